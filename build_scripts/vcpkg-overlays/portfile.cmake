@@ -1,6 +1,17 @@
 set(SOURCE_PATH "/usr/local/share/gcf")
-vcpkg_cmake_configure(SOURCE_PATH ${SOURCE_PATH} DISABLE_PARALLEL_CONFIGURE
-                      OPTIONS -DBUILD_TESTING=OFF)
+set(OPTIMIZATION_OPTIONS)
+if (EXISTS "${SOURCE_PATH}/pgo-profile")
+    # Use the profiles created by ci/cloudbuild/builds/pgo.sh, and LTO.
+    list(
+        APPEND
+        OPTIMIZATION_OPTIONS
+        -DFUNCTIONS_FRAMEWORK_CPP_ENABLE_LTO=ON
+        -DFUNCTIONS_FRAMEWORK_CPP_PGO=use
+        "-DFUNCTIONS_FRAMEWORK_CPP_PGO_PROFILE=${SOURCE_PATH}/pgo-profile")
+endif ()
+vcpkg_cmake_configure(
+    SOURCE_PATH ${SOURCE_PATH} DISABLE_PARALLEL_CONFIGURE
+    OPTIONS -DBUILD_TESTING=OFF ${OPTIMIZATION_OPTIONS})
 vcpkg_cmake_install(ADD_BIN_TO_PATH)
 
 file(REMOVE_RECURSE ${CURRENT_PACKAGES_DIR}/debug/include)
@@ -0,0 +1,91 @@
+#!/bin/bash
+#
+# Copyright 2026 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Builds the framework with profile-guided and link-time optimization. The
+# training workload runs the benchmarks, and the load generator against the
+# integration test servers. Set `PGO_PROFILE_DIR` to keep the profiles, e.g.,
+# to copy them to `pgo-profile/` for the buildpack images.
+
+set -euo pipefail
+
+source "$(dirname "$0")/../../lib/init.sh"
+source module ci/lib/io.sh
+source module ci/cloudbuild/builds/lib/vcpkg.sh
+source module ci/cloudbuild/builds/lib/cmake.sh
+
+readonly PROFILE_DIR="${PGO_PROFILE_DIR:-${PWD}/cmake-out/pgo-profile}"
+readonly CXX_COMPILER="${CXX:-g++}"
+rm -fr "${PROFILE_DIR}"
+
+io::log_h2 "Building the training binaries, with profile instrumentation"
+mapfile -t cmake_args < <(cmake::common_args cmake-out/pgo-generate)
+mapfile -t vcpkg_args < <(vcpkg::cmake_args cmake-out/pgo-generate)
+io::run cmake "${cmake_args[@]}" "${vcpkg_args[@]}" \
+  -DCMAKE_BUILD_TYPE=Release \
+  -DCMAKE_CXX_COMPILER="${CXX_COMPILER}" \
+  -DFUNCTIONS_FRAMEWORK_CPP_TEST_EXAMPLES=OFF \
+  -DFUNCTIONS_FRAMEWORK_CPP_ENABLE_BENCHMARKS=ON \
+  -DFUNCTIONS_FRAMEWORK_CPP_PGO=generate \
+  -DFUNCTIONS_FRAMEWORK_CPP_PGO_PROFILE="${PROFILE_DIR}"
+io::run cmake --build cmake-out/pgo-generate
+
+io::log_h2 "Running the training workload"
+readonly BIN="cmake-out/pgo-generate/google/cloud/functions"
+io::run "${BIN}/benchmarks/cloud_event_parsers_benchmark" \
+  --benchmark_min_time=0.1
+io::run "${BIN}/benchmarks/wrapping_overhead_benchmark" \
+  --benchmark_min_time=0.1
+
+# The servers must exit normally to write their profiles.
+"${BIN}/integration_tests/echo_server" --port 8081 &
+echo_server=$!
+"${BIN}/integration_tests/cloud_event_handler" --port 8082 &
+cloud_event_handler=$!
+sleep 1
+load=("${BIN}/benchmarks/load_generator" --warmup=0 --duration=10
+  --connections=16 --threads=2)
+io::run "${load[@]}" --port=8081 --target=/ok
+io::run "${load[@]}" --port=8081 --target=/echo --payload-size=4096 \
+  --pipeline-depth=4
+io::run "${load[@]}" --port=8082 --mode=cloud-event --payload-size=1024
+# The servers check for shutdown between requests, send the request twice.
+for _ in 1 2; do
+  curl -sS http://localhost:8081/quit/program/0 >/dev/null || true
+  curl -sS -H "content-type: application/cloudevents+json" \
+    -d '{"specversion": "1.0", "type": "quit", "source": "//pgo", "id": "quit",
+         "subject": "/quit/program/0"}' \
+    http://localhost:8082/ >/dev/null || true
+done
+wait "${echo_server}" "${cloud_event_handler}"
+
+if compgen -G "${PROFILE_DIR}/*.profraw" >/dev/null; then
+  io::run llvm-profdata merge -output="${PROFILE_DIR}/merged.profdata" \
+    "${PROFILE_DIR}"/*.profraw
+fi
+
+io::log_h2 "Building with the profiles and link-time optimization"
+mapfile -t cmake_args < <(cmake::common_args cmake-out/pgo-use)
+mapfile -t vcpkg_args < <(vcpkg::cmake_args cmake-out/pgo-use)
+io::run cmake "${cmake_args[@]}" "${vcpkg_args[@]}" \
+  -DCMAKE_BUILD_TYPE=Release \
+  -DCMAKE_CXX_COMPILER="${CXX_COMPILER}" \
+  -DFUNCTIONS_FRAMEWORK_CPP_ENABLE_LTO=ON \
+  -DFUNCTIONS_FRAMEWORK_CPP_PGO=use \
+  -DFUNCTIONS_FRAMEWORK_CPP_PGO_PROFILE="${PROFILE_DIR}"
+io::run cmake --build cmake-out/pgo-use
+
+mapfile -t ctest_args < <(ctest::common_args cmake-out/pgo-use)
+io::run ctest "${ctest_args[@]}"
@@ -0,0 +1,51 @@
+# ~~~
+# Copyright 2026 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ~~~
+
+# Finds the brotli libraries, and defines the `Brotli::common`,
+# `Brotli::encoder` and `Brotli::decoder` targets.
+#
+# Not all brotli packages install CMake configuration files, this module
+# searches for the headers and libraries directly.
+
+find_path(Brotli_INCLUDE_DIR NAMES brotli/encode.h)
+find_library(Brotli_COMMON_LIBRARY NAMES brotlicommon brotlicommon-static)
+find_library(Brotli_ENCODER_LIBRARY NAMES brotlienc brotlienc-static)
+find_library(Brotli_DECODER_LIBRARY NAMES brotlidec brotlidec-static)
+mark_as_advanced(Brotli_INCLUDE_DIR Brotli_COMMON_LIBRARY
+                 Brotli_ENCODER_LIBRARY Brotli_DECODER_LIBRARY)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(
+    Brotli REQUIRED_VARS Brotli_ENCODER_LIBRARY Brotli_DECODER_LIBRARY
+                         Brotli_COMMON_LIBRARY Brotli_INCLUDE_DIR)
+
+if (Brotli_FOUND AND NOT TARGET Brotli::common)
+    add_library(Brotli::common UNKNOWN IMPORTED)
+    set_target_properties(
+        Brotli::common
+        PROPERTIES IMPORTED_LOCATION "${Brotli_COMMON_LIBRARY}"
+                   INTERFACE_INCLUDE_DIRECTORIES "${Brotli_INCLUDE_DIR}")
+    add_library(Brotli::encoder UNKNOWN IMPORTED)
+    set_target_properties(
+        Brotli::encoder
+        PROPERTIES IMPORTED_LOCATION "${Brotli_ENCODER_LIBRARY}"
+                   INTERFACE_LINK_LIBRARIES Brotli::common)
+    add_library(Brotli::decoder UNKNOWN IMPORTED)
+    set_target_properties(
+        Brotli::decoder
+        PROPERTIES IMPORTED_LOCATION "${Brotli_DECODER_LIBRARY}"
+                   INTERFACE_LINK_LIBRARIES Brotli::common)
+endif ()
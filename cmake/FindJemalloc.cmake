@@ -0,0 +1,42 @@
+# ~~~
+# Copyright 2026 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ~~~
+
+# Finds the jemalloc library, and defines the `Jemalloc::jemalloc` target.
+#
+# jemalloc does not install CMake configuration files, this module searches
+# for the header and library directly.
+
+find_path(Jemalloc_INCLUDE_DIR NAMES jemalloc/jemalloc.h)
+find_library(Jemalloc_LIBRARY NAMES jemalloc jemalloc_pic)
+mark_as_advanced(Jemalloc_INCLUDE_DIR Jemalloc_LIBRARY)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(Jemalloc REQUIRED_VARS Jemalloc_LIBRARY
+                                                         Jemalloc_INCLUDE_DIR)
+
+if (Jemalloc_FOUND AND NOT TARGET Jemalloc::jemalloc)
+    add_library(Jemalloc::jemalloc UNKNOWN IMPORTED)
+    set_target_properties(
+        Jemalloc::jemalloc
+        PROPERTIES IMPORTED_LOCATION "${Jemalloc_LIBRARY}"
+                   INTERFACE_INCLUDE_DIRECTORIES "${Jemalloc_INCLUDE_DIR}")
+    # The static library needs the threads and dynamic loading libraries.
+    find_package(Threads)
+    set_property(
+        TARGET Jemalloc::jemalloc
+        APPEND
+        PROPERTY INTERFACE_LINK_LIBRARIES Threads::Threads ${CMAKE_DL_LIBS})
+endif ()
@@ -0,0 +1,36 @@
+# ~~~
+# Copyright 2026 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ~~~
+
+# Finds the liburing library, and defines the `Liburing::liburing` target.
+#
+# liburing does not install CMake configuration files, this module searches
+# for the header and library directly.
+
+find_path(Liburing_INCLUDE_DIR NAMES liburing.h)
+find_library(Liburing_LIBRARY NAMES uring)
+mark_as_advanced(Liburing_INCLUDE_DIR Liburing_LIBRARY)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(Liburing REQUIRED_VARS Liburing_LIBRARY
+                                                         Liburing_INCLUDE_DIR)
+
+if (Liburing_FOUND AND NOT TARGET Liburing::liburing)
+    add_library(Liburing::liburing UNKNOWN IMPORTED)
+    set_target_properties(
+        Liburing::liburing
+        PROPERTIES IMPORTED_LOCATION "${Liburing_LIBRARY}"
+                   INTERFACE_INCLUDE_DIRECTORIES "${Liburing_INCLUDE_DIR}")
+endif ()
@@ -0,0 +1,36 @@
+# ~~~
+# Copyright 2026 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ~~~
+
+# Finds the nghttp2 library, and defines the `Nghttp2::nghttp2` target.
+#
+# nghttp2 does not install CMake configuration files, this module searches for
+# the header and library directly.
+
+find_path(Nghttp2_INCLUDE_DIR NAMES nghttp2/nghttp2.h)
+find_library(Nghttp2_LIBRARY NAMES nghttp2)
+mark_as_advanced(Nghttp2_INCLUDE_DIR Nghttp2_LIBRARY)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(Nghttp2 REQUIRED_VARS Nghttp2_LIBRARY
+                                                        Nghttp2_INCLUDE_DIR)
+
+if (Nghttp2_FOUND AND NOT TARGET Nghttp2::nghttp2)
+    add_library(Nghttp2::nghttp2 UNKNOWN IMPORTED)
+    set_target_properties(
+        Nghttp2::nghttp2
+        PROPERTIES IMPORTED_LOCATION "${Nghttp2_LIBRARY}"
+                   INTERFACE_INCLUDE_DIRECTORIES "${Nghttp2_INCLUDE_DIR}")
+endif ()
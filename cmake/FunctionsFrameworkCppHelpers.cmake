@@ -32,7 +32,110 @@ check_cxx_compiler_flag(
 check_cxx_compiler_flag(-Werror
                         FUNCTIONS_FRAMEWORK_CPP_COMPILER_SUPPORTS_WERROR)
 
+# Link-time optimization, across the framework and any code linking it.
+option(FUNCTIONS_FRAMEWORK_CPP_ENABLE_LTO
+       "If set, compiles the framework with link-time optimization." OFF)
+if (FUNCTIONS_FRAMEWORK_CPP_ENABLE_LTO)
+    include(CheckIPOSupported)
+    check_ipo_supported(RESULT functions_framework_cpp_ipo_supported OUTPUT
+                        functions_framework_cpp_ipo_error)
+    if (NOT functions_framework_cpp_ipo_supported)
+        message(FATAL_ERROR "FUNCTIONS_FRAMEWORK_CPP_ENABLE_LTO is set, but "
+                            "the compiler does not support LTO: "
+                            "${functions_framework_cpp_ipo_error}")
+    endif ()
+endif ()
+
+# Profile-guided optimization. Build with `generate`, run a training workload,
+# and then build again with `use`, see ci/cloudbuild/builds/pgo.sh.
+set(FUNCTIONS_FRAMEWORK_CPP_PGO
+    ""
+    CACHE STRING
+          "Profile-guided optimization mode, one of: (empty), generate, use.")
+set_property(CACHE FUNCTIONS_FRAMEWORK_CPP_PGO PROPERTY STRINGS "" "generate"
+                                                        "use")
+set(FUNCTIONS_FRAMEWORK_CPP_PGO_PROFILE
+    "${CMAKE_BINARY_DIR}/pgo-profile"
+    CACHE PATH "The directory with the profile-guided optimization profiles.")
+mark_as_advanced(FUNCTIONS_FRAMEWORK_CPP_PGO
+                 FUNCTIONS_FRAMEWORK_CPP_PGO_PROFILE)
+
+set(FUNCTIONS_FRAMEWORK_CPP_PGO_COMPILE_OPTIONS)
+set(FUNCTIONS_FRAMEWORK_CPP_PGO_LINK_OPTIONS)
+if ("${FUNCTIONS_FRAMEWORK_CPP_PGO}" STREQUAL "")
+    # Nothing to do.
+elseif (NOT "${FUNCTIONS_FRAMEWORK_CPP_PGO}" MATCHES "^(generate|use)$")
+    message(FATAL_ERROR "Invalid FUNCTIONS_FRAMEWORK_CPP_PGO value "
+                        "<${FUNCTIONS_FRAMEWORK_CPP_PGO}>, must be empty, "
+                        "`generate`, or `use`")
+elseif ("${CMAKE_CXX_COMPILER_ID}" STREQUAL "GNU")
+    set(profile "${FUNCTIONS_FRAMEWORK_CPP_PGO_PROFILE}")
+    # Name the profiles relative to the build directory. The training and
+    # optimized builds may use different directories, e.g., in vcpkg.
+    check_cxx_compiler_flag(
+        -fprofile-prefix-path=/
+        FUNCTIONS_FRAMEWORK_CPP_COMPILER_SUPPORTS_FPROFILE_PREFIX_PATH)
+    if (FUNCTIONS_FRAMEWORK_CPP_COMPILER_SUPPORTS_FPROFILE_PREFIX_PATH)
+        list(APPEND FUNCTIONS_FRAMEWORK_CPP_PGO_COMPILE_OPTIONS
+             "-fprofile-prefix-path=${CMAKE_BINARY_DIR}")
+    else ()
+        message(WARNING "The compiler does not support -fprofile-prefix-path, "
+                        "the training and optimized builds must use the same "
+                        "build directory")
+    endif ()
+    if ("${FUNCTIONS_FRAMEWORK_CPP_PGO}" STREQUAL "generate")
+        # The servers are multi-threaded, avoid losing counter updates.
+        list(APPEND FUNCTIONS_FRAMEWORK_CPP_PGO_COMPILE_OPTIONS
+             "-fprofile-generate=${profile}" "-fprofile-update=atomic")
+        list(APPEND FUNCTIONS_FRAMEWORK_CPP_PGO_LINK_OPTIONS
+             "-fprofile-generate=${profile}")
+    else ()
+        # Code not exercised by the training is optimized as usual, not for
+        # size.
+        list(APPEND FUNCTIONS_FRAMEWORK_CPP_PGO_COMPILE_OPTIONS
+             "-fprofile-use=${profile}" "-fprofile-partial-training"
+             "-Wno-missing-profile")
+    endif ()
+elseif ("${CMAKE_CXX_COMPILER_ID}" MATCHES "Clang")
+    set(profile "${FUNCTIONS_FRAMEWORK_CPP_PGO_PROFILE}")
+    if ("${FUNCTIONS_FRAMEWORK_CPP_PGO}" STREQUAL "generate")
+        list(APPEND FUNCTIONS_FRAMEWORK_CPP_PGO_COMPILE_OPTIONS
+             "-fprofile-instr-generate=${profile}/%m-%p.profraw")
+        list(APPEND FUNCTIONS_FRAMEWORK_CPP_PGO_LINK_OPTIONS
+             "-fprofile-instr-generate=${profile}/%m-%p.profraw")
+    else ()
+        # The `*.profraw` files must be merged into this file, using
+        # `llvm-profdata merge`.
+        list(APPEND FUNCTIONS_FRAMEWORK_CPP_PGO_COMPILE_OPTIONS
+             "-fprofile-instr-use=${profile}/merged.profdata"
+             "-Wno-profile-instr-unprofiled" "-Wno-profile-instr-out-of-date")
+    endif ()
+else ()
+    message(FATAL_ERROR "FUNCTIONS_FRAMEWORK_CPP_PGO is not supported with "
+                        "${CMAKE_CXX_COMPILER_ID}")
+endif ()
+
 function (functions_framework_cpp_add_common_options target)
+    if (FUNCTIONS_FRAMEWORK_CPP_ENABLE_LTO)
+        set_target_properties(${target} PROPERTIES INTERPROCEDURAL_OPTIMIZATION
+                                                   ON)
+        get_target_property(type ${target} TYPE)
+        if ("${CMAKE_CXX_COMPILER_ID}" STREQUAL "GNU" AND "${type}" STREQUAL
+                                                          "STATIC_LIBRARY")
+            # Applications built without LTO can still link the library.
+            target_compile_options(${target} PRIVATE "-ffat-lto-objects")
+        endif ()
+    endif ()
+    if (FUNCTIONS_FRAMEWORK_CPP_PGO_COMPILE_OPTIONS)
+        target_compile_options(
+            ${target} PRIVATE ${FUNCTIONS_FRAMEWORK_CPP_PGO_COMPILE_OPTIONS})
+    endif ()
+    if (FUNCTIONS_FRAMEWORK_CPP_PGO_LINK_OPTIONS)
+        # CMake < 3.13 has no target_link_options(), the flags work as
+        # libraries.
+        target_link_libraries(
+            ${target} PRIVATE ${FUNCTIONS_FRAMEWORK_CPP_PGO_LINK_OPTIONS})
+    endif ()
     if (MSVC)
         target_compile_options(${target} PRIVATE "/W3")
         if (FUNCTIONS_FRAMEWORK_CPP_ENABLE_WERROR)
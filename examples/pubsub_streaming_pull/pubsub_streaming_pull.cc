@@ -0,0 +1,135 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <google/cloud/functions/function.h>
+#include <google/cloud/functions/pull_source.h>
+#include <google/cloud/pubsub/subscriber.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gcf = ::google::cloud::functions;
+namespace pubsub = ::google::cloud::pubsub;
+
+namespace {
+
+/**
+ * Pulls the messages of a subscription with a streaming pull subscriber.
+ *
+ * The event data is the message payload, as published, without the JSON
+ * envelope and base64 encoding of push deliveries. The subscriber flow
+ * control bounds the number of messages buffered here.
+ */
+class SubscriptionSource : public gcf::CloudEventSource {
+ public:
+  explicit SubscriptionSource(pubsub::Subscription const& subscription)
+      : source_("//pubsub.googleapis.com/" + subscription.FullName()),
+        subscriber_(pubsub::MakeSubscriberConnection(
+            subscription,
+            google::cloud::Options{}
+                .set<pubsub::MaxOutstandingMessagesOption>(1000))) {
+    session_ = subscriber_.Subscribe(
+        [this](pubsub::Message const& m, pubsub::AckHandler h) {
+          OnMessage(m, std::move(h));
+        });
+  }
+
+  ~SubscriptionSource() override {
+    session_.cancel();
+    session_.get();
+  }
+
+  std::vector<gcf::PulledCloudEvent> Pull(
+      std::size_t max_events, std::chrono::milliseconds timeout) override {
+    std::unique_lock lk(mu_);
+    cv_.wait_for(lk, timeout, [this] { return !messages_.empty(); });
+    std::vector<gcf::PulledCloudEvent> events;
+    while (!messages_.empty() && events.size() != max_events) {
+      events.push_back(std::move(messages_.front()));
+      messages_.pop_front();
+    }
+    return events;
+  }
+
+  void Ack(std::vector<std::string> ack_ids) override {
+    for (auto& h : Take(ack_ids)) std::move(h).ack();
+  }
+
+  void Nack(std::vector<std::string> ack_ids) override {
+    for (auto& h : Take(ack_ids)) std::move(h).nack();
+  }
+
+ private:
+  void OnMessage(pubsub::Message const& m, pubsub::AckHandler h) {
+    gcf::CloudEvent event(m.message_id(), source_,
+                          "google.cloud.pubsub.topic.v1.messagePublished");
+    event.set_data(m.data());
+    event.set_time(m.publish_time());
+    std::lock_guard lk(mu_);
+    auto ack_id = std::to_string(++next_ack_id_);
+    handlers_.emplace(ack_id, std::move(h));
+    messages_.push_back({std::move(event), std::move(ack_id)});
+    cv_.notify_one();
+  }
+
+  std::vector<pubsub::AckHandler> Take(std::vector<std::string> const& ids) {
+    std::vector<pubsub::AckHandler> handlers;
+    std::lock_guard lk(mu_);
+    for (auto const& id : ids) {
+      auto l = handlers_.find(id);
+      if (l == handlers_.end()) continue;
+      handlers.push_back(std::move(l->second));
+      handlers_.erase(l);
+    }
+    return handlers;
+  }
+
+  std::string source_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<gcf::PulledCloudEvent> messages_;
+  std::unordered_map<std::string, pubsub::AckHandler> handlers_;
+  std::uint64_t next_ack_id_ = 0;
+  pubsub::Subscriber subscriber_;
+  google::cloud::future<google::cloud::Status> session_;
+};
+
+}  // namespace
+
+gcf::Function pubsub_streaming_pull() {
+  auto const* project = std::getenv("GOOGLE_CLOUD_PROJECT");
+  auto const* subscription = std::getenv("SUBSCRIPTION_ID");
+  if (project == nullptr || subscription == nullptr) {
+    throw std::runtime_error("GOOGLE_CLOUD_PROJECT or SUBSCRIPTION_ID not set");
+  }
+  gcf::PullOptions options;
+  options.max_batch_size = 10;
+  return gcf::WithPullSource(
+      gcf::MakeFunction([](gcf::CloudEvent const& event) {
+        std::cout << event.data().value_or("") << "\n";
+      }),
+      std::make_shared<SubscriptionSource>(
+          pubsub::Subscription(project, subscription)),
+      options);
+}
@@ -0,0 +1,137 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/background_executor.h"
+#include "google/cloud/functions/internal/cpu_limits.h"
+#include "google/cloud/functions/internal/structured_log.h"
+#include <algorithm>
+#include <exception>
+#include <string>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+BackgroundExecutor::BackgroundExecutor(std::size_t max_threads,
+                                       std::size_t deferred_per_request)
+    : max_threads_(std::max<std::size_t>(max_threads, 1)),
+      deferred_per_request_(deferred_per_request) {}
+
+BackgroundExecutor::~BackgroundExecutor() {
+  {
+    std::unique_lock<std::mutex> lk(mu_);
+    idle_.wait(lk, [this] { return Idle(); });
+    shutdown_ = true;
+  }
+  work_.notify_all();
+  for (auto& t : threads_) t.join();
+}
+
+BackgroundExecutor& BackgroundExecutor::Default() {
+  // Never destroyed, the framework drains it before returning from `Run()`.
+  static auto* const kDefault =
+      new BackgroundExecutor(functions_internal::DefaultConcurrency());
+  return *kDefault;
+}
+
+void BackgroundExecutor::Submit(std::function<void()> task) {
+  std::lock_guard<std::mutex> lk(mu_);
+  Enqueue(std::move(task));
+}
+
+void BackgroundExecutor::Defer(std::function<void()> task) {
+  std::lock_guard<std::mutex> lk(mu_);
+  deferred_.push_back(std::move(task));
+  deferred_count_.store(deferred_.size());
+  // `RequestStarted()` increments `active_` before loading `deferred_count_`,
+  // so either it sees this task, or this sees the request.
+  if (active_.load() > 0) StartDeferred(1);
+}
+
+void BackgroundExecutor::RequestStarted() {
+  active_.fetch_add(1);
+  if (deferred_count_.load() == 0) return;
+  std::lock_guard<std::mutex> lk(mu_);
+  StartDeferred(deferred_per_request_);
+}
+
+std::size_t BackgroundExecutor::pending() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return deferred_.size() + tasks_.size() + running_;
+}
+
+bool BackgroundExecutor::Drain(std::chrono::steady_clock::duration timeout) {
+  std::unique_lock<std::mutex> lk(mu_);
+  return idle_.wait_for(lk, timeout, [this] { return Idle(); });
+}
+
+bool BackgroundExecutor::Idle() {
+  // Tasks deferred while draining, possibly by other tasks, run too.
+  StartDeferred(deferred_.size());
+  return tasks_.empty() && running_ == 0;
+}
+
+void BackgroundExecutor::Enqueue(std::function<void()> task) {
+  tasks_.push_back(std::move(task));
+  // Threads are created on demand, most functions submit few tasks.
+  if (idle_threads_ < tasks_.size() && threads_.size() < max_threads_) {
+    threads_.emplace_back([this] { Run(); });
+  }
+  work_.notify_one();
+}
+
+void BackgroundExecutor::StartDeferred(std::size_t n) {
+  for (; n != 0 && !deferred_.empty(); --n) {
+    auto task = std::move(deferred_.front());
+    deferred_.pop_front();
+    Enqueue(std::move(task));
+  }
+  deferred_count_.store(deferred_.size());
+}
+
+void BackgroundExecutor::Run() {
+  std::unique_lock<std::mutex> lk(mu_);
+  for (;;) {
+    ++idle_threads_;
+    work_.wait(lk, [this] { return shutdown_ || !tasks_.empty(); });
+    --idle_threads_;
+    if (tasks_.empty()) return;
+    auto task = std::move(tasks_.front());
+    tasks_.pop_front();
+    ++running_;
+    lk.unlock();
+    try {
+      task();
+    } catch (std::exception const& ex) {
+      functions_internal::WriteLog(
+          LogSeverity::kError,
+          std::string("Background task failed: ") + ex.what());
+    } catch (...) {
+      functions_internal::WriteLog(
+          LogSeverity::kError,
+          "Background task failed with an unknown exception");
+    }
+    // Release any captured state before reporting the task as done.
+    task = nullptr;
+    lk.lock();
+    --running_;
+    if (tasks_.empty() && running_ == 0) idle_.notify_all();
+  }
+}
+
+void RunInBackground(std::function<void()> task) {
+  BackgroundExecutor::Default().Submit(std::move(task));
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
@@ -0,0 +1,133 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_BACKGROUND_EXECUTOR_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_BACKGROUND_EXECUTOR_H
+
+#include "google/cloud/functions/version.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Runs non-critical work off the request path, and tracks it until done.
+ *
+ * Detached threads, or discarded `std::async()` futures, may not complete:
+ * nothing waits for them when the instance shuts down. Tasks submitted to a
+ * `BackgroundExecutor` run in its own threads, so the function can return
+ * its response immediately, and the framework waits for the tasks of
+ * `Default()` during a graceful shutdown, for up to the
+ * `--shutdown-grace-period`.
+ *
+ * Platforms that throttle the CPU outside of requests, such as Cloud Run with
+ * request-based billing, may run the tasks slowly between requests. Tasks
+ * queued with `Defer()` wait for the next request instead, and each request
+ * starts at most `deferred_per_request` of them, so the work runs while the
+ * CPU is allocated without delaying any request much. Deploy with CPU always
+ * allocated if the tasks must complete promptly regardless of the traffic.
+ *
+ * Exceptions thrown by the tasks are logged and otherwise ignored.
+ */
+class BackgroundExecutor {
+ public:
+  /// The number of deferred tasks started by each request, by default.
+  static constexpr std::size_t kDefaultDeferredPerRequest = 4;
+
+  /// Creates an executor with up to @p max_threads threads, at least 1.
+  explicit BackgroundExecutor(
+      std::size_t max_threads,
+      std::size_t deferred_per_request = kDefaultDeferredPerRequest);
+
+  /// Waits for all the tasks, including any submitted while waiting.
+  ~BackgroundExecutor();
+
+  BackgroundExecutor(BackgroundExecutor const&) = delete;
+  BackgroundExecutor& operator=(BackgroundExecutor const&) = delete;
+
+  /**
+   * The executor drained by the framework during shutdown.
+   *
+   * It has up to one thread per core, created on demand.
+   */
+  static BackgroundExecutor& Default();
+
+  /// Queues @p task, it starts as soon as a thread is available.
+  void Submit(std::function<void()> task);
+
+  /**
+   * Queues @p task until a request is in flight.
+   *
+   * The task starts immediately if a request is in flight, otherwise the next
+   * request starts it, in the order they were deferred. `Drain()` and the
+   * destructor start all the deferred tasks.
+   */
+  void Defer(std::function<void()> task);
+
+  /**
+   * Reports the start and end of a request.
+   *
+   * The framework reports all its requests to `Default()`. Each start moves
+   * up to `deferred_per_request` deferred tasks to the queue.
+   */
+  ///@{
+  void RequestStarted();
+  void RequestDone() { active_.fetch_sub(1); }
+  ///@}
+
+  /// The number of tasks deferred, queued, or running.
+  [[nodiscard]] std::size_t pending() const;
+
+  /// Waits up to @p timeout for all the tasks, returns true if none remain.
+  bool Drain(std::chrono::steady_clock::duration timeout);
+
+ private:
+  void Run();
+  // These require `mu_`.
+  void Enqueue(std::function<void()> task);
+  void StartDeferred(std::size_t n);
+  bool Idle();
+
+  std::size_t max_threads_;
+  std::size_t deferred_per_request_;
+  // Checked without the lock, most requests find no deferred tasks.
+  std::atomic<std::int64_t> active_{0};
+  std::atomic<std::size_t> deferred_count_{0};
+  mutable std::mutex mu_;
+  std::condition_variable work_;
+  std::condition_variable idle_;
+  std::deque<std::function<void()>> tasks_;
+  std::deque<std::function<void()>> deferred_;
+  std::size_t running_ = 0;
+  std::size_t idle_threads_ = 0;
+  bool shutdown_ = false;
+  std::vector<std::thread> threads_;
+};
+
+/// Runs @p task in `BackgroundExecutor::Default()`.
+void RunInBackground(std::function<void()> task);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_BACKGROUND_EXECUTOR_H
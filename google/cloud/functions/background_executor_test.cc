@@ -0,0 +1,124 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/background_executor.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+TEST(BackgroundExecutorTest, RunsTasks) {
+  std::atomic<int> count{0};
+  BackgroundExecutor executor(2);
+  for (int i = 0; i != 10; ++i) executor.Submit([&count] { ++count; });
+  EXPECT_TRUE(executor.Drain(std::chrono::seconds(10)));
+  EXPECT_EQ(count.load(), 10);
+  EXPECT_EQ(executor.pending(), 0);
+}
+
+TEST(BackgroundExecutorTest, DrainTimeout) {
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  BackgroundExecutor executor(1);
+  executor.Submit([released] { released.wait(); });
+  executor.Submit([] {});
+  EXPECT_EQ(executor.pending(), 2);
+  EXPECT_FALSE(executor.Drain(std::chrono::milliseconds(10)));
+  release.set_value();
+  EXPECT_TRUE(executor.Drain(std::chrono::seconds(10)));
+  EXPECT_EQ(executor.pending(), 0);
+}
+
+TEST(BackgroundExecutorTest, IgnoresExceptions) {
+  std::atomic<int> count{0};
+  BackgroundExecutor executor(1);
+  executor.Submit([] { throw std::runtime_error("test-only"); });
+  executor.Submit([&count] { ++count; });
+  EXPECT_TRUE(executor.Drain(std::chrono::seconds(10)));
+  EXPECT_EQ(count.load(), 1);
+}
+
+TEST(BackgroundExecutorTest, DestructorWaits) {
+  std::atomic<int> count{0};
+  {
+    BackgroundExecutor executor(4);
+    for (int i = 0; i != 8; ++i) {
+      executor.Submit([&count] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ++count;
+      });
+    }
+  }
+  EXPECT_EQ(count.load(), 8);
+}
+
+TEST(BackgroundExecutorTest, DeferUntilRequest) {
+  std::atomic<int> count{0};
+  BackgroundExecutor executor(1, 2);
+  for (int i = 0; i != 5; ++i) executor.Defer([&count] { ++count; });
+  EXPECT_EQ(executor.pending(), 5);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(count.load(), 0);
+
+  // Each request starts up to 2 deferred tasks.
+  executor.RequestStarted();
+  executor.RequestDone();
+  auto const deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (count.load() < 2 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(count.load(), 2);
+  EXPECT_EQ(executor.pending(), 3);
+
+  // Drain() starts the remaining tasks.
+  EXPECT_TRUE(executor.Drain(std::chrono::seconds(10)));
+  EXPECT_EQ(count.load(), 5);
+}
+
+TEST(BackgroundExecutorTest, DeferDuringRequest) {
+  std::promise<void> done;
+  BackgroundExecutor executor(1);
+  executor.RequestStarted();
+  executor.Defer([&done] { done.set_value(); });
+  done.get_future().get();
+  executor.RequestDone();
+  EXPECT_TRUE(executor.Drain(std::chrono::seconds(10)));
+}
+
+TEST(BackgroundExecutorTest, DestructorStartsDeferred) {
+  std::atomic<int> count{0};
+  {
+    BackgroundExecutor executor(2);
+    for (int i = 0; i != 4; ++i) executor.Defer([&count] { ++count; });
+  }
+  EXPECT_EQ(count.load(), 4);
+}
+
+TEST(BackgroundExecutorTest, Default) {
+  std::promise<int> result;
+  RunInBackground([&result] { result.set_value(42); });
+  EXPECT_EQ(result.get_future().get(), 42);
+  EXPECT_TRUE(BackgroundExecutor::Default().Drain(std::chrono::seconds(10)));
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
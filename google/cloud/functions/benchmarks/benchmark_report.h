@@ -0,0 +1,67 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_BENCHMARKS_BENCHMARK_REPORT_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_BENCHMARKS_BENCHMARK_REPORT_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// Helpers to print the JSON reports of the benchmark programs.
+namespace google::cloud::functions_benchmarks {
+
+/// Quotes and escapes @p value as a JSON string.
+inline std::string JsonString(std::string const& value) {
+  std::string result = "\"";
+  for (auto c : value) {
+    if (c == '"' || c == '\\') {
+      result.push_back('\\');
+      result.push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char buffer[8];
+      std::snprintf(buffer, sizeof(buffer), "\\u%04x",
+                    static_cast<unsigned>(c));
+      result += buffer;
+    } else {
+      result.push_back(c);
+    }
+  }
+  return result + "\"";
+}
+
+/// The nearest-rank percentile of sorted @p values.
+template <typename T>
+double Percentile(std::vector<T> const& values, double q) {
+  if (values.empty()) return 0;
+  auto rank = static_cast<std::size_t>(
+      std::ceil(q * static_cast<double>(values.size())));
+  rank = std::clamp<std::size_t>(rank, 1, values.size());
+  return static_cast<double>(values[rank - 1]);
+}
+
+/// The nearest-rank percentile of sorted latencies, in nanoseconds, as
+/// microseconds.
+inline double PercentileMicros(std::vector<std::int64_t> const& nanos,
+                               double q) {
+  return Percentile(nanos, q) / 1000.0;
+}
+
+}  // namespace google::cloud::functions_benchmarks
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_BENCHMARKS_BENCHMARK_REPORT_H
@@ -0,0 +1,320 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/base64_decode.h"
+#include "google/cloud/functions/internal/parse_cloud_event_http.h"
+#include "google/cloud/functions/internal/parse_cloud_event_json.h"
+#include "google/cloud/functions/internal/parse_cloud_event_legacy.h"
+#include "google/cloud/functions/internal/parse_cloud_event_storage.h"
+#include <benchmark/benchmark.h>
+#include <string>
+
+namespace {
+
+namespace gcf = ::google::cloud::functions;
+namespace gcf_internal = ::google::cloud::functions_internal;
+
+// The payload sizes, in bytes, before any base64 encoding.
+auto constexpr kSmall = 256;
+auto constexpr kMedium = 4 * 1024;
+auto constexpr kLarge = 64 * 1024;
+
+char Letter(int i) {
+  auto constexpr kLetters = 26;
+  return static_cast<char>('a' + i % kLetters);
+}
+
+/// A JSON object with string fields, of roughly @p size bytes.
+std::string JsonObject(std::size_t size) {
+  std::string json = "{";
+  for (int i = 0; json.size() < size; ++i) {
+    if (i != 0) json += ',';
+    json += R"("field)" + std::to_string(i) + R"(":"value-)";
+    json += std::string(48, Letter(i)) + '"';
+  }
+  return json + "}";
+}
+
+std::string Base64(std::string_view data) {
+  std::string out;
+  gcf_internal::Base64Encode(data, out);
+  return out;
+}
+
+/// The data of a Pub/Sub push, as sent by Eventarc.
+std::string PubSubData(std::size_t size) {
+  return R"({"subscription":"projects/sample-project/subscriptions/sub",)"
+         R"("message":{"attributes":{"origin":"benchmark","source":"test"},)"
+         R"("data":")" +
+         Base64(JsonObject(size)) +
+         R"(","messageId":"2070443601311540","message_id":"2070443601311540",)"
+         R"("publishTime":"2021-02-05T04:06:14.109Z",)"
+         R"("publish_time":"2021-02-05T04:06:14.109Z"}})";
+}
+
+/// A structured mode Pub/Sub event.
+std::string PubSubEvent(std::size_t size) {
+  return R"({"specversion":"1.0",)"
+         R"("type":"google.cloud.pubsub.topic.v1.messagePublished",)"
+         R"("source":"//pubsub.googleapis.com/projects/sample-project/)"
+         R"(topics/gcf-test",)"
+         R"("id":"aaaaaa-1111-bbbb-2222-cccccccccccc",)"
+         R"("time":"2020-09-29T11:32:00.000Z",)"
+         R"("datacontenttype":"application/json",)"
+         R"("data":)" +
+         PubSubData(size) + "}";
+}
+
+/// The metadata of a Cloud Storage object, with @p metadata custom metadata.
+std::string StorageObject(std::size_t metadata) {
+  return R"({"bucket":"some-bucket","contentType":"text/plain",)"
+         R"("crc32c":"rTVTeQ==","etag":"CNHZkbuF/ugCEAE=",)"
+         R"("generation":"1587627537231057",)"
+         R"("id":"some-bucket/folder/Test.cs/1587627537231057",)"
+         R"("kind":"storage#object","md5Hash":"kF8MuJ5+CTJxvyhHS1xzRg==",)"
+         R"("mediaLink":"https://www.googleapis.com/download/storage/v1/b/)"
+         R"(some-bucket/o/folder%2FTest.cs?generation=1587627537231057)"
+         R"(&alt=media",)"
+         R"("metadata":)" +
+         JsonObject(metadata) +
+         R"(,"metageneration":"1","name":"folder/Test.cs",)"
+         R"("selfLink":"https://www.googleapis.com/storage/v1/b/some-bucket/o/)"
+         R"(folder/Test.cs","size":"352","storageClass":"MULTI_REGIONAL",)"
+         R"("timeCreated":"2020-04-23T07:38:57.230Z",)"
+         R"("timeStorageClassUpdated":"2020-04-23T07:38:57.230Z",)"
+         R"("updated":"2020-04-23T07:38:57.230Z"})";
+}
+
+/// A structured mode Cloud Storage event.
+std::string StorageEvent(std::size_t metadata) {
+  return R"({"specversion":"1.0",)"
+         R"("type":"google.cloud.storage.object.v1.finalized",)"
+         R"("source":"//storage.googleapis.com/projects/_/buckets/)"
+         R"(some-bucket",)"
+         R"("subject":"objects/folder/Test.cs",)"
+         R"("id":"aaaaaa-1111-bbbb-2222-cccccccccccc",)"
+         R"("time":"2020-04-23T07:38:57.230Z",)"
+         R"("datacontenttype":"application/json",)"
+         R"("data":)" +
+         StorageObject(metadata) + "}";
+}
+
+/// A Cloud Storage notification, as delivered by Pub/Sub.
+gcf::CloudEvent StorageNotification(std::size_t metadata) {
+  auto data =
+      R"({"message":{"attributes":{)"
+      R"("notificationConfig":"projects/_/buckets/some-bucket/)"
+      R"(notificationConfigs/3",)"
+      R"("eventType":"OBJECT_FINALIZE","payloadFormat":"JSON_API_V1",)"
+      R"("bucketId":"some-bucket","objectId":"folder/Test.cs",)"
+      R"("objectGeneration":"1587627537231057"},"data":")" +
+      Base64(StorageObject(metadata)) + R"("}})";
+  auto event = gcf::CloudEvent(
+      "aaaaaa-1111-bbbb-2222-cccccccccccc",
+      "//pubsub.googleapis.com/projects/sample-project/topics/storage",
+      "google.cloud.pubsub.topic.v1.messagePublished");
+  event.set_data_content_type("application/json");
+  event.set_data(std::move(data));
+  return event;
+}
+
+/// A legacy (GCF) Firestore event, with a document of roughly @p size bytes.
+std::string FirestoreLegacyEvent(std::size_t size) {
+  std::string fields = "{";
+  for (int i = 0; fields.size() < size; ++i) {
+    if (i != 0) fields += ',';
+    fields += R"("field)" + std::to_string(i) + R"(":{"stringValue":")" +
+              std::string(48, Letter(i)) + R"("})";
+  }
+  fields += '}';
+  auto const document =
+      R"({"createTime":"2020-09-29T11:32:00.000Z","fields":)" + fields +
+      R"(,"name":"projects/project-id/databases/(default)/documents/)"
+      R"(gcf-test/2Vm2mI1d0wIaK2Waj5to",)"
+      R"("updateTime":"2020-09-29T11:32:00.000Z"})";
+  return R"({"data":{"oldValue":{},"updateMask":{},"value":)" + document +
+         R"(},"context":{"eventId":"7b8f1804-d38b-4b68-b37d-e2fb5d12d5a0-0",)"
+         R"("eventType":"providers/cloud.firestore/eventTypes/document.write",)"
+         R"("resource":"projects/project-id/databases/(default)/documents/)"
+         R"(gcf-test/2Vm2mI1d0wIaK2Waj5to",)"
+         R"("timestamp":"2020-09-29T11:32:00.000Z"}})";
+}
+
+/// A legacy (GCF) Firebase Auth event.
+std::string FirebaseAuthLegacyEvent() {
+  return R"({"data":{"email":"test@nowhere.com","metadata":{)"
+         R"("createdAt":"2020-05-26T10:42:27Z",)"
+         R"("lastSignedInAt":"2020-10-24T11:00:00Z"},)"
+         R"("providerData":[{"email":"test@nowhere.com",)"
+         R"("providerId":"password","uid":"test@nowhere.com"}],)"
+         R"("uid":"UUpby3s4spZre6kHsgVSPetzQ8l2"},)"
+         R"("context":{"eventId":"aaaaaa-1111-bbbb-2222-cccccccccccc",)"
+         R"("eventType":"providers/firebase.auth/eventTypes/user.create",)"
+         R"("service":"firebase.googleapis.com",)"
+         R"("resource":{"name":"projects/my-project-id"},)"
+         R"("timestamp":"2020-09-29T11:32:00.000Z"}})";
+}
+
+std::string Batch(std::size_t count, std::size_t size) {
+  std::string batch = "[";
+  for (std::size_t i = 0; i != count; ++i) {
+    if (i != 0) batch += ',';
+    batch += PubSubEvent(size);
+  }
+  return batch + "]";
+}
+
+void SetBytes(benchmark::State& state, std::size_t bytes) {
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          static_cast<std::int64_t>(bytes));
+}
+
+void BM_ParseCloudEventJsonPubSub(benchmark::State& state) {
+  auto const json = PubSubEvent(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(gcf_internal::ParseCloudEventJson(json));
+  }
+  SetBytes(state, json.size());
+}
+BENCHMARK(BM_ParseCloudEventJsonPubSub)->Arg(kSmall)->Arg(kMedium)->Arg(kLarge);
+
+void BM_ParseCloudEventJsonStorage(benchmark::State& state) {
+  auto const json = StorageEvent(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(gcf_internal::ParseCloudEventJson(json));
+  }
+  SetBytes(state, json.size());
+}
+BENCHMARK(BM_ParseCloudEventJsonStorage)->Arg(kSmall)->Arg(kMedium);
+
+void BM_ParseCloudEventJsonBatch(benchmark::State& state) {
+  auto const json = Batch(static_cast<std::size_t>(state.range(0)), kSmall);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(gcf_internal::ParseCloudEventJsonBatch(json));
+  }
+  SetBytes(state, json.size());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ParseCloudEventJsonBatch)->Arg(1)->Arg(10)->Arg(100);
+
+void BM_ParseCloudEventLegacyFirestore(benchmark::State& state) {
+  auto const json =
+      FirestoreLegacyEvent(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(gcf_internal::ParseCloudEventLegacy(json));
+  }
+  SetBytes(state, json.size());
+}
+BENCHMARK(BM_ParseCloudEventLegacyFirestore)
+    ->Arg(kSmall)
+    ->Arg(kMedium)
+    ->Arg(kLarge);
+
+void BM_ParseCloudEventLegacyFirebaseAuth(benchmark::State& state) {
+  auto const json = FirebaseAuthLegacyEvent();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(gcf_internal::ParseCloudEventLegacy(json));
+  }
+  SetBytes(state, json.size());
+}
+BENCHMARK(BM_ParseCloudEventLegacyFirebaseAuth);
+
+void BM_ParseCloudEventStorage(benchmark::State& state) {
+  auto const event =
+      StorageNotification(static_cast<std::size_t>(state.range(0)));
+  // Make sure the benchmark measures the conversion.
+  if (gcf_internal::ParseCloudEventStorage(event).type() == event.type()) {
+    state.SkipWithError("not converted to a Cloud Storage event");
+    return;
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(gcf_internal::ParseCloudEventStorage(event));
+  }
+  SetBytes(state, event.data().value_or("").size());
+}
+BENCHMARK(BM_ParseCloudEventStorage)->Arg(kSmall)->Arg(kMedium);
+
+gcf_internal::BeastRequest BinaryRequest(std::size_t size) {
+  gcf_internal::BeastRequest request;
+  request.set("ce-specversion", "1.0");
+  request.set("ce-type", "google.cloud.pubsub.topic.v1.messagePublished");
+  request.set(
+      "ce-source",
+      "//pubsub.googleapis.com/projects/sample-project/topics/gcf-test");
+  request.set("ce-id", "aaaaaa-1111-bbbb-2222-cccccccccccc");
+  request.set("ce-time", "2020-09-29T11:32:00.000Z");
+  request.set("content-type", "application/json");
+  request.body() = PubSubData(size);
+  request.prepare_payload();
+  return request;
+}
+
+gcf_internal::BeastRequest StructuredRequest(std::string content_type,
+                                             std::string body) {
+  gcf_internal::BeastRequest request;
+  request.set("content-type", std::move(content_type));
+  request.body() = std::move(body);
+  request.prepare_payload();
+  return request;
+}
+
+void BM_ParseCloudEventHttpBinary(benchmark::State& state) {
+  auto const request = BinaryRequest(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(gcf_internal::ParseCloudEventHttp(request));
+  }
+  SetBytes(state, request.body().size());
+}
+BENCHMARK(BM_ParseCloudEventHttpBinary)->Arg(kSmall)->Arg(kMedium)->Arg(kLarge);
+
+void BM_ParseCloudEventHttpStructured(benchmark::State& state) {
+  auto const request =
+      StructuredRequest("application/cloudevents+json; charset=UTF-8",
+                        PubSubEvent(static_cast<std::size_t>(state.range(0))));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(gcf_internal::ParseCloudEventHttp(request));
+  }
+  SetBytes(state, request.body().size());
+}
+BENCHMARK(BM_ParseCloudEventHttpStructured)
+    ->Arg(kSmall)
+    ->Arg(kMedium)
+    ->Arg(kLarge);
+
+void BM_ParseCloudEventHttpBatch(benchmark::State& state) {
+  auto const request = StructuredRequest(
+      "application/cloudevents-batch+json; charset=UTF-8",
+      Batch(static_cast<std::size_t>(state.range(0)), kSmall));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(gcf_internal::ParseCloudEventHttp(request));
+  }
+  SetBytes(state, request.body().size());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ParseCloudEventHttpBatch)->Arg(1)->Arg(10)->Arg(100);
+
+void BM_ParseCloudEventHttpLegacy(benchmark::State& state) {
+  auto const request = StructuredRequest(
+      "application/json",
+      FirestoreLegacyEvent(static_cast<std::size_t>(state.range(0))));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(gcf_internal::ParseCloudEventHttp(request));
+  }
+  SetBytes(state, request.body().size());
+}
+BENCHMARK(BM_ParseCloudEventHttpLegacy)->Arg(kSmall)->Arg(kMedium);
+
+}  // namespace
+
+BENCHMARK_MAIN();
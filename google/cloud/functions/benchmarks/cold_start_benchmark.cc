@@ -0,0 +1,319 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the cold start of a function, launching it repeatedly.
+//
+// The command after `--` runs once per iteration, for example:
+//
+//   cold_start_benchmark --iterations=20 -- ./hello_world --debug-startup
+//
+// or, for a container built with `pack`:
+//
+//   cold_start_benchmark -- docker run --rm -p 8080:8080 hello-world
+//
+// Each run records the time from `exec()` until the port accepts connections,
+// and until the first response other than a 5xx. If the function runs with
+// `--debug-startup` the report from `/debug/startup`, with the startup phases
+// measured by the framework, is included in the results. The results are
+// printed as a JSON object.
+//
+// With containers the port may accept connections, through the proxy, before
+// the function listens. The time to the first response is the reliable
+// number in that case.
+
+#include "google/cloud/functions/benchmarks/benchmark_report.h"
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/program_options.hpp>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace {
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace po = boost::program_options;
+using Clock = std::chrono::steady_clock;
+using tcp = asio::ip::tcp;
+using ::google::cloud::functions_benchmarks::JsonString;
+using ::google::cloud::functions_benchmarks::Percentile;
+
+struct Config {
+  std::string host;
+  std::string port;
+  std::string target;
+  std::string startup_target;
+  int iterations = 0;
+  double timeout = 0;
+  double poll_interval = 0;
+  bool show_output = false;
+  std::vector<std::string> command;
+};
+
+struct Run {
+  Clock::duration listen;
+  Clock::duration first_response;
+  std::optional<std::string> startup;
+};
+
+/// Starts @p command in a new process.
+pid_t Spawn(Config const& config) {
+  std::vector<char*> argv;
+  for (auto const& a : config.command) {
+    argv.push_back(const_cast<char*>(a.c_str()));
+  }
+  argv.push_back(nullptr);
+  auto const pid = ::fork();
+  if (pid == -1) {
+    throw std::system_error(errno, std::generic_category(), "fork");
+  }
+  if (pid != 0) return pid;
+  if (!config.show_output) {
+    auto const fd = ::open("/dev/null", O_WRONLY);
+    if (fd != -1) {
+      ::dup2(fd, STDOUT_FILENO);
+      ::dup2(fd, STDERR_FILENO);
+      ::close(fd);
+    }
+  }
+  ::execvp(argv[0], argv.data());
+  std::perror("execvp");
+  ::_exit(127);
+}
+
+void Stop(pid_t pid) {
+  ::kill(pid, SIGTERM);
+  int status;
+  ::waitpid(pid, &status, 0);
+}
+
+/// Sends a `GET` request for @p target, returns the response if any.
+std::optional<http::response<http::string_body>> Get(
+    asio::io_context& io, tcp::resolver::results_type const& endpoints,
+    Config const& config, std::string const& target) {
+  beast::error_code ec;
+  tcp::socket socket(io);
+  asio::connect(socket, endpoints, ec);
+  if (ec) return std::nullopt;
+  http::request<http::empty_body> request{http::verb::get, target, 11};
+  request.set(http::field::host, config.host + ":" + config.port);
+  request.set(http::field::user_agent, "functions-framework-cpp-cold-start");
+  http::write(socket, request, ec);
+  if (ec) return std::nullopt;
+  beast::flat_buffer buffer;
+  http::response<http::string_body> response;
+  http::read(socket, buffer, response, ec);
+  if (ec) return std::nullopt;
+  return response;
+}
+
+/**
+ * Polls until @p done returns `true`.
+ *
+ * Throws if the process exits, or the timeout expires, first.
+ */
+template <typename Predicate>
+void PollUntil(pid_t pid, Config const& config, Clock::time_point deadline,
+               char const* what, Predicate done) {
+  auto const interval = std::chrono::duration<double>(config.poll_interval);
+  while (!done()) {
+    int status;
+    if (::waitpid(pid, &status, WNOHANG) == pid) {
+      throw std::runtime_error(std::string("the command exited before ") +
+                               what);
+    }
+    if (Clock::now() >= deadline) {
+      Stop(pid);
+      throw std::runtime_error(std::string("timeout waiting for ") + what);
+    }
+    std::this_thread::sleep_for(interval);
+  }
+}
+
+Run RunOnce(Config const& config) {
+  asio::io_context io;
+  auto const endpoints = tcp::resolver(io).resolve(config.host, config.port);
+
+  auto const start = Clock::now();
+  auto const pid = Spawn(config);
+  auto const deadline =
+      start + std::chrono::duration_cast<Clock::duration>(
+                  std::chrono::duration<double>(config.timeout));
+  Run run;
+  PollUntil(pid, config, deadline, "listening", [&] {
+    beast::error_code ec;
+    tcp::socket socket(io);
+    asio::connect(socket, endpoints, ec);
+    return !ec;
+  });
+  run.listen = Clock::now() - start;
+  PollUntil(pid, config, deadline, "the first response", [&] {
+    auto const response = Get(io, endpoints, config, config.target);
+    return response && response->result_int() < 500;
+  });
+  run.first_response = Clock::now() - start;
+  if (!config.startup_target.empty()) {
+    auto response = Get(io, endpoints, config, config.startup_target);
+    if (response && response->result() == http::status::ok) {
+      run.startup = std::move(response->body());
+    }
+  }
+  Stop(pid);
+  return run;
+}
+
+double Milliseconds(Clock::duration d) {
+  return std::chrono::duration<double, std::milli>(d).count();
+}
+
+std::string Summary(std::vector<double> values) {
+  std::sort(values.begin(), values.end());
+  auto const mean = values.empty()
+                        ? 0.0
+                        : std::accumulate(values.begin(), values.end(), 0.0) /
+                              static_cast<double>(values.size());
+  std::ostringstream os;
+  os << "{\"min\": " << Percentile(values, 0) << ", \"mean\": " << mean
+     << ", \"p50\": " << Percentile(values, 0.50)
+     << ", \"p90\": " << Percentile(values, 0.90)
+     << ", \"p99\": " << Percentile(values, 0.99)
+     << ", \"max\": " << Percentile(values, 1.0) << "}";
+  return std::move(os).str();
+}
+
+std::string Report(Config const& config, std::vector<Run> const& runs) {
+  std::vector<double> listen;
+  std::vector<double> first_response;
+  for (auto const& r : runs) {
+    listen.push_back(Milliseconds(r.listen));
+    first_response.push_back(Milliseconds(r.first_response));
+  }
+  std::ostringstream os;
+  os << "{\"command\": [";
+  char const* sep = "";
+  for (auto const& a : config.command) {
+    os << sep << JsonString(a);
+    sep = ", ";
+  }
+  os << "], \"iterations\": " << runs.size()
+     << ", \"listen_ms\": " << Summary(listen)
+     << ", \"first_response_ms\": " << Summary(first_response)
+     << ", \"runs\": [";
+  sep = "";
+  for (auto const& r : runs) {
+    os << sep << "{\"listen_ms\": " << Milliseconds(r.listen)
+       << ", \"first_response_ms\": " << Milliseconds(r.first_response)
+       << ", \"startup\": " << r.startup.value_or("null") << "}";
+    sep = ", ";
+  }
+  os << "]}";
+  return std::move(os).str();
+}
+
+Config ParseConfig(int argc, char* argv[]) {
+  Config config;
+  po::options_description desc("Cold start benchmark");
+  desc.add_options()("help", "produce help message")
+      //
+      ("host", po::value(&config.host)->default_value("localhost"),
+       "the host where the function listens")
+      //
+      ("port", po::value(&config.port)->default_value("8080"),
+       "the port where the function listens")
+      //
+      ("target", po::value(&config.target)->default_value("/"),
+       "the target of the first request")
+      //
+      ("startup-target",
+       po::value(&config.startup_target)->default_value("/debug/startup"),
+       "the target with the startup phases, empty to skip them")
+      //
+      ("iterations", po::value(&config.iterations)->default_value(10),
+       "the number of times to start the function")
+      //
+      ("timeout", po::value(&config.timeout)->default_value(60),
+       "the seconds to wait for each start")
+      //
+      ("poll-interval", po::value(&config.poll_interval)->default_value(0.001),
+       "the seconds between connection attempts")
+      //
+      ("show-output", po::bool_switch(&config.show_output),
+       "do not discard the output of the function")
+      //
+      ("command", po::value(&config.command)->multitoken(),
+       "the command to run, usually given after `--`");
+  po::positional_options_description positional;
+  positional.add("command", -1);
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv)
+                .options(desc)
+                .positional(positional)
+                .run(),
+            vm);
+  po::notify(vm);
+  if (vm.count("help") != 0) {
+    std::cout << desc << "\n";
+    std::exit(0);
+  }
+  if (config.command.empty()) {
+    throw std::invalid_argument("missing the command to run");
+  }
+  if (config.iterations <= 0) {
+    throw std::invalid_argument("--iterations must be positive");
+  }
+  if (config.timeout <= 0) {
+    throw std::invalid_argument("--timeout must be positive");
+  }
+  if (config.poll_interval < 0) {
+    throw std::invalid_argument("--poll-interval must be >= 0");
+  }
+  return config;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) try {
+  auto const config = ParseConfig(argc, argv);
+  std::vector<Run> runs;
+  for (int i = 0; i != config.iterations; ++i) {
+    runs.push_back(RunOnce(config));
+  }
+  std::cout << Report(config, runs) << "\n";
+  return 0;
+} catch (std::exception const& ex) {
+  std::cerr << "Standard exception caught " << ex.what() << "\n";
+  return 1;
+}
@@ -0,0 +1,476 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// An open-loop HTTP load generator for the framework.
+//
+// Start a server, such as `echo_server` or `cloud_event_handler` from the
+// integration tests, then run:
+//
+//   load_generator --port=8080 --connections=64 --rate=20000 --duration=30
+//
+// Each connection sends its requests at a fixed rate, independently of the
+// responses. The latency is measured from the time a request was scheduled,
+// so a slow server does not reduce the load it is measured with. Use
+// `--rate=0` to send each request as soon as a connection can. The results
+// are printed as a JSON object.
+
+#include "google/cloud/functions/benchmarks/benchmark_report.h"
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace po = boost::program_options;
+using Clock = std::chrono::steady_clock;
+using Request = http::request<http::string_body>;
+using ::google::cloud::functions_benchmarks::JsonString;
+using ::google::cloud::functions_benchmarks::PercentileMicros;
+
+struct Config {
+  std::string host;
+  std::string port;
+  std::string target;
+  std::string mode;
+  std::size_t payload_size = 0;
+  int connections = 0;
+  int pipeline_depth = 0;
+  int threads = 0;
+  double rate = 0;
+  double warmup = 0;
+  double duration = 0;
+  double timeout = 0;
+};
+
+/// The requests completed by a connection during the measurement window.
+struct Results {
+  std::vector<std::int64_t> latencies;
+  std::map<unsigned, std::int64_t> status_codes;
+  std::int64_t errors = 0;
+};
+
+Request MakeRequest(Config const& config) {
+  Request request;
+  request.version(11);
+  request.target(config.target);
+  request.set(http::field::host, config.host + ":" + config.port);
+  request.set(http::field::user_agent, "functions-framework-cpp-load");
+  request.keep_alive(true);
+  if (config.mode == "cloud-event") {
+    request.method(http::verb::post);
+    request.set("ce-specversion", "1.0");
+    request.set("ce-type", "com.example.load");
+    request.set("ce-source", "//load-generator");
+    request.set("ce-id", "load");
+    request.set("ce-subject", "/load");
+    request.set(http::field::content_type, "application/json");
+    request.body() = R"js({"data": ")js" +
+                     std::string(config.payload_size, 'x') + R"js("})js";
+  } else if (config.payload_size != 0) {
+    request.method(http::verb::post);
+    request.set(http::field::content_type, "text/plain");
+    request.body() = std::string(config.payload_size, 'x');
+  } else {
+    request.method(http::verb::get);
+  }
+  request.prepare_payload();
+  return request;
+}
+
+/**
+ * Sends a request at each scheduled time, over one connection.
+ *
+ * Up to `pipeline_depth` requests are in flight, a request whose time
+ * arrives while the connection is full waits, and that wait counts as
+ * latency. After an error the in-flight requests are counted as errors and
+ * the connection is opened again. All the member functions run in the thread
+ * of the `io_context`.
+ */
+class Connection : public std::enable_shared_from_this<Connection> {
+ public:
+  struct Schedule {
+    Clock::time_point first;
+    Clock::duration interval;
+    Clock::time_point measure;
+    Clock::time_point end;
+  };
+
+  Connection(asio::io_context& io, Config const& config,
+             asio::ip::tcp::resolver::results_type endpoints,
+             Request const& request, Schedule schedule)
+      : stream_(io),
+        timer_(io),
+        endpoints_(std::move(endpoints)),
+        request_(request),
+        schedule_(schedule),
+        next_(schedule.first),
+        depth_(static_cast<std::size_t>(config.pipeline_depth)),
+        timeout_(std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(config.timeout))) {}
+
+  void Start() { Connect(); }
+
+  [[nodiscard]] Results const& results() const { return results_; }
+
+ private:
+  [[nodiscard]] bool open_loop() const {
+    return schedule_.interval != Clock::duration::zero();
+  }
+  [[nodiscard]] bool Measured(Clock::time_point scheduled) const {
+    return scheduled >= schedule_.measure;
+  }
+
+  void Connect() {
+    if (Clock::now() >= schedule_.end) return;
+    stream_.expires_after(timeout_);
+    stream_.async_connect(
+        endpoints_, [self = shared_from_this(), g = generation_](
+                        beast::error_code ec, auto const& /*endpoint*/) {
+          if (g != self->generation_) return;
+          self->OnConnect(ec);
+        });
+  }
+
+  void OnConnect(beast::error_code ec) {
+    if (ec) {
+      if (Measured(Clock::now())) ++results_.errors;
+      timer_armed_ = true;
+      timer_.expires_after(std::chrono::milliseconds(100));
+      timer_.async_wait(
+          [self = shared_from_this(), g = generation_](beast::error_code ec) {
+            if (ec || g != self->generation_) return;
+            self->timer_armed_ = false;
+            self->Connect();
+          });
+      return;
+    }
+    beast::error_code ignored;
+    stream_.socket().set_option(asio::ip::tcp::no_delay(true), ignored);
+    connected_ = true;
+    MaybeSend();
+  }
+
+  void MaybeSend() {
+    if (!connected_ || writing_ || timer_armed_) return;
+    if (inflight_.size() >= depth_) return;
+    auto const now = Clock::now();
+    if (!open_loop()) next_ = now;
+    if (next_ >= schedule_.end) {
+      if (inflight_.empty()) Close();
+      return;
+    }
+    if (next_ > now) {
+      timer_armed_ = true;
+      timer_.expires_at(next_);
+      timer_.async_wait(
+          [self = shared_from_this(), g = generation_](beast::error_code ec) {
+            if (ec || g != self->generation_) return;
+            self->timer_armed_ = false;
+            self->MaybeSend();
+          });
+      return;
+    }
+    writing_ = true;
+    inflight_.push_back(next_);
+    next_ += schedule_.interval;
+    stream_.expires_after(timeout_);
+    http::async_write(
+        stream_, request_,
+        [self = shared_from_this(), g = generation_](beast::error_code ec,
+                                                     std::size_t /*n*/) {
+          if (g != self->generation_) return;
+          self->OnWrite(ec);
+        });
+  }
+
+  void OnWrite(beast::error_code ec) {
+    writing_ = false;
+    if (ec) return OnError();
+    if (!reading_) Read();
+    MaybeSend();
+  }
+
+  void Read() {
+    reading_ = true;
+    response_ = {};
+    stream_.expires_after(timeout_);
+    http::async_read(
+        stream_, buffer_, response_,
+        [self = shared_from_this(), g = generation_](beast::error_code ec,
+                                                     std::size_t /*n*/) {
+          if (g != self->generation_) return;
+          self->OnRead(ec);
+        });
+  }
+
+  void OnRead(beast::error_code ec) {
+    reading_ = false;
+    if (ec) return OnError();
+    auto const scheduled = inflight_.front();
+    inflight_.pop_front();
+    if (Measured(scheduled)) {
+      results_.latencies.push_back(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                               scheduled)
+              .count());
+      ++results_.status_codes[response_.result_int()];
+    }
+    if (!response_.keep_alive()) {
+      for (auto s : inflight_) {
+        if (Measured(s)) ++results_.errors;
+      }
+      return Reconnect();
+    }
+    if (!inflight_.empty()) Read();
+    MaybeSend();
+  }
+
+  void OnError() {
+    for (auto s : inflight_) {
+      if (Measured(s)) ++results_.errors;
+    }
+    Reconnect();
+  }
+
+  void Reconnect() {
+    Close();
+    if (!open_loop()) next_ = Clock::now();
+    Connect();
+  }
+
+  void Close() {
+    ++generation_;
+    connected_ = false;
+    writing_ = false;
+    reading_ = false;
+    timer_armed_ = false;
+    inflight_.clear();
+    buffer_.consume(buffer_.size());
+    timer_.cancel();
+    stream_.close();
+  }
+
+  beast::tcp_stream stream_;
+  asio::steady_timer timer_;
+  asio::ip::tcp::resolver::results_type endpoints_;
+  Request const& request_;
+  Schedule schedule_;
+  Clock::time_point next_;
+  std::size_t depth_;
+  Clock::duration timeout_;
+  beast::flat_buffer buffer_;
+  http::response<http::string_body> response_;
+  std::deque<Clock::time_point> inflight_;
+  std::uint64_t generation_ = 0;
+  bool connected_ = false;
+  bool writing_ = false;
+  bool reading_ = false;
+  bool timer_armed_ = false;
+  Results results_;
+};
+
+std::string Report(Config const& config, Results results) {
+  auto& latencies = results.latencies;
+  std::sort(latencies.begin(), latencies.end());
+  auto const count = static_cast<std::int64_t>(latencies.size());
+  auto const mean =
+      latencies.empty()
+          ? 0.0
+          : static_cast<double>(std::accumulate(latencies.begin(),
+                                                latencies.end(),
+                                                std::int64_t{0})) /
+                static_cast<double>(count) / 1000.0;
+
+  std::ostringstream os;
+  os << "{\"host\": " << JsonString(config.host)
+     << ", \"port\": " << JsonString(config.port)
+     << ", \"target\": " << JsonString(config.target)
+     << ", \"mode\": " << JsonString(config.mode)
+     << ", \"payload_size\": " << config.payload_size
+     << ", \"connections\": " << config.connections
+     << ", \"pipeline_depth\": " << config.pipeline_depth
+     << ", \"threads\": " << config.threads << ", \"rate\": " << config.rate
+     << ", \"warmup_seconds\": " << config.warmup
+     << ", \"duration_seconds\": " << config.duration
+     << ", \"requests\": " << count << ", \"errors\": " << results.errors
+     << ", \"requests_per_second\": "
+     << static_cast<double>(count) / config.duration
+     << ", \"latency_us\": {\"min\": " << PercentileMicros(latencies, 0)
+     << ", \"mean\": " << mean
+     << ", \"p50\": " << PercentileMicros(latencies, 0.50)
+     << ", \"p90\": " << PercentileMicros(latencies, 0.90)
+     << ", \"p99\": " << PercentileMicros(latencies, 0.99)
+     << ", \"p999\": " << PercentileMicros(latencies, 0.999)
+     << ", \"max\": " << PercentileMicros(latencies, 1.0)
+     << "}, \"status_codes\": {";
+  char const* sep = "";
+  for (auto const& [code, n] : results.status_codes) {
+    os << sep << "\"" << code << "\": " << n;
+    sep = ", ";
+  }
+  os << "}}";
+  return std::move(os).str();
+}
+
+Config ParseConfig(int argc, char* argv[]) {
+  Config config;
+  po::options_description desc("Open-loop HTTP load generator");
+  desc.add_options()("help", "produce help message")
+      //
+      ("host", po::value(&config.host)->default_value("localhost"),
+       "the server host")
+      //
+      ("port", po::value(&config.port)->default_value("8080"),
+       "the server port")
+      //
+      ("target", po::value(&config.target)->default_value("/"),
+       "the request target")
+      //
+      ("mode", po::value(&config.mode)->default_value("http"),
+       "the request type, `http` or `cloud-event` (binary mode)")
+      //
+      ("payload-size", po::value(&config.payload_size)->default_value(0),
+       "the size of the request payload, a non-empty `http` payload is sent"
+       " with POST")
+      //
+      ("connections", po::value(&config.connections)->default_value(16),
+       "the number of connections")
+      //
+      ("pipeline-depth", po::value(&config.pipeline_depth)->default_value(1),
+       "the number of requests in flight on each connection")
+      //
+      ("threads", po::value(&config.threads)->default_value(1),
+       "the number of client threads")
+      //
+      ("rate", po::value(&config.rate)->default_value(0),
+       "the total requests per second, 0 to send as fast as possible")
+      //
+      ("warmup", po::value(&config.warmup)->default_value(2),
+       "the seconds before the measurements start")
+      //
+      ("duration", po::value(&config.duration)->default_value(10),
+       "the seconds to measure")
+      //
+      ("timeout", po::value(&config.timeout)->default_value(10),
+       "the seconds before an operation fails");
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  po::notify(vm);
+  if (vm.count("help") != 0) {
+    std::cout << desc << "\n";
+    std::exit(0);
+  }
+  if (config.mode != "http" && config.mode != "cloud-event") {
+    throw std::invalid_argument("--mode must be `http` or `cloud-event`");
+  }
+  if (config.connections <= 0) {
+    throw std::invalid_argument("--connections must be positive");
+  }
+  if (config.pipeline_depth <= 0) {
+    throw std::invalid_argument("--pipeline-depth must be positive");
+  }
+  if (config.threads <= 0) {
+    throw std::invalid_argument("--threads must be positive");
+  }
+  if (config.rate < 0) throw std::invalid_argument("--rate must be >= 0");
+  if (config.warmup < 0) throw std::invalid_argument("--warmup must be >= 0");
+  if (config.duration <= 0) {
+    throw std::invalid_argument("--duration must be positive");
+  }
+  if (config.timeout <= 0) {
+    throw std::invalid_argument("--timeout must be positive");
+  }
+  return config;
+}
+
+Clock::duration Seconds(double s) {
+  return std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(s));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) try {
+  auto const config = ParseConfig(argc, argv);
+  auto const request = MakeRequest(config);
+
+  std::vector<std::unique_ptr<asio::io_context>> contexts;
+  for (int i = 0; i != config.threads; ++i) {
+    contexts.push_back(std::make_unique<asio::io_context>(1));
+  }
+  auto endpoints = asio::ip::tcp::resolver(*contexts.front())
+                       .resolve(config.host, config.port);
+
+  // Each connection sends one of every `connections` requests, offset so
+  // the arrivals are evenly spaced.
+  auto const interval = config.rate == 0
+                            ? Clock::duration::zero()
+                            : Seconds(config.connections / config.rate);
+  auto const start = Clock::now();
+  auto const measure = start + Seconds(config.warmup);
+  auto const end = measure + Seconds(config.duration);
+  std::vector<std::shared_ptr<Connection>> connections;
+  for (int i = 0; i != config.connections; ++i) {
+    auto& io = *contexts[static_cast<std::size_t>(i % config.threads)];
+    auto const first = start + interval * i / config.connections;
+    connections.push_back(std::make_shared<Connection>(
+        io, config, endpoints, request,
+        Connection::Schedule{first, interval, measure, end}));
+    connections.back()->Start();
+  }
+
+  std::vector<std::thread> threads;
+  for (auto& io : contexts) {
+    threads.emplace_back([&io] { io->run(); });
+  }
+  for (auto& t : threads) t.join();
+
+  Results results;
+  for (auto const& c : connections) {
+    auto const& r = c->results();
+    results.latencies.insert(results.latencies.end(), r.latencies.begin(),
+                             r.latencies.end());
+    for (auto const& [code, n] : r.status_codes) {
+      results.status_codes[code] += n;
+    }
+    results.errors += r.errors;
+  }
+  std::cout << Report(config, std::move(results)) << "\n";
+  return 0;
+} catch (std::exception const& ex) {
+  std::cerr << "Standard exception caught " << ex.what() << "\n";
+  return 1;
+}
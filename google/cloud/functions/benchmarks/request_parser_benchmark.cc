@@ -0,0 +1,105 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/fast_request_parser.h"
+#include "google/cloud/functions/internal/http_message_types.h"
+#include <benchmark/benchmark.h>
+#include <boost/beast/http.hpp>
+#include <cstdint>
+#include <string>
+
+namespace {
+
+namespace be = ::boost::beast;
+namespace gcf_internal = ::google::cloud::functions_internal;
+using gcf_internal::BeastRequest;
+
+/// Runs with each combination of the header counts and body sizes.
+void HeadersAndBody(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"headers", "body"});
+  b->ArgsProduct({{0, 8, 32}, {0, 1024}});
+}
+
+/// A request as sent by a typical client, with some long header values.
+std::string MakeRequest(benchmark::State const& state) {
+  std::string request =
+      "POST /benchmark?foo=bar HTTP/1.1\r\nHost: localhost:8080\r\n"
+      "User-Agent: benchmark/1.0\r\nContent-Type: application/json\r\n";
+  for (std::int64_t i = 0; i != state.range(0); ++i) {
+    request += "x-benchmark-header-" + std::to_string(i) + ": " +
+               std::string(48, 'v') + "\r\n";
+  }
+  auto const body_size = static_cast<std::size_t>(state.range(1));
+  request += "Content-Length: " + std::to_string(body_size) + "\r\n\r\n";
+  request += std::string(body_size, 'x');
+  return request;
+}
+
+void SetBytesProcessed(benchmark::State& state, std::string const& request) {
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          static_cast<std::int64_t>(request.size()));
+}
+
+void BM_BeastParser(benchmark::State& state) {
+  auto const request = MakeRequest(state);
+  for (auto _ : state) {
+    be::http::parser<true, be::http::string_body,
+                     gcf_internal::FieldsAllocator<char>>
+        parser;
+    parser.eager(true);
+    be::error_code ec;
+    parser.put(be::net::buffer(request), ec);
+    benchmark::DoNotOptimize(parser.get());
+  }
+  SetBytesProcessed(state, request);
+}
+BENCHMARK(BM_BeastParser)->Apply(HeadersAndBody);
+
+void BM_FastParser(benchmark::State& state) {
+  auto const request = MakeRequest(state);
+  auto constexpr kLimits = gcf_internal::FastParseLimits{8 * 1024, 1 << 20};
+  for (auto _ : state) {
+    BeastRequest parsed;
+    auto n = gcf_internal::FastParseRequest(request, kLimits, parsed);
+    benchmark::DoNotOptimize(n);
+    benchmark::DoNotOptimize(parsed);
+  }
+  state.SetLabel(std::string(gcf_internal::FastParserInstructions()));
+  SetBytesProcessed(state, request);
+}
+BENCHMARK(BM_FastParser)->Apply(HeadersAndBody);
+
+/// The delimiter scan alone, for each implementation.
+void BM_FindLineDelimiter(benchmark::State& state,
+                          char const* (*find)(char const*, char const*, bool)) {
+  auto const line = std::string(static_cast<std::size_t>(state.range(0)), 'v');
+  for (auto _ : state) {
+    auto const* p = find(line.data(), line.data() + line.size(), false);
+    benchmark::DoNotOptimize(p);
+  }
+  SetBytesProcessed(state, line);
+}
+BENCHMARK_CAPTURE(BM_FindLineDelimiter, Portable,
+                  gcf_internal::FindLineDelimiterPortable)
+    ->Range(16, 4096);
+BENCHMARK_CAPTURE(BM_FindLineDelimiter, Sse42,
+                  gcf_internal::FindLineDelimiterSse42)
+    ->Range(16, 4096);
+BENCHMARK_CAPTURE(BM_FindLineDelimiter, Avx2,
+                  gcf_internal::FindLineDelimiterAvx2)
+    ->Range(16, 4096);
+
+}  // namespace
+
+BENCHMARK_MAIN();
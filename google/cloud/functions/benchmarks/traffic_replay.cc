@@ -0,0 +1,336 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Replays the requests in a capture file against a server.
+//
+// Capture a sample of the requests of a deployed function with
+// `--capture-file`, start a build of the function, then run:
+//
+//   traffic_replay --capture-file=requests.ffcap --port=8080 --speed=4
+//       --save-latencies=new.txt --baseline=old.txt
+//
+// Each request is sent at the time it arrived, divided by `--speed`, on the
+// first idle connection. The latency is measured from the time a request was
+// scheduled, so a request waiting for a connection counts that wait, as in an
+// open-loop benchmark. With `--baseline` the results include the latencies
+// of a previous replay, e.g. of the previous build, and the Kolmogorov-Smirnov
+// distance between the two distributions. The results are printed as a JSON
+// object.
+
+#include "google/cloud/functions/benchmarks/benchmark_report.h"
+#include "google/cloud/functions/internal/traffic_capture.h"
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace po = boost::program_options;
+namespace gcf_internal = ::google::cloud::functions_internal;
+using Clock = std::chrono::steady_clock;
+using Request = gcf_internal::BeastRequest;
+using ::google::cloud::functions_benchmarks::PercentileMicros;
+
+struct Config {
+  std::string capture_file;
+  std::string host;
+  std::string port;
+  int connections = 0;
+  double speed = 0;
+  std::string save_latencies;
+  std::string baseline;
+};
+
+struct ScheduledRequest {
+  Clock::duration offset;
+  Request request;
+};
+
+/// The latencies are in nanoseconds, in the order captured, -1 for errors.
+struct Results {
+  std::vector<std::int64_t> latencies;
+  std::map<unsigned, std::int64_t> status_codes;
+  Clock::duration elapsed{0};
+};
+
+std::vector<ScheduledRequest> LoadRequests(Config const& config) {
+  gcf_internal::TrafficCaptureReader reader(config.capture_file);
+  std::vector<ScheduledRequest> requests;
+  std::optional<std::chrono::nanoseconds> first;
+  while (auto captured = reader.Next()) {
+    if (!first) first = captured->offset;
+    auto offset = Clock::duration::zero();
+    if (config.speed > 0) {
+      offset = std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double, std::nano>(
+              static_cast<double>((captured->offset - *first).count()) /
+              config.speed));
+    }
+    auto request = gcf_internal::ToBeastRequest(*captured);
+    request.set(http::field::host, config.host + ":" + config.port);
+    request.keep_alive(true);
+    requests.push_back(ScheduledRequest{offset, std::move(request)});
+  }
+  return requests;
+}
+
+/**
+ * Sends the requests over one connection, one at a time.
+ *
+ * The connections take the next request to send from @p next, so a request
+ * waits only if all the connections are busy.
+ */
+void RunConnection(asio::ip::tcp::resolver::results_type const& endpoints,
+                   std::vector<ScheduledRequest> const& requests,
+                   Clock::time_point start, std::atomic<std::size_t>& next,
+                   Results& results, std::mutex& mu) {
+  asio::io_context io;
+  std::optional<beast::tcp_stream> stream;
+  beast::flat_buffer buffer;
+  for (auto i = next.fetch_add(1); i < requests.size(); i = next.fetch_add(1)) {
+    auto const scheduled = start + requests[i].offset;
+    std::this_thread::sleep_until(scheduled);
+    beast::error_code ec;
+    http::response<http::string_body> response;
+    for (int attempt = 0; attempt != 2; ++attempt) {
+      ec = {};
+      if (!stream) {
+        stream.emplace(io);
+        stream->connect(endpoints, ec);
+        if (ec) {
+          stream.reset();
+          continue;
+        }
+        stream->socket().set_option(asio::ip::tcp::no_delay(true), ec);
+      }
+      http::write(*stream, requests[i].request, ec);
+      if (!ec) http::read(*stream, buffer, response, ec);
+      if (!ec) break;
+      // The server may close an idle keep-alive connection, try once more.
+      stream.reset();
+      buffer.consume(buffer.size());
+    }
+    auto const latency = ec ? -1
+                            : std::chrono::duration_cast<
+                                  std::chrono::nanoseconds>(Clock::now() -
+                                                            scheduled)
+                                  .count();
+    if (!ec && !response.keep_alive()) stream.reset();
+    std::lock_guard<std::mutex> lk(mu);
+    results.latencies[i] = latency;
+    if (!ec) ++results.status_codes[response.result_int()];
+  }
+}
+
+Results Replay(Config const& config,
+               std::vector<ScheduledRequest> const& requests) {
+  asio::io_context io;
+  auto const endpoints =
+      asio::ip::tcp::resolver(io).resolve(config.host, config.port);
+  Results results;
+  results.latencies.resize(requests.size(), -1);
+  std::mutex mu;
+  std::atomic<std::size_t> next{0};
+  auto const start = Clock::now();
+  std::vector<std::thread> threads;
+  for (int i = 0; i != config.connections; ++i) {
+    threads.emplace_back([&] {
+      RunConnection(endpoints, requests, start, next, results, mu);
+    });
+  }
+  for (auto& t : threads) t.join();
+  results.elapsed = Clock::now() - start;
+  return results;
+}
+
+/// The latencies of the successful requests, sorted.
+std::vector<std::int64_t> Sorted(std::vector<std::int64_t> latencies) {
+  latencies.erase(std::remove(latencies.begin(), latencies.end(), -1),
+                  latencies.end());
+  std::sort(latencies.begin(), latencies.end());
+  return latencies;
+}
+
+/// The largest difference between the distributions of sorted @p a and @p b.
+double KolmogorovSmirnovDistance(std::vector<std::int64_t> const& a,
+                                 std::vector<std::int64_t> const& b) {
+  if (a.empty() || b.empty()) return 0;
+  auto const na = static_cast<double>(a.size());
+  auto const nb = static_cast<double>(b.size());
+  std::size_t i = 0;
+  std::size_t j = 0;
+  double distance = 0;
+  while (i != a.size() && j != b.size()) {
+    auto const value = std::min(a[i], b[j]);
+    while (i != a.size() && a[i] == value) ++i;
+    while (j != b.size() && b[j] == value) ++j;
+    distance = std::max(distance, std::abs(static_cast<double>(i) / na -
+                                           static_cast<double>(j) / nb));
+  }
+  return distance;
+}
+
+std::string LatencySummary(std::vector<std::int64_t> const& sorted) {
+  auto const mean =
+      sorted.empty()
+          ? 0.0
+          : static_cast<double>(std::accumulate(sorted.begin(), sorted.end(),
+                                                std::int64_t{0})) /
+                static_cast<double>(sorted.size()) / 1000.0;
+  std::ostringstream os;
+  os << "{\"min\": " << PercentileMicros(sorted, 0) << ", \"mean\": " << mean
+     << ", \"p50\": " << PercentileMicros(sorted, 0.50)
+     << ", \"p90\": " << PercentileMicros(sorted, 0.90)
+     << ", \"p99\": " << PercentileMicros(sorted, 0.99)
+     << ", \"p999\": " << PercentileMicros(sorted, 0.999)
+     << ", \"max\": " << PercentileMicros(sorted, 1.0) << "}";
+  return std::move(os).str();
+}
+
+std::vector<std::int64_t> LoadLatencies(std::string const& path) {
+  std::ifstream is(path);
+  if (!is) throw std::runtime_error("cannot open " + path);
+  std::vector<std::int64_t> latencies;
+  for (std::int64_t latency; is >> latency;) latencies.push_back(latency);
+  return latencies;
+}
+
+void SaveLatencies(std::string const& path,
+                   std::vector<std::int64_t> const& latencies) {
+  std::ofstream os(path, std::ios::trunc);
+  for (auto latency : latencies) os << latency << "\n";
+  if (!os.flush()) throw std::runtime_error("cannot write " + path);
+}
+
+std::string Report(Config const& config, Results const& results) {
+  auto const sorted = Sorted(results.latencies);
+  auto const count = static_cast<std::int64_t>(results.latencies.size());
+  auto const errors = count - static_cast<std::int64_t>(sorted.size());
+  auto const seconds =
+      std::chrono::duration<double>(results.elapsed).count();
+
+  std::ostringstream os;
+  os << "{\"capture_file\": \"" << config.capture_file << "\""
+     << ", \"connections\": " << config.connections
+     << ", \"speed\": " << config.speed << ", \"requests\": " << count
+     << ", \"errors\": " << errors << ", \"duration_seconds\": " << seconds
+     << ", \"requests_per_second\": "
+     << (seconds > 0 ? static_cast<double>(count) / seconds : 0.0)
+     << ", \"latency_us\": " << LatencySummary(sorted)
+     << ", \"status_codes\": {";
+  char const* sep = "";
+  for (auto const& [code, n] : results.status_codes) {
+    os << sep << "\"" << code << "\": " << n;
+    sep = ", ";
+  }
+  os << "}";
+  if (!config.baseline.empty()) {
+    auto const baseline = Sorted(LoadLatencies(config.baseline));
+    auto ratio = [&](double q) {
+      auto const b = PercentileMicros(baseline, q);
+      return b == 0 ? 0.0 : PercentileMicros(sorted, q) / b;
+    };
+    os << ", \"baseline\": {\"requests\": " << baseline.size()
+       << ", \"latency_us\": " << LatencySummary(baseline)
+       << ", \"p50_ratio\": " << ratio(0.50)
+       << ", \"p99_ratio\": " << ratio(0.99)
+       << ", \"ks_distance\": " << KolmogorovSmirnovDistance(sorted, baseline)
+       << "}";
+  }
+  os << "}";
+  return std::move(os).str();
+}
+
+Config ParseConfig(int argc, char* argv[]) {
+  Config config;
+  po::options_description desc("Replays captured requests against a server");
+  desc.add_options()("help", "produce help message")
+      //
+      ("capture-file", po::value(&config.capture_file),
+       "the requests to replay, written by a server with `--capture-file`")
+      //
+      ("host", po::value(&config.host)->default_value("localhost"),
+       "the server host")
+      //
+      ("port", po::value(&config.port)->default_value("8080"),
+       "the server port")
+      //
+      ("connections", po::value(&config.connections)->default_value(16),
+       "the number of connections, and of requests in flight")
+      //
+      ("speed", po::value(&config.speed)->default_value(1),
+       "send the requests this many times faster than captured, 0 to send"
+       " them as fast as possible")
+      //
+      ("save-latencies", po::value(&config.save_latencies),
+       "write the latency of each request to this file, in nanoseconds")
+      //
+      ("baseline", po::value(&config.baseline),
+       "compare the latencies to those saved by a previous replay");
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  po::notify(vm);
+  if (vm.count("help") != 0) {
+    std::cout << desc << "\n";
+    std::exit(0);
+  }
+  if (config.capture_file.empty()) {
+    throw std::invalid_argument("--capture-file is required");
+  }
+  if (config.connections <= 0) {
+    throw std::invalid_argument("--connections must be positive");
+  }
+  if (config.speed < 0) throw std::invalid_argument("--speed must be >= 0");
+  return config;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) try {
+  auto const config = ParseConfig(argc, argv);
+  auto const requests = LoadRequests(config);
+  auto const results = Replay(config, requests);
+  if (!config.save_latencies.empty()) {
+    SaveLatencies(config.save_latencies, results.latencies);
+  }
+  std::cout << Report(config, results) << "\n";
+  return 0;
+} catch (std::exception const& ex) {
+  std::cerr << "Standard exception caught " << ex.what() << "\n";
+  return 1;
+}
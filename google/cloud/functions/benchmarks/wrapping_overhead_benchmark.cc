@@ -0,0 +1,175 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/call_user_function.h"
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/wrap_request.h"
+#include "google/cloud/functions/internal/wrap_response.h"
+#include "google/cloud/functions/function.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <string>
+
+namespace {
+
+namespace gcf = ::google::cloud::functions;
+namespace gcf_internal = ::google::cloud::functions_internal;
+using gcf_internal::BeastRequest;
+
+/// Runs with each combination of the header counts and body sizes.
+void HeadersAndBody(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"headers", "body"});
+  b->ArgsProduct({{0, 8, 32}, {0, 1024, 64 * 1024}});
+}
+
+BeastRequest MakeRequest(benchmark::State const& state) {
+  BeastRequest request;
+  request.method(boost::beast::http::verb::post);
+  request.target("/benchmark?foo=bar");
+  request.version(11);
+  request.set("host", "localhost:8080");
+  for (std::int64_t i = 0; i != state.range(0); ++i) {
+    request.set("x-benchmark-header-" + std::to_string(i),
+                std::string(32, 'v'));
+  }
+  request.body() = std::string(static_cast<std::size_t>(state.range(1)), 'x');
+  request.prepare_payload();
+  return request;
+}
+
+void SetBytesProcessed(benchmark::State& state) {
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          state.range(1));
+}
+
+/// A no-op handler, it returns an empty response.
+gcf::HttpResponse NoOp(gcf::HttpRequest const& /*request*/) {
+  return gcf::HttpResponse{};
+}
+
+/// Echoes the body, with a few headers.
+gcf::HttpResponse Echo(gcf::HttpRequest const& request) {
+  return gcf::HttpResponse{}
+      .set_header("content-type", "text/plain")
+      .set_header("x-benchmark", "echo")
+      .set_payload(std::string(request.payload()));
+}
+
+/// The cost of copying a request, included in the other benchmarks.
+void BM_CopyBeastRequest(benchmark::State& state) {
+  auto const request = MakeRequest(state);
+  for (auto _ : state) {
+    auto copy = request;
+    benchmark::DoNotOptimize(copy);
+  }
+  SetBytesProcessed(state);
+}
+BENCHMARK(BM_CopyBeastRequest)->Apply(HeadersAndBody);
+
+void BM_MakeHttpRequest(benchmark::State& state) {
+  auto const request = MakeRequest(state);
+  for (auto _ : state) {
+    auto wrapped = gcf_internal::MakeHttpRequest(request);
+    benchmark::DoNotOptimize(wrapped);
+  }
+  SetBytesProcessed(state);
+}
+BENCHMARK(BM_MakeHttpRequest)->Apply(HeadersAndBody);
+
+/// Includes building the map returned by `HttpRequest::headers()`.
+void BM_MakeHttpRequestHeaders(benchmark::State& state) {
+  auto const request = MakeRequest(state);
+  for (auto _ : state) {
+    auto wrapped = gcf_internal::MakeHttpRequest(request);
+    benchmark::DoNotOptimize(wrapped.headers().size());
+  }
+  SetBytesProcessed(state);
+}
+BENCHMARK(BM_MakeHttpRequestHeaders)->Apply(HeadersAndBody);
+
+void BM_UnwrapResponse(benchmark::State& state) {
+  auto const payload =
+      std::string(static_cast<std::size_t>(state.range(1)), 'x');
+  for (auto _ : state) {
+    auto response = gcf::HttpResponse{};
+    for (std::int64_t i = 0; i != state.range(0); ++i) {
+      response.set_header("x-benchmark-header-" + std::to_string(i), "v");
+    }
+    response.set_payload(payload);
+    auto unwrapped = gcf_internal::UnwrapResponse::unwrap(std::move(response));
+    benchmark::DoNotOptimize(unwrapped);
+  }
+  SetBytesProcessed(state);
+}
+BENCHMARK(BM_UnwrapResponse)->Apply(HeadersAndBody);
+
+/// A `std::function` handler, called without the type-erased `Function`.
+void BM_CallUserFunction(benchmark::State& state) {
+  auto const request = MakeRequest(state);
+  gcf::UserHttpFunction const function = NoOp;
+  for (auto _ : state) {
+    auto response = gcf_internal::CallUserFunction(function, request);
+    benchmark::DoNotOptimize(response);
+  }
+  SetBytesProcessed(state);
+}
+BENCHMARK(BM_CallUserFunction)->Apply(HeadersAndBody);
+
+/// The handler the server calls, through the `Function` and its handler.
+void BM_FunctionHandler(benchmark::State& state) {
+  auto const request = MakeRequest(state);
+  auto const handler =
+      gcf_internal::FunctionImpl::GetImpl(gcf::MakeFunction(NoOp))
+          ->GetHandler(request.target());
+  for (auto _ : state) {
+    auto response = handler(request);
+    benchmark::DoNotOptimize(response);
+  }
+  SetBytesProcessed(state);
+}
+BENCHMARK(BM_FunctionHandler)->Apply(HeadersAndBody);
+
+/// As above, with a function created by the `MakeFunction()` template.
+void BM_FunctionHandlerTyped(benchmark::State& state) {
+  auto const request = MakeRequest(state);
+  auto const handler = gcf_internal::FunctionImpl::GetImpl(
+                           gcf::MakeFunction([](gcf::HttpRequest const& r) {
+                             return NoOp(r);
+                           }))
+                           ->GetHandler(request.target());
+  for (auto _ : state) {
+    auto response = handler(request);
+    benchmark::DoNotOptimize(response);
+  }
+  SetBytesProcessed(state);
+}
+BENCHMARK(BM_FunctionHandlerTyped)->Apply(HeadersAndBody);
+
+/// A handler that copies the body into the response.
+void BM_FunctionHandlerEcho(benchmark::State& state) {
+  auto const request = MakeRequest(state);
+  auto const handler =
+      gcf_internal::FunctionImpl::GetImpl(gcf::MakeFunction(Echo))
+          ->GetHandler(request.target());
+  for (auto _ : state) {
+    auto response = handler(request);
+    benchmark::DoNotOptimize(response);
+  }
+  SetBytesProcessed(state);
+}
+BENCHMARK(BM_FunctionHandlerEcho)->Apply(HeadersAndBody);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,46 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/body_checksums.h"
+#include "google/cloud/functions/internal/base64_decode.h"
+#include <string_view>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+std::string ToGoogHash(BodyChecksums const& checksums) {
+  std::string value;
+  if (checksums.crc32c) {
+    // The CRC32C is encoded in big-endian order.
+    auto const crc = *checksums.crc32c;
+    char const bytes[] = {static_cast<char>(crc >> 24),
+                          static_cast<char>(crc >> 16),
+                          static_cast<char>(crc >> 8), static_cast<char>(crc)};
+    value += "crc32c=";
+    functions_internal::Base64Encode(std::string_view(bytes, sizeof(bytes)),
+                                     value);
+  }
+  if (checksums.md5) {
+    if (!value.empty()) value += ",";
+    value += "md5=";
+    functions_internal::Base64Encode(
+        std::string_view(reinterpret_cast<char const*>(checksums.md5->data()),
+                         checksums.md5->size()),
+        value);
+  }
+  return value;
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
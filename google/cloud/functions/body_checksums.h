@@ -0,0 +1,50 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_BODY_CHECKSUMS_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_BODY_CHECKSUMS_H
+
+#include "google/cloud/functions/version.h"
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * The checksums of a request body, see `HttpRequest::body_checksums()`.
+ *
+ * Only the algorithms enabled with `--request-checksums` are computed.
+ */
+struct BodyChecksums {
+  /// The CRC32C (Castagnoli) of the body.
+  std::optional<std::uint32_t> crc32c;
+  /// The MD5 digest of the body.
+  std::optional<std::array<std::uint8_t, 16>> md5;
+};
+
+/**
+ * Formats @p checksums as an `x-goog-hash` header value.
+ *
+ * For example `crc32c=4waSgw==,md5=JfnnlDI7RTiF9RgfG2JNCw==`, in the format
+ * Cloud Storage expects in uploads, and returns in downloads.
+ */
+std::string ToGoogHash(BodyChecksums const& checksums);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_BODY_CHECKSUMS_H
@@ -0,0 +1,39 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/body_checksums.h"
+#include <gmock/gmock.h>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+TEST(BodyChecksumsTest, ToGoogHash) {
+  // The CRC32C and MD5 of "123456789".
+  BodyChecksums checksums;
+  EXPECT_EQ(ToGoogHash(checksums), "");
+  checksums.crc32c = 0xe3069283;
+  EXPECT_EQ(ToGoogHash(checksums), "crc32c=4waSgw==");
+  checksums.md5 = std::array<std::uint8_t, 16>{
+      0x25, 0xf9, 0xe7, 0x94, 0x32, 0x3b, 0x45, 0x38,
+      0x85, 0xf5, 0x18, 0x1f, 0x1b, 0x62, 0x4d, 0x0b};
+  EXPECT_EQ(ToGoogHash(checksums),
+            "crc32c=4waSgw==,md5=JfnnlDI7RTiF9RgfG2JNCw==");
+  checksums.crc32c.reset();
+  EXPECT_EQ(ToGoogHash(checksums), "md5=JfnnlDI7RTiF9RgfG2JNCw==");
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
@@ -0,0 +1,83 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/byte_range_response.h"
+#include "google/cloud/functions/internal/byte_ranges.h"
+#include "google/cloud/functions/internal/wrap_response.h"
+#include <boost/beast/http/field.hpp>
+#include <string_view>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+HttpResponse MakeByteRangeResponse(HttpRequest const& request,
+                                   std::uint64_t size,
+                                   ByteRangeReadFunction const& read,
+                                   ByteRangeResponseOptions const& options) {
+  namespace http = ::boost::beast::http;
+  using functions_internal::ByteRange;
+
+  HttpResponse response;
+  auto set_header = [&response](http::field name, std::string_view value) {
+    functions_internal::UnwrapResponse::set_header(response, name, value);
+  };
+  set_header(http::field::accept_ranges, "bytes");
+  if (!options.etag.empty()) set_header(http::field::etag, options.etag);
+  if (!options.last_modified.empty()) {
+    set_header(http::field::last_modified, options.last_modified);
+  }
+  auto full = [&] {
+    if (!options.content_type.empty()) {
+      set_header(http::field::content_type, options.content_type);
+    }
+    response.set_payload(size == 0 ? std::string{} : read(0, size));
+    return std::move(response);
+  };
+
+  auto const range = request.header("range");
+  if (request.verb_view() != "GET" || !range) return full();
+  auto const if_range = request.header("if-range");
+  if (if_range && !functions_internal::IfRangeMatches(
+                      *if_range, options.etag, options.last_modified)) {
+    return full();
+  }
+  auto const ranges = functions_internal::ParseByteRanges(*range, size);
+  if (!ranges) return full();
+  if (ranges->empty()) {
+    response.set_result(HttpResponse::kRangeNotSatisfiable);
+    set_header(http::field::content_range, "bytes */" + std::to_string(size));
+    return response;
+  }
+  response.set_result(HttpResponse::kPartialContent);
+  if (ranges->size() == 1) {
+    auto const r = ranges->front();
+    if (!options.content_type.empty()) {
+      set_header(http::field::content_type, options.content_type);
+    }
+    set_header(http::field::content_range,
+               functions_internal::ContentRange(r, size));
+    response.set_payload(read(r.offset, r.size));
+    return response;
+  }
+  auto const boundary = functions_internal::MakeByteRangesBoundary();
+  set_header(http::field::content_type,
+             "multipart/byteranges; boundary=" + boundary);
+  response.set_payload(functions_internal::MakeMultipartByteRanges(
+      boundary, options.content_type, *ranges, size,
+      [&read](ByteRange r) { return read(r.offset, r.size); }));
+  return response;
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
@@ -0,0 +1,80 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_BYTE_RANGE_RESPONSE_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_BYTE_RANGE_RESPONSE_H
+
+#include "google/cloud/functions/http_request.h"
+#include "google/cloud/functions/http_response.h"
+#include "google/cloud/functions/version.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// Configures `MakeByteRangeResponse()`.
+struct ByteRangeResponseOptions {
+  /// The media type of the full content, e.g. `video/mp4`.
+  std::string content_type;
+  /**
+   * The strong entity tag of the content, including the quotes, if any.
+   *
+   * Requests with an `If-Range` header only get ranges if it matches this
+   * tag, or `last_modified`, otherwise they get the full content.
+   */
+  std::string etag;
+  /// The `Last-Modified` date of the content, in the HTTP date format.
+  std::string last_modified;
+};
+
+/// Returns @p length bytes of the content, starting at @p offset.
+using ByteRangeReadFunction =
+    std::function<std::string(std::uint64_t offset, std::uint64_t length)>;
+
+/**
+ * Answers the `Range` header of @p request, reading only the requested bytes.
+ *
+ * Use this for generated or remote content that is expensive to produce in
+ * full, e.g. a slice of a large object. The content has @p size bytes, and
+ * @p read is only called for the ranges sent: a single range gets a `206
+ * Partial Content` response, several ranges a `multipart/byteranges` body, and
+ * ranges outside the content `416 Range Not Satisfiable`. Requests without a
+ * valid `Range` header, a stale `If-Range`, or another method than `GET` get
+ * the full content. Exceptions thrown by @p read propagate to the caller.
+ *
+ * @par Example
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * gcf::HttpResponse Video(gcf::HttpRequest const& request) {
+ *   auto const object = LookupObject(request.path());
+ *   return gcf::MakeByteRangeResponse(
+ *       request, object.size,
+ *       [&](std::uint64_t offset, std::uint64_t length) {
+ *         return object.Read(offset, length);
+ *       },
+ *       {"video/mp4", object.etag, {}});
+ * }
+ * @endcode
+ */
+HttpResponse MakeByteRangeResponse(
+    HttpRequest const& request, std::uint64_t size,
+    ByteRangeReadFunction const& read,
+    ByteRangeResponseOptions const& options = {});
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_BYTE_RANGE_RESPONSE_H
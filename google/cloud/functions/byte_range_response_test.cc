@@ -0,0 +1,128 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/byte_range_response.h"
+#include <gmock/gmock.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::Optional;
+using ::testing::StartsWith;
+
+auto constexpr kContent = "0123456789";
+
+class ByteRangeResponseTest : public ::testing::Test {
+ protected:
+  HttpResponse Call(HttpRequest const& request,
+                    ByteRangeResponseOptions const& options = {}) {
+    return MakeByteRangeResponse(
+        request, 10,
+        [this](std::uint64_t offset, std::uint64_t length) {
+          reads_.emplace_back(offset, length);
+          return std::string(kContent).substr(offset, length);
+        },
+        options);
+  }
+
+  std::vector<std::pair<std::uint64_t, std::uint64_t>> reads_;
+};
+
+TEST_F(ByteRangeResponseTest, FullContent) {
+  auto response = Call(HttpRequest{}.set_verb("GET"), {"text/plain", {}, {}});
+  EXPECT_EQ(response.result(), HttpResponse::kOkay);
+  EXPECT_EQ(response.payload(), kContent);
+  EXPECT_THAT(response.header("accept-ranges"), Optional(std::string("bytes")));
+  EXPECT_THAT(response.header("content-type"),
+              Optional(std::string("text/plain")));
+  EXPECT_THAT(reads_, ElementsAre(std::make_pair(0, 10)));
+}
+
+TEST_F(ByteRangeResponseTest, SingleRange) {
+  auto response = Call(HttpRequest{}.set_verb("GET").add_header(
+      "Range", "bytes=-3"));
+  EXPECT_EQ(response.result(), HttpResponse::kPartialContent);
+  EXPECT_EQ(response.payload(), "789");
+  EXPECT_THAT(response.header("content-range"),
+              Optional(std::string("bytes 7-9/10")));
+  // Only the requested bytes are read.
+  EXPECT_THAT(reads_, ElementsAre(std::make_pair(7, 3)));
+}
+
+TEST_F(ByteRangeResponseTest, MultipleRanges) {
+  auto response = Call(
+      HttpRequest{}.set_verb("GET").add_header("Range", "bytes=0-1,5-6"),
+      {"text/plain", {}, {}});
+  EXPECT_EQ(response.result(), HttpResponse::kPartialContent);
+  EXPECT_THAT(std::string(response.header("content-type").value_or("")),
+              StartsWith("multipart/byteranges; boundary="));
+  EXPECT_THAT(response.payload(),
+              HasSubstr("Content-Type: text/plain\r\n"
+                        "Content-Range: bytes 5-6/10\r\n\r\n56\r\n"));
+  EXPECT_THAT(reads_,
+              ElementsAre(std::make_pair(0, 2), std::make_pair(5, 2)));
+}
+
+TEST_F(ByteRangeResponseTest, NotSatisfiable) {
+  auto response = Call(
+      HttpRequest{}.set_verb("GET").add_header("Range", "bytes=10-"));
+  EXPECT_EQ(response.result(), HttpResponse::kRangeNotSatisfiable);
+  EXPECT_THAT(response.header("content-range"),
+              Optional(std::string("bytes */10")));
+  EXPECT_TRUE(response.payload().empty());
+  EXPECT_TRUE(reads_.empty());
+}
+
+TEST_F(ByteRangeResponseTest, IfRange) {
+  ByteRangeResponseOptions options{"text/plain", R"("v1")", {}};
+  auto response = Call(HttpRequest{}
+                           .set_verb("GET")
+                           .add_header("Range", "bytes=0-0")
+                           .add_header("If-Range", R"("v1")"),
+                       options);
+  EXPECT_EQ(response.result(), HttpResponse::kPartialContent);
+  EXPECT_THAT(response.header("etag"), Optional(std::string(R"("v1")")));
+
+  response = Call(HttpRequest{}
+                      .set_verb("GET")
+                      .add_header("Range", "bytes=0-0")
+                      .add_header("If-Range", R"("v0")"),
+                  options);
+  EXPECT_EQ(response.result(), HttpResponse::kOkay);
+  EXPECT_EQ(response.payload(), kContent);
+}
+
+TEST_F(ByteRangeResponseTest, IgnoredRange) {
+  auto response = Call(
+      HttpRequest{}.set_verb("POST").add_header("Range", "bytes=0-0"));
+  EXPECT_EQ(response.result(), HttpResponse::kOkay);
+  response = Call(
+      HttpRequest{}.set_verb("GET").add_header("Range", "bytes=invalid"));
+  EXPECT_EQ(response.result(), HttpResponse::kOkay);
+  EXPECT_EQ(response.payload(), kContent);
+  response =
+      Call(HttpRequest{}.set_verb("GET").add_header("Range", "bytes="));
+  EXPECT_EQ(response.result(), HttpResponse::kOkay);
+  EXPECT_EQ(response.payload(), kContent);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
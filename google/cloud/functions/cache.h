@@ -0,0 +1,331 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CACHE_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CACHE_H
+
+#include "google/cloud/functions/internal/cache_base.h"
+#include "google/cloud/functions/version.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// Configure a `Cache`.
+struct CacheOptions {
+  /// If not empty, `/metrics` reports the statistics with this `cache` label.
+  std::string name;
+  /// The maximum number of entries.
+  std::size_t max_entries = 10000;
+  /// If not 0, the maximum total weight of the entries, see `Cache::Weigher`.
+  std::size_t max_weight = 0;
+  /// How long the entries are valid, 0 keeps them until they are evicted.
+  std::chrono::steady_clock::duration ttl = std::chrono::minutes(5);
+  /// The number of shards, each with its own lock.
+  std::size_t shards = 16;
+};
+
+/// The statistics of a `Cache`, the counters are totals since it was created.
+struct CacheStats {
+  /// The lookups that found a valid entry.
+  std::uint64_t hits = 0;
+  /// The lookups that did not, including those waiting for a load.
+  std::uint64_t misses = 0;
+  /// The calls to the loaders of `GetOrLoad()`, and those that threw.
+  std::uint64_t loads = 0;
+  std::uint64_t load_failures = 0;
+  /// The entries removed to stay within the limits.
+  std::uint64_t evictions = 0;
+  /// The entries removed once their time to live passed.
+  std::uint64_t expirations = 0;
+  /// The current number of entries, and their total weight.
+  std::size_t entries = 0;
+  std::size_t weight = 0;
+};
+
+/**
+ * A sharded, bounded, in-memory cache with a time to live.
+ *
+ * Use it to keep data across requests, such as the result of authorization
+ * lookups, configuration rows, or validated tokens. The entries are spread
+ * over `options.shards` shards by the hash of their key, each with its own
+ * lock, so concurrent requests rarely contend. Each shard keeps up to its
+ * share of `options.max_entries` (and `options.max_weight`), evicting its
+ * least recently used entries first. Expired entries are removed when they
+ * are looked up, or evicted.
+ *
+ * The values are shared, and immutable: lookups return a
+ * `std::shared_ptr<V const>` that remains valid after the entry is evicted.
+ * `GetOrLoad()` loads the missing values, concurrent lookups of the same key
+ * wait for a single load.
+ *
+ * Define the caches with static storage duration, or keep them in the state
+ * of the function. Give them a name to export their statistics in the server
+ * metrics, see `--metrics`.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * gcf::Cache<std::string, Permissions> permissions(
+ *     gcf::CacheOptions{"permissions", 50000});
+ *
+ * gcf::HttpResponse Handler(gcf::HttpRequest const& request) {
+ *   auto const user = UserName(request);
+ *   auto p = permissions.GetOrLoad(user, [&] { return Lookup(user); });
+ *   ...
+ * }
+ * @endcode
+ */
+template <typename K, typename V, typename Hash = std::hash<K>,
+          typename KeyEqual = std::equal_to<K>>
+class Cache : private functions_internal::CacheBase {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using ValuePtr = std::shared_ptr<V const>;
+  /// Returns the weight of an entry, such as its size in bytes.
+  using Weigher = std::function<std::size_t(K const&, V const&)>;
+
+  /**
+   * Creates a cache.
+   *
+   * Without a @p weigher all the entries weigh 1, and `options.max_weight`
+   * is another limit on the number of entries.
+   */
+  explicit Cache(CacheOptions options = {}, Weigher weigher = {})
+      : CacheBase(std::move(options.name)),
+        ttl_(options.ttl),
+        weigher_(std::move(weigher)),
+        shard_count_(std::clamp(options.shards, std::size_t{1},
+                                std::max(options.max_entries, std::size_t{1}))),
+        shards_(std::make_unique<Shard[]>(shard_count_)) {
+    // Each shard gets its share of the limits, the shares add up to them.
+    auto share = [this](std::size_t total, std::size_t i) {
+      return total / shard_count_ + (i < total % shard_count_ ? 1 : 0);
+    };
+    for (std::size_t i = 0; i != shard_count_; ++i) {
+      shards_[i].max_entries =
+          std::max(share(options.max_entries, i), std::size_t{1});
+      shards_[i].max_weight = share(options.max_weight, i);
+    }
+    Register();
+  }
+
+  ~Cache() { Unregister(); }
+
+  /// Returns the value of @p key, or null if it is missing or expired.
+  ValuePtr Get(K const& key) {
+    auto& shard = ShardFor(key);
+    auto const now = Now();
+    std::lock_guard<std::mutex> lk(shard.mu);
+    auto value = Find(shard, key, now);
+    ++(value ? shard.stats.hits : shard.stats.misses);
+    return value;
+  }
+
+  /// Sets the value of @p key, replacing any previous value.
+  void Put(K key, V value) {
+    auto v = std::make_shared<V const>(std::move(value));
+    auto const weight = Weigh(key, *v);
+    auto& shard = ShardFor(key);
+    auto const now = Now();
+    std::lock_guard<std::mutex> lk(shard.mu);
+    Insert(shard, std::move(key), std::move(v), weight, now);
+  }
+
+  /**
+   * Returns the value of @p key, calling @p loader to create it if needed.
+   *
+   * @p loader returns the value, it runs without holding any lock. The
+   * concurrent lookups of the same key wait for it, instead of calling their
+   * own loaders. If @p loader throws, these lookups get the exception, and
+   * nothing is cached. @p loader must not look up the same key.
+   */
+  template <typename Loader>
+  ValuePtr GetOrLoad(K const& key, Loader&& loader) {
+    static_assert(std::is_invocable_r_v<V, Loader&>,
+                  "the loader must return the value of the key");
+    auto& shard = ShardFor(key);
+    std::promise<ValuePtr> promise;
+    {
+      std::unique_lock<std::mutex> lk(shard.mu);
+      if (auto value = Find(shard, key, Now())) {
+        ++shard.stats.hits;
+        return value;
+      }
+      ++shard.stats.misses;
+      auto const l = shard.loading.find(key);
+      if (l != shard.loading.end()) {
+        auto pending = l->second;
+        lk.unlock();
+        return pending.get();
+      }
+      ++shard.stats.loads;
+      shard.loading.emplace(key, promise.get_future().share());
+    }
+    ValuePtr value;
+    try {
+      value = std::make_shared<V const>(loader());
+    } catch (...) {
+      {
+        std::lock_guard<std::mutex> lk(shard.mu);
+        shard.loading.erase(key);
+        ++shard.stats.load_failures;
+      }
+      promise.set_exception(std::current_exception());
+      throw;
+    }
+    auto const weight = Weigh(key, *value);
+    {
+      auto const now = Now();
+      std::lock_guard<std::mutex> lk(shard.mu);
+      shard.loading.erase(key);
+      Insert(shard, key, value, weight, now);
+    }
+    promise.set_value(value);
+    return value;
+  }
+
+  /// Removes @p key, if present. A load in progress still caches its value.
+  void Erase(K const& key) {
+    auto& shard = ShardFor(key);
+    std::lock_guard<std::mutex> lk(shard.mu);
+    auto const i = shard.index.find(key);
+    if (i != shard.index.end()) Remove(shard, i);
+  }
+
+  /// Removes all the entries.
+  void Clear() {
+    for (std::size_t i = 0; i != shard_count_; ++i) {
+      auto& shard = shards_[i];
+      std::lock_guard<std::mutex> lk(shard.mu);
+      shard.index.clear();
+      shard.lru.clear();
+      shard.weight = 0;
+    }
+  }
+
+  [[nodiscard]] CacheStats stats() const override {
+    CacheStats total;
+    for (std::size_t i = 0; i != shard_count_; ++i) {
+      auto const& shard = shards_[i];
+      std::lock_guard<std::mutex> lk(shard.mu);
+      total.hits += shard.stats.hits;
+      total.misses += shard.stats.misses;
+      total.loads += shard.stats.loads;
+      total.load_failures += shard.stats.load_failures;
+      total.evictions += shard.stats.evictions;
+      total.expirations += shard.stats.expirations;
+      total.entries += shard.lru.size();
+      total.weight += shard.weight;
+    }
+    return total;
+  }
+
+ private:
+  struct Item {
+    K key;
+    ValuePtr value;
+    Clock::time_point expires;
+    std::size_t weight;
+  };
+  using List = std::list<Item>;
+
+  /// Each shard is aligned, so the locks of different shards do not share
+  /// cache lines.
+  struct alignas(64) Shard {
+    mutable std::mutex mu;
+    /// The most recently used entries first.
+    List lru;
+    std::unordered_map<K, typename List::iterator, Hash, KeyEqual> index;
+    std::unordered_map<K, std::shared_future<ValuePtr>, Hash, KeyEqual>
+        loading;
+    std::size_t weight = 0;
+    std::size_t max_entries = 1;
+    /// If not 0, the limit of `weight`.
+    std::size_t max_weight = 0;
+    CacheStats stats;
+  };
+
+  /// The entries never expire with a 0 time to live, the clock is not read.
+  [[nodiscard]] Clock::time_point Now() const {
+    return ttl_ == Clock::duration::zero() ? Clock::time_point{}
+                                           : Clock::now();
+  }
+
+  Shard& ShardFor(K const& key) {
+    auto const h = static_cast<std::uint64_t>(hash_(key));
+    // Mix the hash, the maps in the shards use its low bits too.
+    return shards_[((h * 0x9e3779b97f4a7c15ULL) >> 32) % shard_count_];
+  }
+
+  std::size_t Weigh(K const& key, V const& value) const {
+    return weigher_ ? weigher_(key, value) : 1;
+  }
+
+  ValuePtr Find(Shard& shard, K const& key, Clock::time_point now) {
+    auto const i = shard.index.find(key);
+    if (i == shard.index.end()) return nullptr;
+    auto const item = i->second;
+    if (ttl_ != Clock::duration::zero() && item->expires <= now) {
+      ++shard.stats.expirations;
+      Remove(shard, i);
+      return nullptr;
+    }
+    shard.lru.splice(shard.lru.begin(), shard.lru, item);
+    return item->value;
+  }
+
+  void Insert(Shard& shard, K key, ValuePtr value, std::size_t weight,
+              Clock::time_point now) {
+    auto const i = shard.index.find(key);
+    if (i != shard.index.end()) Remove(shard, i);
+    shard.lru.push_front(Item{key, std::move(value), now + ttl_, weight});
+    shard.index.emplace(std::move(key), shard.lru.begin());
+    shard.weight += weight;
+    while (!shard.lru.empty() &&
+           (shard.lru.size() > shard.max_entries ||
+            (shard.max_weight != 0 && shard.weight > shard.max_weight))) {
+      ++shard.stats.evictions;
+      Remove(shard, shard.index.find(shard.lru.back().key));
+    }
+  }
+
+  void Remove(Shard& shard, typename decltype(Shard::index)::iterator i) {
+    shard.weight -= i->second->weight;
+    shard.lru.erase(i->second);
+    shard.index.erase(i);
+  }
+
+  Clock::duration const ttl_;
+  Weigher const weigher_;
+  Hash hash_;
+  std::size_t const shard_count_;
+  std::unique_ptr<Shard[]> shards_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CACHE_H
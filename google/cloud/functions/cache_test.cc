@@ -0,0 +1,227 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/cache.h"
+#include "google/cloud/functions/internal/cache_base.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::Contains;
+using ::testing::Key;
+using ::testing::Not;
+
+CacheOptions Options(std::size_t max_entries, std::size_t shards = 1) {
+  CacheOptions options;
+  options.max_entries = max_entries;
+  options.shards = shards;
+  return options;
+}
+
+TEST(CacheTest, GetAndPut) {
+  Cache<std::string, int> cache(Options(100, 4));
+  EXPECT_EQ(cache.Get("a"), nullptr);
+  cache.Put("a", 1);
+  cache.Put("b", 2);
+  ASSERT_NE(cache.Get("a"), nullptr);
+  EXPECT_EQ(*cache.Get("a"), 1);
+  cache.Put("a", 3);
+  EXPECT_EQ(*cache.Get("a"), 3);
+  EXPECT_EQ(*cache.Get("b"), 2);
+  cache.Erase("b");
+  EXPECT_EQ(cache.Get("b"), nullptr);
+
+  auto const stats = cache.stats();
+  EXPECT_EQ(stats.hits, 4);
+  EXPECT_EQ(stats.misses, 2);
+  EXPECT_EQ(stats.entries, 1);
+  cache.Clear();
+  EXPECT_EQ(cache.Get("a"), nullptr);
+  EXPECT_EQ(cache.stats().entries, 0);
+}
+
+TEST(CacheTest, EvictsLeastRecentlyUsed) {
+  Cache<int, int> cache(Options(3));
+  cache.Put(1, 1);
+  cache.Put(2, 2);
+  cache.Put(3, 3);
+  // Using 1 makes 2 the least recently used entry.
+  EXPECT_NE(cache.Get(1), nullptr);
+  cache.Put(4, 4);
+  EXPECT_EQ(cache.Get(2), nullptr);
+  EXPECT_NE(cache.Get(1), nullptr);
+  EXPECT_NE(cache.Get(3), nullptr);
+  EXPECT_NE(cache.Get(4), nullptr);
+  EXPECT_EQ(cache.stats().evictions, 1);
+  EXPECT_EQ(cache.stats().entries, 3);
+}
+
+TEST(CacheTest, ValuesOutliveEviction) {
+  Cache<int, std::string> cache(Options(1));
+  cache.Put(1, "one");
+  auto const value = cache.Get(1);
+  cache.Put(2, "two");
+  EXPECT_EQ(cache.Get(1), nullptr);
+  EXPECT_EQ(*value, "one");
+}
+
+TEST(CacheTest, MaxWeight) {
+  auto options = Options(100);
+  options.max_weight = 10;
+  Cache<int, std::string> cache(
+      options, [](int, std::string const& v) { return v.size(); });
+  cache.Put(1, "12345");
+  cache.Put(2, "1234");
+  EXPECT_EQ(cache.stats().weight, 9);
+  cache.Put(3, "12");
+  EXPECT_EQ(cache.Get(1), nullptr);
+  EXPECT_EQ(cache.stats().weight, 6);
+  // Values heavier than the limit are not kept.
+  cache.Put(4, "12345678901");
+  EXPECT_EQ(cache.Get(4), nullptr);
+  EXPECT_EQ(cache.stats().weight, 0);
+}
+
+TEST(CacheTest, Expiration) {
+  auto options = Options(100);
+  options.ttl = std::chrono::milliseconds(1);
+  Cache<int, int> cache(options);
+  cache.Put(1, 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(cache.Get(1), nullptr);
+  EXPECT_EQ(cache.stats().expirations, 1);
+  EXPECT_EQ(cache.stats().entries, 0);
+
+  options.ttl = std::chrono::seconds(0);
+  Cache<int, int> forever(options);
+  forever.Put(1, 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_NE(forever.Get(1), nullptr);
+}
+
+TEST(CacheTest, GetOrLoad) {
+  Cache<std::string, std::string> cache(Options(100, 4));
+  auto loads = 0;
+  auto loader = [&loads] {
+    ++loads;
+    return std::string("loaded");
+  };
+  EXPECT_EQ(*cache.GetOrLoad("a", loader), "loaded");
+  EXPECT_EQ(*cache.GetOrLoad("a", loader), "loaded");
+  EXPECT_EQ(loads, 1);
+  auto const stats = cache.stats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.loads, 1);
+}
+
+TEST(CacheTest, GetOrLoadFailure) {
+  Cache<int, int> cache(Options(100));
+  EXPECT_THROW(cache.GetOrLoad(1, []() -> int {
+    throw std::runtime_error("unavailable");
+  }),
+               std::runtime_error);
+  EXPECT_EQ(cache.Get(1), nullptr);
+  EXPECT_EQ(cache.stats().load_failures, 1);
+  // The next lookup tries again.
+  EXPECT_EQ(*cache.GetOrLoad(1, [] { return 42; }), 42);
+}
+
+TEST(CacheTest, GetOrLoadSingleFlight) {
+  Cache<int, int> cache(Options(100));
+  std::promise<void> started;
+  std::promise<void> release;
+  std::atomic<int> loads{0};
+  auto loader = [&] {
+    ++loads;
+    started.set_value();
+    release.get_future().wait();
+    return 7;
+  };
+  auto first = std::async(std::launch::async,
+                          [&] { return *cache.GetOrLoad(1, loader); });
+  started.get_future().wait();
+  std::vector<std::future<int>> waiters;
+  for (int i = 0; i != 4; ++i) {
+    waiters.push_back(std::async(std::launch::async, [&] {
+      return *cache.GetOrLoad(1, [&] {
+        ++loads;
+        return 0;
+      });
+    }));
+  }
+  // Wait until all the lookups are waiting for the load.
+  while (cache.stats().misses != 5) std::this_thread::yield();
+  release.set_value();
+  EXPECT_EQ(first.get(), 7);
+  for (auto& w : waiters) EXPECT_EQ(w.get(), 7);
+  EXPECT_EQ(loads.load(), 1);
+}
+
+TEST(CacheTest, Concurrent) {
+  Cache<int, int> cache(Options(1000, 16));
+  std::vector<std::thread> threads;
+  for (int t = 0; t != 8; ++t) {
+    threads.emplace_back([&cache, t] {
+      for (int i = 0; i != 10000; ++i) {
+        auto const key = (i * 7 + t) % 2000;
+        auto const value = cache.GetOrLoad(key, [key] { return key * 2; });
+        EXPECT_EQ(*value, key * 2);
+        if (i % 10 == 0) cache.Put(key, key * 2);
+      }
+    });
+  }
+  for (auto& t : threads) t.join();
+  auto const stats = cache.stats();
+  EXPECT_EQ(stats.hits + stats.misses, 80000);
+  EXPECT_LE(stats.entries, 1000);
+}
+
+TEST(CacheTest, Registered) {
+  auto registered = [] {
+    std::map<std::string, CacheStats> caches;
+    functions_internal::ForEachCache(
+        [&caches](std::string const& name, CacheStats const& stats) {
+          caches.emplace(name, stats);
+        });
+    return caches;
+  };
+  Cache<int, int> unnamed;
+  auto options = Options(10);
+  options.name = "test-cache";
+  {
+    Cache<int, int> named(options);
+    named.Put(1, 1);
+    (void)named.Get(1);
+    auto const caches = registered();
+    ASSERT_THAT(caches, Contains(Key("test-cache")));
+    EXPECT_EQ(caches.at("test-cache").hits, 1);
+    EXPECT_EQ(caches.size(), 1);
+  }
+  EXPECT_THAT(registered(), Not(Contains(Key("test-cache"))));
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
@@ -0,0 +1,42 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/cancellation_token.h"
+#include "google/cloud/functions/internal/cancellation.h"
+#include <utility>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+bool CancellationToken::cancelled() const {
+  return state_ && state_->cancelled();
+}
+
+std::optional<CancellationToken::Clock::time_point>
+CancellationToken::deadline() const {
+  if (!state_) return std::nullopt;
+  return state_->deadline();
+}
+
+void CancellationToken::on_cancel(std::function<void()> callback) const {
+  if (state_) state_->OnCancel(std::move(callback));
+}
+
+CancellationToken CurrentCancellationToken() {
+  return functions_internal::CancellationAccess::MakeToken(
+      functions_internal::CurrentCancellation());
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
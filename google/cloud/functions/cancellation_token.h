@@ -0,0 +1,90 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CANCELLATION_TOKEN_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CANCELLATION_TOKEN_H
+
+#include "google/cloud/functions/version.h"
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+class CancellationState;
+struct CancellationAccess;
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Tells a function that nobody is waiting for its result anymore.
+ *
+ * A request is cancelled once its deadline expires, or once the client closes
+ * the connection. The deadline is the shortest of `--request-deadline` and
+ * the `X-Server-Timeout` header of the request, in seconds, if any. The
+ * framework does not stop the function, functions doing expensive work
+ * should check `cancelled()` from time to time, or register a callback with
+ * `on_cancel()`, and give up early. Whatever they return is discarded if the
+ * client is gone.
+ *
+ * Tokens are cheap to copy, all the copies refer to the same request. A
+ * default constructed token is never cancelled.
+ */
+class CancellationToken {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  CancellationToken() = default;
+
+  /// Returns `true` if the request is cancelled, or its deadline passed.
+  [[nodiscard]] bool cancelled() const;
+
+  /// The deadline of the request, if any.
+  [[nodiscard]] std::optional<Clock::time_point> deadline() const;
+
+  /**
+   * Calls @p callback once the request is cancelled.
+   *
+   * The callback runs immediately if the request is already cancelled, and
+   * otherwise in a framework thread. It must be fast, and not throw. The
+   * callback is discarded, without running, once the request completes.
+   */
+  void on_cancel(std::function<void()> callback) const;
+
+ private:
+  friend struct functions_internal::CancellationAccess;
+  explicit CancellationToken(
+      std::shared_ptr<functions_internal::CancellationState> state)
+      : state_(std::move(state)) {}
+
+  std::shared_ptr<functions_internal::CancellationState> state_;
+};
+
+/**
+ * The token of the request running in the current thread.
+ *
+ * Use this in CloudEvent functions, HTTP functions can also use
+ * `HttpRequest::cancellation_token()`. Asynchronous functions must get the
+ * token before they return. Outside a request the token is never cancelled.
+ */
+CancellationToken CurrentCancellationToken();
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CANCELLATION_TOKEN_H
@@ -13,18 +13,159 @@
 // limitations under the License.
 
 #include "google/cloud/functions/cloud_event.h"
-#include <absl/time/time.h>  // NOLINT(modernize-deprecated-headers)
+#include "google/cloud/functions/internal/parse_time.h"
+#include <algorithm>
+#include <stdexcept>
 
 namespace google::cloud::functions {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
 
-void CloudEvent::set_time(std::string const& timestamp) {
-  std::string err;
-  absl::Time time;
-  if (!absl::ParseTime(absl::RFC3339_full, timestamp, &time, &err)) {
-    throw std::invalid_argument(err);
+/// The attributes defined by the CloudEvents specification.
+bool IsContextAttribute(std::string_view name) {
+  std::string_view const names[] = {
+      "id",   "source",          "type",       "specversion", "subject",
+      "time", "datacontenttype", "dataschema", "data",        "data_base64",
+  };
+  return std::find(std::begin(names), std::end(names), name) !=
+         std::end(names);
+}
+
+}  // namespace
+
+bool CloudEvent::IsValidExtensionName(std::string_view name) {
+  return !name.empty() && !IsContextAttribute(name) &&
+         std::all_of(name.begin(), name.end(), [](char c) {
+           return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9');
+         });
+}
+
+CloudEvent::CloudEvent(std::string_view id, std::string_view source,
+                       std::string_view type, std::string_view spec_version) {
+  attributes_.reserve(id.size() + source.size() + type.size() +
+                      spec_version.size());
+  slices_[kId] = Append(id);
+  slices_[kSource] = Append(source);
+  slices_[kType] = Append(type);
+  slices_[kSpecVersion] = Append(spec_version);
+}
+
+CloudEvent::CloudEvent(CloudEvent&& rhs) noexcept
+    : attributes_(std::move(rhs.attributes_)),
+      slices_(rhs.slices_),
+      extensions_(std::move(rhs.extensions_)),
+      time_(rhs.time_),
+      data_(std::move(rhs.data_)),
+      data_cache_(std::move(rhs.data_cache_)) {
+  rhs.ClearAttributes();
+}
+
+CloudEvent& CloudEvent::operator=(CloudEvent&& rhs) noexcept {
+  attributes_ = std::move(rhs.attributes_);
+  slices_ = rhs.slices_;
+  extensions_ = std::move(rhs.extensions_);
+  time_ = rhs.time_;
+  data_ = std::move(rhs.data_);
+  data_cache_ = std::move(rhs.data_cache_);
+  rhs.ClearAttributes();
+  return *this;
+}
+
+std::optional<std::string_view> CloudEvent::extension(
+    std::string_view name) const {
+  for (auto const& e : extensions_) {
+    if (View(e.name) == name) return View(e.value);
+  }
+  return std::nullopt;
+}
+
+std::optional<TraceContext> CloudEvent::trace_context() const {
+  auto const v = extension("traceparent");
+  if (!v) return std::nullopt;
+  return ParseTraceParent(*v);
+}
+
+std::vector<std::pair<std::string_view, std::string_view>>
+CloudEvent::extensions() const {
+  std::vector<std::pair<std::string_view, std::string_view>> result;
+  result.reserve(extensions_.size());
+  for (auto const& e : extensions_) {
+    result.emplace_back(*View(e.name), *View(e.value));
+  }
+  return result;
+}
+
+void CloudEvent::set_extension(std::string_view name, std::string_view value) {
+  if (!IsValidExtensionName(name)) {
+    throw std::invalid_argument("invalid extension attribute name <" +
+                                std::string(name) + ">");
+  }
+  // The arguments may refer to the buffer, copy them before changing it.
+  if (Aliases(name) || Aliases(value)) {
+    return set_extension(std::string(name), std::string(value));
+  }
+  reset_extension(name);
+  auto const n = Append(name);
+  extensions_.push_back(Extension{n, Append(value)});
+}
+
+void CloudEvent::reset_extension(std::string_view name) {
+  if (Aliases(name)) return reset_extension(std::string(name));
+  auto const i =
+      std::find_if(extensions_.begin(), extensions_.end(),
+                   [&](Extension const& e) { return View(e.name) == name; });
+  if (i == extensions_.end()) return;
+  auto const e = *i;
+  extensions_.erase(i);
+  // Erase the value first, it follows the name in the buffer.
+  Erase(e.value);
+  Erase(e.name);
+}
+
+void CloudEvent::ClearAttributes() noexcept {
+  attributes_.clear();
+  for (auto& s : slices_) s = Slice{};
+  // The required attributes are present, and empty.
+  for (auto a : {kId, kSource, kType, kSpecVersion}) slices_[a] = Slice{0, 0};
+  extensions_.clear();
+}
+
+CloudEvent::Slice CloudEvent::Append(std::string_view value) {
+  if (attributes_.size() + value.size() >= Slice::kAbsent) {
+    throw std::length_error("CloudEvent attributes are too large");
   }
-  set_time(absl::ToChronoTime(time));
+  auto const offset = static_cast<std::uint32_t>(attributes_.size());
+  attributes_.append(value);
+  return Slice{offset, static_cast<std::uint32_t>(value.size())};
+}
+
+void CloudEvent::Erase(Slice s) {
+  if (s.size == Slice::kAbsent || s.size == 0) return;
+  attributes_.erase(s.offset, s.size);
+  auto update = [&s](Slice& v) {
+    if (v.size != Slice::kAbsent && v.offset > s.offset) v.offset -= s.size;
+  };
+  for (auto& v : slices_) update(v);
+  for (auto& e : extensions_) {
+    update(e.name);
+    update(e.value);
+  }
+}
+
+void CloudEvent::Set(Attribute a, std::string_view value) {
+  // The value may refer to the buffer, copy it before changing the buffer.
+  if (Aliases(value)) return Set(a, std::string(value));
+  Reset(a);
+  slices_[a] = Append(value);
+}
+
+void CloudEvent::Reset(Attribute a) {
+  Erase(slices_[a]);
+  slices_[a] = Slice{};
+}
+
+void CloudEvent::set_time(std::string const& timestamp) {
+  set_time(functions_internal::ParseTimestamp(timestamp));
 }
 
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
@@ -15,14 +15,39 @@
 #ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CLOUD_EVENT_H
 #define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CLOUD_EVENT_H
 
+#include "google/cloud/functions/json_document.h"
+#include "google/cloud/functions/trace_context.h"
 #include "google/cloud/functions/version.h"
+#include <absl/types/span.h>
+#include <array>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace google::cloud::functions {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 
+class CloudEvent;
+
+/**
+ * Decodes the data of a Cloud Event into a `T`.
+ *
+ * Specialize this template to use `T` with `CloudEvent::data_as<T>()`. The
+ * specialization must define `static T Decode(CloudEvent const& event)`, which
+ * throws if the event does not contain a `T`, for example, if it has a
+ * different `type()` or `data_schema()`.
+ *
+ * @see `StorageObjectData` for an example.
+ */
+template <typename T>
+struct CloudEventDataDecoder;
+
 /**
  * Represents a Cloud Event.
  *
@@ -39,60 +64,258 @@ class CloudEvent {
   using ClockType = std::chrono::system_clock;
   using time_point = ClockType::time_point;
 
-  CloudEvent(std::string id, std::string source, std::string type,
-             std::string spec_version = kDefaultSpecVersion)
-      : id_(std::move(id)),
-        source_(std::move(source)),
-        type_(std::move(type)),
-        spec_version_(std::move(spec_version)) {}
+  CloudEvent(std::string_view id, std::string_view source,
+             std::string_view type,
+             std::string_view spec_version = kDefaultSpecVersion);
 
-  [[nodiscard]] std::string id() const { return id_; }
-  [[nodiscard]] std::string source() const { return source_; }
-  [[nodiscard]] std::string type() const { return type_; }
-  [[nodiscard]] std::string spec_version() const { return spec_version_; }
+  CloudEvent(CloudEvent const&) = default;
+  CloudEvent& operator=(CloudEvent const&) = default;
+  /// Moved-from events have empty attributes.
+  CloudEvent(CloudEvent&& rhs) noexcept;
+  CloudEvent& operator=(CloudEvent&& rhs) noexcept;
+
+  [[nodiscard]] std::string id() const { return std::string(id_view()); }
+  [[nodiscard]] std::string source() const {
+    return std::string(source_view());
+  }
+  [[nodiscard]] std::string type() const { return std::string(type_view()); }
+  [[nodiscard]] std::string spec_version() const {
+    return std::string(spec_version_view());
+  }
 
   [[nodiscard]] std::optional<std::string> data_content_type() const {
-    return data_content_type_;
+    return AsString(kDataContentType);
   }
   [[nodiscard]] std::optional<std::string> data_schema() const {
-    return data_schema_;
+    return AsString(kDataSchema);
+  }
+  [[nodiscard]] std::optional<std::string> subject() const {
+    return AsString(kSubject);
   }
-  [[nodiscard]] std::optional<std::string> subject() const { return subject_; }
   [[nodiscard]] std::optional<time_point> time() const { return time_; }
   [[nodiscard]] std::optional<std::string> data() const& { return data_; }
   [[nodiscard]] std::optional<std::string> data() && {
     return std::move(data_);
   }
 
-  void set_data_content_type(std::string v) {
-    data_content_type_ = std::move(v);
+  /**
+   * A view of the event data as a JSON document, parsed on demand.
+   *
+   * JSON data is kept as its original text. Use this to read parts of the data
+   * without copying it or building a DOM. The view is invalidated by
+   * `set_data()` and `reset_data()`.
+   */
+  [[nodiscard]] std::optional<JsonDocument> data_json() const {
+    if (!data_) return std::nullopt;
+    return JsonDocument(*data_);
+  }
+
+  /**
+   * The event data decoded as a `T`, using `CloudEventDataDecoder<T>`.
+   *
+   * The data is decoded once, and the result is kept with the event, until
+   * the data changes, or `data_as()` is called with a different type. Copies
+   * of the event share the result.
+   *
+   * @par Example
+   * @code
+   * auto const object = event.data_as<gcf::StorageObjectData>();
+   * std::cout << object->bucket << "/" << object->name << "\n";
+   * @endcode
+   */
+  template <typename T>
+  [[nodiscard]] std::shared_ptr<T const> data_as() const {
+    auto cached = std::atomic_load(&data_cache_);
+    if (cached && cached->type == TypeTag<T>()) {
+      return std::static_pointer_cast<T const>(cached->value);
+    }
+    auto value =
+        std::make_shared<T const>(CloudEventDataDecoder<T>::Decode(*this));
+    // Concurrent calls may decode the data more than once, but each call
+    // returns a complete value.
+    std::atomic_store(&data_cache_, std::make_shared<DataCache const>(
+                                        DataCache{TypeTag<T>(), value}));
+    return value;
+  }
+
+  /**
+   * @name Non-copying accessors.
+   *
+   * These return views into the event, and do not copy the attributes or the
+   * data. The views are invalidated by the corresponding setter or `reset_*()`
+   * function, and when the event is destroyed.
+   */
+  ///@{
+  [[nodiscard]] std::string_view id_view() const { return *View(kId); }
+  [[nodiscard]] std::string_view source_view() const {
+    return *View(kSource);
+  }
+  [[nodiscard]] std::string_view type_view() const { return *View(kType); }
+  [[nodiscard]] std::string_view spec_version_view() const {
+    return *View(kSpecVersion);
+  }
+  [[nodiscard]] std::optional<std::string_view> data_content_type_view()
+      const {
+    return View(kDataContentType);
+  }
+  [[nodiscard]] std::optional<std::string_view> data_schema_view() const {
+    return View(kDataSchema);
+  }
+  [[nodiscard]] std::optional<std::string_view> subject_view() const {
+    return View(kSubject);
+  }
+  [[nodiscard]] std::optional<std::string_view> data_view() const {
+    if (!data_) return std::nullopt;
+    return std::string_view(*data_);
+  }
+  ///@}
+
+  /**
+   * @name Extension attributes.
+   *
+   * Extension attributes are any attributes not defined by the CloudEvents
+   * specification, such as `traceparent`. Their names are lowercase letters
+   * and digits. The views are invalidated by any attribute setter or
+   * `reset_*()` function, and when the event is destroyed.
+   */
+  ///@{
+  /// The value of the extension attribute @p name, if any.
+  [[nodiscard]] std::optional<std::string_view> extension(
+      std::string_view name) const;
+
+  /// The trace context in the `traceparent` extension attribute, if any.
+  [[nodiscard]] std::optional<TraceContext> trace_context() const;
+
+  /// All the extension attributes, as (name, value) pairs, in insertion order.
+  [[nodiscard]] std::vector<std::pair<std::string_view, std::string_view>>
+  extensions() const;
+
+  /**
+   * Sets the extension attribute @p name.
+   *
+   * Throws `std::invalid_argument` if @p name is not a valid extension name,
+   * see `IsValidExtensionName()`.
+   */
+  void set_extension(std::string_view name, std::string_view value);
+  void reset_extension(std::string_view name);
+
+  /**
+   * Returns true if @p name can be used as an extension attribute name.
+   *
+   * Extension names are lowercase letters and digits, and cannot be the name
+   * of an attribute defined by the specification.
+   */
+  [[nodiscard]] static bool IsValidExtensionName(std::string_view name);
+  ///@}
+
+  /**
+   * The event data as bytes, empty if the event has no data.
+   *
+   * The span refers to the data in the event and does not copy it. It is
+   * invalidated by `set_data()` and `reset_data()`.
+   */
+  [[nodiscard]] absl::Span<std::byte const> data_bytes() const {
+    if (!data_) return {};
+    return {reinterpret_cast<std::byte const*>(data_->data()), data_->size()};
   }
-  void reset_data_content_type() { data_content_type_.reset(); }
 
-  void set_data_schema(std::string v) { data_schema_ = std::move(v); }
-  void reset_data_schema() { data_schema_.reset(); }
+  void set_data_content_type(std::string_view v) {
+    Set(kDataContentType, v);
+  }
+  void reset_data_content_type() { Reset(kDataContentType); }
 
-  void set_subject(std::string v) { subject_ = std::move(v); }
-  void reset_subject() { subject_.reset(); }
+  void set_data_schema(std::string_view v) { Set(kDataSchema, v); }
+  void reset_data_schema() { Reset(kDataSchema); }
+
+  void set_subject(std::string_view v) { Set(kSubject, v); }
+  void reset_subject() { Reset(kSubject); }
 
   void set_time(time_point tp) { time_ = tp; }
   void set_time(std::string const& timestamp);
   void reset_time() { time_.reset(); }
 
-  void set_data(std::string v) { data_ = std::move(v); }
-  void reset_data() { data_.reset(); }
+  void set_data(std::string v) {
+    data_ = std::move(v);
+    data_cache_.reset();
+  }
+  void reset_data() {
+    data_.reset();
+    data_cache_.reset();
+  }
 
  private:
-  std::string const id_;
-  std::string const source_;
-  std::string const type_;
-  std::string const spec_version_;
-
-  std::optional<std::string> data_content_type_;
-  std::optional<std::string> data_schema_;
-  std::optional<std::string> subject_;
+  /// The last result of `data_as()`.
+  struct DataCache {
+    void const* type;
+    std::shared_ptr<void const> value;
+  };
+
+  /// A unique address for each type, avoids RTTI.
+  template <typename T>
+  static void const* TypeTag() {
+    static char const kTag = 0;
+    return &kTag;
+  }
+
+  /// The attributes with a fixed position in `slices_`.
+  enum Attribute {
+    kId,
+    kSource,
+    kType,
+    kSpecVersion,
+    kDataContentType,
+    kDataSchema,
+    kSubject,
+    kAttributeCount,
+  };
+
+  /// The location of an attribute value in `attributes_`.
+  struct Slice {
+    static auto constexpr kAbsent = ~std::uint32_t{0};
+    std::uint32_t offset = 0;
+    std::uint32_t size = kAbsent;
+  };
+
+  struct Extension {
+    Slice name;
+    Slice value;
+  };
+
+  [[nodiscard]] std::optional<std::string_view> View(Slice s) const {
+    if (s.size == Slice::kAbsent) return std::nullopt;
+    return std::string_view(attributes_).substr(s.offset, s.size);
+  }
+  [[nodiscard]] std::optional<std::string_view> View(Attribute a) const {
+    return View(slices_[a]);
+  }
+  [[nodiscard]] std::optional<std::string> AsString(Attribute a) const {
+    auto v = View(a);
+    if (!v) return std::nullopt;
+    return std::string(*v);
+  }
+
+  /// Returns true if @p value refers to `attributes_`.
+  [[nodiscard]] bool Aliases(std::string_view value) const {
+    return value.data() >= attributes_.data() &&
+           value.data() < attributes_.data() + attributes_.size();
+  }
+  /// Leaves the attributes in the moved-from state.
+  void ClearAttributes() noexcept;
+  /// Appends @p value to `attributes_`, returns its location.
+  Slice Append(std::string_view value);
+  /// Removes the value at @p s from `attributes_`, and updates the offsets.
+  void Erase(Slice s);
+  void Set(Attribute a, std::string_view value);
+  void Reset(Attribute a);
+
+  // All the attribute values, including the extension names, are stored in
+  // a single buffer. Most events need one allocation for all the attributes.
+  std::string attributes_;
+  std::array<Slice, kAttributeCount> slices_;
+  std::vector<Extension> extensions_;
   std::optional<time_point> time_;
   std::optional<std::string> data_;
+  mutable std::shared_ptr<DataCache const> data_cache_;
 };
 
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
@@ -0,0 +1,71 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CLOUD_EVENT_BATCH_ERROR_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CLOUD_EVENT_BATCH_ERROR_H
+
+#include "google/cloud/functions/version.h"
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Reports the events of a batch that failed, the other events succeeded.
+ *
+ * A `UserCloudEventBatchFunction` throws this exception to fail only some of
+ * the events it received. The response is still an error, but its body lists
+ * the failed events, so senders can retry only those events. Any other
+ * exception fails all the events in the batch.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * void MyHandler(std::vector<gcf::CloudEvent> events) {
+ *   gcf::CloudEventBatchError error;
+ *   for (std::size_t i = 0; i != events.size(); ++i) {
+ *     if (!Process(events[i])) error.Fail(i, "cannot process event");
+ *   }
+ *   if (!error.empty()) throw error;
+ * }
+ * @endcode
+ */
+class CloudEventBatchError : public std::runtime_error {
+ public:
+  struct FailedEvent {
+    /// The position of the event in the vector passed to the function.
+    std::size_t index;
+    std::string message;
+  };
+
+  CloudEventBatchError();
+
+  /// Marks the event at @p index as failed.
+  void Fail(std::size_t index, std::string message);
+
+  [[nodiscard]] std::vector<FailedEvent> const& failed() const {
+    return failed_;
+  }
+  [[nodiscard]] bool empty() const { return failed_.empty(); }
+
+ private:
+  std::vector<FailedEvent> failed_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CLOUD_EVENT_BATCH_ERROR_H
@@ -0,0 +1,38 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/cloud_event_batch_error.h"
+#include <gmock/gmock.h>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+TEST(CloudEventBatchErrorTest, Fail) {
+  CloudEventBatchError error;
+  EXPECT_TRUE(error.empty());
+  EXPECT_STREQ(error.what(), "some events in the batch failed");
+  error.Fail(2, "uh-oh");
+  error.Fail(0, "oh no");
+  EXPECT_FALSE(error.empty());
+  ASSERT_EQ(error.failed().size(), 2);
+  EXPECT_EQ(error.failed()[0].index, 2);
+  EXPECT_EQ(error.failed()[0].message, "uh-oh");
+  EXPECT_EQ(error.failed()[1].index, 0);
+  EXPECT_EQ(error.failed()[1].message, "oh no");
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
@@ -0,0 +1,45 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/cloud_event_dedup.h"
+#include "google/cloud/functions/internal/dedup_cache.h"
+#include <utility>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+std::shared_ptr<CloudEventDeduplicator> MakeCloudEventDedupCache(
+    std::size_t capacity, std::chrono::steady_clock::duration ttl) {
+  return std::make_shared<functions_internal::DedupCache>(capacity, ttl);
+}
+
+UserCloudEventFunction WithDeduplication(
+    UserCloudEventFunction function,
+    std::shared_ptr<CloudEventDeduplicator> deduplicator) {
+  return [function = std::move(function),
+          deduplicator = std::move(deduplicator)](CloudEvent event) {
+    if (!deduplicator->Insert(event.source_view(), event.id_view())) return;
+    auto source = event.source();
+    auto id = event.id();
+    try {
+      function(std::move(event));
+    } catch (...) {
+      deduplicator->Erase(source, id);
+      throw;
+    }
+  };
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
@@ -0,0 +1,79 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CLOUD_EVENT_DEDUP_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CLOUD_EVENT_DEDUP_H
+
+#include "google/cloud/functions/user_functions.h"
+#include "google/cloud/functions/version.h"
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Records the Cloud Events already handled, see `WithDeduplication()`.
+ *
+ * Events are identified by their `source()` and `id()` attributes, as
+ * required by the CloudEvents specification. Implement this interface to share
+ * the records across instances, e.g., using Memorystore. Implementations must
+ * be safe to call from multiple threads.
+ */
+class CloudEventDeduplicator {
+ public:
+  virtual ~CloudEventDeduplicator() = default;
+
+  /// Records the event, returns `false` if it was already recorded.
+  virtual bool Insert(std::string_view source, std::string_view id) = 0;
+
+  /// Removes the event, so a redelivery of the event runs again.
+  virtual void Erase(std::string_view source, std::string_view id) = 0;
+};
+
+/**
+ * Creates an in-memory deduplicator for the events of one instance.
+ *
+ * It keeps up to @p capacity events, each for up to @p ttl, evicting the least
+ * recently inserted events first.
+ */
+std::shared_ptr<CloudEventDeduplicator> MakeCloudEventDedupCache(
+    std::size_t capacity, std::chrono::steady_clock::duration ttl);
+
+/**
+ * Wraps @p function to skip events already handled.
+ *
+ * Duplicates, such as the retries of an at-least-once delivery, are
+ * acknowledged without calling @p function. Events are recorded before
+ * @p function runs, concurrent deliveries of an event run once. If
+ * @p function throws the event is erased, and a redelivery runs again.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * auto MyFunction() {
+ *   auto cache = gcf::MakeCloudEventDedupCache(10000, std::chrono::hours(1));
+ *   return gcf::MakeFunction(gcf::WithDeduplication(MyHandler, cache));
+ * }
+ * @endcode
+ */
+UserCloudEventFunction WithDeduplication(
+    UserCloudEventFunction function,
+    std::shared_ptr<CloudEventDeduplicator> deduplicator);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CLOUD_EVENT_DEDUP_H
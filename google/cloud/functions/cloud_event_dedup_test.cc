@@ -0,0 +1,56 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/cloud_event_dedup.h"
+#include <gmock/gmock.h>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(CloudEventDedupTest, SkipsDuplicates) {
+  std::vector<std::string> ids;
+  auto function = WithDeduplication(
+      [&ids](CloudEvent const& e) { ids.push_back(e.id()); },
+      MakeCloudEventDedupCache(10, std::chrono::minutes(1)));
+  function(CloudEvent("id-0", "source", "type"));
+  function(CloudEvent("id-1", "source", "type"));
+  function(CloudEvent("id-0", "source", "type"));
+  function(CloudEvent("id-0", "other-source", "type"));
+  EXPECT_THAT(ids, ElementsAre("id-0", "id-1", "id-0"));
+}
+
+TEST(CloudEventDedupTest, RetriesFailures) {
+  int calls = 0;
+  auto function = WithDeduplication(
+      [&calls](CloudEvent const&) {
+        if (++calls == 1) throw std::runtime_error("uh-oh");
+      },
+      MakeCloudEventDedupCache(10, std::chrono::minutes(1)));
+  EXPECT_THROW(function(CloudEvent("id-0", "source", "type")),
+               std::runtime_error);
+  function(CloudEvent("id-0", "source", "type"));
+  function(CloudEvent("id-0", "source", "type"));
+  EXPECT_EQ(calls, 2);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
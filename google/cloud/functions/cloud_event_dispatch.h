@@ -0,0 +1,195 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CLOUD_EVENT_DISPATCH_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CLOUD_EVENT_DISPATCH_H
+
+#include "google/cloud/functions/internal/event_type_table.h"
+#include "google/cloud/functions/cloud_event.h"
+#include "google/cloud/functions/function.h"
+#include "google/cloud/functions/version.h"
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// The handler of a CloudEvent type, see `OnEventType()`.
+template <typename F>
+struct CloudEventTypeHandler {
+  std::string_view type;
+  F handler;
+};
+
+/// The handler of the types without their own handler, see
+/// `OnOtherEventTypes()`.
+template <typename F>
+struct CloudEventDefaultHandler {
+  F handler;
+};
+
+/**
+ * Handles the CloudEvents of @p type with @p handler.
+ *
+ * @p type is not copied, it must outlive the function, string literals do.
+ */
+template <typename F>
+constexpr CloudEventTypeHandler<std::decay_t<F>> OnEventType(
+    std::string_view type, F&& handler) {
+  return {type, std::forward<F>(handler)};
+}
+
+/// Handles the CloudEvents of any type not listed with @p handler.
+template <typename F>
+constexpr CloudEventDefaultHandler<std::decay_t<F>> OnOtherEventTypes(
+    F&& handler) {
+  return {std::forward<F>(handler)};
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+template <typename H>
+inline constexpr bool kIsEventTypeHandler = false;
+template <typename F>
+inline constexpr bool kIsEventTypeHandler<functions::CloudEventTypeHandler<F>> =
+    true;
+
+template <typename H>
+inline constexpr bool kIsDefaultEventHandler = false;
+template <typename F>
+inline constexpr bool
+    kIsDefaultEventHandler<functions::CloudEventDefaultHandler<F>> = true;
+
+/**
+ * Calls the handler for the type of each CloudEvent.
+ *
+ * The handlers are stored in a tuple and called directly, the type is found
+ * with an `EventTypeTable`, without copying it. The events of other types run
+ * the default handler, if any, and are otherwise ignored.
+ */
+template <typename... H>
+class CloudEventTypeDispatcher {
+ public:
+  static auto constexpr kHandlers = sizeof...(H);
+  static auto constexpr kHasDefault = (kIsDefaultEventHandler<H> || ...);
+  static auto constexpr kTypes = kHandlers - (kHasDefault ? 1 : 0);
+
+  static_assert(((kIsEventTypeHandler<H> || kIsDefaultEventHandler<H>)&&...),
+                "use `OnEventType()` and `OnOtherEventTypes()`");
+  static_assert((std::size_t{kIsDefaultEventHandler<H>} + ...) <= 1,
+                "at most one `OnOtherEventTypes()` handler");
+  using Last = std::tuple_element_t<kHandlers - 1, std::tuple<H...>>;
+  static_assert(!kHasDefault || kIsDefaultEventHandler<Last>,
+                "`OnOtherEventTypes()` must be the last handler");
+  static_assert(kTypes != 0, "use `OnEventType()` for at least one type");
+  static_assert(
+      (std::is_invocable_v<decltype(std::declval<H&>().handler)&,
+                           functions::CloudEvent> &&
+       ...),
+      "the handlers must be callable with a `functions::CloudEvent`");
+
+  constexpr explicit CloudEventTypeDispatcher(H... handlers)
+      : handlers_(std::move(handlers)...),
+        table_(Types(std::make_index_sequence<kTypes>{})) {}
+
+  void operator()(functions::CloudEvent event) {
+    auto const index = table_.Find(event.type_view());
+    if (index == EventTypeTable<kTypes>::kNotFound) {
+      if constexpr (kHasDefault) {
+        std::get<kHandlers - 1>(handlers_).handler(std::move(event));
+      }
+      return;
+    }
+    Call(index, std::move(event), std::make_index_sequence<kTypes>{});
+  }
+
+ private:
+  template <std::size_t... I>
+  constexpr std::array<std::string_view, kTypes> Types(
+      std::index_sequence<I...>) const {
+    return {std::get<I>(handlers_).type...};
+  }
+
+  template <std::size_t I>
+  static void CallOne(std::tuple<H...>& handlers, functions::CloudEvent&& e) {
+    std::get<I>(handlers).handler(std::move(e));
+  }
+
+  template <std::size_t... I>
+  void Call(std::size_t index, functions::CloudEvent&& event,
+            std::index_sequence<I...>) {
+    using Caller = void (*)(std::tuple<H...>&, functions::CloudEvent&&);
+    static constexpr Caller kCallers[] = {&CallOne<I>...};
+    kCallers[index](handlers_, std::move(event));
+  }
+
+  std::tuple<H...> handlers_;
+  EventTypeTable<kTypes> table_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Wraps a `cloud event` function with a handler for each event type.
+ *
+ * Each event runs the handler for its `type()`, found with a perfect hash
+ * computed when the function is created, without copying the type. The
+ * handlers are called directly, they may take the event by value or as a
+ * `CloudEvent const&`. The events of other types run the
+ * `OnOtherEventTypes()` handler, if any. Without one they are ignored, and
+ * the request succeeds.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * auto MyFunction() {
+ *   return gcf::MakeFunction(
+ *       gcf::OnEventType("google.cloud.pubsub.topic.v1.messagePublished",
+ *                        OnMessage),
+ *       gcf::OnEventType("google.cloud.storage.object.v1.finalized",
+ *                        OnUpload),
+ *       gcf::OnOtherEventTypes([](gcf::CloudEvent const& e) {
+ *         throw std::invalid_argument("unexpected event type " + e.type());
+ *       }));
+ * }
+ * @endcode
+ *
+ * @throws std::invalid_argument if a type is listed more than once.
+ */
+template <typename... H,
+          std::enable_if_t<
+              (sizeof...(H) != 0) &&
+                  ((functions_internal::kIsEventTypeHandler<H> ||
+                    functions_internal::kIsDefaultEventHandler<H>)&&...),
+              int> = 0>
+Function MakeFunction(H... handlers) {
+  using Dispatcher = functions_internal::CloudEventTypeDispatcher<H...>;
+  return MakeFunction(Dispatcher(std::move(handlers)...));
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CLOUD_EVENT_DISPATCH_H
@@ -0,0 +1,118 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/cloud_event_dispatch.h"
+#include "google/cloud/functions/in_process_invoker.h"
+#include <gmock/gmock.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+
+auto constexpr kPublished = "google.cloud.pubsub.topic.v1.messagePublished";
+auto constexpr kFinalized = "google.cloud.storage.object.v1.finalized";
+
+CloudEvent Event(std::string const& id, std::string const& type) {
+  return CloudEvent(id, "//test", type);
+}
+
+HttpRequest EventRequest(std::string const& id, std::string const& type) {
+  return HttpRequest{}
+      .set_verb("POST")
+      .set_target("/")
+      .add_header("ce-id", id)
+      .add_header("ce-source", "//test")
+      .add_header("ce-type", type)
+      .add_header("ce-specversion", "1.0");
+}
+
+TEST(CloudEventDispatchTest, Dispatcher) {
+  std::vector<std::string> calls;
+  functions_internal::CloudEventTypeDispatcher dispatcher(
+      OnEventType(kPublished,
+                  [&calls](CloudEvent const& e) {
+                    calls.push_back("published " + e.id());
+                  }),
+      OnEventType(kFinalized, [&calls](CloudEvent e) {
+        calls.push_back("finalized " + e.id());
+      }));
+  dispatcher(Event("e1", kFinalized));
+  dispatcher(Event("e2", kPublished));
+  // Other types are ignored.
+  dispatcher(Event("e3", "com.example.unknown"));
+  EXPECT_THAT(calls, ElementsAre("finalized e1", "published e2"));
+}
+
+TEST(CloudEventDispatchTest, Default) {
+  std::vector<std::string> calls;
+  functions_internal::CloudEventTypeDispatcher dispatcher(
+      OnEventType(kPublished,
+                  [&calls](CloudEvent const& e) {
+                    calls.push_back("published " + e.id());
+                  }),
+      OnOtherEventTypes([&calls](CloudEvent const& e) {
+        calls.push_back("other " + e.type());
+      }));
+  dispatcher(Event("e1", kFinalized));
+  dispatcher(Event("e2", kPublished));
+  EXPECT_THAT(calls, ElementsAre("other " + std::string(kFinalized),
+                                 "published e2"));
+}
+
+TEST(CloudEventDispatchTest, MoveOnlyHandlers) {
+  auto count = std::make_unique<int>(0);
+  functions_internal::CloudEventTypeDispatcher dispatcher(OnEventType(
+      kPublished, [c = std::move(count)](CloudEvent const&) { ++*c; }));
+  dispatcher(Event("e1", kPublished));
+}
+
+TEST(CloudEventDispatchTest, Duplicates) {
+  auto handler = [](CloudEvent const&) {};
+  EXPECT_THROW(MakeFunction(OnEventType(kPublished, handler),
+                            OnEventType(kPublished, handler)),
+               std::invalid_argument);
+}
+
+TEST(CloudEventDispatchTest, MakeFunction) {
+  std::vector<std::string> calls;
+  InProcessInvoker invoker(MakeFunction(
+      OnEventType(kPublished,
+                  [&calls](CloudEvent const& e) {
+                    calls.push_back("published " + e.id());
+                  }),
+      OnEventType(kFinalized,
+                  [&calls](CloudEvent const& e) {
+                    calls.push_back("finalized " + e.id());
+                  }),
+      OnOtherEventTypes([](CloudEvent const& e) {
+        throw std::invalid_argument("unexpected event type " + e.type());
+      })));
+  EXPECT_EQ(invoker.Invoke(EventRequest("e1", kPublished)).result(),
+            HttpResponse::kOkay);
+  EXPECT_EQ(invoker.Invoke(EventRequest("e2", kFinalized)).result(),
+            HttpResponse::kOkay);
+  EXPECT_EQ(invoker.Invoke(EventRequest("e3", "com.example.unknown")).result(),
+            HttpResponse::kInternalServerError);
+  EXPECT_THAT(calls, ElementsAre("published e1", "finalized e2"));
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
@@ -0,0 +1,48 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/cloud_event_parser.h"
+#include "google/cloud/functions/internal/parse_cloud_event_http.h"
+#include "google/cloud/functions/internal/wrap_request.h"
+#include <utility>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+using ::google::cloud::functions_internal::WrapRequest;
+
+bool IsCloudEventRequest(HttpRequest const& request) {
+  return functions_internal::IsCloudEventHttp(WrapRequest::unwrap(request));
+}
+
+std::vector<CloudEvent> ParseCloudEvents(HttpRequest&& request) {
+  std::vector<CloudEvent> events;
+  functions_internal::ParseCloudEventHttp(
+      std::move(WrapRequest::unwrap(request)),
+      [&events](CloudEvent e) { events.push_back(std::move(e)); });
+  return events;
+}
+
+std::vector<CloudEvent> ParseCloudEvents(HttpRequest const& request) {
+  return functions_internal::ParseCloudEventHttp(WrapRequest::unwrap(request));
+}
+
+void RegisterCloudEventFormat(std::string media_type,
+                              CloudEventDecoder decoder) {
+  functions_internal::RegisterCloudEventDecoder(std::move(media_type),
+                                                std::move(decoder));
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
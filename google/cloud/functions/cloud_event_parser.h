@@ -0,0 +1,119 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CLOUD_EVENT_PARSER_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CLOUD_EVENT_PARSER_H
+
+#include "google/cloud/functions/cloud_event.h"
+#include "google/cloud/functions/http_request.h"
+#include "google/cloud/functions/version.h"
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * @name Parse Cloud Events from HTTP requests.
+ *
+ * HTTP functions that also receive Cloud Events, such as gateways, can use
+ * the same parser as Cloud Event functions. All the content modes are
+ * supported: binary, structured and batched, in the JSON and protobuf
+ * formats, and the legacy Cloud Functions events.
+ *
+ * @par Example
+ * @code
+ * gcf::HttpResponse Handle(gcf::HttpRequest request) {
+ *   if (!gcf::IsCloudEventRequest(request)) return HandleRequest(request);
+ *   for (auto& event : gcf::ParseCloudEvents(std::move(request))) {
+ *     HandleEvent(std::move(event));
+ *   }
+ *   return gcf::HttpResponse{};
+ * }
+ * @endcode
+ */
+///@{
+
+/**
+ * Returns true if @p request contains Cloud Events.
+ *
+ * That is, if it has the `ce-id`, `ce-source` and `ce-type` headers, a
+ * `application/cloudevents*` content type, or a content type registered with
+ * `RegisterCloudEventFormat()`. Legacy events are not detected.
+ */
+bool IsCloudEventRequest(HttpRequest const& request);
+
+/**
+ * Parses the Cloud Events in @p request.
+ *
+ * In the binary content mode the payload is moved into the event data, and
+ * @p request is left without a payload. Throws an exception derived from
+ * `std::exception` if the request is not a valid Cloud Event.
+ */
+std::vector<CloudEvent> ParseCloudEvents(HttpRequest&& request);
+
+/// Parses the Cloud Events in @p request, copying the payload.
+std::vector<CloudEvent> ParseCloudEvents(HttpRequest const& request);
+
+///@}
+
+/**
+ * Decodes the Cloud Events in the payload of a request.
+ *
+ * The decoder receives the request `Content-Type` header, including any
+ * parameters, and the payload, and passes each event to the sink. Throw an
+ * exception derived from `std::exception` to reject an invalid payload, the
+ * function does not run and the request fails with a 400 status.
+ */
+using CloudEventDecoder = std::function<void(
+    std::string_view content_type, std::string_view payload,
+    std::function<void(CloudEvent)> const& sink)>;
+
+/**
+ * Decodes requests with the @p media_type content type using @p decoder.
+ *
+ * Use this for formats without built-in support, such as Avro encoded Pub/Sub
+ * messages, or to replace the decoder of a built-in format, e.g., with one
+ * faster for the expected traffic. The media type, e.g. `application/avro`,
+ * is compared without its parameters and ignoring case. Requests with a
+ * registered content type are Cloud Event requests, see
+ * `IsCloudEventRequest()`. Binary mode events, with the `ce-id`, `ce-source`
+ * and `ce-type` headers, do not use the decoder, their content type describes
+ * their data.
+ *
+ * Register the decoders before the framework starts, the decoders run in
+ * multiple threads at once. Throws `std::invalid_argument` if @p media_type
+ * is empty, longer than 128 characters, or has parameters.
+ *
+ * @par Example
+ * @code
+ * int main(int argc, char* argv[]) {
+ *   gcf::RegisterCloudEventFormat(
+ *       "application/x-my-events", [](auto, std::string_view payload,
+ *                                     auto const& sink) {
+ *         for (auto& event : DecodeMyEvents(payload)) sink(std::move(event));
+ *       });
+ *   return gcf::Run(argc, argv, MyFunction());
+ * }
+ * @endcode
+ */
+void RegisterCloudEventFormat(std::string media_type,
+                              CloudEventDecoder decoder);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CLOUD_EVENT_PARSER_H
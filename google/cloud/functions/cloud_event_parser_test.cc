@@ -0,0 +1,155 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/cloud_event_parser.h"
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+
+HttpRequest BinaryRequest(std::string payload) {
+  return HttpRequest{}
+      .set_verb("POST")
+      .set_target("/")
+      .add_header("ce-specversion", "1.0")
+      .add_header("ce-type", "com.example.someevent")
+      .add_header("ce-source", "/mycontext")
+      .add_header("ce-id", "A234-1234-1234")
+      .add_header("content-type", "text/plain")
+      .set_payload(std::move(payload));
+}
+
+TEST(CloudEventParser, IsCloudEventRequest) {
+  EXPECT_TRUE(IsCloudEventRequest(BinaryRequest("Hello")));
+  EXPECT_TRUE(IsCloudEventRequest(
+      HttpRequest{}.add_header("content-type",
+                               "application/cloudevents-batch+json")));
+  EXPECT_FALSE(IsCloudEventRequest(HttpRequest{}));
+  EXPECT_FALSE(IsCloudEventRequest(
+      HttpRequest{}.add_header("content-type", "application/json")));
+  EXPECT_FALSE(IsCloudEventRequest(HttpRequest{}
+                                       .add_header("ce-id", "A234")
+                                       .add_header("ce-source", "/mycontext")));
+}
+
+TEST(CloudEventParser, BinaryMovesPayload) {
+  auto request = BinaryRequest(std::string(1024, 'x'));
+  auto const* payload = request.payload().data();
+  auto events = ParseCloudEvents(std::move(request));
+  ASSERT_EQ(events.size(), 1);
+  auto const& e = events.front();
+  EXPECT_EQ(e.id(), "A234-1234-1234");
+  EXPECT_EQ(e.type(), "com.example.someevent");
+  EXPECT_EQ(e.data_content_type().value_or(""), "text/plain");
+  ASSERT_TRUE(e.data_view().has_value());
+  EXPECT_EQ(e.data_view()->size(), 1024);
+  EXPECT_EQ(e.data_view()->data(), payload);
+}
+
+TEST(CloudEventParser, BinaryCopiesPayload) {
+  auto const request = BinaryRequest("Hello");
+  auto const events = ParseCloudEvents(request);
+  ASSERT_EQ(events.size(), 1);
+  EXPECT_EQ(events.front().data().value_or(""), "Hello");
+  EXPECT_EQ(request.payload(), "Hello");
+}
+
+TEST(CloudEventParser, Batch) {
+  auto request =
+      HttpRequest{}
+          .add_header("content-type", "application/cloudevents-batch+json")
+          .set_payload(R"js([
+    {"specversion": "1.0", "type": "t", "source": "s", "id": "a"},
+    {"specversion": "1.0", "type": "t", "source": "s", "id": "b"}
+  ])js");
+  std::vector<std::string> ids;
+  for (auto const& e : ParseCloudEvents(std::move(request))) {
+    ids.push_back(e.id());
+  }
+  EXPECT_THAT(ids, ElementsAre("a", "b"));
+}
+
+TEST(CloudEventParser, Invalid) {
+  auto request = HttpRequest{}.add_header("ce-id", "A234");
+  EXPECT_THROW(ParseCloudEvents(std::move(request)), std::exception);
+}
+
+TEST(CloudEventParser, RegisterCloudEventFormat) {
+  // Decodes one event per line, with the event id.
+  RegisterCloudEventFormat(
+      "application/x-test-lines",
+      [](std::string_view content_type, std::string_view payload,
+         std::function<void(CloudEvent)> const& sink) {
+        EXPECT_EQ(content_type, "Application/X-Test-Lines; charset=utf-8");
+        if (payload.empty()) throw std::invalid_argument("empty payload");
+        while (!payload.empty()) {
+          auto const end = std::min(payload.find('\n'), payload.size());
+          sink(CloudEvent(std::string(payload.substr(0, end)), "/lines",
+                          "com.example.line"));
+          payload.remove_prefix(std::min(end + 1, payload.size()));
+        }
+      });
+  auto request = HttpRequest{}
+                     .add_header("content-type",
+                                 "Application/X-Test-Lines; charset=utf-8")
+                     .set_payload("id-1\nid-2");
+  EXPECT_TRUE(IsCloudEventRequest(request));
+  std::vector<std::string> ids;
+  for (auto const& e : ParseCloudEvents(request)) ids.push_back(e.id());
+  EXPECT_THAT(ids, ElementsAre("id-1", "id-2"));
+
+  request.set_payload("");
+  EXPECT_THROW(ParseCloudEvents(std::move(request)), std::exception);
+
+  EXPECT_FALSE(IsCloudEventRequest(
+      HttpRequest{}.add_header("content-type", "application/x-other")));
+  EXPECT_THROW(RegisterCloudEventFormat("", {}), std::invalid_argument);
+  EXPECT_THROW(RegisterCloudEventFormat("text/plain; charset=utf-8", {}),
+               std::invalid_argument);
+}
+
+TEST(CloudEventParser, RegisterCloudEventFormatReplacesBuiltin) {
+  auto calls = 0;
+  RegisterCloudEventFormat(
+      "application/cloudevents+protobuf",
+      [&calls](std::string_view, std::string_view,
+               std::function<void(CloudEvent)> const& sink) {
+        ++calls;
+        sink(CloudEvent("id", "/source", "com.example.type"));
+      });
+  auto events = ParseCloudEvents(HttpRequest{}.add_header(
+      "content-type", "application/cloudevents+protobuf"));
+  EXPECT_EQ(calls, 1);
+  ASSERT_EQ(events.size(), 1);
+  EXPECT_EQ(events.front().id(), "id");
+
+  // The other formats still use the built-in decoders.
+  events = ParseCloudEvents(BinaryRequest("Hello"));
+  EXPECT_EQ(calls, 1);
+  ASSERT_EQ(events.size(), 1);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
@@ -15,6 +15,9 @@
 #include "google/cloud/functions/cloud_event.h"
 #include <absl/time/time.h>
 #include <gmock/gmock.h>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
 
 namespace google::cloud::functions {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
@@ -92,6 +95,11 @@ TEST(CloudEventTest, TimeString) {
   }
   EXPECT_THROW(actual.set_time(""), std::exception);
   EXPECT_THROW(actual.set_time("2020-15"), std::exception);
+  EXPECT_THROW(actual.set_time("2020-11-31T12:34:45Z"), std::exception);
+
+  // Leap seconds are handled by the general parser.
+  actual.set_time("2016-12-31T23:59:60Z");
+  EXPECT_EQ(actual.time(), to_system_clock_tp("2016-12-31T23:59:60Z"));
 }
 
 TEST(CloudEventTest, Data) {
@@ -109,6 +117,207 @@ TEST(CloudEventTest, DataMove) {
   EXPECT_EQ(d.value_or(""), "test-value");
 }
 
+TEST(CloudEventTest, DataBytes) {
+  auto actual = CloudEvent("test-id", "test-source", "test-type");
+  EXPECT_TRUE(actual.data_bytes().empty());
+  actual.set_data(std::string("\x00\x01\xff", 3));
+  auto const bytes = actual.data_bytes();
+  ASSERT_EQ(bytes.size(), 3);
+  EXPECT_EQ(bytes[0], std::byte{0x00});
+  EXPECT_EQ(bytes[1], std::byte{0x01});
+  EXPECT_EQ(bytes[2], std::byte{0xff});
+  actual.reset_data();
+  EXPECT_TRUE(actual.data_bytes().empty());
+}
+
+TEST(CloudEventTest, DataJson) {
+  auto actual = CloudEvent("test-id", "test-source", "test-type");
+  EXPECT_FALSE(actual.data_json().has_value());
+  actual.set_data(R"js({"message": {"data": "SGVsbG8=", "count": 2}})js");
+  auto const json = actual.data_json();
+  ASSERT_TRUE(json.has_value());
+  EXPECT_EQ(json->get_string("/message/data").value_or(""), "SGVsbG8=");
+  EXPECT_EQ(json->get_int64("/message/count").value_or(0), 2);
+  EXPECT_EQ(json->text().data(), actual.data_view()->data());
+}
+
+TEST(CloudEventTest, Views) {
+  auto actual = CloudEvent("test-id", "test-source", "test-type");
+  EXPECT_EQ(actual.id_view(), "test-id");
+  EXPECT_EQ(actual.source_view(), "test-source");
+  EXPECT_EQ(actual.type_view(), "test-type");
+  EXPECT_EQ(actual.spec_version_view(), "1.0");
+  EXPECT_FALSE(actual.data_content_type_view().has_value());
+  EXPECT_FALSE(actual.data_schema_view().has_value());
+  EXPECT_FALSE(actual.subject_view().has_value());
+  EXPECT_FALSE(actual.data_view().has_value());
+
+  actual.set_data_content_type("application/json");
+  actual.set_data_schema("test-schema");
+  actual.set_subject("test-subject");
+  actual.set_data(std::string(1024, 'x'));
+  EXPECT_EQ(actual.data_content_type_view().value_or(""), "application/json");
+  EXPECT_EQ(actual.data_schema_view().value_or(""), "test-schema");
+  EXPECT_EQ(actual.subject_view().value_or(""), "test-subject");
+  auto const data = actual.data_view();
+  ASSERT_TRUE(data.has_value());
+  EXPECT_EQ(data->size(), 1024);
+  // The view refers to the data in the event.
+  EXPECT_EQ(static_cast<void const*>(data->data()),
+            static_cast<void const*>(actual.data_bytes().data()));
+}
+
+TEST(CloudEventTest, Attributes) {
+  auto actual = CloudEvent("test-id", "test-source", "test-type");
+  actual.set_subject("test-subject");
+  actual.set_data_schema("test-schema");
+  // Replacing and resetting an attribute does not change the others.
+  actual.set_subject("a-much-longer-test-subject");
+  EXPECT_EQ(actual.subject_view().value_or(""), "a-much-longer-test-subject");
+  EXPECT_EQ(actual.data_schema_view().value_or(""), "test-schema");
+  actual.reset_subject();
+  EXPECT_FALSE(actual.subject_view().has_value());
+  EXPECT_EQ(actual.data_schema_view().value_or(""), "test-schema");
+  EXPECT_EQ(actual.id_view(), "test-id");
+  EXPECT_EQ(actual.type_view(), "test-type");
+  // Setting an attribute from a view of the event is safe.
+  actual.set_subject(actual.source_view());
+  EXPECT_EQ(actual.subject_view().value_or(""), "test-source");
+  actual.set_data_content_type("");
+  EXPECT_EQ(actual.data_content_type_view().value_or("unset"), "");
+}
+
+TEST(CloudEventTest, Extensions) {
+  using ::testing::ElementsAre;
+  using ::testing::Pair;
+  auto actual = CloudEvent("test-id", "test-source", "test-type");
+  EXPECT_FALSE(actual.extension("traceparent").has_value());
+  EXPECT_TRUE(actual.extensions().empty());
+
+  actual.set_extension("traceparent", "00-abc-def-01");
+  actual.set_extension("partitionkey", "key-1");
+  actual.set_subject("test-subject");
+  EXPECT_EQ(actual.extension("traceparent").value_or(""), "00-abc-def-01");
+  EXPECT_EQ(actual.extension("partitionkey").value_or(""), "key-1");
+  EXPECT_THAT(actual.extensions(),
+              ElementsAre(Pair("traceparent", "00-abc-def-01"),
+                          Pair("partitionkey", "key-1")));
+
+  actual.set_extension("traceparent", "00-xyz-uvw-00");
+  EXPECT_THAT(actual.extensions(),
+              ElementsAre(Pair("partitionkey", "key-1"),
+                          Pair("traceparent", "00-xyz-uvw-00")));
+  actual.reset_extension("partitionkey");
+  actual.reset_extension("not-present");
+  EXPECT_THAT(actual.extensions(),
+              ElementsAre(Pair("traceparent", "00-xyz-uvw-00")));
+  EXPECT_EQ(actual.subject_view().value_or(""), "test-subject");
+  EXPECT_EQ(actual.source_view(), "test-source");
+
+  // Extensions are copied with the event.
+  auto const copy = actual;
+  EXPECT_EQ(copy.extension("traceparent").value_or(""), "00-xyz-uvw-00");
+}
+
+TEST(CloudEventTest, ExtensionNames) {
+  auto actual = CloudEvent("test-id", "test-source", "test-type");
+  EXPECT_TRUE(CloudEvent::IsValidExtensionName("abc123"));
+  for (auto const* name : {"", "Upper", "with-dash", "subject", "data"}) {
+    SCOPED_TRACE("Testing with " + std::string(name));
+    EXPECT_FALSE(CloudEvent::IsValidExtensionName(name));
+    EXPECT_THROW(actual.set_extension(name, "v"), std::invalid_argument);
+  }
+  EXPECT_TRUE(actual.extensions().empty());
+}
+
+TEST(CloudEventTest, TraceContext) {
+  auto actual = CloudEvent("test-id", "test-source", "test-type");
+  EXPECT_FALSE(actual.trace_context().has_value());
+  actual.set_extension(
+      "traceparent", "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01");
+  auto const context = actual.trace_context();
+  ASSERT_TRUE(context.has_value());
+  EXPECT_EQ(context->trace_id, "4bf92f3577b34da6a3ce929d0e0e4736");
+  EXPECT_EQ(context->span_id, "00f067aa0ba902b7");
+  EXPECT_TRUE(context->sampled);
+}
+
+TEST(CloudEventTest, Move) {
+  auto source = CloudEvent("test-id", "test-source", "test-type");
+  source.set_subject("test-subject");
+  source.set_extension("ext", "value");
+  source.set_data(std::string(1024, 'x'));
+  auto const* data = source.data_view()->data();
+
+  auto actual = std::move(source);
+  EXPECT_EQ(actual.id_view(), "test-id");
+  EXPECT_EQ(actual.subject_view().value_or(""), "test-subject");
+  EXPECT_EQ(actual.extension("ext").value_or(""), "value");
+  // The data is moved, not copied.
+  EXPECT_EQ(actual.data_view()->data(), data);
+
+  // Moved-from events are valid, with empty attributes.
+  // NOLINTNEXTLINE(bugprone-use-after-move)
+  EXPECT_EQ(source.id_view(), "");
+  EXPECT_FALSE(source.subject_view().has_value());
+  EXPECT_TRUE(source.extensions().empty());
+}
+
+struct TestData {
+  std::string value;
+};
+
+int test_data_decodes = 0;
+
+}  // namespace
+
+template <>
+struct CloudEventDataDecoder<TestData> {
+  static TestData Decode(CloudEvent const& event) {
+    ++test_data_decodes;
+    return TestData{event.data().value_or("")};
+  }
+};
+
+template <>
+struct CloudEventDataDecoder<std::size_t> {
+  static std::size_t Decode(CloudEvent const& event) {
+    return event.data_bytes().size();
+  }
+};
+
+namespace {
+
+TEST(CloudEventTest, DataAs) {
+  test_data_decodes = 0;
+  auto actual = CloudEvent("test-id", "test-source", "test-type");
+  actual.set_data("some data");
+  auto const a = actual.data_as<TestData>();
+  EXPECT_EQ(a->value, "some data");
+  auto const b = actual.data_as<TestData>();
+  EXPECT_EQ(a.get(), b.get());
+  EXPECT_EQ(test_data_decodes, 1);
+
+  // Copies share the result.
+  auto const copy = actual;
+  EXPECT_EQ(copy.data_as<TestData>().get(), a.get());
+  EXPECT_EQ(test_data_decodes, 1);
+
+  // A different type replaces the result.
+  EXPECT_EQ(*actual.data_as<std::size_t>(), 9);
+  EXPECT_EQ(actual.data_as<TestData>()->value, "some data");
+  EXPECT_EQ(test_data_decodes, 2);
+
+  // Changing the data discards the result.
+  actual.set_data("new data");
+  EXPECT_EQ(actual.data_as<TestData>()->value, "new data");
+  actual.reset_data();
+  EXPECT_EQ(actual.data_as<TestData>()->value, "");
+  EXPECT_EQ(test_data_decodes, 4);
+  // Previous results remain valid.
+  EXPECT_EQ(a->value, "some data");
+}
+
 }  // namespace
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions
@@ -0,0 +1,136 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/cloud_event_writer.h"
+#include "google/cloud/functions/internal/base64_decode.h"
+#include "google/cloud/functions/internal/json_writer.h"
+#include "google/cloud/functions/internal/parse_time.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::google::cloud::functions_internal::JsonAppendString;
+
+/// Matches `application/json`, and any `+json` suffix, ignoring parameters.
+bool IsJsonMediaType(std::string_view content_type) {
+  content_type = content_type.substr(0, content_type.find(';'));
+  while (!content_type.empty() && content_type.back() == ' ') {
+    content_type.remove_suffix(1);
+  }
+  auto const suffix = std::string_view{"+json"};
+  return content_type == "application/json" ||
+         (content_type.size() > suffix.size() &&
+          content_type.substr(content_type.size() - suffix.size()) == suffix);
+}
+
+void AppendMember(std::string& out, std::string_view name,
+                  std::string_view value) {
+  out.push_back(',');
+  JsonAppendString(out, name);
+  out.push_back(':');
+  JsonAppendString(out, value);
+}
+
+/// Header values cannot contain control characters, such as CR or LF.
+std::string HeaderValue(std::string_view name, std::string_view value) {
+  auto const invalid = std::any_of(value.begin(), value.end(), [](char c) {
+    auto const u = static_cast<unsigned char>(c);
+    return u < 0x20 || u == 0x7F;
+  });
+  if (invalid) {
+    throw std::invalid_argument("invalid character in the " +
+                                std::string(name) + " attribute");
+  }
+  return std::string(value);
+}
+
+}  // namespace
+
+void ToStructuredJson(CloudEvent const& event, std::string& out) {
+  // The names of the required attributes need no escaping, and start the
+  // object without a leading comma.
+  out.append(R"({"specversion":)");
+  JsonAppendString(out, event.spec_version_view());
+  AppendMember(out, "id", event.id_view());
+  AppendMember(out, "source", event.source_view());
+  AppendMember(out, "type", event.type_view());
+  auto const content_type = event.data_content_type_view();
+  if (content_type) AppendMember(out, "datacontenttype", *content_type);
+  if (auto v = event.data_schema_view()) AppendMember(out, "dataschema", *v);
+  if (auto v = event.subject_view()) AppendMember(out, "subject", *v);
+  if (auto t = event.time()) {
+    out.append(R"(,"time":")");
+    functions_internal::FormatRfc3339(*t, out);
+    out.push_back('"');
+  }
+  for (auto const& [name, value] : event.extensions()) {
+    AppendMember(out, name, value);
+  }
+  if (auto data = event.data_view()) {
+    if (content_type && IsJsonMediaType(*content_type)) {
+      out.append(R"(,"data":)").append(*data);
+    } else if (functions_internal::IsValidUtf8(*data)) {
+      AppendMember(out, "data", *data);
+    } else {
+      out.append(R"(,"data_base64":")");
+      functions_internal::Base64Encode(*data, out);
+      out.push_back('"');
+    }
+  }
+  out.push_back('}');
+}
+
+void ToBatchJson(absl::Span<CloudEvent const> events, std::string& out) {
+  out.push_back('[');
+  for (auto const& e : events) {
+    if (&e != events.data()) out.push_back(',');
+    ToStructuredJson(e, out);
+  }
+  out.push_back(']');
+}
+
+void ToBinaryHttp(CloudEvent const& event, HttpHeaders& headers,
+                  std::string& body) {
+  headers.set("ce-specversion",
+              HeaderValue("specversion", event.spec_version_view()));
+  headers.set("ce-id", HeaderValue("id", event.id_view()));
+  headers.set("ce-source", HeaderValue("source", event.source_view()));
+  headers.set("ce-type", HeaderValue("type", event.type_view()));
+  if (auto v = event.data_content_type_view()) {
+    headers.set("content-type", HeaderValue("datacontenttype", *v));
+  }
+  if (auto v = event.data_schema_view()) {
+    headers.set("ce-dataschema", HeaderValue("dataschema", *v));
+  }
+  if (auto v = event.subject_view()) {
+    headers.set("ce-subject", HeaderValue("subject", *v));
+  }
+  if (auto t = event.time()) {
+    std::string time;
+    functions_internal::FormatRfc3339(*t, time);
+    headers.set("ce-time", std::move(time));
+  }
+  for (auto const& [name, value] : event.extensions()) {
+    headers.set("ce-" + std::string(name), HeaderValue(name, value));
+  }
+  if (auto data = event.data_view()) body.append(*data);
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
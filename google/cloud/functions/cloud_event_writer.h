@@ -0,0 +1,68 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CLOUD_EVENT_WRITER_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CLOUD_EVENT_WRITER_H
+
+#include "google/cloud/functions/cloud_event.h"
+#include "google/cloud/functions/http_headers.h"
+#include "google/cloud/functions/version.h"
+#include <absl/types/span.h>
+#include <string>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * @name Serialize Cloud Events.
+ *
+ * These functions append to a caller-provided buffer, which can be reused
+ * across events. The output can be parsed by the framework, and by any other
+ * CloudEvents SDK.
+ *
+ * In the JSON formats the data is written as-is if `data_content_type()` is a
+ * JSON media type, such as `application/json`, and the data must be valid
+ * JSON. Otherwise the data is written as a JSON string if it is valid UTF-8,
+ * and as `data_base64` if it is not.
+ *
+ * @par Example
+ * @code
+ * std::string body;
+ * gcf::ToBatchJson(events, body);
+ * client.Post(url, "application/cloudevents-batch+json", body);
+ * @endcode
+ */
+///@{
+
+/// Appends @p event to @p out, in the structured JSON format.
+void ToStructuredJson(CloudEvent const& event, std::string& out);
+
+/// Appends @p events to @p out, as a JSON batch.
+void ToBatchJson(absl::Span<CloudEvent const> events, std::string& out);
+
+/**
+ * Formats @p event in the HTTP binary content mode.
+ *
+ * Adds the `ce-*` and `content-type` headers to @p headers, and appends the
+ * event data to @p body. Throws `std::invalid_argument` if an attribute
+ * cannot be represented as a header value.
+ */
+void ToBinaryHttp(CloudEvent const& event, HttpHeaders& headers,
+                  std::string& body);
+///@}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_CLOUD_EVENT_WRITER_H
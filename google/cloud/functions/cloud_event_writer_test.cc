@@ -0,0 +1,152 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/cloud_event_writer.h"
+#include "google/cloud/functions/internal/parse_cloud_event_json.h"
+#include <gmock/gmock.h>
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+CloudEvent TestEvent() {
+  auto event = CloudEvent("test-id", "/test/\"source\"", "test.type");
+  event.set_subject("some-subject");
+  event.set_data_schema("https://example.com/schema");
+  event.set_time(CloudEvent::time_point{} + std::chrono::seconds(1606739685) +
+                 std::chrono::milliseconds(678));
+  event.set_extension("traceparent", "00-abc-01");
+  return event;
+}
+
+TEST(CloudEventWriter, StructuredJson) {
+  auto event = TestEvent();
+  event.set_data_content_type("application/json");
+  event.set_data(R"js({"name": "Foo"})js");
+  std::string out;
+  ToStructuredJson(event, out);
+  EXPECT_EQ(nlohmann::json::parse(out), nlohmann::json::parse(R"js({
+    "specversion": "1.0",
+    "id": "test-id",
+    "source": "/test/\"source\"",
+    "type": "test.type",
+    "datacontenttype": "application/json",
+    "dataschema": "https://example.com/schema",
+    "subject": "some-subject",
+    "time": "2020-11-30T12:34:45.678Z",
+    "traceparent": "00-abc-01",
+    "data": {"name": "Foo"}
+  })js"));
+}
+
+TEST(CloudEventWriter, StructuredJsonMinimal) {
+  std::string out;
+  ToStructuredJson(CloudEvent("a", "b", "c"), out);
+  EXPECT_EQ(out, R"({"specversion":"1.0","id":"a","source":"b","type":"c"})");
+}
+
+TEST(CloudEventWriter, StructuredJsonData) {
+  auto event = CloudEvent("a", "b", "c");
+  event.set_data_content_type("text/plain");
+  event.set_data("line 1\nline 2");
+  std::string text;
+  ToStructuredJson(event, text);
+  EXPECT_EQ(nlohmann::json::parse(text).value("data", ""), "line 1\nline 2");
+
+  event.set_data_content_type("application/vnd.example+json; charset=utf-8");
+  event.set_data("[1, 2]");
+  std::string json;
+  ToStructuredJson(event, json);
+  EXPECT_EQ(nlohmann::json::parse(json)["data"], nlohmann::json({1, 2}));
+
+  event.set_data_content_type("application/octet-stream");
+  event.set_data(std::string("\0\xff\xfe", 3));
+  std::string binary;
+  ToStructuredJson(event, binary);
+  auto const parsed = nlohmann::json::parse(binary);
+  EXPECT_FALSE(parsed.contains("data"));
+  EXPECT_EQ(parsed.value("data_base64", ""), "AP/+");
+}
+
+TEST(CloudEventWriter, RoundTrip) {
+  auto event = TestEvent();
+  event.set_data_content_type("application/octet-stream");
+  event.set_data(std::string("\0\xff\xfe", 3));
+  std::string out;
+  ToStructuredJson(event, out);
+  auto const actual = functions_internal::ParseCloudEventJson(out);
+  EXPECT_EQ(actual.id(), event.id());
+  EXPECT_EQ(actual.source(), event.source());
+  EXPECT_EQ(actual.type(), event.type());
+  EXPECT_EQ(actual.subject(), event.subject());
+  EXPECT_EQ(actual.data_schema(), event.data_schema());
+  EXPECT_EQ(actual.time(), event.time());
+  EXPECT_EQ(actual.extensions(), event.extensions());
+  EXPECT_EQ(actual.data(), event.data());
+}
+
+TEST(CloudEventWriter, BatchJson) {
+  std::vector<CloudEvent> events{CloudEvent("a", "s", "t"),
+                                 CloudEvent("b", "s", "t")};
+  std::string out;
+  ToBatchJson(events, out);
+  std::vector<std::string> ids;
+  for (auto const& e : functions_internal::ParseCloudEventJsonBatch(out)) {
+    ids.push_back(e.id());
+  }
+  EXPECT_THAT(ids, ElementsAre("a", "b"));
+
+  std::string empty;
+  ToBatchJson({}, empty);
+  EXPECT_EQ(empty, "[]");
+}
+
+TEST(CloudEventWriter, BinaryHttp) {
+  auto event = TestEvent();
+  event.set_data_content_type("text/plain");
+  event.set_data("Hello");
+  HttpHeaders headers;
+  std::string body;
+  ToBinaryHttp(event, headers, body);
+  EXPECT_THAT(headers,
+              ElementsAre(Pair("ce-specversion", "1.0"),
+                          Pair("ce-id", "test-id"),
+                          Pair("ce-source", "/test/\"source\""),
+                          Pair("ce-type", "test.type"),
+                          Pair("content-type", "text/plain"),
+                          Pair("ce-dataschema", "https://example.com/schema"),
+                          Pair("ce-subject", "some-subject"),
+                          Pair("ce-time", "2020-11-30T12:34:45.678Z"),
+                          Pair("ce-traceparent", "00-abc-01")));
+  EXPECT_EQ(body, "Hello");
+}
+
+TEST(CloudEventWriter, BinaryHttpInvalidHeader) {
+  auto event = CloudEvent("a", "s", "t");
+  event.set_subject("injected\r\nx-header: value");
+  HttpHeaders headers;
+  std::string body;
+  EXPECT_THROW(ToBinaryHttp(event, headers, body), std::invalid_argument);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
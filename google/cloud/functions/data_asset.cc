@@ -0,0 +1,196 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/data_asset.h"
+#include "google/cloud/functions/internal/crc32c.h"
+#include "google/cloud/functions/internal/structured_log.h"
+#include "google/cloud/functions/background_executor.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// The mapping shared by the copies of a `DataAsset`, and its checks.
+struct DataAssetState {
+  DataAssetState() = default;
+  ~DataAssetState() {
+#ifndef _WIN32
+    if (mapping != nullptr) ::munmap(mapping, mapping_size);
+#endif  // _WIN32
+  }
+  DataAssetState(DataAssetState const&) = delete;
+  DataAssetState& operator=(DataAssetState const&) = delete;
+
+  std::string path;
+  std::string_view data;
+  void* mapping = nullptr;
+  std::size_t mapping_size = 0;
+  std::string buffer;
+
+  std::mutex mu;
+  std::condition_variable cv;
+  bool done = true;
+  std::exception_ptr error;
+};
+
+namespace {
+
+void Map(DataAssetState& state) {
+#ifdef _WIN32
+  std::ifstream is(state.path, std::ios::binary);
+  if (!is) throw std::runtime_error("cannot open data asset " + state.path);
+  state.buffer.assign(std::istreambuf_iterator<char>(is),
+                      std::istreambuf_iterator<char>());
+  state.data = state.buffer;
+#else
+  auto const fd = ::open(state.path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) throw std::runtime_error("cannot open data asset " + state.path);
+  struct stat st {};
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw std::runtime_error("cannot read data asset " + state.path);
+  }
+  auto const size = static_cast<std::size_t>(st.st_size);
+  if (size != 0) {
+    // The read-only pages are shared with the page cache, and with all the
+    // processes mapping the file.
+    auto* p = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+      ::close(fd);
+      throw std::runtime_error("cannot map data asset " + state.path);
+    }
+    state.mapping = p;
+    state.mapping_size = size;
+    state.data = std::string_view(static_cast<char const*>(p), size);
+  }
+  ::close(fd);
+#endif  // _WIN32
+}
+
+/// Reads one byte of each page, so later reads find the pages in memory.
+void Prefault(DataAssetState const& state) {
+#ifndef _WIN32
+  if (state.mapping == nullptr) return;
+  // Starts reading ahead, while this thread waits for each page in turn.
+  (void)::madvise(state.mapping, state.mapping_size, MADV_WILLNEED);
+  auto const page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  auto const data = state.data;
+  unsigned char sum = 0;
+  for (std::size_t i = 0; i < data.size(); i += page) {
+    sum += static_cast<unsigned char>(data[i]);
+  }
+  // Keeps the compiler from removing the reads.
+  static std::atomic<unsigned char> sink{0};
+  sink.store(sum, std::memory_order_relaxed);
+#else
+  (void)state;
+#endif  // _WIN32
+}
+
+void RunChecks(DataAssetState const& state,
+               functions::DataAssetOptions const& options) {
+  if (options.prefault) Prefault(state);
+  if (options.crc32c) {
+    auto const actual = ExtendCrc32c(0, state.data);
+    if (actual != *options.crc32c) {
+      throw std::runtime_error("data asset " + state.path +
+                               " does not match its CRC32C checksum");
+    }
+  }
+  if (options.validate) options.validate(state.data);
+}
+
+}  // namespace
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+DataAsset::DataAsset(std::string const& path, DataAssetOptions options)
+    : state_(std::make_shared<functions_internal::DataAssetState>()) {
+  state_->path = path;
+  functions_internal::Map(*state_);
+  if (!options.prefault && !options.crc32c && !options.validate) return;
+
+  state_->done = false;
+  BackgroundExecutor::Default().Submit(
+      [state = state_, options = std::move(options)] {
+        std::exception_ptr error;
+        try {
+          functions_internal::RunChecks(*state, options);
+        } catch (std::exception const& ex) {
+          functions_internal::WriteLog(LogSeverity::kError, ex.what());
+          error = std::current_exception();
+        } catch (...) {
+          functions_internal::WriteLog(
+              LogSeverity::kError,
+              "data asset " + state->path + " failed validation");
+          error = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lk(state->mu);
+        state->error = std::move(error);
+        state->done = true;
+        state->cv.notify_all();
+      });
+}
+
+std::string_view DataAsset::data() const { return state_->data; }
+
+void DataAsset::Wait() const {
+  std::unique_lock<std::mutex> lk(state_->mu);
+  state_->cv.wait(lk, [this] { return state_->done; });
+  if (state_->error) std::rethrow_exception(state_->error);
+}
+
+bool DataAsset::ready() const {
+  std::lock_guard<std::mutex> lk(state_->mu);
+  return state_->done;
+}
+
+void const* DataAsset::Address(std::size_t offset, std::size_t count,
+                               std::size_t size, std::size_t alignment) const {
+  auto const data = state_->data;
+  if (offset > data.size() || count > (data.size() - offset) / size) {
+    throw std::out_of_range("the objects at offset " + std::to_string(offset) +
+                            " extend past the end of data asset " +
+                            state_->path);
+  }
+  auto const* p = data.data() + offset;
+  if (reinterpret_cast<std::uintptr_t>(p) % alignment != 0) {
+    throw std::invalid_argument("offset " + std::to_string(offset) +
+                                " in data asset " + state_->path +
+                                " is not aligned for the object type");
+  }
+  return p;
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
@@ -0,0 +1,149 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_DATA_ASSET_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_DATA_ASSET_H
+
+#include "google/cloud/functions/version.h"
+#include <absl/types/span.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+struct DataAssetState;
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// Configures the background work of a `DataAsset`.
+struct DataAssetOptions {
+  /**
+   * Reads every page of the file in the background.
+   *
+   * Without it the pages are read from disk as the requests first touch them,
+   * which may be slow for the first requests of a new instance.
+   */
+  bool prefault = false;
+  /// If set, the CRC32C checksum of the file, checked in the background.
+  std::optional<std::uint32_t> crc32c;
+  /**
+   * If set, called in the background with the contents of the file.
+   *
+   * Throw to reject the contents, e.g. if a header has the wrong version.
+   */
+  std::function<void(std::string_view)> validate;
+};
+
+/**
+ * A read-only file, such as a lookup table or a model, mapped into memory.
+ *
+ * Functions often parse large data files into heap memory on each cold start,
+ * and each worker process holds its own copy. Instead, build the data into a
+ * file with a position-independent layout, e.g. arrays of fixed-size records
+ * and offsets instead of pointers, ship it in the container image, and map
+ * it. Mapping the file takes the same time regardless of its size, the pages
+ * are read from disk as needed, and they are shared by all the processes
+ * mapping the file, e.g., the `--processes` workers. The operating system
+ * may reclaim the pages under memory pressure, and read them again later,
+ * instead of terminating the instance.
+ *
+ * The checks and the prefaulting in `DataAssetOptions` run in
+ * `BackgroundExecutor::Default()`. The data is usable immediately, use
+ * `Wait()` to require the checks, e.g. in a warmup function:
+ *
+ * @code
+ * namespace gcf = ::google::cloud::functions;
+ * gcf::LazyGlobal<gcf::DataAsset> table([] {
+ *   gcf::DataAssetOptions options;
+ *   options.prefault = true;
+ *   return gcf::DataAsset("/srv/table.bin", std::move(options));
+ * });
+ *
+ * int main(int argc, char* argv[]) {
+ *   return gcf::Run(argc, argv, gcf::WithWarmup(MyFunction(), [] {
+ *     table->Wait();
+ *   }));
+ * }
+ * @endcode
+ *
+ * Copies share the same mapping, which lives until the last copy is
+ * destroyed. The data must not change while the file is mapped, replace the
+ * file instead. On Windows the file is read into memory.
+ */
+class DataAsset {
+ public:
+  /// @throws std::runtime_error if @p path cannot be opened or mapped.
+  explicit DataAsset(std::string const& path, DataAssetOptions options = {});
+
+  /// The contents of the file.
+  [[nodiscard]] std::string_view data() const;
+  [[nodiscard]] std::size_t size() const { return data().size(); }
+
+  /**
+   * The object of type `T` at @p offset in the file.
+   *
+   * @throws std::out_of_range if the object extends past the end of the file.
+   * @throws std::invalid_argument if @p offset is not aligned for `T`.
+   */
+  template <typename T>
+  [[nodiscard]] T const& As(std::size_t offset = 0) const {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "DataAsset only contains trivially copyable objects");
+    return *static_cast<T const*>(Address(offset, 1, sizeof(T), alignof(T)));
+  }
+
+  /// The @p count objects of type `T` starting at @p offset, see `As()`.
+  template <typename T>
+  [[nodiscard]] absl::Span<T const> AsArray(std::size_t offset,
+                                            std::size_t count) const {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "DataAsset only contains trivially copyable objects");
+    return {static_cast<T const*>(
+                Address(offset, count, sizeof(T), alignof(T))),
+            count};
+  }
+
+  /**
+   * Waits for the background checks and prefaulting, if any.
+   *
+   * @throws std::runtime_error if the checksum does not match, or the
+   *     exception thrown by `DataAssetOptions::validate`.
+   */
+  void Wait() const;
+
+  /// Returns true once the background work, if any, is done.
+  [[nodiscard]] bool ready() const;
+
+ private:
+  /// The address of @p count objects of @p size bytes, checked.
+  [[nodiscard]] void const* Address(std::size_t offset, std::size_t count,
+                                    std::size_t size,
+                                    std::size_t alignment) const;
+
+  std::shared_ptr<functions_internal::DataAssetState> state_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_DATA_ASSET_H
@@ -0,0 +1,139 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/data_asset.h"
+#include "google/cloud/functions/internal/crc32c.h"
+#include <gmock/gmock.h>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+
+struct Record {
+  std::uint32_t key;
+  std::uint32_t value;
+};
+
+class DataAssetTest : public ::testing::Test {
+ protected:
+  DataAssetTest()
+      : path_((std::filesystem::temp_directory_path() /
+               ("data_asset_test_" + std::to_string(std::random_device{}())))
+                  .string()) {}
+  ~DataAssetTest() override { std::filesystem::remove(path_); }
+
+  std::string const& Write(std::string const& contents) {
+    std::ofstream(path_, std::ios::binary) << contents;
+    return path_;
+  }
+
+  static std::string Records() {
+    std::string contents;
+    for (std::uint32_t i = 0; i != 4; ++i) {
+      Record r{i, i * 10};
+      contents.append(reinterpret_cast<char const*>(&r), sizeof(r));
+    }
+    return contents;
+  }
+
+ private:
+  std::string path_;
+};
+
+TEST_F(DataAssetTest, Map) {
+  auto const& path = Write(Records());
+  DataAsset asset(path);
+  EXPECT_TRUE(asset.ready());
+  EXPECT_NO_THROW(asset.Wait());
+  EXPECT_EQ(asset.size(), 4 * sizeof(Record));
+  EXPECT_EQ(asset.data(), Records());
+  EXPECT_EQ(asset.As<Record>(sizeof(Record)).value, 10);
+  auto const records = asset.AsArray<Record>(0, 4);
+  ASSERT_EQ(records.size(), 4);
+  EXPECT_EQ(records[3].key, 3);
+  EXPECT_EQ(records[3].value, 30);
+
+  // The copies share the mapping.
+  auto copy = asset;
+  EXPECT_EQ(copy.data().data(), asset.data().data());
+}
+
+TEST_F(DataAssetTest, Bounds) {
+  DataAsset asset(Write(Records()));
+  EXPECT_THROW((void)asset.As<Record>(4 * sizeof(Record)), std::out_of_range);
+  EXPECT_THROW((void)asset.AsArray<Record>(sizeof(Record), 4),
+               std::out_of_range);
+  EXPECT_THROW((void)asset.AsArray<Record>(0, SIZE_MAX), std::out_of_range);
+  EXPECT_THROW((void)asset.As<Record>(1), std::invalid_argument);
+  EXPECT_TRUE(asset.AsArray<Record>(4 * sizeof(Record), 0).empty());
+}
+
+TEST_F(DataAssetTest, Empty) {
+  DataAsset asset(Write(""));
+  EXPECT_TRUE(asset.data().empty());
+  EXPECT_THROW((void)asset.As<Record>(), std::out_of_range);
+}
+
+TEST_F(DataAssetTest, Missing) {
+  EXPECT_THROW(DataAsset("/nonexistent/data_asset_test"), std::runtime_error);
+}
+
+TEST_F(DataAssetTest, Checks) {
+  auto const contents = Records();
+  auto const crc32c = functions_internal::ExtendCrc32c(0, contents);
+  auto const& path = Write(contents);
+
+  DataAssetOptions options;
+  options.prefault = true;
+  options.crc32c = crc32c;
+  std::string validated;
+  options.validate = [&validated](std::string_view data) {
+    validated = std::string(data);
+  };
+  DataAsset asset(path, options);
+  EXPECT_NO_THROW(asset.Wait());
+  EXPECT_TRUE(asset.ready());
+  EXPECT_EQ(validated, contents);
+}
+
+TEST_F(DataAssetTest, ChecksumMismatch) {
+  DataAssetOptions options;
+  options.crc32c = 42;
+  DataAsset asset(Write(Records()), options);
+  // The data is usable before, and after, the checks.
+  EXPECT_EQ(asset.As<Record>().key, 0);
+  EXPECT_THROW(asset.Wait(), std::runtime_error);
+  EXPECT_TRUE(asset.ready());
+}
+
+TEST_F(DataAssetTest, ValidationFailure) {
+  DataAssetOptions options;
+  options.validate = [](std::string_view data) {
+    if (data.substr(0, 4) != "MAGI") throw std::invalid_argument("bad magic");
+  };
+  DataAsset asset(Write(Records()), options);
+  EXPECT_THROW(asset.Wait(), std::invalid_argument);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
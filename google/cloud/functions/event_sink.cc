@@ -0,0 +1,93 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/event_sink.h"
+#include "google/cloud/functions/internal/base64_decode.h"
+#include "google/cloud/functions/internal/event_sink.h"
+#include "google/cloud/functions/internal/json_writer.h"
+#include "google/cloud/functions/cloud_event_writer.h"
+#include <utility>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using Format = functions_internal::EventSinkImpl::Format;
+
+/// Formats @p message as a `PubsubMessage` in the Pub/Sub REST API.
+std::string ToPublishJson(PubsubMessage const& message) {
+  std::string out = R"({"data":")";
+  functions_internal::Base64Encode(message.data, out);
+  out.push_back('"');
+  if (!message.attributes.empty()) {
+    out += R"(,"attributes":{)";
+    for (auto const& [key, value] : message.attributes) {
+      if (out.back() != '{') out.push_back(',');
+      functions_internal::JsonAppendString(out, key);
+      out.push_back(':');
+      functions_internal::JsonAppendString(out, value);
+    }
+    out.push_back('}');
+  }
+  if (!message.ordering_key.empty()) {
+    out += R"(,"orderingKey":)";
+    functions_internal::JsonAppendString(out, message.ordering_key);
+  }
+  out.push_back('}');
+  return out;
+}
+
+}  // namespace
+
+EventSink::EventSink(EventSinkOptions options) {
+  auto client = std::make_shared<HttpClient>(options.client_options);
+  impl_ = std::make_shared<functions_internal::EventSinkImpl>(
+      std::move(options),
+      [client](HttpRequest request, HttpClientCallback callback) {
+        client->AsyncSend(std::move(request), std::move(callback));
+      });
+  impl_->Start();
+}
+
+EventSink::~EventSink() {
+  if (impl_) impl_->Shutdown();
+}
+
+EventSink::EventSink(EventSink&&) noexcept = default;
+
+EventSink& EventSink::operator=(EventSink&& rhs) noexcept {
+  if (impl_) impl_->Shutdown();
+  impl_ = std::move(rhs.impl_);
+  return *this;
+}
+
+void EventSink::Emit(std::string const& url, CloudEvent const& event) {
+  std::string item;
+  ToStructuredJson(event, item);
+  impl_->Queue(url, Format::kCloudEventBatch, std::move(item));
+}
+
+void EventSink::Publish(std::string const& topic,
+                        PubsubMessage const& message) {
+  impl_->Queue(topic, Format::kPubsubPublish, ToPublishJson(message));
+}
+
+void EventSink::Flush() { impl_->Flush(); }
+
+std::size_t EventSink::pending() const { return impl_->pending(); }
+
+std::uint64_t EventSink::failed() const { return impl_->failed(); }
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
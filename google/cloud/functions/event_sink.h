@@ -0,0 +1,129 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_EVENT_SINK_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_EVENT_SINK_H
+
+#include "google/cloud/functions/cloud_event.h"
+#include "google/cloud/functions/http_client.h"
+#include "google/cloud/functions/pubsub_message.h"
+#include "google/cloud/functions/version.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+class EventSinkImpl;
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+struct EventSinkOptions {
+  /// A batch is sent once it has this many messages.
+  std::size_t max_batch_messages = 100;
+
+  /// A batch is sent before its payload would exceed this many bytes.
+  std::size_t max_batch_bytes = 1024 * 1024;
+
+  /// A batch is sent this long after its first message, at the latest.
+  std::chrono::milliseconds max_batch_delay = std::chrono::milliseconds(10);
+
+  /// The options of the client sending the batches.
+  HttpClientOptions client_options;
+};
+
+/**
+ * Sends Cloud Events and Pub/Sub messages in batches.
+ *
+ * Functions that fan out often send one message per call, and wait for each
+ * call. Instead, queue the messages in a sink: it accumulates them for each
+ * destination, and sends a batch once it is full, or after
+ * `max_batch_delay`, with a `HttpClient` that reuses its connections.
+ *
+ * The framework delivers the messages queued by a request before sending its
+ * response, the batches with these messages are sent as soon as the function
+ * returns. If any of them fails the response is replaced with a
+ * `500 Internal Server Error`, so the caller retries the request. Only the
+ * messages queued in the thread running the function, before it returns, are
+ * tracked this way. The messages queued elsewhere, e.g., in background tasks,
+ * are flushed during a graceful shutdown, for up to the
+ * `--shutdown-grace-period`.
+ *
+ * The destinations are `http://` URLs, as in `HttpClient`:
+ * - `Emit()` sends the events as a JSON batch, with the
+ *   `application/cloudevents-batch+json` content type.
+ * - `Publish()` calls the `:publish` method of a Pub/Sub topic, e.g.,
+ *   `http://localhost:8085/v1/projects/my-project/topics/my-topic` for the
+ *   emulator, or a sidecar adding the credentials.
+ *
+ * The batches for a destination may be delivered concurrently, and thus out
+ * of order. Create one sink and share it, it is safe to use from multiple
+ * threads:
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * gcf::LazyGlobal<gcf::EventSink> sink([] { return gcf::EventSink(); });
+ *
+ * gcf::HttpResponse Handler(gcf::HttpRequest const& request) {
+ *   for (auto const& item : Split(request.payload())) {
+ *     gcf::PubsubMessage message;
+ *     message.data = item;
+ *     sink->Publish(kTopic, message);
+ *   }
+ *   return gcf::HttpResponse{};
+ * }
+ * @endcode
+ */
+class EventSink {
+ public:
+  explicit EventSink(EventSinkOptions options = {});
+
+  /// Delivers the queued messages, then closes the sink.
+  ~EventSink();
+
+  EventSink(EventSink&&) noexcept;
+  EventSink& operator=(EventSink&&) noexcept;
+
+  /// Queues @p event, for the endpoint at @p url.
+  void Emit(std::string const& url, CloudEvent const& event);
+
+  /**
+   * Queues @p message, for the Pub/Sub @p topic.
+   *
+   * Only the data, the attributes, and the ordering key are published.
+   */
+  void Publish(std::string const& topic, PubsubMessage const& message);
+
+  /// Sends all the queued messages, and waits for their delivery.
+  void Flush();
+
+  /// The number of messages queued, or being sent.
+  [[nodiscard]] std::size_t pending() const;
+
+  /// The number of messages that could not be delivered.
+  [[nodiscard]] std::uint64_t failed() const;
+
+ private:
+  std::shared_ptr<functions_internal::EventSinkImpl> impl_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_EVENT_SINK_H
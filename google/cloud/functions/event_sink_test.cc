@@ -0,0 +1,116 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/event_sink.h"
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <gmock/gmock.h>
+#include <future>
+#include <string>
+#include <thread>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace asio = boost::asio;
+namespace be = boost::beast;
+namespace http = be::http;
+using tcp = asio::ip::tcp;
+
+/// Accepts one connection, and returns the first request.
+class OneRequestServer {
+ public:
+  OneRequestServer()
+      : acceptor_(ioc_, tcp::endpoint(asio::ip::make_address("127.0.0.1"), 0)),
+        request_(std::async(std::launch::async, [this] { return Serve(); })) {}
+
+  [[nodiscard]] std::string url(std::string const& path) const {
+    return "http://127.0.0.1:" +
+           std::to_string(acceptor_.local_endpoint().port()) + path;
+  }
+
+  http::request<http::string_body> request() { return request_.get(); }
+
+ private:
+  http::request<http::string_body> Serve() {
+    auto socket = acceptor_.accept();
+    be::flat_buffer buffer;
+    http::request<http::string_body> request;
+    http::read(socket, buffer, request);
+    http::response<http::string_body> response{http::status::ok, 11};
+    response.body() = "{}";
+    response.prepare_payload();
+    http::write(socket, response);
+    return request;
+  }
+
+  asio::io_context ioc_;
+  tcp::acceptor acceptor_;
+  std::future<http::request<http::string_body>> request_;
+};
+
+TEST(EventSinkTest, Publish) {
+  OneRequestServer server;
+  EventSink sink;
+  PubsubMessage message;
+  message.data = "Hello";
+  message.attributes = {{"a", "1"}, {"b", "2"}};
+  message.ordering_key = "k";
+  sink.Publish(server.url("/v1/projects/p/topics/t"), message);
+  PubsubMessage world;
+  world.data = "World";
+  sink.Publish(server.url("/v1/projects/p/topics/t"), world);
+  sink.Flush();
+  EXPECT_EQ(sink.pending(), 0);
+  EXPECT_EQ(sink.failed(), 0);
+  auto const request = server.request();
+  EXPECT_EQ(request.method(), http::verb::post);
+  EXPECT_EQ(request.target(), "/v1/projects/p/topics/t:publish");
+  EXPECT_EQ(request.body(),
+            R"({"messages":[)"
+            R"({"data":"SGVsbG8=","attributes":{"a":"1","b":"2"},)"
+            R"("orderingKey":"k"},)"
+            R"({"data":"V29ybGQ="}]})");
+}
+
+TEST(EventSinkTest, Emit) {
+  OneRequestServer server;
+  EventSink sink;
+  sink.Emit(server.url("/events"),
+            CloudEvent("id-1", "//source", "com.example.test"));
+  sink.Flush();
+  EXPECT_EQ(sink.failed(), 0);
+  auto const request = server.request();
+  EXPECT_EQ(request[http::field::content_type],
+            "application/cloudevents-batch+json");
+  EXPECT_THAT(request.body(), ::testing::StartsWith("[{"));
+  EXPECT_THAT(request.body(), ::testing::HasSubstr(R"("id":"id-1")"));
+}
+
+TEST(EventSinkTest, Failed) {
+  EventSinkOptions options;
+  options.client_options.connect_timeout = std::chrono::seconds(5);
+  EventSink sink(options);
+  sink.Emit("https://example.com/events",
+            CloudEvent("id-1", "//source", "com.example.test"));
+  sink.Flush();
+  EXPECT_EQ(sink.pending(), 0);
+  EXPECT_EQ(sink.failed(), 1);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
@@ -14,6 +14,8 @@
 
 #include "google/cloud/functions/function.h"
 #include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/static_assets.h"
+#include "google/cloud/functions/raw_function.h"
 
 namespace google::cloud::functions {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
@@ -29,7 +31,25 @@ Function MakeFunction(UserHttpFunction function) {
           std::move(function)));
 }
 
-Function MakeFunction(UserCloudEventFunction function) {
+Function MakeFunction(UserRawHttpFunction function) {
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::BaseFunctionImpl>(
+          std::move(function)));
+}
+
+Function MakeFunction(UserHttpStreamingFunction function) {
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::BaseFunctionImpl>(
+          std::move(function)));
+}
+
+Function MakeFunction(UserHttpStreamingResponseFunction function) {
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::BaseFunctionImpl>(
+          std::move(function)));
+}
+
+Function MakeFunction(UserHttpAsyncFunction function) {
   return functions_internal::FunctionImpl::MakeFunction(
       std::make_shared<functions_internal::BaseFunctionImpl>(
           std::move(function)));
@@ -41,5 +61,149 @@ Function MakeFunction(std::map<std::string, Function> mapping) {
           std::move(mapping)));
 }
 
+Function MakeFunction(
+    std::map<std::string, std::function<Function()>> factories) {
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::MapFunctionImpl>(
+          std::move(factories)));
+}
+
+Function MakeStaticAssetFunction(std::string const& directory,
+                                 StaticAssetOptions options) {
+  auto assets = std::make_shared<functions_internal::StaticAssets const>(
+      directory, std::move(options));
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::BaseFunctionImpl>(
+          functions_internal::Handler(
+              [assets](functions_internal::BeastRequest request) {
+                return assets->Serve(request);
+              })));
+}
+
+Function MakeWebSocketFunction(UserWebSocketFunction function) {
+  return MakeWebSocketFunction(
+      std::move(function),
+      functions_internal::FunctionImpl::MakeFunction(
+          std::make_shared<functions_internal::BaseFunctionImpl>(
+              functions_internal::Handler(
+                  [](functions_internal::BeastRequest const& request) {
+                    functions_internal::BeastResponse response;
+                    response.version(request.version());
+                    response.result(
+                        boost::beast::http::status::upgrade_required);
+                    response.set(boost::beast::http::field::upgrade,
+                                 "websocket");
+                    response.set(boost::beast::http::field::connection,
+                                 "Upgrade");
+                    return response;
+                  }))));
+}
+
+Function MakeWebSocketFunction(UserWebSocketFunction function, Function http) {
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::WebSocketFunctionImpl>(
+          functions_internal::FunctionImpl::GetImpl(http),
+          std::move(function)));
+}
+
+Function MakeRouter(std::vector<FunctionRoute> routes) {
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::RouterFunctionImpl>(
+          std::move(routes)));
+}
+
+Function WithConcurrencyLimit(Function function,
+                              ConcurrencyLimitOptions options) {
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::ConcurrencyLimitFunctionImpl>(
+          functions_internal::FunctionImpl::GetImpl(function), options));
+}
+
+Function WithOffload(Function function, OffloadOptions options) {
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::OffloadFunctionImpl>(
+          functions_internal::FunctionImpl::GetImpl(function), options));
+}
+
+Function WithWarmup(Function function, UserWarmupFunction warmup) {
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::LifecycleFunctionImpl>(
+          functions_internal::FunctionImpl::GetImpl(function),
+          std::move(warmup), functions_internal::ShutdownHandler{}));
+}
+
+Function WithShutdown(Function function, UserShutdownFunction shutdown) {
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::LifecycleFunctionImpl>(
+          functions_internal::FunctionImpl::GetImpl(function),
+          functions_internal::WarmupHandler{}, std::move(shutdown)));
+}
+
+Function WithCheckpointHooks(Function function,
+                             UserCheckpointFunction before_checkpoint,
+                             UserRestoreFunction after_restore) {
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::LifecycleFunctionImpl>(
+          functions_internal::FunctionImpl::GetImpl(function),
+          functions_internal::WarmupHandler{},
+          functions_internal::ShutdownHandler{},
+          functions_internal::CheckpointHandler{std::move(before_checkpoint),
+                                                std::move(after_restore)}));
+}
+
+Function WithPrecheck(Function function, UserHttpPrecheckFunction precheck) {
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::PrecheckFunctionImpl>(
+          functions_internal::FunctionImpl::GetImpl(function),
+          std::move(precheck)));
+}
+
+Function WithValidator(Function function, UserHttpValidatorFunction validator) {
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::ValidatorFunctionImpl>(
+          functions_internal::FunctionImpl::GetImpl(function),
+          std::move(validator)));
+}
+
+Function WithCoalescing(Function function, CoalescingOptions options) {
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::CoalescingFunctionImpl>(
+          functions_internal::FunctionImpl::GetImpl(function),
+          std::move(options)));
+}
+
+Function WithResponseCache(Function function, ResponseCacheOptions options) {
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::ResponseCacheFunctionImpl>(
+          functions_internal::FunctionImpl::GetImpl(function),
+          std::move(options)));
+}
+
+Function WithRateLimit(Function function, RateLimitOptions options) {
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::RateLimitFunctionImpl>(
+          functions_internal::FunctionImpl::GetImpl(function),
+          std::move(options)));
+}
+
+Function WithTracing(Function function,
+                     std::shared_ptr<SpanExporter> exporter) {
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::TracingFunctionImpl>(
+          functions_internal::FunctionImpl::GetImpl(function),
+          std::move(exporter)));
+}
+
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+functions::Function MakeTypedFunction(std::unique_ptr<UserHttpCallable> f) {
+  return FunctionImpl::MakeFunction(
+      std::make_shared<BaseFunctionImpl>(std::shared_ptr(std::move(f))));
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
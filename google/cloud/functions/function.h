@@ -15,9 +15,17 @@
 #ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_FUNCTION_H
 #define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_FUNCTION_H
 
+#include "google/cloud/functions/internal/typed_function.h"
+#include "google/cloud/functions/trace_context.h"
 #include "google/cloud/functions/user_functions.h"
 #include "google/cloud/functions/version.h"
+#include <functional>
 #include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
@@ -79,9 +87,113 @@ class Function {
 /// Wraps an `http` handler.
 Function MakeFunction(UserHttpFunction function);
 
-/// Wraps a `cloud event` handler.
+/**
+ * Wraps an `http` or `cloud event` handler, keeping its type.
+ *
+ * The framework stores @p function as-is, instead of converting it to a
+ * `std::function<>`. It is called through one indirection instead of two, and
+ * it may be move-only, e.g., a lambda capturing a `std::unique_ptr<>`.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * auto MyFunction() {
+ *   return gcf::MakeFunction(
+ *       [state = std::make_unique<State>()](gcf::HttpRequest const& r) {
+ *         return state->Handle(r);
+ *       });
+ * }
+ * @endcode
+ */
+template <typename F,
+          std::enable_if_t<
+              functions_internal::kIsTypedHttpFunction<F> ||
+                  functions_internal::kIsTypedCloudEventFunction<F>,
+              int> = 0>
+Function MakeFunction(F&& function) {
+  using Callable = std::decay_t<F>;
+  if constexpr (functions_internal::kIsTypedHttpFunction<F>) {
+    return functions_internal::MakeTypedFunction(
+        std::make_unique<functions_internal::UserCallableImpl<
+            Callable, HttpResponse(HttpRequest)>>(std::forward<F>(function)));
+  } else {
+    return functions_internal::MakeTypedFunction(
+        std::make_unique<
+            functions_internal::UserCallableImpl<Callable, void(CloudEvent)>>(
+            std::forward<F>(function)));
+  }
+}
+
+/**
+ * Wraps an `http` handler that reads the request body incrementally.
+ *
+ * The framework runs these functions in a separate pool of threads, and reads
+ * the request body as the function consumes it. Use `--streaming-threads` to
+ * configure the size of this pool.
+ */
+Function MakeFunction(UserHttpStreamingFunction function);
+
+/**
+ * Wraps an `http` handler that sends its response incrementally.
+ *
+ * The framework runs these functions in the same thread pool as the functions
+ * reading the request body incrementally.
+ */
+Function MakeFunction(UserHttpStreamingResponseFunction function);
+
+/**
+ * Wraps a `cloud event` handler.
+ *
+ * The framework moves each event into @p function. Handlers may take the
+ * event by value or as a `CloudEvent const&`, neither copies the event data.
+ */
 Function MakeFunction(UserCloudEventFunction function);
 
+/**
+ * Wraps a `cloud event` handler that runs the events of a batch concurrently.
+ *
+ * If any event fails the response reports all the failures. The handler must
+ * be safe to call from multiple threads. With `options.ordering_key` events
+ * with the same key, e.g., the same Pub/Sub ordering key, still run in order.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * auto MyFunction() {
+ *   gcf::CloudEventBatchOptions options;
+ *   options.parallelism = 8;
+ *   options.ordering_key = gcf::PubsubOrderingKey;
+ *   return gcf::MakeFunction(MyHandler, options);
+ * }
+ * @endcode
+ */
+Function MakeFunction(UserCloudEventFunction function,
+                      CloudEventBatchOptions options);
+
+/// Wraps a `cloud event` handler that receives all the events in a request.
+Function MakeFunction(UserCloudEventBatchFunction function);
+
+/**
+ * Wraps an `http` handler that completes asynchronously.
+ *
+ * The handler runs in the server's threads, and must not block. The
+ * connection resumes once the handler calls its callback.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * auto MyFunction() {
+ *   return gcf::MakeFunction(
+ *       [](gcf::HttpRequest r, gcf::HttpResponseCallback done) {
+ *         StartLookup(std::move(r), [done](std::string value) {
+ *           done(gcf::HttpResponse{}.set_payload(std::move(value)));
+ *         });
+ *       });
+ * }
+ * @endcode
+ */
+Function MakeFunction(UserHttpAsyncFunction function);
+
+/// Wraps a `cloud event` handler that completes asynchronously.
+Function MakeFunction(UserCloudEventAsyncFunction function);
+
 /**
  * Creates a function with support for runtime-assigned targets.
  *
@@ -92,6 +204,474 @@ Function MakeFunction(UserCloudEventFunction function);
  */
 Function MakeFunction(std::map<std::string, Function> mapping);
 
+/**
+ * Creates a function with support for runtime-assigned targets, creating only
+ * the function for the selected target.
+ *
+ * Like the previous overload, but the map contains factories. During startup
+ * the framework calls the factory for the selected target, and only that
+ * factory. Use this in binaries that serve many targets, so each one does not
+ * pay for initializing all the others.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * auto MyFunctions() {
+ *   return gcf::MakeFunction(
+ *       std::map<std::string, std::function<gcf::Function()>>{
+ *           {"orders", [] { return gcf::MakeFunction(OrdersHandler()); }},
+ *           {"users", [] { return gcf::MakeFunction(UsersHandler()); }},
+ *       });
+ * }
+ * @endcode
+ */
+Function MakeFunction(
+    std::map<std::string, std::function<Function()>> factories);
+
+/**
+ * Serves the files in @p directory.
+ *
+ * The files are loaded once, when this function is called, together with
+ * their entity tags and their gzip and brotli variants. Each request is served
+ * from memory without copying the file: the variant is chosen from the
+ * `Accept-Encoding` header, `If-None-Match` requests may get `304 Not
+ * Modified`, and `Range` requests get `206 Partial Content`. Use
+ * this for small web UIs or API documents, files changed after startup are
+ * not reloaded.
+ *
+ * The request path maps to the file with the same path relative to
+ * @p directory, and paths ending in `/` to `options.index` in that directory.
+ * Hidden files and directories, with names starting with `.`, are not served.
+ * Other methods than `GET` and `HEAD` get `405 Method Not Allowed`.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * auto MyFunction() {
+ *   gcf::StaticAssetOptions options;
+ *   options.cache_control = "public, max-age=3600";
+ *   return gcf::MakeRouter({
+ *       {"/api/", gcf::MakeFunction(Api)},
+ *       {"/", gcf::MakeStaticAssetFunction("/srv/ui", options)},
+ *   });
+ * }
+ * @endcode
+ *
+ * @throws std::runtime_error if @p directory, or a file in it, cannot be read.
+ */
+Function MakeStaticAssetFunction(std::string const& directory,
+                                 StaticAssetOptions options = {});
+
+/**
+ * Serves WebSocket connections, and rejects all other requests.
+ *
+ * The framework accepts the upgrade requests (RFC 6455) in its own server,
+ * with its timeouts and limits: `--max-body-size` limits the size of each
+ * message, and `--idle-timeout` closes the connections without traffic. The
+ * server sends pings to keep the active connections open. During a graceful
+ * shutdown it closes the connections with the `1001 Going Away` status.
+ *
+ * Requests that are not WebSocket upgrades get `426 Upgrade Required`.
+ * Exceptions thrown by @p function reject the upgrade with a
+ * `500 Internal Server Error`, exceptions thrown by the callbacks close the
+ * connection with the `1011 Internal Error` status. Both are logged.
+ *
+ * The prechecks, such as those added by `WithPrecheck()` and
+ * `WithRateLimit()`, also check the upgrade requests.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * auto Echo() {
+ *   return gcf::MakeWebSocketFunction(
+ *       [](gcf::HttpRequest const&, std::shared_ptr<gcf::WebSocket> socket) {
+ *         return gcf::WebSocketCallbacks{
+ *             [socket](std::string message, bool) {
+ *               socket->Send(std::move(message));
+ *             },
+ *             {}};
+ *       });
+ * }
+ * @endcode
+ *
+ * The callbacks may capture the `WebSocket`, the framework releases them once
+ * the connection closes.
+ */
+Function MakeWebSocketFunction(UserWebSocketFunction function);
+
+/// Serves WebSocket connections, and all other requests with @p http.
+Function MakeWebSocketFunction(UserWebSocketFunction function, Function http);
+
+/// A route for `MakeRouter()`.
+struct FunctionRoute {
+  FunctionRoute(std::string path_prefix, Function function,
+                std::string method = {})
+      : path_prefix(std::move(path_prefix)),
+        function(std::move(function)),
+        method(std::move(method)) {}
+
+  /// The path prefix, such as `/api` or `/static/`.
+  std::string path_prefix;
+  Function function;
+  /// The HTTP method, such as `GET`. An empty method matches any method.
+  std::string method;
+};
+
+/**
+ * Creates a function that routes each request to one of several functions.
+ *
+ * One instance can serve several functions, instead of deploying each one
+ * separately. The request path selects the route with the longest matching
+ * prefix. The prefixes match whole path segments: `/api` matches `/api` and
+ * `/api/v1`, but not `/apis`. A prefix ending in `/` matches any path below
+ * it. Routes for the request method win over routes for any method. Requests
+ * that match no route receive a `404 Not Found` response, before the body is
+ * read.
+ *
+ * The functions receive the request unchanged, including the prefix. Streaming
+ * and asynchronous functions are called through their buffered, blocking
+ * handlers.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * auto MyFunction() {
+ *   return gcf::MakeRouter({
+ *       {"/orders/", gcf::MakeFunction(ListOrders), "GET"},
+ *       {"/orders/", gcf::MakeFunction(CreateOrder), "POST"},
+ *       {"/events", gcf::MakeFunction(OnEvent)},
+ *   });
+ * }
+ * @endcode
+ *
+ * @throws std::invalid_argument if a prefix does not start with `/`, or two
+ *     routes have the same prefix and method.
+ */
+Function MakeRouter(std::vector<FunctionRoute> routes);
+
+/**
+ * Limits how many requests @p function runs at once.
+ *
+ * Requests beyond `options.max_concurrency` wait in a queue of at most
+ * `options.max_queue` requests. Requests that do not fit are rejected with
+ * `503 Service Unavailable` and a `Retry-After` header, before the body is
+ * read. Synchronous functions run in a dedicated pool of
+ * `options.max_concurrency` threads, so a burst of slow requests does not
+ * occupy the server threads. Streaming functions are called through their
+ * buffered handlers.
+ *
+ * Use this with `MakeRouter()` to isolate slow routes from fast ones.
+ *
+ * With `options.lane_weights` and `options.classifier` waiting requests are
+ * split into priority lanes, for example, health checks, interactive queries,
+ * and bulk backfills. Each lane has its own queue, and when the function is
+ * saturated the lanes share the free slots in proportion to their weights,
+ * so a backlog of batch requests absorbs most of the queuing while the
+ * latency-critical requests keep moving.
+ *
+ * A fixed limit is either too high, and requests queue inside the function,
+ * or too low, and throughput is left unused. With `options.adaptive` the
+ * limit follows the latency of the requests instead: it grows while the
+ * latency stays near its long-term average, and shrinks once requests slow
+ * down. Then `options.max_concurrency` is only an upper bound, though
+ * synchronous functions still get a pool of that size.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * auto MyFunction() {
+ *   gcf::ConcurrencyLimitOptions options;
+ *   options.max_concurrency = 2;
+ *   options.max_queue = 16;
+ *   return gcf::MakeRouter({
+ *       {"/render", gcf::WithConcurrencyLimit(
+ *                       gcf::MakeFunction(Render), options)},
+ *       {"/", gcf::MakeFunction(Lookup)},
+ *   });
+ * }
+ * @endcode
+ *
+ * To favor interactive requests over batch requests:
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * auto MyFunction() {
+ *   gcf::ConcurrencyLimitOptions options;
+ *   options.max_concurrency = 8;
+ *   options.max_queue = 64;
+ *   options.lane_weights = {8, 1};
+ *   options.classifier = [](gcf::HttpRequest const& r) -> std::size_t {
+ *     return r.target().rfind("/batch/", 0) == 0 ? 1 : 0;
+ *   };
+ *   return gcf::WithConcurrencyLimit(gcf::MakeFunction(Query), options);
+ * }
+ * @endcode
+ *
+ * To find the limit between 4 and 256 requests:
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * auto MyFunction() {
+ *   gcf::ConcurrencyLimitOptions options;
+ *   options.adaptive = true;
+ *   options.min_concurrency = 4;
+ *   options.max_concurrency = 256;
+ *   options.max_queue = 1024;
+ *   return gcf::WithConcurrencyLimit(gcf::MakeFunction(QueryAsync), options);
+ * }
+ * @endcode
+ *
+ * @throws std::invalid_argument if a lane weight is not greater than 0, or
+ *     `options.min_concurrency` is greater than `options.max_concurrency`.
+ */
+Function WithConcurrencyLimit(Function function,
+                              ConcurrencyLimitOptions options);
+
+/**
+ * Runs @p function in a separate pool, off the server threads.
+ *
+ * Synchronous functions run in the server threads, which also read and write
+ * all the connections. Wrap compute-heavy or blocking functions, such as
+ * image resizing or large JSON transformations, so they do not delay the
+ * requests of other connections. The response is written by the server
+ * threads once the function returns. Streaming and asynchronous functions
+ * already run off the server threads, they are unchanged.
+ *
+ * Unlike `WithConcurrencyLimit()` requests are never rejected, they wait for
+ * a thread of the pool.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * auto MyFunction() {
+ *   return gcf::MakeRouter({
+ *       {"/resize", gcf::WithOffload(gcf::MakeFunction(Resize))},
+ *       {"/", gcf::MakeFunction(Lookup)},
+ *   });
+ * }
+ * @endcode
+ */
+Function WithOffload(Function function, OffloadOptions options = {});
+
+/**
+ * Runs @p warmup during startup, before the server accepts any request.
+ *
+ * Use this for initialization that would otherwise delay the first requests,
+ * such as creating clients, loading models, or filling caches. The server
+ * does not listen on its port until all the warmup functions complete, so
+ * startup probes (and thus traffic) stay away from instances that are not
+ * ready. The warmup functions, added by nesting `WithWarmup()`, run in
+ * parallel. If any of them throws an exception the server does not start,
+ * and `Run()` returns a non-zero value.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * auto MyFunction() {
+ *   return gcf::WithWarmup(
+ *       gcf::WithWarmup(gcf::MakeFunction(Handle), [] { LoadModel(); }),
+ *       [] { FillCache(); });
+ * }
+ * @endcode
+ */
+Function WithWarmup(Function function, UserWarmupFunction warmup);
+
+/**
+ * Runs @p shutdown once the server stops serving requests.
+ *
+ * The server runs the shutdown functions after all the connections close, and
+ * any background tasks complete, in the reverse order they were added, i.e.
+ * the outermost `WithShutdown()` runs first. Use this to flush and release
+ * clients and connection pools in an orderly way.
+ */
+Function WithShutdown(Function function, UserShutdownFunction shutdown);
+
+/**
+ * Runs @p before_checkpoint before the server is checkpointed, and
+ * @p after_restore once it is restored.
+ *
+ * With `--checkpoint-ready-file` the server pauses after the warmup, before it
+ * listens on its port, so it can be checkpointed with CRIU or a similar tool,
+ * and restored in milliseconds instead of running the initialization again.
+ * The server does not open a listening socket until it is restored, and it
+ * reseeds its own random number generators after the restore.
+ *
+ * Use @p before_checkpoint to close the connections that must not be
+ * captured, for example client connection pools, and @p after_restore to
+ * reopen them, and to reseed any random number generators or reset any
+ * clocks captured during the warmup. Either function may be empty. The
+ * `before_checkpoint` functions run in the reverse order they were added,
+ * the `after_restore` functions in the order they were added.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * auto MyFunction() {
+ *   return gcf::WithCheckpointHooks(
+ *       gcf::WithWarmup(gcf::MakeFunction(Handle), [] { LoadModel(); }),
+ *       [] { CloseClients(); }, [] { OpenClients(); });
+ * }
+ * @endcode
+ */
+Function WithCheckpointHooks(Function function,
+                             UserCheckpointFunction before_checkpoint,
+                             UserRestoreFunction after_restore);
+
+/**
+ * Adds a check to @p function that runs once the request header is received.
+ *
+ * Requests rejected by @p precheck get its response without reading the body,
+ * and the connection is closed. If the client sent `Expect: 100-continue` it
+ * is asked to send the body only if the request is accepted. Use this to
+ * reject unauthorized or unwanted uploads cheaply.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * auto MyFunction() {
+ *   return gcf::WithPrecheck(
+ *       gcf::MakeFunction(MyHandler),
+ *       [](gcf::HttpRequest const& r) -> std::optional<gcf::HttpResponse> {
+ *         if (r.headers().count("authorization") != 0) return std::nullopt;
+ *         return gcf::HttpResponse{}.set_result(
+ *             gcf::HttpResponse::kUnauthorized);
+ *       });
+ * }
+ * @endcode
+ */
+Function WithPrecheck(Function function, UserHttpPrecheckFunction precheck);
+
+/**
+ * Answers conditional requests for @p function without calling it.
+ *
+ * The framework calls @p validator once the request header is received. If
+ * the request is a `GET` or `HEAD` with an `If-None-Match` header that matches
+ * the entity tag returned by @p validator, the framework sends a
+ * `304 Not Modified` response, and @p function does not run. Otherwise
+ * @p function runs, and its successful responses get the entity tag in an
+ * `ETag` header, unless they have one. If @p validator throws, the request is
+ * handled as if it returned no entity tag.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * auto MyFunction() {
+ *   return gcf::WithValidator(
+ *       gcf::MakeFunction(ServeConfig),
+ *       [](gcf::HttpRequest const&) -> std::optional<std::string> {
+ *         return CurrentConfigVersion();
+ *       });
+ * }
+ * @endcode
+ */
+Function WithValidator(Function function, UserHttpValidatorFunction validator);
+
+/**
+ * Shares one call of @p function between identical `GET` and `HEAD` requests
+ * that arrive while it is in progress.
+ *
+ * Requests are identical if they have the same method, target, and values for
+ * `options.headers`, or the same key from `options.key`. The first request
+ * calls @p function, the others wait for its response, and all get a copy of
+ * it. The payload of the response is shared, not copied. Use this in front of
+ * expensive lookups that see bursts of the same request, so a burst costs a
+ * single call. Other requests, and requests without a key, call @p function
+ * directly. Only use this if the response depends on nothing but the key, for
+ * example, not on credentials or cookies, unless they are part of the key.
+ *
+ * The waiting requests of synchronous functions occupy a server thread each,
+ * as the call would, consider an asynchronous function for large bursts.
+ * Streaming functions are called through their buffered handlers.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * auto MyFunction() {
+ *   gcf::CoalescingOptions options;
+ *   options.headers = {"accept-language"};
+ *   return gcf::WithCoalescing(gcf::MakeFunction(RenderPage), options);
+ * }
+ * @endcode
+ */
+Function WithCoalescing(Function function, CoalescingOptions options = {});
+
+/**
+ * Caches the responses of @p function to `GET` and `HEAD` requests in memory.
+ *
+ * A response is cached if @p function allows it with `Cache-Control:
+ * s-maxage=N` or `max-age=N`, and reused for N seconds by requests with the
+ * same method, target, and values for `options.headers`, without calling
+ * @p function. Cached payloads are shared, not copied, and reused responses
+ * have an `Age` header. Responses marked `private`, `no-store`, or `no-cache`,
+ * with `Set-Cookie`, or that `Vary` on headers not in `options.headers` are
+ * not cached. Neither are file payloads. When the cache is over
+ * `options.max_bytes` the least recently used responses are discarded.
+ *
+ * Requests with an `Authorization` header or `Cache-Control: no-store` always
+ * call @p function, and `Cache-Control: no-cache` or `max-age=0` refreshes the
+ * cached response. Streaming functions are called through their buffered
+ * handlers.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * gcf::HttpResponse RenderPage(gcf::HttpRequest request) {
+ *   auto response = Render(request);
+ *   response.set_header("Cache-Control", "public, max-age=60");
+ *   return response;
+ * }
+ *
+ * auto MyFunction() {
+ *   gcf::ResponseCacheOptions options;
+ *   options.headers = {"accept-language"};
+ *   return gcf::WithResponseCache(gcf::MakeFunction(RenderPage), options);
+ * }
+ * @endcode
+ */
+Function WithResponseCache(Function function,
+                           ResponseCacheOptions options = {});
+
+/**
+ * Limits the rate of requests from each client to @p function.
+ *
+ * Each client has a token bucket, holding up to `options.burst` tokens and
+ * refilled at `options.requests_per_second`. Each request takes a token,
+ * requests from clients without tokens are rejected with
+ * `429 Too Many Requests` and a `Retry-After` header. The check runs once the
+ * request header is received, before any other check, and before the body is
+ * read. Use this to protect the latency of all clients from a few abusive
+ * clients, or from runaway retry loops.
+ *
+ * By default the clients are identified by the last address in
+ * `X-Forwarded-For`, as appended by the load balancer, or by the address of
+ * the peer if the header is missing. Use `options.header` for another header,
+ * such as an API key, or `options.key` to derive the key from the request, for
+ * example, the subject of a token. Requests without a key from
+ * `options.key` are not limited.
+ *
+ * The limits apply to each instance of the server.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * auto MyFunction() {
+ *   gcf::RateLimitOptions options;
+ *   options.requests_per_second = 5;
+ *   options.burst = 20;
+ *   options.header = "X-Api-Key";
+ *   return gcf::WithRateLimit(gcf::MakeFunction(Lookup), options);
+ * }
+ * @endcode
+ */
+Function WithRateLimit(Function function, RateLimitOptions options = {});
+
+/**
+ * Records a span for each sampled request to @p function.
+ *
+ * Requests with a sampled trace context, in a `traceparent` or
+ * `X-Cloud-Trace-Context` header, run in a new child span. The trace context
+ * headers seen by @p function refer to the new span, so use
+ * `HttpRequest::trace_context()` to propagate it in outbound calls. Once the
+ * response is complete the span is sent to @p exporter. Requests that are not
+ * sampled only pay for the header lookup.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * auto MyFunction() {
+ *   return gcf::WithTracing(gcf::MakeFunction(Handle),
+ *                           std::make_shared<MyCloudTraceExporter>());
+ * }
+ * @endcode
+ */
+Function WithTracing(Function function, std::shared_ptr<SpanExporter> exporter);
+
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions
 
@@ -0,0 +1,445 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/http_client.h"
+#include "google/cloud/functions/internal/client_event_loop.h"
+#include "google/cloud/functions/internal/structured_log.h"
+#include "google/cloud/functions/internal/wrap_request.h"
+#include "google/cloud/functions/internal/wrap_response.h"
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace asio = boost::asio;
+namespace be = boost::beast;
+using tcp = asio::ip::tcp;
+using Clock = std::chrono::steady_clock;
+
+/// The components of an absolute `http://` URL.
+struct HttpUrl {
+  std::string host;
+  std::string port;
+  std::string target;
+};
+
+HttpUrl ParseHttpUrl(std::string_view url) {
+  auto constexpr kScheme = std::string_view("http://");
+  if (url.size() < kScheme.size() ||
+      !be::iequals(url.substr(0, kScheme.size()), kScheme)) {
+    throw std::invalid_argument(
+        "HttpClient requires an absolute http:// URL, got <" +
+        std::string(url) + ">");
+  }
+  url.remove_prefix(kScheme.size());
+  auto const end = url.find_first_of("/?#");
+  auto authority = url.substr(0, end);
+  auto path = end == std::string_view::npos ? std::string_view{}
+                                            : url.substr(end);
+  path = path.substr(0, path.find('#'));
+  if (authority.find('@') != std::string_view::npos) {
+    throw std::invalid_argument("HttpClient does not support user information"
+                                " in URLs");
+  }
+  HttpUrl result;
+  result.port = "80";
+  // IPv6 literals are enclosed in brackets, e.g. `[::1]:8080`.
+  auto const colon = authority.rfind(':');
+  auto const bracket = authority.rfind(']');
+  if (colon != std::string_view::npos &&
+      (bracket == std::string_view::npos || colon > bracket)) {
+    result.port = std::string(authority.substr(colon + 1));
+    authority = authority.substr(0, colon);
+  }
+  if (authority.size() >= 2 && authority.front() == '[' &&
+      authority.back() == ']') {
+    authority = authority.substr(1, authority.size() - 2);
+  }
+  if (authority.empty() || result.port.empty()) {
+    throw std::invalid_argument(
+        "HttpClient cannot parse the host and port in <" + std::string(url) +
+        ">");
+  }
+  result.host = std::string(authority);
+  result.target = path.empty() || path.front() != '/'
+                      ? "/" + std::string(path)
+                      : std::string(path);
+  return result;
+}
+
+bool IsIdempotent(be::http::verb verb) {
+  switch (verb) {
+    case be::http::verb::get:
+    case be::http::verb::head:
+    case be::http::verb::put:
+    case be::http::verb::delete_:
+    case be::http::verb::options:
+    case be::http::verb::trace:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/// A connection kept open between requests.
+struct PooledConnection {
+  explicit PooledConnection(std::shared_ptr<asio::io_context> ctx)
+      : ioc(std::move(ctx)), stream(asio::make_strand(*ioc)) {}
+
+  // Declared before `stream`, the event loop must outlive the socket.
+  std::shared_ptr<asio::io_context> ioc;
+  be::tcp_stream stream;
+  be::flat_buffer buffer;
+  Clock::time_point idle_since;
+};
+
+}  // namespace
+
+/// The connection pool and address cache shared by the calls of a client.
+class HttpClientImpl {
+ public:
+  explicit HttpClientImpl(functions::HttpClientOptions options)
+      : options_(std::move(options)) {}
+
+  [[nodiscard]] functions::HttpClientOptions const& options() const {
+    return options_;
+  }
+
+  /// Returns an idle connection to @p key running in @p ioc, if any.
+  std::unique_ptr<PooledConnection> TakeIdle(std::string const& key,
+                                             asio::io_context const& ioc) {
+    std::lock_guard<std::mutex> lk(mu_);
+    auto const i = idle_.find(key);
+    if (i == idle_.end()) return nullptr;
+    auto& connections = i->second;
+    auto const expired = Clock::now() - options_.idle_timeout;
+    connections.erase(
+        std::remove_if(connections.begin(), connections.end(),
+                       [&](auto const& c) {
+                         return c->idle_since < expired || c->ioc->stopped();
+                       }),
+        connections.end());
+    // The most recently used connection is the least likely to be closed by
+    // the peer.
+    auto const c = std::find_if(
+        connections.rbegin(), connections.rend(),
+        [&ioc](auto const& c) { return c->ioc.get() == &ioc; });
+    std::unique_ptr<PooledConnection> result;
+    if (c != connections.rend()) {
+      result = std::move(*c);
+      connections.erase(std::next(c).base());
+    }
+    if (connections.empty()) idle_.erase(i);
+    return result;
+  }
+
+  /// Keeps @p connection open for the next calls to @p key.
+  void ReturnIdle(std::string const& key,
+                  std::unique_ptr<PooledConnection> connection) {
+    std::lock_guard<std::mutex> lk(mu_);
+    auto& connections = idle_[key];
+    if (connections.size() >= options_.max_idle_connections_per_host) return;
+    connection->idle_since = Clock::now();
+    connections.push_back(std::move(connection));
+  }
+
+  [[nodiscard]] std::size_t idle_connections() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    std::size_t count = 0;
+    for (auto const& [key, connections] : idle_) count += connections.size();
+    return count;
+  }
+
+  std::optional<tcp::resolver::results_type> CachedAddresses(
+      std::string const& key) {
+    std::lock_guard<std::mutex> lk(mu_);
+    auto const i = addresses_.find(key);
+    if (i == addresses_.end()) return std::nullopt;
+    if (i->second.expiration < Clock::now()) {
+      addresses_.erase(i);
+      return std::nullopt;
+    }
+    return i->second.results;
+  }
+
+  void CacheAddresses(std::string const& key,
+                      tcp::resolver::results_type results) {
+    if (options_.dns_ttl == std::chrono::seconds(0)) return;
+    std::lock_guard<std::mutex> lk(mu_);
+    addresses_[key] =
+        CachedResults{std::move(results), Clock::now() + options_.dns_ttl};
+  }
+
+  /// Forgets the addresses for @p key, e.g., after they failed to connect.
+  void InvalidateAddresses(std::string const& key) {
+    std::lock_guard<std::mutex> lk(mu_);
+    addresses_.erase(key);
+  }
+
+ private:
+  struct CachedResults {
+    tcp::resolver::results_type results;
+    Clock::time_point expiration;
+  };
+
+  functions::HttpClientOptions const options_;
+  mutable std::mutex mu_;
+  std::map<std::string, std::vector<std::unique_ptr<PooledConnection>>> idle_;
+  std::map<std::string, CachedResults> addresses_;
+};
+
+namespace {
+
+/**
+ * A single call, from picking a connection to the callback.
+ *
+ * The asynchronous operations run one at a time, in the strand of the
+ * connection, or of the resolver before a connection exists.
+ */
+class HttpClientCall : public std::enable_shared_from_this<HttpClientCall> {
+ public:
+  HttpClientCall(std::shared_ptr<HttpClientImpl> client, ClientEventLoop loop,
+                 BeastRequest request, functions::HttpClientCallback callback)
+      : client_(std::move(client)),
+        loop_(std::move(loop)),
+        strand_(asio::make_strand(*loop_.ioc)),
+        resolver_(strand_),
+        timer_(strand_),
+        request_(std::move(request)),
+        callback_(std::move(callback)) {}
+
+  void Start() {
+    try {
+      auto url = ParseHttpUrl(request_.target());
+      host_ = std::move(url.host);
+      port_ = std::move(url.port);
+      key_ = host_ + ":" + port_;
+      if (request_.method() == be::http::verb::unknown &&
+          request_.method_string().empty()) {
+        request_.method(be::http::verb::get);
+      }
+      request_.target(url.target);
+      request_.set(be::http::field::host, port_ == "80" ? host_ : key_);
+      request_.keep_alive(true);
+      request_.prepare_payload();
+    } catch (...) {
+      return asio::post(strand_, [self = shared_from_this(),
+                                  e = std::current_exception()] {
+        self->Complete(e, {});
+      });
+    }
+    connection_ = client_->TakeIdle(key_, *loop_.ioc);
+    if (connection_) {
+      reused_ = true;
+      return asio::dispatch(connection_->stream.get_executor(),
+                            [self = shared_from_this()] { self->Write(); });
+    }
+    asio::dispatch(strand_, [self = shared_from_this()] { self->Resolve(); });
+  }
+
+ private:
+  void Resolve() {
+    if (auto cached = client_->CachedAddresses(key_)) {
+      return Connect(*std::move(cached), /*cached=*/true);
+    }
+    // The resolver has no timeout of its own.
+    timer_.expires_after(client_->options().connect_timeout);
+    timer_.async_wait([w = weak_from_this()](be::error_code ec) {
+      if (ec) return;
+      if (auto self = w.lock()) self->resolver_.cancel();
+    });
+    resolver_.async_resolve(
+        host_, port_,
+        [self = shared_from_this()](be::error_code ec,
+                                    tcp::resolver::results_type results) {
+          self->timer_.cancel();
+          if (ec == asio::error::operation_aborted) ec = be::error::timeout;
+          if (ec) return self->Fail(ec, "resolving " + self->host_);
+          self->client_->CacheAddresses(self->key_, results);
+          self->Connect(std::move(results), /*cached=*/false);
+        });
+  }
+
+  void Connect(tcp::resolver::results_type results, bool cached) {
+    connection_ = std::make_unique<PooledConnection>(loop_.ioc);
+    connection_->stream.expires_after(client_->options().connect_timeout);
+    connection_->stream.async_connect(
+        results, [self = shared_from_this(), cached](
+                     be::error_code ec, tcp::endpoint const& /*endpoint*/) {
+          if (ec) {
+            // The host may have moved, resolve its addresses again next time.
+            if (cached) self->client_->InvalidateAddresses(self->key_);
+            return self->Fail(ec, "connecting to " + self->key_);
+          }
+          self->Write();
+        });
+  }
+
+  void Write() {
+    connection_->stream.expires_after(client_->options().request_timeout);
+    be::http::async_write(
+        connection_->stream, request_,
+        [self = shared_from_this()](be::error_code ec, std::size_t) {
+          if (ec) return self->Fail(ec, "sending the request");
+          self->Read();
+        });
+  }
+
+  void Read() {
+    parser_.emplace();
+    parser_->body_limit(client_->options().max_response_size);
+    be::http::async_read(
+        connection_->stream, connection_->buffer, *parser_,
+        [self = shared_from_this()](be::error_code ec, std::size_t) {
+          if (ec) return self->Fail(ec, "reading the response");
+          self->OnResponse();
+        });
+  }
+
+  void OnResponse() {
+    auto message = parser_->release();
+    parser_.reset();
+    if (message.keep_alive()) {
+      connection_->stream.expires_never();
+      client_->ReturnIdle(key_, std::move(connection_));
+    }
+    connection_.reset();
+    BeastResponse response;
+    response.result(message.result_int());
+    response.version(message.version());
+    for (auto const& field : message) {
+      response.insert(field.name_string(), field.value());
+    }
+    response.body() = std::move(message.body());
+    Complete(nullptr, UnwrapResponse::wrap(std::move(response)));
+  }
+
+  void Fail(be::error_code ec, std::string const& what) {
+    connection_.reset();
+    // An idle connection may be closed by the peer at any time, retry on a
+    // new connection if the request never reached the peer, or could be
+    // safely repeated.
+    auto const received = parser_ && parser_->got_some();
+    parser_.reset();
+    if (reused_ && !received && ec != be::error::timeout &&
+        IsIdempotent(request_.method())) {
+      reused_ = false;
+      return asio::dispatch(strand_,
+                            [self = shared_from_this()] { self->Resolve(); });
+    }
+    Complete(std::make_exception_ptr(std::system_error(
+                 ec, "HttpClient error " + what + " for " + key_)),
+             {});
+  }
+
+  void Complete(std::exception_ptr error, functions::HttpResponse response) {
+    auto callback = std::move(callback_);
+    try {
+      callback(std::move(error), std::move(response));
+    } catch (std::exception const& ex) {
+      WriteLog(functions::LogSeverity::kError,
+               std::string("Exception in HttpClient callback: ") + ex.what());
+    } catch (...) {
+      WriteLog(functions::LogSeverity::kError,
+               "Unknown exception in HttpClient callback");
+    }
+    // The event loop may stop once the call completes.
+    loop_.work.reset();
+  }
+
+  std::shared_ptr<HttpClientImpl> client_;
+  ClientEventLoop loop_;
+  asio::strand<asio::io_context::executor_type> strand_;
+  tcp::resolver resolver_;
+  asio::steady_timer timer_;
+  BeastRequest request_;
+  functions::HttpClientCallback callback_;
+  std::string host_;
+  std::string port_;
+  std::string key_;
+  std::unique_ptr<PooledConnection> connection_;
+  std::optional<be::http::response_parser<be::http::string_body>> parser_;
+  bool reused_ = false;
+};
+
+void StartCall(std::shared_ptr<HttpClientImpl> client, bool blocking,
+               functions::HttpRequest request,
+               functions::HttpClientCallback callback) {
+  auto call = std::make_shared<HttpClientCall>(
+      std::move(client), AcquireClientEventLoop(blocking),
+      std::move(WrapRequest::unwrap(request)), std::move(callback));
+  call->Start();
+}
+
+}  // namespace
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+HttpClient::HttpClient(HttpClientOptions options)
+    : impl_(std::make_shared<functions_internal::HttpClientImpl>(
+          std::move(options))) {}
+
+HttpClient::~HttpClient() = default;
+
+HttpClient::HttpClient(HttpClient&&) noexcept = default;
+HttpClient& HttpClient::operator=(HttpClient&&) noexcept = default;
+
+void HttpClient::AsyncSend(HttpRequest request, HttpClientCallback callback) {
+  functions_internal::StartCall(impl_, /*blocking=*/false, std::move(request),
+                                std::move(callback));
+}
+
+std::future<HttpResponse> HttpClient::AsyncSend(HttpRequest request) {
+  auto promise = std::make_shared<std::promise<HttpResponse>>();
+  auto f = promise->get_future();
+  // The caller may block on the future, e.g., in a function that is not
+  // asynchronous.
+  functions_internal::StartCall(
+      impl_, /*blocking=*/true, std::move(request),
+      [promise](std::exception_ptr error, HttpResponse response) {
+        if (error) return promise->set_exception(std::move(error));
+        promise->set_value(std::move(response));
+      });
+  return f;
+}
+
+HttpResponse HttpClient::Send(HttpRequest request) {
+  return AsyncSend(std::move(request)).get();
+}
+
+std::size_t HttpClient::idle_connections() const {
+  return impl_->idle_connections();
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
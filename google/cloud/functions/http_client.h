@@ -0,0 +1,137 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_HTTP_CLIENT_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_HTTP_CLIENT_H
+
+#include "google/cloud/functions/http_request.h"
+#include "google/cloud/functions/http_response.h"
+#include "google/cloud/functions/version.h"
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+class HttpClientImpl;
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+struct HttpClientOptions {
+  /// The maximum number of idle connections kept open for each host.
+  std::size_t max_idle_connections_per_host = 16;
+
+  /// Idle connections are closed, instead of reused, after this long.
+  std::chrono::seconds idle_timeout = std::chrono::seconds(60);
+
+  /// The time to resolve the host and connect to it.
+  std::chrono::milliseconds connect_timeout = std::chrono::seconds(10);
+
+  /// The time to send the request and receive the full response.
+  std::chrono::milliseconds request_timeout = std::chrono::seconds(60);
+
+  /// The time to cache the addresses of each host, 0 to resolve each time.
+  std::chrono::seconds dns_ttl = std::chrono::seconds(60);
+
+  /// The maximum size of a response payload, larger responses fail.
+  std::size_t max_response_size = 64 * 1024 * 1024;
+};
+
+/**
+ * Completes an asynchronous `HttpClient` call.
+ *
+ * On success the `std::exception_ptr` is empty, otherwise the response is
+ * empty and the exception describes the error.
+ */
+using HttpClientCallback =
+    std::function<void(std::exception_ptr, functions::HttpResponse)>;
+
+/**
+ * Sends HTTP requests to other services, reusing their connections.
+ *
+ * The client keeps the idle connections to each host open and reuses them
+ * for the next requests, and caches the addresses of each host. Its I/O runs
+ * in the event loops of the server, it creates no threads of its own. Outside
+ * the server, e.g., during the warmup, it uses a single thread shared by all
+ * the clients.
+ *
+ * The request target must be an absolute `http://` URL, e.g.,
+ * `http://backend:8080/items?id=1`. The client sets the `Host` header, and
+ * the `Content-Length` header for the payload. `https://` URLs are not
+ * supported, use a sidecar or a service mesh to encrypt the connections.
+ * Calls that fail on a reused connection before any response is received
+ * are retried once on a new connection, if the request method is idempotent.
+ *
+ * Create one client and share it, it is safe to use from multiple threads:
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * gcf::LazyGlobal<gcf::HttpClient> client([] { return gcf::HttpClient(); });
+ *
+ * void Handler(gcf::HttpRequest request, gcf::HttpResponseCallback done) {
+ *   client->AsyncSend(
+ *       gcf::HttpRequest{}.set_target("http://backend/items"),
+ *       [done](std::exception_ptr error, gcf::HttpResponse response) {
+ *         if (error) return done(gcf::HttpResponse{}.set_result(502));
+ *         done(std::move(response));
+ *       });
+ * }
+ * @endcode
+ */
+class HttpClient {
+ public:
+  explicit HttpClient(HttpClientOptions options = {});
+  ~HttpClient();
+
+  HttpClient(HttpClient&&) noexcept;
+  HttpClient& operator=(HttpClient&&) noexcept;
+
+  /**
+   * Sends @p request, and calls @p callback with the response.
+   *
+   * The callback runs in the event loop that sent the request, and must not
+   * block. For asynchronous functions this is the event loop of the session
+   * calling the function.
+   */
+  void AsyncSend(functions::HttpRequest request, HttpClientCallback callback);
+
+  /// Sends @p request, the future has the response or the error.
+  std::future<functions::HttpResponse> AsyncSend(
+      functions::HttpRequest request);
+
+  /**
+   * Sends @p request and waits for the response.
+   *
+   * Throws on errors. The calling thread blocks, the I/O runs in another
+   * thread. Do not call this from an `HttpClientCallback`.
+   */
+  functions::HttpResponse Send(functions::HttpRequest request);
+
+  /// The number of idle connections kept open, for all hosts.
+  [[nodiscard]] std::size_t idle_connections() const;
+
+ private:
+  std::shared_ptr<functions_internal::HttpClientImpl> impl_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_HTTP_CLIENT_H
@@ -0,0 +1,232 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/http_client.h"
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <gmock/gmock.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace asio = boost::asio;
+namespace be = boost::beast;
+namespace http = be::http;
+using tcp = asio::ip::tcp;
+
+/**
+ * A minimal HTTP server, each response echoes the request.
+ *
+ * Each connection runs in its own thread, and closes after
+ * @p requests_per_connection requests, if not 0, without a
+ * `Connection: close` header.
+ */
+class TestServer {
+ public:
+  explicit TestServer(int requests_per_connection = 0,
+                      std::chrono::milliseconds delay = {})
+      : acceptor_(ioc_, tcp::endpoint(asio::ip::make_address("127.0.0.1"), 0)),
+        requests_per_connection_(requests_per_connection),
+        delay_(delay),
+        thread_([this] { Accept(); }) {}
+
+  ~TestServer() {
+    shutdown_ = true;
+    asio::io_context ioc;
+    tcp::socket wakeup(ioc);
+    be::error_code ec;
+    wakeup.connect(acceptor_.local_endpoint(), ec);
+    thread_.join();
+    for (auto& s : sessions_) s.join();
+  }
+
+  [[nodiscard]] std::string Url(std::string const& path) const {
+    return "http://127.0.0.1:" +
+           std::to_string(acceptor_.local_endpoint().port()) + path;
+  }
+
+  [[nodiscard]] int connections() const { return connections_.load(); }
+
+ private:
+  void Accept() {
+    for (;;) {
+      tcp::socket socket(ioc_);
+      be::error_code ec;
+      acceptor_.accept(socket, ec);
+      if (shutdown_ || ec) return;
+      ++connections_;
+      sessions_.emplace_back(
+          [this, s = std::move(socket)]() mutable { Serve(std::move(s)); });
+    }
+  }
+
+  void Serve(tcp::socket socket) {
+    be::flat_buffer buffer;
+    for (int i = 0;
+         requests_per_connection_ == 0 || i != requests_per_connection_; ++i) {
+      http::request<http::string_body> request;
+      be::error_code ec;
+      http::read(socket, buffer, request, ec);
+      if (ec) return;
+      std::this_thread::sleep_for(delay_);
+      http::response<http::string_body> response{http::status::ok,
+                                                 request.version()};
+      response.set("x-test-host", request[http::field::host]);
+      response.body() = std::string(request.method_string()) + " " +
+                        std::string(request.target()) + " " + request.body();
+      response.keep_alive(request.keep_alive());
+      response.prepare_payload();
+      http::write(socket, response, ec);
+      if (ec) return;
+    }
+  }
+
+  asio::io_context ioc_;
+  tcp::acceptor acceptor_;
+  int requests_per_connection_;
+  std::chrono::milliseconds delay_;
+  std::atomic<bool> shutdown_{false};
+  std::atomic<int> connections_{0};
+  std::vector<std::thread> sessions_;
+  std::thread thread_;
+};
+
+TEST(HttpClientTest, Send) {
+  TestServer server;
+  HttpClient client;
+  auto response = client.Send(HttpRequest{}
+                                  .set_verb("POST")
+                                  .set_target(server.Url("/items?id=1"))
+                                  .set_payload("payload"));
+  EXPECT_EQ(response.result(), HttpResponse::kOkay);
+  EXPECT_EQ(response.payload(), "POST /items?id=1 payload");
+  auto const port = server.Url("").substr(std::string("http://").size());
+  EXPECT_EQ(response.header("x-test-host").value_or(""), port);
+}
+
+TEST(HttpClientTest, DefaultsToGet) {
+  TestServer server;
+  HttpClient client;
+  auto response = client.Send(HttpRequest{}.set_target(server.Url("")));
+  EXPECT_EQ(response.payload(), "GET / ");
+}
+
+TEST(HttpClientTest, ReusesConnections) {
+  TestServer server;
+  HttpClient client;
+  for (int i = 0; i != 3; ++i) {
+    auto response = client.Send(HttpRequest{}.set_target(server.Url("/")));
+    EXPECT_EQ(response.result(), HttpResponse::kOkay);
+    EXPECT_EQ(client.idle_connections(), 1);
+  }
+  EXPECT_EQ(server.connections(), 1);
+}
+
+TEST(HttpClientTest, MaxIdleConnections) {
+  TestServer server;
+  HttpClientOptions options;
+  options.max_idle_connections_per_host = 0;
+  HttpClient client(options);
+  for (int i = 0; i != 2; ++i) {
+    (void)client.Send(HttpRequest{}.set_target(server.Url("/")));
+  }
+  EXPECT_EQ(client.idle_connections(), 0);
+  EXPECT_EQ(server.connections(), 2);
+}
+
+TEST(HttpClientTest, RetriesClosedConnections) {
+  // The server closes each connection after one request.
+  TestServer server(1);
+  HttpClient client;
+  for (int i = 0; i != 3; ++i) {
+    auto response = client.Send(HttpRequest{}.set_target(server.Url("/")));
+    EXPECT_EQ(response.result(), HttpResponse::kOkay);
+  }
+  EXPECT_EQ(server.connections(), 3);
+}
+
+TEST(HttpClientTest, AsyncSend) {
+  TestServer server;
+  HttpClient client;
+  std::promise<std::string> p;
+  client.AsyncSend(HttpRequest{}.set_target(server.Url("/async")),
+                   [&p](std::exception_ptr error, HttpResponse response) {
+                     if (error) return p.set_exception(std::move(error));
+                     p.set_value(response.payload());
+                   });
+  EXPECT_EQ(p.get_future().get(), "GET /async ");
+
+  auto f = client.AsyncSend(HttpRequest{}.set_target(server.Url("/future")));
+  EXPECT_EQ(f.get().payload(), "GET /future ");
+}
+
+TEST(HttpClientTest, InvalidUrl) {
+  HttpClient client;
+  for (auto const* url : {"/relative", "https://example.com/", "http://",
+                          "http://user@example.com/"}) {
+    EXPECT_THROW((void)client.Send(HttpRequest{}.set_target(url)),
+                 std::invalid_argument)
+        << url;
+  }
+}
+
+TEST(HttpClientTest, ConnectionRefused) {
+  std::string url;
+  {
+    TestServer server;
+    url = server.Url("/");
+  }
+  HttpClient client;
+  EXPECT_THROW((void)client.Send(HttpRequest{}.set_target(url)),
+               std::system_error);
+}
+
+TEST(HttpClientTest, RequestTimeout) {
+  TestServer server(0, std::chrono::milliseconds(500));
+  HttpClientOptions options;
+  options.request_timeout = std::chrono::milliseconds(50);
+  HttpClient client(options);
+  EXPECT_THROW((void)client.Send(HttpRequest{}.set_target(server.Url("/"))),
+               std::system_error);
+  EXPECT_EQ(client.idle_connections(), 0);
+}
+
+TEST(HttpClientTest, CallbackExceptionsIgnored) {
+  TestServer server;
+  HttpClient client;
+  std::promise<void> done;
+  client.AsyncSend(HttpRequest{}.set_target(server.Url("/")),
+                   [&done](std::exception_ptr, HttpResponse) {
+                     done.set_value();
+                     throw std::runtime_error("test-only");
+                   });
+  done.get_future().get();
+  // The client is still usable.
+  auto response = client.Send(HttpRequest{}.set_target(server.Url("/")));
+  EXPECT_EQ(response.result(), HttpResponse::kOkay);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
@@ -0,0 +1,142 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/http_headers.h"
+#include <algorithm>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+namespace {
+char ToLower(char c) {
+  if (c >= 'A' && c <= 'Z') return static_cast<char>(c - 'A' + 'a');
+  return c;
+}
+
+/// A case-insensitive FNV-1a hash.
+std::uint32_t HashName(std::string_view name) {
+  auto constexpr kOffsetBasis = std::uint32_t{2166136261U};
+  auto constexpr kPrime = std::uint32_t{16777619U};
+  auto hash = kOffsetBasis;
+  for (auto c : name) {
+    hash ^= static_cast<unsigned char>(ToLower(c));
+    hash *= kPrime;
+  }
+  return hash;
+}
+
+bool EqualNames(std::string_view lhs, std::string_view rhs) {
+  return lhs.size() == rhs.size() &&
+         std::equal(lhs.begin(), lhs.end(), rhs.begin(),
+                    [](char a, char b) { return ToLower(a) == ToLower(b); });
+}
+}  // namespace
+
+HttpHeaders::HttpHeaders(std::initializer_list<value_type> headers) {
+  reserve(headers.size());
+  for (auto const& h : headers) add(h.first, h.second);
+}
+
+HttpHeaders::const_iterator HttpHeaders::find(std::string_view name) const {
+  auto const hash = HashName(name);
+  for (size_type i = 0; i != hashes_.size(); ++i) {
+    if (Matches(i, hash, name)) return entries_.begin() + i;
+  }
+  return entries_.end();
+}
+
+std::pair<HttpHeaders::const_iterator, HttpHeaders::const_iterator>
+HttpHeaders::equal_range(std::string_view name) const {
+  auto const hash = HashName(name);
+  auto i = hashes_.size();
+  for (size_type j = 0; j != hashes_.size(); ++j) {
+    if (Matches(j, hash, name)) {
+      i = j;
+      break;
+    }
+  }
+  auto e = i;
+  while (e != hashes_.size() && Matches(e, hash, name)) ++e;
+  return {entries_.begin() + i, entries_.begin() + e};
+}
+
+HttpHeaders::size_type HttpHeaders::count(std::string_view name) const {
+  auto const hash = HashName(name);
+  size_type n = 0;
+  for (size_type i = 0; i != hashes_.size(); ++i) {
+    if (Matches(i, hash, name)) ++n;
+  }
+  return n;
+}
+
+std::optional<std::string_view> HttpHeaders::get(std::string_view name) const {
+  auto const l = find(name);
+  if (l == end()) return std::nullopt;
+  return l->second;
+}
+
+void HttpHeaders::add(std::string name, std::string value) {
+  insert(value_type(std::move(name), std::move(value)));
+}
+
+HttpHeaders::const_iterator HttpHeaders::insert(value_type header) {
+  auto const hash = HashName(header.first);
+  // Keep the headers with the same name adjacent, `equal_range()` relies on
+  // it. Most headers are new, search from the end.
+  auto i = hashes_.size();
+  while (i != 0 && !Matches(i - 1, hash, header.first)) --i;
+  if (i == 0) i = hashes_.size();
+  hashes_.insert(hashes_.begin() + i, hash);
+  return entries_.insert(entries_.begin() + i, std::move(header));
+}
+
+void HttpHeaders::set(std::string name, std::string value) {
+  erase(name);
+  add(std::move(name), std::move(value));
+}
+
+HttpHeaders::size_type HttpHeaders::erase(std::string_view name) {
+  auto const hash = HashName(name);
+  size_type out = 0;
+  for (size_type i = 0; i != hashes_.size(); ++i) {
+    if (Matches(i, hash, name)) continue;
+    if (out != i) {
+      entries_[out] = std::move(entries_[i]);
+      hashes_[out] = hashes_[i];
+    }
+    ++out;
+  }
+  auto const removed = hashes_.size() - out;
+  entries_.resize(out);
+  hashes_.resize(out);
+  return removed;
+}
+
+void HttpHeaders::clear() {
+  entries_.clear();
+  hashes_.clear();
+}
+
+void HttpHeaders::reserve(size_type n) {
+  entries_.reserve(n);
+  hashes_.reserve(n);
+}
+
+bool HttpHeaders::Matches(size_type i, std::uint32_t hash,
+                          std::string_view name) const {
+  return hashes_[i] == hash && EqualNames(entries_[i].first, name);
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
@@ -0,0 +1,126 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_HTTP_HEADERS_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_HTTP_HEADERS_H
+
+#include "google/cloud/functions/version.h"
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * A list of HTTP headers.
+ *
+ * The headers are kept in the order they were added, in a contiguous array,
+ * except that headers with the same name are adjacent. Header names are
+ * compared case-insensitively, as required by RFC 9110, so
+ * `find("content-type")` also finds a `Content-Type` header. Each name is
+ * hashed once, when it is added, lookups compare the hashes before comparing
+ * any characters.
+ *
+ * The container supports the `std::multimap` functions used to read and add
+ * headers, such as `equal_range()`, `insert()`, and `emplace()`, so code
+ * written for the previous `HeadersType` keeps working.
+ *
+ * @par Example
+ * @code
+ * auto const& headers = request.headers();
+ * if (auto l = headers.find("content-type"); l != headers.end()) {
+ *   std::cout << "content type is " << l->second << "\n";
+ * }
+ * @endcode
+ */
+class HttpHeaders {
+ public:
+  using key_type = std::string;
+  using mapped_type = std::string;
+  using value_type = std::pair<std::string, std::string>;
+  using const_iterator = std::vector<value_type>::const_iterator;
+  using iterator = const_iterator;
+  using size_type = std::size_t;
+
+  HttpHeaders() = default;
+  HttpHeaders(std::initializer_list<value_type> headers);
+
+  [[nodiscard]] const_iterator begin() const { return entries_.begin(); }
+  [[nodiscard]] const_iterator end() const { return entries_.end(); }
+  [[nodiscard]] size_type size() const { return entries_.size(); }
+  [[nodiscard]] bool empty() const { return entries_.empty(); }
+
+  /// Returns the first header named @p name, or `end()`.
+  [[nodiscard]] const_iterator find(std::string_view name) const;
+
+  /// Returns the range of headers named @p name, as in `std::multimap`.
+  [[nodiscard]] std::pair<const_iterator, const_iterator> equal_range(
+      std::string_view name) const;
+
+  /// Returns the number of headers named @p name.
+  [[nodiscard]] size_type count(std::string_view name) const;
+
+  [[nodiscard]] bool contains(std::string_view name) const {
+    return find(name) != end();
+  }
+
+  /// Returns the value of the first header named @p name, if any.
+  [[nodiscard]] std::optional<std::string_view> get(
+      std::string_view name) const;
+
+  /// Adds a header, after any existing headers with the same name.
+  void add(std::string name, std::string value);
+
+  /// Adds a header, as in `std::multimap`, and returns its position.
+  const_iterator insert(value_type header);
+  const_iterator emplace(std::string name, std::string value) {
+    return insert(value_type(std::move(name), std::move(value)));
+  }
+
+  /// Replaces all the headers named @p name with a single header.
+  void set(std::string name, std::string value);
+
+  /// Removes all the headers named @p name, returns the number removed.
+  size_type erase(std::string_view name);
+
+  void clear();
+  void reserve(size_type n);
+
+  friend bool operator==(HttpHeaders const& lhs, HttpHeaders const& rhs) {
+    return lhs.entries_ == rhs.entries_;
+  }
+  friend bool operator!=(HttpHeaders const& lhs, HttpHeaders const& rhs) {
+    return !(lhs == rhs);
+  }
+
+ private:
+  [[nodiscard]] bool Matches(size_type i, std::uint32_t hash,
+                             std::string_view name) const;
+
+  std::vector<value_type> entries_;
+  // The hash of each (lowercase) name, kept separately so lookups scan a
+  // small array of integers.
+  std::vector<std::uint32_t> hashes_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_HTTP_HEADERS_H
@@ -0,0 +1,110 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/http_headers.h"
+#include <gmock/gmock.h>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+
+TEST(HttpHeadersTest, Default) {
+  HttpHeaders headers;
+  EXPECT_TRUE(headers.empty());
+  EXPECT_EQ(headers.size(), 0U);
+  EXPECT_THAT(headers, IsEmpty());
+  EXPECT_EQ(headers.find("content-type"), headers.end());
+  EXPECT_EQ(headers.get("content-type"), std::nullopt);
+}
+
+TEST(HttpHeadersTest, CaseInsensitive) {
+  HttpHeaders const headers{{"Content-Type", "application/json"},
+                            {"x-goog-test", "a"}};
+  EXPECT_EQ(headers.get("content-type"), "application/json");
+  EXPECT_EQ(headers.get("CONTENT-TYPE"), "application/json");
+  EXPECT_EQ(headers.get("X-Goog-Test"), "a");
+  EXPECT_TRUE(headers.contains("x-GOOG-test"));
+  EXPECT_FALSE(headers.contains("x-goog-tes"));
+  EXPECT_FALSE(headers.contains("content_type"));
+  auto const l = headers.find("content-type");
+  ASSERT_NE(l, headers.end());
+  EXPECT_EQ(l->first, "Content-Type");
+}
+
+TEST(HttpHeadersTest, Order) {
+  HttpHeaders headers;
+  headers.add("x-b", "1");
+  headers.add("x-a", "2");
+  headers.add("X-B", "3");
+  // Headers with the same name are adjacent, in the order they were added.
+  EXPECT_THAT(headers, ElementsAre(Pair("x-b", "1"), Pair("X-B", "3"),
+                                   Pair("x-a", "2")));
+  EXPECT_EQ(headers.count("x-b"), 2U);
+  EXPECT_EQ(headers.get("x-b"), "1");
+}
+
+TEST(HttpHeadersTest, MultimapFunctions) {
+  HttpHeaders headers;
+  auto const b = headers.emplace("x-b", "1");
+  EXPECT_EQ(b->second, "1");
+  headers.insert({"x-a", "2"});
+  auto const l = headers.insert({"X-B", "3"});
+  EXPECT_EQ(l->second, "3");
+  headers.insert(std::make_pair("x-c", "4"));
+
+  auto const [begin, end] = headers.equal_range("x-B");
+  std::vector<HttpHeaders::value_type> const range(begin, end);
+  EXPECT_THAT(range, ElementsAre(Pair("x-b", "1"), Pair("X-B", "3")));
+  auto const missing = headers.equal_range("x-missing");
+  EXPECT_EQ(missing.first, missing.second);
+  auto const last = headers.equal_range("x-c");
+  EXPECT_EQ(std::distance(last.first, last.second), 1);
+  EXPECT_EQ(last.second, headers.end());
+}
+
+TEST(HttpHeadersTest, Set) {
+  HttpHeaders headers{{"x-b", "1"}, {"x-a", "2"}, {"X-B", "3"}};
+  headers.set("x-B", "4");
+  EXPECT_THAT(headers, ElementsAre(Pair("x-a", "2"), Pair("x-B", "4")));
+}
+
+TEST(HttpHeadersTest, Erase) {
+  HttpHeaders headers{{"x-b", "1"}, {"x-a", "2"}, {"X-B", "3"}, {"x-c", "4"}};
+  EXPECT_EQ(headers.erase("X-b"), 2U);
+  EXPECT_THAT(headers, ElementsAre(Pair("x-a", "2"), Pair("x-c", "4")));
+  EXPECT_EQ(headers.get("x-c"), "4");
+  EXPECT_EQ(headers.erase("x-missing"), 0U);
+  headers.clear();
+  EXPECT_THAT(headers, IsEmpty());
+  EXPECT_FALSE(headers.contains("x-a"));
+}
+
+TEST(HttpHeadersTest, Equality) {
+  HttpHeaders const a{{"x-a", "1"}};
+  HttpHeaders b;
+  EXPECT_NE(a, b);
+  b.add("x-a", "1");
+  EXPECT_EQ(a, b);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
@@ -0,0 +1,235 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/http_request.h"
+#include "google/cloud/functions/internal/body_checksums.h"
+#include "google/cloud/functions/internal/cancellation.h"
+#include "google/cloud/functions/internal/query_string.h"
+#include "google/cloud/functions/internal/wrap_request.h"
+#include <iterator>
+#include <utility>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+namespace {
+auto constexpr kBeastHttpVersionFactor = 10;
+}  // namespace
+
+HttpRequest::HttpRequest()
+    : impl_(std::make_unique<functions_internal::HttpRequestImpl>()) {}
+
+HttpRequest::HttpRequest(
+    std::unique_ptr<functions_internal::HttpRequestImpl> impl)
+    : impl_(std::move(impl)) {}
+
+HttpRequest::~HttpRequest() = default;
+
+HttpRequest::HttpRequest(HttpRequest const& rhs) : HttpRequest() {
+  // Copy field by field, so the copy uses the default allocator and does not
+  // refer to any memory owned by the connection.
+  auto const& from = rhs.impl_->request;
+  auto& to = impl_->request;
+  to.method_string(from.method_string());
+  to.target(from.target());
+  to.version(from.version());
+  for (auto const& f : from) to.insert(f.name_string(), f.value());
+  to.body() = from.body();
+  impl_->cancellation = rhs.impl_->cancellation;
+  impl_->checksums = rhs.impl_->checksums;
+}
+
+HttpRequest& HttpRequest::operator=(HttpRequest const& rhs) {
+  if (this == &rhs) return *this;
+  HttpRequest tmp(rhs);
+  impl_ = std::move(tmp.impl_);
+  return *this;
+}
+
+// The moved-from request is left empty, as if default constructed, so its
+// accessors remain usable.
+HttpRequest::HttpRequest(HttpRequest&& rhs) noexcept
+    : impl_(std::exchange(
+          rhs.impl_, std::make_unique<functions_internal::HttpRequestImpl>())) {
+}
+
+HttpRequest& HttpRequest::operator=(HttpRequest&& rhs) noexcept {
+  impl_ = std::exchange(
+      rhs.impl_, std::make_unique<functions_internal::HttpRequestImpl>());
+  return *this;
+}
+
+std::string HttpRequest::verb() const { return std::string(verb_view()); }
+
+std::string HttpRequest::target() const { return std::string(target_view()); }
+
+std::string_view HttpRequest::verb_view() const {
+  return impl_->request.method_string();
+}
+
+std::string_view HttpRequest::target_view() const {
+  return impl_->request.target();
+}
+
+std::string_view HttpRequest::path() const {
+  return functions_internal::TargetPath(impl_->request.target());
+}
+
+HttpRequest::QueryParametersType const& HttpRequest::query_parameters() const {
+  std::lock_guard<std::mutex> lk(impl_->query_mu);
+  if (!impl_->query) {
+    impl_->query =
+        functions_internal::ParseQueryParameters(impl_->request.target());
+  }
+  return *impl_->query;
+}
+
+std::optional<std::string_view> HttpRequest::query_parameter(
+    std::string_view name) const {
+  for (auto const& [n, v] : query_parameters()) {
+    if (n == name) return v;
+  }
+  return std::nullopt;
+}
+
+std::optional<std::string> HttpRequest::decoded_query_parameter(
+    std::string_view name) const {
+  auto v = query_parameter(name);
+  if (!v) return std::nullopt;
+  return functions_internal::PercentDecode(*v);
+}
+
+std::string const& HttpRequest::payload() const& {
+  return impl_->request.body();
+}
+
+std::string&& HttpRequest::payload() && {
+  return std::move(impl_->request.body());
+}
+
+absl::Span<std::byte const> HttpRequest::payload_bytes() const {
+  auto const& body = impl_->request.body();
+  return {reinterpret_cast<std::byte const*>(body.data()), body.size()};
+}
+
+JsonDocument HttpRequest::json() const {
+  return JsonDocument(impl_->request.body());
+}
+
+HttpRequest::HeadersType const& HttpRequest::headers() const {
+  std::lock_guard<std::mutex> lk(impl_->headers_mu);
+  if (!impl_->headers) {
+    auto const& request = impl_->request;
+    HeadersType headers;
+    auto const n = std::distance(request.begin(), request.end());
+    headers.reserve(static_cast<std::size_t>(n));
+    for (auto const& f : request) {
+      headers.add(std::string(f.name_string()), std::string(f.value()));
+    }
+    impl_->headers = std::move(headers);
+  }
+  return *impl_->headers;
+}
+
+std::optional<std::string_view> HttpRequest::header(
+    std::string_view name) const {
+  auto const l = impl_->request.find(name);
+  if (l == impl_->request.end()) return std::nullopt;
+  return l->value();
+}
+
+std::optional<TraceContext> HttpRequest::trace_context() const {
+  if (auto v = header("traceparent")) {
+    if (auto context = ParseTraceParent(*v)) return context;
+  }
+  if (auto v = header("x-cloud-trace-context")) {
+    return ParseCloudTraceContext(*v);
+  }
+  return std::nullopt;
+}
+
+void HttpRequest::for_each_header(
+    std::function<void(std::string_view, std::string_view)> const& f) const {
+  for (auto const& h : impl_->request) f(h.name_string(), h.value());
+}
+
+std::pmr::memory_resource* HttpRequest::memory_resource() const {
+  std::lock_guard<std::mutex> lk(impl_->arena_mu);
+  if (!impl_->arena) {
+    impl_->arena.emplace(impl_->request.get_allocator().resource());
+  }
+  return &*impl_->arena;
+}
+
+CancellationToken HttpRequest::cancellation_token() const {
+  return functions_internal::CancellationAccess::MakeToken(
+      impl_->cancellation);
+}
+
+std::optional<BodyChecksums> HttpRequest::body_checksums() const {
+  if (!impl_->checksums) return std::nullopt;
+  return impl_->checksums->checksums;
+}
+
+int HttpRequest::version_major() const {
+  return static_cast<int>(impl_->request.version()) / kBeastHttpVersionFactor;
+}
+
+int HttpRequest::version_minor() const {
+  return static_cast<int>(impl_->request.version()) % kBeastHttpVersionFactor;
+}
+
+HttpRequest& HttpRequest::set_verb(std::string v) & {
+  impl_->request.method_string(v);
+  return *this;
+}
+
+HttpRequest& HttpRequest::set_target(std::string v) & {
+  impl_->request.target(v);
+  impl_->query.reset();
+  return *this;
+}
+
+HttpRequest& HttpRequest::set_payload(std::string v) & {
+  impl_->request.body() = std::move(v);
+  return *this;
+}
+
+HttpRequest& HttpRequest::clear_headers() & {
+  auto& request = impl_->request;
+  for (auto i = request.begin(); i != request.end();) i = request.erase(i);
+  impl_->headers.reset();
+  return *this;
+}
+
+HttpRequest& HttpRequest::add_header(std::string k, std::string v) & {
+  impl_->request.insert(k, v);
+  impl_->headers.reset();
+  return *this;
+}
+
+HttpRequest& HttpRequest::remove_header(std::string const& k) & {
+  impl_->request.erase(k);
+  impl_->headers.reset();
+  return *this;
+}
+
+HttpRequest& HttpRequest::set_version(int major, int minor) & {
+  impl_->request.version(
+      static_cast<unsigned>(major * kBeastHttpVersionFactor + minor));
+  return *this;
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
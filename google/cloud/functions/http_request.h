@@ -15,10 +15,29 @@
 #ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_HTTP_REQUEST_H
 #define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_HTTP_REQUEST_H
 
+#include "google/cloud/functions/body_checksums.h"
+#include "google/cloud/functions/cancellation_token.h"
+#include "google/cloud/functions/http_headers.h"
+#include "google/cloud/functions/json_document.h"
+#include "google/cloud/functions/trace_context.h"
 #include "google/cloud/functions/version.h"
-#include <map>
+#include <absl/types/span.h>
+#include <cstddef>
+#include <functional>
 #include <memory>
+#include <memory_resource>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+struct HttpRequestImpl;
+struct WrapRequest;
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
 
 namespace google::cloud::functions {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
@@ -27,92 +46,188 @@ FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
  * Represents an HTTP request.
  *
  * Functions to handle HTTP requests receive an object of this type.
+ *
+ * The request refers to the message as received by the framework, most
+ * accessors return views into that message and do not copy any data. The
+ * header of a request received by the framework may use memory owned by the
+ * connection. Applications that keep a request after the function returns
+ * must keep a copy, copies do not refer to the connection.
  */
 class HttpRequest {
  public:
-  using HeadersType = std::multimap<std::string, std::string>;
+  using HeadersType = HttpHeaders;
+  using QueryParametersType =
+      std::vector<std::pair<std::string_view, std::string_view>>;
 
-  HttpRequest() = default;
+  HttpRequest();
+  ~HttpRequest();
+  HttpRequest(HttpRequest const& rhs);
+  HttpRequest& operator=(HttpRequest const& rhs);
+  HttpRequest(HttpRequest&&) noexcept;
+  HttpRequest& operator=(HttpRequest&&) noexcept;
 
   /// The HTTP verb (GET, PUT, POST, etc) in the request
-  [[nodiscard]] std::string const& verb() const { return verb_; }
+  [[nodiscard]] std::string verb() const;
 
   /// The target object for the request, e.g, `/index.html`.
-  [[nodiscard]] std::string const& target() const { return target_; }
+  [[nodiscard]] std::string target() const;
+
+  /**
+   * @name Non-copying accessors.
+   *
+   * These return views into the request, and do not copy the verb or the
+   * target. The views are invalidated by `set_verb()`, `set_target()`, and
+   * when the request is destroyed.
+   */
+  ///@{
+  [[nodiscard]] std::string_view verb_view() const;
+  [[nodiscard]] std::string_view target_view() const;
+  ///@}
+
+  /// The path of the target, e.g., `/index.html` for `/index.html?a=b`.
+  [[nodiscard]] std::string_view path() const;
+
+  /**
+   * The query parameters in the target, as `name=value` pairs.
+   *
+   * The query is parsed the first time any of the query parameter functions
+   * is called. The names and values refer to the target, in the order they
+   * appear, and are not decoded. Use `decoded_query_parameter()` to decode a
+   * value.
+   */
+  [[nodiscard]] QueryParametersType const& query_parameters() const;
+
+  /// The undecoded value of the first query parameter named @p name, if any.
+  [[nodiscard]] std::optional<std::string_view> query_parameter(
+      std::string_view name) const;
+
+  /// The value of the first query parameter named @p name, percent-decoded.
+  [[nodiscard]] std::optional<std::string> decoded_query_parameter(
+      std::string_view name) const;
 
   /// The request payload
-  [[nodiscard]] std::string const& payload() const& { return payload_; }
-  [[nodiscard]] std::string&& payload() && { return std::move(payload_); }
-
-  /// The request HTTP headers
-  [[nodiscard]] HeadersType const& headers() const { return headers_; }
+  [[nodiscard]] std::string const& payload() const&;
+  [[nodiscard]] std::string&& payload() &&;
+
+  /// The request payload as bytes, a view of `payload()` without copies.
+  [[nodiscard]] absl::Span<std::byte const> payload_bytes() const;
+
+  /**
+   * The payload as a JSON document, parsed on demand.
+   *
+   * The document refers to the payload, and is invalidated if the payload
+   * changes. Prefer it to parsing the payload into a DOM when the function
+   * only needs a few values.
+   */
+  [[nodiscard]] JsonDocument json() const;
+
+  /**
+   * The request HTTP headers.
+   *
+   * The headers are copied into a `HeadersType` the first time this function
+   * is called. Prefer `header()` and `for_each_header()`, which do not copy.
+   * The headers are in the order received, with repeated headers grouped
+   * together, and their names are compared case-insensitively.
+   */
+  [[nodiscard]] HeadersType const& headers() const;
+
+  /**
+   * The value of the first header named @p name, if any.
+   *
+   * Header names are compared case-insensitively.
+   */
+  [[nodiscard]] std::optional<std::string_view> header(
+      std::string_view name) const;
+
+  /**
+   * The trace context of the caller, if any.
+   *
+   * Uses the `traceparent` header, or the `X-Cloud-Trace-Context` header if
+   * the request has no valid `traceparent`.
+   */
+  [[nodiscard]] std::optional<TraceContext> trace_context() const;
+
+  /// Calls @p f with the name and value of each header, as in `headers()`.
+  void for_each_header(
+      std::function<void(std::string_view, std::string_view)> const& f) const;
+
+  /**
+   * A memory arena that lives as long as this request.
+   *
+   * Memory allocated from the arena is released all at once, when the request
+   * is destroyed, and deallocating it does nothing. Use it for temporary data
+   * derived from the request, e.g., with `std::pmr` containers. For requests
+   * received by the framework the arena obtains its memory from the
+   * connection, which reuses it for the next request. The arena is created on
+   * first use, creating it is thread-safe, but allocating from it is not.
+   */
+  [[nodiscard]] std::pmr::memory_resource* memory_resource() const;
+
+  /**
+   * Signals when nobody is waiting for the response anymore.
+   *
+   * The token is cancelled once the deadline of the request expires, or the
+   * client disconnects, see `CancellationToken`. Requests created by the
+   * application are never cancelled.
+   */
+  [[nodiscard]] CancellationToken cancellation_token() const;
+
+  /**
+   * The checksums of the request body, computed by the framework.
+   *
+   * Only available with `--request-checksums`, which also checks the body
+   * against the `x-goog-hash` and `Content-MD5` headers, if any. Functions
+   * that forward the body, e.g., to Cloud Storage, can send these checksums
+   * without another pass over the body, see `ToGoogHash()`. For functions
+   * with the streaming signature the checksums are computed as the body is
+   * read, and only available once the body reader returned 0.
+   */
+  [[nodiscard]] std::optional<BodyChecksums> body_checksums() const;
 
   /// The HTTP version for the request
-  [[nodiscard]] int version_major() const { return version_major_; }
-  [[nodiscard]] int version_minor() const { return version_minor_; }
+  [[nodiscard]] int version_major() const;
+  [[nodiscard]] int version_minor() const;
 
-  HttpRequest& set_verb(std::string v) & {
-    verb_ = std::move(v);
-    return *this;
-  }
+  HttpRequest& set_verb(std::string v) &;
   HttpRequest&& set_verb(std::string v) && {
     return std::move(set_verb(std::move(v)));
   }
 
-  HttpRequest& set_target(std::string v) & {
-    target_ = std::move(v);
-    return *this;
-  }
+  HttpRequest& set_target(std::string v) &;
   HttpRequest&& set_target(std::string v) && {
     return std::move(set_target(std::move(v)));
   }
 
-  HttpRequest& set_payload(std::string v) & {
-    payload_ = std::move(v);
-    return *this;
-  }
+  HttpRequest& set_payload(std::string v) &;
   HttpRequest&& set_payload(std::string v) && {
     return std::move(set_payload(std::move(v)));
   }
 
-  HttpRequest& clear_headers() & {
-    headers_.clear();
-    return *this;
-  }
+  HttpRequest& clear_headers() &;
   HttpRequest&& clear_headers() && { return std::move(clear_headers()); }
 
-  HttpRequest& add_header(std::string k, std::string v) & {
-    headers_.emplace(std::move(k), std::move(v));
-    return *this;
-  }
+  HttpRequest& add_header(std::string k, std::string v) &;
   HttpRequest&& add_header(std::string k, std::string v) && {
     return std::move(add_header(std::move(k), std::move(v)));
   }
 
-  HttpRequest& remove_header(std::string const& k) & {
-    headers_.erase(k);
-    return *this;
-  }
+  /// Removes all the headers named @p k, compared case-insensitively.
+  HttpRequest& remove_header(std::string const& k) &;
   HttpRequest&& remove_header(std::string const& k) && {
     return std::move(remove_header(k));
   }
 
-  HttpRequest& set_version(int major, int minor) & {
-    version_major_ = major;
-    version_minor_ = minor;
-    return *this;
-  }
+  HttpRequest& set_version(int major, int minor) &;
   HttpRequest&& set_version(int major, int minor) && {
     return std::move(set_version(major, minor));
   }
 
  private:
-  std::string verb_;
-  std::string target_;
-  std::string payload_;
-  HeadersType headers_;
-  int version_major_ = 1;
-  int version_minor_ = 1;
+  friend struct functions_internal::WrapRequest;
+  explicit HttpRequest(
+      std::unique_ptr<functions_internal::HttpRequestImpl> impl);
+
+  std::unique_ptr<functions_internal::HttpRequestImpl> impl_;
 };
 
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
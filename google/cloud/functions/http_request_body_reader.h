@@ -0,0 +1,66 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_HTTP_REQUEST_BODY_READER_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_HTTP_REQUEST_BODY_READER_H
+
+#include "google/cloud/functions/version.h"
+#include <cstddef>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Reads the body of an HTTP request incrementally.
+ *
+ * Functions using the streaming signature receive an object of this type,
+ * and can process large request bodies without holding the full body in
+ * memory.
+ *
+ * @par Example
+ * @code
+ * namespace gcf = ::google::cloud::functions;
+ *
+ * gcf::HttpResponse CountBytes(gcf::HttpRequest const&,
+ *                              gcf::HttpRequestBodyReader& reader) {
+ *   std::vector<char> buffer(64 * 1024);
+ *   std::size_t count = 0;
+ *   for (auto n = reader.Read(buffer.data(), buffer.size()); n != 0;
+ *        n = reader.Read(buffer.data(), buffer.size())) {
+ *     count += n;
+ *   }
+ *   return gcf::HttpResponse{}.set_payload(std::to_string(count));
+ * }
+ * @endcode
+ */
+class HttpRequestBodyReader {
+ public:
+  virtual ~HttpRequestBodyReader() = default;
+
+  /**
+   * Reads up to @p size bytes of the request body into @p data.
+   *
+   * Blocks until some data is available. Returns the number of bytes read,
+   * which is 0 only at the end of the body.
+   *
+   * @throws std::runtime_error if there is an error reading the body, for
+   *     example, if the client disconnects or times out.
+   */
+  virtual std::size_t Read(char* data, std::size_t size) = 0;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_HTTP_REQUEST_BODY_READER_H
@@ -14,6 +14,12 @@
 
 #include "google/cloud/functions/http_request.h"
 #include <gmock/gmock.h>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace google::cloud::functions {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
@@ -21,6 +27,7 @@ namespace {
 
 using ::testing::ElementsAre;
 using ::testing::IsEmpty;
+using ::testing::Pair;
 
 TEST(HttpRequestTest, Default) {
   auto const actual = HttpRequest{};
@@ -39,6 +46,8 @@ TEST(HttpRequestTest, SimpleSetters) {
                           .set_payload("Hello");
   EXPECT_EQ(actual.verb(), "POST");
   EXPECT_EQ(actual.target(), "/index.html");
+  EXPECT_EQ(actual.verb_view(), "POST");
+  EXPECT_EQ(actual.target_view(), "/index.html");
   EXPECT_EQ(actual.payload(), "Hello");
   EXPECT_EQ(actual.version_major(), 1);
   EXPECT_EQ(actual.version_minor(), 0);
@@ -51,9 +60,16 @@ TEST(HttpRequestTest, AddHeader) {
                           .add_header("x-repeated", "1")
                           .add_header("abc-header", "2")
                           .add_header("x-repeated", "2");
-  EXPECT_THAT(actual.headers(), ElementsAre(value_type("abc-header", "2"),
-                                            value_type("x-repeated", "1"),
-                                            value_type("x-repeated", "2")));
+  // Repeated headers are kept together.
+  EXPECT_THAT(actual.headers(), ElementsAre(value_type("x-repeated", "1"),
+                                            value_type("x-repeated", "2"),
+                                            value_type("abc-header", "2")));
+  EXPECT_EQ(actual.headers().count("X-Repeated"), 2U);
+  auto const [begin, end] = actual.headers().equal_range("X-Repeated");
+  EXPECT_EQ(std::distance(begin, end), 2);
+  auto const l = actual.headers().find("ABC-Header");
+  ASSERT_NE(l, actual.headers().end());
+  EXPECT_EQ(l->second, "2");
 }
 
 TEST(HttpRequestTest, RemoveHeader) {
@@ -67,12 +83,150 @@ TEST(HttpRequestTest, RemoveHeader) {
   EXPECT_THAT(actual.headers(), ElementsAre(value_type("abc-header", "2")));
 }
 
+TEST(HttpRequestTest, Header) {
+  auto const actual = HttpRequest{}
+                          .add_header("Content-Type", "text/plain")
+                          .add_header("x-repeated", "1")
+                          .add_header("x-repeated", "2");
+  EXPECT_EQ(actual.header("content-type"), "text/plain");
+  EXPECT_EQ(actual.header("X-Repeated"), "1");
+  EXPECT_EQ(actual.header("x-missing"), std::nullopt);
+
+  std::vector<std::pair<std::string, std::string>> headers;
+  actual.for_each_header([&](std::string_view name, std::string_view value) {
+    headers.emplace_back(name, value);
+  });
+  EXPECT_THAT(headers, ElementsAre(Pair("Content-Type", "text/plain"),
+                                   Pair("x-repeated", "1"),
+                                   Pair("x-repeated", "2")));
+}
+
+TEST(HttpRequestTest, HeadersAfterUpdate) {
+  using value_type = HttpRequest::HeadersType::value_type;
+
+  auto actual = HttpRequest{}.add_header("x-header-a", "1");
+  EXPECT_THAT(actual.headers(), ElementsAre(value_type("x-header-a", "1")));
+  actual.add_header("x-header-b", "2");
+  EXPECT_THAT(actual.headers(), ElementsAre(value_type("x-header-a", "1"),
+                                            value_type("x-header-b", "2")));
+  actual.remove_header("X-Header-A");
+  EXPECT_THAT(actual.headers(), ElementsAre(value_type("x-header-b", "2")));
+}
+
+TEST(HttpRequestTest, QueryParameters) {
+  auto request = HttpRequest{}.set_target("/search?q=a%20b&lang=en&q=c");
+  EXPECT_EQ(request.path(), "/search");
+  EXPECT_THAT(request.query_parameters(),
+              ElementsAre(Pair("q", "a%20b"), Pair("lang", "en"),
+                          Pair("q", "c")));
+  EXPECT_EQ(request.query_parameter("q"), "a%20b");
+  EXPECT_EQ(request.decoded_query_parameter("q"), "a b");
+  EXPECT_EQ(request.query_parameter("missing"), std::nullopt);
+  EXPECT_EQ(request.decoded_query_parameter("missing"), std::nullopt);
+
+  request.set_target("/other?lang=fr");
+  EXPECT_EQ(request.path(), "/other");
+  EXPECT_THAT(request.query_parameters(), ElementsAre(Pair("lang", "fr")));
+
+  auto const copy = request;
+  EXPECT_THAT(copy.query_parameters(), ElementsAre(Pair("lang", "fr")));
+  EXPECT_NE(copy.query_parameters()[0].second.data(),
+            request.query_parameters()[0].second.data());
+}
+
+TEST(HttpRequestTest, PayloadBytes) {
+  auto const request = HttpRequest{}.set_payload(std::string("\x00\xfe", 2));
+  auto const bytes = request.payload_bytes();
+  ASSERT_EQ(bytes.size(), 2);
+  EXPECT_EQ(static_cast<void const*>(bytes.data()),
+            static_cast<void const*>(request.payload().data()));
+  EXPECT_EQ(bytes[0], std::byte{0x00});
+  EXPECT_EQ(bytes[1], std::byte{0xfe});
+  EXPECT_TRUE(HttpRequest{}.payload_bytes().empty());
+}
+
+TEST(HttpRequestTest, Json) {
+  auto const request =
+      HttpRequest{}.set_payload(R"js({"name": "World", "count": 2})js");
+  auto const json = request.json();
+  EXPECT_EQ(json.text().data(), request.payload().data());
+  EXPECT_EQ(json.get_string("/name"), "World");
+  EXPECT_EQ(json.get_int64("/count"), 2);
+  EXPECT_EQ(HttpRequest{}.json().text(), "");
+}
+
+TEST(HttpRequestTest, Copy) {
+  auto const original = HttpRequest{}
+                            .set_verb("PUT")
+                            .set_target("/index.html")
+                            .set_version(1, 0)
+                            .set_payload("Hello")
+                            .add_header("x-header", "1");
+  auto copy = original;
+  EXPECT_EQ(copy.verb(), "PUT");
+  EXPECT_EQ(copy.target(), "/index.html");
+  EXPECT_EQ(copy.version_minor(), 0);
+  EXPECT_EQ(copy.payload(), "Hello");
+  EXPECT_EQ(copy.header("x-header"), "1");
+
+  copy.set_target("/other.html").clear_headers();
+  EXPECT_EQ(original.target(), "/index.html");
+  EXPECT_EQ(original.header("x-header"), "1");
+  EXPECT_THAT(copy.headers(), IsEmpty());
+}
+
+TEST(HttpRequestTest, Move) {
+  auto original = HttpRequest{}
+                      .set_verb("PUT")
+                      .set_target("/index.html")
+                      .set_payload("Hello")
+                      .add_header("x-header", "1");
+  auto moved = std::move(original);
+  EXPECT_EQ(moved.verb(), "PUT");
+  EXPECT_EQ(moved.payload(), "Hello");
+  EXPECT_EQ(moved.header("x-header"), "1");
+
+  // The moved-from request is empty, and remains usable.
+  // NOLINTNEXTLINE(bugprone-use-after-move)
+  EXPECT_THAT(original.verb(), IsEmpty());
+  EXPECT_THAT(original.target(), IsEmpty());
+  EXPECT_THAT(original.payload(), IsEmpty());
+  EXPECT_THAT(original.headers(), IsEmpty());
+  original.set_verb("GET").set_payload("Goodbye");
+  EXPECT_EQ(original.verb(), "GET");
+
+  auto assigned = HttpRequest{};
+  assigned = std::move(original);
+  EXPECT_EQ(assigned.verb(), "GET");
+  EXPECT_EQ(assigned.payload(), "Goodbye");
+  // NOLINTNEXTLINE(bugprone-use-after-move)
+  EXPECT_THAT(original.verb(), IsEmpty());
+  EXPECT_THAT(original.payload(), IsEmpty());
+}
+
 TEST(HttpRequestTest, ClearHeaders) {
   auto const actual =
       HttpRequest{}.add_header("abc-header", "2").clear_headers();
   EXPECT_THAT(actual.headers(), IsEmpty());
 }
 
+TEST(HttpRequestTest, TraceContext) {
+  EXPECT_FALSE(HttpRequest{}.trace_context().has_value());
+  auto const cloud = HttpRequest{}.add_header(
+      "X-Cloud-Trace-Context", "4bf92f3577b34da6a3ce929d0e0e4736/1;o=1");
+  auto context = cloud.trace_context();
+  ASSERT_TRUE(context.has_value());
+  EXPECT_EQ(context->span_id, "0000000000000001");
+
+  auto const both = HttpRequest{cloud}.add_header(
+      "traceparent", "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-00");
+  context = both.trace_context();
+  ASSERT_TRUE(context.has_value());
+  EXPECT_EQ(context->trace_id, "4bf92f3577b34da6a3ce929d0e0e4736");
+  EXPECT_EQ(context->span_id, "00f067aa0ba902b7");
+  EXPECT_FALSE(context->sampled);
+}
+
 }  // namespace
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions
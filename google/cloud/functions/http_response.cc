@@ -13,14 +13,195 @@
 // limitations under the License.
 
 #include "google/cloud/functions/http_response.h"
+#include "google/cloud/functions/internal/response_body.h"
 #include "google/cloud/functions/internal/wrap_response.h"
+#include <stdexcept>
 
 namespace google::cloud::functions {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 
-HttpResponse::HttpResponse() : impl_(functions_internal::MakeHttpResponse()) {}
+namespace {
+auto constexpr kBeastHttpVersionFactor = 10;
+}  // namespace
+
+HttpResponse::HttpResponse()
+    : impl_(std::make_unique<functions_internal::HttpResponseImpl>()) {}
+
+HttpResponse::HttpResponse(std::unique_ptr<Impl> impl)
+    : impl_(std::make_unique<functions_internal::HttpResponseImpl>()),
+      custom_(std::move(impl)) {}
+
+HttpResponse::~HttpResponse() = default;
+
+HttpResponse::HttpResponse(HttpResponse const& rhs)
+    : impl_(std::make_unique<functions_internal::HttpResponseImpl>()),
+      custom_(rhs.custom_) {
+  if (rhs.impl_) impl_->response = rhs.impl_->response;
+}
+
+HttpResponse& HttpResponse::operator=(HttpResponse const& rhs) {
+  if (this == &rhs) return *this;
+  HttpResponse tmp(rhs);
+  *this = std::move(tmp);
+  return *this;
+}
+
+HttpResponse::HttpResponse(HttpResponse&&) noexcept = default;
+HttpResponse& HttpResponse::operator=(HttpResponse&&) noexcept = default;
+
+HttpResponse& HttpResponse::set_payload(std::string v) & {
+  if (custom_) {
+    custom_->set_payload(std::move(v));
+    ResetCustomHeaders();
+  } else {
+    impl_->response.body() = std::move(v);
+  }
+  return *this;
+}
+
+std::string const& HttpResponse::payload() const {
+  if (custom_) return custom_->payload();
+  return impl_->response.body().str();
+}
+
+HttpResponse& HttpResponse::set_payload_shared(
+    std::shared_ptr<std::string const> v) & {
+  if (custom_) {
+    custom_->set_payload(v ? *v : std::string{});
+    ResetCustomHeaders();
+  } else {
+    impl_->response.body().set_shared(std::move(v));
+  }
+  return *this;
+}
+
+HttpResponse& HttpResponse::set_payload_file(
+    std::string const& path, std::uint64_t offset,
+    std::optional<std::uint64_t> size) & {
+  if (custom_) {
+    custom_->set_payload_file(path, offset, size);
+    ResetCustomHeaders();
+  } else {
+    impl_->response.body().set_file(
+        functions_internal::OpenFileSegment(path, offset, size));
+  }
+  return *this;
+}
+
+HttpResponse& HttpResponse::set_result(int code) & {
+  if (custom_) {
+    custom_->set_result(code);
+    ResetCustomHeaders();
+  } else {
+    impl_->response.result(code);
+  }
+  return *this;
+}
+
+int HttpResponse::result() const {
+  if (custom_) return custom_->result();
+  return static_cast<int>(impl_->response.result_int());
+}
+
+HttpResponse& HttpResponse::set_header(std::string_view name,
+                                       std::string_view value) & {
+  if (custom_) {
+    custom_->set_header(name, value);
+    ResetCustomHeaders();
+  } else {
+    impl_->response.set(name, value);
+  }
+  return *this;
+}
+
+HttpResponse::HeadersType HttpResponse::headers() const {
+  if (custom_) return custom_->headers();
+  HeadersType h;
+  for (auto const& f : impl_->response) {
+    h.add(std::string(f.name_string()), std::string(f.value()));
+  }
+  return h;
+}
+
+std::optional<std::string_view> HttpResponse::header(
+    std::string_view name) const {
+  if (custom_) {
+    auto const& headers = CustomHeaders();
+    auto const l = headers.find(name);
+    if (l == headers.end()) return std::nullopt;
+    return l->second;
+  }
+  auto const l = impl_->response.find(name);
+  if (l == impl_->response.end()) return std::nullopt;
+  return l->value();
+}
+
+bool HttpResponse::has_header(std::string_view name) const {
+  if (custom_) return CustomHeaders().contains(name);
+  return impl_->response.find(name) != impl_->response.end();
+}
+
+void HttpResponse::for_each_header(
+    std::function<void(std::string_view, std::string_view)> const& f) const {
+  if (custom_) {
+    for (auto const& [name, value] : CustomHeaders()) f(name, value);
+    return;
+  }
+  for (auto const& h : impl_->response) f(h.name_string(), h.value());
+}
+
+HttpResponse& HttpResponse::set_version(int major, int minor) & {
+  if (custom_) {
+    custom_->set_version(major, minor);
+    ResetCustomHeaders();
+  } else {
+    impl_->response.version(major * kBeastHttpVersionFactor + minor);
+  }
+  return *this;
+}
+
+int HttpResponse::version_major() const {
+  if (custom_) return custom_->version_major();
+  return static_cast<int>(impl_->response.version()) / kBeastHttpVersionFactor;
+}
+
+int HttpResponse::version_minor() const {
+  if (custom_) return custom_->version_minor();
+  return static_cast<int>(impl_->response.version()) % kBeastHttpVersionFactor;
+}
+
+HttpResponse::HeadersType const& HttpResponse::CustomHeaders() const {
+  std::lock_guard<std::mutex> lk(impl_->custom_headers_mu);
+  if (!impl_->custom_headers) impl_->custom_headers = custom_->headers();
+  return *impl_->custom_headers;
+}
+
+void HttpResponse::ResetCustomHeaders() {
+  std::lock_guard<std::mutex> lk(impl_->custom_headers_mu);
+  impl_->custom_headers.reset();
+}
 
 HttpResponse::Impl::~Impl() = default;
 
+void HttpResponse::Impl::set_payload_file(std::string const& path,
+                                          std::uint64_t offset,
+                                          std::optional<std::uint64_t> size) {
+  auto const segment = functions_internal::OpenFileSegment(path, offset, size);
+  std::string payload(static_cast<std::size_t>(segment.size), '\0');
+  boost::beast::error_code ec;
+  segment.file->seek(segment.offset, ec);
+  std::size_t count = 0;
+  while (!ec && count != payload.size()) {
+    auto const n = segment.file->read(payload.data() + count,
+                                      payload.size() - count, ec);
+    if (n == 0) break;
+    count += n;
+  }
+  if (ec || count != payload.size()) {
+    throw std::runtime_error("cannot read file <" + path + ">");
+  }
+  set_payload(std::move(payload));
+}
+
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions
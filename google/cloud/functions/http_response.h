@@ -15,14 +15,18 @@
 #ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_HTTP_RESPONSE_H
 #define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_HTTP_RESPONSE_H
 
+#include "google/cloud/functions/http_headers.h"
 #include "google/cloud/functions/version.h"
-#include <map>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+struct HttpResponseImpl;
 struct UnwrapResponse;
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions_internal
@@ -37,48 +41,96 @@ FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
  */
 class HttpResponse {
  public:
-  using HeadersType = std::map<std::string, std::string>;
+  using HeadersType = HttpHeaders;
 
   HttpResponse();
+  ~HttpResponse();
+  HttpResponse(HttpResponse const& rhs);
+  HttpResponse& operator=(HttpResponse const& rhs);
+  HttpResponse(HttpResponse&&) noexcept;
+  HttpResponse& operator=(HttpResponse&&) noexcept;
 
   /// The request payload
-  HttpResponse& set_payload(std::string v) & {
-    impl_->set_payload(std::move(v));
-    return *this;
-  }
+  HttpResponse& set_payload(std::string v) &;
   HttpResponse&& set_payload(std::string v) && {
     return std::move(set_payload(std::move(v)));
   }
-  [[nodiscard]] std::string const& payload() const { return impl_->payload(); }
+  [[nodiscard]] std::string const& payload() const;
 
-  /// The status result
-  HttpResponse& set_result(int code) & {
-    impl_->set_result(code);
-    return *this;
+  /**
+   * Sends the shared, immutable string @p v as the response payload.
+   *
+   * The response refers to @p v instead of copying it, and so do copies of the
+   * response. Use this to send the same precomputed payload in many
+   * responses. A null pointer is an empty payload. `payload()` returns the
+   * shared string.
+   */
+  HttpResponse& set_payload_shared(std::shared_ptr<std::string const> v) &;
+  HttpResponse&& set_payload_shared(std::shared_ptr<std::string const> v) && {
+    return std::move(set_payload_shared(std::move(v)));
   }
+
+  /**
+   * Sends a range of a file as the response payload.
+   *
+   * The payload is @p size bytes starting at @p offset, or the rest of the
+   * file if @p size is not set. The file is opened immediately, and replaces
+   * any previous payload; `payload()` returns an empty string afterwards. On
+   * Linux the file is sent with `sendfile(2)`, without copying its contents
+   * through user-space buffers.
+   *
+   * @throws std::runtime_error if the file cannot be opened, and
+   *     std::invalid_argument if the range is not contained in the file.
+   */
+  HttpResponse& set_payload_file(std::string const& path,
+                                 std::uint64_t offset = 0,
+                                 std::optional<std::uint64_t> size = {}) &;
+  HttpResponse&& set_payload_file(std::string const& path,
+                                  std::uint64_t offset = 0,
+                                  std::optional<std::uint64_t> size = {}) && {
+    return std::move(set_payload_file(path, offset, size));
+  }
+
+  /// The status result
+  HttpResponse& set_result(int code) &;
   HttpResponse&& set_result(int code) && { return std::move(set_result(code)); }
-  [[nodiscard]] int result() const { return impl_->result(); }
+  [[nodiscard]] int result() const;
 
   /// The request HTTP headers
-  HttpResponse& set_header(std::string_view name, std::string_view value) & {
-    impl_->set_header(name, value);
-    return *this;
-  }
+  HttpResponse& set_header(std::string_view name, std::string_view value) &;
   HttpResponse&& set_header(std::string_view name, std::string_view value) && {
     return std::move(set_header(name, value));
   }
-  [[nodiscard]] HeadersType headers() const { return impl_->headers(); }
+  /**
+   * The response HTTP headers.
+   *
+   * This function copies the headers. Prefer `header()`, `has_header()`, and
+   * `for_each_header()`, which do not copy.
+   */
+  [[nodiscard]] HeadersType headers() const;
+
+  /**
+   * The value of the first header named @p name, if any.
+   *
+   * Header names are compared case-insensitively.
+   */
+  [[nodiscard]] std::optional<std::string_view> header(
+      std::string_view name) const;
+
+  /// Returns true if the response has a header named @p name.
+  [[nodiscard]] bool has_header(std::string_view name) const;
+
+  /// Calls @p f with the name and value of each header, as in `headers()`.
+  void for_each_header(
+      std::function<void(std::string_view, std::string_view)> const& f) const;
 
   /// The HTTP version for the request
-  HttpResponse& set_version(int major, int minor) & {
-    impl_->set_version(major, minor);
-    return *this;
-  }
+  HttpResponse& set_version(int major, int minor) &;
   HttpResponse&& set_version(int major, int minor) && {
     return std::move(set_version(major, minor));
   }
-  [[nodiscard]] int version_major() const { return impl_->version_major(); }
-  [[nodiscard]] int version_minor() const { return impl_->version_minor(); }
+  [[nodiscard]] int version_major() const;
+  [[nodiscard]] int version_minor() const;
 
   /**
    * @name Common HTTP status codes.
@@ -154,11 +206,24 @@ class HttpResponse {
   inline static auto constexpr kNetworkAuthenticationRequired = 511;
   //@}
 
+  /**
+   * An alternative implementation for the response.
+   *
+   * Responses created with the default constructor store the message
+   * directly, copies are independent, and the framework sends the message
+   * without further copies. Responses created from an `Impl` call it through
+   * virtual functions, share it with their copies, and the framework copies
+   * the status, headers, and payload out of it before sending the response.
+   */
   class Impl {
    public:
     virtual ~Impl() = 0;
     virtual void set_payload(std::string) = 0;
     [[nodiscard]] virtual std::string const& payload() const = 0;
+    /// The default implementation reads the range into `set_payload()`.
+    virtual void set_payload_file(std::string const& path,
+                                  std::uint64_t offset,
+                                  std::optional<std::uint64_t> size);
     virtual void set_result(int code) = 0;
     [[nodiscard]] virtual int result() const = 0;
     virtual void set_header(std::string_view name, std::string_view value) = 0;
@@ -168,11 +233,15 @@ class HttpResponse {
     [[nodiscard]] virtual int version_minor() const = 0;
   };
 
-  explicit HttpResponse(std::unique_ptr<Impl> impl) : impl_(std::move(impl)) {}
+  explicit HttpResponse(std::unique_ptr<Impl> impl);
 
  private:
   friend struct functions_internal::UnwrapResponse;
-  std::shared_ptr<Impl> impl_;
+  [[nodiscard]] HeadersType const& CustomHeaders() const;
+  void ResetCustomHeaders();
+
+  std::unique_ptr<functions_internal::HttpResponseImpl> impl_;
+  std::shared_ptr<Impl> custom_;
 };
 
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
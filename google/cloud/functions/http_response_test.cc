@@ -13,7 +13,15 @@
 // limitations under the License.
 
 #include "google/cloud/functions/http_response.h"
+#include "google/cloud/functions/internal/wrap_response.h"
+#include <boost/beast/http/field.hpp>
 #include <gmock/gmock.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
@@ -33,6 +41,36 @@ TEST(WrapResponseTest, Payload) {
   EXPECT_EQ(response.payload(), bye);
 }
 
+TEST(WrapResponseTest, PayloadFile) {
+  auto const path = (std::filesystem::temp_directory_path() /
+                     ("http_response_test_" + std::to_string(std::rand())))
+                        .string();
+  std::ofstream(path) << "Hello";
+  auto response =
+      functions::HttpResponse{}.set_payload("replaced").set_payload_file(path);
+  EXPECT_THAT(response.payload(), IsEmpty());
+  EXPECT_THROW(response.set_payload_file(path, 6), std::invalid_argument);
+  EXPECT_THROW(response.set_payload_file(path + ".missing"),
+               std::runtime_error);
+  std::remove(path.c_str());
+}
+
+TEST(WrapResponseTest, PayloadShared) {
+  auto const payload = std::make_shared<std::string const>("cached");
+  auto response = functions::HttpResponse{}.set_payload_shared(payload);
+  EXPECT_EQ(response.payload(), "cached");
+  EXPECT_EQ(response.payload().data(), payload->data());
+
+  auto copy = response;
+  EXPECT_EQ(copy.payload().data(), payload->data());
+  auto const unwrapped = UnwrapResponse::unwrap(std::move(copy));
+  EXPECT_EQ(unwrapped.body().str().data(), payload->data());
+
+  response.set_payload("replaced");
+  EXPECT_EQ(response.payload(), "replaced");
+  EXPECT_EQ(*payload, "cached");
+}
+
 TEST(WrapResponseTest, Result) {
   functions::HttpResponse r;
   EXPECT_EQ(r.result(), functions::HttpResponse::kOkay);
@@ -55,6 +93,37 @@ TEST(WrapResponseTest, Headers) {
                           std::make_pair("x-goog-test", "b")));
 }
 
+TEST(WrapResponseTest, HeaderView) {
+  auto response = functions::HttpResponse{}
+                      .set_header("Content-Type", "application/json")
+                      .set_header("x-goog-test", "a");
+  EXPECT_EQ(response.header("content-type").value_or(""), "application/json");
+  EXPECT_FALSE(response.header("x-missing").has_value());
+  EXPECT_TRUE(response.has_header("X-Goog-Test"));
+  EXPECT_FALSE(response.has_header("x-missing"));
+
+  std::vector<std::pair<std::string, std::string>> headers;
+  response.for_each_header([&](std::string_view name, std::string_view value) {
+    headers.emplace_back(name, value);
+  });
+  EXPECT_THAT(headers,
+              ElementsAre(std::make_pair("Content-Type", "application/json"),
+                          std::make_pair("x-goog-test", "a")));
+}
+
+TEST(WrapResponseTest, HeaderField) {
+  namespace http = ::boost::beast::http;
+  auto response = functions::HttpResponse{};
+  UnwrapResponse::set_header(response, http::field::content_type,
+                             "text/plain");
+  response.set_header("cache-control", "no-store");
+  UnwrapResponse::set_header(response, http::field::cache_control,
+                             "max-age=60");
+  EXPECT_THAT(response.headers(),
+              ElementsAre(std::make_pair("Content-Type", "text/plain"),
+                          std::make_pair("Cache-Control", "max-age=60")));
+}
+
 TEST(WrapResponseTest, Version) {
   auto r = functions::HttpResponse{};
   EXPECT_EQ(r.version_major(), 1);
@@ -67,6 +136,100 @@ TEST(WrapResponseTest, Version) {
   EXPECT_EQ(response.version_minor(), 1);
 }
 
+TEST(WrapResponseTest, CopiesAreIndependent) {
+  auto const original =
+      functions::HttpResponse{}.set_payload("Hello").set_header("x-a", "1");
+  auto copy = original;
+  copy.set_payload("Goodbye").set_header("x-a", "2");
+  EXPECT_EQ(original.payload(), "Hello");
+  EXPECT_THAT(original.headers(), ElementsAre(std::make_pair("x-a", "1")));
+  EXPECT_EQ(copy.payload(), "Goodbye");
+  EXPECT_THAT(copy.headers(), ElementsAre(std::make_pair("x-a", "2")));
+}
+
+TEST(WrapResponseTest, UnwrapMovesPayload) {
+  auto response = functions::HttpResponse{}.set_payload(std::string(1024, 'x'));
+  auto const* data = response.payload().data();
+  auto unwrapped = UnwrapResponse::unwrap(std::move(response));
+  EXPECT_EQ(unwrapped.body().str().data(), data);
+}
+
+class TestImpl : public functions::HttpResponse::Impl {
+ public:
+  using HeadersType = functions::HttpResponse::HeadersType;
+
+  void set_payload(std::string v) override { payload_ = std::move(v); }
+  [[nodiscard]] std::string const& payload() const override {
+    return payload_;
+  }
+  void set_result(int code) override { result_ = code; }
+  [[nodiscard]] int result() const override { return result_; }
+  void set_header(std::string_view name, std::string_view value) override {
+    headers_.set(std::string(name), std::string(value));
+  }
+  [[nodiscard]] HeadersType headers() const override { return headers_; }
+  void set_version(int major, int minor) override {
+    major_ = major;
+    minor_ = minor;
+  }
+  [[nodiscard]] int version_major() const override { return major_; }
+  [[nodiscard]] int version_minor() const override { return minor_; }
+
+ private:
+  std::string payload_;
+  int result_ = functions::HttpResponse::kOkay;
+  HeadersType headers_;
+  int major_ = 1;
+  int minor_ = 1;
+};
+
+TEST(WrapResponseTest, CustomImpl) {
+  auto response = functions::HttpResponse(std::make_unique<TestImpl>())
+                      .set_payload("Hello")
+                      .set_result(functions::HttpResponse::kCreated)
+                      .set_header("x-a", "1")
+                      .set_version(1, 0);
+  EXPECT_EQ(response.payload(), "Hello");
+  EXPECT_EQ(response.result(), functions::HttpResponse::kCreated);
+  EXPECT_THAT(response.headers(), ElementsAre(std::make_pair("x-a", "1")));
+  EXPECT_EQ(response.version_major(), 1);
+  EXPECT_EQ(response.version_minor(), 0);
+  EXPECT_EQ(response.header("X-A").value_or(""), "1");
+  response.set_header("x-a", "2");
+  EXPECT_EQ(response.header("x-a").value_or(""), "2");
+  EXPECT_TRUE(response.has_header("x-a"));
+  response.set_header("x-a", "1");
+  UnwrapResponse::set_header(
+      response, ::boost::beast::http::field::cache_control, "no-store");
+  EXPECT_EQ(response.header("Cache-Control").value_or(""), "no-store");
+  response.set_payload_shared(std::make_shared<std::string const>("Hello"));
+
+  auto const unwrapped = UnwrapResponse::unwrap(std::move(response));
+  EXPECT_EQ(unwrapped.body().str(), "Hello");
+  EXPECT_EQ(unwrapped.result_int(), functions::HttpResponse::kCreated);
+  EXPECT_EQ(unwrapped["x-a"], "1");
+  EXPECT_EQ(unwrapped.version(), 10U);
+}
+
+TEST(WrapResponseTest, CustomImplPayloadFile) {
+  auto const path = (std::filesystem::temp_directory_path() /
+                     ("http_response_test_" + std::to_string(std::rand())))
+                        .string();
+  std::ofstream(path) << "Hello World";
+  // `TestImpl` does not override `set_payload_file()`, the default reads the
+  // range into the payload.
+  auto response = functions::HttpResponse(std::make_unique<TestImpl>())
+                      .set_payload_file(path, 6, 3);
+  EXPECT_EQ(response.payload(), "Wor");
+  response.set_payload_file(path);
+  EXPECT_EQ(response.payload(), "Hello World");
+  EXPECT_THROW(response.set_payload_file(path, 12), std::invalid_argument);
+  EXPECT_THROW(response.set_payload_file(path + ".missing"),
+               std::runtime_error);
+  EXPECT_EQ(response.payload(), "Hello World");
+  std::remove(path.c_str());
+}
+
 }  // namespace
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions_internal
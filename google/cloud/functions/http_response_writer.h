@@ -0,0 +1,91 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_HTTP_RESPONSE_WRITER_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_HTTP_RESPONSE_WRITER_H
+
+#include "google/cloud/functions/http_response.h"
+#include "google/cloud/functions/version.h"
+#include <chrono>
+#include <string_view>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Writes an HTTP response incrementally.
+ *
+ * Functions using the streaming response signature receive an object of this
+ * type. The framework sends the response header and each block of data as
+ * soon as the function provides them, using chunked transfer encoding.
+ *
+ * @par Example
+ * @code
+ * namespace gcf = ::google::cloud::functions;
+ *
+ * void Report(gcf::HttpRequest const&, gcf::HttpResponseWriter& writer) {
+ *   writer.WriteHeader(
+ *       gcf::HttpResponse{}.set_header("content-type", "text/csv"));
+ *   for (auto const& row : QueryRows()) writer.Write(FormatCsv(row));
+ * }
+ * @endcode
+ */
+class HttpResponseWriter {
+ public:
+  virtual ~HttpResponseWriter() = default;
+
+  /**
+   * Sends the response status and headers.
+   *
+   * Any payload in @p response is sent as the first block of data. Calling
+   * this function is optional, if the first call is to `Write()` the framework
+   * sends a `200 OK` response with no additional headers. Calling this
+   * function more than once, or after `Write()`, has no effect.
+   *
+   * @throws std::runtime_error if there is an error sending the data, for
+   *     example, if the client disconnects or times out.
+   */
+  virtual void WriteHeader(HttpResponse response) = 0;
+
+  /**
+   * Sends @p data to the client.
+   *
+   * Blocks until the data is sent, the function can reuse any buffers used by
+   * @p data as soon as this function returns.
+   *
+   * @throws std::runtime_error if there is an error sending the data, for
+   *     example, if the client disconnects or times out.
+   */
+  virtual void Write(std::string_view data) = 0;
+
+  /**
+   * Sends @p data each time the response is idle for @p interval.
+   *
+   * Use this to keep long-lived responses, such as Server-Sent Events, open
+   * through proxies that close idle connections. The framework sends the
+   * heartbeats while the function waits for its next block of data, the data
+   * must be valid in any position of the response. Sends the header, if
+   * needed. Use an @p interval of 0 to stop the heartbeats.
+   *
+   * The heartbeats are not sent for compressed or buffered responses. The
+   * default implementation ignores them.
+   */
+  virtual void SetHeartbeat(std::string_view /*data*/,
+                            std::chrono::milliseconds /*interval*/) {}
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_HTTP_RESPONSE_WRITER_H
@@ -0,0 +1,53 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/in_process_invoker.h"
+#include "google/cloud/functions/internal/framework_impl.h"
+#include "google/cloud/functions/internal/wrap_request.h"
+#include "google/cloud/functions/internal/wrap_response.h"
+#include <boost/beast/http/write.hpp>
+#include <sstream>
+#include <utility>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+InProcessInvoker::InProcessInvoker(Function const& function,
+                                   std::vector<std::string> const& options) {
+  std::vector<char const*> argv{"in-process-invoker"};
+  for (auto const& o : options) argv.push_back(o.c_str());
+  impl_ = functions_internal::MakeInProcessServer(
+      static_cast<int>(argv.size()), argv.data(), function);
+}
+
+InProcessInvoker::~InProcessInvoker() = default;
+
+InProcessInvoker::InProcessInvoker(InProcessInvoker&&) noexcept = default;
+InProcessInvoker& InProcessInvoker::operator=(InProcessInvoker&&) noexcept =
+    default;
+
+HttpResponse InProcessInvoker::Invoke(HttpRequest request) {
+  auto response = impl_->Call(
+      std::move(functions_internal::WrapRequest::unwrap(request)));
+  return functions_internal::UnwrapResponse::wrap(std::move(response));
+}
+
+std::string InProcessInvoker::InvokeRaw(std::string_view request) {
+  std::ostringstream os;
+  os << impl_->CallRaw(request);
+  return std::move(os).str();
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
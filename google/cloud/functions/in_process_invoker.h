@@ -0,0 +1,90 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_IN_PROCESS_INVOKER_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_IN_PROCESS_INVOKER_H
+
+#include "google/cloud/functions/function.h"
+#include "google/cloud/functions/http_request.h"
+#include "google/cloud/functions/http_response.h"
+#include "google/cloud/functions/version.h"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+class InProcessServer;
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Invokes a function in-process, without a server or any sockets.
+ *
+ * The requests go through the same pipeline as in the server started by
+ * `Run()`: the static routes, the admission checks, the decompression,
+ * compression, and conditional request middleware, and the headers set on
+ * each response. Use this to test functions, and to benchmark them without
+ * the network in the measurements.
+ *
+ * The @p options are the command-line options accepted by `Run()`, e.g.
+ * `{"--compression"}`. The options for the connections, such as timeouts and
+ * pipelining, do not apply. The warmup functions run in the constructor, and
+ * the shutdown functions in the destructor. Functions that stream their
+ * request or response cannot be invoked in-process.
+ *
+ * @code
+ * namespace gcf = ::google::cloud::functions;
+ * gcf::InProcessInvoker invoker(gcf::MakeFunction(MyHandler));
+ * auto response = invoker.Invoke(gcf::HttpRequest{}.set_target("/hello"));
+ * assert(response.result() == gcf::HttpResponse::kOkay);
+ * @endcode
+ *
+ * The function runs in the calling thread, or, for asynchronous functions, in
+ * the thread completing the response. It is safe to invoke the function from
+ * multiple threads.
+ */
+class InProcessInvoker {
+ public:
+  explicit InProcessInvoker(Function const& function,
+                            std::vector<std::string> const& options = {});
+  ~InProcessInvoker();
+
+  InProcessInvoker(InProcessInvoker&&) noexcept;
+  InProcessInvoker& operator=(InProcessInvoker&&) noexcept;
+
+  /// Invokes the function with @p request, and returns its response.
+  HttpResponse Invoke(HttpRequest request);
+
+  /**
+   * Parses @p request, an HTTP/1.x request, and returns the response bytes.
+   *
+   * The request limits, such as `--max-body-size`, apply to the parsed
+   * request. Malformed or incomplete requests get a `400 Bad Request`
+   * response.
+   */
+  std::string InvokeRaw(std::string_view request);
+
+ private:
+  std::unique_ptr<functions_internal::InProcessServer> impl_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_IN_PROCESS_INVOKER_H
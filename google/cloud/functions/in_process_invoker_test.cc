@@ -0,0 +1,125 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/in_process_invoker.h"
+#include <gmock/gmock.h>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::StartsWith;
+
+HttpResponse Hello(HttpRequest const& request) {
+  return HttpResponse{}
+      .set_header("content-type", "text/plain")
+      .set_payload("Hello from " + request.target());
+}
+
+TEST(InProcessInvokerTest, Invoke) {
+  InProcessInvoker invoker(MakeFunction(Hello));
+  auto const response = invoker.Invoke(HttpRequest{}.set_target("/hello"));
+  EXPECT_EQ(response.result(), HttpResponse::kOkay);
+  EXPECT_EQ(response.payload(), "Hello from /hello");
+  // The response has the headers set by the server.
+  EXPECT_TRUE(response.has_header("server"));
+  EXPECT_TRUE(response.has_header("date"));
+  EXPECT_EQ(response.header("content-length").value_or(""), "17");
+}
+
+TEST(InProcessInvokerTest, InvokeAsync) {
+  InProcessInvoker invoker(MakeFunction(
+      [](HttpRequest request, HttpResponseCallback done) {
+        done(HttpResponse{}.set_payload("async " + request.target()));
+      }));
+  auto const response = invoker.Invoke(HttpRequest{}.set_target("/a"));
+  EXPECT_EQ(response.payload(), "async /a");
+}
+
+TEST(InProcessInvokerTest, Options) {
+  InProcessInvoker invoker(MakeFunction(Hello),
+                           {"--static-route=/healthz=200:ok"});
+  EXPECT_EQ(invoker.Invoke(HttpRequest{}.set_target("/healthz")).payload(),
+            "ok");
+  EXPECT_EQ(invoker.Invoke(HttpRequest{}.set_target("/x")).payload(),
+            "Hello from /x");
+
+  EXPECT_THROW(InProcessInvoker(MakeFunction(Hello), {"--threads=-1"}),
+               std::invalid_argument);
+}
+
+TEST(InProcessInvokerTest, Precheck) {
+  auto function = WithPrecheck(
+      MakeFunction(Hello),
+      [](HttpRequest const& request) -> std::optional<HttpResponse> {
+        if (request.target() == "/ok") return std::nullopt;
+        return HttpResponse{}.set_result(HttpResponse::kForbidden);
+      });
+  InProcessInvoker invoker(function);
+  EXPECT_EQ(invoker.Invoke(HttpRequest{}.set_target("/ok")).result(),
+            HttpResponse::kOkay);
+  auto const rejected = invoker.Invoke(HttpRequest{}.set_target("/no"));
+  EXPECT_EQ(rejected.result(), HttpResponse::kForbidden);
+  EXPECT_EQ(rejected.header("connection").value_or(""), "close");
+}
+
+TEST(InProcessInvokerTest, WarmupAndShutdown) {
+  std::vector<std::string> calls;
+  auto function = WithShutdown(
+      WithWarmup(MakeFunction(Hello), [&] { calls.emplace_back("warmup"); }),
+      [&] { calls.emplace_back("shutdown"); });
+  {
+    InProcessInvoker invoker(function);
+    EXPECT_THAT(calls, ElementsAre("warmup"));
+  }
+  EXPECT_THAT(calls, ElementsAre("warmup", "shutdown"));
+}
+
+TEST(InProcessInvokerTest, InvokeRaw) {
+  InProcessInvoker invoker(MakeFunction(Hello), {"--max-body-size=8"});
+  auto response = invoker.InvokeRaw(
+      "POST /raw HTTP/1.1\r\nHost: localhost\r\nContent-Length: 4\r\n\r\n"
+      "data");
+  EXPECT_THAT(response, StartsWith("HTTP/1.1 200 OK\r\n"));
+  EXPECT_THAT(response, HasSubstr("\r\n\r\nHello from /raw"));
+
+  response = invoker.InvokeRaw(
+      "POST /raw HTTP/1.1\r\nHost: localhost\r\nContent-Length: 16\r\n\r\n"
+      "0123456789abcdef");
+  EXPECT_THAT(response, StartsWith("HTTP/1.1 413 Payload Too Large\r\n"));
+
+  for (auto const* invalid :
+       {"not http\r\n\r\n", "GET /incomplete HTTP/1.1\r\nHost: local",
+        "POST /short HTTP/1.1\r\nContent-Length: 8\r\n\r\nabc"}) {
+    SCOPED_TRACE(std::string("Testing with ") + invalid);
+    EXPECT_THAT(invoker.InvokeRaw(invalid),
+                StartsWith("HTTP/1.1 400 Bad Request\r\n"));
+  }
+}
+
+TEST(InProcessInvokerTest, StreamingNotSupported) {
+  auto streaming = MakeFunction(
+      [](HttpRequest const& /*request*/, HttpResponseWriter& /*writer*/) {});
+  EXPECT_THROW(InProcessInvoker{streaming}, std::invalid_argument);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
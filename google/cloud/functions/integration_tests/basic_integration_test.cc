@@ -207,6 +207,29 @@ TEST(RunIntegrationTest, ConformanceSmokeTest) {
   EXPECT_EQ(server.exit_code(), 0);
 }
 
+#ifndef _WIN32
+TEST(RunIntegrationTest, Processes) {
+  auto server = bp::child(ExePath(kServer), "--port=8010", "--processes=2");
+  auto result = WaitForServerReady("localhost", "8010");
+  ASSERT_EQ(result, 0);
+
+  // The worker crashes before it can respond, the supervisor restarts it.
+  EXPECT_ANY_THROW((void)HttpGet("localhost", "8010", "/abort/"));
+  auto actual = HttpGet("localhost", "8010", "/ok");
+  EXPECT_EQ(actual.result_int(), functions::HttpResponse::kOkay);
+
+  // A graceful stop of any worker stops the server.
+  try {
+    for (int i = 0; i != 10; ++i) {
+      (void)HttpGet("localhost", "8010", "/quit/program/0");
+    }
+  } catch (...) {
+  }
+  server.wait();
+  EXPECT_EQ(server.exit_code(), 0);
+}
+#endif  // _WIN32
+
 TEST(RunIntegrationTest, SomeParallelism) {
   auto server = bp::child(ExePath(kServer), "--port=8010");
   auto result = WaitForServerReady("localhost", "8010");
@@ -14,6 +14,7 @@
 
 #include "google/cloud/functions/internal/framework_impl.h"
 #include <atomic>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <sstream>
@@ -34,6 +35,8 @@ HttpResponse EchoServer(HttpRequest const& request) {
   }
   if (target.rfind("/exception/", 0) == 0) throw std::runtime_error(target);
   if (target.rfind("/unknown-exception/", 0) == 0) throw "uh-oh";
+  // Crash the process, to test the supervisor of `--processes`.
+  if (target.rfind("/abort/", 0) == 0) std::abort();
 
   if (target == "/ok") {
     return HttpResponse{}
@@ -0,0 +1,54 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/adaptive_concurrency.h"
+#include <algorithm>
+#include <cmath>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+AdaptiveConcurrency::AdaptiveConcurrency(std::size_t min_limit,
+                                         std::size_t max_limit)
+    : min_limit_(static_cast<double>(std::max<std::size_t>(min_limit, 1))),
+      max_limit_(std::max(min_limit_, static_cast<double>(max_limit))),
+      limit_(min_limit_) {}
+
+void AdaptiveConcurrency::Sample(std::chrono::nanoseconds latency,
+                                 std::size_t inflight) {
+  auto const sample = std::max(static_cast<double>(latency.count()), 1.0);
+  std::lock_guard<std::mutex> lk(mu_);
+  if (baseline_ == 0) {
+    baseline_ = sample;
+  } else {
+    baseline_ += (sample - baseline_) * 2 / (kBaselineWindow + 1);
+  }
+  // After a long overload the baseline includes the queuing, let it recover
+  // faster once the latency drops.
+  if (baseline_ > 2 * sample) baseline_ *= 0.95;
+  if (static_cast<double>(inflight) < limit_ / 2) return;
+
+  auto const gradient = std::clamp(kTolerance * baseline_ / sample, 0.5, 1.0);
+  auto const estimate = limit_ * gradient + std::sqrt(limit_);
+  limit_ = std::clamp(limit_ * (1 - kSmoothing) + estimate * kSmoothing,
+                      min_limit_, max_limit_);
+}
+
+std::size_t AdaptiveConcurrency::limit() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return static_cast<std::size_t>(limit_);
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
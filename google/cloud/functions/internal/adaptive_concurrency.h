@@ -0,0 +1,68 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_ADAPTIVE_CONCURRENCY_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_ADAPTIVE_CONCURRENCY_H
+
+#include "google/cloud/functions/version.h"
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Estimates the concurrency limit of a function from its latency.
+ *
+ * This follows the gradient algorithm of Netflix's concurrency-limits library.
+ * A long-term average of the latency is the baseline. While the latency of new
+ * requests stays within `kTolerance` of the baseline the limit grows, by about
+ * the square root of the limit per request. Once requests slow down, because
+ * they queue for some resource, the limit shrinks in proportion to the
+ * slowdown, at most by half.
+ *
+ * The limit only grows while at least half of it is in use, a function that
+ * does not receive enough requests gives no evidence of a higher limit.
+ */
+class AdaptiveConcurrency {
+ public:
+  /// Starts at @p min_limit, and stays between @p min_limit and @p max_limit.
+  AdaptiveConcurrency(std::size_t min_limit, std::size_t max_limit);
+
+  /// Records the latency of a request, completed with @p inflight requests.
+  void Sample(std::chrono::nanoseconds latency, std::size_t inflight);
+
+  [[nodiscard]] std::size_t limit() const;
+
+  /// How much slower than the baseline the requests may be.
+  static constexpr double kTolerance = 1.5;
+  /// How much of each new estimate goes into the limit.
+  static constexpr double kSmoothing = 0.2;
+  /// The number of requests averaged in the baseline.
+  static constexpr double kBaselineWindow = 600;
+
+ private:
+  double const min_limit_;
+  double const max_limit_;
+  mutable std::mutex mu_;
+  double limit_;
+  /// The baseline latency, in nanoseconds, 0 before the first sample.
+  double baseline_ = 0;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_ADAPTIVE_CONCURRENCY_H
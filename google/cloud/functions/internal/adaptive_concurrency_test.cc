@@ -0,0 +1,78 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/adaptive_concurrency.h"
+#include <gmock/gmock.h>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using std::chrono::milliseconds;
+
+TEST(AdaptiveConcurrency, StartsAtMinimum) {
+  AdaptiveConcurrency limit(4, 16);
+  EXPECT_EQ(limit.limit(), 4);
+
+  AdaptiveConcurrency zero(0, 0);
+  EXPECT_EQ(zero.limit(), 1);
+}
+
+TEST(AdaptiveConcurrency, GrowsWithSteadyLatency) {
+  AdaptiveConcurrency limit(1, 64);
+  auto previous = limit.limit();
+  for (int i = 0; i != 200; ++i) {
+    limit.Sample(milliseconds(10), limit.limit());
+    EXPECT_GE(limit.limit(), previous);
+    previous = limit.limit();
+  }
+  EXPECT_EQ(limit.limit(), 64);
+}
+
+TEST(AdaptiveConcurrency, ShrinksWhenLatencyGrows) {
+  AdaptiveConcurrency limit(1, 64);
+  for (int i = 0; i != 200; ++i) limit.Sample(milliseconds(10), 64);
+  ASSERT_EQ(limit.limit(), 64);
+
+  // Small variations are tolerated.
+  for (int i = 0; i != 10; ++i) limit.Sample(milliseconds(14), 64);
+  EXPECT_EQ(limit.limit(), 64);
+
+  for (int i = 0; i != 10; ++i) limit.Sample(milliseconds(40), 64);
+  auto const shrunk = limit.limit();
+  EXPECT_LT(shrunk, 32);
+  EXPECT_GE(shrunk, 1);
+}
+
+TEST(AdaptiveConcurrency, RecoversAfterOverload) {
+  AdaptiveConcurrency limit(1, 64);
+  for (int i = 0; i != 200; ++i) limit.Sample(milliseconds(10), 64);
+  for (int i = 0; i != 50; ++i) limit.Sample(milliseconds(100), 64);
+  EXPECT_LT(limit.limit(), 8);
+  for (int i = 0; i != 200; ++i) {
+    limit.Sample(milliseconds(10), limit.limit());
+  }
+  EXPECT_EQ(limit.limit(), 64);
+}
+
+TEST(AdaptiveConcurrency, DoesNotGrowWhenIdle) {
+  AdaptiveConcurrency limit(8, 64);
+  // Less than half the limit in use does not show the limit is too low.
+  for (int i = 0; i != 200; ++i) limit.Sample(milliseconds(10), 3);
+  EXPECT_EQ(limit.limit(), 8);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,77 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/admission_control.h"
+#include <boost/beast/core/string.hpp>
+#include <string>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace be = ::boost::beast;
+
+}  // namespace
+
+void AdmissionController::RecordDelay(Clock::duration delay,
+                                      Clock::time_point now) {
+  std::lock_guard<std::mutex> lk(mu_);
+  last_delay_ = now;
+  if (delay < target_) {
+    above_ = false;
+    overloaded_ = false;
+    return;
+  }
+  if (!above_) {
+    above_ = true;
+    above_until_ = now + interval_;
+    return;
+  }
+  if (now >= above_until_) overloaded_ = true;
+}
+
+bool AdmissionController::overloaded(Clock::time_point now) const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return overloaded_ && now - last_delay_ < interval_;
+}
+
+bool IsCloudEventRequest(BeastRequest const& request) {
+  if (request.find("ce-specversion") != request.end()) return true;
+  auto const content_type = request[be::http::field::content_type];
+  auto constexpr kStructured = be::string_view("application/cloudevents");
+  return content_type.size() >= kStructured.size() &&
+         be::iequals(content_type.substr(0, kStructured.size()), kStructured);
+}
+
+PrecheckHandler MakeAdmissionPrecheckHandler(
+    PrecheckHandler precheck, std::shared_ptr<AdmissionController> controller,
+    std::chrono::seconds retry_after) {
+  BeastResponse rejected;
+  rejected.result(be::http::status::too_many_requests);
+  rejected.set(be::http::field::retry_after,
+               std::to_string(retry_after.count()));
+  return [precheck = std::move(precheck), controller = std::move(controller),
+          rejected = std::move(rejected)](
+             BeastRequest const& request) -> std::optional<BeastResponse> {
+    if (IsCloudEventRequest(request) && controller->overloaded()) {
+      return rejected;
+    }
+    if (!precheck) return std::nullopt;
+    return precheck(request);
+  };
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
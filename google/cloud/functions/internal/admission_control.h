@@ -0,0 +1,78 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_ADMISSION_CONTROL_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_ADMISSION_CONTROL_H
+
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/version.h"
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Detects overload from the time requests wait in the server queues.
+ *
+ * This follows CoDel: a queue is overloaded, instead of just absorbing a
+ * burst, once its delay stays above @p target for a whole @p interval. A
+ * single delay below the target ends the overload. So does a silent interval,
+ * as the queues report no delays once they are empty.
+ */
+class AdmissionController {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  AdmissionController(Clock::duration target, Clock::duration interval)
+      : target_(target), interval_(interval) {}
+
+  /// Records the time a request (or connection) waited in a queue.
+  void RecordDelay(Clock::duration delay, Clock::time_point now);
+  void RecordDelay(Clock::duration delay) { RecordDelay(delay, Clock::now()); }
+
+  [[nodiscard]] bool overloaded(Clock::time_point now) const;
+  [[nodiscard]] bool overloaded() const { return overloaded(Clock::now()); }
+
+ private:
+  Clock::duration const target_;
+  Clock::duration const interval_;
+  mutable std::mutex mu_;
+  /// When the delay may be declared an overload, if it stays above target.
+  Clock::time_point above_until_;
+  bool above_ = false;
+  bool overloaded_ = false;
+  Clock::time_point last_delay_;
+};
+
+/// Returns `true` if @p request delivers CloudEvents, in any content mode.
+bool IsCloudEventRequest(BeastRequest const& request);
+
+/**
+ * Wraps @p precheck to reject CloudEvents while the server is overloaded.
+ *
+ * The rejected requests receive `429 Too Many Requests`, with a `Retry-After`
+ * header. Push subscriptions slow down their delivery in response, instead of
+ * timing out and retrying at full rate. Other requests are not affected.
+ */
+PrecheckHandler MakeAdmissionPrecheckHandler(
+    PrecheckHandler precheck, std::shared_ptr<AdmissionController> controller,
+    std::chrono::seconds retry_after);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_ADMISSION_CONTROL_H
@@ -0,0 +1,116 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/admission_control.h"
+#include <gmock/gmock.h>
+#include <chrono>
+#include <memory>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace be = ::boost::beast;
+using std::chrono::milliseconds;
+
+TEST(AdmissionControlTest, SustainedDelay) {
+  AdmissionController controller(milliseconds(5), milliseconds(100));
+  auto const start = AdmissionController::Clock::now();
+  EXPECT_FALSE(controller.overloaded(start));
+
+  // A burst above the target is not an overload.
+  controller.RecordDelay(milliseconds(20), start);
+  controller.RecordDelay(milliseconds(20), start + milliseconds(50));
+  EXPECT_FALSE(controller.overloaded(start + milliseconds(50)));
+
+  // The delay stays above the target for a whole interval.
+  controller.RecordDelay(milliseconds(20), start + milliseconds(100));
+  EXPECT_TRUE(controller.overloaded(start + milliseconds(100)));
+  EXPECT_TRUE(controller.overloaded(start + milliseconds(150)));
+
+  // Without new delays the queue is empty.
+  EXPECT_FALSE(controller.overloaded(start + milliseconds(200)));
+}
+
+TEST(AdmissionControlTest, DelayBelowTarget) {
+  AdmissionController controller(milliseconds(5), milliseconds(100));
+  auto const start = AdmissionController::Clock::now();
+  controller.RecordDelay(milliseconds(20), start);
+  controller.RecordDelay(milliseconds(20), start + milliseconds(100));
+  EXPECT_TRUE(controller.overloaded(start + milliseconds(100)));
+
+  controller.RecordDelay(milliseconds(1), start + milliseconds(110));
+  EXPECT_FALSE(controller.overloaded(start + milliseconds(110)));
+
+  // The interval restarts.
+  controller.RecordDelay(milliseconds(20), start + milliseconds(120));
+  controller.RecordDelay(milliseconds(20), start + milliseconds(150));
+  EXPECT_FALSE(controller.overloaded(start + milliseconds(150)));
+  controller.RecordDelay(milliseconds(20), start + milliseconds(220));
+  EXPECT_TRUE(controller.overloaded(start + milliseconds(220)));
+}
+
+TEST(AdmissionControlTest, IsCloudEventRequest) {
+  BeastRequest binary;
+  binary.set("ce-specversion", "1.0");
+  EXPECT_TRUE(IsCloudEventRequest(binary));
+
+  BeastRequest structured;
+  structured.set(be::http::field::content_type,
+                 "application/cloudevents+json; charset=utf-8");
+  EXPECT_TRUE(IsCloudEventRequest(structured));
+
+  BeastRequest batch;
+  batch.set(be::http::field::content_type,
+            "Application/CloudEvents-Batch+json");
+  EXPECT_TRUE(IsCloudEventRequest(batch));
+
+  BeastRequest plain;
+  plain.set(be::http::field::content_type, "application/json");
+  EXPECT_FALSE(IsCloudEventRequest(plain));
+  EXPECT_FALSE(IsCloudEventRequest(BeastRequest{}));
+}
+
+TEST(AdmissionControlTest, Precheck) {
+  auto controller =
+      std::make_shared<AdmissionController>(milliseconds(5), milliseconds(50));
+  auto prechecked = 0;
+  auto precheck = MakeAdmissionPrecheckHandler(
+      [&prechecked](BeastRequest const&) -> std::optional<BeastResponse> {
+        ++prechecked;
+        return std::nullopt;
+      },
+      controller, std::chrono::seconds(3));
+
+  BeastRequest event;
+  event.set("ce-specversion", "1.0");
+  BeastRequest plain;
+  EXPECT_FALSE(precheck(event).has_value());
+  EXPECT_FALSE(precheck(plain).has_value());
+  EXPECT_EQ(prechecked, 2);
+
+  controller->RecordDelay(milliseconds(20),
+                          AdmissionController::Clock::now() - milliseconds(50));
+  controller->RecordDelay(milliseconds(20));
+  auto rejected = precheck(event);
+  ASSERT_TRUE(rejected.has_value());
+  EXPECT_EQ(rejected->result(), be::http::status::too_many_requests);
+  EXPECT_EQ(rejected->at(be::http::field::retry_after), "3");
+  EXPECT_FALSE(precheck(plain).has_value());
+  EXPECT_EQ(prechecked, 3);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,142 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/allocation_counter.h"
+#if FUNCTIONS_FRAMEWORK_CPP_HAVE_ALLOCATION_COUNTING
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_ALLOCATION_COUNTING
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+#if FUNCTIONS_FRAMEWORK_CPP_HAVE_ALLOCATION_COUNTING
+namespace {
+// Constant initialized, the operators may run before any dynamic
+// initialization.
+thread_local AllocationCounts thread_allocations;
+std::atomic<AllocationHook> allocation_hook{nullptr};
+
+void CountAllocation(std::size_t size) {
+  ++thread_allocations.count;
+  thread_allocations.bytes += size;
+  auto* hook = allocation_hook.load(std::memory_order_relaxed);
+  if (hook != nullptr) hook(size);
+}
+}  // namespace
+
+bool AllocationCountingEnabled() { return true; }
+
+AllocationCounts ThreadAllocations() { return thread_allocations; }
+
+bool SetAllocationHook(AllocationHook hook) {
+  allocation_hook.store(hook);
+  return true;
+}
+
+#else
+
+bool AllocationCountingEnabled() { return false; }
+
+AllocationCounts ThreadAllocations() { return {}; }
+
+bool SetAllocationHook(AllocationHook /*hook*/) { return false; }
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_ALLOCATION_COUNTING
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#if FUNCTIONS_FRAMEWORK_CPP_HAVE_ALLOCATION_COUNTING
+namespace {
+
+using ::google::cloud::functions_internal::CountAllocation;
+
+void* Allocate(std::size_t size) {
+  CountAllocation(size);
+  // `malloc(0)` may return null, `operator new` must not.
+  if (auto* p = std::malloc(size == 0 ? 1 : size)) return p;
+  throw std::bad_alloc();
+}
+
+void* AllocateAligned(std::size_t size, std::align_val_t alignment) {
+  CountAllocation(size);
+  auto const a = static_cast<std::size_t>(alignment);
+  // `aligned_alloc()` requires a size that is a multiple of the alignment.
+  auto const rounded = (size + a - 1) / a * a;
+  if (auto* p = std::aligned_alloc(a, rounded == 0 ? a : rounded)) return p;
+  throw std::bad_alloc();
+}
+
+}  // namespace
+
+// NOLINTBEGIN(misc-new-delete-overloads)
+void* operator new(std::size_t size) { return Allocate(size); }
+void* operator new[](std::size_t size) { return Allocate(size); }
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept try {
+  return Allocate(size);
+} catch (...) {
+  return nullptr;
+}
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept try {
+  return Allocate(size);
+} catch (...) {
+  return nullptr;
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  return AllocateAligned(size, alignment);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  return AllocateAligned(size, alignment);
+}
+void* operator new(std::size_t size, std::align_val_t alignment,
+                   std::nothrow_t const&) noexcept try {
+  return AllocateAligned(size, alignment);
+} catch (...) {
+  return nullptr;
+}
+void* operator new[](std::size_t size, std::align_val_t alignment,
+                     std::nothrow_t const&) noexcept try {
+  return AllocateAligned(size, alignment);
+} catch (...) {
+  return nullptr;
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::nothrow_t const&) noexcept { std::free(p); }
+void operator delete[](void* p, std::nothrow_t const&) noexcept {
+  std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+void operator delete(void* p, std::align_val_t,
+                     std::nothrow_t const&) noexcept {
+  std::free(p);
+}
+void operator delete[](void* p, std::align_val_t,
+                       std::nothrow_t const&) noexcept {
+  std::free(p);
+}
+// NOLINTEND(misc-new-delete-overloads)
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_ALLOCATION_COUNTING
@@ -0,0 +1,75 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_ALLOCATION_COUNTER_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_ALLOCATION_COUNTER_H
+
+#include "google/cloud/functions/version.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// A number of heap allocations, and the bytes they requested.
+struct AllocationCounts {
+  std::uint64_t count = 0;
+  std::uint64_t bytes = 0;
+
+  AllocationCounts& operator+=(AllocationCounts const& rhs) {
+    count += rhs.count;
+    bytes += rhs.bytes;
+    return *this;
+  }
+};
+
+inline AllocationCounts operator-(AllocationCounts const& lhs,
+                                  AllocationCounts const& rhs) {
+  return {lhs.count - rhs.count, lhs.bytes - rhs.bytes};
+}
+
+inline bool operator==(AllocationCounts const& lhs,
+                       AllocationCounts const& rhs) {
+  return lhs.count == rhs.count && lhs.bytes == rhs.bytes;
+}
+
+/**
+ * Returns `true` if the library counts the heap allocations.
+ *
+ * Building with `-DFUNCTIONS_FRAMEWORK_CPP_COUNT_ALLOCATIONS=ON` replaces the
+ * global `operator new` and `operator delete`, and the new operators count
+ * the allocations made by each thread. This is meant for measuring and
+ * benchmarks, the production builds should not use it.
+ */
+bool AllocationCountingEnabled();
+
+/// The allocations made by the calling thread, always 0 if not enabled.
+AllocationCounts ThreadAllocations();
+
+/// Called by `operator new` with the size of each allocation.
+using AllocationHook = void (*)(std::size_t size);
+
+/**
+ * Calls @p hook on each allocation, or stops if @p hook is `nullptr`.
+ *
+ * The hook runs in the allocating thread, before the memory is allocated, and
+ * may run for a while after it is replaced. Returns `false`, and does nothing,
+ * if the library does not count the allocations.
+ */
+bool SetAllocationHook(AllocationHook hook);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_ALLOCATION_COUNTER_H
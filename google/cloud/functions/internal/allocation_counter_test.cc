@@ -0,0 +1,59 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/allocation_counter.h"
+#include <gmock/gmock.h>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+TEST(AllocationCounterTest, Counts) {
+  auto const before = ThreadAllocations();
+  auto p = std::make_unique<std::string>(1000, 'x');
+  auto const after = ThreadAllocations();
+  if (!AllocationCountingEnabled()) {
+    EXPECT_EQ(after, AllocationCounts{});
+    return;
+  }
+  auto const delta = after - before;
+  // The `std::string` object and its buffer.
+  EXPECT_EQ(delta.count, 2);
+  EXPECT_GE(delta.bytes, 1000 + sizeof(std::string));
+}
+
+TEST(AllocationCounterTest, PerThread) {
+  auto const before = ThreadAllocations();
+  std::thread([] {
+    auto p = std::make_unique<std::string>(1000, 'x');
+  }).join();
+  auto const after = ThreadAllocations();
+  // Starting the thread allocates in this thread, but the string is counted
+  // in the other thread.
+  EXPECT_LT(after.bytes - before.bytes, 1000);
+}
+
+TEST(AllocationCounterTest, Arithmetic) {
+  AllocationCounts a{3, 100};
+  a += AllocationCounts{2, 50};
+  EXPECT_EQ(a, (AllocationCounts{5, 150}));
+  EXPECT_EQ((a - AllocationCounts{1, 10}), (AllocationCounts{4, 140}));
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
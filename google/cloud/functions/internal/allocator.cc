@@ -0,0 +1,166 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/allocator.h"
+#include <algorithm>
+#include <utility>
+#if defined(FUNCTIONS_FRAMEWORK_CPP_HAVE_MIMALLOC)
+#include <mimalloc.h>
+#elif defined(FUNCTIONS_FRAMEWORK_CPP_HAVE_JEMALLOC)
+#include <jemalloc/jemalloc.h>
+#include <string>
+#elif defined(__GLIBC__)
+#include <malloc.h>
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_MIMALLOC
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+/// Reports the end of a request once destroyed.
+class ActiveRequest {
+ public:
+  explicit ActiveRequest(std::shared_ptr<IdleMemoryRelease> release)
+      : release_(std::move(release)) {
+    release_->RequestStarted();
+  }
+  ~ActiveRequest() { release_->RequestDone(); }
+
+  ActiveRequest(ActiveRequest const&) = delete;
+  ActiveRequest& operator=(ActiveRequest const&) = delete;
+
+ private:
+  std::shared_ptr<IdleMemoryRelease> release_;
+};
+
+}  // namespace
+
+std::string_view AllocatorName() {
+#if defined(FUNCTIONS_FRAMEWORK_CPP_HAVE_MIMALLOC)
+  return "mimalloc";
+#elif defined(FUNCTIONS_FRAMEWORK_CPP_HAVE_JEMALLOC)
+  return "jemalloc";
+#else
+  return "system";
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_MIMALLOC
+}
+
+void ReleaseFreeMemory() {
+#if defined(FUNCTIONS_FRAMEWORK_CPP_HAVE_MIMALLOC)
+  mi_collect(true);
+#elif defined(FUNCTIONS_FRAMEWORK_CPP_HAVE_JEMALLOC)
+  static auto const kPurge =
+      "arena." + std::to_string(MALLCTL_ARENAS_ALL) + ".purge";
+  mallctl(kPurge.c_str(), nullptr, nullptr, nullptr, 0);
+#elif defined(__GLIBC__)
+  malloc_trim(0);
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_MIMALLOC
+}
+
+bool SetMaxAllocatorArenas(int arenas) {
+#if !defined(FUNCTIONS_FRAMEWORK_CPP_HAVE_MIMALLOC) && \
+    !defined(FUNCTIONS_FRAMEWORK_CPP_HAVE_JEMALLOC) && defined(__GLIBC__)
+  return mallopt(M_ARENA_MAX, arenas) == 1;
+#else
+  (void)arenas;
+  return false;
+#endif  // __GLIBC__
+}
+
+IdleMemoryRelease::IdleMemoryRelease(Clock::duration idle_period,
+                                     std::function<void()> release)
+    : idle_period_(idle_period),
+      release_(std::move(release)),
+      thread_([this] { Run(); }) {}
+
+IdleMemoryRelease::~IdleMemoryRelease() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+}
+
+void IdleMemoryRelease::Run() {
+  // Checking a few times per period bounds the delay past the idle period,
+  // without waking up often.
+  auto const interval = std::max<Clock::duration>(
+      idle_period_ / 4, std::chrono::milliseconds(1));
+  auto last_started = started_.load();
+  auto last_active = Clock::now();
+  auto released = false;
+  std::unique_lock<std::mutex> lk(mu_);
+  while (!cv_.wait_for(lk, interval, [this] { return shutdown_; })) {
+    auto const now = Clock::now();
+    auto const started = started_.load();
+    if (started != last_started || active_.load() != 0) {
+      last_started = started;
+      last_active = now;
+      released = false;
+      continue;
+    }
+    if (released || now - last_active < idle_period_) continue;
+    released = true;
+    lk.unlock();
+    release_();
+    release_count_.fetch_add(1);
+    lk.lock();
+  }
+}
+
+Handler MakeIdleReleaseHandler(Handler handler,
+                               std::shared_ptr<IdleMemoryRelease> release) {
+  return [handler = std::move(handler),
+          release = std::move(release)](BeastRequest request) {
+    ActiveRequest active(release);
+    return handler(std::move(request));
+  };
+}
+
+StreamingHandler MakeIdleReleaseStreamingHandler(
+    StreamingHandler handler, std::shared_ptr<IdleMemoryRelease> release) {
+  return [handler = std::move(handler), release = std::move(release)](
+             BeastRequest request, functions::HttpRequestBodyReader& reader) {
+    ActiveRequest active(release);
+    return handler(std::move(request), reader);
+  };
+}
+
+WriterHandler MakeIdleReleaseWriterHandler(
+    WriterHandler handler, std::shared_ptr<IdleMemoryRelease> release) {
+  return [handler = std::move(handler), release = std::move(release)](
+             BeastRequest request, ResponseWriter& writer) {
+    ActiveRequest active(release);
+    return handler(std::move(request), writer);
+  };
+}
+
+AsyncHandler MakeIdleReleaseAsyncHandler(
+    AsyncHandler handler, std::shared_ptr<IdleMemoryRelease> release) {
+  return [handler = std::move(handler), release = std::move(release)](
+             BeastRequest request, AsyncResponseCallback callback) {
+    // The request is active until the callback runs, or is discarded.
+    auto active = std::make_shared<ActiveRequest>(release);
+    handler(std::move(request),
+            [callback = std::move(callback),
+             active = std::move(active)](BeastResponse response) mutable {
+              callback(std::move(response));
+              active.reset();
+            });
+  };
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
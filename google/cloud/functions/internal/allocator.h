@@ -0,0 +1,119 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_ALLOCATOR_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_ALLOCATOR_H
+
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/version.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * The allocator linked into the program.
+ *
+ * Either `mimalloc` or `jemalloc`, as configured with
+ * `FUNCTIONS_FRAMEWORK_CPP_ALLOCATOR`, or `system`.
+ */
+std::string_view AllocatorName();
+
+/**
+ * Returns the free memory cached by the allocator to the operating system.
+ *
+ * Uses `mi_collect()` with mimalloc, purges all the arenas with jemalloc, and
+ * calls `malloc_trim()` with glibc. Does nothing with other allocators.
+ */
+void ReleaseFreeMemory();
+
+/**
+ * Limits the number of allocator arenas, the memory pools shared by threads.
+ *
+ * Fewer arenas reduce the fragmentation, at the cost of more contention. Only
+ * the glibc allocator supports this at runtime (`M_ARENA_MAX`), set
+ * `MALLOC_CONF=narenas:N` with jemalloc. mimalloc has per-thread heaps, and
+ * no shared arenas. Returns `false` if the allocator does not support it.
+ */
+bool SetMaxAllocatorArenas(int arenas);
+
+/**
+ * Releases the free memory once the server is idle.
+ *
+ * The handlers report the start and end of each request. A background thread
+ * calls @p release once no request has run for @p idle_period, and again
+ * only after more requests run. On Cloud Run the instances are billed for
+ * their memory, and often idle between bursts of requests.
+ */
+class IdleMemoryRelease {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit IdleMemoryRelease(
+      Clock::duration idle_period,
+      std::function<void()> release = ReleaseFreeMemory);
+  ~IdleMemoryRelease();
+
+  IdleMemoryRelease(IdleMemoryRelease const&) = delete;
+  IdleMemoryRelease& operator=(IdleMemoryRelease const&) = delete;
+
+  void RequestStarted() {
+    active_.fetch_add(1);
+    started_.fetch_add(1);
+  }
+  void RequestDone() { active_.fetch_sub(1); }
+
+  /// The number of times the memory was released.
+  [[nodiscard]] std::uint64_t release_count() const {
+    return release_count_.load();
+  }
+
+ private:
+  void Run();
+
+  Clock::duration const idle_period_;
+  std::function<void()> const release_;
+  std::atomic<std::int64_t> active_{0};
+  std::atomic<std::uint64_t> started_{0};
+  std::atomic<std::uint64_t> release_count_{0};
+  std::mutex mu_;
+  std::condition_variable cv_;
+  bool shutdown_ = false;
+  std::thread thread_;
+};
+
+/// Wrap the handlers to report each request to @p release.
+///@{
+Handler MakeIdleReleaseHandler(Handler handler,
+                               std::shared_ptr<IdleMemoryRelease> release);
+StreamingHandler MakeIdleReleaseStreamingHandler(
+    StreamingHandler handler, std::shared_ptr<IdleMemoryRelease> release);
+WriterHandler MakeIdleReleaseWriterHandler(
+    WriterHandler handler, std::shared_ptr<IdleMemoryRelease> release);
+AsyncHandler MakeIdleReleaseAsyncHandler(
+    AsyncHandler handler, std::shared_ptr<IdleMemoryRelease> release);
+///@}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_ALLOCATOR_H
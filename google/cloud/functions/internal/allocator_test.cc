@@ -0,0 +1,118 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/allocator.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using std::chrono::milliseconds;
+
+/// Waits up to 5 seconds for @p release to release the memory @p count times.
+bool WaitForReleases(IdleMemoryRelease const& release, std::uint64_t count) {
+  auto const deadline = std::chrono::steady_clock::now() + milliseconds(5000);
+  while (release.release_count() < count) {
+    if (std::chrono::steady_clock::now() > deadline) return false;
+    std::this_thread::sleep_for(milliseconds(1));
+  }
+  return true;
+}
+
+TEST(AllocatorTest, Name) {
+#if defined(FUNCTIONS_FRAMEWORK_CPP_HAVE_MIMALLOC)
+  EXPECT_EQ(AllocatorName(), "mimalloc");
+#elif defined(FUNCTIONS_FRAMEWORK_CPP_HAVE_JEMALLOC)
+  EXPECT_EQ(AllocatorName(), "jemalloc");
+#else
+  EXPECT_EQ(AllocatorName(), "system");
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_MIMALLOC
+}
+
+TEST(AllocatorTest, ReleaseFreeMemory) {
+  auto buffers = std::vector<std::unique_ptr<char[]>>(1024);
+  for (auto& b : buffers) b = std::make_unique<char[]>(16 * 1024);
+  buffers.clear();
+  ReleaseFreeMemory();
+  // The allocator is still usable.
+  auto p = std::make_unique<char[]>(1024);
+  EXPECT_NE(p.get(), nullptr);
+}
+
+TEST(AllocatorTest, ReleaseOnceIdle) {
+  std::atomic<int> calls{0};
+  IdleMemoryRelease release(milliseconds(20), [&calls] { ++calls; });
+  ASSERT_TRUE(WaitForReleases(release, 1));
+  // Released once per idle period with requests.
+  std::this_thread::sleep_for(milliseconds(100));
+  EXPECT_EQ(release.release_count(), 1);
+
+  release.RequestStarted();
+  release.RequestDone();
+  ASSERT_TRUE(WaitForReleases(release, 2));
+  EXPECT_EQ(calls.load(), 2);
+}
+
+TEST(AllocatorTest, NoReleaseWhileActive) {
+  IdleMemoryRelease release(milliseconds(20), [] {});
+  AsyncResponseCallback pending;
+  auto handler = MakeIdleReleaseAsyncHandler(
+      [&pending](BeastRequest const&, AsyncResponseCallback callback) {
+        pending = std::move(callback);
+      },
+      std::shared_ptr<IdleMemoryRelease>(&release, [](auto*) {}));
+  BeastResponse response;
+  handler(BeastRequest{}, [&](BeastResponse r) { response = std::move(r); });
+  std::this_thread::sleep_for(milliseconds(100));
+  EXPECT_EQ(release.release_count(), 0);
+
+  BeastResponse sent;
+  sent.result(boost::beast::http::status::accepted);
+  pending(std::move(sent));
+  EXPECT_EQ(response.result(), boost::beast::http::status::accepted);
+  pending = nullptr;
+  EXPECT_TRUE(WaitForReleases(release, 1));
+}
+
+TEST(AllocatorTest, Handlers) {
+  auto release = std::make_shared<IdleMemoryRelease>(milliseconds(1000));
+  auto handler = MakeIdleReleaseHandler(
+      [](BeastRequest const&) {
+        BeastResponse response;
+        response.body() = "handler";
+        return response;
+      },
+      release);
+  EXPECT_EQ(handler(BeastRequest{}).body(), "handler");
+
+  auto writer = MakeIdleReleaseWriterHandler(
+      [](BeastRequest const&, ResponseWriter&) { return true; }, release);
+  EXPECT_TRUE(static_cast<bool>(writer));
+  auto streaming = MakeIdleReleaseStreamingHandler(
+      [](BeastRequest const&, functions::HttpRequestBodyReader&) {
+        return BeastResponse{};
+      },
+      release);
+  EXPECT_TRUE(static_cast<bool>(streaming));
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,83 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/background_activity.h"
+#include <memory>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+/// Reports the end of a request once destroyed.
+class ActiveRequest {
+ public:
+  explicit ActiveRequest(functions::BackgroundExecutor& executor)
+      : executor_(executor) {
+    executor_.RequestStarted();
+  }
+  ~ActiveRequest() { executor_.RequestDone(); }
+
+  ActiveRequest(ActiveRequest const&) = delete;
+  ActiveRequest& operator=(ActiveRequest const&) = delete;
+
+ private:
+  functions::BackgroundExecutor& executor_;
+};
+
+}  // namespace
+
+Handler MakeBackgroundActivityHandler(Handler handler,
+                                      functions::BackgroundExecutor& executor) {
+  return [handler = std::move(handler), &executor](BeastRequest request) {
+    ActiveRequest active(executor);
+    return handler(std::move(request));
+  };
+}
+
+StreamingHandler MakeBackgroundActivityStreamingHandler(
+    StreamingHandler handler, functions::BackgroundExecutor& executor) {
+  return [handler = std::move(handler), &executor](
+             BeastRequest request, functions::HttpRequestBodyReader& reader) {
+    ActiveRequest active(executor);
+    return handler(std::move(request), reader);
+  };
+}
+
+WriterHandler MakeBackgroundActivityWriterHandler(
+    WriterHandler handler, functions::BackgroundExecutor& executor) {
+  return [handler = std::move(handler), &executor](BeastRequest request,
+                                                   ResponseWriter& writer) {
+    ActiveRequest active(executor);
+    return handler(std::move(request), writer);
+  };
+}
+
+AsyncHandler MakeBackgroundActivityAsyncHandler(
+    AsyncHandler handler, functions::BackgroundExecutor& executor) {
+  return [handler = std::move(handler), &executor](
+             BeastRequest request, AsyncResponseCallback callback) {
+    // The request is active until the callback runs, or is discarded.
+    auto active = std::make_shared<ActiveRequest>(executor);
+    handler(std::move(request),
+            [callback = std::move(callback),
+             active = std::move(active)](BeastResponse response) mutable {
+              callback(std::move(response));
+              active.reset();
+            });
+  };
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,45 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_BACKGROUND_ACTIVITY_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_BACKGROUND_ACTIVITY_H
+
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/background_executor.h"
+#include "google/cloud/functions/version.h"
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Wrap the handlers to report each request to @p executor.
+ *
+ * The deferred tasks of @p executor then run while the requests hold the CPU,
+ * see `functions::BackgroundExecutor::Defer()`.
+ */
+///@{
+Handler MakeBackgroundActivityHandler(Handler handler,
+                                      functions::BackgroundExecutor& executor);
+StreamingHandler MakeBackgroundActivityStreamingHandler(
+    StreamingHandler handler, functions::BackgroundExecutor& executor);
+WriterHandler MakeBackgroundActivityWriterHandler(
+    WriterHandler handler, functions::BackgroundExecutor& executor);
+AsyncHandler MakeBackgroundActivityAsyncHandler(
+    AsyncHandler handler, functions::BackgroundExecutor& executor);
+///@}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_BACKGROUND_ACTIVITY_H
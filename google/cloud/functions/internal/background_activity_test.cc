@@ -0,0 +1,88 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/background_activity.h"
+#include <gmock/gmock.h>
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using std::chrono::seconds;
+
+TEST(BackgroundActivityTest, Handler) {
+  functions::BackgroundExecutor executor(1, 1);
+  auto handler = MakeBackgroundActivityHandler(
+      [&executor](BeastRequest const&) {
+        // The request is in flight, so deferred tasks start immediately.
+        executor.Defer([] {});
+        BeastResponse response;
+        response.body() = "handler";
+        return response;
+      },
+      executor);
+  EXPECT_EQ(handler(BeastRequest{}).body(), "handler");
+  EXPECT_TRUE(executor.Drain(seconds(10)));
+}
+
+TEST(BackgroundActivityTest, StartsDeferred) {
+  functions::BackgroundExecutor executor(1, 1);
+  executor.Defer([] {});
+  executor.Defer([] {});
+  auto handler = MakeBackgroundActivityHandler(
+      [&executor](BeastRequest const&) {
+        BeastResponse response;
+        response.body() = std::to_string(executor.pending());
+        return response;
+      },
+      executor);
+  // Each request starts one task, the other task remains deferred.
+  auto const first = handler(BeastRequest{}).body();
+  EXPECT_TRUE(first == "2" || first == "1");
+  handler(BeastRequest{});
+  EXPECT_TRUE(executor.Drain(seconds(10)));
+  EXPECT_EQ(executor.pending(), 0);
+}
+
+TEST(BackgroundActivityTest, AsyncHandler) {
+  functions::BackgroundExecutor executor(1);
+  AsyncResponseCallback pending;
+  auto handler = MakeBackgroundActivityAsyncHandler(
+      [&pending](BeastRequest const&, AsyncResponseCallback callback) {
+        pending = std::move(callback);
+      },
+      executor);
+  auto done = false;
+  handler(BeastRequest{}, [&done](BeastResponse const&) { done = true; });
+  pending(BeastResponse{});
+  EXPECT_TRUE(done);
+  pending = nullptr;
+
+  auto writer = MakeBackgroundActivityWriterHandler(
+      [](BeastRequest const&, ResponseWriter&) { return true; }, executor);
+  EXPECT_TRUE(static_cast<bool>(writer));
+  auto streaming = MakeBackgroundActivityStreamingHandler(
+      [](BeastRequest const&, functions::HttpRequestBodyReader&) {
+        return BeastResponse{};
+      },
+      executor);
+  EXPECT_TRUE(static_cast<bool>(streaming));
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -13,43 +13,130 @@
 // limitations under the License.
 
 #include "google/cloud/functions/internal/base64_decode.h"
-#include <boost/archive/iterators/binary_from_base64.hpp>
-#include <boost/archive/iterators/transform_width.hpp>
+#include <array>
+#include <cstdint>
 #include <stdexcept>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
 
-// NOLINTNEXTLINE(misc-no-recursion)
-std::string Base64Decode(std::string const& base64) {
-  if (base64.size() % 4 != 0) {
-    // This should be uncommon, to avoid copying every time, pad only when
-    // needed and try again.
-    auto padded = base64;
-    padded.append((4 - padded.size() % 4) % 4, '=');
-    return Base64Decode(padded);
+auto constexpr kInvalid = std::uint8_t{0xFF};
+
+using DecodeTable = std::array<std::uint8_t, 256>;
+
+char constexpr kAlphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+char constexpr kUrlSafeAlphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+constexpr DecodeTable MakeDecodeTable(char const* alphabet) {
+  DecodeTable table{};
+  for (auto& v : table) v = kInvalid;
+  for (std::uint8_t value = 0; value != 64; ++value) {
+    table[static_cast<unsigned char>(alphabet[value])] = value;
+  }
+  return table;
+}
+
+auto constexpr kStandardTable = MakeDecodeTable(kAlphabet);
+auto constexpr kUrlSafeTable = MakeDecodeTable(kUrlSafeAlphabet);
+
+[[noreturn]] void ThrowInvalid(std::string_view base64) {
+  throw std::invalid_argument("Invalid base64 string <" + std::string(base64) +
+                              ">");
+}
+
+/// Returns @p base64 without its padding, validating the padding.
+std::string_view StripPadding(std::string_view base64) {
+  auto const end = base64.find_last_not_of('=');
+  auto const size = end == std::string_view::npos ? 0 : end + 1;
+  auto const pad_count = base64.size() - size;
+  // The padding, if any, only completes the last group of 4 characters.
+  auto const rounded = (size + 3) / 4 * 4;
+  if (pad_count > 2 || size + pad_count > rounded || size % 4 == 1) {
+    ThrowInvalid(base64);
   }
+  return base64.substr(0, size);
+}
 
-  namespace bai = boost::archive::iterators;
-  auto constexpr kBase64RawBits = 6;
-  auto constexpr kBase64EncodedBits = 8;
-  using Decoder =
-      bai::transform_width<bai::binary_from_base64<std::string::const_iterator>,
-                           kBase64EncodedBits, kBase64RawBits>;
-  // While we know how much padding we added, there may have been some padding
-  // there, just not enough. We need to determine the actual number of `=`
-  // characters at the end of the string.
-  auto pad_count = std::distance(base64.rbegin(),
-                                 std::find_if(base64.rbegin(), base64.rend(),
-                                              [](auto c) { return c != '='; }));
-  if (pad_count > 2) {
-    throw std::invalid_argument("Invalid base64 string <" + base64 + ">");
+std::size_t DecodedSize(std::size_t unpadded) {
+  auto constexpr kPartial = std::array<std::size_t, 4>{0, 0, 1, 2};
+  return unpadded / 4 * 3 + kPartial[unpadded % 4];
+}
+
+}  // namespace
+
+std::size_t Base64DecodedSize(std::string_view base64) {
+  return DecodedSize(StripPadding(base64).size());
+}
+
+std::size_t Base64Decode(std::string_view base64, char* out,
+                         Base64Alphabet alphabet) {
+  auto const& table =
+      alphabet == Base64Alphabet::kUrlSafe ? kUrlSafeTable : kStandardTable;
+  auto const input = StripPadding(base64);
+  auto const* p = reinterpret_cast<unsigned char const*>(input.data());
+  auto const* const end = p + input.size();
+  auto* o = reinterpret_cast<unsigned char*>(out);
+  // Decode each group of 4 characters into 3 bytes. Invalid characters map to
+  // values with the high bit set, a single test per group detects them.
+  for (; end - p >= 4; p += 4, o += 3) {
+    std::uint32_t const a = table[p[0]];
+    std::uint32_t const b = table[p[1]];
+    std::uint32_t const c = table[p[2]];
+    std::uint32_t const d = table[p[3]];
+    if (((a | b | c | d) & 0x80U) != 0) ThrowInvalid(base64);
+    auto const v = (a << 18) | (b << 12) | (c << 6) | d;
+    o[0] = static_cast<unsigned char>(v >> 16);
+    o[1] = static_cast<unsigned char>(v >> 8);
+    o[2] = static_cast<unsigned char>(v);
   }
+  // The last group may have 2 or 3 characters, without padding.
+  if (p != end) {
+    std::uint32_t const a = table[p[0]];
+    std::uint32_t const b = table[p[1]];
+    std::uint32_t const c = end - p == 3 ? table[p[2]] : 0;
+    if (((a | b | c) & 0x80U) != 0) ThrowInvalid(base64);
+    auto const v = (a << 18) | (b << 12) | (c << 6);
+    *o++ = static_cast<unsigned char>(v >> 16);
+    if (end - p == 3) *o++ = static_cast<unsigned char>(v >> 8);
+  }
+  return static_cast<std::size_t>(o - reinterpret_cast<unsigned char*>(out));
+}
 
-  auto data = std::string{Decoder(base64.begin()), Decoder(base64.end())};
-  for (; pad_count != 0; --pad_count) data.pop_back();
+std::string Base64Decode(std::string_view base64, Base64Alphabet alphabet) {
+  std::string data;
+  data.resize(Base64DecodedSize(base64));
+  Base64Decode(base64, data.data(), alphabet);
   return data;
 }
 
+void Base64Encode(std::string_view data, std::string& out,
+                  Base64Alphabet alphabet) {
+  auto const* const chars =
+      alphabet == Base64Alphabet::kUrlSafe ? kUrlSafeAlphabet : kAlphabet;
+  auto const offset = out.size();
+  out.resize(offset + (data.size() + 2) / 3 * 4);
+  auto const* p = reinterpret_cast<unsigned char const*>(data.data());
+  auto const* const end = p + data.size();
+  auto* o = out.data() + offset;
+  for (; end - p >= 3; p += 3, o += 4) {
+    auto const v = (std::uint32_t{p[0]} << 16) | (std::uint32_t{p[1]} << 8) |
+                   std::uint32_t{p[2]};
+    o[0] = chars[(v >> 18) & 0x3F];
+    o[1] = chars[(v >> 12) & 0x3F];
+    o[2] = chars[(v >> 6) & 0x3F];
+    o[3] = chars[v & 0x3F];
+  }
+  if (p == end) return;
+  auto const v = (std::uint32_t{p[0]} << 16) |
+                 (end - p == 2 ? std::uint32_t{p[1]} << 8 : 0);
+  o[0] = chars[(v >> 18) & 0x3F];
+  o[1] = chars[(v >> 12) & 0x3F];
+  o[2] = end - p == 2 ? chars[(v >> 6) & 0x3F] : '=';
+  o[3] = '=';
+}
+
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions_internal
@@ -16,12 +16,39 @@
 #define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_BASE64_DECODE_H
 
 #include "google/cloud/functions/version.h"
+#include <cstddef>
 #include <string>
+#include <string_view>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 
-std::string Base64Decode(std::string const& base64);
+/// The base64 alphabets, see RFC 4648.
+enum class Base64Alphabet { kStandard, kUrlSafe };
+
+/**
+ * Returns the size of the data encoded in @p base64.
+ *
+ * The padding is optional. Throws `std::invalid_argument` if @p base64 has too
+ * much padding, does not check the other characters.
+ */
+std::size_t Base64DecodedSize(std::string_view base64);
+
+/**
+ * Decodes @p base64 into @p out, returns the number of bytes written.
+ *
+ * @p out must have room for `Base64DecodedSize(base64)` bytes. Throws
+ * `std::invalid_argument` if @p base64 is not valid.
+ */
+std::size_t Base64Decode(std::string_view base64, char* out,
+                         Base64Alphabet alphabet = Base64Alphabet::kStandard);
+
+std::string Base64Decode(std::string_view base64,
+                         Base64Alphabet alphabet = Base64Alphabet::kStandard);
+
+/// Appends the padded base64 encoding of @p data to @p out.
+void Base64Encode(std::string_view data, std::string& out,
+                  Base64Alphabet alphabet = Base64Alphabet::kStandard);
 
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions_internal
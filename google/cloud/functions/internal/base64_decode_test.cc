@@ -14,6 +14,8 @@
 
 #include "google/cloud/functions/internal/base64_decode.h"
 #include <gmock/gmock.h>
+#include <cstdint>
+#include <string>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
@@ -60,6 +62,90 @@ TEST(Base64DecodeTest, Overpadded) {
   EXPECT_THROW(Base64Decode(kExcessivePadding), std::invalid_argument);
 }
 
+TEST(Base64DecodeTest, InvalidCharacters) {
+  EXPECT_THROW(Base64Decode("YW*j"), std::invalid_argument);
+  EXPECT_THROW(Base64Decode("YW\nj"), std::invalid_argument);
+  EXPECT_THROW(Base64Decode("Y"), std::invalid_argument);
+  EXPECT_THROW(Base64Decode("YWJj="), std::invalid_argument);
+  EXPECT_THROW(Base64Decode("YW=j"), std::invalid_argument);
+}
+
+TEST(Base64DecodeTest, UrlSafe) {
+  //   echo -n $'\xfb\xff' | openssl base64 -e
+  EXPECT_EQ(Base64Decode("+/8=", Base64Alphabet::kStandard), "\xfb\xff");
+  EXPECT_EQ(Base64Decode("-_8", Base64Alphabet::kUrlSafe), "\xfb\xff");
+  EXPECT_THROW(Base64Decode("-_8"), std::invalid_argument);
+  EXPECT_THROW(Base64Decode("+/8", Base64Alphabet::kUrlSafe),
+               std::invalid_argument);
+}
+
+TEST(Base64DecodeTest, IntoBuffer) {
+  auto constexpr kEncoded = "SGVsbG8gV29ybGQ";
+  ASSERT_EQ(Base64DecodedSize(kEncoded), 11);
+  std::string buffer(16, '-');
+  EXPECT_EQ(Base64Decode(kEncoded, buffer.data()), 11);
+  EXPECT_EQ(buffer, "Hello World-----");
+}
+
+TEST(Base64DecodeTest, AllBytes) {
+  // Round trip all the byte values through a simple reference encoder.
+  std::string data;
+  for (int i = 0; i != 256; ++i) data.push_back(static_cast<char>(i));
+  auto constexpr kAlphabet =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string encoded;
+  std::uint32_t bits = 0;
+  int count = 0;
+  for (auto c : data) {
+    bits = (bits << 8) | static_cast<unsigned char>(c);
+    count += 8;
+    while (count >= 6) {
+      count -= 6;
+      encoded.push_back(kAlphabet[(bits >> count) & 0x3F]);
+    }
+  }
+  if (count != 0) encoded.push_back(kAlphabet[(bits << (6 - count)) & 0x3F]);
+  EXPECT_EQ(Base64Decode(encoded), data);
+}
+
+TEST(Base64DecodeTest, Encode) {
+  struct {
+    std::string data;
+    std::string expected;
+  } const cases[] = {
+      {"", ""},
+      {"f", "Zg=="},
+      {"fo", "Zm8="},
+      {"foo", "Zm9v"},
+      {"foob", "Zm9vYg=="},
+      {"fooba", "Zm9vYmE="},
+      {"foobar", "Zm9vYmFy"},
+  };
+  for (auto const& [data, expected] : cases) {
+    std::string out = "prefix:";
+    Base64Encode(data, out);
+    EXPECT_EQ(out, "prefix:" + expected);
+  }
+
+  std::string const bytes("\xFB\xFF", 2);
+  std::string standard;
+  Base64Encode(bytes, standard);
+  EXPECT_EQ(standard, "+/8=");
+  std::string url_safe;
+  Base64Encode(bytes, url_safe, Base64Alphabet::kUrlSafe);
+  EXPECT_EQ(url_safe, "-_8=");
+}
+
+TEST(Base64DecodeTest, EncodeRoundTrip) {
+  std::string data;
+  for (int i = 0; i != 256; ++i) {
+    data.push_back(static_cast<char>(i));
+    std::string encoded;
+    Base64Encode(data, encoded);
+    EXPECT_EQ(Base64Decode(encoded), data);
+  }
+}
+
 }  // namespace
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions_internal
@@ -0,0 +1,263 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/body_checksums.h"
+#include "google/cloud/functions/internal/base64_decode.h"
+#include "google/cloud/functions/internal/crc32c.h"
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace be = ::boost::beast;
+
+thread_local std::shared_ptr<BodyChecksumState> current_checksums;
+
+auto constexpr kMismatch =
+    std::string_view("the request body does not match its checksum");
+
+std::string_view Trim(std::string_view s) {
+  auto const b = s.find_first_not_of(" \t");
+  if (b == std::string_view::npos) return {};
+  auto const e = s.find_last_not_of(" \t");
+  return s.substr(b, e - b + 1);
+}
+
+/// Calls @p f with each element in the comma separated list @p list.
+template <typename Function>
+void ForEachElement(std::string_view list, Function f) {
+  while (!list.empty()) {
+    auto const comma = list.find(',');
+    f(Trim(list.substr(0, comma)));
+    if (comma == std::string_view::npos) break;
+    list.remove_prefix(comma + 1);
+  }
+}
+
+/// Decodes @p base64, throws `std::invalid_argument` unless it has @p size
+/// bytes.
+std::string DecodeChecksum(std::string_view base64, std::size_t size) {
+  auto decoded = Base64Decode(base64);
+  if (decoded.size() != size) {
+    throw std::invalid_argument("invalid checksum size");
+  }
+  return decoded;
+}
+
+std::uint32_t DecodeCrc32c(std::string_view base64) {
+  auto const decoded = DecodeChecksum(base64, 4);
+  std::uint32_t crc = 0;
+  for (auto c : decoded) crc = (crc << 8) | static_cast<unsigned char>(c);
+  return crc;
+}
+
+Md5::Digest DecodeMd5(std::string_view base64) {
+  auto const decoded = DecodeChecksum(base64, 16);
+  Md5::Digest digest;
+  for (std::size_t i = 0; i != digest.size(); ++i) {
+    digest[i] = static_cast<std::uint8_t>(decoded[i]);
+  }
+  return digest;
+}
+
+BeastResponse MismatchError() {
+  BeastResponse response;
+  response.result(be::http::status::bad_request);
+  response.set(be::http::field::content_type, "text/plain");
+  response.body() = std::string(kMismatch);
+  return response;
+}
+
+/**
+ * Computes the checksums of @p request, returns an error response if they do
+ * not match the checksums sent by the client.
+ */
+std::optional<BeastResponse> CheckBody(BeastRequest const& request,
+                                       BodyChecksumOptions options,
+                                       BodyChecksumState& state) {
+  auto const expected = GetExpectedBodyChecksums(request);
+  if (!expected) return MismatchError();
+  BodyChecksummer checksummer(options);
+  checksummer.Update(request.body());
+  state.checksums = checksummer.Finish();
+  if (!BodyChecksumsMatch(*expected, *state.checksums)) return MismatchError();
+  return std::nullopt;
+}
+
+/// Computes the checksums of the body as the function reads it.
+class ChecksummingReader : public functions::HttpRequestBodyReader {
+ public:
+  ChecksummingReader(functions::HttpRequestBodyReader& impl,
+                     BodyChecksumOptions options,
+                     std::optional<functions::BodyChecksums> expected,
+                     BodyChecksumState& state)
+      : impl_(impl),
+        checksummer_(options),
+        expected_(std::move(expected)),
+        state_(state) {}
+
+  std::size_t Read(char* data, std::size_t size) override {
+    if (state_.checksums) return 0;
+    auto const n = impl_.Read(data, size);
+    if (n != 0) {
+      checksummer_.Update(std::string_view(data, n));
+      return n;
+    }
+    state_.checksums = checksummer_.Finish();
+    if (!expected_ || !BodyChecksumsMatch(*expected_, *state_.checksums)) {
+      throw std::runtime_error(std::string(kMismatch));
+    }
+    return 0;
+  }
+
+ private:
+  functions::HttpRequestBodyReader& impl_;
+  BodyChecksummer checksummer_;
+  std::optional<functions::BodyChecksums> expected_;
+  BodyChecksumState& state_;
+};
+
+}  // namespace
+
+BodyChecksumOptions ParseBodyChecksumOptions(std::string_view value) {
+  BodyChecksumOptions options;
+  ForEachElement(value, [&options](std::string_view name) {
+    if (name == "crc32c") {
+      options.crc32c = true;
+    } else if (name == "md5") {
+      options.md5 = true;
+    } else if (!name.empty()) {
+      throw std::invalid_argument("Unknown request checksum (" +
+                                  std::string(name) +
+                                  "), expected `crc32c` or `md5`.");
+    }
+  });
+  return options;
+}
+
+BodyChecksummer::BodyChecksummer(BodyChecksumOptions options) {
+  if (options.crc32c) crc32c_ = 0;
+  if (options.md5) md5_.emplace();
+}
+
+void BodyChecksummer::Update(std::string_view data) {
+  if (crc32c_) crc32c_ = ExtendCrc32c(*crc32c_, data);
+  if (md5_) md5_->Update(data);
+}
+
+functions::BodyChecksums BodyChecksummer::Finish() {
+  functions::BodyChecksums checksums;
+  checksums.crc32c = crc32c_;
+  if (md5_) checksums.md5 = md5_->Finish();
+  return checksums;
+}
+
+std::optional<functions::BodyChecksums> GetExpectedBodyChecksums(
+    BeastRequest const& request) try {
+  functions::BodyChecksums expected;
+  auto const [begin, end] = request.equal_range("x-goog-hash");
+  for (auto h = begin; h != end; ++h) {
+    auto const value = h->value();
+    ForEachElement({value.data(), value.size()}, [&](std::string_view e) {
+      auto const eq = e.find('=');
+      if (eq == std::string_view::npos) return;
+      auto const name = e.substr(0, eq);
+      auto const base64 = e.substr(eq + 1);
+      if (name == "crc32c") expected.crc32c = DecodeCrc32c(base64);
+      if (name == "md5") expected.md5 = DecodeMd5(base64);
+    });
+  }
+  auto const content_md5 = request[be::http::field::content_md5];
+  if (!content_md5.empty() && !expected.md5) {
+    expected.md5 = DecodeMd5(Trim({content_md5.data(), content_md5.size()}));
+  }
+  return expected;
+} catch (std::invalid_argument const&) {
+  return std::nullopt;
+}
+
+bool BodyChecksumsMatch(functions::BodyChecksums const& expected,
+                        functions::BodyChecksums const& actual) {
+  if (expected.crc32c && actual.crc32c && *expected.crc32c != *actual.crc32c) {
+    return false;
+  }
+  return !(expected.md5 && actual.md5 && *expected.md5 != *actual.md5);
+}
+
+std::shared_ptr<BodyChecksumState> CurrentBodyChecksums() {
+  return current_checksums;
+}
+
+ScopedBodyChecksums::ScopedBodyChecksums(
+    std::shared_ptr<BodyChecksumState> state)
+    : previous_(std::exchange(current_checksums, std::move(state))) {}
+
+ScopedBodyChecksums::~ScopedBodyChecksums() {
+  current_checksums = std::move(previous_);
+}
+
+Handler MakeBodyChecksumHandler(Handler handler, BodyChecksumOptions options) {
+  return [h = std::move(handler), options](BeastRequest request) {
+    auto state = std::make_shared<BodyChecksumState>();
+    if (auto error = CheckBody(request, options, *state)) return *error;
+    ScopedBodyChecksums scope(std::move(state));
+    return h(std::move(request));
+  };
+}
+
+StreamingHandler MakeBodyChecksumStreamingHandler(StreamingHandler handler,
+                                                  BodyChecksumOptions options) {
+  return [h = std::move(handler), options](
+             BeastRequest request, functions::HttpRequestBodyReader& reader) {
+    auto state = std::make_shared<BodyChecksumState>();
+    ChecksummingReader checksumming(reader, options,
+                                    GetExpectedBodyChecksums(request), *state);
+    ScopedBodyChecksums scope(std::move(state));
+    return h(std::move(request), checksumming);
+  };
+}
+
+WriterHandler MakeBodyChecksumWriterHandler(WriterHandler handler,
+                                            BodyChecksumOptions options) {
+  return [h = std::move(handler), options](BeastRequest request,
+                                           ResponseWriter& writer) {
+    auto state = std::make_shared<BodyChecksumState>();
+    if (auto error = CheckBody(request, options, *state)) {
+      writer.WriteHeader(*std::move(error));
+      return true;
+    }
+    ScopedBodyChecksums scope(std::move(state));
+    return h(std::move(request), writer);
+  };
+}
+
+AsyncHandler MakeBodyChecksumAsyncHandler(AsyncHandler handler,
+                                          BodyChecksumOptions options) {
+  return [h = std::move(handler), options](BeastRequest request,
+                                           AsyncResponseCallback done) {
+    auto state = std::make_shared<BodyChecksumState>();
+    if (auto error = CheckBody(request, options, *state)) {
+      return done(*std::move(error));
+    }
+    ScopedBodyChecksums scope(std::move(state));
+    h(std::move(request), std::move(done));
+  };
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,111 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_BODY_CHECKSUMS_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_BODY_CHECKSUMS_H
+
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/internal/md5.h"
+#include "google/cloud/functions/body_checksums.h"
+#include "google/cloud/functions/version.h"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// The checksums computed for each request body.
+struct BodyChecksumOptions {
+  bool crc32c = false;
+  bool md5 = false;
+};
+
+/**
+ * Parses the `--request-checksums` value @p value, e.g. `crc32c,md5`.
+ *
+ * @throws std::invalid_argument if @p value names an unknown algorithm.
+ */
+BodyChecksumOptions ParseBodyChecksumOptions(std::string_view value);
+
+/// Computes the checksums of a body received in chunks.
+class BodyChecksummer {
+ public:
+  explicit BodyChecksummer(BodyChecksumOptions options);
+
+  void Update(std::string_view data);
+  functions::BodyChecksums Finish();
+
+ private:
+  std::optional<std::uint32_t> crc32c_;
+  std::optional<Md5> md5_;
+};
+
+/**
+ * Returns the checksums sent by the client, from the `x-goog-hash` and
+ * `Content-MD5` headers of @p request.
+ *
+ * Returns an empty optional if any of these values is invalid.
+ */
+std::optional<functions::BodyChecksums> GetExpectedBodyChecksums(
+    BeastRequest const& request);
+
+/// Returns `false` if a checksum in both @p expected and @p actual differs.
+bool BodyChecksumsMatch(functions::BodyChecksums const& expected,
+                        functions::BodyChecksums const& actual);
+
+/// The checksums of a request body, shared with its `functions::HttpRequest`.
+struct BodyChecksumState {
+  /// Set once the whole body is received.
+  std::optional<functions::BodyChecksums> checksums;
+};
+
+/// The checksums of the request running in the current thread, if any.
+std::shared_ptr<BodyChecksumState> CurrentBodyChecksums();
+
+/// Sets the checksums of the current thread, @p state may be null.
+class ScopedBodyChecksums {
+ public:
+  explicit ScopedBodyChecksums(std::shared_ptr<BodyChecksumState> state);
+  ~ScopedBodyChecksums();
+
+  ScopedBodyChecksums(ScopedBodyChecksums const&) = delete;
+  ScopedBodyChecksums& operator=(ScopedBodyChecksums const&) = delete;
+
+ private:
+  std::shared_ptr<BodyChecksumState> previous_;
+};
+
+/**
+ * Returns handlers that compute the checksums of the request bodies.
+ *
+ * The buffered bodies are checked before calling @p handler, a mismatch with
+ * the checksums sent by the client gets `400 Bad Request`. The streamed bodies
+ * are checked as the handler reads them, the body reader throws at the end of
+ * a body that does not match.
+ */
+Handler MakeBodyChecksumHandler(Handler handler, BodyChecksumOptions options);
+StreamingHandler MakeBodyChecksumStreamingHandler(StreamingHandler handler,
+                                                  BodyChecksumOptions options);
+WriterHandler MakeBodyChecksumWriterHandler(WriterHandler handler,
+                                            BodyChecksumOptions options);
+AsyncHandler MakeBodyChecksumAsyncHandler(AsyncHandler handler,
+                                          BodyChecksumOptions options);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_BODY_CHECKSUMS_H
@@ -0,0 +1,172 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/body_checksums.h"
+#include "google/cloud/functions/internal/wrap_request.h"
+#include <boost/beast/http.hpp>
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace be = ::boost::beast;
+
+// The CRC32C and MD5 of "123456789", see `body_checksums_test.cc`.
+auto constexpr kCrc32c = "crc32c=4waSgw==";
+auto constexpr kMd5 = "JfnnlDI7RTiF9RgfG2JNCw==";
+
+BeastRequest PostRequest(std::string body) {
+  BeastRequest request;
+  request.method(be::http::verb::post);
+  request.target("/");
+  request.body() = std::move(body);
+  request.prepare_payload();
+  return request;
+}
+
+class TestReader : public functions::HttpRequestBodyReader {
+ public:
+  explicit TestReader(std::string body) : body_(std::move(body)) {}
+
+  std::size_t Read(char* data, std::size_t size) override {
+    auto const n = std::min({size, body_.size() - offset_, std::size_t{4}});
+    std::copy_n(body_.data() + offset_, n, data);
+    offset_ += n;
+    return n;
+  }
+
+ private:
+  std::string body_;
+  std::size_t offset_ = 0;
+};
+
+TEST(BodyChecksumsTest, ParseOptions) {
+  auto options = ParseBodyChecksumOptions("");
+  EXPECT_FALSE(options.crc32c);
+  EXPECT_FALSE(options.md5);
+  options = ParseBodyChecksumOptions("crc32c");
+  EXPECT_TRUE(options.crc32c);
+  EXPECT_FALSE(options.md5);
+  options = ParseBodyChecksumOptions("md5, crc32c");
+  EXPECT_TRUE(options.crc32c);
+  EXPECT_TRUE(options.md5);
+  EXPECT_THROW(ParseBodyChecksumOptions("crc32c,sha256"),
+               std::invalid_argument);
+}
+
+TEST(BodyChecksumsTest, Checksummer) {
+  BodyChecksummer checksummer(BodyChecksumOptions{true, true});
+  checksummer.Update("1234");
+  checksummer.Update("56789");
+  auto const checksums = checksummer.Finish();
+  EXPECT_EQ(checksums.crc32c, 0xe3069283);
+  EXPECT_EQ(functions::ToGoogHash(checksums),
+            std::string(kCrc32c) + ",md5=" + kMd5);
+
+  BodyChecksummer crc32c_only(BodyChecksumOptions{true, false});
+  crc32c_only.Update("123456789");
+  EXPECT_FALSE(crc32c_only.Finish().md5.has_value());
+}
+
+TEST(BodyChecksumsTest, GetExpected) {
+  auto request = PostRequest("123456789");
+  auto expected = GetExpectedBodyChecksums(request);
+  ASSERT_TRUE(expected.has_value());
+  EXPECT_FALSE(expected->crc32c.has_value());
+  EXPECT_FALSE(expected->md5.has_value());
+
+  request.set("x-goog-hash", std::string(kCrc32c) + ", md5=" + kMd5);
+  expected = GetExpectedBodyChecksums(request);
+  ASSERT_TRUE(expected.has_value());
+  EXPECT_EQ(expected->crc32c, 0xe3069283);
+  EXPECT_TRUE(expected->md5.has_value());
+
+  request.erase("x-goog-hash");
+  request.set(be::http::field::content_md5, kMd5);
+  expected = GetExpectedBodyChecksums(request);
+  ASSERT_TRUE(expected.has_value());
+  EXPECT_TRUE(expected->md5.has_value());
+
+  request.set(be::http::field::content_md5, "not base64!");
+  EXPECT_FALSE(GetExpectedBodyChecksums(request).has_value());
+  request.erase(be::http::field::content_md5);
+  request.set("x-goog-hash", "crc32c=AAAA");
+  EXPECT_FALSE(GetExpectedBodyChecksums(request).has_value());
+}
+
+TEST(BodyChecksumsTest, Handler) {
+  auto handler = MakeBodyChecksumHandler(
+      [](BeastRequest request) {
+        auto const wrapped = MakeHttpRequest(std::move(request));
+        BeastResponse response;
+        auto const checksums = wrapped.body_checksums();
+        response.body() =
+            checksums ? functions::ToGoogHash(*checksums) : "none";
+        return response;
+      },
+      BodyChecksumOptions{true, false});
+  auto response = handler(PostRequest("123456789"));
+  EXPECT_EQ(response.result(), be::http::status::ok);
+  EXPECT_EQ(response.body(), kCrc32c);
+
+  auto request = PostRequest("123456789");
+  request.set("x-goog-hash", kCrc32c);
+  response = handler(request);
+  EXPECT_EQ(response.result(), be::http::status::ok);
+
+  // Only the computed checksums are checked.
+  request.set("x-goog-hash",
+              std::string(kCrc32c) + ",md5=AAAAAAAAAAAAAAAAAAAAAA==");
+  response = handler(request);
+  EXPECT_EQ(response.result(), be::http::status::ok);
+
+  request = PostRequest("123456780");
+  request.set("x-goog-hash", kCrc32c);
+  response = handler(request);
+  EXPECT_EQ(response.result(), be::http::status::bad_request);
+}
+
+TEST(BodyChecksumsTest, StreamingHandler) {
+  std::optional<functions::BodyChecksums> before;
+  std::optional<functions::BodyChecksums> after;
+  auto handler = MakeBodyChecksumStreamingHandler(
+      [&](BeastRequest request, functions::HttpRequestBodyReader& reader) {
+        auto const wrapped = MakeHttpRequest(std::move(request));
+        before = wrapped.body_checksums();
+        std::array<char, 16> buffer;
+        while (reader.Read(buffer.data(), buffer.size()) != 0) continue;
+        after = wrapped.body_checksums();
+        return BeastResponse{};
+      },
+      BodyChecksumOptions{false, true});
+  auto request = PostRequest({});
+  request.set(be::http::field::content_md5, kMd5);
+  TestReader reader("123456789");
+  (void)handler(request, reader);
+  EXPECT_FALSE(before.has_value());
+  ASSERT_TRUE(after.has_value());
+  EXPECT_EQ(functions::ToGoogHash(*after), std::string("md5=") + kMd5);
+
+  TestReader mismatch("12345678");
+  EXPECT_THROW((void)handler(request, mismatch), std::runtime_error);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,47 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/body_memory_budget.h"
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+BodyReservation::~BodyReservation() {
+  if (budget_ != nullptr && size_ != 0) budget_->Release(size_);
+}
+
+BodyReservation& BodyReservation::operator=(BodyReservation&& rhs) noexcept {
+  BodyReservation tmp(std::move(rhs));
+  std::swap(budget_, tmp.budget_);
+  std::swap(size_, tmp.size_);
+  return *this;
+}
+
+bool BodyReservation::GrowTo(std::uint64_t size) {
+  if (size <= size_) return true;
+  if (budget_ == nullptr || !budget_->Reserve(size - size_)) return false;
+  size_ = size;
+  return true;
+}
+
+bool BodyMemoryBudget::Reserve(std::uint64_t size) {
+  auto used = used_.load();
+  do {
+    if (size > limit_ - used) return false;
+  } while (!used_.compare_exchange_weak(used, used + size));
+  return true;
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
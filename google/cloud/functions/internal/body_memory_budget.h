@@ -0,0 +1,90 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_BODY_MEMORY_BUDGET_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_BODY_MEMORY_BUDGET_H
+
+#include "google/cloud/functions/version.h"
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+class BodyMemoryBudget;
+
+/// Memory reserved from a `BodyMemoryBudget`, released on destruction.
+class BodyReservation {
+ public:
+  BodyReservation() = default;
+  ~BodyReservation();
+
+  BodyReservation(BodyReservation&& rhs) noexcept
+      : budget_(std::exchange(rhs.budget_, nullptr)),
+        size_(std::exchange(rhs.size_, 0)) {}
+  BodyReservation& operator=(BodyReservation&& rhs) noexcept;
+
+  BodyReservation(BodyReservation const&) = delete;
+  BodyReservation& operator=(BodyReservation const&) = delete;
+
+  [[nodiscard]] std::uint64_t size() const { return size_; }
+
+  /**
+   * Grows the reservation to at least @p size bytes.
+   *
+   * Returns `false`, and keeps the current reservation, if the budget does not
+   * have enough memory left.
+   */
+  bool GrowTo(std::uint64_t size);
+
+ private:
+  friend class BodyMemoryBudget;
+  explicit BodyReservation(BodyMemoryBudget* budget) : budget_(budget) {}
+
+  BodyMemoryBudget* budget_ = nullptr;
+  std::uint64_t size_ = 0;
+};
+
+/**
+ * Limits the memory used by the buffered request bodies of all the sessions.
+ *
+ * Several large uploads arriving together could exceed the memory of the
+ * instance, even if each one is below `--max-body-size`. Sessions reserve
+ * the size of each body before reading it, or as it grows if the size is not
+ * known in advance, and release it once the response is ready.
+ */
+class BodyMemoryBudget {
+ public:
+  explicit BodyMemoryBudget(std::uint64_t limit) : limit_(limit) {}
+
+  /// Returns an empty reservation, bound to this budget.
+  BodyReservation MakeReservation() { return BodyReservation(this); }
+
+  [[nodiscard]] std::uint64_t limit() const { return limit_; }
+  [[nodiscard]] std::uint64_t used() const { return used_.load(); }
+
+ private:
+  friend class BodyReservation;
+  bool Reserve(std::uint64_t size);
+  void Release(std::uint64_t size) { used_.fetch_sub(size); }
+
+  std::uint64_t const limit_;
+  std::atomic<std::uint64_t> used_{0};
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_BODY_MEMORY_BUDGET_H
@@ -0,0 +1,67 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/body_memory_budget.h"
+#include <gmock/gmock.h>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+TEST(BodyMemoryBudgetTest, ReserveAndRelease) {
+  BodyMemoryBudget budget(100);
+  {
+    auto a = budget.MakeReservation();
+    EXPECT_TRUE(a.GrowTo(60));
+    EXPECT_EQ(a.size(), 60);
+    EXPECT_EQ(budget.used(), 60);
+
+    // Reservations are all or nothing.
+    auto b = budget.MakeReservation();
+    EXPECT_FALSE(b.GrowTo(50));
+    EXPECT_EQ(b.size(), 0);
+    EXPECT_TRUE(b.GrowTo(40));
+    EXPECT_EQ(budget.used(), 100);
+
+    // Growing only reserves the difference.
+    EXPECT_TRUE(b.GrowTo(30));
+    EXPECT_FALSE(b.GrowTo(41));
+    EXPECT_EQ(b.size(), 40);
+  }
+  EXPECT_EQ(budget.used(), 0);
+}
+
+TEST(BodyMemoryBudgetTest, Move) {
+  BodyMemoryBudget budget(100);
+  auto a = budget.MakeReservation();
+  ASSERT_TRUE(a.GrowTo(30));
+  auto b = std::move(a);
+  EXPECT_EQ(b.size(), 30);
+  EXPECT_EQ(budget.used(), 30);
+
+  auto c = budget.MakeReservation();
+  ASSERT_TRUE(c.GrowTo(20));
+  c = std::move(b);
+  EXPECT_EQ(c.size(), 30);
+  EXPECT_EQ(budget.used(), 30);
+
+  c = BodyReservation();
+  EXPECT_EQ(budget.used(), 0);
+  EXPECT_FALSE(c.GrowTo(1));
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,289 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/byte_ranges.h"
+#include "google/cloud/functions/internal/checkpoint.h"
+#include <algorithm>
+#include <charconv>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace http = ::boost::beast::http;
+
+std::string_view View(boost::beast::string_view v) {
+  return {v.data(), v.size()};
+}
+
+std::string_view Trim(std::string_view s) {
+  auto const b = s.find_first_not_of(" \t");
+  if (b == std::string_view::npos) return {};
+  auto const e = s.find_last_not_of(" \t");
+  return s.substr(b, e - b + 1);
+}
+
+std::optional<std::uint64_t> ParseDigits(std::string_view s) {
+  std::uint64_t value = 0;
+  auto const* end = s.data() + s.size();
+  auto const r = std::from_chars(s.data(), end, value);
+  if (s.empty() || r.ec != std::errc() || r.ptr != end) return std::nullopt;
+  return value;
+}
+
+/**
+ * Parses one range in a `Range` header.
+ *
+ * Returns an empty optional if the range is invalid, and a range with a size
+ * of 0 if it is not satisfiable.
+ */
+std::optional<ByteRange> ParseRangeSpec(std::string_view spec,
+                                        std::uint64_t size) {
+  auto const dash = spec.find('-');
+  if (dash == std::string_view::npos) return std::nullopt;
+  auto const first = spec.substr(0, dash);
+  auto const last = spec.substr(dash + 1);
+  if (first.empty()) {
+    // A suffix range, e.g. `bytes=-500` for the last 500 bytes.
+    auto const n = ParseDigits(last);
+    if (!n) return std::nullopt;
+    if (*n == 0 || size == 0) return ByteRange{};
+    auto const length = std::min(*n, size);
+    return ByteRange{size - length, length};
+  }
+  auto const begin = ParseDigits(first);
+  if (!begin) return std::nullopt;
+  auto end = size;
+  if (!last.empty()) {
+    auto const l = ParseDigits(last);
+    if (!l || *l < *begin) return std::nullopt;
+    // Avoid `*l + 1`, it overflows for the largest positions.
+    end = *l >= size ? size : *l + 1;
+  }
+  if (*begin >= size) return ByteRange{};
+  return ByteRange{*begin, end - *begin};
+}
+
+/// Returns the bytes in @p range of a file or string payload.
+std::string ReadRange(ResponseBody::value_type const& body, ByteRange range) {
+  auto const* segment = body.file();
+  if (segment == nullptr) return body.str().substr(range.offset, range.size);
+  std::string data(range.size, '\0');
+  boost::beast::error_code ec;
+  segment->file->seek(segment->offset + range.offset, ec);
+  std::size_t offset = 0;
+  while (!ec && offset != data.size()) {
+    auto const n =
+        segment->file->read(data.data() + offset, data.size() - offset, ec);
+    // The file was truncated after it was opened.
+    if (n == 0) break;
+    offset += n;
+  }
+  if (ec || offset != data.size()) {
+    throw std::runtime_error("cannot read the range of a file payload");
+  }
+  return data;
+}
+
+}  // namespace
+
+std::optional<std::vector<ByteRange>> ParseByteRanges(std::string_view value,
+                                                      std::uint64_t size) {
+  auto constexpr kPrefix = std::string_view("bytes=");
+  if (value.substr(0, kPrefix.size()) != kPrefix) return std::nullopt;
+  std::vector<ByteRange> ranges;
+  auto specs = value.substr(kPrefix.size());
+  int count = 0;
+  while (!specs.empty()) {
+    auto const comma = specs.find(',');
+    auto const spec = Trim(specs.substr(0, comma));
+    specs = comma == std::string_view::npos ? std::string_view{}
+                                            : specs.substr(comma + 1);
+    // The list may contain empty elements, see RFC 9110 section 5.6.1.
+    if (spec.empty()) continue;
+    if (++count > kMaxByteRanges) return std::nullopt;
+    auto range = ParseRangeSpec(spec, size);
+    if (!range) return std::nullopt;
+    if (range->size != 0) ranges.push_back(*range);
+  }
+  // A header without any range is invalid, and ignored.
+  if (count == 0) return std::nullopt;
+  std::sort(ranges.begin(), ranges.end(), [](auto const& a, auto const& b) {
+    return a.offset < b.offset;
+  });
+  std::vector<ByteRange> merged;
+  for (auto const& r : ranges) {
+    if (!merged.empty() &&
+        r.offset <= merged.back().offset + merged.back().size) {
+      auto& m = merged.back();
+      m.size = std::max(m.offset + m.size, r.offset + r.size) - m.offset;
+      continue;
+    }
+    merged.push_back(r);
+  }
+  return merged;
+}
+
+std::string ContentRange(ByteRange range, std::uint64_t size) {
+  return "bytes " + std::to_string(range.offset) + "-" +
+         std::to_string(range.offset + range.size - 1) + "/" +
+         std::to_string(size);
+}
+
+bool IfRangeMatches(std::string_view if_range, std::string_view etag,
+                    std::string_view last_modified) {
+  if_range = Trim(if_range);
+  if (if_range.empty() || if_range.rfind("W/", 0) == 0) return false;
+  // A weak `etag` starts with `W/`, it never matches a quoted value.
+  if (if_range.front() == '"') return if_range == etag;
+  return !last_modified.empty() && if_range == last_modified;
+}
+
+std::string MakeByteRangesBoundary() {
+  auto constexpr kDigits = std::string_view("0123456789abcdef");
+  auto constexpr kLength = 32;
+  auto& generator = ThreadRandomGenerator();
+  std::uniform_int_distribution<std::size_t> digit(0, kDigits.size() - 1);
+  std::string boundary;
+  boundary.reserve(kLength);
+  for (int i = 0; i != kLength; ++i) {
+    boundary.push_back(kDigits[digit(generator)]);
+  }
+  return boundary;
+}
+
+std::string MakeMultipartByteRanges(std::string_view boundary,
+                                    std::string_view content_type,
+                                    std::vector<ByteRange> const& ranges,
+                                    std::uint64_t size,
+                                    ByteRangeReader const& read) {
+  std::string body;
+  for (auto const& r : ranges) {
+    body += "--";
+    body += boundary;
+    body += "\r\n";
+    if (!content_type.empty()) {
+      body += "Content-Type: ";
+      body += content_type;
+      body += "\r\n";
+    }
+    body += "Content-Range: " + ContentRange(r, size) + "\r\n\r\n";
+    body += read(r);
+    body += "\r\n";
+  }
+  body += "--";
+  body += boundary;
+  body += "--\r\n";
+  return body;
+}
+
+ByteRangeRequest GetByteRangeRequest(BeastRequest const& request) {
+  if (request.method() != http::verb::get) return {};
+  return ByteRangeRequest{std::string(View(request[http::field::range])),
+                          std::string(View(request[http::field::if_range]))};
+}
+
+void ServeByteRanges(std::string_view range, BeastResponse& response) {
+  auto& body = response.body();
+  auto const size = body.size();
+  auto ranges = ParseByteRanges(range, size);
+  if (!ranges) return;
+  if (ranges->empty()) {
+    response.result(http::status::range_not_satisfiable);
+    response.set(http::field::content_range, "bytes */" + std::to_string(size));
+    body.clear();
+    return;
+  }
+  if (ranges->size() == 1) {
+    auto const r = ranges->front();
+    response.result(http::status::partial_content);
+    response.set(http::field::content_range, ContentRange(r, size));
+    if (auto const* segment = body.file()) {
+      body.set_file(
+          FileSegment{segment->file, segment->offset + r.offset, r.size});
+      return;
+    }
+    body = body.str().substr(r.offset, r.size);
+    return;
+  }
+  std::uint64_t total = 0;
+  for (auto const& r : *ranges) total += r.size;
+  if (total > kMaxMultipartByteRangesSize) return;
+  auto const boundary = MakeByteRangesBoundary();
+  std::string parts;
+  try {
+    parts = MakeMultipartByteRanges(
+        boundary, View(response[http::field::content_type]), *ranges, size,
+        [&body](ByteRange r) { return ReadRange(body, r); });
+  } catch (std::exception const&) {
+    // The full response reports any problems reading the file.
+    return;
+  }
+  response.result(http::status::partial_content);
+  response.set(http::field::content_type,
+               "multipart/byteranges; boundary=" + boundary);
+  body = std::move(parts);
+}
+
+void ApplyByteRanges(ByteRangeRequest const& request, BeastResponse& response) {
+  if (response.result() != http::status::ok) return;
+  if (response.find(http::field::content_encoding) != response.end()) return;
+  auto const& body = response.body();
+  if (body.file() == nullptr && body.shared() == nullptr) return;
+  response.set(http::field::accept_ranges, "bytes");
+  if (request.range.empty()) return;
+  if (!request.if_range.empty() &&
+      !IfRangeMatches(request.if_range, View(response[http::field::etag]),
+                      View(response[http::field::last_modified]))) {
+    return;
+  }
+  ServeByteRanges(request.range, response);
+}
+
+Handler MakeByteRangeHandler(Handler handler) {
+  return [h = std::move(handler)](BeastRequest request) {
+    auto const ranges = GetByteRangeRequest(request);
+    auto response = h(std::move(request));
+    ApplyByteRanges(ranges, response);
+    return response;
+  };
+}
+
+StreamingHandler MakeByteRangeStreamingHandler(StreamingHandler handler) {
+  return [h = std::move(handler)](BeastRequest request,
+                                  functions::HttpRequestBodyReader& reader) {
+    auto const ranges = GetByteRangeRequest(request);
+    auto response = h(std::move(request), reader);
+    ApplyByteRanges(ranges, response);
+    return response;
+  };
+}
+
+AsyncHandler MakeByteRangeAsyncHandler(AsyncHandler handler) {
+  return [h = std::move(handler)](BeastRequest request,
+                                  AsyncResponseCallback done) {
+    auto ranges = GetByteRangeRequest(request);
+    h(std::move(request), [ranges = std::move(ranges),
+                           done = std::move(done)](BeastResponse response) {
+      ApplyByteRanges(ranges, response);
+      done(std::move(response));
+    });
+  };
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
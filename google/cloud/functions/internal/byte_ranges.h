@@ -0,0 +1,121 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_BYTE_RANGES_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_BYTE_RANGES_H
+
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/version.h"
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// A range of bytes requested with a `Range` header.
+struct ByteRange {
+  std::uint64_t offset = 0;
+  std::uint64_t size = 0;
+};
+
+/// Requests with more ranges than this get the full response.
+auto constexpr kMaxByteRanges = 16;
+
+/// Multiple ranges are buffered, larger `multipart/byteranges` are not sent.
+auto constexpr kMaxMultipartByteRangesSize = 16 * 1024 * 1024;
+
+/**
+ * Parses the `Range` header value @p value, for a representation of @p size
+ * bytes.
+ *
+ * Returns an empty optional if the header should be ignored, e.g. if it is
+ * invalid or requests too many ranges. Returns an empty vector if no range is
+ * satisfiable. The ranges are sorted, and overlapping or adjacent ranges are
+ * merged.
+ */
+std::optional<std::vector<ByteRange>> ParseByteRanges(std::string_view value,
+                                                      std::uint64_t size);
+
+/// Returns the `Content-Range` value for @p range.
+std::string ContentRange(ByteRange range, std::uint64_t size);
+
+/**
+ * Returns `true` if the `If-Range` value @p if_range matches the validators
+ * of the response.
+ *
+ * Entity tags use the strong comparison, so weak tags never match. Dates must
+ * match the `Last-Modified` value exactly.
+ */
+bool IfRangeMatches(std::string_view if_range, std::string_view etag,
+                    std::string_view last_modified);
+
+/// Returns a random boundary for a `multipart/byteranges` body.
+std::string MakeByteRangesBoundary();
+
+/// Returns the bytes in @p range.
+using ByteRangeReader = std::function<std::string(ByteRange range)>;
+
+/**
+ * Returns a `multipart/byteranges` body with a part for each range in
+ * @p ranges, of a representation of @p size bytes.
+ */
+std::string MakeMultipartByteRanges(std::string_view boundary,
+                                    std::string_view content_type,
+                                    std::vector<ByteRange> const& ranges,
+                                    std::uint64_t size,
+                                    ByteRangeReader const& read);
+
+/**
+ * Replaces the payload of @p response with the ranges in @p range.
+ *
+ * @p range is the value of a `Range` header, the response is not changed if
+ * it should be ignored. A single range of a file payload refers to the same
+ * file, other ranges are copied, multiple ranges into a `multipart/byteranges`
+ * body.
+ */
+void ServeByteRanges(std::string_view range, BeastResponse& response);
+
+/// The `Range` headers of a request, saved before the request is handled.
+struct ByteRangeRequest {
+  /// Empty unless the request is a `GET` with a `Range` header.
+  std::string range;
+  std::string if_range;
+};
+
+ByteRangeRequest GetByteRangeRequest(BeastRequest const& request);
+
+/**
+ * Answers the `Range` header of @p request with the ranges of @p response.
+ *
+ * Only `200 OK` responses without a `Content-Encoding`, and with a file or
+ * shared payload, are eligible. They get an `Accept-Ranges` header, and serve
+ * the ranges if the `If-Range` header, if any, matches their validators.
+ */
+void ApplyByteRanges(ByteRangeRequest const& request, BeastResponse& response);
+
+/// Returns handlers that answer `Range` requests with the responses of
+/// @p handler, streamed responses are not eligible.
+Handler MakeByteRangeHandler(Handler handler);
+StreamingHandler MakeByteRangeStreamingHandler(StreamingHandler handler);
+AsyncHandler MakeByteRangeAsyncHandler(AsyncHandler handler);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_BYTE_RANGES_H
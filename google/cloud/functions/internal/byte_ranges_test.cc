@@ -0,0 +1,288 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/byte_ranges.h"
+#include <boost/beast/http.hpp>
+#include <gmock/gmock.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace http = ::boost::beast::http;
+using ::testing::HasSubstr;
+using ::testing::StartsWith;
+
+std::string Ranges(std::string_view value, std::uint64_t size = 100) {
+  auto ranges = ParseByteRanges(value, size);
+  if (!ranges) return "ignored";
+  std::string result;
+  for (auto const& r : *ranges) {
+    if (!result.empty()) result += ",";
+    result += std::to_string(r.offset) + "+" + std::to_string(r.size);
+  }
+  return result;
+}
+
+BeastRequest RangeRequest(std::string_view range,
+                          std::string_view if_range = {}) {
+  BeastRequest request;
+  request.method(http::verb::get);
+  request.target("/");
+  request.set(http::field::range, range);
+  if (!if_range.empty()) request.set(http::field::if_range, if_range);
+  return request;
+}
+
+BeastResponse SharedResponse(std::string body) {
+  BeastResponse response;
+  response.set(http::field::content_type, "text/plain");
+  response.body().set_shared(
+      std::make_shared<std::string const>(std::move(body)));
+  return response;
+}
+
+TEST(ByteRangesTest, ParseByteRanges) {
+  EXPECT_EQ(Ranges("bytes=0-9"), "0+10");
+  EXPECT_EQ(Ranges("bytes=90-"), "90+10");
+  EXPECT_EQ(Ranges("bytes=90-200"), "90+10");
+  EXPECT_EQ(Ranges("bytes=-30"), "70+30");
+  EXPECT_EQ(Ranges("bytes=-300"), "0+100");
+  EXPECT_EQ(Ranges("bytes=100-"), "");
+  EXPECT_EQ(Ranges("bytes=-0"), "");
+  EXPECT_EQ(Ranges("bytes=9-0"), "ignored");
+  EXPECT_EQ(Ranges("items=0-9"), "ignored");
+  EXPECT_EQ(Ranges("bytes=a-9"), "ignored");
+  EXPECT_EQ(Ranges("bytes=5"), "ignored");
+  EXPECT_EQ(Ranges("bytes=-5", 0), "");
+  // The largest positions do not overflow.
+  EXPECT_EQ(Ranges("bytes=5-18446744073709551615"), "5+95");
+  EXPECT_EQ(Ranges("bytes=0-18446744073709551615"), "0+100");
+  EXPECT_EQ(Ranges("bytes=18446744073709551615-18446744073709551615"), "");
+  EXPECT_EQ(Ranges("bytes=0-18446744073709551616"), "ignored");
+  // Headers without any range are ignored.
+  EXPECT_EQ(Ranges("bytes="), "ignored");
+  EXPECT_EQ(Ranges("bytes= , "), "ignored");
+}
+
+TEST(ByteRangesTest, ParseMultipleByteRanges) {
+  EXPECT_EQ(Ranges("bytes=0-1,5-6"), "0+2,5+2");
+  EXPECT_EQ(Ranges("bytes=50-59, 0-9"), "0+10,50+10");
+  // Overlapping and adjacent ranges are merged.
+  EXPECT_EQ(Ranges("bytes=0-9,5-14"), "0+15");
+  EXPECT_EQ(Ranges("bytes=0-9,10-19"), "0+20");
+  EXPECT_EQ(Ranges("bytes=-10,0-9"), "0+10,90+10");
+  // Unsatisfiable ranges are dropped, unless all of them are.
+  EXPECT_EQ(Ranges("bytes=0-9,200-"), "0+10");
+  EXPECT_EQ(Ranges("bytes=100-,200-"), "");
+  EXPECT_EQ(Ranges("bytes=0-9,x"), "ignored");
+  EXPECT_EQ(Ranges("bytes=0-1,,5-6,"), "0+2,5+2");
+  std::string many = "bytes=0-0";
+  for (int i = 1; i != kMaxByteRanges + 1; ++i) {
+    many += "," + std::to_string(2 * i) + "-" + std::to_string(2 * i);
+  }
+  EXPECT_EQ(Ranges(many), "ignored");
+}
+
+TEST(ByteRangesTest, IfRangeMatches) {
+  auto constexpr kDate = "Sun, 06 Nov 1994 08:49:37 GMT";
+  EXPECT_TRUE(IfRangeMatches(R"("v1")", R"("v1")", ""));
+  EXPECT_FALSE(IfRangeMatches(R"("v2")", R"("v1")", ""));
+  // Weak entity tags never match.
+  EXPECT_FALSE(IfRangeMatches(R"(W/"v1")", R"(W/"v1")", ""));
+  EXPECT_FALSE(IfRangeMatches(R"("v1")", R"(W/"v1")", ""));
+  EXPECT_TRUE(IfRangeMatches(kDate, R"(W/"v1")", kDate));
+  EXPECT_FALSE(IfRangeMatches(kDate, "", ""));
+  EXPECT_FALSE(IfRangeMatches("", R"("v1")", kDate));
+}
+
+TEST(ByteRangesTest, MakeMultipartByteRanges) {
+  auto const body = MakeMultipartByteRanges(
+      "XyZ", "text/plain", {{0, 2}, {5, 3}}, 10, [](ByteRange r) {
+        return std::string("0123456789").substr(r.offset, r.size);
+      });
+  EXPECT_EQ(body,
+            "--XyZ\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Range: bytes 0-1/10\r\n"
+            "\r\n"
+            "01\r\n"
+            "--XyZ\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Range: bytes 5-7/10\r\n"
+            "\r\n"
+            "567\r\n"
+            "--XyZ--\r\n");
+}
+
+TEST(ByteRangesTest, SingleRange) {
+  auto response = SharedResponse("0123456789");
+  ApplyByteRanges(GetByteRangeRequest(RangeRequest("bytes=2-4")), response);
+  EXPECT_EQ(response.result(), http::status::partial_content);
+  EXPECT_EQ(response[http::field::accept_ranges], "bytes");
+  EXPECT_EQ(response[http::field::content_range], "bytes 2-4/10");
+  EXPECT_EQ(response[http::field::content_type], "text/plain");
+  EXPECT_EQ(response.body(), "234");
+}
+
+TEST(ByteRangesTest, MultipleRanges) {
+  auto response = SharedResponse("0123456789");
+  ApplyByteRanges(GetByteRangeRequest(RangeRequest("bytes=0-1,-2")), response);
+  EXPECT_EQ(response.result(), http::status::partial_content);
+  auto const content_type = std::string(response[http::field::content_type]);
+  EXPECT_THAT(content_type, StartsWith("multipart/byteranges; boundary="));
+  auto const boundary = content_type.substr(content_type.find('=') + 1);
+  EXPECT_EQ(boundary.size(), 32U);
+  EXPECT_EQ(response.body(),
+            MakeMultipartByteRanges(boundary, "text/plain", {{0, 2}, {8, 2}},
+                                    10, [](ByteRange r) {
+                                      return std::string("0123456789")
+                                          .substr(r.offset, r.size);
+                                    }));
+}
+
+TEST(ByteRangesTest, NotSatisfiable) {
+  auto response = SharedResponse("0123456789");
+  ApplyByteRanges(GetByteRangeRequest(RangeRequest("bytes=10-")), response);
+  EXPECT_EQ(response.result(), http::status::range_not_satisfiable);
+  EXPECT_EQ(response[http::field::content_range], "bytes */10");
+  EXPECT_TRUE(response.body().empty());
+}
+
+TEST(ByteRangesTest, LargestLastPosition) {
+  auto response = SharedResponse("0123456789");
+  ApplyByteRanges(
+      GetByteRangeRequest(RangeRequest("bytes=5-18446744073709551615")),
+      response);
+  EXPECT_EQ(response.result(), http::status::partial_content);
+  EXPECT_EQ(response[http::field::content_range], "bytes 5-9/10");
+  EXPECT_EQ(response.body(), "56789");
+
+  response = SharedResponse("0123456789");
+  ApplyByteRanges(
+      GetByteRangeRequest(RangeRequest("bytes=0-18446744073709551615")),
+      response);
+  EXPECT_EQ(response.result(), http::status::partial_content);
+  EXPECT_EQ(response[http::field::content_range], "bytes 0-9/10");
+  EXPECT_EQ(response.body(), "0123456789");
+}
+
+TEST(ByteRangesTest, EmptyRangeSet) {
+  auto response = SharedResponse("0123456789");
+  ApplyByteRanges(GetByteRangeRequest(RangeRequest("bytes=")), response);
+  EXPECT_EQ(response.result(), http::status::ok);
+  EXPECT_EQ(response.body(), "0123456789");
+}
+
+TEST(ByteRangesTest, IneligibleResponses) {
+  auto const request = GetByteRangeRequest(RangeRequest("bytes=2-4"));
+
+  // Plain string payloads are usually generated for each request.
+  BeastResponse response;
+  response.body() = std::string("0123456789");
+  ApplyByteRanges(request, response);
+  EXPECT_EQ(response.result(), http::status::ok);
+  EXPECT_EQ(response.find(http::field::accept_ranges), response.end());
+
+  response = SharedResponse("0123456789");
+  response.set(http::field::content_encoding, "gzip");
+  ApplyByteRanges(request, response);
+  EXPECT_EQ(response.result(), http::status::ok);
+
+  response = SharedResponse("0123456789");
+  response.result(http::status::not_found);
+  ApplyByteRanges(request, response);
+  EXPECT_EQ(response.result(), http::status::not_found);
+
+  // Only `GET` requests get ranges.
+  auto head = RangeRequest("bytes=2-4");
+  head.method(http::verb::head);
+  response = SharedResponse("0123456789");
+  ApplyByteRanges(GetByteRangeRequest(head), response);
+  EXPECT_EQ(response.result(), http::status::ok);
+  EXPECT_EQ(response[http::field::accept_ranges], "bytes");
+}
+
+TEST(ByteRangesTest, IfRange) {
+  auto response = SharedResponse("0123456789");
+  response.set(http::field::etag, R"("v1")");
+  ApplyByteRanges(GetByteRangeRequest(RangeRequest("bytes=2-4", R"("v1")")),
+                  response);
+  EXPECT_EQ(response.result(), http::status::partial_content);
+
+  response = SharedResponse("0123456789");
+  response.set(http::field::etag, R"("v2")");
+  ApplyByteRanges(GetByteRangeRequest(RangeRequest("bytes=2-4", R"("v1")")),
+                  response);
+  EXPECT_EQ(response.result(), http::status::ok);
+  EXPECT_EQ(response.body(), "0123456789");
+}
+
+TEST(ByteRangesTest, File) {
+  auto const path = (std::filesystem::temp_directory_path() /
+                     ("byte_ranges_test_" + std::to_string(std::rand())))
+                        .string();
+  std::ofstream(path, std::ios::binary) << "0123456789";
+  BeastResponse response;
+  response.body().set_file(OpenFileSegment(path, 1, 8));
+  ApplyByteRanges(GetByteRangeRequest(RangeRequest("bytes=2-4")), response);
+  EXPECT_EQ(response.result(), http::status::partial_content);
+  EXPECT_EQ(response[http::field::content_range], "bytes 2-4/8");
+  // A single range refers to the same file.
+  ASSERT_NE(response.body().file(), nullptr);
+  EXPECT_EQ(response.body().file()->offset, 3U);
+  EXPECT_EQ(response.body().file()->size, 3U);
+
+  response = BeastResponse{};
+  response.body().set_file(OpenFileSegment(path, 1, 8));
+  ApplyByteRanges(GetByteRangeRequest(RangeRequest("bytes=0-0,7-")), response);
+  EXPECT_EQ(response.result(), http::status::partial_content);
+  EXPECT_EQ(response.body().file(), nullptr);
+  EXPECT_THAT(response.body().str(),
+              HasSubstr("Content-Range: bytes 0-0/8\r\n\r\n1\r\n"));
+  EXPECT_THAT(response.body().str(),
+              HasSubstr("Content-Range: bytes 7-7/8\r\n\r\n8\r\n"));
+  std::remove(path.c_str());
+}
+
+TEST(ByteRangesTest, Handler) {
+  auto handler = MakeByteRangeHandler([](BeastRequest) {
+    auto response = SharedResponse("0123456789");
+    response.set(http::field::etag, R"("v1")");
+    return response;
+  });
+  auto response = handler(RangeRequest("bytes=-3", R"("v1")"));
+  EXPECT_EQ(response.result(), http::status::partial_content);
+  EXPECT_EQ(response.body(), "789");
+
+  std::optional<BeastResponse> async_response;
+  auto async = MakeByteRangeAsyncHandler(
+      [](BeastRequest, AsyncResponseCallback done) {
+        done(SharedResponse("0123456789"));
+      });
+  async(RangeRequest("bytes=0-0"),
+        [&](BeastResponse r) { async_response = std::move(r); });
+  ASSERT_TRUE(async_response.has_value());
+  EXPECT_EQ(async_response->result(), http::status::partial_content);
+  EXPECT_EQ(async_response->body(), "0");
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,70 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/cache_base.h"
+#include "google/cloud/functions/cache.h"
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+/// The registered caches, they may be globals destroyed after any other.
+struct Registry {
+  std::mutex mu;
+  std::vector<CacheBase*> caches;
+};
+
+Registry& GetRegistry() {
+  static auto* const kRegistry = new Registry;
+  return *kRegistry;
+}
+
+}  // namespace
+
+CacheBase::~CacheBase() { Unregister(); }
+
+void CacheBase::Register() {
+  if (name_.empty()) return;
+  auto& registry = GetRegistry();
+  std::lock_guard<std::mutex> lk(registry.mu);
+  registry.caches.push_back(this);
+  registered_ = true;
+}
+
+void CacheBase::Unregister() {
+  if (!registered_) return;
+  auto& registry = GetRegistry();
+  std::lock_guard<std::mutex> lk(registry.mu);
+  registry.caches.erase(
+      std::remove(registry.caches.begin(), registry.caches.end(), this),
+      registry.caches.end());
+  registered_ = false;
+}
+
+void ForEachCache(
+    std::function<void(std::string const&, functions::CacheStats const&)> const&
+        callback) {
+  auto& registry = GetRegistry();
+  // The lock keeps the caches from being destroyed while they are read.
+  std::lock_guard<std::mutex> lk(registry.mu);
+  for (auto const* cache : registry.caches) {
+    callback(cache->name_, cache->stats());
+  }
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,74 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CACHE_BASE_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CACHE_BASE_H
+
+#include "google/cloud/functions/version.h"
+#include <functional>
+#include <string>
+#include <utility>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+struct CacheStats;
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * The registration of a `functions::Cache<K, V>` in the server metrics.
+ *
+ * The caches with a name are listed by `ForEachCache()`. The derived class
+ * calls `Register()` once it is fully constructed, and `Unregister()` before
+ * it is destroyed, so the metrics never see a partially built cache.
+ */
+class CacheBase {
+ public:
+  CacheBase(CacheBase const&) = delete;
+  CacheBase& operator=(CacheBase const&) = delete;
+
+  /// The statistics of all the shards.
+  [[nodiscard]] virtual functions::CacheStats stats() const = 0;
+
+ protected:
+  explicit CacheBase(std::string name) : name_(std::move(name)) {}
+  ~CacheBase();
+
+  /// Adds this cache to the metrics, if it has a name.
+  void Register();
+
+  /// Removes this cache from the metrics, waiting for any scrape using it.
+  void Unregister();
+
+ private:
+  friend void ForEachCache(
+      std::function<void(std::string const&, functions::CacheStats const&)>
+          const& callback);
+
+  std::string name_;
+  bool registered_ = false;
+};
+
+/// Calls @p callback with the name and statistics of each registered cache.
+void ForEachCache(
+    std::function<void(std::string const&, functions::CacheStats const&)> const&
+        callback);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CACHE_BASE_H
@@ -0,0 +1,318 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/call_user_cloud_event.h"
+#include "google/cloud/functions/cloud_event_batch_error.h"
+#include "google/cloud/functions/internal/call_user_function.h"
+#include "google/cloud/functions/internal/json_writer.h"
+#include "google/cloud/functions/internal/log_throttle.h"
+#include "google/cloud/functions/internal/parse_cloud_event_http.h"
+#include "google/cloud/functions/internal/report_exception.h"
+#include "google/cloud/functions/internal/request_timing.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+namespace be = ::boost::beast;
+
+namespace {
+
+/// The maximum number of invalid Cloud Events logged each second.
+auto constexpr kInvalidCloudEventLogRate = 1;
+
+/**
+ * Rejects a request with invalid Cloud Events.
+ *
+ * This is a client error, the function never ran. Push subscriptions do not
+ * retry 400 responses, so the invalid messages are not redelivered. The log
+ * is rate limited, a flood of invalid requests must not saturate `stderr`.
+ */
+BeastResponse InvalidCloudEvent(ParseError const& error) {
+  static auto* const kThrottle = new LogThrottle(kInvalidCloudEventLogRate);
+  if (auto const suppressed = kThrottle->Acquire(LogThrottle::Clock::now())) {
+    auto const dropped = std::to_string(*suppressed);
+    LogField const fields[] = {{"suppressed", dropped}};
+    WriteLog(functions::LogSeverity::kWarning,
+             "invalid Cloud Event rejected: " + error.message, fields);
+  }
+  BeastResponse response;
+  response.result(be::http::status::bad_request);
+  response.insert(be::http::field::content_type, "text/plain");
+  response.body() = error.message;
+  return response;
+}
+
+/// An event of a batch that failed, or was skipped.
+struct ReportedEvent {
+  std::size_t index;
+  std::string_view id;
+  std::string message;
+  bool skipped = false;
+};
+
+/**
+ * Reports the events of a batch that did not complete successfully.
+ *
+ * The events not listed succeeded. The status is still a 500, senders unaware
+ * of this format retry the whole batch, while other senders may retry only
+ * the listed events, identified by their `index` in the batch and their `id`.
+ */
+BeastResponse PartialFailure(std::size_t count,
+                             std::vector<ReportedEvent> const& events) {
+  auto const skipped = std::count_if(events.begin(), events.end(),
+                                     [](auto const& e) { return e.skipped; });
+  auto message = std::to_string(events.size() - skipped) + " of " +
+                 std::to_string(count) + " events in the batch failed";
+  if (skipped != 0) message += ", " + std::to_string(skipped) + " skipped";
+  std::string details = "[";
+  for (auto const& e : events) {
+    if (details.size() != 1) details += ',';
+    details += R"({"index":)";
+    details += std::to_string(e.index);
+    details += R"(,"id":)";
+    JsonAppendString(details, e.id);
+    details += R"(,"message":)";
+    JsonAppendString(details, e.message);
+    details += '}';
+  }
+  details += ']';
+  LogField const fields[] = {{"errors", details}};
+  return ApplicationError(message, fields);
+}
+
+BeastResponse PartialFailure(std::size_t count,
+                             std::vector<BatchEventError> const& errors) {
+  std::vector<ReportedEvent> events;
+  events.reserve(errors.size());
+  for (auto const& e : errors) {
+    if (e.error) {
+      events.push_back({e.index, e.id, ExceptionMessage(e.error)});
+    } else {
+      events.push_back(
+          {e.index, e.id, "skipped after a previous failure", true});
+    }
+  }
+  return PartialFailure(count, events);
+}
+
+/// Completes a batch of asynchronous events once all of them complete.
+class AsyncBatch {
+ public:
+  AsyncBatch(std::size_t pending, std::shared_ptr<AsyncCompletion> completion)
+      : count_(pending),
+        pending_(pending),
+        completion_(std::move(completion)) {}
+
+  void Done(std::size_t index, std::string id, std::exception_ptr error) {
+    std::unique_lock<std::mutex> lk(mu_);
+    if (error) errors_.push_back({index, std::move(id), std::move(error)});
+    if (--pending_ != 0) return;
+    auto errors = std::move(errors_);
+    lk.unlock();
+    if (errors.empty()) return (*completion_)(BeastResponse{});
+    if (count_ == 1) return (*completion_)(ReportException(errors[0].error));
+    std::sort(errors.begin(), errors.end(), [](auto const& a, auto const& b) {
+      return a.index < b.index;
+    });
+    (*completion_)(PartialFailure(count_, errors));
+  }
+
+ private:
+  std::mutex mu_;
+  std::size_t const count_;
+  std::size_t pending_;
+  std::vector<BatchEventError> errors_;
+  std::shared_ptr<AsyncCompletion> completion_;
+};
+
+template <typename Function>
+BeastResponse CallCloudEvent(Function&& function, BeastRequest request) try {
+  if (request.target() == "/favicon.ico" || request.target() == "/robots.txt") {
+    BeastResponse response;
+    response.result(be::http::status::not_found);
+    return response;
+  }
+  // Move each event into the function, functions taking the event by value
+  // or by reference do not copy it, nor its data. Binary mode events take
+  // the request body as their data. The events in a batch run as they are
+  // parsed. The first failure stops the batch, the remaining events are
+  // still parsed, and reported as skipped.
+  std::size_t count = 0;
+  std::vector<BatchEventError> errors;
+  PhaseTimer decode(RequestPhase::kDecode);
+  auto parsed = TryParseCloudEventHttp(
+      std::move(request), [&](functions::CloudEvent ce) {
+        auto const index = count++;
+        if (!errors.empty()) {
+          errors.push_back({index, ce.id(), nullptr});
+          return;
+        }
+        SetRequestEventType(ce.type());
+        PhaseTimer timer(RequestPhase::kFunction);
+        auto id = ce.id();
+        try {
+          function(std::move(ce));
+        } catch (...) {
+          errors.push_back({index, std::move(id), std::current_exception()});
+        }
+      });
+  // Any events parsed before the error have run.
+  if (!parsed) return InvalidCloudEvent(parsed.error());
+  if (errors.empty()) return BeastResponse{};
+  if (count == 1) std::rethrow_exception(errors.front().error);
+  return PartialFailure(count, errors);
+} catch (std::exception const& ex) {
+  return ReportExceptionInFunction(ex);
+} catch (...) {
+  return ReportUnknownExceptionInFunction();
+}
+
+}  // namespace
+
+BeastResponse CallUserFunction(
+    functions::UserCloudEventFunction const& function, BeastRequest request) {
+  return CallCloudEvent(function, std::move(request));
+}
+
+BeastResponse CallUserFunction(
+    functions::UserCloudEventBatchFunction const& function,
+    BeastRequest request) try {
+  if (request.target() == "/favicon.ico" || request.target() == "/robots.txt") {
+    BeastResponse response;
+    response.result(be::http::status::not_found);
+    return response;
+  }
+  auto events = Timed(RequestPhase::kDecode, [&] {
+    return TryParseCloudEventHttp(std::move(request));
+  });
+  if (!events) return InvalidCloudEvent(events.error());
+  if (!events->empty()) SetRequestEventType(events->front().type());
+  auto const count = events->size();
+  // The ids are needed only if the function reports a partial failure, but
+  // the function consumes the events. A single event keeps the plain error.
+  std::vector<std::string> ids;
+  if (count != 1) {
+    ids.reserve(count);
+    for (auto const& e : *events) ids.push_back(e.id());
+  }
+  PhaseTimer timer(RequestPhase::kFunction);
+  try {
+    function(*std::move(events));
+  } catch (functions::CloudEventBatchError const& ex) {
+    std::vector<ReportedEvent> failed;
+    for (auto const& f : ex.failed()) {
+      if (f.index >= ids.size()) continue;
+      failed.push_back({f.index, ids[f.index], f.message});
+    }
+    if (failed.empty()) throw;
+    std::sort(failed.begin(), failed.end(),
+              [](auto const& a, auto const& b) { return a.index < b.index; });
+    failed.erase(std::unique(failed.begin(), failed.end(),
+                             [](auto const& a, auto const& b) {
+                               return a.index == b.index;
+                             }),
+                 failed.end());
+    return PartialFailure(count, failed);
+  }
+  return BeastResponse{};
+} catch (std::exception const& ex) {
+  return ReportExceptionInFunction(ex);
+} catch (...) {
+  return ReportUnknownExceptionInFunction();
+}
+
+BeastResponse CallUserFunction(ParallelBatchRunner& runner,
+                               BeastRequest request) try {
+  if (request.target() == "/favicon.ico" || request.target() == "/robots.txt") {
+    BeastResponse response;
+    response.result(be::http::status::not_found);
+    return response;
+  }
+  std::size_t count = 0;
+  std::optional<ParseError> invalid;
+  // The events run in other threads, while the request is parsed.
+  auto const errors = Timed(RequestPhase::kFunction, [&] {
+    return runner.Run([&](ParallelBatchRunner::EventSink const& sink) {
+      PhaseTimer decode(RequestPhase::kDecode);
+      auto parsed = TryParseCloudEventHttp(
+          std::move(request), [&](functions::CloudEvent ce) {
+            ++count;
+            SetRequestEventType(ce.type());
+            sink(std::move(ce));
+          });
+      if (!parsed) invalid = parsed.error();
+    });
+  });
+  // Any events parsed before the error have run.
+  if (invalid) return InvalidCloudEvent(*invalid);
+  if (errors.empty()) return BeastResponse{};
+  return PartialFailure(count, errors);
+} catch (std::exception const& ex) {
+  return ReportExceptionInFunction(ex);
+} catch (...) {
+  return ReportUnknownExceptionInFunction();
+}
+
+BeastResponse CallUserFunction(UserCloudEventCallable& function,
+                               BeastRequest request) {
+  return CallCloudEvent(
+      [&function](functions::CloudEvent ce) { function.Call(std::move(ce)); },
+      std::move(request));
+}
+
+void CallUserFunction(functions::UserCloudEventAsyncFunction const& function,
+                      BeastRequest request, AsyncResponseCallback done) {
+  if (request.target() == "/favicon.ico" || request.target() == "/robots.txt") {
+    BeastResponse response;
+    response.result(be::http::status::not_found);
+    return done(std::move(response));
+  }
+  auto completion = std::make_shared<AsyncCompletion>(std::move(done));
+  auto parsed = Timed(RequestPhase::kDecode, [&] {
+    return TryParseCloudEventHttp(std::move(request));
+  });
+  if (!parsed) return (*completion)(InvalidCloudEvent(parsed.error()));
+  auto events = *std::move(parsed);
+  if (events.empty()) return (*completion)(BeastResponse{});
+  SetRequestEventType(events.front().type());
+  auto batch = std::make_shared<AsyncBatch>(events.size(), completion);
+  for (std::size_t i = 0; i != events.size(); ++i) {
+    auto& ce = events[i];
+    // Each event completes once, even if the function fails after calling
+    // the callback.
+    auto called = std::make_shared<std::atomic<bool>>(false);
+    auto on_done = [batch, called, i, id = ce.id()](std::exception_ptr error) {
+      if (called->exchange(true)) return;
+      batch->Done(i, id, std::move(error));
+    };
+    try {
+      function(std::move(ce), on_done);
+    } catch (...) {
+      on_done(std::current_exception());
+    }
+  }
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
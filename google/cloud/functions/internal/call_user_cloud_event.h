@@ -0,0 +1,55 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CALL_USER_CLOUD_EVENT_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CALL_USER_CLOUD_EVENT_H
+
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/internal/parallel_batch.h"
+#include "google/cloud/functions/internal/typed_function.h"
+#include "google/cloud/functions/user_functions.h"
+#include "google/cloud/functions/version.h"
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+// These overloads are declared apart from `call_user_function.h`, only the
+// Cloud Event functions should depend on the parsers.
+
+/// Calls @p function for each event in @p request.
+BeastResponse CallUserFunction(
+    functions::UserCloudEventFunction const& function, BeastRequest request);
+
+/// Calls @p function once with all the events in @p request.
+BeastResponse CallUserFunction(
+    functions::UserCloudEventBatchFunction const& function,
+    BeastRequest request);
+
+/// Calls @p runner with the events in @p request, and reports all failures.
+BeastResponse CallUserFunction(ParallelBatchRunner& runner,
+                               BeastRequest request);
+
+/// Calls a function created by the `MakeFunction()` template.
+BeastResponse CallUserFunction(UserCloudEventCallable& function,
+                               BeastRequest request);
+
+/// Calls @p function for each event, and @p done once all complete.
+void CallUserFunction(functions::UserCloudEventAsyncFunction const& function,
+                      BeastRequest request, AsyncResponseCallback done);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CALL_USER_CLOUD_EVENT_H
@@ -13,64 +13,155 @@
 // limitations under the License.
 
 #include "google/cloud/functions/internal/call_user_function.h"
-#include "google/cloud/functions/internal/parse_cloud_event_http.h"
+#include "google/cloud/functions/internal/conditional.h"
+#include "google/cloud/functions/internal/report_exception.h"
+#include "google/cloud/functions/internal/request_timing.h"
 #include "google/cloud/functions/internal/wrap_request.h"
 #include "google/cloud/functions/internal/wrap_response.h"
-#include <nlohmann/json.hpp>
-#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <optional>
 #include <stdexcept>
+#include <string>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 
 namespace be = ::boost::beast;
 
-struct UnwrapResponse {
-  static BeastResponse unwrap(functions::HttpResponse response) {
-    auto impl = std::move(response).impl_;
-    auto& wrap = dynamic_cast<WrapResponseImpl&>(*impl);
-    return std::move(wrap).response_;
+namespace {
+/// Reads the body of a fully buffered request.
+class StringBodyReader : public functions::HttpRequestBodyReader {
+ public:
+  explicit StringBodyReader(std::string body) : body_(std::move(body)) {}
+
+  std::size_t Read(char* data, std::size_t size) override {
+    auto const n = std::min(size, body_.size() - offset_);
+    std::memcpy(data, body_.data() + offset_, n);
+    offset_ += n;
+    return n;
   }
+
+ private:
+  std::string body_;
+  std::size_t offset_ = 0;
 };
 
-namespace {
-BeastResponse ApplicationError(nlohmann::json const& error) {
-  auto msg = error.dump();
-  // Log the message to stderr. If the message is properly formatted, as it is
-  // done here, they are sent picked up and parsed by Cloud Logging:
-  //     https://cloud.google.com/functions/docs/monitoring/logging#writing_structured_logs
-  std::cerr << msg << std::endl;
-  BeastResponse response;
-  response.result(be::http::status::internal_server_error);
-  response.insert("content-type", "application/json");
-  response.body() = std::move(msg);
-  return response;
-}
+/// Collects a streaming response into a single message.
+class BufferedResponseWriter : public ResponseWriter {
+ public:
+  void WriteHeader(BeastResponse header) override {
+    response_ = std::move(header);
+  }
+  void Write(std::string_view data) override { response_.body() += data; }
 
-BeastResponse ReportExceptionInFunction(std::exception const& ex) {
-  return ApplicationError(
-      {{"severity", "error"},
-       {"message",
-        std::string("standard C++ exception thrown by the function: ") +
-            ex.what()}});
-}
+  BeastResponse&& response() && { return std::move(response_); }
+
+ private:
+  BeastResponse response_;
+};
 
-BeastResponse ReportUnknownExceptionInFunction() {
-  return ApplicationError({
-      {"severity", "error"},
-      {"message", std::string("unknown C++ exception thrown by the function")},
-  });
+/// Adapts the internal `ResponseWriter` to the public interface.
+class HttpResponseWriterAdapter : public functions::HttpResponseWriter {
+ public:
+  explicit HttpResponseWriterAdapter(ResponseWriter& impl) : impl_(impl) {}
+
+  void WriteHeader(functions::HttpResponse response) override {
+    if (header_sent_) return;
+    auto header = UnwrapResponse::unwrap(std::move(response));
+    if (header.body().file() != nullptr) {
+      throw std::invalid_argument(
+          "file payloads are not supported in streaming responses");
+    }
+    header_sent_ = true;
+    impl_.WriteHeader(std::move(header));
+  }
+  void Write(std::string_view data) override {
+    WriteHeader(functions::HttpResponse{});
+    impl_.Write(data);
+  }
+  void SetHeartbeat(std::string_view data,
+                    std::chrono::milliseconds interval) override {
+    WriteHeader(functions::HttpResponse{});
+    impl_.SetHeartbeat(data, interval);
+  }
+
+  [[nodiscard]] bool header_sent() const { return header_sent_; }
+
+ private:
+  ResponseWriter& impl_;
+  bool header_sent_ = false;
+};
+
+template <typename Function>
+BeastResponse CallHttp(Function&& function, BeastRequest request) try {
+  if (request.target() == "/favicon.ico" || request.target() == "/robots.txt") {
+    BeastResponse response;
+    response.result(be::http::status::not_found);
+    return response;
+  }
+  auto r = Timed(RequestPhase::kDecode,
+                 [&] { return MakeHttpRequest(std::move(request)); });
+  auto response =
+      Timed(RequestPhase::kFunction, [&] { return function(std::move(r)); });
+  PhaseTimer encode(RequestPhase::kEncode);
+  return UnwrapResponse::unwrap(std::move(response));
+} catch (std::exception const& ex) {
+  return ReportExceptionInFunction(ex);
+} catch (...) {
+  return ReportUnknownExceptionInFunction();
 }
+
 }  // namespace
 
 BeastResponse CallUserFunction(functions::UserHttpFunction const& function,
-                               BeastRequest request) try {
+                               BeastRequest request) {
+  return CallHttp(function, std::move(request));
+}
+
+BeastResponse CallUserRawFunction(Handler const& function,
+                                  BeastRequest request) try {
+  return Timed(RequestPhase::kFunction,
+               [&] { return function(std::move(request)); });
+} catch (std::exception const& ex) {
+  return ReportExceptionInFunction(ex);
+} catch (...) {
+  return ReportUnknownExceptionInFunction();
+}
+
+BeastResponse CallUserFunction(UserHttpCallable& function,
+                               BeastRequest request) {
+  return CallHttp(
+      [&function](functions::HttpRequest r) {
+        return function.Call(std::move(r));
+      },
+      std::move(request));
+}
+
+BeastResponse CallUserFunction(
+    functions::UserHttpStreamingFunction const& function,
+    BeastRequest request) {
+  StringBodyReader reader(std::move(request.body()));
+  request.body().clear();
+  return CallUserFunction(function, std::move(request), reader);
+}
+
+BeastResponse CallUserFunction(
+    functions::UserHttpStreamingFunction const& function, BeastRequest request,
+    functions::HttpRequestBodyReader& reader) try {
   if (request.target() == "/favicon.ico" || request.target() == "/robots.txt") {
     BeastResponse response;
     response.result(be::http::status::not_found);
     return response;
   }
-  auto response = function(MakeHttpRequest(std::move(request)));
+  auto r = Timed(RequestPhase::kDecode,
+                 [&] { return MakeHttpRequest(std::move(request)); });
+  auto response = Timed(RequestPhase::kFunction,
+                        [&] { return function(std::move(r), reader); });
+  PhaseTimer encode(RequestPhase::kEncode);
   return UnwrapResponse::unwrap(std::move(response));
 } catch (std::exception const& ex) {
   return ReportExceptionInFunction(ex);
@@ -79,23 +170,139 @@ BeastResponse CallUserFunction(functions::UserHttpFunction const& function,
 }
 
 BeastResponse CallUserFunction(
-    functions::UserCloudEventFunction const& function,
-    BeastRequest const& request) try {
+    functions::UserHttpStreamingResponseFunction const& function,
+    BeastRequest request) {
+  BufferedResponseWriter writer;
+  (void)CallUserFunction(function, std::move(request), writer);
+  return std::move(writer).response();
+}
+
+bool CallUserFunction(
+    functions::UserHttpStreamingResponseFunction const& function,
+    BeastRequest request, ResponseWriter& writer) {
   if (request.target() == "/favicon.ico" || request.target() == "/robots.txt") {
     BeastResponse response;
     response.result(be::http::status::not_found);
-    return response;
+    writer.WriteHeader(std::move(response));
+    return true;
+  }
+  HttpResponseWriterAdapter adapter(writer);
+  auto on_error = [&](BeastResponse error) {
+    // Once the header is sent the error can only be logged.
+    if (adapter.header_sent()) return false;
+    writer.WriteHeader(std::move(error));
+    return true;
+  };
+  try {
+    auto r = Timed(RequestPhase::kDecode,
+                   [&] { return MakeHttpRequest(std::move(request)); });
+    PhaseTimer timer(RequestPhase::kFunction);
+    function(std::move(r), adapter);
+    // Functions that never write send an empty response.
+    adapter.WriteHeader(functions::HttpResponse{});
+    return true;
+  } catch (std::exception const& ex) {
+    return on_error(ReportExceptionInFunction(ex));
+  } catch (...) {
+    return on_error(ReportUnknownExceptionInFunction());
+  }
+}
+
+void CallUserFunction(functions::UserHttpAsyncFunction const& function,
+                      BeastRequest request, AsyncResponseCallback done) {
+  if (request.target() == "/favicon.ico" || request.target() == "/robots.txt") {
+    BeastResponse response;
+    response.result(be::http::status::not_found);
+    return done(std::move(response));
   }
-  auto const events = ParseCloudEventHttp(request);
-  for (auto const& ce : events) {
-    function(ce);
+  auto completion = std::make_shared<AsyncCompletion>(std::move(done));
+  try {
+    // The function time is measured until the callback, see
+    // `MakeTimingAsyncHandler()`.
+    auto r = Timed(RequestPhase::kDecode,
+                   [&] { return MakeHttpRequest(std::move(request)); });
+    function(std::move(r),
+             [completion](functions::HttpResponse response) {
+               (*completion)(UnwrapResponse::unwrap(std::move(response)));
+             });
+  } catch (...) {
+    (*completion)(ReportException(std::current_exception()));
   }
-  return BeastResponse{};
+}
+
+std::optional<BeastResponse> CallUserFunction(
+    functions::UserWebSocketFunction const& function,
+    BeastRequest const& request, std::shared_ptr<functions::WebSocket> socket,
+    functions::WebSocketCallbacks& callbacks) try {
+  callbacks = function(MakeHttpRequest(BeastRequest(request.base())),
+                       std::move(socket));
+  return std::nullopt;
+} catch (std::exception const& ex) {
+  return ReportExceptionInFunction(ex);
+} catch (...) {
+  return ReportUnknownExceptionInFunction();
+}
+
+bool CallUserWebSocketCallback(std::function<void()> const& callback) try {
+  callback();
+  return true;
+} catch (std::exception const& ex) {
+  (void)ReportExceptionInFunction(ex);
+  return false;
+} catch (...) {
+  (void)ReportUnknownExceptionInFunction();
+  return false;
+}
+
+std::optional<BeastResponse> CallUserPrecheck(
+    functions::UserHttpPrecheckFunction const& function,
+    BeastRequest const& request) try {
+  auto response = function(MakeHttpRequest(BeastRequest(request.base())));
+  if (!response) return std::nullopt;
+  return UnwrapResponse::unwrap(*std::move(response));
 } catch (std::exception const& ex) {
   return ReportExceptionInFunction(ex);
 } catch (...) {
   return ReportUnknownExceptionInFunction();
 }
 
+std::optional<std::string> CallUserValidator(
+    functions::UserHttpValidatorFunction const& function,
+    BeastRequest const& request) try {
+  auto etag = function(MakeHttpRequest(BeastRequest(request.base())));
+  if (!etag) return std::nullopt;
+  return QuoteEntityTag(*etag);
+} catch (std::exception const& ex) {
+  (void)ReportExceptionInFunction(ex);
+  return std::nullopt;
+} catch (...) {
+  (void)ReportUnknownExceptionInFunction();
+  return std::nullopt;
+}
+
+std::size_t CallUserClassifier(
+    functions::UserHttpClassifierFunction const& function,
+    BeastRequest const& request) try {
+  return function(MakeHttpRequest(BeastRequest(request.base())));
+} catch (std::exception const& ex) {
+  (void)ReportExceptionInFunction(ex);
+  return std::numeric_limits<std::size_t>::max();
+} catch (...) {
+  (void)ReportUnknownExceptionInFunction();
+  return std::numeric_limits<std::size_t>::max();
+}
+
+std::optional<std::string> CallUserCoalescingKey(
+    functions::UserHttpCoalescingKeyFunction const& function,
+    BeastRequest const& request) try {
+  return function(MakeHttpRequest(BeastRequest(request.base())));
+} catch (std::exception const& ex) {
+  (void)ReportExceptionInFunction(ex);
+  return std::nullopt;
+} catch (...) {
+  (void)ReportUnknownExceptionInFunction();
+  return std::nullopt;
+}
+
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions_internal
@@ -15,8 +15,16 @@
 #ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CALL_USER_FUNCTION_H
 #define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CALL_USER_FUNCTION_H
 
+#include "google/cloud/functions/internal/function_impl.h"
 #include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/internal/typed_function.h"
 #include "google/cloud/functions/user_functions.h"
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
@@ -24,8 +32,105 @@ FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 BeastResponse CallUserFunction(functions::UserHttpFunction const& function,
                                BeastRequest request);
 
+/// Calls @p function with a reader over the (buffered) body of @p request.
 BeastResponse CallUserFunction(
-    functions::UserCloudEventFunction const& function,
+    functions::UserHttpStreamingFunction const& function, BeastRequest request);
+
+/// Calls @p function, @p request contains only the header.
+BeastResponse CallUserFunction(
+    functions::UserHttpStreamingFunction const& function, BeastRequest request,
+    functions::HttpRequestBodyReader& reader);
+
+/// Calls @p function, buffering the full response.
+BeastResponse CallUserFunction(
+    functions::UserHttpStreamingResponseFunction const& function,
+    BeastRequest request);
+
+/// Calls @p function, returns `false` if the response is incomplete.
+bool CallUserFunction(
+    functions::UserHttpStreamingResponseFunction const& function,
+    BeastRequest request, ResponseWriter& writer);
+
+/// Calls a raw function, see `functions::UserRawHttpFunction`.
+BeastResponse CallUserRawFunction(Handler const& function,
+                                  BeastRequest request);
+
+/// Calls a function created by the `MakeFunction()` template.
+BeastResponse CallUserFunction(UserHttpCallable& function,
+                               BeastRequest request);
+
+/**
+ * Calls the asynchronous @p function.
+ *
+ * @p done receives the response exactly once, including any errors.
+ */
+void CallUserFunction(functions::UserHttpAsyncFunction const& function,
+                      BeastRequest request, AsyncResponseCallback done);
+
+/// Calls the callback of an asynchronous function at most once.
+class AsyncCompletion {
+ public:
+  explicit AsyncCompletion(AsyncResponseCallback done)
+      : done_(std::move(done)) {}
+
+  void operator()(BeastResponse response) {
+    if (called_.exchange(true)) return;
+    done_(std::move(response));
+  }
+
+ private:
+  std::atomic<bool> called_{false};
+  AsyncResponseCallback done_;
+};
+
+/**
+ * Calls the WebSocket @p function, @p request contains only the header.
+ *
+ * Returns a response to reject the upgrade, including any errors.
+ */
+std::optional<BeastResponse> CallUserFunction(
+    functions::UserWebSocketFunction const& function,
+    BeastRequest const& request, std::shared_ptr<functions::WebSocket> socket,
+    functions::WebSocketCallbacks& callbacks);
+
+/**
+ * Calls a WebSocket callback, returns `false` if it throws.
+ *
+ * Exceptions are logged.
+ */
+bool CallUserWebSocketCallback(std::function<void()> const& callback);
+
+/// Calls the precheck @p function, @p request contains only the header.
+std::optional<BeastResponse> CallUserPrecheck(
+    functions::UserHttpPrecheckFunction const& function,
+    BeastRequest const& request);
+
+/**
+ * Calls the validator @p function, @p request contains only the header.
+ *
+ * Returns the quoted entity tag, if any. Exceptions are logged, and return no
+ * entity tag.
+ */
+std::optional<std::string> CallUserValidator(
+    functions::UserHttpValidatorFunction const& function,
+    BeastRequest const& request);
+
+/**
+ * Calls the classifier @p function, @p request contains only the header.
+ *
+ * Exceptions are logged, and return the largest lane.
+ */
+std::size_t CallUserClassifier(
+    functions::UserHttpClassifierFunction const& function,
+    BeastRequest const& request);
+
+/**
+ * Calls the coalescing key @p function, @p request contains only the header.
+ *
+ * Exceptions are logged, and return no key.
+ */
+std::optional<std::string> CallUserCoalescingKey(
+    functions::UserHttpCoalescingKeyFunction const& function,
     BeastRequest const& request);
 
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
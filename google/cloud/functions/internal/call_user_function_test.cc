@@ -12,14 +12,22 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "google/cloud/functions/internal/call_user_cloud_event.h"
 #include "google/cloud/functions/internal/call_user_function.h"
+#include <nlohmann/json.hpp>
 #include <gmock/gmock.h>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 namespace {
 
 using ::testing::Contains;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
 namespace http = ::boost::beast::http;
 
 TEST(CallUserFunctionHttpTest, Basic) {
@@ -55,6 +63,74 @@ TEST(CallUserFunctionHttpTest, ReturnError) {
   EXPECT_EQ(response.result_int(), functions::HttpResponse::kNotFound);
 }
 
+TEST(CallUserFunctionHttpTest, Streaming) {
+  auto func = [](functions::HttpRequest const& request,
+                 functions::HttpRequestBodyReader& reader) {
+    EXPECT_EQ(request.target(), "/foo/bar");
+    EXPECT_EQ(request.payload(), "");
+    std::string body;
+    std::vector<char> buffer(4);
+    for (auto n = reader.Read(buffer.data(), buffer.size()); n != 0;
+         n = reader.Read(buffer.data(), buffer.size())) {
+      body.append(buffer.data(), n);
+    }
+    return functions::HttpResponse{}.set_payload(body + "!");
+  };
+  BeastRequest request;
+  request.target("/foo/bar");
+  request.method(boost::beast::http::verb::put);
+  request.body() = "Hello, is there anybody out there?";
+  auto response = CallUserFunction(
+      functions::UserHttpStreamingFunction(func), std::move(request));
+  EXPECT_EQ(response.result_int(), functions::HttpResponse::kOkay);
+  EXPECT_EQ(response.body(), "Hello, is there anybody out there?!");
+}
+
+TEST(CallUserFunctionHttpTest, StreamingThrow) {
+  auto func = [](functions::HttpRequest const& /*request*/,
+                 functions::HttpRequestBodyReader& /*reader*/)
+      -> functions::HttpResponse { throw std::runtime_error("uh-oh"); };
+  BeastRequest request;
+  request.target("/foo/bar");
+  auto response = CallUserFunction(
+      functions::UserHttpStreamingFunction(func), std::move(request));
+  EXPECT_EQ(response.result_int(),
+            functions::HttpResponse::kInternalServerError);
+}
+
+TEST(CallUserFunctionHttpTest, StreamingResponse) {
+  auto func = [](functions::HttpRequest const& request,
+                 functions::HttpResponseWriter& writer) {
+    writer.WriteHeader(functions::HttpResponse{}
+                           .set_header("x-goog-test", "response-header")
+                           .set_payload("target=" + request.target()));
+    writer.Write(", more");
+    // These are ignored.
+    writer.WriteHeader(functions::HttpResponse{}.set_result(
+        functions::HttpResponse::kNotFound));
+  };
+  BeastRequest request;
+  request.target("/foo/bar");
+  auto response = CallUserFunction(
+      functions::UserHttpStreamingResponseFunction(func), std::move(request));
+  EXPECT_EQ(response.result_int(), functions::HttpResponse::kOkay);
+  EXPECT_EQ(response.body(), "target=/foo/bar, more");
+  EXPECT_EQ(response["x-goog-test"], "response-header");
+}
+
+TEST(CallUserFunctionHttpTest, StreamingResponseThrow) {
+  auto func = [](functions::HttpRequest const& /*request*/,
+                 functions::HttpResponseWriter& /*writer*/) {
+    throw std::runtime_error("uh-oh");
+  };
+  BeastRequest request;
+  request.target("/foo/bar");
+  auto response = CallUserFunction(
+      functions::UserHttpStreamingResponseFunction(func), std::move(request));
+  EXPECT_EQ(response.result_int(),
+            functions::HttpResponse::kInternalServerError);
+}
+
 functions::HttpResponse HttpAlwaysThrow(
     functions::HttpRequest const& /*request*/) {
   throw std::runtime_error("uh-oh");
@@ -117,6 +193,200 @@ TEST(CallUserFunctionCloudEventTest, Basic) {
   EXPECT_EQ(response.result_int(), 200);
 }
 
+TEST(CallUserFunctionCloudEventTest, MovesEvents) {
+  // Only compiles if the function receives an rvalue.
+  std::vector<std::string> ids;
+  functions::UserCloudEventFunction func =
+      [&ids](functions::CloudEvent&& event) { ids.push_back(event.id()); };
+  BeastRequest request;
+  request.target("/hello");
+  request.insert("content-type", "application/cloudevents-batch+json");
+  request.body() = R"js([
+    {"specversion": "1.0", "type": "t", "source": "s", "id": "id-1"},
+    {"specversion": "1.0", "type": "t", "source": "s", "id": "id-2"}])js";
+  request.prepare_payload();
+  auto response = CallUserFunction(func, request);
+  EXPECT_EQ(response.result_int(), 200);
+  EXPECT_THAT(ids, ElementsAre("id-1", "id-2"));
+}
+
+TEST(CallUserFunctionCloudEventTest, MovesBinaryBody) {
+  BeastRequest request;
+  request.target("/hello");
+  request.set("ce-specversion", "1.0");
+  request.set("ce-type", "t");
+  request.set("ce-source", "s");
+  request.set("ce-id", "id-1");
+  request.set("content-type", "application/octet-stream");
+  request.body() = std::string(4096, 'x');
+  request.prepare_payload();
+
+  // The request body becomes the event data, the payload is not copied.
+  auto const* payload = request.body().data();
+  char const* data = nullptr;
+  functions::UserCloudEventFunction func =
+      [&data](functions::CloudEvent const& event) {
+        data = event.data_view()->data();
+      };
+  auto response = CallUserFunction(func, request);
+  EXPECT_EQ(response.result_int(), 200);
+  EXPECT_NE(data, payload);
+  response = CallUserFunction(func, std::move(request));
+  EXPECT_EQ(response.result_int(), 200);
+  EXPECT_EQ(data, payload);
+}
+
+TEST(CallUserFunctionCloudEventTest, Batch) {
+  std::vector<std::string> ids;
+  functions::UserCloudEventBatchFunction func =
+      [&ids](std::vector<functions::CloudEvent> events) {
+        for (auto const& e : events) ids.push_back(e.id());
+      };
+  BeastRequest request;
+  request.target("/hello");
+  request.insert("content-type", "application/cloudevents-batch+json");
+  request.body() = R"js([
+    {"specversion": "1.0", "type": "t", "source": "s", "id": "id-1"},
+    {"specversion": "1.0", "type": "t", "source": "s", "id": "id-2"}])js";
+  request.prepare_payload();
+  auto response = CallUserFunction(func, request);
+  EXPECT_EQ(response.result_int(), 200);
+  EXPECT_THAT(ids, ElementsAre("id-1", "id-2"));
+
+  ids.clear();
+  response = CallUserFunction(func, TestCloudEventRequest());
+  EXPECT_EQ(response.result_int(), 200);
+  EXPECT_THAT(ids, ElementsAre("A234-1234-1234"));
+
+  functions::UserCloudEventBatchFunction fail =
+      [](std::vector<functions::CloudEvent> const&) {
+        throw std::runtime_error("uh-oh");
+      };
+  response = CallUserFunction(fail, TestCloudEventRequest());
+  EXPECT_EQ(response.result_int(), 500);
+}
+
+TEST(CallUserFunctionCloudEventTest, BatchPartialFailure) {
+  functions::UserCloudEventBatchFunction func =
+      [](std::vector<functions::CloudEvent> events) {
+        functions::CloudEventBatchError error;
+        for (std::size_t i = 0; i != events.size(); ++i) {
+          if (events[i].id() == "id-2") continue;
+          error.Fail(i, "uh-oh " + events[i].id());
+        }
+        error.Fail(42, "ignored");
+        if (!error.empty()) throw error;
+      };
+  BeastRequest request;
+  request.target("/hello");
+  request.insert("content-type", "application/cloudevents-batch+json");
+  request.body() = R"js([
+    {"specversion": "1.0", "type": "t", "source": "s", "id": "id-1"},
+    {"specversion": "1.0", "type": "t", "source": "s", "id": "id-2"},
+    {"specversion": "1.0", "type": "t", "source": "s", "id": "id-3"}])js";
+  request.prepare_payload();
+  auto response = CallUserFunction(func, request);
+  EXPECT_EQ(response.result_int(), 500);
+  auto const error = nlohmann::json::parse(response.body().str());
+  EXPECT_EQ(error.value("message", ""), "2 of 3 events in the batch failed");
+  ASSERT_EQ(error.at("errors").size(), 2);
+  EXPECT_EQ(error.at("errors")[0].value("index", -1), 0);
+  EXPECT_EQ(error.at("errors")[0].value("id", ""), "id-1");
+  EXPECT_EQ(error.at("errors")[0].value("message", ""), "uh-oh id-1");
+  EXPECT_EQ(error.at("errors")[1].value("index", -1), 2);
+  EXPECT_EQ(error.at("errors")[1].value("id", ""), "id-3");
+
+  // A single event keeps the plain error response.
+  response = CallUserFunction(func, TestCloudEventRequest());
+  EXPECT_EQ(response.result_int(), 500);
+  EXPECT_EQ(nlohmann::json::parse(response.body().str()).count("errors"), 0);
+}
+
+TEST(CallUserFunctionCloudEventTest, SequentialBatchErrors) {
+  std::vector<std::string> ids;
+  functions::UserCloudEventFunction func =
+      [&ids](functions::CloudEvent const& event) {
+        ids.push_back(event.id());
+        if (event.id() == "id-2") throw std::runtime_error("uh-oh");
+      };
+  BeastRequest request;
+  request.target("/hello");
+  request.insert("content-type", "application/cloudevents-batch+json");
+  request.body() = R"js([
+    {"specversion": "1.0", "type": "t", "source": "s", "id": "id-1"},
+    {"specversion": "1.0", "type": "t", "source": "s", "id": "id-2"},
+    {"specversion": "1.0", "type": "t", "source": "s", "id": "id-3"}])js";
+  request.prepare_payload();
+  auto response = CallUserFunction(func, request);
+  EXPECT_EQ(response.result_int(), 500);
+  EXPECT_THAT(ids, ElementsAre("id-1", "id-2"));
+  auto const error = nlohmann::json::parse(response.body().str());
+  EXPECT_EQ(error.value("message", ""),
+            "1 of 3 events in the batch failed, 1 skipped");
+  ASSERT_EQ(error.at("errors").size(), 2);
+  EXPECT_EQ(error.at("errors")[0].value("id", ""), "id-2");
+  EXPECT_THAT(error.at("errors")[0].value("message", ""), HasSubstr("uh-oh"));
+  EXPECT_EQ(error.at("errors")[1].value("id", ""), "id-3");
+  EXPECT_EQ(error.at("errors")[1].value("index", -1), 2);
+}
+
+TEST(CallUserFunctionCloudEventTest, AsyncBatchErrors) {
+  std::vector<functions::CloudEventCallback> pending;
+  functions::UserCloudEventAsyncFunction func =
+      [&pending](functions::CloudEvent const& /*event*/,
+                 functions::CloudEventCallback done) {
+        pending.push_back(std::move(done));
+      };
+  BeastRequest request;
+  request.target("/hello");
+  request.insert("content-type", "application/cloudevents-batch+json");
+  request.body() = R"js([
+    {"specversion": "1.0", "type": "t", "source": "s", "id": "id-1"},
+    {"specversion": "1.0", "type": "t", "source": "s", "id": "id-2"}])js";
+  request.prepare_payload();
+  std::optional<BeastResponse> response;
+  CallUserFunction(func, request,
+                   [&response](BeastResponse r) { response = std::move(r); });
+  ASSERT_EQ(pending.size(), 2);
+  pending[1](std::make_exception_ptr(std::runtime_error("uh-oh")));
+  EXPECT_FALSE(response.has_value());
+  pending[0](nullptr);
+  ASSERT_TRUE(response.has_value());
+  EXPECT_EQ(response->result_int(), 500);
+  auto const error = nlohmann::json::parse(response->body().str());
+  EXPECT_EQ(error.value("message", ""), "1 of 2 events in the batch failed");
+  ASSERT_EQ(error.at("errors").size(), 1);
+  EXPECT_EQ(error.at("errors")[0].value("id", ""), "id-2");
+  EXPECT_EQ(error.at("errors")[0].value("index", -1), 1);
+}
+
+TEST(CallUserFunctionCloudEventTest, ParallelBatchErrors) {
+  ParallelBatchRunner runner(
+      [](functions::CloudEvent const& event) {
+        if (event.id() == "id-2") throw std::runtime_error("uh-oh");
+      },
+      functions::CloudEventBatchOptions{2});
+  BeastRequest request;
+  request.target("/hello");
+  request.insert("content-type", "application/cloudevents-batch+json");
+  request.body() = R"js([
+    {"specversion": "1.0", "type": "t", "source": "s", "id": "id-1"},
+    {"specversion": "1.0", "type": "t", "source": "s", "id": "id-2"}])js";
+  request.prepare_payload();
+  auto response = CallUserFunction(runner, request);
+  EXPECT_EQ(response.result_int(), 500);
+  auto const error = nlohmann::json::parse(response.body().str());
+  EXPECT_EQ(error.value("message", ""), "1 of 2 events in the batch failed");
+  ASSERT_EQ(error.at("errors").size(), 1);
+  EXPECT_EQ(error.at("errors")[0].value("id", ""), "id-2");
+  EXPECT_EQ(error.at("errors")[0].value("index", -1), 1);
+
+  request.body() = R"js([])js";
+  request.prepare_payload();
+  response = CallUserFunction(runner, request);
+  EXPECT_EQ(response.result_int(), 200);
+}
+
 void CloudEventAlwaysThrow(functions::CloudEvent const& /*event*/) {
   throw std::runtime_error("uh-oh");
 }
@@ -137,6 +407,38 @@ TEST(CallUserFunctionCloudEventTest, ReturnErrorOnUnknownException) {
   EXPECT_EQ(response.result(), http::status::internal_server_error);
 }
 
+TEST(CallUserFunctionCloudEventTest, InvalidEventsAreBadRequests) {
+  BeastRequest missing;
+  missing.target("/hello");
+  missing.insert("ce-id", "id-1");
+  BeastRequest malformed;
+  malformed.target("/hello");
+  malformed.insert("content-type", "application/cloudevents+json");
+  malformed.body() = R"js({"id": "id-1", "type": )js";
+  BeastRequest not_array;
+  not_array.target("/hello");
+  not_array.insert("content-type", "application/cloudevents-batch+json");
+  not_array.body() = R"js({"id": "id-1"})js";
+
+  auto calls = 0;
+  auto func = [&calls](functions::CloudEvent const&) { ++calls; };
+  functions::UserCloudEventBatchFunction batch =
+      [&calls](std::vector<functions::CloudEvent> const&) { ++calls; };
+  ParallelBatchRunner runner(
+      [&calls](functions::CloudEvent const&) { ++calls; },
+      functions::CloudEventBatchOptions{2});
+  for (auto const* request : {&missing, &malformed, &not_array}) {
+    auto response = CallUserFunction(func, *request);
+    EXPECT_EQ(response.result(), http::status::bad_request);
+    EXPECT_FALSE(response.body().str().empty());
+    response = CallUserFunction(batch, *request);
+    EXPECT_EQ(response.result(), http::status::bad_request);
+    response = CallUserFunction(runner, *request);
+    EXPECT_EQ(response.result(), http::status::bad_request);
+  }
+  EXPECT_EQ(calls, 0);
+}
+
 TEST(CallUserFunctionCloudEventTest, InterceptRobotsTxt) {
   BeastRequest request;
   request.target("/robots.txt");
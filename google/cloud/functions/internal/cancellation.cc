@@ -0,0 +1,205 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/cancellation.h"
+#include "google/cloud/functions/internal/structured_log.h"
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+thread_local CancellationState* current_cancellation = nullptr;
+
+void RunCallback(std::function<void()> const& callback) try {
+  callback();
+} catch (std::exception const& ex) {
+  WriteLog(functions::LogSeverity::kError,
+           std::string("Cancellation callback failed: ") + ex.what());
+} catch (...) {
+  WriteLog(functions::LogSeverity::kError,
+           "Cancellation callback failed with an unknown exception");
+}
+
+/**
+ * Returns the state for @p request, creating it if needed.
+ *
+ * The second member is `true` if the caller created the state, and must
+ * release it once the request completes.
+ */
+std::pair<std::shared_ptr<CancellationState>, bool> PrepareCancellation(
+    BeastRequest const& request, std::chrono::milliseconds deadline) {
+  std::optional<std::chrono::microseconds> timeout;
+  auto const h = request.find("x-server-timeout");
+  if (h != request.end()) timeout = ParseServerTimeout(h->value());
+  auto state = CurrentCancellation();
+  auto const owned = !state;
+  if (owned) {
+    if (deadline == std::chrono::milliseconds(0) && !timeout) return {};
+    state = std::make_shared<CancellationState>();
+  }
+  auto const now = CancellationState::Clock::now();
+  if (deadline != std::chrono::milliseconds(0)) {
+    state->ShortenDeadline(now + deadline);
+  }
+  if (timeout) state->ShortenDeadline(now + *timeout);
+  return {std::move(state), owned};
+}
+
+}  // namespace
+
+void CancellationState::ShortenDeadline(Clock::time_point deadline) {
+  deadline_ = deadline_ ? std::min(*deadline_, deadline) : deadline;
+}
+
+bool CancellationState::cancelled() const {
+  if (cancelled_.load()) return true;
+  return deadline_ && Clock::now() >= *deadline_;
+}
+
+void CancellationState::Cancel() {
+  std::vector<std::function<void()>> callbacks;
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (cancelled_.exchange(true)) return;
+    callbacks.swap(callbacks_);
+    timer_.reset();
+    loop_.reset();
+  }
+  for (auto const& c : callbacks) RunCallback(c);
+}
+
+void CancellationState::OnCancel(std::function<void()> callback) {
+  if (!callback) return;
+  if (cancelled()) {
+    // The deadline may pass before the timer fires, cancel for the other
+    // callbacks too.
+    Cancel();
+    return RunCallback(callback);
+  }
+  std::lock_guard<std::mutex> lk(mu_);
+  if (released_) return;
+  callbacks_.push_back(std::move(callback));
+  if (!deadline_ || timer_) return;
+  loop_.emplace(AcquireClientEventLoop(/*blocking=*/false));
+  timer_.emplace(*loop_->ioc, *deadline_);
+  timer_->async_wait(
+      [w = weak_from_this()](boost::system::error_code const& ec) {
+        if (ec) return;
+        if (auto self = w.lock()) self->Cancel();
+      });
+}
+
+void CancellationState::Release() {
+  std::lock_guard<std::mutex> lk(mu_);
+  released_ = true;
+  callbacks_.clear();
+  timer_.reset();
+  loop_.reset();
+}
+
+std::shared_ptr<CancellationState> CurrentCancellation() {
+  if (current_cancellation == nullptr) return nullptr;
+  return current_cancellation->shared_from_this();
+}
+
+ScopedCancellation::ScopedCancellation(CancellationState* state)
+    : previous_(std::exchange(current_cancellation, state)) {}
+
+ScopedCancellation::~ScopedCancellation() {
+  current_cancellation = previous_;
+}
+
+std::optional<std::chrono::microseconds> ParseServerTimeout(
+    std::string_view value) {
+  auto const dot = value.find('.');
+  auto const whole = value.substr(0, dot);
+  auto const fraction = dot == std::string_view::npos
+                            ? std::string_view{}
+                            : value.substr(dot + 1);
+  if (whole.empty() && fraction.empty()) return std::nullopt;
+  auto constexpr kMaxSeconds = std::int64_t{365} * 24 * 3600;
+  auto constexpr kMicrosDigits = 6;
+  auto constexpr kBase = 10;
+  std::int64_t seconds = 0;
+  for (auto c : whole) {
+    if (c < '0' || c > '9') return std::nullopt;
+    seconds = seconds * kBase + (c - '0');
+    if (seconds > kMaxSeconds) return std::nullopt;
+  }
+  std::int64_t micros = 0;
+  for (std::size_t i = 0; i != fraction.size(); ++i) {
+    auto const c = fraction[i];
+    if (c < '0' || c > '9') return std::nullopt;
+    if (i < kMicrosDigits) micros = micros * kBase + (c - '0');
+  }
+  for (auto i = fraction.size(); i < kMicrosDigits; ++i) micros *= kBase;
+  return std::chrono::seconds(seconds) + std::chrono::microseconds(micros);
+}
+
+Handler MakeCancellationHandler(Handler handler,
+                                std::chrono::milliseconds deadline) {
+  return [handler = std::move(handler), deadline](BeastRequest request) {
+    auto [state, owned] = PrepareCancellation(request, deadline);
+    ScopedCancellation scoped(state.get());
+    auto response = handler(std::move(request));
+    if (owned) state->Release();
+    return response;
+  };
+}
+
+StreamingHandler MakeCancellationStreamingHandler(
+    StreamingHandler handler, std::chrono::milliseconds deadline) {
+  return [handler = std::move(handler), deadline](
+             BeastRequest request, functions::HttpRequestBodyReader& reader) {
+    auto [state, owned] = PrepareCancellation(request, deadline);
+    ScopedCancellation scoped(state.get());
+    auto response = handler(std::move(request), reader);
+    if (owned) state->Release();
+    return response;
+  };
+}
+
+WriterHandler MakeCancellationWriterHandler(
+    WriterHandler handler, std::chrono::milliseconds deadline) {
+  return [handler = std::move(handler), deadline](BeastRequest request,
+                                                  ResponseWriter& writer) {
+    auto [state, owned] = PrepareCancellation(request, deadline);
+    ScopedCancellation scoped(state.get());
+    auto const ok = handler(std::move(request), writer);
+    if (owned) state->Release();
+    return ok;
+  };
+}
+
+AsyncHandler MakeCancellationAsyncHandler(AsyncHandler handler,
+                                          std::chrono::milliseconds deadline) {
+  return [handler = std::move(handler), deadline](
+             BeastRequest request, AsyncResponseCallback callback) {
+    auto [state, owned] = PrepareCancellation(request, deadline);
+    ScopedCancellation scoped(state.get());
+    if (!owned) return handler(std::move(request), std::move(callback));
+    handler(std::move(request), [state = state, callback = std::move(callback)](
+                                    BeastResponse response) {
+      state->Release();
+      callback(std::move(response));
+    });
+  };
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,128 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CANCELLATION_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CANCELLATION_H
+
+#include "google/cloud/functions/internal/client_event_loop.h"
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/cancellation_token.h"
+#include "google/cloud/functions/version.h"
+#include <boost/asio/steady_timer.hpp>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * The cancellation state of a request, shared by its tokens.
+ *
+ * The deadline is only checked when asked for, a timer is armed, in one of
+ * the client event loops, only once a callback needs it.
+ */
+class CancellationState
+    : public std::enable_shared_from_this<CancellationState> {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /// Keeps the earliest deadline, only call it before the function runs.
+  void ShortenDeadline(Clock::time_point deadline);
+  [[nodiscard]] std::optional<Clock::time_point> deadline() const {
+    return deadline_;
+  }
+
+  [[nodiscard]] bool cancelled() const;
+
+  /// Cancels the request, and runs the callbacks, at most once.
+  void Cancel();
+
+  /// Runs @p callback once the request is cancelled, unless it completes.
+  void OnCancel(std::function<void()> callback);
+
+  /// The request is complete, discards the callbacks, and stops the timer.
+  void Release();
+
+ private:
+  std::optional<Clock::time_point> deadline_;
+  std::atomic<bool> cancelled_{false};
+  std::mutex mu_;
+  bool released_ = false;
+  std::vector<std::function<void()>> callbacks_;
+  std::optional<ClientEventLoop> loop_;
+  std::optional<boost::asio::steady_timer> timer_;
+};
+
+struct CancellationAccess {
+  static functions::CancellationToken MakeToken(
+      std::shared_ptr<CancellationState> state) {
+    return functions::CancellationToken(std::move(state));
+  }
+};
+
+/// The state of the request running in the current thread, if any.
+std::shared_ptr<CancellationState> CurrentCancellation();
+
+/// Sets the cancellation state of the current thread, @p state may be null.
+class ScopedCancellation {
+ public:
+  explicit ScopedCancellation(CancellationState* state);
+  ~ScopedCancellation();
+
+  ScopedCancellation(ScopedCancellation const&) = delete;
+  ScopedCancellation& operator=(ScopedCancellation const&) = delete;
+
+ private:
+  CancellationState* previous_;
+};
+
+/**
+ * Parses an `X-Server-Timeout` header value, a number of seconds.
+ *
+ * Returns an empty optional for invalid, negative, or absurdly large values.
+ */
+std::optional<std::chrono::microseconds> ParseServerTimeout(
+    std::string_view value);
+
+/**
+ * Wrap handlers to give each request its deadline.
+ *
+ * The deadline is the shortest of @p deadline, if not 0, and the
+ * `X-Server-Timeout` header, counted from the start of the handler. The
+ * handlers use the state set by the session, if any, which also cancels the
+ * request if the client disconnects. Otherwise they create their own, only
+ * if the request has a deadline.
+ */
+///@{
+Handler MakeCancellationHandler(Handler handler,
+                                std::chrono::milliseconds deadline);
+StreamingHandler MakeCancellationStreamingHandler(
+    StreamingHandler handler, std::chrono::milliseconds deadline);
+WriterHandler MakeCancellationWriterHandler(WriterHandler handler,
+                                            std::chrono::milliseconds deadline);
+AsyncHandler MakeCancellationAsyncHandler(AsyncHandler handler,
+                                          std::chrono::milliseconds deadline);
+///@}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CANCELLATION_H
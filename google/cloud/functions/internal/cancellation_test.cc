@@ -0,0 +1,123 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/cancellation.h"
+#include "google/cloud/functions/internal/wrap_request.h"
+#include <gmock/gmock.h>
+#include <chrono>
+#include <future>
+#include <memory>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using std::chrono::microseconds;
+
+TEST(CancellationTest, ParseServerTimeout) {
+  EXPECT_EQ(ParseServerTimeout("5"), microseconds(5000000));
+  EXPECT_EQ(ParseServerTimeout("0.25"), microseconds(250000));
+  EXPECT_EQ(ParseServerTimeout(".5"), microseconds(500000));
+  EXPECT_EQ(ParseServerTimeout("1.0000019"), microseconds(1000001));
+  EXPECT_EQ(ParseServerTimeout("0"), microseconds(0));
+  for (auto const* invalid : {"", ".", "-1", "1s", "1e3", "1.2.3",
+                              "99999999999999999999"}) {
+    EXPECT_FALSE(ParseServerTimeout(invalid).has_value()) << invalid;
+  }
+}
+
+TEST(CancellationTest, Cancel) {
+  auto state = std::make_shared<CancellationState>();
+  int calls = 0;
+  state->OnCancel([&calls] { ++calls; });
+  state->OnCancel([&calls] { ++calls; });
+  EXPECT_FALSE(state->cancelled());
+  state->Cancel();
+  state->Cancel();
+  EXPECT_TRUE(state->cancelled());
+  EXPECT_EQ(calls, 2);
+  // Late callbacks run immediately.
+  state->OnCancel([&calls] { ++calls; });
+  EXPECT_EQ(calls, 3);
+}
+
+TEST(CancellationTest, Release) {
+  auto state = std::make_shared<CancellationState>();
+  int calls = 0;
+  state->OnCancel([&calls] { ++calls; });
+  state->Release();
+  state->Cancel();
+  EXPECT_EQ(calls, 0);
+}
+
+TEST(CancellationTest, Deadline) {
+  auto state = std::make_shared<CancellationState>();
+  EXPECT_FALSE(state->deadline().has_value());
+  auto const now = CancellationState::Clock::now();
+  state->ShortenDeadline(now + std::chrono::hours(1));
+  state->ShortenDeadline(now + std::chrono::milliseconds(20));
+  state->ShortenDeadline(now + std::chrono::hours(2));
+  EXPECT_EQ(state->deadline(), now + std::chrono::milliseconds(20));
+
+  // The timer cancels the request, even if nobody checks.
+  std::promise<void> fired;
+  state->OnCancel([&fired] { fired.set_value(); });
+  EXPECT_EQ(fired.get_future().wait_for(std::chrono::seconds(5)),
+            std::future_status::ready);
+  EXPECT_TRUE(state->cancelled());
+}
+
+TEST(CancellationTest, HandlerDeadline) {
+  auto handler = MakeCancellationHandler(
+      [](BeastRequest request) {
+        auto token = MakeHttpRequest(std::move(request)).cancellation_token();
+        BeastResponse response;
+        response.body() = token.deadline().has_value() ? "deadline" : "none";
+        return response;
+      },
+      std::chrono::milliseconds(0));
+  BeastRequest request;
+  EXPECT_EQ(handler(request).body(), "none");
+  request.set("x-server-timeout", "10");
+  EXPECT_EQ(handler(request).body(), "deadline");
+  // Outside the handler there is no token.
+  EXPECT_FALSE(functions::CurrentCancellationToken().deadline().has_value());
+}
+
+TEST(CancellationTest, HandlerUsesSessionState) {
+  auto state = std::make_shared<CancellationState>();
+  std::shared_ptr<CancellationState> seen;
+  auto handler = MakeCancellationAsyncHandler(
+      [&seen](BeastRequest const&, AsyncResponseCallback done) {
+        seen = CurrentCancellation();
+        done(BeastResponse{});
+      },
+      std::chrono::milliseconds(1000));
+  ScopedCancellation scoped(state.get());
+  handler(BeastRequest{}, [](BeastResponse const&) {});
+  EXPECT_EQ(seen, state);
+  EXPECT_TRUE(state->deadline().has_value());
+  EXPECT_FALSE(state->cancelled());
+}
+
+TEST(CancellationTest, DefaultToken) {
+  functions::CancellationToken token;
+  EXPECT_FALSE(token.cancelled());
+  EXPECT_FALSE(token.deadline().has_value());
+  token.on_cancel([] { FAIL() << "unexpected callback"; });
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,51 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/cgroup_files.h"
+#include <fstream>
+#include <iterator>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+std::string_view TrimCgroupValue(std::string_view s) {
+  auto const b = s.find_first_not_of(" \t\n");
+  if (b == std::string_view::npos) return {};
+  auto const e = s.find_last_not_of(" \t\n");
+  return s.substr(b, e - b + 1);
+}
+
+std::optional<std::string> ReadSystemFile(std::filesystem::path const& path) {
+  std::ifstream is(path);
+  if (!is) return std::nullopt;
+  return std::string{std::istreambuf_iterator<char>(is), {}};
+}
+
+void ForEachCgroupDirectory(
+    std::filesystem::path const& root, std::string const& path,
+    std::function<void(std::filesystem::path const&)> const& f) {
+  f(root);
+  auto dir = root;
+  for (auto const& part : CgroupRelativePath(path)) {
+    dir /= part;
+    f(dir);
+  }
+}
+
+std::filesystem::path CgroupRelativePath(std::string const& path) {
+  return std::filesystem::path(path).relative_path();
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,64 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CGROUP_FILES_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CGROUP_FILES_H
+
+#include "google/cloud/functions/version.h"
+#include <charconv>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// Removes the whitespace, including the newline, around a cgroup value.
+std::string_view TrimCgroupValue(std::string_view s);
+
+/// Parses a cgroup value with a single decimal integer.
+template <typename T>
+std::optional<T> ParseCgroupInteger(std::string_view s) {
+  s = TrimCgroupValue(s);
+  T value = 0;
+  auto const* end = s.data() + s.size();
+  auto const r = std::from_chars(s.data(), end, value);
+  if (s.empty() || r.ec != std::errc{} || r.ptr != end) return std::nullopt;
+  return value;
+}
+
+/// The contents of a cgroup, or `/proc`, file, if it can be read.
+std::optional<std::string> ReadSystemFile(std::filesystem::path const& path);
+
+/**
+ * Calls @p f with @p root, and each directory of the cgroup @p path below it.
+ *
+ * The limits of the ancestors also apply. Inside a container the path may
+ * refer to the host hierarchy, only the directories that exist count, @p f
+ * ignores the files it cannot read.
+ */
+void ForEachCgroupDirectory(
+    std::filesystem::path const& root, std::string const& path,
+    std::function<void(std::filesystem::path const&)> const& f);
+
+/// The relative form of a cgroup path, which may be absolute.
+std::filesystem::path CgroupRelativePath(std::string const& path);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CGROUP_FILES_H
@@ -0,0 +1,71 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/cgroup_files.h"
+#include <gmock/gmock.h>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Optional;
+
+TEST(CgroupFilesTest, TrimCgroupValue) {
+  EXPECT_EQ(TrimCgroupValue(" 42\n"), "42");
+  EXPECT_EQ(TrimCgroupValue("max 100000\n"), "max 100000");
+  EXPECT_EQ(TrimCgroupValue(" \t\n"), "");
+}
+
+TEST(CgroupFilesTest, ParseCgroupInteger) {
+  EXPECT_THAT(ParseCgroupInteger<std::int64_t>("-1\n"), Optional(-1));
+  EXPECT_THAT(ParseCgroupInteger<std::uint64_t>("1073741824\n"),
+              Optional(1073741824U));
+  EXPECT_EQ(ParseCgroupInteger<std::uint64_t>("max\n"), std::nullopt);
+  EXPECT_EQ(ParseCgroupInteger<std::uint64_t>("-1"), std::nullopt);
+  EXPECT_EQ(ParseCgroupInteger<std::int64_t>("12 34"), std::nullopt);
+  EXPECT_EQ(ParseCgroupInteger<std::int64_t>(""), std::nullopt);
+}
+
+TEST(CgroupFilesTest, ReadSystemFile) {
+  auto const path = std::filesystem::temp_directory_path() /
+                    ("cgroup_files_test_" + std::to_string(std::rand()));
+  std::ofstream(path) << "100000 100000\n";
+  EXPECT_THAT(ReadSystemFile(path), Optional(std::string("100000 100000\n")));
+  std::filesystem::remove(path);
+  EXPECT_EQ(ReadSystemFile(path), std::nullopt);
+}
+
+TEST(CgroupFilesTest, ForEachCgroupDirectory) {
+  std::vector<std::filesystem::path> dirs;
+  auto record = [&dirs](std::filesystem::path const& dir) {
+    dirs.push_back(dir);
+  };
+  ForEachCgroupDirectory("/sys/fs/cgroup", "/kubepods/pod1", record);
+  EXPECT_THAT(dirs, ElementsAre("/sys/fs/cgroup", "/sys/fs/cgroup/kubepods",
+                                "/sys/fs/cgroup/kubepods/pod1"));
+  dirs.clear();
+  ForEachCgroupDirectory("/sys/fs/cgroup", "/", record);
+  EXPECT_THAT(dirs, ElementsAre("/sys/fs/cgroup"));
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,105 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/checkpoint.h"
+#include "google/cloud/functions/internal/structured_log.h"
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/signal_set.hpp>
+#include <atomic>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#ifndef _WIN32
+#include <unistd.h>
+#endif  // _WIN32
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+std::atomic<std::uint64_t> restore_count{0};
+
+#ifndef _WIN32
+/// Writes @p path atomically, the checkpoint tool may be polling for it.
+void WriteReadyFile(std::string const& path) {
+  auto const tmp = path + ".tmp";
+  {
+    std::ofstream os(tmp, std::ios::trunc);
+    os << ::getpid() << "\n";
+    if (!os.flush()) {
+      throw std::runtime_error("cannot write the checkpoint ready file " +
+                               tmp);
+    }
+  }
+  std::filesystem::rename(tmp, path);
+}
+#endif  // _WIN32
+
+}  // namespace
+
+std::uint64_t RestoreCount() { return restore_count.load(); }
+
+std::mt19937_64& ThreadRandomGenerator() {
+  struct Generator {
+    std::mt19937_64 engine{std::random_device{}()};
+    std::uint64_t restore_count = RestoreCount();
+  };
+  thread_local Generator generator;
+  auto const current = RestoreCount();
+  if (generator.restore_count != current) {
+    generator.engine.seed(std::random_device{}());
+    generator.restore_count = current;
+  }
+  return generator.engine;
+}
+
+bool RunCheckpoint(std::vector<CheckpointHandler> const& handlers,
+                   std::string const& ready_file) {
+#ifdef _WIN32
+  (void)handlers;
+  (void)ready_file;
+  throw std::invalid_argument(
+      "--checkpoint-ready-file is not supported on this platform");
+#else
+  for (auto h = handlers.rbegin(); h != handlers.rend(); ++h) {
+    if (h->before_checkpoint) h->before_checkpoint();
+  }
+  // Install the signal handlers before the checkpoint tool may see the file.
+  boost::asio::io_context ioc;
+  boost::asio::signal_set signals(ioc, SIGUSR1, SIGTERM);
+  int received = 0;
+  signals.async_wait(
+      [&](boost::system::error_code const& ec, int signal_number) {
+        if (!ec) received = signal_number;
+      });
+  WriteReadyFile(ready_file);
+  WriteLog(functions::LogSeverity::kInfo, "Ready for checkpoint");
+  ioc.run();
+  std::error_code ec;
+  std::filesystem::remove(ready_file, ec);
+  if (received != SIGUSR1) return false;
+
+  restore_count.fetch_add(1);
+  WriteLog(functions::LogSeverity::kInfo, "Restored from checkpoint");
+  for (auto const& h : handlers) {
+    if (h.after_restore) h.after_restore();
+  }
+  return true;
+#endif  // _WIN32
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,61 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CHECKPOINT_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CHECKPOINT_H
+
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/version.h"
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// The number of times this process was restored from a checkpoint.
+std::uint64_t RestoreCount();
+
+/**
+ * Returns a random number generator for the current thread.
+ *
+ * The generator is seeded on first use, and reseeded after each restore, all
+ * the instances restored from the same checkpoint would produce the same
+ * numbers otherwise.
+ */
+std::mt19937_64& ThreadRandomGenerator();
+
+/**
+ * Pauses the server until it is checkpointed and restored.
+ *
+ * Runs the `before_checkpoint` handlers, in reverse order, writes the process
+ * id to @p ready_file, and waits for `SIGUSR1`. The checkpoint tool must send
+ * this signal once the process is restored, or to resume the process without
+ * a checkpoint. Then removes @p ready_file, reseeds the random number
+ * generators, and runs the `after_restore` handlers, in order.
+ *
+ * Returns `false` if the process receives `SIGTERM` while it waits, the
+ * `after_restore` handlers do not run in that case. Exceptions thrown by the
+ * handlers are propagated. Not supported on Windows.
+ *
+ * @throws std::invalid_argument on Windows.
+ */
+bool RunCheckpoint(std::vector<CheckpointHandler> const& handlers,
+                   std::string const& ready_file);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CHECKPOINT_H
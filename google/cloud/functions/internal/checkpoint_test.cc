@@ -0,0 +1,134 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/checkpoint.h"
+#include <gmock/gmock.h>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <unistd.h>
+#endif  // _WIN32
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+
+#ifndef _WIN32
+
+std::string ReadyFilePath() {
+  return (std::filesystem::temp_directory_path() /
+          ("checkpoint_test_" + std::to_string(::getpid()) + "_" +
+           std::to_string(std::rand())))
+      .string();
+}
+
+/// Plays the role of the checkpoint tool, sends @p signal once the server is
+/// ready.
+std::thread SignalWhenReady(std::string path, int signal,
+                            std::string* contents) {
+  return std::thread([path = std::move(path), signal, contents] {
+    while (!std::filesystem::exists(path)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::ifstream is(path);
+    std::getline(is, *contents);
+    ::kill(::getpid(), signal);
+  });
+}
+
+TEST(CheckpointTest, Restore) {
+  std::vector<std::string> calls;
+  auto record = [&calls](std::string name) {
+    return [&calls, name = std::move(name)] { calls.push_back(name); };
+  };
+  std::vector<CheckpointHandler> handlers{
+      {record("checkpoint-1"), record("restore-1")},
+      {record("checkpoint-2"), {}},
+      {{}, record("restore-3")},
+  };
+  auto const path = ReadyFilePath();
+  auto const restores = RestoreCount();
+  auto before = ThreadRandomGenerator();
+
+  std::string contents;
+  auto tool = SignalWhenReady(path, SIGUSR1, &contents);
+  EXPECT_TRUE(RunCheckpoint(handlers, path));
+  tool.join();
+
+  EXPECT_EQ(contents, std::to_string(::getpid()));
+  EXPECT_FALSE(std::filesystem::exists(path));
+  EXPECT_THAT(calls, ElementsAre("checkpoint-2", "checkpoint-1", "restore-1",
+                                 "restore-3"));
+  EXPECT_EQ(RestoreCount(), restores + 1);
+  // The generator is reseeded, it does not continue the sequence captured in
+  // the checkpoint.
+  EXPECT_NE(ThreadRandomGenerator()(), before());
+}
+
+TEST(CheckpointTest, TerminatedBeforeRestore) {
+  std::vector<std::string> calls;
+  std::vector<CheckpointHandler> handlers{
+      {[&calls] { calls.emplace_back("checkpoint"); },
+       [&calls] { calls.emplace_back("restore"); }},
+  };
+  auto const path = ReadyFilePath();
+  auto const restores = RestoreCount();
+
+  std::string contents;
+  auto tool = SignalWhenReady(path, SIGTERM, &contents);
+  EXPECT_FALSE(RunCheckpoint(handlers, path));
+  tool.join();
+
+  EXPECT_FALSE(std::filesystem::exists(path));
+  EXPECT_THAT(calls, ElementsAre("checkpoint"));
+  EXPECT_EQ(RestoreCount(), restores);
+}
+
+TEST(CheckpointTest, BeforeCheckpointThrows) {
+  std::vector<CheckpointHandler> handlers{
+      {[] { throw std::runtime_error("cannot close"); }, {}},
+  };
+  auto const path = ReadyFilePath();
+  EXPECT_THROW(RunCheckpoint(handlers, path), std::runtime_error);
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+#else
+
+TEST(CheckpointTest, NotSupported) {
+  EXPECT_THROW(RunCheckpoint({}, "unused"), std::invalid_argument);
+}
+
+#endif  // _WIN32
+
+TEST(CheckpointTest, ThreadRandomGenerator) {
+  auto& generator = ThreadRandomGenerator();
+  EXPECT_EQ(&generator, &ThreadRandomGenerator());
+  std::mt19937_64* other = nullptr;
+  std::thread([&other] { other = &ThreadRandomGenerator(); }).join();
+  EXPECT_NE(other, &generator);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,115 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/client_event_loop.h"
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace asio = boost::asio;
+
+struct Registration {
+  std::uint64_t id;
+  std::vector<std::shared_ptr<asio::io_context>> contexts;
+};
+
+/// The server event loops, intentionally leaked like the other registries.
+struct Registry {
+  std::mutex mu;
+  std::uint64_t next_id = 0;
+  std::vector<Registration> registrations;
+};
+
+Registry& GetRegistry() {
+  static auto* const kRegistry = new Registry;
+  return *kRegistry;
+}
+
+/// The event loop used outside the server, it runs until the process exits.
+std::shared_ptr<asio::io_context> FallbackEventLoop() {
+  static auto* const kFallback = [] {
+    auto ioc = std::make_shared<asio::io_context>(1);
+    std::thread([ioc, work = asio::make_work_guard(*ioc)] {
+      ScopedEventLoopThread current(*ioc);
+      ioc->run();
+    }).detach();
+    return new std::shared_ptr<asio::io_context>(std::move(ioc));
+  }();
+  return *kFallback;
+}
+
+thread_local asio::io_context const* current_event_loop = nullptr;
+
+}  // namespace
+
+ClientEventLoop AcquireClientEventLoop(bool blocking) {
+  auto& registry = GetRegistry();
+  {
+    // The work guard is created while the loops are offered, before they can
+    // run out of work.
+    std::lock_guard<std::mutex> lk(registry.mu);
+    auto make = [](std::shared_ptr<asio::io_context> const& ioc) {
+      return ClientEventLoop{ioc, asio::make_work_guard(*ioc)};
+    };
+    for (auto const& r : registry.registrations) {
+      auto const i = std::find_if(
+          r.contexts.begin(), r.contexts.end(),
+          [](auto const& ioc) { return ioc.get() == current_event_loop; });
+      if (i == r.contexts.end()) continue;
+      // Blocking the thread of an event loop to wait for a call in the same
+      // event loop could deadlock.
+      if (blocking) break;
+      return make(*i);
+    }
+    if (!registry.registrations.empty() && current_event_loop == nullptr) {
+      return make(registry.registrations.back().contexts.front());
+    }
+  }
+  auto ioc = FallbackEventLoop();
+  auto work = asio::make_work_guard(*ioc);
+  return ClientEventLoop{std::move(ioc), std::move(work)};
+}
+
+ServerEventLoops::ServerEventLoops(
+    std::vector<std::shared_ptr<asio::io_context>> contexts) {
+  auto& registry = GetRegistry();
+  std::lock_guard<std::mutex> lk(registry.mu);
+  id_ = ++registry.next_id;
+  registry.registrations.push_back(Registration{id_, std::move(contexts)});
+}
+
+void ServerEventLoops::Release() {
+  auto& registry = GetRegistry();
+  std::lock_guard<std::mutex> lk(registry.mu);
+  registry.registrations.erase(
+      std::remove_if(registry.registrations.begin(),
+                     registry.registrations.end(),
+                     [this](auto const& r) { return r.id == id_; }),
+      registry.registrations.end());
+}
+
+ScopedEventLoopThread::ScopedEventLoopThread(asio::io_context const& ioc)
+    : previous_(std::exchange(current_event_loop, &ioc)) {}
+
+ScopedEventLoopThread::~ScopedEventLoopThread() {
+  current_event_loop = previous_;
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,90 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CLIENT_EVENT_LOOP_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CLIENT_EVENT_LOOP_H
+
+#include "google/cloud/functions/version.h"
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * An event loop running an outbound call.
+ *
+ * The work guard keeps the event loop running until the call completes, even
+ * if the server stops in the meantime.
+ */
+struct ClientEventLoop {
+  std::shared_ptr<boost::asio::io_context> ioc;
+  boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
+      work;
+};
+
+/**
+ * Picks the event loop for an outbound call.
+ *
+ * Returns the server event loop run by the calling thread, if any, otherwise
+ * the first server event loop, otherwise a fallback event loop, with a single
+ * thread created on first use. Threads running other event loops, such as the
+ * one in `EventSinkImpl`, always get the fallback. With @p blocking the
+ * calling thread waits for the call, so it never gets the event loop it runs.
+ */
+ClientEventLoop AcquireClientEventLoop(bool blocking);
+
+/**
+ * Offers the server event loops to the outbound calls while it exists.
+ *
+ * The event loops stop once they run out of work. Call `Release()` before
+ * that may happen, e.g., when the listeners stop, and the outbound calls
+ * already started keep their event loop running until they complete.
+ */
+class ServerEventLoops {
+ public:
+  explicit ServerEventLoops(
+      std::vector<std::shared_ptr<boost::asio::io_context>> contexts);
+  ~ServerEventLoops() { Release(); }
+
+  ServerEventLoops(ServerEventLoops const&) = delete;
+  ServerEventLoops& operator=(ServerEventLoops const&) = delete;
+
+  /// Stops offering the event loops, this function is idempotent.
+  void Release();
+
+ private:
+  std::uint64_t id_;
+};
+
+/// Marks the calling thread as running @p ioc, until destroyed.
+class ScopedEventLoopThread {
+ public:
+  explicit ScopedEventLoopThread(boost::asio::io_context const& ioc);
+  ~ScopedEventLoopThread();
+
+  ScopedEventLoopThread(ScopedEventLoopThread const&) = delete;
+  ScopedEventLoopThread& operator=(ScopedEventLoopThread const&) = delete;
+
+ private:
+  boost::asio::io_context const* previous_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CLIENT_EVENT_LOOP_H
@@ -0,0 +1,76 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/client_event_loop.h"
+#include <boost/asio/post.hpp>
+#include <gmock/gmock.h>
+#include <future>
+#include <memory>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace asio = boost::asio;
+
+TEST(ClientEventLoopTest, Fallback) {
+  auto loop = AcquireClientEventLoop(/*blocking=*/false);
+  ASSERT_NE(loop.ioc, nullptr);
+  EXPECT_EQ(AcquireClientEventLoop(/*blocking=*/true).ioc, loop.ioc);
+  // The fallback event loop has its own thread.
+  std::promise<void> done;
+  asio::post(*loop.ioc, [&done] { done.set_value(); });
+  done.get_future().get();
+}
+
+TEST(ClientEventLoopTest, ServerEventLoops) {
+  auto fallback = AcquireClientEventLoop(/*blocking=*/false).ioc;
+  auto a = std::make_shared<asio::io_context>();
+  auto b = std::make_shared<asio::io_context>();
+  ServerEventLoops loops({a, b});
+  EXPECT_EQ(AcquireClientEventLoop(/*blocking=*/false).ioc, a);
+  EXPECT_EQ(AcquireClientEventLoop(/*blocking=*/true).ioc, a);
+  {
+    ScopedEventLoopThread current(*b);
+    EXPECT_EQ(AcquireClientEventLoop(/*blocking=*/false).ioc, b);
+    // Waiting in the thread of an event loop must not use any event loop of
+    // the server.
+    EXPECT_EQ(AcquireClientEventLoop(/*blocking=*/true).ioc, fallback);
+  }
+
+  loops.Release();
+  EXPECT_EQ(AcquireClientEventLoop(/*blocking=*/false).ioc, fallback);
+  ScopedEventLoopThread current(*b);
+  EXPECT_EQ(AcquireClientEventLoop(/*blocking=*/false).ioc, fallback);
+}
+
+TEST(ClientEventLoopTest, WorkGuard) {
+  auto ioc = std::make_shared<asio::io_context>();
+  ServerEventLoops loops({ioc});
+  auto loop = AcquireClientEventLoop(/*blocking=*/false);
+  loops.Release();
+  // The call in progress keeps the event loop running.
+  std::promise<void> done;
+  asio::post(*ioc, [&] {
+    done.set_value();
+    loop.work.reset();
+  });
+  ioc->run();
+  done.get_future().get();
+  EXPECT_TRUE(ioc->stopped());
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,107 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/framework.h"
+#include "google/cloud/functions/function.h"
+#include "google/cloud/functions/internal/call_user_cloud_event.h"
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/parallel_batch.h"
+#include <memory>
+#include <utility>
+
+// The Cloud Event functions are created in their own translation unit, so
+// programs that only serve HTTP do not link the Cloud Event parsers, nor
+// their dependencies.
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+Function MakeFunction(UserCloudEventFunction function) {
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::BaseFunctionImpl>(
+          std::move(function)));
+}
+
+Function MakeFunction(UserCloudEventFunction function,
+                      CloudEventBatchOptions options) {
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::BaseFunctionImpl>(
+          std::move(function), options));
+}
+
+Function MakeFunction(UserCloudEventBatchFunction function) {
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::BaseFunctionImpl>(
+          std::move(function)));
+}
+
+Function MakeFunction(UserCloudEventAsyncFunction function) {
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::BaseFunctionImpl>(
+          std::move(function)));
+}
+
+int Run(int argc, char const* const argv[],
+        UserCloudEventFunction handler) noexcept {
+  return Run(argc, argv, MakeFunction(std::move(handler)));
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+BaseFunctionImpl::BaseFunctionImpl(functions::UserCloudEventFunction function)
+    : handler_([fun = std::move(function)](BeastRequest request) {
+        return CallUserFunction(fun, std::move(request));
+      }) {}
+
+BaseFunctionImpl::BaseFunctionImpl(functions::UserCloudEventFunction function,
+                                   functions::CloudEventBatchOptions options)
+    : handler_([runner = std::make_shared<ParallelBatchRunner>(
+                    std::move(function), options)](
+                   BeastRequest request) {
+        return CallUserFunction(*runner, std::move(request));
+      }) {}
+
+BaseFunctionImpl::BaseFunctionImpl(
+    functions::UserCloudEventBatchFunction function)
+    : handler_([fun = std::move(function)](BeastRequest request) {
+        return CallUserFunction(fun, std::move(request));
+      }) {}
+
+BaseFunctionImpl::BaseFunctionImpl(
+    std::shared_ptr<UserCloudEventCallable> function)
+    : handler_([fun = std::move(function)](BeastRequest request) {
+        return CallUserFunction(*fun, std::move(request));
+      }) {}
+
+BaseFunctionImpl::BaseFunctionImpl(
+    functions::UserCloudEventAsyncFunction function)
+    : async_handler_([function = std::move(function)](
+                         BeastRequest request, AsyncResponseCallback done) {
+        CallUserFunction(function, std::move(request), std::move(done));
+      }) {
+  handler_ = MakeBlockingHandler(async_handler_);
+}
+
+functions::Function MakeTypedFunction(
+    std::unique_ptr<UserCloudEventCallable> f) {
+  return FunctionImpl::MakeFunction(
+      std::make_shared<BaseFunctionImpl>(std::shared_ptr(std::move(f))));
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
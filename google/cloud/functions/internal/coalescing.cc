@@ -0,0 +1,147 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/coalescing.h"
+#include <future>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace be = ::boost::beast;
+
+/// The response for the waiters if the shared call throws.
+BeastResponse CoalescedCallError() {
+  BeastResponse response;
+  response.result(be::http::status::internal_server_error);
+  return response;
+}
+
+}  // namespace
+
+CoalescingKey MakeCoalescingKey(std::vector<std::string> headers) {
+  return [headers = std::move(headers)](
+             BeastRequest const& request) -> std::optional<std::string> {
+    auto const method = request.method();
+    if (method != be::http::verb::get && method != be::http::verb::head) {
+      return std::nullopt;
+    }
+    std::string key(request.method_string());
+    key += ' ';
+    key += request.target();
+    // Header values cannot contain newlines, so the key is unambiguous.
+    for (auto const& name : headers) {
+      key += '\n';
+      key += name;
+      key += ':';
+      auto const range = request.equal_range(name);
+      for (auto i = range.first; i != range.second; ++i) {
+        if (i != range.first) key += ',';
+        key += i->value();
+      }
+    }
+    return key;
+  };
+}
+
+bool RequestCoalescer::Join(std::string const& key,
+                            AsyncResponseCallback done) {
+  std::lock_guard<std::mutex> lk(mu_);
+  auto [i, inserted] = calls_.try_emplace(key);
+  i->second.push_back(std::move(done));
+  return inserted;
+}
+
+void RequestCoalescer::Complete(std::string const& key,
+                                BeastResponse response) {
+  std::vector<AsyncResponseCallback> waiters;
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    auto i = calls_.find(key);
+    if (i == calls_.end()) return;
+    waiters = std::move(i->second);
+    calls_.erase(i);
+  }
+  if (waiters.size() > 1 && !response.body().file() &&
+      !response.body().shared()) {
+    // The copies share the payload, instead of copying it.
+    auto payload = std::make_shared<std::string const>(
+        std::move(response.body()).str());
+    response.body().set_shared(std::move(payload));
+  }
+  for (std::size_t i = 0; i + 1 < waiters.size(); ++i) waiters[i](response);
+  waiters.back()(std::move(response));
+}
+
+std::size_t RequestCoalescer::in_progress() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return calls_.size();
+}
+
+std::size_t RequestCoalescer::waiting() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  std::size_t count = 0;
+  for (auto const& kv : calls_) count += kv.second.size();
+  return count;
+}
+
+Handler MakeCoalescingHandler(Handler handler, CoalescingKey key,
+                              std::shared_ptr<RequestCoalescer> coalescer) {
+  return [handler = std::move(handler), key = std::move(key),
+          coalescer = std::move(coalescer)](BeastRequest request) {
+    auto k = key(request);
+    if (!k) return handler(std::move(request));
+    // The waiters block their thread, as the call would.
+    std::promise<BeastResponse> p;
+    auto f = p.get_future();
+    auto done = [&p](BeastResponse response) {
+      p.set_value(std::move(response));
+    };
+    if (coalescer->Join(*k, std::move(done))) {
+      auto response = [&] {
+        try {
+          return handler(std::move(request));
+        } catch (...) {
+          return CoalescedCallError();
+        }
+      }();
+      coalescer->Complete(*k, std::move(response));
+    }
+    return f.get();
+  };
+}
+
+AsyncHandler MakeCoalescingAsyncHandler(
+    AsyncHandler handler, CoalescingKey key,
+    std::shared_ptr<RequestCoalescer> coalescer) {
+  return [handler = std::move(handler), key = std::move(key),
+          coalescer = std::move(coalescer)](BeastRequest request,
+                                            AsyncResponseCallback done) {
+    auto k = key(request);
+    if (!k) return handler(std::move(request), std::move(done));
+    if (!coalescer->Join(*k, std::move(done))) return;
+    try {
+      handler(std::move(request),
+              [coalescer, k = *k](BeastResponse response) {
+                coalescer->Complete(k, std::move(response));
+              });
+    } catch (...) {
+      coalescer->Complete(*k, CoalescedCallError());
+    }
+  };
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,89 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_COALESCING_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_COALESCING_H
+
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/version.h"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// Returns the key of a request, or an empty optional to run it on its own.
+using CoalescingKey =
+    std::function<std::optional<std::string>(BeastRequest const&)>;
+
+/**
+ * Returns the default key: the method, the target, and the values of the
+ * @p headers.
+ *
+ * Only `GET` and `HEAD` requests get a key.
+ */
+CoalescingKey MakeCoalescingKey(std::vector<std::string> headers);
+
+/**
+ * The calls in progress for a function, see `functions::WithCoalescing()`.
+ *
+ * Each call has a key, and the callbacks of all the requests waiting for it.
+ */
+class RequestCoalescer {
+ public:
+  /**
+   * Joins the call for @p key, or starts it if there is none.
+   *
+   * Returns `true` if the caller must run the call, and then `Complete()` it.
+   * Otherwise @p done is called with the response of the call in progress.
+   */
+  bool Join(std::string const& key, AsyncResponseCallback done);
+
+  /// Calls all the callbacks waiting for @p key with @p response.
+  void Complete(std::string const& key, BeastResponse response);
+
+  /// The number of calls in progress.
+  [[nodiscard]] std::size_t in_progress() const;
+
+  /// The number of requests waiting for the calls in progress.
+  [[nodiscard]] std::size_t waiting() const;
+
+ private:
+  mutable std::mutex mu_;
+  std::unordered_map<std::string, std::vector<AsyncResponseCallback>> calls_;
+};
+
+/**
+ * Returns handlers that share one call of @p handler between the requests with
+ * the same key, while that call is in progress.
+ *
+ * Requests without a key call @p handler directly.
+ */
+Handler MakeCoalescingHandler(Handler handler, CoalescingKey key,
+                              std::shared_ptr<RequestCoalescer> coalescer);
+AsyncHandler MakeCoalescingAsyncHandler(
+    AsyncHandler handler, CoalescingKey key,
+    std::shared_ptr<RequestCoalescer> coalescer);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_COALESCING_H
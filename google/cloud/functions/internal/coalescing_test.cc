@@ -0,0 +1,173 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/coalescing.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace http = ::boost::beast::http;
+
+BeastRequest MakeRequest(http::verb verb, std::string target) {
+  BeastRequest request;
+  request.method(verb);
+  request.target(std::move(target));
+  return request;
+}
+
+TEST(CoalescingTest, Key) {
+  auto key = MakeCoalescingKey({"accept"});
+  auto request = MakeRequest(http::verb::get, "/a?b=c");
+  EXPECT_EQ(key(request).value_or(""), "GET /a?b=c\naccept:");
+  request.insert("Accept", "text/html");
+  request.insert("Accept", "text/plain");
+  request.set("x-other", "ignored");
+  EXPECT_EQ(key(request).value_or(""),
+            "GET /a?b=c\naccept:text/html,text/plain");
+  request.method(http::verb::head);
+  EXPECT_EQ(key(request).value_or(""),
+            "HEAD /a?b=c\naccept:text/html,text/plain");
+
+  for (auto verb : {http::verb::post, http::verb::put, http::verb::delete_}) {
+    EXPECT_FALSE(key(MakeRequest(verb, "/a")).has_value());
+  }
+}
+
+TEST(CoalescingTest, Coalescer) {
+  RequestCoalescer coalescer;
+  std::vector<std::string> responses;
+  auto done = [&responses](BeastResponse r) {
+    responses.push_back(std::string(r.body().str()));
+  };
+  EXPECT_TRUE(coalescer.Join("a", done));
+  EXPECT_FALSE(coalescer.Join("a", done));
+  EXPECT_TRUE(coalescer.Join("b", done));
+  EXPECT_EQ(coalescer.in_progress(), 2);
+  EXPECT_EQ(coalescer.waiting(), 3);
+
+  BeastResponse response;
+  response.body() = std::string("payload-a");
+  coalescer.Complete("a", response);
+  EXPECT_THAT(responses, ::testing::ElementsAre("payload-a", "payload-a"));
+  EXPECT_EQ(coalescer.in_progress(), 1);
+
+  // The next request for "a" starts a new call.
+  EXPECT_TRUE(coalescer.Join("a", done));
+}
+
+TEST(CoalescingTest, SharesPayload) {
+  RequestCoalescer coalescer;
+  std::vector<BeastResponse> responses;
+  auto done = [&responses](BeastResponse r) {
+    responses.push_back(std::move(r));
+  };
+  ASSERT_TRUE(coalescer.Join("a", done));
+  ASSERT_FALSE(coalescer.Join("a", done));
+  BeastResponse response;
+  response.body() = std::string("payload");
+  coalescer.Complete("a", std::move(response));
+  ASSERT_EQ(responses.size(), 2);
+  ASSERT_NE(responses[0].body().shared(), nullptr);
+  EXPECT_EQ(responses[0].body().shared(), responses[1].body().shared());
+  EXPECT_EQ(responses[1].body(), "payload");
+}
+
+TEST(CoalescingTest, Handler) {
+  std::atomic<int> calls{0};
+  std::promise<void> started;
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  auto coalescer = std::make_shared<RequestCoalescer>();
+  auto handler = MakeCoalescingHandler(
+      [&](BeastRequest request) {
+        if (++calls == 1) {
+          started.set_value();
+          released.wait();
+        }
+        BeastResponse response;
+        response.body() = std::string(request.target());
+        return response;
+      },
+      MakeCoalescingKey({}), coalescer);
+
+  auto leader = std::async(std::launch::async, [&] {
+    return handler(MakeRequest(http::verb::get, "/a"));
+  });
+  started.get_future().get();
+  auto waiter = std::async(std::launch::async, [&] {
+    return handler(MakeRequest(http::verb::get, "/a"));
+  });
+  // Wait until the second request joins the call in progress.
+  while (coalescer->waiting() != 2) std::this_thread::yield();
+  // Requests with other keys, or without keys, run on their own.
+  EXPECT_EQ(handler(MakeRequest(http::verb::get, "/b")).body(), "/b");
+  EXPECT_EQ(handler(MakeRequest(http::verb::post, "/a")).body(), "/a");
+  EXPECT_EQ(calls.load(), 3);
+
+  release.set_value();
+  EXPECT_EQ(leader.get().body(), "/a");
+  EXPECT_EQ(waiter.get().body(), "/a");
+  EXPECT_EQ(calls.load(), 3);
+  EXPECT_EQ(coalescer->in_progress(), 0);
+}
+
+TEST(CoalescingTest, HandlerThrows) {
+  auto coalescer = std::make_shared<RequestCoalescer>();
+  auto handler = MakeCoalescingHandler(
+      [](BeastRequest const&) -> BeastResponse {
+        throw std::runtime_error("testing");
+      },
+      MakeCoalescingKey({}), coalescer);
+  auto response = handler(MakeRequest(http::verb::get, "/a"));
+  EXPECT_EQ(response.result(), http::status::internal_server_error);
+  EXPECT_EQ(coalescer->in_progress(), 0);
+}
+
+TEST(CoalescingTest, AsyncHandler) {
+  std::vector<AsyncResponseCallback> pending;
+  auto coalescer = std::make_shared<RequestCoalescer>();
+  auto handler = MakeCoalescingAsyncHandler(
+      [&pending](BeastRequest const&, AsyncResponseCallback done) {
+        pending.push_back(std::move(done));
+      },
+      MakeCoalescingKey({}), coalescer);
+
+  std::vector<std::string> responses;
+  auto done = [&responses](BeastResponse r) {
+    responses.push_back(std::string(r.body().str()));
+  };
+  for (int i = 0; i != 3; ++i) {
+    handler(MakeRequest(http::verb::get, "/a"), done);
+  }
+  ASSERT_EQ(pending.size(), 1);
+  EXPECT_TRUE(responses.empty());
+
+  BeastResponse response;
+  response.body() = std::string("payload");
+  pending[0](std::move(response));
+  EXPECT_THAT(responses, ::testing::ElementsAre("payload", "payload",
+                                                "payload"));
+  EXPECT_EQ(coalescer->in_progress(), 0);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
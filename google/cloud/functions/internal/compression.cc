@@ -0,0 +1,708 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/compression.h"
+#include <boost/beast/http.hpp>
+#include <zlib.h>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#ifdef FUNCTIONS_FRAMEWORK_CPP_HAVE_BROTLI
+#include <brotli/decode.h>
+#include <brotli/encode.h>
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_BROTLI
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace be = ::boost::beast;
+
+bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+  return a.size() == b.size() &&
+         std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+           return std::tolower(static_cast<unsigned char>(x)) ==
+                  std::tolower(static_cast<unsigned char>(y));
+         });
+}
+
+std::string_view Trim(std::string_view s) {
+  auto const b = s.find_first_not_of(" \t");
+  if (b == std::string_view::npos) return {};
+  auto const e = s.find_last_not_of(" \t");
+  return s.substr(b, e - b + 1);
+}
+
+/// Parses the quality value in @p params, e.g. `;q=0.5`, as thousandths.
+int ParseQuality(std::string_view params) {
+  auto constexpr kMaxQuality = 1000;
+  while (!params.empty()) {
+    auto const next = params.find(';', 1);
+    auto const param = Trim(params.substr(1, next - 1));
+    params = next == std::string_view::npos ? std::string_view{}
+                                            : params.substr(next);
+    if (param.size() < 2 || std::tolower(param[0]) != 'q' || param[1] != '=') {
+      continue;
+    }
+    // The value is `0`, `1`, or has at most three decimals, e.g. `0.125`.
+    auto const value = param.substr(2);
+    if (value.empty() || (value[0] != '0' && value[0] != '1')) return 0;
+    auto quality = (value[0] - '0') * kMaxQuality;
+    auto scale = kMaxQuality / 10;
+    for (auto c : value.substr(std::min<std::size_t>(2, value.size()))) {
+      if (!std::isdigit(static_cast<unsigned char>(c)) || scale == 0) break;
+      quality += (c - '0') * scale;
+      scale /= 10;
+    }
+    return std::min(quality, kMaxQuality);
+  }
+  return kMaxQuality;
+}
+
+bool IsSupported(ContentEncoding encoding) {
+#ifndef FUNCTIONS_FRAMEWORK_CPP_HAVE_BROTLI
+  if (encoding == ContentEncoding::kBrotli) return false;
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_BROTLI
+  return encoding != ContentEncoding::kIdentity;
+}
+
+/// Compresses with zlib, using the gzip or zlib (`deflate`) format.
+class ZlibCompressor : public Compressor {
+ public:
+  explicit ZlibCompressor(int window_bits) {
+    auto constexpr kMemLevel = 8;
+    if (deflateInit2(&stream_, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits,
+                     kMemLevel, Z_DEFAULT_STRATEGY) != Z_OK) {
+      throw std::runtime_error("cannot initialize zlib");
+    }
+  }
+  ~ZlibCompressor() override { deflateEnd(&stream_); }
+
+  ZlibCompressor(ZlibCompressor const&) = delete;
+  ZlibCompressor& operator=(ZlibCompressor const&) = delete;
+
+  std::string Compress(std::string_view data, bool finish) override {
+    std::string out;
+    auto const flush = finish ? Z_FINISH : Z_SYNC_FLUSH;
+    // zlib counts the input with `uInt`, larger inputs are split.
+    auto constexpr kMaxInput = std::size_t{1} << 30;
+    do {
+      auto const input = data.substr(0, kMaxInput);
+      data.remove_prefix(input.size());
+      // zlib's API is not const-correct, it never modifies the input.
+      stream_.next_in =
+          reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+      stream_.avail_in = static_cast<uInt>(input.size());
+      auto const bound = static_cast<std::size_t>(
+          deflateBound(&stream_, static_cast<uLong>(input.size())));
+      auto const last = data.empty();
+      int rc;
+      do {
+        auto const offset = out.size();
+        out.resize(offset + bound);
+        stream_.next_out = reinterpret_cast<Bytef*>(out.data() + offset);
+        stream_.avail_out = static_cast<uInt>(bound);
+        rc = deflate(&stream_, last ? flush : Z_NO_FLUSH);
+        out.resize(offset + bound - stream_.avail_out);
+        if (rc == Z_STREAM_ERROR) throw std::runtime_error("zlib error");
+      } while (stream_.avail_out == 0 || stream_.avail_in != 0);
+    } while (!data.empty());
+    return out;
+  }
+
+ private:
+  z_stream stream_{};
+};
+
+#ifdef FUNCTIONS_FRAMEWORK_CPP_HAVE_BROTLI
+class BrotliCompressor : public Compressor {
+ public:
+  BrotliCompressor()
+      : state_(BrotliEncoderCreateInstance(nullptr, nullptr, nullptr)) {
+    if (state_ == nullptr) throw std::runtime_error("cannot initialize brotli");
+    // The default quality (11) is meant for static content, it is too slow
+    // for responses compressed on the fly.
+    auto constexpr kQuality = 5;
+    BrotliEncoderSetParameter(state_, BROTLI_PARAM_QUALITY, kQuality);
+  }
+  ~BrotliCompressor() override { BrotliEncoderDestroyInstance(state_); }
+
+  BrotliCompressor(BrotliCompressor const&) = delete;
+  BrotliCompressor& operator=(BrotliCompressor const&) = delete;
+
+  std::string Compress(std::string_view data, bool finish) override {
+    std::string out;
+    auto const op = finish ? BROTLI_OPERATION_FINISH : BROTLI_OPERATION_FLUSH;
+    auto available_in = data.size();
+    auto const* next_in = reinterpret_cast<std::uint8_t const*>(data.data());
+    do {
+      std::size_t available_out = 0;
+      if (!BrotliEncoderCompressStream(state_, op, &available_in, &next_in,
+                                       &available_out, nullptr, nullptr)) {
+        throw std::runtime_error("brotli error");
+      }
+      std::size_t size = 0;
+      auto const* output = BrotliEncoderTakeOutput(state_, &size);
+      out.append(reinterpret_cast<char const*>(output), size);
+    } while (available_in != 0 || BrotliEncoderHasMoreOutput(state_) ||
+             (finish && !BrotliEncoderIsFinished(state_)));
+    return out;
+  }
+
+ private:
+  BrotliEncoderState* state_;
+};
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_BROTLI
+
+/// Decompresses with zlib, for the gzip, zlib, and raw deflate formats.
+class ZlibDecompressor : public Decompressor {
+ public:
+  explicit ZlibDecompressor(ContentEncoding encoding) : encoding_(encoding) {}
+  ~ZlibDecompressor() override {
+    if (initialized_) inflateEnd(&stream_);
+  }
+
+  ZlibDecompressor(ZlibDecompressor const&) = delete;
+  ZlibDecompressor& operator=(ZlibDecompressor const&) = delete;
+
+  std::size_t Decompress(std::string_view& input, char* data,
+                         std::size_t size) override {
+    if (done_ || (input.empty() && !initialized_)) return 0;
+    if (!initialized_) Initialize(input);
+    auto constexpr kMaxSize = std::size_t{1} << 30;
+    auto const in = input.substr(0, kMaxSize);
+    stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    stream_.avail_in = static_cast<uInt>(in.size());
+    stream_.next_out = reinterpret_cast<Bytef*>(data);
+    stream_.avail_out = static_cast<uInt>(std::min(size, kMaxSize));
+    auto const available = stream_.avail_out;
+    auto const rc = inflate(&stream_, Z_NO_FLUSH);
+    input.remove_prefix(in.size() - stream_.avail_in);
+    if (rc == Z_STREAM_END) done_ = true;
+    if (rc != Z_OK && rc != Z_STREAM_END && rc != Z_BUF_ERROR) {
+      throw std::runtime_error("invalid compressed data");
+    }
+    return available - stream_.avail_out;
+  }
+
+  [[nodiscard]] bool done() const override { return done_; }
+
+ private:
+  void Initialize(std::string_view input) {
+    // See the documentation for `inflateInit2()`. Adding 32 detects the gzip
+    // and zlib formats, negative values select raw deflate data.
+    auto constexpr kWindowBits = 15;
+    auto constexpr kAutoDetect = 32;
+    auto bits = kWindowBits + kAutoDetect;
+    // `deflate` should use the zlib format, but some clients send raw
+    // deflate data. The zlib format starts with a 2-byte checksummed header.
+    if (encoding_ == ContentEncoding::kDeflate && input.size() >= 2) {
+      auto const cmf = static_cast<unsigned char>(input[0]);
+      auto const flg = static_cast<unsigned char>(input[1]);
+      auto constexpr kDeflated = 8;
+      auto constexpr kCheck = 31;
+      if ((cmf & 0x0F) != kDeflated || (cmf * 256 + flg) % kCheck != 0) {
+        bits = -kWindowBits;
+      }
+    }
+    if (inflateInit2(&stream_, bits) != Z_OK) {
+      throw std::runtime_error("cannot initialize zlib");
+    }
+    initialized_ = true;
+  }
+
+  ContentEncoding encoding_;
+  z_stream stream_{};
+  bool initialized_ = false;
+  bool done_ = false;
+};
+
+#ifdef FUNCTIONS_FRAMEWORK_CPP_HAVE_BROTLI
+class BrotliDecompressor : public Decompressor {
+ public:
+  BrotliDecompressor()
+      : state_(BrotliDecoderCreateInstance(nullptr, nullptr, nullptr)) {
+    if (state_ == nullptr) throw std::runtime_error("cannot initialize brotli");
+  }
+  ~BrotliDecompressor() override { BrotliDecoderDestroyInstance(state_); }
+
+  BrotliDecompressor(BrotliDecompressor const&) = delete;
+  BrotliDecompressor& operator=(BrotliDecompressor const&) = delete;
+
+  std::size_t Decompress(std::string_view& input, char* data,
+                         std::size_t size) override {
+    if (done_) return 0;
+    auto available_in = input.size();
+    auto const* next_in = reinterpret_cast<std::uint8_t const*>(input.data());
+    auto available_out = size;
+    auto* next_out = reinterpret_cast<std::uint8_t*>(data);
+    auto const rc = BrotliDecoderDecompressStream(
+        state_, &available_in, &next_in, &available_out, &next_out, nullptr);
+    input.remove_prefix(input.size() - available_in);
+    if (rc == BROTLI_DECODER_RESULT_ERROR) {
+      throw std::runtime_error("invalid compressed data");
+    }
+    if (rc == BROTLI_DECODER_RESULT_SUCCESS) done_ = true;
+    return size - available_out;
+  }
+
+  [[nodiscard]] bool done() const override { return done_; }
+
+ private:
+  BrotliDecoderState* state_;
+  bool done_ = false;
+};
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_BROTLI
+
+/// Decompresses the request body as the function reads it.
+class DecompressingReader : public functions::HttpRequestBodyReader {
+ public:
+  DecompressingReader(functions::HttpRequestBodyReader& impl,
+                      ContentEncoding encoding, std::size_t max_size)
+      : impl_(impl),
+        decompressor_(MakeDecompressor(encoding)),
+        max_size_(max_size) {}
+
+  std::size_t Read(char* data, std::size_t size) override {
+    while (!decompressor_->done()) {
+      if (input_.empty()) {
+        auto const n = impl_.Read(buffer_.data(), buffer_.size());
+        if (n == 0) throw std::runtime_error("truncated compressed data");
+        input_ = std::string_view(buffer_.data(), n);
+      }
+      auto const n = decompressor_->Decompress(input_, data, size);
+      total_ += n;
+      if (total_ > max_size_) {
+        throw std::length_error("the decompressed request body is too large");
+      }
+      if (n != 0) return n;
+    }
+    return 0;
+  }
+
+ private:
+  functions::HttpRequestBodyReader& impl_;
+  std::unique_ptr<Decompressor> decompressor_;
+  std::size_t max_size_;
+  std::array<char, 16 * 1024> buffer_{};
+  std::string_view input_;
+  std::size_t total_ = 0;
+};
+
+/// The checksums sent by the client describe the compressed body.
+void EraseBodyChecksums(BeastRequest& request) {
+  request.erase(be::http::field::content_md5);
+  request.erase("x-goog-hash");
+}
+
+BeastResponse RequestError(be::http::status status, std::string_view what) {
+  BeastResponse response;
+  response.result(status);
+  response.set(be::http::field::content_type, "text/plain");
+  response.body() = std::string(what);
+  return response;
+}
+
+/**
+ * Decompresses the body of @p request in place.
+ *
+ * Returns an error response if the request cannot be decompressed.
+ */
+std::optional<BeastResponse> DecompressRequest(
+    BeastRequest& request, DecompressionOptions const& options) {
+  auto const value = request[be::http::field::content_encoding];
+  if (value.empty()) return std::nullopt;
+  auto const encoding = ParseContentEncoding(value);
+  if (!encoding) {
+    return RequestError(be::http::status::unsupported_media_type,
+                        "unsupported content encoding");
+  }
+  if (*encoding != ContentEncoding::kIdentity) {
+    try {
+      request.body() =
+          DecompressBody(*encoding, request.body(), options.max_size);
+    } catch (std::length_error const& ex) {
+      return RequestError(be::http::status::payload_too_large, ex.what());
+    } catch (std::exception const& ex) {
+      return RequestError(be::http::status::bad_request, ex.what());
+    }
+    EraseBodyChecksums(request);
+  }
+  request.erase(be::http::field::content_encoding);
+  request.content_length(request.body().size());
+  return std::nullopt;
+}
+
+/// Returns `true` if the response in @p header may be compressed.
+bool CanCompress(be::http::response_header<> const& header) {
+  auto const status = header.result_int();
+  auto constexpr kNoContent = 204;
+  auto constexpr kPartialContent = 206;
+  auto constexpr kNotModified = 304;
+  // The `Content-Range` of partial responses refers to the unencoded bytes.
+  if (status < 200 || status == kNoContent || status == kPartialContent ||
+      status == kNotModified) {
+    return false;
+  }
+  if (header.find(be::http::field::content_encoding) != header.end()) {
+    return false;
+  }
+  if (be::http::token_list{header[be::http::field::cache_control]}.exists(
+          "no-transform")) {
+    return false;
+  }
+  return IsCompressible(header[be::http::field::content_type]);
+}
+
+/// Marks @p header as depending on `Accept-Encoding`, for caches.
+void AddVary(be::http::response_header<>& header) {
+  auto const vary = header[be::http::field::vary];
+  if (be::http::token_list{vary}.exists("accept-encoding") ||
+      Trim(vary) == "*") {
+    return;
+  }
+  if (vary.empty()) return header.set(be::http::field::vary, "Accept-Encoding");
+  header.set(be::http::field::vary, std::string(vary) + ", Accept-Encoding");
+}
+
+void MarkEncoded(ContentEncoding encoding,
+                 be::http::response_header<>& header) {
+  header.set(be::http::field::content_encoding, ToString(encoding));
+  // Any validator describes the identity encoding.
+  header.erase(be::http::field::content_md5);
+  auto const etag = header[be::http::field::etag];
+  if (!etag.empty() && etag.front() == '"') {
+    header.set(be::http::field::etag, "W/" + std::string(etag));
+  }
+}
+
+/// Compresses the body of a streaming response as it is written.
+class CompressingResponseWriter : public ResponseWriter {
+ public:
+  CompressingResponseWriter(ResponseWriter& impl, ContentEncoding encoding)
+      : impl_(impl), encoding_(encoding) {}
+
+  void WriteHeader(BeastResponse header) override {
+    if (encoding_ != ContentEncoding::kIdentity && CanCompress(header)) {
+      compressor_ = MakeCompressor(encoding_);
+      MarkEncoded(encoding_, header);
+      header.erase(be::http::field::content_length);
+      header.body() = compressor_->Compress(header.body().str(), false);
+    }
+    if (CanCompress(header) || compressor_) AddVary(header);
+    impl_.WriteHeader(std::move(header));
+  }
+
+  void Write(std::string_view data) override {
+    if (!compressor_) return impl_.Write(data);
+    impl_.Write(compressor_->Compress(data, false));
+  }
+
+  /// The heartbeats would corrupt a compressed stream.
+  void SetHeartbeat(std::string_view data,
+                    std::chrono::milliseconds interval) override {
+    if (!compressor_) impl_.SetHeartbeat(data, interval);
+  }
+
+  /// Sends the end of the compressed stream.
+  void Finish() {
+    if (compressor_) impl_.Write(compressor_->Compress({}, true));
+  }
+
+ private:
+  ResponseWriter& impl_;
+  ContentEncoding encoding_;
+  std::unique_ptr<Compressor> compressor_;
+};
+
+}  // namespace
+
+std::string_view ToString(ContentEncoding encoding) {
+  switch (encoding) {
+    case ContentEncoding::kGzip:
+      return "gzip";
+    case ContentEncoding::kDeflate:
+      return "deflate";
+    case ContentEncoding::kBrotli:
+      return "br";
+    case ContentEncoding::kIdentity:
+      break;
+  }
+  return "identity";
+}
+
+ContentEncoding NegotiateEncoding(std::string_view accept_encoding) {
+  // In order of preference for equal quality values.
+  std::array<ContentEncoding, 3> const candidates{ContentEncoding::kBrotli,
+                                                  ContentEncoding::kGzip,
+                                                  ContentEncoding::kDeflate};
+  std::array<int, 3> quality{-1, -1, -1};
+  auto wildcard = -1;
+  while (!accept_encoding.empty()) {
+    auto const next = accept_encoding.find(',');
+    auto const item = accept_encoding.substr(0, next);
+    accept_encoding = next == std::string_view::npos
+                          ? std::string_view{}
+                          : accept_encoding.substr(next + 1);
+    auto const semicolon = item.find(';');
+    auto const coding = Trim(item.substr(0, semicolon));
+    auto const q = semicolon == std::string_view::npos
+                       ? ParseQuality({})
+                       : ParseQuality(item.substr(semicolon));
+    if (coding == "*") wildcard = q;
+    for (std::size_t i = 0; i != candidates.size(); ++i) {
+      // `x-gzip` is an alias for `gzip`, see RFC 9110.
+      if (EqualsIgnoreCase(coding, ToString(candidates[i])) ||
+          (candidates[i] == ContentEncoding::kGzip &&
+           EqualsIgnoreCase(coding, "x-gzip"))) {
+        quality[i] = q;
+      }
+    }
+  }
+  auto best = ContentEncoding::kIdentity;
+  auto best_quality = 0;
+  for (std::size_t i = 0; i != candidates.size(); ++i) {
+    if (!IsSupported(candidates[i])) continue;
+    auto const q = quality[i] < 0 ? wildcard : quality[i];
+    if (q > best_quality) {
+      best = candidates[i];
+      best_quality = q;
+    }
+  }
+  return best;
+}
+
+bool IsCompressible(std::string_view content_type) {
+  auto const media_type = Trim(content_type.substr(0, content_type.find(';')));
+  if (media_type.empty()) return false;
+  auto const slash = media_type.find('/');
+  if (slash == std::string_view::npos) return false;
+  auto const type = media_type.substr(0, slash);
+  auto const subtype = media_type.substr(slash + 1);
+  if (EqualsIgnoreCase(type, "text")) return true;
+  auto ends_with = [&subtype](std::string_view suffix) {
+    return subtype.size() >= suffix.size() &&
+           EqualsIgnoreCase(subtype.substr(subtype.size() - suffix.size()),
+                            suffix);
+  };
+  if (ends_with("+json") || ends_with("+xml")) return true;
+  if (!EqualsIgnoreCase(type, "application")) {
+    return EqualsIgnoreCase(media_type, "image/svg+xml");
+  }
+  for (auto const* s : {"json", "javascript", "xml", "x-ndjson", "wasm"}) {
+    if (EqualsIgnoreCase(subtype, s)) return true;
+  }
+  return false;
+}
+
+std::unique_ptr<Compressor> MakeCompressor(ContentEncoding encoding) {
+  // See the documentation for `deflateInit2()`, adding 16 selects gzip.
+  auto constexpr kWindowBits = 15;
+  auto constexpr kGzip = 16;
+  switch (encoding) {
+    case ContentEncoding::kGzip:
+      return std::make_unique<ZlibCompressor>(kWindowBits + kGzip);
+    case ContentEncoding::kDeflate:
+      return std::make_unique<ZlibCompressor>(kWindowBits);
+    case ContentEncoding::kBrotli:
+#ifdef FUNCTIONS_FRAMEWORK_CPP_HAVE_BROTLI
+      return std::make_unique<BrotliCompressor>();
+#else
+      break;
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_BROTLI
+    case ContentEncoding::kIdentity:
+      break;
+  }
+  throw std::invalid_argument("unsupported content encoding " +
+                              std::string(ToString(encoding)));
+}
+
+void CompressResponse(ContentEncoding encoding,
+                      CompressionOptions const& options,
+                      BeastResponse& response) {
+  if (!CanCompress(response)) return;
+  AddVary(response);
+  auto& body = response.body();
+  if (encoding == ContentEncoding::kIdentity || body.file() != nullptr ||
+      body.size() < options.min_size) {
+    return;
+  }
+  auto compressed = MakeCompressor(encoding)->Compress(body.str(), true);
+  // Some payloads, e.g. already compressed data, do not get smaller.
+  if (compressed.size() >= body.size()) return;
+  body = std::move(compressed);
+  MarkEncoded(encoding, response);
+  response.content_length(body.size());
+}
+
+Handler MakeCompressionHandler(Handler handler, CompressionOptions options) {
+  return [h = std::move(handler), options](BeastRequest request) {
+    auto const encoding =
+        NegotiateEncoding(request[be::http::field::accept_encoding]);
+    auto response = h(std::move(request));
+    CompressResponse(encoding, options, response);
+    return response;
+  };
+}
+
+StreamingHandler MakeCompressionStreamingHandler(StreamingHandler handler,
+                                                 CompressionOptions options) {
+  return [h = std::move(handler), options](
+             BeastRequest request, functions::HttpRequestBodyReader& reader) {
+    auto const encoding =
+        NegotiateEncoding(request[be::http::field::accept_encoding]);
+    auto response = h(std::move(request), reader);
+    CompressResponse(encoding, options, response);
+    return response;
+  };
+}
+
+WriterHandler MakeCompressionWriterHandler(WriterHandler handler) {
+  return [h = std::move(handler)](BeastRequest request,
+                                  ResponseWriter& writer) {
+    CompressingResponseWriter compressing(
+        writer, NegotiateEncoding(request[be::http::field::accept_encoding]));
+    if (!h(std::move(request), compressing)) return false;
+    compressing.Finish();
+    return true;
+  };
+}
+
+AsyncHandler MakeCompressionAsyncHandler(AsyncHandler handler,
+                                         CompressionOptions options) {
+  return [h = std::move(handler), options](BeastRequest request,
+                                           AsyncResponseCallback done) {
+    auto const encoding =
+        NegotiateEncoding(request[be::http::field::accept_encoding]);
+    h(std::move(request), [encoding, options, done = std::move(done)](
+                              BeastResponse response) {
+      CompressResponse(encoding, options, response);
+      done(std::move(response));
+    });
+  };
+}
+
+std::optional<ContentEncoding> ParseContentEncoding(std::string_view value) {
+  auto const coding = Trim(value);
+  if (EqualsIgnoreCase(coding, "identity")) return ContentEncoding::kIdentity;
+  for (auto e : {ContentEncoding::kGzip, ContentEncoding::kDeflate,
+                 ContentEncoding::kBrotli}) {
+    if (IsSupported(e) && EqualsIgnoreCase(coding, ToString(e))) return e;
+  }
+  if (EqualsIgnoreCase(coding, "x-gzip")) return ContentEncoding::kGzip;
+  return std::nullopt;
+}
+
+std::unique_ptr<Decompressor> MakeDecompressor(ContentEncoding encoding) {
+  switch (encoding) {
+    case ContentEncoding::kGzip:
+    case ContentEncoding::kDeflate:
+      return std::make_unique<ZlibDecompressor>(encoding);
+    case ContentEncoding::kBrotli:
+#ifdef FUNCTIONS_FRAMEWORK_CPP_HAVE_BROTLI
+      return std::make_unique<BrotliDecompressor>();
+#else
+      break;
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_BROTLI
+    case ContentEncoding::kIdentity:
+      break;
+  }
+  throw std::invalid_argument("unsupported content encoding " +
+                              std::string(ToString(encoding)));
+}
+
+std::string DecompressBody(ContentEncoding encoding, std::string_view body,
+                           std::size_t max_size) {
+  auto decompressor = MakeDecompressor(encoding);
+  auto constexpr kMinChunk = std::size_t{16 * 1024};
+  std::string out;
+  while (!decompressor->done()) {
+    auto const offset = out.size();
+    // Grow the output geometrically, but never past the limit (plus one byte
+    // to detect larger outputs).
+    auto const chunk =
+        std::min(std::max({kMinChunk, offset, 4 * body.size()}),
+                 max_size + 1 - offset);
+    out.resize(offset + chunk);
+    auto const n = decompressor->Decompress(body, out.data() + offset, chunk);
+    out.resize(offset + n);
+    if (out.size() > max_size) {
+      throw std::length_error("the decompressed request body is too large");
+    }
+    if (n == 0 && body.empty() && !decompressor->done()) {
+      throw std::runtime_error("truncated compressed data");
+    }
+  }
+  return out;
+}
+
+Handler MakeDecompressionHandler(Handler handler,
+                                 DecompressionOptions options) {
+  return [h = std::move(handler), options](BeastRequest request) {
+    if (auto error = DecompressRequest(request, options)) return *error;
+    return h(std::move(request));
+  };
+}
+
+StreamingHandler MakeDecompressionStreamingHandler(
+    StreamingHandler handler, DecompressionOptions options) {
+  return [h = std::move(handler), options](
+             BeastRequest request, functions::HttpRequestBodyReader& reader) {
+    auto const value = request[be::http::field::content_encoding];
+    if (value.empty()) return h(std::move(request), reader);
+    auto const encoding = ParseContentEncoding(value);
+    if (!encoding) {
+      return RequestError(be::http::status::unsupported_media_type,
+                          "unsupported content encoding");
+    }
+    request.erase(be::http::field::content_encoding);
+    // The decompressed size is not known until the body is consumed.
+    request.erase(be::http::field::content_length);
+    if (*encoding == ContentEncoding::kIdentity) {
+      return h(std::move(request), reader);
+    }
+    EraseBodyChecksums(request);
+    DecompressingReader decompressing(reader, *encoding, options.max_size);
+    return h(std::move(request), decompressing);
+  };
+}
+
+WriterHandler MakeDecompressionWriterHandler(WriterHandler handler,
+                                             DecompressionOptions options) {
+  return [h = std::move(handler), options](BeastRequest request,
+                                           ResponseWriter& writer) {
+    if (auto error = DecompressRequest(request, options)) {
+      writer.WriteHeader(*std::move(error));
+      return true;
+    }
+    return h(std::move(request), writer);
+  };
+}
+
+AsyncHandler MakeDecompressionAsyncHandler(AsyncHandler handler,
+                                           DecompressionOptions options) {
+  return [h = std::move(handler), options](BeastRequest request,
+                                           AsyncResponseCallback done) {
+    if (auto error = DecompressRequest(request, options)) {
+      return done(*std::move(error));
+    }
+    h(std::move(request), std::move(done));
+  };
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,160 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_COMPRESSION_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_COMPRESSION_H
+
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/version.h"
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// The content codings supported for requests and responses.
+enum class ContentEncoding { kIdentity, kGzip, kDeflate, kBrotli };
+
+/// The name of @p encoding in the `Content-Encoding` header.
+std::string_view ToString(ContentEncoding encoding);
+
+/// The configuration for response compression.
+struct CompressionOptions {
+  /// Buffered responses smaller than this are sent uncompressed.
+  std::size_t min_size;
+};
+
+/**
+ * Picks the content coding for a response, given an `Accept-Encoding` value.
+ *
+ * The coding with the highest quality value wins, ties prefer brotli, then
+ * gzip, then deflate. Codings not supported by this build are ignored.
+ */
+ContentEncoding NegotiateEncoding(std::string_view accept_encoding);
+
+/// Returns `true` if responses with @p content_type are worth compressing.
+bool IsCompressible(std::string_view content_type);
+
+/// Incrementally compresses a response body.
+class Compressor {
+ public:
+  virtual ~Compressor() = default;
+
+  /**
+   * Compresses @p data and returns any output available.
+   *
+   * Each call flushes the output, so it can be sent right away. If @p finish
+   * is `true` the output is completed, and the compressor cannot be used
+   * again.
+   */
+  virtual std::string Compress(std::string_view data, bool finish) = 0;
+};
+
+/// Creates a compressor for @p encoding, which must not be `kIdentity`.
+std::unique_ptr<Compressor> MakeCompressor(ContentEncoding encoding);
+
+/**
+ * Compresses the body of a buffered @p response, if it is worth it.
+ *
+ * The response is unchanged if @p encoding is `kIdentity`, if the response is
+ * already encoded, if its body is a file or smaller than the threshold, or if
+ * its content type does not compress well.
+ */
+void CompressResponse(ContentEncoding encoding,
+                      CompressionOptions const& options,
+                      BeastResponse& response);
+
+/// Returns handlers that compress the responses from @p handler.
+Handler MakeCompressionHandler(Handler handler, CompressionOptions options);
+StreamingHandler MakeCompressionStreamingHandler(StreamingHandler handler,
+                                                 CompressionOptions options);
+WriterHandler MakeCompressionWriterHandler(WriterHandler handler);
+AsyncHandler MakeCompressionAsyncHandler(AsyncHandler handler,
+                                         CompressionOptions options);
+
+/// The configuration for request decompression.
+struct DecompressionOptions {
+  /// The maximum size for a decompressed request body, in bytes.
+  std::size_t max_size;
+};
+
+/**
+ * Parses a `Content-Encoding` header value.
+ *
+ * Returns an empty optional if the coding is not supported, including
+ * requests with more than one coding.
+ */
+std::optional<ContentEncoding> ParseContentEncoding(std::string_view value);
+
+/// Incrementally decompresses a request body.
+class Decompressor {
+ public:
+  virtual ~Decompressor() = default;
+
+  /**
+   * Decompresses from @p input into @p data, consuming the input used.
+   *
+   * Returns the number of bytes written, which may be 0 if more input is
+   * needed.
+   *
+   * @throws std::runtime_error if the input is not valid.
+   */
+  virtual std::size_t Decompress(std::string_view& input, char* data,
+                                 std::size_t size) = 0;
+
+  /// Returns `true` once the end of the compressed stream is found.
+  [[nodiscard]] virtual bool done() const = 0;
+};
+
+/// Creates a decompressor for @p encoding, which must not be `kIdentity`.
+std::unique_ptr<Decompressor> MakeDecompressor(ContentEncoding encoding);
+
+/**
+ * Decompresses a complete body.
+ *
+ * @throws std::length_error if the output is larger than @p max_size.
+ * @throws std::runtime_error if @p body is not valid, or is truncated.
+ */
+std::string DecompressBody(ContentEncoding encoding, std::string_view body,
+                           std::size_t max_size);
+
+/**
+ * Returns handlers that decompress the request body before calling
+ * @p handler.
+ *
+ * The handlers remove the `Content-Encoding` header, and set the
+ * `Content-Length` header to the decompressed size. Requests with an
+ * unsupported coding are rejected with `415 Unsupported Media Type`, invalid
+ * bodies with `400 Bad Request`, and bodies over the limit with
+ * `413 Payload Too Large`.
+ *
+ * The streaming handler decompresses the body as the function reads it, the
+ * errors are reported by the reader.
+ */
+Handler MakeDecompressionHandler(Handler handler, DecompressionOptions options);
+StreamingHandler MakeDecompressionStreamingHandler(
+    StreamingHandler handler, DecompressionOptions options);
+WriterHandler MakeDecompressionWriterHandler(WriterHandler handler,
+                                             DecompressionOptions options);
+AsyncHandler MakeDecompressionAsyncHandler(AsyncHandler handler,
+                                           DecompressionOptions options);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_COMPRESSION_H
@@ -0,0 +1,447 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/compression.h"
+#include <boost/beast/http.hpp>
+#include <gmock/gmock.h>
+#include <zlib.h>
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+#ifdef FUNCTIONS_FRAMEWORK_CPP_HAVE_BROTLI
+#include <brotli/decode.h>
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_BROTLI
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace be = ::boost::beast;
+
+std::string Inflate(std::string const& data, ContentEncoding encoding) {
+  // Accept both the gzip and zlib formats, see `inflateInit2()`.
+  auto constexpr kAutoDetect = 15 + 32;
+  z_stream stream{};
+  EXPECT_EQ(inflateInit2(&stream, kAutoDetect), Z_OK);
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = static_cast<uInt>(data.size());
+  std::string out;
+  int rc;
+  do {
+    std::array<char, 4096> buffer;
+    stream.next_out = reinterpret_cast<Bytef*>(buffer.data());
+    stream.avail_out = static_cast<uInt>(buffer.size());
+    rc = inflate(&stream, Z_NO_FLUSH);
+    out.append(buffer.data(), buffer.size() - stream.avail_out);
+  } while (rc == Z_OK);
+  EXPECT_EQ(rc, Z_STREAM_END);
+  inflateEnd(&stream);
+  // The gzip format starts with 0x1f 0x8b.
+  EXPECT_EQ(encoding == ContentEncoding::kGzip, data.rfind("\x1f\x8b", 0) == 0);
+  return out;
+}
+
+std::string Decompress(std::string const& data, ContentEncoding encoding) {
+#ifdef FUNCTIONS_FRAMEWORK_CPP_HAVE_BROTLI
+  if (encoding == ContentEncoding::kBrotli) {
+    std::string out(16 * 1024 * 1024, '\0');
+    auto size = out.size();
+    auto const* input = reinterpret_cast<std::uint8_t const*>(data.data());
+    EXPECT_EQ(BrotliDecoderDecompress(
+                  data.size(), input, &size,
+                  reinterpret_cast<std::uint8_t*>(out.data())),
+              BROTLI_DECODER_RESULT_SUCCESS);
+    out.resize(size);
+    return out;
+  }
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_BROTLI
+  return Inflate(data, encoding);
+}
+
+std::vector<ContentEncoding> SupportedEncodings() {
+  std::vector<ContentEncoding> encodings{ContentEncoding::kGzip,
+                                         ContentEncoding::kDeflate};
+#ifdef FUNCTIONS_FRAMEWORK_CPP_HAVE_BROTLI
+  encodings.push_back(ContentEncoding::kBrotli);
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_BROTLI
+  return encodings;
+}
+
+std::string JsonPayload() {
+  std::string payload = "[";
+  for (int i = 0; i != 10000; ++i) {
+    payload += R"js({"id": )js" + std::to_string(i) + R"js(, "ok": true},)js";
+  }
+  payload += "{}]";
+  return payload;
+}
+
+BeastResponse JsonResponse(std::string payload) {
+  BeastResponse response;
+  response.set(be::http::field::content_type, "application/json");
+  response.body() = std::move(payload);
+  return response;
+}
+
+TEST(CompressionTest, Negotiate) {
+  auto const kBest =
+#ifdef FUNCTIONS_FRAMEWORK_CPP_HAVE_BROTLI
+      ContentEncoding::kBrotli;
+#else
+      ContentEncoding::kGzip;
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_BROTLI
+  EXPECT_EQ(NegotiateEncoding(""), ContentEncoding::kIdentity);
+  EXPECT_EQ(NegotiateEncoding("identity"), ContentEncoding::kIdentity);
+  EXPECT_EQ(NegotiateEncoding("gzip"), ContentEncoding::kGzip);
+  EXPECT_EQ(NegotiateEncoding("GZIP"), ContentEncoding::kGzip);
+  EXPECT_EQ(NegotiateEncoding("x-gzip"), ContentEncoding::kGzip);
+  EXPECT_EQ(NegotiateEncoding("deflate"), ContentEncoding::kDeflate);
+  EXPECT_EQ(NegotiateEncoding("gzip, deflate, br"), kBest);
+  EXPECT_EQ(NegotiateEncoding("*"), kBest);
+  EXPECT_EQ(NegotiateEncoding("deflate, gzip;q=0.5"),
+            ContentEncoding::kDeflate);
+  EXPECT_EQ(NegotiateEncoding("deflate;q=0.4 , gzip ; q=0.5"),
+            ContentEncoding::kGzip);
+  EXPECT_EQ(NegotiateEncoding("gzip;q=0, deflate;q=0.001"),
+            ContentEncoding::kDeflate);
+  EXPECT_EQ(NegotiateEncoding("gzip;q=0"), ContentEncoding::kIdentity);
+  EXPECT_EQ(NegotiateEncoding("*;q=0"), ContentEncoding::kIdentity);
+  EXPECT_EQ(NegotiateEncoding("br;q=0, *"), ContentEncoding::kGzip);
+  EXPECT_EQ(NegotiateEncoding("compress, unknown"), ContentEncoding::kIdentity);
+}
+
+TEST(CompressionTest, IsCompressible) {
+  EXPECT_TRUE(IsCompressible("text/plain"));
+  EXPECT_TRUE(IsCompressible("text/html; charset=utf-8"));
+  EXPECT_TRUE(IsCompressible("application/json"));
+  EXPECT_TRUE(IsCompressible("Application/JSON"));
+  EXPECT_TRUE(IsCompressible("application/cloudevents+json"));
+  EXPECT_TRUE(IsCompressible("application/atom+xml"));
+  EXPECT_TRUE(IsCompressible("application/javascript"));
+  EXPECT_TRUE(IsCompressible("image/svg+xml"));
+  EXPECT_FALSE(IsCompressible(""));
+  EXPECT_FALSE(IsCompressible("text"));
+  EXPECT_FALSE(IsCompressible("image/png"));
+  EXPECT_FALSE(IsCompressible("application/octet-stream"));
+  EXPECT_FALSE(IsCompressible("application/gzip"));
+}
+
+TEST(CompressionTest, RoundTrip) {
+  auto const payload = JsonPayload();
+  for (auto encoding : SupportedEncodings()) {
+    SCOPED_TRACE("encoding=" + std::string(ToString(encoding)));
+    auto response = JsonResponse(payload);
+    response.set(be::http::field::etag, R"("abc")");
+    CompressResponse(encoding, CompressionOptions{1024}, response);
+    EXPECT_EQ(response[be::http::field::content_encoding], ToString(encoding));
+    EXPECT_EQ(response[be::http::field::vary], "Accept-Encoding");
+    EXPECT_EQ(response[be::http::field::etag], R"(W/"abc")");
+    EXPECT_EQ(response[be::http::field::content_length],
+              std::to_string(response.body().size()));
+    EXPECT_LT(response.body().size(), payload.size() / 4);
+    EXPECT_EQ(Decompress(response.body().str(), encoding), payload);
+  }
+}
+
+TEST(CompressionTest, Thresholds) {
+  auto const options = CompressionOptions{1024};
+  auto const payload = JsonPayload();
+
+  auto identity = JsonResponse(payload);
+  CompressResponse(ContentEncoding::kIdentity, options, identity);
+  EXPECT_EQ(identity.count(be::http::field::content_encoding), 0);
+  // The response depends on `Accept-Encoding`, even if it is not compressed.
+  EXPECT_EQ(identity[be::http::field::vary], "Accept-Encoding");
+
+  auto small = JsonResponse(R"js({"small": true})js");
+  CompressResponse(ContentEncoding::kGzip, options, small);
+  EXPECT_EQ(small.count(be::http::field::content_encoding), 0);
+  EXPECT_EQ(small.body(), R"js({"small": true})js");
+
+  auto binary = JsonResponse(payload);
+  binary.set(be::http::field::content_type, "image/png");
+  CompressResponse(ContentEncoding::kGzip, options, binary);
+  EXPECT_EQ(binary.count(be::http::field::content_encoding), 0);
+  EXPECT_EQ(binary.count(be::http::field::vary), 0);
+
+  auto encoded = JsonResponse(payload);
+  encoded.set(be::http::field::content_encoding, "deflate");
+  CompressResponse(ContentEncoding::kGzip, options, encoded);
+  EXPECT_EQ(encoded[be::http::field::content_encoding], "deflate");
+  EXPECT_EQ(encoded.body(), payload);
+
+  auto no_transform = JsonResponse(payload);
+  no_transform.set(be::http::field::cache_control, "public, no-transform");
+  CompressResponse(ContentEncoding::kGzip, options, no_transform);
+  EXPECT_EQ(no_transform.count(be::http::field::content_encoding), 0);
+
+  auto no_content = JsonResponse({});
+  no_content.result(be::http::status::no_content);
+  CompressResponse(ContentEncoding::kGzip, CompressionOptions{0}, no_content);
+  EXPECT_EQ(no_content.count(be::http::field::content_encoding), 0);
+
+  auto partial = JsonResponse(payload);
+  partial.result(be::http::status::partial_content);
+  CompressResponse(ContentEncoding::kGzip, options, partial);
+  EXPECT_EQ(partial.count(be::http::field::content_encoding), 0);
+  EXPECT_EQ(partial.body(), payload);
+
+  auto vary = JsonResponse(payload);
+  vary.set(be::http::field::vary, "Origin");
+  CompressResponse(ContentEncoding::kGzip, options, vary);
+  EXPECT_EQ(vary[be::http::field::vary], "Origin, Accept-Encoding");
+}
+
+class TestWriter : public ResponseWriter {
+ public:
+  void WriteHeader(BeastResponse header) override {
+    body += header.body().str();
+    header.body().clear();
+    this->header = std::move(header);
+  }
+  void Write(std::string_view data) override {
+    body += data;
+    ++writes;
+  }
+
+  BeastResponse header;
+  std::string body;
+  int writes = 0;
+};
+
+TEST(CompressionTest, Streaming) {
+  auto const payload = JsonPayload();
+  auto handler = [&payload](BeastRequest, ResponseWriter& writer) {
+    auto header = JsonResponse(payload.substr(0, 100));
+    header.content_length(payload.size());
+    writer.WriteHeader(std::move(header));
+    for (std::size_t offset = 100; offset < payload.size(); offset += 4096) {
+      writer.Write(std::string_view(payload).substr(offset, 4096));
+    }
+    return true;
+  };
+  for (auto encoding : SupportedEncodings()) {
+    SCOPED_TRACE("encoding=" + std::string(ToString(encoding)));
+    auto wrapped = MakeCompressionWriterHandler(handler);
+    BeastRequest request;
+    request.set(be::http::field::accept_encoding, ToString(encoding));
+    TestWriter writer;
+    EXPECT_TRUE(wrapped(std::move(request), writer));
+    EXPECT_EQ(writer.header[be::http::field::content_encoding],
+              ToString(encoding));
+    // The compressed size is not known in advance.
+    EXPECT_EQ(writer.header.count(be::http::field::content_length), 0);
+    EXPECT_GT(writer.writes, 1);
+    EXPECT_EQ(Decompress(writer.body, encoding), payload);
+  }
+
+  // Without `Accept-Encoding` the response is unchanged.
+  auto wrapped = MakeCompressionWriterHandler(handler);
+  TestWriter writer;
+  EXPECT_TRUE(wrapped(BeastRequest{}, writer));
+  EXPECT_EQ(writer.header.count(be::http::field::content_encoding), 0);
+  EXPECT_EQ(writer.body, payload);
+}
+
+TEST(CompressionTest, Handler) {
+  auto const payload = JsonPayload();
+  auto handler = MakeCompressionHandler(
+      [&payload](BeastRequest) { return JsonResponse(payload); },
+      CompressionOptions{1024});
+  BeastRequest request;
+  request.set(be::http::field::accept_encoding, "gzip");
+  auto response = handler(std::move(request));
+  EXPECT_EQ(response[be::http::field::content_encoding], "gzip");
+  EXPECT_EQ(Decompress(response.body().str(), ContentEncoding::kGzip),
+            payload);
+
+  response = handler(BeastRequest{});
+  EXPECT_EQ(response.count(be::http::field::content_encoding), 0);
+  EXPECT_EQ(response.body(), payload);
+}
+
+std::string Compress(ContentEncoding encoding, std::string_view data) {
+  return MakeCompressor(encoding)->Compress(data, true);
+}
+
+/// Reads a body in small pieces, to exercise the incremental decompression.
+class TestReader : public functions::HttpRequestBodyReader {
+ public:
+  explicit TestReader(std::string body) : body_(std::move(body)) {}
+
+  std::size_t Read(char* data, std::size_t size) override {
+    auto const n = std::min({size, body_.size() - offset_, std::size_t{7}});
+    std::copy_n(body_.data() + offset_, n, data);
+    offset_ += n;
+    return n;
+  }
+
+ private:
+  std::string body_;
+  std::size_t offset_ = 0;
+};
+
+std::string ReadAll(functions::HttpRequestBodyReader& reader) {
+  std::string body;
+  std::array<char, 1000> buffer;
+  for (auto n = reader.Read(buffer.data(), buffer.size()); n != 0;
+       n = reader.Read(buffer.data(), buffer.size())) {
+    body.append(buffer.data(), n);
+  }
+  return body;
+}
+
+TEST(DecompressionTest, ParseContentEncoding) {
+  EXPECT_EQ(ParseContentEncoding("gzip"), ContentEncoding::kGzip);
+  EXPECT_EQ(ParseContentEncoding(" GZip "), ContentEncoding::kGzip);
+  EXPECT_EQ(ParseContentEncoding("x-gzip"), ContentEncoding::kGzip);
+  EXPECT_EQ(ParseContentEncoding("deflate"), ContentEncoding::kDeflate);
+  EXPECT_EQ(ParseContentEncoding("identity"), ContentEncoding::kIdentity);
+  EXPECT_EQ(ParseContentEncoding("compress"), std::nullopt);
+  EXPECT_EQ(ParseContentEncoding("gzip, deflate"), std::nullopt);
+#ifdef FUNCTIONS_FRAMEWORK_CPP_HAVE_BROTLI
+  EXPECT_EQ(ParseContentEncoding("br"), ContentEncoding::kBrotli);
+#else
+  EXPECT_EQ(ParseContentEncoding("br"), std::nullopt);
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_BROTLI
+}
+
+TEST(DecompressionTest, RoundTrip) {
+  auto const payload = JsonPayload();
+  for (auto encoding : SupportedEncodings()) {
+    SCOPED_TRACE("encoding=" + std::string(ToString(encoding)));
+    auto const compressed = Compress(encoding, payload);
+    EXPECT_EQ(DecompressBody(encoding, compressed, payload.size()), payload);
+    EXPECT_THROW(DecompressBody(encoding, compressed, payload.size() - 1),
+                 std::length_error);
+    EXPECT_THROW(DecompressBody(encoding, compressed.substr(0, 100), 1 << 20),
+                 std::runtime_error);
+    EXPECT_THROW(DecompressBody(encoding, "not compressed", 1 << 20),
+                 std::runtime_error);
+    EXPECT_EQ(DecompressBody(encoding, Compress(encoding, ""), 0), "");
+  }
+}
+
+TEST(DecompressionTest, RawDeflate) {
+  // Some clients send raw deflate data, without the zlib header.
+  auto const payload = JsonPayload();
+  z_stream stream{};
+  ASSERT_EQ(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8,
+                         Z_DEFAULT_STRATEGY),
+            Z_OK);
+  std::string raw(deflateBound(&stream, payload.size()), '\0');
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(payload.data()));
+  stream.avail_in = static_cast<uInt>(payload.size());
+  stream.next_out = reinterpret_cast<Bytef*>(raw.data());
+  stream.avail_out = static_cast<uInt>(raw.size());
+  ASSERT_EQ(deflate(&stream, Z_FINISH), Z_STREAM_END);
+  raw.resize(raw.size() - stream.avail_out);
+  deflateEnd(&stream);
+  EXPECT_EQ(DecompressBody(ContentEncoding::kDeflate, raw, 1 << 20), payload);
+}
+
+TEST(DecompressionTest, ZipBomb) {
+  // About 64 MiB of zeros compress to a few KiB.
+  auto const bomb =
+      Compress(ContentEncoding::kGzip, std::string(64 * 1024 * 1024, '\0'));
+  EXPECT_LT(bomb.size(), 128 * 1024);
+  EXPECT_THROW(DecompressBody(ContentEncoding::kGzip, bomb, 1024 * 1024),
+               std::length_error);
+}
+
+TEST(DecompressionTest, Handler) {
+  auto const payload = JsonPayload();
+  auto handler = MakeDecompressionHandler(
+      [](BeastRequest request) {
+        BeastResponse response;
+        response.set("x-content-encoding",
+                     request[be::http::field::content_encoding]);
+        response.set("x-content-length",
+                     request[be::http::field::content_length]);
+        response.set("x-content-md5", request[be::http::field::content_md5]);
+        response.body() = std::move(request.body());
+        return response;
+      },
+      DecompressionOptions{1024 * 1024});
+  auto make_request = [](std::string_view encoding, std::string body) {
+    BeastRequest request;
+    request.set(be::http::field::content_encoding, encoding);
+    request.body() = std::move(body);
+    request.prepare_payload();
+    return request;
+  };
+
+  auto compressed =
+      make_request("gzip", Compress(ContentEncoding::kGzip, payload));
+  // The checksum describes the compressed body.
+  compressed.set(be::http::field::content_md5, "unused");
+  auto response = handler(std::move(compressed));
+  EXPECT_EQ(response.result(), be::http::status::ok);
+  EXPECT_EQ(response.body(), payload);
+  EXPECT_EQ(response["x-content-encoding"], "");
+  EXPECT_EQ(response["x-content-length"], std::to_string(payload.size()));
+  EXPECT_EQ(response["x-content-md5"], "");
+
+  response = handler(make_request("identity", "plain"));
+  EXPECT_EQ(response.body(), "plain");
+
+  response = handler(make_request("compress", "unused"));
+  EXPECT_EQ(response.result(), be::http::status::unsupported_media_type);
+
+  response = handler(make_request("gzip", "not compressed"));
+  EXPECT_EQ(response.result(), be::http::status::bad_request);
+
+  response = handler(make_request(
+      "gzip", Compress(ContentEncoding::kGzip, std::string(2 << 20, 'a'))));
+  EXPECT_EQ(response.result(), be::http::status::payload_too_large);
+
+  BeastRequest uncompressed;
+  uncompressed.body() = "uncompressed";
+  response = handler(std::move(uncompressed));
+  EXPECT_EQ(response.body(), "uncompressed");
+}
+
+TEST(DecompressionTest, StreamingHandler) {
+  auto const payload = JsonPayload();
+  auto handler = MakeDecompressionStreamingHandler(
+      [](BeastRequest request, functions::HttpRequestBodyReader& reader) {
+        EXPECT_EQ(request.count(be::http::field::content_encoding), 0);
+        BeastResponse response;
+        response.body() = ReadAll(reader);
+        return response;
+      },
+      DecompressionOptions{1024 * 1024});
+  for (auto encoding : SupportedEncodings()) {
+    SCOPED_TRACE("encoding=" + std::string(ToString(encoding)));
+    BeastRequest request;
+    request.set(be::http::field::content_encoding, ToString(encoding));
+    TestReader reader(Compress(encoding, payload));
+    auto response = handler(std::move(request), reader);
+    EXPECT_EQ(response.body(), payload);
+  }
+
+  BeastRequest request;
+  request.set(be::http::field::content_encoding, "gzip");
+  TestReader truncated(Compress(ContentEncoding::kGzip, payload).substr(0, 50));
+  EXPECT_THROW(handler(request, truncated), std::runtime_error);
+
+  TestReader bomb(
+      Compress(ContentEncoding::kGzip, std::string(4 * 1024 * 1024, 'a')));
+  EXPECT_THROW(handler(request, bomb), std::length_error);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
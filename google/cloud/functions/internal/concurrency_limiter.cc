@@ -0,0 +1,110 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/concurrency_limiter.h"
+#include <algorithm>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+ConcurrencyLimiter::ConcurrencyLimiter(std::size_t max_concurrency,
+                                       std::size_t max_queue,
+                                       std::vector<double> const& weights)
+    : max_queue_(max_queue),
+      max_concurrency_(std::max<std::size_t>(max_concurrency, 1)) {
+  for (auto w : weights) lanes_.push_back(Lane{1.0 / w});
+  if (lanes_.empty()) lanes_.push_back(Lane{1.0});
+}
+
+bool ConcurrencyLimiter::Submit(std::function<void()> task,
+                                std::size_t lane) {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (running_ < max_concurrency_) {
+    ++running_;
+    lk.unlock();
+    task();
+    return true;
+  }
+  auto& l = lanes_[LaneIndex(lane)];
+  if (l.queue.size() >= max_queue_) return false;
+  // A lane that was idle starts at the current virtual time, it does not
+  // get credit for the time it had no tasks.
+  l.last_finish = std::max(l.last_finish, virtual_time_) + l.cost;
+  l.queue.push_back(Queued{l.last_finish, std::move(task)});
+  ++queued_;
+  return true;
+}
+
+void ConcurrencyLimiter::Done() {
+  std::unique_lock<std::mutex> lk(mu_);
+  --running_;
+  Drain(std::move(lk));
+}
+
+void ConcurrencyLimiter::SetMaxConcurrency(std::size_t max_concurrency) {
+  std::unique_lock<std::mutex> lk(mu_);
+  max_concurrency_ = std::max<std::size_t>(max_concurrency, 1);
+  Drain(std::move(lk));
+}
+
+void ConcurrencyLimiter::Drain(std::unique_lock<std::mutex> lk) {
+  while (queued_ != 0 && running_ < max_concurrency_) {
+    auto next = lanes_.end();
+    for (auto l = lanes_.begin(); l != lanes_.end(); ++l) {
+      if (l->queue.empty()) continue;
+      if (next == lanes_.end() ||
+          l->queue.front().finish < next->queue.front().finish) {
+        next = l;
+      }
+    }
+    auto queued = std::move(next->queue.front());
+    next->queue.pop_front();
+    --queued_;
+    ++running_;
+    virtual_time_ = queued.finish;
+    lk.unlock();
+    queued.task();
+    lk.lock();
+  }
+}
+
+bool ConcurrencyLimiter::Full(std::size_t lane) const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return running_ >= max_concurrency_ &&
+         lanes_[LaneIndex(lane)].queue.size() >= max_queue_;
+}
+
+std::size_t ConcurrencyLimiter::max_concurrency() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return max_concurrency_;
+}
+
+std::size_t ConcurrencyLimiter::running() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return running_;
+}
+
+std::size_t ConcurrencyLimiter::queued() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return queued_;
+}
+
+std::size_t ConcurrencyLimiter::queued(std::size_t lane) const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return lanes_[LaneIndex(lane)].queue.size();
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
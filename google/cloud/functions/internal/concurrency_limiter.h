@@ -0,0 +1,108 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CONCURRENCY_LIMITER_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CONCURRENCY_LIMITER_H
+
+#include "google/cloud/functions/version.h"
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Limits how many tasks run at once, with a bounded queue for the rest.
+ *
+ * Tasks start in the calling thread, either in `Submit()` or in the `Done()`
+ * call that frees a slot, so they should only start work elsewhere (e.g.
+ * post it to a thread pool), and must call `Done()` once complete.
+ *
+ * Queued tasks wait in priority lanes, each with its own queue of up to
+ * `max_queue` tasks. Free slots go to the lanes using weighted fair queuing:
+ * each queued task gets a virtual finish time, advancing by the inverse of
+ * the lane weight, and the task with the earliest finish time runs next. A
+ * lane with weight 4 starts four tasks for each task of a lane with weight 1
+ * while both have queued tasks, and idle lanes do not accumulate credit.
+ */
+class ConcurrencyLimiter {
+ public:
+  /// Creates a limiter with one lane per weight, or a single lane if empty.
+  ConcurrencyLimiter(std::size_t max_concurrency, std::size_t max_queue,
+                     std::vector<double> const& weights = {});
+
+  /**
+   * Starts @p task, or queues it in @p lane. Returns false if the queue is
+   * full.
+   *
+   * Lanes out of range use the last lane.
+   */
+  bool Submit(std::function<void()> task, std::size_t lane = 0);
+
+  /// Completes a task, and starts the next queued task, if any.
+  void Done();
+
+  /**
+   * Changes the limit, at least 1.
+   *
+   * A higher limit starts queued tasks right away, in the calling thread. With
+   * a lower limit the running tasks complete, and queued tasks wait until
+   * fewer than the new limit are running.
+   */
+  void SetMaxConcurrency(std::size_t max_concurrency);
+
+  /// Returns true if `Submit()` would reject a task in @p lane.
+  [[nodiscard]] bool Full(std::size_t lane = 0) const;
+
+  [[nodiscard]] std::size_t max_concurrency() const;
+  [[nodiscard]] std::size_t running() const;
+  [[nodiscard]] std::size_t queued() const;
+  [[nodiscard]] std::size_t queued(std::size_t lane) const;
+
+ private:
+  struct Queued {
+    double finish;
+    std::function<void()> task;
+  };
+  struct Lane {
+    double cost;
+    double last_finish = 0;
+    std::deque<Queued> queue = {};
+  };
+
+  [[nodiscard]] std::size_t LaneIndex(std::size_t lane) const {
+    return std::min(lane, lanes_.size() - 1);
+  }
+
+  /// Starts queued tasks while there are free slots, releases @p lk.
+  void Drain(std::unique_lock<std::mutex> lk);
+
+  std::size_t const max_queue_;
+  mutable std::mutex mu_;
+  std::size_t max_concurrency_;
+  std::size_t running_ = 0;
+  std::size_t queued_ = 0;
+  /// The finish time of the last task started from a queue.
+  double virtual_time_ = 0;
+  std::vector<Lane> lanes_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CONCURRENCY_LIMITER_H
@@ -0,0 +1,152 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/concurrency_limiter.h"
+#include <gmock/gmock.h>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(ConcurrencyLimiter, RunsUpToLimit) {
+  ConcurrencyLimiter limiter(2, 1);
+  std::vector<int> started;
+  auto task = [&started](int i) {
+    return [&started, i] { started.push_back(i); };
+  };
+  EXPECT_TRUE(limiter.Submit(task(1)));
+  EXPECT_TRUE(limiter.Submit(task(2)));
+  EXPECT_FALSE(limiter.Full());
+  EXPECT_TRUE(limiter.Submit(task(3)));
+  EXPECT_TRUE(limiter.Full());
+  EXPECT_FALSE(limiter.Submit(task(4)));
+  EXPECT_THAT(started, ElementsAre(1, 2));
+  EXPECT_EQ(limiter.running(), 2);
+  EXPECT_EQ(limiter.queued(), 1);
+
+  // Completing a task starts the next queued task.
+  limiter.Done();
+  EXPECT_THAT(started, ElementsAre(1, 2, 3));
+  EXPECT_EQ(limiter.running(), 2);
+  EXPECT_EQ(limiter.queued(), 0);
+  limiter.Done();
+  limiter.Done();
+  EXPECT_EQ(limiter.running(), 0);
+}
+
+TEST(ConcurrencyLimiter, NoQueue) {
+  ConcurrencyLimiter limiter(0, 0);
+  auto count = 0;
+  EXPECT_TRUE(limiter.Submit([&count] { ++count; }));
+  EXPECT_TRUE(limiter.Full());
+  EXPECT_FALSE(limiter.Submit([&count] { ++count; }));
+  EXPECT_EQ(count, 1);
+  limiter.Done();
+  EXPECT_FALSE(limiter.Full());
+}
+
+TEST(ConcurrencyLimiter, SetMaxConcurrency) {
+  ConcurrencyLimiter limiter(1, 8);
+  std::vector<int> started;
+  auto task = [&started](int i) {
+    return [&started, i] { started.push_back(i); };
+  };
+  for (int i = 0; i != 5; ++i) EXPECT_TRUE(limiter.Submit(task(i)));
+  EXPECT_THAT(started, ElementsAre(0));
+
+  // A higher limit starts queued tasks right away.
+  limiter.SetMaxConcurrency(3);
+  EXPECT_EQ(limiter.max_concurrency(), 3);
+  EXPECT_THAT(started, ElementsAre(0, 1, 2));
+  EXPECT_EQ(limiter.running(), 3);
+
+  // With a lower limit the queued tasks wait for the running tasks.
+  limiter.SetMaxConcurrency(0);
+  EXPECT_EQ(limiter.max_concurrency(), 1);
+  limiter.Done();
+  limiter.Done();
+  EXPECT_THAT(started, ElementsAre(0, 1, 2));
+  limiter.Done();
+  EXPECT_THAT(started, ElementsAre(0, 1, 2, 3));
+  EXPECT_EQ(limiter.running(), 1);
+  limiter.Done();
+  limiter.Done();
+  EXPECT_THAT(started, ElementsAre(0, 1, 2, 3, 4));
+  EXPECT_EQ(limiter.running(), 0);
+}
+
+TEST(ConcurrencyLimiter, WeightedLanes) {
+  ConcurrencyLimiter limiter(1, 8, {3, 1});
+  std::vector<int> started;
+  auto task = [&started](int i) {
+    return [&started, i] { started.push_back(i); };
+  };
+  EXPECT_TRUE(limiter.Submit(task(-1)));
+  for (int i = 0; i != 4; ++i) {
+    EXPECT_TRUE(limiter.Submit(task(10 + i), 1));
+    EXPECT_TRUE(limiter.Submit(task(i), 0));
+  }
+  EXPECT_EQ(limiter.queued(0), 4);
+  EXPECT_EQ(limiter.queued(1), 4);
+  for (int i = 0; i != 8; ++i) limiter.Done();
+  // While both lanes have tasks the first lane starts three for each task of
+  // the second lane.
+  EXPECT_THAT(started, ElementsAre(-1, 0, 1, 2, 10, 3, 11, 12, 13));
+  limiter.Done();
+  EXPECT_EQ(limiter.running(), 0);
+}
+
+TEST(ConcurrencyLimiter, LanesHaveSeparateQueues) {
+  ConcurrencyLimiter limiter(1, 1, {1, 1});
+  auto count = 0;
+  auto task = [&count] { ++count; };
+  EXPECT_TRUE(limiter.Submit(task));
+  EXPECT_TRUE(limiter.Submit(task, 1));
+  EXPECT_TRUE(limiter.Full(1));
+  // Lanes out of range use the last lane.
+  EXPECT_TRUE(limiter.Full(7));
+  EXPECT_FALSE(limiter.Submit(task, 7));
+  EXPECT_FALSE(limiter.Full(0));
+  EXPECT_TRUE(limiter.Submit(task, 0));
+  EXPECT_EQ(limiter.queued(), 2);
+  limiter.Done();
+  limiter.Done();
+  EXPECT_EQ(count, 3);
+}
+
+TEST(ConcurrencyLimiter, IdleLanesDoNotAccumulateCredit) {
+  ConcurrencyLimiter limiter(1, 8, {1, 1});
+  std::vector<int> started;
+  auto task = [&started](int i) {
+    return [&started, i] { started.push_back(i); };
+  };
+  EXPECT_TRUE(limiter.Submit(task(0)));
+  for (int i = 1; i != 4; ++i) EXPECT_TRUE(limiter.Submit(task(i), 0));
+  for (int i = 0; i != 3; ++i) limiter.Done();
+  // The second lane was idle, it shares the slots with the first lane from
+  // now on, instead of running its backlog first.
+  for (int i = 0; i != 2; ++i) {
+    EXPECT_TRUE(limiter.Submit(task(4 + i), 0));
+    EXPECT_TRUE(limiter.Submit(task(10 + i), 1));
+  }
+  for (int i = 0; i != 4; ++i) limiter.Done();
+  EXPECT_THAT(started, ElementsAre(0, 1, 2, 3, 4, 10, 5, 11));
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
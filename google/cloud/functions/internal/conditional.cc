@@ -0,0 +1,300 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/conditional.h"
+#include <absl/time/time.h>  // NOLINT(modernize-deprecated-headers)
+#include <zlib.h>
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace be = ::boost::beast;
+
+std::string_view Trim(std::string_view s) {
+  auto const b = s.find_first_not_of(" \t");
+  if (b == std::string_view::npos) return {};
+  auto const e = s.find_last_not_of(" \t");
+  return s.substr(b, e - b + 1);
+}
+
+/// Removes the weak indicator, the weak comparison ignores it.
+std::string_view Opaque(std::string_view etag) {
+  if (etag.substr(0, 2) == "W/") etag.remove_prefix(2);
+  return etag;
+}
+
+std::optional<absl::Time> ParseHttpDate(std::string_view value) {
+  // Only the preferred IMF-fixdate format, e.g.,
+  // "Sun, 06 Nov 1994 08:49:37 GMT", the obsolete formats are ignored.
+  absl::Time t;
+  std::string error;
+  if (!absl::ParseTime("%a, %d %b %Y %H:%M:%S GMT", std::string(Trim(value)),
+                       absl::UTCTimeZone(), &t, &error)) {
+    return std::nullopt;
+  }
+  return t;
+}
+
+bool IsSuccess(BeastResponse const& response) {
+  return response.result() == be::http::status::ok;
+}
+
+BeastResponse NotModifiedResponse(std::string const& etag) {
+  BeastResponse response;
+  response.result(be::http::status::not_modified);
+  response.set(be::http::field::etag, etag);
+  return response;
+}
+
+/// Sets the `ETag` of a successful response, unless it has one.
+void SetEntityTag(BeastResponse& response, std::string const& etag) {
+  if (!IsSuccess(response) || response.count(be::http::field::etag) != 0) {
+    return;
+  }
+  response.set(be::http::field::etag, etag);
+}
+
+/// Answers the preconditions of a streaming response once its header is set.
+class ConditionalResponseWriter : public ResponseWriter {
+ public:
+  ConditionalResponseWriter(ResponseWriter& impl, ConditionalRequest request,
+                            std::optional<std::string> etag = std::nullopt)
+      : impl_(impl), request_(std::move(request)), etag_(std::move(etag)) {}
+
+  void WriteHeader(BeastResponse header) override {
+    if (etag_) SetEntityTag(header, *etag_);
+    if (request_.cacheable && IsSuccess(header) &&
+        IsNotModified(request_, header)) {
+      MakeNotModified(header);
+      not_modified_ = true;
+    }
+    impl_.WriteHeader(std::move(header));
+  }
+
+  void Write(std::string_view data) override {
+    if (not_modified_) return;
+    impl_.Write(data);
+  }
+
+  void SetHeartbeat(std::string_view data,
+                    std::chrono::milliseconds interval) override {
+    if (not_modified_) return;
+    impl_.SetHeartbeat(data, interval);
+  }
+
+ private:
+  ResponseWriter& impl_;
+  ConditionalRequest request_;
+  std::optional<std::string> etag_;
+  bool not_modified_ = false;
+};
+
+/// Returns the response for a request that matches its current entity tag.
+std::optional<BeastResponse> CheckEntityTag(ConditionalRequest const& request,
+                                            std::optional<std::string> const&
+                                                etag) {
+  if (!etag || !request.cacheable ||
+      !EntityTagMatches(request.if_none_match, *etag)) {
+    return std::nullopt;
+  }
+  return NotModifiedResponse(*etag);
+}
+
+}  // namespace
+
+ConditionalRequest GetConditionalRequest(BeastRequest const& request) {
+  auto const method = request.method();
+  return ConditionalRequest{
+      method == be::http::verb::get || method == be::http::verb::head,
+      std::string(request[be::http::field::if_none_match]),
+      std::string(request[be::http::field::if_modified_since])};
+}
+
+std::string MakeEntityTag(std::string_view body) {
+  auto crc = crc32(0L, Z_NULL, 0);
+  for (auto data = body; !data.empty();) {
+    auto const n = std::min<std::size_t>(data.size(),
+                                         std::numeric_limits<uInt>::max());
+    crc = crc32(crc, reinterpret_cast<Bytef const*>(data.data()),
+                static_cast<uInt>(n));
+    data.remove_prefix(n);
+  }
+  char buffer[64];
+  auto const n = std::snprintf(buffer, sizeof(buffer), "W/\"%08lx-%zx\"",
+                               static_cast<unsigned long>(crc), body.size());
+  return std::string(buffer, static_cast<std::size_t>(n));
+}
+
+std::string QuoteEntityTag(std::string_view tag) {
+  if (!Opaque(tag).empty() && Opaque(tag).front() == '"') {
+    return std::string(tag);
+  }
+  return "\"" + std::string(tag) + "\"";
+}
+
+bool EntityTagMatches(std::string_view if_none_match, std::string_view etag) {
+  if (etag.empty()) return false;
+  while (!if_none_match.empty()) {
+    auto const end = if_none_match.find(',');
+    auto const candidate = Trim(if_none_match.substr(0, end));
+    if (candidate == "*" || Opaque(candidate) == Opaque(etag)) return true;
+    if (end == std::string_view::npos) break;
+    if_none_match.remove_prefix(end + 1);
+  }
+  return false;
+}
+
+bool IsNotModified(ConditionalRequest const& request,
+                   BeastResponse const& response) {
+  if (!request.cacheable) return false;
+  if (!request.if_none_match.empty()) {
+    return EntityTagMatches(request.if_none_match,
+                            response[be::http::field::etag]);
+  }
+  if (request.if_modified_since.empty()) return false;
+  auto const since = ParseHttpDate(request.if_modified_since);
+  auto const modified =
+      ParseHttpDate(response[be::http::field::last_modified]);
+  return since && modified && *modified <= *since;
+}
+
+void MakeNotModified(BeastResponse& response) {
+  response.result(be::http::status::not_modified);
+  response.body().clear();
+  // A 304 response has no content, it only refreshes the cached response.
+  response.erase(be::http::field::content_length);
+  response.erase(be::http::field::content_type);
+  response.erase(be::http::field::content_encoding);
+}
+
+void ApplyConditional(ConditionalRequest const& request,
+                      BeastResponse& response) {
+  if (!request.cacheable || !IsSuccess(response)) return;
+  if (response.count(be::http::field::etag) == 0 &&
+      response.body().file() == nullptr) {
+    response.set(be::http::field::etag, MakeEntityTag(response.body().str()));
+  }
+  if (IsNotModified(request, response)) MakeNotModified(response);
+}
+
+Handler MakeConditionalHandler(Handler handler) {
+  return [h = std::move(handler)](BeastRequest request) {
+    auto const conditional = GetConditionalRequest(request);
+    auto response = h(std::move(request));
+    ApplyConditional(conditional, response);
+    return response;
+  };
+}
+
+StreamingHandler MakeConditionalStreamingHandler(StreamingHandler handler) {
+  return [h = std::move(handler)](BeastRequest request,
+                                  functions::HttpRequestBodyReader& reader) {
+    auto const conditional = GetConditionalRequest(request);
+    auto response = h(std::move(request), reader);
+    ApplyConditional(conditional, response);
+    return response;
+  };
+}
+
+WriterHandler MakeConditionalWriterHandler(WriterHandler handler) {
+  return [h = std::move(handler)](BeastRequest request,
+                                  ResponseWriter& writer) {
+    // Streaming responses are not hashed, only their own validators apply.
+    ConditionalResponseWriter conditional(writer,
+                                          GetConditionalRequest(request));
+    return h(std::move(request), conditional);
+  };
+}
+
+AsyncHandler MakeConditionalAsyncHandler(AsyncHandler handler) {
+  return [h = std::move(handler)](BeastRequest request,
+                                  AsyncResponseCallback done) {
+    auto conditional = GetConditionalRequest(request);
+    h(std::move(request), [conditional = std::move(conditional),
+                           done = std::move(done)](BeastResponse response) {
+      ApplyConditional(conditional, response);
+      done(std::move(response));
+    });
+  };
+}
+
+Handler MakeValidatorHandler(Handler handler, EntityTagValidator validator) {
+  return [h = std::move(handler), v = std::move(validator)](
+             BeastRequest request) {
+    auto const etag = v(request);
+    if (auto r = CheckEntityTag(GetConditionalRequest(request), etag)) {
+      return *std::move(r);
+    }
+    auto response = h(std::move(request));
+    if (etag) SetEntityTag(response, *etag);
+    return response;
+  };
+}
+
+StreamingHandler MakeValidatorStreamingHandler(StreamingHandler handler,
+                                               EntityTagValidator validator) {
+  return [h = std::move(handler), v = std::move(validator)](
+             BeastRequest request, functions::HttpRequestBodyReader& reader) {
+    auto const etag = v(request);
+    if (auto r = CheckEntityTag(GetConditionalRequest(request), etag)) {
+      return *std::move(r);
+    }
+    auto response = h(std::move(request), reader);
+    if (etag) SetEntityTag(response, *etag);
+    return response;
+  };
+}
+
+WriterHandler MakeValidatorWriterHandler(WriterHandler handler,
+                                         EntityTagValidator validator) {
+  return [h = std::move(handler), v = std::move(validator)](
+             BeastRequest request, ResponseWriter& writer) {
+    auto etag = v(request);
+    auto conditional = GetConditionalRequest(request);
+    if (auto r = CheckEntityTag(conditional, etag)) {
+      writer.WriteHeader(*std::move(r));
+      return true;
+    }
+    // The request did not match, the writer only sets the entity tag.
+    conditional.cacheable = false;
+    ConditionalResponseWriter w(writer, std::move(conditional),
+                                std::move(etag));
+    return h(std::move(request), w);
+  };
+}
+
+AsyncHandler MakeValidatorAsyncHandler(AsyncHandler handler,
+                                       EntityTagValidator validator) {
+  return [h = std::move(handler), v = std::move(validator)](
+             BeastRequest request, AsyncResponseCallback done) {
+    auto etag = v(request);
+    if (auto r = CheckEntityTag(GetConditionalRequest(request), etag)) {
+      return done(*std::move(r));
+    }
+    h(std::move(request), [etag = std::move(etag),
+                           done = std::move(done)](BeastResponse response) {
+      if (etag) SetEntityTag(response, *etag);
+      done(std::move(response));
+    });
+  };
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
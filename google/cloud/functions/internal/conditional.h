@@ -0,0 +1,108 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CONDITIONAL_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CONDITIONAL_H
+
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/version.h"
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// The preconditions of a request, saved before the request is handled.
+struct ConditionalRequest {
+  /// Only `GET` and `HEAD` requests are answered with `304 Not Modified`.
+  bool cacheable = false;
+  std::string if_none_match;
+  std::string if_modified_since;
+};
+
+ConditionalRequest GetConditionalRequest(BeastRequest const& request);
+
+/**
+ * Returns an entity tag derived from the CRC-32 and size of @p body.
+ *
+ * The tag is weak, so it does not change when the response is compressed.
+ */
+std::string MakeEntityTag(std::string_view body);
+
+/// Quotes @p tag as an entity tag, unless it is already quoted.
+std::string QuoteEntityTag(std::string_view tag);
+
+/**
+ * Returns `true` if the `If-None-Match` value @p if_none_match matches
+ * @p etag.
+ *
+ * Uses the weak comparison, as required for `If-None-Match`, so `W/"a"` and
+ * `"a"` match.
+ */
+bool EntityTagMatches(std::string_view if_none_match, std::string_view etag);
+
+/**
+ * Returns `true` if @p response can be replaced by `304 Not Modified`.
+ *
+ * Uses the response `ETag` if the request has an `If-None-Match` header, and
+ * otherwise the response `Last-Modified` and the `If-Modified-Since` header.
+ */
+bool IsNotModified(ConditionalRequest const& request,
+                   BeastResponse const& response);
+
+/// Turns @p response into `304 Not Modified`, keeping its validators.
+void MakeNotModified(BeastResponse& response);
+
+/**
+ * Adds an `ETag` to a successful buffered @p response, and answers the
+ * request preconditions.
+ *
+ * Responses that already have an `ETag` keep it, responses with a file
+ * payload only use their own validators.
+ */
+void ApplyConditional(ConditionalRequest const& request,
+                      BeastResponse& response);
+
+/// Returns handlers that answer preconditions with the responses of @p handler.
+Handler MakeConditionalHandler(Handler handler);
+StreamingHandler MakeConditionalStreamingHandler(StreamingHandler handler);
+WriterHandler MakeConditionalWriterHandler(WriterHandler handler);
+AsyncHandler MakeConditionalAsyncHandler(AsyncHandler handler);
+
+/// Returns the current entity tag for a request, if any.
+using EntityTagValidator =
+    std::function<std::optional<std::string>(BeastRequest const&)>;
+
+/**
+ * Returns handlers that answer requests matching the entity tag from
+ * @p validator with `304 Not Modified`, without calling @p handler.
+ *
+ * Other requests call @p handler, and its successful responses get the entity
+ * tag, unless they have one.
+ */
+Handler MakeValidatorHandler(Handler handler, EntityTagValidator validator);
+StreamingHandler MakeValidatorStreamingHandler(StreamingHandler handler,
+                                               EntityTagValidator validator);
+WriterHandler MakeValidatorWriterHandler(WriterHandler handler,
+                                         EntityTagValidator validator);
+AsyncHandler MakeValidatorAsyncHandler(AsyncHandler handler,
+                                       EntityTagValidator validator);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CONDITIONAL_H
@@ -0,0 +1,220 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/conditional.h"
+#include <boost/beast/http.hpp>
+#include <gmock/gmock.h>
+#include <string>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace be = ::boost::beast;
+
+BeastRequest GetRequest(std::string_view if_none_match = {}) {
+  BeastRequest request;
+  request.method(be::http::verb::get);
+  request.target("/");
+  if (!if_none_match.empty()) {
+    request.set(be::http::field::if_none_match, if_none_match);
+  }
+  return request;
+}
+
+BeastResponse TextResponse(std::string body) {
+  BeastResponse response;
+  response.set(be::http::field::content_type, "text/plain");
+  response.body() = std::move(body);
+  response.prepare_payload();
+  return response;
+}
+
+TEST(ConditionalTest, MakeEntityTag) {
+  // The CRC-32 of "Hello World" is 0x4a17b156.
+  EXPECT_EQ(MakeEntityTag("Hello World"), R"(W/"4a17b156-b")");
+  EXPECT_EQ(MakeEntityTag(""), R"(W/"00000000-0")");
+  EXPECT_NE(MakeEntityTag("Hello World"), MakeEntityTag("Hello World!"));
+}
+
+TEST(ConditionalTest, QuoteEntityTag) {
+  EXPECT_EQ(QuoteEntityTag("v1"), R"("v1")");
+  EXPECT_EQ(QuoteEntityTag(R"("v1")"), R"("v1")");
+  EXPECT_EQ(QuoteEntityTag(R"(W/"v1")"), R"(W/"v1")");
+}
+
+TEST(ConditionalTest, EntityTagMatches) {
+  EXPECT_TRUE(EntityTagMatches(R"("a")", R"("a")"));
+  EXPECT_TRUE(EntityTagMatches(R"(W/"a")", R"("a")"));
+  EXPECT_TRUE(EntityTagMatches(R"("a")", R"(W/"a")"));
+  EXPECT_TRUE(EntityTagMatches(R"("x", "y" , "a")", R"("a")"));
+  EXPECT_TRUE(EntityTagMatches("*", R"("a")"));
+  EXPECT_FALSE(EntityTagMatches(R"("b")", R"("a")"));
+  EXPECT_FALSE(EntityTagMatches("", R"("a")"));
+  EXPECT_FALSE(EntityTagMatches("*", ""));
+}
+
+TEST(ConditionalTest, IfModifiedSince) {
+  auto request = GetRequest();
+  request.set(be::http::field::if_modified_since,
+              "Sun, 06 Nov 1994 08:49:37 GMT");
+  auto response = TextResponse("Hello");
+  response.set(be::http::field::last_modified,
+               "Sun, 06 Nov 1994 08:49:37 GMT");
+  EXPECT_TRUE(IsNotModified(GetConditionalRequest(request), response));
+  response.set(be::http::field::last_modified,
+               "Sun, 06 Nov 1994 08:49:38 GMT");
+  EXPECT_FALSE(IsNotModified(GetConditionalRequest(request), response));
+  response.set(be::http::field::last_modified, "invalid");
+  EXPECT_FALSE(IsNotModified(GetConditionalRequest(request), response));
+
+  // `If-None-Match` takes precedence.
+  response.set(be::http::field::last_modified,
+               "Sun, 06 Nov 1994 08:49:37 GMT");
+  response.set(be::http::field::etag, R"("a")");
+  request.set(be::http::field::if_none_match, R"("b")");
+  EXPECT_FALSE(IsNotModified(GetConditionalRequest(request), response));
+}
+
+TEST(ConditionalTest, ApplyConditional) {
+  auto const etag = MakeEntityTag("Hello");
+  auto response = TextResponse("Hello");
+  ApplyConditional(GetConditionalRequest(GetRequest()), response);
+  EXPECT_EQ(response.result(), be::http::status::ok);
+  EXPECT_EQ(response[be::http::field::etag], etag);
+  EXPECT_EQ(response.body(), "Hello");
+
+  response = TextResponse("Hello");
+  ApplyConditional(GetConditionalRequest(GetRequest(etag)), response);
+  EXPECT_EQ(response.result(), be::http::status::not_modified);
+  EXPECT_EQ(response[be::http::field::etag], etag);
+  EXPECT_TRUE(response.body().empty());
+  EXPECT_EQ(response.count(be::http::field::content_length), 0);
+  EXPECT_EQ(response.count(be::http::field::content_type), 0);
+
+  // Existing entity tags are kept.
+  response = TextResponse("Hello");
+  response.set(be::http::field::etag, R"("v1")");
+  ApplyConditional(GetConditionalRequest(GetRequest(R"("v1")")), response);
+  EXPECT_EQ(response.result(), be::http::status::not_modified);
+  EXPECT_EQ(response[be::http::field::etag], R"("v1")");
+
+  // Only successful responses to `GET` and `HEAD` are changed.
+  auto post = GetRequest(etag);
+  post.method(be::http::verb::post);
+  response = TextResponse("Hello");
+  ApplyConditional(GetConditionalRequest(post), response);
+  EXPECT_EQ(response.result(), be::http::status::ok);
+  EXPECT_EQ(response.count(be::http::field::etag), 0);
+
+  response = TextResponse("Hello");
+  response.result(be::http::status::not_found);
+  ApplyConditional(GetConditionalRequest(GetRequest(etag)), response);
+  EXPECT_EQ(response.result(), be::http::status::not_found);
+  EXPECT_EQ(response.count(be::http::field::etag), 0);
+}
+
+class TestWriter : public ResponseWriter {
+ public:
+  void WriteHeader(BeastResponse header) override {
+    body += header.body().str();
+    this->header = std::move(header);
+  }
+  void Write(std::string_view data) override { body += data; }
+
+  BeastResponse header;
+  std::string body;
+};
+
+TEST(ConditionalTest, WriterHandler) {
+  auto handler = MakeConditionalWriterHandler(
+      [](BeastRequest, ResponseWriter& writer) {
+        auto header = TextResponse("Hello");
+        header.set(be::http::field::etag, R"("v1")");
+        writer.WriteHeader(std::move(header));
+        writer.Write(" World");
+        return true;
+      });
+  TestWriter writer;
+  EXPECT_TRUE(handler(GetRequest(R"("v1")"), writer));
+  EXPECT_EQ(writer.header.result(), be::http::status::not_modified);
+  EXPECT_EQ(writer.body, "");
+
+  TestWriter modified;
+  EXPECT_TRUE(handler(GetRequest(R"("v0")"), modified));
+  EXPECT_EQ(modified.header.result(), be::http::status::ok);
+  EXPECT_EQ(modified.body, "Hello World");
+}
+
+TEST(ConditionalTest, ValidatorHandler) {
+  int calls = 0;
+  auto handler = MakeValidatorHandler(
+      [&calls](BeastRequest) {
+        ++calls;
+        return TextResponse("Hello");
+      },
+      [](BeastRequest const&) -> std::optional<std::string> {
+        return R"("v1")";
+      });
+  auto response = handler(GetRequest(R"("v1")"));
+  EXPECT_EQ(response.result(), be::http::status::not_modified);
+  EXPECT_EQ(response[be::http::field::etag], R"("v1")");
+  EXPECT_EQ(calls, 0);
+
+  response = handler(GetRequest(R"("v0")"));
+  EXPECT_EQ(response.result(), be::http::status::ok);
+  EXPECT_EQ(response[be::http::field::etag], R"("v1")");
+  EXPECT_EQ(response.body(), "Hello");
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(ConditionalTest, ValidatorWithoutEntityTag) {
+  int calls = 0;
+  auto handler = MakeValidatorHandler(
+      [&calls](BeastRequest) {
+        ++calls;
+        return TextResponse("Hello");
+      },
+      [](BeastRequest const&) { return std::optional<std::string>{}; });
+  auto const response = handler(GetRequest("*"));
+  EXPECT_EQ(response.result(), be::http::status::ok);
+  EXPECT_EQ(response.count(be::http::field::etag), 0);
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(ConditionalTest, ValidatorAsyncHandler) {
+  int calls = 0;
+  auto handler = MakeValidatorAsyncHandler(
+      [&calls](BeastRequest, AsyncResponseCallback const& done) {
+        ++calls;
+        done(TextResponse("Hello"));
+      },
+      [](BeastRequest const&) -> std::optional<std::string> {
+        return R"("v1")";
+      });
+  BeastResponse response;
+  auto capture = [&response](BeastResponse r) { response = std::move(r); };
+  handler(GetRequest(R"(W/"v1")"), capture);
+  EXPECT_EQ(response.result(), be::http::status::not_modified);
+  EXPECT_EQ(calls, 0);
+
+  handler(GetRequest(), capture);
+  EXPECT_EQ(response.result(), be::http::status::ok);
+  EXPECT_EQ(response[be::http::field::etag], R"("v1")");
+  EXPECT_EQ(calls, 1);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,177 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/cpu_limits.h"
+#include "google/cloud/functions/internal/cgroup_files.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif  // __linux__
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+std::optional<double> Quota(std::int64_t quota, std::int64_t period) {
+  if (quota <= 0 || period <= 0) return std::nullopt;
+  return static_cast<double>(quota) / static_cast<double>(period);
+}
+
+std::optional<double> Min(std::optional<double> a, std::optional<double> b) {
+  if (!a) return b;
+  if (!b) return a;
+  return std::min(*a, *b);
+}
+
+std::optional<double> CgroupV2Limit(std::filesystem::path const& root,
+                                    std::string const& path) {
+  std::optional<double> result;
+  ForEachCgroupDirectory(root, path, [&result](auto const& dir) {
+    auto contents = ReadSystemFile(dir / "cpu.max");
+    if (contents) result = Min(result, ParseCgroupCpuMax(*contents));
+  });
+  return result;
+}
+
+std::optional<double> CgroupV1Limit(std::filesystem::path const& root,
+                                    std::string const& path) {
+  auto const relative = CgroupRelativePath(path);
+  for (auto const* name : {"cpu", "cpu,cpuacct", "cpuacct,cpu"}) {
+    for (auto const& dir : {root / name / relative, root / name}) {
+      auto quota = ReadSystemFile(dir / "cpu.cfs_quota_us");
+      auto period = ReadSystemFile(dir / "cpu.cfs_period_us");
+      if (quota && period) return ParseCgroupCfsQuota(*quota, *period);
+    }
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
+std::optional<std::string> CgroupPath(std::string const& proc_cgroup,
+                                      std::string_view controller) {
+  std::istringstream is(proc_cgroup);
+  std::string line;
+  while (std::getline(is, line)) {
+    // Each line is `hierarchy-id:controller-list:path`.
+    auto const first = line.find(':');
+    auto const second = line.find(':', first + 1);
+    if (first == std::string::npos || second == std::string::npos) continue;
+    auto const list =
+        std::string_view(line).substr(first + 1, second - first - 1);
+    auto const path = line.substr(second + 1);
+    if (controller.empty()) {
+      if (list.empty()) return path;
+      continue;
+    }
+    for (std::size_t pos = 0; pos <= list.size();) {
+      auto const end = std::min(list.find(',', pos), list.size());
+      if (list.substr(pos, end - pos) == controller) return path;
+      pos = end + 1;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<double> ParseCgroupCpuMax(std::string_view contents) {
+  contents = TrimCgroupValue(contents);
+  auto const space = contents.find(' ');
+  if (space == std::string_view::npos) return std::nullopt;
+  auto const quota =
+      ParseCgroupInteger<std::int64_t>(contents.substr(0, space));
+  auto const period =
+      ParseCgroupInteger<std::int64_t>(contents.substr(space + 1));
+  if (!quota || !period) return std::nullopt;
+  return Quota(*quota, *period);
+}
+
+std::optional<double> ParseCgroupCfsQuota(std::string_view quota,
+                                          std::string_view period) {
+  auto const q = ParseCgroupInteger<std::int64_t>(quota);
+  auto const p = ParseCgroupInteger<std::int64_t>(period);
+  if (!q || !p) return std::nullopt;
+  return Quota(*q, *p);
+}
+
+std::optional<double> CgroupCpuLimit(std::string const& proc_cgroup,
+                                     std::filesystem::path const& root) {
+  if (auto v1 = CgroupPath(proc_cgroup, "cpu")) {
+    if (auto limit = CgroupV1Limit(root, *v1)) return limit;
+  }
+  if (auto v2 = CgroupPath(proc_cgroup, "")) {
+    if (auto limit = CgroupV2Limit(root, *v2)) return limit;
+    // On hybrid systems the v2 hierarchy is mounted on `unified`.
+    if (auto limit = CgroupV2Limit(root / "unified", *v2)) return limit;
+  }
+  return std::nullopt;
+}
+
+std::optional<double> CgroupCpuLimit() {
+#ifdef __linux__
+  auto contents = ReadSystemFile("/proc/self/cgroup");
+  if (!contents) return std::nullopt;
+  return CgroupCpuLimit(*contents);
+#else
+  return std::nullopt;
+#endif  // __linux__
+}
+
+std::vector<int> AllowedCpus() {
+  std::vector<int> cpus;
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) != 0) return cpus;
+  for (int i = 0; i != CPU_SETSIZE; ++i) {
+    if (CPU_ISSET(i, &set)) cpus.push_back(i);
+  }
+#endif  // __linux__
+  return cpus;
+}
+
+unsigned DefaultConcurrency() {
+  static auto const kValue = [] {
+    auto value = std::max(std::thread::hardware_concurrency(), 1U);
+    auto const cpus = AllowedCpus();
+    if (!cpus.empty()) {
+      value = std::min(value, static_cast<unsigned>(cpus.size()));
+    }
+    if (auto const limit = CgroupCpuLimit()) {
+      value = std::min(value, static_cast<unsigned>(std::ceil(*limit)));
+    }
+    return std::max(value, 1U);
+  }();
+  return kValue;
+}
+
+bool PinCurrentThread(int cpu) {
+#ifdef __linux__
+  if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  (void)cpu;
+  return false;
+#endif  // __linux__
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
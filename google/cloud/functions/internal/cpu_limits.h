@@ -0,0 +1,83 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CPU_LIMITS_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CPU_LIMITS_H
+
+#include "google/cloud/functions/version.h"
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Returns the path of the cgroup for @p controller, from the contents of
+ * `/proc/self/cgroup`. An empty controller selects the cgroup v2 hierarchy.
+ */
+std::optional<std::string> CgroupPath(std::string const& proc_cgroup,
+                                      std::string_view controller);
+
+/**
+ * Parses a cgroup v2 `cpu.max` file, e.g. `"150000 100000"`.
+ *
+ * Returns the number of CPUs the quota allows, possibly fractional, or an
+ * empty optional if there is no quota (`"max 100000"`) or the contents are
+ * invalid.
+ */
+std::optional<double> ParseCgroupCpuMax(std::string_view contents);
+
+/// Parses the cgroup v1 `cpu.cfs_quota_us` and `cpu.cfs_period_us` files.
+std::optional<double> ParseCgroupCfsQuota(std::string_view quota,
+                                          std::string_view period);
+
+/**
+ * Returns the CPU quota of the cgroup running this process, in CPUs.
+ *
+ * Supports cgroup v2, where the quota of each ancestor also applies, and
+ * cgroup v1. @p proc_cgroup is the contents of `/proc/self/cgroup`, and
+ * @p root the cgroup filesystem mount point, the tests override both.
+ */
+std::optional<double> CgroupCpuLimit(
+    std::string const& proc_cgroup,
+    std::filesystem::path const& root = "/sys/fs/cgroup");
+
+/// Returns the CPU quota of the cgroup running this process, in CPUs.
+std::optional<double> CgroupCpuLimit();
+
+/// Returns the CPUs this process may run on, empty if the platform does not
+/// report them.
+std::vector<int> AllowedCpus();
+
+/**
+ * The default number of threads to run CPU bound work.
+ *
+ * This is the number of cores (`std::thread::hardware_concurrency()`),
+ * limited by the CPU affinity of the process and by the cgroup CPU quota,
+ * rounded up. A container with a 1 vCPU quota on a large host gets 1 thread.
+ * Computed once, it is always at least 1.
+ */
+unsigned DefaultConcurrency();
+
+/// Pins the calling thread to @p cpu, returns `false` if that fails or the
+/// platform does not support it.
+bool PinCurrentThread(int cpu);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CPU_LIMITS_H
@@ -0,0 +1,110 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/cpu_limits.h"
+#include "google/cloud/functions/testing_util/cgroup_directory.h"
+#include <gmock/gmock.h>
+#include <string>
+#include <thread>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::Optional;
+
+TEST(CpuLimitsTest, ParseCgroupCpuMax) {
+  EXPECT_THAT(ParseCgroupCpuMax("100000 100000\n"), Optional(1.0));
+  EXPECT_THAT(ParseCgroupCpuMax("150000 100000"), Optional(1.5));
+  EXPECT_THAT(ParseCgroupCpuMax("50000 100000"), Optional(0.5));
+  EXPECT_EQ(ParseCgroupCpuMax("max 100000\n"), std::nullopt);
+  EXPECT_EQ(ParseCgroupCpuMax(""), std::nullopt);
+  EXPECT_EQ(ParseCgroupCpuMax("100000"), std::nullopt);
+  EXPECT_EQ(ParseCgroupCpuMax("100000 0"), std::nullopt);
+}
+
+TEST(CpuLimitsTest, ParseCgroupCfsQuota) {
+  EXPECT_THAT(ParseCgroupCfsQuota("200000\n", "100000\n"), Optional(2.0));
+  EXPECT_EQ(ParseCgroupCfsQuota("-1\n", "100000\n"), std::nullopt);
+  EXPECT_EQ(ParseCgroupCfsQuota("abc", "100000"), std::nullopt);
+}
+
+TEST(CpuLimitsTest, CgroupV2) {
+  CgroupDirectory cgroup("cpu_limits_test");
+  cgroup.Write("cpu.max", "max 100000\n");
+  cgroup.Write("service/cpu.max", "400000 100000\n");
+  cgroup.Write("service/instance/cpu.max", "max 100000\n");
+  EXPECT_THAT(CgroupCpuLimit("0::/service/instance\n", cgroup.root()),
+              Optional(4.0));
+
+  cgroup.Write("service/instance/cpu.max", "100000 100000\n");
+  EXPECT_THAT(CgroupCpuLimit("0::/service/instance\n", cgroup.root()),
+              Optional(1.0));
+  EXPECT_EQ(CgroupCpuLimit("0::/\n", cgroup.root()), std::nullopt);
+}
+
+TEST(CpuLimitsTest, CgroupV2Container) {
+  // Inside a container the cgroup is the root of the mounted hierarchy.
+  CgroupDirectory cgroup("cpu_limits_test");
+  cgroup.Write("cpu.max", "100000 100000\n");
+  EXPECT_THAT(CgroupCpuLimit("0::/\n", cgroup.root()), Optional(1.0));
+  EXPECT_THAT(CgroupCpuLimit("0::/host/path\n", cgroup.root()),
+              Optional(1.0));
+}
+
+TEST(CpuLimitsTest, CgroupV1) {
+  CgroupDirectory cgroup("cpu_limits_test");
+  cgroup.Write("cpu,cpuacct/docker/abc/cpu.cfs_quota_us", "150000\n");
+  cgroup.Write("cpu,cpuacct/docker/abc/cpu.cfs_period_us", "100000\n");
+  auto const proc_cgroup = "4:memory:/docker/abc\n3:cpu,cpuacct:/docker/abc\n";
+  EXPECT_THAT(CgroupCpuLimit(proc_cgroup, cgroup.root()), Optional(1.5));
+
+  CgroupDirectory unlimited("cpu_limits_test");
+  unlimited.Write("cpu/cpu.cfs_quota_us", "-1\n");
+  unlimited.Write("cpu/cpu.cfs_period_us", "100000\n");
+  EXPECT_EQ(CgroupCpuLimit("1:cpu:/\n0::/\n", unlimited.root()),
+            std::nullopt);
+}
+
+TEST(CpuLimitsTest, NoCgroup) {
+  CgroupDirectory cgroup("cpu_limits_test");
+  EXPECT_EQ(CgroupCpuLimit("", cgroup.root()), std::nullopt);
+  EXPECT_EQ(CgroupCpuLimit("0::/\n", cgroup.root()), std::nullopt);
+}
+
+TEST(CpuLimitsTest, DefaultConcurrency) {
+  auto const value = DefaultConcurrency();
+  EXPECT_GE(value, 1U);
+  EXPECT_LE(value, std::max(std::thread::hardware_concurrency(), 1U));
+  EXPECT_EQ(value, DefaultConcurrency());
+}
+
+TEST(CpuLimitsTest, PinCurrentThread) {
+  auto const cpus = AllowedCpus();
+#ifdef __linux__
+  ASSERT_FALSE(cpus.empty());
+  std::thread([cpu = cpus.front()] {
+    EXPECT_TRUE(PinCurrentThread(cpu));
+    EXPECT_THAT(AllowedCpus(), ::testing::ElementsAre(cpu));
+  }).join();
+  EXPECT_FALSE(PinCurrentThread(-1));
+#else
+  EXPECT_TRUE(cpus.empty());
+  EXPECT_FALSE(PinCurrentThread(0));
+#endif  // __linux__
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,133 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/crc32c.h"
+#include <array>
+#include <cstring>
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define FUNCTIONS_FRAMEWORK_CPP_CRC32C_SSE42 1
+#elif defined(__aarch64__) && defined(__linux__) && \
+    (defined(__GNUC__) || defined(__clang__))
+#include <arm_acle.h>
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#define FUNCTIONS_FRAMEWORK_CPP_CRC32C_ARMV8 1
+#endif
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+/// The reflected Castagnoli polynomial.
+auto constexpr kPolynomial = std::uint32_t{0x82f63b78};
+
+using Tables = std::array<std::array<std::uint32_t, 256>, 8>;
+
+/// The tables for the slicing-by-8 algorithm.
+constexpr Tables MakeTables() {
+  Tables tables{};
+  for (std::uint32_t i = 0; i != 256; ++i) {
+    auto crc = i;
+    for (int k = 0; k != 8; ++k) crc = (crc >> 1) ^ ((crc & 1) * kPolynomial);
+    tables[0][i] = crc;
+  }
+  for (std::size_t i = 0; i != 256; ++i) {
+    for (std::size_t t = 1; t != tables.size(); ++t) {
+      auto const previous = tables[t - 1][i];
+      tables[t][i] = (previous >> 8) ^ tables[0][previous & 0xff];
+    }
+  }
+  return tables;
+}
+
+constexpr Tables kTables = MakeTables();
+
+std::uint64_t LoadLittleEndian64(char const* p) {
+  std::array<unsigned char, 8> b;
+  std::memcpy(b.data(), p, b.size());
+  std::uint64_t v = 0;
+  for (int i = 7; i >= 0; --i) v = (v << 8) | b[i];
+  return v;
+}
+
+#if FUNCTIONS_FRAMEWORK_CPP_CRC32C_SSE42
+__attribute__((target("sse4.2"))) std::uint32_t ExtendHardware(
+    std::uint32_t crc, char const* p, std::size_t n) {
+  std::uint64_t c = ~crc;
+  for (; n >= 8; p += 8, n -= 8) {
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    c = _mm_crc32_u64(c, v);
+  }
+  auto c32 = static_cast<std::uint32_t>(c);
+  for (; n != 0; ++p, --n) {
+    c32 = _mm_crc32_u8(c32, static_cast<unsigned char>(*p));
+  }
+  return ~c32;
+}
+
+bool HasHardware() { return __builtin_cpu_supports("sse4.2"); }
+#elif FUNCTIONS_FRAMEWORK_CPP_CRC32C_ARMV8
+__attribute__((target("+crc"))) std::uint32_t ExtendHardware(
+    std::uint32_t crc, char const* p, std::size_t n) {
+  auto c = ~crc;
+  for (; n >= 8; p += 8, n -= 8) {
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    c = __crc32cd(c, v);
+  }
+  for (; n != 0; ++p, --n) c = __crc32cb(c, static_cast<std::uint8_t>(*p));
+  return ~c;
+}
+
+bool HasHardware() { return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0; }
+#else
+std::uint32_t ExtendHardware(std::uint32_t crc, char const* p,
+                             std::size_t n) {
+  return ExtendCrc32cPortable(crc, std::string_view(p, n));
+}
+
+bool HasHardware() { return false; }
+#endif
+
+}  // namespace
+
+std::uint32_t ExtendCrc32c(std::uint32_t crc, std::string_view data) {
+  static bool const kHardware = HasHardware();
+  if (kHardware) return ExtendHardware(crc, data.data(), data.size());
+  return ExtendCrc32cPortable(crc, data);
+}
+
+std::uint32_t ExtendCrc32cPortable(std::uint32_t crc, std::string_view data) {
+  auto const* p = data.data();
+  auto n = data.size();
+  auto c = ~crc;
+  for (; n >= 8; p += 8, n -= 8) {
+    auto const v = LoadLittleEndian64(p) ^ c;
+    c = kTables[7][v & 0xff] ^ kTables[6][(v >> 8) & 0xff] ^
+        kTables[5][(v >> 16) & 0xff] ^ kTables[4][(v >> 24) & 0xff] ^
+        kTables[3][(v >> 32) & 0xff] ^ kTables[2][(v >> 40) & 0xff] ^
+        kTables[1][(v >> 48) & 0xff] ^ kTables[0][v >> 56];
+  }
+  for (; n != 0; ++p, --n) {
+    c = (c >> 8) ^ kTables[0][(c ^ static_cast<unsigned char>(*p)) & 0xff];
+  }
+  return ~c;
+}
+
+bool Crc32cIsHardwareAccelerated() { return HasHardware(); }
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
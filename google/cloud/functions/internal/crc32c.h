@@ -0,0 +1,43 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CRC32C_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CRC32C_H
+
+#include "google/cloud/functions/version.h"
+#include <cstdint>
+#include <string_view>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Returns the CRC32C (Castagnoli) of the data hashed by @p crc, followed by
+ * @p data.
+ *
+ * Start with a @p crc of 0. Uses the SSE4.2 or ARMv8 CRC instructions if the
+ * CPU supports them, and a table-driven implementation otherwise.
+ */
+std::uint32_t ExtendCrc32c(std::uint32_t crc, std::string_view data);
+
+/// The table-driven implementation of `ExtendCrc32c()`, for tests.
+std::uint32_t ExtendCrc32cPortable(std::uint32_t crc, std::string_view data);
+
+/// Returns `true` if `ExtendCrc32c()` uses the CPU instructions.
+bool Crc32cIsHardwareAccelerated();
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_CRC32C_H
@@ -0,0 +1,50 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/crc32c.h"
+#include <gmock/gmock.h>
+#include <string>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+TEST(Crc32cTest, KnownValues) {
+  // See RFC 3720, Appendix B.4.
+  EXPECT_EQ(ExtendCrc32c(0, ""), 0);
+  EXPECT_EQ(ExtendCrc32c(0, "123456789"), 0xe3069283);
+  EXPECT_EQ(ExtendCrc32c(0, std::string(32, '\0')), 0x8a9136aa);
+  EXPECT_EQ(ExtendCrc32c(0, std::string(32, '\xff')), 0x62a8ab43);
+  EXPECT_EQ(ExtendCrc32cPortable(0, "123456789"), 0xe3069283);
+  EXPECT_EQ(ExtendCrc32cPortable(0, std::string(32, '\0')), 0x8a9136aa);
+}
+
+TEST(Crc32cTest, Extend) {
+  std::string data;
+  for (int i = 0; i != 1000; ++i) data.push_back(static_cast<char>(i * 7));
+  auto const expected = ExtendCrc32cPortable(0, data);
+  EXPECT_EQ(ExtendCrc32c(0, data), expected);
+  // Split the data at every offset, including unaligned ones.
+  for (std::size_t split = 0; split != 20; ++split) {
+    auto const head = std::string_view(data).substr(0, split);
+    auto const tail = std::string_view(data).substr(split);
+    EXPECT_EQ(ExtendCrc32c(ExtendCrc32c(0, head), tail), expected);
+    EXPECT_EQ(ExtendCrc32cPortable(ExtendCrc32cPortable(0, head), tail),
+              expected);
+  }
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
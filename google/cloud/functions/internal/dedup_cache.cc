@@ -0,0 +1,78 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/dedup_cache.h"
+#include <iterator>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+DedupCache::DedupCache(std::size_t capacity, Clock::duration ttl,
+                       NowFunction now)
+    : capacity_(capacity), ttl_(ttl), now_(std::move(now)) {
+  index_.reserve(capacity_);
+}
+
+bool DedupCache::Insert(std::string_view source, std::string_view id) {
+  if (capacity_ == 0) return true;
+  auto key = Key(source, id);
+  auto const now = now_();
+  std::lock_guard<std::mutex> lk(mu_);
+  Expire(now);
+  if (index_.count(key) != 0) return false;
+  if (entries_.size() == capacity_) {
+    index_.erase(entries_.front().key);
+    entries_.pop_front();
+  }
+  entries_.push_back(Entry{std::move(key), now + ttl_});
+  // The index refers to the key in the list, which does not move.
+  auto const last = std::prev(entries_.end());
+  index_.emplace(last->key, last);
+  return true;
+}
+
+void DedupCache::Erase(std::string_view source, std::string_view id) {
+  auto const key = Key(source, id);
+  std::lock_guard<std::mutex> lk(mu_);
+  auto const i = index_.find(key);
+  if (i == index_.end()) return;
+  auto const entry = i->second;
+  index_.erase(i);
+  entries_.erase(entry);
+}
+
+std::size_t DedupCache::size() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return entries_.size();
+}
+
+std::string DedupCache::Key(std::string_view source, std::string_view id) {
+  // Prefix the source with its length, so no two pairs share a key.
+  auto key = std::to_string(source.size());
+  key.reserve(key.size() + 1 + source.size() + id.size());
+  key.push_back(':');
+  key.append(source).append(id);
+  return key;
+}
+
+void DedupCache::Expire(Clock::time_point now) {
+  while (!entries_.empty() && entries_.front().expires <= now) {
+    index_.erase(entries_.front().key);
+    entries_.pop_front();
+  }
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
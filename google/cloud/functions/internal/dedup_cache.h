@@ -0,0 +1,72 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_DEDUP_CACHE_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_DEDUP_CACHE_H
+
+#include "google/cloud/functions/cloud_event_dedup.h"
+#include "google/cloud/functions/version.h"
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * A bounded, in-memory `CloudEventDeduplicator` with a time to live.
+ *
+ * The entries are kept in insertion order, which is also their expiration
+ * order, so expired entries are always at the front.
+ */
+class DedupCache : public functions::CloudEventDeduplicator {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using NowFunction = std::function<Clock::time_point()>;
+
+  DedupCache(std::size_t capacity, Clock::duration ttl,
+             NowFunction now = Clock::now);
+
+  bool Insert(std::string_view source, std::string_view id) override;
+  void Erase(std::string_view source, std::string_view id) override;
+
+  [[nodiscard]] std::size_t size() const;
+
+ private:
+  struct Entry {
+    std::string key;
+    Clock::time_point expires;
+  };
+  using List = std::list<Entry>;
+
+  static std::string Key(std::string_view source, std::string_view id);
+  void Expire(Clock::time_point now);
+
+  std::size_t const capacity_;
+  Clock::duration const ttl_;
+  NowFunction const now_;
+  mutable std::mutex mu_;
+  List entries_;
+  std::unordered_map<std::string_view, List::iterator> index_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_DEDUP_CACHE_H
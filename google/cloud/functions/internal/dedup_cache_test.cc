@@ -0,0 +1,81 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/dedup_cache.h"
+#include <gmock/gmock.h>
+#include <chrono>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::std::chrono::seconds;
+
+TEST(DedupCacheTest, Basic) {
+  DedupCache cache(10, seconds(60));
+  EXPECT_TRUE(cache.Insert("source", "id-0"));
+  EXPECT_FALSE(cache.Insert("source", "id-0"));
+  EXPECT_TRUE(cache.Insert("source", "id-1"));
+  EXPECT_TRUE(cache.Insert("other", "id-0"));
+  EXPECT_EQ(cache.size(), 3);
+}
+
+TEST(DedupCacheTest, KeysAreUnambiguous) {
+  DedupCache cache(10, seconds(60));
+  EXPECT_TRUE(cache.Insert("ab", "c"));
+  EXPECT_TRUE(cache.Insert("a", "bc"));
+}
+
+TEST(DedupCacheTest, Erase) {
+  DedupCache cache(10, seconds(60));
+  EXPECT_TRUE(cache.Insert("source", "id-0"));
+  cache.Erase("source", "id-0");
+  cache.Erase("source", "not-found");
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_TRUE(cache.Insert("source", "id-0"));
+}
+
+TEST(DedupCacheTest, Capacity) {
+  DedupCache cache(2, seconds(60));
+  EXPECT_TRUE(cache.Insert("source", "id-0"));
+  EXPECT_TRUE(cache.Insert("source", "id-1"));
+  EXPECT_TRUE(cache.Insert("source", "id-2"));
+  EXPECT_EQ(cache.size(), 2);
+  // The oldest entry was evicted.
+  EXPECT_TRUE(cache.Insert("source", "id-0"));
+  EXPECT_FALSE(cache.Insert("source", "id-2"));
+
+  DedupCache disabled(0, seconds(60));
+  EXPECT_TRUE(disabled.Insert("source", "id-0"));
+  EXPECT_TRUE(disabled.Insert("source", "id-0"));
+}
+
+TEST(DedupCacheTest, Expiration) {
+  auto now = DedupCache::Clock::time_point{};
+  DedupCache cache(10, seconds(60), [&now] { return now; });
+  EXPECT_TRUE(cache.Insert("source", "id-0"));
+  now += seconds(30);
+  EXPECT_TRUE(cache.Insert("source", "id-1"));
+  EXPECT_FALSE(cache.Insert("source", "id-0"));
+  now += seconds(30);
+  EXPECT_TRUE(cache.Insert("source", "id-0"));
+  EXPECT_FALSE(cache.Insert("source", "id-1"));
+  now += seconds(30);
+  EXPECT_TRUE(cache.Insert("source", "id-1"));
+  EXPECT_EQ(cache.size(), 2);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
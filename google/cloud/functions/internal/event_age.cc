@@ -0,0 +1,116 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/event_age.h"
+#include "google/cloud/functions/internal/json_writer.h"
+#include "google/cloud/functions/internal/log_throttle.h"
+#include "google/cloud/functions/internal/parse_time.h"
+#include "google/cloud/functions/internal/request_timing.h"
+#include "google/cloud/functions/internal/structured_log.h"
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+/// The maximum number of stale events logged each second.
+auto constexpr kStaleEventLogRate = 1;
+
+thread_local std::chrono::seconds current_max_age{0};
+
+/// Logs a dropped event, a backlog of stale events must not flood `stderr`.
+void LogStaleEvent(std::string_view id, std::chrono::seconds age) {
+  static auto* const kThrottle = new LogThrottle(kStaleEventLogRate);
+  auto const suppressed = kThrottle->Acquire(LogThrottle::Clock::now());
+  if (!suppressed) return;
+  std::string id_json;
+  JsonAppendString(id_json, id);
+  auto const age_seconds = std::to_string(age.count());
+  auto const dropped = std::to_string(*suppressed);
+  LogField const fields[] = {{"id", id_json},
+                             {"ageSeconds", age_seconds},
+                             {"suppressed", dropped}};
+  WriteLog(functions::LogSeverity::kWarning, "stale Cloud Event dropped",
+           fields);
+}
+
+}  // namespace
+
+EventAgeCutoff::EventAgeCutoff()
+    : EventAgeCutoff(current_max_age, Clock::time_point{}) {
+  if (enabled()) now_ = Clock::now();
+}
+
+EventAgeCutoff::EventAgeCutoff(std::chrono::seconds max_age,
+                               Clock::time_point now)
+    : max_age_(max_age), now_(now) {}
+
+EventAgeCutoff::~EventAgeCutoff() {
+  if (dropped_ != 0) AddRequestStaleEvents(dropped_);
+}
+
+bool EventAgeCutoff::Drop(std::string_view id,
+                          std::optional<Clock::time_point> time) {
+  if (!enabled() || !time) return false;
+  auto const age =
+      std::chrono::duration_cast<std::chrono::seconds>(now_ - *time);
+  if (age < max_age_) return false;
+  ++dropped_;
+  LogStaleEvent(id, age);
+  return true;
+}
+
+bool EventAgeCutoff::Drop(std::string_view id, std::string_view time) {
+  if (!enabled()) return false;
+  auto tp = ParseRfc3339(time);
+  if (!tp) {
+    // The parser reports the invalid timestamps, with the other errors.
+    try {
+      tp = ParseTimestamp(std::string(time));
+    } catch (std::invalid_argument const&) {
+      return false;
+    }
+  }
+  return Drop(id, tp);
+}
+
+std::chrono::seconds CurrentMaxEventAge() { return current_max_age; }
+
+ScopedMaxEventAge::ScopedMaxEventAge(std::chrono::seconds max_age)
+    : previous_(std::exchange(current_max_age, max_age)) {}
+
+ScopedMaxEventAge::~ScopedMaxEventAge() { current_max_age = previous_; }
+
+Handler MakeEventAgeHandler(Handler handler, std::chrono::seconds max_age) {
+  return [h = std::move(handler), max_age](BeastRequest request) {
+    ScopedMaxEventAge scope(max_age);
+    return h(std::move(request));
+  };
+}
+
+AsyncHandler MakeEventAgeAsyncHandler(AsyncHandler handler,
+                                      std::chrono::seconds max_age) {
+  // The functions that run in other threads, such as `WithOffload()`, carry
+  // the maximum age with them.
+  return [h = std::move(handler), max_age](BeastRequest request,
+                                           AsyncResponseCallback done) {
+    ScopedMaxEventAge scope(max_age);
+    h(std::move(request), std::move(done));
+  };
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,104 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_EVENT_AGE_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_EVENT_AGE_H
+
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/version.h"
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Drops the Cloud Events older than the `--max-event-age` of the server.
+ *
+ * Push subscriptions, and other senders, retry the events until the function
+ * succeeds. A message that always fails is redelivered for days, running the
+ * function each time. Functions used to compare the event time against a
+ * threshold themselves, the parsers now drop these events before running the
+ * function, and the request succeeds, which stops the retries.
+ *
+ * Events without a time, or with an invalid time, are never stale. The
+ * parsers create a cutoff for each request, it uses the maximum age of the
+ * current thread, and drops nothing if it is 0.
+ */
+class EventAgeCutoff {
+ public:
+  using Clock = std::chrono::system_clock;
+
+  EventAgeCutoff();
+  EventAgeCutoff(std::chrono::seconds max_age, Clock::time_point now);
+  ~EventAgeCutoff();
+
+  EventAgeCutoff(EventAgeCutoff const&) = delete;
+  EventAgeCutoff& operator=(EventAgeCutoff const&) = delete;
+
+  [[nodiscard]] bool enabled() const {
+    return max_age_ != std::chrono::seconds(0);
+  }
+
+  /// Returns `true`, and counts the event, if @p time is too old.
+  bool Drop(std::string_view id, std::optional<Clock::time_point> time);
+
+  /// Returns `true`, and counts the event, if the RFC 3339 @p time is too old.
+  bool Drop(std::string_view id, std::string_view time);
+
+  /// The number of events dropped so far.
+  [[nodiscard]] std::uint64_t dropped() const { return dropped_; }
+
+ private:
+  std::chrono::seconds max_age_;
+  Clock::time_point now_;
+  std::uint64_t dropped_ = 0;
+};
+
+/// The maximum age of the Cloud Events parsed in the current thread, 0 if
+/// there is no maximum.
+std::chrono::seconds CurrentMaxEventAge();
+
+/// Sets the maximum event age of the current thread.
+class ScopedMaxEventAge {
+ public:
+  explicit ScopedMaxEventAge(std::chrono::seconds max_age);
+  ~ScopedMaxEventAge();
+
+  ScopedMaxEventAge(ScopedMaxEventAge const&) = delete;
+  ScopedMaxEventAge& operator=(ScopedMaxEventAge const&) = delete;
+
+ private:
+  std::chrono::seconds previous_;
+};
+
+/**
+ * Wrap the handlers to drop the events older than @p max_age.
+ *
+ * Only Cloud Event functions parse events, the other handlers are unchanged.
+ * The stale events are counted in the metrics of the request, see
+ * `RequestTiming::stale_events()`.
+ */
+///@{
+Handler MakeEventAgeHandler(Handler handler, std::chrono::seconds max_age);
+AsyncHandler MakeEventAgeAsyncHandler(AsyncHandler handler,
+                                      std::chrono::seconds max_age);
+///@}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_EVENT_AGE_H
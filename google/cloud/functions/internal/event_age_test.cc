@@ -0,0 +1,243 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/event_age.h"
+#include "google/cloud/functions/internal/call_user_cloud_event.h"
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/metrics.h"
+#include "google/cloud/functions/internal/parse_cloud_event_http.h"
+#include "google/cloud/functions/internal/parse_time.h"
+#include "google/cloud/functions/internal/request_timing.h"
+#include "google/cloud/functions/function.h"
+#include <boost/beast/http.hpp>
+#include <gmock/gmock.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace be = ::boost::beast;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using std::chrono::hours;
+using std::chrono::seconds;
+using Clock = EventAgeCutoff::Clock;
+
+std::string Timestamp(Clock::time_point tp) {
+  std::string out;
+  FormatRfc3339(tp, out);
+  return out;
+}
+
+BeastRequest BinaryRequest(std::string const& id, Clock::time_point time) {
+  BeastRequest request;
+  request.method(be::http::verb::post);
+  request.target("/");
+  request.set("ce-id", id);
+  request.set("ce-source", "//test");
+  request.set("ce-type", "com.example.test");
+  request.set("ce-time", Timestamp(time));
+  request.body() = "payload";
+  request.prepare_payload();
+  return request;
+}
+
+using TimedIds = std::vector<std::pair<std::string, Clock::time_point>>;
+
+BeastRequest BatchRequest(TimedIds const& events) {
+  std::string body = "[";
+  for (auto const& [id, time] : events) {
+    if (body.size() != 1) body += ',';
+    body += R"({"specversion":"1.0","id":")" + id +
+            R"(","source":"//test","type":"com.example.test","time":")" +
+            Timestamp(time) + R"("})";
+  }
+  body += ']';
+  BeastRequest request;
+  request.method(be::http::verb::post);
+  request.target("/");
+  request.set(be::http::field::content_type,
+              "application/cloudevents-batch+json");
+  request.body() = std::move(body);
+  request.prepare_payload();
+  return request;
+}
+
+std::vector<std::string> ParsedIds(BeastRequest request) {
+  std::vector<std::string> ids;
+  auto parsed = TryParseCloudEventHttp(
+      std::move(request),
+      [&ids](functions::CloudEvent e) { ids.push_back(e.id()); });
+  EXPECT_TRUE(parsed);
+  return ids;
+}
+
+TEST(EventAgeTest, Disabled) {
+  auto const now = Clock::now();
+  EventAgeCutoff cutoff(seconds(0), now);
+  EXPECT_FALSE(cutoff.enabled());
+  EXPECT_FALSE(cutoff.Drop("id", now - hours(24 * 7)));
+  EXPECT_FALSE(cutoff.Drop("id", Timestamp(now - hours(24 * 7))));
+  EXPECT_EQ(cutoff.dropped(), 0);
+}
+
+TEST(EventAgeTest, Drop) {
+  auto const now = Clock::now();
+  EventAgeCutoff cutoff(seconds(10), now);
+  EXPECT_TRUE(cutoff.enabled());
+  EXPECT_FALSE(cutoff.Drop("id", std::nullopt));
+  EXPECT_FALSE(cutoff.Drop("id", now));
+  EXPECT_FALSE(cutoff.Drop("id", now - seconds(9)));
+  // Events from the future, e.g. with clock skew, are not stale.
+  EXPECT_FALSE(cutoff.Drop("id", now + hours(1)));
+  EXPECT_TRUE(cutoff.Drop("id", now - seconds(10)));
+  EXPECT_TRUE(cutoff.Drop("id", Timestamp(now - hours(1))));
+  EXPECT_FALSE(cutoff.Drop("id", Timestamp(now)));
+  // The parsers report invalid timestamps.
+  EXPECT_FALSE(cutoff.Drop("id", "not a timestamp"));
+  EXPECT_EQ(cutoff.dropped(), 2);
+}
+
+TEST(EventAgeTest, CountsInRequestTiming) {
+  RequestTiming timing;
+  {
+    ScopedRequestTiming scoped(&timing);
+    auto const now = Clock::now();
+    EventAgeCutoff cutoff(seconds(10), now);
+    EXPECT_TRUE(cutoff.Drop("id", now - hours(1)));
+    EXPECT_EQ(timing.stale_events(), 0);
+  }
+  EXPECT_EQ(timing.stale_events(), 1);
+}
+
+TEST(EventAgeTest, Scoped) {
+  EXPECT_EQ(CurrentMaxEventAge(), seconds(0));
+  EXPECT_FALSE(EventAgeCutoff().enabled());
+  {
+    ScopedMaxEventAge scoped(seconds(30));
+    EXPECT_EQ(CurrentMaxEventAge(), seconds(30));
+    EXPECT_TRUE(EventAgeCutoff().enabled());
+  }
+  EXPECT_EQ(CurrentMaxEventAge(), seconds(0));
+}
+
+TEST(EventAgeTest, ParseBinary) {
+  auto const now = Clock::now();
+  EXPECT_THAT(ParsedIds(BinaryRequest("old", now - hours(1))),
+              ElementsAre("old"));
+
+  ScopedMaxEventAge scoped(seconds(60));
+  EXPECT_THAT(ParsedIds(BinaryRequest("old", now - hours(1))), ElementsAre());
+  EXPECT_THAT(ParsedIds(BinaryRequest("new", now)), ElementsAre("new"));
+  auto request = BinaryRequest("no-time", now);
+  request.erase("ce-time");
+  EXPECT_THAT(ParsedIds(std::move(request)), ElementsAre("no-time"));
+}
+
+TEST(EventAgeTest, ParseBatch) {
+  auto const now = Clock::now();
+  ScopedMaxEventAge scoped(seconds(60));
+  EXPECT_THAT(ParsedIds(BatchRequest({{"e0", now},
+                                      {"e1", now - hours(1)},
+                                      {"e2", now - seconds(1)},
+                                      {"e3", now - hours(48)}})),
+              ElementsAre("e0", "e2"));
+}
+
+TEST(EventAgeTest, Handler) {
+  std::vector<std::string> ids;
+  functions::UserCloudEventFunction function =
+      [&ids](functions::CloudEvent const& e) { ids.push_back(e.id()); };
+  auto metrics = std::make_shared<ServerMetrics>();
+  auto handler = MakeTimingHandler(
+      MakeEventAgeHandler(
+          [&function](BeastRequest request) {
+            return CallUserFunction(function, std::move(request));
+          },
+          seconds(60)),
+      RequestTimingOptions{metrics, false});
+
+  auto const now = Clock::now();
+  auto response = handler(BinaryRequest("old", now - hours(1)));
+  EXPECT_EQ(response.result_int(), 200);
+  EXPECT_THAT(ids, ElementsAre());
+  response = handler(BatchRequest({{"e0", now}, {"e1", now - hours(1)}}));
+  EXPECT_EQ(response.result_int(), 200);
+  EXPECT_THAT(ids, ElementsAre("e0"));
+  EXPECT_THAT(metrics->Render(),
+              HasSubstr("functions_framework_stale_events_total 2\n"));
+  // The maximum age applies only while the handler runs.
+  EXPECT_EQ(CurrentMaxEventAge(), seconds(0));
+}
+
+TEST(EventAgeTest, AsyncHandler) {
+  std::vector<std::string> ids;
+  functions::UserCloudEventAsyncFunction function =
+      [&ids](functions::CloudEvent e, functions::CloudEventCallback done) {
+        ids.push_back(e.id());
+        done(nullptr);
+      };
+  auto handler = MakeEventAgeAsyncHandler(
+      [&function](BeastRequest request, AsyncResponseCallback done) {
+        CallUserFunction(function, std::move(request), std::move(done));
+      },
+      seconds(60));
+
+  auto const now = Clock::now();
+  std::vector<unsigned> statuses;
+  auto done = [&statuses](BeastResponse r) {
+    statuses.push_back(r.result_int());
+  };
+  handler(BinaryRequest("old", now - hours(1)), done);
+  handler(BatchRequest({{"e0", now - hours(1)}, {"e1", now}}), done);
+  EXPECT_THAT(statuses, ElementsAre(200, 200));
+  EXPECT_THAT(ids, ElementsAre("e1"));
+}
+
+TEST(EventAgeTest, OtherThreads) {
+  std::mutex mu;
+  std::vector<std::string> ids;
+  functions::UserCloudEventFunction function =
+      [&](functions::CloudEvent const& e) {
+        std::lock_guard<std::mutex> lk(mu);
+        ids.push_back(e.id());
+      };
+  // The synchronous functions run in a pool of the wrapper.
+  auto offload = functions::WithOffload(functions::MakeFunction(function));
+  // The limiter releases its slot after the response, queue the next request.
+  functions::ConcurrencyLimitOptions options;
+  options.max_queue = 1;
+  auto limit = functions::WithConcurrencyLimit(
+      functions::MakeFunction(function), options);
+
+  auto const now = Clock::now();
+  for (auto const& f : {offload, limit}) {
+    auto handler = MakeBlockingHandler(MakeEventAgeAsyncHandler(
+        FunctionImpl::GetImpl(f)->GetAsyncHandler("/"), seconds(60)));
+    auto response = handler(BinaryRequest("old", now - hours(1)));
+    EXPECT_EQ(response.result_int(), 200);
+    response = handler(BinaryRequest("new", now));
+    EXPECT_EQ(response.result_int(), 200);
+  }
+  EXPECT_THAT(ids, ElementsAre("new", "new"));
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
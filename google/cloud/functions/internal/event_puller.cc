@@ -0,0 +1,258 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/event_puller.h"
+#include "google/cloud/functions/internal/cpu_limits.h"
+#include "google/cloud/functions/internal/parse_time.h"
+#include "google/cloud/functions/internal/structured_log.h"
+#include "google/cloud/functions/cloud_event_writer.h"
+#include "google/cloud/functions/json_document.h"
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+namespace be = ::boost::beast;
+
+namespace {
+
+be::string_view ToBeast(std::string_view v) { return {v.data(), v.size()}; }
+
+BeastRequest ToBatchRequest(std::vector<functions::CloudEvent> const& events) {
+  BeastRequest request;
+  request.method(be::http::verb::post);
+  request.target("/");
+  request.set(be::http::field::content_type,
+              "application/cloudevents-batch+json");
+  functions::ToBatchJson(events, request.body());
+  request.prepare_payload();
+  return request;
+}
+
+/// Logs the failures to settle events, the source redelivers them.
+template <typename Callable>
+void CallSource(char const* operation, Callable&& callable) {
+  try {
+    callable();
+  } catch (std::exception const& ex) {
+    WriteLog(functions::LogSeverity::kWarning,
+             std::string(operation) + " failed: " + ex.what());
+  } catch (...) {
+    WriteLog(functions::LogSeverity::kWarning,
+             std::string(operation) + " failed with an unknown exception");
+  }
+}
+
+}  // namespace
+
+BeastRequest ToBinaryRequest(functions::CloudEvent event) {
+  BeastRequest request;
+  request.method(be::http::verb::post);
+  request.target("/");
+  request.set("ce-specversion", ToBeast(event.spec_version_view()));
+  request.set("ce-id", ToBeast(event.id_view()));
+  request.set("ce-source", ToBeast(event.source_view()));
+  request.set("ce-type", ToBeast(event.type_view()));
+  if (auto v = event.data_content_type_view()) {
+    request.set(be::http::field::content_type, ToBeast(*v));
+  }
+  if (auto v = event.data_schema_view()) {
+    request.set("ce-dataschema", ToBeast(*v));
+  }
+  if (auto v = event.subject_view()) request.set("ce-subject", ToBeast(*v));
+  if (auto t = event.time()) {
+    std::string time;
+    FormatRfc3339(*t, time);
+    request.set("ce-time", time);
+  }
+  for (auto const& [name, value] : event.extensions()) {
+    request.set("ce-" + std::string(name), ToBeast(value));
+  }
+  if (auto data = std::move(event).data()) {
+    request.body() = *std::move(data);
+    request.prepare_payload();
+  }
+  return request;
+}
+
+std::vector<bool> FailedBatchEvents(BeastResponse const& response,
+                                    std::size_t count) {
+  if (response.result_int() / 100 == 2) return std::vector<bool>(count);
+  std::vector<bool> failed(count);
+  auto listed = false;
+  try {
+    functions::JsonDocument const json(response.body().str());
+    for (std::size_t i = 0;; ++i) {
+      auto const index =
+          json.get_int64("/errors/" + std::to_string(i) + "/index");
+      if (!index) break;
+      if (*index < 0 || static_cast<std::size_t>(*index) >= count) continue;
+      failed[static_cast<std::size_t>(*index)] = true;
+      listed = true;
+    }
+  } catch (std::exception const&) {
+    // Not a batch failure, e.g., the function returned a plain error.
+  }
+  if (!listed) failed.assign(count, true);
+  return failed;
+}
+
+EventPuller::EventPuller(std::shared_ptr<functions::CloudEventSource> source,
+                         functions::PullOptions options)
+    : source_(std::move(source)), options_(options) {
+  if (options_.concurrency == 0) options_.concurrency = DefaultConcurrency();
+  options_.max_batch_size = (std::max)(options_.max_batch_size, std::size_t{1});
+  options_.ack_batch_size = (std::max)(options_.ack_batch_size, std::size_t{1});
+}
+
+EventPuller::~EventPuller() { Stop(); }
+
+void EventPuller::Start(Handler handler) {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (running_) return;
+  running_ = true;
+  lk.unlock();
+  handler_ = std::move(handler);
+  for (std::size_t i = 0; i != options_.concurrency; ++i) {
+    workers_.emplace_back([this] { Work(); });
+  }
+  flusher_ = std::thread([this] { FlushLoop(); });
+}
+
+void EventPuller::Stop() {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (!running_) return;
+  running_ = false;
+  lk.unlock();
+  cv_.notify_all();
+  for (auto& t : workers_) t.join();
+  workers_.clear();
+  flusher_.join();
+  Flush(std::unique_lock<std::mutex>(mu_));
+}
+
+void EventPuller::Work() {
+  for (;;) {
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      if (!running_) return;
+    }
+    std::vector<functions::PulledCloudEvent> pulled;
+    CallSource("Pulling events", [&] {
+      pulled = source_->Pull(options_.max_batch_size, kPullTimeout);
+    });
+    if (!pulled.empty()) Deliver(std::move(pulled));
+  }
+}
+
+void EventPuller::Deliver(std::vector<functions::PulledCloudEvent> pulled) {
+  auto const count = pulled.size();
+  std::vector<std::string> ack_ids;
+  std::vector<functions::CloudEvent> events;
+  ack_ids.reserve(count);
+  events.reserve(count);
+  for (auto& p : pulled) {
+    ack_ids.push_back(std::move(p.ack_id));
+    events.push_back(std::move(p.event));
+  }
+  std::vector<bool> failed(count, true);
+  try {
+    auto request = count == 1 ? ToBinaryRequest(std::move(events.front()))
+                              : ToBatchRequest(events);
+    failed = FailedBatchEvents(handler_(std::move(request)), count);
+  } catch (...) {
+    // The handlers report the function failures as responses, this is a
+    // failure of the framework, e.g., an event that cannot be formatted.
+  }
+  std::vector<std::string> acks;
+  std::vector<std::string> nacks;
+  for (std::size_t i = 0; i != count; ++i) {
+    (failed[i] ? nacks : acks).push_back(std::move(ack_ids[i]));
+  }
+  Settle(std::move(acks), std::move(nacks));
+}
+
+void EventPuller::Settle(std::vector<std::string> acks,
+                         std::vector<std::string> nacks) {
+  std::unique_lock<std::mutex> lk(mu_);
+  acks_.insert(acks_.end(), std::make_move_iterator(acks.begin()),
+               std::make_move_iterator(acks.end()));
+  nacks_.insert(nacks_.end(), std::make_move_iterator(nacks.begin()),
+                std::make_move_iterator(nacks.end()));
+  if (acks_.size() + nacks_.size() < options_.ack_batch_size) return;
+  Flush(std::move(lk));
+}
+
+void EventPuller::Flush(std::unique_lock<std::mutex> lk) {
+  auto acks = std::exchange(acks_, {});
+  auto nacks = std::exchange(nacks_, {});
+  lk.unlock();
+  if (!acks.empty()) {
+    CallSource("Acknowledging events",
+               [&] { source_->Ack(std::move(acks)); });
+  }
+  if (!nacks.empty()) {
+    CallSource("Returning failed events",
+               [&] { source_->Nack(std::move(nacks)); });
+  }
+}
+
+void EventPuller::FlushLoop() {
+  std::unique_lock<std::mutex> lk(mu_);
+  while (running_) {
+    cv_.wait_for(lk, options_.ack_delay);
+    if (acks_.empty() && nacks_.empty()) continue;
+    Flush(std::move(lk));
+    lk = std::unique_lock<std::mutex>(mu_);
+  }
+}
+
+PullFunctionImpl::PullFunctionImpl(std::shared_ptr<FunctionImpl> impl,
+                                   std::shared_ptr<EventPuller> puller)
+    : LifecycleFunctionImpl(impl, WarmupHandler{}, ShutdownHandler{}),
+      impl_(std::move(impl)),
+      puller_(std::move(puller)) {}
+
+std::vector<WarmupHandler> PullFunctionImpl::GetWarmupHandlers(
+    std::string_view target) const {
+  // Events must not run before the function is ready.
+  return {[warmups = impl_->GetWarmupHandlers(target),
+           handler = impl_->GetHandler(target), puller = puller_] {
+    RunWarmup(warmups);
+    puller->Start(handler);
+  }};
+}
+
+std::vector<ShutdownHandler> PullFunctionImpl::GetShutdownHandlers(
+    std::string_view target) const {
+  auto handlers = impl_->GetShutdownHandlers(target);
+  handlers.emplace_back([puller = puller_] { puller->Stop(); });
+  return handlers;
+}
+
+std::vector<CheckpointHandler> PullFunctionImpl::GetCheckpointHandlers(
+    std::string_view target) const {
+  auto handlers = impl_->GetCheckpointHandlers(target);
+  handlers.push_back(CheckpointHandler{
+      [puller = puller_] { puller->Stop(); },
+      [handler = impl_->GetHandler(target), puller = puller_] {
+        puller->Start(handler);
+      }});
+  return handlers;
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
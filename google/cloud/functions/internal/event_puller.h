@@ -0,0 +1,118 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_EVENT_PULLER_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_EVENT_PULLER_H
+
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/pull_source.h"
+#include "google/cloud/functions/version.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// How long each pull waits for events before checking for a stop.
+auto constexpr kPullTimeout = std::chrono::milliseconds(200);
+
+/**
+ * Formats @p event as a request in the binary content mode.
+ *
+ * The data is moved into the request body. The request is parsed in the same
+ * process, the attributes are not validated as header values.
+ */
+BeastRequest ToBinaryRequest(functions::CloudEvent event);
+
+/**
+ * Returns the events of a batch of @p count that failed, given the response.
+ *
+ * A failed batch lists the failed and skipped events in its response, see
+ * `functions::CloudEventBatchError`. Otherwise all the events failed.
+ */
+std::vector<bool> FailedBatchEvents(BeastResponse const& response,
+                                    std::size_t count);
+
+/**
+ * Runs a function with the events of a `functions::CloudEventSource`.
+ *
+ * Each worker thread pulls a batch of events, runs it, and settles its events
+ * before pulling again. The acknowledgements of all the workers are sent
+ * together, once enough are pending, or after a delay.
+ */
+class EventPuller {
+ public:
+  EventPuller(std::shared_ptr<functions::CloudEventSource> source,
+              functions::PullOptions options);
+  ~EventPuller();
+
+  /// Starts pulling events, and running them with @p handler.
+  void Start(Handler handler);
+
+  /// Stops pulling, waits for the events in progress, and settles them.
+  void Stop();
+
+ private:
+  void Work();
+  void Deliver(std::vector<functions::PulledCloudEvent> pulled);
+  void Settle(std::vector<std::string> acks, std::vector<std::string> nacks);
+  void Flush(std::unique_lock<std::mutex> lk);
+  void FlushLoop();
+
+  std::shared_ptr<functions::CloudEventSource> source_;
+  functions::PullOptions options_;
+  Handler handler_;
+  std::vector<std::thread> workers_;
+  std::thread flusher_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  bool running_ = false;
+  std::vector<std::string> acks_;
+  std::vector<std::string> nacks_;
+};
+
+/// Runs a function with pulled events, see `functions::WithPullSource()`.
+class PullFunctionImpl : public LifecycleFunctionImpl {
+ public:
+  PullFunctionImpl(std::shared_ptr<FunctionImpl> impl,
+                   std::shared_ptr<EventPuller> puller);
+  ~PullFunctionImpl() override = default;
+
+  /// Runs the warmup handlers of the function, and then starts pulling.
+  [[nodiscard]] std::vector<WarmupHandler> GetWarmupHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<ShutdownHandler> GetShutdownHandlers(
+      std::string_view target) const override;
+  /// Stops pulling while the server is checkpointed.
+  [[nodiscard]] std::vector<CheckpointHandler> GetCheckpointHandlers(
+      std::string_view target) const override;
+
+ private:
+  std::shared_ptr<FunctionImpl> impl_;
+  std::shared_ptr<EventPuller> puller_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_EVENT_PULLER_H
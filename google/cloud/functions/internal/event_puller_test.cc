@@ -0,0 +1,221 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/event_puller.h"
+#include "google/cloud/functions/internal/parse_cloud_event_http.h"
+#include "google/cloud/functions/function.h"
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+
+/// Delivers a fixed list of events, the ack ids are the event ids.
+class FakeSource : public functions::CloudEventSource {
+ public:
+  explicit FakeSource(int count) {
+    for (int i = 0; i != count; ++i) {
+      events_.emplace_back("id-" + std::to_string(i), "/source", "type");
+    }
+  }
+
+  std::vector<functions::PulledCloudEvent> Pull(
+      std::size_t max_events, std::chrono::milliseconds timeout) override {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait_for(lk, timeout, [this] { return !events_.empty(); });
+    std::vector<functions::PulledCloudEvent> pulled;
+    while (!events_.empty() && pulled.size() != max_events) {
+      auto id = events_.front().id();
+      pulled.push_back({std::move(events_.front()), std::move(id)});
+      events_.pop_front();
+    }
+    return pulled;
+  }
+
+  void Ack(std::vector<std::string> ack_ids) override {
+    std::lock_guard<std::mutex> lk(mu_);
+    ack_calls_.push_back(ack_ids.size());
+    acks_.insert(acks_.end(), ack_ids.begin(), ack_ids.end());
+    cv_.notify_all();
+  }
+
+  void Nack(std::vector<std::string> ack_ids) override {
+    std::lock_guard<std::mutex> lk(mu_);
+    nacks_.insert(nacks_.end(), ack_ids.begin(), ack_ids.end());
+    cv_.notify_all();
+  }
+
+  /// Waits until @p count events are settled.
+  void WaitSettled(std::size_t count) {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait(lk, [&] { return acks_.size() + nacks_.size() >= count; });
+  }
+
+  std::vector<std::string> acks() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return acks_;
+  }
+  std::vector<std::string> nacks() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return nacks_;
+  }
+  bool drained() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return events_.empty();
+  }
+  std::vector<std::size_t> ack_calls() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return ack_calls_;
+  }
+
+ private:
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<functions::CloudEvent> events_;
+  std::vector<std::string> acks_;
+  std::vector<std::string> nacks_;
+  std::vector<std::size_t> ack_calls_;
+};
+
+Handler FailingHandler(std::vector<std::string> failures) {
+  return FunctionImpl::GetImpl(
+             functions::MakeFunction(
+                 [failures](functions::CloudEvent const& event) {
+                   auto const f = std::find(failures.begin(), failures.end(),
+                                            event.id());
+                   if (f != failures.end()) throw std::runtime_error("uh-oh");
+                 }))
+      ->GetHandler("");
+}
+
+TEST(EventPullerTest, ToBinaryRequest) {
+  functions::CloudEvent event("id-1", "/source", "com.example.type");
+  event.set_subject("subject");
+  event.set_data_content_type("text/plain");
+  event.set_extension("myextension", "value");
+  event.set_data(std::string(1024, 'x'));
+  auto const* data = event.data_view()->data();
+
+  auto request = ToBinaryRequest(std::move(event));
+  EXPECT_EQ(request.body().data(), data);
+  auto events = ParseCloudEventHttp(request);
+  ASSERT_EQ(events.size(), 1);
+  auto const& e = events.front();
+  EXPECT_EQ(e.id(), "id-1");
+  EXPECT_EQ(e.source(), "/source");
+  EXPECT_EQ(e.type(), "com.example.type");
+  EXPECT_EQ(e.subject().value_or(""), "subject");
+  EXPECT_EQ(e.data_content_type().value_or(""), "text/plain");
+  EXPECT_EQ(e.extension("myextension").value_or(""), "value");
+  EXPECT_EQ(e.data().value_or(""), std::string(1024, 'x'));
+
+  events = ParseCloudEventHttp(
+      ToBinaryRequest(functions::CloudEvent("id-2", "/source", "type")));
+  ASSERT_EQ(events.size(), 1);
+  EXPECT_FALSE(events.front().data().has_value());
+}
+
+TEST(EventPullerTest, FailedBatchEvents) {
+  BeastResponse response;
+  EXPECT_THAT(FailedBatchEvents(response, 3), ElementsAre(false, false, false));
+
+  response.result(boost::beast::http::status::internal_server_error);
+  response.body() = "plain error";
+  EXPECT_THAT(FailedBatchEvents(response, 2), ElementsAre(true, true));
+
+  response.body() =
+      R"js({"message":"2 of 3 events in the batch failed","errors":[)js"
+      R"js({"index":0,"id":"a","message":"x"},)js"
+      R"js({"index":2,"id":"c","message":"y"},)js"
+      R"js({"index":7,"id":"z","message":"out of range"}]})js";
+  EXPECT_THAT(FailedBatchEvents(response, 3), ElementsAre(true, false, true));
+}
+
+TEST(EventPullerTest, AcksAndNacks) {
+  auto source = std::make_shared<FakeSource>(10);
+  functions::PullOptions options;
+  options.concurrency = 2;
+  options.ack_batch_size = 3;
+  EventPuller puller(source, options);
+  puller.Start(FailingHandler({"id-3", "id-7"}));
+  source->WaitSettled(10);
+  puller.Stop();
+  EXPECT_EQ(source->acks().size(), 8);
+  EXPECT_THAT(source->nacks(), UnorderedElementsAre("id-3", "id-7"));
+}
+
+TEST(EventPullerTest, Batches) {
+  auto source = std::make_shared<FakeSource>(5);
+  functions::PullOptions options;
+  options.concurrency = 1;
+  options.max_batch_size = 10;
+  EventPuller puller(source, options);
+  // The events in a batch run in order, the first failure skips the others.
+  puller.Start(FailingHandler({"id-2"}));
+  source->WaitSettled(5);
+  puller.Stop();
+  EXPECT_THAT(source->acks(), ElementsAre("id-0", "id-1"));
+  EXPECT_THAT(source->nacks(), ElementsAre("id-2", "id-3", "id-4"));
+}
+
+TEST(EventPullerTest, StopFlushesAcks) {
+  auto source = std::make_shared<FakeSource>(5);
+  functions::PullOptions options;
+  options.concurrency = 1;
+  options.ack_delay = std::chrono::hours(1);
+  EventPuller puller(source, options);
+  puller.Start(FailingHandler({}));
+  // Wait until the source is drained, the acks are still pending.
+  while (!source->drained()) std::this_thread::yield();
+  EXPECT_THAT(source->acks(), IsEmpty());
+  puller.Stop();
+  EXPECT_THAT(source->ack_calls(), ElementsAre(5));
+}
+
+TEST(EventPullerTest, WithPullSource) {
+  auto source = std::make_shared<FakeSource>(4);
+  functions::PullOptions options;
+  options.concurrency = 2;
+  auto warmed_up = false;
+  auto function = functions::WithPullSource(
+      functions::WithWarmup(
+          functions::MakeFunction([&](functions::CloudEvent const&) {
+            EXPECT_TRUE(warmed_up);
+          }),
+          [&] { warmed_up = true; }),
+      source, options);
+  auto impl = FunctionImpl::GetImpl(function);
+  RunWarmup(impl->GetWarmupHandlers(""));
+  source->WaitSettled(4);
+  for (auto const& h : impl->GetShutdownHandlers("")) h();
+  EXPECT_EQ(source->acks().size(), 4);
+  EXPECT_THAT(source->nacks(), IsEmpty());
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
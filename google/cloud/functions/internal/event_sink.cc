@@ -0,0 +1,405 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/event_sink.h"
+#include "google/cloud/functions/internal/client_event_loop.h"
+#include "google/cloud/functions/internal/structured_log.h"
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <future>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace asio = ::boost::asio;
+namespace be = ::boost::beast;
+
+thread_local std::shared_ptr<EmissionTracker>* current_tracker = nullptr;
+
+/// The live sinks, intentionally leaked like the other registries.
+struct Registry {
+  std::mutex mu;
+  std::vector<std::weak_ptr<EventSinkImpl>> sinks;
+  /// Without sinks the requests do not need a tracker.
+  std::atomic<bool> started{false};
+};
+
+Registry& GetRegistry() {
+  static auto* const kRegistry = new Registry;
+  return *kRegistry;
+}
+
+bool SinksStarted() {
+  return GetRegistry().started.load(std::memory_order_relaxed);
+}
+
+/// The batches of each format go to a different endpoint, even for the same
+/// URL.
+std::string BatchKey(std::string const& url, EventSinkImpl::Format format) {
+  auto const prefix =
+      format == EventSinkImpl::Format::kCloudEventBatch ? "e:" : "p:";
+  return prefix + url;
+}
+
+std::string ErrorMessage(std::exception_ptr const& error) try {
+  std::rethrow_exception(error);
+} catch (std::exception const& ex) {
+  return ex.what();
+} catch (...) {
+  return "unknown error";
+}
+
+void LogDeliveryFailure() {
+  WriteLog(functions::LogSeverity::kError,
+           "Could not deliver the events queued by the request");
+}
+
+BeastResponse DeliveryFailed() {
+  LogDeliveryFailure();
+  BeastResponse response;
+  response.result(be::http::status::internal_server_error);
+  return response;
+}
+
+}  // namespace
+
+void EmissionTracker::Add() {
+  std::lock_guard<std::mutex> lk(mu_);
+  ++pending_;
+}
+
+void EmissionTracker::Done(bool ok) {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (!ok) failed_ = true;
+  if (--pending_ != 0 || !callback_) return;
+  auto callback = std::exchange(callback_, {});
+  auto const failed = failed_;
+  lk.unlock();
+  callback(!failed);
+}
+
+void EmissionTracker::OnDelivered(std::function<void(bool)> callback) {
+  std::vector<std::weak_ptr<EventSinkImpl>> sinks;
+  {
+    std::unique_lock<std::mutex> lk(mu_);
+    if (pending_ == 0) {
+      auto const failed = failed_;
+      lk.unlock();
+      return callback(!failed);
+    }
+    callback_ = std::move(callback);
+    sinks.swap(sinks_);
+  }
+  // The batches are not full yet, the response is waiting for them.
+  for (auto const& s : sinks) {
+    if (auto sink = s.lock()) sink->Expedite(*this);
+  }
+}
+
+bool EmissionTracker::Wait() {
+  std::promise<bool> done;
+  OnDelivered([&done](bool ok) { done.set_value(ok); });
+  return done.get_future().get();
+}
+
+EventSinkImpl::EventSinkImpl(functions::EventSinkOptions options,
+                             EventSinkTransport transport)
+    : options_(std::move(options)), transport_(std::move(transport)) {
+  options_.max_batch_messages = std::max<std::size_t>(
+      options_.max_batch_messages, 1);
+}
+
+EventSinkImpl::~EventSinkImpl() { Shutdown(); }
+
+void EventSinkImpl::Start() {
+  work_.emplace(asio::make_work_guard(ioc_));
+  thread_ = std::thread([this] {
+    // The client calls started here never run in a server event loop.
+    ScopedEventLoopThread current(ioc_);
+    ioc_.run();
+  });
+  auto& registry = GetRegistry();
+  std::lock_guard<std::mutex> lk(registry.mu);
+  registry.sinks.erase(
+      std::remove_if(registry.sinks.begin(), registry.sinks.end(),
+                     [](auto const& s) { return s.expired(); }),
+      registry.sinks.end());
+  registry.sinks.push_back(weak_from_this());
+  registry.started.store(true);
+}
+
+void EventSinkImpl::Queue(std::string const& url, Format format,
+                          std::string item) {
+  auto tracker = CurrentEmissionTracker();
+  if (tracker) {
+    tracker->Add();
+    std::lock_guard<std::mutex> lk(tracker->mu_);
+    auto const self = weak_from_this();
+    auto const& sinks = tracker->sinks_;
+    auto const known = std::any_of(sinks.begin(), sinks.end(), [&](auto& s) {
+      return !s.owner_before(self) && !self.owner_before(s);
+    });
+    if (!known) tracker->sinks_.push_back(self);
+  }
+  auto const key = BatchKey(url, format);
+  std::lock_guard<std::mutex> lk(mu_);
+  ++pending_;
+  std::vector<Batch> ready;
+  auto i = batches_.find(key);
+  if (i != batches_.end() &&
+      i->second.body.size() + item.size() + 1 > options_.max_batch_bytes) {
+    ready.push_back(std::move(i->second));
+    batches_.erase(i);
+    i = batches_.end();
+  }
+  if (i == batches_.end()) {
+    auto const id = ++next_id_;
+    i = batches_.emplace(key, Batch{url, format, {}, 0, id, {}}).first;
+    asio::post(ioc_, [this, key, id] {
+      auto timer =
+          std::make_shared<asio::steady_timer>(ioc_, options_.max_batch_delay);
+      timer->async_wait([this, timer, key, id](be::error_code ec) {
+        if (!ec) Expire(key, id);
+      });
+    });
+  }
+  auto& batch = i->second;
+  if (batch.count != 0) batch.body.push_back(',');
+  batch.body += item;
+  ++batch.count;
+  if (tracker) batch.trackers.push_back(std::move(tracker));
+  if (batch.count >= options_.max_batch_messages) {
+    ready.push_back(std::move(batch));
+    batches_.erase(i);
+  }
+  Post(std::move(ready));
+}
+
+bool EventSinkImpl::Flush(std::chrono::steady_clock::duration timeout) {
+  std::unique_lock<std::mutex> lk(mu_);
+  Post(TakeIf([](Batch const&) { return true; }));
+  return idle_.wait_for(lk, timeout, [this] { return pending_ == 0; });
+}
+
+void EventSinkImpl::Flush() {
+  std::unique_lock<std::mutex> lk(mu_);
+  Post(TakeIf([](Batch const&) { return true; }));
+  idle_.wait(lk, [this] { return pending_ == 0; });
+}
+
+void EventSinkImpl::Shutdown() {
+  if (!thread_.joinable()) return;
+  Flush();
+  work_.reset();
+  // The pending timers never fire once the sink is flushed.
+  ioc_.stop();
+  thread_.join();
+}
+
+std::size_t EventSinkImpl::pending() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return pending_;
+}
+
+std::uint64_t EventSinkImpl::failed() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return failed_;
+}
+
+void EventSinkImpl::Expedite(EmissionTracker const& tracker) {
+  std::lock_guard<std::mutex> lk(mu_);
+  Post(TakeIf([&tracker](Batch const& b) {
+    return std::any_of(
+        b.trackers.begin(), b.trackers.end(),
+        [&tracker](auto const& t) { return t.get() == &tracker; });
+  }));
+}
+
+std::vector<EventSinkImpl::Batch> EventSinkImpl::TakeIf(
+    std::function<bool(Batch const&)> const& pred) {
+  std::vector<Batch> taken;
+  for (auto i = batches_.begin(); i != batches_.end();) {
+    if (!pred(i->second)) {
+      ++i;
+      continue;
+    }
+    taken.push_back(std::move(i->second));
+    i = batches_.erase(i);
+  }
+  return taken;
+}
+
+void EventSinkImpl::Post(std::vector<Batch> batches) {
+  for (auto& b : batches) {
+    asio::post(ioc_,
+               [this, b = std::move(b)]() mutable { Send(std::move(b)); });
+  }
+}
+
+void EventSinkImpl::Expire(std::string const& key, std::uint64_t id) {
+  std::lock_guard<std::mutex> lk(mu_);
+  auto i = batches_.find(key);
+  // The batch may be full, or expedited, already.
+  if (i == batches_.end() || i->second.id != id) return;
+  std::vector<Batch> expired;
+  expired.push_back(std::move(i->second));
+  batches_.erase(i);
+  Post(std::move(expired));
+}
+
+void EventSinkImpl::Send(Batch batch) {
+  auto request = functions::HttpRequest{}.set_verb("POST");
+  if (batch.format == Format::kCloudEventBatch) {
+    request.set_target(batch.url)
+        .add_header("content-type", "application/cloudevents-batch+json")
+        .set_payload("[" + batch.body + "]");
+  } else {
+    request.set_target(batch.url + ":publish")
+        .add_header("content-type", "application/json")
+        .set_payload(R"({"messages":[)" + batch.body + "]}");
+  }
+  auto callback = [self = shared_from_this(), trackers = batch.trackers,
+                   count = batch.count](
+                      std::exception_ptr error,
+                      functions::HttpResponse response) {
+    auto constexpr kFirstError = 300;
+    auto const ok = !error && response.result() >= 200 &&
+                    response.result() < kFirstError;
+    if (!ok) {
+      WriteLog(functions::LogSeverity::kError,
+               "Could not deliver a batch of " + std::to_string(count) +
+                   " events, " +
+                   (error ? ErrorMessage(error)
+                          : "status " + std::to_string(response.result())));
+    }
+    self->OnSent(trackers, count, ok);
+  };
+  try {
+    transport_(std::move(request), std::move(callback));
+  } catch (...) {
+    // The transport calls the callback on errors, except for invalid
+    // requests, such as URLs it does not support.
+    OnSent(batch.trackers, batch.count, false);
+  }
+}
+
+void EventSinkImpl::OnSent(
+    std::vector<std::shared_ptr<EmissionTracker>> const& trackers,
+    std::size_t count, bool ok) {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    pending_ -= count;
+    if (!ok) failed_ += count;
+    if (pending_ == 0) idle_.notify_all();
+  }
+  for (auto const& t : trackers) t->Done(ok);
+}
+
+bool DrainEventSinks(std::chrono::steady_clock::duration timeout) {
+  auto const deadline = std::chrono::steady_clock::now() + timeout;
+  std::vector<std::shared_ptr<EventSinkImpl>> sinks;
+  {
+    auto& registry = GetRegistry();
+    std::lock_guard<std::mutex> lk(registry.mu);
+    for (auto const& s : registry.sinks) {
+      if (auto sink = s.lock()) sinks.push_back(std::move(sink));
+    }
+  }
+  auto drained = true;
+  for (auto const& s : sinks) {
+    auto const remaining = std::max(deadline - std::chrono::steady_clock::now(),
+                                    std::chrono::steady_clock::duration(0));
+    drained = s->Flush(remaining) && drained;
+  }
+  return drained;
+}
+
+ScopedEmissions::ScopedEmissions(std::shared_ptr<EmissionTracker>& tracker)
+    : previous_(std::exchange(current_tracker, &tracker)) {}
+
+ScopedEmissions::~ScopedEmissions() { current_tracker = previous_; }
+
+std::shared_ptr<EmissionTracker> CurrentEmissionTracker() {
+  if (current_tracker == nullptr) return nullptr;
+  if (!SinksStarted()) return nullptr;
+  if (!*current_tracker) *current_tracker = std::make_shared<EmissionTracker>();
+  return *current_tracker;
+}
+
+Handler MakeEventSinkHandler(Handler handler) {
+  return [h = std::move(handler)](BeastRequest request) {
+    std::shared_ptr<EmissionTracker> tracker;
+    auto response = [&] {
+      ScopedEmissions scope(tracker);
+      return h(std::move(request));
+    }();
+    if (tracker && !tracker->Wait()) return DeliveryFailed();
+    return response;
+  };
+}
+
+StreamingHandler MakeEventSinkStreamingHandler(StreamingHandler handler) {
+  return [h = std::move(handler)](BeastRequest request,
+                                  functions::HttpRequestBodyReader& reader) {
+    std::shared_ptr<EmissionTracker> tracker;
+    auto response = [&] {
+      ScopedEmissions scope(tracker);
+      return h(std::move(request), reader);
+    }();
+    if (tracker && !tracker->Wait()) return DeliveryFailed();
+    return response;
+  };
+}
+
+WriterHandler MakeEventSinkWriterHandler(WriterHandler handler) {
+  return [h = std::move(handler)](BeastRequest request,
+                                  ResponseWriter& writer) {
+    std::shared_ptr<EmissionTracker> tracker;
+    auto const complete = [&] {
+      ScopedEmissions scope(tracker);
+      return h(std::move(request), writer);
+    }();
+    if (tracker && !tracker->Wait()) {
+      LogDeliveryFailure();
+      return false;
+    }
+    return complete;
+  };
+}
+
+AsyncHandler MakeEventSinkAsyncHandler(AsyncHandler handler) {
+  return [h = std::move(handler)](BeastRequest request,
+                                  AsyncResponseCallback done) {
+    // The function may complete in any thread, the tracker must exist before
+    // it starts. The requests need none until the process creates a sink.
+    if (!SinksStarted()) return h(std::move(request), std::move(done));
+    auto tracker = std::make_shared<EmissionTracker>();
+    auto wrapped = [tracker, done = std::move(done)](BeastResponse response) {
+      tracker->OnDelivered(
+          [done, r = std::move(response)](bool ok) mutable {
+            done(ok ? std::move(r) : DeliveryFailed());
+          });
+    };
+    ScopedEmissions scope(tracker);
+    h(std::move(request), std::move(wrapped));
+  };
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
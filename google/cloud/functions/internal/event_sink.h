@@ -0,0 +1,197 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_EVENT_SINK_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_EVENT_SINK_H
+
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/event_sink.h"
+#include "google/cloud/functions/http_client.h"
+#include "google/cloud/functions/version.h"
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// Sends a batch, the tests replace the `functions::HttpClient`.
+using EventSinkTransport = std::function<void(functions::HttpRequest,
+                                              functions::HttpClientCallback)>;
+
+/**
+ * The messages queued by one request.
+ *
+ * The framework delivers them before the response, see `ScopedEmissions`.
+ */
+class EmissionTracker {
+ public:
+  void Add();
+  void Done(bool ok);
+
+  /// Calls @p callback once all the messages are delivered, or failed.
+  void OnDelivered(std::function<void(bool)> callback);
+
+  /// Blocks until all the messages are delivered, returns false on failures.
+  bool Wait();
+
+ private:
+  friend class EventSinkImpl;
+
+  std::mutex mu_;
+  std::size_t pending_ = 0;
+  bool failed_ = false;
+  std::function<void(bool)> callback_;
+  /// The sinks with messages from this request, to send them right away.
+  std::vector<std::weak_ptr<EventSinkImpl>> sinks_;
+};
+
+/**
+ * Batches the messages of a `functions::EventSink`.
+ *
+ * The open batches are protected by a mutex, the queuing threads only append
+ * to them. The sink runs its own event loop, in a single thread, to expire
+ * the batches and to start the calls. The calls run in the event loop picked
+ * by the client, which is never a server event loop from this thread, so the
+ * functions can block on the delivery.
+ */
+class EventSinkImpl : public std::enable_shared_from_this<EventSinkImpl> {
+ public:
+  enum class Format { kCloudEventBatch, kPubsubPublish };
+
+  EventSinkImpl(functions::EventSinkOptions options,
+                EventSinkTransport transport);
+  ~EventSinkImpl();
+
+  /// Starts the event loop, and makes the sink visible to `DrainEventSinks()`.
+  void Start();
+
+  /// Queues @p item, a JSON value in @p format, for @p url.
+  void Queue(std::string const& url, Format format, std::string item);
+
+  /// Sends all the batches, and waits for the deliveries.
+  void Flush();
+
+  /// Sends all the batches, and waits up to @p timeout for the deliveries.
+  bool Flush(std::chrono::steady_clock::duration timeout);
+
+  /// Flushes the sink, and stops its event loop.
+  void Shutdown();
+
+  [[nodiscard]] std::size_t pending() const;
+  [[nodiscard]] std::uint64_t failed() const;
+
+  /// Sends the batches with messages from @p tracker right away.
+  void Expedite(EmissionTracker const& tracker);
+
+ private:
+  struct Batch {
+    std::string url;
+    Format format;
+    std::string body;
+    std::size_t count = 0;
+    std::uint64_t id = 0;
+    std::vector<std::shared_ptr<EmissionTracker>> trackers;
+  };
+
+  // These require `mu_`.
+  std::vector<Batch> TakeIf(std::function<bool(Batch const&)> const& pred);
+  void Post(std::vector<Batch> batches);
+
+  void Expire(std::string const& key, std::uint64_t id);
+  void Send(Batch batch);
+  void OnSent(std::vector<std::shared_ptr<EmissionTracker>> const& trackers,
+              std::size_t count, bool ok);
+
+  functions::EventSinkOptions options_;
+  EventSinkTransport transport_;
+  boost::asio::io_context ioc_{1};
+  std::optional<boost::asio::executor_work_guard<
+      boost::asio::io_context::executor_type>>
+      work_;
+  std::thread thread_;
+  mutable std::mutex mu_;
+  std::condition_variable idle_;
+  std::map<std::string, Batch> batches_;
+  std::uint64_t next_id_ = 0;
+  std::size_t pending_ = 0;
+  std::uint64_t failed_ = 0;
+};
+
+/**
+ * Flushes all the sinks, waits up to @p timeout for all the deliveries.
+ *
+ * Returns `false` if any message is still pending.
+ */
+bool DrainEventSinks(std::chrono::steady_clock::duration timeout);
+
+/**
+ * Tracks the messages queued by the current thread.
+ *
+ * The messages queued while @p tracker is current are delivered before the
+ * response. If @p tracker is null, the scope creates one on the first
+ * message.
+ */
+class ScopedEmissions {
+ public:
+  explicit ScopedEmissions(std::shared_ptr<EmissionTracker>& tracker);
+  ~ScopedEmissions();
+
+  ScopedEmissions(ScopedEmissions const&) = delete;
+  ScopedEmissions& operator=(ScopedEmissions const&) = delete;
+
+ private:
+  std::shared_ptr<EmissionTracker>* previous_;
+};
+
+/**
+ * The tracker of the current thread, creates it if needed, may be null.
+ *
+ * The tasks that run a request in another thread capture it, and install it
+ * with a `ScopedEmissions` in that thread. It is null until the process
+ * starts a sink.
+ */
+std::shared_ptr<EmissionTracker> CurrentEmissionTracker();
+
+/**
+ * Returns handlers that deliver the messages queued by each request before
+ * its response.
+ *
+ * A failed delivery replaces the response with `500 Internal Server Error`,
+ * so the caller retries the request. The writer handlers have already sent
+ * their header, their response is marked incomplete instead.
+ */
+///@{
+Handler MakeEventSinkHandler(Handler handler);
+StreamingHandler MakeEventSinkStreamingHandler(StreamingHandler handler);
+WriterHandler MakeEventSinkWriterHandler(WriterHandler handler);
+AsyncHandler MakeEventSinkAsyncHandler(AsyncHandler handler);
+///@}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_EVENT_SINK_H
@@ -0,0 +1,289 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/event_sink.h"
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/function.h"
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace be = ::boost::beast;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using Format = EventSinkImpl::Format;
+
+/// Records the batches, and answers each with @p status.
+class FakeTransport {
+ public:
+  explicit FakeTransport(int status = 200) : status_(status) {}
+
+  EventSinkTransport transport() {
+    return [this](functions::HttpRequest request,
+                  functions::HttpClientCallback callback) {
+      {
+        std::lock_guard<std::mutex> lk(mu_);
+        requests_.push_back(request);
+      }
+      if (status_ == 0) {
+        return callback(std::make_exception_ptr(std::runtime_error("fail")),
+                        {});
+      }
+      callback({}, functions::HttpResponse{}.set_result(status_));
+    };
+  }
+
+  std::vector<std::string> payloads() {
+    std::lock_guard<std::mutex> lk(mu_);
+    std::vector<std::string> payloads;
+    for (auto const& r : requests_) payloads.emplace_back(r.payload());
+    return payloads;
+  }
+
+  std::vector<functions::HttpRequest> requests() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return requests_;
+  }
+
+ private:
+  int status_;
+  std::mutex mu_;
+  std::vector<functions::HttpRequest> requests_;
+};
+
+std::shared_ptr<EventSinkImpl> MakeSink(FakeTransport& transport,
+                                        functions::EventSinkOptions options) {
+  auto sink = std::make_shared<EventSinkImpl>(std::move(options),
+                                              transport.transport());
+  sink->Start();
+  return sink;
+}
+
+functions::EventSinkOptions Options(std::size_t messages, std::size_t bytes,
+                                    std::chrono::milliseconds delay) {
+  functions::EventSinkOptions options;
+  options.max_batch_messages = messages;
+  options.max_batch_bytes = bytes;
+  options.max_batch_delay = delay;
+  return options;
+}
+
+auto constexpr kLongDelay = std::chrono::hours(1);
+
+TEST(EventSinkTest, BatchByCount) {
+  FakeTransport transport;
+  auto sink = MakeSink(transport, Options(3, 1024, kLongDelay));
+  for (auto const* item : {"1", "2", "3", "4", "5", "6", "7"}) {
+    sink->Queue("http://a/events", Format::kCloudEventBatch, item);
+  }
+  sink->Flush();
+  EXPECT_EQ(sink->pending(), 0);
+  EXPECT_EQ(sink->failed(), 0);
+  EXPECT_THAT(transport.payloads(),
+              ElementsAre("[1,2,3]", "[4,5,6]", "[7]"));
+  auto const requests = transport.requests();
+  ASSERT_EQ(requests.size(), 3);
+  EXPECT_EQ(requests[0].verb(), "POST");
+  EXPECT_EQ(requests[0].target(), "http://a/events");
+  EXPECT_EQ(requests[0].headers().get("content-type"),
+            "application/cloudevents-batch+json");
+  sink->Shutdown();
+}
+
+TEST(EventSinkTest, BatchByBytes) {
+  FakeTransport transport;
+  auto sink = MakeSink(transport, Options(100, 8, kLongDelay));
+  for (auto const* item : {"111", "222", "333", "444444444"}) {
+    sink->Queue("http://a/events", Format::kCloudEventBatch, item);
+  }
+  sink->Flush();
+  EXPECT_THAT(transport.payloads(),
+              ElementsAre("[111,222]", "[333]", "[444444444]"));
+  sink->Shutdown();
+}
+
+TEST(EventSinkTest, BatchByDelay) {
+  FakeTransport transport;
+  auto sink =
+      MakeSink(transport, Options(100, 1024, std::chrono::milliseconds(10)));
+  sink->Queue("http://a/events", Format::kCloudEventBatch, "1");
+  sink->Queue("http://a/events", Format::kCloudEventBatch, "2");
+  auto const deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (sink->pending() != 0 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_EQ(sink->pending(), 0);
+  EXPECT_THAT(transport.payloads(), ElementsAre("[1,2]"));
+  sink->Shutdown();
+}
+
+TEST(EventSinkTest, Destinations) {
+  FakeTransport transport;
+  auto sink = MakeSink(transport, Options(100, 1024, kLongDelay));
+  sink->Queue("http://a/events", Format::kCloudEventBatch, "1");
+  sink->Queue("http://b/events", Format::kCloudEventBatch, "2");
+  sink->Queue("http://p/v1/projects/p/topics/t", Format::kPubsubPublish, "3");
+  sink->Queue("http://a/events", Format::kCloudEventBatch, "4");
+  sink->Flush();
+  std::vector<std::string> sent;
+  for (auto const& r : transport.requests()) {
+    sent.push_back(r.target() + " " + r.payload());
+  }
+  std::sort(sent.begin(), sent.end());
+  EXPECT_THAT(sent, ElementsAre("http://a/events [1,4]",
+                                "http://b/events [2]",
+                                "http://p/v1/projects/p/topics/t:publish "
+                                R"({"messages":[3]})"));
+  sink->Shutdown();
+}
+
+TEST(EventSinkTest, Failures) {
+  for (auto status : {0, 500}) {
+    SCOPED_TRACE("status=" + std::to_string(status));
+    FakeTransport transport(status);
+    auto sink = MakeSink(transport, Options(100, 1024, kLongDelay));
+    sink->Queue("http://a/events", Format::kCloudEventBatch, "1");
+    sink->Queue("http://a/events", Format::kCloudEventBatch, "2");
+    EXPECT_TRUE(sink->Flush(std::chrono::seconds(10)));
+    EXPECT_EQ(sink->failed(), 2);
+    sink->Shutdown();
+  }
+}
+
+TEST(EventSinkTest, TransportThrows) {
+  auto sink = std::make_shared<EventSinkImpl>(
+      Options(100, 1024, kLongDelay),
+      [](functions::HttpRequest const&, functions::HttpClientCallback const&) {
+        throw std::invalid_argument("unsupported URL");
+      });
+  sink->Start();
+  sink->Queue("https://a/events", Format::kCloudEventBatch, "1");
+  sink->Flush();
+  EXPECT_EQ(sink->failed(), 1);
+  sink->Shutdown();
+}
+
+TEST(EventSinkTest, HandlerWaitsForDelivery) {
+  FakeTransport transport;
+  auto sink = MakeSink(transport, Options(100, 1024, kLongDelay));
+  auto handler = MakeEventSinkHandler([&](BeastRequest) {
+    sink->Queue("http://a/events", Format::kCloudEventBatch, "1");
+    sink->Queue("http://a/events", Format::kCloudEventBatch, "2");
+    EXPECT_THAT(transport.payloads(), IsEmpty());
+    BeastResponse response;
+    response.result(be::http::status::ok);
+    return response;
+  });
+  auto const response = handler(BeastRequest{});
+  EXPECT_EQ(response.result(), be::http::status::ok);
+  EXPECT_THAT(transport.payloads(), ElementsAre("[1,2]"));
+  EXPECT_EQ(sink->pending(), 0);
+
+  // Requests without messages do not wait.
+  auto empty = MakeEventSinkHandler([](BeastRequest) {
+    return BeastResponse{be::http::status::accepted, 11};
+  });
+  EXPECT_EQ(empty(BeastRequest{}).result(), be::http::status::accepted);
+  sink->Shutdown();
+}
+
+TEST(EventSinkTest, HandlerDeliveryFailure) {
+  FakeTransport transport(503);
+  auto sink = MakeSink(transport, Options(100, 1024, kLongDelay));
+  auto handler = MakeEventSinkHandler([&](BeastRequest) {
+    sink->Queue("http://a/events", Format::kCloudEventBatch, "1");
+    return BeastResponse{be::http::status::ok, 11};
+  });
+  EXPECT_EQ(handler(BeastRequest{}).result(),
+            be::http::status::internal_server_error);
+
+  auto writer = MakeEventSinkWriterHandler([&](BeastRequest, ResponseWriter&) {
+    sink->Queue("http://a/events", Format::kCloudEventBatch, "2");
+    return true;
+  });
+  class NullWriter : public ResponseWriter {
+   public:
+    void WriteHeader(BeastResponse) override {}
+    void Write(std::string_view) override {}
+  } null_writer;
+  EXPECT_FALSE(writer(BeastRequest{}, null_writer));
+  sink->Shutdown();
+}
+
+TEST(EventSinkTest, AsyncHandlerWaitsForDelivery) {
+  FakeTransport transport;
+  auto sink = MakeSink(transport, Options(100, 1024, kLongDelay));
+  std::promise<AsyncResponseCallback> started;
+  auto handler = MakeEventSinkAsyncHandler(
+      [&](BeastRequest, AsyncResponseCallback done) {
+        sink->Queue("http://a/events", Format::kCloudEventBatch, "1");
+        started.set_value(std::move(done));
+      });
+  std::promise<BeastResponse> response;
+  handler(BeastRequest{}, [&response](BeastResponse r) {
+    response.set_value(std::move(r));
+  });
+  // The function completes in another thread.
+  auto done = started.get_future().get();
+  std::thread([done = std::move(done)] {
+    done(BeastResponse{be::http::status::ok, 11});
+  }).join();
+  EXPECT_EQ(response.get_future().get().result(), be::http::status::ok);
+  EXPECT_THAT(transport.payloads(), ElementsAre("[1]"));
+  sink->Shutdown();
+}
+
+TEST(EventSinkTest, OffloadedFunctions) {
+  FakeTransport transport;
+  auto sink = MakeSink(transport, Options(100, 1024, kLongDelay));
+  auto function = functions::WithOffload(
+      functions::MakeFunction([&](functions::HttpRequest const&) {
+        sink->Queue("http://a/events", Format::kCloudEventBatch, "1");
+        return functions::HttpResponse{};
+      }));
+  auto impl = FunctionImpl::GetImpl(function);
+  // The function runs in the offload pool, the response still waits.
+  auto handler = MakeEventSinkHandler(impl->GetHandler("/"));
+  EXPECT_EQ(handler(BeastRequest{}).result(), be::http::status::ok);
+  EXPECT_THAT(transport.payloads(), ElementsAre("[1]"));
+  auto async = MakeBlockingHandler(
+      MakeEventSinkAsyncHandler(impl->GetAsyncHandler("/")));
+  EXPECT_EQ(async(BeastRequest{}).result(), be::http::status::ok);
+  EXPECT_THAT(transport.payloads(), ElementsAre("[1]", "[1]"));
+  sink->Shutdown();
+}
+
+TEST(EventSinkTest, DrainEventSinks) {
+  FakeTransport transport;
+  auto sink = MakeSink(transport, Options(100, 1024, kLongDelay));
+  sink->Queue("http://a/events", Format::kCloudEventBatch, "1");
+  EXPECT_TRUE(DrainEventSinks(std::chrono::seconds(10)));
+  EXPECT_THAT(transport.payloads(), ElementsAre("[1]"));
+  sink->Shutdown();
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,140 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_EVENT_TYPE_TABLE_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_EVENT_TYPE_TABLE_H
+
+#include "google/cloud/functions/version.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// A seeded FNV-1a hash, usable in constant expressions.
+constexpr std::uint64_t HashEventType(std::uint64_t seed,
+                                      std::string_view type) {
+  auto constexpr kOffsetBasis = std::uint64_t{14695981039346656037ULL};
+  auto constexpr kPrime = std::uint64_t{1099511628211ULL};
+  auto hash = kOffsetBasis ^ (seed * 0x9e3779b97f4a7c15ULL);
+  for (auto c : type) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= kPrime;
+  }
+  return hash ^ (hash >> 32);
+}
+
+/**
+ * Maps @p N CloudEvent types to their index, with a single probe in most
+ * cases.
+ *
+ * The constructor searches for a hash seed that places every type in its own
+ * slot, a perfect hash. The table has at least 8 slots for each type, the
+ * search almost always succeeds for the tables used to dispatch events, with
+ * tens of types. Otherwise it keeps the seed with the shortest probes, and
+ * lookups still find all the types.
+ *
+ * The constructor is `constexpr`, tables built from string literals can be
+ * computed at compile time. Lookups do not allocate.
+ */
+template <std::size_t N>
+class EventTypeTable {
+ public:
+  static_assert(N != 0, "an event type table needs at least one type");
+
+  /// Returned by `Find()` for the types not in the table.
+  static auto constexpr kNotFound = N;
+
+  /// @throws std::invalid_argument if @p types has duplicates.
+  constexpr explicit EventTypeTable(std::array<std::string_view, N> types)
+      : types_(types) {
+    for (std::size_t i = 0; i != N; ++i) {
+      for (std::size_t j = i + 1; j != N; ++j) {
+        if (types_[i] == types_[j]) {
+          throw std::invalid_argument("duplicate CloudEvent type");
+        }
+      }
+    }
+    auto best_seed = std::uint64_t{0};
+    auto best_probes = kSlots + 1;
+    for (std::uint64_t seed = 0; seed != kMaxSeeds && best_probes != 1;
+         ++seed) {
+      auto const probes = Fill(seed);
+      if (probes >= best_probes) continue;
+      best_seed = seed;
+      best_probes = probes;
+    }
+    max_probes_ = Fill(best_seed);
+    seed_ = best_seed;
+  }
+
+  /// Returns the index of @p type, or `kNotFound`.
+  [[nodiscard]] constexpr std::size_t Find(std::string_view type) const {
+    auto slot = HashEventType(seed_, type) & kMask;
+    for (std::size_t p = 0; p != max_probes_; ++p) {
+      auto const entry = slots_[slot];
+      if (entry == 0) break;
+      if (types_[entry - 1] == type) return entry - 1;
+      slot = (slot + 1) & kMask;
+    }
+    return kNotFound;
+  }
+
+  /// The longest lookup, in slots. 1 if the hash is perfect.
+  [[nodiscard]] constexpr std::size_t max_probes() const {
+    return max_probes_;
+  }
+
+ private:
+  static constexpr std::size_t SlotCount() {
+    std::size_t slots = 8;
+    while (slots < 8 * N) slots *= 2;
+    return slots;
+  }
+
+  static auto constexpr kSlots = SlotCount();
+  static auto constexpr kMask = kSlots - 1;
+  static auto constexpr kMaxSeeds = std::uint64_t{256};
+
+  /// Places the types with @p seed, returns the longest probe sequence.
+  constexpr std::size_t Fill(std::uint64_t seed) {
+    for (auto& s : slots_) s = 0;
+    std::size_t longest = 0;
+    for (std::size_t i = 0; i != N; ++i) {
+      auto slot = HashEventType(seed, types_[i]) & kMask;
+      std::size_t probes = 1;
+      while (slots_[slot] != 0) {
+        slot = (slot + 1) & kMask;
+        ++probes;
+      }
+      slots_[slot] = static_cast<std::uint32_t>(i + 1);
+      if (probes > longest) longest = probes;
+    }
+    return longest;
+  }
+
+  std::array<std::string_view, N> types_;
+  /// The index of the type in each slot, plus 1. Empty slots are 0.
+  std::array<std::uint32_t, kSlots> slots_{};
+  std::uint64_t seed_ = 0;
+  std::size_t max_probes_ = 0;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_EVENT_TYPE_TABLE_H
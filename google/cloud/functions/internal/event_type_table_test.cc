@@ -0,0 +1,74 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/event_type_table.h"
+#include <gmock/gmock.h>
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+auto constexpr kTable = EventTypeTable<3>({
+    "google.cloud.pubsub.topic.v1.messagePublished",
+    "google.cloud.storage.object.v1.finalized",
+    "google.cloud.storage.object.v1.deleted",
+});
+
+// The table is computed at compile time.
+static_assert(kTable.Find("google.cloud.storage.object.v1.finalized") == 1);
+static_assert(kTable.Find("unknown") == decltype(kTable)::kNotFound);
+static_assert(kTable.max_probes() == 1);
+
+TEST(EventTypeTableTest, Find) {
+  EXPECT_EQ(kTable.Find("google.cloud.pubsub.topic.v1.messagePublished"), 0);
+  EXPECT_EQ(kTable.Find("google.cloud.storage.object.v1.finalized"), 1);
+  EXPECT_EQ(kTable.Find("google.cloud.storage.object.v1.deleted"), 2);
+  EXPECT_EQ(kTable.Find(""), 3);
+  EXPECT_EQ(kTable.Find("google.cloud.storage.object.v1.Deleted"), 3);
+  EXPECT_EQ(kTable.Find("google.cloud.storage.object.v1.deleted.extra"), 3);
+}
+
+TEST(EventTypeTableTest, ManyTypes) {
+  std::vector<std::string> names;
+  std::array<std::string_view, 64> types;
+  names.reserve(types.size());
+  for (std::size_t i = 0; i != types.size(); ++i) {
+    names.push_back("com.example.event.v" + std::to_string(i));
+  }
+  for (std::size_t i = 0; i != types.size(); ++i) types[i] = names[i];
+  EventTypeTable<64> table(types);
+  EXPECT_EQ(table.max_probes(), 1);
+  for (std::size_t i = 0; i != types.size(); ++i) {
+    EXPECT_EQ(table.Find(types[i]), i) << types[i];
+  }
+  EXPECT_EQ(table.Find("com.example.event.v64"), 64);
+}
+
+TEST(EventTypeTableTest, Duplicates) {
+  EXPECT_THROW(EventTypeTable<3>({"a", "b", "a"}), std::invalid_argument);
+}
+
+TEST(EventTypeTableTest, HashIsSeeded) {
+  EXPECT_NE(HashEventType(0, "a"), HashEventType(1, "a"));
+  EXPECT_NE(HashEventType(0, "a"), HashEventType(0, "b"));
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,268 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/fast_request_parser.h"
+#include <boost/beast/core/string.hpp>
+#include <algorithm>
+#include <array>
+#include <optional>
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define FUNCTIONS_FRAMEWORK_CPP_FAST_PARSER_X86 1
+#endif
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace be = ::boost::beast;
+
+/// The maximum number of headers, requests with more use Boost.Beast.
+auto constexpr kMaxFields = 64;
+
+/// The `tchar` characters of RFC 7230, used in methods and header names.
+constexpr std::array<bool, 256> MakeTokenTable() {
+  std::array<bool, 256> table{};
+  for (auto c = '0'; c <= '9'; ++c) table[static_cast<unsigned char>(c)] = true;
+  for (auto c = 'a'; c <= 'z'; ++c) table[static_cast<unsigned char>(c)] = true;
+  for (auto c = 'A'; c <= 'Z'; ++c) table[static_cast<unsigned char>(c)] = true;
+  for (auto c : std::string_view("!#$%&'*+-.^_`|~")) {
+    table[static_cast<unsigned char>(c)] = true;
+  }
+  return table;
+}
+
+constexpr auto kToken = MakeTokenTable();
+
+bool IsToken(char c) { return kToken[static_cast<unsigned char>(c)]; }
+
+bool IsDelimiter(char c, bool stop_at_space) {
+  auto const u = static_cast<unsigned char>(c);
+  if (stop_at_space) return u <= 0x20 || u == 0x7F;
+  return (u < 0x20 && u != '\t') || u == 0x7F;
+}
+
+char const* FindPortable(char const* p, char const* end, bool stop_at_space) {
+  while (p != end && !IsDelimiter(*p, stop_at_space)) ++p;
+  return p;
+}
+
+#if FUNCTIONS_FRAMEWORK_CPP_FAST_PARSER_X86
+bool HasSse42() { return __builtin_cpu_supports("sse4.2"); }
+bool HasAvx2() { return __builtin_cpu_supports("avx2"); }
+
+__attribute__((target("sse4.2"))) char const* FindSse42(char const* p,
+                                                        char const* end,
+                                                        bool stop_at_space) {
+  // Pairs of inclusive bounds, the value ranges skip HTAB.
+  alignas(16) static char const kValueRanges[16] = {0x00, 0x08, 0x0a,
+                                                    0x1f, 0x7f, 0x7f};
+  alignas(16) static char const kTargetRanges[16] = {0x00, 0x20, 0x7f, 0x7f};
+  auto const ranges = _mm_load_si128(reinterpret_cast<__m128i const*>(
+      stop_at_space ? kTargetRanges : kValueRanges));
+  auto const ranges_size = stop_at_space ? 4 : 6;
+  for (; end - p >= 16; p += 16) {
+    auto const b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+    auto const i = _mm_cmpestri(
+        ranges, ranges_size, b, 16,
+        _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+    if (i != 16) return p + i;
+  }
+  return FindPortable(p, end, stop_at_space);
+}
+
+__attribute__((target("avx2"))) char const* FindAvx2(char const* p,
+                                                     char const* end,
+                                                     bool stop_at_space) {
+  auto const control = _mm256_set1_epi8(0x1f);
+  auto const del = _mm256_set1_epi8(0x7f);
+  auto const tab = _mm256_set1_epi8('\t');
+  auto const space = _mm256_set1_epi8(' ');
+  for (; end - p >= 32; p += 32) {
+    auto const b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+    // The unsigned bytes up to 0x1f are unchanged by the minimum.
+    auto found = _mm256_cmpeq_epi8(_mm256_min_epu8(b, control), b);
+    found = _mm256_or_si256(found, _mm256_cmpeq_epi8(b, del));
+    if (stop_at_space) {
+      found = _mm256_or_si256(found, _mm256_cmpeq_epi8(b, space));
+    } else {
+      found = _mm256_andnot_si256(_mm256_cmpeq_epi8(b, tab), found);
+    }
+    auto const mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(found));
+    if (mask != 0) return p + __builtin_ctz(mask);
+  }
+  return FindPortable(p, end, stop_at_space);
+}
+#endif  // FUNCTIONS_FRAMEWORK_CPP_FAST_PARSER_X86
+
+using FindFunction = char const* (*)(char const*, char const*, bool);
+
+FindFunction SelectFind() {
+#if FUNCTIONS_FRAMEWORK_CPP_FAST_PARSER_X86
+  if (HasAvx2()) return FindAvx2;
+  if (HasSse42()) return FindSse42;
+#endif  // FUNCTIONS_FRAMEWORK_CPP_FAST_PARSER_X86
+  return FindPortable;
+}
+
+/// Parses a `Content-Length` value, Boost.Beast handles any other format.
+std::optional<std::uint64_t> ParseContentLength(std::string_view value) {
+  auto constexpr kMaxDigits = 19;
+  if (value.empty() || value.size() > kMaxDigits) return std::nullopt;
+  std::uint64_t length = 0;
+  for (auto c : value) {
+    if (c < '0' || c > '9') return std::nullopt;
+    length = length * 10 + static_cast<std::uint64_t>(c - '0');
+  }
+  return length;
+}
+
+}  // namespace
+
+char const* FindLineDelimiter(char const* p, char const* end,
+                              bool stop_at_space) {
+  static auto const kFind = SelectFind();
+  return kFind(p, end, stop_at_space);
+}
+
+char const* FindLineDelimiterPortable(char const* p, char const* end,
+                                      bool stop_at_space) {
+  return FindPortable(p, end, stop_at_space);
+}
+
+char const* FindLineDelimiterSse42(char const* p, char const* end,
+                                   bool stop_at_space) {
+#if FUNCTIONS_FRAMEWORK_CPP_FAST_PARSER_X86
+  static auto const kSupported = HasSse42();
+  if (kSupported) return FindSse42(p, end, stop_at_space);
+#endif  // FUNCTIONS_FRAMEWORK_CPP_FAST_PARSER_X86
+  return FindPortable(p, end, stop_at_space);
+}
+
+char const* FindLineDelimiterAvx2(char const* p, char const* end,
+                                  bool stop_at_space) {
+#if FUNCTIONS_FRAMEWORK_CPP_FAST_PARSER_X86
+  static auto const kSupported = HasAvx2();
+  if (kSupported) return FindAvx2(p, end, stop_at_space);
+#endif  // FUNCTIONS_FRAMEWORK_CPP_FAST_PARSER_X86
+  return FindPortable(p, end, stop_at_space);
+}
+
+std::string_view FastParserInstructions() {
+#if FUNCTIONS_FRAMEWORK_CPP_FAST_PARSER_X86
+  if (HasAvx2()) return "avx2";
+  if (HasSse42()) return "sse4.2";
+#endif  // FUNCTIONS_FRAMEWORK_CPP_FAST_PARSER_X86
+  return "portable";
+}
+
+std::size_t FastParseRequest(std::string_view data, FastParseLimits limits,
+                             BeastRequest& request) {
+  struct Field {
+    std::string_view name;
+    std::string_view value;
+  };
+  std::array<Field, kMaxFields> fields;
+  std::size_t field_count = 0;
+  std::optional<std::uint64_t> content_length;
+
+  auto const* const begin = data.data();
+  // A header over the limit is never complete here, Boost.Beast rejects it.
+  auto const* const end =
+      begin + std::min<std::size_t>(data.size(), limits.max_header_size);
+  auto const* p = begin;
+  auto view = [](char const* first, char const* last) {
+    return std::string_view(first, static_cast<std::size_t>(last - first));
+  };
+
+  auto const* const method_begin = p;
+  while (p != end && IsToken(*p)) ++p;
+  if (p == method_begin || p == end || *p != ' ') return 0;
+  auto const method = view(method_begin, p);
+  ++p;
+
+  auto const* const target_begin = p;
+  p = FindLineDelimiter(p, end, /*stop_at_space=*/true);
+  if (p == target_begin || p == end || *p != ' ') return 0;
+  auto const target = view(target_begin, p);
+  ++p;
+
+  auto constexpr kVersionLine = std::string_view("HTTP/1.x\r\n");
+  if (static_cast<std::size_t>(end - p) < kVersionLine.size()) return 0;
+  if (view(p, p + 7) != kVersionLine.substr(0, 7)) return 0;
+  if ((p[7] != '0' && p[7] != '1') || p[8] != '\r' || p[9] != '\n') return 0;
+  auto const version = p[7] == '1' ? 11U : 10U;
+  p += kVersionLine.size();
+
+  for (;;) {
+    if (end - p < 2) return 0;
+    if (p[0] == '\r') {
+      if (p[1] != '\n') return 0;
+      p += 2;
+      break;
+    }
+    if (field_count == fields.size()) return 0;
+    auto const* const name_begin = p;
+    while (p != end && IsToken(*p)) ++p;
+    if (p == name_begin || p == end || *p != ':') return 0;
+    auto const name = view(name_begin, p);
+    ++p;
+    while (p != end && (*p == ' ' || *p == '\t')) ++p;
+    auto const* const value_begin = p;
+    p = FindLineDelimiter(p, end, /*stop_at_space=*/false);
+    if (end - p < 2 || p[0] != '\r' || p[1] != '\n') return 0;
+    auto const* value_end = p;
+    while (value_end != value_begin &&
+           (value_end[-1] == ' ' || value_end[-1] == '\t')) {
+      --value_end;
+    }
+    p += 2;
+    // Obsolete line folding continues the value in the next line.
+    if (p != end && (*p == ' ' || *p == '\t')) return 0;
+    auto const value = view(value_begin, value_end);
+    if (be::iequals(name, "content-length")) {
+      if (content_length) return 0;
+      content_length = ParseContentLength(value);
+      if (!content_length) return 0;
+    } else if (be::iequals(name, "transfer-encoding") ||
+               be::iequals(name, "upgrade")) {
+      return 0;
+    }
+    fields[field_count++] = Field{name, value};
+  }
+
+  auto const header_size = static_cast<std::size_t>(p - begin);
+  auto const body_size = content_length.value_or(0);
+  if (body_size > limits.max_body_size) return 0;
+  if (body_size > data.size() - header_size) return 0;
+
+  // Build the request as the Boost.Beast parser does.
+  auto const verb = be::http::string_to_verb(method);
+  if (verb != be::http::verb::unknown) {
+    request.method(verb);
+  } else {
+    request.method_string(method);
+  }
+  request.target(target);
+  request.version(version);
+  for (std::size_t i = 0; i != field_count; ++i) {
+    auto const& f = fields[i];
+    request.insert(be::http::string_to_field(f.name), f.name, f.value);
+  }
+  request.body().assign(p, static_cast<std::size_t>(body_size));
+  return header_size + static_cast<std::size_t>(body_size);
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
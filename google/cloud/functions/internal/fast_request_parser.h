@@ -0,0 +1,79 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_FAST_REQUEST_PARSER_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_FAST_REQUEST_PARSER_H
+
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/version.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// The limits of the requests parsed by `FastParseRequest()`.
+struct FastParseLimits {
+  std::uint32_t max_header_size;
+  std::uint64_t max_body_size;
+};
+
+/**
+ * Parses a complete HTTP/1.x request from @p data into @p request.
+ *
+ * Most requests arrive in a single read: the request line, a few headers,
+ * and a small body, if any. This parser handles those requests in one pass
+ * over contiguous memory, finding the end of each line with SSE4.2 or AVX2
+ * instructions when the CPU supports them, as picohttpparser does. Boost.Beast
+ * examines one byte at a time.
+ *
+ * Returns the number of bytes consumed, or 0 if the request must be parsed
+ * by Boost.Beast, leaving @p request unchanged. That is the case if the
+ * request is incomplete, is malformed, exceeds @p limits, has a
+ * `Transfer-Encoding` or `Upgrade` header, uses obsolete line folding, or is
+ * not HTTP/1.0 or HTTP/1.1. Boost.Beast then reports any errors as usual.
+ * The requests parsed here are identical to those parsed by Boost.Beast.
+ */
+std::size_t FastParseRequest(std::string_view data, FastParseLimits limits,
+                             BeastRequest& request);
+
+/// The instructions used by `FastParseRequest()`, `avx2`, `sse4.2`, or
+/// `portable`.
+std::string_view FastParserInstructions();
+
+/**
+ * Returns the first byte in [@p p, @p end) that ends a header value or target.
+ *
+ * That is any control character except HTAB, and also the space if
+ * @p stop_at_space, or @p end if there is none. The dispatching overload
+ * uses the fastest implementation for the CPU. The others are exposed for
+ * testing, and use the portable implementation if the CPU does not support
+ * their instructions.
+ */
+///@{
+char const* FindLineDelimiter(char const* p, char const* end,
+                              bool stop_at_space);
+char const* FindLineDelimiterPortable(char const* p, char const* end,
+                                      bool stop_at_space);
+char const* FindLineDelimiterSse42(char const* p, char const* end,
+                                   bool stop_at_space);
+char const* FindLineDelimiterAvx2(char const* p, char const* end,
+                                  bool stop_at_space);
+///@}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_FAST_REQUEST_PARSER_H
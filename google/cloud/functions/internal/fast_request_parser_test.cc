@@ -0,0 +1,176 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/fast_request_parser.h"
+#include <gmock/gmock.h>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace be = ::boost::beast;
+
+auto constexpr kLimits = FastParseLimits{8 * 1024, 1024 * 1024};
+
+/// The request as parsed by Boost.Beast, with the bytes it consumed.
+std::pair<std::size_t, BeastRequest> BeastParse(std::string const& data) {
+  be::http::parser<true, be::http::string_body, FieldsAllocator<char>> parser;
+  parser.eager(true);
+  be::error_code ec;
+  auto const n = parser.put(boost::asio::buffer(data), ec);
+  EXPECT_FALSE(ec) << ec.message();
+  EXPECT_TRUE(parser.is_done());
+  return {n, parser.release()};
+}
+
+std::vector<std::pair<std::string, std::string>> Fields(
+    BeastRequest const& request) {
+  std::vector<std::pair<std::string, std::string>> fields;
+  for (auto const& f : request) {
+    fields.emplace_back(std::string(f.name_string()), std::string(f.value()));
+  }
+  return fields;
+}
+
+TEST(FastRequestParserTest, SameAsBeast) {
+  std::string const requests[] = {
+      "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n",
+      "GET /a/b?c=d&e=%20 HTTP/1.0\r\n\r\n",
+      "POST /upload HTTP/1.1\r\nHost: example.com\r\n"
+      "Content-Type: application/json\r\nContent-Length: 13\r\n"
+      "Connection: keep-alive\r\n\r\n{\"a\": \"b c\"}\n",
+      "PURGE /cache HTTP/1.1\r\nx-custom-header:   padded value \t \r\n"
+      "X-Empty:\r\nx-tab:\ta\tb\r\nx-utf8: caf\xc3\xa9\r\n\r\n",
+      "DELETE /" + std::string(300, 'x') +
+          " HTTP/1.1\r\nx-long: " + std::string(500, 'v') + "\r\n\r\n",
+  };
+  for (auto const& data : requests) {
+    SCOPED_TRACE(data);
+    auto [expected_size, expected] = BeastParse(data);
+    BeastRequest actual;
+    auto const n = FastParseRequest(data, kLimits, actual);
+    EXPECT_EQ(n, expected_size);
+    EXPECT_EQ(n, data.size());
+    EXPECT_EQ(actual.method(), expected.method());
+    EXPECT_EQ(actual.method_string(), expected.method_string());
+    EXPECT_EQ(actual.target(), expected.target());
+    EXPECT_EQ(actual.version(), expected.version());
+    EXPECT_EQ(actual.keep_alive(), expected.keep_alive());
+    EXPECT_EQ(Fields(actual), Fields(expected));
+    EXPECT_EQ(actual.body(), expected.body());
+  }
+}
+
+TEST(FastRequestParserTest, Pipelined) {
+  std::string const first =
+      "POST /a HTTP/1.1\r\nContent-Length: 3\r\n\r\nabc";
+  std::string const data = first + "GET /b HTTP/1.1\r\n\r\n";
+  BeastRequest request;
+  EXPECT_EQ(FastParseRequest(data, kLimits, request), first.size());
+  EXPECT_EQ(request.target(), "/a");
+  EXPECT_EQ(request.body(), "abc");
+}
+
+TEST(FastRequestParserTest, Fallback) {
+  std::string const requests[] = {
+      // Incomplete.
+      "",
+      "GET / HTTP/1.1\r\nHost: localhost\r\n",
+      "GET / HTTP/1.1\r\nHost: local",
+      "POST / HTTP/1.1\r\nContent-Length: 10\r\n\r\nabc",
+      // Other framing, or protocols.
+      "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n",
+      "GET / HTTP/1.1\r\nUpgrade: websocket\r\n\r\n",
+      "GET / HTTP/2.0\r\n\r\n",
+      "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n",
+      // Malformed, or unusual.
+      "\r\nGET / HTTP/1.1\r\n\r\n",
+      "GET  / HTTP/1.1\r\n\r\n",
+      "GET /a\tb HTTP/1.1\r\n\r\n",
+      "GET / HTTP/1.1\nHost: localhost\n\n",
+      "GET / HTTP/1.1\r\nHost : localhost\r\n\r\n",
+      "GET / HTTP/1.1\r\nx-a: b\r\n  folded\r\n\r\n",
+      "GET / HTTP/1.1\r\nx-a: b\x01\r\n\r\n",
+      "POST / HTTP/1.1\r\nContent-Length: 1, 1\r\n\r\na",
+      "POST / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 1\r\n\r\na",
+      "POST / HTTP/1.1\r\nContent-Length: 99999999999999999999\r\n\r\n",
+  };
+  for (auto const& data : requests) {
+    SCOPED_TRACE(data);
+    BeastRequest request;
+    EXPECT_EQ(FastParseRequest(data, kLimits, request), 0);
+    EXPECT_EQ(request.target(), "");
+    EXPECT_EQ(request.begin(), request.end());
+  }
+}
+
+TEST(FastRequestParserTest, Limits) {
+  std::string const data =
+      "POST / HTTP/1.1\r\nHost: localhost\r\nContent-Length: 5\r\n\r\nHello";
+  BeastRequest request;
+  EXPECT_EQ(FastParseRequest(data, FastParseLimits{32, 1024}, request), 0);
+  EXPECT_EQ(FastParseRequest(data, FastParseLimits{1024, 4}, request), 0);
+  EXPECT_EQ(FastParseRequest(data, FastParseLimits{1024, 5}, request),
+            data.size());
+}
+
+TEST(FastRequestParserTest, TooManyFields) {
+  std::string data = "GET / HTTP/1.1\r\n";
+  for (int i = 0; i != 100; ++i) data += "x-" + std::to_string(i) + ": a\r\n";
+  data += "\r\n";
+  BeastRequest request;
+  EXPECT_EQ(FastParseRequest(data, kLimits, request), 0);
+}
+
+TEST(FastRequestParserTest, FindLineDelimiter) {
+  // Compare the implementations on random bytes, mostly printable, at every
+  // offset and length, including the tails shorter than a vector.
+  std::mt19937_64 generator(42);
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::uniform_int_distribution<int> printable(0x21, 0x7e);
+  std::bernoulli_distribution rare(0.02);
+  for (int round = 0; round != 200; ++round) {
+    std::string data(80, ' ');
+    for (auto& c : data) {
+      c = static_cast<char>(rare(generator) ? byte(generator)
+                                            : printable(generator));
+    }
+    if (round % 4 == 0) data[79 - round % 70] = '\t';
+    if (round % 4 == 1) data[round % 80] = ' ';
+    for (std::size_t offset = 0; offset != 40; ++offset) {
+      auto const* p = data.data() + offset;
+      auto const* end = data.data() + data.size() - offset / 2;
+      for (auto stop_at_space : {false, true}) {
+        auto const* expected =
+            FindLineDelimiterPortable(p, end, stop_at_space);
+        EXPECT_EQ(FindLineDelimiterSse42(p, end, stop_at_space), expected);
+        EXPECT_EQ(FindLineDelimiterAvx2(p, end, stop_at_space), expected);
+        EXPECT_EQ(FindLineDelimiter(p, end, stop_at_space), expected);
+      }
+    }
+  }
+}
+
+TEST(FastRequestParserTest, Instructions) {
+  auto const instructions = FastParserInstructions();
+  EXPECT_THAT(instructions, ::testing::AnyOf("avx2", "sse4.2", "portable"));
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
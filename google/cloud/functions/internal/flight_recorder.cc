@@ -0,0 +1,368 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/flight_recorder.h"
+#include "google/cloud/functions/internal/slow_request_log.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#endif  // _WIN32
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+template <std::size_t N>
+void CopyTruncated(std::array<char, N>& destination, std::string_view source) {
+  auto const n = std::min(source.size(), N - 1);
+  std::memcpy(destination.data(), source.data(), n);
+  destination[n] = '\0';
+}
+
+template <std::size_t N>
+std::string_view View(std::array<char, N> const& s) {
+  return {s.data(), ::strnlen(s.data(), N)};
+}
+
+std::int64_t Nanoseconds(FlightRecorder::Clock::duration d) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+}
+
+/// Formats JSON into a fixed buffer, without allocating, in signal handlers.
+class SignalSafeWriter {
+ public:
+  explicit SignalSafeWriter(int fd) : fd_(fd) {}
+  ~SignalSafeWriter() { Flush(); }
+
+  SignalSafeWriter(SignalSafeWriter const&) = delete;
+  SignalSafeWriter& operator=(SignalSafeWriter const&) = delete;
+
+  void Append(std::string_view s) {
+    while (!s.empty()) {
+      if (size_ == buffer_.size()) Flush();
+      auto const n = std::min(s.size(), buffer_.size() - size_);
+      std::memcpy(buffer_.data() + size_, s.data(), n);
+      size_ += n;
+      s.remove_prefix(n);
+    }
+  }
+
+  void AppendInt(std::int64_t value) {
+    std::array<char, 24> digits;
+    auto const r =
+        std::to_chars(digits.data(), digits.data() + digits.size(), value);
+    Append({digits.data(), static_cast<std::size_t>(r.ptr - digits.data())});
+  }
+
+  /// Appends @p value / @p unit as a decimal number with @p digits decimals.
+  void AppendScaled(std::int64_t value, std::int64_t unit, int digits = 3) {
+    if (value < 0) {
+      Append("-");
+      value = -value;
+    }
+    AppendInt(value / unit);
+    std::array<char, 10> fraction;
+    fraction[0] = '.';
+    auto remainder = value % unit;
+    for (int i = 1; i <= digits; ++i) {
+      remainder *= 10;
+      fraction[i] = static_cast<char>('0' + remainder / unit);
+      remainder %= unit;
+    }
+    Append({fraction.data(), static_cast<std::size_t>(digits) + 1});
+  }
+
+  void AppendJsonString(std::string_view s) {
+    Append("\"");
+    AppendJsonEscaped(s);
+    Append("\"");
+  }
+
+  void AppendJsonEscaped(std::string_view s) {
+    for (auto c : s) {
+      auto const u = static_cast<unsigned char>(c);
+      if (c == '"' || c == '\\') {
+        char const escaped[] = {'\\', c};
+        Append({escaped, sizeof(escaped)});
+      } else if (u < 0x20) {
+        char const hex[] = "0123456789abcdef";
+        char const escaped[] = {'\\', 'u', '0', '0', hex[u >> 4], hex[u & 0xF]};
+        Append({escaped, sizeof(escaped)});
+      } else {
+        Append({&c, 1});
+      }
+    }
+  }
+
+  void Flush() {
+#ifndef _WIN32
+    std::size_t offset = 0;
+    while (offset != size_) {
+      auto const n = ::write(fd_, buffer_.data() + offset, size_ - offset);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) break;
+      offset += static_cast<std::size_t>(n);
+    }
+#endif  // _WIN32
+    size_ = 0;
+  }
+
+ private:
+  int fd_;
+  std::array<char, 4096> buffer_;
+  std::size_t size_ = 0;
+};
+
+auto constexpr kNanosPerMilli = std::int64_t{1000 * 1000};
+auto constexpr kNanosPerSecond = 1000 * kNanosPerMilli;
+
+}  // namespace
+
+void FlightRecorder::InFlight::Reset() {
+  if (auto* recorder = std::exchange(recorder_, nullptr)) {
+    recorder->Release(slot_);
+  }
+}
+
+FlightRecorder::FlightRecorder(std::size_t capacity)
+    : recent_(std::make_unique<Entry[]>(std::max<std::size_t>(capacity, 1))),
+      in_flight_(std::make_unique<InFlightEntry[]>(
+          std::max<std::size_t>(capacity, 1))),
+      capacity_(std::max<std::size_t>(capacity, 1)) {}
+
+FlightRecorder::InFlight FlightRecorder::Begin(std::string_view method,
+                                               std::string_view target,
+                                               Clock::time_point start) {
+  // Start at a different slot each time, most probes find a free slot first.
+  auto const first = next_in_flight_.fetch_add(1, std::memory_order_relaxed);
+  for (std::size_t i = 0; i != capacity_; ++i) {
+    auto const slot = (first + i) % capacity_;
+    auto& e = in_flight_[slot];
+    if (e.busy.load(std::memory_order_relaxed) ||
+        e.busy.exchange(true, std::memory_order_acquire)) {
+      continue;
+    }
+    Summary summary;
+    summary.start_ns = Nanoseconds(start.time_since_epoch());
+    CopyTruncated(summary.method, method);
+    CopyTruncated(summary.target, target);
+    Write(e.entry, summary);
+    return InFlight(this, slot);
+  }
+  untracked_.fetch_add(1, std::memory_order_relaxed);
+  return {};
+}
+
+void FlightRecorder::Complete(RequestRecord& record, Clock::time_point now) {
+  Summary summary;
+  auto in_flight = std::move(record.in_flight);
+  // The sessions only copy the method and target to `record` for the slow
+  // request log, the in-flight summary always has them.
+  if (in_flight.recorder_ != this ||
+      !Read(in_flight_[in_flight.slot_].entry, summary)) {
+    CopyTruncated(summary.method, record.method);
+    CopyTruncated(summary.target, record.target);
+  }
+  in_flight.Reset();
+  summary.start_ns = Nanoseconds(record.start.time_since_epoch());
+  summary.latency_ns = Nanoseconds(now - record.start);
+  for (std::size_t i = 0; i != kRequestPhaseCount; ++i) {
+    summary.phases_ns[i] =
+        Nanoseconds(record.timing.duration(static_cast<RequestPhase>(i)));
+  }
+  summary.request_size = record.request_size;
+  summary.response_size = record.response_size;
+  summary.status = record.status;
+  CopyTruncated(summary.route, record.timing.route());
+  CopyTruncated(summary.event_type, record.timing.event_type());
+  auto const n = next_.fetch_add(1, std::memory_order_relaxed);
+  Write(recent_[n % capacity_], summary);
+}
+
+void FlightRecorder::Dump(int fd, std::string_view reason) const {
+  auto const now_ns = Nanoseconds(Clock::now().time_since_epoch());
+  SignalSafeWriter out(fd);
+  auto const recorded = next_.load();
+  out.Append(R"({"severity":"critical","message":"Flight recorder dump: )");
+  out.Append(reason);
+  out.Append(R"(","reason":)");
+  out.AppendJsonString(reason);
+  out.Append(R"(,"recorded":)");
+  out.AppendInt(static_cast<std::int64_t>(recorded));
+  out.Append(R"(,"untrackedInFlight":)");
+  out.AppendInt(static_cast<std::int64_t>(untracked_.load()));
+  out.Append("}\n");
+
+  auto dump = [&](Summary const& s, bool in_flight) {
+    out.Append(R"({"severity":"critical","message":)");
+    out.Append(in_flight ? R"("In-flight request: )" : R"("Recent request: )");
+    out.AppendJsonEscaped(View(s.method));
+    out.Append(" ");
+    out.AppendJsonEscaped(View(s.target));
+    out.Append(R"(","httpRequest":{"requestMethod":)");
+    out.AppendJsonString(View(s.method));
+    out.Append(R"(,"requestUrl":)");
+    out.AppendJsonString(View(s.target));
+    if (!in_flight) {
+      out.Append(R"(,"requestSize":")");
+      out.AppendInt(static_cast<std::int64_t>(s.request_size));
+      out.Append(R"(","responseSize":")");
+      out.AppendInt(static_cast<std::int64_t>(s.response_size));
+      out.Append(R"(","status":)");
+      out.AppendInt(s.status);
+      out.Append(R"(,"latency":")");
+      out.AppendScaled(s.latency_ns, kNanosPerSecond, /*digits=*/6);
+      out.Append(R"(s")");
+    }
+    out.Append(R"(},"ageMs":)");
+    out.AppendScaled(now_ns - s.start_ns, kNanosPerMilli);
+    if (!in_flight) {
+      out.Append(R"(,"phasesMs":{)");
+      for (std::size_t i = 0; i != kRequestPhaseCount; ++i) {
+        if (i != 0) out.Append(",");
+        out.AppendJsonString(RequestPhaseName(static_cast<RequestPhase>(i)));
+        out.Append(":");
+        out.AppendScaled(s.phases_ns[i], kNanosPerMilli);
+      }
+      out.Append("}");
+    }
+    if (s.route[0] != '\0') {
+      out.Append(R"(,"route":)");
+      out.AppendJsonString(View(s.route));
+    }
+    if (s.event_type[0] != '\0') {
+      out.Append(R"(,"eventType":)");
+      out.AppendJsonString(View(s.event_type));
+    }
+    out.Append("}\n");
+  };
+  Summary summary;
+  for (std::size_t i = 0; i != capacity_; ++i) {
+    auto const& e = in_flight_[i];
+    if (!e.busy.load() || !Read(e.entry, summary)) continue;
+    dump(summary, /*in_flight=*/true);
+  }
+  auto const count = std::min<std::uint64_t>(recorded, capacity_);
+  for (auto n = recorded - count; n != recorded; ++n) {
+    if (!Read(recent_[n % capacity_], summary)) continue;
+    dump(summary, /*in_flight=*/false);
+  }
+}
+
+void FlightRecorder::Release(std::size_t slot) {
+  in_flight_[slot].busy.store(false, std::memory_order_release);
+}
+
+void FlightRecorder::Write(Entry& entry, Summary const& summary) {
+  // An odd sequence marks the entry as being written. Two writers only share
+  // an entry if the ring wraps around while one of them runs, the dump may
+  // then show a mixed summary.
+  entry.sequence.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  entry.summary = summary;
+  entry.sequence.fetch_add(1, std::memory_order_release);
+}
+
+bool FlightRecorder::Read(Entry const& entry, Summary& summary) {
+  auto const before = entry.sequence.load(std::memory_order_acquire);
+  if (before == 0 || before % 2 != 0) return false;
+  summary = entry.summary;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return entry.sequence.load(std::memory_order_relaxed) == before;
+}
+
+#ifndef _WIN32
+namespace {
+
+auto constexpr kDumpSignals =
+    std::array<int, 6>{SIGQUIT, SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+std::array<struct sigaction, kDumpSignals.size()> previous_actions{};
+std::atomic<FlightRecorder const*> signal_recorder{nullptr};
+std::atomic<bool> dumping{false};
+
+char const* SignalName(int signal) {
+  switch (signal) {
+    case SIGQUIT:
+      return "SIGQUIT";
+    case SIGSEGV:
+      return "SIGSEGV";
+    case SIGBUS:
+      return "SIGBUS";
+    case SIGFPE:
+      return "SIGFPE";
+    case SIGILL:
+      return "SIGILL";
+    case SIGABRT:
+      return "SIGABRT";
+    default:
+      break;
+  }
+  return "signal";
+}
+
+void OnDumpSignal(int signal, siginfo_t* /*info*/, void* /*context*/) {
+  auto const saved_errno = errno;
+  auto const* recorder = signal_recorder.load();
+  // Two threads may crash at once, only one of them dumps.
+  if (recorder != nullptr && !dumping.exchange(true)) {
+    recorder->Dump(STDERR_FILENO, SignalName(signal));
+    dumping.store(false);
+  }
+  errno = saved_errno;
+  if (signal == SIGQUIT) return;
+  // Deliver the fatal signal again, to the previous handler or the default
+  // action, once this handler returns.
+  auto const i = static_cast<std::size_t>(
+      std::find(kDumpSignals.begin(), kDumpSignals.end(), signal) -
+      kDumpSignals.begin());
+  ::sigaction(signal, &previous_actions[i], nullptr);
+  ::raise(signal);
+}
+
+}  // namespace
+
+ScopedFlightRecorderSignals::ScopedFlightRecorderSignals(
+    FlightRecorder const& recorder) {
+  signal_recorder.store(&recorder);
+  struct sigaction action {};
+  action.sa_sigaction = OnDumpSignal;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_SIGINFO | SA_RESTART | SA_ONSTACK;
+  for (std::size_t i = 0; i != kDumpSignals.size(); ++i) {
+    ::sigaction(kDumpSignals[i], &action, &previous_actions[i]);
+  }
+}
+
+ScopedFlightRecorderSignals::~ScopedFlightRecorderSignals() {
+  for (std::size_t i = 0; i != kDumpSignals.size(); ++i) {
+    ::sigaction(kDumpSignals[i], &previous_actions[i], nullptr);
+  }
+  signal_recorder.store(nullptr);
+}
+
+#else
+
+ScopedFlightRecorderSignals::ScopedFlightRecorderSignals(
+    FlightRecorder const& /*recorder*/) {}
+
+ScopedFlightRecorderSignals::~ScopedFlightRecorderSignals() = default;
+
+#endif  // _WIN32
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
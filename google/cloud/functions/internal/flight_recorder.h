@@ -0,0 +1,154 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_FLIGHT_RECORDER_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_FLIGHT_RECORDER_H
+
+#include "google/cloud/functions/internal/request_timing.h"
+#include "google/cloud/functions/version.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+struct RequestRecord;
+
+/**
+ * Keeps the summaries of the last requests, and of the requests in progress.
+ *
+ * When the process crashes or hangs these summaries show what it was doing.
+ * Recording a request copies a few hundred bytes into a preallocated slot,
+ * without locks or allocations. `Dump()` is async-signal-safe, it only reads
+ * the slots, and skips any slot written while it runs.
+ */
+class FlightRecorder {
+ public:
+  using Clock = RequestTiming::Clock;
+
+  /// Keeps the last @p capacity requests, and as many requests in progress.
+  explicit FlightRecorder(std::size_t capacity);
+
+  /// The slot of a request in progress, released when destroyed.
+  class InFlight {
+   public:
+    InFlight() = default;
+    ~InFlight() { Reset(); }
+    InFlight(InFlight&& rhs) noexcept
+        : recorder_(std::exchange(rhs.recorder_, nullptr)), slot_(rhs.slot_) {}
+    InFlight& operator=(InFlight&& rhs) noexcept {
+      if (this == &rhs) return *this;
+      Reset();
+      recorder_ = std::exchange(rhs.recorder_, nullptr);
+      slot_ = rhs.slot_;
+      return *this;
+    }
+
+    void Reset();
+
+   private:
+    friend class FlightRecorder;
+    InFlight(FlightRecorder* recorder, std::size_t slot)
+        : recorder_(recorder), slot_(slot) {}
+
+    FlightRecorder* recorder_ = nullptr;
+    std::size_t slot_ = 0;
+  };
+
+  /// Tracks a request in progress, once it is read.
+  InFlight Begin(std::string_view method, std::string_view target,
+                 Clock::time_point start);
+
+  /// Records a completed request, and releases its in-flight slot.
+  void Complete(RequestRecord& record, Clock::time_point now);
+
+  /**
+   * Writes the in-flight and the recent requests to @p fd, oldest first.
+   *
+   * Each request is a structured log entry, the first entry names the
+   * @p reason for the dump.
+   */
+  void Dump(int fd, std::string_view reason) const;
+
+  /// The number of requests in progress without a slot.
+  [[nodiscard]] std::uint64_t untracked() const { return untracked_.load(); }
+
+ private:
+  static auto constexpr kMethodSize = 16;
+  static auto constexpr kTargetSize = 160;
+  static auto constexpr kNameSize = 64;
+
+  struct Summary {
+    std::int64_t start_ns = 0;
+    std::int64_t latency_ns = 0;
+    std::array<std::int64_t, kRequestPhaseCount> phases_ns{};
+    std::uint64_t request_size = 0;
+    std::uint64_t response_size = 0;
+    unsigned status = 0;
+    std::array<char, kMethodSize> method{};
+    std::array<char, kTargetSize> target{};
+    std::array<char, kNameSize> route{};
+    std::array<char, kNameSize> event_type{};
+  };
+
+  /// A request summary, the writers bump `sequence` before and after.
+  struct Entry {
+    std::atomic<std::uint64_t> sequence{0};
+    Summary summary;
+  };
+
+  struct InFlightEntry {
+    std::atomic<bool> busy{false};
+    Entry entry;
+  };
+
+  void Release(std::size_t slot);
+  static void Write(Entry& entry, Summary const& summary);
+  static bool Read(Entry const& entry, Summary& summary);
+
+  std::unique_ptr<Entry[]> recent_;
+  std::unique_ptr<InFlightEntry[]> in_flight_;
+  std::size_t capacity_;
+  std::atomic<std::uint64_t> next_{0};
+  std::atomic<std::size_t> next_in_flight_{0};
+  std::atomic<std::uint64_t> untracked_{0};
+};
+
+/**
+ * Dumps @p recorder to `stderr` on `SIGQUIT` and on fatal signals.
+ *
+ * The process continues after a `SIGQUIT`, the fatal signals run their
+ * previous handler after the dump. The destructor restores the previous
+ * handlers. Does nothing on Windows.
+ */
+class ScopedFlightRecorderSignals {
+ public:
+  explicit ScopedFlightRecorderSignals(FlightRecorder const& recorder);
+  ~ScopedFlightRecorderSignals();
+
+  ScopedFlightRecorderSignals(ScopedFlightRecorderSignals const&) = delete;
+  ScopedFlightRecorderSignals& operator=(ScopedFlightRecorderSignals const&) =
+      delete;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_FLIGHT_RECORDER_H
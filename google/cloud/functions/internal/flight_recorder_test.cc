@@ -0,0 +1,193 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/flight_recorder.h"
+#include "google/cloud/functions/internal/slow_request_log.h"
+#include <gmock/gmock.h>
+#include <nlohmann/json.hpp>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <csignal>
+#include <unistd.h>
+#endif  // _WIN32
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::SizeIs;
+using ms = std::chrono::milliseconds;
+
+/// Returns the lines written by @p dump to a file descriptor.
+template <typename Dump>
+std::vector<nlohmann::json> Capture(Dump dump) {
+  auto* file = std::tmpfile();
+  dump(::fileno(file));
+  std::rewind(file);
+  std::string text;
+  for (int c = std::fgetc(file); c != EOF; c = std::fgetc(file)) {
+    text.push_back(static_cast<char>(c));
+  }
+  std::fclose(file);
+  std::vector<nlohmann::json> lines;
+  std::istringstream is(text);
+  for (std::string line; std::getline(is, line);) {
+    lines.push_back(nlohmann::json::parse(line));
+  }
+  return lines;
+}
+
+RequestRecord MakeRecord(FlightRecorder& recorder, std::string target,
+                         FlightRecorder::Clock::time_point start) {
+  RequestRecord record;
+  record.start = start;
+  record.in_flight = recorder.Begin("POST", target, start);
+  record.request_size = 10;
+  record.status = 200;
+  record.response_size = 1234;
+  record.timing.Add(RequestPhase::kFunction, ms(250));
+  record.timing.set_route("POST /a");
+  return record;
+}
+
+TEST(FlightRecorderTest, Dump) {
+  FlightRecorder recorder(4);
+  auto const now = FlightRecorder::Clock::now();
+  auto done = MakeRecord(recorder, "/a?q=\"x\"", now - ms(500));
+  recorder.Complete(done, now - ms(200));
+  auto running = MakeRecord(recorder, "/b", now - ms(100));
+
+  auto const lines = Capture([&](int fd) { recorder.Dump(fd, "SIGQUIT"); });
+  ASSERT_THAT(lines, SizeIs(3));
+  EXPECT_EQ(lines[0].value("message", ""), "Flight recorder dump: SIGQUIT");
+  EXPECT_EQ(lines[0].value("recorded", 0), 1);
+
+  auto const& in_flight = lines[1];
+  EXPECT_EQ(in_flight.value("severity", ""), "critical");
+  EXPECT_EQ(in_flight.value("message", ""), "In-flight request: POST /b");
+  EXPECT_EQ(in_flight["httpRequest"].value("requestUrl", ""), "/b");
+  EXPECT_FALSE(in_flight["httpRequest"].contains("status"));
+  EXPECT_GE(in_flight.value("ageMs", 0.0), 100.0);
+
+  auto const& recent = lines[2];
+  EXPECT_EQ(recent.value("message", ""), R"(Recent request: POST /a?q="x")");
+  auto const& http = recent["httpRequest"];
+  EXPECT_EQ(http.value("requestMethod", ""), "POST");
+  EXPECT_EQ(http.value("requestUrl", ""), R"(/a?q="x")");
+  EXPECT_EQ(http.value("status", 0), 200);
+  EXPECT_EQ(http.value("requestSize", ""), "10");
+  EXPECT_EQ(http.value("responseSize", ""), "1234");
+  EXPECT_EQ(http.value("latency", ""), "0.300000s");
+  EXPECT_EQ(recent["phasesMs"].value("function", 0.0), 250.0);
+  EXPECT_EQ(recent.value("route", ""), "POST /a");
+  EXPECT_GE(recent.value("ageMs", 0.0), 500.0);
+}
+
+TEST(FlightRecorderTest, KeepsLastRequests) {
+  FlightRecorder recorder(2);
+  auto const now = FlightRecorder::Clock::now();
+  for (auto const* target : {"/1", "/2", "/3"}) {
+    auto record = MakeRecord(recorder, target, now);
+    recorder.Complete(record, now);
+  }
+  auto const lines = Capture([&](int fd) { recorder.Dump(fd, "test"); });
+  std::vector<std::string> urls;
+  for (auto const& l : lines) {
+    if (!l.contains("httpRequest")) continue;
+    urls.push_back(l["httpRequest"].value("requestUrl", ""));
+  }
+  EXPECT_THAT(urls, ElementsAre("/2", "/3"));
+}
+
+TEST(FlightRecorderTest, InFlightSlots) {
+  FlightRecorder recorder(2);
+  auto const now = FlightRecorder::Clock::now();
+  auto a = recorder.Begin("GET", "/a", now);
+  auto b = recorder.Begin("GET", "/b", now);
+  auto c = recorder.Begin("GET", "/c", now);
+  EXPECT_EQ(recorder.untracked(), 1);
+  a.Reset();
+  auto d = recorder.Begin("GET", "/d", now);
+  EXPECT_EQ(recorder.untracked(), 1);
+
+  auto const lines = Capture([&](int fd) { recorder.Dump(fd, "test"); });
+  std::vector<std::string> urls;
+  for (auto const& l : lines) {
+    if (!l.contains("httpRequest")) continue;
+    urls.push_back(l["httpRequest"].value("requestUrl", ""));
+  }
+  EXPECT_THAT(urls, ::testing::UnorderedElementsAre("/b", "/d"));
+  EXPECT_EQ(lines[0].value("untrackedInFlight", 0), 1);
+}
+
+TEST(FlightRecorderTest, TruncatesLongTargets) {
+  FlightRecorder recorder(1);
+  auto const now = FlightRecorder::Clock::now();
+  auto record = MakeRecord(recorder, "/" + std::string(1000, 'x'), now);
+  recorder.Complete(record, now);
+  auto const lines = Capture([&](int fd) { recorder.Dump(fd, "test"); });
+  ASSERT_THAT(lines, SizeIs(2));
+  auto const url = lines[1]["httpRequest"].value("requestUrl", "");
+  EXPECT_LT(url.size(), 1000);
+  EXPECT_EQ(url.substr(0, 4), "/xxx");
+}
+
+#ifndef _WIN32
+TEST(FlightRecorderTest, DumpsOnSigquit) {
+  FlightRecorder recorder(1);
+  auto const now = FlightRecorder::Clock::now();
+  auto record = MakeRecord(recorder, "/quit", now);
+  recorder.Complete(record, now);
+
+  auto* file = std::tmpfile();
+  auto const saved = ::dup(STDERR_FILENO);
+  ::dup2(::fileno(file), STDERR_FILENO);
+  {
+    ScopedFlightRecorderSignals signals(recorder);
+    // The process continues after the dump.
+    ::raise(SIGQUIT);
+  }
+  ::dup2(saved, STDERR_FILENO);
+  ::close(saved);
+  std::rewind(file);
+  std::string text;
+  for (int c = std::fgetc(file); c != EOF; c = std::fgetc(file)) {
+    text.push_back(static_cast<char>(c));
+  }
+  std::fclose(file);
+  EXPECT_THAT(text, ::testing::HasSubstr("Flight recorder dump: SIGQUIT"));
+  EXPECT_THAT(text, ::testing::HasSubstr("Recent request: POST /quit"));
+}
+
+TEST(FlightRecorderDeathTest, DumpsOnCrash) {
+  FlightRecorder recorder(1);
+  auto const now = FlightRecorder::Clock::now();
+  auto record = MakeRecord(recorder, "/crash", now);
+  recorder.Complete(record, now);
+  EXPECT_DEATH(
+      {
+        ScopedFlightRecorderSignals signals(recorder);
+        std::abort();
+      },
+      "Recent request: POST /crash");
+}
+#endif  // _WIN32
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -13,19 +13,94 @@
 // limitations under the License.
 
 #include "google/cloud/functions/internal/framework_impl.h"
+#include "google/cloud/functions/background_executor.h"
+#include "google/cloud/functions/internal/admission_control.h"
+#include "google/cloud/functions/internal/allocator.h"
+#include "google/cloud/functions/internal/background_activity.h"
+#include "google/cloud/functions/internal/body_checksums.h"
+#include "google/cloud/functions/internal/body_memory_budget.h"
+#include "google/cloud/functions/internal/byte_ranges.h"
+#include "google/cloud/functions/internal/cancellation.h"
+#include "google/cloud/functions/internal/checkpoint.h"
+#include "google/cloud/functions/internal/client_event_loop.h"
+#include "google/cloud/functions/internal/compression.h"
+#include "google/cloud/functions/internal/conditional.h"
+#include "google/cloud/functions/internal/cpu_limits.h"
+#include "google/cloud/functions/internal/event_age.h"
+#include "google/cloud/functions/internal/event_sink.h"
+#include "google/cloud/functions/internal/fast_request_parser.h"
+#include "google/cloud/functions/internal/flight_recorder.h"
 #include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/http_date.h"
+#include "google/cloud/functions/internal/lazy_global_base.h"
+#ifdef FUNCTIONS_FRAMEWORK_CPP_HAVE_HTTP2
+#include "google/cloud/functions/internal/http2_session.h"
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_HTTP2
+#include "google/cloud/functions/internal/log_sink.h"
+#include "google/cloud/functions/internal/memory_pressure.h"
+#include "google/cloud/functions/internal/metrics.h"
 #include "google/cloud/functions/internal/parse_options.h"
+#include "google/cloud/functions/internal/profiler.h"
+#include "google/cloud/functions/internal/rate_limiter.h"
+#include "google/cloud/functions/internal/request_timing.h"
+#include "google/cloud/functions/internal/server_state.h"
+#include "google/cloud/functions/internal/slow_request_log.h"
+#include "google/cloud/functions/internal/startup_timer.h"
+#include "google/cloud/functions/internal/static_routes.h"
+#include "google/cloud/functions/internal/structured_log.h"
+#include "google/cloud/functions/internal/traffic_capture.h"
+#include "google/cloud/functions/internal/websocket_session.h"
+#include "google/cloud/functions/internal/worker_processes.h"
 #include "google/cloud/functions/version.h"
+#include <boost/asio/basic_socket_acceptor.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/generic/stream_protocol.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/signal_set.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/beast/version.hpp>
 #include <boost/program_options.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <deque>
+#include <filesystem>
 #include <functional>
 #include <future>
-#include <iostream>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
 #include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+#ifndef _WIN32
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif  // _WIN32
+#ifdef __linux__
+#include <sys/sendfile.h>
+#define FUNCTIONS_FRAMEWORK_CPP_HAVE_SENDFILE 1
+#else
+#define FUNCTIONS_FRAMEWORK_CPP_HAVE_SENDFILE 0
+#endif  // __linux__
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
@@ -33,108 +108,2724 @@ namespace {
 namespace be = boost::beast;
 namespace asio = boost::asio;
 using tcp = boost::asio::ip::tcp;
+// Sessions and listeners work with both TCP and Unix domain sockets.
+using stream_protocol = boost::asio::generic::stream_protocol;
+using StreamAcceptor = boost::asio::basic_socket_acceptor<stream_protocol>;
 
-void HandleSession(tcp::socket socket, Handler const& handler) {
-  auto report_error = [](be::error_code ec, char const* what) {
-    // TODO(#35) - maybe replace with Boost.Log
-    std::cerr << what << ": " << ec.message() << "\n";
+void ReportError(be::error_code ec, char const* what) {
+  WriteLog(functions::LogSeverity::kError,
+           std::string(what) + ": " + ec.message());
+}
+
+/// The server configuration, as parsed from the command-line and environment.
+struct ServerOptions {
+  int threads;
+  /// If `true`, pin each thread to one of the available cores.
+  bool pin_threads;
+  /// If `true`, each thread runs its own event loop and listening socket.
+  bool reuse_port;
+  /// The number of worker processes sharing the listening socket.
+  int processes;
+  /// The size of the listen queue, 0 uses the system maximum.
+  int listen_backlog;
+  /// The socket options for accepted TCP connections, 0 keeps the default.
+  bool tcp_nodelay;
+  std::chrono::seconds tcp_keepalive;
+  std::chrono::seconds tcp_keepalive_interval;
+  int tcp_keepalive_count;
+  std::chrono::seconds tcp_defer_accept;
+  int send_buffer_size;
+  int receive_buffer_size;
+  /// The maximum number of concurrent sessions, 0 means no limit.
+  std::size_t max_sessions;
+  /// If `true`, reject requests with a 503 once the limit is reached.
+  bool reject_on_overload;
+  std::chrono::seconds retry_after;
+  /// If not 0, reject CloudEvents once the queue delay stays above this.
+  std::chrono::milliseconds queue_delay_target;
+  std::chrono::milliseconds queue_delay_interval;
+  /// If not 0, reject requests above this percentage of the memory limit.
+  int memory_watermark;
+  /// How long to wait for in-flight requests during shutdown.
+  std::chrono::seconds shutdown_grace_period;
+  /// The I/O timeouts, 0 disables the timeout.
+  std::chrono::seconds idle_timeout;
+  std::chrono::seconds header_timeout;
+  std::chrono::seconds body_timeout;
+  std::chrono::seconds write_timeout;
+  /// The limits of keep-alive connections, 0 means no limit.
+  std::uint64_t max_connection_requests;
+  std::chrono::seconds max_connection_age;
+  /// Each connection lowers its limits by up to this percentage.
+  int connection_limit_jitter;
+  /// The maximum size for the request header and body, in bytes.
+  std::uint32_t max_header_size;
+  std::uint64_t max_body_size;
+  /// If not 0, the memory for the buffered request bodies of all sessions.
+  std::uint64_t max_buffered_body_memory;
+  /// The number of threads running streaming functions.
+  int streaming_threads;
+  /// If `true`, the standard streams are written by a background thread.
+  bool async_logging;
+  /// The number of pipelined requests that may run concurrently in a session.
+  std::size_t pipeline_depth;
+  /// If `true`, complete HTTP/1.1 requests skip the Boost.Beast parser.
+  bool fast_request_parser;
+  /// If `true`, the server also accepts HTTP/2 cleartext (h2c) connections.
+  bool http2;
+  std::uint32_t http2_max_streams;
+  /// If `true`, responses are compressed as negotiated with the client.
+  bool compression;
+  std::size_t compression_min_size;
+  /// If `true`, compressed request bodies are decompressed for the function.
+  bool request_decompression;
+  /// The checksums computed for each request body, see `--request-checksums`.
+  BodyChecksumOptions body_checksums;
+  std::size_t max_decompressed_size;
+  /// If `true`, responses get an `ETag`, and preconditions are answered.
+  bool conditional_requests;
+  /// If `true`, `Range` requests get the requested bytes of the responses.
+  bool range_requests;
+  /// If `true`, record metrics and answer `/metrics` requests.
+  bool metrics;
+  /// If not 0, answer `/metrics` requests on this port.
+  std::uint16_t metrics_port;
+  /// If `true`, responses get a `Server-Timing` header.
+  bool server_timing;
+  /// If not 0, release the free memory once idle for this long.
+  std::chrono::seconds release_memory_after_idle;
+  /// If not 0, limit the number of allocator arenas.
+  int max_allocator_arenas;
+  /// If not 0, the deadline of each request.
+  std::chrono::seconds request_deadline;
+  /// If not 0, drop the CloudEvents older than this.
+  std::chrono::seconds max_event_age;
+  /// If not 0, log the requests slower than this.
+  std::chrono::milliseconds slow_request_threshold;
+  int slow_request_log_rate;
+  /// If not 0, keep the last requests, and dump them on `SIGQUIT` or crashes.
+  int flight_recorder;
+  /// If not empty, write a sample of the requests into this file.
+  std::string capture_file;
+  int capture_sample_rate;
+  std::uint64_t capture_max_bytes;
+  /// If `true`, log the startup phases once the server is ready.
+  bool log_startup;
+  /// If `true`, answer `/debug/startup` with the startup phases.
+  bool debug_startup;
+  /// If not empty, wait for a checkpoint and restore after the warmup.
+  std::string checkpoint_ready_file;
+  /// If `true`, answer `/debug/server` requests with this token.
+  bool debug_server;
+  std::string debug_server_token;
+  /// If `true`, answer `/debug/pprof/...` requests with `debug_server_token`.
+  bool debug_pprof;
+  /// The `--static-route` values.
+  std::vector<std::string> static_routes;
+  /// If not empty, listen on this Unix domain socket instead of TCP.
+  std::string unix_socket;
+};
+
+ServerOptions MakeServerOptions(
+    boost::program_options::variables_map const& vm) {
+  auto const threads = [&vm] {
+    auto const configured = vm["threads"].as<int>();
+    if (configured > 0) return configured;
+    return static_cast<int>(DefaultConcurrency());
+  }();
+  auto seconds = [&vm](char const* name) {
+    return std::chrono::seconds(vm[name].as<int>());
   };
+  ServerOptions options;
+  options.threads = threads;
+  options.pin_threads = vm["pin-threads"].as<bool>();
+#ifndef __linux__
+  if (options.pin_threads) {
+    throw std::invalid_argument(
+        "--pin-threads is not supported on this platform");
+  }
+#endif  // __linux__
+  options.reuse_port = vm["reuse-port"].as<bool>();
+  options.processes = vm["processes"].as<int>();
+  options.listen_backlog = vm["listen-backlog"].as<int>();
+  options.tcp_nodelay = vm["tcp-nodelay"].as<bool>();
+  options.tcp_keepalive = seconds("tcp-keepalive");
+  options.tcp_keepalive_interval = seconds("tcp-keepalive-interval");
+  options.tcp_keepalive_count = vm["tcp-keepalive-count"].as<int>();
+  options.tcp_defer_accept = seconds("tcp-defer-accept");
+#if !defined(TCP_KEEPIDLE) && !defined(TCP_KEEPALIVE)
+  if (options.tcp_keepalive != std::chrono::seconds(0)) {
+    throw std::invalid_argument(
+        "--tcp-keepalive is not supported on this platform");
+  }
+#endif  // TCP_KEEPIDLE || TCP_KEEPALIVE
+#if !defined(TCP_KEEPINTVL) || !defined(TCP_KEEPCNT)
+  if (options.tcp_keepalive_interval != std::chrono::seconds(0) ||
+      options.tcp_keepalive_count != 0) {
+    throw std::invalid_argument(
+        "--tcp-keepalive-interval and --tcp-keepalive-count are not supported"
+        " on this platform");
+  }
+#endif  // TCP_KEEPINTVL && TCP_KEEPCNT
+#if !defined(TCP_DEFER_ACCEPT)
+  if (options.tcp_defer_accept != std::chrono::seconds(0)) {
+    throw std::invalid_argument(
+        "--tcp-defer-accept is not supported on this platform");
+  }
+#endif  // TCP_DEFER_ACCEPT
+  options.send_buffer_size = vm["send-buffer-size"].as<int>();
+  options.receive_buffer_size = vm["receive-buffer-size"].as<int>();
+  options.max_sessions = static_cast<std::size_t>(vm["max-sessions"].as<int>());
+  options.reject_on_overload =
+      vm["overload-policy"].as<std::string>() == "reject";
+  options.retry_after = seconds("retry-after");
+  options.queue_delay_target =
+      std::chrono::milliseconds(vm["queue-delay-target"].as<int>());
+  options.queue_delay_interval =
+      std::chrono::milliseconds(vm["queue-delay-interval"].as<int>());
+  options.memory_watermark = vm["memory-watermark"].as<int>();
+  options.shutdown_grace_period = seconds("shutdown-grace-period");
+  options.idle_timeout = seconds("idle-timeout");
+  options.header_timeout = seconds("header-timeout");
+  options.body_timeout = seconds("body-timeout");
+  options.write_timeout = seconds("write-timeout");
+  options.max_connection_requests = static_cast<std::uint64_t>(
+      vm["max-connection-requests"].as<int>());
+  options.max_connection_age = seconds("max-connection-age");
+  options.connection_limit_jitter = vm["connection-limit-jitter"].as<int>();
+  options.max_header_size =
+      static_cast<std::uint32_t>(vm["max-header-size"].as<std::int64_t>());
+  options.max_body_size =
+      static_cast<std::uint64_t>(vm["max-body-size"].as<std::int64_t>());
+  options.max_buffered_body_memory = static_cast<std::uint64_t>(
+      vm["max-buffered-body-memory"].as<std::int64_t>());
+  options.streaming_threads = vm["streaming-threads"].as<int>();
+  options.async_logging = vm["async-logging"].as<bool>();
+  options.pipeline_depth =
+      static_cast<std::size_t>(vm["pipeline-depth"].as<int>());
+  options.fast_request_parser = vm["fast-request-parser"].as<bool>();
+  options.http2 = vm["http2"].as<bool>();
+#ifndef FUNCTIONS_FRAMEWORK_CPP_HAVE_HTTP2
+  if (options.http2) {
+    throw std::invalid_argument("--http2 requires a build with HTTP/2 support");
+  }
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_HTTP2
+  options.http2_max_streams =
+      static_cast<std::uint32_t>(vm["http2-max-streams"].as<int>());
+  options.compression = vm["compression"].as<bool>();
+  options.compression_min_size =
+      static_cast<std::size_t>(vm["compression-min-size"].as<int>());
+  options.request_decompression = vm["request-decompression"].as<bool>();
+  options.body_checksums =
+      ParseBodyChecksumOptions(vm["request-checksums"].as<std::string>());
+  options.max_decompressed_size = static_cast<std::size_t>(
+      vm["max-decompressed-size"].as<std::int64_t>());
+  options.conditional_requests = vm["conditional-requests"].as<bool>();
+  options.range_requests = vm["range-requests"].as<bool>();
+  options.metrics_port =
+      static_cast<std::uint16_t>(vm["metrics-port"].as<int>());
+  options.metrics = vm["metrics"].as<bool>() || options.metrics_port != 0;
+  options.server_timing = vm["server-timing"].as<bool>();
+  options.release_memory_after_idle = seconds("release-memory-after-idle");
+  options.max_allocator_arenas = vm["max-allocator-arenas"].as<int>();
+  options.request_deadline = seconds("request-deadline");
+  options.max_event_age = seconds("max-event-age");
+  options.slow_request_threshold =
+      std::chrono::milliseconds(vm["slow-request-threshold"].as<int>());
+  options.slow_request_log_rate = vm["slow-request-log-rate"].as<int>();
+  options.flight_recorder = vm["flight-recorder"].as<int>();
+  options.capture_file = vm["capture-file"].as<std::string>();
+  options.capture_sample_rate = vm["capture-sample-rate"].as<int>();
+  options.capture_max_bytes =
+      static_cast<std::uint64_t>(vm["capture-max-size"].as<int>()) * 1024 *
+      1024;
+  options.log_startup = vm["log-startup"].as<bool>();
+  options.debug_startup = vm["debug-startup"].as<bool>();
+  options.checkpoint_ready_file = vm["checkpoint-ready-file"].as<std::string>();
+  options.debug_server = vm["debug-server"].as<bool>();
+  options.debug_server_token = vm["debug-server-token"].as<std::string>();
+  options.debug_pprof = vm["debug-pprof"].as<bool>();
+  options.unix_socket = vm["unix-socket"].as<std::string>();
+  if (!options.unix_socket.empty() && options.reuse_port) {
+    throw std::invalid_argument(
+        "--reuse-port cannot be used with --unix-socket");
+  }
+  if (options.processes > 1) {
+#ifdef _WIN32
+    throw std::invalid_argument(
+        "--processes is not supported on this platform");
+#endif  // _WIN32
+    // The worker processes share a single listening socket, bound by the
+    // parent process.
+    if (options.reuse_port) {
+      throw std::invalid_argument(
+          "--reuse-port cannot be used with --processes");
+    }
+    if (options.metrics_port != 0) {
+      throw std::invalid_argument(
+          "--metrics-port cannot be used with --processes");
+    }
+    // The parent process binds the socket before the workers are created.
+    if (!options.checkpoint_ready_file.empty()) {
+      throw std::invalid_argument(
+          "--checkpoint-ready-file cannot be used with --processes");
+    }
+    // The workers would write the same capture file.
+    if (!options.capture_file.empty()) {
+      throw std::invalid_argument(
+          "--capture-file cannot be used with --processes");
+    }
+  }
+  if (vm.count("static-route") != 0) {
+    options.static_routes = vm["static-route"].as<std::vector<std::string>>();
+  }
+  return options;
+}
+
+#if defined(SO_REUSEPORT)
+using ReusePortOption = asio::detail::socket_option::boolean<SOL_SOCKET,
+                                                             SO_REUSEPORT>;
+#endif  // SO_REUSEPORT
+#if defined(TCP_KEEPIDLE)
+using KeepAliveIdleOption =
+    asio::detail::socket_option::integer<IPPROTO_TCP, TCP_KEEPIDLE>;
+#elif defined(TCP_KEEPALIVE)
+// macOS spells `TCP_KEEPIDLE` as `TCP_KEEPALIVE`.
+using KeepAliveIdleOption =
+    asio::detail::socket_option::integer<IPPROTO_TCP, TCP_KEEPALIVE>;
+#endif  // TCP_KEEPIDLE
+#if defined(TCP_KEEPINTVL) && defined(TCP_KEEPCNT)
+using KeepAliveIntervalOption =
+    asio::detail::socket_option::integer<IPPROTO_TCP, TCP_KEEPINTVL>;
+using KeepAliveCountOption =
+    asio::detail::socket_option::integer<IPPROTO_TCP, TCP_KEEPCNT>;
+#endif  // TCP_KEEPINTVL && TCP_KEEPCNT
+#if defined(TCP_DEFER_ACCEPT)
+using DeferAcceptOption =
+    asio::detail::socket_option::integer<IPPROTO_TCP, TCP_DEFER_ACCEPT>;
+#endif  // TCP_DEFER_ACCEPT
+
+[[nodiscard]] bool IsTcp(stream_protocol const& protocol) {
+  return protocol.family() == tcp::v4().family() ||
+         protocol.family() == tcp::v6().family();
+}
 
+/**
+ * Applies the `--tcp-*` options to an accepted TCP connection.
+ *
+ * Errors are ignored: the connection still works with the default options,
+ * and the client may have closed it already.
+ */
+void ConfigureConnection(stream_protocol::socket& socket,
+                         ServerOptions const& options) {
   be::error_code ec;
-  for (;;) {
-    be::flat_buffer buffer;
-    // Read a request
-    BeastRequest request;
-    be::http::read(socket, buffer, request, ec);
-    if (ec == be::http::error::end_of_stream) break;
-    if (ec) return report_error(ec, "read");
-    auto const keep_alive = request.keep_alive();
-    auto response = handler(std::move(request));
-    // Flush any buffered output, as the application may be shutdown immediately
-    // after the HTTP response is sent.
-    std::cout << std::flush;
-    std::clog << std::flush;
-    std::cerr << std::flush;
-    // Send the response
-    response.set(be::http::field::server, BOOST_BEAST_VERSION_STRING);
-    response.prepare_payload();
-    response.keep_alive(keep_alive);
-    be::http::write(socket, response, ec);
-    if (ec) return report_error(ec, "write");
+  if (options.tcp_nodelay) socket.set_option(tcp::no_delay(true), ec);
+  if (options.tcp_keepalive == std::chrono::seconds(0)) return;
+  socket.set_option(asio::socket_base::keep_alive(true), ec);
+#if defined(TCP_KEEPIDLE) || defined(TCP_KEEPALIVE)
+  socket.set_option(
+      KeepAliveIdleOption(static_cast<int>(options.tcp_keepalive.count())),
+      ec);
+#endif  // TCP_KEEPIDLE || TCP_KEEPALIVE
+#if defined(TCP_KEEPINTVL) && defined(TCP_KEEPCNT)
+  if (options.tcp_keepalive_interval != std::chrono::seconds(0)) {
+    socket.set_option(KeepAliveIntervalOption(static_cast<int>(
+                          options.tcp_keepalive_interval.count())),
+                      ec);
+  }
+  if (options.tcp_keepalive_count != 0) {
+    socket.set_option(KeepAliveCountOption(options.tcp_keepalive_count), ec);
   }
-  socket.shutdown(tcp::socket::shutdown_send, ec);
+#endif  // TCP_KEEPINTVL && TCP_KEEPCNT
 }
 
-int RunForTestImpl(int argc, char const* const argv[],
-                   functions::Function const& function,
-                   std::function<bool()> const& shutdown,
-                   std::function<void(int)> const& actual_port) {
-  auto vm = ParseOptions(argc, argv);
-  if (vm.count("help") != 0) return 0;
+/**
+ * Applies the options of the listening socket, and starts listening.
+ *
+ * Accepted connections inherit the buffer sizes from the listening socket. The
+ * receive buffer must be set before listening, as it determines the TCP window
+ * scale.
+ */
+void Listen(StreamAcceptor& acceptor, ServerOptions const& options) {
+  if (options.send_buffer_size != 0) {
+    acceptor.set_option(
+        asio::socket_base::send_buffer_size(options.send_buffer_size));
+  }
+  if (options.receive_buffer_size != 0) {
+    acceptor.set_option(
+        asio::socket_base::receive_buffer_size(options.receive_buffer_size));
+  }
+#if defined(TCP_DEFER_ACCEPT)
+  if (options.tcp_defer_accept != std::chrono::seconds(0) &&
+      IsTcp(acceptor.local_endpoint().protocol())) {
+    acceptor.set_option(
+        DeferAcceptOption(static_cast<int>(options.tcp_defer_accept.count())));
+  }
+#endif  // TCP_DEFER_ACCEPT
+  acceptor.listen(options.listen_backlog != 0
+                      ? options.listen_backlog
+                      : asio::socket_base::max_connections);
+}
 
-  auto address = asio::ip::make_address(vm["address"].as<std::string>());
-  auto port = vm["port"].as<int>();
-  auto target = vm["target"].as<std::string>();
+using RequestParser =
+    be::http::request_parser<be::http::string_body, FieldsAllocator<char>>;
+using StreamingParser =
+    be::http::request_parser<be::http::buffer_body, FieldsAllocator<char>>;
 
-  asio::io_context ioc{1};
-  tcp::acceptor acceptor{ioc, {address, static_cast<std::uint16_t>(port)}};
-  acceptor.listen(boost::asio::socket_base::max_connections);
-  actual_port(acceptor.local_endpoint().port());
+/// The handlers used by a session.
+struct SessionHandlers {
+  Handler handler;
+  /// If not empty, the session uses this handler, and reads the request body
+  /// as the handler consumes it.
+  StreamingHandler streaming_handler;
+  /// If not empty, the session uses this handler, and sends the response as
+  /// the handler produces it.
+  WriterHandler writer_handler;
+  /// If not empty, the session uses this handler, and waits for its callback
+  /// without blocking.
+  AsyncHandler async_handler;
+  /// If not empty, the session hands over the WebSocket upgrade requests to a
+  /// `WebSocketSession`.
+  WebSocketHandler websocket_handler;
+  /// If not empty, checks each request once its header is received.
+  PrecheckHandler precheck;
+  /// If not null, answers these paths once the request header is received.
+  std::shared_ptr<StaticRoutes const> static_routes;
+  /// Runs the streaming and writer handlers, only created if needed.
+  asio::thread_pool* streaming_pool = nullptr;
+  /// If not null, counts the sessions.
+  ServerMetrics* metrics = nullptr;
+  /// If not null, the sessions report each request once its response is sent.
+  SlowRequestLog* slow_requests = nullptr;
+  /// If not null, the sessions record each request in progress, and done.
+  FlightRecorder* flight_recorder = nullptr;
+  /// If not null, the sessions and listeners report their state.
+  ServerState* server_state = nullptr;
+  /// If not null, the sessions and listeners report their queue delays.
+  AdmissionController* admission = nullptr;
+  /// If not null, the sessions reserve the memory for buffered bodies.
+  BodyMemoryBudget* body_budget = nullptr;
+};
 
-  auto handler = FunctionImpl::GetImpl(function)->GetHandler(target);
+/**
+ * Lowers @p limit by a random amount, up to @p jitter percent.
+ *
+ * Connections opened together, e.g., when a front end connects to a new
+ * instance, would reach their limits together otherwise.
+ */
+double WithJitter(double limit, int jitter) {
+  if (jitter == 0) return limit;
+  auto constexpr kPercent = 100.0;
+  auto reduction = std::uniform_real_distribution<double>(
+      0, limit * jitter / kPercent);
+  return limit - reduction(ThreadRandomGenerator());
+}
+
+/// Sets the headers of a buffered HTTP/1.1 response, just before sending it.
+void FinalizeResponse(BeastResponse& response, bool keep_alive) {
+  response.set(be::http::field::server, BOOST_BEAST_VERSION_STRING);
+  if (response.find(be::http::field::date) == response.end()) {
+    response.set(be::http::field::date, CurrentHttpDate());
+  }
+  response.prepare_payload();
+  response.keep_alive(keep_alive);
+}
 
-  auto handle_session = [h = std::move(handler)](tcp::socket socket) {
-    HandleSession(std::move(socket), h);
+/// Returns a handler that rejects all requests due to overload.
+Handler MakeOverloadHandler(std::chrono::seconds retry_after) {
+  return [value = std::to_string(retry_after.count())](BeastRequest const&) {
+    BeastResponse response;
+    response.result(be::http::status::service_unavailable);
+    response.set(be::http::field::retry_after, value);
+    response.set(be::http::field::connection, "close");
+    return response;
   };
+}
+
+/**
+ * Handles a single HTTP connection.
+ *
+ * Each session reads requests from the connection, invokes the handler, and
+ * writes back the response, until the peer closes the connection or an error
+ * is detected. All the I/O is asynchronous, the operations for a session are
+ * serialized through the strand associated with its socket.
+ *
+ * The @p on_close callback runs when the session is destroyed, that is, once
+ * all the I/O operations for the session have completed.
+ *
+ * Once @p draining is set the session stops reading new requests, and any
+ * request already in progress receives a response with `Connection: close`.
+ * The same happens once the connection reaches its request or age limit, so
+ * the clients spread their new connections across all the instances.
+ *
+ * Streaming handlers run in a separate thread pool, as they block waiting for
+ * the request body. Their reads are forwarded to the session's strand, so all
+ * the I/O remains asynchronous (and subject to the body timeout). If the
+ * handler does not consume the full body the connection is closed after the
+ * response.
+ *
+ * The session closes the connection if the peer takes too long to start a new
+ * request (the idle timeout), to send the request header or body, or to
+ * receive the response.
+ *
+ * Requests with a header or body larger than the configured limits are
+ * rejected, with a `431 Request Header Fields Too Large` or a
+ * `413 Payload Too Large` response respectively. If the request declares its
+ * body size the response is sent without reading the body.
+ *
+ * The precheck handler, if any, runs once the header is received, and may
+ * reject the request before its body is read. Clients that send
+ * `Expect: 100-continue` receive the `100 Continue` interim response only
+ * after the request passes these checks.
+ *
+ * With `--http2` the session hands over the connection to an `Http2Session`,
+ * if it starts with the HTTP/2 connection preface, or if a request asks to
+ * upgrade the connection to h2c. Likewise, WebSocket functions receive the
+ * connection of each WebSocket upgrade request in a `WebSocketSession`.
+ */
+class HttpSession : public std::enable_shared_from_this<HttpSession> {
+ public:
+  HttpSession(stream_protocol::socket socket, ServerOptions const& options,
+              SessionHandlers const& handlers,
+              std::atomic<bool> const& draining,
+              std::function<void()> on_close)
+      : stream_(std::move(socket)),
+        executor_(stream_.get_executor()),
+        pipelining_(options.pipeline_depth > 1 && !handlers.streaming_handler &&
+                    !handlers.writer_handler),
+        fields_pool_(MakeFieldsPool(pipelining_ ||
+                                    static_cast<bool>(handlers.async_handler))),
+        options_(options),
+        handlers_(handlers),
+        draining_(draining),
+        on_close_(std::move(on_close)),
+        status_(handlers.server_state ? handlers.server_state->OpenSession()
+                                      : nullptr) {
+    auto const jitter = options.connection_limit_jitter;
+    if (options.max_connection_requests != 0) {
+      auto const limit = WithJitter(
+          static_cast<double>(options.max_connection_requests), jitter);
+      max_requests_ =
+          std::max<std::uint64_t>(1, static_cast<std::uint64_t>(limit));
+    }
+    if (options.max_connection_age != std::chrono::seconds(0)) {
+      auto const age = std::chrono::duration<double>(WithJitter(
+          static_cast<double>(options.max_connection_age.count()), jitter));
+      retire_at_ =
+          std::chrono::steady_clock::now() +
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(age);
+    }
+  }
+
+  ~HttpSession() {
+    if (on_close_) on_close_();
+  }
+
+  HttpSession(HttpSession const&) = delete;
+  HttpSession& operator=(HttpSession const&) = delete;
+
+  void Start() {
+    // The socket was accepted on a strand, dispatch to that strand to make sure
+    // the session is never running in two threads.
+    asio::dispatch(stream_.get_executor(), [self = shared_from_this()] {
+      self->DoRead();
+    });
+  }
+
+  /// Closes the connection if it is waiting for a new request.
+  void Drain() {
+    asio::dispatch(stream_.get_executor(), [self = shared_from_this()] {
+#ifdef FUNCTIONS_FRAMEWORK_CPP_HAVE_HTTP2
+      if (auto h2 = self->http2_.lock()) return h2->Drain();
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_HTTP2
+      if (auto ws = self->websocket_.lock()) return ws->Drain();
+      if (self->idle_) self->stream_.cancel();
+    });
+  }
+
+  /// Closes the connection, even if a request is in progress.
+  void Abort() {
+    asio::dispatch(stream_.get_executor(), [self = shared_from_this()] {
+#ifdef FUNCTIONS_FRAMEWORK_CPP_HAVE_HTTP2
+      if (auto h2 = self->http2_.lock()) return h2->Abort();
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_HTTP2
+      if (auto ws = self->websocket_.lock()) return ws->Abort();
+      be::error_code ec;
+      self->stream_.socket().close(ec);
+    });
+  }
+
+ private:
+  void ExpiresAfter(std::chrono::seconds timeout) {
+    if (timeout == std::chrono::seconds(0)) return stream_.expires_never();
+    stream_.expires_after(timeout);
+  }
+
+  /// Returns `true` once the connection reached its request or age limit.
+  [[nodiscard]] bool Expired() const {
+    if (max_requests_ != 0 && requests_ >= max_requests_) return true;
+    return retire_at_ && std::chrono::steady_clock::now() >= *retire_at_;
+  }
+
+  /// Returns `true` if @p ec means the session should close silently.
+  static bool IsClosed(be::error_code ec) {
+    // With a timeout the stream has already closed the socket.
+    return ec == be::http::error::end_of_stream || ec == asio::error::eof ||
+           ec == asio::error::operation_aborted || ec == be::error::timeout;
+  }
+
+  void DoRead() {
+    reading_ = true;
+    if (draining_.load()) return DoClose();
+    // Start each request from a fresh message, but allocate its fields from
+    // the memory pool owned by this session. The buffer is also reused, it may
+    // contain data for the next request, e.g., if the client pipelines
+    // requests.
+    parser_.emplace(std::piecewise_construct, std::make_tuple(),
+                    std::make_tuple(
+                        BeastRequestFields::allocator_type(fields_pool_)));
+    parser_->header_limit(options_.max_header_size);
+    parser_->body_limit(options_.max_body_size);
+    fast_parsed_ = false;
+    if (buffer_.size() != 0) return DoReadHeader();
+    // Wait for the first bytes of the request, only this wait is subject to
+    // the idle timeout.
+    auto constexpr kReadSize = 16 * 1024;
+    idle_ = true;
+    SetState(SessionState::kIdle);
+    ExpiresAfter(options_.idle_timeout);
+    stream_.async_read_some(
+        buffer_.prepare(kReadSize),
+        [self = shared_from_this()](be::error_code ec, std::size_t n) {
+          self->OnIdle(ec, n);
+        });
+  }
+
+  void OnIdle(be::error_code ec, std::size_t n) {
+    idle_ = false;
+    if (IsClosed(ec)) return DoClose();
+    if (ec) return ReportError(ec, "read");
+    buffer_.commit(n);
+#ifdef FUNCTIONS_FRAMEWORK_CPP_HAVE_HTTP2
+    // Only the first bytes in the connection may be the HTTP/2 preface.
+    if (std::exchange(first_read_, false) && options_.http2) {
+      return DoDetectHttp2();
+    }
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_HTTP2
+    DoReadHeader();
+  }
+
+#ifdef FUNCTIONS_FRAMEWORK_CPP_HAVE_HTTP2
+  /// Reads until the buffer is known to be, or not to be, the HTTP/2 preface.
+  void DoDetectHttp2() {
+    auto const data = BufferView();
+    if (!IsHttp2PrefacePrefix(data)) return DoReadHeader();
+    if (IsHttp2Preface(data)) return StartHttp2({});
+    auto constexpr kReadSize = 1024;
+    ExpiresAfter(options_.header_timeout);
+    stream_.async_read_some(
+        buffer_.prepare(kReadSize),
+        [self = shared_from_this()](be::error_code ec, std::size_t n) {
+          if (IsClosed(ec)) return self->DoClose();
+          if (ec) return ReportError(ec, "read");
+          self->buffer_.commit(n);
+          self->DoDetectHttp2();
+        });
+  }
+
+  /// Moves the connection, and any buffered data, to a new HTTP/2 session.
+  void StartHttp2(std::optional<BeastRequest> upgrade) {
+    stream_.expires_never();
+    auto const data = be::buffers_to_string(buffer_.data());
+    buffer_.consume(buffer_.size());
+    auto h2 = std::make_shared<Http2Session>(
+        stream_.release_socket(),
+        Http2Options{options_.idle_timeout, options_.max_header_size,
+                     options_.max_body_size, options_.http2_max_streams},
+        handlers_.handler, handlers_.precheck, shared_from_this());
+    http2_ = h2;
+    if (upgrade) return h2->StartUpgrade(*std::move(upgrade), data);
+    h2->Start(data);
+  }
+
+  std::string_view BufferView() const {
+    auto const data = buffer_.data();
+    return {static_cast<char const*>(data.data()), data.size()};
+  }
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_HTTP2
+
+  /// Moves the connection to a new WebSocket session, for @p request.
+  void StartWebSocket(BeastRequest request) {
+    // The connection outlives any request timing, and its body budget.
+    record_.reset();
+    body_reservation_ = {};
+    auto ws = std::make_shared<WebSocketSession>(
+        stream_.release_socket(),
+        WebSocketOptions{options_.idle_timeout, options_.header_timeout,
+                         options_.max_body_size},
+        handlers_.websocket_handler, shared_from_this());
+    websocket_ = ws;
+    ws->Start(std::move(request));
+    if (draining_.load()) ws->Drain();
+  }
+
+  void DoReadHeader() {
+    // The request starts with its first byte, idle time is not counted.
+    auto const previous_requests = requests_++;
+    SetState(SessionState::kReading);
+    if (status_) status_->OnRequest();
+    if (timed()) {
+      record_ = std::make_shared<RequestRecord>();
+      record_->start = RequestTiming::Clock::now();
+      record_->connection_requests = previous_requests;
+    }
+    if (options_.fast_request_parser && TryFastParse()) {
+      return OnReadHeader({});
+    }
+    ExpiresAfter(options_.header_timeout);
+    be::http::async_read_header(
+        stream_, buffer_, *parser_,
+        [self = shared_from_this()](be::error_code ec, std::size_t) {
+          self->OnReadHeader(ec);
+        });
+  }
+
+  /**
+   * Parses a complete request from the buffer, without Boost.Beast.
+   *
+   * Returns `false`, leaving the buffer and the parser untouched, if the
+   * request is incomplete or needs the general parser. Streaming functions
+   * take over the parser itself, so they always use Boost.Beast.
+   */
+  bool TryFastParse() {
+    if (handlers_.streaming_handler) return false;
+    auto const data = buffer_.data();
+    auto const n = FastParseRequest(
+        {static_cast<char const*>(data.data()), data.size()},
+        FastParseLimits{options_.max_header_size, options_.max_body_size},
+        parser_->get());
+    if (n == 0) return false;
+    buffer_.consume(n);
+    fast_parsed_ = true;
+    return true;
+  }
+
+  /// Returns `true` if the request, including its body, is fully read.
+  bool RequestDone() { return fast_parsed_ || parser_->is_done(); }
+
+  void OnReadHeader(be::error_code ec) {
+    if (IsClosed(ec)) return DoClose();
+    // The parser reports a `Content-Length` over the limit with the header.
+    if (ec == be::http::error::body_limit) {
+      return DoReject(be::http::status::payload_too_large);
+    }
+    if (ec == be::http::error::header_limit) {
+      return DoReject(be::http::status::request_header_fields_too_large);
+    }
+    if (ec) return ReportError(ec, "read");
+    auto const& request = parser_->get();
+    auto const expect = request[be::http::field::expect];
+    auto const expect_continue = be::iequals(expect, "100-continue");
+    if (!expect.empty() && !expect_continue) {
+      return DoReject(be::http::status::expectation_failed);
+    }
+    if (handlers_.static_routes) {
+      if (handlers_.static_routes->IsAsync(request.target())) {
+        return DoAsyncStaticResponse();
+      }
+      auto route = handlers_.static_routes->Respond(
+          request.target(), request[be::http::field::authorization]);
+      if (route) return DoStaticResponse(*std::move(route));
+    }
+    if (handlers_.precheck) {
+      ScopedPeerAddress peer(peer_address_);
+      if (auto response = handlers_.precheck(request)) {
+        return DoReject(*std::move(response));
+      }
+    }
+    if (!ReserveBody()) return DoReject(BodyBudgetExhausted());
+    // Only ask for the body if the client is waiting for the go-ahead, and the
+    // interim response cannot interleave with pipelined responses.
+    auto constexpr kHttp11 = 11;
+    if (expect_continue && !RequestDone() &&
+        request.version() >= kHttp11 && pipeline_.empty()) {
+      return DoContinue();
+    }
+    OnContinue();
+  }
+
+  /// Sends @p response for a static route, without calling any handler.
+  void DoStaticResponse(BeastResponse response) {
+    record_.reset();
+    // Skipping the body of a request requires closing the connection.
+    if (!RequestDone()) return DoReject(std::move(response));
+    stream_.expires_never();
+    auto const keep_alive = parser_->get().keep_alive();
+    if (pipelining_) {
+      // Send the response after any pipelined responses.
+      auto slot = std::make_shared<PipelinedResponse>();
+      slot->response = std::move(response);
+      slot->keep_alive = keep_alive;
+      slot->ready = true;
+      pipeline_.push_back(std::move(slot));
+      return ContinuePipeline(keep_alive);
+    }
+    response_ = std::move(response);
+    OnResponse(keep_alive);
+  }
+
+  /// Waits for the response of an asynchronous static route, e.g. a profile.
+  void DoAsyncStaticResponse() {
+    SetState(SessionState::kRunning);
+    stream_.expires_never();
+    auto const& request = parser_->get();
+    // The event loop must keep running until the response is ready, even if
+    // the server is shutting down.
+    auto work = asio::prefer(stream_.get_executor(),
+                             asio::execution::outstanding_work.tracked);
+    handlers_.static_routes->RespondAsync(
+        request.target(), request[be::http::field::authorization],
+        [self = shared_from_this(), work](BeastResponse response) {
+          asio::post(work, [self, response = std::move(response)]() mutable {
+            self->DoStaticResponse(std::move(response));
+          });
+        });
+  }
+
+  void DoContinue() {
+    ExpiresAfter(options_.write_timeout);
+    asio::async_write(
+        stream_, asio::buffer(kContinue),
+        [self = shared_from_this()](be::error_code ec, std::size_t) {
+          if (IsClosed(ec)) return self->DoClose();
+          if (ec) return ReportError(ec, "write");
+          self->OnContinue();
+        });
+  }
+
+  /// Reads the request body, once the request is accepted.
+  void OnContinue() {
+    if (handlers_.streaming_handler) return DoStreamingCall();
+    if (RequestDone()) return OnRead({});
+    ExpiresAfter(options_.body_timeout);
+    // Without a `Content-Length` the body is reserved as it grows.
+    if (handlers_.body_budget && !parser_->content_length()) {
+      return DoReadUnsizedBody();
+    }
+    be::http::async_read(
+        stream_, buffer_, *parser_,
+        [self = shared_from_this()](be::error_code ec, std::size_t) {
+          self->OnRead(ec);
+        });
+  }
+
+  /**
+   * Reserves the memory for the body of a buffered request.
+   *
+   * Returns `false` if the budget does not have enough memory left. Bodies
+   * without a `Content-Length` are reserved as they are read.
+   */
+  bool ReserveBody() {
+    if (!handlers_.body_budget || handlers_.streaming_handler) return true;
+    body_reservation_ = handlers_.body_budget->MakeReservation();
+    auto const length = parser_->content_length();
+    if (!length || RequestDone()) return true;
+    return body_reservation_.GrowTo(*length);
+  }
+
+  BeastResponse BodyBudgetExhausted() const {
+    BeastResponse response;
+    response.result(be::http::status::service_unavailable);
+    response.set(be::http::field::retry_after,
+                 std::to_string(options_.retry_after.count()));
+    return response;
+  }
+
+  void DoReadUnsizedBody() {
+    be::http::async_read_some(
+        stream_, buffer_, *parser_,
+        [self = shared_from_this()](be::error_code ec, std::size_t) {
+          self->OnReadUnsizedBody(ec);
+        });
+  }
+
+  void OnReadUnsizedBody(be::error_code ec) {
+    if (ec) return OnRead(ec);
+    // The reservation may fall behind the body by one read.
+    if (!body_reservation_.GrowTo(parser_->get().body().size())) {
+      return DoReject(BodyBudgetExhausted());
+    }
+    if (parser_->is_done()) return OnRead({});
+    DoReadUnsizedBody();
+  }
+
+  void OnRead(be::error_code ec) {
+    if (IsClosed(ec)) return DoClose();
+    if (ec == be::http::error::body_limit) {
+      return DoReject(be::http::status::payload_too_large);
+    }
+    if (ec) return ReportError(ec, "read");
+    OnRequestRead(parser_->get(), parser_->get().body().size());
+    // The handler has no deadline, the timeouts only apply to the I/O.
+    stream_.expires_never();
+    if (handlers_.websocket_handler && pipeline_.empty() &&
+        be::websocket::is_upgrade(parser_->get())) {
+      return StartWebSocket(parser_->release());
+    }
+#ifdef FUNCTIONS_FRAMEWORK_CPP_HAVE_HTTP2
+    if (options_.http2 && pipeline_.empty() &&
+        IsHttp2Upgrade(parser_->get())) {
+      return StartHttp2(parser_->release());
+    }
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_HTTP2
+    // Pipelined sessions read ahead, they cannot detect disconnects.
+    if (!pipelining_) WatchDisconnect();
+    if (handlers_.writer_handler) return DoWriterCall(parser_->release());
+    auto const keep_alive = parser_->get().keep_alive();
+    if (pipelining_) return DoPipelinedCall(parser_->release(), keep_alive);
+    if (handlers_.async_handler) {
+      return DoAsyncCall(parser_->release(), keep_alive);
+    }
+    SetState(SessionState::kRunning);
+    {
+      ScopedRequestTiming timing(Timing(record_));
+      ScopedCancellation cancellation(cancellation_.get());
+      response_ = handlers_.handler(parser_->release());
+    }
+    OnResponse(keep_alive);
+  }
+
+  /**
+   * Cancels the current request if the client disconnects before its response.
+   *
+   * The session waits for the socket to become readable, outside the strand,
+   * as the handler may be blocking it. If the client sends more data, e.g.,
+   * the body of a streaming request, the session stops watching.
+   */
+  void WatchDisconnect() {
+    cancellation_ = std::make_shared<CancellationState>();
+#ifndef _WIN32
+    auto& ioc = static_cast<asio::io_context&>(
+        asio::query(executor_, asio::execution::context));
+    auto& socket = stream_.socket();
+    socket.async_wait(
+        stream_protocol::socket::wait_read,
+        asio::bind_executor(ioc, [state = cancellation_,
+                                  fd = socket.native_handle()](
+                                     be::error_code ec) {
+          // The session closes the socket, cancelling the wait, only once the
+          // state is released, or when aborting the request.
+          if (!ec && PeerConnected(fd)) return;
+          state->Cancel();
+        }));
+#endif  // _WIN32
+  }
+
+#ifndef _WIN32
+  /// Returns `false` if the peer closed the connection, or it failed.
+  static bool PeerConnected(stream_protocol::socket::native_handle_type fd) {
+    char c;
+    auto const n = ::recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (n > 0) return true;
+    return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+  }
+#endif  // _WIN32
+
+  /// The response is ready, the client can no longer cancel the request.
+  void ReleaseCancellation() {
+    if (auto state = std::exchange(cancellation_, nullptr)) state->Release();
+  }
+
+  /// Records the end of the read phase, and the attributes of @p request.
+  void OnRequestRead(BeastRequest const& request, std::uint64_t size) {
+    if (!record_) return;
+    auto const now = RequestTiming::Clock::now();
+    record_->read_done = now;
+    RecordPhase(*record_, RequestPhase::kRead, now - record_->start);
+    if (handlers_.flight_recorder) {
+      record_->in_flight = handlers_.flight_recorder->Begin(
+          request.method_string(), request.target(), record_->start);
+    }
+    if (!handlers_.slow_requests) return;
+    record_->method = std::string(request.method_string());
+    record_->target = std::string(request.target());
+    record_->request_size = size;
+    record_->log_context = MakeLogContext(request);
+  }
+
+  /// Records the time @p record waited for a thread, from any thread.
+  void RecordQueue(RequestRecord* record) {
+    if (record == nullptr) return;
+    RecordPhase(*record, RequestPhase::kQueue,
+                RequestTiming::Clock::now() - record->read_done);
+  }
+
+  /// Reports the time a handler waited for a thread, from any thread.
+  void RecordQueueDelay(AdmissionController::Clock::time_point queued) {
+    if (handlers_.admission == nullptr) return;
+    handlers_.admission->RecordDelay(AdmissionController::Clock::now() -
+                                     queued);
+  }
+
+  static RequestTiming* Timing(std::shared_ptr<RequestRecord> const& record) {
+    return record ? &record->timing : nullptr;
+  }
+
+  /// Starts an asynchronous handler, its callback resumes the session.
+  void DoAsyncCall(BeastRequest request, bool keep_alive) {
+    // The record outlives the callback, it is only released once the
+    // response is sent.
+    SetState(SessionState::kRunning);
+    ScopedRequestTiming timing(Timing(record_));
+    ScopedCancellation cancellation(cancellation_.get());
+    handlers_.async_handler(
+        std::move(request),
+        [self = shared_from_this(), keep_alive](BeastResponse response) {
+          asio::post(self->executor_, [self, keep_alive,
+                                       r = std::move(response)]() mutable {
+            self->response_ = std::move(r);
+            self->OnResponse(keep_alive);
+          });
+        });
+  }
+
+  static std::shared_ptr<std::pmr::memory_resource> MakeFieldsPool(
+      bool synchronized) {
+    // Pipelined and asynchronous handlers release their requests outside the
+    // strand.
+    if (synchronized) {
+      return std::make_shared<std::pmr::synchronized_pool_resource>();
+    }
+    return std::make_shared<std::pmr::unsynchronized_pool_resource>();
+  }
+
+  /**
+   * Runs the handler outside the strand, and keeps reading pipelined requests.
+   *
+   * The session only reads ahead while the client has already sent more data,
+   * and never reads and writes at the same time.
+   */
+  void DoPipelinedCall(BeastRequest request, bool keep_alive) {
+    auto slot = std::make_shared<PipelinedResponse>();
+    slot->keep_alive = keep_alive;
+    slot->record = std::move(record_);
+    slot->body = std::move(body_reservation_);
+    pipeline_.push_back(slot);
+    if (handlers_.async_handler) {
+      // Asynchronous handlers do not block, start them in the strand. The slot
+      // keeps the record alive until the callback runs.
+      ScopedRequestTiming timing(Timing(slot->record));
+      handlers_.async_handler(
+          std::move(request),
+          [self = shared_from_this(), slot](BeastResponse response) {
+            asio::post(self->executor_, [self, slot,
+                                         r = std::move(response)]() mutable {
+              slot->response = std::move(r);
+              slot->ready = true;
+              self->OnPipelinedResponse();
+            });
+          });
+      return ContinuePipeline(keep_alive);
+    }
+    // The handler may run in any of the threads serving this event loop.
+    auto& ioc = static_cast<asio::io_context&>(
+        asio::query(executor_, asio::execution::context));
+    SetState(SessionState::kQueued);
+    auto const queued = AdmissionController::Clock::now();
+    asio::post(ioc, [self = shared_from_this(), request = std::move(request),
+                     slot, queued]() mutable {
+      self->RecordQueue(slot->record.get());
+      self->RecordQueueDelay(queued);
+      self->SetState(SessionState::kRunning);
+      auto response = [&] {
+        ScopedRequestTiming timing(Timing(slot->record));
+        return self->handlers_.handler(std::move(request));
+      }();
+      asio::dispatch(self->executor_, [self, slot,
+                                       r = std::move(response)]() mutable {
+        slot->response = std::move(r);
+        slot->ready = true;
+        self->OnPipelinedResponse();
+      });
+    });
+    ContinuePipeline(keep_alive);
+  }
+
+  /// Reads the next pipelined request, if available, or writes responses.
+  void ContinuePipeline(bool keep_alive) {
+    be::error_code ec;
+    auto const has_input =
+        buffer_.size() != 0 || stream_.socket().available(ec) != 0;
+    if (keep_alive && has_input && !draining_.load() && !Expired() &&
+        pipeline_.size() < options_.pipeline_depth) {
+      return DoRead();
+    }
+    reading_ = false;
+    OnPipelinedResponse();
+  }
+
+  /// Writes the next pipelined response, or resumes reading once all are sent.
+  void OnPipelinedResponse() {
+    if (closed_ || reading_ || writing_) return;
+    if (pipeline_.empty()) return close_after_pipeline_ ? DoClose() : DoRead();
+    auto slot = pipeline_.front();
+    if (!slot->ready) return;
+    pipeline_.pop_front();
+    response_ = std::move(slot->response);
+    write_record_ = std::move(slot->record);
+    writing_ = true;
+    OnResponse(slot->keep_alive);
+  }
+
+  /**
+   * Runs @p f in the streaming pool, and then its result in the strand.
+   *
+   * @p f receives the session, and returns a function to continue processing
+   * the request in the session's strand. The work guard keeps the event loop
+   * running while @p f runs.
+   */
+  template <typename Function>
+  void RunInPool(Function f) {
+    SetState(SessionState::kQueued);
+    auto* state = handlers_.server_state;
+    if (state) state->PoolTaskQueued();
+    asio::post(*handlers_.streaming_pool,
+               [self = shared_from_this(), f = std::move(f), state,
+                queued = AdmissionController::Clock::now(),
+                work = asio::make_work_guard(executor_)]() mutable {
+                 if (state) state->PoolTaskStarted();
+                 self->RecordQueueDelay(queued);
+                 self->SetState(SessionState::kRunning);
+                 auto continuation = f(self);
+                 if (state) state->PoolTaskDone();
+                 asio::post(work.get_executor(),
+                            [s = std::move(self),
+                             c = std::move(continuation)]() mutable { c(*s); });
+                 work.reset();
+               });
+  }
+
+  /**
+   * Runs @p f in the session's strand, blocking until it sets the result.
+   *
+   * The handlers in the streaming pool use this function to perform I/O.
+   */
+  template <typename T, typename Function>
+  static T CallInStrand(std::shared_ptr<HttpSession> const& session,
+                        Function f) {
+    auto p = std::make_shared<std::promise<T>>();
+    auto result = p->get_future();
+    asio::post(session->executor_,
+               [s = session, f = std::move(f), p = std::move(p)]() mutable {
+                 f(*s, std::move(p));
+               });
+    return result.get();
+  }
+
+  /// Reads the request body on behalf of a streaming handler.
+  class BodyReader : public functions::HttpRequestBodyReader {
+   public:
+    explicit BodyReader(std::shared_ptr<HttpSession> session)
+        : session_(std::move(session)) {}
+
+    std::size_t Read(char* data, std::size_t size) override {
+      if (size == 0) return 0;
+      return CallInStrand<std::size_t>(
+          session_, [data, size](HttpSession& s, auto p) {
+            s.DoReadBody(data, size, std::move(p));
+          });
+    }
+
+   private:
+    std::shared_ptr<HttpSession> session_;
+  };
+
+  /// Sends the response on behalf of a writer handler.
+  class StreamWriter : public ResponseWriter {
+   public:
+    explicit StreamWriter(std::shared_ptr<HttpSession> session)
+        : session_(std::move(session)) {}
+
+    void WriteHeader(BeastResponse header) override {
+      CallInStrand<void>(session_, [&header](HttpSession& s, auto p) {
+        s.DoWriteHeader(std::move(header.base()), std::move(p));
+      });
+      if (!header.body().empty()) Write(header.body().str());
+    }
+
+    void Write(std::string_view data) override {
+      if (data.empty()) return;
+      CallInStrand<void>(session_, [data](HttpSession& s, auto p) {
+        s.DoWriteChunk(data, std::move(p));
+      });
+    }
+
+    void SetHeartbeat(std::string_view data,
+                      std::chrono::milliseconds interval) override {
+      CallInStrand<void>(session_, [data, interval](HttpSession& s, auto p) {
+        s.DoSetHeartbeat(data, interval);
+        p->set_value();
+      });
+    }
+
+   private:
+    std::shared_ptr<HttpSession> session_;
+  };
+
+  void DoStreamingCall() {
+    // The body is read while the function runs, this is the header time.
+    OnRequestRead(parser_->get(), parser_->content_length().value_or(0));
+    stream_.expires_never();
+    streaming_parser_.emplace(std::move(*parser_));
+    auto const keep_alive = streaming_parser_->get().keep_alive();
+    WatchDisconnect();
+    RunInPool([request = BeastRequest(streaming_parser_->get().base()),
+               keep_alive, record = record_, cancellation = cancellation_](
+                  std::shared_ptr<HttpSession> const& self) mutable {
+      self->RecordQueue(record.get());
+      BodyReader reader(self);
+      ScopedRequestTiming timing(Timing(record));
+      ScopedCancellation scoped(cancellation.get());
+      auto response =
+          self->handlers_.streaming_handler(std::move(request), reader);
+      return [r = std::move(response), keep_alive](HttpSession& s) mutable {
+        s.OnStreamingResponse(std::move(r), keep_alive);
+      };
+    });
+  }
+
+  void DoWriterCall(BeastRequest request) {
+    stream_keep_alive_ = request.keep_alive();
+    // HTTP/1.0 does not support chunked encoding.
+    auto constexpr kHttp11 = 11;
+    stream_chunked_ = request.version() >= kHttp11;
+    // The response is sent by the handler, the slow request log does not
+    // include these requests.
+    RunInPool([request = std::move(request), record = std::move(record_),
+               cancellation = cancellation_](
+                  std::shared_ptr<HttpSession> const& self) mutable {
+      self->RecordQueue(record.get());
+      StreamWriter writer(self);
+      ScopedRequestTiming timing(Timing(record));
+      ScopedCancellation scoped(cancellation.get());
+      auto ok = false;
+      try {
+        ok = self->handlers_.writer_handler(std::move(request), writer);
+      } catch (...) {
+        // Errors sending the response are reported by the session.
+      }
+      return [ok](HttpSession& s) { s.OnWriterDone(ok); };
+    });
+  }
+
+  void DoWriteHeader(be::http::response_header<> header,
+                     std::shared_ptr<std::promise<void>> p) {
+    auto const close = draining_.load() || Expired() ||
+                       be::http::token_list{header[be::http::field::connection]}
+                           .exists("close");
+    stream_keep_alive_ = stream_keep_alive_ && stream_chunked_ && !close;
+    stream_response_.emplace(std::move(header));
+    stream_response_->set(be::http::field::server, BOOST_BEAST_VERSION_STRING);
+    if (stream_response_->find(be::http::field::date) ==
+        stream_response_->end()) {
+      stream_response_->set(be::http::field::date, CurrentHttpDate());
+    }
+    // Without chunked encoding the end of the body is signaled by closing the
+    // connection.
+    stream_response_->erase(be::http::field::content_length);
+    stream_response_->chunked(stream_chunked_);
+    stream_response_->keep_alive(stream_keep_alive_);
+    stream_serializer_.emplace(*stream_response_);
+    stream_writing_ = true;
+    ExpiresAfter(options_.write_timeout);
+    be::http::async_write_header(
+        stream_, *stream_serializer_,
+        [self = shared_from_this(), p = std::move(p)](be::error_code ec,
+                                                      std::size_t) {
+          self->OnStreamWrite(ec, *p);
+        });
+  }
+
+  void DoWriteChunk(std::string_view data,
+                    std::shared_ptr<std::promise<void>> p) {
+    if (heartbeat_writing_) {
+      // The handler is blocked, @p data remains valid.
+      pending_write_ = [self = shared_from_this(), data,
+                        p = std::move(p)]() mutable {
+        self->DoWriteChunk(data, std::move(p));
+      };
+      return;
+    }
+    stream_writing_ = true;
+    heartbeat_timer_.cancel();
+    auto on_write = [self = shared_from_this(), p = std::move(p)](
+                        be::error_code ec, std::size_t) {
+      self->OnStreamWrite(ec, *p);
+    };
+    ExpiresAfter(options_.write_timeout);
+    auto const payload = asio::buffer(data.data(), data.size());
+    if (!stream_chunked_) {
+      return asio::async_write(stream_, payload, std::move(on_write));
+    }
+    auto constexpr kHex = 16;
+    chunk_header_ = ToHex(data.size(), kHex) + "\r\n";
+    std::array<asio::const_buffer, 3> const buffers{
+        asio::buffer(chunk_header_), payload, asio::buffer(kCrLf)};
+    asio::async_write(stream_, buffers, std::move(on_write));
+  }
+
+  void OnStreamWrite(be::error_code ec, std::promise<void>& p) {
+    stream_.expires_never();
+    stream_writing_ = false;
+    if (ec) {
+      return p.set_exception(std::make_exception_ptr(std::runtime_error(
+          "error writing the response: " + ec.message())));
+    }
+    ArmHeartbeat();
+    p.set_value();
+  }
+
+  /// Sends @p data, framed as a chunk if needed, once idle for @p interval.
+  void DoSetHeartbeat(std::string_view data,
+                      std::chrono::milliseconds interval) {
+    heartbeat_interval_ = data.empty() ? std::chrono::milliseconds(0)
+                                       : interval;
+    heartbeat_.clear();
+    if (stream_chunked_) {
+      auto constexpr kHex = 16;
+      heartbeat_ = ToHex(data.size(), kHex) + "\r\n";
+    }
+    heartbeat_ += data;
+    if (stream_chunked_) heartbeat_ += kCrLf;
+    heartbeat_timer_.cancel();
+    if (!stream_writing_ && !heartbeat_writing_) ArmHeartbeat();
+  }
+
+  void ArmHeartbeat() {
+    if (heartbeat_interval_ == std::chrono::milliseconds(0) ||
+        !stream_serializer_) {
+      return;
+    }
+    heartbeat_timer_.expires_after(heartbeat_interval_);
+    heartbeat_timer_.async_wait(
+        [self = shared_from_this()](be::error_code ec) {
+          if (!ec) self->OnHeartbeat();
+        });
+  }
+
+  void OnHeartbeat() {
+    // The handler may have started a write before the timer was cancelled.
+    if (stream_writing_ || heartbeat_writing_ ||
+        heartbeat_interval_ == std::chrono::milliseconds(0)) {
+      return;
+    }
+    heartbeat_writing_ = true;
+    ExpiresAfter(options_.write_timeout);
+    asio::async_write(stream_, asio::buffer(heartbeat_),
+                      [self = shared_from_this()](be::error_code ec,
+                                                  std::size_t) {
+                        self->OnHeartbeatWritten(ec);
+                      });
+  }
+
+  void OnHeartbeatWritten(be::error_code ec) {
+    stream_.expires_never();
+    heartbeat_writing_ = false;
+    if (ec) {
+      // The client is gone, the next write reports the error.
+      heartbeat_interval_ = std::chrono::milliseconds(0);
+      if (cancellation_) cancellation_->Cancel();
+    }
+    if (auto pending = std::exchange(pending_write_, nullptr)) {
+      return pending();
+    }
+    ArmHeartbeat();
+  }
+
+  void OnWriterDone(bool ok) {
+    if (heartbeat_writing_) {
+      pending_write_ = [self = shared_from_this(), ok] {
+        self->OnWriterDone(ok);
+      };
+      return;
+    }
+    heartbeat_interval_ = std::chrono::milliseconds(0);
+    heartbeat_timer_.cancel();
+    ReleaseCancellation();
+    body_reservation_ = {};
+    stream_serializer_.reset();
+    stream_response_.reset();
+    FlushLogs();
+    // Close the connection without completing the response, the client can
+    // detect the response is truncated.
+    if (!ok) {
+      be::error_code ec;
+      stream_.socket().close(ec);
+      return;
+    }
+    if (!stream_chunked_) return DoClose();
+    ExpiresAfter(options_.write_timeout);
+    asio::async_write(
+        stream_, asio::buffer(kLastChunk),
+        [self = shared_from_this()](be::error_code ec, std::size_t) {
+          self->OnLastChunk(ec);
+        });
+  }
+
+  void OnLastChunk(be::error_code ec) {
+    if (ec) return ReportError(ec, "write");
+    if (!stream_keep_alive_) return DoClose();
+    DoRead();
+  }
+
+  static std::string ToHex(std::size_t value, std::size_t base) {
+    std::string s;
+    do {
+      s.insert(s.begin(), "0123456789abcdef"[value % base]);
+      value /= base;
+    } while (value != 0);
+    return s;
+  }
+
+  void DoReadBody(char* data, std::size_t size,
+                  std::shared_ptr<std::promise<std::size_t>> p) {
+    if (streaming_parser_->is_done()) return p->set_value(0);
+    auto& body = streaming_parser_->get().body();
+    body.data = data;
+    body.size = size;
+    body.more = true;
+    ExpiresAfter(options_.body_timeout);
+    be::http::async_read_some(
+        stream_, buffer_, *streaming_parser_,
+        [self = shared_from_this(), data, size, p = std::move(p)](
+            be::error_code ec, std::size_t) mutable {
+          self->OnReadBody(ec, data, size, std::move(p));
+        });
+  }
+
+  void OnReadBody(be::error_code ec, char* data, std::size_t size,
+                  std::shared_ptr<std::promise<std::size_t>> p) {
+    stream_.expires_never();
+    // The buffer is full, this is the normal result with a `buffer_body`.
+    if (ec == be::http::error::need_buffer) ec = {};
+    if (ec) {
+      return p->set_exception(std::make_exception_ptr(std::runtime_error(
+          "error reading the request body: " + ec.message())));
+    }
+    auto const n = size - streaming_parser_->get().body().size;
+    // Some reads only consume framing, e.g., the size of a chunk.
+    if (n == 0 && !streaming_parser_->is_done()) {
+      return DoReadBody(data, size, std::move(p));
+    }
+    p->set_value(n);
+  }
+
+  void OnStreamingResponse(BeastResponse response, bool keep_alive) {
+    response_ = std::move(response);
+    // Unless the full body was consumed the connection is not reusable.
+    auto const done = streaming_parser_->is_done();
+    streaming_parser_.reset();
+    OnResponse(keep_alive && done);
+  }
+
+  void OnResponse(bool keep_alive) {
+    ReleaseCancellation();
+    body_reservation_ = {};
+    // Flush any buffered output, as the application may be shutdown immediately
+    // after the HTTP response is sent.
+    FlushLogs();
+    // Send the response. The handler may request closing the connection, e.g.,
+    // when the server is overloaded, and the connection is always closed when
+    // the server is shutting down. Connections past their limits close after
+    // the responses for any pipelined requests.
+    auto const expired =
+        Expired() && (!pipelining_ || (pipeline_.empty() && !reading_));
+    auto const close = draining_.load() || expired ||
+                       be::http::token_list{
+                           response_[be::http::field::connection]}
+                           .exists("close");
+    DoWrite(keep_alive && !close);
+  }
+
+  /// Rejects the current request and closes the connection.
+  void DoReject(be::http::status status) {
+    BeastResponse response;
+    response.result(status);
+    DoReject(std::move(response));
+  }
+
+  /// Sends @p response without reading the request body, and closes.
+  void DoReject(BeastResponse response) {
+    record_.reset();
+    body_reservation_ = {};
+    stream_.expires_never();
+    if (!pipeline_.empty()) {
+      // Send the rejection after any pipelined responses.
+      auto slot = std::make_shared<PipelinedResponse>();
+      slot->response = std::move(response);
+      slot->ready = true;
+      pipeline_.push_back(std::move(slot));
+      reading_ = false;
+      return OnPipelinedResponse();
+    }
+    response_ = std::move(response);
+    writing_ = true;
+    DoWrite(/*keep_alive=*/false);
+  }
+
+  void DoWrite(bool keep_alive) {
+    SetState(SessionState::kWriting);
+    if (timed()) write_start_ = RequestTiming::Clock::now();
+    FinalizeResponse(response_, keep_alive);
+    // Pipelined sessions take the record from the response slot.
+    if (!pipelining_) write_record_ = std::move(record_);
+    if (write_record_) {
+      write_record_->status = response_.result_int();
+      write_record_->response_size = response_.body().size();
+    }
+    ExpiresAfter(options_.write_timeout);
+#if FUNCTIONS_FRAMEWORK_CPP_HAVE_SENDFILE
+    if (response_.body().file() != nullptr) return DoWriteFileHeader();
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_SENDFILE
+    be::http::async_write(
+        stream_, response_,
+        [self = shared_from_this()](be::error_code ec, std::size_t) {
+          self->OnWrite(ec);
+        });
+  }
+
+#if FUNCTIONS_FRAMEWORK_CPP_HAVE_SENDFILE
+  /// Sends the header, the file segment is sent directly by the kernel.
+  void DoWriteFileHeader() {
+    file_serializer_.emplace(response_);
+    be::http::async_write_header(
+        stream_, *file_serializer_,
+        [self = shared_from_this()](be::error_code ec, std::size_t) {
+          self->file_serializer_.reset();
+          if (ec) return self->OnWrite(ec);
+          auto const& segment = *self->response_.body().file();
+          self->file_offset_ = segment.offset;
+          self->file_remaining_ = segment.size;
+          self->DoSendFile();
+        });
+  }
+
+  void DoSendFile() {
+    auto& socket = stream_.socket();
+    be::error_code ec;
+    socket.non_blocking(true, ec);
+    if (ec) return OnWrite(ec);
+    // Send one chunk at a time, so other sessions in the same thread can make
+    // progress.
+    auto constexpr kMaxChunk = std::uint64_t{1024 * 1024};
+    while (file_remaining_ != 0) {
+      auto offset = static_cast<off_t>(file_offset_);
+      auto const n = ::sendfile(socket.native_handle(),
+                                response_.body().file()->file->native_handle(),
+                                &offset, std::min(file_remaining_, kMaxChunk));
+      if (n > 0) {
+        file_offset_ += n;
+        file_remaining_ -= n;
+        if (file_remaining_ == 0) break;
+        return asio::post(executor_,
+                          [self = shared_from_this()] { self->DoSendFile(); });
+      }
+      if (n < 0 && errno == EINTR) continue;
+      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return DoWaitWritable();
+      }
+      // A zero byte result means the file was truncated after it was opened.
+      return OnWrite(n == 0 ? be::http::error::short_read
+                            : be::error_code(errno, be::system_category()));
+    }
+    stream_.expires_never();
+    OnWrite({});
+  }
+
+  void DoWaitWritable() {
+    // The stream timeout does not cover this operation, use a separate timer
+    // that closes the socket.
+    if (options_.write_timeout != std::chrono::seconds(0)) {
+      file_timer_.expires_after(options_.write_timeout);
+      file_timer_.async_wait([self = shared_from_this()](be::error_code ec) {
+        if (ec) return;
+        be::error_code ignored;
+        self->stream_.socket().close(ignored);
+      });
+    }
+    stream_.socket().async_wait(asio::socket_base::wait_write,
+                                [self = shared_from_this()](be::error_code ec) {
+                                  self->file_timer_.cancel();
+                                  if (ec) return self->OnWrite(ec);
+                                  self->DoSendFile();
+                                });
+  }
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_SENDFILE
 
-  auto cleanup = [](std::vector<std::future<void>> sessions, auto wait) {
-    std::vector<std::future<void>> running;
-    for (auto& s : sessions) {
-      if (s.wait_for(wait) == std::future_status::timeout) {
-        running.push_back(std::move(s));
-        continue;
+  void OnWrite(be::error_code ec) {
+    if (ec) return ReportError(ec, "write");
+    OnResponseSent();
+    writing_ = false;
+    if (!response_.keep_alive()) {
+      pipeline_.clear();
+      return DoClose();
+    }
+    if (pipelining_) return OnPipelinedResponse();
+    DoRead();
+  }
+
+  /// Records the write phase, and reports the request if it was slow.
+  void OnResponseSent() {
+    if (!timed()) return;
+    auto const now = RequestTiming::Clock::now();
+    auto const record = std::move(write_record_);
+    if (!record) {
+      // Rejected requests and static routes only record the write time.
+      if (handlers_.metrics) {
+        handlers_.metrics->RecordPhase(RequestPhase::kWrite,
+                                       now - write_start_);
       }
-      s.get();
+      return;
+    }
+    RecordPhase(*record, RequestPhase::kWrite, now - write_start_);
+    if (handlers_.slow_requests) handlers_.slow_requests->Record(*record, now);
+    if (handlers_.flight_recorder) {
+      handlers_.flight_recorder->Complete(*record, now);
+    }
+  }
+
+  void RecordPhase(RequestRecord& record, RequestPhase phase,
+                   RequestTiming::Clock::duration d) {
+    record.timing.Add(phase, d);
+    if (handlers_.metrics) handlers_.metrics->RecordPhase(phase, d);
+  }
+
+  /// Reports the session state to `/debug/server`, from any thread.
+  void SetState(SessionState state) {
+    if (status_) status_->set_state(state, SessionStatus::Clock::now());
+  }
+
+  /// If `true`, the session times each request.
+  [[nodiscard]] bool timed() const {
+    return handlers_.metrics != nullptr || handlers_.slow_requests != nullptr ||
+           handlers_.flight_recorder != nullptr;
+  }
+
+  void DoClose() {
+    if (!pipeline_.empty()) {
+      // Send the responses for any pipelined requests before closing.
+      close_after_pipeline_ = true;
+      reading_ = false;
+      return OnPipelinedResponse();
     }
-    return running;
+    closed_ = true;
+    be::error_code ec;
+    stream_.socket().shutdown(asio::socket_base::shutdown_send, ec);
+  }
+
+  static auto constexpr kCrLf = std::string_view{"\r\n"};
+  static auto constexpr kLastChunk = std::string_view{"0\r\n\r\n"};
+  static auto constexpr kContinue =
+      std::string_view{"HTTP/1.1 100 Continue\r\n\r\n"};
+
+  be::basic_stream<stream_protocol> stream_;
+  // A copy of the stream executor, safe to use from any thread.
+  be::basic_stream<stream_protocol>::executor_type executor_;
+  // Keys the rate limits of requests without a client header.
+  std::string const peer_address_ = PeerAddress(stream_.socket());
+  be::flat_buffer buffer_;
+  // All the session operations, including the handler, run in the session's
+  // strand, an unsynchronized pool is safe.
+  bool pipelining_;
+  // The requests moved out of the session share the ownership of the pool.
+  std::shared_ptr<std::pmr::memory_resource> fields_pool_;
+  std::optional<RequestParser> parser_;
+  /// If `true`, the request in `parser_` was filled by `FastParseRequest()`.
+  bool fast_parsed_ = false;
+  std::optional<StreamingParser> streaming_parser_;
+  /// The memory reserved for the body of the current buffered request.
+  BodyReservation body_reservation_;
+  BeastResponse response_;
+  using StreamResponse = be::http::response<be::http::empty_body>;
+  std::optional<StreamResponse> stream_response_;
+  std::optional<be::http::response_serializer<be::http::empty_body>>
+      stream_serializer_;
+  std::string chunk_header_;
+  // The heartbeats of a writer handler, sent while it does not write.
+  asio::steady_timer heartbeat_timer_{executor_};
+  std::chrono::milliseconds heartbeat_interval_{0};
+  std::string heartbeat_;
+  bool stream_writing_ = false;
+  bool heartbeat_writing_ = false;
+  // A write waiting for the heartbeat in progress.
+  std::function<void()> pending_write_;
+#if FUNCTIONS_FRAMEWORK_CPP_HAVE_SENDFILE
+  std::optional<be::http::response_serializer<ResponseBody>> file_serializer_;
+  asio::steady_timer file_timer_{executor_};
+  std::uint64_t file_offset_ = 0;
+  std::uint64_t file_remaining_ = 0;
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_SENDFILE
+  bool stream_chunked_ = false;
+  bool stream_keep_alive_ = false;
+  // The request being read, or running in non-pipelined sessions, and the
+  // request whose response is being sent. Only created if `timed()`.
+  std::shared_ptr<RequestRecord> record_;
+  std::shared_ptr<RequestRecord> write_record_;
+  RequestTiming::Clock::time_point write_start_;
+  // The cancellation state of the running request, not in pipelined sessions.
+  std::shared_ptr<CancellationState> cancellation_;
+  std::uint64_t requests_ = 0;
+  // The connection limits, with jitter.
+  std::uint64_t max_requests_ = 0;
+  std::optional<std::chrono::steady_clock::time_point> retire_at_;
+  ServerOptions const& options_;
+  SessionHandlers const& handlers_;
+  std::atomic<bool> const& draining_;
+  std::function<void()> on_close_;
+  // Only created with `--debug-server`.
+  std::shared_ptr<SessionStatus> status_;
+  bool idle_ = false;
+  struct PipelinedResponse {
+    BeastResponse response;
+    std::shared_ptr<RequestRecord> record;
+    /// Released once the response is sent.
+    BodyReservation body;
+    bool keep_alive = false;
+    bool ready = false;
   };
+  std::deque<std::shared_ptr<PipelinedResponse>> pipeline_;
+  bool reading_ = false;
+  bool writing_ = false;
+  bool close_after_pipeline_ = false;
+  bool closed_ = false;
+#ifdef FUNCTIONS_FRAMEWORK_CPP_HAVE_HTTP2
+  bool first_read_ = true;
+  std::weak_ptr<Http2Session> http2_;
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_HTTP2
+  std::weak_ptr<WebSocketSession> websocket_;
+};
+
+/**
+ * Accepts incoming connections and starts a session for each one.
+ *
+ * The listener counts the active sessions, and applies the configured overload
+ * policy once the count reaches `max_sessions`. With the `queue` policy it
+ * stops accepting connections until a session completes, with the `reject`
+ * policy it accepts the connection, rejects the request, and closes the
+ * connection.
+ *
+ * The listener calls `Drain()` once @p shutdown returns `true`. The check runs
+ * after each connection is accepted. @p on_drained runs once the listener is
+ * draining and all its sessions are closed.
+ *
+ * All the listener member functions run in the strand associated with the
+ * acceptor.
+ */
+class Listener : public std::enable_shared_from_this<Listener> {
+ public:
+  Listener(asio::io_context& ioc, StreamAcceptor acceptor,
+           ServerOptions const& options, SessionHandlers const& handlers,
+           std::function<bool()> const& shutdown,
+           std::atomic<bool> const& draining, std::function<void()> on_drained)
+      : ioc_(ioc),
+        acceptor_(std::move(acceptor)),
+        tcp_(IsTcp(acceptor_.local_endpoint().protocol())),
+        options_(options),
+        handlers_(handlers),
+        overload_handlers_{MakeOverloadHandler(options.retry_after),
+                           {},
+                           {},
+                           {},
+                           {},
+                           nullptr,
+                           nullptr,
+                           nullptr},
+        shutdown_(shutdown),
+        draining_(draining),
+        on_drained_(std::move(on_drained)) {}
+
+  void Start() {
+    asio::dispatch(acceptor_.get_executor(), [self = shared_from_this()] {
+      if (self->shutdown_()) return self->DoDrain();
+      self->DoAccept();
+    });
+  }
+
+  /// Stops accepting connections and closes any idle sessions.
+  void Drain() {
+    asio::dispatch(acceptor_.get_executor(),
+                   [self = shared_from_this()] { self->DoDrain(); });
+  }
+
+  /// Closes all the sessions, even if they have requests in progress.
+  void Abort() {
+    asio::dispatch(acceptor_.get_executor(), [self = shared_from_this()] {
+      for (auto& kv : self->sessions_) {
+        if (auto s = kv.second.lock()) s->Abort();
+      }
+    });
+  }
+
+ private:
+  [[nodiscard]] bool AtCapacity() const {
+    return options_.max_sessions != 0 &&
+           sessions_.size() >= options_.max_sessions;
+  }
+
+  void DoDrain() {
+    if (stopped_) return;
+    stopped_ = true;
+    be::error_code ec;
+    acceptor_.close(ec);
+    for (auto& kv : sessions_) {
+      if (auto s = kv.second.lock()) s->Drain();
+    }
+    if (sessions_.empty()) on_drained_();
+  }
+
+  void DoAccept() {
+    if (AtCapacity() && !options_.reject_on_overload) {
+      // Stop accepting connections, `OnSessionClosed()` resumes the loop.
+      paused_ = true;
+      paused_since_ = AdmissionController::Clock::now();
+      if (handlers_.server_state) handlers_.server_state->AcceptPaused();
+      return;
+    }
+    // Each connection gets its own strand, so the session handlers do not need
+    // any additional synchronization.
+    acceptor_.async_accept(
+        asio::make_strand(ioc_),
+        [self = shared_from_this()](be::error_code ec,
+                                    stream_protocol::socket socket) {
+          self->OnAccept(ec, std::move(socket));
+        });
+  }
+
+  void OnAccept(be::error_code ec, stream_protocol::socket socket) {
+    if (ec == asio::error::operation_aborted) return;
+    // The connection may complete just as the listener stops, close it.
+    if (stopped_) return;
+    if (!ec && tcp_) ConfigureConnection(socket, options_);
+    if (ec) {
+      ReportError(ec, "accept");
+    } else if (AtCapacity()) {
+      // Rejected sessions are short-lived, and are not counted.
+      std::make_shared<HttpSession>(std::move(socket), options_,
+                                    overload_handlers_, draining_,
+                                    std::function<void()>{})
+          ->Start();
+    } else {
+      auto const id = next_session_id_++;
+      auto on_close = [self = shared_from_this(), id] {
+        asio::post(self->acceptor_.get_executor(),
+                   [self, id] { self->OnSessionClosed(id); });
+      };
+      auto session = std::make_shared<HttpSession>(
+          std::move(socket), options_, handlers_, draining_,
+          std::move(on_close));
+      sessions_.emplace(id, session);
+      if (handlers_.metrics) handlers_.metrics->SessionOpened();
+      session->Start();
+    }
+    if (shutdown_()) return DoDrain();
+    DoAccept();
+  }
+
+  void OnSessionClosed(std::uint64_t id) {
+    sessions_.erase(id);
+    if (handlers_.metrics) handlers_.metrics->SessionClosed();
+    if (stopped_) {
+      if (sessions_.empty()) on_drained_();
+      return;
+    }
+    if (!paused_) return;
+    paused_ = false;
+    if (handlers_.server_state) handlers_.server_state->AcceptResumed();
+    // The connections in the listen queue waited, at most, this long.
+    if (handlers_.admission) {
+      handlers_.admission->RecordDelay(AdmissionController::Clock::now() -
+                                       paused_since_);
+    }
+    DoAccept();
+  }
+
+  asio::io_context& ioc_;
+  StreamAcceptor acceptor_;
+  bool tcp_;
+  ServerOptions const& options_;
+  SessionHandlers const& handlers_;
+  SessionHandlers overload_handlers_;
+  std::function<bool()> const& shutdown_;
+  std::atomic<bool> const& draining_;
+  std::function<void()> on_drained_;
+  std::map<std::uint64_t, std::weak_ptr<HttpSession>> sessions_;
+  std::uint64_t next_session_id_ = 0;
+  bool paused_ = false;
+  AdmissionController::Clock::time_point paused_since_;
+  bool stopped_ = false;
+};
+
+/**
+ * Coordinates the graceful shutdown of all the listeners.
+ *
+ * The shutdown starts when `Shutdown()` is called, or when the process receives
+ * `SIGTERM`. The listeners stop accepting connections, idle sessions are
+ * closed, and the requests already in progress complete, with a
+ * `Connection: close` header in their responses. Any sessions still open after
+ * the grace period are closed.
+ *
+ * All the private member functions run in the strand associated with the
+ * signal set and the timer.
+ */
+class ShutdownCoordinator {
+ public:
+  ShutdownCoordinator(asio::io_context& ioc, std::chrono::seconds grace_period,
+                      std::function<void()> on_shutdown = {})
+      : strand_(asio::make_strand(ioc)),
+        signals_(strand_, SIGTERM),
+        timer_(strand_),
+        grace_period_(grace_period),
+        on_shutdown_(std::move(on_shutdown)) {}
+
+  void Start(std::vector<std::shared_ptr<Listener>> listeners) {
+    asio::dispatch(strand_, [this, l = std::move(listeners)]() mutable {
+      listeners_ = std::move(l);
+      signals_.async_wait([this](be::error_code ec, int /*signal*/) {
+        if (!ec) Shutdown();
+      });
+    });
+  }
+
+  /// Starts the shutdown, this function is thread-safe and idempotent.
+  void Shutdown() {
+    if (draining_.exchange(true)) return;
+    asio::dispatch(strand_, [this] { DoShutdown(); });
+  }
+
+  /// Called by each listener once it has stopped and all its sessions closed.
+  void OnDrained() {
+    asio::dispatch(strand_, [this] {
+      if (++drained_ == listeners_.size()) timer_.cancel();
+    });
+  }
+
+  [[nodiscard]] std::atomic<bool> const& draining() const { return draining_; }
+
+ private:
+  void DoShutdown() {
+    // Restore the default signal handling, if the process receives `SIGTERM`
+    // again it terminates immediately.
+    be::error_code ec;
+    signals_.clear(ec);
+    signals_.cancel(ec);
+    if (on_shutdown_) on_shutdown_();
+    for (auto& l : listeners_) l->Drain();
+    if (grace_period_ == std::chrono::seconds(0)) {
+      for (auto& l : listeners_) l->Abort();
+      return;
+    }
+    timer_.expires_after(grace_period_);
+    timer_.async_wait([this](be::error_code ec) {
+      if (ec) return;
+      for (auto& l : listeners_) l->Abort();
+    });
+  }
 
-  // Reaching this number of sessions triggers a cleanup of any sessions that
-  // may have finished already. We allow up to 80 sessions to start without
-  // blocking, this should be enough for Cloud Run and Cloud Functions:
-  //     https://cloud.google.com/run/docs/about-concurrency#concurrency_values
-  auto constexpr kSessionCleanupThreshold = 80;
+  asio::strand<asio::io_context::executor_type> strand_;
+  asio::signal_set signals_;
+  asio::steady_timer timer_;
+  std::chrono::seconds grace_period_;
+  std::function<void()> on_shutdown_;
+  std::vector<std::shared_ptr<Listener>> listeners_;
+  std::atomic<bool> draining_{false};
+  std::size_t drained_ = 0;
+};
 
-  // If we reach this number of sessions we block until we are below the cleanup
-  // threshold.
-  auto constexpr kMaximumSessions = 160;
+/// Opens and binds a TCP socket, without listening on it.
+tcp::acceptor BindAcceptor(asio::io_context& ioc, tcp::endpoint const& endpoint,
+                           bool reuse_port) {
+  // All the operations on the acceptor run in this strand.
+  tcp::acceptor acceptor{asio::make_strand(ioc)};
+  acceptor.open(endpoint.protocol());
+  acceptor.set_option(asio::socket_base::reuse_address(true));
+  if (reuse_port) {
+#if defined(SO_REUSEPORT)
+    acceptor.set_option(ReusePortOption(true));
+#else
+    throw std::invalid_argument(
+        "--reuse-port is not supported on this platform");
+#endif  // SO_REUSEPORT
+  }
+  acceptor.bind(endpoint);
+  return acceptor;
+}
 
-  std::vector<std::future<void>> sessions;
-  while (!shutdown()) {
-    if (sessions.size() >= kSessionCleanupThreshold) {
-      sessions = cleanup(std::move(sessions), std::chrono::milliseconds(0));
+/// Opens and binds a Unix domain socket, without listening on it.
+StreamAcceptor BindUnixAcceptor(asio::io_context& ioc,
+                                std::string const& path) {
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+  using local = asio::local::stream_protocol;
+  // A previous run may have left the socket behind, `bind()` fails if the
+  // path exists.
+  std::error_code ec;
+  if (std::filesystem::is_socket(path, ec)) std::filesystem::remove(path, ec);
+  local::acceptor acceptor{asio::make_strand(ioc)};
+  local::endpoint const endpoint{path};
+  acceptor.open(endpoint.protocol());
+  acceptor.bind(endpoint);
+  return StreamAcceptor(std::move(acceptor));
+#else
+  (void)ioc;
+  (void)path;
+  throw std::invalid_argument(
+      "--unix-socket is not supported on this platform");
+#endif  // BOOST_ASIO_HAS_LOCAL_SOCKETS
+}
+
+/// A listening socket bound by the parent of the worker processes.
+struct InheritedSocket {
+  stream_protocol protocol;
+  StreamAcceptor::native_handle_type handle;
+};
+
+/// Runs the shutdown handlers in reverse order, logging any exceptions.
+void RunShutdown(std::vector<ShutdownHandler> const& handlers) {
+  for (auto h = handlers.rbegin(); h != handlers.rend(); ++h) {
+    try {
+      (*h)();
+    } catch (std::exception const& ex) {
+      WriteLog(functions::LogSeverity::kError,
+               std::string("Shutdown function failed: ") + ex.what());
+    } catch (...) {
+      WriteLog(functions::LogSeverity::kError,
+               "Shutdown function failed with an unknown exception");
     }
-    while (sessions.size() >= kMaximumSessions) {
-      sessions = cleanup(std::move(sessions), std::chrono::seconds(1));
+  }
+}
+
+/**
+ * The request pipeline of a server, shared by all its sessions.
+ *
+ * The handlers refer to the other members, the pipeline cannot be moved.
+ */
+struct ServerPipeline {
+  SessionHandlers handlers;
+  std::shared_ptr<StaticRoutes> static_routes;
+  std::shared_ptr<ServerMetrics> metrics;
+  std::optional<SlowRequestLog> slow_requests;
+  std::optional<FlightRecorder> flight_recorder;
+  std::optional<ScopedFlightRecorderSignals> flight_recorder_signals;
+  std::shared_ptr<AdmissionController> admission;
+  std::shared_ptr<MemoryPressureMonitor> memory_pressure;
+  std::optional<BodyMemoryBudget> body_budget;
+  std::optional<ServerState> server_state;
+  std::shared_ptr<Profiler> profiler;
+  std::shared_ptr<TrafficCapture> capture;
+};
+
+/**
+ * Wraps the handlers of @p impl with the middleware enabled in @p options.
+ *
+ * The server, and `InProcessInvoker`, run the requests through this pipeline.
+ */
+std::unique_ptr<ServerPipeline> MakeServerPipeline(ServerOptions const& options,
+                                                   FunctionImpl const& impl,
+                                                   std::string const& target) {
+  auto pipeline = std::make_unique<ServerPipeline>();
+  auto& handlers = pipeline->handlers;
+  handlers = SessionHandlers{impl.GetHandler(target),
+                             impl.GetStreamingHandler(target),
+                             impl.GetWriterHandler(target),
+                             impl.GetAsyncHandler(target),
+                             impl.GetWebSocketHandler(target),
+                             impl.GetPrecheckHandler(target),
+                             nullptr,
+                             nullptr,
+                             nullptr,
+                             nullptr,
+                             nullptr};
+  // The events queued by the function are delivered before its response.
+  handlers.handler = MakeEventSinkHandler(std::move(handlers.handler));
+  if (handlers.streaming_handler) {
+    handlers.streaming_handler =
+        MakeEventSinkStreamingHandler(std::move(handlers.streaming_handler));
+  }
+  if (handlers.writer_handler) {
+    handlers.writer_handler =
+        MakeEventSinkWriterHandler(std::move(handlers.writer_handler));
+  }
+  if (handlers.async_handler) {
+    handlers.async_handler =
+        MakeEventSinkAsyncHandler(std::move(handlers.async_handler));
+  }
+  // Stale events are dropped while parsing, before the function runs.
+  if (options.max_event_age != std::chrono::seconds(0)) {
+    auto const max_age = options.max_event_age;
+    handlers.handler =
+        MakeEventAgeHandler(std::move(handlers.handler), max_age);
+    if (handlers.async_handler) {
+      handlers.async_handler =
+          MakeEventAgeAsyncHandler(std::move(handlers.async_handler), max_age);
     }
-    auto socket = acceptor.accept(ioc);
-    if (!socket.is_open()) break;
-    // Run a thread per-session, transferring ownership of the socket
-    sessions.push_back(
-        std::async(std::launch::async, handle_session, std::move(socket)));
+  }
+  // The log entries written while the function runs refer to its request.
+  handlers.handler = MakeLogContextHandler(std::move(handlers.handler));
+  if (handlers.streaming_handler) {
+    handlers.streaming_handler =
+        MakeLogContextStreamingHandler(std::move(handlers.streaming_handler));
+  }
+  if (handlers.writer_handler) {
+    handlers.writer_handler =
+        MakeLogContextWriterHandler(std::move(handlers.writer_handler));
+  }
+  if (handlers.async_handler) {
+    handlers.async_handler =
+        MakeLogContextAsyncHandler(std::move(handlers.async_handler));
+  }
+  // The handlers run with the deadline of their request, and the sessions
+  // cancel the requests whose client disconnects.
+  auto const deadline =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          options.request_deadline);
+  handlers.handler =
+      MakeCancellationHandler(std::move(handlers.handler), deadline);
+  if (handlers.streaming_handler) {
+    handlers.streaming_handler = MakeCancellationStreamingHandler(
+        std::move(handlers.streaming_handler), deadline);
+  }
+  if (handlers.writer_handler) {
+    handlers.writer_handler = MakeCancellationWriterHandler(
+        std::move(handlers.writer_handler), deadline);
+  }
+  if (handlers.async_handler) {
+    handlers.async_handler = MakeCancellationAsyncHandler(
+        std::move(handlers.async_handler), deadline);
+  }
+  // The checksums describe the body as the function receives it, after any
+  // decompression.
+  if (options.body_checksums.crc32c || options.body_checksums.md5) {
+    auto const checksums = options.body_checksums;
+    handlers.handler =
+        MakeBodyChecksumHandler(std::move(handlers.handler), checksums);
+    if (handlers.streaming_handler) {
+      handlers.streaming_handler = MakeBodyChecksumStreamingHandler(
+          std::move(handlers.streaming_handler), checksums);
+    }
+    if (handlers.writer_handler) {
+      handlers.writer_handler = MakeBodyChecksumWriterHandler(
+          std::move(handlers.writer_handler), checksums);
+    }
+    if (handlers.async_handler) {
+      handlers.async_handler = MakeBodyChecksumAsyncHandler(
+          std::move(handlers.async_handler), checksums);
+    }
+  }
+  if (options.request_decompression) {
+    auto const decompression =
+        DecompressionOptions{options.max_decompressed_size};
+    handlers.handler =
+        MakeDecompressionHandler(std::move(handlers.handler), decompression);
+    if (handlers.streaming_handler) {
+      handlers.streaming_handler = MakeDecompressionStreamingHandler(
+          std::move(handlers.streaming_handler), decompression);
+    }
+    if (handlers.writer_handler) {
+      handlers.writer_handler = MakeDecompressionWriterHandler(
+          std::move(handlers.writer_handler), decompression);
+    }
+    if (handlers.async_handler) {
+      handlers.async_handler = MakeDecompressionAsyncHandler(
+          std::move(handlers.async_handler), decompression);
+    }
+  }
+  // The preconditions apply to the uncompressed responses, compression weakens
+  // any entity tag.
+  if (options.conditional_requests) {
+    handlers.handler = MakeConditionalHandler(std::move(handlers.handler));
+    if (handlers.streaming_handler) {
+      handlers.streaming_handler = MakeConditionalStreamingHandler(
+          std::move(handlers.streaming_handler));
+    }
+    if (handlers.writer_handler) {
+      handlers.writer_handler =
+          MakeConditionalWriterHandler(std::move(handlers.writer_handler));
+    }
+    if (handlers.async_handler) {
+      handlers.async_handler =
+          MakeConditionalAsyncHandler(std::move(handlers.async_handler));
+    }
+  }
+  // The ranges refer to the uncompressed responses, and `If-Range` to their
+  // strong entity tags.
+  if (options.range_requests) {
+    handlers.handler = MakeByteRangeHandler(std::move(handlers.handler));
+    if (handlers.streaming_handler) {
+      handlers.streaming_handler = MakeByteRangeStreamingHandler(
+          std::move(handlers.streaming_handler));
+    }
+    if (handlers.async_handler) {
+      handlers.async_handler =
+          MakeByteRangeAsyncHandler(std::move(handlers.async_handler));
+    }
+  }
+  if (options.compression) {
+    auto const compression = CompressionOptions{options.compression_min_size};
+    handlers.handler =
+        MakeCompressionHandler(std::move(handlers.handler), compression);
+    if (handlers.streaming_handler) {
+      handlers.streaming_handler = MakeCompressionStreamingHandler(
+          std::move(handlers.streaming_handler), compression);
+    }
+    if (handlers.writer_handler) {
+      handlers.writer_handler =
+          MakeCompressionWriterHandler(std::move(handlers.writer_handler));
+    }
+    if (handlers.async_handler) {
+      handlers.async_handler = MakeCompressionAsyncHandler(
+          std::move(handlers.async_handler), compression);
+    }
+  }
+  // The metrics include the time spent compressing the responses, but not the
+  // static routes.
+  auto& metrics = pipeline->metrics;
+  if (options.metrics) {
+    metrics = std::make_shared<ServerMetrics>();
+    handlers.handler = MakeMetricsHandler(std::move(handlers.handler), metrics);
+    if (handlers.streaming_handler) {
+      handlers.streaming_handler = MakeMetricsStreamingHandler(
+          std::move(handlers.streaming_handler), metrics);
+    }
+    if (handlers.writer_handler) {
+      handlers.writer_handler =
+          MakeMetricsWriterHandler(std::move(handlers.writer_handler), metrics);
+    }
+    if (handlers.async_handler) {
+      handlers.async_handler =
+          MakeMetricsAsyncHandler(std::move(handlers.async_handler), metrics);
+    }
+    handlers.metrics = metrics.get();
+  }
+  auto& slow_requests = pipeline->slow_requests;
+  if (options.slow_request_threshold != std::chrono::milliseconds(0)) {
+    slow_requests.emplace(options.slow_request_threshold,
+                          options.slow_request_log_rate);
+    handlers.slow_requests = &*slow_requests;
+  }
+  auto& flight_recorder = pipeline->flight_recorder;
+  if (options.flight_recorder != 0) {
+    flight_recorder.emplace(
+        static_cast<std::size_t>(options.flight_recorder));
+    handlers.flight_recorder = &*flight_recorder;
+    pipeline->flight_recorder_signals.emplace(*flight_recorder);
+  }
+  // `CallUserFunction()` times the decode, function, and encode phases, the
+  // sessions time the read, queue, and write phases.
+  if (metrics || options.server_timing || slow_requests || flight_recorder) {
+    auto const timing = RequestTimingOptions{metrics, options.server_timing};
+    handlers.handler = MakeTimingHandler(std::move(handlers.handler), timing);
+    if (handlers.streaming_handler) {
+      handlers.streaming_handler = MakeTimingStreamingHandler(
+          std::move(handlers.streaming_handler), timing);
+    }
+    if (handlers.writer_handler) {
+      handlers.writer_handler =
+          MakeTimingWriterHandler(std::move(handlers.writer_handler), timing);
+    }
+    if (handlers.async_handler) {
+      handlers.async_handler =
+          MakeTimingAsyncHandler(std::move(handlers.async_handler), timing);
+    }
+  }
+  if (options.release_memory_after_idle != std::chrono::seconds(0)) {
+    auto release =
+        std::make_shared<IdleMemoryRelease>(options.release_memory_after_idle);
+    handlers.handler =
+        MakeIdleReleaseHandler(std::move(handlers.handler), release);
+    if (handlers.streaming_handler) {
+      handlers.streaming_handler = MakeIdleReleaseStreamingHandler(
+          std::move(handlers.streaming_handler), release);
+    }
+    if (handlers.writer_handler) {
+      handlers.writer_handler = MakeIdleReleaseWriterHandler(
+          std::move(handlers.writer_handler), release);
+    }
+    if (handlers.async_handler) {
+      handlers.async_handler = MakeIdleReleaseAsyncHandler(
+          std::move(handlers.async_handler), release);
+    }
+  }
+  // Deferred background tasks run while the requests hold the CPU.
+  auto& background = functions::BackgroundExecutor::Default();
+  handlers.handler =
+      MakeBackgroundActivityHandler(std::move(handlers.handler), background);
+  if (handlers.streaming_handler) {
+    handlers.streaming_handler = MakeBackgroundActivityStreamingHandler(
+        std::move(handlers.streaming_handler), background);
+  }
+  if (handlers.writer_handler) {
+    handlers.writer_handler = MakeBackgroundActivityWriterHandler(
+        std::move(handlers.writer_handler), background);
+  }
+  if (handlers.async_handler) {
+    handlers.async_handler = MakeBackgroundActivityAsyncHandler(
+        std::move(handlers.async_handler), background);
+  }
+  // The requests are captured as received, the replays go through the same
+  // middleware.
+  auto& capture = pipeline->capture;
+  if (!options.capture_file.empty()) {
+    capture = std::make_shared<TrafficCapture>(
+        options.capture_file, options.capture_sample_rate,
+        options.capture_max_bytes, CurrentTrafficCaptureRedactor());
+    handlers.handler =
+        MakeTrafficCaptureHandler(std::move(handlers.handler), capture);
+    if (handlers.async_handler) {
+      handlers.async_handler = MakeTrafficCaptureAsyncHandler(
+          std::move(handlers.async_handler), capture);
+    }
+  }
+  // The static routes bypass all other handlers. HTTP/1.1 sessions answer them
+  // directly, HTTP/2 sessions only use the handler.
+  auto& static_routes = pipeline->static_routes;
+  static_routes =
+      std::make_shared<StaticRoutes>(MakeStaticRoutes(options.static_routes));
+  if (metrics && options.metrics_port == 0) {
+    static_routes->AddGenerated("/metrics",
+                                [m = metrics] { return m->MakeResponse(); });
+  }
+  // Push subscriptions back off when their CloudEvents are rejected, before
+  // the queues grow enough to time out the requests.
+  auto& admission = pipeline->admission;
+  if (options.queue_delay_target != std::chrono::milliseconds(0)) {
+    admission = std::make_shared<AdmissionController>(
+        options.queue_delay_target, options.queue_delay_interval);
+    handlers.precheck = MakeAdmissionPrecheckHandler(
+        std::move(handlers.precheck), admission, options.retry_after);
+    handlers.admission = admission.get();
+  }
+  // Shedding a few requests is cheaper than running out of memory, which
+  // terminates all the requests in progress.
+  auto& memory_pressure = pipeline->memory_pressure;
+  memory_pressure = MakeMemoryPressureMonitor(options.memory_watermark);
+  if (memory_pressure) {
+    handlers.precheck = MakeMemoryPressurePrecheckHandler(
+        std::move(handlers.precheck), memory_pressure, options.retry_after);
+  }
+  auto& body_budget = pipeline->body_budget;
+  if (options.max_buffered_body_memory != 0) {
+    body_budget.emplace(options.max_buffered_body_memory);
+    handlers.body_budget = &*body_budget;
+  }
+  auto& server_state = pipeline->server_state;
+  if (options.debug_server) {
+    auto const pool_threads =
+        handlers.streaming_handler || handlers.writer_handler
+            ? options.streaming_threads
+            : 0;
+    server_state.emplace(options.threads, pool_threads, options.max_sessions);
+    handlers.server_state = &*server_state;
+    static_routes->AddGenerated(
+        "/debug/server",
+        [&server_state] {
+          BeastResponse response;
+          response.set(be::http::field::content_type, "application/json");
+          response.set(be::http::field::cache_control, "no-store");
+          response.body() = server_state->ToJson();
+          return response;
+        },
+        options.debug_server_token);
+  }
+  auto& profiler = pipeline->profiler;
+  if (options.debug_pprof) {
+    profiler = std::make_shared<Profiler>();
+    static_routes->AddAsync(
+        "/debug/pprof/profile",
+        [p = profiler](std::string_view target, AsyncResponseCallback done) {
+          p->CpuProfile(target, std::move(done));
+        },
+        options.debug_server_token);
+    static_routes->AddAsync(
+        "/debug/pprof/heap",
+        [p = profiler](std::string_view target, AsyncResponseCallback done) {
+          p->HeapProfile(target, std::move(done));
+        },
+        options.debug_server_token);
+  }
+  if (options.debug_startup) {
+    // Replaced by the report once the startup completes.
+    BeastResponse pending;
+    pending.result(be::http::status::service_unavailable);
+    static_routes->Add("/debug/startup", std::move(pending));
+  }
+  if (!static_routes->empty()) {
+    handlers.handler =
+        MakeStaticRoutesHandler(std::move(handlers.handler), static_routes);
+    handlers.static_routes = static_routes;
+  }
+  return pipeline;
+}
+
+/**
+ * Runs the server until it shuts down.
+ *
+ * If @p inherited is not null the server runs in a worker process, and
+ * accepts connections on that socket instead of creating its own.
+ */
+int RunServer(StartupTimer& startup, ServerOptions const& options,
+              tcp::endpoint endpoint, std::string const& target,
+              functions::Function const& function,
+              std::function<bool()> const& shutdown,
+              std::function<void(int)> const& actual_port,
+              InheritedSocket const* inherited) {
+  std::optional<ScopedLogSink> log_sink;
+  if (options.async_logging) log_sink.emplace();
+
+  // By default all the threads share a single event loop and listening socket.
+  // With `--reuse-port` each thread gets its own event loop and listening
+  // socket (a "shard"), the kernel distributes the incoming connections across
+  // the sockets, and each connection is served by a single thread.
+  auto const shards = options.reuse_port ? options.threads : 1;
+  auto shard_options = options;
+  if (shard_options.max_sessions != 0) {
+    shard_options.max_sessions =
+        (options.max_sessions + shards - 1) / static_cast<std::size_t>(shards);
+  }
+
+  startup.Mark("parse_options");
+  // The globals initialize while the server resolves the function, warms up,
+  // and starts listening.
+  PrefetchLazyGlobals();
+
+  auto const impl = FunctionImpl::GetImpl(function);
+  auto const pipeline = MakeServerPipeline(options, *impl, target);
+  auto& handlers = pipeline->handlers;
+  auto& static_routes = pipeline->static_routes;
+  auto metrics_route = [metrics = pipeline->metrics] {
+    return metrics->MakeResponse();
+  };
+
+  // Nothing listens on the port until the function is ready, so startup
+  // probes, and then traffic, do not reach a function still warming up.
+  startup.Mark("get_handler");
+  RunWarmup(impl->GetWarmupHandlers(target));
+  startup.Mark("warmup");
+  if (!options.checkpoint_ready_file.empty()) {
+    // Nothing listens yet, and the event loops do not exist, the checkpoint
+    // only captures the function state.
+    if (!RunCheckpoint(impl->GetCheckpointHandlers(target),
+                       options.checkpoint_ready_file)) {
+      RunShutdown(impl->GetShutdownHandlers(target));
+      return 0;
+    }
+    // Report the startup of the restored process, the process age is not
+    // meaningful after a restore.
+    startup = StartupTimer(std::nullopt);
+    startup.Mark("restore");
+  }
+
+  // The event loops are shared with the outbound `HttpClient` connections.
+  std::vector<std::shared_ptr<asio::io_context>> contexts(shards);
+  std::generate(contexts.begin(), contexts.end(), [&] {
+    return std::make_shared<asio::io_context>(options.threads / shards);
+  });
+  // The outbound calls use the event loops until they stop accepting
+  // connections, the calls in progress keep them running.
+  std::optional<ServerEventLoops> client_event_loops;
+  ShutdownCoordinator coordinator(
+      *contexts.front(), options.shutdown_grace_period,
+      [&client_event_loops] { client_event_loops->Release(); });
+  // Any listener may observe the shutdown request, and it must stop all the
+  // other listeners.
+  std::function<bool()> const shutdown_requested = [&shutdown, &coordinator,
+                                                    &pipeline] {
+    if (!shutdown()) return false;
+    coordinator.Shutdown();
+    // A profile in progress would delay the shutdown, return it early.
+    if (pipeline->profiler) pipeline->profiler->Stop();
+    return true;
+  };
+  std::vector<std::shared_ptr<Listener>> listeners;
+  for (auto& ioc : contexts) {
+    auto acceptor = [&] {
+      if (inherited != nullptr) {
+        StreamAcceptor a{asio::make_strand(*ioc)};
+        a.assign(inherited->protocol, inherited->handle);
+        return a;
+      }
+      if (!options.unix_socket.empty()) {
+        return BindUnixAcceptor(*ioc, options.unix_socket);
+      }
+      auto a = BindAcceptor(*ioc, endpoint, options.reuse_port);
+      // If the port is 0 the first acceptor picks the port, and all the other
+      // acceptors must use the same value.
+      endpoint = a.local_endpoint();
+      return StreamAcceptor(std::move(a));
+    }();
+    Listen(acceptor, options);
+    listeners.push_back(std::make_shared<Listener>(
+        *ioc, std::move(acceptor), shard_options, handlers, shutdown_requested,
+        coordinator.draining(), [&coordinator] { coordinator.OnDrained(); }));
+  }
+  // The metrics port only answers `/metrics`, its sessions are not counted.
+  SessionHandlers metrics_handlers;
+  if (options.metrics_port != 0) {
+    auto routes = std::make_shared<StaticRoutes>();
+    routes->AddGenerated("/metrics", metrics_route);
+    metrics_handlers.handler = [](BeastRequest const& /*request*/) {
+      BeastResponse response;
+      response.result(be::http::status::not_found);
+      return response;
+    };
+    metrics_handlers.handler =
+        MakeStaticRoutesHandler(std::move(metrics_handlers.handler), routes);
+    metrics_handlers.static_routes = std::move(routes);
+    auto& ioc = *contexts.front();
+    auto acceptor = StreamAcceptor(BindAcceptor(
+        ioc, tcp::endpoint{endpoint.address(), options.metrics_port}, false));
+    Listen(acceptor, options);
+    listeners.push_back(std::make_shared<Listener>(
+        ioc, std::move(acceptor), shard_options, metrics_handlers,
+        shutdown_requested, coordinator.draining(),
+        [&coordinator] { coordinator.OnDrained(); }));
+  }
+  // Declared after the event loops, streaming handlers refer to sessions.
+  std::optional<asio::thread_pool> streaming_pool;
+  if (handlers.streaming_handler || handlers.writer_handler) {
+    streaming_pool.emplace(options.streaming_threads);
+    handlers.streaming_pool = &*streaming_pool;
+  }
+  startup.Mark("listen");
+  if (options.debug_startup) {
+    // The listeners have not started, they see the route once they do.
+    BeastResponse report;
+    report.set(be::http::field::content_type, "application/json");
+    report.body() = startup.ToJson();
+    static_routes->Add("/debug/startup", std::move(report));
+  }
+  if (options.log_startup) {
+    auto const report = startup.ToJson();
+    LogField const fields[] = {{"startup", report}};
+    WriteLog(functions::LogSeverity::kInfo, "Server ready", fields);
+  }
+  client_event_loops.emplace(contexts);
+  coordinator.Start(listeners);
+  actual_port(options.unix_socket.empty() ? endpoint.port() : 0);
+  for (auto& l : listeners) l->Start();
+
+  // The calling thread is one of the threads running the event loops. The
+  // event loops return once the listeners stop and all the sessions are closed.
+  auto const cpus = options.pin_threads ? AllowedCpus() : std::vector<int>{};
+  auto run = [&contexts, &cpus](int i) {
+    if (!cpus.empty() && !PinCurrentThread(cpus[i % cpus.size()])) {
+      WriteLog(functions::LogSeverity::kWarning,
+               "Cannot pin thread " + std::to_string(i) + " to a core");
+    }
+    auto& ioc = *contexts[i % contexts.size()];
+    ScopedEventLoopThread current(ioc);
+    ioc.run();
+  };
+  std::vector<std::thread> workers;
+  for (int i = 1; i < options.threads; ++i) workers.emplace_back(run, i);
+  run(0);
+  for (auto& t : workers) t.join();
+  if (streaming_pool) streaming_pool->join();
+  // All the sessions are closed, give any background work the same grace
+  // period, shared by the queued events and the background tasks.
+  auto const drain_deadline =
+      std::chrono::steady_clock::now() + options.shutdown_grace_period;
+  if (!DrainEventSinks(options.shutdown_grace_period)) {
+    WriteLog(functions::LogSeverity::kWarning,
+             "Queued events still pending at shutdown");
+  }
+  auto const remaining =
+      std::max(drain_deadline - std::chrono::steady_clock::now(),
+               std::chrono::steady_clock::duration(0));
+  if (!functions::BackgroundExecutor::Default().Drain(remaining)) {
+    WriteLog(functions::LogSeverity::kWarning,
+             "Background tasks still running at shutdown");
+  }
+  RunShutdown(impl->GetShutdownHandlers(target));
+  if (inherited == nullptr && !options.unix_socket.empty()) {
+    std::error_code ec;
+    std::filesystem::remove(options.unix_socket, ec);
   }
   return 0;
 }
 
+#ifndef _WIN32
+/**
+ * Runs the server in `options.processes` worker processes.
+ *
+ * This process binds the listening socket, and supervises the workers. Each
+ * worker listens on the socket once it is ready, so the first connections
+ * wait until a worker has warmed up.
+ */
+int RunWorkerServers(StartupTimer& startup, ServerOptions const& options,
+                     tcp::endpoint endpoint, std::string const& target,
+                     functions::Function const& function,
+                     std::function<bool()> const& shutdown,
+                     std::function<void(int)> const& actual_port) {
+  auto const inherited = [&] {
+    // No threads run this context, and the socket is released before any
+    // worker starts.
+    asio::io_context ioc;
+    auto acceptor = [&] {
+      if (!options.unix_socket.empty()) {
+        return BindUnixAcceptor(ioc, options.unix_socket);
+      }
+      auto a = BindAcceptor(ioc, endpoint, false);
+      endpoint = a.local_endpoint();
+      return StreamAcceptor(std::move(a));
+    }();
+    auto const protocol = acceptor.local_endpoint().protocol();
+    return InheritedSocket{protocol, acceptor.release()};
+  }();
+  bool worker_process = false;
+  auto const result = RunWorkerProcesses(
+      WorkerProcessOptions{options.processes}, [&](int /*index*/) {
+        worker_process = true;
+        return RunServer(startup, options, endpoint, target, function,
+                         shutdown, actual_port, &inherited);
+      });
+  if (worker_process) return result;
+  ::close(inherited.handle);
+  if (!options.unix_socket.empty()) {
+    std::error_code ec;
+    std::filesystem::remove(options.unix_socket, ec);
+  }
+  return result;
+}
+#endif  // _WIN32
+
+int RunForTestImpl(int argc, char const* const argv[],
+                   functions::Function const& function,
+                   std::function<bool()> const& shutdown,
+                   std::function<void(int)> const& actual_port) {
+  StartupTimer startup;
+  auto vm = ParseOptions(argc, argv);
+  if (vm.count("help") != 0) return 0;
+
+  auto const endpoint =
+      tcp::endpoint{asio::ip::make_address(vm["address"].as<std::string>()),
+                    static_cast<std::uint16_t>(vm["port"].as<int>())};
+  auto const target = vm["target"].as<std::string>();
+  auto const options = MakeServerOptions(vm);
+  // The arenas are created as threads start allocating.
+  if (options.max_allocator_arenas != 0 &&
+      !SetMaxAllocatorArenas(options.max_allocator_arenas)) {
+    WriteLog(functions::LogSeverity::kWarning,
+             "--max-allocator-arenas is not supported by the " +
+                 std::string(AllocatorName()) + " allocator");
+  }
+#ifndef _WIN32
+  // The worker processes start before this process creates any threads.
+  if (options.processes > 1) {
+    return RunWorkerServers(startup, options, endpoint, target, function,
+                            shutdown, actual_port);
+  }
+#endif  // _WIN32
+  return RunServer(startup, options, endpoint, target, function, shutdown,
+                   actual_port, nullptr);
+}
+
+/**
+ * Runs requests through the server pipeline, without any sockets.
+ *
+ * The requests skip the session: there are no timeouts, no pipelining, and no
+ * body memory budget. The function runs in the calling thread, or in the
+ * thread completing an asynchronous function.
+ */
+class InProcessServerImpl : public InProcessServer {
+ public:
+  InProcessServerImpl(int argc, char const* const argv[],
+                      functions::Function const& function) {
+    auto vm = ParseOptions(argc, argv);
+    options_ = MakeServerOptions(vm);
+    target_ = vm["target"].as<std::string>();
+    impl_ = FunctionImpl::GetImpl(function);
+    pipeline_ = MakeServerPipeline(options_, *impl_, target_);
+    if (pipeline_->handlers.streaming_handler ||
+        pipeline_->handlers.writer_handler) {
+      throw std::invalid_argument(
+          "streaming functions cannot be invoked in-process");
+    }
+    RunWarmup(impl_->GetWarmupHandlers(target_));
+  }
+  ~InProcessServerImpl() override {
+    RunShutdown(impl_->GetShutdownHandlers(target_));
+  }
+
+  BeastResponse Call(BeastRequest request) override {
+    auto const& handlers = pipeline_->handlers;
+    auto keep_alive = request.keep_alive();
+    auto response = [&] {
+      if (handlers.static_routes) {
+        auto route = handlers.static_routes->Respond(
+            request.target(), request[be::http::field::authorization]);
+        if (route) return *std::move(route);
+      }
+      if (handlers.precheck) {
+        if (auto r = handlers.precheck(request)) {
+          keep_alive = false;
+          return *std::move(r);
+        }
+      }
+      if (!handlers.async_handler) return handlers.handler(std::move(request));
+      std::promise<BeastResponse> p;
+      auto f = p.get_future();
+      handlers.async_handler(std::move(request), [&p](BeastResponse r) {
+        p.set_value(std::move(r));
+      });
+      return f.get();
+    }();
+    FlushLogs();
+    auto const close =
+        be::http::token_list{response[be::http::field::connection]}.exists(
+            "close");
+    FinalizeResponse(response, keep_alive && !close);
+    return response;
+  }
+
+  BeastResponse CallRaw(std::string_view raw) override {
+    RequestParser parser;
+    parser.eager(true);
+    parser.header_limit(options_.max_header_size);
+    parser.body_limit(options_.max_body_size);
+    be::error_code ec;
+    parser.put(asio::buffer(raw.data(), raw.size()), ec);
+    // Parse an incomplete request as if the client closed the connection.
+    if (!ec && !parser.is_done()) parser.put_eof(ec);
+    if (ec) {
+      BeastResponse response;
+      response.result(be::http::status::bad_request);
+      if (ec == be::http::error::body_limit) {
+        response.result(be::http::status::payload_too_large);
+      } else if (ec == be::http::error::header_limit) {
+        response.result(be::http::status::request_header_fields_too_large);
+      }
+      FinalizeResponse(response, false);
+      return response;
+    }
+    return Call(parser.release());
+  }
+
+ private:
+  ServerOptions options_;
+  std::string target_;
+  std::shared_ptr<FunctionImpl> impl_;
+  std::unique_ptr<ServerPipeline> pipeline_;
+};
+
 int RunImpl(int argc, char const* const argv[],
             functions::Function const& f) noexcept try {
   return RunForTestImpl(
       argc, argv, f, [] { return false; }, [](int /*unused*/) {});
 } catch (std::exception const& ex) {
-  std::cerr << "Standard C++ exception thrown " << ex.what() << "\n";
+  WriteLog(functions::LogSeverity::kCritical,
+           std::string("Standard C++ exception thrown ") + ex.what());
   return 1;
 } catch (...) {
-  std::cerr << "Unknown exception thrown\n";
+  WriteLog(functions::LogSeverity::kCritical, "Unknown exception thrown");
   return 1;
 }
 
@@ -147,6 +2838,11 @@ int RunForTest(int argc, char const* const argv[],
   return RunForTestImpl(argc, argv, handler, shutdown, actual_port);
 }
 
+std::unique_ptr<InProcessServer> MakeInProcessServer(
+    int argc, char const* const argv[], functions::Function const& function) {
+  return std::make_unique<InProcessServerImpl>(argc, argv, function);
+}
+
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions_internal
 
@@ -162,11 +2858,5 @@ int Run(int argc, char const* const argv[], UserHttpFunction handler) noexcept {
       argc, argv, functions::MakeFunction(std::move(handler)));
 }
 
-int Run(int argc, char const* const argv[],
-        UserCloudEventFunction handler) noexcept {
-  return functions_internal::RunImpl(
-      argc, argv, functions::MakeFunction(std::move(handler)));
-}
-
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions
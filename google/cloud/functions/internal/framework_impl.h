@@ -15,10 +15,13 @@
 #ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_FRAMEWORK_IMPL_H
 #define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_FRAMEWORK_IMPL_H
 
+#include "google/cloud/functions/internal/http_message_types.h"
 #include "google/cloud/functions/function.h"
 #include "google/cloud/functions/user_functions.h"
 #include "google/cloud/functions/version.h"
 #include <functional>
+#include <memory>
+#include <string_view>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
@@ -29,6 +32,22 @@ int RunForTest(int argc, char const* const argv[],
                std::function<bool()> const& shutdown,
                std::function<void(int)> const& actual_port);
 
+/// Runs requests through the pipeline of a server, without any sockets.
+class InProcessServer {
+ public:
+  virtual ~InProcessServer() = default;
+
+  /// Returns the response, with the headers set as it would be sent.
+  virtual BeastResponse Call(BeastRequest request) = 0;
+
+  /// Parses @p raw as an HTTP/1.x request, and returns its response.
+  virtual BeastResponse CallRaw(std::string_view raw) = 0;
+};
+
+/// Creates the pipeline of a server configured with @p argv.
+std::unique_ptr<InProcessServer> MakeInProcessServer(
+    int argc, char const* const argv[], functions::Function const& function);
+
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions_internal
 
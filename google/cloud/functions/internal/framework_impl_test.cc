@@ -13,19 +13,43 @@
 // limitations under the License.
 
 #include "google/cloud/functions/internal/framework_impl.h"
+#include "google/cloud/functions/background_executor.h"
+#include "google/cloud/functions/internal/compression.h"
+#include "google/cloud/functions/internal/conditional.h"
+#include "google/cloud/functions/event_sink.h"
 #include "google/cloud/functions/framework.h"
+#include "google/cloud/functions/http_client.h"
+#include "google/cloud/functions/server_sent_events.h"
 #include <boost/asio/connect.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
 #include <boost/beast.hpp>
 #include <gmock/gmock.h>
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <future>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 namespace {
 
+using ::testing::Each;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
 using ::testing::IsEmpty;
+using ::testing::Not;
 
 char const* const kTestArgv[] = {"unused", "--port=0"};
 auto constexpr kTestArgc = sizeof(kTestArgv) / sizeof(kTestArgv[0]);
@@ -34,6 +58,33 @@ char const* const kTestInvalidArgv[] = {"unused", "--port=12345467"};
 auto constexpr kTestInvalidArgc =
     sizeof(kTestInvalidArgv) / sizeof(kTestInvalidArgv[0]);
 
+boost::beast::http::response<boost::beast::http::string_body> HttpGetResponse(
+    std::string const& host, std::string const& port,
+    std::string const& target, std::string const& authorization = {}) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using tcp = boost::asio::ip::tcp;
+
+  boost::asio::io_context ioc;
+  tcp::resolver resolver(ioc);
+  beast::tcp_stream stream(ioc);
+  stream.connect(resolver.resolve(host, port));
+
+  auto constexpr kHttpVersion = 10;  // 1.0 as Boost.Beast spells it
+  http::request<http::string_body> req{http::verb::get, target, kHttpVersion};
+  req.set(http::field::host, host);
+  if (!authorization.empty()) {
+    req.set(http::field::authorization, authorization);
+  }
+  http::write(stream, req);
+  beast::flat_buffer buffer;
+  http::response<http::string_body> res;
+  http::read(stream, buffer, res);
+  beast::error_code ec;
+  stream.socket().shutdown(tcp::socket::shutdown_both, ec);
+  return res;
+}
+
 std::string HttpGet(std::string const& host, std::string const& port,
                     std::string const& target) {
   namespace beast = boost::beast;
@@ -98,6 +149,39 @@ std::string CloudEventGet(std::string const& host, std::string const& port,
   return std::move(res.body());
 }
 
+/// Make several requests over a single (keep-alive) connection.
+std::vector<std::string> HttpGetKeepAlive(
+    std::string const& host, std::string const& port,
+    std::vector<std::string> const& targets) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using tcp = boost::asio::ip::tcp;
+
+  boost::asio::io_context ioc;
+  tcp::resolver resolver(ioc);
+  beast::tcp_stream stream(ioc);
+  auto const results = resolver.resolve(host, port);
+  stream.connect(results);
+
+  std::vector<std::string> bodies;
+  beast::flat_buffer buffer;
+  for (auto const& target : targets) {
+    auto constexpr kHttpVersion = 11;  // 1.1 as Boost.Beast spells it
+    http::request<http::string_body> req{http::verb::get, target,
+                                         kHttpVersion};
+    req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+    req.set(http::field::host, host);
+    req.keep_alive(true);
+    req.prepare_payload();
+    http::write(stream, req);
+    http::response<http::string_body> res;
+    http::read(stream, buffer, res);
+    bodies.push_back(std::move(res.body()));
+  }
+  stream.socket().shutdown(tcp::socket::shutdown_both);
+  return bodies;
+}
+
 TEST(FrameworkTest, Http) {
   std::promise<int> port_p;
   auto port_f = port_p.get_future();
@@ -120,6 +204,13 @@ TEST(FrameworkTest, Http) {
   auto port = port_f.get();
   auto actual = HttpGet("localhost", std::to_string(port), "/say/hello");
   EXPECT_EQ(actual, "Hello World from /say/hello");
+  // Responses include the Date header, in IMF-fixdate format.
+  auto const response =
+      HttpGetResponse("localhost", std::to_string(port), "/say/hello");
+  EXPECT_THAT(std::string(response[boost::beast::http::field::date]),
+              ::testing::MatchesRegex(
+                  "[A-Z][a-z]{2}, [0-9]{2} [A-Z][a-z]{2} [0-9]{4} "
+                  "[0-9]{2}:[0-9]{2}:[0-9]{2} GMT"));
   shutdown.store(true);
   // Making a second request guarantees the change in `shutdown` is seen, but
   // can fail.
@@ -130,6 +221,2029 @@ TEST(FrameworkTest, Http) {
   EXPECT_EQ(done.get(), 0);
 }
 
+TEST(FrameworkTest, Warmup) {
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  std::atomic<int> warmups{0};
+  auto hello = [&warmups](functions::HttpRequest const& /*request*/) {
+    return functions::HttpResponse{}.set_payload(
+        "warmups=" + std::to_string(warmups.load()));
+  };
+  auto warmup = [&warmups] { ++warmups; };
+  auto function = functions::WithWarmup(
+      functions::WithWarmup(functions::MakeFunction(hello), warmup), warmup);
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kTestArgc), kTestArgv, function,
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p, &warmups](int port) mutable {
+          // The warmup completes before the server listens.
+          EXPECT_EQ(warmups.load(), 2);
+          port_p.set_value(port);
+        });
+  });
+
+  auto port = port_f.get();
+  EXPECT_EQ(HttpGet("localhost", std::to_string(port), "/"), "warmups=2");
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", std::to_string(port), "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, DebugStartup) {
+  char const* const argv[] = {"unused", "--port=0", "--debug-startup"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto hello = [](functions::HttpRequest const& /*request*/) {
+    return functions::HttpResponse{}.set_payload("Hello");
+  };
+  auto function = functions::WithWarmup(functions::MakeFunction(hello), [] {});
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv, function,
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+
+  auto port = std::to_string(port_f.get());
+  auto const report = HttpGet("localhost", port, "/debug/startup");
+  for (auto const* phase : {"parse_options", "get_handler", "warmup", "listen",
+                            "totalMs"}) {
+    EXPECT_THAT(report, HasSubstr(phase));
+  }
+  EXPECT_EQ(HttpGet("localhost", port, "/"), "Hello");
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, SocketOptions) {
+  char const* const argv[] = {"unused",
+                              "--port=0",
+                              "--listen-backlog=16",
+                              "--tcp-nodelay=false",
+                              "--tcp-keepalive=30",
+                              "--tcp-keepalive-interval=5",
+                              "--tcp-keepalive-count=3",
+                              "--send-buffer-size=65536",
+                              "--receive-buffer-size=65536",
+#ifdef __linux__
+                              "--tcp-defer-accept=5",
+#endif  // __linux__
+                              "--threads=2"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto hello = [](functions::HttpRequest const& /*request*/) {
+    return functions::HttpResponse{}.set_payload("Hello");
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv, functions::MakeFunction(hello),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+
+  auto port = std::to_string(port_f.get());
+  EXPECT_EQ(HttpGet("localhost", port, "/"), "Hello");
+  EXPECT_THAT(HttpGetKeepAlive("localhost", port, {"/a", "/b"}),
+              ElementsAre("Hello", "Hello"));
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, DebugServer) {
+  char const* const argv[] = {"unused", "--port=0", "--debug-server",
+                              "--debug-server-token=secret"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto hello = [](functions::HttpRequest const& /*request*/) {
+    return functions::HttpResponse{}.set_payload("Hello");
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv, functions::MakeFunction(hello),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+
+  auto port = std::to_string(port_f.get());
+  auto const denied = HttpGetResponse("localhost", port, "/debug/server");
+  EXPECT_EQ(denied.result(), boost::beast::http::status::unauthorized);
+  auto const report = HttpGetResponse("localhost", port, "/debug/server",
+                                      "Bearer secret");
+  EXPECT_EQ(report.result(), boost::beast::http::status::ok);
+  // The session answering the request is reading its header.
+  EXPECT_THAT(report.body(), HasSubstr(R"("sessions":{"open":)"));
+  EXPECT_THAT(report.body(), HasSubstr(R"("state":"reading")"));
+  EXPECT_THAT(report.body(), HasSubstr(R"("admission":{)"));
+  EXPECT_EQ(HttpGet("localhost", port, "/"), "Hello");
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, BackgroundTasksDrain) {
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  std::atomic<bool> completed{false};
+  auto hello = [&completed](functions::HttpRequest const& /*request*/) {
+    functions::RunInBackground([&completed] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      completed = true;
+    });
+    return functions::HttpResponse{}.set_payload("Hello");
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kTestArgc), kTestArgv, functions::MakeFunction(hello),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+
+  auto port = std::to_string(port_f.get());
+  // The response does not wait for the background task.
+  EXPECT_EQ(HttpGet("localhost", port, "/"), "Hello");
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+  EXPECT_TRUE(completed.load());
+}
+
+TEST(FrameworkTest, Shutdown) {
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  std::vector<std::string> calls;
+  auto add = [&calls](std::string name) {
+    return [&calls, name = std::move(name)] { calls.push_back(name); };
+  };
+  auto hello = [](functions::HttpRequest const& /*request*/) {
+    return functions::HttpResponse{}.set_payload("Hello");
+  };
+  auto function = functions::WithShutdown(
+      functions::WithShutdown(functions::MakeFunction(hello), add("inner")),
+      [] { throw std::runtime_error("ignored"); });
+  function = functions::WithShutdown(std::move(function), add("outer"));
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kTestArgc), kTestArgv, function,
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+
+  auto port = std::to_string(port_f.get());
+  EXPECT_EQ(HttpGet("localhost", port, "/"), "Hello");
+  EXPECT_THAT(calls, IsEmpty());
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+  EXPECT_THAT(calls, ElementsAre("outer", "inner"));
+}
+
+TEST(FrameworkTest, Metrics) {
+  // Pick an unused port for the metrics.
+  auto const metrics_port = [] {
+    boost::asio::io_context ioc;
+    boost::asio::ip::tcp::acceptor acceptor(
+        ioc, {boost::asio::ip::tcp::v4(), 0});
+    return std::to_string(acceptor.local_endpoint().port());
+  }();
+  for (auto const& flag :
+       {std::string("--metrics"), "--metrics-port=" + metrics_port}) {
+    char const* const argv[] = {"unused", "--port=0", flag.c_str()};
+    auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+    std::promise<int> port_p;
+    auto port_f = port_p.get_future();
+    std::atomic<bool> shutdown{false};
+    auto hello = [](functions::HttpRequest const& /*request*/) {
+      return functions::HttpResponse{}.set_payload("Hello");
+    };
+    auto done = std::async(std::launch::async, [&] {
+      return RunForTest(
+          static_cast<int>(kArgc), argv, functions::MakeFunction(hello),
+          [&shutdown]() { return shutdown.load(); },
+          [&port_p](int port) mutable { port_p.set_value(port); });
+    });
+
+    auto port = std::to_string(port_f.get());
+    EXPECT_EQ(HttpGet("localhost", port, "/say/hello"), "Hello");
+    auto const scrape_port = flag == "--metrics" ? port : metrics_port;
+    auto const text = HttpGet("localhost", scrape_port, "/metrics");
+    EXPECT_THAT(text, HasSubstr("functions_framework_requests_total{code="
+                                "\"200\"} 1\n"));
+    EXPECT_THAT(text, HasSubstr("functions_framework_request_duration_"
+                                "seconds_count 1\n"));
+    EXPECT_THAT(text, HasSubstr("functions_framework_request_phase_seconds_"
+                                "count{phase=\"read\"} 1\n"));
+    EXPECT_THAT(text, HasSubstr("functions_framework_request_phase_seconds_"
+                                "count{phase=\"function\"} 1\n"));
+    if (scrape_port != port) {
+      EXPECT_EQ(HttpGetResponse("localhost", scrape_port, "/say/hello")
+                    .result_int(),
+                404);
+      EXPECT_EQ(HttpGet("localhost", port, "/metrics"), "Hello");
+    }
+    shutdown.store(true);
+    try {
+      (void)HttpGet("localhost", port, "/quit/now");
+    } catch (...) {
+    }
+    EXPECT_EQ(done.get(), 0) << flag;
+  }
+}
+
+TEST(FrameworkTest, ServerTiming) {
+  char const* const argv[] = {"unused", "--port=0", "--server-timing"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto hello = [](functions::HttpRequest const& /*request*/) {
+    return functions::HttpResponse{}.set_payload("Hello");
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv, functions::MakeFunction(hello),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+
+  auto port = std::to_string(port_f.get());
+  auto const response = HttpGetResponse("localhost", port, "/say/hello");
+  EXPECT_EQ(response.body(), "Hello");
+  auto const timing = std::string(response["Server-Timing"]);
+  EXPECT_THAT(timing, HasSubstr("decode;dur="));
+  EXPECT_THAT(timing, HasSubstr("function;dur="));
+  EXPECT_THAT(timing, HasSubstr("encode;dur="));
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, SlowRequests) {
+  char const* const argv[] = {"unused", "--port=0",
+                              "--slow-request-threshold=20"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto hello = [](functions::HttpRequest const& request) {
+    if (request.target() == "/slow") {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    return functions::HttpResponse{}.set_payload("Hello");
+  };
+  std::ostringstream captured;
+  auto* previous = std::cerr.rdbuf(captured.rdbuf());
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv, functions::MakeFunction(hello),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+
+  auto port = std::to_string(port_f.get());
+  EXPECT_EQ(HttpGet("localhost", port, "/fast"), "Hello");
+  EXPECT_EQ(HttpGet("localhost", port, "/slow"), "Hello");
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+  std::cerr.rdbuf(previous);
+
+  auto const log = captured.str();
+  EXPECT_THAT(log, HasSubstr(R"("message":"Slow request: GET /slow")"));
+  EXPECT_THAT(log, HasSubstr(R"("requestMethod":"GET")"));
+  EXPECT_THAT(log, HasSubstr(R"("phasesMs":{"read":)"));
+  EXPECT_THAT(log, Not(HasSubstr("/fast")));
+}
+
+TEST(FrameworkTest, WarmupFailure) {
+  auto called = false;
+  auto function = functions::WithWarmup(
+      functions::MakeFunction([](functions::HttpRequest const& /*request*/) {
+        return functions::HttpResponse{};
+      }),
+      [] { throw std::runtime_error("cannot load the model"); });
+  EXPECT_THROW(RunForTest(
+                   static_cast<int>(kTestArgc), kTestArgv, function,
+                   [] { return true; }, [&called](int) { called = true; }),
+               std::runtime_error);
+  EXPECT_FALSE(called);
+}
+
+TEST(FrameworkTest, HttpKeepAliveMultipleThreads) {
+  char const* const argv[] = {"unused", "--port=0", "--threads=4"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto hello = [](functions::HttpRequest const& r) {
+    return functions::HttpResponse{}
+        .set_header("content-type", "text/plain")
+        .set_payload("Hello World from " + r.target());
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv, functions::MakeFunction(hello),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+
+  auto const port = std::to_string(port_f.get());
+  auto constexpr kClients = 8;
+  std::vector<std::future<std::vector<std::string>>> clients(kClients);
+  std::generate(clients.begin(), clients.end(), [&] {
+    return std::async(std::launch::async, HttpGetKeepAlive, "localhost", port,
+                      std::vector<std::string>{"/a", "/b", "/c"});
+  });
+  for (auto& c : clients) {
+    EXPECT_THAT(c.get(), ElementsAre("Hello World from /a",
+                                     "Hello World from /b",
+                                     "Hello World from /c"));
+  }
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, HttpReusePort) {
+  char const* const argv[] = {"unused", "--port=0", "--threads=4",
+                              "--reuse-port"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto hello = [](functions::HttpRequest const& r) {
+    return functions::HttpResponse{}
+        .set_header("content-type", "text/plain")
+        .set_payload("Hello World from " + r.target());
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv, functions::MakeFunction(hello),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+
+  auto const port = std::to_string(port_f.get());
+  auto constexpr kClients = 8;
+  std::vector<std::future<std::vector<std::string>>> clients(kClients);
+  std::generate(clients.begin(), clients.end(), [&] {
+    return std::async(std::launch::async, HttpGetKeepAlive, "localhost", port,
+                      std::vector<std::string>{"/a", "/b", "/c"});
+  });
+  for (auto& c : clients) {
+    EXPECT_THAT(c.get(), ElementsAre("Hello World from /a",
+                                     "Hello World from /b",
+                                     "Hello World from /c"));
+  }
+  // A single request stops all the listeners, no matter which one receives it.
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, OverloadReject) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using tcp = boost::asio::ip::tcp;
+
+  char const* const argv[] = {"unused", "--port=0", "--max-sessions=1",
+                              "--overload-policy=reject", "--retry-after=7"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto hello = [](functions::HttpRequest const& /*r*/) {
+    return functions::HttpResponse{}.set_payload("Hello");
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv, functions::MakeFunction(hello),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  // Keep a session open, this consumes the only available slot.
+  boost::asio::io_context ioc;
+  tcp::resolver resolver(ioc);
+  beast::tcp_stream stream(ioc);
+  stream.connect(resolver.resolve("localhost", port));
+  http::request<http::string_body> req{http::verb::get, "/", 11};
+  req.set(http::field::host, "localhost");
+  req.keep_alive(true);
+  http::write(stream, req);
+  beast::flat_buffer buffer;
+  http::response<http::string_body> res;
+  http::read(stream, buffer, res);
+  EXPECT_EQ(res.result(), http::status::ok);
+
+  // Any new connections get a 503.
+  auto const rejected = HttpGetResponse("localhost", port, "/rejected");
+  EXPECT_EQ(rejected.result(), http::status::service_unavailable);
+  EXPECT_EQ(rejected[http::field::retry_after], "7");
+
+  // Once the session is closed, requests are served again.
+  stream.socket().shutdown(tcp::socket::shutdown_both);
+  stream.close();
+  auto served = rejected;
+  for (int i = 0; i != 100; ++i) {
+    served = HttpGetResponse("localhost", port, "/served");
+    if (served.result() == http::status::ok) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(served.result(), http::status::ok);
+
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, OverloadQueue) {
+  char const* const argv[] = {"unused", "--port=0", "--max-sessions=1",
+                              "--overload-policy=queue"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto hello = [](functions::HttpRequest const& r) {
+    return functions::HttpResponse{}.set_payload("Hello " + r.target());
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv, functions::MakeFunction(hello),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  // With a single session available all these clients are served, one at a
+  // time.
+  auto constexpr kClients = 4;
+  std::vector<std::future<std::vector<std::string>>> clients(kClients);
+  std::generate(clients.begin(), clients.end(), [&] {
+    return std::async(std::launch::async, HttpGetKeepAlive, "localhost", port,
+                      std::vector<std::string>{"/a", "/b"});
+  });
+  for (auto& c : clients) {
+    EXPECT_THAT(c.get(), ElementsAre("Hello /a", "Hello /b"));
+  }
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, SigtermCompletesRequestsInProgress) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using tcp = boost::asio::ip::tcp;
+
+  char const* const argv[] = {"unused", "--port=0", "--threads=2"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::promise<void> started;
+  std::promise<void> release;
+  auto slow = [&started, f = release.get_future().share()](
+                  functions::HttpRequest const& /*r*/) {
+    started.set_value();
+    f.wait();
+    return functions::HttpResponse{}.set_payload("Hello");
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv, functions::MakeFunction(slow),
+        [] { return false; },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  boost::asio::io_context ioc;
+  tcp::resolver resolver(ioc);
+  beast::tcp_stream stream(ioc);
+  stream.connect(resolver.resolve("localhost", port));
+  http::request<http::string_body> req{http::verb::get, "/slow", 11};
+  req.set(http::field::host, "localhost");
+  req.keep_alive(true);
+  http::write(stream, req);
+  started.get_future().wait();
+
+  // Once the server receives the signal it stops accepting connections.
+  std::raise(SIGTERM);
+  bool accepting = true;
+  for (int i = 0; i != 100 && accepting; ++i) {
+    try {
+      (void)HttpGetResponse("localhost", port, "/rejected");
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    } catch (...) {
+      accepting = false;
+    }
+  }
+  EXPECT_FALSE(accepting);
+
+  // The request in progress completes, and the connection is closed.
+  release.set_value();
+  beast::flat_buffer buffer;
+  http::response<http::string_body> res;
+  http::read(stream, buffer, res);
+  EXPECT_EQ(res.result(), http::status::ok);
+  EXPECT_EQ(res.body(), "Hello");
+  EXPECT_FALSE(res.keep_alive());
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, SigtermClosesIdleSessions) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using tcp = boost::asio::ip::tcp;
+
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  auto hello = [](functions::HttpRequest const& /*r*/) {
+    return functions::HttpResponse{}.set_payload("Hello");
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kTestArgc), kTestArgv, functions::MakeFunction(hello),
+        [] { return false; },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  boost::asio::io_context ioc;
+  tcp::resolver resolver(ioc);
+  beast::tcp_stream stream(ioc);
+  stream.connect(resolver.resolve("localhost", port));
+  http::request<http::string_body> req{http::verb::get, "/", 11};
+  req.set(http::field::host, "localhost");
+  req.keep_alive(true);
+  http::write(stream, req);
+  beast::flat_buffer buffer;
+  http::response<http::string_body> res;
+  http::read(stream, buffer, res);
+  EXPECT_TRUE(res.keep_alive());
+
+  // The session is idle, waiting for the next request, the server closes it.
+  std::raise(SIGTERM);
+  beast::error_code ec;
+  http::read(stream, buffer, res, ec);
+  EXPECT_EQ(ec, http::error::end_of_stream);
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, ConnectionLimits) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using tcp = boost::asio::ip::tcp;
+
+  char const* const argv[] = {"unused", "--port=0",
+                              "--max-connection-requests=3",
+                              "--connection-limit-jitter=0"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto hello = [](functions::HttpRequest const& /*r*/) {
+    return functions::HttpResponse{}.set_payload("Hello");
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv, functions::MakeFunction(hello),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  boost::asio::io_context ioc;
+  tcp::resolver resolver(ioc);
+  beast::tcp_stream stream(ioc);
+  stream.connect(resolver.resolve("localhost", port));
+  beast::flat_buffer buffer;
+  std::vector<bool> keep_alive;
+  for (int i = 0; i != 3; ++i) {
+    http::request<http::string_body> req{http::verb::get, "/", 11};
+    req.set(http::field::host, "localhost");
+    req.keep_alive(true);
+    http::write(stream, req);
+    http::response<http::string_body> res;
+    http::read(stream, buffer, res);
+    EXPECT_EQ(res.body(), "Hello");
+    keep_alive.push_back(res.keep_alive());
+  }
+  EXPECT_THAT(keep_alive, ElementsAre(true, true, false));
+  // The server closes the connection after the last response.
+  http::response<http::string_body> res;
+  beast::error_code ec;
+  http::read(stream, buffer, res, ec);
+  EXPECT_EQ(ec, http::error::end_of_stream);
+
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+/// Connects to the server, sends @p prefix, and waits until the server closes
+/// the connection.
+boost::beast::error_code ReadUntilClosed(std::string const& port,
+                                      std::string const& prefix) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using tcp = boost::asio::ip::tcp;
+
+  boost::asio::io_context ioc;
+  tcp::resolver resolver(ioc);
+  beast::tcp_stream stream(ioc);
+  stream.connect(resolver.resolve("localhost", port));
+  if (!prefix.empty()) boost::asio::write(stream, boost::asio::buffer(prefix));
+  // Guard against hangs if the server never closes the connection.
+  stream.expires_after(std::chrono::seconds(30));
+  beast::flat_buffer buffer;
+  http::response<http::string_body> res;
+  beast::error_code ec;
+  http::read(stream, buffer, res, ec);
+  return ec;
+}
+
+TEST(FrameworkTest, Timeouts) {
+  char const* const argv[] = {"unused", "--port=0", "--idle-timeout=1",
+                              "--header-timeout=1"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto hello = [](functions::HttpRequest const& /*r*/) {
+    return functions::HttpResponse{}.set_payload("Hello");
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv, functions::MakeFunction(hello),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  // An idle connection, and a connection that never completes the request
+  // header, are closed by the server.
+  auto idle = std::async(std::launch::async, ReadUntilClosed, port, "");
+  auto partial = std::async(std::launch::async, ReadUntilClosed, port,
+                            "GET / HTTP/1.1\r\nHost: localhost\r\n");
+  EXPECT_EQ(idle.get(), boost::beast::http::error::end_of_stream);
+  auto const ec = partial.get();
+  EXPECT_TRUE(ec) << ec.message();
+  EXPECT_NE(ec, boost::beast::error::timeout);
+
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+/// Sends @p request and returns the server response.
+boost::beast::http::response<boost::beast::http::string_body> SendRaw(
+    std::string const& port, std::string const& request) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using tcp = boost::asio::ip::tcp;
+
+  boost::asio::io_context ioc;
+  tcp::resolver resolver(ioc);
+  beast::tcp_stream stream(ioc);
+  stream.connect(resolver.resolve("localhost", port));
+  boost::asio::write(stream, boost::asio::buffer(request));
+  beast::flat_buffer buffer;
+  http::response<http::string_body> res;
+  http::read(stream, buffer, res);
+  return res;
+}
+
+TEST(FrameworkTest, RequestLimits) {
+  namespace http = boost::beast::http;
+  char const* const argv[] = {"unused", "--port=0", "--max-header-size=512",
+                              "--max-body-size=16"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto echo = [](functions::HttpRequest const& r) {
+    return functions::HttpResponse{}.set_payload(r.payload());
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv, functions::MakeFunction(echo),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  auto small = SendRaw(port,
+                       "POST / HTTP/1.1\r\nHost: localhost\r\n"
+                       "Content-Length: 5\r\n\r\nHello");
+  EXPECT_EQ(small.result(), http::status::ok);
+  EXPECT_EQ(small.body(), "Hello");
+
+  // The server rejects the request without waiting for the body.
+  auto large = SendRaw(port,
+                       "POST / HTTP/1.1\r\nHost: localhost\r\n"
+                       "Content-Length: 1000000\r\n\r\n");
+  EXPECT_EQ(large.result(), http::status::payload_too_large);
+  EXPECT_FALSE(large.keep_alive());
+
+  auto chunked = SendRaw(port,
+                         "POST / HTTP/1.1\r\nHost: localhost\r\n"
+                         "Transfer-Encoding: chunked\r\n\r\n"
+                         "20\r\n" +
+                             std::string(32, 'x') + "\r\n0\r\n\r\n");
+  EXPECT_EQ(chunked.result(), http::status::payload_too_large);
+
+  auto header = SendRaw(port, "GET / HTTP/1.1\r\nHost: localhost\r\n"
+                              "x-large: " +
+                                  std::string(1024, 'x') + "\r\n\r\n");
+  EXPECT_EQ(header.result(), http::status::request_header_fields_too_large);
+
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, FastRequestParser) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using tcp = boost::asio::ip::tcp;
+
+  char const* const argv[] = {"unused", "--port=0", "--fast-request-parser",
+                              "--max-header-size=512", "--max-body-size=16"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto echo = [](functions::HttpRequest const& r) {
+    return functions::HttpResponse{}
+        .set_header("x-target", r.target())
+        .set_header("x-custom", r.headers().get("x-custom").value_or(""))
+        .set_payload(r.payload());
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv, functions::MakeFunction(echo),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  // Pipeline requests taking the fast path and requests falling back to the
+  // Boost.Beast parser, in the same connection.
+  boost::asio::io_context ioc;
+  tcp::resolver resolver(ioc);
+  beast::tcp_stream stream(ioc);
+  stream.connect(resolver.resolve("localhost", port));
+  std::string const requests =
+      "POST /a HTTP/1.1\r\nHost: localhost\r\nx-custom:  v1 \r\n"
+      "Content-Length: 5\r\n\r\nHello"
+      "POST /b HTTP/1.1\r\nHost: localhost\r\n"
+      "Transfer-Encoding: chunked\r\n\r\n3\r\nabc\r\n0\r\n\r\n"
+      "GET /c HTTP/1.1\r\nHost: localhost\r\nx-custom: v3\r\n\r\n";
+  boost::asio::write(stream, boost::asio::buffer(requests));
+  beast::flat_buffer buffer;
+  std::vector<std::string> responses;
+  for (int i = 0; i != 3; ++i) {
+    http::response<http::string_body> res;
+    http::read(stream, buffer, res);
+    EXPECT_EQ(res.result(), http::status::ok);
+    EXPECT_TRUE(res.keep_alive());
+    responses.push_back(std::string(res["x-target"]) + " " +
+                        std::string(res["x-custom"]) + " " + res.body());
+  }
+  EXPECT_THAT(responses, ElementsAre("/a v1 Hello", "/b  abc", "/c v3 "));
+  stream.socket().shutdown(tcp::socket::shutdown_both);
+
+  // The limits apply to both parsers.
+  auto large = SendRaw(port,
+                       "POST / HTTP/1.1\r\nHost: localhost\r\n"
+                       "Content-Length: 17\r\n\r\n" +
+                           std::string(17, 'x'));
+  EXPECT_EQ(large.result(), http::status::payload_too_large);
+  auto header = SendRaw(port, "GET / HTTP/1.1\r\nHost: localhost\r\n"
+                              "x-large: " +
+                                  std::string(1024, 'x') + "\r\n\r\n");
+  EXPECT_EQ(header.result(), http::status::request_header_fields_too_large);
+
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, BufferedBodyMemory) {
+  namespace http = boost::beast::http;
+  char const* const argv[] = {"unused", "--port=0",
+                              "--max-buffered-body-memory=64",
+                              "--retry-after=3"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto echo = [](functions::HttpRequest const& r) {
+    return functions::HttpResponse{}.set_payload(r.payload());
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv, functions::MakeFunction(echo),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  // The server rejects the request without waiting for the body.
+  auto large = SendRaw(port,
+                       "POST / HTTP/1.1\r\nHost: localhost\r\n"
+                       "Content-Length: 100\r\n\r\n");
+  EXPECT_EQ(large.result(), http::status::service_unavailable);
+  EXPECT_EQ(large[http::field::retry_after], "3");
+  EXPECT_FALSE(large.keep_alive());
+
+  auto chunked = SendRaw(port,
+                         "POST / HTTP/1.1\r\nHost: localhost\r\n"
+                         "Transfer-Encoding: chunked\r\n\r\n"
+                         "64\r\n" +
+                             std::string(100, 'x') + "\r\n0\r\n\r\n");
+  EXPECT_EQ(chunked.result(), http::status::service_unavailable);
+
+  // The rejected requests released their memory.
+  auto small = SendRaw(port,
+                       "POST / HTTP/1.1\r\nHost: localhost\r\n"
+                       "Content-Length: 64\r\n\r\n" +
+                           std::string(64, 'x'));
+  EXPECT_EQ(small.result(), http::status::ok);
+  EXPECT_EQ(small.body(), std::string(64, 'x'));
+
+  auto small_chunked = SendRaw(port,
+                               "POST / HTTP/1.1\r\nHost: localhost\r\n"
+                               "Transfer-Encoding: chunked\r\n\r\n"
+                               "5\r\nHello\r\n0\r\n\r\n");
+  EXPECT_EQ(small_chunked.result(), http::status::ok);
+  EXPECT_EQ(small_chunked.body(), "Hello");
+
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, StreamingRequestBody) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using tcp = boost::asio::ip::tcp;
+
+  char const* const argv[] = {"unused", "--port=0", "--max-body-size=8000000",
+                              "--streaming-threads=2"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto count = [](functions::HttpRequest const& r,
+                  functions::HttpRequestBodyReader& reader) {
+    if (r.target() == "/ignore-body") return functions::HttpResponse{};
+    // Use a small buffer, the body is larger than the buffer and must be
+    // received in multiple reads.
+    std::vector<char> buffer(1024);
+    std::size_t size = 0;
+    std::size_t x_count = 0;
+    for (auto n = reader.Read(buffer.data(), buffer.size()); n != 0;
+         n = reader.Read(buffer.data(), buffer.size())) {
+      size += n;
+      x_count += std::count(buffer.begin(), buffer.begin() + n, 'x');
+    }
+    return functions::HttpResponse{}.set_payload(std::to_string(size) + " " +
+                                                 std::to_string(x_count));
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv,
+        functions::MakeFunction(functions::UserHttpStreamingFunction(count)),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  boost::asio::io_context ioc;
+  tcp::resolver resolver(ioc);
+  beast::tcp_stream stream(ioc);
+  stream.connect(resolver.resolve("localhost", port));
+  beast::flat_buffer buffer;
+
+  auto constexpr kSize = 4 * 1024 * 1024;
+  http::request<http::string_body> req{http::verb::post, "/", 11};
+  req.set(http::field::host, "localhost");
+  req.keep_alive(true);
+  req.body() = std::string(kSize, 'x');
+  req.prepare_payload();
+  http::write(stream, req);
+  http::response<http::string_body> res;
+  http::read(stream, buffer, res);
+  EXPECT_EQ(res.result(), http::status::ok);
+  EXPECT_EQ(res.body(), std::to_string(kSize) + " " + std::to_string(kSize));
+  EXPECT_TRUE(res.keep_alive());
+
+  // Send a chunked body through the same connection.
+  boost::asio::write(
+      stream, boost::asio::buffer(
+                  std::string("POST / HTTP/1.1\r\nHost: localhost\r\n"
+                              "Transfer-Encoding: chunked\r\n\r\n"
+                              "3\r\nxxx\r\n5\r\nyyyyy\r\n0\r\n\r\n")));
+  res = {};
+  http::read(stream, buffer, res);
+  EXPECT_EQ(res.result(), http::status::ok);
+  EXPECT_EQ(res.body(), "8 3");
+  EXPECT_TRUE(res.keep_alive());
+
+  // If the body is not consumed the connection is closed. Use a small body,
+  // the server may close the connection before the client sends a large body.
+  req.target("/ignore-body");
+  req.body() = "Hello";
+  req.prepare_payload();
+  http::write(stream, req);
+  res = {};
+  http::read(stream, buffer, res);
+  EXPECT_EQ(res.result(), http::status::ok);
+  EXPECT_FALSE(res.keep_alive());
+
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, StreamingResponse) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using tcp = boost::asio::ip::tcp;
+
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto writer = [](functions::HttpRequest const& r,
+                   functions::HttpResponseWriter& w) {
+    if (r.target() == "/default-header") return w.Write("no header");
+    w.WriteHeader(functions::HttpResponse{}
+                      .set_header("content-type", "text/plain")
+                      .set_payload("header payload\n"));
+    for (int i = 0; i != 3; ++i) w.Write("line " + std::to_string(i) + "\n");
+    if (r.target() == "/fail") throw std::runtime_error("uh-oh");
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kTestArgc), kTestArgv,
+        functions::MakeFunction(
+            functions::UserHttpStreamingResponseFunction(writer)),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  boost::asio::io_context ioc;
+  tcp::resolver resolver(ioc);
+  beast::tcp_stream stream(ioc);
+  stream.connect(resolver.resolve("localhost", port));
+  beast::flat_buffer buffer;
+
+  http::request<http::string_body> req{http::verb::get, "/", 11};
+  req.set(http::field::host, "localhost");
+  req.keep_alive(true);
+  http::write(stream, req);
+  http::response<http::string_body> res;
+  http::read(stream, buffer, res);
+  EXPECT_EQ(res.result(), http::status::ok);
+  EXPECT_TRUE(res.chunked());
+  EXPECT_TRUE(res.keep_alive());
+  EXPECT_EQ(res[http::field::content_type], "text/plain");
+  EXPECT_EQ(res.body(), "header payload\nline 0\nline 1\nline 2\n");
+
+  // The connection is reusable, and `Write()` sends a default header.
+  req.target("/default-header");
+  http::write(stream, req);
+  res = {};
+  http::read(stream, buffer, res);
+  EXPECT_EQ(res.result(), http::status::ok);
+  EXPECT_EQ(res.body(), "no header");
+
+  // Failures after the header is sent truncate the response.
+  req.target("/fail");
+  http::write(stream, req);
+  res = {};
+  beast::error_code ec;
+  http::read(stream, buffer, res, ec);
+  EXPECT_TRUE(ec);
+
+  // HTTP/1.0 clients do not support chunked encoding.
+  auto const http10 = HttpGetResponse("localhost", port, "/");
+  EXPECT_FALSE(http10.chunked());
+  EXPECT_EQ(http10.body(), "header payload\nline 0\nline 1\nline 2\n");
+
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, ServerSentEvents) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using tcp = boost::asio::ip::tcp;
+
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto writer = [](functions::HttpRequest const&,
+                   functions::HttpResponseWriter& w) {
+    functions::ServerSentEventOptions options;
+    options.heartbeat_interval = std::chrono::milliseconds(20);
+    functions::ServerSentEventWriter events(w, options);
+    events.Send("first");
+    // The framework sends heartbeats while the function waits.
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    events.Send(functions::ServerSentEvent{"last", "done"});
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kTestArgc), kTestArgv,
+        functions::MakeFunction(
+            functions::UserHttpStreamingResponseFunction(writer)),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  boost::asio::io_context ioc;
+  tcp::resolver resolver(ioc);
+  beast::tcp_stream stream(ioc);
+  stream.connect(resolver.resolve("localhost", port));
+  beast::flat_buffer buffer;
+
+  http::request<http::string_body> req{http::verb::get, "/", 11};
+  req.set(http::field::host, "localhost");
+  req.set(http::field::accept_encoding, "gzip");
+  req.keep_alive(true);
+  http::write(stream, req);
+  http::response<http::string_body> res;
+  http::read(stream, buffer, res);
+  EXPECT_EQ(res.result(), http::status::ok);
+  EXPECT_EQ(res[http::field::content_type], "text/event-stream");
+  EXPECT_EQ(res[http::field::content_encoding], "");
+  auto const& body = res.body();
+  auto constexpr kFirst = std::string_view{"data: first\n\n"};
+  auto constexpr kLast = std::string_view{"event: done\ndata: last\n\n"};
+  ASSERT_GT(body.size(), kFirst.size() + kLast.size());
+  EXPECT_EQ(body.substr(0, kFirst.size()), kFirst);
+  EXPECT_EQ(body.substr(body.size() - kLast.size()), kLast);
+  auto const heartbeats =
+      body.substr(kFirst.size(), body.size() - kFirst.size() - kLast.size());
+  EXPECT_EQ(heartbeats.size() % 2, 0);
+  EXPECT_GE(heartbeats.size(), 2);
+  for (std::size_t i = 0; i < heartbeats.size(); i += 2) {
+    EXPECT_EQ(heartbeats.substr(i, 2), ":\n");
+  }
+
+  // The connection is reusable after the heartbeats.
+  http::write(stream, req);
+  res = {};
+  http::read(stream, buffer, res);
+  EXPECT_EQ(res.result(), http::status::ok);
+
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, FileResponse) {
+  auto const path = (std::filesystem::temp_directory_path() /
+                     ("framework_impl_test_" + std::to_string(std::rand())))
+                        .string();
+  // Use a file large enough to require multiple `sendfile()` calls.
+  std::string contents;
+  for (int i = 0; contents.size() < 4 * 1024 * 1024; ++i) {
+    contents += std::to_string(i) + "\n";
+  }
+  std::ofstream(path, std::ios::binary) << contents;
+
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto handler = [&path](functions::HttpRequest const& r) {
+    if (r.target() == "/range") {
+      return functions::HttpResponse{}.set_payload_file(path, 10, 20);
+    }
+    if (r.target() == "/missing") {
+      return functions::HttpResponse{}.set_payload_file(path + ".missing");
+    }
+    return functions::HttpResponse{}.set_payload_file(path);
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kTestArgc), kTestArgv,
+        functions::MakeFunction(functions::UserHttpFunction(handler)),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  EXPECT_THAT(HttpGetKeepAlive("localhost", port, {"/", "/range", "/"}),
+              ElementsAre(contents, contents.substr(10, 20), contents));
+  auto const missing = HttpGetResponse("localhost", port, "/missing");
+  EXPECT_EQ(missing.result(),
+            boost::beast::http::status::internal_server_error);
+
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+  std::remove(path.c_str());
+}
+
+TEST(FrameworkTest, Pipelining) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using tcp = boost::asio::ip::tcp;
+
+  char const* const argv[] = {"unused", "--port=0", "--threads=4",
+                              "--pipeline-depth=4"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto handler = [](functions::HttpRequest const& r) {
+    // The first requests take longer, their responses must still be first.
+    auto const delay = std::chrono::milliseconds(
+        r.target() == "/0" ? 600 : (r.target() == "/1" ? 300 : 0));
+    std::this_thread::sleep_for(delay);
+    return functions::HttpResponse{}.set_payload(r.target());
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv,
+        functions::MakeFunction(functions::UserHttpFunction(handler)),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  boost::asio::io_context ioc;
+  tcp::resolver resolver(ioc);
+  beast::tcp_stream stream(ioc);
+  stream.connect(resolver.resolve("localhost", port));
+  std::string requests;
+  for (auto const* target : {"/0", "/1", "/2"}) {
+    requests += std::string("GET ") + target +
+                " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  }
+  auto const start = std::chrono::steady_clock::now();
+  boost::asio::write(stream, boost::asio::buffer(requests));
+  beast::flat_buffer buffer;
+  std::vector<std::string> bodies;
+  for (int i = 0; i != 3; ++i) {
+    http::response<http::string_body> res;
+    http::read(stream, buffer, res);
+    EXPECT_TRUE(res.keep_alive());
+    bodies.push_back(std::move(res.body()));
+  }
+  auto const elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_THAT(bodies, ElementsAre("/0", "/1", "/2"));
+  // The handlers run concurrently.
+  EXPECT_LT(elapsed, std::chrono::milliseconds(900));
+
+  // The connection remains usable after the pipelined requests.
+  http::request<http::string_body> req{http::verb::get, "/3", 11};
+  req.set(http::field::host, "localhost");
+  http::write(stream, req);
+  http::response<http::string_body> res;
+  http::read(stream, buffer, res);
+  EXPECT_EQ(res.body(), "/3");
+  stream.socket().shutdown(tcp::socket::shutdown_both);
+
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, AsyncHttp) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using tcp = boost::asio::ip::tcp;
+
+  char const* const argv[] = {"unused", "--port=0", "--threads=1"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  std::mutex mu;
+  std::vector<std::thread> workers;
+  // Each request completes from a separate thread, the single server thread
+  // never blocks.
+  auto handler = [&](functions::HttpRequest r,
+                     functions::HttpResponseCallback done) {
+    std::lock_guard<std::mutex> lk(mu);
+    workers.emplace_back([r = std::move(r), done = std::move(done)] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(300));
+      done(functions::HttpResponse{}.set_payload(r.target()));
+    });
+  };
+  auto run = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv,
+        functions::MakeFunction(functions::UserHttpAsyncFunction(handler)),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  boost::asio::io_context ioc;
+  tcp::resolver resolver(ioc);
+  auto const endpoints = resolver.resolve("localhost", port);
+  std::vector<beast::tcp_stream> streams;
+  for (int i = 0; i != 3; ++i) {
+    streams.emplace_back(ioc);
+    streams.back().connect(endpoints);
+  }
+  auto const start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i != streams.size(); ++i) {
+    http::request<http::string_body> req{http::verb::get,
+                                         "/" + std::to_string(i), 11};
+    req.set(http::field::host, "localhost");
+    http::write(streams[i], req);
+  }
+  for (std::size_t i = 0; i != streams.size(); ++i) {
+    beast::flat_buffer buffer;
+    http::response<http::string_body> res;
+    http::read(streams[i], buffer, res);
+    EXPECT_EQ(res.result(), http::status::ok);
+    EXPECT_EQ(res.body(), "/" + std::to_string(i));
+    EXPECT_TRUE(res.keep_alive());
+  }
+  auto const elapsed = std::chrono::steady_clock::now() - start;
+  // The requests are in progress at the same time.
+  EXPECT_LT(elapsed, std::chrono::milliseconds(850));
+  for (auto& s : streams) s.socket().shutdown(tcp::socket::shutdown_both);
+
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(run.get(), 0);
+  for (auto& w : workers) w.join();
+}
+
+TEST(FrameworkTest, Cancellation) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using tcp = boost::asio::ip::tcp;
+
+  char const* const argv[] = {"unused", "--port=0", "--threads=2",
+                              "--request-deadline=30"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  std::promise<void> cancelled;
+  std::mutex mu;
+  functions::HttpResponseCallback pending;
+  auto handler = [&](functions::HttpRequest r,
+                     functions::HttpResponseCallback done) {
+    auto token = r.cancellation_token();
+    if (r.target() == "/deadline") {
+      auto const deadline = token.deadline();
+      while (!token.cancelled()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      }
+      auto const remaining = deadline.value_or(
+                                 std::chrono::steady_clock::time_point{}) -
+                             std::chrono::steady_clock::now();
+      return done(functions::HttpResponse{}.set_payload(
+          remaining < std::chrono::seconds(1) ? "expired" : "unexpected"));
+    }
+    if (r.target() != "/disconnect") return done(functions::HttpResponse{});
+    {
+      std::lock_guard<std::mutex> lk(mu);
+      pending = std::move(done);
+    }
+    token.on_cancel([&cancelled] { cancelled.set_value(); });
+  };
+  auto run = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv,
+        functions::MakeFunction(functions::UserHttpAsyncFunction(handler)),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  boost::asio::io_context ioc;
+  tcp::resolver resolver(ioc);
+  auto const endpoints = resolver.resolve("localhost", port);
+  // The header shortens the deadline set by `--request-deadline`.
+  beast::tcp_stream stream(ioc);
+  stream.connect(endpoints);
+  http::request<http::string_body> req{http::verb::get, "/deadline", 11};
+  req.set(http::field::host, "localhost");
+  req.set("x-server-timeout", "0.05");
+  http::write(stream, req);
+  beast::flat_buffer buffer;
+  http::response<http::string_body> res;
+  http::read(stream, buffer, res);
+  EXPECT_EQ(res.body(), "expired");
+  stream.socket().shutdown(tcp::socket::shutdown_both);
+
+  // Closing the connection cancels the request in progress.
+  beast::tcp_stream closed(ioc);
+  closed.connect(endpoints);
+  req.target("/disconnect");
+  req.erase("x-server-timeout");
+  http::write(closed, req);
+  closed.socket().close();
+  EXPECT_EQ(cancelled.get_future().wait_for(std::chrono::seconds(5)),
+            std::future_status::ready);
+  {
+    std::lock_guard<std::mutex> lk(mu);
+    if (pending) pending(functions::HttpResponse{});
+  }
+
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(run.get(), 0);
+}
+
+TEST(FrameworkTest, HttpClientUsesServerEventLoop) {
+  auto start = [](char const* const* argv, std::size_t argc,
+                  functions::Function function, std::atomic<bool>& shutdown) {
+    auto port_p = std::make_shared<std::promise<int>>();
+    auto port_f = port_p->get_future();
+    auto run = std::async(
+        std::launch::async, [argv, argc, function, &shutdown, port_p] {
+          return RunForTest(
+              static_cast<int>(argc), argv, function,
+              [&shutdown]() { return shutdown.load(); },
+              [port_p](int port) { port_p->set_value(port); });
+        });
+    return std::make_pair(std::to_string(port_f.get()), std::move(run));
+  };
+  std::atomic<bool> backend_shutdown{false};
+  auto backend = start(
+      kTestArgv, kTestArgc,
+      functions::MakeFunction([](functions::HttpRequest const& r) {
+        return functions::HttpResponse{}.set_payload("backend " + r.target());
+      }),
+      backend_shutdown);
+
+  // The single server thread runs the function and the outbound call.
+  char const* const argv[] = {"unused", "--port=0", "--threads=1"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  functions::HttpClient client;
+  std::mutex mu;
+  std::vector<std::thread::id> threads;
+  auto handler = [&](functions::HttpRequest r,
+                     functions::HttpResponseCallback done) {
+    {
+      std::lock_guard<std::mutex> lk(mu);
+      threads.push_back(std::this_thread::get_id());
+    }
+    client.AsyncSend(
+        functions::HttpRequest{}.set_target("http://localhost:" +
+                                            backend.first + r.target()),
+        [&, done = std::move(done)](std::exception_ptr error,
+                                    functions::HttpResponse response) {
+          {
+            std::lock_guard<std::mutex> lk(mu);
+            threads.push_back(std::this_thread::get_id());
+          }
+          if (error) return done(functions::HttpResponse{}.set_result(502));
+          done(std::move(response));
+        });
+  };
+  std::atomic<bool> shutdown{false};
+  auto frontend = start(
+      argv, kArgc,
+      functions::MakeFunction(functions::UserHttpAsyncFunction(handler)),
+      shutdown);
+
+  for (int i = 0; i != 3; ++i) {
+    auto const target = "/" + std::to_string(i);
+    EXPECT_EQ(HttpGet("localhost", frontend.first, target),
+              "backend " + target);
+  }
+  EXPECT_EQ(client.idle_connections(), 1);
+  {
+    std::lock_guard<std::mutex> lk(mu);
+    ASSERT_EQ(threads.size(), 6);
+    EXPECT_THAT(threads, Each(threads.front()));
+  }
+
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", frontend.first, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(frontend.second.get(), 0);
+  backend_shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", backend.first, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(backend.second.get(), 0);
+}
+
+TEST(FrameworkTest, EventSinkDeliversBeforeResponse) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using tcp = boost::asio::ip::tcp;
+
+  // The destination accepts a single batch.
+  boost::asio::io_context ioc;
+  tcp::acceptor acceptor(
+      ioc, tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0));
+  auto batch = std::async(std::launch::async, [&acceptor] {
+    auto socket = acceptor.accept();
+    beast::flat_buffer buffer;
+    http::request<http::string_body> request;
+    http::read(socket, buffer, request);
+    http::response<http::string_body> response{http::status::ok, 11};
+    response.prepare_payload();
+    http::write(socket, response);
+    return request.body();
+  });
+  auto const url = "http://127.0.0.1:" +
+                   std::to_string(acceptor.local_endpoint().port()) + "/events";
+
+  // Only the end of the request sends the batch. With a single thread the
+  // function blocks the event loop until it is delivered.
+  functions::EventSinkOptions options;
+  options.max_batch_delay = std::chrono::hours(1);
+  functions::EventSink sink(options);
+  auto handler = [&](functions::HttpRequest const& request) {
+    if (request.target() != "/fan-out") return functions::HttpResponse{};
+    for (auto const* id : {"id-1", "id-2"}) {
+      sink.Emit(url, functions::CloudEvent(id, "//test", "com.example.test"));
+    }
+    return functions::HttpResponse{}.set_payload("ok");
+  };
+  char const* const argv[] = {"unused", "--port=0", "--threads=1"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv,
+        functions::MakeFunction(functions::UserHttpFunction(handler)),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  EXPECT_EQ(HttpGet("localhost", port, "/fan-out"), "ok");
+  ASSERT_EQ(batch.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+  auto const body = batch.get();
+  EXPECT_THAT(body, HasSubstr(R"("id":"id-1")"));
+  EXPECT_THAT(body, HasSubstr(R"("id":"id-2")"));
+  EXPECT_EQ(sink.pending(), 0);
+
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, Compression) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using tcp = boost::asio::ip::tcp;
+
+  char const* const argv[] = {"unused", "--port=0", "--compression"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto const payload = std::string(64 * 1024, 'a');
+  auto handler = [&payload](functions::HttpRequest const&) {
+    return functions::HttpResponse{}
+        .set_header("content-type", "text/plain")
+        .set_payload(payload);
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv,
+        functions::MakeFunction(functions::UserHttpFunction(handler)),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  boost::asio::io_context ioc;
+  tcp::resolver resolver(ioc);
+  beast::tcp_stream stream(ioc);
+  stream.connect(resolver.resolve("localhost", port));
+  beast::flat_buffer buffer;
+  for (auto const* encoding : {"gzip", "deflate"}) {
+    http::request<http::string_body> req{http::verb::get, "/", 11};
+    req.set(http::field::host, "localhost");
+    req.set(http::field::accept_encoding, encoding);
+    http::write(stream, req);
+    http::response<http::string_body> res;
+    http::read(stream, buffer, res);
+    EXPECT_EQ(res[http::field::content_encoding], encoding);
+    EXPECT_EQ(res[http::field::vary], "Accept-Encoding");
+    EXPECT_LT(res.body().size(), payload.size() / 10);
+  }
+  http::request<http::string_body> req{http::verb::get, "/", 11};
+  req.set(http::field::host, "localhost");
+  http::write(stream, req);
+  http::response<http::string_body> res;
+  http::read(stream, buffer, res);
+  EXPECT_EQ(res.count(http::field::content_encoding), 0);
+  EXPECT_EQ(res.body(), payload);
+  stream.socket().shutdown(tcp::socket::shutdown_both);
+
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, ConditionalRequests) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using tcp = boost::asio::ip::tcp;
+
+  char const* const argv[] = {"unused", "--port=0", "--conditional-requests",
+                              "--compression"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto const payload = std::string(64 * 1024, 'a');
+  auto handler = [&payload](functions::HttpRequest const&) {
+    return functions::HttpResponse{}
+        .set_header("content-type", "text/plain")
+        .set_payload(payload);
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv,
+        functions::MakeFunction(functions::UserHttpFunction(handler)),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  boost::asio::io_context ioc;
+  tcp::resolver resolver(ioc);
+  beast::tcp_stream stream(ioc);
+  stream.connect(resolver.resolve("localhost", port));
+  beast::flat_buffer buffer;
+  http::request<http::string_body> req{http::verb::get, "/", 11};
+  req.set(http::field::host, "localhost");
+  req.set(http::field::accept_encoding, "gzip");
+  http::write(stream, req);
+  http::response<http::string_body> res;
+  http::read(stream, buffer, res);
+  EXPECT_EQ(res.result(), http::status::ok);
+  // The entity tag describes the uncompressed payload.
+  auto const etag = std::string(res[http::field::etag]);
+  EXPECT_EQ(etag, MakeEntityTag(payload));
+
+  // The connection stays open after the 304 response.
+  for (int i = 0; i != 2; ++i) {
+    req.set(http::field::if_none_match, etag);
+    http::write(stream, req);
+    http::response<http::string_body> not_modified;
+    http::read(stream, buffer, not_modified);
+    EXPECT_EQ(not_modified.result(), http::status::not_modified);
+    EXPECT_EQ(not_modified[http::field::etag], etag);
+    EXPECT_TRUE(not_modified.body().empty());
+  }
+  stream.socket().shutdown(tcp::socket::shutdown_both);
+
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, RangeRequests) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using tcp = boost::asio::ip::tcp;
+
+  char const* const argv[] = {"unused", "--port=0", "--range-requests",
+                              "--compression"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto const payload = std::make_shared<std::string const>(64 * 1024, 'a');
+  auto handler = [&payload](functions::HttpRequest const&) {
+    return functions::HttpResponse{}
+        .set_header("content-type", "text/plain")
+        .set_payload_shared(payload);
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv,
+        functions::MakeFunction(functions::UserHttpFunction(handler)),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  boost::asio::io_context ioc;
+  tcp::resolver resolver(ioc);
+  beast::tcp_stream stream(ioc);
+  stream.connect(resolver.resolve("localhost", port));
+  beast::flat_buffer buffer;
+  http::request<http::string_body> req{http::verb::get, "/", 11};
+  req.set(http::field::host, "localhost");
+  req.set(http::field::accept_encoding, "gzip");
+  req.set(http::field::range, "bytes=100-199");
+  http::write(stream, req);
+  http::response<http::string_body> res;
+  http::read(stream, buffer, res);
+  EXPECT_EQ(res.result(), http::status::partial_content);
+  // The ranges refer to the uncompressed payload.
+  EXPECT_EQ(res.count(http::field::content_encoding), 0);
+  EXPECT_EQ(res[http::field::content_range], "bytes 100-199/65536");
+  EXPECT_EQ(res.body(), std::string(100, 'a'));
+
+  req.set(http::field::range, "bytes=70000-");
+  http::write(stream, req);
+  http::response<http::string_body> not_satisfiable;
+  http::read(stream, buffer, not_satisfiable);
+  EXPECT_EQ(not_satisfiable.result(), http::status::range_not_satisfiable);
+  EXPECT_EQ(not_satisfiable[http::field::content_range], "bytes */65536");
+  stream.socket().shutdown(tcp::socket::shutdown_both);
+
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, RequestDecompression) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using tcp = boost::asio::ip::tcp;
+
+  char const* const argv[] = {"unused", "--port=0",
+                              "--max-decompressed-size=65536"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto handler = [](functions::HttpRequest const& r) {
+    return functions::HttpResponse{}.set_payload(r.payload());
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv,
+        functions::MakeFunction(functions::UserHttpFunction(handler)),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  boost::asio::io_context ioc;
+  tcp::resolver resolver(ioc);
+  beast::tcp_stream stream(ioc);
+  stream.connect(resolver.resolve("localhost", port));
+  beast::flat_buffer buffer;
+  auto post = [&](std::string const& payload) {
+    http::request<http::string_body> req{http::verb::post, "/", 11};
+    req.set(http::field::host, "localhost");
+    req.set(http::field::content_encoding, "gzip");
+    req.body() =
+        MakeCompressor(ContentEncoding::kGzip)->Compress(payload, true);
+    req.prepare_payload();
+    http::write(stream, req);
+    http::response<http::string_body> res;
+    http::read(stream, buffer, res);
+    return res;
+  };
+  auto const payload = std::string(32 * 1024, 'a');
+  auto res = post(payload);
+  EXPECT_EQ(res.result_int(), 200);
+  EXPECT_EQ(res.body(), payload);
+  res = post(std::string(128 * 1024, 'a'));
+  EXPECT_EQ(res.result_int(), 413);
+  stream.socket().shutdown(tcp::socket::shutdown_both);
+
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, ExpectContinue) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using tcp = boost::asio::ip::tcp;
+
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto handler = [](functions::HttpRequest const& r) {
+    return functions::HttpResponse{}.set_payload(r.payload());
+  };
+  auto precheck = [](functions::HttpRequest const& r)
+      -> std::optional<functions::HttpResponse> {
+    if (r.headers().count("x-reject") == 0) return std::nullopt;
+    return functions::HttpResponse{}.set_result(
+        functions::HttpResponse::kForbidden);
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        kTestArgc, kTestArgv,
+        functions::WithPrecheck(
+            functions::MakeFunction(functions::UserHttpFunction(handler)),
+            precheck),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  boost::asio::io_context ioc;
+  tcp::resolver resolver(ioc);
+  auto connect = [&] {
+    tcp::socket socket(ioc);
+    boost::asio::connect(socket, resolver.resolve("localhost", port));
+    return socket;
+  };
+  auto send_header = [](tcp::socket& socket, std::string const& extra) {
+    std::string const header =
+        "POST / HTTP/1.1\r\nHost: localhost\r\nContent-Length: 4\r\n" +
+        extra + "\r\n";
+    boost::asio::write(socket, boost::asio::buffer(header));
+  };
+
+  // The server asks for the body once the request passes the checks.
+  auto socket = connect();
+  send_header(socket, "Expect: 100-continue\r\n");
+  beast::flat_buffer buffer;
+  http::response<http::empty_body> interim;
+  http::read(socket, buffer, interim);
+  EXPECT_EQ(interim.result(), http::status::continue_);
+  boost::asio::write(socket, boost::asio::buffer(std::string("body")));
+  http::response<http::string_body> res;
+  http::read(socket, buffer, res);
+  EXPECT_EQ(res.result(), http::status::ok);
+  EXPECT_EQ(res.body(), "body");
+
+  // Rejected requests get the response without sending the body.
+  socket = connect();
+  send_header(socket, "Expect: 100-continue\r\nx-reject: yes\r\n");
+  buffer.clear();
+  res = {};
+  http::read(socket, buffer, res);
+  EXPECT_EQ(res.result(), http::status::forbidden);
+  EXPECT_FALSE(res.keep_alive());
+
+  // The precheck also applies without `Expect: 100-continue`.
+  socket = connect();
+  send_header(socket, "x-reject: yes\r\n");
+  buffer.clear();
+  res = {};
+  http::read(socket, buffer, res);
+  EXPECT_EQ(res.result(), http::status::forbidden);
+
+  socket = connect();
+  send_header(socket, "Expect: something-else\r\n");
+  buffer.clear();
+  res = {};
+  http::read(socket, buffer, res);
+  EXPECT_EQ(res.result(), http::status::expectation_failed);
+
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+TEST(FrameworkTest, StaticRoutes) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using tcp = boost::asio::ip::tcp;
+
+  char const* const argv[] = {"unused", "--port=0", "--pipeline-depth=2",
+                              "--static-route=/healthz=200:ok"};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  std::atomic<int> calls{0};
+  auto handler = [&calls](functions::HttpRequest const& r) {
+    ++calls;
+    return functions::HttpResponse{}.set_payload(r.target());
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv,
+        functions::MakeFunction(functions::UserHttpFunction(handler)),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  auto const port = std::to_string(port_f.get());
+
+  boost::asio::io_context ioc;
+  tcp::resolver resolver(ioc);
+  tcp::socket socket(ioc);
+  boost::asio::connect(socket, resolver.resolve("localhost", port));
+  beast::flat_buffer buffer;
+  auto read = [&] {
+    http::response<http::string_body> res;
+    http::read(socket, buffer, res);
+    return res;
+  };
+  auto get = [](std::string const& target) {
+    return "GET " + target + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  };
+
+  // The static routes are answered without calling the function, and keep
+  // the connection open.
+  boost::asio::write(socket, boost::asio::buffer(get("/healthz?probe=1")));
+  auto res = read();
+  EXPECT_EQ(res.result(), http::status::ok);
+  EXPECT_EQ(res.body(), "ok");
+  EXPECT_TRUE(res.keep_alive());
+  boost::asio::write(socket, boost::asio::buffer(get("/favicon.ico")));
+  res = read();
+  EXPECT_EQ(res.result(), http::status::not_found);
+  EXPECT_EQ(calls.load(), 0);
+
+  // Pipelined requests are answered in order.
+  boost::asio::write(socket, boost::asio::buffer(get("/a") + get("/healthz") +
+                                                 get("/b")));
+  for (auto const* expected : {"/a", "ok", "/b"}) {
+    res = read();
+    EXPECT_EQ(res.result(), http::status::ok);
+    EXPECT_EQ(res.body(), expected);
+  }
+  EXPECT_EQ(calls.load(), 2);
+
+  // The body is not read, and the connection is closed.
+  std::string const post =
+      "POST /healthz HTTP/1.1\r\nHost: localhost\r\nContent-Length: 4\r\n"
+      "\r\n";
+  boost::asio::write(socket, boost::asio::buffer(post));
+  res = read();
+  EXPECT_EQ(res.body(), "ok");
+  EXPECT_FALSE(res.keep_alive());
+  EXPECT_EQ(calls.load(), 2);
+
+  shutdown.store(true);
+  try {
+    (void)HttpGet("localhost", port, "/quit/now");
+  } catch (...) {
+  }
+  EXPECT_EQ(done.get(), 0);
+}
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+TEST(FrameworkTest, UnixSocket) {
+  namespace beast = boost::beast;
+  namespace http = beast::http;
+  using local = boost::asio::local::stream_protocol;
+
+  auto const path = (std::filesystem::temp_directory_path() /
+                     ("framework_impl_test_" + std::to_string(std::rand()) +
+                      ".sock"))
+                        .string();
+  // A stale socket is replaced.
+  boost::asio::io_context ioc;
+  {
+    local::acceptor stale(ioc, local::endpoint(path));
+  }
+  auto const option = "--unix-socket=" + path;
+  char const* const argv[] = {"unused", option.c_str()};
+  auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+  std::promise<int> port_p;
+  auto port_f = port_p.get_future();
+  std::atomic<bool> shutdown{false};
+  auto handler = [](functions::HttpRequest const& r) {
+    return functions::HttpResponse{}.set_payload(r.target());
+  };
+  auto done = std::async(std::launch::async, [&] {
+    return RunForTest(
+        static_cast<int>(kArgc), argv,
+        functions::MakeFunction(functions::UserHttpFunction(handler)),
+        [&shutdown]() { return shutdown.load(); },
+        [&port_p](int port) mutable { port_p.set_value(port); });
+  });
+  EXPECT_EQ(port_f.get(), 0);
+
+  beast::basic_stream<local> stream(ioc);
+  stream.connect(local::endpoint(path));
+  beast::flat_buffer buffer;
+  for (auto const* target : {"/a", "/b"}) {
+    http::request<http::string_body> req{http::verb::get, target, 11};
+    req.set(http::field::host, "localhost");
+    http::write(stream, req);
+    http::response<http::string_body> res;
+    http::read(stream, buffer, res);
+    EXPECT_EQ(res.result(), http::status::ok);
+    EXPECT_EQ(res.body(), target);
+  }
+  stream.close();
+
+  // The server checks for shutdown requests after each connection.
+  shutdown.store(true);
+  local::socket socket(ioc);
+  socket.connect(local::endpoint(path));
+  EXPECT_EQ(done.get(), 0);
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+#endif  // BOOST_ASIO_HAS_LOCAL_SOCKETS
+
 TEST(FrameworkTest, HttpInvalidPort) {
   auto const exit_code = ::google::cloud::functions::Run(
       kTestInvalidArgc, kTestInvalidArgv, functions::UserHttpFunction{});
@@ -14,10 +14,113 @@
 
 #include "google/cloud/functions/internal/function_impl.h"
 #include "google/cloud/functions/internal/call_user_function.h"
+#include "google/cloud/functions/internal/cancellation.h"
+#include "google/cloud/functions/internal/coalescing.h"
+#include "google/cloud/functions/internal/conditional.h"
+#include "google/cloud/functions/internal/cpu_limits.h"
+#include "google/cloud/functions/internal/event_age.h"
+#include "google/cloud/functions/internal/event_sink.h"
+#include "google/cloud/functions/internal/rate_limiter.h"
+#include "google/cloud/functions/internal/request_timing.h"
+#include "google/cloud/functions/internal/response_cache.h"
+#include "google/cloud/functions/internal/tracing.h"
 #include "google/cloud/functions/function.h"
+#include <boost/asio/post.hpp>
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+/// Calls @p handler and blocks until it completes.
+Handler MakeBlockingHandler(AsyncHandler handler) {
+  return [handler = std::move(handler)](BeastRequest request) {
+    auto p = std::make_shared<std::promise<BeastResponse>>();
+    auto result = p->get_future();
+    handler(std::move(request),
+            [p](BeastResponse response) { p->set_value(std::move(response)); });
+    return result.get();
+  };
+}
+
+void RunWarmup(std::vector<WarmupHandler> const& warmups) {
+  if (warmups.empty()) return;
+  std::vector<std::exception_ptr> errors(warmups.size());
+  auto run = [&](std::size_t i) {
+    try {
+      warmups[i]();
+    } catch (...) {
+      errors[i] = std::current_exception();
+    }
+  };
+  std::vector<std::thread> workers;
+  for (std::size_t i = 1; i < warmups.size(); ++i) workers.emplace_back(run, i);
+  run(0);
+  for (auto& t : workers) t.join();
+  for (auto const& e : errors) {
+    if (e) std::rethrow_exception(e);
+  }
+}
+
+namespace {
+/**
+ * Runs @p handler in @p pool, and then calls the callback in that thread.
+ *
+ * The tasks refer to the pool with a raw pointer: the pool must not be
+ * released, and joined, by one of its own threads.
+ */
+AsyncHandler MakePoolAsyncHandler(boost::asio::thread_pool* pool,
+                                  Handler handler) {
+  return [pool, handler = std::move(handler)](BeastRequest request,
+                                              AsyncResponseCallback done) {
+    auto task = [handler, request = std::move(request), done = std::move(done),
+                 cancellation = CurrentCancellation(),
+                 max_event_age = CurrentMaxEventAge(),
+                 emissions = CurrentEmissionTracker()]() mutable {
+      ScopedCancellation scoped(cancellation.get());
+      ScopedMaxEventAge age(max_event_age);
+      ScopedEmissions tracked(emissions);
+      done(handler(std::move(request)));
+    };
+    boost::asio::post(*pool, std::move(task));
+  };
+}
+
+boost::asio::thread_pool& DefaultOffloadPool() {
+  // Never destroyed, its threads may still run when the process exits.
+  static auto* const kPool =
+      new boost::asio::thread_pool(DefaultConcurrency());
+  return *kPool;
+}
+
+BeastResponse RouteNotFound() {
+  BeastResponse response;
+  response.result(boost::beast::http::status::not_found);
+  return response;
+}
+
+std::string_view Method(BeastRequest const& request) {
+  auto const m = request.method_string();
+  return {m.data(), m.size()};
+}
+
+/// Returns the last element of a comma-separated header value, trimmed.
+std::string_view LastListElement(std::string_view value) {
+  if (auto const p = value.rfind(','); p != std::string_view::npos) {
+    value.remove_prefix(p + 1);
+  }
+  auto const b = value.find_first_not_of(" \t");
+  if (b == std::string_view::npos) return {};
+  return value.substr(b, value.find_last_not_of(" \t") - b + 1);
+}
+}  // namespace
 
 std::shared_ptr<FunctionImpl> FunctionImpl::GetImpl(
     functions::Function const& fun) {
@@ -34,27 +137,929 @@ BaseFunctionImpl::BaseFunctionImpl(functions::UserHttpFunction function)
         return CallUserFunction(fun, std::move(request));
       }) {}
 
-BaseFunctionImpl::BaseFunctionImpl(functions::UserCloudEventFunction function)
-    : handler_([fun = std::move(function)](BeastRequest const& request) {
-        return CallUserFunction(fun, request);
+BaseFunctionImpl::BaseFunctionImpl(Handler function)
+    : handler_([fun = std::move(function)](BeastRequest request) {
+        return CallUserRawFunction(fun, std::move(request));
+      }) {}
+
+BaseFunctionImpl::BaseFunctionImpl(
+    functions::UserHttpStreamingFunction function)
+    : handler_([function](BeastRequest request) {
+        return CallUserFunction(function, std::move(request));
+      }),
+      streaming_handler_([function](BeastRequest request,
+                                    functions::HttpRequestBodyReader& reader) {
+        return CallUserFunction(function, std::move(request), reader);
+      }) {}
+
+BaseFunctionImpl::BaseFunctionImpl(
+    functions::UserHttpStreamingResponseFunction function)
+    : handler_([function](BeastRequest request) {
+        return CallUserFunction(function, std::move(request));
+      }),
+      writer_handler_([function](BeastRequest request, ResponseWriter& writer) {
+        return CallUserFunction(function, std::move(request), writer);
+      }) {}
+
+BaseFunctionImpl::BaseFunctionImpl(std::shared_ptr<UserHttpCallable> function)
+    : handler_([fun = std::move(function)](BeastRequest request) {
+        return CallUserFunction(*fun, std::move(request));
       }) {}
 
+BaseFunctionImpl::BaseFunctionImpl(functions::UserHttpAsyncFunction function)
+    : async_handler_([function = std::move(function)](
+                         BeastRequest request, AsyncResponseCallback done) {
+        CallUserFunction(function, std::move(request), std::move(done));
+      }) {
+  handler_ = MakeBlockingHandler(async_handler_);
+}
+
 [[nodiscard]] Handler BaseFunctionImpl::GetHandler(
     std::string_view /*target*/) const {
   return handler_;
 }
 
+[[nodiscard]] StreamingHandler BaseFunctionImpl::GetStreamingHandler(
+    std::string_view /*target*/) const {
+  return streaming_handler_;
+}
+
+[[nodiscard]] WriterHandler BaseFunctionImpl::GetWriterHandler(
+    std::string_view /*target*/) const {
+  return writer_handler_;
+}
+
+[[nodiscard]] AsyncHandler BaseFunctionImpl::GetAsyncHandler(
+    std::string_view /*target*/) const {
+  return async_handler_;
+}
+
 MapFunctionImpl::MapFunctionImpl(
     std::map<std::string, functions::Function> mapping)
-    : mapping_(std::move(mapping)) {}
+    : mapping_(std::make_move_iterator(mapping.begin()),
+               std::make_move_iterator(mapping.end())) {}
+
+MapFunctionImpl::MapFunctionImpl(std::map<std::string, Factory> factories)
+    : factories_(std::make_move_iterator(factories.begin()),
+                 std::make_move_iterator(factories.end())) {}
 
 [[nodiscard]] Handler MapFunctionImpl::GetHandler(
     std::string_view target) const {
-  auto const l = mapping_.find(std::string(target));
-  if (l == mapping_.end()) {
+  return Find(target).GetHandler(target);
+}
+
+[[nodiscard]] StreamingHandler MapFunctionImpl::GetStreamingHandler(
+    std::string_view target) const {
+  return Find(target).GetStreamingHandler(target);
+}
+
+[[nodiscard]] WriterHandler MapFunctionImpl::GetWriterHandler(
+    std::string_view target) const {
+  return Find(target).GetWriterHandler(target);
+}
+
+[[nodiscard]] AsyncHandler MapFunctionImpl::GetAsyncHandler(
+    std::string_view target) const {
+  return Find(target).GetAsyncHandler(target);
+}
+
+[[nodiscard]] WebSocketHandler MapFunctionImpl::GetWebSocketHandler(
+    std::string_view target) const {
+  return Find(target).GetWebSocketHandler(target);
+}
+
+[[nodiscard]] PrecheckHandler MapFunctionImpl::GetPrecheckHandler(
+    std::string_view target) const {
+  return Find(target).GetPrecheckHandler(target);
+}
+
+[[nodiscard]] std::vector<WarmupHandler> MapFunctionImpl::GetWarmupHandlers(
+    std::string_view target) const {
+  return Find(target).GetWarmupHandlers(target);
+}
+
+[[nodiscard]] std::vector<ShutdownHandler>
+MapFunctionImpl::GetShutdownHandlers(std::string_view target) const {
+  return Find(target).GetShutdownHandlers(target);
+}
+
+[[nodiscard]] std::vector<CheckpointHandler>
+MapFunctionImpl::GetCheckpointHandlers(std::string_view target) const {
+  return Find(target).GetCheckpointHandlers(target);
+}
+
+FunctionImpl const& MapFunctionImpl::Find(std::string_view target) const {
+  std::lock_guard lk(mu_);
+  auto l = mapping_.find(target);
+  if (l != mapping_.end()) return *FunctionImpl::GetImpl(l->second);
+  auto const f = factories_.find(target);
+  if (f == factories_.end() || !f->second) {
     throw std::runtime_error("Function not found " + std::string(target));
   }
-  return FunctionImpl::GetImpl(l->second)->GetHandler(target);
+  // The elements of `mapping_` are never removed, the reference remains valid
+  // once the lock is released.
+  l = mapping_.emplace(std::string(target), f->second()).first;
+  return *FunctionImpl::GetImpl(l->second);
+}
+
+RouterFunctionImpl::RouterFunctionImpl(
+    std::vector<functions::FunctionRoute> routes) {
+  auto router = std::make_shared<PathRouter>();
+  for (auto& r : routes) {
+    router->Add(r.method, r.path_prefix, functions_.size());
+    functions_.push_back(FunctionImpl::GetImpl(r.function));
+    names_.push_back(r.method.empty() ? r.path_prefix
+                                      : r.method + " " + r.path_prefix);
+  }
+  router_ = std::move(router);
+}
+
+[[nodiscard]] Handler RouterFunctionImpl::GetHandler(
+    std::string_view target) const {
+  std::vector<Handler> handlers;
+  handlers.reserve(functions_.size());
+  for (auto const& f : functions_) handlers.push_back(f->GetHandler(target));
+  return [router = router_, names = names_,
+          handlers = std::move(handlers)](BeastRequest request) {
+    auto const route = router->Find(Method(request), request.target());
+    if (!route) return RouteNotFound();
+    SetRequestRoute(names[*route]);
+    return handlers[*route](std::move(request));
+  };
+}
+
+[[nodiscard]] AsyncHandler RouterFunctionImpl::GetAsyncHandler(
+    std::string_view target) const {
+  std::vector<AsyncHandler> async_handlers;
+  std::vector<Handler> handlers;
+  async_handlers.reserve(functions_.size());
+  handlers.reserve(functions_.size());
+  for (auto const& f : functions_) {
+    async_handlers.push_back(f->GetAsyncHandler(target));
+    handlers.push_back(f->GetHandler(target));
+  }
+  auto const has_async =
+      std::any_of(async_handlers.begin(), async_handlers.end(),
+                  [](auto const& h) { return static_cast<bool>(h); });
+  if (!has_async) return {};
+  // Once any route is asynchronous the server uses this handler for all the
+  // requests. The synchronous routes run in place, in the server thread that
+  // received the request.
+  return [router = router_, names = names_,
+          async_handlers = std::move(async_handlers),
+          handlers = std::move(handlers)](BeastRequest request,
+                                          AsyncResponseCallback done) {
+    auto const route = router->Find(Method(request), request.target());
+    if (!route) return done(RouteNotFound());
+    SetRequestRoute(names[*route]);
+    if (auto const& async = async_handlers[*route]) {
+      return async(std::move(request), std::move(done));
+    }
+    done(handlers[*route](std::move(request)));
+  };
+}
+
+[[nodiscard]] WebSocketHandler RouterFunctionImpl::GetWebSocketHandler(
+    std::string_view target) const {
+  std::vector<WebSocketHandler> websocket_handlers;
+  std::vector<Handler> handlers;
+  websocket_handlers.reserve(functions_.size());
+  handlers.reserve(functions_.size());
+  for (auto const& f : functions_) {
+    websocket_handlers.push_back(f->GetWebSocketHandler(target));
+    handlers.push_back(f->GetHandler(target));
+  }
+  auto const has_websocket =
+      std::any_of(websocket_handlers.begin(), websocket_handlers.end(),
+                  [](auto const& h) { return static_cast<bool>(h); });
+  if (!has_websocket) return {};
+  // The upgrade requests for routes without WebSocket support get the
+  // response of the route, and the connection is closed.
+  return [router = router_, websocket_handlers = std::move(websocket_handlers),
+          handlers = std::move(handlers)](
+             BeastRequest const& request,
+             std::shared_ptr<functions::WebSocket> socket,
+             functions::WebSocketCallbacks& callbacks)
+             -> std::optional<BeastResponse> {
+    auto const route = router->Find(Method(request), request.target());
+    if (!route) return RouteNotFound();
+    if (auto const& websocket = websocket_handlers[*route]) {
+      return websocket(request, std::move(socket), callbacks);
+    }
+    return handlers[*route](BeastRequest(request));
+  };
+}
+
+[[nodiscard]] PrecheckHandler RouterFunctionImpl::GetPrecheckHandler(
+    std::string_view target) const {
+  // Unmatched requests are rejected before the body is read, so there is
+  // always a precheck.
+  std::vector<PrecheckHandler> prechecks;
+  prechecks.reserve(functions_.size());
+  for (auto const& f : functions_) {
+    prechecks.push_back(f->GetPrecheckHandler(target));
+  }
+  return [router = router_, prechecks = std::move(prechecks)](
+             BeastRequest const& request) -> std::optional<BeastResponse> {
+    auto const route = router->Find(Method(request), request.target());
+    if (!route) return RouteNotFound();
+    auto const& precheck = prechecks[*route];
+    if (!precheck) return std::nullopt;
+    return precheck(request);
+  };
+}
+
+[[nodiscard]] std::vector<WarmupHandler> RouterFunctionImpl::GetWarmupHandlers(
+    std::string_view target) const {
+  // All the routes must be ready before any request is accepted.
+  std::vector<WarmupHandler> warmups;
+  for (auto const& f : functions_) {
+    auto w = f->GetWarmupHandlers(target);
+    std::move(w.begin(), w.end(), std::back_inserter(warmups));
+  }
+  return warmups;
+}
+
+[[nodiscard]] std::vector<ShutdownHandler>
+RouterFunctionImpl::GetShutdownHandlers(std::string_view target) const {
+  std::vector<ShutdownHandler> handlers;
+  for (auto const& f : functions_) {
+    auto h = f->GetShutdownHandlers(target);
+    std::move(h.begin(), h.end(), std::back_inserter(handlers));
+  }
+  return handlers;
+}
+
+[[nodiscard]] std::vector<CheckpointHandler>
+RouterFunctionImpl::GetCheckpointHandlers(std::string_view target) const {
+  std::vector<CheckpointHandler> handlers;
+  for (auto const& f : functions_) {
+    auto h = f->GetCheckpointHandlers(target);
+    std::move(h.begin(), h.end(), std::back_inserter(handlers));
+  }
+  return handlers;
+}
+
+ConcurrencyLimitFunctionImpl::ConcurrencyLimitFunctionImpl(
+    std::shared_ptr<FunctionImpl> impl,
+    functions::ConcurrencyLimitOptions options)
+    : impl_(std::move(impl)),
+      max_concurrency_(std::max<std::size_t>(options.max_concurrency, 1)),
+      classifier_(std::move(options.classifier)) {
+  for (auto w : options.lane_weights) {
+    if (w > 0) continue;
+    throw std::invalid_argument("lane weights must be greater than 0");
+  }
+  auto initial = max_concurrency_;
+  if (options.adaptive) {
+    if (options.min_concurrency > max_concurrency_) {
+      throw std::invalid_argument(
+          "min_concurrency must not be greater than max_concurrency");
+    }
+    adaptive_ = std::make_shared<AdaptiveConcurrency>(options.min_concurrency,
+                                                      max_concurrency_);
+    initial = adaptive_->limit();
+  }
+  limiter_ = std::make_shared<ConcurrencyLimiter>(initial, options.max_queue,
+                                                  options.lane_weights);
+  rejected_.result(boost::beast::http::status::service_unavailable);
+  rejected_.set(boost::beast::http::field::retry_after,
+                std::to_string(options.retry_after.count()));
+}
+
+[[nodiscard]] Handler ConcurrencyLimitFunctionImpl::GetHandler(
+    std::string_view target) const {
+  return MakeBlockingHandler(GetAsyncHandler(target));
+}
+
+[[nodiscard]] AsyncHandler ConcurrencyLimitFunctionImpl::GetAsyncHandler(
+    std::string_view target) const {
+  auto start = impl_->GetAsyncHandler(target);
+  if (!start) {
+    // Synchronous functions run in a dedicated pool, sized to the limit.
+    std::call_once(pool_once_, [this] {
+      pool_ = std::make_shared<boost::asio::thread_pool>(max_concurrency_);
+    });
+    start = MakePoolAsyncHandler(pool_.get(), impl_->GetHandler(target));
+  }
+  return [limiter = limiter_, adaptive = adaptive_, pool = pool_,
+          rejected = rejected_, classifier = classifier_,
+          start = std::move(start)](BeastRequest request,
+                                    AsyncResponseCallback done) {
+    auto const lane = classifier ? CallUserClassifier(classifier, request) : 0;
+    // Rejected requests still need their callback, share it with the task.
+    struct Call {
+      BeastRequest request;
+      AsyncResponseCallback done;
+    };
+    auto call =
+        std::make_shared<Call>(Call{std::move(request), std::move(done)});
+    // The task may start in the thread completing another request.
+    auto task = [limiter, adaptive, start, call,
+                 cancellation = CurrentCancellation(),
+                 max_event_age = CurrentMaxEventAge(),
+                 emissions = CurrentEmissionTracker()]() mutable {
+      ScopedCancellation scoped(cancellation.get());
+      ScopedMaxEventAge age(max_event_age);
+      ScopedEmissions tracked(emissions);
+      auto const started = std::chrono::steady_clock::now();
+      start(std::move(call->request),
+            [limiter, adaptive, call, started](BeastResponse response) {
+              if (adaptive) {
+                // The time waiting in the queue is not part of the latency.
+                adaptive->Sample(std::chrono::steady_clock::now() - started,
+                                 limiter->running());
+                limiter->SetMaxConcurrency(adaptive->limit());
+              }
+              call->done(std::move(response));
+              limiter->Done();
+            });
+    };
+    if (!limiter->Submit(std::move(task), lane)) call->done(rejected);
+  };
+}
+
+[[nodiscard]] WebSocketHandler
+ConcurrencyLimitFunctionImpl::GetWebSocketHandler(
+    std::string_view target) const {
+  return impl_->GetWebSocketHandler(target);
+}
+
+[[nodiscard]] PrecheckHandler ConcurrencyLimitFunctionImpl::GetPrecheckHandler(
+    std::string_view target) const {
+  // Reject requests that would not fit in the queue before reading the body.
+  return [limiter = limiter_, rejected = rejected_, classifier = classifier_,
+          precheck = impl_->GetPrecheckHandler(target)](
+             BeastRequest const& request) -> std::optional<BeastResponse> {
+    auto const lane = classifier ? CallUserClassifier(classifier, request) : 0;
+    if (limiter->Full(lane)) return rejected;
+    if (!precheck) return std::nullopt;
+    return precheck(request);
+  };
+}
+
+[[nodiscard]] std::vector<WarmupHandler>
+ConcurrencyLimitFunctionImpl::GetWarmupHandlers(std::string_view target) const {
+  return impl_->GetWarmupHandlers(target);
+}
+
+[[nodiscard]] std::vector<ShutdownHandler>
+ConcurrencyLimitFunctionImpl::GetShutdownHandlers(
+    std::string_view target) const {
+  return impl_->GetShutdownHandlers(target);
+}
+
+[[nodiscard]] std::vector<CheckpointHandler>
+ConcurrencyLimitFunctionImpl::GetCheckpointHandlers(
+    std::string_view target) const {
+  return impl_->GetCheckpointHandlers(target);
+}
+
+OffloadFunctionImpl::OffloadFunctionImpl(std::shared_ptr<FunctionImpl> impl,
+                                         functions::OffloadOptions options)
+    : impl_(std::move(impl)) {
+  if (options.threads != 0) {
+    pool_ = std::make_shared<boost::asio::thread_pool>(options.threads);
+  }
+}
+
+[[nodiscard]] Handler OffloadFunctionImpl::GetHandler(
+    std::string_view target) const {
+  if (impl_->GetAsyncHandler(target)) return impl_->GetHandler(target);
+  return MakeBlockingHandler(GetAsyncHandler(target));
+}
+
+[[nodiscard]] StreamingHandler OffloadFunctionImpl::GetStreamingHandler(
+    std::string_view target) const {
+  return impl_->GetStreamingHandler(target);
+}
+
+[[nodiscard]] WriterHandler OffloadFunctionImpl::GetWriterHandler(
+    std::string_view target) const {
+  return impl_->GetWriterHandler(target);
+}
+
+[[nodiscard]] AsyncHandler OffloadFunctionImpl::GetAsyncHandler(
+    std::string_view target) const {
+  if (auto async = impl_->GetAsyncHandler(target)) return async;
+  // Streaming functions already run in the streaming pool.
+  if (impl_->GetStreamingHandler(target) || impl_->GetWriterHandler(target)) {
+    return {};
+  }
+  auto handler = impl_->GetHandler(target);
+  if (!pool_) return MakePoolAsyncHandler(&DefaultOffloadPool(), handler);
+  // Keep the dedicated pool alive while the handler is in use.
+  return [pool = pool_, start = MakePoolAsyncHandler(pool_.get(), handler)](
+             BeastRequest request, AsyncResponseCallback done) {
+    start(std::move(request), std::move(done));
+  };
+}
+
+[[nodiscard]] WebSocketHandler OffloadFunctionImpl::GetWebSocketHandler(
+    std::string_view target) const {
+  return impl_->GetWebSocketHandler(target);
+}
+
+[[nodiscard]] PrecheckHandler OffloadFunctionImpl::GetPrecheckHandler(
+    std::string_view target) const {
+  return impl_->GetPrecheckHandler(target);
+}
+
+[[nodiscard]] std::vector<WarmupHandler> OffloadFunctionImpl::GetWarmupHandlers(
+    std::string_view target) const {
+  return impl_->GetWarmupHandlers(target);
+}
+
+[[nodiscard]] std::vector<ShutdownHandler>
+OffloadFunctionImpl::GetShutdownHandlers(std::string_view target) const {
+  return impl_->GetShutdownHandlers(target);
+}
+
+[[nodiscard]] std::vector<CheckpointHandler>
+OffloadFunctionImpl::GetCheckpointHandlers(std::string_view target) const {
+  return impl_->GetCheckpointHandlers(target);
+}
+
+LifecycleFunctionImpl::LifecycleFunctionImpl(
+    std::shared_ptr<FunctionImpl> impl, WarmupHandler warmup,
+    ShutdownHandler shutdown, CheckpointHandler checkpoint)
+    : impl_(std::move(impl)),
+      warmup_(std::move(warmup)),
+      shutdown_(std::move(shutdown)),
+      checkpoint_(std::move(checkpoint)) {}
+
+[[nodiscard]] Handler LifecycleFunctionImpl::GetHandler(
+    std::string_view target) const {
+  return impl_->GetHandler(target);
+}
+
+[[nodiscard]] StreamingHandler LifecycleFunctionImpl::GetStreamingHandler(
+    std::string_view target) const {
+  return impl_->GetStreamingHandler(target);
+}
+
+[[nodiscard]] WriterHandler LifecycleFunctionImpl::GetWriterHandler(
+    std::string_view target) const {
+  return impl_->GetWriterHandler(target);
+}
+
+[[nodiscard]] AsyncHandler LifecycleFunctionImpl::GetAsyncHandler(
+    std::string_view target) const {
+  return impl_->GetAsyncHandler(target);
+}
+
+[[nodiscard]] WebSocketHandler LifecycleFunctionImpl::GetWebSocketHandler(
+    std::string_view target) const {
+  return impl_->GetWebSocketHandler(target);
+}
+
+[[nodiscard]] PrecheckHandler LifecycleFunctionImpl::GetPrecheckHandler(
+    std::string_view target) const {
+  return impl_->GetPrecheckHandler(target);
+}
+
+[[nodiscard]] std::vector<WarmupHandler>
+LifecycleFunctionImpl::GetWarmupHandlers(std::string_view target) const {
+  auto warmups = impl_->GetWarmupHandlers(target);
+  if (warmup_) warmups.push_back(warmup_);
+  return warmups;
+}
+
+[[nodiscard]] std::vector<ShutdownHandler>
+LifecycleFunctionImpl::GetShutdownHandlers(std::string_view target) const {
+  auto handlers = impl_->GetShutdownHandlers(target);
+  if (shutdown_) handlers.push_back(shutdown_);
+  return handlers;
+}
+
+[[nodiscard]] std::vector<CheckpointHandler>
+LifecycleFunctionImpl::GetCheckpointHandlers(std::string_view target) const {
+  auto handlers = impl_->GetCheckpointHandlers(target);
+  if (checkpoint_.before_checkpoint || checkpoint_.after_restore) {
+    handlers.push_back(checkpoint_);
+  }
+  return handlers;
+}
+
+PrecheckFunctionImpl::PrecheckFunctionImpl(
+    std::shared_ptr<FunctionImpl> impl,
+    functions::UserHttpPrecheckFunction precheck)
+    : impl_(std::move(impl)),
+      precheck_([fun = std::move(precheck)](BeastRequest const& request) {
+        return CallUserPrecheck(fun, request);
+      }) {}
+
+[[nodiscard]] Handler PrecheckFunctionImpl::GetHandler(
+    std::string_view target) const {
+  return impl_->GetHandler(target);
+}
+
+[[nodiscard]] StreamingHandler PrecheckFunctionImpl::GetStreamingHandler(
+    std::string_view target) const {
+  return impl_->GetStreamingHandler(target);
+}
+
+[[nodiscard]] WriterHandler PrecheckFunctionImpl::GetWriterHandler(
+    std::string_view target) const {
+  return impl_->GetWriterHandler(target);
+}
+
+[[nodiscard]] AsyncHandler PrecheckFunctionImpl::GetAsyncHandler(
+    std::string_view target) const {
+  return impl_->GetAsyncHandler(target);
+}
+
+[[nodiscard]] WebSocketHandler PrecheckFunctionImpl::GetWebSocketHandler(
+    std::string_view target) const {
+  return impl_->GetWebSocketHandler(target);
+}
+
+[[nodiscard]] PrecheckHandler PrecheckFunctionImpl::GetPrecheckHandler(
+    std::string_view target) const {
+  auto inner = impl_->GetPrecheckHandler(target);
+  if (!inner) return precheck_;
+  // Both checks apply, the innermost runs first.
+  return [inner = std::move(inner), outer = precheck_](
+             BeastRequest const& request) -> std::optional<BeastResponse> {
+    if (auto response = inner(request)) return response;
+    return outer(request);
+  };
+}
+
+[[nodiscard]] std::vector<WarmupHandler>
+PrecheckFunctionImpl::GetWarmupHandlers(std::string_view target) const {
+  return impl_->GetWarmupHandlers(target);
+}
+
+[[nodiscard]] std::vector<ShutdownHandler>
+PrecheckFunctionImpl::GetShutdownHandlers(std::string_view target) const {
+  return impl_->GetShutdownHandlers(target);
+}
+
+[[nodiscard]] std::vector<CheckpointHandler>
+PrecheckFunctionImpl::GetCheckpointHandlers(std::string_view target) const {
+  return impl_->GetCheckpointHandlers(target);
+}
+
+ValidatorFunctionImpl::ValidatorFunctionImpl(
+    std::shared_ptr<FunctionImpl> impl,
+    functions::UserHttpValidatorFunction validator)
+    : impl_(std::move(impl)),
+      validator_([fun = std::move(validator)](BeastRequest const& request) {
+        return CallUserValidator(fun, request);
+      }) {}
+
+[[nodiscard]] Handler ValidatorFunctionImpl::GetHandler(
+    std::string_view target) const {
+  return MakeValidatorHandler(impl_->GetHandler(target), validator_);
+}
+
+[[nodiscard]] StreamingHandler ValidatorFunctionImpl::GetStreamingHandler(
+    std::string_view target) const {
+  auto handler = impl_->GetStreamingHandler(target);
+  if (!handler) return handler;
+  return MakeValidatorStreamingHandler(std::move(handler), validator_);
+}
+
+[[nodiscard]] WriterHandler ValidatorFunctionImpl::GetWriterHandler(
+    std::string_view target) const {
+  auto handler = impl_->GetWriterHandler(target);
+  if (!handler) return handler;
+  return MakeValidatorWriterHandler(std::move(handler), validator_);
+}
+
+[[nodiscard]] AsyncHandler ValidatorFunctionImpl::GetAsyncHandler(
+    std::string_view target) const {
+  auto handler = impl_->GetAsyncHandler(target);
+  if (!handler) return handler;
+  return MakeValidatorAsyncHandler(std::move(handler), validator_);
+}
+
+[[nodiscard]] WebSocketHandler ValidatorFunctionImpl::GetWebSocketHandler(
+    std::string_view target) const {
+  return impl_->GetWebSocketHandler(target);
+}
+
+[[nodiscard]] PrecheckHandler ValidatorFunctionImpl::GetPrecheckHandler(
+    std::string_view target) const {
+  return impl_->GetPrecheckHandler(target);
+}
+
+[[nodiscard]] std::vector<WarmupHandler>
+ValidatorFunctionImpl::GetWarmupHandlers(std::string_view target) const {
+  return impl_->GetWarmupHandlers(target);
+}
+
+[[nodiscard]] std::vector<ShutdownHandler>
+ValidatorFunctionImpl::GetShutdownHandlers(std::string_view target) const {
+  return impl_->GetShutdownHandlers(target);
+}
+
+[[nodiscard]] std::vector<CheckpointHandler>
+ValidatorFunctionImpl::GetCheckpointHandlers(std::string_view target) const {
+  return impl_->GetCheckpointHandlers(target);
+}
+
+CoalescingFunctionImpl::CoalescingFunctionImpl(
+    std::shared_ptr<FunctionImpl> impl, functions::CoalescingOptions options)
+    : impl_(std::move(impl)),
+      key_(MakeCoalescingKey(std::move(options.headers))),
+      coalescer_(std::make_shared<RequestCoalescer>()) {
+  if (!options.key) return;
+  key_ = [fun = std::move(options.key)](
+             BeastRequest const& request) -> std::optional<std::string> {
+    namespace http = ::boost::beast::http;
+    auto const method = request.method();
+    if (method != http::verb::get && method != http::verb::head) {
+      return std::nullopt;
+    }
+    auto key = CallUserCoalescingKey(fun, request);
+    if (!key) return std::nullopt;
+    return std::string(request.method_string()) + ' ' + *key;
+  };
+}
+
+[[nodiscard]] Handler CoalescingFunctionImpl::GetHandler(
+    std::string_view target) const {
+  return MakeCoalescingHandler(impl_->GetHandler(target), key_, coalescer_);
+}
+
+[[nodiscard]] AsyncHandler CoalescingFunctionImpl::GetAsyncHandler(
+    std::string_view target) const {
+  auto handler = impl_->GetAsyncHandler(target);
+  if (!handler) return handler;
+  return MakeCoalescingAsyncHandler(std::move(handler), key_, coalescer_);
+}
+
+[[nodiscard]] WebSocketHandler CoalescingFunctionImpl::GetWebSocketHandler(
+    std::string_view target) const {
+  return impl_->GetWebSocketHandler(target);
+}
+
+[[nodiscard]] PrecheckHandler CoalescingFunctionImpl::GetPrecheckHandler(
+    std::string_view target) const {
+  return impl_->GetPrecheckHandler(target);
+}
+
+[[nodiscard]] std::vector<WarmupHandler>
+CoalescingFunctionImpl::GetWarmupHandlers(std::string_view target) const {
+  return impl_->GetWarmupHandlers(target);
+}
+
+[[nodiscard]] std::vector<ShutdownHandler>
+CoalescingFunctionImpl::GetShutdownHandlers(std::string_view target) const {
+  return impl_->GetShutdownHandlers(target);
+}
+
+[[nodiscard]] std::vector<CheckpointHandler>
+CoalescingFunctionImpl::GetCheckpointHandlers(std::string_view target) const {
+  return impl_->GetCheckpointHandlers(target);
+}
+
+ResponseCacheFunctionImpl::ResponseCacheFunctionImpl(
+    std::shared_ptr<FunctionImpl> impl, functions::ResponseCacheOptions options)
+    : impl_(std::move(impl)),
+      headers_(std::move(options.headers)),
+      key_(MakeCoalescingKey(headers_)),
+      cache_(std::make_shared<ResponseCache>(options.max_bytes,
+                                             options.shards)) {}
+
+[[nodiscard]] Handler ResponseCacheFunctionImpl::GetHandler(
+    std::string_view target) const {
+  return MakeResponseCacheHandler(impl_->GetHandler(target), key_, headers_,
+                                  cache_);
+}
+
+[[nodiscard]] AsyncHandler ResponseCacheFunctionImpl::GetAsyncHandler(
+    std::string_view target) const {
+  auto handler = impl_->GetAsyncHandler(target);
+  if (!handler) return handler;
+  return MakeResponseCacheAsyncHandler(std::move(handler), key_, headers_,
+                                       cache_);
+}
+
+[[nodiscard]] WebSocketHandler ResponseCacheFunctionImpl::GetWebSocketHandler(
+    std::string_view target) const {
+  return impl_->GetWebSocketHandler(target);
+}
+
+[[nodiscard]] PrecheckHandler ResponseCacheFunctionImpl::GetPrecheckHandler(
+    std::string_view target) const {
+  return impl_->GetPrecheckHandler(target);
+}
+
+[[nodiscard]] std::vector<WarmupHandler>
+ResponseCacheFunctionImpl::GetWarmupHandlers(std::string_view target) const {
+  return impl_->GetWarmupHandlers(target);
+}
+
+[[nodiscard]] std::vector<ShutdownHandler>
+ResponseCacheFunctionImpl::GetShutdownHandlers(std::string_view target) const {
+  return impl_->GetShutdownHandlers(target);
+}
+
+[[nodiscard]] std::vector<CheckpointHandler>
+ResponseCacheFunctionImpl::GetCheckpointHandlers(
+    std::string_view target) const {
+  return impl_->GetCheckpointHandlers(target);
+}
+
+RateLimitFunctionImpl::RateLimitFunctionImpl(
+    std::shared_ptr<FunctionImpl> impl, functions::RateLimitOptions options)
+    : impl_(std::move(impl)),
+      header_(std::move(options.header)),
+      key_(std::move(options.key)),
+      limiter_(std::make_shared<RateLimiter>(options.requests_per_second,
+                                             options.burst,
+                                             options.max_clients)) {}
+
+[[nodiscard]] Handler RateLimitFunctionImpl::GetHandler(
+    std::string_view target) const {
+  return impl_->GetHandler(target);
+}
+
+[[nodiscard]] StreamingHandler RateLimitFunctionImpl::GetStreamingHandler(
+    std::string_view target) const {
+  return impl_->GetStreamingHandler(target);
+}
+
+[[nodiscard]] WriterHandler RateLimitFunctionImpl::GetWriterHandler(
+    std::string_view target) const {
+  return impl_->GetWriterHandler(target);
+}
+
+[[nodiscard]] AsyncHandler RateLimitFunctionImpl::GetAsyncHandler(
+    std::string_view target) const {
+  return impl_->GetAsyncHandler(target);
+}
+
+[[nodiscard]] WebSocketHandler RateLimitFunctionImpl::GetWebSocketHandler(
+    std::string_view target) const {
+  return impl_->GetWebSocketHandler(target);
+}
+
+[[nodiscard]] PrecheckHandler RateLimitFunctionImpl::GetPrecheckHandler(
+    std::string_view target) const {
+  // Reject requests over the limit before any other check, or reading the
+  // body.
+  return [limiter = limiter_, header = header_, key = key_,
+          precheck = impl_->GetPrecheckHandler(target)](
+             BeastRequest const& request) -> std::optional<BeastResponse> {
+    auto const retry_after = [&]() -> std::optional<std::chrono::seconds> {
+      if (key) {
+        auto const k = CallUserCoalescingKey(key, request);
+        if (!k) return std::nullopt;
+        return limiter->Acquire(*k);
+      }
+      // Proxies append the address of their peer, the last element of the
+      // last field is the only one set by a trusted proxy. Clients connected
+      // directly are identified by their address.
+      std::string_view value;
+      auto const range = request.equal_range(header);
+      for (auto f = range.first; f != range.second; ++f) {
+        value = std::string_view(f->value().data(), f->value().size());
+      }
+      auto const client = LastListElement(value);
+      return limiter->Acquire(client.empty() ? CurrentPeerAddress() : client);
+    }();
+    if (retry_after) {
+      BeastResponse rejected;
+      rejected.result(boost::beast::http::status::too_many_requests);
+      rejected.set(boost::beast::http::field::retry_after,
+                   std::to_string(retry_after->count()));
+      return rejected;
+    }
+    if (!precheck) return std::nullopt;
+    return precheck(request);
+  };
+}
+
+[[nodiscard]] std::vector<WarmupHandler>
+RateLimitFunctionImpl::GetWarmupHandlers(std::string_view target) const {
+  return impl_->GetWarmupHandlers(target);
+}
+
+[[nodiscard]] std::vector<ShutdownHandler>
+RateLimitFunctionImpl::GetShutdownHandlers(std::string_view target) const {
+  return impl_->GetShutdownHandlers(target);
+}
+
+[[nodiscard]] std::vector<CheckpointHandler>
+RateLimitFunctionImpl::GetCheckpointHandlers(std::string_view target) const {
+  return impl_->GetCheckpointHandlers(target);
+}
+
+TracingFunctionImpl::TracingFunctionImpl(
+    std::shared_ptr<FunctionImpl> impl,
+    std::shared_ptr<functions::SpanExporter> exporter)
+    : impl_(std::move(impl)), exporter_(std::move(exporter)) {}
+
+[[nodiscard]] Handler TracingFunctionImpl::GetHandler(
+    std::string_view target) const {
+  return MakeTracingHandler(impl_->GetHandler(target), exporter_);
+}
+
+[[nodiscard]] StreamingHandler TracingFunctionImpl::GetStreamingHandler(
+    std::string_view target) const {
+  auto handler = impl_->GetStreamingHandler(target);
+  if (!handler) return handler;
+  return MakeTracingStreamingHandler(std::move(handler), exporter_);
+}
+
+[[nodiscard]] WriterHandler TracingFunctionImpl::GetWriterHandler(
+    std::string_view target) const {
+  auto handler = impl_->GetWriterHandler(target);
+  if (!handler) return handler;
+  return MakeTracingWriterHandler(std::move(handler), exporter_);
+}
+
+[[nodiscard]] AsyncHandler TracingFunctionImpl::GetAsyncHandler(
+    std::string_view target) const {
+  auto handler = impl_->GetAsyncHandler(target);
+  if (!handler) return handler;
+  return MakeTracingAsyncHandler(std::move(handler), exporter_);
+}
+
+[[nodiscard]] WebSocketHandler TracingFunctionImpl::GetWebSocketHandler(
+    std::string_view target) const {
+  return impl_->GetWebSocketHandler(target);
+}
+
+[[nodiscard]] PrecheckHandler TracingFunctionImpl::GetPrecheckHandler(
+    std::string_view target) const {
+  return impl_->GetPrecheckHandler(target);
+}
+
+[[nodiscard]] std::vector<WarmupHandler>
+TracingFunctionImpl::GetWarmupHandlers(std::string_view target) const {
+  return impl_->GetWarmupHandlers(target);
+}
+
+[[nodiscard]] std::vector<ShutdownHandler>
+TracingFunctionImpl::GetShutdownHandlers(std::string_view target) const {
+  return impl_->GetShutdownHandlers(target);
+}
+
+[[nodiscard]] std::vector<CheckpointHandler>
+TracingFunctionImpl::GetCheckpointHandlers(std::string_view target) const {
+  return impl_->GetCheckpointHandlers(target);
+}
+
+WebSocketFunctionImpl::WebSocketFunctionImpl(
+    std::shared_ptr<FunctionImpl> impl,
+    functions::UserWebSocketFunction function)
+    : impl_(std::move(impl)),
+      websocket_([function = std::move(function)](
+                     BeastRequest const& request,
+                     std::shared_ptr<functions::WebSocket> socket,
+                     functions::WebSocketCallbacks& callbacks) {
+        return CallUserFunction(function, request, std::move(socket),
+                                callbacks);
+      }) {}
+
+[[nodiscard]] Handler WebSocketFunctionImpl::GetHandler(
+    std::string_view target) const {
+  return impl_->GetHandler(target);
+}
+
+[[nodiscard]] StreamingHandler WebSocketFunctionImpl::GetStreamingHandler(
+    std::string_view target) const {
+  return impl_->GetStreamingHandler(target);
+}
+
+[[nodiscard]] WriterHandler WebSocketFunctionImpl::GetWriterHandler(
+    std::string_view target) const {
+  return impl_->GetWriterHandler(target);
+}
+
+[[nodiscard]] AsyncHandler WebSocketFunctionImpl::GetAsyncHandler(
+    std::string_view target) const {
+  return impl_->GetAsyncHandler(target);
+}
+
+[[nodiscard]] WebSocketHandler WebSocketFunctionImpl::GetWebSocketHandler(
+    std::string_view /*target*/) const {
+  return websocket_;
+}
+
+[[nodiscard]] PrecheckHandler WebSocketFunctionImpl::GetPrecheckHandler(
+    std::string_view target) const {
+  return impl_->GetPrecheckHandler(target);
+}
+
+[[nodiscard]] std::vector<WarmupHandler>
+WebSocketFunctionImpl::GetWarmupHandlers(std::string_view target) const {
+  return impl_->GetWarmupHandlers(target);
+}
+
+[[nodiscard]] std::vector<ShutdownHandler>
+WebSocketFunctionImpl::GetShutdownHandlers(std::string_view target) const {
+  return impl_->GetShutdownHandlers(target);
+}
+
+[[nodiscard]] std::vector<CheckpointHandler>
+WebSocketFunctionImpl::GetCheckpointHandlers(std::string_view target) const {
+  return impl_->GetCheckpointHandlers(target);
 }
 
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
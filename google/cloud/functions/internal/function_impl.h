@@ -15,15 +15,29 @@
 #ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_FUNCTION_IMPL_H
 #define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_FUNCTION_IMPL_H
 
+#include "google/cloud/functions/internal/adaptive_concurrency.h"
+#include "google/cloud/functions/internal/concurrency_limiter.h"
 #include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/internal/path_router.h"
+#include "google/cloud/functions/internal/typed_function.h"
+#include "google/cloud/functions/trace_context.h"
 #include "google/cloud/functions/user_functions.h"
 #include "google/cloud/functions/version.h"
+#include <boost/asio/thread_pool.hpp>
+#include <chrono>
+#include <cstddef>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string_view>
+#include <vector>
 
 namespace google::cloud::functions {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 class Function;
+struct FunctionRoute;
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions
 
@@ -32,11 +46,172 @@ FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 
 using Handler = std::function<BeastResponse(BeastRequest)>;
 
+/// Handlers for functions that read the request body incrementally.
+using StreamingHandler = std::function<BeastResponse(
+    BeastRequest, functions::HttpRequestBodyReader&)>;
+
+/// Sends a response incrementally, see `functions::HttpResponseWriter`.
+class ResponseWriter {
+ public:
+  virtual ~ResponseWriter() = default;
+  /// Sends the status and headers in @p header, and its body, if not empty.
+  virtual void WriteHeader(BeastResponse header) = 0;
+  virtual void Write(std::string_view data) = 0;
+  /// See `functions::HttpResponseWriter::SetHeartbeat()`, the default
+  /// implementation ignores the heartbeat.
+  virtual void SetHeartbeat(std::string_view /*data*/,
+                            std::chrono::milliseconds /*interval*/) {}
+};
+
+/**
+ * Handlers for functions that send their response incrementally.
+ *
+ * These handlers always call `ResponseWriter::WriteHeader()`. They return
+ * `false` if the response is incomplete, for example, if the function failed
+ * after sending the header.
+ */
+using WriterHandler = std::function<bool(BeastRequest, ResponseWriter&)>;
+
+/// Completes an asynchronous handler, it may be called from any thread.
+using AsyncResponseCallback = std::function<void(BeastResponse)>;
+
+/**
+ * Handlers for functions that complete asynchronously.
+ *
+ * These handlers return once the function starts, and call the callback
+ * exactly once, with the response.
+ */
+using AsyncHandler = std::function<void(BeastRequest, AsyncResponseCallback)>;
+
+/**
+ * Checks a request once its header is received.
+ *
+ * The request has an empty body. Returns the response to reject the request,
+ * or an empty optional to accept it.
+ */
+using PrecheckHandler =
+    std::function<std::optional<BeastResponse>(BeastRequest const&)>;
+
+/**
+ * Accepts WebSocket connections.
+ *
+ * Runs with the upgrade request, before the `101 Switching Protocols`
+ * response. Sets the callbacks for the connection, or returns the response
+ * to reject the upgrade.
+ */
+using WebSocketHandler = std::function<std::optional<BeastResponse>(
+    BeastRequest const&, std::shared_ptr<functions::WebSocket>,
+    functions::WebSocketCallbacks&)>;
+
+/// Runs once during startup, before the server accepts requests.
+using WarmupHandler = std::function<void()>;
+
+/// Runs once during shutdown, after the server stops serving requests.
+using ShutdownHandler = std::function<void()>;
+
+/// Runs before the server is checkpointed, and after it is restored.
+struct CheckpointHandler {
+  std::function<void()> before_checkpoint;
+  std::function<void()> after_restore;
+};
+
+/// Calls @p handler and blocks until it completes.
+Handler MakeBlockingHandler(AsyncHandler handler);
+
+/**
+ * Runs the warmup handlers in parallel, and waits for all of them.
+ *
+ * The calling thread runs one of the handlers. Rethrows the exception of the
+ * first handler that failed, if any.
+ */
+void RunWarmup(std::vector<WarmupHandler> const& warmups);
+
 class FunctionImpl {
  public:
   virtual ~FunctionImpl() = default;
   [[nodiscard]] virtual Handler GetHandler(std::string_view target) const = 0;
 
+  /**
+   * Returns the handler to read request bodies incrementally.
+   *
+   * Returns an empty function if the function does not support streaming. The
+   * handler returned by `GetHandler()` is always usable, streaming functions
+   * receive a reader over the buffered body.
+   */
+  [[nodiscard]] virtual StreamingHandler GetStreamingHandler(
+      std::string_view /*target*/) const {
+    return {};
+  }
+
+  /**
+   * Returns the handler to send responses incrementally.
+   *
+   * Returns an empty function if the function does not support streaming
+   * responses. The handler returned by `GetHandler()` is always usable, the
+   * streaming responses are buffered.
+   */
+  [[nodiscard]] virtual WriterHandler GetWriterHandler(
+      std::string_view /*target*/) const {
+    return {};
+  }
+
+  /**
+   * Returns the handler to complete requests asynchronously.
+   *
+   * Returns an empty function if the function is synchronous. The handler
+   * returned by `GetHandler()` is always usable, it blocks until the
+   * asynchronous function completes.
+   */
+  [[nodiscard]] virtual AsyncHandler GetAsyncHandler(
+      std::string_view /*target*/) const {
+    return {};
+  }
+
+  /**
+   * Returns the handler for WebSocket upgrade requests.
+   *
+   * Returns an empty function if the function does not accept WebSocket
+   * connections, the upgrade requests then use the other handlers.
+   */
+  [[nodiscard]] virtual WebSocketHandler GetWebSocketHandler(
+      std::string_view /*target*/) const {
+    return {};
+  }
+
+  /// Returns the handler to check requests, or an empty function.
+  [[nodiscard]] virtual PrecheckHandler GetPrecheckHandler(
+      std::string_view /*target*/) const {
+    return {};
+  }
+
+  /// Returns the functions to run before the server accepts requests.
+  [[nodiscard]] virtual std::vector<WarmupHandler> GetWarmupHandlers(
+      std::string_view /*target*/) const {
+    return {};
+  }
+
+  /**
+   * Returns the functions to run after the server stops.
+   *
+   * The server runs them in reverse order, so the functions added by the
+   * innermost decorators run last.
+   */
+  [[nodiscard]] virtual std::vector<ShutdownHandler> GetShutdownHandlers(
+      std::string_view /*target*/) const {
+    return {};
+  }
+
+  /**
+   * Returns the functions to run around a checkpoint of the server.
+   *
+   * The server runs the `before_checkpoint` functions in reverse order, and
+   * the `after_restore` functions in order.
+   */
+  [[nodiscard]] virtual std::vector<CheckpointHandler> GetCheckpointHandlers(
+      std::string_view /*target*/) const {
+    return {};
+  }
+
   static std::shared_ptr<FunctionImpl> GetImpl(functions::Function const& fun);
   static functions::Function MakeFunction(std::shared_ptr<FunctionImpl> impl);
 };
@@ -44,24 +219,421 @@ class FunctionImpl {
 class BaseFunctionImpl : public FunctionImpl {
  public:
   explicit BaseFunctionImpl(functions::UserHttpFunction function);
+  /// Wraps a raw function, see `functions::UserRawHttpFunction`.
+  explicit BaseFunctionImpl(Handler function);
+  explicit BaseFunctionImpl(functions::UserHttpStreamingFunction function);
+  explicit BaseFunctionImpl(
+      functions::UserHttpStreamingResponseFunction function);
   explicit BaseFunctionImpl(functions::UserCloudEventFunction function);
+  BaseFunctionImpl(functions::UserCloudEventFunction function,
+                   functions::CloudEventBatchOptions options);
+  explicit BaseFunctionImpl(functions::UserCloudEventBatchFunction function);
+  explicit BaseFunctionImpl(functions::UserHttpAsyncFunction function);
+  explicit BaseFunctionImpl(functions::UserCloudEventAsyncFunction function);
+  explicit BaseFunctionImpl(std::shared_ptr<UserHttpCallable> function);
+  explicit BaseFunctionImpl(std::shared_ptr<UserCloudEventCallable> function);
   ~BaseFunctionImpl() override = default;
 
   [[nodiscard]] Handler GetHandler(std::string_view /*target*/) const override;
+  [[nodiscard]] StreamingHandler GetStreamingHandler(
+      std::string_view /*target*/) const override;
+  [[nodiscard]] WriterHandler GetWriterHandler(
+      std::string_view /*target*/) const override;
+  [[nodiscard]] AsyncHandler GetAsyncHandler(
+      std::string_view /*target*/) const override;
 
  private:
   Handler handler_;
+  StreamingHandler streaming_handler_;
+  WriterHandler writer_handler_;
+  AsyncHandler async_handler_;
 };
 
+/**
+ * Selects one of several functions by target, see `functions::MakeFunction()`.
+ *
+ * The functions created by factories are created the first time their target
+ * is used, and kept for the lifetime of this object.
+ */
 class MapFunctionImpl : public FunctionImpl {
  public:
+  using Factory = std::function<functions::Function()>;
+
   explicit MapFunctionImpl(std::map<std::string, functions::Function> mapping);
+  explicit MapFunctionImpl(std::map<std::string, Factory> factories);
   ~MapFunctionImpl() override = default;
 
   [[nodiscard]] Handler GetHandler(std::string_view target) const override;
+  [[nodiscard]] StreamingHandler GetStreamingHandler(
+      std::string_view target) const override;
+  [[nodiscard]] WriterHandler GetWriterHandler(
+      std::string_view target) const override;
+  [[nodiscard]] AsyncHandler GetAsyncHandler(
+      std::string_view target) const override;
+  [[nodiscard]] WebSocketHandler GetWebSocketHandler(
+      std::string_view target) const override;
+  [[nodiscard]] PrecheckHandler GetPrecheckHandler(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<WarmupHandler> GetWarmupHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<ShutdownHandler> GetShutdownHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<CheckpointHandler> GetCheckpointHandlers(
+      std::string_view target) const override;
+
+ private:
+  [[nodiscard]] FunctionImpl const& Find(std::string_view target) const;
+
+  std::map<std::string, Factory, std::less<>> factories_;
+  mutable std::mutex mu_;
+  mutable std::map<std::string, functions::Function, std::less<>> mapping_;
+};
+
+/// Routes each request to one of several functions, see
+/// `functions::MakeRouter()`.
+class RouterFunctionImpl : public FunctionImpl {
+ public:
+  explicit RouterFunctionImpl(std::vector<functions::FunctionRoute> routes);
+  ~RouterFunctionImpl() override = default;
+
+  [[nodiscard]] Handler GetHandler(std::string_view target) const override;
+  [[nodiscard]] AsyncHandler GetAsyncHandler(
+      std::string_view target) const override;
+  [[nodiscard]] WebSocketHandler GetWebSocketHandler(
+      std::string_view target) const override;
+  [[nodiscard]] PrecheckHandler GetPrecheckHandler(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<WarmupHandler> GetWarmupHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<ShutdownHandler> GetShutdownHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<CheckpointHandler> GetCheckpointHandlers(
+      std::string_view target) const override;
+
+ private:
+  std::shared_ptr<PathRouter const> router_;
+  /// The route values in `router_` are indices into this vector.
+  std::vector<std::shared_ptr<FunctionImpl>> functions_;
+  /// The name of each route in the metrics, its method and prefix.
+  std::vector<std::string> names_;
+};
+
+/// Limits the concurrency of an existing function, see
+/// `functions::WithConcurrencyLimit()`.
+class ConcurrencyLimitFunctionImpl : public FunctionImpl {
+ public:
+  ConcurrencyLimitFunctionImpl(std::shared_ptr<FunctionImpl> impl,
+                               functions::ConcurrencyLimitOptions options);
+  ~ConcurrencyLimitFunctionImpl() override = default;
+
+  [[nodiscard]] Handler GetHandler(std::string_view target) const override;
+  [[nodiscard]] AsyncHandler GetAsyncHandler(
+      std::string_view target) const override;
+  [[nodiscard]] WebSocketHandler GetWebSocketHandler(
+      std::string_view target) const override;
+  [[nodiscard]] PrecheckHandler GetPrecheckHandler(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<WarmupHandler> GetWarmupHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<ShutdownHandler> GetShutdownHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<CheckpointHandler> GetCheckpointHandlers(
+      std::string_view target) const override;
+
+ private:
+  std::shared_ptr<FunctionImpl> impl_;
+  std::size_t max_concurrency_;
+  functions::UserHttpClassifierFunction classifier_;
+  /// Adjusts the limit of `limiter_`, null unless the limit is adaptive.
+  std::shared_ptr<AdaptiveConcurrency> adaptive_;
+  std::shared_ptr<ConcurrencyLimiter> limiter_;
+  BeastResponse rejected_;
+  /// Runs synchronous functions, created on first use.
+  mutable std::once_flag pool_once_;
+  mutable std::shared_ptr<boost::asio::thread_pool> pool_;
+};
+
+/// Runs a synchronous function in a separate pool, see
+/// `functions::WithOffload()`.
+class OffloadFunctionImpl : public FunctionImpl {
+ public:
+  OffloadFunctionImpl(std::shared_ptr<FunctionImpl> impl,
+                      functions::OffloadOptions options);
+  ~OffloadFunctionImpl() override = default;
+
+  [[nodiscard]] Handler GetHandler(std::string_view target) const override;
+  [[nodiscard]] StreamingHandler GetStreamingHandler(
+      std::string_view target) const override;
+  [[nodiscard]] WriterHandler GetWriterHandler(
+      std::string_view target) const override;
+  [[nodiscard]] AsyncHandler GetAsyncHandler(
+      std::string_view target) const override;
+  [[nodiscard]] WebSocketHandler GetWebSocketHandler(
+      std::string_view target) const override;
+  [[nodiscard]] PrecheckHandler GetPrecheckHandler(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<WarmupHandler> GetWarmupHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<ShutdownHandler> GetShutdownHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<CheckpointHandler> GetCheckpointHandlers(
+      std::string_view target) const override;
+
+ private:
+  std::shared_ptr<FunctionImpl> impl_;
+  /// The dedicated pool, if any, otherwise the function uses the default.
+  std::shared_ptr<boost::asio::thread_pool> pool_;
+};
+
+/// Adds warmup, shutdown, or checkpoint handlers to a function.
+class LifecycleFunctionImpl : public FunctionImpl {
+ public:
+  LifecycleFunctionImpl(std::shared_ptr<FunctionImpl> impl,
+                        WarmupHandler warmup, ShutdownHandler shutdown,
+                        CheckpointHandler checkpoint = {});
+  ~LifecycleFunctionImpl() override = default;
+
+  [[nodiscard]] Handler GetHandler(std::string_view target) const override;
+  [[nodiscard]] StreamingHandler GetStreamingHandler(
+      std::string_view target) const override;
+  [[nodiscard]] WriterHandler GetWriterHandler(
+      std::string_view target) const override;
+  [[nodiscard]] AsyncHandler GetAsyncHandler(
+      std::string_view target) const override;
+  [[nodiscard]] WebSocketHandler GetWebSocketHandler(
+      std::string_view target) const override;
+  [[nodiscard]] PrecheckHandler GetPrecheckHandler(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<WarmupHandler> GetWarmupHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<ShutdownHandler> GetShutdownHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<CheckpointHandler> GetCheckpointHandlers(
+      std::string_view target) const override;
+
+ private:
+  std::shared_ptr<FunctionImpl> impl_;
+  WarmupHandler warmup_;
+  ShutdownHandler shutdown_;
+  CheckpointHandler checkpoint_;
+};
+
+/// Adds a precheck handler to an existing function.
+class PrecheckFunctionImpl : public FunctionImpl {
+ public:
+  PrecheckFunctionImpl(std::shared_ptr<FunctionImpl> impl,
+                       functions::UserHttpPrecheckFunction precheck);
+  ~PrecheckFunctionImpl() override = default;
+
+  [[nodiscard]] Handler GetHandler(std::string_view target) const override;
+  [[nodiscard]] StreamingHandler GetStreamingHandler(
+      std::string_view target) const override;
+  [[nodiscard]] WriterHandler GetWriterHandler(
+      std::string_view target) const override;
+  [[nodiscard]] AsyncHandler GetAsyncHandler(
+      std::string_view target) const override;
+  [[nodiscard]] WebSocketHandler GetWebSocketHandler(
+      std::string_view target) const override;
+  [[nodiscard]] PrecheckHandler GetPrecheckHandler(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<WarmupHandler> GetWarmupHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<ShutdownHandler> GetShutdownHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<CheckpointHandler> GetCheckpointHandlers(
+      std::string_view target) const override;
+
+ private:
+  std::shared_ptr<FunctionImpl> impl_;
+  PrecheckHandler precheck_;
+};
+
+/// Answers conditional requests for an existing function, see
+/// `functions::WithValidator()`.
+class ValidatorFunctionImpl : public FunctionImpl {
+ public:
+  ValidatorFunctionImpl(std::shared_ptr<FunctionImpl> impl,
+                        functions::UserHttpValidatorFunction validator);
+  ~ValidatorFunctionImpl() override = default;
+
+  [[nodiscard]] Handler GetHandler(std::string_view target) const override;
+  [[nodiscard]] StreamingHandler GetStreamingHandler(
+      std::string_view target) const override;
+  [[nodiscard]] WriterHandler GetWriterHandler(
+      std::string_view target) const override;
+  [[nodiscard]] AsyncHandler GetAsyncHandler(
+      std::string_view target) const override;
+  [[nodiscard]] WebSocketHandler GetWebSocketHandler(
+      std::string_view target) const override;
+  [[nodiscard]] PrecheckHandler GetPrecheckHandler(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<WarmupHandler> GetWarmupHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<ShutdownHandler> GetShutdownHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<CheckpointHandler> GetCheckpointHandlers(
+      std::string_view target) const override;
+
+ private:
+  std::shared_ptr<FunctionImpl> impl_;
+  std::function<std::optional<std::string>(BeastRequest const&)> validator_;
+};
+
+class RequestCoalescer;
+
+/// Shares calls between identical requests to an existing function, see
+/// `functions::WithCoalescing()`.
+class CoalescingFunctionImpl : public FunctionImpl {
+ public:
+  CoalescingFunctionImpl(std::shared_ptr<FunctionImpl> impl,
+                         functions::CoalescingOptions options);
+  ~CoalescingFunctionImpl() override = default;
+
+  [[nodiscard]] Handler GetHandler(std::string_view target) const override;
+  [[nodiscard]] AsyncHandler GetAsyncHandler(
+      std::string_view target) const override;
+  [[nodiscard]] WebSocketHandler GetWebSocketHandler(
+      std::string_view target) const override;
+  [[nodiscard]] PrecheckHandler GetPrecheckHandler(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<WarmupHandler> GetWarmupHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<ShutdownHandler> GetShutdownHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<CheckpointHandler> GetCheckpointHandlers(
+      std::string_view target) const override;
+
+ private:
+  std::shared_ptr<FunctionImpl> impl_;
+  std::function<std::optional<std::string>(BeastRequest const&)> key_;
+  std::shared_ptr<RequestCoalescer> coalescer_;
+};
+
+class ResponseCache;
+
+/// Caches the responses of an existing function, see
+/// `functions::WithResponseCache()`.
+class ResponseCacheFunctionImpl : public FunctionImpl {
+ public:
+  ResponseCacheFunctionImpl(std::shared_ptr<FunctionImpl> impl,
+                            functions::ResponseCacheOptions options);
+  ~ResponseCacheFunctionImpl() override = default;
+
+  [[nodiscard]] Handler GetHandler(std::string_view target) const override;
+  [[nodiscard]] AsyncHandler GetAsyncHandler(
+      std::string_view target) const override;
+  [[nodiscard]] WebSocketHandler GetWebSocketHandler(
+      std::string_view target) const override;
+  [[nodiscard]] PrecheckHandler GetPrecheckHandler(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<WarmupHandler> GetWarmupHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<ShutdownHandler> GetShutdownHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<CheckpointHandler> GetCheckpointHandlers(
+      std::string_view target) const override;
+
+ private:
+  std::shared_ptr<FunctionImpl> impl_;
+  std::vector<std::string> headers_;
+  std::function<std::optional<std::string>(BeastRequest const&)> key_;
+  std::shared_ptr<ResponseCache> cache_;
+};
+
+class RateLimiter;
+
+/// Limits the rate of requests per client to an existing function, see
+/// `functions::WithRateLimit()`.
+class RateLimitFunctionImpl : public FunctionImpl {
+ public:
+  RateLimitFunctionImpl(std::shared_ptr<FunctionImpl> impl,
+                        functions::RateLimitOptions options);
+  ~RateLimitFunctionImpl() override = default;
+
+  [[nodiscard]] Handler GetHandler(std::string_view target) const override;
+  [[nodiscard]] StreamingHandler GetStreamingHandler(
+      std::string_view target) const override;
+  [[nodiscard]] WriterHandler GetWriterHandler(
+      std::string_view target) const override;
+  [[nodiscard]] AsyncHandler GetAsyncHandler(
+      std::string_view target) const override;
+  [[nodiscard]] WebSocketHandler GetWebSocketHandler(
+      std::string_view target) const override;
+  [[nodiscard]] PrecheckHandler GetPrecheckHandler(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<WarmupHandler> GetWarmupHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<ShutdownHandler> GetShutdownHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<CheckpointHandler> GetCheckpointHandlers(
+      std::string_view target) const override;
+
+ private:
+  std::shared_ptr<FunctionImpl> impl_;
+  std::string header_;
+  functions::UserHttpRateLimitKeyFunction key_;
+  std::shared_ptr<RateLimiter> limiter_;
+};
+
+/// Records spans for an existing function, see `functions::WithTracing()`.
+class TracingFunctionImpl : public FunctionImpl {
+ public:
+  TracingFunctionImpl(std::shared_ptr<FunctionImpl> impl,
+                      std::shared_ptr<functions::SpanExporter> exporter);
+  ~TracingFunctionImpl() override = default;
+
+  [[nodiscard]] Handler GetHandler(std::string_view target) const override;
+  [[nodiscard]] StreamingHandler GetStreamingHandler(
+      std::string_view target) const override;
+  [[nodiscard]] WriterHandler GetWriterHandler(
+      std::string_view target) const override;
+  [[nodiscard]] AsyncHandler GetAsyncHandler(
+      std::string_view target) const override;
+  [[nodiscard]] WebSocketHandler GetWebSocketHandler(
+      std::string_view target) const override;
+  [[nodiscard]] PrecheckHandler GetPrecheckHandler(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<WarmupHandler> GetWarmupHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<ShutdownHandler> GetShutdownHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<CheckpointHandler> GetCheckpointHandlers(
+      std::string_view target) const override;
+
+ private:
+  std::shared_ptr<FunctionImpl> impl_;
+  std::shared_ptr<functions::SpanExporter> exporter_;
+};
+
+/// Accepts WebSocket connections, and sends the other requests to an
+/// existing function, see `functions::MakeWebSocketFunction()`.
+class WebSocketFunctionImpl : public FunctionImpl {
+ public:
+  WebSocketFunctionImpl(std::shared_ptr<FunctionImpl> impl,
+                        functions::UserWebSocketFunction function);
+  ~WebSocketFunctionImpl() override = default;
+
+  [[nodiscard]] Handler GetHandler(std::string_view target) const override;
+  [[nodiscard]] StreamingHandler GetStreamingHandler(
+      std::string_view target) const override;
+  [[nodiscard]] WriterHandler GetWriterHandler(
+      std::string_view target) const override;
+  [[nodiscard]] AsyncHandler GetAsyncHandler(
+      std::string_view target) const override;
+  [[nodiscard]] WebSocketHandler GetWebSocketHandler(
+      std::string_view target) const override;
+  [[nodiscard]] PrecheckHandler GetPrecheckHandler(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<WarmupHandler> GetWarmupHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<ShutdownHandler> GetShutdownHandlers(
+      std::string_view target) const override;
+  [[nodiscard]] std::vector<CheckpointHandler> GetCheckpointHandlers(
+      std::string_view target) const override;
 
  private:
-  std::map<std::string, functions::Function> mapping_;
+  std::shared_ptr<FunctionImpl> impl_;
+  WebSocketHandler websocket_;
 };
 
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
@@ -13,14 +13,30 @@
 // limitations under the License.
 
 #include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/rate_limiter.h"
+#include "google/cloud/functions/internal/request_timing.h"
 #include "google/cloud/functions/function.h"
 #include <gmock/gmock.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
+using ::testing::Pair;
 namespace http = ::boost::beast::http;
 
 auto SimpleHttp(functions::HttpRequest const& request) {
@@ -67,6 +83,109 @@ TEST(FunctionImpl, HttpNormal) {
   EXPECT_THAT(response.body(), HasSubstr("x-test-header: value"));
 }
 
+TEST(FunctionImpl, HttpMoveOnly) {
+  auto prefix = std::make_unique<std::string>("target=");
+  auto function = functions::MakeFunction(
+      [p = std::move(prefix)](functions::HttpRequest const& request) {
+        return functions::HttpResponse{}.set_payload(*p + request.target());
+      });
+  auto handler = FunctionImpl::GetImpl(function)->GetHandler("unused");
+  BeastRequest request;
+  request.target("/test-target");
+  auto response = handler(request);
+  EXPECT_EQ(response.result(), http::status::ok);
+  EXPECT_EQ(response.body(), "target=/test-target");
+
+  auto throws = functions::MakeFunction(
+      [p = std::make_unique<int>(0)](functions::HttpRequest const& r) {
+        return AlwaysThrowHttp(r);
+      });
+  response = FunctionImpl::GetImpl(throws)->GetHandler("unused")(request);
+  EXPECT_EQ(response.result(), http::status::internal_server_error);
+}
+
+TEST(FunctionImpl, HttpAsync) {
+  auto function = functions::MakeFunction(functions::UserHttpAsyncFunction(
+      [](functions::HttpRequest const& request,
+         functions::HttpResponseCallback const& done) {
+        if (request.target() == "/throw") throw std::runtime_error("testing");
+        done(functions::HttpResponse{}.set_payload(request.target()));
+        // Only the first call counts.
+        done(functions::HttpResponse{}.set_payload("ignored"));
+        if (request.target() == "/throw-after") {
+          throw std::runtime_error("testing");
+        }
+      }));
+  auto impl = FunctionImpl::GetImpl(function);
+  auto async = impl->GetAsyncHandler("unused");
+  ASSERT_TRUE(async);
+  std::vector<BeastResponse> responses;
+  auto call = [&](std::string const& target) {
+    BeastRequest request;
+    request.target(target);
+    async(std::move(request), [&responses](BeastResponse response) {
+      responses.push_back(std::move(response));
+    });
+  };
+  call("/test-target");
+  call("/throw");
+  call("/throw-after");
+  ASSERT_EQ(responses.size(), 3);
+  EXPECT_EQ(responses[0].result(), http::status::ok);
+  EXPECT_EQ(responses[0].body(), "/test-target");
+  EXPECT_EQ(responses[1].result(), http::status::internal_server_error);
+  EXPECT_EQ(responses[2].body(), "/throw-after");
+
+  // The synchronous handler waits for the function.
+  BeastRequest request;
+  request.target("/sync");
+  auto response = impl->GetHandler("unused")(std::move(request));
+  EXPECT_EQ(response.body(), "/sync");
+
+  auto http = functions::MakeFunction(SimpleHttp);
+  EXPECT_FALSE(FunctionImpl::GetImpl(http)->GetAsyncHandler("unused"));
+}
+
+TEST(FunctionImpl, HttpStreaming) {
+  auto function = functions::MakeFunction(
+      [](functions::HttpRequest const& /*request*/,
+         functions::HttpRequestBodyReader& reader) {
+        std::string buffer(16, '\0');
+        buffer.resize(reader.Read(buffer.data(), buffer.size()));
+        return functions::HttpResponse{}.set_payload(buffer);
+      });
+  auto impl = FunctionImpl::GetImpl(function);
+  EXPECT_TRUE(impl->GetStreamingHandler("unused"));
+  auto handler = impl->GetHandler("unused");
+  BeastRequest request;
+  request.target("/test-target");
+  request.body() = "Hello";
+  auto response = handler(request);
+  EXPECT_EQ(response.result(), http::status::ok);
+  EXPECT_EQ(response.body(), "Hello");
+
+  auto http = functions::MakeFunction(SimpleHttp);
+  EXPECT_FALSE(FunctionImpl::GetImpl(http)->GetStreamingHandler("unused"));
+}
+
+TEST(FunctionImpl, HttpStreamingResponse) {
+  auto function = functions::MakeFunction(
+      [](functions::HttpRequest const& request,
+         functions::HttpResponseWriter& writer) {
+        writer.Write("Hello ");
+        writer.Write(request.target());
+      });
+  auto impl = FunctionImpl::GetImpl(function);
+  EXPECT_TRUE(impl->GetWriterHandler("unused"));
+  EXPECT_FALSE(impl->GetStreamingHandler("unused"));
+  auto handler = impl->GetHandler("unused");
+  BeastRequest request;
+  request.target("/test-target");
+  auto response = handler(request);
+  EXPECT_EQ(response.result(), http::status::ok);
+  EXPECT_EQ(response.body(), "Hello /test-target");
+}
+
 TEST(FunctionImpl, HttpThrow) {
   auto function = functions::MakeFunction(AlwaysThrowHttp);
   auto handler = FunctionImpl::GetImpl(function)->GetHandler("unused");
@@ -88,6 +207,75 @@ TEST(FunctionImpl, CloudEventNormal) {
   EXPECT_EQ(response.result(), http::status::ok);
 }
 
+TEST(FunctionImpl, CloudEventParallelBatch) {
+  auto func = [](functions::CloudEvent const& event) {
+    EXPECT_EQ(event.id(), "A234-1234-1234");
+  };
+  auto function =
+      functions::MakeFunction(func, functions::CloudEventBatchOptions{2});
+  auto handler = FunctionImpl::GetImpl(function)->GetHandler("unused");
+  auto response = handler(TestCloudEventRequest());
+  EXPECT_EQ(response.result(), http::status::ok);
+}
+
+TEST(FunctionImpl, CloudEventBatch) {
+  int calls = 0;
+  auto function = functions::MakeFunction(
+      [&calls](std::vector<functions::CloudEvent>&& events) {
+        ASSERT_EQ(events.size(), 1);
+        EXPECT_EQ(events[0].id(), "A234-1234-1234");
+        ++calls;
+      });
+  auto handler = FunctionImpl::GetImpl(function)->GetHandler("unused");
+  auto response = handler(TestCloudEventRequest());
+  EXPECT_EQ(response.result(), http::status::ok);
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(FunctionImpl, CloudEventMoveOnly) {
+  auto count = std::make_unique<int>(0);
+  auto* counter = count.get();
+  auto function = functions::MakeFunction(
+      [c = std::move(count)](functions::CloudEvent const& event) {
+        EXPECT_EQ(event.id(), "A234-1234-1234");
+        ++*c;
+      });
+  auto handler = FunctionImpl::GetImpl(function)->GetHandler("unused");
+  auto response = handler(TestCloudEventRequest());
+  EXPECT_EQ(response.result(), http::status::ok);
+  EXPECT_EQ(*counter, 1);
+}
+
+TEST(FunctionImpl, CloudEventAsync) {
+  std::vector<functions::CloudEventCallback> pending;
+  auto function =
+      functions::MakeFunction(functions::UserCloudEventAsyncFunction(
+          [&pending](functions::CloudEvent const& event,
+                     functions::CloudEventCallback done) {
+            EXPECT_EQ(event.id(), "A234-1234-1234");
+            pending.push_back(std::move(done));
+          }));
+  auto async = FunctionImpl::GetImpl(function)->GetAsyncHandler("unused");
+  ASSERT_TRUE(async);
+  std::optional<BeastResponse> response;
+  auto on_response = [&response](BeastResponse r) { response = std::move(r); };
+
+  async(TestCloudEventRequest(), on_response);
+  ASSERT_EQ(pending.size(), 1);
+  EXPECT_FALSE(response.has_value());
+  pending.back()(nullptr);
+  ASSERT_TRUE(response.has_value());
+  EXPECT_EQ(response->result(), http::status::ok);
+
+  response.reset();
+  async(TestCloudEventRequest(), on_response);
+  ASSERT_EQ(pending.size(), 2);
+  pending.back()(std::make_exception_ptr(std::runtime_error("testing")));
+  ASSERT_TRUE(response.has_value());
+  EXPECT_EQ(response->result(), http::status::internal_server_error);
+  EXPECT_THAT(response->body(), HasSubstr("testing"));
+}
+
 TEST(FunctionImpl, CloudEventThrow) {
   auto func = [](functions::CloudEvent const& /*event*/) {
     throw std::runtime_error("testing");
@@ -133,12 +321,663 @@ TEST(FunctionImpl, MapThrow) {
   EXPECT_EQ(response.result(), http::status::internal_server_error);
 }
 
+std::optional<functions::HttpResponse> RejectMissingHeader(
+    functions::HttpRequest const& request, std::string const& name) {
+  if (request.headers().count(name) != 0) return std::nullopt;
+  return functions::HttpResponse{}.set_result(
+      functions::HttpResponse::kForbidden);
+}
+
+TEST(FunctionImpl, Precheck) {
+  auto base = functions::MakeFunction(SimpleHttp);
+  EXPECT_FALSE(FunctionImpl::GetImpl(base)->GetPrecheckHandler("unused"));
+
+  auto function = functions::WithPrecheck(
+      base, [](functions::HttpRequest const& r) {
+        EXPECT_TRUE(r.payload().empty());
+        return RejectMissingHeader(r, "x-a");
+      });
+  function = functions::WithPrecheck(
+      function, [](auto const& r) { return RejectMissingHeader(r, "x-b"); });
+  auto const& impl = *FunctionImpl::GetImpl(function);
+  auto precheck = impl.GetPrecheckHandler("unused");
+  ASSERT_TRUE(precheck);
+
+  BeastRequest request;
+  request.body() = "the body is not available to prechecks";
+  EXPECT_EQ(precheck(request)->result(), http::status::forbidden);
+  request.set("x-a", "1");
+  EXPECT_EQ(precheck(request)->result(), http::status::forbidden);
+  request.set("x-b", "1");
+  EXPECT_FALSE(precheck(request).has_value());
+
+  // The other handlers are unchanged.
+  auto response = impl.GetHandler("unused")(BeastRequest());
+  EXPECT_EQ(response.result(), http::status::ok);
+}
+
+TEST(FunctionImpl, PrecheckThrow) {
+  auto throws = [](functions::HttpRequest const&)
+      -> std::optional<functions::HttpResponse> {
+    throw std::runtime_error("testing");
+  };
+  auto function =
+      functions::WithPrecheck(functions::MakeFunction(SimpleHttp), throws);
+  auto precheck = FunctionImpl::GetImpl(function)->GetPrecheckHandler("a");
+  EXPECT_EQ(precheck(BeastRequest())->result(),
+            http::status::internal_server_error);
+}
+
+TEST(FunctionImpl, Validator) {
+  auto function = functions::WithValidator(
+      functions::MakeFunction(SimpleHttp),
+      [](functions::HttpRequest const& r) -> std::optional<std::string> {
+        EXPECT_TRUE(r.payload().empty());
+        if (r.target() == "/throw") throw std::runtime_error("testing");
+        return "v1";
+      });
+  auto const& impl = *FunctionImpl::GetImpl(function);
+  auto handler = impl.GetHandler("unused");
+
+  BeastRequest request;
+  request.method(http::verb::get);
+  request.target("/");
+  request.set(http::field::if_none_match, R"("v1")");
+  auto response = handler(request);
+  EXPECT_EQ(response.result(), http::status::not_modified);
+  EXPECT_EQ(response[http::field::etag], R"("v1")");
+
+  request.set(http::field::if_none_match, R"("v0")");
+  response = handler(request);
+  EXPECT_EQ(response.result(), http::status::ok);
+  EXPECT_EQ(response[http::field::etag], R"("v1")");
+
+  // Validators that throw are ignored.
+  request.target("/throw");
+  response = handler(request);
+  EXPECT_EQ(response.result(), http::status::ok);
+  EXPECT_EQ(response.count(http::field::etag), 0);
+}
+
+TEST(FunctionImpl, MapPrecheck) {
+  auto const reject = [](functions::HttpRequest const&) {
+    return std::make_optional(functions::HttpResponse{}.set_result(
+        functions::HttpResponse::kForbidden));
+  };
+  auto function = functions::MakeFunction({
+      {"a", functions::WithPrecheck(functions::MakeFunction(SimpleHttp),
+                                    reject)},
+      {"b", functions::MakeFunction(SimpleHttp)},
+  });
+  auto const& impl = *FunctionImpl::GetImpl(function);
+  ASSERT_TRUE(impl.GetPrecheckHandler("a"));
+  EXPECT_FALSE(impl.GetPrecheckHandler("b"));
+}
+
 TEST(FunctionImpl, MapInvalidName) {
   auto function = MakeTestMapFunction();
   EXPECT_THROW((void)FunctionImpl::GetImpl(function)->GetHandler("invalid"),
                std::exception);
 }
 
+TEST(FunctionImpl, MapFactories) {
+  std::map<std::string, int> calls;
+  auto factory = [&calls](std::string name) {
+    return [&calls, name] {
+      ++calls[name];
+      return functions::MakeFunction(
+          [name](functions::HttpRequest const& /*r*/) {
+            return functions::HttpResponse{}.set_payload(name);
+          });
+    };
+  };
+  auto function = functions::MakeFunction(
+      std::map<std::string, std::function<functions::Function()>>{
+          {"a", factory("a")},
+          {"b", factory("b")},
+      });
+  EXPECT_TRUE(calls.empty());
+
+  auto const& impl = *FunctionImpl::GetImpl(function);
+  EXPECT_FALSE(impl.GetPrecheckHandler("a"));
+  EXPECT_TRUE(impl.GetWarmupHandlers("a").empty());
+  auto handler = impl.GetHandler("a");
+  EXPECT_EQ(handler(BeastRequest()).body(), "a");
+  EXPECT_THAT(calls, ElementsAre(Pair("a", 1)));
+
+  EXPECT_THROW((void)impl.GetHandler("invalid"), std::exception);
+  EXPECT_THAT(calls, ElementsAre(Pair("a", 1)));
+}
+
+BeastRequest RouteRequest(http::verb method, std::string const& target) {
+  BeastRequest request;
+  request.method(method);
+  request.target(target);
+  return request;
+}
+
+TEST(FunctionImpl, Router) {
+  auto make = [](std::string name) {
+    return functions::MakeFunction(
+        [name = std::move(name)](functions::HttpRequest const& /*r*/) {
+          return functions::HttpResponse{}.set_payload(name);
+        });
+  };
+  auto function = functions::MakeRouter({
+      {"/orders", make("list"), "GET"},
+      {"/orders", make("create"), "POST"},
+      {"/", make("default")},
+  });
+  auto const& impl = *FunctionImpl::GetImpl(function);
+  auto handler = impl.GetHandler("unused");
+  EXPECT_EQ(handler(RouteRequest(http::verb::get, "/orders/1")).body(), "list");
+  EXPECT_EQ(handler(RouteRequest(http::verb::post, "/orders")).body(),
+            "create");
+  EXPECT_EQ(handler(RouteRequest(http::verb::put, "/orders")).body(),
+            "default");
+  EXPECT_EQ(handler(RouteRequest(http::verb::get, "/")).body(), "default");
+}
+
+TEST(FunctionImpl, Warmup) {
+  std::vector<std::string> calls;
+  auto warmup = [&calls](std::string name) {
+    return [&calls, name = std::move(name)] { calls.push_back(name); };
+  };
+  auto base = functions::MakeFunction(SimpleHttp);
+  EXPECT_TRUE(FunctionImpl::GetImpl(base)->GetWarmupHandlers("unused").empty());
+
+  auto function = functions::MakeRouter({
+      {"/a", functions::WithWarmup(
+                 functions::WithWarmup(base, warmup("a1")), warmup("a2"))},
+      {"/b", functions::WithPrecheck(
+                 functions::WithWarmup(base, warmup("b")),
+                 [](functions::HttpRequest const& /*request*/) {
+                   return std::optional<functions::HttpResponse>{};
+                 })},
+      {"/c", base},
+  });
+  auto warmups = FunctionImpl::GetImpl(function)->GetWarmupHandlers("unused");
+  ASSERT_EQ(warmups.size(), 3);
+  for (auto const& w : warmups) w();
+  EXPECT_THAT(calls, ::testing::ElementsAre("a1", "a2", "b"));
+
+  // The decorator does not change the request handling.
+  auto handler = FunctionImpl::GetImpl(function)->GetHandler("unused");
+  EXPECT_EQ(handler(RouteRequest(http::verb::get, "/c")).result(),
+            http::status::ok);
+}
+
+TEST(FunctionImpl, CheckpointHooks) {
+  std::vector<std::string> calls;
+  auto hook = [&calls](std::string name) {
+    return [&calls, name = std::move(name)] { calls.push_back(name); };
+  };
+  auto base = functions::MakeFunction(SimpleHttp);
+  EXPECT_TRUE(
+      FunctionImpl::GetImpl(base)->GetCheckpointHandlers("unused").empty());
+
+  auto function = functions::MakeRouter({
+      {"/a", functions::WithCheckpointHooks(
+                 functions::WithWarmup(base, hook("warmup")),
+                 hook("checkpoint-a"), hook("restore-a"))},
+      {"/b", functions::WithCheckpointHooks(base, {}, hook("restore-b"))},
+      {"/c", base},
+  });
+  auto const impl = FunctionImpl::GetImpl(function);
+  EXPECT_EQ(impl->GetWarmupHandlers("unused").size(), 1);
+  auto handlers = impl->GetCheckpointHandlers("unused");
+  ASSERT_EQ(handlers.size(), 2);
+  for (auto const& h : handlers) {
+    if (h.before_checkpoint) h.before_checkpoint();
+    if (h.after_restore) h.after_restore();
+  }
+  EXPECT_THAT(calls,
+              ::testing::ElementsAre("checkpoint-a", "restore-a", "restore-b"));
+}
+
+TEST(FunctionImpl, RouterNotFound) {
+  auto function = functions::MakeRouter({
+      {"/a", functions::MakeFunction(SimpleHttp)},
+      {"/b", functions::WithPrecheck(functions::MakeFunction(SimpleHttp),
+                                     [](functions::HttpRequest const& r) {
+                                       return RejectMissingHeader(r, "x-b");
+                                     })},
+  });
+  auto const& impl = *FunctionImpl::GetImpl(function);
+  auto precheck = impl.GetPrecheckHandler("unused");
+  ASSERT_TRUE(precheck);
+  EXPECT_FALSE(precheck(RouteRequest(http::verb::get, "/a")).has_value());
+  EXPECT_EQ(precheck(RouteRequest(http::verb::get, "/b"))->result(),
+            http::status::forbidden);
+  EXPECT_EQ(precheck(RouteRequest(http::verb::get, "/c"))->result(),
+            http::status::not_found);
+
+  auto handler = impl.GetHandler("unused");
+  EXPECT_EQ(handler(RouteRequest(http::verb::get, "/a")).result(),
+            http::status::ok);
+  EXPECT_EQ(handler(RouteRequest(http::verb::get, "/c")).result(),
+            http::status::not_found);
+}
+
+TEST(FunctionImpl, RouterSetsRoute) {
+  auto function = functions::MakeRouter({
+      {"/a", functions::MakeFunction(SimpleHttp), "POST"},
+      {"/", functions::MakeFunction(SimpleHttp)},
+  });
+  auto handler = FunctionImpl::GetImpl(function)->GetHandler("unused");
+  RequestTiming timing;
+  ScopedRequestTiming scoped(&timing);
+  (void)handler(RouteRequest(http::verb::post, "/a/1"));
+  EXPECT_EQ(timing.route(), "POST /a");
+  (void)handler(RouteRequest(http::verb::get, "/a/1"));
+  EXPECT_EQ(timing.route(), "/");
+}
+
+TEST(FunctionImpl, RouterInvalid) {
+  auto f = functions::MakeFunction(SimpleHttp);
+  EXPECT_THROW(functions::MakeRouter({{"a", f}}), std::invalid_argument);
+  EXPECT_THROW(functions::MakeRouter({{"/a", f}, {"/a", f}}),
+               std::invalid_argument);
+}
+
+std::future<BeastResponse> CallAsync(AsyncHandler const& handler,
+                                     BeastRequest request) {
+  auto p = std::make_shared<std::promise<BeastResponse>>();
+  auto f = p->get_future();
+  handler(std::move(request),
+          [p](BeastResponse response) { p->set_value(std::move(response)); });
+  return f;
+}
+
+TEST(FunctionImpl, ConcurrencyLimit) {
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  std::atomic<int> calls{0};
+  functions::ConcurrencyLimitOptions options;
+  options.max_concurrency = 1;
+  options.max_queue = 1;
+  options.retry_after = std::chrono::seconds(7);
+  auto function = functions::WithConcurrencyLimit(
+      functions::MakeFunction(
+          [released, &calls](functions::HttpRequest const& /*r*/) {
+            ++calls;
+            released.wait();
+            return functions::HttpResponse{}.set_payload("done");
+          }),
+      options);
+  auto const& impl = *FunctionImpl::GetImpl(function);
+  auto async = impl.GetAsyncHandler("unused");
+  ASSERT_TRUE(async);
+  auto precheck = impl.GetPrecheckHandler("unused");
+  ASSERT_TRUE(precheck);
+  EXPECT_FALSE(precheck(BeastRequest()).has_value());
+
+  auto running = CallAsync(async, BeastRequest());
+  auto queued = CallAsync(async, BeastRequest());
+  // The queue is full, new requests are rejected without waiting.
+  auto rejected = CallAsync(async, BeastRequest());
+  ASSERT_EQ(rejected.wait_for(std::chrono::seconds(0)),
+            std::future_status::ready);
+  auto response = rejected.get();
+  EXPECT_EQ(response.result(), http::status::service_unavailable);
+  EXPECT_EQ(response[http::field::retry_after], "7");
+  EXPECT_EQ(precheck(BeastRequest())->result(),
+            http::status::service_unavailable);
+
+  release.set_value();
+  EXPECT_EQ(running.get().body(), "done");
+  EXPECT_EQ(queued.get().body(), "done");
+  EXPECT_EQ(calls.load(), 2);
+  // The blocking handler uses the same limit.
+  EXPECT_EQ(impl.GetHandler("unused")(BeastRequest()).body(), "done");
+}
+
+TEST(FunctionImpl, ConcurrencyLimitLanes) {
+  std::vector<std::pair<std::string, functions::HttpResponseCallback>> pending;
+  // Completing a request starts the next one, which adds to `pending`.
+  pending.reserve(4);
+  functions::ConcurrencyLimitOptions options;
+  options.max_concurrency = 1;
+  options.max_queue = 1;
+  options.lane_weights = {4, 1};
+  options.classifier = [](functions::HttpRequest const& r) -> std::size_t {
+    EXPECT_TRUE(r.payload().empty());
+    if (r.target() == "/throw") throw std::runtime_error("testing");
+    return r.target().rfind("/batch", 0) == 0 ? 1 : 0;
+  };
+  auto function = functions::WithConcurrencyLimit(
+      functions::MakeFunction(
+          [&pending](functions::HttpRequest const& r,
+                     functions::HttpResponseCallback done) {
+            pending.emplace_back(r.target(), std::move(done));
+          }),
+      options);
+  auto const& impl = *FunctionImpl::GetImpl(function);
+  auto async = impl.GetAsyncHandler("unused");
+  ASSERT_TRUE(async);
+  auto precheck = impl.GetPrecheckHandler("unused");
+  ASSERT_TRUE(precheck);
+
+  auto make_request = [](std::string target) {
+    BeastRequest request;
+    request.target(std::move(target));
+    return request;
+  };
+  auto running = CallAsync(async, make_request("/batch/1"));
+  auto batch = CallAsync(async, make_request("/batch/2"));
+  // The batch lane is full, and exceptions use the last lane.
+  EXPECT_TRUE(precheck(make_request("/batch/3")).has_value());
+  EXPECT_TRUE(precheck(make_request("/throw")).has_value());
+  // The interactive lane has its own queue, and goes first.
+  EXPECT_FALSE(precheck(make_request("/query")).has_value());
+  auto query = CallAsync(async, make_request("/query"));
+  ASSERT_EQ(pending.size(), 1);
+
+  pending[0].second(functions::HttpResponse{});
+  ASSERT_EQ(pending.size(), 2);
+  EXPECT_EQ(pending[1].first, "/query");
+  pending[1].second(functions::HttpResponse{});
+  ASSERT_EQ(pending.size(), 3);
+  EXPECT_EQ(pending[2].first, "/batch/2");
+  pending[2].second(functions::HttpResponse{});
+  for (auto* f : {&running, &batch, &query}) {
+    EXPECT_EQ(f->get().result(), http::status::ok);
+  }
+
+  options.lane_weights = {1, 0};
+  EXPECT_THROW(functions::WithConcurrencyLimit(
+                   functions::MakeFunction(SimpleHttp), options),
+               std::invalid_argument);
+}
+
+TEST(FunctionImpl, ConcurrencyLimitAdaptive) {
+  std::vector<functions::HttpResponseCallback> pending;
+  functions::ConcurrencyLimitOptions options;
+  options.adaptive = true;
+  options.min_concurrency = 2;
+  options.max_concurrency = 8;
+  options.max_queue = 8;
+  auto function = functions::WithConcurrencyLimit(
+      functions::MakeFunction([&pending](functions::HttpRequest const& /*r*/,
+                                         functions::HttpResponseCallback done) {
+        pending.push_back(std::move(done));
+      }),
+      options);
+  auto async = FunctionImpl::GetImpl(function)->GetAsyncHandler("unused");
+  ASSERT_TRUE(async);
+
+  std::vector<std::future<BeastResponse>> responses;
+  for (int i = 0; i != 4; ++i) {
+    responses.push_back(CallAsync(async, BeastRequest()));
+  }
+  // The limit starts at the minimum.
+  EXPECT_EQ(pending.size(), 2);
+  for (std::size_t i = 0; i != 2; ++i) {
+    auto done = std::move(pending[i]);
+    done(functions::HttpResponse{});
+  }
+  ASSERT_EQ(pending.size(), 4);
+  for (std::size_t i = 2; i != 4; ++i) {
+    auto done = std::move(pending[i]);
+    done(functions::HttpResponse{});
+  }
+  for (auto& r : responses) EXPECT_EQ(r.get().result(), http::status::ok);
+
+  options.min_concurrency = 16;
+  EXPECT_THROW(functions::WithConcurrencyLimit(
+                   functions::MakeFunction(SimpleHttp), options),
+               std::invalid_argument);
+}
+
+TEST(FunctionImpl, Offload) {
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  functions::OffloadOptions options;
+  options.threads = 2;
+  auto function = functions::WithOffload(
+      functions::MakeFunction([released](functions::HttpRequest const& r) {
+        if (r.target() == "/wait") released.wait();
+        std::ostringstream os;
+        os << std::this_thread::get_id();
+        return functions::HttpResponse{}.set_payload(os.str());
+      }),
+      options);
+  auto const& impl = *FunctionImpl::GetImpl(function);
+  auto async = impl.GetAsyncHandler("unused");
+  ASSERT_TRUE(async);
+
+  std::ostringstream os;
+  os << std::this_thread::get_id();
+  auto const caller = os.str();
+  // A blocked request does not delay the next one.
+  auto blocked = CallAsync(async, RouteRequest(http::verb::get, "/wait"));
+  auto other = CallAsync(async, RouteRequest(http::verb::get, "/"));
+  EXPECT_NE(other.get().body(), caller);
+  release.set_value();
+  EXPECT_NE(blocked.get().body(), caller);
+  EXPECT_NE(impl.GetHandler("unused")(BeastRequest()).body(), caller);
+
+  // The default pool is shared by all the functions.
+  auto shared = functions::WithOffload(functions::MakeFunction(
+      [](functions::HttpRequest const& /*r*/) {
+        return functions::HttpResponse{}.set_payload("shared");
+      }));
+  auto shared_async = FunctionImpl::GetImpl(shared)->GetAsyncHandler("unused");
+  ASSERT_TRUE(shared_async);
+  EXPECT_EQ(CallAsync(shared_async, BeastRequest()).get().body(), "shared");
+
+  // Streaming functions already run off the server threads.
+  auto streaming = functions::WithOffload(functions::MakeFunction(
+      [](functions::HttpRequest const& /*r*/,
+         functions::HttpResponseWriter& writer) {
+        writer.WriteHeader(functions::HttpResponse{});
+      }));
+  EXPECT_FALSE(FunctionImpl::GetImpl(streaming)->GetAsyncHandler("unused"));
+  EXPECT_TRUE(FunctionImpl::GetImpl(streaming)->GetWriterHandler("unused"));
+}
+
+TEST(FunctionImpl, Coalescing) {
+  std::vector<functions::HttpResponseCallback> pending;
+  functions::CoalescingOptions options;
+  options.key =
+      [](functions::HttpRequest const& r) -> std::optional<std::string> {
+    EXPECT_TRUE(r.payload().empty());
+    if (r.target() == "/throw") throw std::runtime_error("testing");
+    return r.target().substr(0, 2);
+  };
+  auto function = functions::WithCoalescing(
+      functions::MakeFunction(
+          [&pending](functions::HttpRequest const& /*r*/,
+                     functions::HttpResponseCallback done) {
+            pending.push_back(std::move(done));
+          }),
+      std::move(options));
+  auto async = FunctionImpl::GetImpl(function)->GetAsyncHandler("unused");
+  ASSERT_TRUE(async);
+
+  BeastRequest request;
+  request.method(http::verb::get);
+  request.target("/a/1");
+  auto a1 = CallAsync(async, request);
+  request.target("/a/2");
+  auto a2 = CallAsync(async, request);
+  // Requests without a key run on their own.
+  request.target("/throw");
+  auto unkeyed = CallAsync(async, request);
+  ASSERT_EQ(pending.size(), 2);
+
+  pending[0](functions::HttpResponse{}.set_payload("shared"));
+  pending[1](functions::HttpResponse{}.set_payload("own"));
+  EXPECT_EQ(a1.get().body(), "shared");
+  EXPECT_EQ(a2.get().body(), "shared");
+  EXPECT_EQ(unkeyed.get().body(), "own");
+}
+
+TEST(FunctionImpl, ResponseCache) {
+  int calls = 0;
+  functions::ResponseCacheOptions options;
+  options.headers = {"accept"};
+  auto function = functions::WithResponseCache(
+      functions::MakeFunction([&calls](functions::HttpRequest const& r) {
+        ++calls;
+        return functions::HttpResponse{}
+            .set_header("cache-control", "max-age=60")
+            .set_header("vary", "Accept")
+            .set_payload(r.target());
+      }),
+      std::move(options));
+  auto handler = FunctionImpl::GetImpl(function)->GetHandler("unused");
+  ASSERT_TRUE(handler);
+
+  BeastRequest request;
+  request.method(http::verb::get);
+  request.target("/a");
+  EXPECT_EQ(handler(request).body(), "/a");
+  auto cached = handler(request);
+  EXPECT_EQ(cached.body(), "/a");
+  EXPECT_EQ(cached[http::field::age], "0");
+  EXPECT_EQ(calls, 1);
+  request.set(http::field::accept, "text/plain");
+  EXPECT_EQ(handler(request).body(), "/a");
+  EXPECT_EQ(calls, 2);
+  request.method(http::verb::post);
+  EXPECT_EQ(handler(request).body(), "/a");
+  EXPECT_EQ(calls, 3);
+}
+
+TEST(FunctionImpl, RateLimit) {
+  functions::RateLimitOptions options;
+  options.requests_per_second = 0.001;
+  options.burst = 1;
+  auto function = functions::WithRateLimit(
+      functions::WithPrecheck(functions::MakeFunction(SimpleHttp),
+                              [](functions::HttpRequest const& r) {
+                                return RejectMissingHeader(r, "x-required");
+                              }),
+      options);
+  auto precheck = FunctionImpl::GetImpl(function)->GetPrecheckHandler("a");
+  ASSERT_TRUE(precheck);
+
+  BeastRequest request;
+  request.set("x-required", "1");
+  request.set("x-forwarded-for", " 10.0.0.1 , 192.168.0.1 ");
+  EXPECT_FALSE(precheck(request).has_value());
+  auto rejected = precheck(request);
+  ASSERT_TRUE(rejected.has_value());
+  EXPECT_EQ(rejected->result(), http::status::too_many_requests);
+  EXPECT_FALSE(rejected->at(http::field::retry_after).empty());
+  // Only the last address identifies the client, the others are set by the
+  // client.
+  request.set("x-forwarded-for", "10.0.0.2, 192.168.0.1");
+  EXPECT_TRUE(precheck(request).has_value());
+  request.set("x-forwarded-for", "10.0.0.1, 192.168.0.2");
+  EXPECT_FALSE(precheck(request).has_value());
+  request.set("x-forwarded-for", "10.0.0.1");
+  request.insert("x-forwarded-for", "192.168.0.2");
+  EXPECT_TRUE(precheck(request).has_value());
+
+  // Requests without the header are keyed by the peer address.
+  request.erase("x-forwarded-for");
+  {
+    ScopedPeerAddress peer("172.16.0.1");
+    EXPECT_FALSE(precheck(request).has_value());
+    EXPECT_TRUE(precheck(request).has_value());
+  }
+  {
+    ScopedPeerAddress peer("172.16.0.2");
+    EXPECT_FALSE(precheck(request).has_value());
+  }
+
+  // The inner checks still apply.
+  request.set("x-forwarded-for", "10.0.0.3");
+  request.erase("x-required");
+  auto forbidden = precheck(request);
+  ASSERT_TRUE(forbidden.has_value());
+  EXPECT_EQ(forbidden->result(), http::status::forbidden);
+}
+
+TEST(FunctionImpl, RateLimitKey) {
+  functions::RateLimitOptions options;
+  options.requests_per_second = 0.001;
+  options.burst = 1;
+  options.key =
+      [](functions::HttpRequest const& r) -> std::optional<std::string> {
+    if (r.target() == "/throw") throw std::runtime_error("testing");
+    return r.target();
+  };
+  auto function =
+      functions::WithRateLimit(functions::MakeFunction(SimpleHttp), options);
+  auto precheck = FunctionImpl::GetImpl(function)->GetPrecheckHandler("a");
+  ASSERT_TRUE(precheck);
+
+  EXPECT_FALSE(precheck(RouteRequest(http::verb::get, "/a")).has_value());
+  auto rejected = precheck(RouteRequest(http::verb::get, "/a"));
+  ASSERT_TRUE(rejected.has_value());
+  EXPECT_EQ(rejected->result(), http::status::too_many_requests);
+  EXPECT_FALSE(precheck(RouteRequest(http::verb::get, "/b")).has_value());
+  // Errors in the key function skip the limit.
+  EXPECT_FALSE(precheck(RouteRequest(http::verb::get, "/throw")).has_value());
+  EXPECT_FALSE(precheck(RouteRequest(http::verb::get, "/throw")).has_value());
+}
+
+TEST(FunctionImpl, RouterAsync) {
+  auto make = [](std::string name) {
+    return functions::MakeFunction(
+        [name = std::move(name)](functions::HttpRequest const& /*r*/) {
+          return functions::HttpResponse{}.set_payload(name);
+        });
+  };
+  auto sync = functions::MakeRouter({{"/a", make("a")}});
+  EXPECT_FALSE(FunctionImpl::GetImpl(sync)->GetAsyncHandler("unused"));
+
+  auto function = functions::MakeRouter({
+      {"/a", make("a")},
+      {"/b", functions::WithConcurrencyLimit(make("b"), {})},
+  });
+  auto async = FunctionImpl::GetImpl(function)->GetAsyncHandler("unused");
+  ASSERT_TRUE(async);
+  EXPECT_EQ(CallAsync(async, RouteRequest(http::verb::get, "/a")).get().body(),
+            "a");
+  EXPECT_EQ(CallAsync(async, RouteRequest(http::verb::get, "/b")).get().body(),
+            "b");
+  auto not_found = CallAsync(async, RouteRequest(http::verb::get, "/c")).get();
+  EXPECT_EQ(not_found.result(), http::status::not_found);
+}
+
+TEST(FunctionImpl, RouterWebSocket) {
+  auto http = functions::MakeFunction([](functions::HttpRequest const& /*r*/) {
+    return functions::HttpResponse{}.set_payload("http");
+  });
+  auto plain = functions::MakeRouter({{"/a", http}});
+  EXPECT_FALSE(FunctionImpl::GetImpl(plain)->GetWebSocketHandler("unused"));
+
+  auto called = std::make_shared<int>(0);
+  auto ws = functions::MakeWebSocketFunction(
+      [called](functions::HttpRequest const& /*r*/,
+               std::shared_ptr<functions::WebSocket> const& /*socket*/) {
+        ++*called;
+        return functions::WebSocketCallbacks{};
+      });
+  auto function = functions::MakeRouter({{"/a", http}, {"/ws", ws}});
+  auto handler = FunctionImpl::GetImpl(function)->GetWebSocketHandler("unused");
+  ASSERT_TRUE(handler);
+  functions::WebSocketCallbacks callbacks;
+  EXPECT_FALSE(handler(RouteRequest(http::verb::get, "/ws"), {}, callbacks));
+  EXPECT_EQ(*called, 1);
+  auto rejected = handler(RouteRequest(http::verb::get, "/a"), {}, callbacks);
+  ASSERT_TRUE(rejected);
+  EXPECT_EQ(rejected->body(), "http");
+  rejected = handler(RouteRequest(http::verb::get, "/b"), {}, callbacks);
+  ASSERT_TRUE(rejected);
+  EXPECT_EQ(rejected->result(), http::status::not_found);
+
+  // Plain HTTP requests for the WebSocket route get `426 Upgrade Required`.
+  auto const response = FunctionImpl::GetImpl(function)->GetHandler("unused")(
+      RouteRequest(http::verb::get, "/ws"));
+  EXPECT_EQ(response.result(), http::status::upgrade_required);
+  EXPECT_EQ(*called, 1);
+}
+
 }  // namespace
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions_internal
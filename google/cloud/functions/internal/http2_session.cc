@@ -0,0 +1,480 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/http2_session.h"
+#include "google/cloud/functions/internal/base64_decode.h"
+#include "google/cloud/functions/internal/http_date.h"
+#include "google/cloud/functions/internal/rate_limiter.h"
+#include "google/cloud/functions/internal/structured_log.h"
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/version.hpp>
+#include <nghttp2/nghttp2.h>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace asio = ::boost::asio;
+namespace be = ::boost::beast;
+
+auto constexpr kPreface = std::string_view{"PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"};
+auto constexpr kSwitchingProtocols = std::string_view{
+    "HTTP/1.1 101 Switching Protocols\r\n"
+    "Connection: Upgrade\r\n"
+    "Upgrade: h2c\r\n\r\n"};
+auto constexpr kHttp2Settings = std::string_view{"HTTP2-Settings"};
+auto constexpr kHttp2Version = 20;  // 2.0 as Boost.Beast spells it
+auto constexpr kReadSize = 16 * 1024;
+auto constexpr kMaxWriteSize = 64 * 1024;
+
+std::string_view ToStringView(std::uint8_t const* data, std::size_t size) {
+  return {reinterpret_cast<char const*>(data), size};
+}
+
+/// HTTP/2 forbids the HTTP/1.1 connection-specific header fields.
+bool IsConnectionSpecific(std::string_view name) {
+  return name == "connection" || name == "keep-alive" ||
+         name == "proxy-connection" || name == "transfer-encoding" ||
+         name == "upgrade";
+}
+
+std::string ToLower(std::string_view name) {
+  std::string lower(name);
+  std::transform(lower.begin(), lower.end(), lower.begin(), [](char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+  });
+  return lower;
+}
+
+/// Decodes the `HTTP2-Settings` header, which uses the URL-safe alphabet.
+std::string DecodeSettings(std::string_view value) {
+  return Base64Decode(value, Base64Alphabet::kUrlSafe);
+}
+
+asio::io_context& GetContext(asio::generic::stream_protocol::socket& socket) {
+  return static_cast<asio::io_context&>(
+      asio::query(socket.get_executor(), asio::execution::context));
+}
+
+}  // namespace
+
+bool IsHttp2Preface(std::string_view data) {
+  return data.substr(0, kPreface.size()) == kPreface;
+}
+
+bool IsHttp2PrefacePrefix(std::string_view data) {
+  auto const n = std::min(data.size(), kPreface.size());
+  return data.substr(0, n) == kPreface.substr(0, n);
+}
+
+bool IsHttp2Upgrade(BeastRequest const& request) {
+  return be::http::token_list{request[be::http::field::upgrade]}.exists(
+             "h2c") &&
+         request.find(kHttp2Settings) != request.end();
+}
+
+struct Http2Session::Stream {
+  BeastRequest request;
+  BeastResponse response;
+  std::size_t header_size = 0;
+  // The number of body bytes already sent.
+  std::uint64_t offset = 0;
+  bool head = false;
+  std::optional<be::http::status> reject;
+  // Set if the response was sent before the request completed.
+  bool responded = false;
+};
+
+/// The nghttp2 callbacks, @p user_data is always the session.
+struct Http2Session::Callbacks {
+  static Http2Session& Self(void* user_data) {
+    return *static_cast<Http2Session*>(user_data);
+  }
+
+  static Stream* Find(Http2Session& self, std::int32_t stream_id) {
+    auto i = self.streams_.find(stream_id);
+    if (i == self.streams_.end()) return nullptr;
+    return i->second.get();
+  }
+
+  static int OnBeginHeaders(nghttp2_session* /*session*/,
+                            nghttp2_frame const* frame, void* user_data) {
+    if (frame->hd.type != NGHTTP2_HEADERS ||
+        frame->headers.cat != NGHTTP2_HCAT_REQUEST) {
+      return 0;
+    }
+    auto& self = Self(user_data);
+    auto stream = std::make_unique<Stream>();
+    stream->request.version(kHttp2Version);
+    self.streams_.emplace(frame->hd.stream_id, std::move(stream));
+    self.idle_timer_.cancel();
+    return 0;
+  }
+
+  static int OnHeader(nghttp2_session* /*session*/, nghttp2_frame const* frame,
+                      std::uint8_t const* name, std::size_t namelen,
+                      std::uint8_t const* value, std::size_t valuelen,
+                      std::uint8_t /*flags*/, void* user_data) {
+    auto& self = Self(user_data);
+    auto* stream = Find(self, frame->hd.stream_id);
+    if (stream == nullptr || stream->reject) return 0;
+    stream->header_size += namelen + valuelen;
+    if (stream->header_size > self.options_.max_header_size) {
+      stream->reject = be::http::status::request_header_fields_too_large;
+      return 0;
+    }
+    auto const n = ToStringView(name, namelen);
+    auto const v = ToStringView(value, valuelen);
+    auto& request = stream->request;
+    if (n == ":method") {
+      request.method_string(v);
+      stream->head = v == "HEAD";
+    } else if (n == ":path") {
+      request.target(v);
+    } else if (n == ":authority") {
+      request.set(be::http::field::host, v);
+    } else if (!n.empty() && n.front() != ':') {
+      request.insert(n, v);
+    }
+    return 0;
+  }
+
+  static int OnDataChunk(nghttp2_session* /*session*/, std::uint8_t /*flags*/,
+                         std::int32_t stream_id, std::uint8_t const* data,
+                         std::size_t len, void* user_data) {
+    auto& self = Self(user_data);
+    auto* stream = Find(self, stream_id);
+    if (stream == nullptr || stream->reject || stream->responded) return 0;
+    auto& body = stream->request.body();
+    if (body.size() + len > self.options_.max_body_size) {
+      stream->reject = be::http::status::payload_too_large;
+      body.clear();
+      return 0;
+    }
+    body.append(ToStringView(data, len));
+    return 0;
+  }
+
+  static int OnFrameReceived(nghttp2_session* /*session*/,
+                             nghttp2_frame const* frame, void* user_data) {
+    if (frame->hd.type != NGHTTP2_DATA && frame->hd.type != NGHTTP2_HEADERS) {
+      return 0;
+    }
+    auto& self = Self(user_data);
+    if (frame->hd.type == NGHTTP2_HEADERS &&
+        frame->headers.cat == NGHTTP2_HCAT_REQUEST) {
+      self.Precheck(frame->hd.stream_id);
+    }
+    if ((frame->hd.flags & NGHTTP2_FLAG_END_STREAM) == 0) return 0;
+    self.Dispatch(frame->hd.stream_id);
+    return 0;
+  }
+
+  static int OnStreamClose(nghttp2_session* /*session*/, std::int32_t stream_id,
+                           std::uint32_t /*error_code*/, void* user_data) {
+    auto& self = Self(user_data);
+    self.streams_.erase(stream_id);
+    if (self.streams_.empty()) self.DoIdleTimer();
+    return 0;
+  }
+
+  static ssize_t ReadBody(nghttp2_session* /*session*/,
+                          std::int32_t /*stream_id*/, std::uint8_t* buf,
+                          std::size_t length, std::uint32_t* data_flags,
+                          nghttp2_data_source* source, void* /*user_data*/) {
+    auto& stream = *static_cast<Stream*>(source->ptr);
+    auto const& body = stream.response.body();
+    auto const n = static_cast<std::size_t>(
+        std::min<std::uint64_t>(length, body.size() - stream.offset));
+    if (auto const* segment = body.file()) {
+      be::error_code ec;
+      segment->file->seek(segment->offset + stream.offset, ec);
+      if (!ec && segment->file->read(buf, n, ec) != n) {
+        ec = be::http::error::short_read;
+      }
+      if (ec) return NGHTTP2_ERR_TEMPORAL_CALLBACK_FAILURE;
+    } else {
+      std::memcpy(buf, body.str().data() + stream.offset, n);
+    }
+    stream.offset += n;
+    if (stream.offset == body.size()) *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+    return static_cast<ssize_t>(n);
+  }
+};
+
+Http2Session::Http2Session(asio::generic::stream_protocol::socket socket,
+                           Http2Options options, Handler const& handler,
+                           PrecheckHandler const& precheck,
+                           std::shared_ptr<void> owner)
+    : owner_(std::move(owner)),
+      socket_(std::move(socket)),
+      peer_address_(PeerAddress(socket_)),
+      options_(options),
+      handler_(handler),
+      precheck_(precheck),
+      idle_timer_(socket_.get_executor()) {}
+
+Http2Session::~Http2Session() {
+  // Release the streams first, their requests may use memory from the owner.
+  streams_.clear();
+  if (session_ != nullptr) nghttp2_session_del(session_);
+}
+
+void Http2Session::Start(std::string_view data) {
+  Initialize(nullptr, false);
+  DoIdleTimer();
+  Receive(data);
+  DoWrite();
+  DoRead();
+}
+
+void Http2Session::StartUpgrade(BeastRequest request, std::string_view data) {
+  std::string settings;
+  try {
+    settings = DecodeSettings(request[kHttp2Settings]);
+  } catch (std::exception const&) {
+    return Close();
+  }
+  write_buffer_ = std::string(kSwitchingProtocols);
+  auto stream = std::make_unique<Stream>();
+  stream->head = request.method() == be::http::verb::head;
+  request.erase(be::http::field::connection);
+  request.erase(be::http::field::upgrade);
+  request.erase(kHttp2Settings);
+  stream->request = std::move(request);
+  Initialize(&settings, stream->head);
+  if (closed_) return;
+  // The upgraded request is stream 1, and it is already half-closed.
+  streams_.emplace(1, std::move(stream));
+  Dispatch(1);
+  Receive(data);
+  DoWrite();
+  DoRead();
+}
+
+void Http2Session::Drain() {
+  asio::dispatch(socket_.get_executor(), [self = shared_from_this()] {
+    if (self->closed_) return;
+    nghttp2_submit_goaway(self->session_, NGHTTP2_FLAG_NONE,
+                          nghttp2_session_get_last_proc_stream_id(
+                              self->session_),
+                          NGHTTP2_NO_ERROR, nullptr, 0);
+    self->DoWrite();
+  });
+}
+
+void Http2Session::Abort() {
+  asio::dispatch(socket_.get_executor(),
+                 [self = shared_from_this()] { self->Close(); });
+}
+
+void Http2Session::Initialize(std::string const* upgrade_settings,
+                              bool head_request) {
+  nghttp2_session_callbacks* callbacks = nullptr;
+  nghttp2_session_callbacks_new(&callbacks);
+  nghttp2_session_callbacks_set_on_begin_headers_callback(
+      callbacks, &Callbacks::OnBeginHeaders);
+  nghttp2_session_callbacks_set_on_header_callback(callbacks,
+                                                   &Callbacks::OnHeader);
+  nghttp2_session_callbacks_set_on_data_chunk_recv_callback(
+      callbacks, &Callbacks::OnDataChunk);
+  nghttp2_session_callbacks_set_on_frame_recv_callback(
+      callbacks, &Callbacks::OnFrameReceived);
+  nghttp2_session_callbacks_set_on_stream_close_callback(
+      callbacks, &Callbacks::OnStreamClose);
+  nghttp2_session_server_new(&session_, callbacks, this);
+  nghttp2_session_callbacks_del(callbacks);
+
+  if (upgrade_settings != nullptr) {
+    auto const rv = nghttp2_session_upgrade2(
+        session_,
+        reinterpret_cast<std::uint8_t const*>(upgrade_settings->data()),
+        upgrade_settings->size(), head_request ? 1 : 0, nullptr);
+    if (rv != 0) return Close();
+  }
+  std::array<nghttp2_settings_entry, 2> settings{{
+      {NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS,
+       options_.max_concurrent_streams},
+      {NGHTTP2_SETTINGS_MAX_HEADER_LIST_SIZE, options_.max_header_size},
+  }};
+  nghttp2_submit_settings(session_, NGHTTP2_FLAG_NONE, settings.data(),
+                          settings.size());
+}
+
+void Http2Session::Receive(std::string_view data) {
+  if (data.empty()) return;
+  auto const rv = nghttp2_session_mem_recv(
+      session_, reinterpret_cast<std::uint8_t const*>(data.data()),
+      data.size());
+  if (rv >= 0) return;
+  WriteLog(functions::LogSeverity::kError,
+           std::string("http2: ") + nghttp2_strerror(static_cast<int>(rv)));
+  Close();
+}
+
+void Http2Session::Precheck(std::int32_t stream_id) {
+  auto* stream = Callbacks::Find(*this, stream_id);
+  if (stream == nullptr || stream->reject || !precheck_) return;
+  ScopedPeerAddress peer(peer_address_);
+  auto response = precheck_(stream->request);
+  if (!response) return;
+  stream->responded = true;
+  stream->request = {};
+  SubmitResponse(stream_id, *std::move(response));
+}
+
+void Http2Session::Dispatch(std::int32_t stream_id) {
+  auto* stream = Callbacks::Find(*this, stream_id);
+  if (stream == nullptr || stream->responded) return;
+  if (stream->reject) {
+    BeastResponse response;
+    response.result(*stream->reject);
+    return SubmitResponse(stream_id, std::move(response));
+  }
+  ++in_flight_;
+  // The handler may run in any of the threads serving this event loop.
+  asio::post(GetContext(socket_), [self = shared_from_this(), stream_id,
+                                   request =
+                                       std::move(stream->request)]() mutable {
+    auto response = self->handler_(std::move(request));
+    auto executor = self->socket_.get_executor();
+    asio::dispatch(executor, [self = std::move(self), stream_id,
+                              r = std::move(response)]() mutable {
+      --self->in_flight_;
+      if (self->closed_) return;
+      self->SubmitResponse(stream_id, std::move(r));
+      self->DoWrite();
+    });
+  });
+}
+
+void Http2Session::SubmitResponse(std::int32_t stream_id,
+                                  BeastResponse response) {
+  auto* stream = Callbacks::Find(*this, stream_id);
+  // The client may have reset the stream while the handler was running.
+  if (stream == nullptr) return;
+  stream->response = std::move(response);
+  auto const& r = stream->response;
+
+  std::vector<std::pair<std::string, std::string>> fields;
+  fields.emplace_back(":status", std::to_string(r.result_int()));
+  for (auto const& f : r) {
+    auto name = ToLower(f.name_string());
+    if (IsConnectionSpecific(name) || name == "content-length") continue;
+    fields.emplace_back(std::move(name), std::string(f.value()));
+  }
+  if (r.find(be::http::field::server) == r.end()) {
+    fields.emplace_back("server", BOOST_BEAST_VERSION_STRING);
+  }
+  if (r.find(be::http::field::date) == r.end()) {
+    fields.emplace_back("date", std::string(CurrentHttpDate()));
+  }
+  fields.emplace_back("content-length", std::to_string(r.body().size()));
+  std::vector<nghttp2_nv> nv;
+  nv.reserve(fields.size());
+  for (auto& f : fields) {
+    nv.push_back({reinterpret_cast<std::uint8_t*>(f.first.data()),
+                  reinterpret_cast<std::uint8_t*>(f.second.data()),
+                  f.first.size(), f.second.size(), NGHTTP2_NV_FLAG_NONE});
+  }
+  nghttp2_data_provider provider;
+  provider.source.ptr = stream;
+  provider.read_callback = &Callbacks::ReadBody;
+  auto const has_body = !stream->head && !r.body().empty();
+  // nghttp2 copies the header fields.
+  nghttp2_submit_response(session_, stream_id, nv.data(), nv.size(),
+                          has_body ? &provider : nullptr);
+}
+
+void Http2Session::DoRead() {
+  if (read_closed_ || closed_) return;
+  read_buffer_.resize(kReadSize);
+  socket_.async_read_some(
+      asio::buffer(read_buffer_),
+      [self = shared_from_this()](be::error_code ec, std::size_t n) {
+        if (ec) {
+          self->read_closed_ = true;
+          return self->MaybeClose();
+        }
+        self->Receive(std::string_view(self->read_buffer_.data(), n));
+        if (self->closed_) return;
+        self->DoWrite();
+        if (nghttp2_session_want_read(self->session_) == 0) {
+          return self->MaybeClose();
+        }
+        self->DoRead();
+      });
+}
+
+void Http2Session::DoWrite() {
+  if (writing_ || closed_) return;
+  while (write_buffer_.size() < kMaxWriteSize) {
+    std::uint8_t const* data = nullptr;
+    auto const n = nghttp2_session_mem_send(session_, &data);
+    if (n < 0) return Close();
+    if (n == 0) break;
+    write_buffer_.append(ToStringView(data, static_cast<std::size_t>(n)));
+  }
+  if (write_buffer_.empty()) return MaybeClose();
+  writing_ = true;
+  asio::async_write(
+      socket_, asio::buffer(write_buffer_),
+      [self = shared_from_this()](be::error_code ec, std::size_t) {
+        self->writing_ = false;
+        self->write_buffer_.clear();
+        if (ec) return self->Close();
+        self->DoWrite();
+      });
+}
+
+void Http2Session::DoIdleTimer() {
+  if (options_.idle_timeout == std::chrono::seconds(0) || closed_) return;
+  idle_timer_.expires_after(options_.idle_timeout);
+  idle_timer_.async_wait([w = weak_from_this()](be::error_code ec) {
+    auto self = w.lock();
+    if (ec || !self || self->closed_ || !self->streams_.empty()) return;
+    nghttp2_session_terminate_session(self->session_, NGHTTP2_NO_ERROR);
+    self->DoWrite();
+  });
+}
+
+void Http2Session::MaybeClose() {
+  if (closed_ || writing_ || in_flight_ != 0) return;
+  if (!read_closed_ && nghttp2_session_want_read(session_) != 0) return;
+  Close();
+}
+
+void Http2Session::Close() {
+  if (closed_) return;
+  closed_ = true;
+  idle_timer_.cancel();
+  be::error_code ec;
+  socket_.shutdown(asio::socket_base::shutdown_both, ec);
+  socket_.close(ec);
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
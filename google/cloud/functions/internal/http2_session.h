@@ -0,0 +1,130 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_HTTP2_SESSION_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_HTTP2_SESSION_H
+
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/version.h"
+#include <boost/asio/generic/stream_protocol.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+
+struct nghttp2_session;
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// The configuration for HTTP/2 sessions.
+struct Http2Options {
+  /// Close the connection after this long without streams, 0 means never.
+  std::chrono::seconds idle_timeout;
+  std::uint32_t max_header_size;
+  std::uint64_t max_body_size;
+  std::uint32_t max_concurrent_streams;
+};
+
+/// Returns `true` if @p data starts with the HTTP/2 client connection preface.
+bool IsHttp2Preface(std::string_view data);
+
+/// Returns `true` if @p data may be the start of the connection preface.
+bool IsHttp2PrefacePrefix(std::string_view data);
+
+/// Returns `true` if @p request asks to upgrade the connection to h2c.
+bool IsHttp2Upgrade(BeastRequest const& request);
+
+/**
+ * Serves HTTP/2 over a cleartext TCP connection (h2c).
+ *
+ * Each stream carries one request, the requests run concurrently in the
+ * threads serving the event loop, and their responses are multiplexed over
+ * the connection. All the protocol work, including HPACK and flow control, is
+ * done by nghttp2, the session only moves bytes between nghttp2 and the
+ * socket.
+ *
+ * If @p precheck rejects a request its response is sent as soon as the
+ * request headers are received, and the request body is discarded.
+ *
+ * The session keeps @p owner alive until the connection closes.
+ */
+class Http2Session : public std::enable_shared_from_this<Http2Session> {
+ public:
+  Http2Session(boost::asio::generic::stream_protocol::socket socket,
+               Http2Options options, Handler const& handler,
+               PrecheckHandler const& precheck, std::shared_ptr<void> owner);
+  ~Http2Session();
+
+  Http2Session(Http2Session const&) = delete;
+  Http2Session& operator=(Http2Session const&) = delete;
+
+  /// Starts a session with prior knowledge, @p data was already received.
+  void Start(std::string_view data);
+
+  /**
+   * Starts a session upgraded from HTTP/1.1.
+   *
+   * Sends the `101 Switching Protocols` response, and then the response for
+   * @p request as stream 1. @p data was already received after @p request.
+   */
+  void StartUpgrade(BeastRequest request, std::string_view data);
+
+  /// Sends `GOAWAY`, and closes the connection once all streams complete.
+  void Drain();
+
+  /// Closes the connection, even if streams are in progress.
+  void Abort();
+
+ private:
+  struct Stream;
+  struct Callbacks;
+
+  void Initialize(std::string const* upgrade_settings, bool head_request);
+  void Receive(std::string_view data);
+  void Precheck(std::int32_t stream_id);
+  void Dispatch(std::int32_t stream_id);
+  void SubmitResponse(std::int32_t stream_id, BeastResponse response);
+  void DoRead();
+  void DoWrite();
+  void DoIdleTimer();
+  void MaybeClose();
+  void Close();
+
+  // Released last, the owner may hold memory used by the upgraded request.
+  std::shared_ptr<void> owner_;
+  boost::asio::generic::stream_protocol::socket socket_;
+  std::string peer_address_;
+  Http2Options options_;
+  Handler const& handler_;
+  PrecheckHandler const& precheck_;
+  boost::asio::steady_timer idle_timer_;
+  nghttp2_session* session_ = nullptr;
+  std::map<std::int32_t, std::unique_ptr<Stream>> streams_;
+  std::string read_buffer_;
+  std::string write_buffer_;
+  int in_flight_ = 0;
+  bool writing_ = false;
+  bool read_closed_ = false;
+  bool closed_ = false;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_HTTP2_SESSION_H
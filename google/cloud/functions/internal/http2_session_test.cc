@@ -0,0 +1,356 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/http2_session.h"
+#include "google/cloud/functions/internal/framework_impl.h"
+#include "google/cloud/functions/framework.h"
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/beast.hpp>
+#include <gmock/gmock.h>
+#include <nghttp2/nghttp2.h>
+#include <chrono>
+#include <future>
+#include <list>
+#include <map>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace be = ::boost::beast;
+using tcp = ::boost::asio::ip::tcp;
+using ::testing::Contains;
+using ::testing::Pair;
+
+struct TestResponse {
+  std::map<std::string, std::string> headers;
+  std::string body;
+};
+
+/// A minimal, blocking, HTTP/2 client.
+class TestClient {
+ public:
+  explicit TestClient(tcp::socket& socket) : socket_(socket) {
+    nghttp2_session_callbacks* callbacks = nullptr;
+    nghttp2_session_callbacks_new(&callbacks);
+    nghttp2_session_callbacks_set_on_header_callback(callbacks, &OnHeader);
+    nghttp2_session_callbacks_set_on_data_chunk_recv_callback(callbacks,
+                                                              &OnData);
+    nghttp2_session_callbacks_set_on_stream_close_callback(callbacks,
+                                                           &OnClose);
+    nghttp2_session_client_new(&session_, callbacks, this);
+    nghttp2_session_callbacks_del(callbacks);
+  }
+  ~TestClient() { nghttp2_session_del(session_); }
+
+  /// Continues an upgraded connection, the request is stream 1.
+  void Upgrade(std::string const& settings) {
+    nghttp2_session_upgrade2(
+        session_, reinterpret_cast<std::uint8_t const*>(settings.data()),
+        settings.size(), 0, nullptr);
+  }
+
+  void Start() {
+    nghttp2_submit_settings(session_, NGHTTP2_FLAG_NONE, nullptr, 0);
+  }
+
+  std::int32_t Submit(std::string method, std::string path,
+                      std::string body = {}) {
+    std::vector<std::pair<std::string, std::string>> fields{
+        {":method", std::move(method)},
+        {":scheme", "http"},
+        {":path", std::move(path)},
+        {":authority", "localhost"},
+        {"x-test-header", "test-value"}};
+    std::vector<nghttp2_nv> nv;
+    for (auto& f : fields) {
+      nv.push_back({reinterpret_cast<std::uint8_t*>(f.first.data()),
+                    reinterpret_cast<std::uint8_t*>(f.second.data()),
+                    f.first.size(), f.second.size(), NGHTTP2_NV_FLAG_NONE});
+    }
+    auto const has_body = !body.empty();
+    bodies_.push_back(std::move(body));
+    nghttp2_data_provider provider;
+    provider.source.ptr = &bodies_.back();
+    provider.read_callback = &ReadBody;
+    return nghttp2_submit_request(session_, nullptr, nv.data(), nv.size(),
+                                  has_body ? &provider : nullptr, nullptr);
+  }
+
+  /// Feeds data received before the client took over the connection.
+  void Receive(std::string_view data) {
+    nghttp2_session_mem_recv(
+        session_, reinterpret_cast<std::uint8_t const*>(data.data()),
+        data.size());
+  }
+
+  /// Runs the session until @p count streams have closed.
+  void Run(std::size_t count) {
+    while (closed_ < count) {
+      std::uint8_t const* data = nullptr;
+      for (auto n = nghttp2_session_mem_send(session_, &data); n > 0;
+           n = nghttp2_session_mem_send(session_, &data)) {
+        boost::asio::write(socket_,
+                           boost::asio::buffer(data, static_cast<int>(n)));
+      }
+      if (closed_ >= count) break;
+      std::array<char, 16 * 1024> buffer;
+      auto const n = socket_.read_some(boost::asio::buffer(buffer));
+      Receive(std::string_view(buffer.data(), n));
+    }
+  }
+
+  std::map<std::int32_t, TestResponse> responses;
+
+ private:
+  static TestClient& Self(void* user_data) {
+    return *static_cast<TestClient*>(user_data);
+  }
+
+  static int OnHeader(nghttp2_session*, nghttp2_frame const* frame,
+                      std::uint8_t const* name, std::size_t namelen,
+                      std::uint8_t const* value, std::size_t valuelen,
+                      std::uint8_t, void* user_data) {
+    Self(user_data).responses[frame->hd.stream_id].headers.emplace(
+        std::string(reinterpret_cast<char const*>(name), namelen),
+        std::string(reinterpret_cast<char const*>(value), valuelen));
+    return 0;
+  }
+
+  static int OnData(nghttp2_session*, std::uint8_t, std::int32_t stream_id,
+                    std::uint8_t const* data, std::size_t len,
+                    void* user_data) {
+    Self(user_data).responses[stream_id].body.append(
+        reinterpret_cast<char const*>(data), len);
+    return 0;
+  }
+
+  static int OnClose(nghttp2_session*, std::int32_t, std::uint32_t,
+                     void* user_data) {
+    ++Self(user_data).closed_;
+    return 0;
+  }
+
+  static ssize_t ReadBody(nghttp2_session*, std::int32_t, std::uint8_t* buf,
+                          std::size_t length, std::uint32_t* data_flags,
+                          nghttp2_data_source* source, void*) {
+    auto& body = *static_cast<std::string*>(source->ptr);
+    auto const n = std::min(length, body.size());
+    std::copy_n(body.data(), n, buf);
+    body.erase(0, n);
+    if (body.empty()) *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+    return static_cast<ssize_t>(n);
+  }
+
+  tcp::socket& socket_;
+  nghttp2_session* session_ = nullptr;
+  // The request bodies must remain stable while nghttp2 sends them.
+  std::list<std::string> bodies_;
+  std::size_t closed_ = 0;
+};
+
+/// Runs a server with HTTP/2 enabled until the destructor.
+class TestServer {
+ public:
+  explicit TestServer(functions::Function function) {
+    auto port_f = port_.get_future();
+    done_ = std::async(std::launch::async, [this, f = std::move(function)] {
+      char const* const argv[] = {"unused", "--port=0", "--threads=4",
+                                  "--http2", "--max-body-size=1024"};
+      auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+      return RunForTest(
+          static_cast<int>(kArgc), argv, f,
+          [this] { return shutdown_.load(); },
+          [this](int port) { port_.set_value(port); });
+    });
+    port_number_ = std::to_string(port_f.get());
+  }
+
+  ~TestServer() {
+    shutdown_.store(true);
+    try {
+      // Wake up the listener, so it detects the shutdown.
+      (void)Connect();
+    } catch (...) {
+    }
+    EXPECT_EQ(done_.get(), 0);
+  }
+
+  tcp::socket Connect() {
+    tcp::resolver resolver(ioc_);
+    tcp::socket socket(ioc_);
+    boost::asio::connect(socket, resolver.resolve("localhost", port_number_));
+    return socket;
+  }
+
+ private:
+  boost::asio::io_context ioc_;
+  std::promise<int> port_;
+  std::string port_number_;
+  std::atomic<bool> shutdown_{false};
+  std::future<int> done_;
+};
+
+functions::HttpResponse EchoHandler(functions::HttpRequest const& r) {
+  if (r.target() == "/slow") {
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  }
+  auto const h = r.headers().find("x-test-header");
+  return functions::HttpResponse{}
+      .set_header("x-echo-header", h == r.headers().end() ? "" : h->second)
+      .set_payload(r.verb() + " " + r.target() + " " + r.payload());
+}
+
+TEST(Http2SessionTest, Preface) {
+  auto constexpr kPreface = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+  EXPECT_TRUE(IsHttp2Preface(kPreface));
+  EXPECT_TRUE(IsHttp2Preface(std::string(kPreface) + "more data"));
+  EXPECT_FALSE(IsHttp2Preface("PRI * HTTP/2.0\r\n"));
+  EXPECT_FALSE(IsHttp2Preface("GET / HTTP/1.1\r\n\r\n"));
+
+  EXPECT_TRUE(IsHttp2PrefacePrefix(""));
+  EXPECT_TRUE(IsHttp2PrefacePrefix("PRI * HTTP"));
+  EXPECT_TRUE(IsHttp2PrefacePrefix(kPreface));
+  EXPECT_FALSE(IsHttp2PrefacePrefix("POST / HTTP/1.1\r\n"));
+}
+
+TEST(Http2SessionTest, Upgrade) {
+  BeastRequest request;
+  EXPECT_FALSE(IsHttp2Upgrade(request));
+  request.set(be::http::field::upgrade, "websocket");
+  request.set("HTTP2-Settings", "");
+  EXPECT_FALSE(IsHttp2Upgrade(request));
+  request.set(be::http::field::upgrade, "h2c");
+  EXPECT_TRUE(IsHttp2Upgrade(request));
+  request.erase("HTTP2-Settings");
+  EXPECT_FALSE(IsHttp2Upgrade(request));
+}
+
+TEST(Http2SessionTest, PriorKnowledge) {
+  TestServer server(functions::MakeFunction(EchoHandler));
+  auto socket = server.Connect();
+  TestClient client(socket);
+  client.Start();
+  auto const start = std::chrono::steady_clock::now();
+  std::vector<std::int32_t> ids;
+  for (int i = 0; i != 3; ++i) ids.push_back(client.Submit("GET", "/slow"));
+  auto const post = client.Submit("POST", "/post", "request body");
+  auto const large = client.Submit("POST", "/large", std::string(2048, 'x'));
+  client.Run(5);
+  auto const elapsed = std::chrono::steady_clock::now() - start;
+  // The streams are multiplexed, and the handlers run concurrently.
+  EXPECT_LT(elapsed, std::chrono::milliseconds(900));
+
+  for (auto id : ids) {
+    auto const& r = client.responses[id];
+    EXPECT_THAT(r.headers, Contains(Pair(":status", "200")));
+    EXPECT_THAT(r.headers, Contains(Pair("x-echo-header", "test-value")));
+    EXPECT_THAT(r.headers, Contains(Pair("content-length", "10")));
+    EXPECT_EQ(r.body, "GET /slow ");
+  }
+  EXPECT_EQ(client.responses[post].body, "POST /post request body");
+  EXPECT_THAT(client.responses[large].headers,
+              Contains(Pair(":status", "413")));
+
+  // The HTTP/1.1 connection-specific headers are not sent.
+  for (auto const& kv : client.responses) {
+    EXPECT_EQ(kv.second.headers.count("connection"), 0);
+  }
+  socket.close();
+}
+
+TEST(Http2SessionTest, UpgradeFromHttp1) {
+  TestServer server(functions::MakeFunction(EchoHandler));
+  auto socket = server.Connect();
+
+  // SETTINGS_MAX_CONCURRENT_STREAMS = 100, base64url encoded.
+  std::string const settings{"\x00\x03\x00\x00\x00\x64", 6};
+  std::string const request =
+      "GET /upgrade HTTP/1.1\r\n"
+      "Host: localhost\r\n"
+      "x-test-header: test-value\r\n"
+      "Connection: Upgrade, HTTP2-Settings\r\n"
+      "Upgrade: h2c\r\n"
+      "HTTP2-Settings: AAMAAABk\r\n"
+      "\r\n";
+  boost::asio::write(socket, boost::asio::buffer(request));
+  std::string received;
+  auto const n = boost::asio::read_until(
+      socket, boost::asio::dynamic_buffer(received), "\r\n\r\n");
+  EXPECT_THAT(received.substr(0, n),
+              ::testing::StartsWith("HTTP/1.1 101 Switching Protocols\r\n"));
+
+  TestClient client(socket);
+  client.Upgrade(settings);
+  client.Start();
+  client.Receive(std::string_view(received).substr(n));
+  client.Run(1);
+  auto const& upgraded = client.responses[1];
+  EXPECT_THAT(upgraded.headers, Contains(Pair(":status", "200")));
+  EXPECT_THAT(upgraded.headers, Contains(Pair("x-echo-header", "test-value")));
+  EXPECT_EQ(upgraded.body, "GET /upgrade ");
+
+  // The connection continues with HTTP/2.
+  auto const id = client.Submit("GET", "/next");
+  client.Run(2);
+  EXPECT_EQ(client.responses[id].body, "GET /next ");
+  socket.close();
+}
+
+TEST(Http2SessionTest, Precheck) {
+  auto precheck = [](functions::HttpRequest const& r)
+      -> std::optional<functions::HttpResponse> {
+    if (r.target() != "/reject") return std::nullopt;
+    return functions::HttpResponse{}.set_result(
+        functions::HttpResponse::kForbidden);
+  };
+  TestServer server(functions::WithPrecheck(
+      functions::MakeFunction(EchoHandler), precheck));
+  auto socket = server.Connect();
+  TestClient client(socket);
+  client.Start();
+  auto const rejected = client.Submit("POST", "/reject", "unused");
+  auto const accepted = client.Submit("POST", "/accept", "body");
+  client.Run(2);
+  EXPECT_THAT(client.responses[rejected].headers,
+              Contains(Pair(":status", "403")));
+  EXPECT_EQ(client.responses[accepted].body, "POST /accept body");
+  socket.close();
+}
+
+TEST(Http2SessionTest, Http1StillWorks) {
+  TestServer server(functions::MakeFunction(EchoHandler));
+  auto socket = server.Connect();
+  be::http::request<be::http::string_body> req{be::http::verb::get, "/http1",
+                                               11};
+  req.set(be::http::field::host, "localhost");
+  be::http::write(socket, req);
+  be::flat_buffer buffer;
+  be::http::response<be::http::string_body> res;
+  be::http::read(socket, buffer, res);
+  EXPECT_EQ(res.result_int(), 200);
+  EXPECT_EQ(res.body(), "GET /http1 ");
+  socket.close();
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
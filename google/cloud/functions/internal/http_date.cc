@@ -0,0 +1,118 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/http_date.h"
+#include <array>
+#include <cstdint>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+auto constexpr kHttpDateSize = sizeof("Sun, 06 Nov 1994 08:49:37 GMT") - 1;
+using HttpDateBuffer = std::array<char, kHttpDateSize>;
+
+void Put2(char* p, int v) {
+  p[0] = static_cast<char>('0' + v / 10);
+  p[1] = static_cast<char>('0' + v % 10);
+}
+
+HttpDateBuffer FormatSeconds(std::int64_t seconds) {
+  static char const* const kDays[] = {"Thu", "Fri", "Sat", "Sun",
+                                      "Mon", "Tue", "Wed"};
+  static char const* const kMonths[] = {"Jan", "Feb", "Mar", "Apr",
+                                        "May", "Jun", "Jul", "Aug",
+                                        "Sep", "Oct", "Nov", "Dec"};
+  auto constexpr kSecondsPerDay = 24 * 60 * 60;
+  auto days = seconds / kSecondsPerDay;
+  auto time = seconds % kSecondsPerDay;
+  if (time < 0) {
+    time += kSecondsPerDay;
+    --days;
+  }
+  auto weekday = days % 7;
+  if (weekday < 0) weekday += 7;
+
+  // Converts days since the epoch to a civil date, see
+  //     http://howardhinnant.github.io/date_algorithms.html#civil_from_days
+  auto const z = days + 719468;
+  auto const era = (z >= 0 ? z : z - 146096) / 146097;
+  auto const doe = z - era * 146097;
+  auto const yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  auto const doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  auto const mp = (5 * doy + 2) / 153;
+  auto const day = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+  auto const month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+  auto const year = static_cast<int>(yoe + era * 400 + (month <= 2 ? 1 : 0));
+
+  HttpDateBuffer buffer;
+  auto* p = buffer.data();
+  auto const* name = kDays[weekday];
+  p[0] = name[0];
+  p[1] = name[1];
+  p[2] = name[2];
+  p[3] = ',';
+  p[4] = ' ';
+  Put2(p + 5, day);
+  p[7] = ' ';
+  name = kMonths[month - 1];
+  p[8] = name[0];
+  p[9] = name[1];
+  p[10] = name[2];
+  p[11] = ' ';
+  Put2(p + 12, year / 100 % 100);
+  Put2(p + 14, year % 100);
+  p[16] = ' ';
+  Put2(p + 17, static_cast<int>(time / 3600));
+  p[19] = ':';
+  Put2(p + 20, static_cast<int>(time / 60 % 60));
+  p[22] = ':';
+  Put2(p + 23, static_cast<int>(time % 60));
+  p[25] = ' ';
+  p[26] = 'G';
+  p[27] = 'M';
+  p[28] = 'T';
+  return buffer;
+}
+
+std::int64_t ToSeconds(std::chrono::system_clock::time_point tp) {
+  return std::chrono::floor<std::chrono::seconds>(tp.time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+std::string FormatHttpDate(std::chrono::system_clock::time_point tp) {
+  auto const buffer = FormatSeconds(ToSeconds(tp));
+  return std::string(buffer.data(), buffer.size());
+}
+
+std::string_view CurrentHttpDate() {
+  // Each thread keeps its own copy: a copy shared by all the I/O threads would
+  // need synchronization on every response, to save one format per second.
+  struct Cache {
+    std::int64_t seconds = -1;
+    HttpDateBuffer value;
+  };
+  thread_local Cache cache;
+  auto const seconds = ToSeconds(std::chrono::system_clock::now());
+  if (seconds != cache.seconds) {
+    cache.value = FormatSeconds(seconds);
+    cache.seconds = seconds;
+  }
+  return {cache.value.data(), cache.value.size()};
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
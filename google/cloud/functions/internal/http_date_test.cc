@@ -0,0 +1,60 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/http_date.h"
+#include <gmock/gmock.h>
+#include <chrono>
+#include <string>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using std::chrono::seconds;
+using std::chrono::system_clock;
+
+TEST(HttpDateTest, Format) {
+  struct Test {
+    std::int64_t seconds;
+    std::string expected;
+  } cases[] = {
+      {0, "Thu, 01 Jan 1970 00:00:00 GMT"},
+      {784111777, "Sun, 06 Nov 1994 08:49:37 GMT"},
+      {951782400, "Tue, 29 Feb 2000 00:00:00 GMT"},
+      {1798761599, "Thu, 31 Dec 2026 23:59:59 GMT"},
+      {-1, "Wed, 31 Dec 1969 23:59:59 GMT"},
+  };
+  for (auto const& t : cases) {
+    SCOPED_TRACE("Testing for " + std::to_string(t.seconds));
+    EXPECT_EQ(FormatHttpDate(system_clock::time_point(seconds(t.seconds))),
+              t.expected);
+  }
+}
+
+TEST(HttpDateTest, FormatTruncatesSubseconds) {
+  auto const tp = system_clock::time_point(seconds(784111777)) +
+                  std::chrono::milliseconds(999);
+  EXPECT_EQ(FormatHttpDate(tp), "Sun, 06 Nov 1994 08:49:37 GMT");
+}
+
+TEST(HttpDateTest, Current) {
+  auto const before = FormatHttpDate(system_clock::now());
+  auto const actual = std::string(CurrentHttpDate());
+  auto const after = FormatHttpDate(system_clock::now());
+  EXPECT_THAT(actual, ::testing::AnyOf(before, after));
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -15,17 +15,100 @@
 #ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_HTTP_MESSAGE_TYPES_H
 #define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_HTTP_MESSAGE_TYPES_H
 
+#include "google/cloud/functions/internal/response_body.h"
 #include "google/cloud/functions/version.h"
 #include <boost/beast/http.hpp>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 
+/**
+ * An allocator for the header fields of incoming requests.
+ *
+ * `std::pmr::polymorphic_allocator<>` is not assignable, and Boost.Beast
+ * requires assignable allocators for `basic_fields<>`. This is a minimal
+ * wrapper around a `std::pmr::memory_resource` that meets the requirements.
+ *
+ * The allocators created from a `std::shared_ptr<>` share the ownership of
+ * the resource, a message moved out of its connection keeps the connection's
+ * memory pool alive.
+ */
+template <typename T>
+class FieldsAllocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  FieldsAllocator() noexcept = default;
+  explicit FieldsAllocator(std::pmr::memory_resource* resource) noexcept
+      : resource_(resource) {}
+  explicit FieldsAllocator(
+      std::shared_ptr<std::pmr::memory_resource> resource) noexcept
+      : resource_(resource.get()), owner_(std::move(resource)) {}
+  template <typename U>
+  // NOLINTNEXTLINE(google-explicit-constructor)
+  FieldsAllocator(FieldsAllocator<U> const& rhs) noexcept
+      : resource_(rhs.resource_), owner_(rhs.owner_) {}
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(resource_->allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T* p, std::size_t n) noexcept {
+    resource_->deallocate(p, n * sizeof(T), alignof(T));
+  }
+
+  [[nodiscard]] std::pmr::memory_resource* resource() const noexcept {
+    return resource_;
+  }
+
+  template <typename U>
+  friend bool operator==(FieldsAllocator const& lhs,
+                         FieldsAllocator<U> const& rhs) noexcept {
+    return lhs.resource() == rhs.resource() ||
+           *lhs.resource() == *rhs.resource();
+  }
+  template <typename U>
+  friend bool operator!=(FieldsAllocator const& lhs,
+                         FieldsAllocator<U> const& rhs) noexcept {
+    return !(lhs == rhs);
+  }
+
+ private:
+  template <typename U>
+  friend class FieldsAllocator;
+
+  std::pmr::memory_resource* resource_ = std::pmr::get_default_resource();
+  std::shared_ptr<std::pmr::memory_resource> owner_;
+};
+
+/**
+ * The header fields for incoming requests.
+ *
+ * The server allocates the fields from a per-connection memory pool, so
+ * requests arriving over a keep-alive connection reuse the memory released by
+ * previous requests. A default constructed request uses the default memory
+ * resource, typically the global heap.
+ *
+ * The allocator propagates, and shares the ownership of the pool. The fields
+ * of a request received by the server may outlive the connection, e.g., in a
+ * function that completes after the client disconnects.
+ */
+using BeastRequestFields =
+    boost::beast::http::basic_fields<FieldsAllocator<char>>;
+
 using BeastRequest =
-    boost::beast::http::request<boost::beast::http::string_body>;
+    boost::beast::http::request<boost::beast::http::string_body,
+                                BeastRequestFields>;
 
-using BeastResponse =
-    boost::beast::http::response<boost::beast::http::string_body>;
+/// Responses carry either a string or a file segment as their body.
+using BeastResponse = boost::beast::http::response<ResponseBody>;
 
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions_internal
@@ -0,0 +1,529 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/json_scanner.h"
+#include "google/cloud/functions/internal/base64_decode.h"
+#include <cctype>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#ifdef FUNCTIONS_FRAMEWORK_CPP_HAVE_SIMDJSON
+#include <simdjson.h>
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_SIMDJSON
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+// Deeper documents are rejected, the scanner is recursive.
+auto constexpr kMaxDepth = 512;
+
+[[noreturn]] void InvalidJson(char const* what) {
+  throw std::invalid_argument(std::string("invalid JSON: ") + what);
+}
+
+bool IsWhitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+std::string_view TrimRight(std::string_view s) {
+  while (!s.empty() && IsWhitespace(s.back())) s.remove_suffix(1);
+  return s;
+}
+
+/// A portable scanner that validates and skips JSON values.
+class Scanner {
+ public:
+  explicit Scanner(std::string_view text) : text_(text) {}
+
+  void SkipWhitespace() {
+    while (pos_ != text_.size() && IsWhitespace(text_[pos_])) ++pos_;
+  }
+
+  [[nodiscard]] bool AtEnd() const { return pos_ == text_.size(); }
+
+  [[nodiscard]] char Peek() const {
+    if (AtEnd()) InvalidJson("unexpected end of input");
+    return text_[pos_];
+  }
+
+  void Expect(char c) {
+    if (Peek() != c) InvalidJson("unexpected character");
+    ++pos_;
+  }
+
+  /// Scans the value at the current position and returns its raw text.
+  std::string_view Value() {
+    auto const start = pos_;
+    switch (Peek()) {
+      case '{':
+        ForEachMember([](std::string_view, std::string_view) { return false; });
+        break;
+      case '[':
+        ForEachElement([](std::string_view) { return false; });
+        break;
+      case '"':
+        String();
+        break;
+      case 't':
+        Literal("true");
+        break;
+      case 'f':
+        Literal("false");
+        break;
+      case 'n':
+        Literal("null");
+        break;
+      default:
+        Number();
+        break;
+    }
+    return text_.substr(start, pos_ - start);
+  }
+
+  /// Scans the whole input as a single value.
+  std::string_view Document() {
+    SkipWhitespace();
+    auto value = Value();
+    SkipWhitespace();
+    if (!AtEnd()) InvalidJson("unexpected data after the value");
+    return value;
+  }
+
+  /**
+   * Calls @p f with the key and value of each member of an object.
+   *
+   * Stops, leaving the rest of the object unscanned, if @p f returns `true`.
+   */
+  template <typename F>
+  void ForEachMember(F&& f) {
+    Expect('{');
+    Enter();
+    SkipWhitespace();
+    if (Peek() == '}') return Leave();
+    for (;;) {
+      SkipWhitespace();
+      auto key = String();
+      SkipWhitespace();
+      Expect(':');
+      SkipWhitespace();
+      auto value = Value();
+      if (f(key.substr(1, key.size() - 2), value)) return;
+      SkipWhitespace();
+      if (Peek() == '}') return Leave();
+      Expect(',');
+    }
+  }
+
+  /// Like `ForEachMember()`, for the elements of an array.
+  template <typename F>
+  void ForEachElement(F&& f) {
+    Expect('[');
+    Enter();
+    SkipWhitespace();
+    if (Peek() == ']') return Leave();
+    for (;;) {
+      SkipWhitespace();
+      if (f(Value())) return;
+      SkipWhitespace();
+      if (Peek() == ']') return Leave();
+      Expect(',');
+    }
+  }
+
+ private:
+  void Enter() {
+    if (++depth_ > kMaxDepth) InvalidJson("document is too deep");
+  }
+
+  void Leave() {
+    --depth_;
+    ++pos_;
+  }
+
+  std::string_view String() {
+    auto const start = pos_;
+    Expect('"');
+    for (;;) {
+      auto const c = Peek();
+      ++pos_;
+      if (c == '"') break;
+      if (static_cast<unsigned char>(c) < 0x20) {
+        InvalidJson("control character in string");
+      }
+      if (c != '\\') continue;
+      auto const e = Peek();
+      ++pos_;
+      if (e == 'u') {
+        for (int i = 0; i != 4; ++i, ++pos_) {
+          if (!std::isxdigit(static_cast<unsigned char>(Peek()))) {
+            InvalidJson("invalid unicode escape");
+          }
+        }
+        continue;
+      }
+      if (std::string_view(R"("\/bfnrt)").find(e) == std::string_view::npos) {
+        InvalidJson("invalid escape");
+      }
+    }
+    return text_.substr(start, pos_ - start);
+  }
+
+  void Literal(std::string_view literal) {
+    if (text_.substr(pos_, literal.size()) != literal) {
+      InvalidJson("invalid literal");
+    }
+    pos_ += literal.size();
+  }
+
+  void Digits() {
+    if (!IsDigit(Peek())) InvalidJson("invalid number");
+    while (!AtEnd() && IsDigit(text_[pos_])) ++pos_;
+  }
+
+  void Number() {
+    if (Peek() == '-') ++pos_;
+    if (Peek() == '0') {
+      ++pos_;
+    } else {
+      Digits();
+    }
+    if (!AtEnd() && text_[pos_] == '.') {
+      ++pos_;
+      Digits();
+    }
+    if (!AtEnd() && (text_[pos_] == 'e' || text_[pos_] == 'E')) {
+      ++pos_;
+      if (Peek() == '+' || Peek() == '-') ++pos_;
+      Digits();
+    }
+  }
+
+  std::string_view text_;
+  std::size_t pos_ = 0;
+  int depth_ = 0;
+};
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_HAVE_SIMDJSON
+std::string_view TrimLeft(std::string_view s) {
+  while (!s.empty() && IsWhitespace(s.front())) s.remove_prefix(1);
+  return s;
+}
+
+/// Decodes a JSON Pointer reference token, the `~0` and `~1` escapes.
+std::string PointerToken(std::string_view token) {
+  std::string result;
+  result.reserve(token.size());
+  for (std::size_t i = 0; i != token.size(); ++i) {
+    if (token[i] != '~') {
+      result.push_back(token[i]);
+      continue;
+    }
+    auto const e = i + 1 == token.size() ? '\0' : token[++i];
+    if (e != '0' && e != '1') {
+      throw std::invalid_argument("invalid JSON Pointer escape");
+    }
+    result.push_back(e == '0' ? '~' : '/');
+  }
+  return result;
+}
+
+std::optional<std::size_t> ArrayIndex(std::string_view token) {
+  if (token.empty() || (token.size() > 1 && token[0] == '0')) return {};
+  std::size_t index = 0;
+  for (auto c : token) {
+    if (!IsDigit(c)) return {};
+    index = index * 10 + static_cast<std::size_t>(c - '0');
+  }
+  return index;
+}
+
+bool KeyEquals(std::string_view key, std::string const& token) {
+  if (key.find('\\') == std::string_view::npos) return key == token;
+  return JsonUnescapeString(std::string("\"").append(key).append("\"")) ==
+         token;
+}
+
+std::optional<std::string_view> PortableFindPointer(std::string_view json,
+                                                    std::string_view pointer) {
+  auto current = TrimRight(TrimLeft(json));
+  while (!pointer.empty()) {
+    auto const end = pointer.find('/', 1);
+    auto const token = PointerToken(pointer.substr(1, end - 1));
+    pointer = end == std::string_view::npos ? std::string_view{}
+                                            : pointer.substr(end);
+    if (current.empty()) return std::nullopt;
+    std::optional<std::string_view> next;
+    Scanner scanner(current);
+    if (current.front() == '{') {
+      scanner.ForEachMember([&](std::string_view key, std::string_view value) {
+        if (!KeyEquals(key, token)) return false;
+        next = value;
+        return true;
+      });
+    } else if (current.front() == '[') {
+      auto const index = ArrayIndex(token);
+      if (!index) return std::nullopt;
+      std::size_t i = 0;
+      scanner.ForEachElement([&](std::string_view value) {
+        if (i++ != *index) return false;
+        next = value;
+        return true;
+      });
+    }
+    if (!next) return std::nullopt;
+    current = *next;
+  }
+  return Scanner(current).Value();
+}
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_SIMDJSON
+
+#ifdef FUNCTIONS_FRAMEWORK_CPP_HAVE_SIMDJSON
+namespace sj = ::simdjson;
+
+/// The per-thread simdjson parser, and a buffer for the padded input.
+struct SimdjsonState {
+  sj::ondemand::parser parser;
+  std::string buffer;
+};
+
+SimdjsonState& State() {
+  thread_local SimdjsonState state;
+  return state;
+}
+
+/// Returns the value in @p r, or throws if it holds an error.
+template <typename T, typename Result>
+T Get(Result&& r) {
+  T value;
+  auto const error = std::forward<Result>(r).get(value);
+  if (error != sj::SUCCESS) InvalidJson(sj::error_message(error));
+  return value;
+}
+
+/// Copies @p json to the padded buffer and starts iterating it.
+sj::ondemand::document Iterate(SimdjsonState& state, std::string_view json) {
+  state.buffer.reserve(json.size() + sj::SIMDJSON_PADDING);
+  state.buffer.assign(json);
+  return Get<sj::ondemand::document>(state.parser.iterate(
+      sj::padded_string_view(state.buffer.data(), json.size(),
+                             state.buffer.capacity())));
+}
+
+/// Maps a view of the padded buffer to the same bytes in @p json.
+std::string_view Rebase(SimdjsonState const& state, std::string_view json,
+                        std::string_view v) {
+  return json.substr(v.data() - state.buffer.data(), v.size());
+}
+
+std::string_view RawJson(SimdjsonState const& state, std::string_view json,
+                         sj::ondemand::value& value) {
+  return Rebase(state, json,
+                TrimRight(Get<std::string_view>(value.raw_json())));
+}
+
+void CheckAtEnd(sj::ondemand::document& doc) {
+  if (!doc.at_end()) InvalidJson("unexpected data after the value");
+}
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_SIMDJSON
+
+}  // namespace
+
+#ifdef FUNCTIONS_FRAMEWORK_CPP_HAVE_SIMDJSON
+std::vector<JsonMember> JsonObjectMembers(std::string_view json) {
+  auto& state = State();
+  auto doc = Iterate(state, json);
+  std::vector<JsonMember> members;
+  for (auto result : Get<sj::ondemand::object>(doc.get_object())) {
+    sj::ondemand::field field;
+    auto const error = std::move(result).get(field);
+    if (error != sj::SUCCESS) InvalidJson(sj::error_message(error));
+    auto const key = Rebase(state, json, field.escaped_key());
+    members.push_back({key, RawJson(state, json, field.value())});
+  }
+  CheckAtEnd(doc);
+  return members;
+}
+
+std::vector<std::string_view> JsonArrayElements(std::string_view json) {
+  auto& state = State();
+  auto doc = Iterate(state, json);
+  std::vector<std::string_view> elements;
+  for (auto result : Get<sj::ondemand::array>(doc.get_array())) {
+    auto element = Get<sj::ondemand::value>(std::move(result));
+    elements.push_back(RawJson(state, json, element));
+  }
+  CheckAtEnd(doc);
+  return elements;
+}
+
+std::optional<std::string_view> JsonFindPointer(std::string_view json,
+                                                std::string_view pointer) {
+  if (pointer.empty()) return Scanner(json).Document();
+  if (pointer.front() != '/') {
+    throw std::invalid_argument("JSON Pointer must start with `/`");
+  }
+  auto& state = State();
+  auto doc = Iterate(state, json);
+  sj::ondemand::value value;
+  switch (auto const error = doc.at_pointer(pointer).get(value)) {
+    case sj::SUCCESS:
+      return RawJson(state, json, value);
+    case sj::NO_SUCH_FIELD:
+    case sj::INDEX_OUT_OF_BOUNDS:
+    case sj::INCORRECT_TYPE:
+      return std::nullopt;
+    case sj::INVALID_JSON_POINTER:
+      throw std::invalid_argument("invalid JSON Pointer");
+    default:
+      InvalidJson(sj::error_message(error));
+  }
+}
+#else
+std::vector<JsonMember> JsonObjectMembers(std::string_view json) {
+  Scanner scanner(json);
+  scanner.SkipWhitespace();
+  std::vector<JsonMember> members;
+  scanner.ForEachMember([&](std::string_view key, std::string_view value) {
+    members.push_back({key, value});
+    return false;
+  });
+  scanner.SkipWhitespace();
+  if (!scanner.AtEnd()) InvalidJson("unexpected data after the value");
+  return members;
+}
+
+std::vector<std::string_view> JsonArrayElements(std::string_view json) {
+  Scanner scanner(json);
+  scanner.SkipWhitespace();
+  std::vector<std::string_view> elements;
+  scanner.ForEachElement([&](std::string_view value) {
+    elements.push_back(value);
+    return false;
+  });
+  scanner.SkipWhitespace();
+  if (!scanner.AtEnd()) InvalidJson("unexpected data after the value");
+  return elements;
+}
+
+std::optional<std::string_view> JsonFindPointer(std::string_view json,
+                                                std::string_view pointer) {
+  if (pointer.empty()) return Scanner(json).Document();
+  if (pointer.front() != '/') {
+    throw std::invalid_argument("JSON Pointer must start with `/`");
+  }
+  return PortableFindPointer(json, pointer);
+}
+#endif  // FUNCTIONS_FRAMEWORK_CPP_HAVE_SIMDJSON
+
+std::string JsonUnescapeString(std::string_view raw) {
+  if (raw.size() < 2 || raw.front() != '"' || raw.back() != '"') {
+    throw std::invalid_argument("expected a JSON string");
+  }
+  raw = raw.substr(1, raw.size() - 2);
+  if (raw.find('\\') == std::string_view::npos) return std::string(raw);
+
+  auto hex4 = [&](std::size_t i) {
+    if (i + 4 > raw.size()) InvalidJson("invalid unicode escape");
+    std::uint32_t v = 0;
+    for (auto c : raw.substr(i, 4)) {
+      auto const u = static_cast<unsigned char>(c);
+      if (!std::isxdigit(u)) InvalidJson("invalid unicode escape");
+      v = v * 16 + static_cast<std::uint32_t>(
+                       IsDigit(c) ? c - '0' : (std::tolower(u) - 'a' + 10));
+    }
+    return v;
+  };
+  auto append_utf8 = [](std::string& out, std::uint32_t cp) {
+    if (cp < 0x80) {
+      out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+      out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+      out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+      out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+      out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+      out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+      out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+  };
+
+  std::string result;
+  result.reserve(raw.size());
+  for (std::size_t i = 0; i != raw.size(); ++i) {
+    if (raw[i] != '\\') {
+      result.push_back(raw[i]);
+      continue;
+    }
+    if (++i == raw.size()) InvalidJson("invalid escape");
+    switch (raw[i]) {
+      case '"':
+      case '\\':
+      case '/':
+        result.push_back(raw[i]);
+        break;
+      case 'b':
+        result.push_back('\b');
+        break;
+      case 'f':
+        result.push_back('\f');
+        break;
+      case 'n':
+        result.push_back('\n');
+        break;
+      case 'r':
+        result.push_back('\r');
+        break;
+      case 't':
+        result.push_back('\t');
+        break;
+      case 'u': {
+        auto cp = hex4(i + 1);
+        i += 4;
+        // Combine surrogate pairs, lone surrogates are invalid.
+        if (cp >= 0xD800 && cp < 0xDC00) {
+          if (raw.substr(i + 1, 2) != "\\u") InvalidJson("lone surrogate");
+          auto const low = hex4(i + 3);
+          if (low < 0xDC00 || low >= 0xE000) InvalidJson("lone surrogate");
+          cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+          i += 6;
+        } else if (cp >= 0xDC00 && cp < 0xE000) {
+          InvalidJson("lone surrogate");
+        }
+        append_utf8(result, cp);
+        break;
+      }
+      default:
+        InvalidJson("invalid escape");
+    }
+  }
+  return result;
+}
+
+std::string JsonBase64Decode(std::string_view raw) {
+  if (raw.size() >= 2 && raw.front() == '"' && raw.back() == '"' &&
+      raw.find('\\') == std::string_view::npos) {
+    return Base64Decode(raw.substr(1, raw.size() - 2));
+  }
+  return Base64Decode(JsonUnescapeString(raw));
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,73 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_JSON_SCANNER_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_JSON_SCANNER_H
+
+#include "google/cloud/functions/version.h"
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * A member of a JSON object.
+ *
+ * Both fields refer to the scanned text. The key excludes the quotes and is
+ * not unescaped, the value is the raw JSON text of the member value.
+ */
+struct JsonMember {
+  std::string_view key;
+  std::string_view value;
+};
+
+/*
+ * These functions locate values in a JSON text on demand, without building a
+ * DOM. The results refer to the input text. They use simdjson when the
+ * library is built with it, and a portable scanner otherwise. All of them
+ * throw `std::invalid_argument` if the text is not valid JSON.
+ */
+
+/// Returns the members of the JSON object in @p json.
+std::vector<JsonMember> JsonObjectMembers(std::string_view json);
+
+/// Returns the raw text of the elements of the JSON array in @p json.
+std::vector<std::string_view> JsonArrayElements(std::string_view json);
+
+/**
+ * Returns the raw text of the value at the JSON Pointer (RFC 6901) @p pointer.
+ *
+ * Returns `std::nullopt` if there is no such value. An empty pointer refers to
+ * the full document.
+ */
+std::optional<std::string_view> JsonFindPointer(std::string_view json,
+                                                std::string_view pointer);
+
+/// Decodes the raw JSON string @p raw, which must include the quotes.
+std::string JsonUnescapeString(std::string_view raw);
+
+/**
+ * Decodes the base64 data in the raw JSON string @p raw.
+ *
+ * Base64 strings rarely have escapes, these are decoded directly from @p raw.
+ */
+std::string JsonBase64Decode(std::string_view raw);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_JSON_SCANNER_H
@@ -0,0 +1,109 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/json_scanner.h"
+#include <gmock/gmock.h>
+#include <stdexcept>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Field;
+using ::testing::IsEmpty;
+
+auto MemberIs(std::string_view key, std::string_view value) {
+  return ::testing::AllOf(Field(&JsonMember::key, key),
+                          Field(&JsonMember::value, value));
+}
+
+TEST(JsonScannerTest, ObjectMembers) {
+  EXPECT_THAT(JsonObjectMembers("{}"), IsEmpty());
+  EXPECT_THAT(JsonObjectMembers(R"js( { "a" : 1, "b\n": [1, {"c": null}],
+      "d": "x\"y", "e": {"f": true}, "g": -1.5e+3 } )js"),
+              ElementsAre(MemberIs("a", "1"),
+                          MemberIs(R"(b\n)", R"([1, {"c": null}])"),
+                          MemberIs("d", R"("x\"y")"),
+                          MemberIs("e", R"({"f": true})"),
+                          MemberIs("g", "-1.5e+3")));
+}
+
+TEST(JsonScannerTest, ObjectMembersReferToInput) {
+  std::string const json = R"js({"key": "value"})js";
+  auto const members = JsonObjectMembers(json);
+  ASSERT_THAT(members, ElementsAre(MemberIs("key", R"("value")")));
+  EXPECT_EQ(members[0].key.data(), json.data() + 2);
+  EXPECT_EQ(members[0].value.data(), json.data() + 8);
+}
+
+TEST(JsonScannerTest, ArrayElements) {
+  EXPECT_THAT(JsonArrayElements("[]"), IsEmpty());
+  EXPECT_THAT(JsonArrayElements(R"js([1, "two", {"three": 3}, [], false])js"),
+              ElementsAre("1", R"("two")", R"({"three": 3})", "[]", "false"));
+}
+
+TEST(JsonScannerTest, InvalidJson) {
+  for (auto const* json :
+       {"", "{", "[1,]", R"({"a" 1})", R"({"a": tru})", "01", "{} {}",
+        R"({"a": "\x"})", "[1] x", "{\"a\": \"\x01\"}"}) {
+    SCOPED_TRACE("Testing with " + std::string(json));
+    EXPECT_THROW(JsonFindPointer(json, ""), std::invalid_argument);
+  }
+  EXPECT_THROW(JsonObjectMembers("[]"), std::invalid_argument);
+  EXPECT_THROW(JsonObjectMembers("{} x"), std::invalid_argument);
+  EXPECT_THROW(JsonArrayElements("{}"), std::invalid_argument);
+  EXPECT_THROW(JsonArrayElements("[1, 2"), std::invalid_argument);
+}
+
+TEST(JsonScannerTest, FindPointer) {
+  auto constexpr kJson = R"js({
+    "a": {"b": [10, {"c": "d"}, 30]},
+    "e/f": 1,
+    "g~h": 2,
+    "": 3
+  })js";
+  EXPECT_EQ(JsonFindPointer(kJson, "/a/b/0"), "10");
+  EXPECT_EQ(JsonFindPointer(kJson, "/a/b/1"), R"({"c": "d"})");
+  EXPECT_EQ(JsonFindPointer(kJson, "/a/b/1/c"), R"("d")");
+  EXPECT_EQ(JsonFindPointer(kJson, "/a/b"), R"([10, {"c": "d"}, 30])");
+  EXPECT_EQ(JsonFindPointer(kJson, "/e~1f"), "1");
+  EXPECT_EQ(JsonFindPointer(kJson, "/g~0h"), "2");
+  EXPECT_EQ(JsonFindPointer(kJson, "/"), "3");
+  EXPECT_EQ(JsonFindPointer(" [1] ", ""), "[1]");
+
+  EXPECT_EQ(JsonFindPointer(kJson, "/missing"), std::nullopt);
+  EXPECT_EQ(JsonFindPointer(kJson, "/a/b/3"), std::nullopt);
+  EXPECT_EQ(JsonFindPointer(kJson, "/a/b/0/c"), std::nullopt);
+  EXPECT_THROW(JsonFindPointer(kJson, "a"), std::invalid_argument);
+}
+
+TEST(JsonScannerTest, UnescapeString) {
+  EXPECT_EQ(JsonUnescapeString(R"("")"), "");
+  EXPECT_EQ(JsonUnescapeString(R"("plain")"), "plain");
+  EXPECT_EQ(JsonUnescapeString(R"("a\"b\\c\/d\be\ff\ng\rh\ti")"),
+            "a\"b\\c/d\be\ff\ng\rh\ti");
+  EXPECT_EQ(JsonUnescapeString(R"("Aé€😀")"),
+            "A\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80");
+
+  EXPECT_THROW(JsonUnescapeString("plain"), std::invalid_argument);
+  EXPECT_THROW(JsonUnescapeString("42"), std::invalid_argument);
+  EXPECT_THROW(JsonUnescapeString(R"("\q")"), std::invalid_argument);
+  EXPECT_THROW(JsonUnescapeString(R"("\u12")"), std::invalid_argument);
+  EXPECT_THROW(JsonUnescapeString(R"("\ud83d")"), std::invalid_argument);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
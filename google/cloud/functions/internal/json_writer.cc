@@ -0,0 +1,113 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/json_writer.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+bool NeedsEscape(char c) {
+  return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+bool IsContinuation(unsigned char c) { return (c & 0xC0) == 0x80; }
+
+}  // namespace
+
+bool IsValidUtf8(std::string_view text) {
+  auto const* p = reinterpret_cast<unsigned char const*>(text.data());
+  auto const* const end = p + text.size();
+  while (p != end) {
+    // Skip runs of ASCII characters, the common case.
+    if (*p < 0x80) {
+      ++p;
+      continue;
+    }
+    int length = 0;
+    std::uint32_t min = 0;
+    if ((*p & 0xE0) == 0xC0) {
+      length = 2;
+      min = 0x80;
+    } else if ((*p & 0xF0) == 0xE0) {
+      length = 3;
+      min = 0x800;
+    } else if ((*p & 0xF8) == 0xF0) {
+      length = 4;
+      min = 0x10000;
+    } else {
+      return false;
+    }
+    if (end - p < length) return false;
+    std::uint32_t cp = *p & (0x7F >> length);
+    for (int i = 1; i != length; ++i) {
+      if (!IsContinuation(p[i])) return false;
+      cp = (cp << 6) | (p[i] & 0x3F);
+    }
+    // Reject overlong encodings, surrogates, and values past U+10FFFF.
+    if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+      return false;
+    }
+    p += length;
+  }
+  return true;
+}
+
+void JsonAppendString(std::string& out, std::string_view value) {
+  static char constexpr kHex[] = "0123456789abcdef";
+  out.reserve(out.size() + value.size() + 2);
+  out.push_back('"');
+  while (!value.empty()) {
+    // Copy the characters that need no escaping in a single append.
+    auto const run = std::find_if(value.begin(), value.end(), NeedsEscape);
+    out.append(value.begin(), run);
+    value.remove_prefix(run - value.begin());
+    if (value.empty()) break;
+    auto const c = value.front();
+    value.remove_prefix(1);
+    out.push_back('\\');
+    switch (c) {
+      case '"':
+      case '\\':
+        out.push_back(c);
+        break;
+      case '\b':
+        out.push_back('b');
+        break;
+      case '\f':
+        out.push_back('f');
+        break;
+      case '\n':
+        out.push_back('n');
+        break;
+      case '\r':
+        out.push_back('r');
+        break;
+      case '\t':
+        out.push_back('t');
+        break;
+      default:
+        out.append("u00");
+        out.push_back(kHex[(c >> 4) & 0xF]);
+        out.push_back(kHex[c & 0xF]);
+        break;
+    }
+  }
+  out.push_back('"');
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
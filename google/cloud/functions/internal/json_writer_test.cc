@@ -0,0 +1,65 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/json_writer.h"
+#include "google/cloud/functions/internal/json_scanner.h"
+#include <gmock/gmock.h>
+#include <string>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+TEST(JsonWriterTest, AppendString) {
+  struct {
+    std::string value;
+    std::string expected;
+  } const cases[] = {
+      {"", R"("")"},
+      {"plain", R"("plain")"},
+      {R"(a "quoted" \ value)", R"("a \"quoted\" \\ value")"},
+      {"tab\tnewline\ncr\r", R"("tab\tnewline\ncr\r")"},
+      {std::string("\x01\x1f\b\f", 4), R"("\u0001\u001f\b\f")"},
+      {"caf\xc3\xa9", "\"caf\xc3\xa9\""},
+  };
+  for (auto const& [value, expected] : cases) {
+    std::string out = "prefix:";
+    JsonAppendString(out, value);
+    EXPECT_EQ(out, "prefix:" + expected);
+    EXPECT_EQ(JsonUnescapeString(out.substr(7)), value);
+  }
+}
+
+TEST(JsonWriterTest, IsValidUtf8) {
+  EXPECT_TRUE(IsValidUtf8(""));
+  EXPECT_TRUE(IsValidUtf8("plain ascii"));
+  EXPECT_TRUE(IsValidUtf8("caf\xc3\xa9"));
+  EXPECT_TRUE(IsValidUtf8("\xe2\x82\xac"));
+  EXPECT_TRUE(IsValidUtf8("\xf0\x9f\x98\x80"));
+  EXPECT_TRUE(IsValidUtf8(std::string("\0", 1)));
+
+  EXPECT_FALSE(IsValidUtf8("\xff"));
+  EXPECT_FALSE(IsValidUtf8("\xc3"));
+  EXPECT_FALSE(IsValidUtf8("\xc3\x28"));
+  // Overlong encoding of '/'.
+  EXPECT_FALSE(IsValidUtf8("\xc0\xaf"));
+  // A surrogate half.
+  EXPECT_FALSE(IsValidUtf8("\xed\xa0\x80"));
+  // Past U+10FFFF.
+  EXPECT_FALSE(IsValidUtf8("\xf4\x90\x80\x80"));
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,123 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/lazy_global_base.h"
+#include <algorithm>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+namespace {
+
+/// The registered objects, usually constructed during static initialization.
+struct Registry {
+  std::mutex mu;
+  std::vector<LazyGlobalBase*> objects;
+};
+
+Registry& GetRegistry() {
+  // Never destroyed, the objects may be destroyed after any other static.
+  static auto* const kRegistry = new Registry;
+  return *kRegistry;
+}
+
+std::vector<LazyGlobalBase*> RegisteredObjects() {
+  auto& registry = GetRegistry();
+  std::lock_guard<std::mutex> lk(registry.mu);
+  return registry.objects;
+}
+
+}  // namespace
+
+LazyGlobalBase::~LazyGlobalBase() { Shutdown(); }
+
+void LazyGlobalBase::Prefetch() {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (state_ != State::kIdle) return;
+  state_ = State::kRunning;
+  // A previous background initialization failed, its thread is done.
+  if (thread_.joinable()) thread_.join();
+  thread_ = std::thread([this] { Run(); });
+}
+
+void LazyGlobalBase::Wait() {
+  if (ready()) return;
+  std::unique_lock<std::mutex> lk(mu_);
+  if (state_ == State::kReady) return;
+  if (state_ == State::kIdle) {
+    state_ = State::kRunning;
+    lk.unlock();
+    Run();
+    lk.lock();
+  } else {
+    auto const generation = generation_;
+    cv_.wait(lk, [&] { return generation_ != generation; });
+  }
+  if (state_ == State::kReady) return;
+  std::rethrow_exception(error_);
+}
+
+void LazyGlobalBase::Register() {
+  auto& registry = GetRegistry();
+  std::lock_guard<std::mutex> lk(registry.mu);
+  registry.objects.push_back(this);
+  registered_ = true;
+}
+
+void LazyGlobalBase::Shutdown() {
+  if (registered_) {
+    auto& registry = GetRegistry();
+    std::lock_guard<std::mutex> lk(registry.mu);
+    auto& objects = registry.objects;
+    objects.erase(std::remove(objects.begin(), objects.end(), this),
+                  objects.end());
+    registered_ = false;
+  }
+  std::unique_lock<std::mutex> lk(mu_);
+  cv_.wait(lk, [this] { return state_ != State::kRunning; });
+  if (thread_.joinable()) thread_.join();
+}
+
+void LazyGlobalBase::Run() {
+  std::exception_ptr error;
+  try {
+    Initialize();
+  } catch (...) {
+    error = std::current_exception();
+  }
+  std::lock_guard<std::mutex> lk(mu_);
+  state_ = error ? State::kIdle : State::kReady;
+  error_ = std::move(error);
+  ready_.store(!error_, std::memory_order_release);
+  ++generation_;
+  cv_.notify_all();
+}
+
+void PrefetchLazyGlobals() {
+  for (auto* o : RegisteredObjects()) o->Prefetch();
+}
+
+void WaitForLazyGlobals() {
+  for (auto* o : RegisteredObjects()) o->Wait();
+}
+
+bool LazyGlobalsReady() {
+  auto const objects = RegisteredObjects();
+  return std::all_of(objects.begin(), objects.end(),
+                     [](auto const* o) { return o->ready(); });
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,91 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_LAZY_GLOBAL_BASE_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_LAZY_GLOBAL_BASE_H
+
+#include "google/cloud/functions/version.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * The initialization state of a `functions::LazyGlobal<T>`.
+ *
+ * The value is initialized at most once at a time, either by the background
+ * thread started in `Prefetch()`, or inline by the first call to `Wait()`.
+ * If the initialization throws, the callers waiting for it get the exception,
+ * and the next call to `Wait()` or `Prefetch()` tries again.
+ */
+class LazyGlobalBase {
+ public:
+  LazyGlobalBase(LazyGlobalBase const&) = delete;
+  LazyGlobalBase& operator=(LazyGlobalBase const&) = delete;
+
+  /// Starts the initialization in the background, unless it has started.
+  void Prefetch();
+
+  /// Returns once the value is initialized, initializing it if needed.
+  void Wait();
+
+  /// Returns true if the value is initialized.
+  [[nodiscard]] bool ready() const {
+    return ready_.load(std::memory_order_acquire);
+  }
+
+ protected:
+  LazyGlobalBase() = default;
+  ~LazyGlobalBase();
+
+  /// Adds this object to the objects started by `PrefetchLazyGlobals()`.
+  void Register();
+
+  /// Removes the registration, and waits for any background initialization.
+  void Shutdown();
+
+ private:
+  virtual void Initialize() = 0;
+  void Run();
+
+  enum class State { kIdle, kRunning, kReady };
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  State state_ = State::kIdle;
+  std::uint64_t generation_ = 0;
+  std::exception_ptr error_;
+  std::atomic<bool> ready_{false};
+  std::thread thread_;
+  bool registered_ = false;
+};
+
+/// Starts the initialization of all the registered objects.
+void PrefetchLazyGlobals();
+
+/// Waits for the initialization of all the registered objects.
+void WaitForLazyGlobals();
+
+/// Returns true if all the registered objects are initialized.
+bool LazyGlobalsReady();
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_LAZY_GLOBAL_BASE_H
@@ -0,0 +1,221 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/log_sink.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iostream>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+/// An unbuffered `std::streambuf` that forwards all the data to the sink.
+class LogSinkBuffer : public std::streambuf {
+ public:
+  void set_destination(std::streambuf* d) { destination_ = d; }
+
+ protected:
+  int_type overflow(int_type c) override {
+    if (traits_type::eq_int_type(c, traits_type::eof())) return 0;
+    auto const ch = traits_type::to_char_type(c);
+    LogSink::Instance().Write(destination_, std::string_view(&ch, 1));
+    return c;
+  }
+
+  std::streamsize xsputn(char const* s, std::streamsize n) override {
+    LogSink::Instance().Write(destination_,
+                              std::string_view(s, static_cast<std::size_t>(n)));
+    return n;
+  }
+
+  // Data is flushed by the sink, and explicitly by `FlushLogs()`.
+  int sync() override { return 0; }
+
+ private:
+  std::atomic<std::streambuf*> destination_{nullptr};
+};
+
+struct Redirection {
+  std::ostream* stream;
+  std::streambuf* original;
+  LogSinkBuffer buffer;
+};
+
+/// The state for `ScopedLogSink`, intentionally leaked like the sink.
+struct RedirectState {
+  std::mutex mu;
+  int count = 0;
+  std::atomic<bool> redirected{false};
+  std::array<Redirection, 3> redirections{{
+      {&std::cout, nullptr, {}},
+      {&std::clog, nullptr, {}},
+      {&std::cerr, nullptr, {}},
+  }};
+};
+
+RedirectState& GetRedirectState() {
+  static auto* const kState = new RedirectState;
+  return *kState;
+}
+
+}  // namespace
+
+LogSink& LogSink::Instance() {
+  // Intentionally leaked, the sink may be used while other static objects,
+  // including the standard streams, are destroyed.
+  static auto* const kInstance = new LogSink;
+  return *kInstance;
+}
+
+LogSink::LogSink() : slots_(new Slot[kCapacity]) {
+  for (std::uint64_t i = 0; i != kCapacity; ++i) slots_[i].sequence = i;
+  writer_ = std::thread([this] { Run(); });
+  writer_.detach();
+}
+
+void LogSink::Write(std::streambuf* destination, std::string_view data) {
+  // A bounded multi-producer queue, each slot's sequence number tells the
+  // producers when it is free, and the consumer when it is ready.
+  auto pos = tail_.load(std::memory_order_relaxed);
+  for (;;) {
+    auto& slot = slots_[pos % kCapacity];
+    auto const sequence = slot.sequence.load(std::memory_order_acquire);
+    auto const diff = static_cast<std::int64_t>(sequence - pos);
+    if (diff == 0) {
+      if (tail_.compare_exchange_weak(pos, pos + 1,
+                                      std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // The ring is full, wait for the background thread to catch up.
+      WakeWriter();
+      std::this_thread::yield();
+      pos = tail_.load(std::memory_order_relaxed);
+    } else {
+      pos = tail_.load(std::memory_order_relaxed);
+    }
+  }
+  auto& slot = slots_[pos % kCapacity];
+  slot.destination = destination;
+  slot.data.assign(data.data(), data.size());
+  slot.sequence.store(pos + 1);
+  if (sleeping_.load()) WakeWriter();
+}
+
+void LogSink::Flush() {
+  auto const target = tail_.load();
+  if (written_.load() >= target) return;
+  std::unique_lock<std::mutex> lk(mu_);
+  sleeping_ = false;
+  wakeup_.notify_one();
+  flushed_.wait(lk, [&] { return written_.load() >= target; });
+}
+
+void LogSink::WakeWriter() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    sleeping_ = false;
+  }
+  wakeup_.notify_one();
+}
+
+void LogSink::Run() {
+  for (;;) {
+    if (Drain()) continue;
+    // Producers check `sleeping_` after publishing their data, and the
+    // writer checks for data after setting `sleeping_`, so no wakeups are
+    // lost.
+    sleeping_ = true;
+    if (HasData()) {
+      sleeping_ = false;
+      continue;
+    }
+    std::unique_lock<std::mutex> lk(mu_);
+    wakeup_.wait(lk, [this] { return !sleeping_.load(); });
+  }
+}
+
+bool LogSink::HasData() const {
+  return slots_[head_ % kCapacity].sequence.load() == head_ + 1;
+}
+
+bool LogSink::Drain() {
+  auto const start = head_;
+  std::streambuf* destination = nullptr;
+  while (HasData()) {
+    auto& slot = slots_[head_ % kCapacity];
+    if (slot.destination != destination) {
+      Put(destination);
+      destination = slot.destination;
+    }
+    batch_.append(slot.data);
+    slot.sequence.store(head_ + kCapacity, std::memory_order_release);
+    ++head_;
+  }
+  if (head_ == start) return false;
+  Put(destination);
+  for (auto* d : destinations_) d->pubsync();
+  destinations_.clear();
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    written_ = head_;
+  }
+  flushed_.notify_all();
+  return true;
+}
+
+void LogSink::Put(std::streambuf* destination) {
+  if (destination == nullptr || batch_.empty()) return;
+  destination->sputn(batch_.data(),
+                     static_cast<std::streamsize>(batch_.size()));
+  batch_.clear();
+  if (std::find(destinations_.begin(), destinations_.end(), destination) ==
+      destinations_.end()) {
+    destinations_.push_back(destination);
+  }
+}
+
+ScopedLogSink::ScopedLogSink() {
+  auto& state = GetRedirectState();
+  std::lock_guard<std::mutex> lk(state.mu);
+  if (state.count++ != 0) return;
+  for (auto& r : state.redirections) {
+    r.stream->flush();
+    r.original = r.stream->rdbuf();
+    r.buffer.set_destination(r.original);
+    r.stream->rdbuf(&r.buffer);
+  }
+  state.redirected = true;
+}
+
+ScopedLogSink::~ScopedLogSink() {
+  auto& state = GetRedirectState();
+  std::lock_guard<std::mutex> lk(state.mu);
+  if (--state.count != 0) return;
+  state.redirected = false;
+  for (auto& r : state.redirections) r.stream->rdbuf(r.original);
+  LogSink::Instance().Flush();
+}
+
+void FlushLogs() {
+  if (GetRedirectState().redirected.load()) return LogSink::Instance().Flush();
+  std::cout << std::flush;
+  std::clog << std::flush;
+  std::cerr << std::flush;
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,112 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_LOG_SINK_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_LOG_SINK_H
+
+#include "google/cloud/functions/version.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Writes log data to the standard streams from a background thread.
+ *
+ * Producers copy their data into a bounded, lock-free ring buffer and return
+ * immediately. A single background thread drains the ring, coalescing
+ * consecutive writes for the same destination into a single write, and then
+ * flushes each destination once per batch.
+ *
+ * `Flush()` is a barrier: it returns once all the data written before the
+ * call reaches its destination. If the background thread has already caught
+ * up, which is the common case, it returns after reading two atomics.
+ */
+class LogSink {
+ public:
+  /// The process-wide sink, it is never destroyed.
+  static LogSink& Instance();
+
+  /// Queues @p data for @p destination, blocks only if the ring is full.
+  void Write(std::streambuf* destination, std::string_view data);
+
+  /// Waits until all previous writes reach their destination.
+  void Flush();
+
+ private:
+  LogSink();
+
+  struct Slot {
+    std::atomic<std::uint64_t> sequence{0};
+    std::streambuf* destination = nullptr;
+    std::string data;
+  };
+
+  void WakeWriter();
+  void Run();
+  bool Drain();
+  [[nodiscard]] bool HasData() const;
+  void Put(std::streambuf* destination);
+
+  static auto constexpr kCapacity = std::uint64_t{1024};
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<std::uint64_t> tail_{0};
+  std::atomic<std::uint64_t> written_{0};
+  std::atomic<bool> sleeping_{false};
+  // Only used by the background thread.
+  std::uint64_t head_ = 0;
+  std::string batch_;
+  std::vector<std::streambuf*> destinations_;
+  std::mutex mu_;
+  std::condition_variable wakeup_;
+  std::condition_variable flushed_;
+  std::thread writer_;
+};
+
+/**
+ * Redirects `std::cout`, `std::clog`, and `std::cerr` to the `LogSink`.
+ *
+ * The streams are restored, and any pending data is flushed, when the last
+ * instance is destroyed.
+ */
+class ScopedLogSink {
+ public:
+  ScopedLogSink();
+  ~ScopedLogSink();
+
+  ScopedLogSink(ScopedLogSink const&) = delete;
+  ScopedLogSink& operator=(ScopedLogSink const&) = delete;
+};
+
+/**
+ * Flushes the standard streams.
+ *
+ * Uses the `LogSink` barrier if the streams are redirected, and flushes
+ * `std::cout`, `std::clog`, and `std::cerr` otherwise.
+ */
+void FlushLogs();
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_LOG_SINK_H
@@ -0,0 +1,89 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/log_sink.h"
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+TEST(LogSinkTest, WriteAndFlush) {
+  std::stringbuf out;
+  LogSink::Instance().Write(&out, "Hello ");
+  LogSink::Instance().Write(&out, "World\n");
+  LogSink::Instance().Flush();
+  EXPECT_EQ(out.str(), "Hello World\n");
+}
+
+TEST(LogSinkTest, ManyWriters) {
+  std::stringbuf out;
+  auto constexpr kThreads = 4;
+  // Enough lines to fill the ring buffer multiple times.
+  auto constexpr kLines = 2000;
+  std::vector<std::thread> writers;
+  for (int i = 0; i != kThreads; ++i) {
+    writers.emplace_back([&out, i] {
+      for (int j = 0; j != kLines; ++j) {
+        LogSink::Instance().Write(
+            &out, std::to_string(i) + ":" + std::to_string(j) + "\n");
+      }
+    });
+  }
+  for (auto& t : writers) t.join();
+  LogSink::Instance().Flush();
+
+  std::istringstream is(out.str());
+  std::vector<int> next(kThreads, 0);
+  int count = 0;
+  for (std::string line; std::getline(is, line); ++count) {
+    auto const pos = line.find(':');
+    ASSERT_NE(pos, std::string::npos);
+    auto const i = std::stoi(line.substr(0, pos));
+    // Writes from each thread appear in order.
+    EXPECT_EQ(std::stoi(line.substr(pos + 1)), next[i]++);
+  }
+  EXPECT_EQ(count, kThreads * kLines);
+}
+
+TEST(LogSinkTest, ScopedRedirect) {
+  std::stringbuf out;
+  std::stringbuf err;
+  auto* saved_out = std::cout.rdbuf(&out);
+  auto* saved_err = std::cerr.rdbuf(&err);
+  {
+    ScopedLogSink sink;
+    EXPECT_NE(std::cout.rdbuf(), &out);
+    std::cout << "answer=" << 42 << std::endl;
+    std::cerr << "error\n";
+    FlushLogs();
+    EXPECT_EQ(out.str(), "answer=42\n");
+    EXPECT_EQ(err.str(), "error\n");
+    std::cout << "pending\n";
+  }
+  EXPECT_EQ(std::cout.rdbuf(), &out);
+  EXPECT_EQ(out.str(), "answer=42\npending\n");
+  std::cout.rdbuf(saved_out);
+  std::cerr.rdbuf(saved_err);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
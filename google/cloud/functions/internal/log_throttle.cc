@@ -0,0 +1,36 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/log_throttle.h"
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+std::optional<std::uint64_t> LogThrottle::Acquire(Clock::time_point now) {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (now - window_ >= std::chrono::seconds(1)) {
+    window_ = now;
+    count_ = 0;
+  }
+  if (count_ >= max_per_second_) {
+    ++suppressed_;
+    return std::nullopt;
+  }
+  ++count_;
+  return std::exchange(suppressed_, 0);
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,59 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_LOG_THROTTLE_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_LOG_THROTTLE_H
+
+#include "google/cloud/functions/version.h"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Limits a log to @p max_per_second entries each second.
+ *
+ * Logs triggered by requests, such as slow or invalid requests, could
+ * otherwise write an entry for each request, and slow down the server when
+ * it can least afford it.
+ */
+class LogThrottle {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit LogThrottle(int max_per_second) : max_per_second_(max_per_second) {}
+
+  /**
+   * Returns `std::nullopt` if the entry must be suppressed.
+   *
+   * Otherwise returns how many entries were suppressed since the previous
+   * entry, which the new entry should report.
+   */
+  std::optional<std::uint64_t> Acquire(Clock::time_point now);
+
+ private:
+  int max_per_second_;
+  std::mutex mu_;
+  Clock::time_point window_;
+  int count_ = 0;
+  std::uint64_t suppressed_ = 0;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_LOG_THROTTLE_H
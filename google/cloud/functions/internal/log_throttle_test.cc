@@ -0,0 +1,47 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/log_throttle.h"
+#include <gmock/gmock.h>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using std::chrono::milliseconds;
+using ::testing::Optional;
+
+TEST(LogThrottleTest, Basic) {
+  LogThrottle throttle(2);
+  auto const start = LogThrottle::Clock::now();
+  EXPECT_THAT(throttle.Acquire(start), Optional(0));
+  EXPECT_THAT(throttle.Acquire(start + milliseconds(1)), Optional(0));
+  EXPECT_EQ(throttle.Acquire(start + milliseconds(2)), std::nullopt);
+  EXPECT_EQ(throttle.Acquire(start + milliseconds(999)), std::nullopt);
+
+  // The next window reports the suppressed entries once.
+  EXPECT_THAT(throttle.Acquire(start + milliseconds(1000)), Optional(2));
+  EXPECT_THAT(throttle.Acquire(start + milliseconds(1001)), Optional(0));
+  EXPECT_EQ(throttle.Acquire(start + milliseconds(1002)), std::nullopt);
+}
+
+TEST(LogThrottleTest, Disabled) {
+  LogThrottle throttle(0);
+  auto const now = LogThrottle::Clock::now();
+  EXPECT_EQ(throttle.Acquire(now), std::nullopt);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
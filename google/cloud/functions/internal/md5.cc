@@ -0,0 +1,125 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/md5.h"
+#include <algorithm>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+/// The per-round shift amounts.
+constexpr std::array<int, 64> kShifts = {
+    7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+    5, 9,  14, 20, 5, 9,  14, 20, 5, 9,  14, 20, 5, 9,  14, 20,
+    4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+    6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21};
+
+/// The integer part of `abs(sin(i + 1)) * 2^32`.
+constexpr std::array<std::uint32_t, 64> kConstants = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a,
+    0xa8304613, 0xfd469501, 0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be,
+    0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821, 0xf61e2562, 0xc040b340,
+    0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8,
+    0x676f02d9, 0x8d2a4c8a, 0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c,
+    0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70, 0x289b7ec6, 0xeaa127fa,
+    0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92,
+    0xffeff47d, 0x85845dd1, 0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1,
+    0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391};
+
+std::uint32_t RotateLeft(std::uint32_t x, int n) {
+  return (x << n) | (x >> (32 - n));
+}
+
+}  // namespace
+
+void Md5::Update(std::string_view data) {
+  auto const* p = reinterpret_cast<unsigned char const*>(data.data());
+  auto n = data.size();
+  auto offset = static_cast<std::size_t>(size_ % buffer_.size());
+  size_ += n;
+  if (offset != 0) {
+    auto const count = std::min(n, buffer_.size() - offset);
+    std::copy(p, p + count, buffer_.begin() + offset);
+    p += count;
+    n -= count;
+    if (offset + count != buffer_.size()) return;
+    Transform(buffer_.data());
+  }
+  for (; n >= buffer_.size(); p += buffer_.size(), n -= buffer_.size()) {
+    Transform(p);
+  }
+  std::copy(p, p + n, buffer_.begin());
+}
+
+Md5::Digest Md5::Finish() {
+  auto const bits = size_ * 8;
+  std::array<unsigned char, 72> padding{0x80};
+  auto const offset = static_cast<std::size_t>(size_ % buffer_.size());
+  auto const pad = (offset < 56 ? 56 : 120) - offset;
+  for (int i = 0; i != 8; ++i) {
+    padding[pad + i] = static_cast<unsigned char>(bits >> (8 * i));
+  }
+  Update(std::string_view(reinterpret_cast<char const*>(padding.data()),
+                          pad + 8));
+  Digest digest;
+  for (std::size_t i = 0; i != digest.size(); ++i) {
+    digest[i] = static_cast<std::uint8_t>(state_[i / 4] >> (8 * (i % 4)));
+  }
+  return digest;
+}
+
+void Md5::Transform(unsigned char const* block) {
+  std::array<std::uint32_t, 16> m;
+  for (std::size_t i = 0; i != m.size(); ++i) {
+    m[i] = std::uint32_t{block[4 * i]} | std::uint32_t{block[4 * i + 1]} << 8 |
+           std::uint32_t{block[4 * i + 2]} << 16 |
+           std::uint32_t{block[4 * i + 3]} << 24;
+  }
+  auto a = state_[0];
+  auto b = state_[1];
+  auto c = state_[2];
+  auto d = state_[3];
+  for (std::size_t i = 0; i != kConstants.size(); ++i) {
+    std::uint32_t f;
+    std::size_t g;
+    if (i < 16) {
+      f = (b & c) | (~b & d);
+      g = i;
+    } else if (i < 32) {
+      f = (d & b) | (~d & c);
+      g = (5 * i + 1) % 16;
+    } else if (i < 48) {
+      f = b ^ c ^ d;
+      g = (3 * i + 5) % 16;
+    } else {
+      f = c ^ (b | ~d);
+      g = (7 * i) % 16;
+    }
+    auto const rotated = RotateLeft(a + f + kConstants[i] + m[g], kShifts[i]);
+    a = d;
+    d = c;
+    c = b;
+    b += rotated;
+  }
+  state_[0] += a;
+  state_[1] += b;
+  state_[2] += c;
+  state_[3] += d;
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,53 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_MD5_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_MD5_H
+
+#include "google/cloud/functions/version.h"
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Computes the MD5 digest of data received in chunks, see RFC 1321.
+ *
+ * MD5 is only used to check the integrity of request bodies, as in the
+ * `Content-MD5` and `x-goog-hash` headers.
+ */
+class Md5 {
+ public:
+  using Digest = std::array<std::uint8_t, 16>;
+
+  void Update(std::string_view data);
+
+  /// Returns the digest of the data, the object must not be used afterwards.
+  Digest Finish();
+
+ private:
+  void Transform(unsigned char const* block);
+
+  std::array<std::uint32_t, 4> state_{0x67452301, 0xefcdab89, 0x98badcfe,
+                                      0x10325476};
+  std::array<unsigned char, 64> buffer_{};
+  std::uint64_t size_ = 0;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_MD5_H
@@ -0,0 +1,66 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/md5.h"
+#include <gmock/gmock.h>
+#include <string>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+std::string Hex(Md5::Digest const& digest) {
+  auto constexpr kDigits = std::string_view("0123456789abcdef");
+  std::string hex;
+  for (auto b : digest) {
+    hex.push_back(kDigits[b >> 4]);
+    hex.push_back(kDigits[b & 0xf]);
+  }
+  return hex;
+}
+
+std::string Md5Hex(std::string_view data) {
+  Md5 md5;
+  md5.Update(data);
+  return Hex(md5.Finish());
+}
+
+TEST(Md5Test, KnownValues) {
+  // See RFC 1321, Appendix A.5.
+  EXPECT_EQ(Md5Hex(""), "d41d8cd98f00b204e9800998ecf8427e");
+  EXPECT_EQ(Md5Hex("a"), "0cc175b9c0f1b6a831c399e269772661");
+  EXPECT_EQ(Md5Hex("abc"), "900150983cd24fb0d6963f7d28e17f72");
+  EXPECT_EQ(Md5Hex("message digest"), "f96b697d7cb7938d525a2f31aaf161d0");
+  EXPECT_EQ(
+      Md5Hex("12345678901234567890123456789012345678901234567890123456789012"
+             "345678901234567890"),
+      "57edf4a22be3c955ac49da2e2107b67a");
+}
+
+TEST(Md5Test, Chunks) {
+  std::string data;
+  for (int i = 0; i != 1000; ++i) data.push_back(static_cast<char>(i * 7));
+  auto const expected = Md5Hex(data);
+  for (std::size_t chunk : {1, 3, 55, 56, 63, 64, 65, 500}) {
+    Md5 md5;
+    for (std::size_t offset = 0; offset < data.size(); offset += chunk) {
+      md5.Update(std::string_view(data).substr(offset, chunk));
+    }
+    EXPECT_EQ(Hex(md5.Finish()), expected) << "chunk=" << chunk;
+  }
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,236 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/memory_pressure.h"
+#include "google/cloud/functions/internal/cgroup_files.h"
+#include "google/cloud/functions/internal/cpu_limits.h"
+#include "google/cloud/functions/internal/structured_log.h"
+#include <algorithm>
+#include <sstream>
+#include <utility>
+#ifdef __linux__
+#include <unistd.h>
+#endif  // __linux__
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace be = ::boost::beast;
+
+/// The usage in @p dir, minus its inactive file cache.
+std::optional<std::uint64_t> WorkingSet(std::filesystem::path const& dir,
+                                        char const* usage_file,
+                                        char const* inactive_key) {
+  auto usage = ReadSystemFile(dir / usage_file);
+  if (!usage) return std::nullopt;
+  auto value = ParseCgroupInteger<std::uint64_t>(*usage);
+  if (!value) return std::nullopt;
+  auto stat = ReadSystemFile(dir / "memory.stat");
+  if (!stat) return value;
+  auto const inactive = ParseMemoryStat(*stat, inactive_key).value_or(0);
+  return *value - std::min(*value, inactive);
+}
+
+CgroupMemory CgroupV2Memory(std::filesystem::path const& root,
+                            std::string const& path) {
+  CgroupMemory result;
+  ForEachCgroupDirectory(root, path, [&result](auto const& dir) {
+    if (auto contents = ReadSystemFile(dir / "memory.max")) {
+      if (auto limit = ParseCgroupMemoryLimit(*contents)) {
+        result.limit = result.limit ? std::min(*result.limit, *limit) : limit;
+      }
+    }
+    if (auto ws = WorkingSet(dir, "memory.current", "inactive_file")) {
+      result.working_set = ws;
+    }
+  });
+  return result;
+}
+
+CgroupMemory CgroupV1Memory(std::filesystem::path const& root,
+                            std::string const& path) {
+  auto const relative = CgroupRelativePath(path);
+  for (auto const& dir : {root / "memory" / relative, root / "memory"}) {
+    auto contents = ReadSystemFile(dir / "memory.limit_in_bytes");
+    if (!contents) continue;
+    return CgroupMemory{
+        ParseCgroupMemoryLimit(*contents),
+        WorkingSet(dir, "memory.usage_in_bytes", "total_inactive_file")};
+  }
+  return {};
+}
+
+std::optional<std::uint64_t> PhysicalMemory() {
+#ifdef __linux__
+  auto const pages = sysconf(_SC_PHYS_PAGES);
+  auto const page_size = sysconf(_SC_PAGE_SIZE);
+  if (pages <= 0 || page_size <= 0) return std::nullopt;
+  return static_cast<std::uint64_t>(pages) *
+         static_cast<std::uint64_t>(page_size);
+#else
+  return std::nullopt;
+#endif  // __linux__
+}
+
+std::optional<std::uint64_t> ResidentMemory() {
+#ifdef __linux__
+  auto contents = ReadSystemFile("/proc/self/statm");
+  if (!contents) return std::nullopt;
+  // The second field is the resident set size, in pages.
+  std::istringstream is(*contents);
+  std::uint64_t size = 0;
+  std::uint64_t resident = 0;
+  if (!(is >> size >> resident)) return std::nullopt;
+  auto const page_size = sysconf(_SC_PAGE_SIZE);
+  if (page_size <= 0) return std::nullopt;
+  return resident * static_cast<std::uint64_t>(page_size);
+#else
+  return std::nullopt;
+#endif  // __linux__
+}
+
+}  // namespace
+
+std::optional<std::uint64_t> ParseCgroupMemoryLimit(
+    std::string_view contents) {
+  // cgroup v1 reports "no limit" as the largest multiple of the page size.
+  auto constexpr kUnlimited = std::uint64_t{1} << 62;
+  auto const value = ParseCgroupInteger<std::uint64_t>(contents);
+  if (!value || *value == 0 || *value >= kUnlimited) return std::nullopt;
+  return value;
+}
+
+std::optional<std::uint64_t> ParseMemoryStat(std::string_view contents,
+                                             std::string_view key) {
+  while (!contents.empty()) {
+    auto const eol = std::min(contents.find('\n'), contents.size());
+    auto const line = contents.substr(0, eol);
+    contents.remove_prefix(std::min(eol + 1, contents.size()));
+    auto const space = line.find(' ');
+    if (space == std::string_view::npos || line.substr(0, space) != key) {
+      continue;
+    }
+    return ParseCgroupInteger<std::uint64_t>(line.substr(space + 1));
+  }
+  return std::nullopt;
+}
+
+CgroupMemory CgroupMemoryUsage(std::string const& proc_cgroup,
+                               std::filesystem::path const& root) {
+  if (auto v1 = CgroupPath(proc_cgroup, "memory")) {
+    auto result = CgroupV1Memory(root, *v1);
+    if (result.limit || result.working_set) return result;
+  }
+  if (auto v2 = CgroupPath(proc_cgroup, "")) {
+    auto result = CgroupV2Memory(root, *v2);
+    if (result.limit || result.working_set) return result;
+    // On hybrid systems the v2 hierarchy is mounted on `unified`.
+    return CgroupV2Memory(root / "unified", *v2);
+  }
+  return {};
+}
+
+CgroupMemory CgroupMemoryUsage() {
+#ifdef __linux__
+  auto contents = ReadSystemFile("/proc/self/cgroup");
+  if (!contents) return {};
+  return CgroupMemoryUsage(*contents);
+#else
+  return {};
+#endif  // __linux__
+}
+
+MemoryPressureMonitor::MemoryPressureMonitor(std::uint64_t watermark,
+                                             std::chrono::milliseconds interval,
+                                             Sampler sample)
+    : watermark_(watermark),
+      interval_(interval),
+      sample_(std::move(sample)),
+      thread_([this] { Run(); }) {}
+
+MemoryPressureMonitor::~MemoryPressureMonitor() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+}
+
+void MemoryPressureMonitor::Sample() {
+  auto const usage = sample_();
+  if (!usage) return;
+  usage_.store(*usage);
+  auto const overloaded = *usage >= watermark_;
+  if (overloaded_.exchange(overloaded) == overloaded) return;
+  std::ostringstream os;
+  os << "Memory usage (" << *usage << " bytes) is "
+     << (overloaded ? "above" : "below") << " the watermark (" << watermark_
+     << " bytes), " << (overloaded ? "rejecting" : "accepting")
+     << " new requests";
+  WriteLog(overloaded ? functions::LogSeverity::kWarning
+                      : functions::LogSeverity::kInfo,
+           std::move(os).str());
+}
+
+void MemoryPressureMonitor::Run() {
+  std::unique_lock<std::mutex> lk(mu_);
+  do {
+    lk.unlock();
+    Sample();
+    lk.lock();
+  } while (!cv_.wait_for(lk, interval_, [this] { return shutdown_; }));
+}
+
+std::shared_ptr<MemoryPressureMonitor> MakeMemoryPressureMonitor(
+    int watermark_percent) {
+  if (watermark_percent <= 0) return nullptr;
+  auto const cgroup = CgroupMemoryUsage();
+  auto const limit = cgroup.limit ? cgroup.limit : PhysicalMemory();
+  if (!limit) {
+    WriteLog(functions::LogSeverity::kWarning,
+             "--memory-watermark ignored, the memory limit is unknown");
+    return nullptr;
+  }
+  auto constexpr kPercent = 100;
+  auto constexpr kInterval = std::chrono::milliseconds(100);
+  auto const watermark = *limit / kPercent * watermark_percent;
+  // Without a cgroup limit only the memory of this process counts.
+  auto sample = cgroup.limit && cgroup.working_set
+                    ? MemoryPressureMonitor::Sampler(
+                          [] { return CgroupMemoryUsage().working_set; })
+                    : MemoryPressureMonitor::Sampler(ResidentMemory);
+  return std::make_shared<MemoryPressureMonitor>(watermark, kInterval,
+                                                 std::move(sample));
+}
+
+PrecheckHandler MakeMemoryPressurePrecheckHandler(
+    PrecheckHandler precheck, std::shared_ptr<MemoryPressureMonitor> monitor,
+    std::chrono::seconds retry_after) {
+  BeastResponse rejected;
+  rejected.result(be::http::status::service_unavailable);
+  rejected.set(be::http::field::retry_after,
+               std::to_string(retry_after.count()));
+  return [precheck = std::move(precheck), monitor = std::move(monitor),
+          rejected = std::move(rejected)](
+             BeastRequest const& request) -> std::optional<BeastResponse> {
+    if (monitor->overloaded()) return rejected;
+    if (!precheck) return std::nullopt;
+    return precheck(request);
+  };
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
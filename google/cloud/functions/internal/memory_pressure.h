@@ -0,0 +1,133 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_MEMORY_PRESSURE_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_MEMORY_PRESSURE_H
+
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/version.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Parses a cgroup memory limit, from `memory.max` (v2) or
+ * `memory.limit_in_bytes` (v1).
+ *
+ * Returns an empty optional if there is no limit (`"max"` in v2, a value close
+ * to the maximum in v1), or the contents are invalid.
+ */
+std::optional<std::uint64_t> ParseCgroupMemoryLimit(std::string_view contents);
+
+/// Returns the value of @p key in a cgroup `memory.stat` file.
+std::optional<std::uint64_t> ParseMemoryStat(std::string_view contents,
+                                             std::string_view key);
+
+/// The memory limit and working set of a cgroup, in bytes.
+struct CgroupMemory {
+  std::optional<std::uint64_t> limit;
+  std::optional<std::uint64_t> working_set;
+};
+
+/**
+ * Returns the memory limit and working set of the cgroup running this process.
+ *
+ * The limits of the ancestors also apply in cgroup v2. The working set is the
+ * usage minus the inactive file cache, which the kernel reclaims before
+ * running out of memory. @p proc_cgroup is the contents of `/proc/self/cgroup`,
+ * and @p root the cgroup filesystem mount point, the tests override both.
+ */
+CgroupMemory CgroupMemoryUsage(
+    std::string const& proc_cgroup,
+    std::filesystem::path const& root = "/sys/fs/cgroup");
+
+/// Returns the memory limit and working set of the cgroup running this process.
+CgroupMemory CgroupMemoryUsage();
+
+/**
+ * Sheds requests while the memory usage is above a watermark.
+ *
+ * The OOM killer terminates the whole instance, and every request in progress
+ * with it. Rejecting new requests once the memory usage approaches the limit
+ * is much cheaper. A background thread samples the usage every @p interval,
+ * the requests only read the result.
+ */
+class MemoryPressureMonitor {
+ public:
+  using Sampler = std::function<std::optional<std::uint64_t>()>;
+
+  MemoryPressureMonitor(std::uint64_t watermark,
+                        std::chrono::milliseconds interval, Sampler sample);
+  ~MemoryPressureMonitor();
+
+  MemoryPressureMonitor(MemoryPressureMonitor const&) = delete;
+  MemoryPressureMonitor& operator=(MemoryPressureMonitor const&) = delete;
+
+  [[nodiscard]] bool overloaded() const { return overloaded_.load(); }
+  [[nodiscard]] std::uint64_t watermark() const { return watermark_; }
+  /// The last sampled usage, in bytes.
+  [[nodiscard]] std::uint64_t usage() const { return usage_.load(); }
+
+  /// Samples the memory usage, the background thread calls this periodically.
+  void Sample();
+
+ private:
+  void Run();
+
+  std::uint64_t const watermark_;
+  std::chrono::milliseconds const interval_;
+  Sampler const sample_;
+  std::atomic<bool> overloaded_{false};
+  std::atomic<std::uint64_t> usage_{0};
+  std::mutex mu_;
+  std::condition_variable cv_;
+  bool shutdown_ = false;
+  std::thread thread_;
+};
+
+/**
+ * Creates a monitor for `--memory-watermark`, a percentage of the limit.
+ *
+ * The limit is the cgroup memory limit, or the physical memory if there is
+ * none. Returns null if the watermark is 0, or the limit is unknown.
+ */
+std::shared_ptr<MemoryPressureMonitor> MakeMemoryPressureMonitor(
+    int watermark_percent);
+
+/**
+ * Wraps @p precheck to reject requests while the memory usage is too high.
+ *
+ * The rejected requests receive `503 Service Unavailable`, with a
+ * `Retry-After` header, before their body is read.
+ */
+PrecheckHandler MakeMemoryPressurePrecheckHandler(
+    PrecheckHandler precheck, std::shared_ptr<MemoryPressureMonitor> monitor,
+    std::chrono::seconds retry_after);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_MEMORY_PRESSURE_H
@@ -0,0 +1,118 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/memory_pressure.h"
+#include "google/cloud/functions/testing_util/cgroup_directory.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace be = ::boost::beast;
+using ::testing::Optional;
+
+TEST(MemoryPressureTest, ParseCgroupMemoryLimit) {
+  EXPECT_THAT(ParseCgroupMemoryLimit("536870912\n"), Optional(536870912U));
+  EXPECT_EQ(ParseCgroupMemoryLimit("max\n"), std::nullopt);
+  EXPECT_EQ(ParseCgroupMemoryLimit("9223372036854771712\n"), std::nullopt);
+  EXPECT_EQ(ParseCgroupMemoryLimit(""), std::nullopt);
+  EXPECT_EQ(ParseCgroupMemoryLimit("-1"), std::nullopt);
+}
+
+TEST(MemoryPressureTest, ParseMemoryStat) {
+  auto const stat = std::string("anon 1000\nfile 500\ninactive_file 300\n");
+  EXPECT_THAT(ParseMemoryStat(stat, "inactive_file"), Optional(300U));
+  EXPECT_THAT(ParseMemoryStat(stat, "anon"), Optional(1000U));
+  EXPECT_EQ(ParseMemoryStat(stat, "file_mapped"), std::nullopt);
+  EXPECT_EQ(ParseMemoryStat(stat, "inactive"), std::nullopt);
+}
+
+TEST(MemoryPressureTest, CgroupV2) {
+  CgroupDirectory cgroup("memory_pressure_test");
+  cgroup.Write("memory.max", "max\n");
+  cgroup.Write("service/memory.max", "1000000\n");
+  cgroup.Write("service/instance/memory.max", "2000000\n");
+  cgroup.Write("service/instance/memory.current", "600000\n");
+  cgroup.Write("service/instance/memory.stat",
+               "anon 400000\ninactive_file 100000\n");
+  auto const actual =
+      CgroupMemoryUsage("0::/service/instance\n", cgroup.root());
+  EXPECT_THAT(actual.limit, Optional(1000000U));
+  EXPECT_THAT(actual.working_set, Optional(500000U));
+
+  // Inside a container the cgroup is the root of the mounted hierarchy.
+  CgroupDirectory container("memory_pressure_test");
+  container.Write("memory.max", "536870912\n");
+  container.Write("memory.current", "1000\n");
+  auto const inside = CgroupMemoryUsage("0::/\n", container.root());
+  EXPECT_THAT(inside.limit, Optional(536870912U));
+  EXPECT_THAT(inside.working_set, Optional(1000U));
+}
+
+TEST(MemoryPressureTest, CgroupV1) {
+  CgroupDirectory cgroup("memory_pressure_test");
+  cgroup.Write("memory/memory.limit_in_bytes", "9223372036854771712\n");
+  cgroup.Write("memory/docker/abc/memory.limit_in_bytes", "268435456\n");
+  cgroup.Write("memory/docker/abc/memory.usage_in_bytes", "2000\n");
+  cgroup.Write("memory/docker/abc/memory.stat",
+               "cache 900\ntotal_inactive_file 500\n");
+  auto const actual =
+      CgroupMemoryUsage("4:memory:/docker/abc\n", cgroup.root());
+  EXPECT_THAT(actual.limit, Optional(268435456U));
+  EXPECT_THAT(actual.working_set, Optional(1500U));
+
+  auto const none = CgroupMemoryUsage("4:memory:/\n", cgroup.root());
+  EXPECT_EQ(none.limit, std::nullopt);
+}
+
+TEST(MemoryPressureTest, Monitor) {
+  auto usage = std::make_shared<std::atomic<std::uint64_t>>(100);
+  // Sample explicitly, the background thread only samples once.
+  auto monitor = std::make_shared<MemoryPressureMonitor>(
+      1000, std::chrono::hours(1),
+      [usage]() -> std::optional<std::uint64_t> { return usage->load(); });
+  monitor->Sample();
+  EXPECT_FALSE(monitor->overloaded());
+  EXPECT_EQ(monitor->usage(), 100);
+
+  auto precheck = MakeMemoryPressurePrecheckHandler(
+      PrecheckHandler{}, monitor, std::chrono::seconds(5));
+  EXPECT_FALSE(precheck(BeastRequest()).has_value());
+
+  usage->store(1000);
+  monitor->Sample();
+  EXPECT_TRUE(monitor->overloaded());
+  auto rejected = precheck(BeastRequest());
+  ASSERT_TRUE(rejected.has_value());
+  EXPECT_EQ(rejected->result(), be::http::status::service_unavailable);
+  EXPECT_EQ((*rejected)[be::http::field::retry_after], "5");
+
+  usage->store(999);
+  monitor->Sample();
+  EXPECT_FALSE(monitor->overloaded());
+  EXPECT_FALSE(precheck(BeastRequest()).has_value());
+}
+
+TEST(MemoryPressureTest, Disabled) {
+  EXPECT_EQ(MakeMemoryPressureMonitor(0), nullptr);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,562 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/metrics.h"
+#include "google/cloud/functions/internal/cache_base.h"
+#include "google/cloud/functions/cache.h"
+#include <algorithm>
+#include <charconv>
+#include <iterator>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+namespace {
+
+namespace http = ::boost::beast::http;
+using Clock = std::chrono::steady_clock;
+
+/// The latency buckets, in nanoseconds, from 1ms to 10s.
+std::vector<std::uint64_t> LatencyBounds() {
+  auto constexpr kMicro = std::uint64_t{1000};
+  std::vector<std::uint64_t> bounds;
+  for (auto ms : {1, 2, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000,
+                  10000}) {
+    bounds.push_back(static_cast<std::uint64_t>(ms) * kMicro * kMicro);
+  }
+  return bounds;
+}
+
+/// The phase buckets, in nanoseconds, from 10us to 10s.
+std::vector<std::uint64_t> PhaseBounds() {
+  std::vector<std::uint64_t> bounds;
+  for (auto us : {10, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000,
+                  50000, 100000, 250000, 500000, 1000000, 2500000, 5000000,
+                  10000000}) {
+    bounds.push_back(static_cast<std::uint64_t>(us) * 1000);
+  }
+  return bounds;
+}
+
+/// The size buckets, in bytes, from 64B to 16MiB.
+std::vector<std::uint64_t> SizeBounds() {
+  std::vector<std::uint64_t> bounds;
+  for (auto b = std::uint64_t{64}; b <= 16 * 1024 * 1024; b *= 4) {
+    bounds.push_back(b);
+  }
+  return bounds;
+}
+
+/// The allocation count buckets, from 1 to 100000.
+std::vector<std::uint64_t> AllocationBounds() {
+  std::vector<std::uint64_t> bounds;
+  for (auto n : {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000,
+                 20000, 50000, 100000}) {
+    bounds.push_back(static_cast<std::uint64_t>(n));
+  }
+  return bounds;
+}
+
+void AppendDouble(std::string& out, double value) {
+  char buffer[32];
+  auto const r = std::to_chars(std::begin(buffer), std::end(buffer), value);
+  out.append(buffer, r.ptr);
+}
+
+void AppendHistogramHeader(std::string& out, char const* name,
+                           char const* help) {
+  out += "# HELP ";
+  out += name;
+  out += ' ';
+  out += help;
+  out += "\n# TYPE ";
+  out += name;
+  out += " histogram\n";
+}
+
+/// Appends the series for @p histogram, @p labels may be empty.
+void AppendHistogramSeries(std::string& out, char const* name,
+                           std::string_view labels, Histogram const& histogram,
+                           double scale) {
+  auto const snapshot = histogram.Collect();
+  std::string const suffix =
+      labels.empty() ? std::string{} : "{" + std::string(labels) + "}";
+  std::uint64_t cumulative = 0;
+  auto const& bounds = histogram.bounds();
+  for (std::size_t i = 0; i != snapshot.buckets.size(); ++i) {
+    cumulative += snapshot.buckets[i];
+    out += name;
+    out += "_bucket{";
+    if (!labels.empty()) {
+      out += labels;
+      out += ',';
+    }
+    out += R"(le=")";
+    if (i == bounds.size()) {
+      out += "+Inf";
+    } else {
+      AppendDouble(out, static_cast<double>(bounds[i]) / scale);
+    }
+    out += "\"} ";
+    out += std::to_string(cumulative);
+    out += '\n';
+  }
+  out += name;
+  out += "_sum";
+  out += suffix;
+  out += ' ';
+  AppendDouble(out, static_cast<double>(snapshot.sum) / scale);
+  out += '\n';
+  out += name;
+  out += "_count";
+  out += suffix;
+  out += ' ';
+  out += std::to_string(snapshot.count);
+  out += '\n';
+}
+
+void AppendHistogram(std::string& out, char const* name, char const* help,
+                     Histogram const& histogram, double scale) {
+  AppendHistogramHeader(out, name, help);
+  AppendHistogramSeries(out, name, {}, histogram, scale);
+}
+
+void AppendGauge(std::string& out, char const* name, char const* help,
+                 std::int64_t value) {
+  out += "# HELP ";
+  out += name;
+  out += ' ';
+  out += help;
+  out += "\n# TYPE ";
+  out += name;
+  out += " gauge\n";
+  out += name;
+  out += ' ';
+  out += std::to_string(value);
+  out += '\n';
+}
+
+/// Appends @p value as a label value, escaped as required by Prometheus.
+void AppendLabelValue(std::string& out, std::string_view value) {
+  out += '"';
+  for (auto c : value) {
+    if (c == '\\' || c == '"') {
+      out += '\\';
+      out += c;
+    } else if (c == '\n') {
+      out += "\\n";
+    } else {
+      out += c;
+    }
+  }
+  out += '"';
+}
+
+/// Appends the statistics of the `functions::Cache` objects with a name.
+void AppendCacheMetrics(std::string& out) {
+  std::vector<std::pair<std::string, functions::CacheStats>> caches;
+  ForEachCache([&caches](std::string const& name,
+                         functions::CacheStats const& stats) {
+    caches.emplace_back(name, stats);
+  });
+  if (caches.empty()) return;
+  auto append = [&out, &caches](char const* name, char const* help,
+                                char const* type, auto value) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+    for (auto const& [cache, stats] : caches) {
+      out += name;
+      out += "{cache=";
+      AppendLabelValue(out, cache);
+      out += "} ";
+      out += std::to_string(value(stats));
+      out += '\n';
+    }
+  };
+  using Stats = functions::CacheStats;
+  append("functions_framework_cache_hits_total",
+         "The cache lookups that found a valid entry.", "counter",
+         [](Stats const& s) { return s.hits; });
+  append("functions_framework_cache_misses_total",
+         "The cache lookups that did not find a valid entry.", "counter",
+         [](Stats const& s) { return s.misses; });
+  append("functions_framework_cache_loads_total",
+         "The values loaded on a cache miss.", "counter",
+         [](Stats const& s) { return s.loads; });
+  append("functions_framework_cache_load_failures_total",
+         "The cache loads that failed.", "counter",
+         [](Stats const& s) { return s.load_failures; });
+  append("functions_framework_cache_evictions_total",
+         "The entries evicted to stay within the cache limits.", "counter",
+         [](Stats const& s) { return s.evictions; });
+  append("functions_framework_cache_expirations_total",
+         "The entries removed once their time to live passed.", "counter",
+         [](Stats const& s) { return s.expirations; });
+  append("functions_framework_cache_entries", "The entries in the cache.",
+         "gauge", [](Stats const& s) { return s.entries; });
+  append("functions_framework_cache_weight",
+         "The total weight of the entries in the cache.", "gauge",
+         [](Stats const& s) { return s.weight; });
+}
+
+/// The request body size, the content length for streaming requests.
+std::uint64_t RequestSize(BeastRequest const& request) {
+  if (!request.body().empty()) return request.body().size();
+  auto const length = request[http::field::content_length];
+  std::uint64_t size = 0;
+  std::from_chars(length.data(), length.data() + length.size(), size);
+  return size;
+}
+
+/// Records the request once the response is complete.
+class RequestRecorder {
+ public:
+  RequestRecorder(std::shared_ptr<ServerMetrics> metrics,
+                  BeastRequest const& request)
+      : metrics_(std::move(metrics)),
+        request_size_(RequestSize(request)),
+        start_(Clock::now()) {
+    metrics_->RequestStarted();
+  }
+
+  ~RequestRecorder() {
+    // The handler threw, or dropped the callback, without a response.
+    if (!finished_) Finish(500, 0);
+  }
+
+  RequestRecorder(RequestRecorder const&) = delete;
+  RequestRecorder& operator=(RequestRecorder const&) = delete;
+
+  void Finish(unsigned status, std::uint64_t response_size) {
+    finished_ = true;
+    metrics_->RequestFinished(status, Clock::now() - start_, request_size_,
+                              response_size);
+  }
+
+ private:
+  std::shared_ptr<ServerMetrics> metrics_;
+  std::uint64_t request_size_;
+  Clock::time_point start_;
+  bool finished_ = false;
+};
+
+/// Counts the bytes sent by a writer handler.
+class CountingWriter : public ResponseWriter {
+ public:
+  explicit CountingWriter(ResponseWriter& writer) : writer_(writer) {}
+
+  void WriteHeader(BeastResponse header) override {
+    status_ = header.result_int();
+    bytes_ += header.body().size();
+    writer_.WriteHeader(std::move(header));
+  }
+  void Write(std::string_view data) override {
+    bytes_ += data.size();
+    writer_.Write(data);
+  }
+  void SetHeartbeat(std::string_view data,
+                    std::chrono::milliseconds interval) override {
+    writer_.SetHeartbeat(data, interval);
+  }
+
+  [[nodiscard]] unsigned status() const { return status_; }
+  [[nodiscard]] std::uint64_t bytes() const { return bytes_; }
+
+ private:
+  ResponseWriter& writer_;
+  unsigned status_ = 500;
+  std::uint64_t bytes_ = 0;
+};
+
+}  // namespace
+
+std::size_t ThisThreadMetricShard() {
+  static std::atomic<std::size_t> next{0};
+  thread_local auto const kShard =
+      next.fetch_add(1, std::memory_order_relaxed) % kMetricShards;
+  return kShard;
+}
+
+Histogram::Histogram(std::vector<std::uint64_t> bounds)
+    : bounds_(std::move(bounds)) {
+  for (auto& s : shards_) {
+    s.buckets = std::make_unique<std::atomic<std::uint64_t>[]>(
+        bounds_.size() + 1);
+  }
+}
+
+void Histogram::Observe(std::uint64_t value) {
+  auto const l = std::lower_bound(bounds_.begin(), bounds_.end(), value);
+  auto const bucket = static_cast<std::size_t>(l - bounds_.begin());
+  auto& shard = shards_[ThisThreadMetricShard()];
+  shard.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+  shard.sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::Collect() const {
+  Snapshot snapshot;
+  snapshot.buckets.resize(bounds_.size() + 1);
+  for (auto const& s : shards_) {
+    for (std::size_t i = 0; i != snapshot.buckets.size(); ++i) {
+      auto const n = s.buckets[i].load(std::memory_order_relaxed);
+      snapshot.buckets[i] += n;
+      snapshot.count += n;
+    }
+    snapshot.sum += s.sum.load(std::memory_order_relaxed);
+  }
+  return snapshot;
+}
+
+ServerMetrics::ServerMetrics()
+    : status_(std::make_unique<std::array<StatusShard, kMetricShards>>()),
+      cpu_(std::make_unique<std::array<CpuShard, kMetricShards>>()),
+      latency_(LatencyBounds()),
+      request_size_(SizeBounds()),
+      response_size_(SizeBounds()) {
+  for (auto& p : phases_) p = std::make_unique<Histogram>(PhaseBounds());
+  if (!AllocationCountingEnabled()) return;
+  for (auto phase : kHandlerPhases) {
+    auto const i = static_cast<std::size_t>(phase);
+    allocations_[i] = std::make_unique<Histogram>(AllocationBounds());
+    allocated_bytes_[i] = std::make_unique<Histogram>(SizeBounds());
+  }
+}
+
+void ServerMetrics::RequestFinished(unsigned status,
+                                    std::chrono::nanoseconds latency,
+                                    std::uint64_t request_size,
+                                    std::uint64_t response_size) {
+  in_flight_.fetch_sub(1, std::memory_order_relaxed);
+  // Invalid status codes are counted as 0.
+  auto const index = status < kMaxStatus ? status : 0;
+  (*status_)[ThisThreadMetricShard()].counts[index].fetch_add(
+      1, std::memory_order_relaxed);
+  latency_.Observe(static_cast<std::uint64_t>(
+      std::max(latency.count(), std::chrono::nanoseconds::rep{0})));
+  request_size_.Observe(request_size);
+  response_size_.Observe(response_size);
+}
+
+void ServerMetrics::RecordPhase(RequestPhase phase,
+                                std::chrono::nanoseconds duration) {
+  phases_[static_cast<std::size_t>(phase)]->Observe(static_cast<std::uint64_t>(
+      std::max(duration.count(), std::chrono::nanoseconds::rep{0})));
+}
+
+void ServerMetrics::RecordAllocations(RequestPhase phase,
+                                      AllocationCounts counts) {
+  auto const i = static_cast<std::size_t>(phase);
+  if (!allocations_[i]) return;
+  allocations_[i]->Observe(counts.count);
+  allocated_bytes_[i]->Observe(counts.bytes);
+}
+
+void ServerMetrics::RecordCpuTime(std::string_view route,
+                                  std::string_view event_type,
+                                  std::chrono::nanoseconds cpu) {
+  auto& shard = (*cpu_)[ThisThreadMetricShard()];
+  std::lock_guard<std::mutex> lk(shard.mu);
+  auto r = shard.totals.find(route);
+  if (r == shard.totals.end()) {
+    r = shard.totals.emplace(std::string(route), CpuTotals::mapped_type{})
+            .first;
+  }
+  auto t = r->second.find(event_type);
+  if (t == r->second.end()) {
+    if (shard.series >= kMaxCpuSeries) event_type = "other";
+    t = r->second.find(event_type);
+  }
+  if (t == r->second.end()) {
+    t = r->second.emplace(std::string(event_type), CpuTotal{}).first;
+    ++shard.series;
+  }
+  ++t->second.requests;
+  t->second.cpu += cpu;
+}
+
+std::string ServerMetrics::Render() const {
+  std::string out;
+  out += "# HELP functions_framework_requests_total The completed requests.\n";
+  out += "# TYPE functions_framework_requests_total counter\n";
+  for (std::size_t code = 0; code != kMaxStatus; ++code) {
+    std::uint64_t count = 0;
+    for (auto const& s : *status_) {
+      count += s.counts[code].load(std::memory_order_relaxed);
+    }
+    if (count == 0) continue;
+    out += R"(functions_framework_requests_total{code=")";
+    out += std::to_string(code);
+    out += "\"} ";
+    out += std::to_string(count);
+    out += '\n';
+  }
+  AppendGauge(out, "functions_framework_sessions", "The open connections.",
+              sessions_.load(std::memory_order_relaxed));
+  AppendGauge(out, "functions_framework_requests_in_flight",
+              "The requests in progress.",
+              in_flight_.load(std::memory_order_relaxed));
+  auto constexpr kNanosPerSecond = 1e9;
+  AppendHistogram(out, "functions_framework_request_duration_seconds",
+                  "The time spent in the function.", latency_,
+                  kNanosPerSecond);
+  auto constexpr kPhaseName = "functions_framework_request_phase_seconds";
+  AppendHistogramHeader(out, kPhaseName,
+                        "The time spent in each phase of the requests.");
+  for (std::size_t i = 0; i != phases_.size(); ++i) {
+    auto const labels = R"(phase=")" +
+                        std::string(RequestPhaseName(RequestPhase(i))) + "\"";
+    AppendHistogramSeries(out, kPhaseName, labels, *phases_[i],
+                          kNanosPerSecond);
+  }
+  if (AllocationCountingEnabled()) {
+    auto append = [&out](char const* name, char const* help,
+                         auto const& histograms) {
+      AppendHistogramHeader(out, name, help);
+      for (auto phase : kHandlerPhases) {
+        auto const labels =
+            R"(phase=")" + std::string(RequestPhaseName(phase)) + "\"";
+        AppendHistogramSeries(out, name, labels,
+                              *histograms[static_cast<std::size_t>(phase)],
+                              1.0);
+      }
+    };
+    append("functions_framework_request_phase_allocations",
+           "The heap allocations in each phase of the requests.",
+           allocations_);
+    append("functions_framework_request_phase_allocated_bytes",
+           "The bytes allocated in each phase of the requests.",
+           allocated_bytes_);
+  }
+  CpuTotals cpu;
+  for (auto& shard : *cpu_) {
+    std::lock_guard<std::mutex> lk(shard.mu);
+    for (auto const& [route, types] : shard.totals) {
+      auto& merged = cpu[route];
+      for (auto const& [type, total] : types) {
+        merged[type].requests += total.requests;
+        merged[type].cpu += total.cpu;
+      }
+    }
+  }
+  auto append_cpu = [&out, &cpu](char const* name, char const* help,
+                                 auto value) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += " counter\n";
+    for (auto const& [route, types] : cpu) {
+      for (auto const& [type, total] : types) {
+        out += name;
+        out += "{route=";
+        AppendLabelValue(out, route);
+        out += ",event_type=";
+        AppendLabelValue(out, type);
+        out += "} ";
+        value(total);
+        out += '\n';
+      }
+    }
+  };
+  append_cpu("functions_framework_handler_cpu_seconds_total",
+             "The CPU time used by the handlers.", [&out](CpuTotal const& t) {
+               AppendDouble(out, std::chrono::duration<double>(t.cpu).count());
+             });
+  append_cpu("functions_framework_handler_cpu_requests_total",
+             "The requests included in the handler CPU time.",
+             [&out](CpuTotal const& t) { out += std::to_string(t.requests); });
+  out +=
+      "# HELP functions_framework_stale_events_total The CloudEvents dropped"
+      " as older than the maximum event age.\n"
+      "# TYPE functions_framework_stale_events_total counter\n"
+      "functions_framework_stale_events_total ";
+  out += std::to_string(stale_events_.load(std::memory_order_relaxed));
+  out += '\n';
+  AppendHistogram(out, "functions_framework_request_size_bytes",
+                  "The size of the request bodies.", request_size_, 1.0);
+  AppendHistogram(out, "functions_framework_response_size_bytes",
+                  "The size of the response bodies.", response_size_, 1.0);
+  AppendCacheMetrics(out);
+  return out;
+}
+
+BeastResponse ServerMetrics::MakeResponse() const {
+  BeastResponse response;
+  response.result(http::status::ok);
+  response.set(http::field::content_type, "text/plain; version=0.0.4");
+  response.set(http::field::cache_control, "no-store");
+  response.body() = Render();
+  return response;
+}
+
+Handler MakeMetricsHandler(Handler handler,
+                           std::shared_ptr<ServerMetrics> metrics) {
+  return [handler = std::move(handler),
+          metrics = std::move(metrics)](BeastRequest request) {
+    RequestRecorder recorder(metrics, request);
+    auto response = handler(std::move(request));
+    recorder.Finish(response.result_int(), response.body().size());
+    return response;
+  };
+}
+
+StreamingHandler MakeMetricsStreamingHandler(
+    StreamingHandler handler, std::shared_ptr<ServerMetrics> metrics) {
+  return [handler = std::move(handler), metrics = std::move(metrics)](
+             BeastRequest request, functions::HttpRequestBodyReader& reader) {
+    RequestRecorder recorder(metrics, request);
+    auto response = handler(std::move(request), reader);
+    recorder.Finish(response.result_int(), response.body().size());
+    return response;
+  };
+}
+
+WriterHandler MakeMetricsWriterHandler(WriterHandler handler,
+                                       std::shared_ptr<ServerMetrics> metrics) {
+  return [handler = std::move(handler), metrics = std::move(metrics)](
+             BeastRequest request, ResponseWriter& writer) {
+    RequestRecorder recorder(metrics, request);
+    CountingWriter counting(writer);
+    auto const ok = handler(std::move(request), counting);
+    recorder.Finish(counting.status(), counting.bytes());
+    return ok;
+  };
+}
+
+AsyncHandler MakeMetricsAsyncHandler(AsyncHandler handler,
+                                     std::shared_ptr<ServerMetrics> metrics) {
+  return [handler = std::move(handler), metrics = std::move(metrics)](
+             BeastRequest request, AsyncResponseCallback callback) {
+    auto recorder = std::make_shared<RequestRecorder>(metrics, request);
+    handler(std::move(request),
+            [recorder = std::move(recorder),
+             callback = std::move(callback)](BeastResponse response) {
+              recorder->Finish(response.result_int(), response.body().size());
+              callback(std::move(response));
+            });
+  };
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,175 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_METRICS_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_METRICS_H
+
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/internal/request_timing.h"
+#include "google/cloud/functions/version.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// The number of shards used by the metrics, threads are assigned round-robin.
+inline constexpr std::size_t kMetricShards = 16;
+
+/// Returns the metrics shard of the calling thread.
+std::size_t ThisThreadMetricShard();
+
+/**
+ * A histogram with fixed buckets, updated without locks.
+ *
+ * Each thread updates the buckets of its own shard, with relaxed atomic
+ * increments that do not contend with other threads. The shards are only
+ * merged by `Collect()`, when the metrics are scraped.
+ */
+class Histogram {
+ public:
+  /// Creates a histogram, @p bounds are the sorted upper bounds of the buckets.
+  explicit Histogram(std::vector<std::uint64_t> bounds);
+
+  void Observe(std::uint64_t value);
+
+  struct Snapshot {
+    /// The count for each bucket, the last bucket has no upper bound.
+    std::vector<std::uint64_t> buckets;
+    std::uint64_t sum = 0;
+    std::uint64_t count = 0;
+  };
+  [[nodiscard]] Snapshot Collect() const;
+
+  [[nodiscard]] std::vector<std::uint64_t> const& bounds() const {
+    return bounds_;
+  }
+
+ private:
+  struct alignas(64) Shard {
+    std::unique_ptr<std::atomic<std::uint64_t>[]> buckets;
+    std::atomic<std::uint64_t> sum{0};
+  };
+
+  std::vector<std::uint64_t> bounds_;
+  std::array<Shard, kMetricShards> shards_;
+};
+
+/**
+ * The server metrics, exported in the Prometheus text format.
+ *
+ * Records the requests by status code, the open sessions, the requests in
+ * progress, and histograms for the handler latency, the time (and, if enabled,
+ * the heap allocations) in each request phase, and the body sizes. The CPU
+ * time of the handlers is totaled by route and CloudEvent type.
+ */
+class ServerMetrics {
+ public:
+  ServerMetrics();
+
+  void SessionOpened() { sessions_.fetch_add(1, std::memory_order_relaxed); }
+  void SessionClosed() { sessions_.fetch_sub(1, std::memory_order_relaxed); }
+
+  void RequestStarted() { in_flight_.fetch_add(1, std::memory_order_relaxed); }
+  void RequestFinished(unsigned status, std::chrono::nanoseconds latency,
+                       std::uint64_t request_size,
+                       std::uint64_t response_size);
+
+  /// Records the time a request spent in @p phase.
+  void RecordPhase(RequestPhase phase, std::chrono::nanoseconds duration);
+
+  /// Records the heap allocations of a request in @p phase, only used if
+  /// `AllocationCountingEnabled()`.
+  void RecordAllocations(RequestPhase phase, AllocationCounts counts);
+
+  /**
+   * Adds the CPU time of a request to the total of its route and event type.
+   *
+   * Either may be empty. Once there are `kMaxCpuSeries` totals, new event
+   * types are counted as `other`, the types come from the requests.
+   */
+  void RecordCpuTime(std::string_view route, std::string_view event_type,
+                     std::chrono::nanoseconds cpu);
+
+  static auto constexpr kMaxCpuSeries = std::size_t{256};
+
+  /// Counts the CloudEvents dropped as too old, see `EventAgeCutoff`.
+  void RecordStaleEvents(std::uint64_t n) {
+    stale_events_.fetch_add(n, std::memory_order_relaxed);
+  }
+
+  /// Formats all the metrics, in the Prometheus text exposition format.
+  [[nodiscard]] std::string Render() const;
+
+  /// Returns a response with the result of `Render()`.
+  [[nodiscard]] BeastResponse MakeResponse() const;
+
+ private:
+  static auto constexpr kMaxStatus = std::size_t{600};
+  struct alignas(64) StatusShard {
+    std::array<std::atomic<std::uint64_t>, kMaxStatus> counts{};
+  };
+  struct CpuTotal {
+    std::uint64_t requests = 0;
+    std::chrono::nanoseconds cpu{0};
+  };
+  /// The totals by route, then by event type.
+  using CpuTotals =
+      std::map<std::string, std::map<std::string, CpuTotal, std::less<>>,
+               std::less<>>;
+  struct alignas(64) CpuShard {
+    std::mutex mu;
+    CpuTotals totals;
+    std::size_t series = 0;
+  };
+
+  std::atomic<std::int64_t> sessions_{0};
+  std::atomic<std::int64_t> in_flight_{0};
+  std::atomic<std::uint64_t> stale_events_{0};
+  std::unique_ptr<std::array<StatusShard, kMetricShards>> status_;
+  std::unique_ptr<std::array<CpuShard, kMetricShards>> cpu_;
+  Histogram latency_;
+  std::array<std::unique_ptr<Histogram>, kRequestPhaseCount> phases_;
+  // Only created for the handler phases, and if counting allocations.
+  std::array<std::unique_ptr<Histogram>, kRequestPhaseCount> allocations_;
+  std::array<std::unique_ptr<Histogram>, kRequestPhaseCount> allocated_bytes_;
+  Histogram request_size_;
+  Histogram response_size_;
+};
+
+/// Wrap the handlers to record each request in @p metrics.
+Handler MakeMetricsHandler(Handler handler,
+                           std::shared_ptr<ServerMetrics> metrics);
+StreamingHandler MakeMetricsStreamingHandler(
+    StreamingHandler handler, std::shared_ptr<ServerMetrics> metrics);
+WriterHandler MakeMetricsWriterHandler(WriterHandler handler,
+                                       std::shared_ptr<ServerMetrics> metrics);
+AsyncHandler MakeMetricsAsyncHandler(AsyncHandler handler,
+                                     std::shared_ptr<ServerMetrics> metrics);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_METRICS_H
@@ -0,0 +1,222 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/metrics.h"
+#include "google/cloud/functions/cache.h"
+#include <gmock/gmock.h>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::Not;
+namespace http = ::boost::beast::http;
+
+TEST(MetricsTest, Histogram) {
+  Histogram histogram({10, 100});
+  for (auto v : {1, 10, 11, 100, 1000}) {
+    histogram.Observe(static_cast<std::uint64_t>(v));
+  }
+  auto const snapshot = histogram.Collect();
+  EXPECT_THAT(snapshot.buckets, ElementsAre(2, 2, 1));
+  EXPECT_EQ(snapshot.count, 5);
+  EXPECT_EQ(snapshot.sum, 1122);
+}
+
+TEST(MetricsTest, HistogramThreads) {
+  Histogram histogram({10});
+  std::vector<std::future<void>> tasks(8);
+  for (auto& t : tasks) {
+    t = std::async(std::launch::async, [&histogram] {
+      for (int i = 0; i != 1000; ++i) histogram.Observe(1);
+    });
+  }
+  for (auto& t : tasks) t.get();
+  auto const snapshot = histogram.Collect();
+  EXPECT_EQ(snapshot.count, 8000);
+  EXPECT_EQ(snapshot.sum, 8000);
+}
+
+TEST(MetricsTest, Render) {
+  ServerMetrics metrics;
+  metrics.SessionOpened();
+  metrics.RequestStarted();
+  metrics.RequestFinished(200, std::chrono::milliseconds(3), 10, 100);
+  metrics.RequestStarted();
+  metrics.RequestFinished(404, std::chrono::milliseconds(30), 0, 1000);
+  metrics.RequestStarted();
+  auto const text = metrics.Render();
+  EXPECT_THAT(text, HasSubstr("functions_framework_requests_total{code=\"200\"}"
+                              " 1\n"));
+  EXPECT_THAT(text, HasSubstr("functions_framework_requests_total{code=\"404\"}"
+                              " 1\n"));
+  EXPECT_THAT(text, HasSubstr("functions_framework_sessions 1\n"));
+  EXPECT_THAT(text, HasSubstr("functions_framework_requests_in_flight 1\n"));
+  EXPECT_THAT(text, HasSubstr("# TYPE functions_framework_request_duration_"
+                              "seconds histogram\n"));
+  EXPECT_THAT(text, HasSubstr("functions_framework_request_duration_seconds_"
+                              "bucket{le=\"0.005\"} 1\n"));
+  EXPECT_THAT(text, HasSubstr("functions_framework_request_duration_seconds_"
+                              "bucket{le=\"+Inf\"} 2\n"));
+  EXPECT_THAT(text, HasSubstr("functions_framework_request_duration_seconds_"
+                              "sum 0.033\n"));
+  EXPECT_THAT(text, HasSubstr("functions_framework_response_size_bytes_sum "
+                              "1100\n"));
+
+  auto const response = metrics.MakeResponse();
+  EXPECT_EQ(response[http::field::content_type], "text/plain; version=0.0.4");
+}
+
+TEST(MetricsTest, Phases) {
+  ServerMetrics metrics;
+  metrics.RecordPhase(RequestPhase::kRead, std::chrono::microseconds(20));
+  metrics.RecordPhase(RequestPhase::kFunction, std::chrono::milliseconds(2));
+  auto const text = metrics.Render();
+  EXPECT_THAT(text, HasSubstr("# TYPE functions_framework_request_phase_"
+                              "seconds histogram\n"));
+  EXPECT_THAT(text, HasSubstr("functions_framework_request_phase_seconds_"
+                              "bucket{phase=\"read\",le=\"5e-05\"} 1\n"));
+  EXPECT_THAT(text, HasSubstr("functions_framework_request_phase_seconds_"
+                              "sum{phase=\"function\"} 0.002\n"));
+  EXPECT_THAT(text, HasSubstr("functions_framework_request_phase_seconds_"
+                              "count{phase=\"write\"} 0\n"));
+}
+
+TEST(MetricsTest, Allocations) {
+  ServerMetrics metrics;
+  metrics.RecordAllocations(RequestPhase::kDecode, AllocationCounts{3, 300});
+  auto const text = metrics.Render();
+  if (!AllocationCountingEnabled()) {
+    EXPECT_THAT(text, Not(HasSubstr("allocations")));
+    return;
+  }
+  EXPECT_THAT(text, HasSubstr("functions_framework_request_phase_"
+                              "allocations_bucket{phase=\"decode\",le=\"5\"} "
+                              "1\n"));
+  EXPECT_THAT(text, HasSubstr("functions_framework_request_phase_allocated_"
+                              "bytes_sum{phase=\"decode\"} 300\n"));
+  EXPECT_THAT(text, Not(HasSubstr("allocations_count{phase=\"read\"}")));
+}
+
+TEST(MetricsTest, CpuTime) {
+  ServerMetrics metrics;
+  metrics.RecordCpuTime("/a", "", std::chrono::milliseconds(2));
+  metrics.RecordCpuTime("/a", "", std::chrono::milliseconds(3));
+  metrics.RecordCpuTime("", "com.example.\"quoted\"\\",
+                        std::chrono::milliseconds(1));
+  auto const text = metrics.Render();
+  EXPECT_THAT(text, HasSubstr("# TYPE functions_framework_handler_cpu_seconds_"
+                              "total counter\n"));
+  EXPECT_THAT(text, HasSubstr("functions_framework_handler_cpu_seconds_total{"
+                              "route=\"/a\",event_type=\"\"} 0.005\n"));
+  EXPECT_THAT(text, HasSubstr("functions_framework_handler_cpu_requests_total{"
+                              "route=\"/a\",event_type=\"\"} 2\n"));
+  EXPECT_THAT(text, HasSubstr("functions_framework_handler_cpu_requests_total{"
+                              "route=\"\",event_type=\"com.example."
+                              "\\\"quoted\\\"\\\\\"} 1\n"));
+}
+
+TEST(MetricsTest, CpuTimeSeriesLimit) {
+  ServerMetrics metrics;
+  auto const n = ServerMetrics::kMaxCpuSeries + 10;
+  for (std::size_t i = 0; i != n; ++i) {
+    metrics.RecordCpuTime("/events", "type-" + std::to_string(i),
+                          std::chrono::milliseconds(1));
+  }
+  auto const text = metrics.Render();
+  EXPECT_THAT(text, HasSubstr("functions_framework_handler_cpu_requests_total{"
+                              "route=\"/events\",event_type=\"type-0\"} 1\n"));
+  EXPECT_THAT(text, HasSubstr("functions_framework_handler_cpu_requests_total{"
+                              "route=\"/events\",event_type=\"other\"} 10\n"));
+  auto const last = "event_type=\"type-" + std::to_string(n - 1);
+  EXPECT_THAT(text, Not(HasSubstr(last)));
+}
+
+TEST(MetricsTest, Caches) {
+  ServerMetrics metrics;
+  EXPECT_THAT(metrics.Render(), Not(HasSubstr("functions_framework_cache_")));
+
+  functions::CacheOptions options;
+  options.name = "tokens";
+  functions::Cache<int, int> cache(options);
+  cache.Put(1, 1);
+  (void)cache.Get(1);
+  (void)cache.Get(2);
+  auto const text = metrics.Render();
+  EXPECT_THAT(text, HasSubstr("# TYPE functions_framework_cache_hits_total "
+                              "counter\n"
+                              "functions_framework_cache_hits_total{cache="
+                              "\"tokens\"} 1\n"));
+  EXPECT_THAT(text, HasSubstr("functions_framework_cache_misses_total{cache="
+                              "\"tokens\"} 1\n"));
+  EXPECT_THAT(text, HasSubstr("# TYPE functions_framework_cache_entries gauge\n"
+                              "functions_framework_cache_entries{cache="
+                              "\"tokens\"} 1\n"));
+}
+
+TEST(MetricsTest, Handlers) {
+  auto metrics = std::make_shared<ServerMetrics>();
+  auto handler = MakeMetricsHandler(
+      [](BeastRequest const&) {
+        BeastResponse response;
+        response.result(http::status::created);
+        response.body() = "done";
+        return response;
+      },
+      metrics);
+  BeastRequest request;
+  request.body() = "payload";
+  EXPECT_EQ(handler(request).result(), http::status::created);
+
+  AsyncResponseCallback pending;
+  auto async = MakeMetricsAsyncHandler(
+      [&pending](BeastRequest const&, AsyncResponseCallback cb) {
+        pending = std::move(cb);
+      },
+      metrics);
+  async(request, [](BeastResponse const&) {});
+  EXPECT_THAT(metrics->Render(),
+              HasSubstr("functions_framework_requests_in_flight 1\n"));
+  BeastResponse response;
+  response.result(http::status::accepted);
+  pending(std::move(response));
+
+  auto throwing = MakeMetricsHandler(
+      [](BeastRequest const&) -> BeastResponse {
+        throw std::runtime_error("test-only");
+      },
+      metrics);
+  EXPECT_THROW(throwing(request), std::runtime_error);
+
+  auto const text = metrics->Render();
+  EXPECT_THAT(text, HasSubstr("functions_framework_requests_total{code=\"201\"}"
+                              " 1\n"));
+  EXPECT_THAT(text, HasSubstr("functions_framework_requests_total{code=\"202\"}"
+                              " 1\n"));
+  EXPECT_THAT(text, HasSubstr("functions_framework_requests_total{code=\"500\"}"
+                              " 1\n"));
+  EXPECT_THAT(text, HasSubstr("functions_framework_requests_in_flight 0\n"));
+  EXPECT_THAT(text,
+              HasSubstr("functions_framework_request_size_bytes_sum 21\n"));
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
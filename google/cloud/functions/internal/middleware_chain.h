@@ -0,0 +1,72 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_MIDDLEWARE_CHAIN_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_MIDDLEWARE_CHAIN_H
+
+#include "google/cloud/functions/http_request.h"
+#include "google/cloud/functions/http_response.h"
+#include "google/cloud/functions/version.h"
+#include <type_traits>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * One layer of a middleware chain, and the rest of the chain.
+ *
+ * The types of all the layers are known at compile time, each layer calls the
+ * next one directly, and the compiler may inline the whole chain.
+ */
+template <typename Layer, typename Next>
+class ChainLink {
+ public:
+  ChainLink(Layer layer, Next next)
+      : layer_(std::move(layer)), next_(std::move(next)) {}
+
+  functions::HttpResponse operator()(functions::HttpRequest request) {
+    return layer_(std::move(request), next_);
+  }
+
+ private:
+  Layer layer_;
+  Next next_;
+};
+
+template <typename Handler>
+auto MakeChain(Handler&& handler) {
+  static_assert(std::is_invocable_r_v<functions::HttpResponse,
+                                      std::decay_t<Handler>&,
+                                      functions::HttpRequest>,
+                "the last element of a chain must be an HTTP function");
+  return std::decay_t<Handler>(std::forward<Handler>(handler));
+}
+
+template <typename Layer, typename Next, typename... Rest>
+auto MakeChain(Layer&& layer, Next&& next, Rest&&... rest) {
+  auto tail = MakeChain(std::forward<Next>(next), std::forward<Rest>(rest)...);
+  static_assert(std::is_invocable_r_v<functions::HttpResponse,
+                                      std::decay_t<Layer>&,
+                                      functions::HttpRequest, decltype(tail)&>,
+                "each layer of a chain must be callable with an HTTP request"
+                " and the next layer");
+  return ChainLink<std::decay_t<Layer>, decltype(tail)>(
+      std::forward<Layer>(layer), std::move(tail));
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_MIDDLEWARE_CHAIN_H
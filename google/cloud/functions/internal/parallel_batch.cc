@@ -0,0 +1,214 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/parallel_batch.h"
+#include "google/cloud/functions/internal/cancellation.h"
+#include "google/cloud/functions/internal/cpu_limits.h"
+#include <boost/asio/post.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+/// The state of a batch, shared by the threads running its events.
+class BatchState {
+ public:
+  BatchState(std::shared_ptr<functions::UserCloudEventFunction const> function,
+             std::shared_ptr<
+                 functions::UserCloudEventOrderingKeyFunction const> key,
+             bool ordered)
+      : function_(std::move(function)),
+        key_(std::move(key)),
+        ordered_(ordered),
+        cancellation_(CurrentCancellation()) {}
+
+  /// Queues @p event, returns the number of events queued so far.
+  std::size_t Push(functions::CloudEvent event) {
+    // Compute the key in the producer thread, outside the lock.
+    auto key = OrderingKey(event);
+    std::lock_guard<std::mutex> lk(mu_);
+    pending_.push_back({pushed_, std::move(event), std::move(key)});
+    cv_.notify_one();
+    return ++pushed_;
+  }
+
+  /// No more events will be queued.
+  void Close() {
+    std::lock_guard<std::mutex> lk(mu_);
+    closed_ = true;
+    cv_.notify_all();
+  }
+
+  /// Runs events until the queue is closed and empty.
+  void Work() {
+    // The events in the pool threads belong to the same request.
+    ScopedCancellation scoped(cancellation_.get());
+    std::unique_lock<std::mutex> lk(mu_);
+    while (true) {
+      cv_.wait(lk, [this] { return closed_ || !pending_.empty(); });
+      if (pending_.empty()) return;
+      auto item = std::move(pending_.front());
+      pending_.pop_front();
+      if (item.key) {
+        // Another thread is running an event with the same key, it runs this
+        // event once it completes.
+        auto const [i, inserted] = running_keys_.try_emplace(*item.key);
+        if (!inserted) {
+          i->second.push_back(std::move(item));
+          continue;
+        }
+      }
+      // Run the event, and then the events with the same key queued behind
+      // it, in order.
+      while (true) {
+        Run(lk, item);
+        if (!item.key) break;
+        auto i = running_keys_.find(*item.key);
+        if (i->second.empty()) {
+          running_keys_.erase(i);
+          break;
+        }
+        item = std::move(i->second.front());
+        i->second.pop_front();
+      }
+    }
+  }
+
+  /// Waits until all the events complete, and returns the errors in order.
+  std::vector<BatchEventError> Wait() {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait(lk, [this] { return closed_ && done_ == pushed_; });
+    auto errors = std::move(errors_);
+    lk.unlock();
+    std::sort(errors.begin(), errors.end(),
+              [](auto const& a, auto const& b) { return a.index < b.index; });
+    return errors;
+  }
+
+ private:
+  struct Item {
+    std::size_t index;
+    functions::CloudEvent event;
+    std::optional<std::string> key;
+  };
+
+  std::optional<std::string> OrderingKey(functions::CloudEvent const& event) {
+    if (!key_) return std::nullopt;
+    try {
+      return (*key_)(event);
+    } catch (...) {
+      return std::nullopt;
+    }
+  }
+
+  /// Runs @p item, @p lk is unlocked while the function runs.
+  void Run(std::unique_lock<std::mutex>& lk, Item& item) {
+    auto const skip = ordered_ && failed_;
+    lk.unlock();
+    std::exception_ptr error;
+    auto id = item.event.id();
+    if (!skip) {
+      try {
+        (*function_)(std::move(item.event));
+      } catch (...) {
+        error = std::current_exception();
+      }
+    }
+    lk.lock();
+    if (skip || error) {
+      errors_.push_back({item.index, std::move(id), std::move(error)});
+      failed_ = true;
+    }
+    if (++done_ == pushed_ && closed_) cv_.notify_all();
+  }
+
+  std::shared_ptr<functions::UserCloudEventFunction const> function_;
+  std::shared_ptr<functions::UserCloudEventOrderingKeyFunction const> key_;
+  bool ordered_;
+  std::shared_ptr<CancellationState> cancellation_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<Item> pending_;
+  /// The keys with a running event, and the events waiting for it.
+  std::unordered_map<std::string, std::deque<Item>> running_keys_;
+  std::size_t pushed_ = 0;
+  std::size_t done_ = 0;
+  bool closed_ = false;
+  bool failed_ = false;
+  std::vector<BatchEventError> errors_;
+};
+
+}  // namespace
+
+ParallelBatchRunner::ParallelBatchRunner(
+    functions::UserCloudEventFunction function,
+    functions::CloudEventBatchOptions options)
+    : function_(std::make_shared<functions::UserCloudEventFunction const>(
+          std::move(function))),
+      parallelism_(options.parallelism != 0 ? options.parallelism
+                                            : DefaultConcurrency()),
+      ordered_(options.ordered) {
+  if (!options.ordering_key) return;
+  ordering_key_ = std::make_shared<
+      functions::UserCloudEventOrderingKeyFunction const>(
+      std::move(options.ordering_key));
+}
+
+ParallelBatchRunner::~ParallelBatchRunner() {
+  if (pool_) pool_->join();
+}
+
+std::vector<BatchEventError> ParallelBatchRunner::Run(
+    std::vector<functions::CloudEvent> events) {
+  return Run([&events](EventSink const& sink) {
+    for (auto& e : events) sink(std::move(e));
+  });
+}
+
+std::vector<BatchEventError> ParallelBatchRunner::Run(
+    EventProducer const& producer) {
+  auto state = std::make_shared<BatchState>(function_, ordering_key_, ordered_);
+  // The calling thread runs events once the producer returns, start a pool
+  // thread for each additional event, up to the configured parallelism.
+  // Workers that start after the batch completes find no events, and return.
+  auto sink = [&](functions::CloudEvent event) {
+    auto const queued = state->Push(std::move(event));
+    if (queued == 1 || queued > parallelism_) return;
+    boost::asio::post(Pool(), [state] { state->Work(); });
+  };
+  std::exception_ptr error;
+  try {
+    producer(sink);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  state->Close();
+  state->Work();
+  auto errors = state->Wait();
+  if (error) std::rethrow_exception(error);
+  return errors;
+}
+
+boost::asio::thread_pool& ParallelBatchRunner::Pool() {
+  std::call_once(pool_once_, [this] { pool_.emplace(parallelism_ - 1); });
+  return *pool_;
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,87 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PARALLEL_BATCH_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PARALLEL_BATCH_H
+
+#include "google/cloud/functions/cloud_event.h"
+#include "google/cloud/functions/user_functions.h"
+#include "google/cloud/functions/version.h"
+#include <boost/asio/thread_pool.hpp>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// The outcome of an event in a batch that did not complete successfully.
+struct BatchEventError {
+  /// The position of the event in the batch.
+  std::size_t index;
+  std::string id;
+  /// The exception thrown by the function, null if the event was skipped.
+  std::exception_ptr error;
+};
+
+/**
+ * Runs the events of a batch concurrently.
+ *
+ * See `functions::CloudEventBatchOptions`. The pool is shared by all the
+ * batches, and created once the first batch with more than one event runs.
+ */
+class ParallelBatchRunner {
+ public:
+  ParallelBatchRunner(functions::UserCloudEventFunction function,
+                      functions::CloudEventBatchOptions options);
+  ~ParallelBatchRunner();
+
+  /// Runs all the events, returns the failed and skipped events in order.
+  std::vector<BatchEventError> Run(std::vector<functions::CloudEvent> events);
+
+  using EventSink = std::function<void(functions::CloudEvent)>;
+  using EventProducer = std::function<void(EventSink const&)>;
+
+  /**
+   * Runs the events passed by @p producer to its sink, as they are produced.
+   *
+   * The pool threads start running events while @p producer runs, the calling
+   * thread joins them once @p producer returns. If @p producer throws, the
+   * events already produced complete, and the exception is rethrown.
+   */
+  std::vector<BatchEventError> Run(EventProducer const& producer);
+
+  [[nodiscard]] std::size_t parallelism() const { return parallelism_; }
+
+ private:
+  boost::asio::thread_pool& Pool();
+
+  std::shared_ptr<functions::UserCloudEventFunction const> function_;
+  std::shared_ptr<functions::UserCloudEventOrderingKeyFunction const>
+      ordering_key_;
+  std::size_t parallelism_;
+  bool ordered_;
+  std::once_flag pool_once_;
+  std::optional<boost::asio::thread_pool> pool_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PARALLEL_BATCH_H
@@ -0,0 +1,212 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/parallel_batch.h"
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::UnorderedElementsAre;
+
+std::vector<functions::CloudEvent> MakeEvents(int count) {
+  std::vector<functions::CloudEvent> events;
+  for (int i = 0; i != count; ++i) {
+    events.emplace_back("id-" + std::to_string(i), "test-source", "test-type");
+  }
+  return events;
+}
+
+std::vector<std::string> Ids(std::vector<BatchEventError> const& errors) {
+  std::vector<std::string> ids;
+  for (auto const& e : errors) ids.push_back(e.id);
+  return ids;
+}
+
+TEST(ParallelBatchTest, RunsAllEvents) {
+  std::mutex mu;
+  std::vector<std::string> ids;
+  ParallelBatchRunner runner(
+      [&](functions::CloudEvent const& e) {
+        std::lock_guard<std::mutex> lk(mu);
+        ids.push_back(e.id());
+      },
+      functions::CloudEventBatchOptions{4});
+  EXPECT_EQ(runner.parallelism(), 4);
+  auto const errors = runner.Run(MakeEvents(5));
+  EXPECT_TRUE(errors.empty());
+  EXPECT_THAT(ids,
+              UnorderedElementsAre("id-0", "id-1", "id-2", "id-3", "id-4"));
+}
+
+TEST(ParallelBatchTest, RunsConcurrently) {
+  // Each event waits until all the events start, this only completes if they
+  // run concurrently.
+  std::mutex mu;
+  std::condition_variable cv;
+  int started = 0;
+  ParallelBatchRunner runner(
+      [&](functions::CloudEvent const&) {
+        std::unique_lock<std::mutex> lk(mu);
+        if (++started == 3) cv.notify_all();
+        if (!cv.wait_for(lk, std::chrono::seconds(30),
+                         [&] { return started == 3; })) {
+          throw std::runtime_error("timeout");
+        }
+      },
+      functions::CloudEventBatchOptions{3});
+  EXPECT_TRUE(runner.Run(MakeEvents(3)).empty());
+  // The pool is reused by the next batch.
+  started = 0;
+  EXPECT_TRUE(runner.Run(MakeEvents(3)).empty());
+}
+
+TEST(ParallelBatchTest, DefaultParallelism) {
+  ParallelBatchRunner runner([](functions::CloudEvent const&) {},
+                             functions::CloudEventBatchOptions{});
+  EXPECT_GE(runner.parallelism(), 1);
+  EXPECT_TRUE(runner.Run(MakeEvents(2)).empty());
+  EXPECT_TRUE(runner.Run(std::vector<functions::CloudEvent>{}).empty());
+}
+
+TEST(ParallelBatchTest, UnorderedReportsAllErrors) {
+  ParallelBatchRunner runner(
+      [](functions::CloudEvent const& e) {
+        if (e.id() != "id-2") throw std::runtime_error("uh-oh");
+      },
+      functions::CloudEventBatchOptions{2});
+  auto const errors = runner.Run(MakeEvents(4));
+  EXPECT_THAT(Ids(errors), ElementsAre("id-0", "id-1", "id-3"));
+  for (auto const& e : errors) EXPECT_TRUE(e.error);
+}
+
+TEST(ParallelBatchTest, OrderedSkipsAfterFailure) {
+  std::vector<std::string> ids;
+  ParallelBatchRunner runner(
+      [&ids](functions::CloudEvent const& e) {
+        ids.push_back(e.id());
+        if (e.id() == "id-1") throw std::runtime_error("uh-oh");
+      },
+      functions::CloudEventBatchOptions{/*parallelism=*/1, /*ordered=*/true});
+  auto const errors = runner.Run(MakeEvents(4));
+  EXPECT_THAT(ids, ElementsAre("id-0", "id-1"));
+  ASSERT_THAT(Ids(errors), ElementsAre("id-1", "id-2", "id-3"));
+  EXPECT_EQ(errors[0].index, 1);
+  EXPECT_TRUE(errors[0].error);
+  EXPECT_FALSE(errors[1].error);
+  EXPECT_FALSE(errors[2].error);
+}
+
+TEST(ParallelBatchTest, RunsWhileProducing) {
+  // The producer waits until the first events run, this only completes if they
+  // start before the producer returns.
+  std::mutex mu;
+  std::condition_variable cv;
+  int started = 0;
+  ParallelBatchRunner runner(
+      [&](functions::CloudEvent const&) {
+        std::lock_guard<std::mutex> lk(mu);
+        ++started;
+        cv.notify_all();
+      },
+      functions::CloudEventBatchOptions{3});
+  auto producer = [&](ParallelBatchRunner::EventSink const& sink) {
+    for (auto& e : MakeEvents(2)) sink(std::move(e));
+    std::unique_lock<std::mutex> lk(mu);
+    if (!cv.wait_for(lk, std::chrono::seconds(30),
+                     [&] { return started != 0; })) {
+      throw std::runtime_error("timeout");
+    }
+    lk.unlock();
+    for (auto& e : MakeEvents(2)) sink(std::move(e));
+  };
+  auto const errors = runner.Run(producer);
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ(started, 4);
+}
+
+TEST(ParallelBatchTest, ProducerError) {
+  std::mutex mu;
+  std::vector<std::string> ids;
+  ParallelBatchRunner runner(
+      [&](functions::CloudEvent const& e) {
+        std::lock_guard<std::mutex> lk(mu);
+        ids.push_back(e.id());
+      },
+      functions::CloudEventBatchOptions{2});
+  auto producer = [](ParallelBatchRunner::EventSink const& sink) {
+    for (auto& e : MakeEvents(2)) sink(std::move(e));
+    throw std::invalid_argument("bad event");
+  };
+  EXPECT_THROW(runner.Run(producer), std::invalid_argument);
+  EXPECT_THAT(ids, UnorderedElementsAre("id-0", "id-1"));
+}
+
+TEST(ParallelBatchTest, OrderingKeys) {
+  // Events with the same subject run in order, while events with different
+  // subjects run concurrently: the first event of each subject waits until
+  // both started, and the events check they run after their predecessor.
+  std::mutex mu;
+  std::condition_variable cv;
+  int first_started = 0;
+  std::vector<std::string> ids;
+  functions::CloudEventBatchOptions options;
+  options.parallelism = 4;
+  options.ordering_key = [](functions::CloudEvent const& e) {
+    if (e.id() == "throw") throw std::runtime_error("testing");
+    return e.subject();
+  };
+  ParallelBatchRunner runner(
+      [&](functions::CloudEvent const& e) {
+        std::unique_lock<std::mutex> lk(mu);
+        if (e.id() == "a-0" || e.id() == "b-0") {
+          if (++first_started == 2) cv.notify_all();
+          if (!cv.wait_for(lk, std::chrono::seconds(30),
+                           [&] { return first_started == 2; })) {
+            throw std::runtime_error("timeout");
+          }
+        }
+        ids.push_back(e.id());
+      },
+      std::move(options));
+
+  std::vector<functions::CloudEvent> events;
+  for (auto const* id : {"a-0", "a-1", "b-0", "a-2", "b-1", "throw", "b-2"}) {
+    events.emplace_back(id, "test-source", "test-type");
+    if (id[1] == '-') events.back().set_subject(std::string(1, id[0]));
+  }
+  EXPECT_TRUE(runner.Run(std::move(events)).empty());
+  ASSERT_EQ(ids.size(), 7);
+  auto position = [&ids](std::string const& id) {
+    return std::find(ids.begin(), ids.end(), id) - ids.begin();
+  };
+  EXPECT_LT(position("a-0"), position("a-1"));
+  EXPECT_LT(position("a-1"), position("a-2"));
+  EXPECT_LT(position("b-0"), position("b-1"));
+  EXPECT_LT(position("b-1"), position("b-2"));
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -13,76 +13,462 @@
 // limitations under the License.
 
 #include "google/cloud/functions/internal/parse_cloud_event_http.h"
+#include "google/cloud/functions/internal/event_age.h"
 #include "google/cloud/functions/internal/parse_cloud_event_json.h"
 #include "google/cloud/functions/internal/parse_cloud_event_legacy.h"
+#include "google/cloud/functions/internal/parse_cloud_event_protobuf.h"
 #include "google/cloud/functions/internal/parse_cloud_event_storage.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <exception>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 
-bool HasHeader(BeastRequest const& request, std::string_view header) {
-  return request.count(header) != 0;
-}
+namespace {
+
+/// The binary content mode headers of a request, see `ScanHeaders()`.
+struct BinaryHeaders {
+  std::optional<std::string_view> id;
+  std::optional<std::string_view> source;
+  std::optional<std::string_view> type;
+  std::optional<std::string_view> spec_version;
+  std::optional<std::string_view> data_content_type;
+  std::optional<std::string_view> data_schema;
+  std::optional<std::string_view> subject;
+  std::optional<std::string_view> time;
+  std::optional<std::string_view> content_type;
+  /// The extension attributes, with the names not yet lowercased.
+  std::vector<std::pair<std::string_view, std::string_view>> extensions;
 
-bool HasMinimalCloudEventHeaders(BeastRequest const& request) {
-  char const* minimal_headers[] = {"ce-id", "ce-source", "ce-type"};
-  return std::all_of(std::begin(minimal_headers), std::end(minimal_headers),
-                     [&request](auto h) { return HasHeader(request, h); });
+  [[nodiscard]] bool HasMinimalAttributes() const {
+    return id && source && type;
+  }
+};
+
+void SetFirst(std::optional<std::string_view>& field, std::string_view value) {
+  if (!field) field = value;
 }
 
-functions::CloudEvent ParseCloudEventHttpBinary(BeastRequest const& request) {
-  std::string spec_version = functions::CloudEvent::kDefaultSpecVersion;
-  if (HasHeader(request, "ce-specversion")) {
-    spec_version = request["ce-specversion"];
-  }
-  functions::CloudEvent event(std::string(request.at("ce-id")),
-                              std::string(request.at("ce-source")),
-                              std::string(request.at("ce-type")), spec_version);
-  if (HasHeader(request, "ce-datacontenttype")) {
-    if (HasHeader(request, "Content-Type") &&
-        request["ce-datacontenttype"] != request["Content-Type"]) {
-      throw std::invalid_argument(
-          "Mismatched ce-datacontentype and Content-Type header values");
+/**
+ * Finds the Cloud Event headers in a single pass over the request headers.
+ *
+ * As with `request[name]`, the first header wins if a name is repeated.
+ * Any other `ce-` headers are extension attributes.
+ */
+BinaryHeaders ScanHeaders(BeastRequest const& request) {
+  using ::boost::beast::iequals;
+  BinaryHeaders headers;
+  for (auto const& field : request) {
+    auto const name = field.name_string();
+    auto const value = field.value();
+    if (field.name() == boost::beast::http::field::content_type) {
+      SetFirst(headers.content_type, {value.data(), value.size()});
+      continue;
+    }
+    if (name.size() < 4 || !iequals(name.substr(0, 3), "ce-")) continue;
+    auto const attribute = name.substr(3);
+    auto const v = std::string_view{value.data(), value.size()};
+    auto const match = [&](char const* expected,
+                           std::optional<std::string_view>& field) {
+      if (!iequals(attribute, expected)) return false;
+      SetFirst(field, v);
+      return true;
+    };
+    // Dispatch on the size first, most comparisons are avoided.
+    auto known = false;
+    switch (attribute.size()) {
+      case 2:
+        known = match("id", headers.id);
+        break;
+      case 4:
+        known = match("type", headers.type) || match("time", headers.time);
+        break;
+      case 6:
+        known = match("source", headers.source);
+        break;
+      case 7:
+        known = match("subject", headers.subject);
+        break;
+      case 10:
+        known = match("dataschema", headers.data_schema);
+        break;
+      case 11:
+        known = match("specversion", headers.spec_version);
+        break;
+      case 15:
+        known = match("datacontenttype", headers.data_content_type);
+        break;
+      default:
+        break;
+    }
+    if (!known) {
+      headers.extensions.emplace_back(
+          std::string_view{attribute.data(), attribute.size()}, v);
     }
-    event.set_data_content_type(std::string(request["ce-datacontenttype"]));
-  } else if (HasHeader(request, "Content-Type")) {
-    event.set_data_content_type(std::string(request["Content-Type"]));
   }
+  return headers;
+}
 
-  if (HasHeader(request, "ce-dataschema")) {
-    event.set_data_schema(std::string(request["ce-dataschema"]));
+/**
+ * Parse @p request in the binary content mode.
+ *
+ * If @p body is not null it is the request body, and it is moved into the
+ * event data instead of copied.
+ */
+ParseResult<functions::CloudEvent> ParseCloudEventHttpBinary(
+    BeastRequest const& request, BinaryHeaders const& headers,
+    std::string* body) {
+  if (!headers.HasMinimalAttributes()) {
+    return ParseError{
+        "missing ce-id, ce-source, and/or ce-type header in binary mode "
+        "Cloud Event"};
+  }
+  functions::CloudEvent event(
+      std::string(*headers.id), std::string(*headers.source),
+      std::string(*headers.type),
+      headers.spec_version ? std::string(*headers.spec_version)
+                           : functions::CloudEvent::kDefaultSpecVersion);
+  if (headers.data_content_type) {
+    if (headers.content_type &&
+        *headers.data_content_type != *headers.content_type) {
+      return ParseError{
+          "Mismatched ce-datacontentype and Content-Type header values"};
+    }
+    event.set_data_content_type(std::string(*headers.data_content_type));
+  } else if (headers.content_type) {
+    event.set_data_content_type(std::string(*headers.content_type));
   }
-  if (HasHeader(request, "ce-subject")) {
-    event.set_subject(std::string(request["ce-subject"]));
+
+  if (headers.data_schema) {
+    event.set_data_schema(std::string(*headers.data_schema));
   }
-  if (HasHeader(request, "ce-time")) {
-    event.set_time(std::string(request["ce-time"]));
+  if (headers.subject) event.set_subject(std::string(*headers.subject));
+  if (headers.time) event.set_time(std::string(*headers.time));
+  std::string name;
+  for (auto const& [n, value] : headers.extensions) {
+    name.clear();
+    std::transform(n.begin(), n.end(), std::back_inserter(name), [](char c) {
+      return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    });
+    // Headers that are not valid attribute names are ignored, and the first
+    // header wins if a name is repeated.
+    if (!functions::CloudEvent::IsValidExtensionName(name)) continue;
+    if (event.extension(name)) continue;
+    event.set_extension(name, value);
   }
 
-  if (request.has_content_length()) {
-    event.set_data(request.body());
+  // Chunked requests, and requests built by applications, may have a body
+  // without a content length.
+  if (request.has_content_length() || !request.body().empty()) {
+    // Convert Cloud Storage notifications from the body, without copying it
+    // into an intermediate event.
+    if (MaybeStorageNotification(event)) {
+      auto storage = ParseCloudEventStorage(event, request.body());
+      if (storage) return *std::move(storage);
+    }
+    event.set_data(body ? std::move(*body) : request.body());
   }
 
   return event;
 }
 
-std::vector<functions::CloudEvent> ParseCloudEventHttp(
-    BeastRequest const& request) {
-  if (!HasHeader(request, "content-type")) {
-    return {ParseCloudEventStorage(ParseCloudEventHttpBinary(request))};
+/// The decoders for the Cloud Event content types.
+enum class Format {
+  kJsonBatch,
+  kJson,
+  kProtobufBatch,
+  kProtobuf,
+  kLegacy,
+  kCustom,
+};
+
+struct FormatEntry {
+  Format format;
+  /// The decoder of `Format::kCustom` entries.
+  std::shared_ptr<functions::CloudEventDecoder const> decoder;
+};
+
+/// The longest media type with a decoder, see `FindFormat()`.
+auto constexpr kMaxMediaTypeSize = 128;
+
+/// Maps lowercase media types, without parameters, to their decoders.
+using FormatTable = std::unordered_map<std::string_view, FormatEntry>;
+
+/**
+ * The content types with a decoder, see `RegisterCloudEventDecoder()`.
+ *
+ * Each request finds its decoder with a single lookup. Registering a decoder
+ * publishes a new table, the previous tables are kept, parsers running
+ * concurrently may still use them. Registrations are rare, typically a few
+ * during startup.
+ */
+class FormatRegistry {
+ public:
+  static FormatRegistry& Instance() {
+    static auto* const kInstance = new FormatRegistry;
+    return *kInstance;
   }
-  auto const content_type = request["content-type"];
-  if (content_type.rfind("application/cloudevents-batch+json", 0) == 0) {
-    return ParseCloudEventJsonBatch(request.body());
+
+  [[nodiscard]] FormatTable const& table() const {
+    return *table_.load(std::memory_order_acquire);
+  }
+
+  void Register(std::string media_type,
+                std::shared_ptr<functions::CloudEventDecoder const> decoder) {
+    std::lock_guard<std::mutex> lk(mu_);
+    // The tables refer to the keys of `custom_`, which are never erased.
+    custom_[std::move(media_type)] = std::move(decoder);
+    auto table = std::make_unique<FormatTable>(BuiltinFormats());
+    for (auto const& [name, d] : custom_) {
+      (*table)[name] = FormatEntry{Format::kCustom, d};
+    }
+    table_.store(table.get(), std::memory_order_release);
+    tables_.push_back(std::move(table));
+  }
+
+ private:
+  FormatRegistry() {
+    tables_.push_back(std::make_unique<FormatTable>(BuiltinFormats()));
+    table_.store(tables_.back().get(), std::memory_order_release);
+  }
+
+  static FormatTable BuiltinFormats() {
+    return FormatTable{
+        {"application/cloudevents-batch+json", {Format::kJsonBatch, nullptr}},
+        {"application/cloudevents+json", {Format::kJson, nullptr}},
+        {"application/cloudevents-batch+protobuf",
+         {Format::kProtobufBatch, nullptr}},
+        {"application/cloudevents+protobuf", {Format::kProtobuf, nullptr}},
+        {"application/json", {Format::kLegacy, nullptr}},
+    };
+  }
+
+  std::mutex mu_;
+  std::map<std::string, std::shared_ptr<functions::CloudEventDecoder const>>
+      custom_;
+  std::vector<std::unique_ptr<FormatTable const>> tables_;
+  std::atomic<FormatTable const*> table_{nullptr};
+};
+
+/// Removes the parameters, and any whitespace, from @p content_type.
+std::string_view MediaType(std::string_view content_type) {
+  content_type = content_type.substr(0, content_type.find(';'));
+  auto const end = content_type.find_last_not_of(" \t");
+  if (end == std::string_view::npos) return {};
+  content_type = content_type.substr(0, end + 1);
+  return content_type.substr(
+      std::min(content_type.find_first_not_of(" \t"), content_type.size()));
+}
+
+/**
+ * Returns the decoder for @p content_type, or null to use the binary mode.
+ *
+ * Media types are case insensitive, but almost always lowercase. Only the
+ * others are converted, in a buffer large enough for any registered type.
+ */
+FormatEntry const* FindFormat(std::string_view content_type) {
+  auto const& table = FormatRegistry::Instance().table();
+  auto media_type = MediaType(content_type);
+  auto const is_upper = [](char c) { return c >= 'A' && c <= 'Z'; };
+  char buffer[kMaxMediaTypeSize];
+  if (std::any_of(media_type.begin(), media_type.end(), is_upper)) {
+    if (media_type.size() > sizeof(buffer)) return nullptr;
+    std::transform(media_type.begin(), media_type.end(), buffer, [](char c) {
+      return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    });
+    media_type = std::string_view(buffer, media_type.size());
   }
-  if (content_type.rfind("application/cloudevents+json", 0) == 0) {
-    return {ParseCloudEventJson(request.body())};
+  auto const l = table.find(media_type);
+  if (l == table.end()) return nullptr;
+  return &l->second;
+}
+
+/// Passes @p event to @p sink, if it is valid.
+ParseResult<std::size_t> Single(ParseResult<functions::CloudEvent> event,
+                                CloudEventSink const& sink) {
+  if (!event) return event.error();
+  sink(*std::move(event));
+  return std::size_t{1};
+}
+
+/**
+ * Passes the binary mode event in @p request to @p sink, unless it is stale.
+ *
+ * The `ce-time` header is checked first, stale events are dropped without
+ * copying their data.
+ */
+ParseResult<std::size_t> Binary(BeastRequest const& request,
+                                BinaryHeaders const& headers,
+                                std::string* body, EventAgeCutoff& cutoff,
+                                CloudEventSink const& sink) {
+  if (cutoff.enabled() && headers.HasMinimalAttributes() && headers.time &&
+      cutoff.Drop(*headers.id, *headers.time)) {
+    return std::size_t{0};
   }
-  if (content_type.rfind("application/json", 0) == 0 &&
-      !HasMinimalCloudEventHeaders(request)) {
-    return {ParseCloudEventLegacy(request.body())};
+  return Single(ParseCloudEventHttpBinary(request, headers, body), sink);
+}
+
+/// Parse @p request, moving @p body into the event data if it is not null.
+ParseResult<std::size_t> ParseCloudEventHttpImpl(BeastRequest const& request,
+                                                 std::string* body,
+                                                 EventAgeCutoff& cutoff,
+                                                 CloudEventSink const& sink) {
+  auto const headers = ScanHeaders(request);
+  if (!headers.content_type) {
+    return Binary(request, headers, body, cutoff, sink);
+  }
+  auto const content_type = *headers.content_type;
+  auto const* entry = FindFormat(content_type);
+  if (entry == nullptr) {
+    return Binary(request, headers, body, cutoff, sink);
+  }
+  std::size_t count = 0;
+  auto counted = [&](functions::CloudEvent e) {
+    sink(std::move(e));
+    ++count;
+  };
+  switch (entry->format) {
+    case Format::kJsonBatch:
+      return TryParseCloudEventJsonBatch(request.body(), sink);
+    case Format::kJson:
+      return Single(TryParseCloudEventJson(request.body()), sink);
+    case Format::kProtobufBatch:
+      ParseCloudEventProtobufBatch(request.body(), counted);
+      return count;
+    case Format::kProtobuf:
+      return Single(ParseCloudEventProtobuf(request.body()), sink);
+    case Format::kLegacy:
+      if (headers.HasMinimalAttributes()) break;
+      return Single(ParseCloudEventLegacy(request.body()), sink);
+    case Format::kCustom:
+      // The content type of binary mode events describes their data.
+      if (headers.HasMinimalAttributes()) break;
+      (*entry->decoder)(content_type, request.body(), counted);
+      return count;
+  }
+  return Binary(request, headers, body, cutoff, sink);
+}
+
+/**
+ * Parse @p request, returning any error in the request as a `ParseError`.
+ *
+ * The common errors, such as missing attributes, are returned directly. Some
+ * parsers report malformed payloads with exceptions, these are converted.
+ * Exceptions thrown by @p sink propagate unchanged. The events older than the
+ * maximum event age of the thread are dropped, @p sink never sees them.
+ */
+ParseResult<std::size_t> TryParseCloudEventHttp(BeastRequest const& request,
+                                                std::string* body,
+                                                CloudEventSink const& sink) {
+  EventAgeCutoff cutoff;
+  auto in_sink = false;
+  auto wrapped = [&](functions::CloudEvent e) {
+    if (cutoff.Drop(e.id(), e.time())) return;
+    in_sink = true;
+    sink(std::move(e));
+    in_sink = false;
+  };
+  try {
+    return ParseCloudEventHttpImpl(request, body, cutoff, wrapped);
+  } catch (std::exception const& ex) {
+    if (in_sink) throw;
+    return ParseError{ex.what()};
+  }
+}
+
+/// Parse @p request into a vector, moving @p body if it is not null.
+ParseResult<std::vector<functions::CloudEvent>> CollectCloudEvents(
+    BeastRequest const& request, std::string* body) {
+  std::vector<functions::CloudEvent> events;
+  auto result = TryParseCloudEventHttp(
+      request, body,
+      [&events](functions::CloudEvent e) { events.push_back(std::move(e)); });
+  if (!result) return result.error();
+  return events;
+}
+
+}  // namespace
+
+functions::CloudEvent ParseCloudEventHttpBinary(BeastRequest const& request) {
+  return ParseCloudEventHttpBinary(request, ScanHeaders(request), nullptr)
+      .value();
+}
+
+std::vector<functions::CloudEvent> ParseCloudEventHttp(
+    BeastRequest const& request) {
+  return TryParseCloudEventHttp(request).value();
+}
+
+void ParseCloudEventHttp(BeastRequest const& request,
+                         CloudEventSink const& sink) {
+  auto result = TryParseCloudEventHttp(request, nullptr, sink);
+  if (!result) throw std::invalid_argument(result.error().message);
+}
+
+void ParseCloudEventHttp(BeastRequest&& request, CloudEventSink const& sink) {
+  auto result = TryParseCloudEventHttp(request, &request.body(), sink);
+  if (!result) throw std::invalid_argument(result.error().message);
+}
+
+ParseResult<std::vector<functions::CloudEvent>> TryParseCloudEventHttp(
+    BeastRequest const& request) {
+  return CollectCloudEvents(request, nullptr);
+}
+
+ParseResult<std::size_t> TryParseCloudEventHttp(BeastRequest const& request,
+                                                CloudEventSink const& sink) {
+  return TryParseCloudEventHttp(request, nullptr, sink);
+}
+
+ParseResult<std::vector<functions::CloudEvent>> TryParseCloudEventHttp(
+    BeastRequest&& request) {
+  return CollectCloudEvents(request, &request.body());
+}
+
+ParseResult<std::size_t> TryParseCloudEventHttp(BeastRequest&& request,
+                                                CloudEventSink const& sink) {
+  return TryParseCloudEventHttp(request, &request.body(), sink);
+}
+
+bool IsCloudEventHttp(BeastRequest const& request) {
+  auto const headers = ScanHeaders(request);
+  if (headers.HasMinimalAttributes()) return true;
+  if (!headers.content_type) return false;
+  if (headers.content_type->rfind("application/cloudevents", 0) == 0) {
+    return true;
+  }
+  auto const* entry = FindFormat(*headers.content_type);
+  return entry != nullptr && entry->format == Format::kCustom;
+}
+
+void RegisterCloudEventDecoder(std::string media_type,
+                               functions::CloudEventDecoder decoder) {
+  std::transform(media_type.begin(), media_type.end(), media_type.begin(),
+                 [](char c) {
+                   return static_cast<char>(
+                       std::tolower(static_cast<unsigned char>(c)));
+                 });
+  if (media_type.empty() || media_type.size() > kMaxMediaTypeSize ||
+      MediaType(media_type) != media_type) {
+    throw std::invalid_argument("invalid Cloud Event media type: " +
+                                media_type);
   }
-  return {ParseCloudEventStorage(ParseCloudEventHttpBinary(request))};
+  FormatRegistry::Instance().Register(
+      std::move(media_type),
+      std::make_shared<functions::CloudEventDecoder const>(std::move(decoder)));
 }
 
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
@@ -16,8 +16,13 @@
 #define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PARSE_CLOUD_EVENT_HTTP_H
 
 #include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/internal/parse_cloud_event_json.h"
+#include "google/cloud/functions/internal/parse_result.h"
 #include "google/cloud/functions/cloud_event.h"
+#include "google/cloud/functions/cloud_event_parser.h"
 #include "google/cloud/functions/version.h"
+#include <cstddef>
+#include <string>
 #include <vector>
 
 namespace google::cloud::functions_internal {
@@ -30,6 +35,57 @@ functions::CloudEvent ParseCloudEventHttpBinary(BeastRequest const& request);
 std::vector<functions::CloudEvent> ParseCloudEventHttp(
     BeastRequest const& request);
 
+/**
+ * Parse @p request as one or more Cloud Events, calling @p sink for each.
+ *
+ * Batches are parsed incrementally, see `ParseCloudEventJsonBatch()`.
+ */
+void ParseCloudEventHttp(BeastRequest const& request,
+                         CloudEventSink const& sink);
+
+/// Parse @p request as in the previous overload, moving the body into the
+/// event data in the binary content mode.
+void ParseCloudEventHttp(BeastRequest&& request, CloudEventSink const& sink);
+
+/**
+ * Parse @p request as Cloud Events, returning the error if it is invalid.
+ *
+ * Invalid requests are rejected without exceptions in the common cases, such
+ * as missing attributes or a malformed batch. Exceptions thrown by @p sink
+ * propagate unchanged. The events older than `CurrentMaxEventAge()` are
+ * dropped, see `EventAgeCutoff`.
+ */
+///@{
+ParseResult<std::vector<functions::CloudEvent>> TryParseCloudEventHttp(
+    BeastRequest const& request);
+ParseResult<std::size_t> TryParseCloudEventHttp(BeastRequest const& request,
+                                                CloudEventSink const& sink);
+///@}
+
+/**
+ * Parse @p request as in the previous overloads, moving the body into the
+ * event data in the binary content mode.
+ */
+///@{
+ParseResult<std::vector<functions::CloudEvent>> TryParseCloudEventHttp(
+    BeastRequest&& request);
+ParseResult<std::size_t> TryParseCloudEventHttp(BeastRequest&& request,
+                                                CloudEventSink const& sink);
+///@}
+
+/**
+ * Returns true if @p request contains Cloud Events.
+ *
+ * That is, if it has the required binary mode headers, a structured or
+ * batched Cloud Events content type, or a registered content type. Legacy
+ * events are not detected.
+ */
+bool IsCloudEventHttp(BeastRequest const& request);
+
+/// Implements `functions::RegisterCloudEventFormat()`.
+void RegisterCloudEventDecoder(std::string media_type,
+                               functions::CloudEventDecoder decoder);
+
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions_internal
 
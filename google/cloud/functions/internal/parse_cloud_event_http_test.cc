@@ -24,6 +24,7 @@ FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 namespace {
 
 using ::testing::ElementsAre;
+using ::testing::Pair;
 
 auto TestBeastRequest() {
   BeastRequest request;
@@ -61,6 +62,36 @@ TEST(ParseCloudEventHttp, MissingRequiredFields) {
   }
 }
 
+TEST(ParseCloudEventHttp, HeaderNamesAreCaseInsensitive) {
+  BeastRequest request;
+  request.insert("CE-Type", "com.example.someevent");
+  request.insert("Ce-Source", "/mycontext");
+  request.insert("ce-ID", "A234-1234-1234");
+  request.insert("CE-SUBJECT", "some-subject");
+  request.insert("Ce-DataContentType", "text/plain");
+  request.insert("CONTENT-TYPE", "text/plain");
+  auto ce = ParseCloudEventHttpBinary(request);
+  EXPECT_EQ(ce.id(), "A234-1234-1234");
+  EXPECT_EQ(ce.source(), "/mycontext");
+  EXPECT_EQ(ce.type(), "com.example.someevent");
+  EXPECT_EQ(ce.subject().value_or(""), "some-subject");
+  EXPECT_EQ(ce.data_content_type().value_or(""), "text/plain");
+}
+
+TEST(ParseCloudEventHttp, RepeatedAndExtensionHeaders) {
+  auto request = TestBeastRequest();
+  request.insert("ce-subject", "first");
+  request.insert("ce-subject", "second");
+  request.insert("ce-someextension", "first");
+  request.insert("CE-SomeExtension", "second");
+  request.insert("ce-invalid-name", "ignored");
+  request.insert("ce-", "ignored");
+  auto ce = ParseCloudEventHttpBinary(request);
+  EXPECT_EQ(ce.subject().value_or(""), "first");
+  EXPECT_THAT(ce.extensions(),
+              ElementsAre(Pair("someextension", "first")));
+}
+
 TEST(ParseCloudEventHttp, WithCloudEventDataContentType) {
   auto request = TestBeastRequest();
   request.insert("ce-datacontenttype", "text/plain");
@@ -235,6 +266,24 @@ TEST(ParseCloudEventHttp, JsonBatch) {
                                "A234-1234-1234-2"));
 }
 
+TEST(ParseCloudEventHttp, Protobuf) {
+  // An `io.cloudevents.v1.CloudEvent` message with `id`, `source` and `type`.
+  auto const event = std::string("\x0a\x01" "a" "\x12\x01" "s" "\x22\x01" "t");
+  BeastRequest request;
+  request.insert("content-type", "application/cloudevents+protobuf");
+  request.body() = event;
+  auto events = ParseCloudEventHttp(request);
+  ASSERT_EQ(events.size(), 1);
+  EXPECT_EQ(events[0].id(), "a");
+  EXPECT_EQ(events[0].source(), "s");
+  EXPECT_EQ(events[0].type(), "t");
+
+  request.set("content-type", "application/cloudevents-batch+protobuf");
+  request.body() = "\x0a\x09" + event + "\x0a\x09" + event;
+  events = ParseCloudEventHttp(request);
+  EXPECT_EQ(events.size(), 2);
+}
+
 TEST(ParseCloudEventHttp, Binary) {
   auto request = TestBeastRequest();
   request.prepare_payload();
@@ -13,49 +13,100 @@
 // limitations under the License.
 
 #include "google/cloud/functions/internal/parse_cloud_event_json.h"
-#include "google/cloud/functions/internal/base64_decode.h"
+#include "google/cloud/functions/internal/json_scanner.h"
 #include "google/cloud/functions/internal/parse_cloud_event_storage.h"
-#include <nlohmann/json.hpp>
-#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 namespace {
 
-functions::CloudEvent ParseCloudEventJson(nlohmann::json const& json) {
-  if (!json.contains("id") || !json.contains("source") ||
-      !json.contains("type")) {
-    throw std::runtime_error(
-        "JSON message missing `id`, `source`, and/or `type` fields");
+/**
+ * Parse the JSON object @p json as a Cloud Event.
+ *
+ * If @p storage is `true`, Cloud Storage notifications sent by Pub/Sub are
+ * converted to Cloud Storage events, from the data in @p json.
+ */
+ParseResult<functions::CloudEvent> ParseCloudEventJsonObject(
+    std::string_view json, bool storage) {
+  // Locate the attributes without building a DOM, the data (often the
+  // largest part of the event) is copied as-is.
+  std::optional<std::string_view> id;
+  std::optional<std::string_view> source;
+  std::optional<std::string_view> type;
+  std::optional<std::string_view> spec_version;
+  std::optional<std::string_view> data_content_type;
+  std::optional<std::string_view> data_schema;
+  std::optional<std::string_view> subject;
+  std::optional<std::string_view> time;
+  std::optional<std::string_view> data;
+  std::optional<std::string_view> data_base64;
+  std::vector<JsonMember> extensions;
+  for (auto const& m : JsonObjectMembers(json)) {
+    if (m.key == "id") {
+      id = m.value;
+    } else if (m.key == "source") {
+      source = m.value;
+    } else if (m.key == "type") {
+      type = m.value;
+    } else if (m.key == "specversion") {
+      spec_version = m.value;
+    } else if (m.key == "datacontenttype") {
+      data_content_type = m.value;
+    } else if (m.key == "dataschema") {
+      data_schema = m.value;
+    } else if (m.key == "subject") {
+      subject = m.value;
+    } else if (m.key == "time") {
+      time = m.value;
+    } else if (m.key == "data") {
+      data = m.value;
+    } else if (m.key == "data_base64") {
+      data_base64 = m.value;
+    } else {
+      extensions.push_back(m);
+    }
+  }
+  if (!id || !source || !type) {
+    return ParseError{
+        "JSON message missing `id`, `source`, and/or `type` fields"};
   }
 
   auto event = functions::CloudEvent(
-      json.at("id").get<std::string>(), json.at("source").get<std::string>(),
-      json.at("type").get<std::string>(),
-      json.value("specversion", functions::CloudEvent::kDefaultSpecVersion));
-  if (json.count("datacontenttype") != 0) {
-    event.set_data_content_type(json.at("datacontenttype").get<std::string>());
-  }
-  if (json.count("dataschema") != 0) {
-    event.set_data_schema(json.at("dataschema").get<std::string>());
+      JsonUnescapeString(*id), JsonUnescapeString(*source),
+      JsonUnescapeString(*type),
+      spec_version ? JsonUnescapeString(*spec_version)
+                   : functions::CloudEvent::kDefaultSpecVersion);
+  if (data_content_type) {
+    event.set_data_content_type(JsonUnescapeString(*data_content_type));
   }
-  if (json.count("subject") != 0) {
-    event.set_subject(json.at("subject").get<std::string>());
+  if (data_schema) event.set_data_schema(JsonUnescapeString(*data_schema));
+  if (subject) event.set_subject(JsonUnescapeString(*subject));
+  if (time) event.set_time(JsonUnescapeString(*time));
+  for (auto const& m : extensions) {
+    // Extension values are strings, numbers, or booleans. Members that are
+    // not valid attribute names, and null or structured values, are ignored.
+    if (!functions::CloudEvent::IsValidExtensionName(m.key)) continue;
+    auto const c = m.value.front();
+    if (c == 'n' || c == '{' || c == '[') continue;
+    event.set_extension(m.key, c == '"' ? JsonUnescapeString(m.value)
+                                        : std::string(m.value));
   }
-  if (json.count("time") != 0) {
-    event.set_time(json.at("time").get<std::string>());
-  }
-  if (json.count("data") != 0) {
-    auto const& d = json.at("data");
-    if (d.is_object()) {
-      event.set_data(d.dump());
+  if (data) {
+    if (storage && data->front() == '{' && MaybeStorageNotification(event)) {
+      auto s = ParseCloudEventStorage(event, *data);
+      if (s) return *std::move(s);
+    }
+    if (data->front() == '{') {
+      event.set_data(std::string(*data));
     } else {
-      event.set_data(d.get<std::string>());
+      event.set_data(JsonUnescapeString(*data));
     }
-  } else if (json.count("data_base64") != 0) {
-    // TODO(#117) - consider storing as std::vector<std::uint8_t>
-    event.set_data(
-        Base64Decode(json.at("data_base64").get_ref<std::string const&>()));
+  } else if (data_base64) {
+    event.set_data(JsonBase64Decode(*data_base64));
   }
 
   return event;
@@ -65,24 +116,47 @@ functions::CloudEvent ParseCloudEventJson(nlohmann::json const& json) {
 
 /// Parse @p json_string as a Cloud Event
 functions::CloudEvent ParseCloudEventJson(std::string_view json_string) {
-  auto json = nlohmann::json::parse(json_string);
-  return ParseCloudEventStorage(ParseCloudEventJson(json));
+  return ParseCloudEventJsonObject(json_string, /*storage=*/true).value();
 }
 
 std::vector<functions::CloudEvent> ParseCloudEventJsonBatch(
     std::string_view json_string) {
-  auto const json = nlohmann::json::parse(json_string);
-  if (!json.is_array()) {
-    throw std::invalid_argument(
-        "ParseCloudEventJsonBatch - the input string must be a JSON array");
-  }
   std::vector<functions::CloudEvent> events;
-  events.reserve(json.size());
-  std::transform(
-      json.begin(), json.end(), std::back_inserter(events),
-      [](nlohmann::json const& j) { return ParseCloudEventJson(j); });
+  ParseCloudEventJsonBatch(json_string, [&events](functions::CloudEvent e) {
+    events.push_back(std::move(e));
+  });
   return events;
 }
 
+void ParseCloudEventJsonBatch(std::string_view json_string,
+                              CloudEventSink const& sink) {
+  auto result = TryParseCloudEventJsonBatch(json_string, sink);
+  if (!result) throw std::invalid_argument(result.error().message);
+}
+
+ParseResult<functions::CloudEvent> TryParseCloudEventJson(
+    std::string_view json_string) {
+  return ParseCloudEventJsonObject(json_string, /*storage=*/true);
+}
+
+ParseResult<std::size_t> TryParseCloudEventJsonBatch(
+    std::string_view json_string, CloudEventSink const& sink) {
+  auto const first = json_string.find_first_not_of(" \t\r\n");
+  if (first == std::string_view::npos || json_string[first] != '[') {
+    return ParseError{
+        "ParseCloudEventJsonBatch - the input string must be a JSON array"};
+  }
+  // Locating the elements is cheap, they are views of the input. Parsing each
+  // element into an event, which copies its data, happens one at a time.
+  std::size_t count = 0;
+  for (auto const element : JsonArrayElements(json_string)) {
+    auto event = ParseCloudEventJsonObject(element, /*storage=*/false);
+    if (!event) return event.error();
+    sink(*std::move(event));
+    ++count;
+  }
+  return count;
+}
+
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions_internal
@@ -15,8 +15,11 @@
 #ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PARSE_CLOUD_EVENT_JSON_H
 #define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PARSE_CLOUD_EVENT_JSON_H
 
+#include "google/cloud/functions/internal/parse_result.h"
 #include "google/cloud/functions/cloud_event.h"
 #include "google/cloud/functions/version.h"
+#include <cstddef>
+#include <functional>
 #include <string_view>
 #include <vector>
 
@@ -26,10 +29,37 @@ FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 /// Parse @p json_string as a Cloud Event
 functions::CloudEvent ParseCloudEventJson(std::string_view json_string);
 
+/// Receives each event as it is parsed.
+using CloudEventSink = std::function<void(functions::CloudEvent)>;
+
 /// Parse @p json_string as a batch of Cloud Events
 std::vector<functions::CloudEvent> ParseCloudEventJsonBatch(
     std::string_view json_string);
 
+/**
+ * Parse @p json_string as a batch of Cloud Events, calling @p sink for each.
+ *
+ * Each event is parsed and passed to @p sink before the next one is parsed.
+ * If an event is invalid, the previous events have been passed to @p sink.
+ */
+void ParseCloudEventJsonBatch(std::string_view json_string,
+                              CloudEventSink const& sink);
+
+/**
+ * Parse @p json_string as a Cloud Event, returning the error if it is invalid.
+ *
+ * Events without the required attributes are rejected without throwing. The
+ * JSON scanner may still throw `std::invalid_argument` if the text is not
+ * valid JSON.
+ */
+ParseResult<functions::CloudEvent> TryParseCloudEventJson(
+    std::string_view json_string);
+
+/// Parse a batch as `ParseCloudEventJsonBatch()`, returns the number of events
+/// or the error for the first invalid event.
+ParseResult<std::size_t> TryParseCloudEventJsonBatch(
+    std::string_view json_string, CloudEventSink const& sink);
+
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions_internal
 
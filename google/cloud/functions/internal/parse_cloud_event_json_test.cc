@@ -25,6 +25,7 @@ namespace {
 
 using ::testing::ElementsAre;
 using ::testing::IsEmpty;
+using ::testing::Pair;
 
 TEST(ParseCloudEventJson, Basic) {
   auto constexpr kText = R"js({
@@ -171,6 +172,46 @@ TEST(ParseCloudEventJson, WithData) {
   EXPECT_THROW(ParseCloudEventJson(kTextInvalid), std::exception);
 }
 
+TEST(ParseCloudEventJson, WithObjectData) {
+  auto constexpr kText = R"js({
+    "type" : "com.example.someevent",
+    "source" : "/mycontext",
+    "id" : "A234-1234-1234",
+    "data" : {"b": [1, 2], "a": "x\"y"}})js";
+  auto const ce = ParseCloudEventJson(kText);
+  // The data is copied as received, without reformatting.
+  EXPECT_EQ(ce.data().value_or(""), R"js({"b": [1, 2], "a": "x\"y"})js");
+}
+
+TEST(ParseCloudEventJson, WithEscapedAttributes) {
+  auto constexpr kText = R"js({
+    "type" : "com.example.\u0073omeevent",
+    "source" : "/my\/context",
+    "id" : "A234-1234-1234",
+    "subject" : "line\nbreak"})js";
+  auto const ce = ParseCloudEventJson(kText);
+  EXPECT_EQ(ce.type(), "com.example.someevent");
+  EXPECT_EQ(ce.source(), "/my/context");
+  EXPECT_EQ(ce.subject().value_or(""), "line\nbreak");
+}
+
+TEST(ParseCloudEventJson, WithExtensions) {
+  auto constexpr kText = R"js({
+    "type" : "com.example.someevent",
+    "source" : "/mycontext",
+    "id" : "A234-1234-1234",
+    "traceparent" : "00-\u0061bc-01",
+    "count" : 42,
+    "enabled" : true,
+    "nothing" : null,
+    "structured" : {"a": 1},
+    "Invalid-Name" : "ignored"})js";
+  auto const ce = ParseCloudEventJson(kText);
+  EXPECT_THAT(ce.extensions(),
+              ElementsAre(Pair("traceparent", "00-abc-01"), Pair("count", "42"),
+                          Pair("enabled", "true")));
+}
+
 TEST(ParseCloudEventJson, WithDataBase64) {
   // Obtained magic string using:
   //   echo "some text" | openssl base64 -e
@@ -186,6 +227,15 @@ TEST(ParseCloudEventJson, WithDataBase64) {
     "dataschema" : {"foo": "bar"}})js";
   auto const ce = ParseCloudEventJson(kText);
   EXPECT_EQ(ce.data().value_or(""), "some text\n");
+
+  // Escapes in the base64 string are decoded first.
+  auto constexpr kTextEscaped = R"js({
+    "type" : "com.example.someevent",
+    "source" : "/mycontext",
+    "id" : "A234-1234-1234",
+    "data_base64" : "c29tZSB0ZXh0Cg\u003d\u003d"})js";
+  EXPECT_EQ(ParseCloudEventJson(kTextEscaped).data().value_or(""),
+            "some text\n");
   EXPECT_THROW(ParseCloudEventJson(kTextInvalid), std::exception);
 }
 
@@ -227,6 +277,19 @@ TEST(ParseCloudEventJson, BatchInvalid) {
                std::exception);
 }
 
+TEST(ParseCloudEventJson, BatchSink) {
+  auto constexpr kText = R"js([
+  {"type" : "com.example.someevent", "source" : "/mycontext", "id" : "A-0"},
+  {"type" : "com.example.someevent", "source" : "/mycontext", "id" : "A-1"},
+  {"type" : "com.example.someevent", "source" : "/mycontext"}
+  ])js";
+  std::vector<std::string> ids;
+  EXPECT_THROW(ParseCloudEventJsonBatch(
+                   kText, [&ids](auto ce) { ids.push_back(ce.id()); }),
+               std::exception);
+  EXPECT_THAT(ids, ElementsAre("A-0", "A-1"));
+}
+
 TEST(ParseCloudEventJson, EmulateStorage) {
   auto const data = nlohmann::json::parse(R"js({
     "bucket": "some-bucket",
@@ -13,99 +13,141 @@
 // limitations under the License.
 
 #include "google/cloud/functions/internal/parse_cloud_event_legacy.h"
+#include "google/cloud/functions/internal/json_scanner.h"
 #include <nlohmann/json.hpp>
-#include <deque>
-#include <regex>
+#include <algorithm>
+#include <array>
+#include <initializer_list>
+#include <optional>
+#include <string_view>
 #include <utility>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 namespace {
-// NOLINTNEXTLINE(misc-no-recursion)
+/**
+ * Returns the string at @p path in @p json, or an empty string.
+ *
+ * The path is a list of keys, usually a list of literals, no copies of the
+ * keys or the intermediate objects are made.
+ */
 std::string GetNestedKey(nlohmann::json const& json,
-                         std::deque<std::string> path) {
-  if (path.empty()) return std::string{};
-  if (!json.contains(path.front())) return std::string{};
-  auto const& sub = json.at(path.front());
-  path.pop_front();
-  if (sub.is_string() && path.empty()) return sub.get<std::string>();
-  if (!sub.is_object()) return std::string{};
-  return GetNestedKey(sub, std::move(path));
+                         std::initializer_list<std::string_view> path) {
+  if (path.size() == 0) return std::string{};
+  auto const* node = &json;
+  for (auto key : path) {
+    if (!node->is_object()) return std::string{};
+    auto const l = node->find(key);
+    if (l == node->end()) return std::string{};
+    node = &*l;
+  }
+  if (!node->is_string()) return std::string{};
+  return node->get<std::string>();
 }
 
 std::string GetAlternatives(nlohmann::json const& json,
-                            std::deque<std::string> primary,
-                            std::string const& alternative) {
-  auto value = GetNestedKey(json, std::move(primary));
+                            std::initializer_list<std::string_view> primary,
+                            std::string_view alternative) {
+  auto value = GetNestedKey(json, primary);
   if (!value.empty()) return value;
   return json.value(alternative, "");
 }
 
-std::string MapGCFTypeToService(std::string const& gcf_event_type) {
-  static auto const* const kPrefixes =
-      new std::vector<std::pair<std::string, std::string>>{
-          {"providers/cloud.firestore/", "firestore.googleapis.com"},
-          {"providers/google.firebase.analytics/",
-           "firebaseanalytics.googleapis.com"},
-          {"providers/firebase.auth/", "firebaseauth.googleapis.com"},
-          {"providers/google.firebase.database/",
-           "firebasedatabase.googleapis.com"},
-          {"providers/cloud.pubsub/", "pubsub.googleapis.com"},
-          {"google.storage.object.", "storage.googleapis.com"},
-      };
-  for (auto const& [prefix, service] : *kPrefixes) {
-    if (gcf_event_type.rfind(prefix, 0) == 0) return service;
+using Mapping = std::pair<std::string_view, std::string_view>;
+
+auto constexpr kServicePrefixes = std::array<Mapping, 6>{{
+    {"providers/cloud.firestore/", "firestore.googleapis.com"},
+    {"providers/google.firebase.analytics/",
+     "firebaseanalytics.googleapis.com"},
+    {"providers/firebase.auth/", "firebaseauth.googleapis.com"},
+    {"providers/google.firebase.database/", "firebasedatabase.googleapis.com"},
+    {"providers/cloud.pubsub/", "pubsub.googleapis.com"},
+    {"google.storage.object.", "storage.googleapis.com"},
+}};
+
+std::string_view MapGCFTypeToService(std::string_view gcf_event_type) {
+  for (auto const& [prefix, service] : kServicePrefixes) {
+    if (gcf_event_type.substr(0, prefix.size()) == prefix) return service;
   }
-  throw std::runtime_error("Cannot match GCF event type <" + gcf_event_type +
+  throw std::runtime_error("Cannot match GCF event type <" +
+                           std::string(gcf_event_type) +
                            "> to a known prefix");
 }
 
-std::string MapGCFTypeToCloudEventType(std::string const& gcf_event_type) {
-  static auto const* const kMapping = new std::map<std::string, std::string>{
-      {"google.pubsub.topic.publish",
-       "google.cloud.pubsub.topic.v1.messagePublished"},
-      {"providers/cloud.pubsub/eventTypes/topic.publish",
-       "google.cloud.pubsub.topic.v1.messagePublished"},
-      {"google.storage.object.finalize",
-       "google.cloud.storage.object.v1.finalized"},
-      {"google.storage.object.delete",
-       "google.cloud.storage.object.v1.deleted"},
-      {"google.storage.object.archive",
-       "google.cloud.storage.object.v1.archived"},
-      {"google.storage.object.metadataUpdate",
-       "google.cloud.storage.object.v1.metadataUpdated"},
-      {"providers/cloud.firestore/eventTypes/document.write",
-       "google.cloud.firestore.document.v1.written"},
-      {"providers/cloud.firestore/eventTypes/document.create",
-       "google.cloud.firestore.document.v1.created"},
-      {"providers/cloud.firestore/eventTypes/document.update",
-       "google.cloud.firestore.document.v1.updated"},
-      {"providers/cloud.firestore/eventTypes/document.delete",
-       "google.cloud.firestore.document.v1.deleted"},
-      {"providers/firebase.auth/eventTypes/user.create",
-       "google.firebase.auth.user.v1.created"},
-      {"providers/firebase.auth/eventTypes/user.delete",
-       "google.firebase.auth.user.v1.deleted"},
-      {"providers/firebase.remoteConfig/remoteconfig.update",
-       "google.firebase.remoteconfig.remoteConfig.v1.updated"},
-      {"providers/google.firebase.analytics/eventTypes/event.log",
-       "google.firebase.analytics.log.v1.written"},
-      {"providers/google.firebase.database/eventTypes/ref.create",
-       "google.firebase.database.ref.v1.created"},
-      {"providers/google.firebase.database/eventTypes/ref.write",
-       "google.firebase.database.ref.v1.written"},
-      {"providers/google.firebase.database/eventTypes/ref.update",
-       "google.firebase.database.ref.v1.updated"},
-      {"providers/google.firebase.database/eventTypes/ref.delete",
-       "google.firebase.database.ref.v1.deleted"},
-  };
-  auto p = kMapping->find(gcf_event_type);
-  if (p != kMapping->end()) return p->second;
-  if (gcf_event_type.rfind("google.storage.object.", 0) == 0) {
+// Sorted by the GCF event type, see the `static_assert()` below.
+auto constexpr kEventTypes = std::array<Mapping, 18>{{
+    {"google.pubsub.topic.publish",
+     "google.cloud.pubsub.topic.v1.messagePublished"},
+    {"google.storage.object.archive",
+     "google.cloud.storage.object.v1.archived"},
+    {"google.storage.object.delete", "google.cloud.storage.object.v1.deleted"},
+    {"google.storage.object.finalize",
+     "google.cloud.storage.object.v1.finalized"},
+    {"google.storage.object.metadataUpdate",
+     "google.cloud.storage.object.v1.metadataUpdated"},
+    {"providers/cloud.firestore/eventTypes/document.create",
+     "google.cloud.firestore.document.v1.created"},
+    {"providers/cloud.firestore/eventTypes/document.delete",
+     "google.cloud.firestore.document.v1.deleted"},
+    {"providers/cloud.firestore/eventTypes/document.update",
+     "google.cloud.firestore.document.v1.updated"},
+    {"providers/cloud.firestore/eventTypes/document.write",
+     "google.cloud.firestore.document.v1.written"},
+    {"providers/cloud.pubsub/eventTypes/topic.publish",
+     "google.cloud.pubsub.topic.v1.messagePublished"},
+    {"providers/firebase.auth/eventTypes/user.create",
+     "google.firebase.auth.user.v1.created"},
+    {"providers/firebase.auth/eventTypes/user.delete",
+     "google.firebase.auth.user.v1.deleted"},
+    {"providers/firebase.remoteConfig/remoteconfig.update",
+     "google.firebase.remoteconfig.remoteConfig.v1.updated"},
+    {"providers/google.firebase.analytics/eventTypes/event.log",
+     "google.firebase.analytics.log.v1.written"},
+    {"providers/google.firebase.database/eventTypes/ref.create",
+     "google.firebase.database.ref.v1.created"},
+    {"providers/google.firebase.database/eventTypes/ref.delete",
+     "google.firebase.database.ref.v1.deleted"},
+    {"providers/google.firebase.database/eventTypes/ref.update",
+     "google.firebase.database.ref.v1.updated"},
+    {"providers/google.firebase.database/eventTypes/ref.write",
+     "google.firebase.database.ref.v1.written"},
+}};
+
+constexpr bool IsSorted(std::array<Mapping, kEventTypes.size()> const& m) {
+  for (std::size_t i = 1; i < m.size(); ++i) {
+    if (!(m[i - 1].first < m[i].first)) return false;
+  }
+  return true;
+}
+static_assert(IsSorted(kEventTypes), "kEventTypes must be sorted");
+
+std::string_view MapGCFTypeToCloudEventType(std::string_view gcf_event_type) {
+  auto const p = std::lower_bound(
+      kEventTypes.begin(), kEventTypes.end(), gcf_event_type,
+      [](Mapping const& m, std::string_view key) { return m.first < key; });
+  if (p != kEventTypes.end() && p->first == gcf_event_type) return p->second;
+  auto constexpr kStoragePrefix = std::string_view("google.storage.object.");
+  if (gcf_event_type.substr(0, kStoragePrefix.size()) == kStoragePrefix) {
     return gcf_event_type;
   }
   throw std::runtime_error("Unknown mapping for GCF event type <" +
-                           gcf_event_type + ">");
+                           std::string(gcf_event_type) + ">");
+}
+
+/// Removes @p prefix from @p path, returns `false` if it is not a prefix.
+bool ConsumePrefix(std::string_view& path, std::string_view prefix) {
+  if (path.substr(0, prefix.size()) != prefix) return false;
+  path.remove_prefix(prefix.size());
+  return true;
+}
+
+/// Removes a non-empty path segment and its trailing `/` from @p path.
+std::optional<std::string_view> ConsumeSegment(std::string_view& path) {
+  auto const end = path.find('/');
+  if (end == 0 || end == std::string_view::npos) return std::nullopt;
+  auto segment = path.substr(0, end);
+  path.remove_prefix(end + 1);
+  return segment;
 }
 
 struct LegacyCommonFields {
@@ -124,7 +166,7 @@ LegacyCommonFields ParseLegacyCommonFields(nlohmann::json const& json) {
   auto gcf_service = [&] {
     auto value = GetNestedKey(json, {"context", "resource", "service"});
     if (!value.empty()) return value;
-    return MapGCFTypeToService(gcf_event_type);
+    return std::string(MapGCFTypeToService(gcf_event_type));
   }();
   auto gcf_event_id = GetAlternatives(json, {"context", "eventId"}, "eventId");
   auto gcf_resource_name =
@@ -143,26 +185,32 @@ LegacyCommonFields ParseLegacyCommonFields(nlohmann::json const& json) {
 }
 
 functions::CloudEvent ParseLegacyCommon(LegacyCommonFields gcf,
-                                        nlohmann::json const& data) {
-  auto ce_type = MapGCFTypeToCloudEventType(gcf.event_type);
-  auto event = functions::CloudEvent(std::move(gcf.event_id),
-                                     std::move(gcf.source), std::move(ce_type));
+                                        std::string data) {
+  auto event = functions::CloudEvent(
+      std::move(gcf.event_id), std::move(gcf.source),
+      std::string(MapGCFTypeToCloudEventType(gcf.event_type)));
   if (!gcf.timestamp.empty()) event.set_time(gcf.timestamp);
   if (!gcf.subject.empty()) event.set_subject(std::move(gcf.subject));
   event.set_data_content_type("application/json");
-  event.set_data(data.dump());
+  event.set_data(std::move(data));
   return event;
 }
 
-functions::CloudEvent ParseLegacyStorage(nlohmann::json const& json,
+/// The raw JSON at @p pointer, copied without a parse and serialize cycle.
+std::string RawJson(std::string_view text, std::string_view pointer) {
+  return std::string(JsonFindPointer(text, pointer).value_or("null"));
+}
+
+functions::CloudEvent ParseLegacyStorage(std::string_view text,
                                          LegacyCommonFields gcf) {
-  auto const re = std::regex(
-      "//storage\\.googleapis\\.com/"
-      "projects/_/buckets/([^/]+)/objects/(.+)");
-  std::smatch m;
-  if (std::regex_match(gcf.source, m, re) && m.size() == 3) {
-    gcf.subject = "objects/" + m[2].str();
-    gcf.source = "//storage.googleapis.com/projects/_/buckets/" + m[1].str();
+  // Match `//storage.googleapis.com/projects/_/buckets/{b}/objects/{o}`.
+  auto constexpr kPrefix = "//storage.googleapis.com/projects/_/buckets/";
+  std::string_view path = gcf.source;
+  std::optional<std::string_view> bucket;
+  if (ConsumePrefix(path, kPrefix) && (bucket = ConsumeSegment(path)) &&
+      ConsumePrefix(path, "objects/") && !path.empty()) {
+    gcf.subject = "objects/" + std::string(path);
+    gcf.source = kPrefix + std::string(*bucket);
     auto const p = gcf.subject.find_last_of('#');
     if (p != std::string::npos &&
         gcf.subject.find_first_not_of("0123456789", p + 1) ==
@@ -170,8 +218,7 @@ functions::CloudEvent ParseLegacyStorage(nlohmann::json const& json,
       gcf.subject = gcf.subject.substr(0, p);
     }
   }
-  return ParseLegacyCommon(std::move(gcf),
-                           json.value("data", nlohmann::json{}));
+  return ParseLegacyCommon(std::move(gcf), RawJson(text, "/data"));
 }
 
 functions::CloudEvent ParseLegacyPubSub(nlohmann::json const& json,
@@ -181,10 +228,11 @@ functions::CloudEvent ParseLegacyPubSub(nlohmann::json const& json,
   auto& message = gcf_data["message"];
   if (!gcf.event_id.empty()) message["messageId"] = gcf.event_id;
   if (!gcf.timestamp.empty()) message["publishTime"] = gcf.timestamp;
-  return ParseLegacyCommon(std::move(gcf), gcf_data);
+  return ParseLegacyCommon(std::move(gcf), gcf_data.dump());
 }
 
 functions::CloudEvent ParseLegacyFirebaseDatabase(nlohmann::json const& json,
+                                                  std::string_view text,
                                                   LegacyCommonFields gcf) {
   auto const location = [&json] {
     if (json.count("domain") == 0) {
@@ -203,17 +251,19 @@ functions::CloudEvent ParseLegacyFirebaseDatabase(nlohmann::json const& json,
         ") firebase database event");
   }();
 
-  auto const re = std::regex(
-      "//firebasedatabase\\.googleapis\\.com/"
-      "projects/_/instances/([^/]+)/refs/(.+)");
-  std::smatch m;
-  if (std::regex_match(gcf.source, m, re) && m.size() == 3) {
-    gcf.subject = "refs/" + m[2].str();
+  // Match `//firebasedatabase.googleapis.com/projects/_/instances/{i}/refs/..`.
+  auto constexpr kPrefix =
+      "//firebasedatabase.googleapis.com/projects/_/instances/";
+  std::string_view path = gcf.source;
+  std::optional<std::string_view> instance;
+  if (ConsumePrefix(path, kPrefix) && (instance = ConsumeSegment(path)) &&
+      ConsumePrefix(path, "refs/") &&
+      !path.empty()) {
+    gcf.subject = "refs/" + std::string(path);
     gcf.source = "//firebasedatabase.googleapis.com/projects/_/locations/" +
-                 location + "/instances/" + m[1].str();
+                 location + "/instances/" + std::string(*instance);
   }
-  return ParseLegacyCommon(std::move(gcf),
-                           json.value("data", nlohmann::json{}));
+  return ParseLegacyCommon(std::move(gcf), RawJson(text, "/data"));
 }
 
 functions::CloudEvent ParseLegacyFirebaseAuth(nlohmann::json const& json,
@@ -245,41 +295,44 @@ functions::CloudEvent ParseLegacyFirebaseAuth(nlohmann::json const& json,
     metadata[new_name] = std::move(value);
     metadata.erase(old_name);
   }
-  return ParseLegacyCommon(std::move(gcf), modified);
+  return ParseLegacyCommon(std::move(gcf), modified.dump());
 }
 
-functions::CloudEvent ParseLegacyFirestore(nlohmann::json const& json,
+functions::CloudEvent ParseLegacyFirestore(std::string_view text,
                                            LegacyCommonFields gcf) {
-  auto const re =
-      std::regex("projects/([^/]+)/databases/([^/]+)/documents/(.+)");
-  std::smatch m;
-  if (std::regex_match(gcf.resource_name, m, re) && m.size() == 4) {
-    gcf.source = "//firestore.googleapis.com/projects/" + m[1].str() +
-                 "/databases/" + m[2].str();
-    gcf.subject = "documents/" + m[3].str();
+  // Match `projects/{p}/databases/{d}/documents/{document}`.
+  std::string_view path = gcf.resource_name;
+  std::optional<std::string_view> project;
+  std::optional<std::string_view> database;
+  if (ConsumePrefix(path, "projects/") && (project = ConsumeSegment(path)) &&
+      ConsumePrefix(path, "databases/") && (database = ConsumeSegment(path)) &&
+      ConsumePrefix(path, "documents/") && !path.empty()) {
+    gcf.source = "//firestore.googleapis.com/projects/" +
+                 std::string(*project) + "/databases/" + std::string(*database);
+    gcf.subject = "documents/" + std::string(path);
   }
-  return ParseLegacyCommon(std::move(gcf),
-                           json.value("data", nlohmann::json{}));
+  return ParseLegacyCommon(std::move(gcf), RawJson(text, "/data"));
 }
 
-functions::CloudEvent ParseCloudEventLegacy(nlohmann::json const& json) {
+functions::CloudEvent ParseCloudEventLegacy(nlohmann::json const& json,
+                                            std::string_view text) {
   auto gcf = ParseLegacyCommonFields(json);
   if (gcf.service == "storage.googleapis.com") {
-    return ParseLegacyStorage(json, std::move(gcf));
+    return ParseLegacyStorage(text, std::move(gcf));
   }
   if (gcf.service == "pubsub.googleapis.com") {
     return ParseLegacyPubSub(json, std::move(gcf));
   }
   if (gcf.service == "firebasedatabase.googleapis.com") {
-    return ParseLegacyFirebaseDatabase(json, std::move(gcf));
+    return ParseLegacyFirebaseDatabase(json, text, std::move(gcf));
   }
   if (gcf.service == "firebaseauth.googleapis.com") {
     return ParseLegacyFirebaseAuth(json, std::move(gcf));
   }
   if (gcf.service == "firestore.googleapis.com") {
-    return ParseLegacyFirestore(json, std::move(gcf));
+    return ParseLegacyFirestore(text, std::move(gcf));
   }
-  return ParseLegacyCommon(std::move(gcf), json);
+  return ParseLegacyCommon(std::move(gcf), RawJson(text, ""));
 }
 
 }  // namespace
@@ -287,7 +340,7 @@ functions::CloudEvent ParseCloudEventLegacy(nlohmann::json const& json) {
 /// Parse @p json_string as one of the legacy GCF event formats.
 functions::CloudEvent ParseCloudEventLegacy(std::string_view json_string) {
   auto json = nlohmann::json::parse(json_string);
-  return ParseCloudEventLegacy(json);
+  return ParseCloudEventLegacy(json, json_string);
 }
 
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
@@ -295,6 +295,41 @@ TEST(ParseCloudEventLegacy, MapStorage) {
   EXPECT_EQ(ce.spec_version(), "1.0");
 }
 
+TEST(ParseCloudEventLegacy, MapStorageUnmatchedResource) {
+  for (auto const* resource : {
+           "projects/_/buckets//objects/o",
+           "projects/_/buckets/b/objects/",
+           "projects/_/buckets/b/other/o",
+           "projects/_/buckets/b",
+       }) {
+    SCOPED_TRACE(resource);
+    auto input_event = nlohmann::json{
+        {"context",
+         {{"eventType", "google.storage.object.finalize"},
+          {"eventId", "test-event-id"},
+          {"resource", {{"name", resource}}}}},
+        {"data", {{"unused", "123456"}}},
+    };
+    auto const ce = ParseCloudEventLegacy(input_event.dump());
+    EXPECT_EQ(ce.source(), std::string("//storage.googleapis.com/") + resource);
+    EXPECT_FALSE(ce.subject().has_value());
+  }
+}
+
+TEST(ParseCloudEventLegacy, MapStorageKeepsRawData) {
+  auto constexpr kInput = R"js({
+      "context": {
+        "eventType": "google.storage.object.finalize",
+        "eventId": "test-event-id",
+        "resource": {"name": "projects/_/buckets/b/objects/o"}
+      },
+      "data": {"name": "o", "bucket": "b", "size": "1024"}
+  })js";
+  auto const ce = ParseCloudEventLegacy(kInput);
+  EXPECT_EQ(ce.data().value_or(""),
+            R"js({"name": "o", "bucket": "b", "size": "1024"})js");
+}
+
 TEST(ParseCloudEventLegacy, MapPubSub) {
   auto const input_event = nlohmann::json{
       {"context",
@@ -0,0 +1,359 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/parse_cloud_event_protobuf.h"
+#include "google/cloud/functions/internal/base64_decode.h"
+#include "google/cloud/functions/internal/parse_cloud_event_storage.h"
+#include "google/cloud/functions/internal/parse_time.h"
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using time_point = functions::CloudEvent::time_point;
+
+/**
+ * Iterates over the fields of a serialized protobuf message.
+ *
+ * The CloudEvents messages are small and stable, decoding them directly from
+ * the wire format avoids a dependency on the protobuf runtime, and copying
+ * the fields into intermediate messages.
+ */
+class WireReader {
+ public:
+  explicit WireReader(std::string_view buffer) : buffer_(buffer) {}
+
+  /// Reads the next field tag, returns `false` at the end of the message.
+  bool Next() {
+    if (buffer_.empty()) return false;
+    auto const tag = Varint();
+    field_ = tag >> 3;
+    wire_type_ = static_cast<int>(tag & 0x7);
+    if (field_ == 0) throw std::invalid_argument("invalid protobuf field 0");
+    return true;
+  }
+
+  [[nodiscard]] std::uint64_t field() const { return field_; }
+  [[nodiscard]] int wire_type() const { return wire_type_; }
+
+  std::uint64_t Varint() {
+    std::uint64_t value = 0;
+    for (int shift = 0; shift < 64 && !buffer_.empty(); shift += 7) {
+      auto const b = static_cast<unsigned char>(buffer_.front());
+      buffer_.remove_prefix(1);
+      value |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+      if ((b & 0x80) == 0) return value;
+    }
+    throw std::invalid_argument("invalid protobuf varint");
+  }
+
+  std::string_view LengthDelimited() {
+    auto const size = Varint();
+    if (size > buffer_.size()) {
+      throw std::invalid_argument("truncated protobuf field");
+    }
+    auto value = buffer_.substr(0, size);
+    buffer_.remove_prefix(size);
+    return value;
+  }
+
+  /// Reads the current field, throws if it has a different wire type.
+  std::uint64_t VarintField() {
+    Expect(kVarint);
+    return Varint();
+  }
+  std::string_view LengthDelimitedField() {
+    Expect(kLengthDelimited);
+    return LengthDelimited();
+  }
+
+  /// Skips the value of an unknown field.
+  void Skip() {
+    switch (wire_type_) {
+      case kVarint:
+        Varint();
+        return;
+      case kFixed64:
+        return Consume(8);
+      case kLengthDelimited:
+        LengthDelimited();
+        return;
+      case kFixed32:
+        return Consume(4);
+      default:
+        break;
+    }
+    throw std::invalid_argument("unsupported protobuf wire type " +
+                                std::to_string(wire_type_));
+  }
+
+ private:
+  static auto constexpr kVarint = 0;
+  static auto constexpr kFixed64 = 1;
+  static auto constexpr kLengthDelimited = 2;
+  static auto constexpr kFixed32 = 5;
+
+  void Expect(int wire_type) const {
+    if (wire_type_ == wire_type) return;
+    throw std::invalid_argument("unexpected wire type for protobuf field " +
+                                std::to_string(field_));
+  }
+
+  void Consume(std::size_t size) {
+    if (size > buffer_.size()) {
+      throw std::invalid_argument("truncated protobuf field");
+    }
+    buffer_.remove_prefix(size);
+  }
+
+  std::string_view buffer_;
+  std::uint64_t field_ = 0;
+  int wire_type_ = 0;
+};
+
+/// Decodes a `google.protobuf.Timestamp` message.
+time_point ParseTimestamp(std::string_view buffer) {
+  std::int64_t seconds = 0;
+  std::int64_t nanos = 0;
+  for (WireReader r(buffer); r.Next();) {
+    if (r.field() == 1) {
+      seconds = static_cast<std::int64_t>(r.VarintField());
+    } else if (r.field() == 2) {
+      nanos = static_cast<std::int32_t>(r.VarintField());
+    } else {
+      r.Skip();
+    }
+  }
+  auto constexpr kMaxSeconds =
+      std::chrono::floor<std::chrono::seconds>(time_point::duration::max())
+          .count() -
+      1;
+  if (seconds > kMaxSeconds || seconds < -kMaxSeconds || nanos < 0 ||
+      nanos >= 1'000'000'000) {
+    throw std::invalid_argument("protobuf timestamp out of range");
+  }
+  return time_point{} + std::chrono::duration_cast<time_point::duration>(
+                            std::chrono::seconds(seconds) +
+                            std::chrono::nanoseconds(nanos));
+}
+
+/// The value of an attribute, from a `CloudEventAttributeValue` message.
+struct AttributeValue {
+  /// Set for the `ce_string`, `ce_bytes`, `ce_uri` and `ce_uri_ref` fields.
+  std::optional<std::string_view> text;
+  /// Set for the `ce_timestamp` field.
+  std::optional<time_point> timestamp;
+  /// Set for the `ce_boolean` field.
+  std::optional<bool> boolean;
+  /// Set for the `ce_integer` field.
+  std::optional<std::int32_t> integer;
+  /// True if `text` is the `ce_bytes` field.
+  bool bytes = false;
+};
+
+AttributeValue ParseAttributeValue(std::string_view buffer) {
+  AttributeValue value;
+  for (WireReader r(buffer); r.Next();) {
+    switch (r.field()) {
+      case 1:  // ce_boolean
+        value.boolean = r.VarintField() != 0;
+        break;
+      case 2:  // ce_integer
+        value.integer = static_cast<std::int32_t>(r.VarintField());
+        break;
+      case 3:  // ce_string
+      case 4:  // ce_bytes
+      case 5:  // ce_uri
+      case 6:  // ce_uri_ref
+        value.text = r.LengthDelimitedField();
+        value.bytes = r.field() == 4;
+        break;
+      case 7:  // ce_timestamp
+        value.timestamp = ParseTimestamp(r.LengthDelimitedField());
+        break;
+      default:
+        r.Skip();
+        break;
+    }
+  }
+  return value;
+}
+
+/**
+ * Returns the canonical string encoding of an extension attribute value.
+ *
+ * These are the encodings used by the binary and JSON formats: base64 for
+ * bytes, and RFC 3339 for timestamps.
+ */
+std::optional<std::string> ExtensionValue(AttributeValue const& value) {
+  std::string result;
+  if (value.text && value.bytes) {
+    Base64Encode(*value.text, result);
+  } else if (value.text) {
+    result = std::string(*value.text);
+  } else if (value.timestamp) {
+    FormatRfc3339(*value.timestamp, result);
+  } else if (value.boolean) {
+    result = *value.boolean ? "true" : "false";
+  } else if (value.integer) {
+    result = std::to_string(*value.integer);
+  } else {
+    return std::nullopt;
+  }
+  return result;
+}
+
+/**
+ * Parse @p buffer as a `io.cloudevents.v1.CloudEvent` message.
+ *
+ * If @p storage is `true`, Cloud Storage notifications sent by Pub/Sub are
+ * converted to Cloud Storage events, from the event data.
+ */
+functions::CloudEvent ParseCloudEventProtobufMessage(std::string_view buffer,
+                                                     bool storage) {
+  std::string_view id;
+  std::string_view source;
+  std::string_view spec_version;
+  std::string_view type;
+  std::optional<AttributeValue> data_content_type;
+  std::optional<AttributeValue> data_schema;
+  std::optional<AttributeValue> subject;
+  std::optional<AttributeValue> time;
+  std::optional<std::string_view> data;
+  bool proto_data = false;
+  std::vector<std::pair<std::string_view, AttributeValue>> extensions;
+  for (WireReader r(buffer); r.Next();) {
+    switch (r.field()) {
+      case 1:
+        id = r.LengthDelimitedField();
+        break;
+      case 2:
+        source = r.LengthDelimitedField();
+        break;
+      case 3:
+        spec_version = r.LengthDelimitedField();
+        break;
+      case 4:
+        type = r.LengthDelimitedField();
+        break;
+      case 5: {
+        // Each map entry is a message with the key and value as fields 1 and
+        // 2.
+        std::string_view key;
+        std::optional<std::string_view> value;
+        for (WireReader e(r.LengthDelimitedField()); e.Next();) {
+          if (e.field() == 1) {
+            key = e.LengthDelimitedField();
+          } else if (e.field() == 2) {
+            value = e.LengthDelimitedField();
+          } else {
+            e.Skip();
+          }
+        }
+        if (!value) break;
+        if (key == "datacontenttype") {
+          data_content_type = ParseAttributeValue(*value);
+        } else if (key == "dataschema") {
+          data_schema = ParseAttributeValue(*value);
+        } else if (key == "subject") {
+          subject = ParseAttributeValue(*value);
+        } else if (key == "time") {
+          time = ParseAttributeValue(*value);
+        } else {
+          extensions.emplace_back(key, ParseAttributeValue(*value));
+        }
+        break;
+      }
+      case 6:  // binary_data
+      case 7:  // text_data
+      case 8:  // proto_data
+        data = r.LengthDelimitedField();
+        proto_data = r.field() == 8;
+        break;
+      default:
+        r.Skip();
+        break;
+    }
+  }
+  if (id.empty() || source.empty() || type.empty()) {
+    throw std::runtime_error(
+        "protobuf message missing `id`, `source`, and/or `type` fields");
+  }
+
+  auto event = functions::CloudEvent(
+      std::string(id), std::string(source), std::string(type),
+      spec_version.empty() ? functions::CloudEvent::kDefaultSpecVersion
+                           : std::string(spec_version));
+  if (data_content_type && data_content_type->text) {
+    event.set_data_content_type(std::string(*data_content_type->text));
+  }
+  if (data_schema && data_schema->text) {
+    event.set_data_schema(std::string(*data_schema->text));
+  }
+  if (subject && subject->text) event.set_subject(std::string(*subject->text));
+  if (time && time->timestamp) event.set_time(*time->timestamp);
+  if (time && time->text) event.set_time(std::string(*time->text));
+  for (auto const& [name, value] : extensions) {
+    // As in the other formats, invalid names are ignored.
+    if (!functions::CloudEvent::IsValidExtensionName(name)) continue;
+    if (auto v = ExtensionValue(value)) event.set_extension(name, *v);
+  }
+  if (data) {
+    if (storage && !proto_data && !data->empty() && data->front() == '{' &&
+        MaybeStorageNotification(event)) {
+      auto s = ParseCloudEventStorage(event, *data);
+      if (s) return *std::move(s);
+    }
+    event.set_data(std::string(*data));
+  }
+
+  return event;
+}
+
+}  // namespace
+
+functions::CloudEvent ParseCloudEventProtobuf(std::string_view buffer) {
+  return ParseCloudEventProtobufMessage(buffer, /*storage=*/true);
+}
+
+std::vector<functions::CloudEvent> ParseCloudEventProtobufBatch(
+    std::string_view buffer) {
+  std::vector<functions::CloudEvent> events;
+  ParseCloudEventProtobufBatch(buffer, [&events](functions::CloudEvent e) {
+    events.push_back(std::move(e));
+  });
+  return events;
+}
+
+void ParseCloudEventProtobufBatch(std::string_view buffer,
+                                  CloudEventSink const& sink) {
+  for (WireReader r(buffer); r.Next();) {
+    if (r.field() != 1) {
+      r.Skip();
+      continue;
+    }
+    sink(ParseCloudEventProtobufMessage(r.LengthDelimitedField(),
+                                        /*storage=*/false));
+  }
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
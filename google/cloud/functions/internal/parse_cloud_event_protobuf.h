@@ -0,0 +1,53 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PARSE_CLOUD_EVENT_PROTOBUF_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PARSE_CLOUD_EVENT_PROTOBUF_H
+
+#include "google/cloud/functions/internal/parse_cloud_event_json.h"
+#include "google/cloud/functions/cloud_event.h"
+#include "google/cloud/functions/version.h"
+#include <string_view>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Parse @p buffer as a Cloud Event in the protobuf format.
+ *
+ * The buffer is a serialized `io.cloudevents.v1.CloudEvent` message, as
+ * defined in the CloudEvents protobuf format specification. The
+ * `binary_data` and `text_data` fields become the event data. For the
+ * `proto_data` field the event data is the serialized `google.protobuf.Any`.
+ */
+functions::CloudEvent ParseCloudEventProtobuf(std::string_view buffer);
+
+/// Parse @p buffer as a `io.cloudevents.v1.CloudEventBatch` message
+std::vector<functions::CloudEvent> ParseCloudEventProtobufBatch(
+    std::string_view buffer);
+
+/**
+ * Parse @p buffer as a batch of Cloud Events, calling @p sink for each.
+ *
+ * As with `ParseCloudEventJsonBatch()`, the events before an invalid event
+ * have been passed to @p sink.
+ */
+void ParseCloudEventProtobufBatch(std::string_view buffer,
+                                  CloudEventSink const& sink);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PARSE_CLOUD_EVENT_PROTOBUF_H
@@ -0,0 +1,231 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/parse_cloud_event_protobuf.h"
+#include <cppcodec/base64_rfc4648.hpp>
+#include <gmock/gmock.h>
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+
+std::string Varint(std::uint64_t v) {
+  std::string result;
+  for (; v >= 0x80; v >>= 7) result.push_back(static_cast<char>(v | 0x80));
+  result.push_back(static_cast<char>(v));
+  return result;
+}
+
+std::string VarintField(int field, std::uint64_t v) {
+  return Varint(field << 3) + Varint(v);
+}
+
+std::string Field(int field, std::string const& value) {
+  return Varint((field << 3) | 2) + Varint(value.size()) + value;
+}
+
+std::string Attribute(std::string const& name, std::string const& value) {
+  return Field(5, Field(1, name) + Field(2, value));
+}
+
+std::string Required(std::string const& id) {
+  return Field(1, id) + Field(2, "/mycontext") + Field(3, "1.0") +
+         Field(4, "com.example.someevent");
+}
+
+TEST(ParseCloudEventProtobuf, Basic) {
+  auto const ce = ParseCloudEventProtobuf(Required("A234-1234-1234"));
+  EXPECT_EQ(ce.id(), "A234-1234-1234");
+  EXPECT_EQ(ce.source(), "/mycontext");
+  EXPECT_EQ(ce.type(), "com.example.someevent");
+  EXPECT_EQ(ce.spec_version(), "1.0");
+  EXPECT_FALSE(ce.data_content_type().has_value());
+  EXPECT_FALSE(ce.data_schema().has_value());
+  EXPECT_FALSE(ce.subject().has_value());
+  EXPECT_FALSE(ce.time().has_value());
+  EXPECT_FALSE(ce.data().has_value());
+}
+
+TEST(ParseCloudEventProtobuf, DefaultSpecVersion) {
+  auto const ce = ParseCloudEventProtobuf(
+      Field(1, "A234") + Field(2, "/mycontext") + Field(4, "some.type"));
+  EXPECT_EQ(ce.spec_version(), functions::CloudEvent::kDefaultSpecVersion);
+}
+
+TEST(ParseCloudEventProtobuf, MissingRequiredField) {
+  EXPECT_THROW(ParseCloudEventProtobuf(Field(1, "A234") + Field(4, "t")),
+               std::exception);
+  EXPECT_THROW(ParseCloudEventProtobuf(""), std::exception);
+}
+
+TEST(ParseCloudEventProtobuf, Attributes) {
+  auto const ce = ParseCloudEventProtobuf(
+      Required("A234") + Attribute("datacontenttype", Field(3, "text/plain")) +
+      Attribute("dataschema", Field(5, "https://example.com/schema")) +
+      Attribute("subject", Field(3, "some-subject")) +
+      Attribute("someextension", VarintField(1, 1)));
+  EXPECT_EQ(ce.data_content_type().value_or(""), "text/plain");
+  EXPECT_EQ(ce.data_schema().value_or(""), "https://example.com/schema");
+  EXPECT_EQ(ce.subject().value_or(""), "some-subject");
+}
+
+TEST(ParseCloudEventProtobuf, Extensions) {
+  using ::testing::Pair;
+  auto const ce = ParseCloudEventProtobuf(
+      Required("A234") + Attribute("text", Field(3, "some-text")) +
+      Attribute("flag", VarintField(1, 1)) +
+      Attribute("count", VarintField(2, static_cast<std::uint64_t>(-7))) +
+      Attribute("bytes", Field(4, std::string("\0\xff\xfe", 3))) +
+      Attribute("when", Field(7, VarintField(1, 1609459200))) +
+      Attribute("Invalid-Name", Field(3, "ignored")));
+  EXPECT_THAT(ce.extensions(),
+              ElementsAre(Pair("text", "some-text"), Pair("flag", "true"),
+                          Pair("count", "-7"), Pair("bytes", "AP/+"),
+                          Pair("when", "2021-01-01T00:00:00Z")));
+}
+
+TEST(ParseCloudEventProtobuf, Time) {
+  using std::chrono::seconds;
+  auto const expected = functions::CloudEvent::time_point{} +
+                        seconds(1609459200) + std::chrono::milliseconds(250);
+  auto const timestamp = ParseCloudEventProtobuf(
+      Required("A234") +
+      Attribute("time", Field(7, VarintField(1, 1609459200) +
+                                     VarintField(2, 250'000'000))));
+  EXPECT_EQ(timestamp.time(), expected);
+
+  auto const text = ParseCloudEventProtobuf(
+      Required("A234") +
+      Attribute("time", Field(3, "2021-01-01T00:00:00.25Z")));
+  EXPECT_EQ(text.time(), expected);
+}
+
+TEST(ParseCloudEventProtobuf, InvalidTime) {
+  EXPECT_THROW(ParseCloudEventProtobuf(
+                   Required("A234") +
+                   Attribute("time", Field(7, VarintField(2, 2'000'000'000)))),
+               std::invalid_argument);
+  EXPECT_THROW(ParseCloudEventProtobuf(
+                   Required("A234") +
+                   Attribute("time", Field(7, VarintField(1, 1ULL << 62)))),
+               std::invalid_argument);
+}
+
+TEST(ParseCloudEventProtobuf, Data) {
+  auto const binary = std::string("\0\1\2\xFF", 4);
+  auto const b = ParseCloudEventProtobuf(Required("A234") + Field(6, binary));
+  EXPECT_EQ(b.data().value_or(""), binary);
+
+  auto const t =
+      ParseCloudEventProtobuf(Required("A234") + Field(7, "some text"));
+  EXPECT_EQ(t.data().value_or(""), "some text");
+
+  auto const any = Field(1, "type.googleapis.com/google.protobuf.Empty");
+  auto const p = ParseCloudEventProtobuf(Required("A234") + Field(8, any));
+  EXPECT_EQ(p.data().value_or(""), any);
+}
+
+TEST(ParseCloudEventProtobuf, EmulateStorage) {
+  auto const data = nlohmann::json{
+      {"bucket", "some-bucket"},
+      {"kind", "storage#object"},
+      {"name", "folder/Test.cs"},
+  };
+  auto const attributes = nlohmann::json{
+      {"notificationConfig",
+       "projects/_/buckets/some-bucket/notificationConfigs/3"},
+      {"eventType", "OBJECT_FINALIZE"},
+      {"payloadFormat", "JSON_API_V1"},
+      {"bucketId", "some-bucket"},
+      {"objectId", "folder/Test.cs"},
+      {"objectGeneration", "1587627537231057"},
+  };
+  auto const payload = nlohmann::json{{
+      "message",
+      nlohmann::json{
+          {"attributes", attributes},
+          {"data", cppcodec::base64_rfc4648::encode(data.dump())},
+      },
+  }};
+  auto const message =
+      Field(1, "aaaaaa-1111-bbbb-2222-cccccccccccc") +
+      Field(2, "//pubsub.googleapis.com/projects/sample-project/topics/gcs") +
+      Field(4, "google.cloud.pubsub.topic.v1.messagePublished") +
+      Attribute("datacontenttype", Field(3, "application/json")) +
+      Field(7, payload.dump());
+
+  auto const ce = ParseCloudEventProtobuf(message);
+  EXPECT_EQ(ce.type(), "google.cloud.storage.object.v1.finalized");
+  EXPECT_EQ(ce.data_content_type().value_or(""), "application/json");
+  EXPECT_EQ(nlohmann::json::parse(ce.data().value_or("{}")), data);
+
+  // Batches are not converted, as in the JSON format.
+  auto const events = ParseCloudEventProtobufBatch(Field(1, message));
+  ASSERT_EQ(events.size(), 1);
+  EXPECT_EQ(events[0].type(), "google.cloud.pubsub.topic.v1.messagePublished");
+}
+
+TEST(ParseCloudEventProtobuf, UnknownFields) {
+  auto const ce = ParseCloudEventProtobuf(
+      VarintField(15, 42) + Required("A234") + Field(16, "ignored") +
+      Varint((17 << 3) | 5) + std::string(4, 'x') + Varint((18 << 3) | 1) +
+      std::string(8, 'x'));
+  EXPECT_EQ(ce.id(), "A234");
+}
+
+TEST(ParseCloudEventProtobuf, InvalidWireFormat) {
+  // Truncated length-delimited field.
+  EXPECT_THROW(ParseCloudEventProtobuf(Varint((1 << 3) | 2) + Varint(10)),
+               std::invalid_argument);
+  // Unterminated varint.
+  EXPECT_THROW(ParseCloudEventProtobuf("\x80"), std::invalid_argument);
+  // Groups are not supported.
+  EXPECT_THROW(ParseCloudEventProtobuf(Varint((1 << 3) | 3)),
+               std::invalid_argument);
+  // The `id` field must be length-delimited.
+  EXPECT_THROW(ParseCloudEventProtobuf(VarintField(1, 1)),
+               std::invalid_argument);
+}
+
+TEST(ParseCloudEventProtobuf, Batch) {
+  auto const batch = Field(1, Required("A-0")) + Field(1, Required("A-1")) +
+                     Field(1, Required("A-2"));
+  std::vector<std::string> ids;
+  for (auto const& ce : ParseCloudEventProtobufBatch(batch)) {
+    ids.push_back(ce.id());
+  }
+  EXPECT_THAT(ids, ElementsAre("A-0", "A-1", "A-2"));
+  EXPECT_TRUE(ParseCloudEventProtobufBatch("").empty());
+}
+
+TEST(ParseCloudEventProtobuf, BatchSink) {
+  auto const batch = Field(1, Required("A-0")) + Field(1, Required("A-1")) +
+                     Field(1, Field(1, "A-2"));
+  std::vector<std::string> ids;
+  EXPECT_THROW(ParseCloudEventProtobufBatch(
+                   batch, [&ids](auto ce) { ids.push_back(ce.id()); }),
+               std::exception);
+  EXPECT_THAT(ids, ElementsAre("A-0", "A-1"));
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
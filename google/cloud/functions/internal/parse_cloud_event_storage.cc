@@ -13,32 +13,85 @@
 // limitations under the License.
 
 #include "google/cloud/functions/internal/parse_cloud_event_storage.h"
-#include "google/cloud/functions/internal/base64_decode.h"
-#include <nlohmann/json.hpp>
+#include "google/cloud/functions/internal/json_scanner.h"
+#include <array>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
 
-functions::CloudEvent ParseCloudEventStorage(functions::CloudEvent e) {
-  if (e.type() != "google.cloud.pubsub.topic.v1.messagePublished") return e;
-  if (e.data_content_type().value_or("") != "application/json") return e;
+/// Returns the members of @p json if it is an object, otherwise nothing.
+std::vector<JsonMember> MaybeObjectMembers(std::string_view json) {
+  if (json.empty() || json.front() != '{') return {};
+  return JsonObjectMembers(json);
+}
+
+/// Returns the value of the raw JSON string @p raw, empty if not a string.
+std::string StringValue(std::string_view raw) {
+  if (raw.empty() || raw.front() != '"') return {};
+  return JsonUnescapeString(raw);
+}
+
+}  // namespace
+
+bool MaybeStorageNotification(functions::CloudEvent const& e) {
+  return e.type_view() == "google.cloud.pubsub.topic.v1.messagePublished" &&
+         e.data_content_type_view().value_or("") == "application/json";
+}
 
-  // If the event looks like a storage event, reparse it and return that event
-  // instead.
-  auto const payload = nlohmann::json::parse(e.data().value_or("{}"));
-  if (payload.count("message") == 0) return e;
-  auto const& message = payload.at("message");
-  if (message.count("attributes") == 0 || message.count("data") == 0) return e;
-  auto const& attributes = message.at("attributes");
-  char const* required_attributes[] = {
+std::optional<functions::CloudEvent> ParseCloudEventStorage(
+    functions::CloudEvent const& e, std::string_view data) {
+  if (!MaybeStorageNotification(e)) return std::nullopt;
+
+  // Locate the message attributes and data in a single pass over each level,
+  // without building a DOM.
+  auto const start = data.find_first_not_of(" \t\r\n");
+  if (start == std::string_view::npos || data[start] != '{') {
+    // Still reject invalid JSON, as a Pub/Sub event would.
+    (void)JsonFindPointer(data, "");
+    return std::nullopt;
+  }
+  std::optional<std::string_view> message;
+  for (auto const& m : JsonObjectMembers(data)) {
+    if (m.key == "message") message = m.value;
+  }
+  if (!message) return std::nullopt;
+  std::optional<std::string_view> attributes;
+  std::optional<std::string_view> message_data;
+  for (auto const& m : MaybeObjectMembers(*message)) {
+    if (m.key == "attributes") attributes = m.value;
+    if (m.key == "data") message_data = m.value;
+  }
+  if (!attributes || !message_data) return std::nullopt;
+
+  enum Attribute {
+    kNotificationConfig,
+    kEventType,
+    kPayloadFormat,
+    kBucketId,
+    kObjectId,
+    kObjectGeneration,
+    kAttributeCount,
+  };
+  std::string_view const required_attributes[] = {
       "notificationConfig", "eventType", "payloadFormat",
       "bucketId",           "objectId",  "objectGeneration",
   };
-  auto const has_all_attributes = std::all_of(
-      std::begin(required_attributes), std::end(required_attributes),
-      [&attributes](char const* a) { return attributes.count(a) != 0; });
-  if (!has_all_attributes) return e;
-  if (attributes.value("payloadFormat", "") != "JSON_API_V1") return e;
+  std::array<std::optional<std::string_view>, kAttributeCount> values;
+  for (auto const& m : MaybeObjectMembers(*attributes)) {
+    for (int i = 0; i != kAttributeCount; ++i) {
+      if (m.key == required_attributes[i]) values[i] = m.value;
+    }
+  }
+  for (auto const& v : values) {
+    if (!v) return std::nullopt;
+  }
+  if (StringValue(*values[kPayloadFormat]) != "JSON_API_V1") {
+    return std::nullopt;
+  }
   static auto const kMessageTypeMappings =
       std::unordered_map<std::string, std::string>{
           {"OBJECT_FINALIZE", "google.cloud.storage.object.v1.finalized"},
@@ -47,22 +100,29 @@ functions::CloudEvent ParseCloudEventStorage(functions::CloudEvent e) {
           {"OBJECT_DELETE", "google.cloud.storage.object.v1.deleted"},
           {"OBJECT_ARCHIVE", "google.cloud.storage.object.v1.archived"},
       };
-  auto mapped = kMessageTypeMappings.find(attributes.value("eventType", ""));
-  if (mapped == kMessageTypeMappings.end()) return e;
+  auto mapped = kMessageTypeMappings.find(StringValue(*values[kEventType]));
+  if (mapped == kMessageTypeMappings.end()) return std::nullopt;
 
   auto source = "//storage.googleapis.com/projects/_/buckets/" +
-                attributes.value("bucketId", "");
+                StringValue(*values[kBucketId]);
   auto const& event_type = mapped->second;
-  auto event = functions::CloudEvent(e.id(), std::move(source), event_type,
-                                     e.spec_version());
+  auto event = functions::CloudEvent(std::string(e.id_view()),
+                                     std::move(source), event_type,
+                                     std::string(e.spec_version_view()));
   event.set_data_content_type("application/json");
   event.set_data_schema("google.events.cloud.storage.v1.StorageObjectData");
-  event.set_subject("objects/" + attributes.value("objectId", ""));
+  event.set_subject("objects/" + StringValue(*values[kObjectId]));
   if (auto t = e.time(); t.has_value()) event.set_time(*t);
-  event.set_data(Base64Decode(message.value("data", "")));
-
+  event.set_data(JsonBase64Decode(*message_data));
   return event;
 }
 
+functions::CloudEvent ParseCloudEventStorage(functions::CloudEvent e) {
+  if (!MaybeStorageNotification(e)) return e;
+  auto storage = ParseCloudEventStorage(e, e.data_view().value_or("{}"));
+  if (!storage) return e;
+  return *std::move(storage);
+}
+
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions_internal
@@ -17,10 +17,25 @@
 
 #include "google/cloud/functions/cloud_event.h"
 #include "google/cloud/functions/version.h"
+#include <optional>
+#include <string_view>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 
+/// Returns true if @p e may be a Cloud Storage notification sent by Pub/Sub.
+bool MaybeStorageNotification(functions::CloudEvent const& e);
+
+/**
+ * Parse a Cloud Storage notification sent by Pub/Sub.
+ *
+ * @p e has the attributes of the Pub/Sub event, and @p data its data, which is
+ * not copied. Returns the Cloud Storage event, or `std::nullopt` if @p data is
+ * not a Cloud Storage notification.
+ */
+std::optional<functions::CloudEvent> ParseCloudEventStorage(
+    functions::CloudEvent const& e, std::string_view data);
+
 /// Parse @p e as a Cloud Storage event if possible, otherwise return @p e.
 functions::CloudEvent ParseCloudEventStorage(functions::CloudEvent e);
 
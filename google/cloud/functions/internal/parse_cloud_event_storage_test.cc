@@ -125,6 +125,39 @@ TEST(ParseCloudEventJson, EmulateStorageIdempotent) {
   EXPECT_EQ(ce.type(), "google.cloud.storage.object.v1.finalized");
 }
 
+TEST(ParseCloudEventJson, EmulateStorageFromData) {
+  // The Pub/Sub attributes are in the event, and the data is parsed from a
+  // separate buffer, with escapes in the strings.
+  auto constexpr kData = R"js({"message": {
+      "attributes": {
+        "notificationConfig": "projects/_/buckets/b/notificationConfigs/3",
+        "eventType": "OBJECT_FINALIZE",
+        "payloadFormat": "JSON_API_V1",
+        "bucketId": "b",
+        "objectId": "folder\/Test.cs",
+        "objectGeneration": "1"
+      },
+      "data": "eyJuYW1lIjogImZvbGRlci9UZXN0LmNzIn0\u003d"
+  }})js";
+  auto event = functions::CloudEvent(
+      /*id=*/"test-id",
+      /*source=*/"//pubsub.googleapis.com/projects/p/topics/t",
+      /*type=*/"google.cloud.pubsub.topic.v1.messagePublished");
+  event.set_data_content_type("application/json");
+  ASSERT_TRUE(MaybeStorageNotification(event));
+
+  auto const ce = ParseCloudEventStorage(event, kData);
+  ASSERT_TRUE(ce.has_value());
+  EXPECT_EQ(ce->id(), "test-id");
+  EXPECT_EQ(ce->type(), "google.cloud.storage.object.v1.finalized");
+  EXPECT_EQ(ce->source(), "//storage.googleapis.com/projects/_/buckets/b");
+  EXPECT_EQ(ce->subject().value_or(""), "objects/folder/Test.cs");
+  EXPECT_EQ(ce->data().value_or(""), R"js({"name": "folder/Test.cs"})js");
+
+  EXPECT_FALSE(ParseCloudEventStorage(event, R"js({"message": "m"})js"));
+  EXPECT_FALSE(ParseCloudEventStorage(event, R"js([])js"));
+}
+
 TEST(ParseCloudEventJson, EmulateStorageMissingMessage) {
   auto const payload = nlohmann::json{{"foo", "bar"}};
 
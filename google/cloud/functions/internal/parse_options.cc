@@ -13,17 +13,59 @@
 // limitations under the License.
 
 #include "google/cloud/functions/internal/parse_options.h"
+#include "google/cloud/functions/internal/body_checksums.h"
 #include <boost/program_options.hpp>
+#include <algorithm>
+#include <cctype>
 #include <cstdint>
 #include <iostream>
 #include <limits>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 namespace po = boost::program_options;
 
 auto constexpr kDefaultPort = 8080;
+auto constexpr kDefaultMaxSessions = 160;
+auto constexpr kDefaultRetryAfterSeconds = 1;
+auto constexpr kDefaultShutdownGracePeriodSeconds = 10;
+// The CoDel interval, long enough to absorb bursts, short enough to react
+// before a push subscription times out.
+auto constexpr kDefaultQueueDelayIntervalMilliseconds = 100;
+// Longer than the keep-alive timeout used by Google Front Ends (600s), so the
+// load balancer, and not the server, closes idle connections.
+auto constexpr kDefaultIdleTimeoutSeconds = 620;
+auto constexpr kDefaultHeaderTimeoutSeconds = 30;
+auto constexpr kDefaultBodyTimeoutSeconds = 300;
+auto constexpr kDefaultWriteTimeoutSeconds = 300;
+// These match the Boost.Beast defaults for request parsers.
+auto constexpr kDefaultMaxHeaderSize = std::int64_t{8 * 1024};
+auto constexpr kDefaultMaxBodySize = std::int64_t{1024 * 1024};
+auto constexpr kDefaultMaxDecompressedSize = std::int64_t{16 * 1024 * 1024};
+auto constexpr kDefaultStreamingThreads = 16;
+auto constexpr kEnvironmentPrefix =
+    std::string_view{"FUNCTIONS_FRAMEWORK_CPP_"};
+
+namespace {
+// Maps `FUNCTIONS_FRAMEWORK_CPP_FOO_BAR` to the `--foo-bar` option, as long as
+// that option exists. All other environment variables are ignored.
+std::string EnvironmentToOption(po::options_description const& desc,
+                                std::string const& variable) {
+  if (variable.rfind(kEnvironmentPrefix, 0) != 0) return {};
+  auto name = variable.substr(kEnvironmentPrefix.size());
+  std::transform(name.begin(), name.end(), name.begin(), [](char c) {
+    if (c == '_') return '-';
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+  });
+  if (name == "help") return {};
+  if (desc.find_nothrow(name, /*approx=*/false) == nullptr) return {};
+  return name;
+}
+}  // namespace
 
 po::variables_map ParseOptions(int argc, char const* const argv[]) {
   // Initialize the default port with the value from the "PORT" environment
@@ -53,25 +95,450 @@ po::variables_map ParseOptions(int argc, char const* const argv[]) {
        " See https://github.com/GoogleCloudPlatform/functions-framework for"
        " additional information.")
       //
-      ("port", po::value<int>()->default_value(port), "set listening port");
+      ("port", po::value<int>()->default_value(port), "set listening port")
+      //
+      ("unix-socket", po::value<std::string>()->default_value(""),
+       "listen on this Unix domain socket path instead of `--address` and"
+       " `--port`, e.g. for a local proxy in front of the function. Any"
+       " existing socket at this path is replaced")
+      //
+      ("threads", po::value<int>()->default_value(0),
+       "set the number of threads running the server, use 0 to run one"
+       " thread per available core, as limited by the CPU affinity and the"
+       " cgroup CPU quota of the process")
+      //
+      ("pin-threads",
+       po::value<bool>()->default_value(false)->implicit_value(true),
+       "pin each thread running the server to one of the cores available to"
+       " the process. Only supported on Linux")
+      //
+      ("reuse-port",
+       po::value<bool>()->default_value(false)->implicit_value(true),
+       "open one listening socket per thread using `SO_REUSEPORT`, each thread"
+       " accepts and serves its own connections. Only supported on Linux")
+      //
+      ("processes", po::value<int>()->default_value(1),
+       "set the number of worker processes. The server binds the listening"
+       " socket once, and each process accepts and serves connections on it"
+       " with its own threads. Worker processes that crash are restarted."
+       " Only supported on POSIX platforms")
+      //
+      ("listen-backlog", po::value<int>()->default_value(0),
+       "set the size of the queue for connections not yet accepted, use 0"
+       " for the system maximum (`SOMAXCONN`)")
+      //
+      ("tcp-nodelay",
+       po::value<bool>()->default_value(true)->implicit_value(true),
+       "disable Nagle's algorithm (`TCP_NODELAY`) on accepted connections, so"
+       " small writes are not delayed waiting for the client to acknowledge"
+       " the previous ones")
+      //
+      ("tcp-keepalive", po::value<int>()->default_value(0),
+       "send TCP keep-alive probes once a connection is idle for this many"
+       " seconds, to detect clients that disappeared without closing the"
+       " connection. Use 0 to disable")
+      //
+      ("tcp-keepalive-interval", po::value<int>()->default_value(0),
+       "set the time, in seconds, between TCP keep-alive probes. Use 0 for"
+       " the system default")
+      //
+      ("tcp-keepalive-count", po::value<int>()->default_value(0),
+       "set the number of unanswered TCP keep-alive probes before the"
+       " connection is closed. Use 0 for the system default")
+      //
+      ("tcp-defer-accept", po::value<int>()->default_value(0),
+       "accept connections only once the client sends data, or after this"
+       " many seconds (`TCP_DEFER_ACCEPT`). Use 0 to disable. Only supported"
+       " on Linux")
+      //
+      ("send-buffer-size", po::value<int>()->default_value(0),
+       "set the size, in bytes, of the socket send buffer (`SO_SNDBUF`) of"
+       " accepted connections. Use 0 for the system default")
+      //
+      ("receive-buffer-size", po::value<int>()->default_value(0),
+       "set the size, in bytes, of the socket receive buffer (`SO_RCVBUF`) of"
+       " accepted connections. Use 0 for the system default")
+      //
+      ("max-sessions", po::value<int>()->default_value(kDefaultMaxSessions),
+       "set the maximum number of concurrent sessions (connections), use 0"
+       " for no limit")
+      //
+      ("overload-policy", po::value<std::string>()->default_value("queue"),
+       "set the behavior once the number of sessions reaches"
+       " `--max-sessions`. With `queue` new connections wait in the listen"
+       " queue until a session completes, with `reject` new requests receive"
+       " a `503 Service Unavailable` response")
+      //
+      ("retry-after",
+       po::value<int>()->default_value(kDefaultRetryAfterSeconds),
+       "set the `Retry-After` value (in seconds) for requests rejected with"
+       " the `reject` overload policy, or due to `--queue-delay-target`,"
+       " `--max-buffered-body-memory`, or `--memory-watermark`")
+      //
+      ("queue-delay-target", po::value<int>()->default_value(0),
+       "reject CloudEvents with `429 Too Many Requests` while the time"
+       " requests wait in the server queues stays above this many"
+       " milliseconds, so push subscriptions back off. Use 0 to disable")
+      //
+      ("queue-delay-interval",
+       po::value<int>()->default_value(kDefaultQueueDelayIntervalMilliseconds),
+       "how long, in milliseconds, the queue delay must stay above"
+       " `--queue-delay-target` before CloudEvents are rejected")
+      //
+      ("memory-watermark", po::value<int>()->default_value(0),
+       "reject new requests with `503 Service Unavailable` while the memory"
+       " usage is above this percentage of the container (cgroup) memory"
+       " limit, instead of running out of memory. Use 0 to disable")
+      //
+      ("shutdown-grace-period",
+       po::value<int>()->default_value(kDefaultShutdownGracePeriodSeconds),
+       "on SIGTERM, stop accepting connections and wait this many seconds for"
+       " any requests in progress to complete, use 0 to close all connections"
+       " immediately")
+      //
+      ("idle-timeout",
+       po::value<int>()->default_value(kDefaultIdleTimeoutSeconds),
+       "close connections that do not start a new request within this many"
+       " seconds, use 0 for no timeout")
+      //
+      ("header-timeout",
+       po::value<int>()->default_value(kDefaultHeaderTimeoutSeconds),
+       "close connections that do not complete the request header within this"
+       " many seconds, use 0 for no timeout")
+      //
+      ("body-timeout",
+       po::value<int>()->default_value(kDefaultBodyTimeoutSeconds),
+       "close connections that do not complete the request body within this"
+       " many seconds, use 0 for no timeout")
+      //
+      ("write-timeout",
+       po::value<int>()->default_value(kDefaultWriteTimeoutSeconds),
+       "close connections that do not receive the complete response within"
+       " this many seconds, use 0 for no timeout")
+      //
+      ("max-connection-requests", po::value<int>()->default_value(0),
+       "close keep-alive connections after this many requests, the last"
+       " response has a `Connection: close` header. Use 0 for no limit")
+      //
+      ("max-connection-age", po::value<int>()->default_value(0),
+       "close keep-alive connections at the end of the first response after"
+       " they are this many seconds old, the response has a"
+       " `Connection: close` header. Use 0 for no limit")
+      //
+      ("connection-limit-jitter", po::value<int>()->default_value(10),
+       "lower the --max-connection-requests and --max-connection-age of each"
+       " connection by a random amount, up to this percentage, so the"
+       " connections opened together do not close together")
+      //
+      ("max-header-size",
+       po::value<std::int64_t>()->default_value(kDefaultMaxHeaderSize),
+       "set the maximum size (in bytes) of the request header, larger requests"
+       " are rejected with a `431 Request Header Fields Too Large` response")
+      //
+      ("max-body-size",
+       po::value<std::int64_t>()->default_value(kDefaultMaxBodySize),
+       "set the maximum size (in bytes) of the request body, larger requests"
+       " are rejected with a `413 Payload Too Large` response")
+      //
+      ("max-buffered-body-memory", po::value<std::int64_t>()->default_value(0),
+       "limit the memory (in bytes) used by the request bodies buffered by"
+       " all connections, requests that do not fit are rejected with a"
+       " `503 Service Unavailable` response and a `Retry-After` header."
+       " Functions reading the body incrementally are not limited. Use 0 for"
+       " no limit")
+      //
+      ("streaming-threads",
+       po::value<int>()->default_value(kDefaultStreamingThreads),
+       "set the number of threads running streaming functions, this limits"
+       " the number of concurrent requests for these functions")
+      //
+      ("async-logging",
+       po::value<bool>()->default_value(true)->implicit_value(true),
+       "write `std::cout`, `std::clog`, and `std::cerr` from a background"
+       " thread. All output is still written before each response is sent")
+      //
+      ("pipeline-depth", po::value<int>()->default_value(1),
+       "set the number of pipelined requests on a keep-alive connection that"
+       " may run concurrently, the responses are always sent in order. Use 1"
+       " to handle one request at a time")
+      //
+      ("fast-request-parser",
+       po::value<bool>()->default_value(false)->implicit_value(true),
+       "parse the HTTP/1.1 requests received in full with a SIMD-accelerated"
+       " parser, other requests are still parsed by Boost.Beast")
+      //
+      ("http2", po::value<bool>()->default_value(false)->implicit_value(true),
+       "accept HTTP/2 cleartext (h2c) connections, with prior knowledge or"
+       " upgraded from HTTP/1.1. Requires a build with HTTP/2 support")
+      //
+      ("http2-max-streams", po::value<int>()->default_value(100),
+       "set the maximum number of concurrent streams in an HTTP/2"
+       " connection")
+      //
+      ("compression",
+       po::value<bool>()->default_value(false)->implicit_value(true),
+       "compress responses with brotli, gzip, or deflate, as negotiated with"
+       " the client's `Accept-Encoding` header. Only text, JSON, XML, and"
+       " JavaScript responses are compressed")
+      //
+      ("compression-min-size", po::value<int>()->default_value(1024),
+       "set the minimum size, in bytes, for compressing a buffered response."
+       " Streaming responses are compressed regardless of their size")
+      //
+      ("request-decompression",
+       po::value<bool>()->default_value(true)->implicit_value(true),
+       "decompress request bodies with a gzip, deflate, or brotli"
+       " `Content-Encoding` before calling the function")
+      //
+      ("max-decompressed-size",
+       po::value<std::int64_t>()->default_value(kDefaultMaxDecompressedSize),
+       "set the maximum size, in bytes, for a decompressed request body."
+       " Larger bodies are rejected with a 413 status code")
+      //
+      ("request-checksums", po::value<std::string>()->default_value(""),
+       "compute these checksums of each request body, a comma separated list"
+       " of `crc32c` and `md5`, for `HttpRequest::body_checksums()`. Bodies"
+       " that do not match their `x-goog-hash` or `Content-MD5` header are"
+       " rejected with a 400 status code")
+      //
+      ("conditional-requests",
+       po::value<bool>()->default_value(false)->implicit_value(true),
+       "add an `ETag` to successful buffered `GET` and `HEAD` responses, and"
+       " answer `If-None-Match` and `If-Modified-Since` with a 304 status"
+       " code when the response did not change")
+      //
+      ("range-requests",
+       po::value<bool>()->default_value(false)->implicit_value(true),
+       "answer `Range` requests for buffered `GET` responses with a 206 status"
+       " code and the requested bytes, or a `multipart/byteranges` body for"
+       " several ranges")
+      //
+      ("metrics",
+       po::value<bool>()->default_value(false)->implicit_value(true),
+       "record the request counts, latency, and sizes, and answer `/metrics`"
+       " requests with them, in the Prometheus text format")
+      //
+      ("server-timing",
+       po::value<bool>()->default_value(false)->implicit_value(true),
+       "add a `Server-Timing` header, with the time spent decoding the request,"
+       " running the function, and encoding the response, to each response")
+      //
+      ("request-deadline", po::value<int>()->default_value(0),
+       "cancel the requests still running after this many seconds, functions"
+       " see the deadline in their cancellation token. Requests may shorten it"
+       " with an `X-Server-Timeout` header. Use 0 for no deadline")
+      //
+      ("max-event-age", po::value<int>()->default_value(0),
+       "drop the CloudEvents older than this many seconds, by their `time`"
+       " attribute, without running the function. The requests succeed, so"
+       " the senders stop retrying them. Use 0 to keep all the events")
+      //
+      ("slow-request-threshold", po::value<int>()->default_value(0),
+       "log the requests slower than this many milliseconds, with the time"
+       " spent in each phase. Use 0 to disable the slow request log")
+      //
+      ("slow-request-log-rate", po::value<int>()->default_value(10),
+       "the maximum number of slow requests logged each second")
+      //
+      ("flight-recorder", po::value<int>()->default_value(0),
+       "keep the summaries of the last N requests, and of the requests in"
+       " progress, and log them on `SIGQUIT` or when the process crashes. Use"
+       " 0 to disable")
+      //
+      ("capture-file", po::value<std::string>()->default_value(""),
+       "write a sample of the requests, with their headers and bodies, into"
+       " this file, to replay them with `ReplayTraffic()` or the"
+       " `traffic_replay` benchmark. The credentials are redacted, see"
+       " `SetTrafficCaptureRedactor()`. Streaming functions are not captured")
+      //
+      ("capture-sample-rate", po::value<int>()->default_value(100),
+       "capture 1 in N requests, chosen at random")
+      //
+      ("capture-max-size", po::value<int>()->default_value(256),
+       "stop capturing once the capture file reaches this many MiB")
+      //
+      ("release-memory-after-idle", po::value<int>()->default_value(0),
+       "return the free memory cached by the allocator to the operating"
+       " system once no request has run for this many seconds. Use 0 to"
+       " keep the memory")
+      //
+      ("max-allocator-arenas", po::value<int>()->default_value(0),
+       "limit the number of memory arenas of the allocator, fewer arenas"
+       " reduce the fragmentation but increase contention. Only the glibc"
+       " allocator supports this option. Use 0 for the allocator default")
+      //
+      ("metrics-port", po::value<int>()->default_value(0),
+       "answer `/metrics` requests on this port, instead of the listening"
+       " port, implies `--metrics`. Use 0 to serve them on the listening port")
+      //
+      ("log-startup",
+       po::value<bool>()->default_value(false)->implicit_value(true),
+       "log the duration of each startup phase, as a structured log entry,"
+       " once the server is ready")
+      //
+      ("checkpoint-ready-file",
+       po::value<std::string>()->default_value(""),
+       "pause after the warmup, before listening, so a tool like CRIU can"
+       " checkpoint the server. The server runs the before-checkpoint hooks,"
+       " writes its process id to this file, and waits for `SIGUSR1`, which"
+       " the tool sends once the server is restored. Not supported on Windows")
+      //
+      ("debug-startup",
+       po::value<bool>()->default_value(false)->implicit_value(true),
+       "answer `/debug/startup` requests with the duration of each startup"
+       " phase, in JSON format, without calling the function")
+      //
+      ("debug-server",
+       po::value<bool>()->default_value(false)->implicit_value(true),
+       "answer `/debug/server` requests with the open sessions and their"
+       " states, the streaming pool usage, and the accept loop pauses, in JSON"
+       " format. Requires `--debug-server-token`")
+      //
+      ("debug-server-token", po::value<std::string>()->default_value(""),
+       "the requests for `/debug/server` and `/debug/pprof/...` must include"
+       " an `Authorization: Bearer <token>` header with this token")
+      //
+      ("debug-pprof",
+       po::value<bool>()->default_value(false)->implicit_value(true),
+       "answer `/debug/pprof/profile?seconds=N` requests with a CPU profile,"
+       " and `/debug/pprof/heap?seconds=N` with the allocations sampled over"
+       " N seconds, in pprof format. Heap profiles require a library built"
+       " with `FUNCTIONS_FRAMEWORK_CPP_COUNT_ALLOCATIONS`. Requires"
+       " `--debug-server-token`")
+      //
+      ("static-route",
+       po::value<std::vector<std::string>>()->composing(),
+       "answer requests for a path with a fixed response, without calling the"
+       " function, e.g. `/healthz=200:ok`. The format is `PATH=STATUS[:BODY]`,"
+       " the option may be repeated. `/favicon.ico` and `/robots.txt` return"
+       " 404 unless overridden");
   po::variables_map vm;
   char const* a[] = {"missing-command"};
   // Boost.Options throws an exception if argc == 0, we want to avoid that.
   auto ac = argc == 0 ? 1 : argc;
   auto const* av = argc == 0 ? a : argv;
   po::store(po::parse_command_line(ac, av, desc), vm);
+  // Values in the command-line take precedence, `po::store()` does not
+  // override any values already present.
+  po::store(po::parse_environment(desc,
+                                  [&desc](std::string const& variable) {
+                                    return EnvironmentToOption(desc, variable);
+                                  }),
+            vm);
   po::notify(vm);
   if (vm.count("help") != 0) {
     std::cout << desc << "\n";
   }
-  auto port_value = vm["port"].as<int>();
-  if (port_value >= std::numeric_limits<std::uint16_t>::min() &&
-      port_value <= std::numeric_limits<std::uint16_t>::max()) {
-    return vm;
+  for (auto const* name : {"port", "metrics-port"}) {
+    auto port_value = vm[name].as<int>();
+    if (port_value < std::numeric_limits<std::uint16_t>::min() ||
+        port_value > std::numeric_limits<std::uint16_t>::max()) {
+      std::ostringstream os;
+      os << "The configured port (" << port_value << ") is out of range.";
+      throw std::invalid_argument(std::move(os).str());
+    }
+  }
+  (void)ParseBodyChecksumOptions(vm["request-checksums"].as<std::string>());
+  auto const policy = vm["overload-policy"].as<std::string>();
+  if (policy != "queue" && policy != "reject") {
+    throw std::invalid_argument("Unknown overload policy (" + policy +
+                                "), expected `queue` or `reject`.");
+  }
+  for (auto const* name :
+       {"threads", "listen-backlog", "tcp-keepalive", "tcp-keepalive-interval",
+        "tcp-keepalive-count", "tcp-defer-accept", "send-buffer-size",
+        "receive-buffer-size", "max-sessions", "retry-after",
+        "queue-delay-target", "memory-watermark", "shutdown-grace-period",
+        "idle-timeout", "header-timeout", "body-timeout", "write-timeout",
+        "max-connection-requests", "max-connection-age",
+        "request-deadline", "max-event-age", "slow-request-threshold",
+        "release-memory-after-idle", "max-allocator-arenas"}) {
+    if (vm[name].as<int>() >= 0) continue;
+    throw std::invalid_argument(std::string("The value for --") + name +
+                                " must not be negative.");
+  }
+  auto const max_header_size = vm["max-header-size"].as<std::int64_t>();
+  if (max_header_size <= 0 ||
+      max_header_size > std::numeric_limits<std::uint32_t>::max()) {
+    throw std::invalid_argument("The value for --max-header-size (" +
+                                std::to_string(max_header_size) +
+                                ") is out of range.");
+  }
+  if (vm["streaming-threads"].as<int>() <= 0) {
+    throw std::invalid_argument(
+        "The value for --streaming-threads must be positive.");
+  }
+  if (vm["debug-server"].as<bool>() &&
+      vm["debug-server-token"].as<std::string>().empty()) {
+    throw std::invalid_argument(
+        "--debug-server requires a non-empty --debug-server-token.");
+  }
+  if (vm["debug-pprof"].as<bool>() &&
+      vm["debug-server-token"].as<std::string>().empty()) {
+    throw std::invalid_argument(
+        "--debug-pprof requires a non-empty --debug-server-token.");
+  }
+  if (vm["queue-delay-interval"].as<int>() <= 0) {
+    throw std::invalid_argument(
+        "The value for --queue-delay-interval must be positive.");
+  }
+  auto constexpr kMaxPercent = 100;
+  if (vm["memory-watermark"].as<int>() > kMaxPercent) {
+    throw std::invalid_argument(
+        "The value for --memory-watermark must not exceed 100.");
+  }
+  auto const jitter = vm["connection-limit-jitter"].as<int>();
+  if (jitter < 0 || jitter > kMaxPercent) {
+    throw std::invalid_argument(
+        "The value for --connection-limit-jitter must be between 0 and 100.");
+  }
+  if (vm["slow-request-log-rate"].as<int>() <= 0) {
+    throw std::invalid_argument(
+        "The value for --slow-request-log-rate must be positive.");
+  }
+  auto constexpr kMaxFlightRecorder = 64 * 1024;
+  if (vm["flight-recorder"].as<int>() < 0 ||
+      vm["flight-recorder"].as<int>() > kMaxFlightRecorder) {
+    throw std::invalid_argument(
+        "The value for --flight-recorder must be in the [0, " +
+        std::to_string(kMaxFlightRecorder) + "] range.");
+  }
+  if (vm["capture-sample-rate"].as<int>() <= 0) {
+    throw std::invalid_argument(
+        "The value for --capture-sample-rate must be positive.");
+  }
+  if (vm["capture-max-size"].as<int>() <= 0) {
+    throw std::invalid_argument(
+        "The value for --capture-max-size must be positive.");
+  }
+  if (vm["processes"].as<int>() <= 0) {
+    throw std::invalid_argument("The value for --processes must be positive.");
+  }
+  if (vm["pipeline-depth"].as<int>() <= 0) {
+    throw std::invalid_argument(
+        "The value for --pipeline-depth must be positive.");
+  }
+  if (vm["http2-max-streams"].as<int>() <= 0) {
+    throw std::invalid_argument(
+        "The value for --http2-max-streams must be positive.");
+  }
+  if (vm["compression-min-size"].as<int>() < 0) {
+    throw std::invalid_argument(
+        "The value for --compression-min-size must not be negative.");
+  }
+  if (vm["max-decompressed-size"].as<std::int64_t>() < 0) {
+    throw std::invalid_argument(
+        "The value for --max-decompressed-size must not be negative.");
+  }
+  if (vm["max-buffered-body-memory"].as<std::int64_t>() < 0) {
+    throw std::invalid_argument(
+        "The value for --max-buffered-body-memory must not be negative.");
+  }
+  if (vm["max-body-size"].as<std::int64_t>() < 0) {
+    throw std::invalid_argument(
+        "The value for --max-body-size must not be negative.");
   }
-  std::ostringstream os;
-  os << "The configured port (" << port_value << ") is out of range.";
-  throw std::invalid_argument(std::move(os).str());
+  return vm;
 }
 
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
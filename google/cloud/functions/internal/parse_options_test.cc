@@ -15,11 +15,15 @@
 #include "google/cloud/functions/internal/parse_options.h"
 #include "google/cloud/functions/internal/setenv.h"
 #include <gmock/gmock.h>
+#include <string>
+#include <vector>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 namespace {
 
+using ::testing::ElementsAre;
+
 TEST(WrapRequestTest, NoCmd) {
   char const* argv[] = {"unused"};
   auto const vm = ParseOptions(0, argv);
@@ -61,6 +65,647 @@ TEST(WrapRequestTest, AcceptsRequiredOptions) {
   EXPECT_EQ(vm["signature-type"].as<std::string>(), "bar");
 }
 
+TEST(WrapRequestTest, Threads) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_EQ(vm["threads"].as<int>(), 0);
+
+  char const* argv[] = {"unused", "--threads=4"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_EQ(vm["threads"].as<int>(), 4);
+}
+
+TEST(WrapRequestTest, ReusePort) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_FALSE(vm["reuse-port"].as<bool>());
+
+  char const* argv[] = {"unused", "--reuse-port"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_TRUE(vm["reuse-port"].as<bool>());
+
+  char const* argv_false[] = {"unused", "--reuse-port=false"};
+  vm = ParseOptions(sizeof(argv_false) / sizeof(argv_false[0]), argv_false);
+  EXPECT_FALSE(vm["reuse-port"].as<bool>());
+
+  SetEnv("FUNCTIONS_FRAMEWORK_CPP_REUSE_PORT", "true");
+  vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                    argv_default);
+  EXPECT_TRUE(vm["reuse-port"].as<bool>());
+  SetEnv("FUNCTIONS_FRAMEWORK_CPP_REUSE_PORT", std::nullopt);
+}
+
+TEST(WrapRequestTest, AsyncLogging) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_TRUE(vm["async-logging"].as<bool>());
+
+  char const* argv[] = {"unused", "--async-logging=false"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_FALSE(vm["async-logging"].as<bool>());
+}
+
+TEST(WrapRequestTest, PipelineDepth) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_EQ(vm["pipeline-depth"].as<int>(), 1);
+
+  char const* argv[] = {"unused", "--pipeline-depth=8"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_EQ(vm["pipeline-depth"].as<int>(), 8);
+
+  char const* argv_invalid[] = {"unused", "--pipeline-depth=0"};
+  EXPECT_THROW(ParseOptions(sizeof(argv_invalid) / sizeof(argv_invalid[0]),
+                            argv_invalid),
+               std::exception);
+}
+
+TEST(WrapRequestTest, Processes) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_EQ(vm["processes"].as<int>(), 1);
+
+  char const* argv[] = {"unused", "--processes=4"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_EQ(vm["processes"].as<int>(), 4);
+
+  char const* argv_invalid[] = {"unused", "--processes=0"};
+  EXPECT_THROW(ParseOptions(sizeof(argv_invalid) / sizeof(argv_invalid[0]),
+                            argv_invalid),
+               std::exception);
+}
+
+TEST(WrapRequestTest, CheckpointReadyFile) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_EQ(vm["checkpoint-ready-file"].as<std::string>(), "");
+
+  char const* argv[] = {"unused", "--checkpoint-ready-file=/tmp/ready"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_EQ(vm["checkpoint-ready-file"].as<std::string>(), "/tmp/ready");
+}
+
+TEST(WrapRequestTest, PinThreads) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_FALSE(vm["pin-threads"].as<bool>());
+
+  char const* argv[] = {"unused", "--pin-threads"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_TRUE(vm["pin-threads"].as<bool>());
+}
+
+TEST(WrapRequestTest, Allocator) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_EQ(vm["release-memory-after-idle"].as<int>(), 0);
+  EXPECT_EQ(vm["max-allocator-arenas"].as<int>(), 0);
+
+  char const* argv[] = {"unused", "--release-memory-after-idle=30",
+                        "--max-allocator-arenas=2"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_EQ(vm["release-memory-after-idle"].as<int>(), 30);
+  EXPECT_EQ(vm["max-allocator-arenas"].as<int>(), 2);
+
+  for (auto const* invalid :
+       {"--release-memory-after-idle=-1", "--max-allocator-arenas=-1"}) {
+    char const* argv_invalid[] = {"unused", invalid};
+    EXPECT_THROW(ParseOptions(sizeof(argv_invalid) / sizeof(argv_invalid[0]),
+                              argv_invalid),
+                 std::exception);
+  }
+}
+
+TEST(WrapRequestTest, FastRequestParser) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_FALSE(vm["fast-request-parser"].as<bool>());
+
+  char const* argv[] = {"unused", "--fast-request-parser"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_TRUE(vm["fast-request-parser"].as<bool>());
+}
+
+TEST(WrapRequestTest, Http2) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_FALSE(vm["http2"].as<bool>());
+  EXPECT_EQ(vm["http2-max-streams"].as<int>(), 100);
+
+  char const* argv[] = {"unused", "--http2", "--http2-max-streams=8"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_TRUE(vm["http2"].as<bool>());
+  EXPECT_EQ(vm["http2-max-streams"].as<int>(), 8);
+
+  char const* argv_invalid[] = {"unused", "--http2-max-streams=0"};
+  EXPECT_THROW(ParseOptions(sizeof(argv_invalid) / sizeof(argv_invalid[0]),
+                            argv_invalid),
+               std::exception);
+}
+
+TEST(WrapRequestTest, Compression) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_FALSE(vm["compression"].as<bool>());
+  EXPECT_EQ(vm["compression-min-size"].as<int>(), 1024);
+
+  char const* argv[] = {"unused", "--compression", "--compression-min-size=0"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_TRUE(vm["compression"].as<bool>());
+  EXPECT_EQ(vm["compression-min-size"].as<int>(), 0);
+
+  char const* argv_invalid[] = {"unused", "--compression-min-size=-1"};
+  EXPECT_THROW(ParseOptions(sizeof(argv_invalid) / sizeof(argv_invalid[0]),
+                            argv_invalid),
+               std::exception);
+}
+
+TEST(WrapRequestTest, RequestDecompression) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_TRUE(vm["request-decompression"].as<bool>());
+  EXPECT_EQ(vm["max-decompressed-size"].as<std::int64_t>(), 16 * 1024 * 1024);
+
+  char const* argv[] = {"unused", "--request-decompression=false",
+                        "--max-decompressed-size=1024"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_FALSE(vm["request-decompression"].as<bool>());
+  EXPECT_EQ(vm["max-decompressed-size"].as<std::int64_t>(), 1024);
+
+  char const* argv_invalid[] = {"unused", "--max-decompressed-size=-1"};
+  EXPECT_THROW(ParseOptions(sizeof(argv_invalid) / sizeof(argv_invalid[0]),
+                            argv_invalid),
+               std::exception);
+}
+
+TEST(WrapRequestTest, ConditionalRequests) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_FALSE(vm["conditional-requests"].as<bool>());
+
+  char const* argv[] = {"unused", "--conditional-requests"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_TRUE(vm["conditional-requests"].as<bool>());
+}
+
+TEST(WrapRequestTest, RequestChecksums) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_EQ(vm["request-checksums"].as<std::string>(), "");
+
+  char const* argv[] = {"unused", "--request-checksums=crc32c,md5"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_EQ(vm["request-checksums"].as<std::string>(), "crc32c,md5");
+
+  char const* argv_invalid[] = {"unused", "--request-checksums=sha1"};
+  EXPECT_THROW(ParseOptions(sizeof(argv_invalid) / sizeof(argv_invalid[0]),
+                            argv_invalid),
+               std::invalid_argument);
+}
+
+TEST(WrapRequestTest, RangeRequests) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_FALSE(vm["range-requests"].as<bool>());
+
+  char const* argv[] = {"unused", "--range-requests"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_TRUE(vm["range-requests"].as<bool>());
+}
+
+TEST(WrapRequestTest, UnixSocket) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_EQ(vm["unix-socket"].as<std::string>(), "");
+
+  char const* argv[] = {"unused", "--unix-socket=/tmp/function.sock"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_EQ(vm["unix-socket"].as<std::string>(), "/tmp/function.sock");
+}
+
+TEST(WrapRequestTest, Metrics) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_FALSE(vm["metrics"].as<bool>());
+  EXPECT_EQ(vm["metrics-port"].as<int>(), 0);
+
+  char const* argv[] = {"unused", "--metrics", "--metrics-port=9090"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_TRUE(vm["metrics"].as<bool>());
+  EXPECT_EQ(vm["metrics-port"].as<int>(), 9090);
+
+  char const* argv_invalid[] = {"unused", "--metrics-port=65536"};
+  EXPECT_THROW(ParseOptions(sizeof(argv_invalid) / sizeof(argv_invalid[0]),
+                            argv_invalid),
+               std::invalid_argument);
+}
+
+TEST(WrapRequestTest, ServerTiming) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_FALSE(vm["server-timing"].as<bool>());
+
+  char const* argv[] = {"unused", "--server-timing"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_TRUE(vm["server-timing"].as<bool>());
+}
+
+TEST(WrapRequestTest, SlowRequests) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_EQ(vm["slow-request-threshold"].as<int>(), 0);
+  EXPECT_EQ(vm["slow-request-log-rate"].as<int>(), 10);
+
+  char const* argv[] = {"unused", "--slow-request-threshold=250",
+                        "--slow-request-log-rate=2"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_EQ(vm["slow-request-threshold"].as<int>(), 250);
+  EXPECT_EQ(vm["slow-request-log-rate"].as<int>(), 2);
+
+  for (auto const* invalid :
+       {"--slow-request-threshold=-1", "--slow-request-log-rate=0"}) {
+    char const* argv_invalid[] = {"unused", invalid};
+    EXPECT_THROW(ParseOptions(sizeof(argv_invalid) / sizeof(argv_invalid[0]),
+                              argv_invalid),
+                 std::invalid_argument)
+        << invalid;
+  }
+}
+
+TEST(WrapRequestTest, MaxEventAge) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_EQ(vm["max-event-age"].as<int>(), 0);
+
+  char const* argv[] = {"unused", "--max-event-age=3600"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_EQ(vm["max-event-age"].as<int>(), 3600);
+
+  char const* argv_invalid[] = {"unused", "--max-event-age=-1"};
+  EXPECT_THROW(ParseOptions(sizeof(argv_invalid) / sizeof(argv_invalid[0]),
+                            argv_invalid),
+               std::invalid_argument);
+}
+
+TEST(WrapRequestTest, RequestDeadline) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_EQ(vm["request-deadline"].as<int>(), 0);
+
+  char const* argv[] = {"unused", "--request-deadline=30"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_EQ(vm["request-deadline"].as<int>(), 30);
+
+  char const* argv_invalid[] = {"unused", "--request-deadline=-1"};
+  EXPECT_THROW(ParseOptions(sizeof(argv_invalid) / sizeof(argv_invalid[0]),
+                            argv_invalid),
+               std::invalid_argument);
+}
+
+TEST(WrapRequestTest, QueueDelay) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_EQ(vm["queue-delay-target"].as<int>(), 0);
+  EXPECT_EQ(vm["queue-delay-interval"].as<int>(), 100);
+
+  char const* argv[] = {"unused", "--queue-delay-target=50",
+                        "--queue-delay-interval=500"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_EQ(vm["queue-delay-target"].as<int>(), 50);
+  EXPECT_EQ(vm["queue-delay-interval"].as<int>(), 500);
+
+  for (auto const* invalid :
+       {"--queue-delay-target=-1", "--queue-delay-interval=0"}) {
+    char const* argv_invalid[] = {"unused", invalid};
+    EXPECT_THROW(ParseOptions(sizeof(argv_invalid) / sizeof(argv_invalid[0]),
+                              argv_invalid),
+                 std::invalid_argument);
+  }
+}
+
+TEST(WrapRequestTest, MaxBufferedBodyMemory) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_EQ(vm["max-buffered-body-memory"].as<std::int64_t>(), 0);
+
+  char const* argv[] = {"unused", "--max-buffered-body-memory=268435456"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_EQ(vm["max-buffered-body-memory"].as<std::int64_t>(), 268435456);
+
+  char const* argv_invalid[] = {"unused", "--max-buffered-body-memory=-1"};
+  EXPECT_THROW(ParseOptions(sizeof(argv_invalid) / sizeof(argv_invalid[0]),
+                            argv_invalid),
+               std::invalid_argument);
+}
+
+TEST(WrapRequestTest, MemoryWatermark) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_EQ(vm["memory-watermark"].as<int>(), 0);
+
+  char const* argv[] = {"unused", "--memory-watermark=90"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_EQ(vm["memory-watermark"].as<int>(), 90);
+
+  for (auto const* invalid :
+       {"--memory-watermark=-1", "--memory-watermark=101"}) {
+    char const* argv_invalid[] = {"unused", invalid};
+    EXPECT_THROW(ParseOptions(sizeof(argv_invalid) / sizeof(argv_invalid[0]),
+                              argv_invalid),
+                 std::invalid_argument);
+  }
+}
+
+TEST(WrapRequestTest, SocketOptions) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_EQ(vm["listen-backlog"].as<int>(), 0);
+  EXPECT_TRUE(vm["tcp-nodelay"].as<bool>());
+  EXPECT_EQ(vm["tcp-keepalive"].as<int>(), 0);
+  EXPECT_EQ(vm["tcp-keepalive-interval"].as<int>(), 0);
+  EXPECT_EQ(vm["tcp-keepalive-count"].as<int>(), 0);
+  EXPECT_EQ(vm["tcp-defer-accept"].as<int>(), 0);
+  EXPECT_EQ(vm["send-buffer-size"].as<int>(), 0);
+  EXPECT_EQ(vm["receive-buffer-size"].as<int>(), 0);
+
+  char const* argv[] = {"unused",
+                        "--listen-backlog=1024",
+                        "--tcp-nodelay=false",
+                        "--tcp-keepalive=60",
+                        "--tcp-keepalive-interval=10",
+                        "--tcp-keepalive-count=4",
+                        "--tcp-defer-accept=2",
+                        "--send-buffer-size=262144",
+                        "--receive-buffer-size=131072"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_EQ(vm["listen-backlog"].as<int>(), 1024);
+  EXPECT_FALSE(vm["tcp-nodelay"].as<bool>());
+  EXPECT_EQ(vm["tcp-keepalive"].as<int>(), 60);
+  EXPECT_EQ(vm["tcp-keepalive-interval"].as<int>(), 10);
+  EXPECT_EQ(vm["tcp-keepalive-count"].as<int>(), 4);
+  EXPECT_EQ(vm["tcp-defer-accept"].as<int>(), 2);
+  EXPECT_EQ(vm["send-buffer-size"].as<int>(), 262144);
+  EXPECT_EQ(vm["receive-buffer-size"].as<int>(), 131072);
+
+  for (auto const* invalid :
+       {"--listen-backlog=-1", "--tcp-keepalive=-1",
+        "--tcp-keepalive-interval=-1", "--tcp-keepalive-count=-1",
+        "--tcp-defer-accept=-1", "--send-buffer-size=-1",
+        "--receive-buffer-size=-1"}) {
+    char const* argv_invalid[] = {"unused", invalid};
+    EXPECT_THROW(ParseOptions(sizeof(argv_invalid) / sizeof(argv_invalid[0]),
+                              argv_invalid),
+                 std::invalid_argument);
+  }
+}
+
+TEST(WrapRequestTest, StartupReport) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_FALSE(vm["log-startup"].as<bool>());
+  EXPECT_FALSE(vm["debug-startup"].as<bool>());
+
+  char const* argv[] = {"unused", "--log-startup", "--debug-startup"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_TRUE(vm["log-startup"].as<bool>());
+  EXPECT_TRUE(vm["debug-startup"].as<bool>());
+}
+
+TEST(WrapRequestTest, DebugServer) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_FALSE(vm["debug-server"].as<bool>());
+  EXPECT_EQ(vm["debug-server-token"].as<std::string>(), "");
+
+  char const* argv[] = {"unused", "--debug-server",
+                        "--debug-server-token=secret"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_TRUE(vm["debug-server"].as<bool>());
+  EXPECT_EQ(vm["debug-server-token"].as<std::string>(), "secret");
+
+  char const* argv_invalid[] = {"unused", "--debug-server"};
+  EXPECT_THROW(ParseOptions(sizeof(argv_invalid) / sizeof(argv_invalid[0]),
+                            argv_invalid),
+               std::invalid_argument);
+}
+
+TEST(WrapRequestTest, FlightRecorder) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_EQ(vm["flight-recorder"].as<int>(), 0);
+
+  char const* argv[] = {"unused", "--flight-recorder=256"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_EQ(vm["flight-recorder"].as<int>(), 256);
+
+  for (auto const* invalid :
+       {"--flight-recorder=-1", "--flight-recorder=1000000"}) {
+    char const* argv_invalid[] = {"unused", invalid};
+    EXPECT_THROW(ParseOptions(sizeof(argv_invalid) / sizeof(argv_invalid[0]),
+                              argv_invalid),
+                 std::invalid_argument)
+        << invalid;
+  }
+}
+
+TEST(WrapRequestTest, TrafficCapture) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_EQ(vm["capture-file"].as<std::string>(), "");
+  EXPECT_EQ(vm["capture-sample-rate"].as<int>(), 100);
+  EXPECT_EQ(vm["capture-max-size"].as<int>(), 256);
+
+  char const* argv[] = {"unused", "--capture-file=/tmp/requests.ffcap",
+                        "--capture-sample-rate=1", "--capture-max-size=16"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_EQ(vm["capture-file"].as<std::string>(), "/tmp/requests.ffcap");
+  EXPECT_EQ(vm["capture-sample-rate"].as<int>(), 1);
+  EXPECT_EQ(vm["capture-max-size"].as<int>(), 16);
+
+  for (auto const* invalid :
+       {"--capture-sample-rate=0", "--capture-max-size=0"}) {
+    char const* argv_invalid[] = {"unused", invalid};
+    EXPECT_THROW(ParseOptions(sizeof(argv_invalid) / sizeof(argv_invalid[0]),
+                              argv_invalid),
+                 std::invalid_argument)
+        << invalid;
+  }
+}
+
+TEST(WrapRequestTest, DebugPprof) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_FALSE(vm["debug-pprof"].as<bool>());
+
+  char const* argv[] = {"unused", "--debug-pprof",
+                        "--debug-server-token=secret"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_TRUE(vm["debug-pprof"].as<bool>());
+
+  char const* argv_invalid[] = {"unused", "--debug-pprof"};
+  EXPECT_THROW(ParseOptions(sizeof(argv_invalid) / sizeof(argv_invalid[0]),
+                            argv_invalid),
+               std::invalid_argument);
+}
+
+TEST(WrapRequestTest, StaticRoutes) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_EQ(vm.count("static-route"), 0);
+
+  char const* argv[] = {"unused", "--static-route=/healthz=200:ok",
+                        "--static-route", "/ready=204"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_THAT(vm["static-route"].as<std::vector<std::string>>(),
+              ElementsAre("/healthz=200:ok", "/ready=204"));
+}
+
+TEST(WrapRequestTest, SessionLimits) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_EQ(vm["max-sessions"].as<int>(), 160);
+  EXPECT_EQ(vm["overload-policy"].as<std::string>(), "queue");
+  EXPECT_EQ(vm["retry-after"].as<int>(), 1);
+
+  char const* argv[] = {"unused", "--max-sessions=10",
+                        "--overload-policy=reject", "--retry-after=5"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_EQ(vm["max-sessions"].as<int>(), 10);
+  EXPECT_EQ(vm["overload-policy"].as<std::string>(), "reject");
+  EXPECT_EQ(vm["retry-after"].as<int>(), 5);
+}
+
+TEST(WrapRequestTest, SessionLimitsInvalid) {
+  char const* argv_1[] = {"unused", "--overload-policy=invalid"};
+  char const* argv_2[] = {"unused", "--max-sessions=-1"};
+  EXPECT_THROW(ParseOptions(sizeof(argv_1) / sizeof(argv_1[0]), argv_1),
+               std::exception);
+  EXPECT_THROW(ParseOptions(sizeof(argv_2) / sizeof(argv_2[0]), argv_2),
+               std::exception);
+}
+
+TEST(WrapRequestTest, Timeouts) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_EQ(vm["shutdown-grace-period"].as<int>(), 10);
+  EXPECT_EQ(vm["idle-timeout"].as<int>(), 620);
+  EXPECT_EQ(vm["header-timeout"].as<int>(), 30);
+  EXPECT_EQ(vm["body-timeout"].as<int>(), 300);
+  EXPECT_EQ(vm["write-timeout"].as<int>(), 300);
+
+  char const* argv[] = {"unused",           "--shutdown-grace-period=1",
+                        "--idle-timeout=2", "--header-timeout=3",
+                        "--body-timeout=4", "--write-timeout=0"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_EQ(vm["shutdown-grace-period"].as<int>(), 1);
+  EXPECT_EQ(vm["idle-timeout"].as<int>(), 2);
+  EXPECT_EQ(vm["header-timeout"].as<int>(), 3);
+  EXPECT_EQ(vm["body-timeout"].as<int>(), 4);
+  EXPECT_EQ(vm["write-timeout"].as<int>(), 0);
+
+  char const* argv_invalid[] = {"unused", "--idle-timeout=-1"};
+  EXPECT_THROW(ParseOptions(sizeof(argv_invalid) / sizeof(argv_invalid[0]),
+                            argv_invalid),
+               std::exception);
+}
+
+TEST(WrapRequestTest, ConnectionLimits) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_EQ(vm["max-connection-requests"].as<int>(), 0);
+  EXPECT_EQ(vm["max-connection-age"].as<int>(), 0);
+  EXPECT_EQ(vm["connection-limit-jitter"].as<int>(), 10);
+
+  char const* argv[] = {"unused", "--max-connection-requests=1000",
+                        "--max-connection-age=300",
+                        "--connection-limit-jitter=0"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_EQ(vm["max-connection-requests"].as<int>(), 1000);
+  EXPECT_EQ(vm["max-connection-age"].as<int>(), 300);
+  EXPECT_EQ(vm["connection-limit-jitter"].as<int>(), 0);
+
+  for (auto const* invalid :
+       {"--max-connection-requests=-1", "--max-connection-age=-1",
+        "--connection-limit-jitter=-1", "--connection-limit-jitter=101"}) {
+    char const* argv_invalid[] = {"unused", invalid};
+    EXPECT_THROW(ParseOptions(sizeof(argv_invalid) / sizeof(argv_invalid[0]),
+                              argv_invalid),
+                 std::invalid_argument);
+  }
+}
+
+TEST(WrapRequestTest, RequestLimits) {
+  char const* argv_default[] = {"unused"};
+  auto vm = ParseOptions(sizeof(argv_default) / sizeof(argv_default[0]),
+                         argv_default);
+  EXPECT_EQ(vm["max-header-size"].as<std::int64_t>(), 8 * 1024);
+  EXPECT_EQ(vm["max-body-size"].as<std::int64_t>(), 1024 * 1024);
+
+  char const* argv[] = {"unused", "--max-header-size=1024",
+                        "--max-body-size=34359738368"};
+  vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_EQ(vm["max-header-size"].as<std::int64_t>(), 1024);
+  EXPECT_EQ(vm["max-body-size"].as<std::int64_t>(), 32LL * 1024 * 1024 * 1024);
+
+  char const* argv_1[] = {"unused", "--max-header-size=0"};
+  char const* argv_2[] = {"unused", "--max-header-size=8589934592"};
+  char const* argv_3[] = {"unused", "--max-body-size=-1"};
+  EXPECT_THROW(ParseOptions(sizeof(argv_1) / sizeof(argv_1[0]), argv_1),
+               std::exception);
+  EXPECT_THROW(ParseOptions(sizeof(argv_2) / sizeof(argv_2[0]), argv_2),
+               std::exception);
+  EXPECT_THROW(ParseOptions(sizeof(argv_3) / sizeof(argv_3[0]), argv_3),
+               std::exception);
+}
+
+TEST(WrapRequestTest, UseEnvForOptions) {
+  SetEnv("FUNCTIONS_FRAMEWORK_CPP_MAX_SESSIONS", "42");
+  SetEnv("FUNCTIONS_FRAMEWORK_CPP_OVERLOAD_POLICY", "reject");
+  SetEnv("FUNCTIONS_FRAMEWORK_CPP_UNKNOWN_OPTION", "ignored");
+  char const* argv[] = {"unused", "--overload-policy=queue"};
+  auto const vm = ParseOptions(sizeof(argv) / sizeof(argv[0]), argv);
+  EXPECT_EQ(vm["max-sessions"].as<int>(), 42);
+  // The command-line takes precedence.
+  EXPECT_EQ(vm["overload-policy"].as<std::string>(), "queue");
+  SetEnv("FUNCTIONS_FRAMEWORK_CPP_MAX_SESSIONS", std::nullopt);
+  SetEnv("FUNCTIONS_FRAMEWORK_CPP_OVERLOAD_POLICY", std::nullopt);
+  SetEnv("FUNCTIONS_FRAMEWORK_CPP_UNKNOWN_OPTION", std::nullopt);
+}
+
 TEST(WrapRequestTest, UseEnvForPort) {
   SetEnv("PORT", "7070");
   char const* argv[] = {"unused"};
@@ -0,0 +1,77 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PARSE_RESULT_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PARSE_RESULT_H
+
+#include "google/cloud/functions/version.h"
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// Describes why the parsers rejected their input.
+struct ParseError {
+  std::string message;
+};
+
+/**
+ * The value parsed from untrusted input, or the reason it was rejected.
+ *
+ * Invalid requests are expected, sometimes in large numbers. Returning the
+ * error avoids unwinding the stack for each of them.
+ */
+template <typename T>
+class ParseResult {
+ public:
+  // Implicit, so functions can return either the value or the error.
+  // NOLINTBEGIN(google-explicit-constructor)
+  ParseResult(T const& value) : v_(std::in_place_index<0>, value) {}
+  ParseResult(T&& value) : v_(std::in_place_index<0>, std::move(value)) {}
+  ParseResult(ParseError error)
+      : v_(std::in_place_index<1>, std::move(error)) {}
+  // NOLINTEND(google-explicit-constructor)
+
+  [[nodiscard]] bool ok() const { return v_.index() == 0; }
+  explicit operator bool() const { return ok(); }
+
+  /// The parsed value, requires `ok()`.
+  ///@{
+  T& operator*() & { return std::get<0>(v_); }
+  T const& operator*() const& { return std::get<0>(v_); }
+  T&& operator*() && { return std::get<0>(std::move(v_)); }
+  T* operator->() { return &std::get<0>(v_); }
+  T const* operator->() const { return &std::get<0>(v_); }
+  ///@}
+
+  /// The error, requires `!ok()`.
+  [[nodiscard]] ParseError const& error() const { return std::get<1>(v_); }
+
+  /// Returns the value, or throws `std::invalid_argument` with the error.
+  T value() && {
+    if (!ok()) throw std::invalid_argument(error().message);
+    return std::get<0>(std::move(v_));
+  }
+
+ private:
+  std::variant<T, ParseError> v_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PARSE_RESULT_H
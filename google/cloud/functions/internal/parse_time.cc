@@ -0,0 +1,185 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/parse_time.h"
+#include <absl/time/time.h>  // NOLINT(modernize-deprecated-headers)
+#include <cstdint>
+#include <stdexcept>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using Clock = std::chrono::system_clock;
+
+auto constexpr kMaxSeconds =
+    std::chrono::floor<std::chrono::seconds>(Clock::duration::max()).count();
+
+/// Parses @p count digits at @p pos, returns -1 if any is not a digit.
+int Digits(std::string_view s, std::size_t pos, std::size_t count) {
+  int value = 0;
+  for (auto i = pos; i != pos + count; ++i) {
+    auto const c = s[i];
+    if (c < '0' || c > '9') return -1;
+    value = value * 10 + (c - '0');
+  }
+  return value;
+}
+
+bool IsLeapYear(int y) { return y % 4 == 0 && (y % 100 != 0 || y % 400 == 0); }
+
+int DaysInMonth(int y, int m) {
+  static int constexpr kDays[] = {31, 28, 31, 30, 31, 30,
+                                  31, 31, 30, 31, 30, 31};
+  return m == 2 && IsLeapYear(y) ? 29 : kDays[m - 1];
+}
+
+/// The number of days since 1970-01-01, see
+/// http://howardhinnant.github.io/date_algorithms.html#days_from_civil
+std::int64_t DaysFromCivil(int y, int m, int d) {
+  y -= m <= 2 ? 1 : 0;
+  auto const era = (y >= 0 ? y : y - 399) / 400;
+  auto const yoe = y - era * 400;
+  auto const doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  auto const doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return std::int64_t{era} * 146097 + doe - 719468;
+}
+
+/// The inverse of `DaysFromCivil()`, see
+/// http://howardhinnant.github.io/date_algorithms.html#civil_from_days
+void CivilFromDays(std::int64_t z, int& y, int& m, int& d) {
+  z += 719468;
+  auto const era = (z >= 0 ? z : z - 146096) / 146097;
+  auto const doe = static_cast<int>(z - era * 146097);
+  auto const yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  auto const doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  auto const mp = (5 * doy + 2) / 153;
+  d = doy - (153 * mp + 2) / 5 + 1;
+  m = mp < 10 ? mp + 3 : mp - 9;
+  y = static_cast<int>(yoe + era * 400) + (m <= 2 ? 1 : 0);
+}
+
+/// Writes @p value as @p count digits, ending at @p end.
+void PutDigits(char* end, std::int64_t value, int count) {
+  for (; count != 0; --count, value /= 10) {
+    *--end = static_cast<char>('0' + value % 10);
+  }
+}
+
+}  // namespace
+
+std::optional<std::chrono::system_clock::time_point> ParseRfc3339(
+    std::string_view timestamp) {
+  // The shortest form is `YYYY-MM-DDTHH:MM:SSZ`.
+  auto constexpr kMinSize = 20;
+  auto const& s = timestamp;
+  if (s.size() < kMinSize || s[4] != '-' || s[7] != '-' ||
+      (s[10] != 'T' && s[10] != 't') || s[13] != ':' || s[16] != ':') {
+    return std::nullopt;
+  }
+  auto const year = Digits(s, 0, 4);
+  auto const month = Digits(s, 5, 2);
+  auto const day = Digits(s, 8, 2);
+  auto const hour = Digits(s, 11, 2);
+  auto const minute = Digits(s, 14, 2);
+  auto const second = Digits(s, 17, 2);
+  if (year < 0 || month < 1 || month > 12 || day < 1 ||
+      day > DaysInMonth(year, month) || hour < 0 || hour > 23 || minute < 0 ||
+      minute > 59 || second < 0 || second > 59) {
+    return std::nullopt;
+  }
+
+  // Digits beyond nanoseconds are truncated.
+  std::size_t pos = 19;
+  std::int64_t nanos = 0;
+  if (s[pos] == '.') {
+    auto const start = ++pos;
+    std::int64_t scale = 100'000'000;
+    for (; pos != s.size() && s[pos] >= '0' && s[pos] <= '9'; ++pos) {
+      nanos += (s[pos] - '0') * scale;
+      scale /= 10;
+    }
+    if (pos == start || pos == s.size()) return std::nullopt;
+  }
+
+  int offset = 0;
+  auto const zone = s.substr(pos);
+  if (zone == "Z" || zone == "z") {
+    offset = 0;
+  } else if (zone.size() == 6 && (zone[0] == '+' || zone[0] == '-') &&
+             zone[3] == ':') {
+    auto const hh = Digits(zone, 1, 2);
+    auto const mm = Digits(zone, 4, 2);
+    if (hh < 0 || hh > 23 || mm < 0 || mm > 59) return std::nullopt;
+    offset = (zone[0] == '+' ? 1 : -1) * (hh * 60 + mm) * 60;
+  } else {
+    return std::nullopt;
+  }
+
+  auto const seconds = DaysFromCivil(year, month, day) * 86400 +
+                       hour * 3600 + minute * 60 + second - offset;
+  // Let the general parser saturate timestamps out of the clock's range.
+  if (seconds >= kMaxSeconds || seconds <= -kMaxSeconds) return std::nullopt;
+  return Clock::time_point(std::chrono::duration_cast<Clock::duration>(
+             std::chrono::seconds(seconds))) +
+         std::chrono::duration_cast<Clock::duration>(
+             std::chrono::nanoseconds(nanos));
+}
+
+Clock::time_point ParseTimestamp(std::string const& timestamp) {
+  if (auto tp = ParseRfc3339(timestamp)) return *tp;
+  // Unusual timestamps, and any errors, are handled by the general parser.
+  std::string err;
+  absl::Time time;
+  if (!absl::ParseTime(absl::RFC3339_full, timestamp, &time, &err)) {
+    throw std::invalid_argument(err);
+  }
+  return absl::ToChronoTime(time);
+}
+
+void FormatRfc3339(Clock::time_point tp, std::string& out) {
+  // The clock's range is within years 0000 to 9999.
+  auto const since_epoch = tp.time_since_epoch();
+  auto const seconds = std::chrono::floor<std::chrono::seconds>(since_epoch);
+  auto const nanos =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch -
+                                                           seconds)
+          .count();
+  auto const total = seconds.count();
+  auto const day = total / 86400 - (total % 86400 < 0 ? 1 : 0);
+  auto const sod = total - day * 86400;
+  int y = 0;
+  int m = 0;
+  int d = 0;
+  CivilFromDays(day, y, m, d);
+  // YYYY-MM-DDTHH:MM:SS.nnnnnnnnnZ
+  char buffer[] = "0000-00-00T00:00:00.000000000Z";
+  PutDigits(buffer + 4, y, 4);
+  PutDigits(buffer + 7, m, 2);
+  PutDigits(buffer + 10, d, 2);
+  PutDigits(buffer + 13, sod / 3600, 2);
+  PutDigits(buffer + 16, sod / 60 % 60, 2);
+  PutDigits(buffer + 19, sod % 60, 2);
+  out.append(buffer, 19);
+  if (nanos != 0) {
+    PutDigits(buffer + 29, nanos, 9);
+    auto digits = 9;
+    while (buffer[19 + digits] == '0') --digits;
+    out.append(buffer + 19, digits + 1);
+  }
+  out.push_back('Z');
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
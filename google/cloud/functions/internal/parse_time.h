@@ -0,0 +1,57 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PARSE_TIME_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PARSE_TIME_H
+
+#include "google/cloud/functions/version.h"
+#include <chrono>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Parses the common forms of RFC 3339 timestamps, without allocating.
+ *
+ * Handles `YYYY-MM-DDTHH:MM:SS[.fraction](Z|+HH:MM|-HH:MM)`. Returns
+ * `std::nullopt` for anything else, including valid but unusual timestamps,
+ * such as leap seconds. Callers should use a general parser in that case.
+ */
+std::optional<std::chrono::system_clock::time_point> ParseRfc3339(
+    std::string_view timestamp);
+
+/**
+ * Parses any RFC 3339 timestamp.
+ *
+ * Uses `ParseRfc3339()` for the common forms, and a general parser otherwise.
+ * Throws `std::invalid_argument` if @p timestamp is not valid.
+ */
+std::chrono::system_clock::time_point ParseTimestamp(
+    std::string const& timestamp);
+
+/**
+ * Appends @p tp to @p out as an RFC 3339 timestamp in UTC.
+ *
+ * The format is `YYYY-MM-DDTHH:MM:SS[.fraction]Z`, the fraction omits
+ * trailing zeros.
+ */
+void FormatRfc3339(std::chrono::system_clock::time_point tp, std::string& out);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PARSE_TIME_H
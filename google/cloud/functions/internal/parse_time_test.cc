@@ -0,0 +1,103 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/parse_time.h"
+#include <absl/time/time.h>  // NOLINT(modernize-deprecated-headers)
+#include <gmock/gmock.h>
+#include <string>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+std::chrono::system_clock::time_point AbslParse(std::string const& s) {
+  std::string err;
+  absl::Time t;
+  EXPECT_TRUE(absl::ParseTime(absl::RFC3339_full, s, &t, &err)) << s;
+  return absl::ToChronoTime(t);
+}
+
+TEST(ParseTimeTest, MatchesGeneralParser) {
+  std::string const valid[] = {
+      "1970-01-01T00:00:00Z",
+      "2020-11-30T12:34:45Z",
+      "2020-11-30t12:34:45z",
+      "2020-11-30T12:34:45.678Z",
+      "2020-11-30T12:34:45.123456789Z",
+      "2020-11-30T12:34:45.1234567891234Z",
+      "2020-11-30T12:34:45.678-05:00",
+      "2020-11-30T12:34:45.678+05:30",
+      "2020-02-29T23:59:59+23:59",
+      "2000-02-29T00:00:00Z",
+      "1969-12-31T23:59:59.5Z",
+      "1900-03-01T00:00:00Z",
+      "2200-12-31T23:59:59.999999999Z",
+  };
+  for (auto const& s : valid) {
+    SCOPED_TRACE(s);
+    auto const tp = ParseRfc3339(s);
+    ASSERT_TRUE(tp.has_value());
+    EXPECT_EQ(*tp, AbslParse(s));
+  }
+}
+
+TEST(ParseTimeTest, Unhandled) {
+  std::string const unhandled[] = {
+      "",
+      "2020-15",
+      "2020-11-30T12:34:45",
+      "2020-11-30T12:34:45.Z",
+      "2020-11-30T12:34:45.678",
+      "2020-11-30 12:34:45Z",
+      "2020-13-30T12:34:45Z",
+      "2020-11-31T12:34:45Z",
+      "2021-02-29T12:34:45Z",
+      "2020-11-30T24:00:00Z",
+      "2020-11-30T12:60:00Z",
+      "2016-12-31T23:59:60Z",
+      "2020-11-30T12:34:45+0500",
+      "2020-11-30T12:34:45+24:00",
+      "2020-11-30T12:34:45Zjunk",
+      "+2020-11-30T12:34:45Z",
+      // These are out of range for a nanosecond clock.
+      "1600-03-01T00:00:00Z",
+      "9999-12-31T23:59:59.999999999Z",
+  };
+  for (auto const& s : unhandled) {
+    EXPECT_FALSE(ParseRfc3339(s).has_value()) << s;
+  }
+}
+
+TEST(ParseTimeTest, Format) {
+  std::string const cases[] = {
+      "1970-01-01T00:00:00Z",
+      "2020-11-30T12:34:45Z",
+      "2020-11-30T12:34:45.6Z",
+      "2020-11-30T12:34:45.678Z",
+      "2020-11-30T12:34:45.123456789Z",
+      "2020-02-29T23:59:59.000001Z",
+      "1969-12-31T23:59:59.5Z",
+      "1901-07-04T00:00:00Z",
+      "2200-12-31T23:59:59Z",
+  };
+  for (auto const& s : cases) {
+    std::string out;
+    FormatRfc3339(AbslParse(s), out);
+    EXPECT_EQ(out, s);
+  }
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
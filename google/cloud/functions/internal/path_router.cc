@@ -0,0 +1,120 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/path_router.h"
+#include "google/cloud/functions/internal/query_string.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+void PathRouter::Add(std::string_view method, std::string_view prefix,
+                     std::size_t value) {
+  if (prefix.empty() || prefix.front() != '/' ||
+      prefix.find('?') != std::string_view::npos) {
+    throw std::invalid_argument("Invalid route prefix (" + std::string(prefix) +
+                                "), it must start with `/` and have no query");
+  }
+  if (nodes_.empty()) NewNode({});
+  std::uint32_t node = 0;
+  auto rest = prefix;
+  while (!rest.empty()) {
+    auto const child = FindChild(node, rest.front());
+    if (child == kNone) {
+      auto const n = NewNode(std::string(rest));
+      nodes_[node].children.push_back(n);
+      node = n;
+      break;
+    }
+    auto const& edge = nodes_[child].edge;
+    auto const common = static_cast<std::size_t>(
+        std::mismatch(edge.begin(), edge.end(), rest.begin(), rest.end())
+            .first -
+        edge.begin());
+    if (common < edge.size()) Split(child, common);
+    node = child;
+    rest.remove_prefix(common);
+  }
+  auto& routes = nodes_[node].routes;
+  auto const duplicate =
+      std::any_of(routes.begin(), routes.end(),
+                  [&](auto const& r) { return r.first == method; });
+  if (duplicate) {
+    throw std::invalid_argument("Duplicate route for " + std::string(method) +
+                                " " + std::string(prefix));
+  }
+  routes.emplace_back(std::string(method), value);
+}
+
+std::optional<std::size_t> PathRouter::Find(std::string_view method,
+                                            std::string_view target) const {
+  if (nodes_.empty()) return std::nullopt;
+  auto const path = TargetPath(target);
+  std::optional<std::size_t> best;
+  std::uint32_t node = 0;
+  std::size_t pos = 0;
+  while (true) {
+    // Only stop at whole segments, or after a prefix ending in `/`.
+    auto const boundary = pos == path.size() || path[pos] == '/' ||
+                          (pos != 0 && path[pos - 1] == '/');
+    if (boundary) {
+      if (auto v = Match(nodes_[node], method)) best = v;
+    }
+    if (pos == path.size()) break;
+    auto const child = FindChild(node, path[pos]);
+    if (child == kNone) break;
+    auto const& edge = nodes_[child].edge;
+    if (path.compare(pos, edge.size(), edge) != 0) break;
+    pos += edge.size();
+    node = child;
+  }
+  return best;
+}
+
+std::uint32_t PathRouter::FindChild(std::uint32_t node, char c) const {
+  for (auto const child : nodes_[node].children) {
+    if (nodes_[child].edge.front() == c) return child;
+  }
+  return kNone;
+}
+
+std::optional<std::size_t> PathRouter::Match(Node const& node,
+                                             std::string_view method) {
+  std::optional<std::size_t> any;
+  for (auto const& [m, value] : node.routes) {
+    if (m == method) return value;
+    if (m.empty()) any = value;
+  }
+  return any;
+}
+
+std::uint32_t PathRouter::NewNode(std::string edge) {
+  nodes_.push_back(Node{std::move(edge), {}, {}});
+  return static_cast<std::uint32_t>(nodes_.size() - 1);
+}
+
+void PathRouter::Split(std::uint32_t node, std::size_t size) {
+  auto const tail = NewNode(nodes_[node].edge.substr(size));
+  auto& n = nodes_[node];
+  auto& t = nodes_[tail];
+  t.children = std::move(n.children);
+  t.routes = std::move(n.routes);
+  n.edge.resize(size);
+  n.children = {tail};
+  n.routes.clear();
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,84 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PATH_ROUTER_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PATH_ROUTER_H
+
+#include "google/cloud/functions/version.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Maps request paths to routes by longest prefix, using a radix tree.
+ *
+ * Prefixes match whole path segments: `/api` matches `/api` and `/api/v1`,
+ * but not `/apis`. A prefix ending in `/` matches any path below it. Each
+ * prefix may have one route per method, and one route for any method.
+ *
+ * The tree is built once, `Find()` does not allocate.
+ */
+class PathRouter {
+ public:
+  PathRouter() = default;
+
+  /**
+   * Adds the route @p value for @p prefix and @p method.
+   *
+   * An empty @p method matches any method. Throws `std::invalid_argument` if
+   * the prefix does not start with `/`, or the route is a duplicate.
+   */
+  void Add(std::string_view method, std::string_view prefix, std::size_t value);
+
+  /**
+   * Returns the best route for @p method and @p target, ignoring any query.
+   *
+   * The longest matching prefix wins, and a route for @p method wins over a
+   * route for any method.
+   */
+  [[nodiscard]] std::optional<std::size_t> Find(std::string_view method,
+                                                std::string_view target) const;
+
+ private:
+  static auto constexpr kNone = ~std::uint32_t{0};
+
+  struct Node {
+    /// The characters on the edge from the parent node.
+    std::string edge;
+    std::vector<std::uint32_t> children;
+    /// The routes ending at this node, as (method, value) pairs.
+    std::vector<std::pair<std::string, std::size_t>> routes;
+  };
+
+  [[nodiscard]] std::uint32_t FindChild(std::uint32_t node, char c) const;
+  [[nodiscard]] static std::optional<std::size_t> Match(
+      Node const& node, std::string_view method);
+  std::uint32_t NewNode(std::string edge);
+  /// Splits the edge to @p node after @p size characters.
+  void Split(std::uint32_t node, std::size_t size);
+
+  std::vector<Node> nodes_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PATH_ROUTER_H
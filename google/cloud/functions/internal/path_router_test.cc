@@ -0,0 +1,97 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/path_router.h"
+#include <gmock/gmock.h>
+#include <stdexcept>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+TEST(PathRouter, Empty) {
+  PathRouter router;
+  EXPECT_FALSE(router.Find("GET", "/").has_value());
+}
+
+TEST(PathRouter, LongestPrefix) {
+  PathRouter router;
+  router.Add("", "/", 0);
+  router.Add("", "/api", 1);
+  router.Add("", "/api/v1", 2);
+  router.Add("", "/apple", 3);
+  EXPECT_EQ(router.Find("GET", "/"), 0);
+  EXPECT_EQ(router.Find("GET", "/other"), 0);
+  EXPECT_EQ(router.Find("GET", "/api"), 1);
+  EXPECT_EQ(router.Find("GET", "/api/v2/x"), 1);
+  EXPECT_EQ(router.Find("GET", "/api/v1"), 2);
+  EXPECT_EQ(router.Find("GET", "/api/v1/x?q=1"), 2);
+  EXPECT_EQ(router.Find("GET", "/apple"), 3);
+  // Prefixes match whole segments.
+  EXPECT_EQ(router.Find("GET", "/apis"), 0);
+  EXPECT_EQ(router.Find("GET", "/api/v10"), 1);
+  EXPECT_EQ(router.Find("GET", "/app"), 0);
+}
+
+TEST(PathRouter, TrailingSlash) {
+  PathRouter router;
+  router.Add("", "/static/", 0);
+  EXPECT_EQ(router.Find("GET", "/static/a.css"), 0);
+  EXPECT_EQ(router.Find("GET", "/static/"), 0);
+  EXPECT_FALSE(router.Find("GET", "/static").has_value());
+  EXPECT_FALSE(router.Find("GET", "/").has_value());
+}
+
+TEST(PathRouter, Methods) {
+  PathRouter router;
+  router.Add("GET", "/orders", 0);
+  router.Add("POST", "/orders", 1);
+  router.Add("", "/orders", 2);
+  router.Add("DELETE", "/orders/archive", 3);
+  EXPECT_EQ(router.Find("GET", "/orders"), 0);
+  EXPECT_EQ(router.Find("POST", "/orders/123"), 1);
+  EXPECT_EQ(router.Find("PUT", "/orders"), 2);
+  EXPECT_EQ(router.Find("DELETE", "/orders/archive"), 3);
+  // Shorter prefixes are used if the method does not match.
+  EXPECT_EQ(router.Find("GET", "/orders/archive"), 0);
+}
+
+TEST(PathRouter, SplitEdges) {
+  PathRouter router;
+  router.Add("", "/abcdef", 0);
+  router.Add("", "/abc", 1);
+  router.Add("", "/abxyz", 2);
+  router.Add("", "/abcdef/g", 3);
+  EXPECT_EQ(router.Find("GET", "/abcdef"), 0);
+  EXPECT_EQ(router.Find("GET", "/abc"), 1);
+  EXPECT_EQ(router.Find("GET", "/abc/d"), 1);
+  EXPECT_EQ(router.Find("GET", "/abxyz"), 2);
+  EXPECT_EQ(router.Find("GET", "/abcdef/g/h"), 3);
+  EXPECT_FALSE(router.Find("GET", "/ab").has_value());
+  EXPECT_FALSE(router.Find("GET", "/abcde").has_value());
+}
+
+TEST(PathRouter, Invalid) {
+  PathRouter router;
+  EXPECT_THROW(router.Add("", "", 0), std::invalid_argument);
+  EXPECT_THROW(router.Add("", "api", 0), std::invalid_argument);
+  EXPECT_THROW(router.Add("", "/api?q", 0), std::invalid_argument);
+  router.Add("GET", "/api", 0);
+  EXPECT_THROW(router.Add("GET", "/api", 1), std::invalid_argument);
+  router.Add("", "/api", 1);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
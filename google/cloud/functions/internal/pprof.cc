@@ -0,0 +1,226 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/pprof.h"
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+// The field numbers in profile.proto.
+namespace field {
+auto constexpr kSampleType = 1;
+auto constexpr kSample = 2;
+auto constexpr kMapping = 3;
+auto constexpr kLocation = 4;
+auto constexpr kStringTable = 6;
+auto constexpr kDropFrames = 7;
+auto constexpr kTimeNanos = 9;
+auto constexpr kDurationNanos = 10;
+auto constexpr kPeriodType = 11;
+auto constexpr kPeriod = 12;
+}  // namespace field
+
+auto constexpr kVarint = 0;
+auto constexpr kLengthDelimited = 2;
+
+void AppendVarint(std::string& out, std::uint64_t value) {
+  auto constexpr kMore = 0x80;
+  while (value >= kMore) {
+    out.push_back(static_cast<char>(value | kMore));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+void AppendTag(std::string& out, int field, int wire_type) {
+  AppendVarint(out, static_cast<std::uint64_t>(field) << 3 | wire_type);
+}
+
+void AppendInt(std::string& out, int field, std::uint64_t value) {
+  if (value == 0) return;
+  AppendTag(out, field, kVarint);
+  AppendVarint(out, value);
+}
+
+void AppendBytes(std::string& out, int field, std::string_view bytes) {
+  AppendTag(out, field, kLengthDelimited);
+  AppendVarint(out, bytes.size());
+  out.append(bytes);
+}
+
+template <typename Range>
+void AppendPacked(std::string& out, int field, Range const& values) {
+  std::string packed;
+  for (auto v : values) AppendVarint(packed, static_cast<std::uint64_t>(v));
+  AppendBytes(out, field, packed);
+}
+
+/// The profile strings, referenced by their index. The first is empty.
+class StringTable {
+ public:
+  StringTable() { (void)Intern({}); }
+
+  std::uint64_t Intern(std::string_view s) {
+    auto l = index_.find(std::string(s));
+    if (l != index_.end()) return l->second;
+    auto const id = static_cast<std::uint64_t>(strings_.size());
+    strings_.emplace_back(s);
+    index_.emplace(strings_.back(), id);
+    return id;
+  }
+
+  [[nodiscard]] std::vector<std::string> const& strings() const {
+    return strings_;
+  }
+
+ private:
+  std::vector<std::string> strings_;
+  std::unordered_map<std::string, std::uint64_t> index_;
+};
+
+std::string ValueType(StringTable& strings,
+                      std::pair<std::string, std::string> const& type) {
+  std::string out;
+  AppendInt(out, 1, strings.Intern(type.first));
+  AppendInt(out, 2, strings.Intern(type.second));
+  return out;
+}
+
+std::uintptr_t ParseHex(std::string_view s) {
+  std::uintptr_t value = 0;
+  std::from_chars(s.data(), s.data() + s.size(), value, 16);
+  return value;
+}
+
+}  // namespace
+
+std::vector<ProfileMapping> ExecutableMappings() {
+  std::ifstream is("/proc/self/maps");
+  if (!is) return {};
+  std::ostringstream os;
+  os << is.rdbuf();
+  return ParseExecutableMappings(std::move(os).str());
+}
+
+std::vector<ProfileMapping> ParseExecutableMappings(std::string_view maps) {
+  std::vector<ProfileMapping> mappings;
+  while (!maps.empty()) {
+    auto const eol = maps.find('\n');
+    auto line = maps.substr(0, eol);
+    maps.remove_prefix(eol == std::string_view::npos ? maps.size() : eol + 1);
+    // Each line is `start-limit perms offset dev inode [path]`.
+    std::vector<std::string_view> columns;
+    while (columns.size() != 5 && !line.empty()) {
+      auto const end = std::min(line.find(' '), line.size());
+      columns.push_back(line.substr(0, end));
+      line.remove_prefix(end);
+      line.remove_prefix(std::min(line.find_first_not_of(' '), line.size()));
+    }
+    if (columns.size() != 5) continue;
+    auto const& range = columns[0];
+    auto const& perms = columns[1];
+    auto const dash = range.find('-');
+    if (dash == std::string_view::npos || perms.size() < 3 || perms[2] != 'x') {
+      continue;
+    }
+    ProfileMapping m;
+    m.start = ParseHex(range.substr(0, dash));
+    m.limit = ParseHex(range.substr(dash + 1));
+    m.offset = ParseHex(columns[2]);
+    m.filename = std::string(line);
+    mappings.push_back(std::move(m));
+  }
+  return mappings;
+}
+
+std::string EncodeProfile(Profile const& profile) {
+  StringTable strings;
+  std::string out;
+  for (auto const& t : profile.sample_types) {
+    AppendBytes(out, field::kSampleType, ValueType(strings, t));
+  }
+
+  // Merge the samples with the same stack, in a deterministic order.
+  std::map<std::vector<std::uintptr_t>, std::vector<std::int64_t>> merged;
+  for (auto const& s : profile.samples) {
+    auto& values = merged[s.stack];
+    values.resize(std::max(values.size(), s.values.size()));
+    for (std::size_t i = 0; i != s.values.size(); ++i) values[i] += s.values[i];
+  }
+  std::map<std::uintptr_t, std::uint64_t> locations;
+  for (auto const& [stack, values] : merged) {
+    std::vector<std::uint64_t> ids;
+    ids.reserve(stack.size());
+    for (auto address : stack) {
+      auto const id = static_cast<std::uint64_t>(locations.size() + 1);
+      ids.push_back(locations.emplace(address, id).first->second);
+    }
+    std::string sample;
+    AppendPacked(sample, 1, ids);
+    AppendPacked(sample, 2, values);
+    AppendBytes(out, field::kSample, sample);
+  }
+
+  for (std::size_t i = 0; i != profile.mappings.size(); ++i) {
+    auto const& m = profile.mappings[i];
+    std::string mapping;
+    AppendInt(mapping, 1, i + 1);
+    AppendInt(mapping, 2, m.start);
+    AppendInt(mapping, 3, m.limit);
+    AppendInt(mapping, 4, m.offset);
+    AppendInt(mapping, 5, strings.Intern(m.filename));
+    AppendBytes(out, field::kMapping, mapping);
+  }
+  for (auto const& [address, id] : locations) {
+    std::string location;
+    AppendInt(location, 1, id);
+    auto const m = std::find_if(
+        profile.mappings.begin(), profile.mappings.end(),
+        [a = address](auto const& m) { return m.start <= a && a < m.limit; });
+    if (m != profile.mappings.end()) {
+      AppendInt(location, 2,
+                static_cast<std::uint64_t>(
+                    std::distance(profile.mappings.begin(), m) + 1));
+    }
+    AppendInt(location, 3, address);
+    AppendBytes(out, field::kLocation, location);
+  }
+
+  if (!profile.drop_frames.empty()) {
+    AppendInt(out, field::kDropFrames, strings.Intern(profile.drop_frames));
+  }
+  auto const time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      profile.time.time_since_epoch());
+  AppendInt(out, field::kTimeNanos, static_cast<std::uint64_t>(time.count()));
+  AppendInt(out, field::kDurationNanos,
+            static_cast<std::uint64_t>(profile.duration.count()));
+  AppendBytes(out, field::kPeriodType, ValueType(strings, profile.period_type));
+  AppendInt(out, field::kPeriod, static_cast<std::uint64_t>(profile.period));
+  // The string table goes last, all the strings are interned by now.
+  for (auto const& s : strings.strings()) {
+    AppendBytes(out, field::kStringTable, s);
+  }
+  return out;
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,83 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PPROF_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PPROF_H
+
+#include "google/cloud/functions/version.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// A stack trace, with the values of the profile sample types.
+struct ProfileSample {
+  /// The instruction addresses, innermost frame first.
+  std::vector<std::uintptr_t> stack;
+  std::vector<std::int64_t> values;
+};
+
+/// A range of the address space mapped from an executable or library.
+struct ProfileMapping {
+  std::uintptr_t start = 0;
+  std::uintptr_t limit = 0;
+  std::uintptr_t offset = 0;
+  std::string filename;
+};
+
+/// A profile, in the terms of the pprof format.
+struct Profile {
+  /// The (type, unit) of each sample value, e.g. ("cpu", "nanoseconds").
+  std::vector<std::pair<std::string, std::string>> sample_types;
+  std::pair<std::string, std::string> period_type;
+  std::int64_t period = 0;
+  std::chrono::system_clock::time_point time;
+  std::chrono::nanoseconds duration{0};
+  /// A regular expression for the frames pprof should drop, may be empty.
+  std::string drop_frames;
+  std::vector<ProfileSample> samples;
+  std::vector<ProfileMapping> mappings;
+};
+
+/**
+ * Returns the executable mappings of the process.
+ *
+ * The profiles have no symbols, pprof symbolizes the addresses offline using
+ * the files named in the mappings. Returns an empty vector if the mappings
+ * are not available, as on platforms without `/proc/self/maps`.
+ */
+std::vector<ProfileMapping> ExecutableMappings();
+
+/// Parses the executable mappings in @p maps, in `/proc/self/maps` format.
+std::vector<ProfileMapping> ParseExecutableMappings(std::string_view maps);
+
+/**
+ * Encodes @p profile as a `perftools.profiles.Profile` protobuf.
+ *
+ * The result is not compressed, the pprof files and endpoints are gzipped.
+ * Samples with the same stack are merged.
+ *
+ * @see https://github.com/google/pprof/blob/main/proto/profile.proto
+ */
+std::string EncodeProfile(Profile const& profile);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PPROF_H
@@ -0,0 +1,148 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/pprof.h"
+#include <gmock/gmock.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::SizeIs;
+
+/// The fields of a protobuf message, varints and length-delimited only.
+struct Fields {
+  std::multimap<int, std::uint64_t> ints;
+  std::multimap<int, std::string> bytes;
+};
+
+std::uint64_t ReadVarint(std::string_view& data) {
+  std::uint64_t value = 0;
+  for (int shift = 0; !data.empty(); shift += 7) {
+    auto const b = static_cast<unsigned char>(data.front());
+    data.remove_prefix(1);
+    value |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+    if ((b & 0x80) == 0) break;
+  }
+  return value;
+}
+
+Fields Decode(std::string_view data) {
+  Fields fields;
+  while (!data.empty()) {
+    auto const tag = ReadVarint(data);
+    auto const field = static_cast<int>(tag >> 3);
+    if ((tag & 7) == 0) {
+      fields.ints.emplace(field, ReadVarint(data));
+      continue;
+    }
+    auto const size = ReadVarint(data);
+    fields.bytes.emplace(field, std::string(data.substr(0, size)));
+    data.remove_prefix(size);
+  }
+  return fields;
+}
+
+std::vector<std::uint64_t> DecodePacked(std::string_view data) {
+  std::vector<std::uint64_t> values;
+  while (!data.empty()) values.push_back(ReadVarint(data));
+  return values;
+}
+
+template <typename Map>
+auto Values(Map const& map, int field) {
+  std::vector<typename Map::mapped_type> values;
+  auto const [begin, end] = map.equal_range(field);
+  for (auto i = begin; i != end; ++i) values.push_back(i->second);
+  return values;
+}
+
+TEST(PprofTest, Encode) {
+  Profile profile;
+  profile.sample_types = {{"samples", "count"}, {"cpu", "nanoseconds"}};
+  profile.period_type = {"cpu", "nanoseconds"};
+  profile.period = 10000000;
+  profile.time = std::chrono::system_clock::time_point(std::chrono::seconds(2));
+  profile.duration = std::chrono::seconds(1);
+  profile.samples = {{{0x1010, 0x1020}, {1, 10}},
+                     {{0x2000}, {1, 10}},
+                     {{0x1010, 0x1020}, {2, 20}}};
+  profile.mappings = {{0x1000, 0x1100, 0, "/bin/function"}};
+
+  auto const decoded = Decode(EncodeProfile(profile));
+  auto const strings = Values(decoded.bytes, 6);
+  ASSERT_THAT(strings, SizeIs(6));
+  EXPECT_EQ(strings[0], "");
+  auto str = [&strings](std::uint64_t id) { return strings.at(id); };
+
+  auto const types = Values(decoded.bytes, 1);
+  ASSERT_THAT(types, SizeIs(2));
+  auto const cpu = Decode(types[1]);
+  EXPECT_EQ(str(Values(cpu.ints, 1).at(0)), "cpu");
+  EXPECT_EQ(str(Values(cpu.ints, 2).at(0)), "nanoseconds");
+
+  // The samples with the same stack are merged.
+  auto const samples = Values(decoded.bytes, 2);
+  ASSERT_THAT(samples, SizeIs(2));
+  auto const first = Decode(samples[0]);
+  EXPECT_THAT(DecodePacked(Values(first.bytes, 1).at(0)), ElementsAre(1, 2));
+  EXPECT_THAT(DecodePacked(Values(first.bytes, 2).at(0)), ElementsAre(3, 30));
+  auto const second = Decode(samples[1]);
+  EXPECT_THAT(DecodePacked(Values(second.bytes, 1).at(0)), ElementsAre(3));
+
+  auto const locations = Values(decoded.bytes, 4);
+  ASSERT_THAT(locations, SizeIs(3));
+  std::map<std::uint64_t, Fields> by_address;
+  for (auto const& l : locations) {
+    auto fields = Decode(l);
+    by_address.emplace(Values(fields.ints, 3).at(0), std::move(fields));
+  }
+  EXPECT_THAT(Values(by_address.at(0x1010).ints, 1), ElementsAre(1));
+  EXPECT_THAT(Values(by_address.at(0x1010).ints, 2), ElementsAre(1));
+  EXPECT_THAT(Values(by_address.at(0x2000).ints, 2), SizeIs(0));
+
+  auto const mappings = Values(decoded.bytes, 3);
+  ASSERT_THAT(mappings, SizeIs(1));
+  auto const mapping = Decode(mappings[0]);
+  EXPECT_THAT(Values(mapping.ints, 2), ElementsAre(0x1000));
+  EXPECT_THAT(Values(mapping.ints, 3), ElementsAre(0x1100));
+  EXPECT_EQ(str(Values(mapping.ints, 5).at(0)), "/bin/function");
+
+  EXPECT_THAT(Values(decoded.ints, 9), ElementsAre(2000000000));
+  EXPECT_THAT(Values(decoded.ints, 10), ElementsAre(1000000000));
+  EXPECT_THAT(Values(decoded.ints, 12), ElementsAre(10000000));
+}
+
+TEST(PprofTest, ParseExecutableMappings) {
+  auto const mappings = ParseExecutableMappings(
+      "55d0c0000000-55d0c0100000 r--p 00000000 08:01 123  /bin/function\n"
+      "55d0c0100000-55d0c0200000 r-xp 00100000 08:01 123  /bin/function\n"
+      "7f0000000000-7f0000001000 rw-p 00000000 00:00 0\n"
+      "7f0000001000-7f0000002000 r-xp 00000000 00:00 0    [vdso]\n"
+      "bad line\n");
+  ASSERT_THAT(mappings, SizeIs(2));
+  EXPECT_EQ(mappings[0].start, 0x55d0c0100000);
+  EXPECT_EQ(mappings[0].limit, 0x55d0c0200000);
+  EXPECT_EQ(mappings[0].offset, 0x100000);
+  EXPECT_EQ(mappings[0].filename, "/bin/function");
+  EXPECT_EQ(mappings[1].filename, "[vdso]");
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,424 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/profiler.h"
+#include "google/cloud/functions/internal/allocation_counter.h"
+#include "google/cloud/functions/internal/compression.h"
+#include "google/cloud/functions/internal/query_string.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#ifdef __linux__
+#include <cerrno>
+#include <csignal>
+#include <execinfo.h>
+#include <sys/time.h>
+#include <ucontext.h>
+#endif  // __linux__
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace be = ::boost::beast;
+
+auto constexpr kMaxFrames = 64;
+auto constexpr kDefaultSeconds = 30;
+auto constexpr kMaxSeconds = 300;
+auto constexpr kDefaultHz = 100;
+auto constexpr kMaxHz = 1000;
+// Each stack uses about 0.5 KiB, this caps the buffers at 8 MiB.
+auto constexpr kMaxStacks = std::size_t{16 * 1024};
+auto constexpr kAllocationInterval = std::int64_t{512 * 1024};
+
+/**
+ * The stacks recorded while a profile runs.
+ *
+ * The buffer is allocated before the profile starts, and `Record()` is
+ * async-signal-safe. Once the buffer is full the other stacks are dropped.
+ */
+class StackBuffer {
+ public:
+  explicit StackBuffer(std::size_t capacity) : slots_(capacity) {}
+
+  /**
+   * Records the stack in @p frames, with its @p values.
+   *
+   * If @p pc is not 0 it is the exact address of the innermost frame, and the
+   * stack starts there. Otherwise the first @p skip frames are dropped. The
+   * other frames are return addresses, pprof expects the call instructions.
+   */
+  void Record(void* const* frames, int count, std::uintptr_t pc, int skip,
+              std::array<std::int64_t, 2> values) {
+    auto const i = next_.fetch_add(1, std::memory_order_relaxed);
+    if (i >= slots_.size()) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    auto& slot = slots_[i];
+    auto start = std::min(skip, count);
+    std::size_t depth = 0;
+    if (pc != 0) {
+      auto const* found = std::find(frames, frames + count,
+                                    reinterpret_cast<void*>(pc));
+      if (found != frames + count) start = static_cast<int>(found - frames) + 1;
+      slot.pcs[depth++] = pc;
+    }
+    for (auto f = start; f < count && depth != slot.pcs.size(); ++f) {
+      slot.pcs[depth++] = reinterpret_cast<std::uintptr_t>(frames[f]) - 1;
+    }
+    slot.depth = depth;
+    slot.values = values;
+    slot.ready.store(true, std::memory_order_release);
+  }
+
+  /// Adds the stacks to @p profile, once no `Record()` calls run.
+  void AppendSamples(Profile& profile) const {
+    auto const n = std::min(next_.load(), slots_.size());
+    for (std::size_t i = 0; i != n; ++i) {
+      auto const& slot = slots_[i];
+      if (!slot.ready.load(std::memory_order_acquire)) continue;
+      ProfileSample sample;
+      sample.stack.assign(slot.pcs.begin(), slot.pcs.begin() + slot.depth);
+      sample.values.assign(slot.values.begin(), slot.values.end());
+      profile.samples.push_back(std::move(sample));
+    }
+  }
+
+  [[nodiscard]] std::uint64_t dropped() const { return dropped_.load(); }
+
+ private:
+  struct Slot {
+    std::atomic<bool> ready{false};
+    std::size_t depth = 0;
+    std::array<std::int64_t, 2> values{};
+    std::array<std::uintptr_t, kMaxFrames> pcs{};
+  };
+
+  std::vector<Slot> slots_;
+  std::atomic<std::size_t> next_{0};
+  std::atomic<std::uint64_t> dropped_{0};
+};
+
+/**
+ * Publishes the buffer of a running profile to the signal handler, or to the
+ * allocation hook.
+ *
+ * The users hold the buffer between `Acquire()` and `Release()`. `Detach()`
+ * waits until no user holds the buffer, so it can be read.
+ */
+class ActiveBuffer {
+ public:
+  StackBuffer* Acquire() {
+    users_.fetch_add(1);
+    return buffer_.load();
+  }
+  void Release() { users_.fetch_sub(1); }
+
+  void Attach(StackBuffer* buffer) { buffer_.store(buffer); }
+  void Detach() {
+    buffer_.store(nullptr);
+    while (users_.load() != 0) std::this_thread::yield();
+  }
+
+ private:
+  std::atomic<StackBuffer*> buffer_{nullptr};
+  std::atomic<int> users_{0};
+};
+
+// Constant initialized, the allocation hook may run before any dynamic
+// initialization, and after the destructors.
+ActiveBuffer cpu_profile;
+ActiveBuffer allocation_profile;
+std::atomic<std::int64_t> cpu_period_ns{0};
+// Only one profile of each kind runs at a time, across all the profilers.
+std::mutex cpu_profile_mu;
+std::mutex allocation_profile_mu;
+
+#ifdef __linux__
+/// Returns the address interrupted by a signal, or 0 if not known.
+std::uintptr_t InterruptedPc(void* context) {
+  auto const* uc = static_cast<ucontext_t const*>(context);
+#if defined(__x86_64__)
+  return static_cast<std::uintptr_t>(uc->uc_mcontext.gregs[REG_RIP]);
+#elif defined(__aarch64__)
+  return static_cast<std::uintptr_t>(uc->uc_mcontext.pc);
+#else
+  (void)uc;
+  return 0;
+#endif
+}
+
+void OnProfilingSignal(int /*signal*/, siginfo_t* /*info*/, void* context) {
+  auto const saved_errno = errno;
+  if (auto* buffer = cpu_profile.Acquire()) {
+    // The handler, and the signal trampoline, precede the interrupted frame.
+    auto constexpr kSignalFrames = 2;
+    std::array<void*, kMaxFrames + kSignalFrames> frames;
+    auto const n = backtrace(frames.data(), static_cast<int>(frames.size()));
+    buffer->Record(frames.data(), n, InterruptedPc(context), kSignalFrames,
+                   {1, cpu_period_ns.load(std::memory_order_relaxed)});
+  }
+  cpu_profile.Release();
+  errno = saved_errno;
+}
+
+/// Loads the unwinder, `backtrace()` allocates the first time it runs.
+void WarmUpBacktrace() {
+  static auto const kWarm = [] {
+    std::array<void*, 4> frames;
+    return backtrace(frames.data(), static_cast<int>(frames.size()));
+  }();
+  (void)kWarm;
+}
+
+// Constant initialized, the hook runs in `operator new`.
+thread_local std::int64_t allocation_countdown = kAllocationInterval;
+thread_local bool in_allocation_hook = false;
+
+void SampleAllocation(std::size_t size) {
+  allocation_countdown -= static_cast<std::int64_t>(size);
+  if (allocation_countdown > 0 || in_allocation_hook) return;
+  allocation_countdown = kAllocationInterval;
+  in_allocation_hook = true;
+  if (auto* buffer = allocation_profile.Acquire()) {
+    // Each sample stands for `kAllocationInterval` bytes of allocations of
+    // this size, or for a single larger allocation.
+    auto const bytes = std::max(static_cast<std::int64_t>(size),
+                                kAllocationInterval);
+    auto const objects =
+        std::max<std::int64_t>(1, bytes / std::max<std::size_t>(size, 1));
+    std::array<void*, kMaxFrames + 1> frames;
+    auto const n = backtrace(frames.data(), static_cast<int>(frames.size()));
+    buffer->Record(frames.data(), n, 0, 1, {objects, bytes});
+  }
+  allocation_profile.Release();
+  in_allocation_hook = false;
+}
+#endif  // __linux__
+
+/// Returns the value of an integer query parameter, or `std::nullopt`.
+std::optional<int> IntParameter(std::string_view target, std::string_view name,
+                                int default_value, int max_value) {
+  for (auto const& [n, v] : ParseQueryParameters(target)) {
+    if (n != name) continue;
+    auto value = 0;
+    auto const* end = v.data() + v.size();
+    auto const r = std::from_chars(v.data(), end, value);
+    if (v.empty() || r.ec != std::errc{} || r.ptr != end || value <= 0 ||
+        value > max_value) {
+      return std::nullopt;
+    }
+    return value;
+  }
+  return default_value;
+}
+
+BeastResponse TextResponse(be::http::status status, std::string body) {
+  BeastResponse response;
+  response.result(status);
+  response.set(be::http::field::content_type, "text/plain");
+  response.body() = std::move(body);
+  return response;
+}
+
+BeastResponse ProfileResponse(Profile const& profile) {
+  BeastResponse response;
+  response.set(be::http::field::content_type, "application/octet-stream");
+  response.set(be::http::field::content_disposition,
+               R"(attachment; filename="profile.pb.gz")");
+  response.set(be::http::field::cache_control, "no-store");
+  response.body() =
+      MakeCompressor(ContentEncoding::kGzip)->Compress(EncodeProfile(profile),
+                                                       /*finish=*/true);
+  return response;
+}
+
+}  // namespace
+
+bool CpuProfilingSupported() {
+#ifdef __linux__
+  return true;
+#else
+  return false;
+#endif  // __linux__
+}
+
+Profile CollectCpuProfile(int hz, std::function<void()> const& wait) {
+  Profile profile;
+  profile.sample_types = {{"samples", "count"}, {"cpu", "nanoseconds"}};
+  profile.period_type = {"cpu", "nanoseconds"};
+  profile.period = std::chrono::nanoseconds(std::chrono::seconds(1)).count() /
+                   std::max(hz, 1);
+  profile.time = std::chrono::system_clock::now();
+#ifdef __linux__
+  std::lock_guard<std::mutex> lk(cpu_profile_mu);
+  WarmUpBacktrace();
+  static auto const kInstalled = [] {
+    struct sigaction action {};
+    action.sa_sigaction = OnProfilingSignal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    return sigaction(SIGPROF, &action, nullptr) == 0;
+  }();
+  if (!kInstalled) return profile;
+
+  auto const cpus = std::max(1U, std::thread::hardware_concurrency());
+  StackBuffer buffer(std::min<std::size_t>(kMaxStacks, std::size_t{1024} *
+                                                           cpus));
+  cpu_period_ns.store(profile.period);
+  cpu_profile.Attach(&buffer);
+  auto const start = std::chrono::steady_clock::now();
+  auto const interval_us = std::max<long>(1, profile.period / 1000);
+  itimerval timer{};
+  timer.it_interval.tv_sec = interval_us / 1000000;
+  timer.it_interval.tv_usec = interval_us % 1000000;
+  timer.it_value = timer.it_interval;
+  setitimer(ITIMER_PROF, &timer, nullptr);
+  wait();
+  timer = itimerval{};
+  setitimer(ITIMER_PROF, &timer, nullptr);
+  cpu_profile.Detach();
+  profile.duration = std::chrono::steady_clock::now() - start;
+  buffer.AppendSamples(profile);
+#else
+  wait();
+#endif  // __linux__
+  profile.mappings = ExecutableMappings();
+  return profile;
+}
+
+std::optional<Profile> CollectAllocationProfile(
+    std::int64_t interval, std::function<void()> const& wait) {
+#ifdef __linux__
+  if (!AllocationCountingEnabled()) return std::nullopt;
+  Profile profile;
+  profile.sample_types = {{"alloc_objects", "count"}, {"alloc_space", "bytes"}};
+  profile.period_type = {"space", "bytes"};
+  profile.period = interval;
+  profile.drop_frames = "operator new.*";
+  profile.time = std::chrono::system_clock::now();
+
+  std::lock_guard<std::mutex> lk(allocation_profile_mu);
+  WarmUpBacktrace();
+  StackBuffer buffer(kMaxStacks);
+  allocation_profile.Attach(&buffer);
+  auto const start = std::chrono::steady_clock::now();
+  SetAllocationHook(SampleAllocation);
+  wait();
+  // The hook may still run for a while, it finds no buffer.
+  allocation_profile.Detach();
+  profile.duration = std::chrono::steady_clock::now() - start;
+  buffer.AppendSamples(profile);
+  profile.mappings = ExecutableMappings();
+  return profile;
+#else
+  (void)interval;
+  (void)wait;
+  return std::nullopt;
+#endif  // __linux__
+}
+
+Profiler::~Profiler() {
+  Stop();
+  if (thread_.joinable()) thread_.join();
+}
+
+void Profiler::CpuProfile(std::string_view target,
+                          AsyncResponseCallback done) {
+  if (!CpuProfilingSupported()) {
+    return done(TextResponse(be::http::status::not_implemented,
+                             "CPU profiles are not supported\n"));
+  }
+  auto const hz = IntParameter(target, "hz", kDefaultHz, kMaxHz);
+  if (!hz) {
+    return done(TextResponse(
+        be::http::status::bad_request,
+        "hz must be in the [1, " + std::to_string(kMaxHz) + "] range\n"));
+  }
+  Start(
+      target,
+      [hz = *hz](std::function<void()> const& wait) {
+        return ProfileResponse(CollectCpuProfile(hz, wait));
+      },
+      std::move(done));
+}
+
+void Profiler::HeapProfile(std::string_view target,
+                           AsyncResponseCallback done) {
+  if (!AllocationCountingEnabled()) {
+    return done(TextResponse(
+        be::http::status::not_implemented,
+        "Heap profiles require a library built with"
+        " -DFUNCTIONS_FRAMEWORK_CPP_COUNT_ALLOCATIONS=ON\n"));
+  }
+  Start(
+      target,
+      [](std::function<void()> const& wait) {
+        auto profile = CollectAllocationProfile(kAllocationInterval, wait);
+        if (!profile) {
+          return TextResponse(be::http::status::not_implemented,
+                              "Heap profiles are not supported\n");
+        }
+        return ProfileResponse(*profile);
+      },
+      std::move(done));
+}
+
+void Profiler::Stop() {
+  std::lock_guard<std::mutex> lk(mu_);
+  stopped_ = true;
+  cv_.notify_all();
+}
+
+void Profiler::Start(std::string_view target, Collector collect,
+                     AsyncResponseCallback done) {
+  auto const seconds =
+      IntParameter(target, "seconds", kDefaultSeconds, kMaxSeconds);
+  if (!seconds) {
+    return done(TextResponse(be::http::status::bad_request,
+                             "seconds must be in the [1, " +
+                                 std::to_string(kMaxSeconds) + "] range\n"));
+  }
+  std::unique_lock<std::mutex> lk(mu_);
+  if (running_) {
+    lk.unlock();
+    return done(TextResponse(be::http::status::conflict,
+                             "A profile is already running\n"));
+  }
+  running_ = true;
+  // The previous thread is done with the profile, it may still be returning.
+  if (thread_.joinable()) thread_.join();
+  auto wait = [this, duration = std::chrono::seconds(*seconds)] {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait_for(lk, duration, [this] { return stopped_; });
+  };
+  thread_ = std::thread([this, collect = std::move(collect),
+                         wait = std::move(wait), done = std::move(done)] {
+    auto response = collect(wait);
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      running_ = false;
+    }
+    done(std::move(response));
+  });
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
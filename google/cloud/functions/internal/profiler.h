@@ -0,0 +1,109 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PROFILER_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PROFILER_H
+
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/internal/pprof.h"
+#include "google/cloud/functions/version.h"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// Returns `true` if the platform supports `CollectCpuProfile()`.
+bool CpuProfilingSupported();
+
+/**
+ * Samples the CPU usage of the process, at @p hz samples per CPU second.
+ *
+ * Uses a `SIGPROF` interval timer, as `ITIMER_PROF` does. The `SIGPROF`
+ * handler stays installed once the first profile starts. Returns once
+ * @p wait returns, which should sleep for the profile duration.
+ */
+Profile CollectCpuProfile(int hz, std::function<void()> const& wait);
+
+/**
+ * Samples the allocations of the process, one every @p interval bytes.
+ *
+ * Returns `std::nullopt` unless the library counts the allocations, see
+ * `AllocationCountingEnabled()`.
+ */
+std::optional<Profile> CollectAllocationProfile(
+    std::int64_t interval, std::function<void()> const& wait);
+
+/**
+ * Answers the `/debug/pprof/...` routes.
+ *
+ * `/debug/pprof/profile` returns a CPU profile, and `/debug/pprof/heap` the
+ * allocations sampled while the profile runs. The `seconds` query parameter
+ * sets the duration, and `hz` the CPU sampling rate. The responses are gzipped
+ * pprof protobufs, without symbols, e.g.:
+ *
+ * @code
+ * curl -H "Authorization: Bearer ${TOKEN}" -o cpu.pb.gz \
+ *     "http://localhost:8080/debug/pprof/profile?seconds=10"
+ * pprof -http=: path/to/function cpu.pb.gz
+ * @endcode
+ *
+ * Only one profile runs at a time, the other requests get a 409. The profile
+ * runs in a thread owned by this class, the server threads do not wait.
+ */
+class Profiler {
+ public:
+  Profiler() = default;
+  ~Profiler();
+
+  Profiler(Profiler const&) = delete;
+  Profiler& operator=(Profiler const&) = delete;
+
+  /// Collects a CPU profile as requested by @p target, calls @p done once.
+  void CpuProfile(std::string_view target, AsyncResponseCallback done);
+
+  /// Collects an allocation profile as requested by @p target.
+  void HeapProfile(std::string_view target, AsyncResponseCallback done);
+
+  /**
+   * Ends the profile in progress, and any later profiles, early.
+   *
+   * The responses include the samples collected so far. The server stops the
+   * profiler when it shuts down.
+   */
+  void Stop();
+
+ private:
+  using Collector = std::function<BeastResponse(std::function<void()> wait)>;
+
+  void Start(std::string_view target, Collector collect,
+             AsyncResponseCallback done);
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  bool running_ = false;
+  bool stopped_ = false;
+  std::thread thread_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_PROFILER_H
@@ -0,0 +1,142 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/profiler.h"
+#include "google/cloud/functions/internal/allocation_counter.h"
+#include <boost/beast/http.hpp>
+#include <gmock/gmock.h>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace be = ::boost::beast;
+using ::testing::IsEmpty;
+using ::testing::Not;
+
+/// Burns CPU for @p duration, the profiles should see it.
+void BusyLoop(std::chrono::milliseconds duration) {
+  auto const end = std::chrono::steady_clock::now() + duration;
+  volatile std::uint64_t sink = 0;
+  while (std::chrono::steady_clock::now() < end) {
+    for (int i = 0; i != 1000; ++i) sink = sink + i;
+  }
+}
+
+TEST(ProfilerTest, CpuProfile) {
+  if (!CpuProfilingSupported()) GTEST_SKIP();
+  auto const profile = CollectCpuProfile(
+      1000, [] { BusyLoop(std::chrono::milliseconds(300)); });
+  EXPECT_EQ(profile.period, 1000000);
+  EXPECT_GE(profile.duration, std::chrono::milliseconds(300));
+  ASSERT_THAT(profile.samples, Not(IsEmpty()));
+  for (auto const& s : profile.samples) {
+    EXPECT_THAT(s.stack, Not(IsEmpty()));
+    EXPECT_EQ(s.values.size(), 2);
+  }
+  EXPECT_THAT(profile.mappings, Not(IsEmpty()));
+}
+
+TEST(ProfilerTest, AllocationProfile) {
+  auto const profile = CollectAllocationProfile(1024, [] {
+    for (int i = 0; i != 1000; ++i) {
+      auto p = std::make_unique<std::vector<char>>(4096);
+      EXPECT_EQ(p->size(), 4096);
+    }
+  });
+  if (!AllocationCountingEnabled()) {
+    EXPECT_FALSE(profile.has_value());
+    return;
+  }
+  ASSERT_TRUE(profile.has_value());
+  EXPECT_THAT(profile->samples, Not(IsEmpty()));
+}
+
+BeastResponse Wait(std::future<BeastResponse> f) {
+  EXPECT_EQ(f.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+  return f.get();
+}
+
+TEST(ProfilerTest, Respond) {
+  if (!CpuProfilingSupported()) GTEST_SKIP();
+  Profiler profiler;
+  std::promise<BeastResponse> first;
+  profiler.CpuProfile("/debug/pprof/profile?seconds=1&hz=500",
+                      [&first](BeastResponse r) { first.set_value(r); });
+  std::promise<BeastResponse> busy;
+  profiler.CpuProfile("/debug/pprof/profile?seconds=1",
+                      [&busy](BeastResponse r) { busy.set_value(r); });
+  EXPECT_EQ(Wait(busy.get_future()).result(), be::http::status::conflict);
+
+  auto const response = Wait(first.get_future());
+  EXPECT_EQ(response.result(), be::http::status::ok);
+  EXPECT_EQ(response[be::http::field::content_type],
+            "application/octet-stream");
+  // A gzip stream.
+  auto const& body = response.body().str();
+  ASSERT_GE(body.size(), 2);
+  EXPECT_EQ(static_cast<unsigned char>(body[0]), 0x1F);
+  EXPECT_EQ(static_cast<unsigned char>(body[1]), 0x8B);
+}
+
+TEST(ProfilerTest, InvalidParameters) {
+  Profiler profiler;
+  for (auto const* target :
+       {"/debug/pprof/profile?seconds=0", "/debug/pprof/profile?seconds=x",
+        "/debug/pprof/profile?seconds=301", "/debug/pprof/profile?hz=0",
+        "/debug/pprof/profile?hz=1001"}) {
+    std::promise<BeastResponse> p;
+    profiler.CpuProfile(target, [&p](BeastResponse r) { p.set_value(r); });
+    auto const status = Wait(p.get_future()).result();
+    if (!CpuProfilingSupported()) {
+      EXPECT_EQ(status, be::http::status::not_implemented);
+      continue;
+    }
+    EXPECT_EQ(status, be::http::status::bad_request) << target;
+  }
+}
+
+TEST(ProfilerTest, Stop) {
+  if (!CpuProfilingSupported()) GTEST_SKIP();
+  Profiler profiler;
+  std::promise<BeastResponse> p;
+  auto const start = std::chrono::steady_clock::now();
+  profiler.CpuProfile("/debug/pprof/profile?seconds=60",
+                      [&p](BeastResponse r) { p.set_value(r); });
+  profiler.Stop();
+  EXPECT_EQ(Wait(p.get_future()).result(), be::http::status::ok);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(30));
+}
+
+TEST(ProfilerTest, HeapProfile) {
+  Profiler profiler;
+  std::promise<BeastResponse> p;
+  profiler.HeapProfile("/debug/pprof/heap?seconds=1",
+                       [&p](BeastResponse r) { p.set_value(r); });
+  auto const status = Wait(p.get_future()).result();
+  if (!AllocationCountingEnabled()) {
+    EXPECT_EQ(status, be::http::status::not_implemented);
+    return;
+  }
+  EXPECT_EQ(status, be::http::status::ok);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,78 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/query_string.h"
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+int HexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+}  // namespace
+
+std::string_view TargetPath(std::string_view target) {
+  return target.substr(0, target.find('?'));
+}
+
+QueryParameters ParseQueryParameters(std::string_view target) {
+  QueryParameters parameters;
+  auto const q = target.find('?');
+  if (q == std::string_view::npos) return parameters;
+  auto query = target.substr(q + 1);
+  query = query.substr(0, query.find('#'));
+  while (!query.empty()) {
+    auto const amp = query.find('&');
+    auto const p = query.substr(0, amp);
+    query = amp == std::string_view::npos ? std::string_view{}
+                                          : query.substr(amp + 1);
+    if (p.empty()) continue;
+    auto const eq = p.find('=');
+    if (eq == std::string_view::npos) {
+      parameters.emplace_back(p, std::string_view{});
+      continue;
+    }
+    parameters.emplace_back(p.substr(0, eq), p.substr(eq + 1));
+  }
+  return parameters;
+}
+
+std::string PercentDecode(std::string_view encoded) {
+  std::string decoded;
+  decoded.reserve(encoded.size());
+  for (std::size_t i = 0; i != encoded.size(); ++i) {
+    auto const c = encoded[i];
+    if (c == '+') {
+      decoded.push_back(' ');
+      continue;
+    }
+    if (c == '%' && i + 2 < encoded.size()) {
+      auto const hi = HexValue(encoded[i + 1]);
+      auto const lo = HexValue(encoded[i + 2]);
+      if (hi >= 0 && lo >= 0) {
+        decoded.push_back(static_cast<char>(hi * 16 + lo));
+        i += 2;
+        continue;
+      }
+    }
+    decoded.push_back(c);
+  }
+  return decoded;
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
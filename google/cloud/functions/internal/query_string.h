@@ -0,0 +1,51 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_QUERY_STRING_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_QUERY_STRING_H
+
+#include "google/cloud/functions/version.h"
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+using QueryParameters =
+    std::vector<std::pair<std::string_view, std::string_view>>;
+
+/// Returns the path of @p target, that is, the target without the query.
+std::string_view TargetPath(std::string_view target);
+
+/**
+ * Splits the query in @p target into `name=value` pairs.
+ *
+ * The pairs refer to @p target and are not decoded. Empty parameters are
+ * skipped, and parameters without a `=` have an empty value.
+ */
+QueryParameters ParseQueryParameters(std::string_view target);
+
+/**
+ * Decodes the percent-escapes in a query name or value.
+ *
+ * A `+` is decoded as a space. Malformed escapes are kept as-is.
+ */
+std::string PercentDecode(std::string_view encoded);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_QUERY_STRING_H
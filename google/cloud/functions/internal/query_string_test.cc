@@ -0,0 +1,65 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/query_string.h"
+#include <gmock/gmock.h>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+
+TEST(QueryStringTest, TargetPath) {
+  EXPECT_EQ(TargetPath(""), "");
+  EXPECT_EQ(TargetPath("/"), "/");
+  EXPECT_EQ(TargetPath("/a/b"), "/a/b");
+  EXPECT_EQ(TargetPath("/a/b?c=d"), "/a/b");
+  EXPECT_EQ(TargetPath("/a/b?"), "/a/b");
+}
+
+TEST(QueryStringTest, ParseQueryParameters) {
+  EXPECT_THAT(ParseQueryParameters("/a/b"), IsEmpty());
+  EXPECT_THAT(ParseQueryParameters("/a/b?"), IsEmpty());
+  EXPECT_THAT(ParseQueryParameters("/?a=1&b=&c&&d=x=y&a=2#frag"),
+              ElementsAre(Pair("a", "1"), Pair("b", ""), Pair("c", ""),
+                          Pair("d", "x=y"), Pair("a", "2")));
+  EXPECT_THAT(ParseQueryParameters("/?q=a%20b+c"),
+              ElementsAre(Pair("q", "a%20b+c")));
+}
+
+TEST(QueryStringTest, ParseQueryParametersRefersToTarget) {
+  std::string const target = "/?name=value";
+  auto const parameters = ParseQueryParameters(target);
+  ASSERT_THAT(parameters, ElementsAre(Pair("name", "value")));
+  EXPECT_EQ(parameters[0].first.data(), target.data() + 2);
+  EXPECT_EQ(parameters[0].second.data(), target.data() + 7);
+}
+
+TEST(QueryStringTest, PercentDecode) {
+  EXPECT_EQ(PercentDecode(""), "");
+  EXPECT_EQ(PercentDecode("abc"), "abc");
+  EXPECT_EQ(PercentDecode("a%20b+c"), "a b c");
+  EXPECT_EQ(PercentDecode("%2f%2F"), "//");
+  EXPECT_EQ(PercentDecode("%e2%82%AC"), "\xe2\x82\xac");
+  EXPECT_EQ(PercentDecode("100%"), "100%");
+  EXPECT_EQ(PercentDecode("%4"), "%4");
+  EXPECT_EQ(PercentDecode("%zz%41"), "%zzA");
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
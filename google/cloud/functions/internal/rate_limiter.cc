@@ -0,0 +1,106 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/rate_limiter.h"
+#include <boost/asio/ip/tcp.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+// Caps the `Retry-After` value, e.g. for a rate of 0.
+auto constexpr kMaxRetryAfter = std::chrono::hours(1);
+
+thread_local std::string_view current_peer_address;
+}  // namespace
+
+RateLimiter::RateLimiter(double rate, double burst, std::size_t max_keys)
+    : rate_(std::max(rate, 0.0)),
+      burst_(std::max(burst, 1.0)),
+      max_keys_per_shard_(std::max<std::size_t>(max_keys / kShards, 1)) {}
+
+std::optional<std::chrono::seconds> RateLimiter::Acquire(
+    std::string_view key, Clock::time_point now) {
+  auto& shard = shards_[std::hash<std::string_view>{}(key) % kShards];
+  std::lock_guard<std::mutex> lk(shard.mu);
+  auto& buckets = shard.buckets;
+  if (auto l = shard.index.find(key); l != shard.index.end()) {
+    buckets.splice(buckets.begin(), buckets, l->second);
+  } else if (buckets.size() >= max_keys_per_shard_) {
+    // Reuse the least recently used bucket, and its key buffer.
+    shard.index.erase(buckets.back().key);
+    buckets.splice(buckets.begin(), buckets, std::prev(buckets.end()));
+    buckets.front().key.assign(key.data(), key.size());
+    buckets.front().tokens = burst_;
+    buckets.front().last = now;
+    shard.index.emplace(buckets.front().key, buckets.begin());
+  } else {
+    buckets.push_front(Bucket{std::string(key), burst_, now});
+    shard.index.emplace(buckets.front().key, buckets.begin());
+  }
+  auto& bucket = buckets.front();
+  bucket.tokens = Refill(bucket, now);
+  bucket.last = now;
+  if (bucket.tokens >= 1.0) {
+    bucket.tokens -= 1.0;
+    return std::nullopt;
+  }
+  using Seconds = std::chrono::seconds;
+  auto const max = std::chrono::duration<double>(kMaxRetryAfter).count();
+  auto const wait =
+      rate_ == 0 ? max : std::min((1.0 - bucket.tokens) / rate_, max);
+  return Seconds(
+      std::max(static_cast<Seconds::rep>(std::ceil(wait)), Seconds::rep{1}));
+}
+
+std::size_t RateLimiter::size() const {
+  std::size_t size = 0;
+  for (auto const& shard : shards_) {
+    std::lock_guard<std::mutex> lk(shard.mu);
+    size += shard.buckets.size();
+  }
+  return size;
+}
+
+double RateLimiter::Refill(Bucket const& b, Clock::time_point now) const {
+  auto const elapsed = std::chrono::duration<double>(now - b.last).count();
+  return std::min(burst_, b.tokens + rate_ * std::max(elapsed, 0.0));
+}
+
+std::string PeerAddress(
+    boost::asio::generic::stream_protocol::socket const& socket) {
+  boost::system::error_code ec;
+  auto const endpoint = socket.remote_endpoint(ec);
+  auto const family = endpoint.protocol().family();
+  if (ec || (family != AF_INET && family != AF_INET6)) return {};
+  boost::asio::ip::tcp::endpoint tcp;
+  if (endpoint.size() > tcp.capacity()) return {};
+  std::memcpy(tcp.data(), endpoint.data(), endpoint.size());
+  tcp.resize(endpoint.size());
+  return tcp.address().to_string();
+}
+
+std::string_view CurrentPeerAddress() { return current_peer_address; }
+
+ScopedPeerAddress::ScopedPeerAddress(std::string_view address)
+    : previous_(std::exchange(current_peer_address, address)) {}
+
+ScopedPeerAddress::~ScopedPeerAddress() { current_peer_address = previous_; }
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,114 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_RATE_LIMITER_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_RATE_LIMITER_H
+
+#include "google/cloud/functions/version.h"
+#include <boost/asio/generic/stream_protocol.hpp>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * A token bucket per key, see `functions::WithRateLimit()`.
+ *
+ * The buckets are split in shards, each with its own mutex, so requests from
+ * different clients rarely contend. Looking up an existing bucket does not
+ * allocate. Each shard keeps its buckets in LRU order, once a shard is full a
+ * new key replaces the least recently used bucket, in constant time. Every
+ * request is limited, even if the bucket of its key was replaced.
+ */
+class RateLimiter {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  RateLimiter(double rate, double burst, std::size_t max_keys);
+
+  /**
+   * Takes a token from the bucket for @p key.
+   *
+   * Returns an empty optional if the request may run, otherwise the number of
+   * seconds until the bucket has a token, at least one.
+   */
+  std::optional<std::chrono::seconds> Acquire(std::string_view key,
+                                              Clock::time_point now);
+  std::optional<std::chrono::seconds> Acquire(std::string_view key) {
+    return Acquire(key, Clock::now());
+  }
+
+  /// The number of buckets.
+  [[nodiscard]] std::size_t size() const;
+
+ private:
+  static auto constexpr kShards = 16;
+
+  struct Bucket {
+    std::string key;
+    double tokens;
+    Clock::time_point last;
+  };
+  using List = std::list<Bucket>;
+  struct Shard {
+    mutable std::mutex mu;
+    /// The most recently used buckets first.
+    List buckets;
+    std::unordered_map<std::string_view, List::iterator> index;
+  };
+
+  [[nodiscard]] double Refill(Bucket const& b, Clock::time_point now) const;
+
+  double const rate_;
+  double const burst_;
+  std::size_t const max_keys_per_shard_;
+  std::array<Shard, kShards> shards_;
+};
+
+/**
+ * The address of the client connected to @p socket.
+ *
+ * Returns an empty string for Unix domain sockets, or if the socket is closed.
+ */
+std::string PeerAddress(
+    boost::asio::generic::stream_protocol::socket const& socket);
+
+/// The peer address of the request checked in the current thread, if any.
+std::string_view CurrentPeerAddress();
+
+/// Sets the peer address of the current thread, see `PeerAddress()`.
+class ScopedPeerAddress {
+ public:
+  explicit ScopedPeerAddress(std::string_view address);
+  ~ScopedPeerAddress();
+
+  ScopedPeerAddress(ScopedPeerAddress const&) = delete;
+  ScopedPeerAddress& operator=(ScopedPeerAddress const&) = delete;
+
+ private:
+  std::string_view previous_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_RATE_LIMITER_H
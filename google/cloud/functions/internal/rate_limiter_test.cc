@@ -0,0 +1,135 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/rate_limiter.h"
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <gmock/gmock.h>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::std::chrono::milliseconds;
+using ::std::chrono::seconds;
+using ::testing::Optional;
+
+TEST(RateLimiter, Burst) {
+  RateLimiter limiter(1.0, 3.0, 1024);
+  auto const now = RateLimiter::Clock::now();
+  EXPECT_EQ(limiter.Acquire("a", now), std::nullopt);
+  EXPECT_EQ(limiter.Acquire("a", now), std::nullopt);
+  EXPECT_EQ(limiter.Acquire("a", now), std::nullopt);
+  EXPECT_THAT(limiter.Acquire("a", now), Optional(seconds(1)));
+  // Other keys have their own bucket.
+  EXPECT_EQ(limiter.Acquire("b", now), std::nullopt);
+  EXPECT_EQ(limiter.size(), 2U);
+}
+
+TEST(RateLimiter, Refill) {
+  RateLimiter limiter(2.0, 1.0, 1024);
+  auto const now = RateLimiter::Clock::now();
+  EXPECT_EQ(limiter.Acquire("a", now), std::nullopt);
+  EXPECT_THAT(limiter.Acquire("a", now), Optional(seconds(1)));
+  EXPECT_THAT(limiter.Acquire("a", now + milliseconds(200)),
+              Optional(seconds(1)));
+  EXPECT_EQ(limiter.Acquire("a", now + milliseconds(500)), std::nullopt);
+  // The bucket never holds more than the burst.
+  EXPECT_EQ(limiter.Acquire("a", now + seconds(60)), std::nullopt);
+  EXPECT_THAT(limiter.Acquire("a", now + seconds(60)), Optional(seconds(1)));
+}
+
+TEST(RateLimiter, RetryAfter) {
+  RateLimiter slow(0.1, 1.0, 1024);
+  auto const now = RateLimiter::Clock::now();
+  EXPECT_EQ(slow.Acquire("a", now), std::nullopt);
+  EXPECT_THAT(slow.Acquire("a", now), Optional(seconds(10)));
+
+  RateLimiter never(0.0, 1.0, 1024);
+  EXPECT_EQ(never.Acquire("a", now), std::nullopt);
+  EXPECT_THAT(never.Acquire("a", now + seconds(60)),
+              Optional(std::chrono::hours(1)));
+}
+
+TEST(RateLimiter, MaxKeys) {
+  // One key per shard, so most new keys replace a bucket.
+  RateLimiter limiter(1.0, 1.0, 0);
+  auto const now = RateLimiter::Clock::now();
+  for (int i = 0; i != 64; ++i) {
+    EXPECT_EQ(limiter.Acquire(std::to_string(i), now), std::nullopt);
+  }
+  EXPECT_LE(limiter.size(), 16U);
+  // New keys are limited, even if all the buckets are in use.
+  EXPECT_EQ(limiter.Acquire("new", now), std::nullopt);
+  EXPECT_THAT(limiter.Acquire("new", now), Optional(seconds(1)));
+  EXPECT_LE(limiter.size(), 16U);
+}
+
+TEST(RateLimiter, LeastRecentlyUsed) {
+  // Two keys per shard, find three keys in the same shard.
+  RateLimiter limiter(1.0, 1.0, 32);
+  auto shard = [](std::string const& key) {
+    return std::hash<std::string_view>{}(key) % 16;
+  };
+  std::vector<std::string> keys;
+  for (int i = 0; keys.size() != 3; ++i) {
+    auto key = std::to_string(i);
+    if (shard(key) == shard("0")) keys.push_back(std::move(key));
+  }
+  auto const now = RateLimiter::Clock::now();
+  EXPECT_EQ(limiter.Acquire(keys[0], now), std::nullopt);
+  EXPECT_EQ(limiter.Acquire(keys[1], now), std::nullopt);
+  EXPECT_TRUE(limiter.Acquire(keys[0], now).has_value());
+  // Replaces the bucket of `keys[1]`, the least recently used.
+  EXPECT_EQ(limiter.Acquire(keys[2], now), std::nullopt);
+  EXPECT_EQ(limiter.size(), 2U);
+  EXPECT_TRUE(limiter.Acquire(keys[0], now).has_value());
+  EXPECT_TRUE(limiter.Acquire(keys[2], now).has_value());
+  EXPECT_EQ(limiter.Acquire(keys[1], now), std::nullopt);
+}
+
+TEST(RateLimiter, PeerAddress) {
+  using ::boost::asio::ip::tcp;
+  boost::asio::io_context io;
+  tcp::acceptor acceptor(io, tcp::endpoint(tcp::v4(), 0));
+  tcp::socket client(io);
+  client.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(),
+                               acceptor.local_endpoint().port()));
+  boost::asio::generic::stream_protocol::socket server(acceptor.accept());
+  EXPECT_EQ(PeerAddress(server), "127.0.0.1");
+  server.close();
+  EXPECT_EQ(PeerAddress(server), "");
+}
+
+TEST(RateLimiter, ScopedPeerAddress) {
+  EXPECT_EQ(CurrentPeerAddress(), "");
+  {
+    ScopedPeerAddress outer("10.0.0.1");
+    {
+      ScopedPeerAddress inner("10.0.0.2");
+      EXPECT_EQ(CurrentPeerAddress(), "10.0.0.2");
+    }
+    EXPECT_EQ(CurrentPeerAddress(), "10.0.0.1");
+  }
+  EXPECT_EQ(CurrentPeerAddress(), "");
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
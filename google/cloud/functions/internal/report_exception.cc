@@ -0,0 +1,65 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/report_exception.h"
+#include <string>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+namespace be = ::boost::beast;
+
+BeastResponse ApplicationError(std::string_view message,
+                               absl::Span<LogField const> fields) {
+  WriteLog(functions::LogSeverity::kError, message, fields);
+  BeastResponse response;
+  response.result(be::http::status::internal_server_error);
+  response.insert(be::http::field::content_type, "application/json");
+  std::string body;
+  FormatLogEntry(body, functions::LogSeverity::kError, message, fields,
+                 nullptr);
+  response.body() = std::move(body);
+  return response;
+}
+
+BeastResponse ReportExceptionInFunction(std::exception const& ex) {
+  return ApplicationError(
+      std::string("standard C++ exception thrown by the function: ") +
+      ex.what());
+}
+
+BeastResponse ReportUnknownExceptionInFunction() {
+  return ApplicationError("unknown C++ exception thrown by the function");
+}
+
+BeastResponse ReportException(std::exception_ptr const& ex) try {
+  std::rethrow_exception(ex);
+} catch (std::exception const& e) {
+  return ReportExceptionInFunction(e);
+} catch (...) {
+  return ReportUnknownExceptionInFunction();
+}
+
+std::string ExceptionMessage(std::exception_ptr const& ex) try {
+  std::rethrow_exception(ex);
+} catch (std::exception const& e) {
+  return std::string("standard C++ exception thrown by the function: ") +
+         e.what();
+} catch (...) {
+  return "unknown C++ exception thrown by the function";
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
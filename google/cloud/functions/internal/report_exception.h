@@ -0,0 +1,54 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_REPORT_EXCEPTION_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_REPORT_EXCEPTION_H
+
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/internal/structured_log.h"
+#include "google/cloud/functions/version.h"
+#include <absl/types/span.h>
+#include <exception>
+#include <string>
+#include <string_view>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Logs an error, and returns it as the response.
+ *
+ * The log entry is picked up and parsed by Cloud Logging:
+ *     https://cloud.google.com/functions/docs/monitoring/logging#writing_structured_logs
+ * The response has the same entry, without the request trace and execution id.
+ */
+BeastResponse ApplicationError(std::string_view message,
+                               absl::Span<LogField const> fields = {});
+
+/// Logs an exception thrown by the function, and returns it as the response.
+BeastResponse ReportExceptionInFunction(std::exception const& ex);
+
+/// Logs an unknown exception thrown by the function, as the previous overload.
+BeastResponse ReportUnknownExceptionInFunction();
+
+/// Logs the exception in @p ex, as the previous overloads.
+BeastResponse ReportException(std::exception_ptr const& ex);
+
+/// Returns the message logged for the exception in @p ex.
+std::string ExceptionMessage(std::exception_ptr const& ex);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_REPORT_EXCEPTION_H
@@ -0,0 +1,239 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/request_timing.h"
+#include "google/cloud/functions/internal/metrics.h"
+#include <charconv>
+#include <ctime>
+#include <iterator>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using Clock = RequestTiming::Clock;
+
+thread_local RequestTiming* current_timing = nullptr;
+thread_local PhaseTimer* current_timer = nullptr;
+
+/// Returns the current request timing, or @p local if there is none.
+RequestTiming& TimingFor(RequestTiming& local) {
+  return current_timing != nullptr ? *current_timing : local;
+}
+
+/// Reports the handler phases once the handler returns.
+void Report(RequestTiming const& timing, RequestTimingOptions const& options,
+            BeastResponse* response) {
+  if (options.metrics) {
+    for (auto phase : kHandlerPhases) {
+      options.metrics->RecordPhase(phase, timing.duration(phase));
+    }
+    options.metrics->RecordCpuTime(timing.route(), timing.event_type(),
+                                   timing.cpu_time());
+    if (timing.stale_events() != 0) {
+      options.metrics->RecordStaleEvents(timing.stale_events());
+    }
+    if (AllocationCountingEnabled()) {
+      for (auto phase : kHandlerPhases) {
+        options.metrics->RecordAllocations(phase, timing.allocations(phase));
+      }
+    }
+  }
+  if (options.server_timing && response != nullptr) {
+    response->set("Server-Timing", timing.ServerTiming());
+  }
+}
+
+}  // namespace
+
+std::string_view RequestPhaseName(RequestPhase phase) {
+  switch (phase) {
+    case RequestPhase::kRead:
+      return "read";
+    case RequestPhase::kQueue:
+      return "queue";
+    case RequestPhase::kDecode:
+      return "decode";
+    case RequestPhase::kFunction:
+      return "function";
+    case RequestPhase::kEncode:
+      return "encode";
+    case RequestPhase::kWrite:
+      return "write";
+  }
+  return "unknown";
+}
+
+std::chrono::nanoseconds ThreadCpuTime() {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+  timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+    return std::chrono::nanoseconds(0);
+  }
+  return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+#else
+  return std::chrono::nanoseconds(0);
+#endif  // CLOCK_THREAD_CPUTIME_ID
+}
+
+std::chrono::nanoseconds RequestTiming::cpu_time() const {
+  std::chrono::nanoseconds total{0};
+  for (auto d : cpu_times_) total += d;
+  return total;
+}
+
+std::string RequestTiming::ServerTiming() const {
+  std::string value;
+  for (auto phase : kHandlerPhases) {
+    if (!value.empty()) value += ", ";
+    value += RequestPhaseName(phase);
+    value += ";dur=";
+    // Server-Timing durations are in milliseconds.
+    auto const ms =
+        std::chrono::duration<double, std::milli>(duration(phase)).count();
+    char buffer[32];
+    auto const r = std::to_chars(std::begin(buffer), std::end(buffer), ms,
+                                 std::chars_format::fixed, 3);
+    value.append(buffer, r.ptr);
+  }
+  return value;
+}
+
+RequestTiming* CurrentRequestTiming() { return current_timing; }
+
+void SetRequestRoute(std::string_view route) {
+  if (current_timing != nullptr) current_timing->set_route(route);
+}
+
+void SetRequestEventType(std::string_view type) {
+  if (current_timing == nullptr || !current_timing->event_type().empty()) {
+    return;
+  }
+  current_timing->set_event_type(type);
+}
+
+void AddRequestStaleEvents(std::uint64_t n) {
+  if (current_timing != nullptr) current_timing->AddStaleEvents(n);
+}
+
+ScopedRequestTiming::ScopedRequestTiming(RequestTiming* timing)
+    : previous_(current_timing) {
+  current_timing = timing;
+}
+
+ScopedRequestTiming::~ScopedRequestTiming() { current_timing = previous_; }
+
+PhaseTimer::PhaseTimer(RequestPhase phase)
+    : timing_(current_timing), phase_(phase), outer_(nullptr) {
+  if (timing_ == nullptr) return;
+  start_ = Clock::now();
+  cpu_start_ = ThreadCpuTime();
+  allocations_start_ = ThreadAllocations();
+  outer_ = std::exchange(current_timer, this);
+  // Pause the outer timer.
+  if (outer_ == nullptr) return;
+  timing_->Add(outer_->phase_, start_ - outer_->start_);
+  timing_->AddCpuTime(outer_->phase_, cpu_start_ - outer_->cpu_start_);
+  timing_->AddAllocations(outer_->phase_,
+                          allocations_start_ - outer_->allocations_start_);
+}
+
+PhaseTimer::~PhaseTimer() {
+  if (timing_ == nullptr) return;
+  auto const now = Clock::now();
+  auto const cpu = ThreadCpuTime();
+  auto const allocations = ThreadAllocations();
+  timing_->Add(phase_, now - start_);
+  timing_->AddCpuTime(phase_, cpu - cpu_start_);
+  timing_->AddAllocations(phase_, allocations - allocations_start_);
+  current_timer = outer_;
+  // Resume the outer timer.
+  if (outer_ == nullptr) return;
+  outer_->start_ = now;
+  outer_->cpu_start_ = cpu;
+  outer_->allocations_start_ = allocations;
+}
+
+Handler MakeTimingHandler(Handler handler, RequestTimingOptions options) {
+  return [handler = std::move(handler),
+          options = std::move(options)](BeastRequest request) {
+    RequestTiming local;
+    auto& timing = TimingFor(local);
+    ScopedRequestTiming scoped(&timing);
+    auto response = handler(std::move(request));
+    Report(timing, options, &response);
+    return response;
+  };
+}
+
+StreamingHandler MakeTimingStreamingHandler(StreamingHandler handler,
+                                            RequestTimingOptions options) {
+  return [handler = std::move(handler), options = std::move(options)](
+             BeastRequest request, functions::HttpRequestBodyReader& reader) {
+    RequestTiming local;
+    auto& timing = TimingFor(local);
+    ScopedRequestTiming scoped(&timing);
+    auto response = handler(std::move(request), reader);
+    Report(timing, options, &response);
+    return response;
+  };
+}
+
+WriterHandler MakeTimingWriterHandler(WriterHandler handler,
+                                      RequestTimingOptions options) {
+  return [handler = std::move(handler), options = std::move(options)](
+             BeastRequest request, ResponseWriter& writer) {
+    // The header is sent before the function returns, so these responses
+    // have no `Server-Timing` header.
+    RequestTiming local;
+    auto& timing = TimingFor(local);
+    ScopedRequestTiming scoped(&timing);
+    auto const ok = handler(std::move(request), writer);
+    Report(timing, options, nullptr);
+    return ok;
+  };
+}
+
+AsyncHandler MakeTimingAsyncHandler(AsyncHandler handler,
+                                    RequestTimingOptions options) {
+  return [handler = std::move(handler), options = std::move(options)](
+             BeastRequest request, AsyncResponseCallback callback) {
+    // Only the start of the function runs in this thread, its time is measured
+    // until the callback. The CPU time only includes the decode phase, the
+    // function may use any number of threads.
+    std::shared_ptr<RequestTiming> owned;
+    auto* timing = current_timing;
+    if (timing == nullptr) {
+      owned = std::make_shared<RequestTiming>();
+      timing = owned.get();
+    }
+    auto const start = Clock::now();
+    ScopedRequestTiming scoped(timing);
+    handler(std::move(request), [owned = std::move(owned), timing, start,
+                                 options, callback = std::move(callback)](
+                                    BeastResponse response) {
+      // The function may still be running in the thread that started it, but
+      // the decode phase is complete. The function phase is only written here.
+      auto const elapsed = Clock::now() - start;
+      auto const decode = timing->duration(RequestPhase::kDecode);
+      timing->Add(RequestPhase::kFunction, elapsed - decode);
+      Report(*timing, options, &response);
+      callback(std::move(response));
+    });
+  };
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
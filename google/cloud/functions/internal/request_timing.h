@@ -0,0 +1,218 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_REQUEST_TIMING_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_REQUEST_TIMING_H
+
+#include "google/cloud/functions/internal/allocation_counter.h"
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/version.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+class ServerMetrics;
+
+/// The phases of a request, in the order they run.
+enum class RequestPhase {
+  /// Reading the request, from its first byte until it is complete.
+  kRead,
+  /// Waiting for a thread to run the handler.
+  kQueue,
+  /// Converting the request to an `HttpRequest`, or parsing its events.
+  kDecode,
+  /// Running the user function.
+  kFunction,
+  /// Converting the `HttpResponse` returned by the function.
+  kEncode,
+  /// Serializing and sending the response.
+  kWrite,
+};
+
+inline constexpr std::size_t kRequestPhaseCount = 6;
+
+/// The phases timed by the handlers, the sessions time the other phases.
+inline constexpr std::array<RequestPhase, 3> kHandlerPhases = {
+    RequestPhase::kDecode,
+    RequestPhase::kFunction,
+    RequestPhase::kEncode,
+};
+
+/// The name of @p phase, in metrics and `Server-Timing` headers.
+std::string_view RequestPhaseName(RequestPhase phase);
+
+/// Returns the CPU time used by the calling thread, 0 if not available.
+std::chrono::nanoseconds ThreadCpuTime();
+
+/**
+ * The time spent in each phase of a request.
+ *
+ * It also measures the CPU time of the handler phases, and with
+ * `FUNCTIONS_FRAMEWORK_CPP_COUNT_ALLOCATIONS` counts their heap allocations.
+ * The sessions interleave the I/O of many requests in the same thread, the
+ * read and write phases are not counted.
+ *
+ * The CPU time is attributed to the route and CloudEvent type of the request,
+ * so the metrics show which handlers are the most expensive to run.
+ */
+class RequestTiming {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  void Add(RequestPhase phase, Clock::duration d) {
+    durations_[static_cast<std::size_t>(phase)] += d;
+  }
+  [[nodiscard]] Clock::duration duration(RequestPhase phase) const {
+    return durations_[static_cast<std::size_t>(phase)];
+  }
+
+  void AddCpuTime(RequestPhase phase, std::chrono::nanoseconds d) {
+    cpu_times_[static_cast<std::size_t>(phase)] += d;
+  }
+  [[nodiscard]] std::chrono::nanoseconds cpu_time(RequestPhase phase) const {
+    return cpu_times_[static_cast<std::size_t>(phase)];
+  }
+  /// The CPU time of all the phases.
+  [[nodiscard]] std::chrono::nanoseconds cpu_time() const;
+
+  /// The route that served the request, see `functions::MakeRouter()`.
+  void set_route(std::string_view route) { route_ = route; }
+  [[nodiscard]] std::string const& route() const { return route_; }
+
+  /// The type of the (first) CloudEvent in the request.
+  void set_event_type(std::string_view type) { event_type_ = type; }
+  [[nodiscard]] std::string const& event_type() const { return event_type_; }
+
+  /// The CloudEvents dropped as too old, see `EventAgeCutoff`.
+  void AddStaleEvents(std::uint64_t n) { stale_events_ += n; }
+  [[nodiscard]] std::uint64_t stale_events() const { return stale_events_; }
+
+  void AddAllocations(RequestPhase phase, AllocationCounts counts) {
+    allocations_[static_cast<std::size_t>(phase)] += counts;
+  }
+  [[nodiscard]] AllocationCounts allocations(RequestPhase phase) const {
+    return allocations_[static_cast<std::size_t>(phase)];
+  }
+
+  /**
+   * Formats the phases as a `Server-Timing` header value.
+   *
+   * Only the decode, function, and encode phases are included, the others are
+   * not known until the response is sent.
+   */
+  [[nodiscard]] std::string ServerTiming() const;
+
+ private:
+  std::array<Clock::duration, kRequestPhaseCount> durations_{};
+  std::array<std::chrono::nanoseconds, kRequestPhaseCount> cpu_times_{};
+  std::array<AllocationCounts, kRequestPhaseCount> allocations_{};
+  std::string route_;
+  std::string event_type_;
+  std::uint64_t stale_events_ = 0;
+};
+
+/// The timing of the request running in the current thread, if any.
+RequestTiming* CurrentRequestTiming();
+
+/// Sets the route of the current request, if it is timed.
+void SetRequestRoute(std::string_view route);
+
+/// Sets the CloudEvent type of the current request, if it is timed and the
+/// type is not set yet.
+void SetRequestEventType(std::string_view type);
+
+/// Adds @p n stale CloudEvents to the current request, if it is timed.
+void AddRequestStaleEvents(std::uint64_t n);
+
+/// Sets the request timing of the current thread, @p timing may be null.
+class ScopedRequestTiming {
+ public:
+  explicit ScopedRequestTiming(RequestTiming* timing);
+  ~ScopedRequestTiming();
+
+  ScopedRequestTiming(ScopedRequestTiming const&) = delete;
+  ScopedRequestTiming& operator=(ScopedRequestTiming const&) = delete;
+
+ private:
+  RequestTiming* previous_;
+};
+
+/**
+ * Adds the time until it is destroyed to a phase of the current request.
+ *
+ * The timers nest, an inner timer pauses the outer one, so the function time
+ * is not counted as decode time when the events of a batch run while they
+ * are parsed. The CPU time and allocations are attributed the same way. Does
+ * nothing, without reading the clocks, if the thread has no request timing.
+ */
+class PhaseTimer {
+ public:
+  explicit PhaseTimer(RequestPhase phase);
+  ~PhaseTimer();
+
+  PhaseTimer(PhaseTimer const&) = delete;
+  PhaseTimer& operator=(PhaseTimer const&) = delete;
+
+ private:
+  RequestTiming* timing_;
+  RequestPhase phase_;
+  RequestTiming::Clock::time_point start_;
+  std::chrono::nanoseconds cpu_start_{0};
+  AllocationCounts allocations_start_;
+  PhaseTimer* outer_;
+};
+
+/// Calls @p f, adding its time to @p phase of the current request.
+template <typename F>
+auto Timed(RequestPhase phase, F&& f) {
+  PhaseTimer timer(phase);
+  return f();
+}
+
+/// Where the request timings are reported.
+struct RequestTimingOptions {
+  /// If not null, records the phases in its histograms.
+  std::shared_ptr<ServerMetrics> metrics;
+  /// If `true`, adds a `Server-Timing` header to the responses.
+  bool server_timing = false;
+};
+
+/**
+ * Wrap the handlers to time the phases of each request.
+ *
+ * The phases are added to the current request timing, if the caller set one,
+ * and to a new timing otherwise. For asynchronous handlers the current timing
+ * must remain valid until the callback runs.
+ */
+///@{
+Handler MakeTimingHandler(Handler handler, RequestTimingOptions options);
+StreamingHandler MakeTimingStreamingHandler(StreamingHandler handler,
+                                            RequestTimingOptions options);
+WriterHandler MakeTimingWriterHandler(WriterHandler handler,
+                                      RequestTimingOptions options);
+AsyncHandler MakeTimingAsyncHandler(AsyncHandler handler,
+                                    RequestTimingOptions options);
+///@}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_REQUEST_TIMING_H
@@ -0,0 +1,176 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/request_timing.h"
+#include "google/cloud/functions/internal/metrics.h"
+#include <gmock/gmock.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::MatchesRegex;
+namespace http = ::boost::beast::http;
+
+TEST(RequestTimingTest, PhaseName) {
+  EXPECT_EQ(RequestPhaseName(RequestPhase::kRead), "read");
+  EXPECT_EQ(RequestPhaseName(RequestPhase::kQueue), "queue");
+  EXPECT_EQ(RequestPhaseName(RequestPhase::kDecode), "decode");
+  EXPECT_EQ(RequestPhaseName(RequestPhase::kFunction), "function");
+  EXPECT_EQ(RequestPhaseName(RequestPhase::kEncode), "encode");
+  EXPECT_EQ(RequestPhaseName(RequestPhase::kWrite), "write");
+}
+
+TEST(RequestTimingTest, ServerTiming) {
+  RequestTiming timing;
+  timing.Add(RequestPhase::kDecode, std::chrono::microseconds(1500));
+  timing.Add(RequestPhase::kFunction, std::chrono::milliseconds(20));
+  timing.Add(RequestPhase::kWrite, std::chrono::milliseconds(5));
+  EXPECT_EQ(timing.ServerTiming(),
+            "decode;dur=1.500, function;dur=20.000, encode;dur=0.000");
+}
+
+TEST(RequestTimingTest, NoTiming) {
+  EXPECT_EQ(CurrentRequestTiming(), nullptr);
+  // Does nothing without a request.
+  PhaseTimer timer(RequestPhase::kFunction);
+}
+
+TEST(RequestTimingTest, NestedTimers) {
+  RequestTiming timing;
+  {
+    ScopedRequestTiming scoped(&timing);
+    EXPECT_EQ(CurrentRequestTiming(), &timing);
+    PhaseTimer decode(RequestPhase::kDecode);
+    {
+      PhaseTimer function(RequestPhase::kFunction);
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+  }
+  EXPECT_EQ(CurrentRequestTiming(), nullptr);
+  EXPECT_GE(timing.duration(RequestPhase::kFunction),
+            std::chrono::milliseconds(20));
+  // The inner timer pauses the outer one.
+  EXPECT_LT(timing.duration(RequestPhase::kDecode),
+            std::chrono::milliseconds(20));
+}
+
+TEST(RequestTimingTest, NestedAllocations) {
+  RequestTiming timing;
+  std::unique_ptr<std::string> decoded;
+  std::unique_ptr<std::string> result;
+  {
+    ScopedRequestTiming scoped(&timing);
+    PhaseTimer decode(RequestPhase::kDecode);
+    decoded = std::make_unique<std::string>(100, 'd');
+    {
+      PhaseTimer function(RequestPhase::kFunction);
+      result = std::make_unique<std::string>(1000, 'f');
+    }
+  }
+  auto const decode = timing.allocations(RequestPhase::kDecode);
+  auto const function = timing.allocations(RequestPhase::kFunction);
+  if (!AllocationCountingEnabled()) {
+    EXPECT_EQ(decode, AllocationCounts{});
+    EXPECT_EQ(function, AllocationCounts{});
+    return;
+  }
+  EXPECT_EQ(decode.count, 2);
+  EXPECT_GE(decode.bytes, 100);
+  EXPECT_LT(decode.bytes, 1000);
+  EXPECT_EQ(function.count, 2);
+  EXPECT_GE(function.bytes, 1000);
+}
+
+TEST(RequestTimingTest, NestedCpuTime) {
+  RequestTiming timing;
+  {
+    ScopedRequestTiming scoped(&timing);
+    PhaseTimer decode(RequestPhase::kDecode);
+    {
+      PhaseTimer function(RequestPhase::kFunction);
+      auto const start = ThreadCpuTime();
+      while (ThreadCpuTime() - start < std::chrono::milliseconds(5)) {
+      }
+    }
+    // Sleeping uses no CPU time.
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  EXPECT_GE(timing.cpu_time(RequestPhase::kFunction),
+            std::chrono::milliseconds(5));
+  EXPECT_LT(timing.cpu_time(RequestPhase::kDecode),
+            std::chrono::milliseconds(5));
+  EXPECT_EQ(timing.cpu_time(), timing.cpu_time(RequestPhase::kDecode) +
+                                   timing.cpu_time(RequestPhase::kFunction));
+}
+
+TEST(RequestTimingTest, RouteAndEventType) {
+  // Does nothing without a request.
+  SetRequestRoute("/unused");
+  SetRequestEventType("unused");
+
+  RequestTiming timing;
+  ScopedRequestTiming scoped(&timing);
+  SetRequestRoute("/api");
+  SetRequestRoute("GET /api/v1");
+  EXPECT_EQ(timing.route(), "GET /api/v1");
+  // The first event of a batch sets the type.
+  SetRequestEventType("com.example.first");
+  SetRequestEventType("com.example.second");
+  EXPECT_EQ(timing.event_type(), "com.example.first");
+}
+
+TEST(RequestTimingTest, Handler) {
+  auto metrics = std::make_shared<ServerMetrics>();
+  auto handler = MakeTimingHandler(
+      [](BeastRequest const&) {
+        PhaseTimer timer(RequestPhase::kFunction);
+        return BeastResponse{};
+      },
+      RequestTimingOptions{metrics, true});
+  auto const response = handler(BeastRequest{});
+  EXPECT_THAT(std::string(response["Server-Timing"]),
+              MatchesRegex("decode;dur=[0-9.]+, function;dur=[0-9.]+, "
+                           "encode;dur=[0-9.]+"));
+  EXPECT_THAT(metrics->Render(),
+              HasSubstr("functions_framework_request_phase_seconds_"
+                        "count{phase=\"function\"} 1\n"));
+  EXPECT_THAT(metrics->Render(),
+              HasSubstr("functions_framework_handler_cpu_requests_total{"
+                        "route=\"\",event_type=\"\"} 1\n"));
+}
+
+TEST(RequestTimingTest, AsyncHandler) {
+  auto handler = MakeTimingAsyncHandler(
+      [](BeastRequest const&, AsyncResponseCallback const& callback) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        callback(BeastResponse{});
+      },
+      RequestTimingOptions{nullptr, true});
+  BeastResponse response;
+  handler(BeastRequest{}, [&](BeastResponse r) { response = std::move(r); });
+  EXPECT_THAT(std::string(response["Server-Timing"]),
+              HasSubstr("function;dur="));
+  EXPECT_THAT(std::string(response["Server-Timing"]),
+              ::testing::Not(HasSubstr("function;dur=0.000")));
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
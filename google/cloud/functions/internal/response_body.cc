@@ -0,0 +1,76 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/response_body.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+namespace be = ::boost::beast;
+
+FileSegment OpenFileSegment(std::string const& path, std::uint64_t offset,
+                            std::optional<std::uint64_t> size) {
+  auto file = std::make_shared<be::file>();
+  be::error_code ec;
+  file->open(path.c_str(), be::file_mode::scan, ec);
+  if (ec) {
+    throw std::runtime_error("cannot open file <" + path +
+                             ">: " + ec.message());
+  }
+  auto const file_size = file->size(ec);
+  if (ec) {
+    throw std::runtime_error("cannot get size of file <" + path +
+                             ">: " + ec.message());
+  }
+  if (offset > file_size || size.value_or(0) > file_size - offset) {
+    throw std::invalid_argument("range is outside file <" + path + ">");
+  }
+  return FileSegment{std::move(file), offset,
+                     size.value_or(file_size - offset)};
+}
+
+void ResponseBody::writer::init(be::error_code& ec) {
+  ec = {};
+  auto const* segment = body_.file();
+  if (segment == nullptr) return;
+  remaining_ = segment->size;
+  buffer_ = std::make_unique<std::array<char, kBufferSize>>();
+  segment->file->seek(segment->offset, ec);
+}
+
+boost::optional<std::pair<ResponseBody::writer::const_buffers_type, bool>>
+ResponseBody::writer::get(be::error_code& ec) {
+  ec = {};
+  auto const* segment = body_.file();
+  if (segment == nullptr) {
+    return {{boost::asio::buffer(body_.str()), false}};
+  }
+  if (remaining_ == 0) return boost::none;
+  auto const n = segment->file->read(
+      buffer_->data(), std::min<std::uint64_t>(remaining_, buffer_->size()),
+      ec);
+  if (ec) return boost::none;
+  // The file was truncated after it was opened.
+  if (n == 0) {
+    ec = be::http::error::short_read;
+    return boost::none;
+  }
+  remaining_ -= n;
+  return {{boost::asio::buffer(buffer_->data(), n), remaining_ != 0}};
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,182 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_RESPONSE_BODY_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_RESPONSE_BODY_H
+
+#include "google/cloud/functions/version.h"
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/core/file.hpp>
+#include <boost/beast/http/error.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional.hpp>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// A range of bytes in an open file.
+struct FileSegment {
+  std::shared_ptr<boost::beast::file> file;
+  std::uint64_t offset = 0;
+  std::uint64_t size = 0;
+};
+
+/**
+ * Opens @p path and returns the segment starting at @p offset.
+ *
+ * The segment covers @p size bytes, or the rest of the file if @p size is not
+ * set.
+ *
+ * @throws std::runtime_error if the file cannot be opened, and
+ *     std::invalid_argument if the range is not contained in the file.
+ */
+FileSegment OpenFileSegment(std::string const& path, std::uint64_t offset,
+                            std::optional<std::uint64_t> size);
+
+/**
+ * A Boost.Beast body for responses.
+ *
+ * The payload is either a string, a shared immutable string, or a segment of
+ * a file. Shared strings are sent directly from the shared buffer, and only
+ * copied if the payload is modified. The generic writer copies the file
+ * contents through a buffer, the server sends file segments with `sendfile(2)`
+ * where available.
+ */
+struct ResponseBody {
+  class value_type {
+   public:
+    value_type() = default;
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    value_type(std::string data) : data_(std::move(data)) {}
+
+    value_type& operator=(std::string data) {
+      data_ = std::move(data);
+      shared_.reset();
+      file_.reset();
+      return *this;
+    }
+    value_type& operator+=(std::string_view data) {
+      Unshare();
+      data_.append(data);
+      return *this;
+    }
+
+    /// The string payload, empty if the payload is a file segment.
+    [[nodiscard]] std::string const& str() const& {
+      return shared_ ? *shared_ : data_;
+    }
+    [[nodiscard]] std::string&& str() && {
+      Unshare();
+      return std::move(data_);
+    }
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    operator std::string const&() const { return str(); }
+
+    /// Refers to @p data, without copying it. A null pointer is empty.
+    void set_shared(std::shared_ptr<std::string const> data) {
+      data_.clear();
+      file_.reset();
+      shared_ = std::move(data);
+    }
+    /// The shared payload, or `nullptr` if the payload is not shared.
+    [[nodiscard]] std::shared_ptr<std::string const> const& shared() const {
+      return shared_;
+    }
+
+    void set_file(FileSegment segment) {
+      data_.clear();
+      shared_.reset();
+      file_ = std::move(segment);
+    }
+    /// The file segment, or `nullptr` if the payload is a string.
+    [[nodiscard]] FileSegment const* file() const {
+      return file_ ? &*file_ : nullptr;
+    }
+
+    [[nodiscard]] bool empty() const { return size() == 0; }
+    [[nodiscard]] std::uint64_t size() const {
+      return file_ ? file_->size : str().size();
+    }
+    void clear() {
+      data_.clear();
+      shared_.reset();
+      file_.reset();
+    }
+
+    friend bool operator==(value_type const& lhs, std::string_view rhs) {
+      return !lhs.file_ && lhs.str() == rhs;
+    }
+    friend bool operator==(std::string_view lhs, value_type const& rhs) {
+      return rhs == lhs;
+    }
+    friend bool operator!=(value_type const& lhs, std::string_view rhs) {
+      return !(lhs == rhs);
+    }
+    friend bool operator!=(std::string_view lhs, value_type const& rhs) {
+      return !(rhs == lhs);
+    }
+    friend std::ostream& operator<<(std::ostream& os, value_type const& rhs) {
+      if (!rhs.file_) return os << rhs.str();
+      return os << "<file segment offset=" << rhs.file_->offset
+                << ", size=" << rhs.file_->size << ">";
+    }
+
+   private:
+    void Unshare() {
+      if (!shared_) return;
+      data_ = *shared_;
+      shared_.reset();
+    }
+
+    std::string data_;
+    std::shared_ptr<std::string const> shared_;
+    std::optional<FileSegment> file_;
+  };
+
+  static std::uint64_t size(value_type const& body) { return body.size(); }
+
+  /// Serializes the body, reading file segments through a buffer.
+  class writer {
+   public:
+    using const_buffers_type = boost::asio::const_buffer;
+
+    template <bool IsRequest, class Fields>
+    writer(boost::beast::http::header<IsRequest, Fields> const& /*header*/,
+           value_type const& body)
+        : body_(body) {}
+
+    void init(boost::beast::error_code& ec);
+    boost::optional<std::pair<const_buffers_type, bool>> get(
+        boost::beast::error_code& ec);
+
+   private:
+    static auto constexpr kBufferSize = 64 * 1024;
+    value_type const& body_;
+    std::uint64_t remaining_ = 0;
+    std::unique_ptr<std::array<char, kBufferSize>> buffer_;
+  };
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_RESPONSE_BODY_H
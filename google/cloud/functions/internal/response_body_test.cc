@@ -0,0 +1,117 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/response_body.h"
+#include <boost/beast/http.hpp>
+#include <gmock/gmock.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace http = boost::beast::http;
+using ::testing::EndsWith;
+using ::testing::HasSubstr;
+
+std::string CreateTestFile(std::string const& contents) {
+  auto path = (std::filesystem::temp_directory_path() /
+               ("response_body_test_" + std::to_string(std::rand())))
+                  .string();
+  std::ofstream(path, std::ios::binary) << contents;
+  return path;
+}
+
+std::string Serialize(http::response<ResponseBody> response) {
+  response.prepare_payload();
+  std::ostringstream os;
+  os << response;
+  return std::move(os).str();
+}
+
+TEST(ResponseBodyTest, String) {
+  http::response<ResponseBody> response;
+  response.body() = std::string("Hello");
+  response.body() += " World";
+  EXPECT_EQ(response.body(), "Hello World");
+  EXPECT_EQ(response.body().file(), nullptr);
+  auto const actual = Serialize(response);
+  EXPECT_THAT(actual, HasSubstr("Content-Length: 11\r\n"));
+  EXPECT_THAT(actual, EndsWith("\r\n\r\nHello World"));
+}
+
+TEST(ResponseBodyTest, Shared) {
+  auto const payload = std::make_shared<std::string const>("Hello World");
+  http::response<ResponseBody> response;
+  response.body().set_shared(payload);
+  EXPECT_EQ(response.body().shared(), payload);
+  EXPECT_EQ(response.body().str().data(), payload->data());
+  EXPECT_EQ(response.body().size(), 11);
+  auto const actual = Serialize(response);
+  EXPECT_THAT(actual, HasSubstr("Content-Length: 11\r\n"));
+  EXPECT_THAT(actual, EndsWith("\r\n\r\nHello World"));
+
+  // Copies share the payload.
+  auto const copy = response;
+  EXPECT_EQ(copy.body().str().data(), payload->data());
+
+  // Modifying the payload copies it first.
+  response.body() += "!";
+  EXPECT_EQ(response.body(), "Hello World!");
+  EXPECT_EQ(response.body().shared(), nullptr);
+  EXPECT_EQ(*payload, "Hello World");
+
+  response.body().set_shared(nullptr);
+  EXPECT_TRUE(response.body().empty());
+  EXPECT_EQ(response.body(), "");
+}
+
+TEST(ResponseBodyTest, File) {
+  auto const path = CreateTestFile("0123456789");
+  http::response<ResponseBody> response;
+  response.body().set_file(OpenFileSegment(path, 0, std::nullopt));
+  ASSERT_NE(response.body().file(), nullptr);
+  EXPECT_EQ(response.body().size(), 10);
+  EXPECT_EQ(response.body().str(), "");
+  auto actual = Serialize(response);
+  EXPECT_THAT(actual, HasSubstr("Content-Length: 10\r\n"));
+  EXPECT_THAT(actual, EndsWith("\r\n\r\n0123456789"));
+
+  response.body().set_file(OpenFileSegment(path, 2, 5));
+  actual = Serialize(response);
+  EXPECT_THAT(actual, HasSubstr("Content-Length: 5\r\n"));
+  EXPECT_THAT(actual, EndsWith("\r\n\r\n23456"));
+
+  response.body() = std::string("replaced");
+  EXPECT_EQ(response.body().file(), nullptr);
+  EXPECT_EQ(response.body(), "replaced");
+  std::remove(path.c_str());
+}
+
+TEST(ResponseBodyTest, OpenFileSegmentErrors) {
+  auto const path = CreateTestFile("0123456789");
+  EXPECT_THROW(OpenFileSegment(path + ".not-found", 0, std::nullopt),
+               std::runtime_error);
+  EXPECT_THROW(OpenFileSegment(path, 11, std::nullopt), std::invalid_argument);
+  EXPECT_THROW(OpenFileSegment(path, 5, 6), std::invalid_argument);
+  EXPECT_NO_THROW(OpenFileSegment(path, 10, std::nullopt));
+  std::remove(path.c_str());
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
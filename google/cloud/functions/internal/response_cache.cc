@@ -0,0 +1,287 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/response_cache.h"
+#include <boost/beast/core/string.hpp>
+#include <algorithm>
+#include <charconv>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace be = ::boost::beast;
+
+/// Approximates the memory used by an entry, besides its header and payload.
+auto constexpr kEntryOverhead = std::size_t{256};
+
+std::string_view Trim(std::string_view s) {
+  auto const b = s.find_first_not_of(" \t");
+  if (b == std::string_view::npos) return {};
+  auto const e = s.find_last_not_of(" \t");
+  return s.substr(b, e - b + 1);
+}
+
+/// Calls @p f with each element in the comma separated values of @p name.
+template <typename Fields, typename Function>
+void ForEachElement(Fields const& fields, be::http::field name, Function f) {
+  auto const [begin, end] = fields.equal_range(name);
+  for (auto h = begin; h != end; ++h) {
+    auto list = std::string_view(h->value().data(), h->value().size());
+    while (!list.empty()) {
+      auto const comma = list.find(',');
+      auto const element = Trim(list.substr(0, comma));
+      if (!element.empty()) f(element);
+      if (comma == std::string_view::npos) break;
+      list.remove_prefix(comma + 1);
+    }
+  }
+}
+
+/// A `Cache-Control` directive, e.g. `max-age=60`.
+struct Directive {
+  std::string_view name;
+  std::string_view value;
+};
+
+Directive ParseDirective(std::string_view element) {
+  auto const eq = element.find('=');
+  if (eq == std::string_view::npos) return {element, {}};
+  auto value = Trim(element.substr(eq + 1));
+  if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+    value = value.substr(1, value.size() - 2);
+  }
+  return {Trim(element.substr(0, eq)), value};
+}
+
+std::optional<std::int64_t> ParseSeconds(std::string_view value) {
+  std::int64_t seconds = 0;
+  auto const* end = value.data() + value.size();
+  auto const r = std::from_chars(value.data(), end, seconds);
+  if (value.empty() || r.ec != std::errc() || r.ptr != end) return std::nullopt;
+  return seconds;
+}
+
+/// The statuses cacheable by default, see RFC 9110, section 15.1.
+bool IsCacheableStatus(unsigned status) {
+  switch (status) {
+    case 200:
+    case 203:
+    case 204:
+    case 300:
+    case 301:
+    case 308:
+    case 404:
+    case 405:
+    case 410:
+    case 414:
+    case 501:
+      return true;
+    default:
+      return false;
+  }
+}
+
+enum class CacheUse { kSkip, kRefresh, kLookup };
+
+CacheUse GetCacheUse(BeastRequest const& request) {
+  // Responses to authenticated requests are private by default.
+  if (request.count(be::http::field::authorization) != 0) {
+    return CacheUse::kSkip;
+  }
+  auto use = CacheUse::kLookup;
+  ForEachElement(request, be::http::field::cache_control,
+                 [&use](std::string_view element) {
+                   auto const d = ParseDirective(element);
+                   if (be::iequals(d.name, "no-store")) {
+                     use = CacheUse::kSkip;
+                   } else if (use == CacheUse::kLookup &&
+                              (be::iequals(d.name, "no-cache") ||
+                               (be::iequals(d.name, "max-age") &&
+                                ParseSeconds(d.value) == 0))) {
+                     use = CacheUse::kRefresh;
+                   }
+                 });
+  return use;
+}
+
+}  // namespace
+
+std::optional<std::chrono::seconds> ResponseCacheLifetime(
+    BeastResponse const& response, std::vector<std::string> const& headers) {
+  if (!IsCacheableStatus(response.result_int())) return std::nullopt;
+  if (response.count(be::http::field::set_cookie) != 0) return std::nullopt;
+  bool cacheable = true;
+  ForEachElement(response, be::http::field::vary,
+                 [&](std::string_view element) {
+                   cacheable = cacheable &&
+                               std::any_of(headers.begin(), headers.end(),
+                                           [&](std::string const& h) {
+                                             return be::iequals(h, element);
+                                           });
+                 });
+  std::optional<std::int64_t> max_age;
+  std::optional<std::int64_t> s_maxage;
+  ForEachElement(response, be::http::field::cache_control,
+                 [&](std::string_view element) {
+                   auto const d = ParseDirective(element);
+                   if (be::iequals(d.name, "no-store") ||
+                       be::iequals(d.name, "no-cache") ||
+                       be::iequals(d.name, "private")) {
+                     cacheable = false;
+                   } else if (be::iequals(d.name, "max-age")) {
+                     max_age = ParseSeconds(d.value);
+                   } else if (be::iequals(d.name, "s-maxage")) {
+                     s_maxage = ParseSeconds(d.value);
+                   }
+                 });
+  // A shared cache prefers `s-maxage`.
+  auto const lifetime = s_maxage ? s_maxage : max_age;
+  if (!cacheable || !lifetime || *lifetime <= 0) return std::nullopt;
+  return std::chrono::seconds(*lifetime);
+}
+
+ResponseCache::ResponseCache(std::size_t max_bytes, std::size_t shards,
+                             NowFunction now)
+    : shard_capacity_(max_bytes / std::max(shards, std::size_t{1})),
+      now_(std::move(now)) {
+  shards_.resize(std::max(shards, std::size_t{1}));
+  for (auto& s : shards_) s = std::make_unique<Shard>();
+}
+
+std::optional<BeastResponse> ResponseCache::Lookup(std::string const& key) {
+  auto& shard = ShardFor(key);
+  auto const now = now_();
+  std::lock_guard<std::mutex> lk(shard.mu);
+  auto l = shard.index.find(key);
+  if (l == shard.index.end()) return std::nullopt;
+  auto const i = l->second;
+  if (i->expires <= now) {
+    Erase(shard, i);
+    return std::nullopt;
+  }
+  shard.entries.splice(shard.entries.begin(), shard.entries, i);
+  auto response = i->response;
+  auto const age =
+      std::chrono::duration_cast<std::chrono::seconds>(now - i->stored);
+  response.set(be::http::field::age, std::to_string(age.count()));
+  return response;
+}
+
+void ResponseCache::Insert(std::string const& key, BeastResponse& response,
+                           std::chrono::seconds lifetime) {
+  auto& body = response.body();
+  if (body.file() != nullptr) return;
+  if (!body.shared()) {
+    body.set_shared(
+        std::make_shared<std::string const>(std::move(body).str()));
+  }
+  auto bytes = kEntryOverhead + 2 * key.size() + body.size();
+  for (auto const& f : response) {
+    bytes += f.name_string().size() + f.value().size();
+  }
+  if (bytes > shard_capacity_) return;
+
+  auto& shard = ShardFor(key);
+  auto const now = now_();
+  std::lock_guard<std::mutex> lk(shard.mu);
+  if (auto l = shard.index.find(key); l != shard.index.end()) {
+    Erase(shard, l->second);
+  }
+  shard.entries.push_front(Entry{key, response, bytes, now, now + lifetime});
+  shard.index.emplace(shard.entries.front().key, shard.entries.begin());
+  shard.bytes += bytes;
+  while (shard.bytes > shard_capacity_) {
+    Erase(shard, std::prev(shard.entries.end()));
+  }
+}
+
+std::size_t ResponseCache::size() const {
+  std::size_t count = 0;
+  for (auto const& s : shards_) {
+    std::lock_guard<std::mutex> lk(s->mu);
+    count += s->entries.size();
+  }
+  return count;
+}
+
+std::size_t ResponseCache::bytes() const {
+  std::size_t bytes = 0;
+  for (auto const& s : shards_) {
+    std::lock_guard<std::mutex> lk(s->mu);
+    bytes += s->bytes;
+  }
+  return bytes;
+}
+
+ResponseCache::Shard& ResponseCache::ShardFor(std::string const& key) {
+  return *shards_[std::hash<std::string>{}(key) % shards_.size()];
+}
+
+void ResponseCache::Erase(Shard& shard, List::iterator i) {
+  shard.bytes -= i->bytes;
+  shard.index.erase(i->key);
+  shard.entries.erase(i);
+}
+
+Handler MakeResponseCacheHandler(Handler handler, CoalescingKey key,
+                                 std::vector<std::string> headers,
+                                 std::shared_ptr<ResponseCache> cache) {
+  return [handler = std::move(handler), key = std::move(key),
+          headers = std::move(headers),
+          cache = std::move(cache)](BeastRequest request) {
+    auto k = key(request);
+    if (!k) return handler(std::move(request));
+    auto const use = GetCacheUse(request);
+    if (use == CacheUse::kSkip) return handler(std::move(request));
+    if (use == CacheUse::kLookup) {
+      if (auto hit = cache->Lookup(*k)) return *std::move(hit);
+    }
+    auto response = handler(std::move(request));
+    if (auto lifetime = ResponseCacheLifetime(response, headers)) {
+      cache->Insert(*k, response, *lifetime);
+    }
+    return response;
+  };
+}
+
+AsyncHandler MakeResponseCacheAsyncHandler(
+    AsyncHandler handler, CoalescingKey key, std::vector<std::string> headers,
+    std::shared_ptr<ResponseCache> cache) {
+  return [handler = std::move(handler), key = std::move(key),
+          headers = std::move(headers), cache = std::move(cache)](
+             BeastRequest request, AsyncResponseCallback done) {
+    auto k = key(request);
+    if (!k) return handler(std::move(request), std::move(done));
+    auto const use = GetCacheUse(request);
+    if (use == CacheUse::kSkip) {
+      return handler(std::move(request), std::move(done));
+    }
+    if (use == CacheUse::kLookup) {
+      if (auto hit = cache->Lookup(*k)) return done(*std::move(hit));
+    }
+    handler(std::move(request),
+            [k = *std::move(k), headers, cache,
+             done = std::move(done)](BeastResponse response) {
+              if (auto lifetime = ResponseCacheLifetime(response, headers)) {
+                cache->Insert(k, response, *lifetime);
+              }
+              done(std::move(response));
+            });
+  };
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
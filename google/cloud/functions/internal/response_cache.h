@@ -0,0 +1,127 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_RESPONSE_CACHE_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_RESPONSE_CACHE_H
+
+#include "google/cloud/functions/internal/coalescing.h"
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/version.h"
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Returns how long a shared cache may reuse @p response.
+ *
+ * Uses `s-maxage`, or `max-age`, from the `Cache-Control` header. Returns an
+ * empty optional if the response must not be cached: it has no lifetime, it
+ * is `private`, `no-store`, or `no-cache`, it sets cookies, its status is not
+ * cacheable, or it varies on headers other than @p headers. The header names
+ * in @p headers must be lowercase.
+ */
+std::optional<std::chrono::seconds> ResponseCacheLifetime(
+    BeastResponse const& response, std::vector<std::string> const& headers);
+
+/**
+ * A sharded, memory-bounded LRU cache of responses, see
+ * `functions::WithResponseCache()`.
+ *
+ * Each shard has its own lock, and an equal part of the memory budget. The
+ * cached payloads are shared, immutable buffers, the hits copy the header
+ * only.
+ */
+class ResponseCache {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using NowFunction = std::function<Clock::time_point()>;
+
+  ResponseCache(std::size_t max_bytes, std::size_t shards,
+                NowFunction now = Clock::now);
+
+  /// Returns the fresh response for @p key, with an `Age` header, if any.
+  std::optional<BeastResponse> Lookup(std::string const& key);
+
+  /**
+   * Keeps @p response for @p key during @p lifetime.
+   *
+   * Moves the payload of @p response to a shared buffer, so the caller sends
+   * the same buffer as the cache. Responses larger than a shard, or with a
+   * file payload, are not kept.
+   */
+  void Insert(std::string const& key, BeastResponse& response,
+              std::chrono::seconds lifetime);
+
+  /// The number of cached responses.
+  [[nodiscard]] std::size_t size() const;
+
+  /// The memory used by the cached responses, approximately.
+  [[nodiscard]] std::size_t bytes() const;
+
+ private:
+  struct Entry {
+    std::string key;
+    BeastResponse response;
+    std::size_t bytes;
+    Clock::time_point stored;
+    Clock::time_point expires;
+  };
+  using List = std::list<Entry>;
+  struct Shard {
+    mutable std::mutex mu;
+    /// The most recently used entries first.
+    List entries;
+    std::unordered_map<std::string_view, List::iterator> index;
+    std::size_t bytes = 0;
+  };
+
+  Shard& ShardFor(std::string const& key);
+  static void Erase(Shard& shard, List::iterator i);
+
+  std::size_t const shard_capacity_;
+  NowFunction const now_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+/**
+ * Returns handlers that serve the responses of @p handler from @p cache.
+ *
+ * Only requests with a key, see `MakeCoalescingKey()`, use the cache. Requests
+ * with `Authorization` or `Cache-Control: no-store` skip it, requests with
+ * `Cache-Control: no-cache` or `max-age=0` refresh it. @p headers are the
+ * lowercase names of the headers in the key.
+ */
+Handler MakeResponseCacheHandler(Handler handler, CoalescingKey key,
+                                 std::vector<std::string> headers,
+                                 std::shared_ptr<ResponseCache> cache);
+AsyncHandler MakeResponseCacheAsyncHandler(
+    AsyncHandler handler, CoalescingKey key, std::vector<std::string> headers,
+    std::shared_ptr<ResponseCache> cache);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_RESPONSE_CACHE_H
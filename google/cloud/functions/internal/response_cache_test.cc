@@ -0,0 +1,186 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/response_cache.h"
+#include <gmock/gmock.h>
+#include <string>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace http = ::boost::beast::http;
+using ::testing::Optional;
+
+BeastResponse MakeResponse(std::string cache_control,
+                           std::string payload = "payload") {
+  BeastResponse response;
+  response.result(http::status::ok);
+  if (!cache_control.empty()) {
+    response.set(http::field::cache_control, std::move(cache_control));
+  }
+  response.body() = std::move(payload);
+  return response;
+}
+
+TEST(ResponseCacheTest, Lifetime) {
+  auto const lifetime = [](std::string cache_control) {
+    return ResponseCacheLifetime(MakeResponse(std::move(cache_control)), {});
+  };
+  EXPECT_THAT(lifetime("max-age=60"), Optional(std::chrono::seconds(60)));
+  EXPECT_THAT(lifetime("public, Max-Age=\"60\""),
+              Optional(std::chrono::seconds(60)));
+  EXPECT_THAT(lifetime("max-age=60, s-maxage=10"),
+              Optional(std::chrono::seconds(10)));
+  EXPECT_FALSE(lifetime("").has_value());
+  EXPECT_FALSE(lifetime("max-age=0").has_value());
+  EXPECT_FALSE(lifetime("max-age=x").has_value());
+  EXPECT_FALSE(lifetime("max-age=60, private").has_value());
+  EXPECT_FALSE(lifetime("no-store, max-age=60").has_value());
+  EXPECT_FALSE(lifetime("max-age=60, no-cache").has_value());
+
+  auto response = MakeResponse("max-age=60");
+  response.result(http::status::internal_server_error);
+  EXPECT_FALSE(ResponseCacheLifetime(response, {}).has_value());
+  response.result(http::status::not_found);
+  EXPECT_TRUE(ResponseCacheLifetime(response, {}).has_value());
+  response.set(http::field::set_cookie, "a=b");
+  EXPECT_FALSE(ResponseCacheLifetime(response, {}).has_value());
+}
+
+TEST(ResponseCacheTest, LifetimeVary) {
+  auto response = MakeResponse("max-age=60");
+  response.set(http::field::vary, "Accept, accept-language");
+  EXPECT_FALSE(ResponseCacheLifetime(response, {"accept"}).has_value());
+  EXPECT_TRUE(ResponseCacheLifetime(response, {"accept", "accept-language"}));
+  response.set(http::field::vary, "*");
+  EXPECT_FALSE(ResponseCacheLifetime(response, {"accept"}).has_value());
+}
+
+TEST(ResponseCacheTest, SharedPayload) {
+  ResponseCache cache(1024 * 1024, 4);
+  auto response = MakeResponse("max-age=60");
+  cache.Insert("k", response, std::chrono::seconds(60));
+  ASSERT_TRUE(response.body().shared());
+  EXPECT_EQ(response.body(), "payload");
+
+  auto hit = cache.Lookup("k");
+  ASSERT_TRUE(hit.has_value());
+  EXPECT_EQ(hit->body().shared(), response.body().shared());
+  EXPECT_EQ(hit->body(), "payload");
+  EXPECT_EQ((*hit)[http::field::cache_control], "max-age=60");
+  EXPECT_FALSE(cache.Lookup("other").has_value());
+}
+
+TEST(ResponseCacheTest, Expiration) {
+  auto now = ResponseCache::Clock::time_point{};
+  ResponseCache cache(1024 * 1024, 1, [&now] { return now; });
+  auto response = MakeResponse("max-age=10");
+  cache.Insert("k", response, std::chrono::seconds(10));
+
+  now += std::chrono::seconds(4);
+  auto hit = cache.Lookup("k");
+  ASSERT_TRUE(hit.has_value());
+  EXPECT_EQ((*hit)[http::field::age], "4");
+
+  now += std::chrono::seconds(6);
+  EXPECT_FALSE(cache.Lookup("k").has_value());
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_EQ(cache.bytes(), 0);
+}
+
+TEST(ResponseCacheTest, EvictsLeastRecentlyUsed) {
+  auto const payload = std::string(1000, 'x');
+  ResponseCache cache(3000, 1);
+  for (auto const* key : {"a", "b"}) {
+    auto response = MakeResponse("max-age=60", payload);
+    cache.Insert(key, response, std::chrono::seconds(60));
+  }
+  EXPECT_EQ(cache.size(), 2);
+  // Using "a" makes "b" the least recently used.
+  EXPECT_TRUE(cache.Lookup("a").has_value());
+  auto response = MakeResponse("max-age=60", payload);
+  cache.Insert("c", response, std::chrono::seconds(60));
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_LE(cache.bytes(), 3000);
+  EXPECT_TRUE(cache.Lookup("a").has_value());
+  EXPECT_FALSE(cache.Lookup("b").has_value());
+  EXPECT_TRUE(cache.Lookup("c").has_value());
+
+  // Responses larger than a shard are not cached.
+  auto large = MakeResponse("max-age=60", std::string(4000, 'x'));
+  cache.Insert("large", large, std::chrono::seconds(60));
+  EXPECT_FALSE(cache.Lookup("large").has_value());
+  EXPECT_EQ(large.body().size(), 4000);
+}
+
+TEST(ResponseCacheTest, Handler) {
+  int calls = 0;
+  auto cache = std::make_shared<ResponseCache>(1024 * 1024, 4);
+  auto handler = MakeResponseCacheHandler(
+      [&calls](BeastRequest const&) {
+        ++calls;
+        return MakeResponse("max-age=60", std::to_string(calls));
+      },
+      MakeCoalescingKey({}), {}, cache);
+
+  BeastRequest request;
+  request.method(http::verb::get);
+  request.target("/a");
+  EXPECT_EQ(handler(request).body(), "1");
+  EXPECT_EQ(handler(request).body(), "1");
+
+  // Refreshes the cached response.
+  request.set(http::field::cache_control, "no-cache");
+  EXPECT_EQ(handler(request).body(), "2");
+  request.erase(http::field::cache_control);
+  EXPECT_EQ(handler(request).body(), "2");
+
+  request.set(http::field::cache_control, "no-store");
+  EXPECT_EQ(handler(request).body(), "3");
+  request.erase(http::field::cache_control);
+  request.set(http::field::authorization, "Bearer t");
+  EXPECT_EQ(handler(request).body(), "4");
+  request.erase(http::field::authorization);
+  EXPECT_EQ(handler(request).body(), "2");
+}
+
+TEST(ResponseCacheTest, AsyncHandler) {
+  std::vector<AsyncResponseCallback> pending;
+  auto cache = std::make_shared<ResponseCache>(1024 * 1024, 4);
+  auto handler = MakeResponseCacheAsyncHandler(
+      [&pending](BeastRequest const&, AsyncResponseCallback done) {
+        pending.push_back(std::move(done));
+      },
+      MakeCoalescingKey({}), {}, cache);
+
+  std::vector<std::string> responses;
+  auto done = [&responses](BeastResponse r) {
+    responses.push_back(r.body().str());
+  };
+  BeastRequest request;
+  request.method(http::verb::get);
+  request.target("/a");
+  handler(request, done);
+  ASSERT_EQ(pending.size(), 1);
+  pending[0](MakeResponse("max-age=60", "cached"));
+  handler(request, done);
+  EXPECT_EQ(pending.size(), 1);
+  EXPECT_THAT(responses, ::testing::ElementsAre("cached", "cached"));
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,163 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/server_state.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <iterator>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+void AppendFixed(std::string& out, double value) {
+  char buffer[32];
+  auto const r = std::to_chars(std::begin(buffer), std::end(buffer), value,
+                               std::chars_format::fixed, 3);
+  out.append(buffer, r.ptr);
+}
+
+void AppendMilliseconds(std::string& out, SessionStatus::Clock::duration d) {
+  AppendFixed(out, std::chrono::duration<double, std::milli>(d).count());
+}
+
+void AppendSeconds(std::string& out, SessionStatus::Clock::duration d) {
+  AppendFixed(out, std::chrono::duration<double>(d).count());
+}
+
+}  // namespace
+
+std::string_view SessionStateName(SessionState state) {
+  switch (state) {
+    case SessionState::kIdle:
+      return "idle";
+    case SessionState::kReading:
+      return "reading";
+    case SessionState::kQueued:
+      return "queued";
+    case SessionState::kRunning:
+      return "running";
+    case SessionState::kWriting:
+      return "writing";
+  }
+  return "unknown";
+}
+
+ServerState::ServerState(int threads, int pool_threads,
+                         std::size_t max_sessions)
+    : started_(Clock::now()),
+      threads_(threads),
+      pool_threads_(pool_threads),
+      max_sessions_(max_sessions) {}
+
+std::shared_ptr<SessionStatus> ServerState::OpenSession() {
+  auto status = std::make_unique<SessionStatus>(Clock::now());
+  std::lock_guard<std::mutex> lk(mu_);
+  auto const id = next_id_++;
+  sessions_.emplace(id, status.get());
+  return std::shared_ptr<SessionStatus>(status.release(),
+                                        [this, id](SessionStatus* s) {
+                                          CloseSession(id);
+                                          delete s;
+                                        });
+}
+
+void ServerState::CloseSession(std::uint64_t id) {
+  std::lock_guard<std::mutex> lk(mu_);
+  sessions_.erase(id);
+}
+
+void ServerState::AcceptPaused() {
+  std::lock_guard<std::mutex> lk(mu_);
+  ++accept_pauses_;
+  if (paused_listeners_++ == 0) paused_since_ = Clock::now();
+}
+
+void ServerState::AcceptResumed() {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (--paused_listeners_ == 0) paused_time_ += Clock::now() - paused_since_;
+}
+
+std::string ServerState::ToJson() const {
+  struct Session {
+    SessionState state;
+    Clock::time_point opened;
+    Clock::time_point since;
+    std::uint64_t requests;
+  };
+  std::vector<Session> sessions;
+  int paused_listeners;
+  std::uint64_t accept_pauses;
+  Clock::duration paused_time;
+  auto const now = Clock::now();
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    sessions.reserve(sessions_.size());
+    for (auto const& kv : sessions_) {
+      auto const& s = *kv.second;
+      sessions.push_back({s.state(), s.opened(), s.since(), s.requests()});
+    }
+    paused_listeners = paused_listeners_;
+    accept_pauses = accept_pauses_;
+    paused_time = paused_time_;
+    if (paused_listeners != 0) paused_time += now - paused_since_;
+  }
+
+  std::array<std::size_t, kSessionStateCount> counts{};
+  for (auto const& s : sessions) ++counts[static_cast<std::size_t>(s.state)];
+  // List the sessions that have been in their state the longest first, these
+  // are the most likely to be stuck.
+  std::sort(
+      sessions.begin(), sessions.end(),
+      [](Session const& a, Session const& b) { return a.since < b.since; });
+
+  std::string out = R"({"uptimeSeconds":)";
+  AppendSeconds(out, now - started_);
+  out += R"(,"eventLoopThreads":)" + std::to_string(threads_);
+  out += R"(,"sessions":{"open":)" + std::to_string(sessions.size());
+  for (std::size_t i = 0; i != kSessionStateCount; ++i) {
+    out += ",\"";
+    out += SessionStateName(static_cast<SessionState>(i));
+    out += "\":" + std::to_string(counts[i]);
+  }
+  out += R"(,"list":[)";
+  auto const listed = std::min(sessions.size(), kMaxListedSessions);
+  for (std::size_t i = 0; i != listed; ++i) {
+    auto const& s = sessions[i];
+    if (i != 0) out += ',';
+    out += R"({"state":")";
+    out += SessionStateName(s.state);
+    out += R"(","ageMs":)";
+    AppendMilliseconds(out, now - s.opened);
+    out += R"(,"stateMs":)";
+    AppendMilliseconds(out, now - s.since);
+    out += R"(,"requests":)" + std::to_string(s.requests) + "}";
+  }
+  out += "]}";
+  out += R"(,"pool":{"threads":)" + std::to_string(pool_threads_);
+  out += R"(,"busy":)" + std::to_string(pool_busy_.load());
+  out += R"(,"queued":)" + std::to_string(pool_queued_.load()) + "}";
+  out += R"(,"admission":{"maxSessions":)" + std::to_string(max_sessions_);
+  out += R"(,"pausedListeners":)" + std::to_string(paused_listeners);
+  out += R"(,"pauses":)" + std::to_string(accept_pauses);
+  out += R"(,"pausedSeconds":)";
+  AppendSeconds(out, paused_time);
+  out += "}}";
+  return out;
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
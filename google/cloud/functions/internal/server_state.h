@@ -0,0 +1,152 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_SERVER_STATE_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_SERVER_STATE_H
+
+#include "google/cloud/functions/version.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// What a session is doing.
+enum class SessionState {
+  /// Waiting for the next request.
+  kIdle,
+  /// Reading a request.
+  kReading,
+  /// Waiting for a thread to run the handler.
+  kQueued,
+  /// Running the handler.
+  kRunning,
+  /// Sending a response.
+  kWriting,
+};
+
+inline constexpr std::size_t kSessionStateCount = 5;
+
+/// The name of @p state in `/debug/server` reports.
+std::string_view SessionStateName(SessionState state);
+
+/**
+ * The state of a session, as reported by `/debug/server`.
+ *
+ * The session updates its state from its strand, or from the thread running
+ * its handler, and the reports read it from any thread.
+ */
+class SessionStatus {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit SessionStatus(Clock::time_point opened)
+      : opened_(opened), since_(opened.time_since_epoch().count()) {}
+
+  void set_state(SessionState state, Clock::time_point now) {
+    state_.store(state, std::memory_order_relaxed);
+    since_.store(now.time_since_epoch().count(), std::memory_order_relaxed);
+  }
+  void OnRequest() { requests_.fetch_add(1, std::memory_order_relaxed); }
+
+  [[nodiscard]] SessionState state() const {
+    return state_.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] Clock::time_point opened() const { return opened_; }
+  /// When the session entered its current state.
+  [[nodiscard]] Clock::time_point since() const {
+    return Clock::time_point(
+        Clock::duration(since_.load(std::memory_order_relaxed)));
+  }
+  [[nodiscard]] std::uint64_t requests() const {
+    return requests_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  Clock::time_point const opened_;
+  std::atomic<SessionState> state_{SessionState::kIdle};
+  std::atomic<Clock::rep> since_;
+  std::atomic<std::uint64_t> requests_{0};
+};
+
+/**
+ * Tracks the sessions, the handler threads, and the accept loops.
+ *
+ * Only created with `--debug-server`, the sessions and listeners do not
+ * update any state otherwise.
+ */
+class ServerState {
+ public:
+  using Clock = SessionStatus::Clock;
+
+  ServerState(int threads, int pool_threads, std::size_t max_sessions);
+
+  /// Registers a session, it is removed once the result is released.
+  std::shared_ptr<SessionStatus> OpenSession();
+
+  /// Called when a task is posted to the streaming pool, and once it starts
+  /// and ends.
+  ///@{
+  void PoolTaskQueued() { pool_queued_.fetch_add(1); }
+  void PoolTaskStarted() {
+    pool_queued_.fetch_sub(1);
+    pool_busy_.fetch_add(1);
+  }
+  void PoolTaskDone() { pool_busy_.fetch_sub(1); }
+  ///@}
+
+  /// Called when a listener stops, or resumes, accepting connections because
+  /// it reached `--max-sessions`.
+  ///@{
+  void AcceptPaused();
+  void AcceptResumed();
+  ///@}
+
+  /// Formats the report, in JSON format.
+  [[nodiscard]] std::string ToJson() const;
+
+  /// The maximum number of sessions listed in the report, the counts include
+  /// all the sessions.
+  static std::size_t constexpr kMaxListedSessions = 100;
+
+ private:
+  void CloseSession(std::uint64_t id);
+
+  Clock::time_point const started_;
+  int const threads_;
+  int const pool_threads_;
+  std::size_t const max_sessions_;
+  std::atomic<std::int64_t> pool_queued_{0};
+  std::atomic<std::int64_t> pool_busy_{0};
+
+  mutable std::mutex mu_;
+  std::uint64_t next_id_ = 0;
+  std::map<std::uint64_t, SessionStatus*> sessions_;
+  int paused_listeners_ = 0;
+  std::uint64_t accept_pauses_ = 0;
+  Clock::time_point paused_since_;
+  Clock::duration paused_time_{};
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_SERVER_STATE_H
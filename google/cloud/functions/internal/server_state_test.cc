@@ -0,0 +1,102 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/server_state.h"
+#include <gmock/gmock.h>
+#include <nlohmann/json.hpp>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+TEST(ServerStateTest, StateName) {
+  EXPECT_EQ(SessionStateName(SessionState::kIdle), "idle");
+  EXPECT_EQ(SessionStateName(SessionState::kReading), "reading");
+  EXPECT_EQ(SessionStateName(SessionState::kQueued), "queued");
+  EXPECT_EQ(SessionStateName(SessionState::kRunning), "running");
+  EXPECT_EQ(SessionStateName(SessionState::kWriting), "writing");
+}
+
+TEST(ServerStateTest, Sessions) {
+  ServerState state(4, 2, 100);
+  auto const now = SessionStatus::Clock::now();
+  auto idle = state.OpenSession();
+  auto running = state.OpenSession();
+  running->OnRequest();
+  running->set_state(SessionState::kRunning, now - std::chrono::seconds(5));
+  {
+    auto closed = state.OpenSession();
+  }
+
+  auto const report = nlohmann::json::parse(state.ToJson());
+  EXPECT_EQ(report.value("eventLoopThreads", 0), 4);
+  auto const& sessions = report["sessions"];
+  EXPECT_EQ(sessions.value("open", 0), 2);
+  EXPECT_EQ(sessions.value("idle", 0), 1);
+  EXPECT_EQ(sessions.value("running", 0), 1);
+  EXPECT_EQ(sessions.value("reading", -1), 0);
+  auto const& list = sessions["list"];
+  ASSERT_EQ(list.size(), 2);
+  // The sessions in their state the longest are listed first.
+  EXPECT_EQ(list[0].value("state", ""), "running");
+  EXPECT_GE(list[0].value("stateMs", 0.0), 5000.0);
+  EXPECT_EQ(list[0].value("requests", 0), 1);
+  EXPECT_EQ(list[1].value("state", ""), "idle");
+
+  idle.reset();
+  running.reset();
+  auto const empty = nlohmann::json::parse(state.ToJson());
+  EXPECT_EQ(empty["sessions"].value("open", -1), 0);
+  EXPECT_TRUE(empty["sessions"]["list"].empty());
+}
+
+TEST(ServerStateTest, ListLimit) {
+  ServerState state(1, 0, 0);
+  std::vector<std::shared_ptr<SessionStatus>> sessions;
+  for (std::size_t i = 0; i != ServerState::kMaxListedSessions + 10; ++i) {
+    sessions.push_back(state.OpenSession());
+  }
+  auto const report = nlohmann::json::parse(state.ToJson());
+  EXPECT_EQ(report["sessions"].value("open", 0u), sessions.size());
+  EXPECT_EQ(report["sessions"]["list"].size(),
+            ServerState::kMaxListedSessions);
+}
+
+TEST(ServerStateTest, PoolAndAdmission) {
+  ServerState state(1, 2, 8);
+  state.PoolTaskQueued();
+  state.PoolTaskQueued();
+  state.PoolTaskStarted();
+  state.AcceptPaused();
+
+  auto report = nlohmann::json::parse(state.ToJson());
+  auto const expected_pool =
+      nlohmann::json{{"threads", 2}, {"busy", 1}, {"queued", 1}};
+  EXPECT_EQ(report["pool"], expected_pool);
+  EXPECT_EQ(report["admission"].value("maxSessions", 0), 8);
+  EXPECT_EQ(report["admission"].value("pausedListeners", 0), 1);
+  EXPECT_EQ(report["admission"].value("pauses", 0), 1);
+
+  state.PoolTaskDone();
+  state.AcceptResumed();
+  report = nlohmann::json::parse(state.ToJson());
+  EXPECT_EQ(report["pool"].value("busy", -1), 0);
+  EXPECT_EQ(report["admission"].value("pausedListeners", -1), 0);
+  EXPECT_GE(report["admission"].value("pausedSeconds", -1.0), 0.0);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
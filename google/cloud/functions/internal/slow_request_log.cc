@@ -0,0 +1,152 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/slow_request_log.h"
+#include "google/cloud/functions/internal/json_writer.h"
+#include <array>
+#include <charconv>
+#include <iterator>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+void AppendFixed(std::string& out, double value) {
+  char buffer[32];
+  auto const r = std::to_chars(std::begin(buffer), std::end(buffer), value,
+                               std::chars_format::fixed, 3);
+  out.append(buffer, r.ptr);
+}
+
+void AppendMilliseconds(std::string& out, RequestTiming::Clock::duration d) {
+  AppendFixed(out, std::chrono::duration<double, std::milli>(d).count());
+}
+
+/// The message and fields of a slow request entry.
+struct SlowRequestEntry {
+  SlowRequestEntry(RequestRecord const& record,
+                   RequestTiming::Clock::duration latency,
+                   std::uint64_t suppressed)
+      : message("Slow request: " + record.method + " " + record.target),
+        requests(std::to_string(record.connection_requests)),
+        dropped(std::to_string(suppressed)) {
+    http = R"({"requestMethod":)";
+    JsonAppendString(http, record.method);
+    http += R"(,"requestUrl":)";
+    JsonAppendString(http, record.target);
+    http += R"(,"requestSize":")" + std::to_string(record.request_size);
+    http += R"(","responseSize":")" + std::to_string(record.response_size);
+    http += R"(","status":)" + std::to_string(record.status);
+    http += R"(,"latency":")";
+    AppendFixed(http, std::chrono::duration<double>(latency).count());
+    http += R"(s"})";
+
+    phases = "{";
+    for (std::size_t i = 0; i != kRequestPhaseCount; ++i) {
+      auto const phase = static_cast<RequestPhase>(i);
+      if (i != 0) phases += ',';
+      JsonAppendString(phases, RequestPhaseName(phase));
+      phases += ':';
+      AppendMilliseconds(phases, record.timing.duration(phase));
+    }
+    phases += '}';
+
+    cpu = "{";
+    for (auto phase : kHandlerPhases) {
+      if (cpu.size() != 1) cpu += ',';
+      JsonAppendString(cpu, RequestPhaseName(phase));
+      cpu += ':';
+      AppendMilliseconds(cpu, record.timing.cpu_time(phase));
+    }
+    cpu += '}';
+
+    fields[0] = LogField{"httpRequest", http};
+    fields[1] = LogField{"phasesMs", phases};
+    fields[2] = LogField{"cpuMs", cpu};
+    fields[3] = LogField{"connectionRequests", requests};
+    fields[4] = LogField{"suppressed", dropped};
+    if (!record.timing.route().empty()) {
+      JsonAppendString(route, record.timing.route());
+      fields[size++] = LogField{"route", route};
+    }
+    if (!record.timing.event_type().empty()) {
+      JsonAppendString(event_type, record.timing.event_type());
+      fields[size++] = LogField{"eventType", event_type};
+    }
+    if (!AllocationCountingEnabled()) return;
+    allocations = "{";
+    for (auto phase : kHandlerPhases) {
+      if (allocations.size() != 1) allocations += ',';
+      JsonAppendString(allocations, RequestPhaseName(phase));
+      auto const counts = record.timing.allocations(phase);
+      allocations += R"(:{"count":)" + std::to_string(counts.count) +
+                     R"(,"bytes":)" + std::to_string(counts.bytes) + "}";
+    }
+    allocations += '}';
+    fields[size++] = LogField{"allocations", allocations};
+  }
+
+  [[nodiscard]] absl::Span<LogField const> span() const {
+    return {fields.data(), size};
+  }
+
+  // The fields refer to the strings below.
+  SlowRequestEntry(SlowRequestEntry const&) = delete;
+  SlowRequestEntry& operator=(SlowRequestEntry const&) = delete;
+
+  std::string message;
+  std::string http;
+  std::string phases;
+  std::string cpu;
+  std::string requests;
+  std::string dropped;
+  std::string route;
+  std::string event_type;
+  std::string allocations;
+  std::array<LogField, 8> fields;
+  std::size_t size = 5;
+};
+
+}  // namespace
+
+SlowRequestLog::SlowRequestLog(std::chrono::milliseconds threshold,
+                               int max_per_second)
+    : threshold_(threshold), throttle_(max_per_second) {}
+
+void SlowRequestLog::Record(RequestRecord const& record,
+                            Clock::time_point now) {
+  auto const latency = now - record.start;
+  if (latency < threshold_) return;
+  // Only slow requests get here, the lock is not contended in normal
+  // operation.
+  auto const suppressed = throttle_.Acquire(now);
+  if (!suppressed) return;
+  SlowRequestEntry e(record, latency, *suppressed);
+  WriteLog(functions::LogSeverity::kWarning, e.message, e.span(),
+           &record.log_context);
+}
+
+std::string SlowRequestLog::FormatEntry(RequestRecord const& record,
+                                        Clock::duration latency,
+                                        std::uint64_t suppressed) {
+  std::string entry;
+  SlowRequestEntry e(record, latency, suppressed);
+  FormatLogEntry(entry, functions::LogSeverity::kWarning, e.message, e.span(),
+                 &record.log_context);
+  return entry;
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,85 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_SLOW_REQUEST_LOG_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_SLOW_REQUEST_LOG_H
+
+#include "google/cloud/functions/internal/flight_recorder.h"
+#include "google/cloud/functions/internal/log_throttle.h"
+#include "google/cloud/functions/internal/request_timing.h"
+#include "google/cloud/functions/internal/structured_log.h"
+#include "google/cloud/functions/version.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// A request, as tracked by its session.
+struct RequestRecord {
+  using Clock = RequestTiming::Clock;
+
+  RequestTiming timing;
+  /// When the first byte of the request was received.
+  Clock::time_point start;
+  /// When the request was completely read.
+  Clock::time_point read_done;
+  std::string method;
+  std::string target;
+  std::uint64_t request_size = 0;
+  unsigned status = 0;
+  std::uint64_t response_size = 0;
+  /// The number of requests received by the connection before this one.
+  std::uint64_t connection_requests = 0;
+  LogContext log_context;
+  /// The flight recorder slot of the request, while it is in progress.
+  FlightRecorder::InFlight in_flight;
+};
+
+/**
+ * Logs the requests slower than a threshold.
+ *
+ * Each slow request produces a single structured log entry, with its
+ * `httpRequest` attributes, the time in each phase, and how many requests
+ * the connection served before. At most @p max_per_second entries are
+ * written each second, the next entry reports how many were suppressed.
+ */
+class SlowRequestLog {
+ public:
+  using Clock = RequestTiming::Clock;
+
+  SlowRequestLog(std::chrono::milliseconds threshold, int max_per_second);
+
+  [[nodiscard]] std::chrono::milliseconds threshold() const {
+    return threshold_;
+  }
+
+  /// Logs @p record if it is slow, and not rate limited.
+  void Record(RequestRecord const& record, Clock::time_point now);
+
+  /// Formats the (JSON) entry for @p record, including the request context.
+  static std::string FormatEntry(RequestRecord const& record,
+                                 Clock::duration latency,
+                                 std::uint64_t suppressed);
+
+ private:
+  std::chrono::milliseconds threshold_;
+  LogThrottle throttle_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_SLOW_REQUEST_LOG_H
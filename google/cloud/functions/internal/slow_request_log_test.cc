@@ -0,0 +1,129 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/slow_request_log.h"
+#include "google/cloud/functions/testing_util/capture_stderr.h"
+#include <gmock/gmock.h>
+#include <nlohmann/json.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ms = std::chrono::milliseconds;
+
+RequestRecord MakeRecord() {
+  RequestRecord record;
+  record.start = RequestRecord::Clock::time_point{} + std::chrono::hours(1);
+  record.method = "POST";
+  record.target = "/slow?q=1";
+  record.request_size = 10;
+  record.status = 200;
+  record.response_size = 1234;
+  record.connection_requests = 3;
+  record.timing.Add(RequestPhase::kRead, std::chrono::microseconds(1500));
+  record.timing.Add(RequestPhase::kQueue, ms(2));
+  record.timing.Add(RequestPhase::kFunction, ms(250));
+  return record;
+}
+
+std::vector<nlohmann::json> Lines(std::string const& text) {
+  std::vector<nlohmann::json> lines;
+  std::istringstream is(text);
+  for (std::string line; std::getline(is, line);) {
+    lines.push_back(nlohmann::json::parse(line));
+  }
+  return lines;
+}
+
+TEST(SlowRequestLogTest, Format) {
+  auto record = MakeRecord();
+  record.log_context.trace_id = "4bf92f3577b34da6a3ce929d0e0e4736";
+  record.log_context.execution_id = "exec-123";
+  auto const entry = nlohmann::json::parse(
+      SlowRequestLog::FormatEntry(record, ms(1250), 7));
+
+  EXPECT_EQ(entry.value("severity", ""), "warning");
+  EXPECT_EQ(entry.value("message", ""), "Slow request: POST /slow?q=1");
+  auto const expected_http = nlohmann::json{
+      {"requestMethod", "POST"}, {"requestUrl", "/slow?q=1"},
+      {"requestSize", "10"},     {"responseSize", "1234"},
+      {"status", 200},           {"latency", "1.250s"},
+  };
+  EXPECT_EQ(entry["httpRequest"], expected_http);
+  auto const expected_phases = nlohmann::json{
+      {"read", 1.5},     {"queue", 2.0},  {"decode", 0.0},
+      {"function", 250}, {"encode", 0.0}, {"write", 0.0},
+  };
+  EXPECT_EQ(entry["phasesMs"], expected_phases);
+  auto const expected_cpu = nlohmann::json{
+      {"decode", 0.0},
+      {"function", 0.0},
+      {"encode", 0.0},
+  };
+  EXPECT_EQ(entry["cpuMs"], expected_cpu);
+  EXPECT_EQ(entry.value("connectionRequests", 0), 3);
+  EXPECT_EQ(entry.value("suppressed", 0), 7);
+  EXPECT_EQ(entry["logging.googleapis.com/labels"].value("execution_id", ""),
+            "exec-123");
+  EXPECT_FALSE(entry.contains("route"));
+  EXPECT_FALSE(entry.contains("eventType"));
+}
+
+TEST(SlowRequestLogTest, FormatCpuTime) {
+  auto record = MakeRecord();
+  record.timing.AddCpuTime(RequestPhase::kFunction, ms(120));
+  record.timing.set_route("POST /slow");
+  record.timing.set_event_type("com.example.created");
+  auto const entry = nlohmann::json::parse(
+      SlowRequestLog::FormatEntry(record, ms(1250), 0));
+  EXPECT_EQ(entry["cpuMs"].value("function", 0.0), 120.0);
+  EXPECT_EQ(entry.value("route", ""), "POST /slow");
+  EXPECT_EQ(entry.value("eventType", ""), "com.example.created");
+}
+
+TEST(SlowRequestLogTest, Threshold) {
+  CaptureStderr capture;
+  SlowRequestLog log(ms(100), 10);
+  auto const record = MakeRecord();
+  log.Record(record, record.start + ms(99));
+  EXPECT_EQ(capture.str(), "");
+  log.Record(record, record.start + ms(100));
+  auto const lines = Lines(capture.str());
+  ASSERT_EQ(lines.size(), 1);
+  EXPECT_EQ(lines[0]["httpRequest"].value("latency", ""), "0.100s");
+}
+
+TEST(SlowRequestLogTest, RateLimit) {
+  CaptureStderr capture;
+  SlowRequestLog log(ms(100), 2);
+  auto const record = MakeRecord();
+  auto const now = record.start + ms(500);
+  for (int i = 0; i != 5; ++i) log.Record(record, now);
+  // The next second reports the three suppressed entries.
+  log.Record(record, now + std::chrono::seconds(1));
+
+  auto const lines = Lines(capture.str());
+  ASSERT_EQ(lines.size(), 3);
+  EXPECT_EQ(lines[0].value("suppressed", -1), 0);
+  EXPECT_EQ(lines[1].value("suppressed", -1), 0);
+  EXPECT_EQ(lines[2].value("suppressed", -1), 3);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,120 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/startup_timer.h"
+#include "google/cloud/functions/internal/json_writer.h"
+#include "google/cloud/functions/internal/structured_log.h"
+#include <charconv>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#if defined(__linux__)
+#include <time.h>
+#include <unistd.h>
+#endif  // __linux__
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+namespace {
+
+void AppendMilliseconds(std::string& out,
+                        std::chrono::steady_clock::duration d) {
+  auto const ms = std::chrono::duration<double, std::milli>(d).count();
+  char buffer[32];
+  auto const r = std::to_chars(std::begin(buffer), std::end(buffer), ms,
+                               std::chars_format::fixed, 3);
+  out.append(buffer, r.ptr);
+}
+
+}  // namespace
+
+std::optional<std::chrono::steady_clock::duration> ProcessAge() {
+#if defined(__linux__)
+  std::ifstream is("/proc/self/stat");
+  std::string stat{std::istreambuf_iterator<char>(is), {}};
+  // The command name may contain spaces, the fields are counted after it.
+  auto const pos = stat.rfind(')');
+  if (pos == std::string::npos) return std::nullopt;
+  std::istringstream fields(stat.substr(pos + 1));
+  // `starttime` is the 22nd field, the 20th after the command name.
+  std::string field;
+  for (int i = 0; i != 20; ++i) fields >> field;
+  long long start_ticks = 0;
+  if (!(fields >> start_ticks)) return std::nullopt;
+  auto const ticks_per_second = sysconf(_SC_CLK_TCK);
+  timespec now{};
+  if (ticks_per_second <= 0 || clock_gettime(CLOCK_BOOTTIME, &now) != 0) {
+    return std::nullopt;
+  }
+  using std::chrono::nanoseconds;
+  using std::chrono::seconds;
+  auto const since_boot = seconds(now.tv_sec) + nanoseconds(now.tv_nsec);
+  auto const started = nanoseconds(seconds(start_ticks)) / ticks_per_second;
+  if (started > since_boot) return std::chrono::steady_clock::duration{0};
+  return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      since_boot - started);
+#else
+  return std::nullopt;
+#endif  // __linux__
+}
+
+StartupTimer::StartupTimer(std::optional<Clock::duration> before_start,
+                           Clock::time_point start)
+    : before_start_(before_start), last_(start) {}
+
+void StartupTimer::Mark(std::string name, Clock::time_point now) {
+  phases_.emplace_back(std::move(name), now - last_);
+  last_ = now;
+}
+
+StartupTimer::Clock::duration StartupTimer::total() const {
+  auto total = before_start_.value_or(Clock::duration{0});
+  for (auto const& p : phases_) total += p.second;
+  return total;
+}
+
+std::string StartupTimer::ToJson() const {
+  std::string json = "{";
+  if (before_start_) {
+    json += R"("processMs":)";
+    AppendMilliseconds(json, *before_start_);
+    json += ',';
+  }
+  json += R"("phases":{)";
+  auto sep = "";
+  for (auto const& [name, duration] : phases_) {
+    json += sep;
+    JsonAppendString(json, name);
+    json += ':';
+    AppendMilliseconds(json, duration);
+    sep = ",";
+  }
+  json += R"(},"totalMs":)";
+  AppendMilliseconds(json, total());
+  json += '}';
+  return json;
+}
+
+std::string StartupTimer::LogEntry() const {
+  auto const report = ToJson();
+  LogField const fields[] = {{"startup", report}};
+  std::string entry;
+  FormatLogEntry(entry, functions::LogSeverity::kInfo, "Server ready", fields,
+                 nullptr);
+  return entry;
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
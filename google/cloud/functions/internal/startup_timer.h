@@ -0,0 +1,84 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_STARTUP_TIMER_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_STARTUP_TIMER_H
+
+#include "google/cloud/functions/version.h"
+#include <chrono>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Returns the time since the process started, if the platform reports it.
+ *
+ * On Linux this is based on `/proc/self/stat`, with the resolution of the
+ * kernel clock ticks, typically 10ms. It covers the dynamic loading and the
+ * static initializers, which run before any framework code.
+ */
+std::optional<std::chrono::steady_clock::duration> ProcessAge();
+
+/**
+ * Measures the phases of the server startup, from `exec()` to listening.
+ *
+ * Each call to `Mark()` ends a phase, which starts at the end of the previous
+ * phase, or when the timer was created.
+ */
+class StartupTimer {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /// Starts the timer, @p before_start is the time before the timer existed.
+  explicit StartupTimer(
+      std::optional<Clock::duration> before_start = ProcessAge(),
+      Clock::time_point start = Clock::now());
+
+  /// Ends the current phase, naming it @p name.
+  void Mark(std::string name, Clock::time_point now = Clock::now());
+
+  /// The phases recorded so far, with their durations.
+  [[nodiscard]] std::vector<std::pair<std::string, Clock::duration>> const&
+  phases() const {
+    return phases_;
+  }
+
+  /// The time from the process start, or the timer creation, to the last mark.
+  [[nodiscard]] Clock::duration total() const;
+
+  /**
+   * Formats the phases as a JSON object.
+   *
+   * For example `{"processMs":12.5,"phases":{"parse_options":0.2},...}`, the
+   * `processMs` member is omitted if the process age is unknown.
+   */
+  [[nodiscard]] std::string ToJson() const;
+
+  /// Formats a structured log entry, with the report in a `startup` member.
+  [[nodiscard]] std::string LogEntry() const;
+
+ private:
+  std::optional<Clock::duration> before_start_;
+  Clock::time_point last_;
+  std::vector<std::pair<std::string, Clock::duration>> phases_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_STARTUP_TIMER_H
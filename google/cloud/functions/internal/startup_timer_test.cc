@@ -0,0 +1,64 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/startup_timer.h"
+#include <gmock/gmock.h>
+#include <chrono>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+TEST(StartupTimerTest, Phases) {
+  auto const start = StartupTimer::Clock::time_point{} + milliseconds(100);
+  StartupTimer timer(milliseconds(12), start);
+  timer.Mark("parse_options", start + microseconds(250));
+  timer.Mark("warmup", start + milliseconds(30));
+  EXPECT_THAT(timer.phases(),
+              ElementsAre(Pair("parse_options", microseconds(250)),
+                          Pair("warmup", microseconds(29750))));
+  EXPECT_EQ(timer.total(), milliseconds(42));
+  EXPECT_EQ(timer.ToJson(),
+            R"({"processMs":12.000,"phases":{"parse_options":0.250,)"
+            R"("warmup":29.750},"totalMs":42.000})");
+  EXPECT_EQ(timer.LogEntry(),
+            R"({"severity":"info","message":"Server ready","startup":)" +
+                timer.ToJson() + "}");
+}
+
+TEST(StartupTimerTest, UnknownProcessAge) {
+  auto const start = StartupTimer::Clock::time_point{};
+  StartupTimer timer(std::nullopt, start);
+  timer.Mark("listen", start + milliseconds(1));
+  EXPECT_EQ(timer.ToJson(), R"({"phases":{"listen":1.000},"totalMs":1.000})");
+}
+
+TEST(StartupTimerTest, ProcessAge) {
+  auto const age = ProcessAge();
+#if defined(__linux__)
+  ASSERT_TRUE(age.has_value());
+  EXPECT_GE(age->count(), 0);
+#else
+  EXPECT_FALSE(age.has_value());
+#endif  // __linux__
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
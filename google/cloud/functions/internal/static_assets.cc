@@ -0,0 +1,202 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/static_assets.h"
+#include "google/cloud/functions/internal/byte_ranges.h"
+#include "google/cloud/functions/internal/compression.h"
+#include "google/cloud/functions/internal/conditional.h"
+#include "google/cloud/functions/internal/query_string.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace http = ::boost::beast::http;
+namespace fs = ::std::filesystem;
+
+std::string_view View(boost::beast::string_view v) {
+  return {v.data(), v.size()};
+}
+
+/// Returns the compressed @p data, or `nullptr` if it is not worth it.
+std::shared_ptr<std::string const> Compress(ContentEncoding encoding,
+                                           std::string const& data) try {
+  auto compressed = MakeCompressor(encoding)->Compress(data, true);
+  if (compressed.size() >= data.size()) return nullptr;
+  return std::make_shared<std::string const>(std::move(compressed));
+} catch (std::invalid_argument const&) {
+  // The encoding is not supported in this build.
+  return nullptr;
+}
+
+StaticAsset LoadAsset(fs::path const& path,
+                      functions::StaticAssetOptions const& options) {
+  std::ifstream is(path, std::ios::binary);
+  if (!is) {
+    throw std::runtime_error("cannot read static asset " + path.string());
+  }
+  std::string data{std::istreambuf_iterator<char>(is), {}};
+  StaticAsset asset;
+  asset.content_type = std::string(ContentTypeForPath(path.generic_string()));
+  asset.etag = MakeEntityTag(data);
+  if (data.size() >= options.min_compress_size &&
+      IsCompressible(asset.content_type)) {
+    asset.gzip = Compress(ContentEncoding::kGzip, data);
+    asset.brotli = Compress(ContentEncoding::kBrotli, data);
+  }
+  asset.identity = std::make_shared<std::string const>(std::move(data));
+  return asset;
+}
+
+}  // namespace
+
+std::string_view ContentTypeForPath(std::string_view path) {
+  struct Entry {
+    std::string_view extension;
+    std::string_view content_type;
+  };
+  static auto constexpr kTypes = std::array<Entry, 22>{{
+      {"css", "text/css; charset=utf-8"},
+      {"csv", "text/csv; charset=utf-8"},
+      {"gif", "image/gif"},
+      {"htm", "text/html; charset=utf-8"},
+      {"html", "text/html; charset=utf-8"},
+      {"ico", "image/x-icon"},
+      {"jpeg", "image/jpeg"},
+      {"jpg", "image/jpeg"},
+      {"js", "text/javascript; charset=utf-8"},
+      {"json", "application/json"},
+      {"map", "application/json"},
+      {"md", "text/markdown; charset=utf-8"},
+      {"mjs", "text/javascript; charset=utf-8"},
+      {"pdf", "application/pdf"},
+      {"png", "image/png"},
+      {"svg", "image/svg+xml"},
+      {"txt", "text/plain; charset=utf-8"},
+      {"wasm", "application/wasm"},
+      {"webp", "image/webp"},
+      {"woff2", "font/woff2"},
+      {"xml", "application/xml"},
+      {"yaml", "application/yaml"},
+  }};
+  auto const name = path.substr(path.find_last_of('/') + 1);
+  auto const dot = name.find_last_of('.');
+  if (dot == std::string_view::npos) return "application/octet-stream";
+  auto const extension = name.substr(dot + 1);
+  for (auto const& e : kTypes) {
+    if (e.extension.size() != extension.size()) continue;
+    if (std::equal(extension.begin(), extension.end(), e.extension.begin(),
+                   [](char a, char b) {
+                     return std::tolower(static_cast<unsigned char>(a)) == b;
+                   })) {
+      return e.content_type;
+    }
+  }
+  return "application/octet-stream";
+}
+
+StaticAssets::StaticAssets(std::string const& directory,
+                           functions::StaticAssetOptions options)
+    : options_(std::move(options)) {
+  auto const root = fs::path(directory);
+  std::error_code ec;
+  auto i = fs::recursive_directory_iterator(root, ec);
+  for (; !ec && i != fs::recursive_directory_iterator(); i.increment(ec)) {
+    auto const& path = i->path();
+    // Hidden files and directories, e.g. `.git`, are not served.
+    if (path.filename().string().rfind('.', 0) == 0) {
+      if (i->is_directory()) i.disable_recursion_pending();
+      continue;
+    }
+    if (!i->is_regular_file()) continue;
+    assets_.emplace("/" + path.lexically_relative(root).generic_string(),
+                    LoadAsset(path, options_));
+  }
+  if (ec) {
+    throw std::runtime_error("cannot read static assets in " + directory +
+                             ": " + ec.message());
+  }
+}
+
+BeastResponse StaticAssets::Serve(BeastRequest const& request) const {
+  BeastResponse response;
+  auto const method = request.method();
+  if (method != http::verb::get && method != http::verb::head) {
+    response.result(http::status::method_not_allowed);
+    response.set(http::field::allow, "GET, HEAD");
+    return response;
+  }
+  auto const* asset = Find(TargetPath(View(request.target())));
+  if (asset == nullptr) {
+    response.result(http::status::not_found);
+    return response;
+  }
+  response.set(http::field::content_type, asset->content_type);
+  response.set(http::field::etag, asset->etag);
+  response.set(http::field::accept_ranges, "bytes");
+  if (!options_.cache_control.empty()) {
+    response.set(http::field::cache_control, options_.cache_control);
+  }
+  if (asset->gzip || asset->brotli) {
+    response.set(http::field::vary, "Accept-Encoding");
+  }
+  auto const if_none_match = View(request[http::field::if_none_match]);
+  if (!if_none_match.empty() && EntityTagMatches(if_none_match, asset->etag)) {
+    response.result(http::status::not_modified);
+    return response;
+  }
+
+  // The server must ignore `Range` in other methods.
+  auto const range = View(request[http::field::range]);
+  auto const if_range = View(request[http::field::if_range]);
+  if (method == http::verb::get && !range.empty() &&
+      (if_range.empty() || if_range == asset->etag)) {
+    response.body().set_shared(asset->identity);
+    ServeByteRanges(range, response);
+    if (response.result() != http::status::ok) return response;
+  }
+
+  auto payload = asset->identity;
+  auto const encoding =
+      NegotiateEncoding(View(request[http::field::accept_encoding]));
+  auto const& variant = encoding == ContentEncoding::kBrotli ? asset->brotli
+                        : encoding == ContentEncoding::kGzip ? asset->gzip
+                                                             : payload;
+  if (variant && variant != payload) {
+    payload = variant;
+    response.set(http::field::content_encoding, ToString(encoding));
+  }
+  if (method == http::verb::get) response.body().set_shared(std::move(payload));
+  return response;
+}
+
+StaticAsset const* StaticAssets::Find(std::string_view path) const {
+  auto l = path.empty() || path.back() != '/'
+               ? assets_.find(path)
+               : assets_.find(std::string(path) + options_.index);
+  if (l == assets_.end()) return nullptr;
+  return &l->second;
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
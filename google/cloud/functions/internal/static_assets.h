@@ -0,0 +1,72 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_STATIC_ASSETS_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_STATIC_ASSETS_H
+
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/user_functions.h"
+#include "google/cloud/functions/version.h"
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// Returns the media type for the file @p path, from its extension.
+std::string_view ContentTypeForPath(std::string_view path);
+
+/// A file served by `StaticAssets`, with its precompressed variants.
+struct StaticAsset {
+  std::string content_type;
+  std::string etag;
+  std::shared_ptr<std::string const> identity;
+  /// Empty if compression does not make the file smaller.
+  std::shared_ptr<std::string const> gzip;
+  std::shared_ptr<std::string const> brotli;
+};
+
+/**
+ * The files in a directory, see `functions::MakeStaticAssetFunction()`.
+ *
+ * The files, their compressed variants, and their entity tags are loaded once.
+ * The responses share the loaded payloads, they are never copied, except for
+ * the `Range` requests for more than one range.
+ */
+class StaticAssets {
+ public:
+  /// @throws std::runtime_error if @p directory, or a file in it, cannot be
+  ///     read.
+  StaticAssets(std::string const& directory,
+               functions::StaticAssetOptions options);
+
+  [[nodiscard]] BeastResponse Serve(BeastRequest const& request) const;
+
+  /// Returns the asset for the request path @p path, or `nullptr`.
+  [[nodiscard]] StaticAsset const* Find(std::string_view path) const;
+
+  [[nodiscard]] std::size_t size() const { return assets_.size(); }
+
+ private:
+  functions::StaticAssetOptions options_;
+  std::map<std::string, StaticAsset, std::less<>> assets_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_STATIC_ASSETS_H
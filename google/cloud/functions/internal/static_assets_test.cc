@@ -0,0 +1,174 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/static_assets.h"
+#include "google/cloud/functions/internal/compression.h"
+#include <gmock/gmock.h>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace http = ::boost::beast::http;
+namespace fs = ::std::filesystem;
+
+class StaticAssetsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    root_ = fs::temp_directory_path() /
+            ("static_assets_test_" + std::to_string(std::rand()));
+    fs::create_directories(root_ / "docs");
+    fs::create_directories(root_ / ".git");
+    Write("index.html", html_);
+    Write("docs/openapi.json", R"js({"openapi": "3.0.0"})js");
+    Write("logo.png", "not really a png");
+    Write(".env", "SECRET=1");
+    Write(".git/config", "[core]");
+  }
+  void TearDown() override { fs::remove_all(root_); }
+
+  void Write(std::string const& name, std::string const& contents) {
+    std::ofstream(root_ / name, std::ios::binary) << contents;
+  }
+
+  static BeastRequest Request(std::string const& target) {
+    BeastRequest request;
+    request.method(http::verb::get);
+    request.target(target);
+    return request;
+  }
+
+  fs::path root_;
+  std::string html_ = "<html>" + std::string(1024, 'x') + "</html>";
+};
+
+TEST_F(StaticAssetsTest, Load) {
+  StaticAssets assets(root_.string(), {});
+  EXPECT_EQ(assets.size(), 3);
+  ASSERT_NE(assets.Find("/"), nullptr);
+  EXPECT_EQ(*assets.Find("/")->identity, html_);
+  EXPECT_EQ(assets.Find("/"), assets.Find("/index.html"));
+  EXPECT_NE(assets.Find("/docs/openapi.json"), nullptr);
+  EXPECT_EQ(assets.Find("/.env"), nullptr);
+  EXPECT_EQ(assets.Find("/.git/config"), nullptr);
+  EXPECT_EQ(assets.Find("/docs/"), nullptr);
+
+  auto const& html = *assets.Find("/index.html");
+  EXPECT_EQ(html.content_type, "text/html; charset=utf-8");
+  ASSERT_NE(html.gzip, nullptr);
+  EXPECT_LT(html.gzip->size(), html_.size());
+  // Small and incompressible files have no variants.
+  EXPECT_EQ(assets.Find("/docs/openapi.json")->gzip, nullptr);
+  EXPECT_EQ(assets.Find("/logo.png")->gzip, nullptr);
+
+  EXPECT_THROW(StaticAssets((root_ / "missing").string(), {}),
+               std::runtime_error);
+}
+
+TEST_F(StaticAssetsTest, Serve) {
+  functions::StaticAssetOptions options;
+  options.cache_control = "public, max-age=60";
+  StaticAssets assets(root_.string(), options);
+
+  auto response = assets.Serve(Request("/index.html?v=1"));
+  EXPECT_EQ(response.result(), http::status::ok);
+  EXPECT_EQ(response.body(), html_);
+  EXPECT_EQ(response[http::field::content_type], "text/html; charset=utf-8");
+  EXPECT_EQ(response[http::field::cache_control], "public, max-age=60");
+  EXPECT_EQ(response[http::field::vary], "Accept-Encoding");
+  EXPECT_EQ(response[http::field::accept_ranges], "bytes");
+  EXPECT_EQ(response.count(http::field::content_encoding), 0);
+  auto const etag = std::string(response[http::field::etag]);
+  EXPECT_FALSE(etag.empty());
+
+  auto request = Request("/");
+  request.set(http::field::accept_encoding, "gzip");
+  response = assets.Serve(request);
+  EXPECT_EQ(response[http::field::content_encoding], "gzip");
+  EXPECT_EQ(response[http::field::etag], etag);
+  auto const& gzip = *assets.Find("/")->gzip;
+  EXPECT_EQ(response.body(), gzip);
+
+  request.set(http::field::if_none_match, etag);
+  response = assets.Serve(request);
+  EXPECT_EQ(response.result(), http::status::not_modified);
+  EXPECT_TRUE(response.body().empty());
+
+  request = Request("/index.html");
+  request.method(http::verb::head);
+  response = assets.Serve(request);
+  EXPECT_EQ(response.result(), http::status::ok);
+  EXPECT_TRUE(response.body().empty());
+
+  request.method(http::verb::post);
+  response = assets.Serve(request);
+  EXPECT_EQ(response.result(), http::status::method_not_allowed);
+  EXPECT_EQ(response[http::field::allow], "GET, HEAD");
+
+  EXPECT_EQ(assets.Serve(Request("/missing")).result(),
+            http::status::not_found);
+  EXPECT_EQ(assets.Serve(Request("/.env")).result(), http::status::not_found);
+}
+
+TEST_F(StaticAssetsTest, Range) {
+  StaticAssets assets(root_.string(), {});
+  auto request = Request("/docs/openapi.json");
+  request.set(http::field::range, "bytes=1-9");
+  auto response = assets.Serve(request);
+  EXPECT_EQ(response.result(), http::status::partial_content);
+  EXPECT_EQ(response.body(), R"js("openapi")js");
+  EXPECT_EQ(response[http::field::content_range], "bytes 1-9/20");
+
+  request.set(http::field::range, "bytes=1-9,-2");
+  response = assets.Serve(request);
+  EXPECT_EQ(response.result(), http::status::partial_content);
+  EXPECT_THAT(std::string(response[http::field::content_type]),
+              ::testing::StartsWith("multipart/byteranges; boundary="));
+  EXPECT_THAT(response.body().str(),
+              ::testing::HasSubstr("Content-Type: application/json\r\n"
+                                   "Content-Range: bytes 18-19/20\r\n"
+                                   "\r\n"
+                                   "\"}\r\n"));
+
+  request.set(http::field::range, "bytes=100-");
+  response = assets.Serve(request);
+  EXPECT_EQ(response.result(), http::status::range_not_satisfiable);
+  EXPECT_EQ(response[http::field::content_range], "bytes */20");
+
+  // A stale `If-Range` gets the full response.
+  request.set(http::field::range, "bytes=1-9");
+  request.set(http::field::if_range, R"("stale")");
+  response = assets.Serve(request);
+  EXPECT_EQ(response.result(), http::status::ok);
+  EXPECT_EQ(response.body().size(), 20);
+}
+
+TEST(StaticAssets, ContentType) {
+  EXPECT_EQ(ContentTypeForPath("/a/b/app.JS"),
+            "text/javascript; charset=utf-8");
+  EXPECT_EQ(ContentTypeForPath("/styles.css"), "text/css; charset=utf-8");
+  EXPECT_EQ(ContentTypeForPath("/font.woff2"), "font/woff2");
+  EXPECT_EQ(ContentTypeForPath("/README"), "application/octet-stream");
+  EXPECT_EQ(ContentTypeForPath("/a.d/README"), "application/octet-stream");
+  EXPECT_EQ(ContentTypeForPath("/archive.xyz"), "application/octet-stream");
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
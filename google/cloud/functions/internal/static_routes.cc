@@ -0,0 +1,197 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/static_routes.h"
+#include <charconv>
+#include <future>
+#include <stdexcept>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+namespace be = ::boost::beast;
+
+namespace {
+
+/// Compares the header with the expected token, in constant time.
+bool IsAuthorized(std::string_view authorization, std::string_view token) {
+  auto constexpr kScheme = std::string_view{"Bearer "};
+  if (authorization.size() != kScheme.size() + token.size()) return false;
+  if (!be::iequals(authorization.substr(0, kScheme.size()), kScheme)) {
+    return false;
+  }
+  auto const value = authorization.substr(kScheme.size());
+  unsigned char diff = 0;
+  for (std::size_t i = 0; i != token.size(); ++i) {
+    diff |= static_cast<unsigned char>(value[i] ^ token[i]);
+  }
+  return diff == 0;
+}
+
+BeastResponse Unauthorized() {
+  BeastResponse response;
+  response.result(be::http::status::unauthorized);
+  response.set(be::http::field::www_authenticate, "Bearer");
+  response.prepare_payload();
+  return response;
+}
+
+}  // namespace
+
+void StaticRoutes::Add(std::string path, BeastResponse response) {
+  response.prepare_payload();
+  routes_.insert_or_assign(std::move(path),
+                           Route{std::move(response), {}, {}, {}});
+}
+
+void StaticRoutes::AddGenerated(std::string path,
+                                std::function<BeastResponse()> generate,
+                                std::string token) {
+  routes_.insert_or_assign(
+      std::move(path), Route{{}, std::move(generate), {}, std::move(token)});
+}
+
+void StaticRoutes::AddAsync(std::string path, AsyncGenerator generate,
+                            std::string token) {
+  routes_.insert_or_assign(
+      std::move(path), Route{{}, {}, std::move(generate), std::move(token)});
+}
+
+bool StaticRoutes::IsAsync(std::string_view target) const {
+  auto const* route = FindRoute(target);
+  return route != nullptr && route->generate_async;
+}
+
+void StaticRoutes::RespondAsync(std::string_view target,
+                                std::string_view authorization,
+                                AsyncResponseCallback done) const {
+  auto const* route = FindRoute(target);
+  if (route == nullptr || !route->generate_async) {
+    BeastResponse response;
+    response.result(be::http::status::not_found);
+    response.prepare_payload();
+    return done(std::move(response));
+  }
+  if (!route->token.empty() && !IsAuthorized(authorization, route->token)) {
+    return done(Unauthorized());
+  }
+  route->generate_async(target, [done = std::move(done)](BeastResponse r) {
+    r.prepare_payload();
+    done(std::move(r));
+  });
+}
+
+BeastResponse const* StaticRoutes::Find(std::string_view target) const {
+  auto const* route = FindRoute(target);
+  if (route == nullptr || route->generate || route->generate_async) {
+    return nullptr;
+  }
+  return &route->response;
+}
+
+std::optional<BeastResponse> StaticRoutes::Respond(
+    std::string_view target, std::string_view authorization) const {
+  auto const* route = FindRoute(target);
+  if (route == nullptr) return std::nullopt;
+  if (route->generate_async) {
+    std::promise<BeastResponse> p;
+    auto f = p.get_future();
+    RespondAsync(target, authorization, [&p](BeastResponse r) {
+      p.set_value(std::move(r));
+    });
+    return f.get();
+  }
+  if (!route->generate) return route->response;
+  if (!route->token.empty() && !IsAuthorized(authorization, route->token)) {
+    return Unauthorized();
+  }
+  auto response = route->generate();
+  response.prepare_payload();
+  return response;
+}
+
+StaticRoutes::Route const* StaticRoutes::FindRoute(
+    std::string_view target) const {
+  if (routes_.empty()) return nullptr;
+  auto const path = target.substr(0, target.find('?'));
+  auto const l = routes_.find(path);
+  if (l == routes_.end()) return nullptr;
+  return &l->second;
+}
+
+std::pair<std::string, BeastResponse> ParseStaticRoute(std::string_view spec) {
+  auto invalid = [spec](char const* reason) {
+    return std::invalid_argument("Invalid static route (" + std::string(spec) +
+                                 "), " + reason);
+  };
+  auto const eq = spec.find('=');
+  if (eq == std::string_view::npos) {
+    throw invalid("expected `PATH=STATUS[:BODY]`");
+  }
+  auto const path = spec.substr(0, eq);
+  if (path.empty() || path.front() != '/' ||
+      path.find('?') != std::string_view::npos) {
+    throw invalid("the path must start with `/` and have no query");
+  }
+  auto const value = spec.substr(eq + 1);
+  auto const colon = value.find(':');
+  auto const status = value.substr(0, colon);
+  auto code = 0;
+  auto const* end = status.data() + status.size();
+  auto const r = std::from_chars(status.data(), end, code);
+  auto constexpr kMinStatus = 200;
+  auto constexpr kMaxStatus = 599;
+  if (status.empty() || r.ec != std::errc{} || r.ptr != end ||
+      code < kMinStatus || code > kMaxStatus) {
+    throw invalid("the status must be in the [200, 599] range");
+  }
+  BeastResponse response;
+  response.result(static_cast<unsigned>(code));
+  if (colon != std::string_view::npos) {
+    response.set(be::http::field::content_type, "text/plain");
+    response.body() = std::string(value.substr(colon + 1));
+  }
+  return {std::string(path), std::move(response)};
+}
+
+StaticRoutes MakeStaticRoutes(std::vector<std::string> const& specs) {
+  StaticRoutes routes;
+  // Browsers request these paths on their own, the function is not expected to
+  // handle them.
+  for (auto const* path : {"/favicon.ico", "/robots.txt"}) {
+    BeastResponse response;
+    response.result(be::http::status::not_found);
+    routes.Add(path, std::move(response));
+  }
+  for (auto const& spec : specs) {
+    auto [path, response] = ParseStaticRoute(spec);
+    routes.Add(std::move(path), std::move(response));
+  }
+  return routes;
+}
+
+Handler MakeStaticRoutesHandler(Handler handler,
+                                std::shared_ptr<StaticRoutes const> routes) {
+  if (routes->empty()) return handler;
+  return [handler = std::move(handler),
+          routes = std::move(routes)](BeastRequest request) {
+    auto route = routes->Respond(request.target(),
+                                 request[be::http::field::authorization]);
+    if (route) return *std::move(route);
+    return handler(std::move(request));
+  };
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,131 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_STATIC_ROUTES_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_STATIC_ROUTES_H
+
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/version.h"
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Fixed responses for paths answered without calling the function.
+ *
+ * Load balancer health checks, readiness probes, and browser requests for
+ * `/favicon.ico` do not need the function. The server answers them as soon as
+ * the request header is parsed, without copying the request.
+ */
+class StaticRoutes {
+ public:
+  StaticRoutes() = default;
+
+  /// Adds, or replaces, the response for @p path.
+  void Add(std::string path, BeastResponse response);
+
+  /**
+   * Adds, or replaces, a route whose response is created by @p generate.
+   *
+   * If @p token is not empty the requests must have an
+   * `Authorization: Bearer <token>` header, other requests get a 401.
+   */
+  void AddGenerated(std::string path, std::function<BeastResponse()> generate,
+                    std::string token = {});
+
+  /// Creates the response for the request target, calls the callback once.
+  using AsyncGenerator =
+      std::function<void(std::string_view target, AsyncResponseCallback done)>;
+
+  /**
+   * Adds, or replaces, a route whose response is created asynchronously.
+   *
+   * Use these routes for responses that take long to create, e.g. a profile
+   * collected over several seconds. The sessions answer them with
+   * `RespondAsync()`, without blocking the server threads. @p token works as
+   * in `AddGenerated()`.
+   */
+  void AddAsync(std::string path, AsyncGenerator generate,
+                std::string token = {});
+
+  /// Returns true if @p target has an asynchronous route.
+  [[nodiscard]] bool IsAsync(std::string_view target) const;
+
+  /**
+   * Creates the response for @p target, which must have an asynchronous route.
+   *
+   * @p done may be called before this function returns, or from any thread.
+   */
+  void RespondAsync(std::string_view target, std::string_view authorization,
+                    AsyncResponseCallback done) const;
+
+  /**
+   * Returns the fixed response for @p target, ignoring any query, or `nullptr`.
+   *
+   * Returns `nullptr` for generated and asynchronous routes, use `Respond()`
+   * to include them.
+   */
+  [[nodiscard]] BeastResponse const* Find(std::string_view target) const;
+
+  /**
+   * Returns the response for @p target, if it has a route.
+   *
+   * @p authorization is the value of the request `Authorization` header.
+   * Blocks until the response of an asynchronous route is ready.
+   */
+  [[nodiscard]] std::optional<BeastResponse> Respond(
+      std::string_view target, std::string_view authorization = {}) const;
+
+  [[nodiscard]] bool empty() const { return routes_.empty(); }
+
+ private:
+  struct Route {
+    BeastResponse response;
+    std::function<BeastResponse()> generate;
+    AsyncGenerator generate_async;
+    std::string token;
+  };
+
+  [[nodiscard]] Route const* FindRoute(std::string_view target) const;
+
+  std::map<std::string, Route, std::less<>> routes_;
+};
+
+/**
+ * Parses a route in `PATH=STATUS[:BODY]` format, e.g. `/healthz=200:ok`.
+ *
+ * @throws std::invalid_argument if @p spec is not a valid route.
+ */
+std::pair<std::string, BeastResponse> ParseStaticRoute(std::string_view spec);
+
+/// Returns the default routes, overridden or extended by @p specs.
+StaticRoutes MakeStaticRoutes(std::vector<std::string> const& specs);
+
+/// Answers the requests for any of the @p routes without calling @p handler.
+Handler MakeStaticRoutesHandler(Handler handler,
+                                std::shared_ptr<StaticRoutes const> routes);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_STATIC_ROUTES_H
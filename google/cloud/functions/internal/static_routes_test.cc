@@ -0,0 +1,186 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/static_routes.h"
+#include <boost/beast/http.hpp>
+#include <gmock/gmock.h>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace be = ::boost::beast;
+
+TEST(StaticRoutesTest, Parse) {
+  auto const [path, response] = ParseStaticRoute("/healthz=200:ok: ready");
+  EXPECT_EQ(path, "/healthz");
+  EXPECT_EQ(response.result_int(), 200);
+  EXPECT_EQ(response[be::http::field::content_type], "text/plain");
+  EXPECT_EQ(response.body(), "ok: ready");
+
+  auto const [empty_path, empty] = ParseStaticRoute("/ready=204");
+  EXPECT_EQ(empty_path, "/ready");
+  EXPECT_EQ(empty.result_int(), 204);
+  EXPECT_EQ(empty.count(be::http::field::content_type), 0);
+  EXPECT_EQ(empty.body(), "");
+}
+
+TEST(StaticRoutesTest, ParseInvalid) {
+  for (auto const* spec :
+       {"/healthz", "healthz=200", "=200", "/a?b=200", "/healthz=",
+        "/healthz=ok", "/healthz=20x", "/healthz=100", "/healthz=600"}) {
+    EXPECT_THROW(ParseStaticRoute(spec), std::invalid_argument) << spec;
+  }
+}
+
+TEST(StaticRoutesTest, Find) {
+  auto const routes = MakeStaticRoutes({"/healthz=200:ok", "/robots.txt=200"});
+  auto const* healthz = routes.Find("/healthz?probe=1");
+  ASSERT_NE(healthz, nullptr);
+  EXPECT_EQ(healthz->body(), "ok");
+  EXPECT_EQ((*healthz)[be::http::field::content_length], "2");
+  EXPECT_EQ(routes.Find("/healthz/more"), nullptr);
+  EXPECT_EQ(routes.Find("/"), nullptr);
+
+  // The defaults can be overridden.
+  auto const* favicon = routes.Find("/favicon.ico");
+  ASSERT_NE(favicon, nullptr);
+  EXPECT_EQ(favicon->result(), be::http::status::not_found);
+  auto const* robots = routes.Find("/robots.txt");
+  ASSERT_NE(robots, nullptr);
+  EXPECT_EQ(robots->result(), be::http::status::ok);
+}
+
+TEST(StaticRoutesTest, Generated) {
+  StaticRoutes routes;
+  auto calls = 0;
+  routes.AddGenerated("/metrics", [&calls] {
+    BeastResponse response;
+    response.body() = "calls=" + std::to_string(++calls);
+    return response;
+  });
+  EXPECT_EQ(routes.Find("/metrics"), nullptr);
+  auto response = routes.Respond("/metrics?format=text");
+  ASSERT_TRUE(response.has_value());
+  EXPECT_EQ(response->body(), "calls=1");
+  EXPECT_EQ((*response)[be::http::field::content_length], "7");
+  EXPECT_EQ(routes.Respond("/metrics")->body(), "calls=2");
+  EXPECT_FALSE(routes.Respond("/other").has_value());
+}
+
+TEST(StaticRoutesTest, Authorized) {
+  StaticRoutes routes;
+  auto calls = 0;
+  routes.AddGenerated(
+      "/debug/server",
+      [&calls] {
+        ++calls;
+        return BeastResponse{};
+      },
+      "secret");
+  for (auto const* authorization :
+       {"", "Bearer", "Bearer secreT", "Bearer secret2", "Basic secret"}) {
+    auto response = routes.Respond("/debug/server", authorization);
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(response->result(), be::http::status::unauthorized)
+        << authorization;
+    EXPECT_EQ((*response)[be::http::field::www_authenticate], "Bearer");
+  }
+  EXPECT_EQ(calls, 0);
+  auto response = routes.Respond("/debug/server", "Bearer secret");
+  ASSERT_TRUE(response.has_value());
+  EXPECT_EQ(response->result(), be::http::status::ok);
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(StaticRoutesTest, Async) {
+  StaticRoutes routes;
+  AsyncResponseCallback pending;
+  std::string target;
+  routes.AddAsync(
+      "/debug/pprof/profile",
+      [&](std::string_view t, AsyncResponseCallback done) {
+        target = std::string(t);
+        pending = std::move(done);
+      },
+      "secret");
+  EXPECT_TRUE(routes.IsAsync("/debug/pprof/profile?seconds=1"));
+  EXPECT_FALSE(routes.IsAsync("/other"));
+  EXPECT_EQ(routes.Find("/debug/pprof/profile"), nullptr);
+
+  std::optional<BeastResponse> response;
+  auto capture = [&response](BeastResponse r) { response = std::move(r); };
+  routes.RespondAsync("/debug/pprof/profile", "Bearer wrong", capture);
+  ASSERT_TRUE(response.has_value());
+  EXPECT_EQ(response->result(), be::http::status::unauthorized);
+  EXPECT_FALSE(pending);
+
+  response.reset();
+  routes.RespondAsync("/debug/pprof/profile?seconds=1", "Bearer secret",
+                      capture);
+  EXPECT_FALSE(response.has_value());
+  EXPECT_EQ(target, "/debug/pprof/profile?seconds=1");
+  ASSERT_TRUE(pending);
+  BeastResponse ready;
+  ready.body() = "profile";
+  std::exchange(pending, {})(std::move(ready));
+  ASSERT_TRUE(response.has_value());
+  EXPECT_EQ(response->body(), "profile");
+  EXPECT_EQ((*response)[be::http::field::content_length], "7");
+}
+
+TEST(StaticRoutesTest, AsyncBlocking) {
+  StaticRoutes routes;
+  routes.AddAsync("/slow", [](std::string_view, AsyncResponseCallback done) {
+    std::thread([done = std::move(done)] {
+      BeastResponse response;
+      response.body() = "done";
+      done(std::move(response));
+    }).detach();
+  });
+  auto response = routes.Respond("/slow");
+  ASSERT_TRUE(response.has_value());
+  EXPECT_EQ(response->body(), "done");
+}
+
+TEST(StaticRoutesTest, Handler) {
+  auto calls = 0;
+  auto handler = MakeStaticRoutesHandler(
+      [&calls](BeastRequest) {
+        ++calls;
+        return BeastResponse{};
+      },
+      std::make_shared<StaticRoutes const>(
+          MakeStaticRoutes({"/healthz=503:unavailable"})));
+  BeastRequest request;
+  request.target("/healthz");
+  auto response = handler(request);
+  EXPECT_EQ(response.result(), be::http::status::service_unavailable);
+  EXPECT_EQ(response.body(), "unavailable");
+  EXPECT_EQ(calls, 0);
+
+  request.target("/other");
+  response = handler(request);
+  EXPECT_EQ(response.result(), be::http::status::ok);
+  EXPECT_EQ(calls, 1);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
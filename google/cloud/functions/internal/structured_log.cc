@@ -0,0 +1,175 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/structured_log.h"
+#include "google/cloud/functions/internal/json_writer.h"
+#include "google/cloud/functions/internal/tracing.h"
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+thread_local LogContext const* current_log_context = nullptr;
+
+/// Cloud Logging matches traces by their full resource name.
+std::string const& TracePrefix() {
+  static auto const* const kPrefix = [] {
+    for (auto const* name : {"GOOGLE_CLOUD_PROJECT", "GCP_PROJECT"}) {
+      auto const* project = std::getenv(name);
+      if (project == nullptr || *project == '\0') continue;
+      return new std::string("projects/" + std::string(project) + "/traces/");
+    }
+    return new std::string;
+  }();
+  return *kPrefix;
+}
+
+}  // namespace
+
+LogContext const* CurrentLogContext() { return current_log_context; }
+
+LogContext MakeLogContext(BeastRequest const& request) {
+  LogContext context;
+  if (auto trace = ParentTraceContext(request)) {
+    context.trace_id = std::move(trace->trace_id);
+    context.span_id = std::move(trace->span_id);
+    context.sampled = trace->sampled;
+  }
+  auto const l = request.find("function-execution-id");
+  if (l != request.end()) {
+    context.execution_id = std::string(l->value().data(), l->value().size());
+  }
+  return context;
+}
+
+ScopedLogContext::ScopedLogContext(BeastRequest const& request)
+    : context_(MakeLogContext(request)), previous_(current_log_context) {
+  current_log_context = &context_;
+}
+
+ScopedLogContext::~ScopedLogContext() { current_log_context = previous_; }
+
+Handler MakeLogContextHandler(Handler handler) {
+  return [handler = std::move(handler)](BeastRequest request) {
+    ScopedLogContext context(request);
+    return handler(std::move(request));
+  };
+}
+
+StreamingHandler MakeLogContextStreamingHandler(StreamingHandler handler) {
+  return [handler = std::move(handler)](
+             BeastRequest request, functions::HttpRequestBodyReader& reader) {
+    ScopedLogContext context(request);
+    return handler(std::move(request), reader);
+  };
+}
+
+WriterHandler MakeLogContextWriterHandler(WriterHandler handler) {
+  return [handler = std::move(handler)](BeastRequest request,
+                                        ResponseWriter& writer) {
+    ScopedLogContext context(request);
+    return handler(std::move(request), writer);
+  };
+}
+
+AsyncHandler MakeLogContextAsyncHandler(AsyncHandler handler) {
+  return [handler = std::move(handler)](BeastRequest request,
+                                        AsyncResponseCallback callback) {
+    ScopedLogContext context(request);
+    handler(std::move(request), std::move(callback));
+  };
+}
+
+std::string_view SeverityName(functions::LogSeverity severity) {
+  // Cloud Logging matches the names case-insensitively, the framework has
+  // always used lowercase.
+  switch (severity) {
+    case functions::LogSeverity::kDebug:
+      return "debug";
+    case functions::LogSeverity::kInfo:
+      return "info";
+    case functions::LogSeverity::kNotice:
+      return "notice";
+    case functions::LogSeverity::kWarning:
+      return "warning";
+    case functions::LogSeverity::kError:
+      return "error";
+    case functions::LogSeverity::kCritical:
+      return "critical";
+  }
+  return "default";
+}
+
+void FormatLogEntry(std::string& out, functions::LogSeverity severity,
+                    std::string_view message, absl::Span<LogField const> fields,
+                    LogContext const* context) {
+  out += R"({"severity":")";
+  out += SeverityName(severity);
+  out += R"(","message":)";
+  JsonAppendString(out, message);
+  for (auto const& f : fields) {
+    out += ',';
+    JsonAppendString(out, f.name);
+    out += ':';
+    out += f.json;
+  }
+  if (context != nullptr && !context->trace_id.empty()) {
+    out += R"(,"logging.googleapis.com/trace":")";
+    out += TracePrefix();
+    out += context->trace_id;
+    out += R"(","logging.googleapis.com/spanId":")";
+    out += context->span_id;
+    out += R"(","logging.googleapis.com/trace_sampled":)";
+    out += context->sampled ? "true" : "false";
+  }
+  if (context != nullptr && !context->execution_id.empty()) {
+    out += R"(,"logging.googleapis.com/labels":{"execution_id":)";
+    JsonAppendString(out, context->execution_id);
+    out += '}';
+  }
+  out += '}';
+}
+
+void WriteLog(functions::LogSeverity severity, std::string_view message,
+              absl::Span<LogField const> fields) {
+  WriteLog(severity, message, fields, CurrentLogContext());
+}
+
+void WriteLog(functions::LogSeverity severity, std::string_view message,
+              absl::Span<LogField const> fields, LogContext const* context) {
+  // Reuse the buffer, most entries do not allocate once it has grown.
+  auto constexpr kInitialCapacity = 1024;
+  auto constexpr kMaxRetainedCapacity = 64 * 1024;
+  thread_local std::string buffer = [] {
+    std::string b;
+    b.reserve(kInitialCapacity);
+    return b;
+  }();
+  buffer.clear();
+  FormatLogEntry(buffer, severity, message, fields, context);
+  buffer += '\n';
+  // A single write, which goes to the `LogSink` if the streams are redirected.
+  std::cerr.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+  if (buffer.capacity() > kMaxRetainedCapacity) {
+    buffer = std::string();
+    buffer.reserve(kInitialCapacity);
+  }
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
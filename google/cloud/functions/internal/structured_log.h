@@ -0,0 +1,100 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_STRUCTURED_LOG_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_STRUCTURED_LOG_H
+
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/logging.h"
+#include "google/cloud/functions/version.h"
+#include <absl/types/span.h>
+#include <string>
+#include <string_view>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// The request attributes included in log entries.
+struct LogContext {
+  std::string trace_id;
+  std::string span_id;
+  bool sampled = false;
+  /// The value of the `Function-Execution-Id` header, if any.
+  std::string execution_id;
+};
+
+/// Returns the log context for @p request.
+LogContext MakeLogContext(BeastRequest const& request);
+
+/// The context of the request running in the current thread, if any.
+LogContext const* CurrentLogContext();
+
+/// Sets the log context of the current thread from @p request.
+class ScopedLogContext {
+ public:
+  explicit ScopedLogContext(BeastRequest const& request);
+  ~ScopedLogContext();
+
+  ScopedLogContext(ScopedLogContext const&) = delete;
+  ScopedLogContext& operator=(ScopedLogContext const&) = delete;
+
+ private:
+  LogContext context_;
+  LogContext const* previous_;
+};
+
+/**
+ * Wrap handlers to set the log context while they run.
+ *
+ * Asynchronous handlers only have the context until they return.
+ */
+///@{
+Handler MakeLogContextHandler(Handler handler);
+StreamingHandler MakeLogContextStreamingHandler(StreamingHandler handler);
+WriterHandler MakeLogContextWriterHandler(WriterHandler handler);
+AsyncHandler MakeLogContextAsyncHandler(AsyncHandler handler);
+///@}
+
+/// A log entry member, @p json must be a valid JSON value.
+struct LogField {
+  std::string_view name;
+  std::string_view json;
+};
+
+/// Returns the name of @p severity in log entries.
+std::string_view SeverityName(functions::LogSeverity severity);
+
+/**
+ * Appends a log entry to @p out, in the Cloud Logging structured format.
+ *
+ * The entry has no trailing newline. If @p context is not null the entry
+ * includes the trace and execution id of that request.
+ */
+void FormatLogEntry(std::string& out, functions::LogSeverity severity,
+                    std::string_view message, absl::Span<LogField const> fields,
+                    LogContext const* context);
+
+/// Formats a log entry with the current context, and writes it to `stderr`.
+void WriteLog(functions::LogSeverity severity, std::string_view message,
+              absl::Span<LogField const> fields = {});
+
+/// Formats a log entry with @p context, and writes it to `stderr`.
+void WriteLog(functions::LogSeverity severity, std::string_view message,
+              absl::Span<LogField const> fields, LogContext const* context);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_STRUCTURED_LOG_H
@@ -0,0 +1,115 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/structured_log.h"
+#include "google/cloud/functions/logging.h"
+#include "google/cloud/functions/testing_util/capture_stderr.h"
+#include <gmock/gmock.h>
+#include <nlohmann/json.hpp>
+#include <sstream>
+#include <string>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::google::cloud::functions::LogSeverity;
+using ::testing::EndsWith;
+namespace http = ::boost::beast::http;
+
+auto constexpr kTraceParent =
+    "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01";
+
+BeastRequest MakeRequest() {
+  BeastRequest request{http::verb::post, "/", 11};
+  request.set("traceparent", kTraceParent);
+  request.set("Function-Execution-Id", "exec-123");
+  return request;
+}
+
+TEST(StructuredLogTest, Format) {
+  std::string out;
+  LogField const fields[] = {{"count", "3"}, {"list", "[1,2]"}};
+  FormatLogEntry(out, LogSeverity::kWarning, "say \"hi\"\n", fields, nullptr);
+  EXPECT_EQ(out,
+            R"({"severity":"warning","message":"say \"hi\"\n",)"
+            R"("count":3,"list":[1,2]})");
+}
+
+TEST(StructuredLogTest, SeverityName) {
+  EXPECT_EQ(SeverityName(LogSeverity::kDebug), "debug");
+  EXPECT_EQ(SeverityName(LogSeverity::kInfo), "info");
+  EXPECT_EQ(SeverityName(LogSeverity::kNotice), "notice");
+  EXPECT_EQ(SeverityName(LogSeverity::kWarning), "warning");
+  EXPECT_EQ(SeverityName(LogSeverity::kError), "error");
+  EXPECT_EQ(SeverityName(LogSeverity::kCritical), "critical");
+}
+
+TEST(StructuredLogTest, Context) {
+  EXPECT_EQ(CurrentLogContext(), nullptr);
+  auto const request = MakeRequest();
+  {
+    ScopedLogContext scoped(request);
+    auto const* context = CurrentLogContext();
+    ASSERT_NE(context, nullptr);
+    EXPECT_EQ(context->trace_id, "4bf92f3577b34da6a3ce929d0e0e4736");
+    EXPECT_EQ(context->span_id, "00f067aa0ba902b7");
+    EXPECT_TRUE(context->sampled);
+    EXPECT_EQ(context->execution_id, "exec-123");
+    {
+      ScopedLogContext nested(BeastRequest{http::verb::get, "/", 11});
+      ASSERT_NE(CurrentLogContext(), nullptr);
+      EXPECT_TRUE(CurrentLogContext()->trace_id.empty());
+    }
+    EXPECT_EQ(CurrentLogContext(), context);
+
+    std::string out;
+    FormatLogEntry(out, LogSeverity::kInfo, "m", {}, context);
+    auto const json = nlohmann::json::parse(out);
+    EXPECT_THAT(json.value("logging.googleapis.com/trace", ""),
+                EndsWith("4bf92f3577b34da6a3ce929d0e0e4736"));
+    EXPECT_EQ(json.value("logging.googleapis.com/spanId", ""),
+              "00f067aa0ba902b7");
+    EXPECT_EQ(json.value("logging.googleapis.com/trace_sampled", false), true);
+    EXPECT_EQ(json["logging.googleapis.com/labels"].value("execution_id", ""),
+              "exec-123");
+  }
+  EXPECT_EQ(CurrentLogContext(), nullptr);
+}
+
+TEST(StructuredLogTest, Log) {
+  CaptureStderr capture;
+  functions::Log(LogSeverity::kInfo, "outside");
+  auto handler = MakeLogContextHandler([](BeastRequest const&) {
+    functions::Log(LogSeverity::kError, "inside");
+    return BeastResponse{};
+  });
+  (void)handler(MakeRequest());
+
+  std::istringstream lines(capture.str());
+  std::string line;
+  ASSERT_TRUE(std::getline(lines, line));
+  EXPECT_EQ(line, R"({"severity":"info","message":"outside"})");
+  ASSERT_TRUE(std::getline(lines, line));
+  auto const json = nlohmann::json::parse(line);
+  EXPECT_EQ(json.value("severity", ""), "error");
+  EXPECT_EQ(json.value("message", ""), "inside");
+  EXPECT_EQ(json.value("logging.googleapis.com/spanId", ""),
+            "00f067aa0ba902b7");
+  EXPECT_FALSE(std::getline(lines, line));
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,172 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/tracing.h"
+#include "google/cloud/functions/internal/structured_log.h"
+#include <chrono>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+auto constexpr kTraceParent = "traceparent";
+auto constexpr kCloudTraceContext = "x-cloud-trace-context";
+
+std::optional<std::string_view> Header(BeastRequest const& request,
+                                       char const* name) {
+  auto const l = request.find(name);
+  if (l == request.end()) return std::nullopt;
+  auto const v = l->value();
+  return std::string_view{v.data(), v.size()};
+}
+
+/// Records the span for a request, if its trace context is sampled.
+class SpanRecorder {
+ public:
+  SpanRecorder(std::shared_ptr<functions::SpanExporter> const& exporter,
+               BeastRequest& request) {
+    auto parent = ParentTraceContext(request);
+    if (!parent || !parent->sampled) return;
+    exporter_ = exporter;
+    auto const method = request.method_string();
+    auto const target = request.target();
+    auto const path = std::string_view{target.data(), target.size()};
+    span_.name = std::string{method.data(), method.size()} + " ";
+    span_.name += path.substr(0, path.find('?'));
+    span_.context = functions::MakeChildSpan(*parent);
+    span_.parent_span_id = std::move(parent->span_id);
+    request.set(kTraceParent, functions::FormatTraceParent(span_.context));
+    if (request.find(kCloudTraceContext) != request.end()) {
+      request.set(kCloudTraceContext,
+                  functions::FormatCloudTraceContext(span_.context));
+    }
+    span_.start_time = std::chrono::system_clock::now();
+  }
+  // Requests that never complete are reported as errors.
+  ~SpanRecorder() { Finish(500); }
+
+  SpanRecorder(SpanRecorder const&) = delete;
+  SpanRecorder& operator=(SpanRecorder const&) = delete;
+
+  void Finish(unsigned status) {
+    if (!exporter_) return;
+    span_.end_time = std::chrono::system_clock::now();
+    span_.status_code = static_cast<int>(status);
+    auto exporter = std::move(exporter_);
+    try {
+      exporter->Export(std::move(span_));
+    } catch (std::exception const& ex) {
+      WriteLog(functions::LogSeverity::kError,
+               std::string("Span export failed: ") + ex.what());
+    } catch (...) {
+      WriteLog(functions::LogSeverity::kError,
+               "Span export failed with an unknown exception");
+    }
+  }
+
+ private:
+  std::shared_ptr<functions::SpanExporter> exporter_;
+  functions::SpanData span_;
+};
+
+/// Captures the status sent by a writer handler.
+class StatusWriter : public ResponseWriter {
+ public:
+  explicit StatusWriter(ResponseWriter& writer) : writer_(writer) {}
+
+  void WriteHeader(BeastResponse header) override {
+    status_ = header.result_int();
+    writer_.WriteHeader(std::move(header));
+  }
+  void Write(std::string_view data) override { writer_.Write(data); }
+  void SetHeartbeat(std::string_view data,
+                    std::chrono::milliseconds interval) override {
+    writer_.SetHeartbeat(data, interval);
+  }
+
+  [[nodiscard]] unsigned status() const { return status_; }
+
+ private:
+  ResponseWriter& writer_;
+  unsigned status_ = 500;
+};
+
+}  // namespace
+
+std::optional<functions::TraceContext> ParentTraceContext(
+    BeastRequest const& request) {
+  if (auto v = Header(request, kTraceParent)) {
+    if (auto context = functions::ParseTraceParent(*v)) return context;
+  }
+  if (auto v = Header(request, kCloudTraceContext)) {
+    return functions::ParseCloudTraceContext(*v);
+  }
+  return std::nullopt;
+}
+
+Handler MakeTracingHandler(Handler handler,
+                           std::shared_ptr<functions::SpanExporter> exporter) {
+  return [handler = std::move(handler),
+          exporter = std::move(exporter)](BeastRequest request) {
+    SpanRecorder recorder(exporter, request);
+    auto response = handler(std::move(request));
+    recorder.Finish(response.result_int());
+    return response;
+  };
+}
+
+StreamingHandler MakeTracingStreamingHandler(
+    StreamingHandler handler,
+    std::shared_ptr<functions::SpanExporter> exporter) {
+  return [handler = std::move(handler), exporter = std::move(exporter)](
+             BeastRequest request, functions::HttpRequestBodyReader& reader) {
+    SpanRecorder recorder(exporter, request);
+    auto response = handler(std::move(request), reader);
+    recorder.Finish(response.result_int());
+    return response;
+  };
+}
+
+WriterHandler MakeTracingWriterHandler(
+    WriterHandler handler, std::shared_ptr<functions::SpanExporter> exporter) {
+  return [handler = std::move(handler), exporter = std::move(exporter)](
+             BeastRequest request, ResponseWriter& writer) {
+    SpanRecorder recorder(exporter, request);
+    StatusWriter status(writer);
+    auto const ok = handler(std::move(request), status);
+    recorder.Finish(ok ? status.status() : 500);
+    return ok;
+  };
+}
+
+AsyncHandler MakeTracingAsyncHandler(
+    AsyncHandler handler, std::shared_ptr<functions::SpanExporter> exporter) {
+  return [handler = std::move(handler), exporter = std::move(exporter)](
+             BeastRequest request, AsyncResponseCallback callback) {
+    auto recorder = std::make_shared<SpanRecorder>(exporter, request);
+    handler(std::move(request),
+            [recorder = std::move(recorder),
+             callback = std::move(callback)](BeastResponse response) {
+              recorder->Finish(response.result_int());
+              callback(std::move(response));
+            });
+  };
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
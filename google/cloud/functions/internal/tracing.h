@@ -0,0 +1,55 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_TRACING_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_TRACING_H
+
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/trace_context.h"
+#include "google/cloud/functions/version.h"
+#include <memory>
+#include <optional>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// The trace context in the `traceparent` or `X-Cloud-Trace-Context` header.
+std::optional<functions::TraceContext> ParentTraceContext(
+    BeastRequest const& request);
+
+/**
+ * Wrap handlers to record a span for each sampled request.
+ *
+ * Requests without a sampled trace context are forwarded unchanged, at the
+ * cost of a header lookup. Sampled requests get a new span, the trace context
+ * headers are replaced with it, so the function (and any calls it makes) run
+ * in the new span. The span is exported once the response is complete.
+ */
+///@{
+Handler MakeTracingHandler(Handler handler,
+                           std::shared_ptr<functions::SpanExporter> exporter);
+StreamingHandler MakeTracingStreamingHandler(
+    StreamingHandler handler,
+    std::shared_ptr<functions::SpanExporter> exporter);
+WriterHandler MakeTracingWriterHandler(
+    WriterHandler handler, std::shared_ptr<functions::SpanExporter> exporter);
+AsyncHandler MakeTracingAsyncHandler(
+    AsyncHandler handler, std::shared_ptr<functions::SpanExporter> exporter);
+///@}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_TRACING_H
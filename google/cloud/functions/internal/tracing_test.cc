@@ -0,0 +1,165 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/tracing.h"
+#include "google/cloud/functions/function.h"
+#include <gmock/gmock.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace http = ::boost::beast::http;
+using ::google::cloud::functions::SpanData;
+
+auto constexpr kTraceId = "4bf92f3577b34da6a3ce929d0e0e4736";
+auto constexpr kSampled =
+    "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01";
+
+class TestExporter : public functions::SpanExporter {
+ public:
+  void Export(SpanData span) override {
+    std::lock_guard<std::mutex> lk(mu_);
+    spans_.push_back(std::move(span));
+  }
+  std::vector<SpanData> spans() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return spans_;
+  }
+
+ private:
+  mutable std::mutex mu_;
+  std::vector<SpanData> spans_;
+};
+
+BeastRequest MakeRequest(char const* traceparent) {
+  BeastRequest request{http::verb::post, "/path?q=1", 11};
+  if (traceparent != nullptr) request.set("traceparent", traceparent);
+  return request;
+}
+
+/// Returns the traceparent header seen by the function.
+BeastResponse EchoTraceParent(BeastRequest const& request) {
+  BeastResponse response;
+  response.result(http::status::created);
+  auto const v = request["traceparent"];
+  response.body() = std::string(v.data(), v.size());
+  return response;
+}
+
+TEST(TracingTest, ParentTraceContext) {
+  EXPECT_FALSE(ParentTraceContext(MakeRequest(nullptr)).has_value());
+
+  auto request = MakeRequest(nullptr);
+  request.set("X-Cloud-Trace-Context", std::string(kTraceId) + "/1;o=1");
+  auto context = ParentTraceContext(request);
+  ASSERT_TRUE(context.has_value());
+  EXPECT_EQ(context->span_id, "0000000000000001");
+
+  // An invalid traceparent falls back to the Cloud Trace header.
+  request.set("traceparent", "invalid");
+  context = ParentTraceContext(request);
+  ASSERT_TRUE(context.has_value());
+  EXPECT_EQ(context->span_id, "0000000000000001");
+
+  request.set("traceparent", kSampled);
+  context = ParentTraceContext(request);
+  ASSERT_TRUE(context.has_value());
+  EXPECT_EQ(context->span_id, "00f067aa0ba902b7");
+}
+
+TEST(TracingTest, Sampled) {
+  auto exporter = std::make_shared<TestExporter>();
+  auto handler = MakeTracingHandler(EchoTraceParent, exporter);
+  auto request = MakeRequest(kSampled);
+  request.set("X-Cloud-Trace-Context", std::string(kTraceId) + "/1;o=1");
+  auto const response = handler(std::move(request));
+  EXPECT_EQ(response.result(), http::status::created);
+
+  auto const spans = exporter->spans();
+  ASSERT_EQ(spans.size(), 1);
+  auto const& span = spans[0];
+  EXPECT_EQ(span.name, "POST /path");
+  EXPECT_EQ(span.context.trace_id, kTraceId);
+  EXPECT_EQ(span.parent_span_id, "00f067aa0ba902b7");
+  EXPECT_NE(span.context.span_id, span.parent_span_id);
+  EXPECT_EQ(span.status_code, 201);
+  EXPECT_LE(span.start_time, span.end_time);
+  // The function runs in the new span.
+  EXPECT_EQ(response.body(), functions::FormatTraceParent(span.context));
+}
+
+TEST(TracingTest, NotSampled) {
+  auto exporter = std::make_shared<TestExporter>();
+  auto handler = MakeTracingHandler(EchoTraceParent, exporter);
+  auto constexpr kUnsampled =
+      "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-00";
+  auto response = handler(MakeRequest(kUnsampled));
+  EXPECT_EQ(response.body(), kUnsampled);
+  response = handler(MakeRequest(nullptr));
+  EXPECT_EQ(response.body(), "");
+  EXPECT_TRUE(exporter->spans().empty());
+}
+
+TEST(TracingTest, Exception) {
+  auto exporter = std::make_shared<TestExporter>();
+  auto handler = MakeTracingHandler(
+      [](BeastRequest const&) -> BeastResponse {
+        throw std::runtime_error("uh-oh");
+      },
+      exporter);
+  EXPECT_THROW(handler(MakeRequest(kSampled)), std::runtime_error);
+  auto const spans = exporter->spans();
+  ASSERT_EQ(spans.size(), 1);
+  EXPECT_EQ(spans[0].status_code, 500);
+}
+
+TEST(TracingTest, Async) {
+  auto exporter = std::make_shared<TestExporter>();
+  auto handler = MakeTracingAsyncHandler(
+      [](BeastRequest request, AsyncResponseCallback const& callback) {
+        callback(EchoTraceParent(request));
+      },
+      exporter);
+  BeastResponse response;
+  handler(MakeRequest(kSampled),
+          [&](BeastResponse r) { response = std::move(r); });
+  auto const spans = exporter->spans();
+  ASSERT_EQ(spans.size(), 1);
+  EXPECT_EQ(spans[0].status_code, 201);
+  EXPECT_EQ(response.body(), functions::FormatTraceParent(spans[0].context));
+}
+
+TEST(TracingTest, WithTracing) {
+  auto exporter = std::make_shared<TestExporter>();
+  auto function = functions::WithTracing(
+      functions::MakeFunction([](functions::HttpRequest const& request) {
+        auto const context = request.trace_context();
+        return functions::HttpResponse{}.set_payload(
+            context ? context->span_id : std::string{});
+      }),
+      exporter);
+  auto handler = FunctionImpl::GetImpl(function)->GetHandler("/");
+  auto const response = handler(MakeRequest(kSampled));
+  auto const spans = exporter->spans();
+  ASSERT_EQ(spans.size(), 1);
+  EXPECT_EQ(response.body(), spans[0].context.span_id);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
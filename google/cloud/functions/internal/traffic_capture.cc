@@ -0,0 +1,357 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/traffic_capture.h"
+#include "google/cloud/functions/internal/checkpoint.h"
+#include "google/cloud/functions/internal/structured_log.h"
+#include "google/cloud/functions/internal/wrap_request.h"
+#include <algorithm>
+#include <array>
+#include <random>
+#include <stdexcept>
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace be = ::boost::beast;
+
+/// The size of the fixed fields at the start of each record.
+auto constexpr kRecordHeaderSize = 32;
+auto constexpr kRecordAlignment = 8;
+
+/// Requests are dropped while the writer thread is this far behind.
+auto constexpr kMaxQueuedBytes = std::size_t{16} * 1024 * 1024;
+
+/// The headers with credentials, their values are never captured.
+auto constexpr kRedactedHeaders = std::array<std::string_view, 5>{
+    "authorization", "proxy-authorization", "cookie",
+    "x-goog-iap-jwt-assertion", "x-serverless-authorization"};
+
+void PutU32(std::string& out, std::uint32_t value) {
+  for (int i = 0; i != 4; ++i) {
+    out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+  }
+}
+
+void PutU64(std::string& out, std::uint64_t value) {
+  PutU32(out, static_cast<std::uint32_t>(value & 0xFFFFFFFF));
+  PutU32(out, static_cast<std::uint32_t>(value >> 32));
+}
+
+std::uint32_t GetU32(char const* p) {
+  std::uint32_t value = 0;
+  for (int i = 0; i != 4; ++i) {
+    value |= static_cast<std::uint32_t>(static_cast<unsigned char>(p[i]))
+             << (8 * i);
+  }
+  return value;
+}
+
+std::uint64_t GetU64(char const* p) {
+  return GetU32(p) | (static_cast<std::uint64_t>(GetU32(p + 4)) << 32);
+}
+
+std::uint32_t Size32(std::string_view s) {
+  return static_cast<std::uint32_t>(s.size());
+}
+
+std::runtime_error MalformedRecord(std::size_t position) {
+  return std::runtime_error("malformed capture record at offset " +
+                            std::to_string(position));
+}
+
+struct RedactorHolder {
+  std::mutex mu;
+  functions::TrafficCaptureRedactor redactor;
+};
+
+RedactorHolder& Redactor() {
+  static auto* const holder = new RedactorHolder;
+  return *holder;
+}
+
+}  // namespace
+
+std::string_view CaptureFileMagic() { return "FFCAPv1\n"; }
+
+void AppendCaptureRecord(std::string& out, CapturedHttpRequest const& request) {
+  auto const start = out.size();
+  PutU32(out, 0);
+  PutU32(out, static_cast<std::uint32_t>(request.headers.size()));
+  PutU64(out, static_cast<std::uint64_t>(request.offset.count()));
+  PutU32(out, request.version);
+  PutU32(out, Size32(request.method));
+  PutU32(out, Size32(request.target));
+  PutU32(out, Size32(request.body));
+  out.append(request.method);
+  out.append(request.target);
+  for (auto const& [name, value] : request.headers) {
+    PutU32(out, Size32(name));
+    PutU32(out, Size32(value));
+    out.append(name);
+    out.append(value);
+  }
+  out.append(request.body);
+  auto const unaligned = (out.size() - start) % kRecordAlignment;
+  if (unaligned != 0) out.append(kRecordAlignment - unaligned, '\0');
+  auto const size = static_cast<std::uint32_t>(out.size() - start);
+  for (int i = 0; i != 4; ++i) {
+    out[start + i] = static_cast<char>((size >> (8 * i)) & 0xFF);
+  }
+}
+
+TrafficCaptureReader::TrafficCaptureReader(std::string const& path) {
+#ifdef _WIN32
+  std::ifstream is(path, std::ios::binary);
+  if (!is) throw std::runtime_error("cannot open the capture file " + path);
+  buffer_.assign(std::istreambuf_iterator<char>(is),
+                 std::istreambuf_iterator<char>());
+  data_ = buffer_;
+#else
+  auto const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) throw std::runtime_error("cannot open the capture file " + path);
+  struct stat st {};
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw std::runtime_error("cannot read the capture file " + path);
+  }
+  auto const size = static_cast<std::size_t>(st.st_size);
+  if (size != 0) {
+    auto* p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+      ::close(fd);
+      throw std::runtime_error("cannot map the capture file " + path);
+    }
+    mapping_ = p;
+    mapping_size_ = size;
+    data_ = std::string_view(static_cast<char const*>(p), size);
+  }
+  ::close(fd);
+#endif  // _WIN32
+  auto const magic = CaptureFileMagic();
+  if (data_.substr(0, magic.size()) != magic) {
+#ifndef _WIN32
+    if (mapping_ != nullptr) ::munmap(mapping_, mapping_size_);
+#endif  // _WIN32
+    throw std::runtime_error(path + " is not a capture file");
+  }
+  position_ = magic.size();
+}
+
+TrafficCaptureReader::~TrafficCaptureReader() {
+#ifndef _WIN32
+  if (mapping_ != nullptr) ::munmap(mapping_, mapping_size_);
+#endif  // _WIN32
+}
+
+std::optional<CapturedHttpRequest> TrafficCaptureReader::Next() {
+  // A capture stopped abruptly, e.g. by a crash, may end with a partial
+  // record.
+  auto const available = data_.size() - position_;
+  if (available < kRecordHeaderSize) return std::nullopt;
+  auto const* p = data_.data() + position_;
+  auto const size = std::size_t{GetU32(p)};
+  if (size < kRecordHeaderSize || size % kRecordAlignment != 0) {
+    throw MalformedRecord(position_);
+  }
+  if (size > available) return std::nullopt;
+
+  auto const record = std::string_view(p, size);
+  std::size_t offset = kRecordHeaderSize;
+  auto take = [&](std::size_t n) {
+    if (n > size - offset) throw MalformedRecord(position_);
+    auto const s = record.substr(offset, n);
+    offset += n;
+    return s;
+  };
+  CapturedHttpRequest request;
+  auto const header_count = std::size_t{GetU32(p + 4)};
+  request.offset = std::chrono::nanoseconds(GetU64(p + 8));
+  request.version = GetU32(p + 16);
+  auto const method_size = GetU32(p + 20);
+  auto const target_size = GetU32(p + 24);
+  auto const body_size = GetU32(p + 28);
+  request.method = take(method_size);
+  request.target = take(target_size);
+  request.headers.reserve(std::min(header_count, size / kRecordAlignment));
+  for (std::size_t i = 0; i != header_count; ++i) {
+    auto const sizes = take(kRecordAlignment);
+    auto const name = take(GetU32(sizes.data()));
+    auto const value = take(GetU32(sizes.data() + 4));
+    request.headers.emplace_back(name, value);
+  }
+  request.body = take(body_size);
+  position_ += size;
+  return request;
+}
+
+void TrafficCaptureReader::Rewind() {
+  position_ = CaptureFileMagic().size();
+}
+
+BeastRequest ToBeastRequest(CapturedHttpRequest const& request) {
+  BeastRequest r;
+  r.method_string(request.method);
+  r.target(request.target);
+  r.version(request.version);
+  // The body was captured without its transfer encoding.
+  for (auto const& [name, value] : request.headers) {
+    auto const field = be::http::string_to_field(name);
+    if (field == be::http::field::transfer_encoding ||
+        field == be::http::field::content_length) {
+      continue;
+    }
+    r.insert(name, value);
+  }
+  r.body() = std::string(request.body);
+  r.prepare_payload();
+  return r;
+}
+
+TrafficCapture::TrafficCapture(std::string const& path, int sample_rate,
+                               std::uint64_t max_bytes,
+                               functions::TrafficCaptureRedactor redactor)
+    : sample_rate_(std::max(sample_rate, 1)),
+      max_bytes_(max_bytes),
+      redactor_(std::move(redactor)) {
+  file_ = std::fopen(path.c_str(), "wb");
+  if (file_ == nullptr) {
+    throw std::runtime_error("cannot open the capture file " + path);
+  }
+  auto const magic = CaptureFileMagic();
+  std::fwrite(magic.data(), 1, magic.size(), file_);
+  std::fflush(file_);
+  accepted_bytes_ = magic.size();
+  thread_ = std::thread([this] { Run(); });
+}
+
+TrafficCapture::~TrafficCapture() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    shutdown_ = true;
+  }
+  cv_.notify_one();
+  thread_.join();
+  std::fclose(file_);
+  if (auto const dropped = dropped_.load(); dropped != 0) {
+    WriteLog(functions::LogSeverity::kWarning,
+             "Traffic capture dropped " + std::to_string(dropped) +
+                 " sampled requests, captured " +
+                 std::to_string(captured_.load()));
+  }
+}
+
+void TrafficCapture::Capture(BeastRequest const& request) {
+  if (sample_rate_ > 1) {
+    std::uniform_int_distribution<int> sample(0, sample_rate_ - 1);
+    if (sample(ThreadRandomGenerator()) != 0) return;
+  }
+  auto const offset = Clock::now() - start_;
+  auto copy = WrapRequest::wrap(BeastRequest(request));
+  auto& r = WrapRequest::unwrap(copy);
+  for (auto name : kRedactedHeaders) {
+    if (r.find(name) != r.end()) r.set(name, "REDACTED");
+  }
+  if (redactor_) {
+    try {
+      if (!redactor_(copy)) return;
+    } catch (...) {
+      dropped_.fetch_add(1);
+      return;
+    }
+  }
+
+  CapturedHttpRequest captured;
+  captured.offset =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(offset);
+  captured.version = r.version();
+  captured.method = r.method_string();
+  captured.target = r.target();
+  for (auto const& f : r) {
+    captured.headers.emplace_back(f.name_string(), f.value());
+  }
+  captured.body = r.body();
+  std::string record;
+  AppendCaptureRecord(record, captured);
+
+  std::unique_lock<std::mutex> lk(mu_);
+  if (queue_.size() + record.size() > kMaxQueuedBytes ||
+      accepted_bytes_ + record.size() > max_bytes_) {
+    lk.unlock();
+    dropped_.fetch_add(1);
+    return;
+  }
+  accepted_bytes_ += record.size();
+  queue_.append(record);
+  captured_.fetch_add(1);
+  lk.unlock();
+  cv_.notify_one();
+}
+
+void TrafficCapture::Run() {
+  std::unique_lock<std::mutex> lk(mu_);
+  for (;;) {
+    cv_.wait(lk, [this] { return shutdown_ || !queue_.empty(); });
+    if (queue_.empty()) return;
+    auto records = std::exchange(queue_, std::string{});
+    lk.unlock();
+    // Flushing each batch keeps the file readable if the process crashes.
+    std::fwrite(records.data(), 1, records.size(), file_);
+    std::fflush(file_);
+    lk.lock();
+  }
+}
+
+Handler MakeTrafficCaptureHandler(Handler handler,
+                                  std::shared_ptr<TrafficCapture> capture) {
+  return [handler = std::move(handler),
+          capture = std::move(capture)](BeastRequest request) {
+    capture->Capture(request);
+    return handler(std::move(request));
+  };
+}
+
+AsyncHandler MakeTrafficCaptureAsyncHandler(
+    AsyncHandler handler, std::shared_ptr<TrafficCapture> capture) {
+  return [handler = std::move(handler), capture = std::move(capture)](
+             BeastRequest request, AsyncResponseCallback callback) {
+    capture->Capture(request);
+    handler(std::move(request), std::move(callback));
+  };
+}
+
+void SetCurrentTrafficCaptureRedactor(functions::TrafficCaptureRedactor r) {
+  auto& holder = Redactor();
+  std::lock_guard<std::mutex> lk(holder.mu);
+  holder.redactor = std::move(r);
+}
+
+functions::TrafficCaptureRedactor CurrentTrafficCaptureRedactor() {
+  auto& holder = Redactor();
+  std::lock_guard<std::mutex> lk(holder.mu);
+  return holder.redactor;
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
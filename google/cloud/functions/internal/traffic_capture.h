@@ -0,0 +1,171 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_TRAFFIC_CAPTURE_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_TRAFFIC_CAPTURE_H
+
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/traffic_capture.h"
+#include "google/cloud/functions/version.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * A request read from a capture file.
+ *
+ * The strings refer to the file, and are valid while its reader exists.
+ */
+struct CapturedHttpRequest {
+  /// The time the request arrived, relative to the start of the capture.
+  std::chrono::nanoseconds offset{0};
+  /// The HTTP version, e.g. 11 for HTTP/1.1.
+  unsigned version = 11;
+  std::string_view method;
+  std::string_view target;
+  std::vector<std::pair<std::string_view, std::string_view>> headers;
+  std::string_view body;
+};
+
+/**
+ * Encodes @p request as a capture file record.
+ *
+ * All the integers are little-endian, and each record starts at a multiple
+ * of 8 bytes:
+ *
+ * - `u32` the size of the record, including this field and any padding.
+ * - `u32` the number of headers.
+ * - `u64` the offset, in nanoseconds.
+ * - `u32` the HTTP version, and the sizes of the method, target, and body.
+ * - The method and target.
+ * - For each header a `u32` name size, a `u32` value size, the name and the
+ *   value.
+ * - The body, and zero bytes up to the next multiple of 8.
+ */
+void AppendCaptureRecord(std::string& out, CapturedHttpRequest const& request);
+
+/// The first 8 bytes of each capture file.
+std::string_view CaptureFileMagic();
+
+/**
+ * Reads the requests of a capture file, mapped into memory.
+ *
+ * Throws `std::runtime_error` if the file cannot be read, is not a capture
+ * file, or, from `Next()`, if a record is truncated.
+ */
+class TrafficCaptureReader {
+ public:
+  explicit TrafficCaptureReader(std::string const& path);
+  ~TrafficCaptureReader();
+
+  TrafficCaptureReader(TrafficCaptureReader const&) = delete;
+  TrafficCaptureReader& operator=(TrafficCaptureReader const&) = delete;
+
+  /// Returns the next request, or `std::nullopt` after the last one.
+  std::optional<CapturedHttpRequest> Next();
+
+  /// Restarts from the first request.
+  void Rewind();
+
+ private:
+  std::string_view data_;
+  std::size_t position_ = 0;
+  void* mapping_ = nullptr;
+  std::size_t mapping_size_ = 0;
+  std::string buffer_;
+};
+
+/// Returns a copy of @p request that can be sent, or given to a handler.
+BeastRequest ToBeastRequest(CapturedHttpRequest const& request);
+
+/**
+ * Writes a sample of the requests into a capture file.
+ *
+ * `Capture()` keeps 1 in @p sample_rate requests, chosen at random. Each
+ * sampled request is copied, its credentials are redacted, then it is passed
+ * to @p redactor, which may change or drop it, and is queued for a background
+ * thread that appends it to the file. Requests are dropped, and counted,
+ * while the queue is over its limit, and once the file would exceed
+ * @p max_bytes. The requests that are not sampled cost a random number.
+ */
+class TrafficCapture {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  TrafficCapture(std::string const& path, int sample_rate,
+                 std::uint64_t max_bytes,
+                 functions::TrafficCaptureRedactor redactor);
+  /// Writes the queued requests, and closes the file.
+  ~TrafficCapture();
+
+  TrafficCapture(TrafficCapture const&) = delete;
+  TrafficCapture& operator=(TrafficCapture const&) = delete;
+
+  void Capture(BeastRequest const& request);
+
+  /// The number of requests written, or queued to be written.
+  [[nodiscard]] std::uint64_t captured() const { return captured_.load(); }
+  /// The number of sampled requests dropped, other than by the redactor.
+  [[nodiscard]] std::uint64_t dropped() const { return dropped_.load(); }
+
+ private:
+  void Run();
+
+  std::FILE* file_ = nullptr;
+  int const sample_rate_;
+  std::uint64_t const max_bytes_;
+  functions::TrafficCaptureRedactor const redactor_;
+  Clock::time_point const start_ = Clock::now();
+  std::atomic<std::uint64_t> captured_{0};
+  std::atomic<std::uint64_t> dropped_{0};
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::string queue_;
+  std::uint64_t accepted_bytes_ = 0;
+  bool shutdown_ = false;
+  std::thread thread_;
+};
+
+/// Wrap the handlers to pass each request to @p capture.
+///@{
+Handler MakeTrafficCaptureHandler(Handler handler,
+                                  std::shared_ptr<TrafficCapture> capture);
+AsyncHandler MakeTrafficCaptureAsyncHandler(
+    AsyncHandler handler, std::shared_ptr<TrafficCapture> capture);
+///@}
+
+/// Implement `functions::SetTrafficCaptureRedactor()`.
+void SetCurrentTrafficCaptureRedactor(functions::TrafficCaptureRedactor r);
+
+/// The redactor set by `functions::SetTrafficCaptureRedactor()`, if any.
+functions::TrafficCaptureRedactor CurrentTrafficCaptureRedactor();
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_TRAFFIC_CAPTURE_H
@@ -0,0 +1,226 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/traffic_capture.h"
+#include <gmock/gmock.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+std::string CapturePath() {
+  return (std::filesystem::temp_directory_path() /
+          ("traffic_capture_test_" + std::to_string(std::random_device{}())))
+      .string();
+}
+
+BeastRequest MakeRequest(std::string target, std::string body) {
+  BeastRequest request;
+  request.method(boost::beast::http::verb::post);
+  request.target(std::move(target));
+  request.set("content-type", "application/json");
+  request.set("authorization", "Bearer secret");
+  request.set("x-custom", "value");
+  request.body() = std::move(body);
+  request.prepare_payload();
+  return request;
+}
+
+std::vector<CapturedHttpRequest> ReadAll(TrafficCaptureReader& reader) {
+  std::vector<CapturedHttpRequest> requests;
+  while (auto r = reader.Next()) requests.push_back(*std::move(r));
+  return requests;
+}
+
+TEST(TrafficCaptureTest, RecordRoundTrip) {
+  CapturedHttpRequest request;
+  request.offset = std::chrono::nanoseconds(0x1'2345'6789);
+  request.version = 10;
+  request.method = "PUT";
+  request.target = "/a?b=c";
+  request.headers = {{"content-type", "text/plain"}, {"x-empty", ""}};
+  request.body = "hello";
+  auto const path = CapturePath();
+  {
+    std::string data(CaptureFileMagic());
+    AppendCaptureRecord(data, request);
+    EXPECT_EQ(data.size() % 8, 0);
+    AppendCaptureRecord(data, CapturedHttpRequest{});
+    std::ofstream(path, std::ios::binary) << data;
+  }
+
+  TrafficCaptureReader reader(path);
+  auto requests = ReadAll(reader);
+  ASSERT_EQ(requests.size(), 2);
+  auto const& r = requests[0];
+  EXPECT_EQ(r.offset, request.offset);
+  EXPECT_EQ(r.version, 10);
+  EXPECT_EQ(r.method, "PUT");
+  EXPECT_EQ(r.target, "/a?b=c");
+  EXPECT_THAT(r.headers, ElementsAre(Pair("content-type", "text/plain"),
+                                     Pair("x-empty", "")));
+  EXPECT_EQ(r.body, "hello");
+  EXPECT_EQ(requests[1].target, "");
+
+  reader.Rewind();
+  EXPECT_EQ(ReadAll(reader).size(), 2);
+  std::filesystem::remove(path);
+}
+
+TEST(TrafficCaptureTest, TruncatedRecord) {
+  CapturedHttpRequest request;
+  request.method = "GET";
+  request.target = "/";
+  std::string data(CaptureFileMagic());
+  AppendCaptureRecord(data, request);
+  AppendCaptureRecord(data, request);
+  data.resize(data.size() - 8);
+  auto const path = CapturePath();
+  std::ofstream(path, std::ios::binary) << data;
+
+  // A capture stopped by a crash is readable up to its last record.
+  TrafficCaptureReader reader(path);
+  EXPECT_EQ(ReadAll(reader).size(), 1);
+  std::filesystem::remove(path);
+}
+
+TEST(TrafficCaptureTest, MalformedRecord) {
+  CapturedHttpRequest request;
+  request.method = "GET";
+  request.target = "/";
+  std::string data(CaptureFileMagic());
+  AppendCaptureRecord(data, request);
+  // A target size larger than the record.
+  data[CaptureFileMagic().size() + 24] = '\x7F';
+  auto const path = CapturePath();
+  std::ofstream(path, std::ios::binary) << data;
+
+  TrafficCaptureReader reader(path);
+  EXPECT_THROW(reader.Next(), std::runtime_error);
+  std::filesystem::remove(path);
+}
+
+TEST(TrafficCaptureTest, NotACaptureFile) {
+  auto const path = CapturePath();
+  EXPECT_THROW(TrafficCaptureReader{path}, std::runtime_error);
+  std::ofstream(path) << "GET / HTTP/1.1\r\n";
+  EXPECT_THROW(TrafficCaptureReader{path}, std::runtime_error);
+  std::filesystem::remove(path);
+}
+
+TEST(TrafficCaptureTest, Capture) {
+  auto const path = CapturePath();
+  {
+    TrafficCapture capture(path, 1, 1024 * 1024, nullptr);
+    capture.Capture(MakeRequest("/a", "{}"));
+    capture.Capture(MakeRequest("/b", "[1]"));
+    EXPECT_EQ(capture.captured(), 2);
+    EXPECT_EQ(capture.dropped(), 0);
+  }
+
+  TrafficCaptureReader reader(path);
+  auto const requests = ReadAll(reader);
+  ASSERT_EQ(requests.size(), 2);
+  EXPECT_EQ(requests[0].method, "POST");
+  EXPECT_EQ(requests[0].target, "/a");
+  EXPECT_EQ(requests[0].body, "{}");
+  EXPECT_EQ(requests[1].target, "/b");
+  EXPECT_LE(requests[0].offset, requests[1].offset);
+  EXPECT_THAT(requests[0].headers,
+              ElementsAre(Pair("content-type", "application/json"),
+                          Pair("x-custom", "value"),
+                          Pair("Content-Length", "2"),
+                          Pair("authorization", "REDACTED")));
+  std::filesystem::remove(path);
+}
+
+TEST(TrafficCaptureTest, Redactor) {
+  auto const path = CapturePath();
+  {
+    TrafficCapture capture(path, 1, 1024 * 1024,
+                           [](functions::HttpRequest& request) {
+                             if (request.path() == "/drop") return false;
+                             request.remove_header("x-custom");
+                             request.set_payload("redacted");
+                             return true;
+                           });
+    capture.Capture(MakeRequest("/drop", "{}"));
+    capture.Capture(MakeRequest("/keep", "{}"));
+  }
+
+  TrafficCaptureReader reader(path);
+  auto const requests = ReadAll(reader);
+  ASSERT_EQ(requests.size(), 1);
+  EXPECT_EQ(requests[0].target, "/keep");
+  EXPECT_EQ(requests[0].body, "redacted");
+  for (auto const& [name, value] : requests[0].headers) {
+    EXPECT_NE(name, "x-custom");
+  }
+  std::filesystem::remove(path);
+}
+
+TEST(TrafficCaptureTest, MaxBytes) {
+  auto const path = CapturePath();
+  {
+    TrafficCapture capture(path, 1, 512, nullptr);
+    for (int i = 0; i != 10; ++i) {
+      capture.Capture(MakeRequest("/a", std::string(100, 'x')));
+    }
+    EXPECT_GT(capture.captured(), 0);
+    EXPECT_GT(capture.dropped(), 0);
+    EXPECT_EQ(capture.captured() + capture.dropped(), 10);
+  }
+  EXPECT_LE(std::filesystem::file_size(path), 512);
+  std::filesystem::remove(path);
+}
+
+TEST(TrafficCaptureTest, Sampling) {
+  auto const path = CapturePath();
+  TrafficCapture capture(path, 1000000, 1024 * 1024, nullptr);
+  for (int i = 0; i != 100; ++i) capture.Capture(MakeRequest("/a", "{}"));
+  // Very unlikely to sample more than a few.
+  EXPECT_LT(capture.captured(), 5);
+  EXPECT_EQ(capture.dropped(), 0);
+  std::filesystem::remove(path);
+}
+
+TEST(TrafficCaptureTest, ToBeastRequest) {
+  CapturedHttpRequest captured;
+  captured.method = "POST";
+  captured.target = "/upload";
+  captured.headers = {{"Transfer-Encoding", "chunked"},
+                      {"Content-Type", "text/plain"}};
+  captured.body = "hello";
+  auto const request = ToBeastRequest(captured);
+  EXPECT_EQ(request.method(), boost::beast::http::verb::post);
+  EXPECT_EQ(request.target(), "/upload");
+  EXPECT_EQ(request.version(), 11);
+  EXPECT_EQ(request.body(), "hello");
+  EXPECT_EQ(request["content-type"], "text/plain");
+  EXPECT_EQ(request["content-length"], "5");
+  EXPECT_EQ(request.count("transfer-encoding"), 0);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,93 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_TYPED_FUNCTION_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_TYPED_FUNCTION_H
+
+#include "google/cloud/functions/cloud_event.h"
+#include "google/cloud/functions/http_request.h"
+#include "google/cloud/functions/http_response.h"
+#include "google/cloud/functions/version.h"
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+class Function;
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Calls a user-defined callable of any type.
+ *
+ * Unlike `std::function` the callable may be move-only. The framework calls
+ * it through a single virtual function, and the call to the callable itself
+ * is direct and can be inlined.
+ */
+template <typename Signature>
+class UserCallable;
+
+template <typename R, typename... Args>
+class UserCallable<R(Args...)> {
+ public:
+  virtual ~UserCallable() = default;
+  virtual R Call(Args... args) = 0;
+};
+
+template <typename F, typename Signature>
+class UserCallableImpl;
+
+template <typename F, typename R, typename... Args>
+class UserCallableImpl<F, R(Args...)> final : public UserCallable<R(Args...)> {
+ public:
+  explicit UserCallableImpl(F f) : f_(std::move(f)) {}
+
+  R Call(Args... args) override {
+    if constexpr (std::is_void_v<R>) {
+      f_(std::forward<Args>(args)...);
+    } else {
+      return f_(std::forward<Args>(args)...);
+    }
+  }
+
+ private:
+  F f_;
+};
+
+using UserHttpCallable = UserCallable<functions::HttpResponse(
+    functions::HttpRequest)>;
+using UserCloudEventCallable = UserCallable<void(functions::CloudEvent)>;
+
+template <typename F>
+inline constexpr bool kIsTypedHttpFunction =
+    std::is_invocable_r_v<functions::HttpResponse, std::decay_t<F>&,
+                          functions::HttpRequest>;
+
+template <typename F>
+inline constexpr bool kIsTypedCloudEventFunction =
+    !kIsTypedHttpFunction<F> &&
+    std::is_invocable_v<std::decay_t<F>&, functions::CloudEvent>;
+
+functions::Function MakeTypedFunction(std::unique_ptr<UserHttpCallable> f);
+functions::Function MakeTypedFunction(
+    std::unique_ptr<UserCloudEventCallable> f);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_TYPED_FUNCTION_H
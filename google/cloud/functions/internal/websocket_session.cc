@@ -0,0 +1,201 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/websocket_session.h"
+#include "google/cloud/functions/internal/call_user_function.h"
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/beast/core/buffers_to_string.hpp>
+#include <boost/beast/http/write.hpp>
+#include <boost/beast/version.hpp>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace asio = ::boost::asio;
+namespace be = ::boost::beast;
+
+/// Converts the framework timeouts, where 0 means never, to Boost.Beast's.
+std::chrono::steady_clock::duration ToTimeout(std::chrono::seconds timeout) {
+  if (timeout == std::chrono::seconds(0)) {
+    return be::websocket::stream_base::none();
+  }
+  return timeout;
+}
+
+}  // namespace
+
+WebSocketSession::WebSocketSession(
+    asio::generic::stream_protocol::socket socket, WebSocketOptions options,
+    WebSocketHandler const& handler, std::shared_ptr<void> owner)
+    : owner_(std::move(owner)),
+      ws_(std::move(socket)),
+      options_(options),
+      handler_(handler) {}
+
+WebSocketSession::~WebSocketSession() {
+  // Release the request first, it uses memory from the owner.
+  request_.reset();
+}
+
+void WebSocketSession::Start(BeastRequest request) {
+  request_ = std::move(request);
+  auto rejection = handler_(*request_, shared_from_this(), callbacks_);
+  if (rejection) return DoReject(*std::move(rejection));
+
+  be::websocket::stream_base::timeout timeout;
+  timeout.handshake_timeout = ToTimeout(options_.handshake_timeout);
+  // With pings a connection is idle only if the client stops answering.
+  timeout.idle_timeout = ToTimeout(options_.idle_timeout);
+  timeout.keep_alive_pings = true;
+  ws_.set_option(timeout);
+  ws_.set_option(be::websocket::stream_base::decorator(
+      [](be::websocket::response_type& response) {
+        response.set(be::http::field::server, BOOST_BEAST_VERSION_STRING);
+      }));
+  ws_.read_message_max(options_.max_message_size);
+  ws_.async_accept(*request_, [self = shared_from_this()](be::error_code ec) {
+    self->OnAccept(ec);
+  });
+}
+
+void WebSocketSession::Drain() {
+  asio::dispatch(ws_.get_executor(), [self = shared_from_this()] {
+    self->RequestClose(CloseCode::going_away);
+  });
+}
+
+void WebSocketSession::Abort() {
+  asio::dispatch(ws_.get_executor(),
+                 [self = shared_from_this()] { self->Finish(); });
+}
+
+void WebSocketSession::Send(std::string message) {
+  Queue(std::move(message), false);
+}
+
+void WebSocketSession::SendBinary(std::string message) {
+  Queue(std::move(message), true);
+}
+
+void WebSocketSession::Close() {
+  asio::dispatch(ws_.get_executor(), [self = shared_from_this()] {
+    self->RequestClose(CloseCode::normal);
+  });
+}
+
+void WebSocketSession::DoReject(BeastResponse response) {
+  response.version(request_->version());
+  if (response.find(be::http::field::server) == response.end()) {
+    response.set(be::http::field::server, BOOST_BEAST_VERSION_STRING);
+  }
+  response.keep_alive(false);
+  response.prepare_payload();
+  rejection_ = std::move(response);
+  be::http::async_write(
+      ws_.next_layer(), *rejection_,
+      [self = shared_from_this()](be::error_code, std::size_t) {
+        self->Finish();
+      });
+}
+
+void WebSocketSession::OnAccept(be::error_code ec) {
+  if (ec) return Finish();
+  accepted_ = true;
+  DoRead();
+  DoWrite();
+}
+
+void WebSocketSession::DoRead() {
+  ws_.async_read(read_buffer_,
+                 [self = shared_from_this()](be::error_code ec, std::size_t) {
+                   self->OnRead(ec);
+                 });
+}
+
+void WebSocketSession::OnRead(be::error_code ec) {
+  // Closed by either peer, timed out, or a protocol error. Boost.Beast sends
+  // the closing frame, if any.
+  if (ec) return Finish();
+  auto message = be::buffers_to_string(read_buffer_.data());
+  read_buffer_.consume(read_buffer_.size());
+  auto const binary = ws_.got_binary();
+  if (finished_ || closing_ || !callbacks_.on_message) return DoRead();
+  auto const ok = CallUserWebSocketCallback([&] {
+    callbacks_.on_message(std::move(message), binary);
+  });
+  if (!ok) return RequestClose(CloseCode::internal_error);
+  DoRead();
+}
+
+void WebSocketSession::Queue(std::string message, bool binary) {
+  asio::dispatch(ws_.get_executor(),
+                 [self = shared_from_this(), message = std::move(message),
+                  binary]() mutable {
+                   if (self->finished_ || self->close_code_) return;
+                   self->write_queue_.emplace_back(std::move(message), binary);
+                   self->DoWrite();
+                 });
+}
+
+void WebSocketSession::RequestClose(CloseCode code) {
+  if (finished_ || close_code_) return;
+  // An error discards the queued messages, a normal close sends them first.
+  // The message being written must outlive the write.
+  if (code == CloseCode::internal_error) {
+    write_queue_.erase(write_queue_.begin() + (writing_ ? 1 : 0),
+                       write_queue_.end());
+  }
+  close_code_ = code;
+  DoWrite();
+}
+
+void WebSocketSession::DoWrite() {
+  if (!accepted_ || writing_ || closing_ || finished_) return;
+  if (write_queue_.empty()) {
+    if (!close_code_) return;
+    closing_ = true;
+    ws_.async_close(*close_code_,
+                    [self = shared_from_this()](be::error_code) {
+                      self->Finish();
+                    });
+    return;
+  }
+  writing_ = true;
+  auto const& [message, binary] = write_queue_.front();
+  ws_.binary(binary);
+  ws_.async_write(asio::buffer(message),
+                  [self = shared_from_this()](be::error_code ec, std::size_t) {
+                    self->writing_ = false;
+                    if (ec) return self->Finish();
+                    self->write_queue_.pop_front();
+                    self->DoWrite();
+                  });
+}
+
+void WebSocketSession::Finish() {
+  if (finished_) return;
+  finished_ = true;
+  // The callbacks often capture this session, releasing them breaks the
+  // cycle.
+  auto callbacks = std::exchange(callbacks_, {});
+  if (callbacks.on_close) (void)CallUserWebSocketCallback(callbacks.on_close);
+  be::error_code ec;
+  ws_.next_layer().shutdown(asio::socket_base::shutdown_both, ec);
+  ws_.next_layer().close(ec);
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,118 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_WEBSOCKET_SESSION_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_WEBSOCKET_SESSION_H
+
+#include "google/cloud/functions/internal/function_impl.h"
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/version.h"
+#include "google/cloud/functions/websocket.h"
+#include <boost/asio/generic/stream_protocol.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/websocket.hpp>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// The configuration for WebSocket sessions.
+struct WebSocketOptions {
+  /// Close the connection after this long without traffic, 0 means never.
+  std::chrono::seconds idle_timeout;
+  /// Close the connection if the closing handshake takes longer than this.
+  std::chrono::seconds handshake_timeout;
+  std::uint64_t max_message_size;
+};
+
+/**
+ * Serves a WebSocket connection upgraded from HTTP/1.1.
+ *
+ * The session calls @p handler with the upgrade request. If the handler
+ * returns a response the session sends it, and closes the connection.
+ * Otherwise the session completes the opening handshake, and calls the
+ * callbacks set by the handler for each message, and once the connection
+ * closes.
+ *
+ * The messages are read and written in the strand of the socket, the user
+ * callbacks run in that strand too.
+ *
+ * The session keeps @p owner alive until the connection closes.
+ */
+class WebSocketSession
+    : public functions::WebSocket,
+      public std::enable_shared_from_this<WebSocketSession> {
+ public:
+  WebSocketSession(boost::asio::generic::stream_protocol::socket socket,
+                   WebSocketOptions options, WebSocketHandler const& handler,
+                   std::shared_ptr<void> owner);
+  ~WebSocketSession() override;
+
+  WebSocketSession(WebSocketSession const&) = delete;
+  WebSocketSession& operator=(WebSocketSession const&) = delete;
+
+  /// Calls the handler for @p request, and accepts or rejects the upgrade.
+  void Start(BeastRequest request);
+
+  /// Closes the connection with `1001 Going Away`, after the queued messages.
+  void Drain();
+
+  /// Closes the connection, without a closing handshake.
+  void Abort();
+
+  void Send(std::string message) override;
+  void SendBinary(std::string message) override;
+  void Close() override;
+
+ private:
+  using CloseCode = boost::beast::websocket::close_code;
+
+  void DoReject(BeastResponse response);
+  void OnAccept(boost::beast::error_code ec);
+  void DoRead();
+  void OnRead(boost::beast::error_code ec);
+  void Queue(std::string message, bool binary);
+  void RequestClose(CloseCode code);
+  void DoWrite();
+  void Finish();
+
+  // Released last, the owner holds the memory used by the upgrade request.
+  std::shared_ptr<void> owner_;
+  boost::beast::websocket::stream<
+      boost::asio::generic::stream_protocol::socket>
+      ws_;
+  WebSocketOptions options_;
+  WebSocketHandler const& handler_;
+  std::optional<BeastRequest> request_;
+  std::optional<BeastResponse> rejection_;
+  functions::WebSocketCallbacks callbacks_;
+  boost::beast::flat_buffer read_buffer_;
+  std::deque<std::pair<std::string, bool>> write_queue_;
+  std::optional<CloseCode> close_code_;
+  bool accepted_ = false;
+  bool writing_ = false;
+  bool closing_ = false;
+  bool finished_ = false;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_WEBSOCKET_SESSION_H
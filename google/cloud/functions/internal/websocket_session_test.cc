@@ -0,0 +1,231 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/websocket_session.h"
+#include "google/cloud/functions/internal/framework_impl.h"
+#include "google/cloud/functions/framework.h"
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/websocket.hpp>
+#include <gmock/gmock.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace be = ::boost::beast;
+using tcp = ::boost::asio::ip::tcp;
+using WebSocketClient = be::websocket::stream<tcp::socket>;
+
+class TestServer {
+ public:
+  explicit TestServer(functions::Function function) {
+    auto port_f = port_.get_future();
+    done_ = std::async(std::launch::async, [this, f = std::move(function)] {
+      char const* const argv[] = {"unused", "--port=0", "--threads=4",
+                                  "--max-body-size=1024"};
+      auto constexpr kArgc = sizeof(argv) / sizeof(argv[0]);
+      return RunForTest(
+          static_cast<int>(kArgc), argv, f,
+          [this] { return shutdown_.load(); },
+          [this](int port) { port_.set_value(port); });
+    });
+    port_number_ = std::to_string(port_f.get());
+  }
+
+  ~TestServer() {
+    shutdown_.store(true);
+    try {
+      // Wake up the listener, so it detects the shutdown.
+      (void)Connect();
+    } catch (...) {
+    }
+    EXPECT_EQ(done_.get(), 0);
+  }
+
+  tcp::socket Connect() {
+    tcp::resolver resolver(ioc_);
+    tcp::socket socket(ioc_);
+    boost::asio::connect(socket, resolver.resolve("localhost", port_number_));
+    return socket;
+  }
+
+ private:
+  boost::asio::io_context ioc_;
+  std::promise<int> port_;
+  std::string port_number_;
+  std::atomic<bool> shutdown_{false};
+  std::future<int> done_;
+};
+
+/// Echoes each message, prefixed with the request target.
+functions::Function EchoFunction(std::shared_ptr<std::promise<void>> closed) {
+  return functions::MakeWebSocketFunction(
+      [closed](functions::HttpRequest const& request,
+               std::shared_ptr<functions::WebSocket> socket) {
+        if (request.target() == "/throw") throw std::runtime_error("uh-oh");
+        return functions::WebSocketCallbacks{
+            [target = request.target(), socket](
+                std::string message, bool binary) {
+              if (message == "throw") throw std::runtime_error("uh-oh");
+              if (message == "close") return socket->Close();
+              if (binary) return socket->SendBinary(std::move(message));
+              socket->Send(target + " " + message);
+            },
+            [closed] { closed->set_value(); }};
+      });
+}
+
+std::string Read(WebSocketClient& ws) {
+  be::flat_buffer buffer;
+  ws.read(buffer);
+  return be::buffers_to_string(buffer.data());
+}
+
+TEST(WebSocketSessionTest, Echo) {
+  auto closed = std::make_shared<std::promise<void>>();
+  auto closed_f = closed->get_future();
+  TestServer server(EchoFunction(closed));
+  WebSocketClient ws(server.Connect());
+  be::websocket::response_type response;
+  ws.handshake(response, "localhost", "/echo");
+  EXPECT_EQ(response.result(), be::http::status::switching_protocols);
+  EXPECT_EQ(response[be::http::field::server], BOOST_BEAST_VERSION_STRING);
+
+  ws.write(boost::asio::buffer(std::string("hello")));
+  EXPECT_EQ(Read(ws), "/echo hello");
+  EXPECT_FALSE(ws.got_binary());
+  ws.binary(true);
+  ws.write(boost::asio::buffer(std::string("\x00\x01\x02", 3)));
+  EXPECT_EQ(Read(ws), std::string("\x00\x01\x02", 3));
+  EXPECT_TRUE(ws.got_binary());
+
+  ws.close(be::websocket::close_code::normal);
+  EXPECT_EQ(closed_f.wait_for(std::chrono::seconds(5)),
+            std::future_status::ready);
+}
+
+TEST(WebSocketSessionTest, ServerClose) {
+  auto closed = std::make_shared<std::promise<void>>();
+  TestServer server(EchoFunction(closed));
+  WebSocketClient ws(server.Connect());
+  ws.handshake("localhost", "/");
+  ws.write(boost::asio::buffer(std::string("close")));
+  be::flat_buffer buffer;
+  be::error_code ec;
+  ws.read(buffer, ec);
+  EXPECT_EQ(ec, be::websocket::error::closed);
+  EXPECT_EQ(ws.reason().code, be::websocket::close_code::normal);
+}
+
+TEST(WebSocketSessionTest, CallbackException) {
+  auto closed = std::make_shared<std::promise<void>>();
+  TestServer server(EchoFunction(closed));
+  WebSocketClient ws(server.Connect());
+  ws.handshake("localhost", "/");
+  ws.write(boost::asio::buffer(std::string("throw")));
+  be::flat_buffer buffer;
+  be::error_code ec;
+  ws.read(buffer, ec);
+  EXPECT_EQ(ec, be::websocket::error::closed);
+  EXPECT_EQ(ws.reason().code, be::websocket::close_code::internal_error);
+}
+
+TEST(WebSocketSessionTest, MessageTooLarge) {
+  auto closed = std::make_shared<std::promise<void>>();
+  TestServer server(EchoFunction(closed));
+  WebSocketClient ws(server.Connect());
+  ws.handshake("localhost", "/");
+  ws.write(boost::asio::buffer(std::string(2048, 'x')));
+  be::flat_buffer buffer;
+  be::error_code ec;
+  ws.read(buffer, ec);
+  // The server may reset the connection before the closing frame arrives, it
+  // does not read the rest of the message.
+  ASSERT_TRUE(ec);
+  if (ec == be::websocket::error::closed) {
+    EXPECT_EQ(ws.reason().code, be::websocket::close_code::too_big);
+  }
+}
+
+TEST(WebSocketSessionTest, FunctionException) {
+  auto closed = std::make_shared<std::promise<void>>();
+  TestServer server(EchoFunction(closed));
+  auto socket = server.Connect();
+  be::http::request<be::http::empty_body> request{be::http::verb::get,
+                                                  "/throw", 11};
+  request.set(be::http::field::host, "localhost");
+  request.set(be::http::field::connection, "Upgrade");
+  request.set(be::http::field::upgrade, "websocket");
+  request.set(be::http::field::sec_websocket_version, "13");
+  request.set(be::http::field::sec_websocket_key, "dGhlIHNhbXBsZSBub25jZQ==");
+  be::http::write(socket, request);
+  be::flat_buffer buffer;
+  be::http::response<be::http::string_body> response;
+  be::http::read(socket, buffer, response);
+  EXPECT_EQ(response.result(), be::http::status::internal_server_error);
+  EXPECT_FALSE(response.keep_alive());
+}
+
+TEST(WebSocketSessionTest, NotAnUpgrade) {
+  auto closed = std::make_shared<std::promise<void>>();
+  TestServer server(EchoFunction(closed));
+  auto socket = server.Connect();
+  be::http::request<be::http::empty_body> request{be::http::verb::get, "/",
+                                                  11};
+  request.set(be::http::field::host, "localhost");
+  be::http::write(socket, request);
+  be::flat_buffer buffer;
+  be::http::response<be::http::string_body> response;
+  be::http::read(socket, buffer, response);
+  EXPECT_EQ(response.result(), be::http::status::upgrade_required);
+  EXPECT_EQ(response[be::http::field::upgrade], "websocket");
+}
+
+TEST(WebSocketSessionTest, HttpFallback) {
+  auto function = functions::MakeWebSocketFunction(
+      [](functions::HttpRequest const&,
+         std::shared_ptr<functions::WebSocket> const&) {
+        return functions::WebSocketCallbacks{};
+      },
+      functions::MakeFunction([](functions::HttpRequest const&) {
+        return functions::HttpResponse{}.set_payload("plain HTTP");
+      }));
+  TestServer server(std::move(function));
+  auto socket = server.Connect();
+  be::http::request<be::http::empty_body> request{be::http::verb::get, "/",
+                                                  11};
+  request.set(be::http::field::host, "localhost");
+  be::http::write(socket, request);
+  be::flat_buffer buffer;
+  be::http::response<be::http::string_body> response;
+  be::http::read(socket, buffer, response);
+  EXPECT_EQ(response.result(), be::http::status::ok);
+  EXPECT_EQ(response.body(), "plain HTTP");
+
+  WebSocketClient ws(server.Connect());
+  ws.handshake("localhost", "/");
+  ws.close(be::websocket::close_code::normal);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
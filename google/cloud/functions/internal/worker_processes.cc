@@ -0,0 +1,248 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/worker_processes.h"
+#include "google/cloud/functions/internal/structured_log.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif  // _WIN32
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif  // __linux__
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+#ifndef _WIN32
+
+using Clock = std::chrono::steady_clock;
+
+// The signal handlers only write the signal number to this pipe, the
+// supervisor loop reads it.
+int signal_pipe_write = -1;
+
+void OnSupervisorSignal(int signo) {
+  auto const saved = errno;
+  auto const c = static_cast<char>(signo);
+  (void)!::write(signal_pipe_write, &c, 1);
+  errno = saved;
+}
+
+std::system_error SystemError(char const* what) {
+  return std::system_error(errno, std::generic_category(), what);
+}
+
+/// Installs the supervisor signal handlers, and restores them on destruction.
+class SignalPipe {
+ public:
+  SignalPipe() {
+    int fds[2];
+    if (::pipe(fds) != 0) throw SystemError("pipe()");
+    read_ = fds[0];
+    write_ = fds[1];
+    for (auto fd : fds) {
+      ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+      ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+    signal_pipe_write = write_;
+    struct sigaction action {};
+    action.sa_handler = OnSupervisorSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    for (std::size_t i = 0; i != kSignals.size(); ++i) {
+      ::sigaction(kSignals[i], &action, &previous_[i]);
+    }
+  }
+  ~SignalPipe() { Release(); }
+
+  SignalPipe(SignalPipe const&) = delete;
+  SignalPipe& operator=(SignalPipe const&) = delete;
+
+  [[nodiscard]] int fd() const { return read_; }
+
+  /// Restores the signal handlers and closes the pipe, the worker processes
+  /// call this before running the worker.
+  void Release() {
+    if (read_ == -1) return;
+    for (std::size_t i = 0; i != kSignals.size(); ++i) {
+      ::sigaction(kSignals[i], &previous_[i], nullptr);
+    }
+    signal_pipe_write = -1;
+    ::close(read_);
+    ::close(write_);
+    read_ = -1;
+    write_ = -1;
+  }
+
+ private:
+  static constexpr std::array<int, 3> kSignals = {SIGTERM, SIGINT, SIGCHLD};
+  int read_ = -1;
+  int write_ = -1;
+  std::array<struct sigaction, 3> previous_{};
+};
+
+struct WorkerProcess {
+  /// The process id, 0 if the worker is not running.
+  pid_t pid = 0;
+  Clock::time_point started;
+  /// If set, start the worker at this time.
+  std::optional<Clock::time_point> start_at;
+};
+
+std::string DescribeStatus(int status) {
+  if (WIFEXITED(status)) {
+    return "exited with status " + std::to_string(WEXITSTATUS(status));
+  }
+  if (WIFSIGNALED(status)) {
+    return "was terminated by signal " + std::to_string(WTERMSIG(status));
+  }
+  return "stopped with wait status " + std::to_string(status);
+}
+
+void LogWorker(functions::LogSeverity severity, int index, pid_t pid,
+               std::string const& what) {
+  WriteLog(severity, "Worker process " + std::to_string(index) + " (pid " +
+                         std::to_string(pid) + ") " + what);
+}
+
+#endif  // _WIN32
+}  // namespace
+
+int RunWorkerProcesses(WorkerProcessOptions const& options,
+                       std::function<int(int index)> const& worker) {
+#ifdef _WIN32
+  (void)options;
+  (void)worker;
+  throw std::invalid_argument(
+      "multiple worker processes are not supported on this platform");
+#else
+  if (options.processes <= 0) {
+    throw std::invalid_argument("the number of processes must be positive");
+  }
+  SignalPipe signals;
+  auto const parent = ::getpid();
+  std::vector<WorkerProcess> workers(options.processes);
+  for (auto& w : workers) w.start_at = Clock::now();
+  bool stopping = false;
+  auto stop_all = [&] {
+    stopping = true;
+    for (auto& w : workers) {
+      w.start_at.reset();
+      if (w.pid != 0) ::kill(w.pid, SIGTERM);
+    }
+  };
+
+  while (true) {
+    for (int i = 0; i != options.processes; ++i) {
+      auto& w = workers[i];
+      if (w.pid == 0) continue;
+      int status = 0;
+      auto const r = ::waitpid(w.pid, &status, WNOHANG);
+      if (r == 0 || (r < 0 && errno == EINTR)) continue;
+      auto const pid = w.pid;
+      w.pid = 0;
+      if (stopping) continue;
+      if (r > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        // A graceful stop, for example the worker received `SIGTERM`
+        // directly. Do not leave the other workers running.
+        LogWorker(functions::LogSeverity::kInfo, i, pid,
+                  "stopped, stopping all workers");
+        stop_all();
+        continue;
+      }
+      LogWorker(functions::LogSeverity::kWarning, i, pid,
+                (r > 0 ? DescribeStatus(status) : "is gone") + ", restarting");
+      w.start_at = std::max(Clock::now(),
+                            w.started + options.min_restart_interval);
+    }
+    if (stopping && std::none_of(workers.begin(), workers.end(),
+                                 [](auto const& w) { return w.pid != 0; })) {
+      return 0;
+    }
+
+    auto timeout = std::optional<Clock::duration>();
+    for (int i = 0; i != options.processes; ++i) {
+      auto& w = workers[i];
+      if (!w.start_at) continue;
+      auto const now = Clock::now();
+      if (*w.start_at > now) {
+        auto const wait = *w.start_at - now;
+        timeout = timeout ? std::min(*timeout, wait) : wait;
+        continue;
+      }
+      // Any buffered output would be written by the parent and the child.
+      std::cout.flush();
+      std::cerr.flush();
+      std::fflush(nullptr);
+      auto const pid = ::fork();
+      if (pid == 0) {
+        signals.Release();
+#ifdef __linux__
+        // Do not leave orphan workers if the supervisor is killed.
+        ::prctl(PR_SET_PDEATHSIG, SIGTERM);
+        if (::getppid() != parent) return 1;
+#endif  // __linux__
+        return worker(i);
+      }
+      w.start_at.reset();
+      if (pid < 0) {
+        auto const ec = std::error_code(errno, std::generic_category());
+        WriteLog(functions::LogSeverity::kError,
+                 "Cannot start worker process " + std::to_string(i) + ": " +
+                     ec.message());
+        w.start_at = now + options.min_restart_interval;
+        continue;
+      }
+      w.pid = pid;
+      w.started = now;
+    }
+
+    auto const timeout_ms =
+        timeout ? static_cast<int>(
+                      std::chrono::ceil<std::chrono::milliseconds>(*timeout)
+                          .count())
+                : -1;
+    pollfd pfd{signals.fd(), POLLIN, 0};
+    if (::poll(&pfd, 1, timeout_ms) <= 0) continue;
+    char buffer[64];
+    for (auto n = ::read(signals.fd(), buffer, sizeof(buffer)); n > 0;
+         n = ::read(signals.fd(), buffer, sizeof(buffer))) {
+      for (auto const* c = buffer; c != buffer + n; ++c) {
+        if (*c == SIGCHLD || stopping) continue;
+        WriteLog(functions::LogSeverity::kInfo,
+                 "Stopping the worker processes");
+        stop_all();
+      }
+    }
+  }
+#endif  // _WIN32
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
@@ -0,0 +1,59 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_WORKER_PROCESSES_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_WORKER_PROCESSES_H
+
+#include "google/cloud/functions/version.h"
+#include <chrono>
+#include <functional>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// Configure `RunWorkerProcesses()`.
+struct WorkerProcessOptions {
+  /// The number of worker processes.
+  int processes = 1;
+  /// A worker that exits with an error is restarted, but not sooner than this
+  /// after its previous start.
+  std::chrono::milliseconds min_restart_interval = std::chrono::seconds(1);
+};
+
+/**
+ * Runs @p worker in `options.processes` child processes, and supervises them.
+ *
+ * Each child process calls `worker(index)` and this function returns its
+ * result, the caller should return from `main()` or exit with that value. In
+ * the parent process this function returns once all the workers have stopped.
+ *
+ * A worker that exits with an error, or due to a signal, is restarted with the
+ * same index. A worker that exits with 0 stopped gracefully, and the parent
+ * stops all the other workers. If the parent receives `SIGTERM` or `SIGINT`
+ * it sends `SIGTERM` to all the workers, and waits for them.
+ *
+ * The workers inherit all the open file descriptors, such as a listening
+ * socket, but not the threads. Call this function before creating any
+ * threads. Only supported on POSIX platforms.
+ *
+ * @throws std::invalid_argument on other platforms.
+ * @throws std::system_error if the parent cannot create the processes.
+ */
+int RunWorkerProcesses(WorkerProcessOptions const& options,
+                       std::function<int(int index)> const& worker);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_INTERNAL_WORKER_PROCESSES_H
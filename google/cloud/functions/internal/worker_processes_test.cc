@@ -0,0 +1,137 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/internal/worker_processes.h"
+#include <gmock/gmock.h>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#ifndef _WIN32
+#include <csignal>
+#include <unistd.h>
+#endif  // _WIN32
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using std::chrono::milliseconds;
+
+#ifndef _WIN32
+
+/// A directory shared by the test and its worker processes.
+class WorkerDirectory {
+ public:
+  WorkerDirectory()
+      : path_(std::filesystem::temp_directory_path() /
+              ("worker_processes_test_" + std::to_string(::getpid()) + "_" +
+               std::to_string(std::rand()))) {
+    std::filesystem::create_directories(path_);
+  }
+  ~WorkerDirectory() {
+    std::error_code ec;
+    std::filesystem::remove_all(path_, ec);
+  }
+
+  void Touch(std::string const& name) const {
+    std::ofstream(path_ / name) << "";
+  }
+  [[nodiscard]] bool Exists(std::string const& name) const {
+    return std::filesystem::exists(path_ / name);
+  }
+  [[nodiscard]] int Count() const {
+    return static_cast<int>(std::distance(
+        std::filesystem::directory_iterator(path_),
+        std::filesystem::directory_iterator()));
+  }
+
+ private:
+  std::filesystem::path path_;
+};
+
+/// The worker processes must not return into the test framework.
+[[noreturn]] void Sleep() {
+  for (;;) std::this_thread::sleep_for(milliseconds(10));
+}
+
+TEST(WorkerProcessesTest, RunsAllWorkers) {
+  WorkerDirectory directory;
+  auto const result = RunWorkerProcesses({3}, [&](int index) -> int {
+    directory.Touch("worker-" + std::to_string(index));
+    if (index != 0) Sleep();
+    // Once all the workers are running, a graceful stop of one worker stops
+    // the others.
+    while (directory.Count() != 3) std::this_thread::sleep_for(milliseconds(1));
+    ::_exit(0);
+  });
+  EXPECT_EQ(result, 0);
+  EXPECT_TRUE(directory.Exists("worker-0"));
+  EXPECT_TRUE(directory.Exists("worker-1"));
+  EXPECT_TRUE(directory.Exists("worker-2"));
+}
+
+TEST(WorkerProcessesTest, RestartsFailedWorkers) {
+  WorkerDirectory directory;
+  auto const start = std::chrono::steady_clock::now();
+  auto const result =
+      RunWorkerProcesses({1, milliseconds(50)}, [&](int /*index*/) -> int {
+        auto const attempt = directory.Count();
+        directory.Touch("attempt-" + std::to_string(attempt));
+        if (attempt == 0) ::_exit(1);
+        if (attempt == 1) ::raise(SIGKILL);
+        ::_exit(0);
+      });
+  EXPECT_EQ(result, 0);
+  EXPECT_EQ(directory.Count(), 3);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, milliseconds(100));
+}
+
+TEST(WorkerProcessesTest, StopsOnSigterm) {
+  WorkerDirectory directory;
+  auto const parent = ::getpid();
+  auto const result = RunWorkerProcesses({2}, [&](int index) -> int {
+    directory.Touch("worker-" + std::to_string(index));
+    if (index == 0) {
+      while (directory.Count() != 2) {
+        std::this_thread::sleep_for(milliseconds(1));
+      }
+      ::kill(parent, SIGTERM);
+    }
+    Sleep();
+  });
+  EXPECT_EQ(result, 0);
+  EXPECT_EQ(directory.Count(), 2);
+}
+
+TEST(WorkerProcessesTest, InvalidProcesses) {
+  EXPECT_THROW(RunWorkerProcesses({0}, [](int) { return 0; }),
+               std::invalid_argument);
+}
+
+#else
+
+TEST(WorkerProcessesTest, NotSupported) {
+  EXPECT_THROW(RunWorkerProcesses({2}, [](int) { return 0; }),
+               std::invalid_argument);
+}
+
+#endif  // _WIN32
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
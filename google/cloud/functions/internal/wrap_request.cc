@@ -13,24 +13,16 @@
 // limitations under the License.
 
 #include "google/cloud/functions/internal/wrap_request.h"
+#include "google/cloud/functions/internal/body_checksums.h"
+#include "google/cloud/functions/internal/cancellation.h"
 #include "google/cloud/functions/http_request.h"
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 
 ::google::cloud::functions::HttpRequest MakeHttpRequest(BeastRequest request) {
-  auto constexpr kBeastHttpVersionFactor = 10;
-  auto const version = static_cast<int>(request.version());
-  auto r = ::google::cloud::functions::HttpRequest{}
-               .set_verb(std::string(request.method_string()))
-               .set_target(std::string(request.target()))
-               .set_version(version / kBeastHttpVersionFactor,
-                            version % kBeastHttpVersionFactor);
-  for (auto const& h : request.base()) {
-    r.add_header(std::string(h.name_string()), std::string(h.value()));
-  }
-  r.set_payload(std::move(request).body());
-  return r;
+  return WrapRequest::wrap(std::move(request), CurrentCancellation(),
+                           CurrentBodyChecksums());
 }
 
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
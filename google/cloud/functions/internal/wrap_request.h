@@ -18,11 +18,61 @@
 #include "google/cloud/functions/internal/http_message_types.h"
 #include "google/cloud/functions/http_request.h"
 #include "google/cloud/functions/version.h"
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 
-/// Wrap a Boost.Beast request into a functions framework HTTP request.
+class CancellationState;
+struct BodyChecksumState;
+
+/// The state of a `functions::HttpRequest`.
+struct HttpRequestImpl {
+  BeastRequest request;
+  /// The headers in the format returned by `headers()`, created on demand.
+  std::mutex headers_mu;
+  std::optional<functions::HttpRequest::HeadersType> headers;
+  /// The query parameters, parsed on demand.
+  std::mutex query_mu;
+  std::optional<functions::HttpRequest::QueryParametersType> query;
+  /// The arena returned by `memory_resource()`, created on demand. It is
+  /// declared after `request`, and released before its allocator.
+  std::mutex arena_mu;
+  std::optional<std::pmr::monotonic_buffer_resource> arena;
+  /// The state returned by `cancellation_token()`, if any.
+  std::shared_ptr<CancellationState> cancellation;
+  /// The state returned by `body_checksums()`, if any.
+  std::shared_ptr<BodyChecksumState const> checksums;
+};
+
+struct WrapRequest {
+  static functions::HttpRequest wrap(
+      BeastRequest request,
+      std::shared_ptr<CancellationState> cancellation = nullptr,
+      std::shared_ptr<BodyChecksumState const> checksums = nullptr) {
+    auto impl = std::make_unique<HttpRequestImpl>();
+    impl->request = std::move(request);
+    impl->cancellation = std::move(cancellation);
+    impl->checksums = std::move(checksums);
+    return functions::HttpRequest(std::move(impl));
+  }
+  static BeastRequest& unwrap(functions::HttpRequest& request) {
+    return request.impl_->request;
+  }
+  static BeastRequest const& unwrap(functions::HttpRequest const& request) {
+    return request.impl_->request;
+  }
+};
+
+/**
+ * Wrap a Boost.Beast request into a functions framework HTTP request.
+ *
+ * The request gets the cancellation state, and the body checksums, of the
+ * current thread, if any.
+ */
 ::google::cloud::functions::HttpRequest MakeHttpRequest(BeastRequest request);
 
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
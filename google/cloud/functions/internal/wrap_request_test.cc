@@ -14,6 +14,10 @@
 
 #include "google/cloud/functions/internal/wrap_request.h"
 #include <gmock/gmock.h>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
@@ -40,6 +44,105 @@ TEST(WrapRequestTest, Basic) {
   EXPECT_EQ(actual.version_minor(), 1);
 }
 
+/// A memory resource that counts the allocations it performs.
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  [[nodiscard]] int allocations() const { return allocations_; }
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    ++allocations_;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* p, std::size_t bytes,
+                     std::size_t alignment) override {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  [[nodiscard]] bool do_is_equal(
+      std::pmr::memory_resource const& other) const noexcept override {
+    return this == &other;
+  }
+
+  int allocations_ = 0;
+};
+
+TEST(WrapRequestTest, FieldsAllocator) {
+  CountingResource resource;
+  BeastRequest br(
+      std::piecewise_construct, std::make_tuple(),
+      std::make_tuple(BeastRequestFields::allocator_type(&resource)));
+  br.set("content-type", "application/json");
+  br.set("x-goog-test", "test-value");
+  br.target("/some/random/target");
+  EXPECT_NE(resource.allocations(), 0);
+
+  auto actual = MakeHttpRequest(std::move(br));
+  EXPECT_EQ(actual.target(), "/some/random/target");
+  EXPECT_THAT(actual.headers(),
+              ElementsAre(std::make_pair("content-type", "application/json"),
+                          std::make_pair("x-goog-test", "test-value")));
+
+  // Copies do not use the connection's memory.
+  auto const allocations = resource.allocations();
+  auto const copy = actual;
+  EXPECT_EQ(resource.allocations(), allocations);
+  EXPECT_EQ(copy.target(), "/some/random/target");
+  EXPECT_EQ(copy.header("x-goog-test"), "test-value");
+}
+
+TEST(WrapRequestTest, SharedFieldsPool) {
+  auto pool = std::make_shared<CountingResource>();
+  std::weak_ptr<CountingResource> const weak = pool;
+  BeastRequest br(std::piecewise_construct, std::make_tuple(),
+                  std::make_tuple(BeastRequestFields::allocator_type(
+                      std::shared_ptr<std::pmr::memory_resource>(pool))));
+  br.set("x-goog-test", "test-value");
+  auto actual = MakeHttpRequest(std::move(br));
+
+  // The request keeps the pool alive after its connection is closed.
+  pool.reset();
+  EXPECT_FALSE(weak.expired());
+  EXPECT_EQ(actual.header("x-goog-test"), "test-value");
+  actual = functions::HttpRequest{};
+  EXPECT_TRUE(weak.expired());
+}
+
+TEST(WrapRequestTest, MemoryResource) {
+  CountingResource resource;
+  BeastRequest br(
+      std::piecewise_construct, std::make_tuple(),
+      std::make_tuple(BeastRequestFields::allocator_type(&resource)));
+  auto const actual = MakeHttpRequest(std::move(br));
+
+  // The arena obtains its memory from the connection.
+  auto const allocations = resource.allocations();
+  auto* arena = actual.memory_resource();
+  ASSERT_NE(arena, nullptr);
+  EXPECT_EQ(actual.memory_resource(), arena);
+  std::pmr::vector<std::pmr::string> values(arena);
+  for (int i = 0; i != 16; ++i) values.emplace_back(std::string(64, 'a'));
+  EXPECT_NE(resource.allocations(), allocations);
+
+  // Copies have their own arena.
+  auto const copy = actual;
+  EXPECT_NE(copy.memory_resource(), arena);
+}
+
+TEST(WrapRequestTest, NoCopy) {
+  BeastRequest br;
+  br.set("x-goog-test", "test-value");
+  br.target("/some/random/target");
+  // Use a payload large enough to avoid the small string optimization.
+  br.body() = std::string(1024, 'a');
+  auto const* target = br.target().data();
+  auto const* payload = br.body().data();
+
+  auto const actual = MakeHttpRequest(std::move(br));
+  EXPECT_EQ(actual.target_view().data(), target);
+  EXPECT_EQ(actual.payload().data(), payload);
+  EXPECT_EQ(actual.header("x-goog-test"), "test-value");
+}
+
 }  // namespace
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions_internal
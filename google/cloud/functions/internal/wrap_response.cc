@@ -16,10 +16,37 @@
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+auto constexpr kBeastHttpVersionFactor = 10;
+}  // namespace
 
-/// Wrap a Boost.Beast request into a functions framework HTTP request.
-std::shared_ptr<functions::HttpResponse::Impl> MakeHttpResponse() {
-  return std::make_shared<WrapResponseImpl>();
+BeastResponse UnwrapResponse::unwrap(functions::HttpResponse response) {
+  if (!response.custom_) return std::move(response.impl_->response);
+  auto const& custom = *response.custom_;
+  BeastResponse r;
+  r.result(custom.result());
+  r.version(custom.version_major() * kBeastHttpVersionFactor +
+            custom.version_minor());
+  for (auto const& [name, value] : custom.headers()) r.insert(name, value);
+  r.body() = custom.payload();
+  return r;
+}
+
+functions::HttpResponse UnwrapResponse::wrap(BeastResponse response) {
+  functions::HttpResponse r;
+  r.impl_->response = std::move(response);
+  return r;
+}
+
+void UnwrapResponse::set_header(functions::HttpResponse& response,
+                                boost::beast::http::field name,
+                                std::string_view value) {
+  if (response.custom_) {
+    auto const n = boost::beast::http::to_string(name);
+    response.set_header(std::string_view(n.data(), n.size()), value);
+  } else {
+    response.impl_->response.set(name, value);
+  }
 }
 
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
@@ -18,57 +18,44 @@
 #include "google/cloud/functions/internal/http_message_types.h"
 #include "google/cloud/functions/http_response.h"
 #include "google/cloud/functions/version.h"
+#include <boost/beast/http/field.hpp>
+#include <mutex>
+#include <optional>
+#include <string_view>
 
 namespace google::cloud::functions_internal {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 
-struct UnwrapResponse;
-
-class WrapResponseImpl : public google::cloud::functions::HttpResponse::Impl {
- public:
-  using Headers = google::cloud::functions::HttpResponse::HeadersType;
-
-  WrapResponseImpl() = default;
-  ~WrapResponseImpl() override = default;
-
-  void set_payload(std::string v) override { response_.body() = std::move(v); }
-  [[nodiscard]] std::string const& payload() const override {
-    return response_.body();
-  }
-  void set_result(int code) override { response_.result(code); }
-  [[nodiscard]] int result() const override {
-    return static_cast<int>(response_.result_int());
-  }
-
-  void set_header(std::string_view name, std::string_view value) override {
-    response_.set(name, value);
-  }
-  [[nodiscard]] Headers headers() const override {
-    Headers h;
-    for (auto const& f : response_) {
-      h.emplace(f.name_string(), f.value());
-    }
-    return h;
-  }
-
-  static inline auto constexpr kBeastHttpVersionFactor = 10;
-  void set_version(int major, int minor) override {
-    response_.version(major * kBeastHttpVersionFactor + minor);
-  }
-  [[nodiscard]] int version_major() const override {
-    return static_cast<int>(response_.version()) / kBeastHttpVersionFactor;
-  }
-  [[nodiscard]] int version_minor() const override {
-    return static_cast<int>(response_.version()) % kBeastHttpVersionFactor;
-  }
-
- private:
-  friend struct UnwrapResponse;
-  BeastResponse response_;
+/// The state of a `functions::HttpResponse`.
+struct HttpResponseImpl {
+  BeastResponse response;
+  /// The headers of a custom `HttpResponse::Impl`, copied on demand.
+  std::mutex custom_headers_mu;
+  std::optional<functions::HttpResponse::HeadersType> custom_headers;
 };
 
-/// Wrap a Boost.Beast request into a functions framework HTTP request.
-std::shared_ptr<functions::HttpResponse::Impl> MakeHttpResponse();
+struct UnwrapResponse {
+  /**
+   * Returns the message in @p response.
+   *
+   * Moves the message out of responses using the default implementation,
+   * responses using a custom `HttpResponse::Impl` are copied.
+   */
+  static BeastResponse unwrap(functions::HttpResponse response);
+
+  /// Returns a response using the default implementation for @p response.
+  static functions::HttpResponse wrap(BeastResponse response);
+
+  /**
+   * Sets a well-known header, such as `http::field::cache_control`.
+   *
+   * Equivalent to `HttpResponse::set_header()`, but skips the lookup of the
+   * header name.
+   */
+  static void set_header(functions::HttpResponse& response,
+                         boost::beast::http::field name,
+                         std::string_view value);
+};
 
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions_internal
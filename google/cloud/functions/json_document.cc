@@ -0,0 +1,89 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/json_document.h"
+#include "google/cloud/functions/internal/json_scanner.h"
+#include <charconv>
+#include <stdexcept>
+#include <system_error>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+[[noreturn]] void WrongType(std::string_view pointer, char const* type) {
+  throw std::invalid_argument("the JSON value at `" + std::string(pointer) +
+                              "` is not " + type);
+}
+
+template <typename T>
+std::optional<T> FromChars(std::string_view raw, std::string_view pointer,
+                           char const* type) {
+  T value;
+  auto const* end = raw.data() + raw.size();
+  auto const r = std::from_chars(raw.data(), end, value);
+  if (r.ec != std::errc{} || r.ptr != end) WrongType(pointer, type);
+  return value;
+}
+
+}  // namespace
+
+bool JsonDocument::contains(std::string_view pointer) const {
+  return raw(pointer).has_value();
+}
+
+std::optional<std::string_view> JsonDocument::raw(
+    std::string_view pointer) const {
+  return functions_internal::JsonFindPointer(text_, pointer);
+}
+
+std::optional<JsonDocument> JsonDocument::find(
+    std::string_view pointer) const {
+  auto r = raw(pointer);
+  if (!r) return std::nullopt;
+  return JsonDocument(*r);
+}
+
+std::optional<std::string> JsonDocument::get_string(
+    std::string_view pointer) const {
+  auto r = raw(pointer);
+  if (!r || *r == "null") return std::nullopt;
+  if (r->front() != '"') WrongType(pointer, "a string");
+  return functions_internal::JsonUnescapeString(*r);
+}
+
+std::optional<std::int64_t> JsonDocument::get_int64(
+    std::string_view pointer) const {
+  auto r = raw(pointer);
+  if (!r || *r == "null") return std::nullopt;
+  return FromChars<std::int64_t>(*r, pointer, "an integer");
+}
+
+std::optional<double> JsonDocument::get_double(
+    std::string_view pointer) const {
+  auto r = raw(pointer);
+  if (!r || *r == "null") return std::nullopt;
+  return FromChars<double>(*r, pointer, "a number");
+}
+
+std::optional<bool> JsonDocument::get_bool(std::string_view pointer) const {
+  auto r = raw(pointer);
+  if (!r || *r == "null") return std::nullopt;
+  if (*r == "true") return true;
+  if (*r == "false") return false;
+  WrongType(pointer, "a boolean");
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
@@ -0,0 +1,84 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_JSON_DOCUMENT_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_JSON_DOCUMENT_H
+
+#include "google/cloud/functions/version.h"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * A read-only view of a JSON document, parsed on demand.
+ *
+ * The document does not build a DOM, each lookup locates the value at a JSON
+ * Pointer (RFC 6901), such as `/message/attributes/0`, and returns a view of
+ * its text. The document and the views refer to the original text, which must
+ * outlive them. The framework uses simdjson for these lookups when it is built
+ * with `FUNCTIONS_FRAMEWORK_CPP_ENABLE_SIMDJSON`.
+ *
+ * Lookups throw `std::invalid_argument` if the text is not valid JSON, or if
+ * the value has a different type than requested. Only the parts of the text
+ * needed for a lookup are validated.
+ *
+ * @par Example
+ * @code
+ * auto json = request.json();
+ * auto name = json.get_string("/name").value_or("World");
+ * @endcode
+ */
+class JsonDocument {
+ public:
+  JsonDocument() = default;
+  explicit JsonDocument(std::string_view text) : text_(text) {}
+
+  /// The full text of the document.
+  [[nodiscard]] std::string_view text() const { return text_; }
+
+  /// Returns true if there is a value at @p pointer.
+  [[nodiscard]] bool contains(std::string_view pointer) const;
+
+  /// The raw JSON text of the value at @p pointer, if any.
+  [[nodiscard]] std::optional<std::string_view> raw(
+      std::string_view pointer) const;
+
+  /// The document rooted at the value at @p pointer, if any.
+  [[nodiscard]] std::optional<JsonDocument> find(
+      std::string_view pointer) const;
+
+  /*
+   * The typed accessors return `std::nullopt` if there is no value at
+   * @p pointer, or if the value is `null`.
+   */
+  [[nodiscard]] std::optional<std::string> get_string(
+      std::string_view pointer) const;
+  [[nodiscard]] std::optional<std::int64_t> get_int64(
+      std::string_view pointer) const;
+  [[nodiscard]] std::optional<double> get_double(
+      std::string_view pointer) const;
+  [[nodiscard]] std::optional<bool> get_bool(std::string_view pointer) const;
+
+ private:
+  std::string_view text_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_JSON_DOCUMENT_H
@@ -0,0 +1,85 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/json_document.h"
+#include <gmock/gmock.h>
+#include <stdexcept>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+auto constexpr kJson = R"js({
+  "name": "Cloud \"Functions\"",
+  "count": 42,
+  "ratio": 0.25,
+  "enabled": true,
+  "nothing": null,
+  "nested": {"items": [{"id": 7}, {"id": 8}]}
+})js";
+
+TEST(JsonDocumentTest, TypedAccessors) {
+  JsonDocument const doc(kJson);
+  EXPECT_EQ(doc.text(), kJson);
+  EXPECT_EQ(doc.get_string("/name"), "Cloud \"Functions\"");
+  EXPECT_EQ(doc.get_int64("/count"), 42);
+  EXPECT_EQ(doc.get_double("/ratio"), 0.25);
+  EXPECT_EQ(doc.get_double("/count"), 42.0);
+  EXPECT_EQ(doc.get_bool("/enabled"), true);
+  EXPECT_EQ(doc.get_int64("/nested/items/1/id"), 8);
+}
+
+TEST(JsonDocumentTest, MissingAndNull) {
+  JsonDocument const doc(kJson);
+  EXPECT_TRUE(doc.contains("/nothing"));
+  EXPECT_FALSE(doc.contains("/missing"));
+  EXPECT_EQ(doc.get_string("/nothing"), std::nullopt);
+  EXPECT_EQ(doc.get_string("/missing"), std::nullopt);
+  EXPECT_EQ(doc.get_int64("/missing"), std::nullopt);
+  EXPECT_EQ(doc.get_double("/nothing"), std::nullopt);
+  EXPECT_EQ(doc.get_bool("/missing"), std::nullopt);
+}
+
+TEST(JsonDocumentTest, WrongType) {
+  JsonDocument const doc(kJson);
+  EXPECT_THROW((void)doc.get_string("/count"), std::invalid_argument);
+  EXPECT_THROW((void)doc.get_int64("/ratio"), std::invalid_argument);
+  EXPECT_THROW((void)doc.get_int64("/name"), std::invalid_argument);
+  EXPECT_THROW((void)doc.get_double("/enabled"), std::invalid_argument);
+  EXPECT_THROW((void)doc.get_bool("/count"), std::invalid_argument);
+}
+
+TEST(JsonDocumentTest, RawAndFind) {
+  std::string const text = kJson;
+  JsonDocument const doc(text);
+  auto const raw = doc.raw("/nested/items/0");
+  ASSERT_TRUE(raw.has_value());
+  EXPECT_EQ(*raw, R"({"id": 7})");
+  EXPECT_GE(raw->data(), text.data());
+  EXPECT_LT(raw->data(), text.data() + text.size());
+
+  auto const items = doc.find("/nested/items");
+  ASSERT_TRUE(items.has_value());
+  EXPECT_EQ(items->get_int64("/0/id"), 7);
+  EXPECT_EQ(doc.find("/missing"), std::nullopt);
+}
+
+TEST(JsonDocumentTest, InvalidJson) {
+  JsonDocument const doc("{\"a\": ");
+  EXPECT_THROW((void)doc.get_string("/a"), std::invalid_argument);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
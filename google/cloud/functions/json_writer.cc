@@ -0,0 +1,133 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/json_writer.h"
+#include "google/cloud/functions/internal/json_writer.h"
+#include <charconv>
+#include <cmath>
+#include <iterator>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+auto constexpr kContentType = "application/json";
+}  // namespace
+
+JsonWriter& JsonWriter::Key(std::string_view key) {
+  Separator();
+  functions_internal::JsonAppendString(buffer_, key);
+  buffer_.push_back(':');
+  after_key_ = true;
+  return *this;
+}
+
+JsonWriter& JsonWriter::Value(std::string_view value) {
+  Separator();
+  functions_internal::JsonAppendString(buffer_, value);
+  return Written();
+}
+
+JsonWriter& JsonWriter::Value(bool value) {
+  Separator();
+  buffer_.append(value ? "true" : "false");
+  return Written();
+}
+
+JsonWriter& JsonWriter::Value(double value) {
+  if (!std::isfinite(value)) return Null();
+  Separator();
+  char buffer[32];
+  auto const r = std::to_chars(std::begin(buffer), std::end(buffer), value);
+  buffer_.append(buffer, r.ptr);
+  return Written();
+}
+
+JsonWriter& JsonWriter::Null() {
+  Separator();
+  buffer_.append("null");
+  return Written();
+}
+
+JsonWriter& JsonWriter::RawValue(std::string_view json) {
+  Separator();
+  buffer_.append(json);
+  return Written();
+}
+
+HttpResponse JsonWriter::ToResponse(int status) && {
+  return HttpResponse{}
+      .set_result(status)
+      .set_header("content-type", kContentType)
+      .set_payload(std::move(buffer_));
+}
+
+void JsonWriter::Flush() {
+  if (writer_ == nullptr) return;
+  if (!header_sent_) {
+    header_sent_ = true;
+    writer_->WriteHeader(HttpResponse{}
+                             .set_header("content-type", kContentType)
+                             .set_payload(std::move(buffer_)));
+    buffer_.clear();
+    return;
+  }
+  if (buffer_.empty()) return;
+  writer_->Write(buffer_);
+  buffer_.clear();
+}
+
+JsonWriter& JsonWriter::Begin(char c) {
+  Separator();
+  buffer_.push_back(c);
+  need_comma_ = false;
+  return *this;
+}
+
+JsonWriter& JsonWriter::End(char c) {
+  buffer_.push_back(c);
+  return Written();
+}
+
+JsonWriter& JsonWriter::Integer(std::int64_t value) {
+  Separator();
+  char buffer[24];
+  auto const r = std::to_chars(std::begin(buffer), std::end(buffer), value);
+  buffer_.append(buffer, r.ptr);
+  return Written();
+}
+
+JsonWriter& JsonWriter::Unsigned(std::uint64_t value) {
+  Separator();
+  char buffer[24];
+  auto const r = std::to_chars(std::begin(buffer), std::end(buffer), value);
+  buffer_.append(buffer, r.ptr);
+  return Written();
+}
+
+void JsonWriter::Separator() {
+  if (after_key_) {
+    after_key_ = false;
+    return;
+  }
+  if (need_comma_) buffer_.push_back(',');
+}
+
+JsonWriter& JsonWriter::Written() {
+  need_comma_ = true;
+  if (writer_ != nullptr && buffer_.size() >= flush_size_) Flush();
+  return *this;
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
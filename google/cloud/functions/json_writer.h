@@ -0,0 +1,153 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_JSON_WRITER_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_JSON_WRITER_H
+
+#include "google/cloud/functions/http_response.h"
+#include "google/cloud/functions/http_response_writer.h"
+#include "google/cloud/functions/version.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Serializes a JSON response directly into its payload.
+ *
+ * Use this instead of building a JSON document, serializing it to a string,
+ * and copying the string into the response. The writer appends each value to
+ * the response payload as it is written, and `ToResponse()` returns the
+ * response with a `content-type: application/json` header, without copying
+ * the payload.
+ *
+ * @code
+ * namespace gcf = ::google::cloud::functions;
+ *
+ * gcf::HttpResponse Lookup(gcf::HttpRequest const& request) {
+ *   auto const user = FindUser(request);
+ *   gcf::JsonWriter json;
+ *   json.BeginObject()
+ *       .Field("id", user.id)
+ *       .Field("name", user.name)
+ *       .Key("roles").BeginArray();
+ *   for (auto const& r : user.roles) json.Value(r);
+ *   json.EndArray().EndObject();
+ *   return std::move(json).ToResponse();
+ * }
+ * @endcode
+ *
+ * The writer can also stream large documents through a `HttpResponseWriter`,
+ * in functions with the streaming response signature. It sends the header
+ * once the buffered data reaches the flush size, and then each time the
+ * buffer fills up. Call `Flush()` once the document is complete.
+ *
+ * The writer does not validate the structure of the document, for example, it
+ * does not check that each `BeginObject()` has a matching `EndObject()`, or
+ * that the members of an object have keys. Strings should be valid UTF-8, and
+ * non-finite numbers are written as `null`.
+ */
+class JsonWriter {
+ public:
+  /// Writes the document into a buffer, see `ToResponse()`.
+  JsonWriter() = default;
+
+  /// Streams the document to @p writer, in blocks of about @p flush_size bytes.
+  explicit JsonWriter(HttpResponseWriter& writer,
+                      std::size_t flush_size = kDefaultFlushSize)
+      : writer_(&writer), flush_size_(flush_size) {}
+
+  JsonWriter& BeginObject() { return Begin('{'); }
+  JsonWriter& EndObject() { return End('}'); }
+  JsonWriter& BeginArray() { return Begin('['); }
+  JsonWriter& EndArray() { return End(']'); }
+
+  /// Writes the key of the next member of an object.
+  JsonWriter& Key(std::string_view key);
+
+  JsonWriter& Value(std::string_view value);
+  JsonWriter& Value(char const* value) {
+    return Value(std::string_view(value));
+  }
+  JsonWriter& Value(bool value);
+  JsonWriter& Value(double value);
+  template <typename T, std::enable_if_t<std::is_integral_v<T> &&
+                                             !std::is_same_v<T, bool>,
+                                         int> = 0>
+  JsonWriter& Value(T value) {
+    if constexpr (std::is_signed_v<T>) {
+      return Integer(static_cast<std::int64_t>(value));
+    } else {
+      return Unsigned(static_cast<std::uint64_t>(value));
+    }
+  }
+  JsonWriter& Null();
+
+  /// Writes @p json as-is, it must be a valid, serialized, JSON value.
+  JsonWriter& RawValue(std::string_view json);
+
+  /// Writes a member of an object, equivalent to `Key(key).Value(value)`.
+  template <typename T>
+  JsonWriter& Field(std::string_view key, T&& value) {
+    return Key(key).Value(std::forward<T>(value));
+  }
+
+  /// The data written so far, and not yet sent.
+  [[nodiscard]] std::string const& buffer() const { return buffer_; }
+
+  /**
+   * Returns a response with the document as its payload.
+   *
+   * The response has the @p status code and a `content-type` header. Only use
+   * this if the writer was not created with a `HttpResponseWriter`.
+   */
+  HttpResponse ToResponse(int status = HttpResponse::kOkay) &&;
+
+  /**
+   * Sends any buffered data to the `HttpResponseWriter`.
+   *
+   * Sends the response header first, if needed. Does nothing if the writer
+   * was created without a `HttpResponseWriter`.
+   *
+   * @throws std::runtime_error if there is an error sending the data.
+   */
+  void Flush();
+
+  static std::size_t constexpr kDefaultFlushSize = 16 * 1024;
+
+ private:
+  JsonWriter& Begin(char c);
+  JsonWriter& End(char c);
+  JsonWriter& Integer(std::int64_t value);
+  JsonWriter& Unsigned(std::uint64_t value);
+  void Separator();
+  JsonWriter& Written();
+
+  HttpResponseWriter* writer_ = nullptr;
+  std::size_t flush_size_ = kDefaultFlushSize;
+  bool header_sent_ = false;
+  bool need_comma_ = false;
+  bool after_key_ = false;
+  std::string buffer_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_JSON_WRITER_H
@@ -0,0 +1,123 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/json_writer.h"
+#include <gmock/gmock.h>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+
+class TestWriter : public HttpResponseWriter {
+ public:
+  void WriteHeader(HttpResponse response) override {
+    header = std::move(response);
+  }
+  void Write(std::string_view data) override { writes.emplace_back(data); }
+  void SetHeartbeat(std::string_view, std::chrono::milliseconds) override {}
+
+  std::optional<HttpResponse> header;
+  std::vector<std::string> writes;
+};
+
+TEST(JsonWriter, Object) {
+  JsonWriter json;
+  json.BeginObject()
+      .Field("name", "Ada \"Countess\" Lovelace")
+      .Field("born", 1815)
+      .Field("ratio", 0.5)
+      .Field("active", false)
+      .Key("nothing")
+      .Null()
+      .Key("tags")
+      .BeginArray()
+      .Value("a")
+      .Value(std::string("b"))
+      .BeginObject()
+      .EndObject()
+      .EndArray()
+      .Key("raw")
+      .RawValue(R"js({"x":[1,2]})js")
+      .EndObject();
+  EXPECT_EQ(json.buffer(),
+            R"js({"name":"Ada \"Countess\" Lovelace","born":1815,)js"
+            R"js("ratio":0.5,"active":false,"nothing":null,)js"
+            R"js("tags":["a","b",{}],"raw":{"x":[1,2]}})js");
+}
+
+TEST(JsonWriter, Numbers) {
+  JsonWriter json;
+  json.BeginArray()
+      .Value(std::numeric_limits<std::int64_t>::min())
+      .Value(std::numeric_limits<std::uint64_t>::max())
+      .Value(static_cast<unsigned char>(7))
+      .Value(true)
+      .Value(0.1)
+      .Value(std::numeric_limits<double>::infinity())
+      .Value(std::numeric_limits<double>::quiet_NaN())
+      .EndArray();
+  EXPECT_EQ(json.buffer(),
+            "[-9223372036854775808,18446744073709551615,7,true,0.1,null,"
+            "null]");
+}
+
+TEST(JsonWriter, ToResponse) {
+  JsonWriter json;
+  json.BeginObject().Field("ok", true).EndObject();
+  auto const response = std::move(json).ToResponse(HttpResponse::kCreated);
+  EXPECT_EQ(response.result(), HttpResponse::kCreated);
+  EXPECT_EQ(response.header("content-type").value_or(""), "application/json");
+  EXPECT_EQ(response.payload(), R"js({"ok":true})js");
+}
+
+TEST(JsonWriter, Streaming) {
+  TestWriter writer;
+  JsonWriter json(writer, 8);
+  json.BeginArray().Value("abc");
+  EXPECT_FALSE(writer.header.has_value());
+  json.Value("def");
+  ASSERT_TRUE(writer.header.has_value());
+  EXPECT_EQ(writer.header->header("content-type").value_or(""),
+            "application/json");
+  EXPECT_EQ(writer.header->payload(), R"js(["abc","def")js");
+  EXPECT_TRUE(json.buffer().empty());
+
+  json.Value(1).Value(2).EndArray();
+  json.Flush();
+  EXPECT_THAT(writer.writes, ElementsAre(",1,2]"));
+  json.Flush();
+  EXPECT_THAT(writer.writes, ElementsAre(",1,2]"));
+}
+
+TEST(JsonWriter, StreamingSmallDocument) {
+  TestWriter writer;
+  JsonWriter json(writer);
+  json.BeginObject().EndObject();
+  EXPECT_FALSE(writer.header.has_value());
+  json.Flush();
+  ASSERT_TRUE(writer.header.has_value());
+  EXPECT_EQ(writer.header->payload(), "{}");
+  EXPECT_TRUE(writer.writes.empty());
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
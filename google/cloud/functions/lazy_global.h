@@ -0,0 +1,109 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_LAZY_GLOBAL_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_LAZY_GLOBAL_H
+
+#include "google/cloud/functions/internal/lazy_global_base.h"
+#include "google/cloud/functions/version.h"
+#include <functional>
+#include <optional>
+#include <utility>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * A global value initialized in the background once the server starts.
+ *
+ * Expensive globals, such as clients or parsed configuration, are often
+ * initialized on first use, which makes the first request pay for the
+ * initialization. Instead, the framework starts initializing all the
+ * `LazyGlobal` objects in background threads as soon as it parses its
+ * options, while it resolves the function, runs any warmup, and starts
+ * listening. `get()` blocks only if the value is not ready yet.
+ *
+ * If the factory throws, the callers of `get()` waiting for the value get
+ * the exception, and the next call to `get()` tries again.
+ *
+ * Define the objects with static storage duration:
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * gcf::LazyGlobal<Model> model([] { return LoadModel("model.bin"); });
+ *
+ * gcf::HttpResponse Predict(gcf::HttpRequest request) {
+ *   return gcf::HttpResponse{}.set_payload(model->Predict(request.payload()));
+ * }
+ * @endcode
+ */
+template <typename T>
+class LazyGlobal : private functions_internal::LazyGlobalBase {
+ public:
+  explicit LazyGlobal(std::function<T()> factory)
+      : factory_(std::move(factory)) {
+    Register();
+  }
+  ~LazyGlobal() { Shutdown(); }
+
+  /// Returns the value, initializing it, or waiting for it, if needed.
+  T& get() {
+    Wait();
+    return *value_;
+  }
+  T& operator*() { return get(); }
+  T* operator->() { return &get(); }
+
+  /// Starts the initialization in the background, unless it has started.
+  using LazyGlobalBase::Prefetch;
+
+  /// Returns true if the value is initialized.
+  using LazyGlobalBase::ready;
+
+ private:
+  void Initialize() override { value_.emplace(factory_()); }
+
+  std::function<T()> factory_;
+  std::optional<T> value_;
+};
+
+/**
+ * Starts the initialization of all the `LazyGlobal` objects.
+ *
+ * The framework calls this during startup, applications only need it if they
+ * create the objects later, or do not use the framework to run the server.
+ */
+void PrefetchLazyGlobals();
+
+/**
+ * Waits until all the `LazyGlobal` objects are initialized.
+ *
+ * Use it as a warmup to keep the server from accepting requests until the
+ * values are ready, e.g., `WithWarmup(function, WaitForLazyGlobals)`.
+ *
+ * @throws the exception of the first object that fails to initialize.
+ */
+void WaitForLazyGlobals();
+
+/**
+ * Returns true if all the `LazyGlobal` objects are initialized.
+ *
+ * Use it to answer readiness checks without blocking.
+ */
+bool LazyGlobalsReady();
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_LAZY_GLOBAL_H
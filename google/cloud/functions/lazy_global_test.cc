@@ -0,0 +1,92 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/lazy_global.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+TEST(LazyGlobalTest, InitializesOnFirstUse) {
+  auto calls = 0;
+  LazyGlobal<std::string> global([&calls] {
+    ++calls;
+    return std::string("value");
+  });
+  EXPECT_FALSE(global.ready());
+  EXPECT_EQ(global.get(), "value");
+  EXPECT_EQ(global->size(), 5);
+  EXPECT_EQ(*global, "value");
+  EXPECT_TRUE(global.ready());
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(LazyGlobalTest, Prefetch) {
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  std::atomic<int> calls{0};
+  LazyGlobal<int> global([&calls, released] {
+    released.wait();
+    return ++calls;
+  });
+  global.Prefetch();
+  global.Prefetch();
+  EXPECT_FALSE(global.ready());
+  EXPECT_FALSE(LazyGlobalsReady());
+
+  // Concurrent callers wait for the background initialization.
+  std::vector<std::future<int>> waiters(4);
+  for (auto& w : waiters) {
+    w = std::async(std::launch::async, [&global] { return global.get(); });
+  }
+  release.set_value();
+  for (auto& w : waiters) EXPECT_EQ(w.get(), 1);
+  EXPECT_TRUE(global.ready());
+  EXPECT_TRUE(LazyGlobalsReady());
+  EXPECT_EQ(calls.load(), 1);
+}
+
+TEST(LazyGlobalTest, RetriesAfterFailure) {
+  auto calls = 0;
+  LazyGlobal<int> global([&calls] {
+    if (++calls == 1) throw std::runtime_error("not yet");
+    return calls;
+  });
+  EXPECT_THROW(WaitForLazyGlobals(), std::runtime_error);
+  EXPECT_FALSE(global.ready());
+  EXPECT_EQ(global.get(), 2);
+  EXPECT_TRUE(global.ready());
+}
+
+TEST(LazyGlobalTest, PrefetchAll) {
+  LazyGlobal<int> a([] { return 1; });
+  LazyGlobal<int> b([] { return 2; });
+  PrefetchLazyGlobals();
+  WaitForLazyGlobals();
+  EXPECT_TRUE(a.ready());
+  EXPECT_TRUE(b.ready());
+  EXPECT_TRUE(LazyGlobalsReady());
+  EXPECT_EQ(a.get() + b.get(), 3);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
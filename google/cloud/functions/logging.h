@@ -0,0 +1,53 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_LOGGING_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_LOGGING_H
+
+#include "google/cloud/functions/version.h"
+#include <string_view>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * The severity of a log entry.
+ *
+ * @see https://cloud.google.com/logging/docs/structured-logging
+ */
+enum class LogSeverity {
+  kDebug,
+  kInfo,
+  kNotice,
+  kWarning,
+  kError,
+  kCritical,
+};
+
+/**
+ * Writes a structured log entry to `stderr`.
+ *
+ * The entry is a single line of JSON, which Cloud Logging parses into its
+ * severity, message, and the trace and execution id of the request running in
+ * the calling thread, if any. Use this instead of writing to `std::cerr` to
+ * correlate the logs with the requests and their traces. Each thread formats
+ * its entries into a reusable buffer, which is written at once, and goes
+ * through the background log sink if it is enabled.
+ */
+void Log(LogSeverity severity, std::string_view message);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_LOGGING_H
@@ -0,0 +1,75 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_MIDDLEWARE_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_MIDDLEWARE_H
+
+#include "google/cloud/functions/internal/middleware_chain.h"
+#include "google/cloud/functions/version.h"
+#include <utility>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Composes middleware layers and an HTTP function into a single callable.
+ *
+ * Each layer is called with the request and the rest of the chain. It may
+ * modify the request before calling `next(std::move(request))`, modify the
+ * response it returns, or return a response without calling `next` at all.
+ * The last argument is the HTTP function.
+ *
+ * The chain is composed at compile time. Each layer calls the next one
+ * directly, so the layers add no indirect calls, and the compiler may inline
+ * the whole chain. Pass the result to `MakeFunction()`, which keeps its type.
+ * Take `next` by reference: copying it copies the rest of the chain.
+ *
+ * @code
+ * namespace gcf = ::google::cloud::functions;
+ *
+ * struct Cors {
+ *   template <typename Next>
+ *   gcf::HttpResponse operator()(gcf::HttpRequest request, Next& next) {
+ *     if (request.verb() == "OPTIONS") {
+ *       return gcf::HttpResponse{}
+ *           .set_result(gcf::HttpResponse::kNoContent)
+ *           .set_header("Access-Control-Allow-Origin", "*");
+ *     }
+ *     return next(std::move(request))
+ *         .set_header("Access-Control-Allow-Origin", "*");
+ *   }
+ * };
+ *
+ * auto function = gcf::MakeFunction(gcf::Chain(
+ *     Cors{},
+ *     [](gcf::HttpRequest request, auto& next) {
+ *       if (!request.header("authorization")) {
+ *         return gcf::HttpResponse{}.set_result(
+ *             gcf::HttpResponse::kUnauthorized);
+ *       }
+ *       return next(std::move(request));
+ *     },
+ *     MyHandler));
+ * @endcode
+ */
+template <typename... Layers>
+auto Chain(Layers&&... layers) {
+  static_assert(sizeof...(Layers) != 0, "a chain needs an HTTP function");
+  return functions_internal::MakeChain(std::forward<Layers>(layers)...);
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_MIDDLEWARE_H
@@ -0,0 +1,120 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/middleware.h"
+#include "google/cloud/functions/in_process_invoker.h"
+#include <gmock/gmock.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+
+/// Records the order of the calls, and tags the responses.
+struct Trace {
+  std::string name;
+  std::vector<std::string>* calls;
+
+  template <typename Next>
+  HttpResponse operator()(HttpRequest request, Next& next) {
+    calls->push_back(name);
+    auto response = next(std::move(request));
+    calls->push_back("~" + name);
+    return std::move(response).set_header("x-" + name, "1");
+  }
+};
+
+TEST(MiddlewareTest, Order) {
+  std::vector<std::string> calls;
+  auto chain = Chain(Trace{"a", &calls}, Trace{"b", &calls},
+                     [&calls](HttpRequest const& request) {
+                       calls.emplace_back("handler");
+                       return HttpResponse{}.set_payload(request.target());
+                     });
+  auto response = chain(HttpRequest{}.set_target("/x"));
+  EXPECT_EQ(response.payload(), "/x");
+  EXPECT_TRUE(response.has_header("x-a"));
+  EXPECT_TRUE(response.has_header("x-b"));
+  EXPECT_THAT(calls, ElementsAre("a", "b", "handler", "~b", "~a"));
+}
+
+TEST(MiddlewareTest, ShortCircuit) {
+  auto handler_calls = 0;
+  auto chain = Chain(
+      [](HttpRequest request, auto& next) {
+        if (!request.header("authorization")) {
+          return HttpResponse{}.set_result(HttpResponse::kUnauthorized);
+        }
+        return next(std::move(request));
+      },
+      [&handler_calls](HttpRequest const& /*request*/) {
+        ++handler_calls;
+        return HttpResponse{};
+      });
+  EXPECT_EQ(chain(HttpRequest{}).result(), HttpResponse::kUnauthorized);
+  EXPECT_EQ(handler_calls, 0);
+  EXPECT_EQ(chain(HttpRequest{}.add_header("Authorization", "Bearer t"))
+                .result(),
+            HttpResponse::kOkay);
+  EXPECT_EQ(handler_calls, 1);
+}
+
+TEST(MiddlewareTest, ModifiesRequest) {
+  auto chain = Chain(
+      [](HttpRequest request, auto& next) {
+        return next(std::move(request).add_header("x-user", "alice"));
+      },
+      [](HttpRequest const& request) {
+        return HttpResponse{}.set_payload(
+            std::string(request.header("x-user").value_or("")));
+      });
+  EXPECT_EQ(chain(HttpRequest{}).payload(), "alice");
+}
+
+TEST(MiddlewareTest, HandlerOnly) {
+  auto chain = Chain([](HttpRequest const& /*request*/) {
+    return HttpResponse{}.set_payload("only");
+  });
+  EXPECT_EQ(chain(HttpRequest{}).payload(), "only");
+}
+
+TEST(MiddlewareTest, MoveOnlyLayers) {
+  auto chain = Chain(
+      [p = std::make_unique<std::string>("x-move")](HttpRequest request,
+                                                    auto& next) {
+        return next(std::move(request)).set_header(*p, "1");
+      },
+      [](HttpRequest const& /*request*/) { return HttpResponse{}; });
+  EXPECT_TRUE(chain(HttpRequest{}).has_header("x-move"));
+}
+
+TEST(MiddlewareTest, MakeFunction) {
+  std::vector<std::string> calls;
+  InProcessInvoker invoker(MakeFunction(Chain(
+      Trace{"a", &calls}, [](HttpRequest const& /*request*/) {
+        return HttpResponse{}.set_payload("chained");
+      })));
+  auto const response = invoker.Invoke(HttpRequest{});
+  EXPECT_EQ(response.payload(), "chained");
+  EXPECT_TRUE(response.has_header("x-a"));
+  EXPECT_THAT(calls, ElementsAre("a", "~a"));
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
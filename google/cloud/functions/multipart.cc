@@ -0,0 +1,351 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/multipart.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+auto constexpr kCrLf = std::string_view("\r\n");
+auto constexpr kHeaderEnd = std::string_view("\r\n\r\n");
+/// RFC 2046 limits boundaries to 70 characters.
+auto constexpr kMaxBoundarySize = 70;
+auto constexpr kReadSize = 64 * 1024;
+
+std::string_view Trim(std::string_view v) {
+  auto const b = v.find_first_not_of(" \t");
+  if (b == std::string_view::npos) return {};
+  auto const e = v.find_last_not_of(" \t");
+  return v.substr(b, e - b + 1);
+}
+
+bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+  return a.size() == b.size() &&
+         std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+           return std::tolower(static_cast<unsigned char>(x)) ==
+                  std::tolower(static_cast<unsigned char>(y));
+         });
+}
+
+/**
+ * Returns the parameter named @p name in a header value.
+ *
+ * The value has the form `token *( ";" name "=" ( token / quoted-string ) )`,
+ * as used in `Content-Type` and `Content-Disposition`.
+ */
+std::optional<std::string> FindParameter(std::string_view value,
+                                         std::string_view name) {
+  auto pos = value.find(';');
+  while (pos != std::string_view::npos) {
+    auto rest = value.substr(pos + 1);
+    auto const eq = rest.find('=');
+    if (eq == std::string_view::npos) return std::nullopt;
+    auto const key = Trim(rest.substr(0, eq));
+    rest = rest.substr(eq + 1);
+    rest = rest.substr(std::min(rest.size(), rest.find_first_not_of(" \t")));
+    std::string parsed;
+    std::size_t end = 0;
+    if (!rest.empty() && rest.front() == '"') {
+      for (end = 1; end < rest.size() && rest[end] != '"'; ++end) {
+        if (rest[end] == '\\' && end + 1 < rest.size()) ++end;
+        parsed.push_back(rest[end]);
+      }
+      end = std::min(rest.size(), end + 1);
+    } else {
+      end = std::min(rest.size(), rest.find(';'));
+      parsed = std::string(Trim(rest.substr(0, end)));
+    }
+    if (EqualsIgnoreCase(key, name)) return parsed;
+    auto const next = rest.find(';', end);
+    if (next == std::string_view::npos) return std::nullopt;
+    pos = static_cast<std::size_t>(rest.data() + next - value.data());
+  }
+  return std::nullopt;
+}
+
+/// Collects the parts of a buffered body, without copying their data.
+class BufferedHandler : public MultipartHandler {
+ public:
+  void OnPartBegin(MultipartHeader const& header) override {
+    parts_.push_back(MultipartPart{header, {}});
+  }
+  void OnPartData(std::string_view data) override {
+    // The body of each part is reported in a single call, as the parser does
+    // not buffer any data when the body is complete.
+    parts_.back().body = data;
+  }
+  void OnPartEnd() override {}
+
+  std::vector<MultipartPart>&& parts() && { return std::move(parts_); }
+
+ private:
+  std::vector<MultipartPart> parts_;
+};
+
+std::filesystem::path MakeSpillPath(std::filesystem::path const& directory) {
+  static std::atomic<std::uint64_t> counter{0};
+  auto generator = std::mt19937_64(std::random_device{}());
+  for (;;) {
+    auto path = directory / ("multipart-" + std::to_string(generator()) + "-" +
+                             std::to_string(++counter));
+    if (!std::filesystem::exists(path)) return path;
+  }
+}
+
+/// Collects the parts of a form, writing file parts to disk.
+class FormHandler : public MultipartHandler {
+ public:
+  explicit FormHandler(MultipartFormOptions const& options)
+      : options_(options) {}
+
+  void OnPartBegin(MultipartHeader const& header) override {
+    parts_.push_back(MultipartFormPart{header, {}, std::nullopt});
+    if (options_.spill_directory.empty() || !header.filename) return;
+    auto path = MakeSpillPath(options_.spill_directory);
+    parts_.back().path = path;
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_) {
+      throw std::runtime_error("cannot create multipart file " +
+                               path.string());
+    }
+  }
+  void OnPartData(std::string_view data) override {
+    if (!file_.is_open()) {
+      parts_.back().body.append(data);
+      return;
+    }
+    file_.write(data.data(), static_cast<std::streamsize>(data.size()));
+  }
+  void OnPartEnd() override {
+    if (!file_.is_open()) return;
+    file_.close();
+    if (!file_) {
+      throw std::runtime_error("error writing multipart file " +
+                               parts_.back().path->string());
+    }
+  }
+
+  /// Removes any files created, used if the body cannot be parsed.
+  void RemoveFiles() {
+    if (file_.is_open()) file_.close();
+    for (auto const& p : parts_) {
+      std::error_code ec;
+      if (p.path) std::filesystem::remove(*p.path, ec);
+    }
+  }
+
+  std::vector<MultipartFormPart>&& parts() && { return std::move(parts_); }
+
+ private:
+  MultipartFormOptions const& options_;
+  std::vector<MultipartFormPart> parts_;
+  std::ofstream file_;
+};
+
+}  // namespace
+
+MultipartParser::MultipartParser(std::string_view boundary,
+                                 MultipartHandler& handler,
+                                 std::size_t max_header_size)
+    : delimiter_("\r\n--" + std::string(boundary)),
+      handler_(handler),
+      max_header_size_(max_header_size) {}
+
+void MultipartParser::Parse(std::string_view data) {
+  if (state_ == State::kDone) return;
+  // Avoid copies when there is no buffered data, in particular, when the
+  // full body is parsed in a single call.
+  if (buffer_.empty()) {
+    auto const n = Consume(data);
+    if (state_ != State::kDone) buffer_.assign(data.substr(n));
+    return;
+  }
+  buffer_.append(data);
+  auto const n = Consume(buffer_);
+  buffer_.erase(0, n);
+  if (state_ == State::kDone) buffer_.clear();
+}
+
+void MultipartParser::Finish() const {
+  if (state_ != State::kDone) {
+    throw std::runtime_error("multipart body ends before the final boundary");
+  }
+}
+
+std::size_t MultipartParser::Consume(std::string_view input) {
+  auto const dash_boundary = std::string_view(delimiter_).substr(2);
+  // Data that may contain a partial delimiter is kept for the next call.
+  auto const keep = [this](std::string_view v) {
+    return v.size() - std::min(v.size(), delimiter_.size() - 1);
+  };
+  std::size_t pos = 0;
+  while (state_ != State::kDone) {
+    auto const rest = input.substr(pos);
+    switch (state_) {
+      case State::kPreamble: {
+        if (at_start_) {
+          // The first boundary may start the body, without a leading CRLF.
+          auto const n = std::min(rest.size(), dash_boundary.size());
+          if (rest.substr(0, n) == dash_boundary.substr(0, n)) {
+            if (n < dash_boundary.size()) return pos;
+            at_start_ = false;
+            pos += n;
+            state_ = State::kAfterBoundary;
+            break;
+          }
+          at_start_ = false;
+        }
+        auto const found = rest.find(delimiter_);
+        if (found == std::string_view::npos) return pos + keep(rest);
+        pos += found + delimiter_.size();
+        state_ = State::kAfterBoundary;
+        break;
+      }
+      case State::kAfterBoundary: {
+        if (rest.size() < 2) return pos;
+        if (in_part_) {
+          in_part_ = false;
+          handler_.OnPartEnd();
+        }
+        if (rest.substr(0, 2) == "--") {
+          state_ = State::kDone;
+          return input.size();
+        }
+        if (rest.substr(0, 2) != kCrLf) {
+          throw std::runtime_error("invalid multipart boundary line");
+        }
+        pos += 2;
+        state_ = State::kHeader;
+        break;
+      }
+      case State::kHeader: {
+        if (rest.size() < 2) return pos;
+        if (rest.substr(0, 2) == kCrLf) {
+          ParseHeader({});
+          pos += 2;
+          break;
+        }
+        auto const found = rest.find(kHeaderEnd);
+        if (std::min(found, rest.size()) > max_header_size_) {
+          throw std::runtime_error("multipart part header is too large");
+        }
+        if (found == std::string_view::npos) return pos;
+        ParseHeader(rest.substr(0, found));
+        pos += found + kHeaderEnd.size();
+        break;
+      }
+      case State::kBody: {
+        auto const found = rest.find(delimiter_);
+        if (found == std::string_view::npos) {
+          auto const n = keep(rest);
+          if (n != 0) handler_.OnPartData(rest.substr(0, n));
+          return pos + n;
+        }
+        if (found != 0) handler_.OnPartData(rest.substr(0, found));
+        pos += found + delimiter_.size();
+        state_ = State::kAfterBoundary;
+        break;
+      }
+      case State::kDone:
+        break;
+    }
+  }
+  return input.size();
+}
+
+void MultipartParser::ParseHeader(std::string_view header) {
+  MultipartHeader part;
+  while (!header.empty()) {
+    auto const eol = header.find(kCrLf);
+    auto const line = header.substr(0, eol);
+    header = eol == std::string_view::npos ? std::string_view{}
+                                           : header.substr(eol + 2);
+    auto const colon = line.find(':');
+    if (colon == std::string_view::npos) {
+      throw std::runtime_error("invalid multipart part header");
+    }
+    part.headers.add(std::string(Trim(line.substr(0, colon))),
+                     std::string(Trim(line.substr(colon + 1))));
+  }
+  if (auto disposition = part.headers.get("content-disposition")) {
+    part.name = FindParameter(*disposition, "name").value_or("");
+    part.filename = FindParameter(*disposition, "filename");
+  }
+  state_ = State::kBody;
+  in_part_ = true;
+  handler_.OnPartBegin(part);
+}
+
+std::string MultipartBoundary(std::string_view content_type) {
+  auto const type = Trim(content_type.substr(0, content_type.find(';')));
+  auto constexpr kMultipart = std::string_view("multipart/");
+  if (type.size() <= kMultipart.size() ||
+      !EqualsIgnoreCase(type.substr(0, kMultipart.size()), kMultipart)) {
+    throw std::invalid_argument("not a multipart content type: " +
+                                std::string(content_type));
+  }
+  auto boundary = FindParameter(content_type, "boundary");
+  if (!boundary || boundary->empty() || boundary->size() > kMaxBoundarySize) {
+    throw std::invalid_argument("missing or invalid multipart boundary in " +
+                                std::string(content_type));
+  }
+  return *std::move(boundary);
+}
+
+std::vector<MultipartPart> ParseMultipart(std::string_view content_type,
+                                          std::string_view body) {
+  BufferedHandler handler;
+  MultipartParser parser(MultipartBoundary(content_type), handler);
+  parser.Parse(body);
+  parser.Finish();
+  return std::move(handler).parts();
+}
+
+void ParseMultipart(std::string_view content_type,
+                    HttpRequestBodyReader& reader, MultipartHandler& handler) {
+  MultipartParser parser(MultipartBoundary(content_type), handler);
+  std::string buffer(kReadSize, '\0');
+  // Consume the full body, even after the final boundary, so the connection
+  // can be reused.
+  for (auto n = reader.Read(buffer.data(), buffer.size()); n != 0;
+       n = reader.Read(buffer.data(), buffer.size())) {
+    parser.Parse({buffer.data(), n});
+  }
+  parser.Finish();
+}
+
+std::vector<MultipartFormPart> ReadMultipartForm(
+    std::string_view content_type, HttpRequestBodyReader& reader,
+    MultipartFormOptions const& options) {
+  FormHandler handler(options);
+  try {
+    ParseMultipart(content_type, reader, handler);
+  } catch (...) {
+    handler.RemoveFiles();
+    throw;
+  }
+  return std::move(handler).parts();
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
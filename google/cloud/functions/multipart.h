@@ -0,0 +1,188 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_MULTIPART_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_MULTIPART_H
+
+#include "google/cloud/functions/http_headers.h"
+#include "google/cloud/functions/http_request_body_reader.h"
+#include "google/cloud/functions/version.h"
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// The header of one part in a `multipart/form-data` body.
+struct MultipartHeader {
+  HttpHeaders headers;
+  /// The `name` parameter of the `Content-Disposition` header, if any.
+  std::string name;
+  /// The `filename` parameter of the `Content-Disposition` header, if any.
+  std::optional<std::string> filename;
+};
+
+/**
+ * Receives the parts of a multipart body as they are parsed.
+ *
+ * For each part the parser calls `OnPartBegin()`, then `OnPartData()` zero
+ * or more times, and then `OnPartEnd()`. The data passed to `OnPartData()` is
+ * only valid during the call.
+ */
+class MultipartHandler {
+ public:
+  virtual ~MultipartHandler() = default;
+  virtual void OnPartBegin(MultipartHeader const& header) = 0;
+  virtual void OnPartData(std::string_view data) = 0;
+  virtual void OnPartEnd() = 0;
+};
+
+/**
+ * Incrementally parses a multipart body, as defined in RFC 2046 and RFC 7578.
+ *
+ * The parser accepts the body in chunks of any size, and only buffers the
+ * data that may be part of a boundary, or an incomplete part header. Data
+ * before the first boundary and after the last boundary is ignored.
+ *
+ * @par Example
+ * @code
+ * gcf::MultipartParser parser(gcf::MultipartBoundary(content_type), handler);
+ * for (auto n = reader.Read(buffer.data(), buffer.size()); n != 0;
+ *      n = reader.Read(buffer.data(), buffer.size())) {
+ *   parser.Parse({buffer.data(), n});
+ * }
+ * parser.Finish();
+ * @endcode
+ */
+class MultipartParser {
+ public:
+  /// The default limit for the size of each part header.
+  static constexpr std::size_t kDefaultMaxHeaderSize = 16 * 1024;
+
+  MultipartParser(std::string_view boundary, MultipartHandler& handler,
+                  std::size_t max_header_size = kDefaultMaxHeaderSize);
+
+  /**
+   * Parses the next chunk of the body.
+   *
+   * @throws std::runtime_error if the body is malformed, or a part header is
+   *     larger than the limit.
+   */
+  void Parse(std::string_view data);
+
+  /**
+   * Completes the parsing.
+   *
+   * @throws std::runtime_error if the body does not end with the final
+   *     boundary.
+   */
+  void Finish() const;
+
+  /// Returns `true` once the final boundary is found.
+  [[nodiscard]] bool done() const { return state_ == State::kDone; }
+
+ private:
+  enum class State { kPreamble, kAfterBoundary, kHeader, kBody, kDone };
+
+  std::size_t Consume(std::string_view input);
+  void ParseHeader(std::string_view header);
+
+  /// The boundary preceded by `CRLF--`.
+  std::string delimiter_;
+  MultipartHandler& handler_;
+  std::size_t max_header_size_;
+  State state_ = State::kPreamble;
+  bool at_start_ = true;
+  bool in_part_ = false;
+  std::string buffer_;
+};
+
+/**
+ * Returns the boundary in a multipart content type.
+ *
+ * For example, `multipart/form-data; boundary="XyZ"` returns `XyZ`.
+ *
+ * @throws std::invalid_argument if @p content_type is not a multipart type,
+ *     or has no boundary.
+ */
+std::string MultipartBoundary(std::string_view content_type);
+
+/// One part of a buffered multipart body.
+struct MultipartPart {
+  MultipartHeader header;
+  /// The body of the part, it refers to the buffer passed to the parser.
+  std::string_view body;
+};
+
+/**
+ * Parses a buffered multipart body.
+ *
+ * The part bodies refer to @p body, and are not copied.
+ *
+ * @throws std::invalid_argument if @p content_type has no boundary, and
+ *     std::runtime_error if @p body is malformed.
+ */
+std::vector<MultipartPart> ParseMultipart(std::string_view content_type,
+                                          std::string_view body);
+
+/**
+ * Parses a multipart body as the function reads it.
+ *
+ * For functions using the streaming signature: the body is never held in
+ * memory, only one chunk at a time.
+ */
+void ParseMultipart(std::string_view content_type,
+                    HttpRequestBodyReader& reader, MultipartHandler& handler);
+
+/// The configuration for `ReadMultipartForm()`.
+struct MultipartFormOptions {
+  /**
+   * If not empty, file parts are written to new files in this directory.
+   *
+   * File parts are the parts with a `filename` parameter in their
+   * `Content-Disposition` header. The application must remove the files.
+   */
+  std::filesystem::path spill_directory;
+};
+
+/// One part of a form read by `ReadMultipartForm()`.
+struct MultipartFormPart {
+  MultipartHeader header;
+  /// The part body, empty if the part was written to a file.
+  std::string body;
+  /// The file containing the part body, if it was written to a file.
+  std::optional<std::filesystem::path> path;
+};
+
+/**
+ * Reads a multipart form, optionally writing its file parts to disk.
+ *
+ * With a spill directory the memory used is bounded by the size of the
+ * non-file parts, regardless of the size of the uploaded files.
+ *
+ * @throws std::runtime_error if the body is malformed, or a file cannot be
+ *     created.
+ */
+std::vector<MultipartFormPart> ReadMultipartForm(
+    std::string_view content_type, HttpRequestBodyReader& reader,
+    MultipartFormOptions const& options = {});
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_MULTIPART_H
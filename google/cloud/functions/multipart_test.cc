@@ -0,0 +1,197 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/multipart.h"
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+auto constexpr kContentType = "multipart/form-data; boundary=\"XyZ\"";
+auto constexpr kBody =
+    "preamble\r\n"
+    "--XyZ\r\n"
+    "Content-Disposition: form-data; name=\"field1\"\r\n"
+    "\r\n"
+    "value1\r\n"
+    "--XyZ\r\n"
+    "Content-Disposition: form-data; name=\"file\"; "
+    "filename=\"a \\\"b\\\".txt\"\r\n"
+    "Content-Type: text/plain\r\n"
+    "\r\n"
+    "line 1\r\n--Xy not a boundary\r\nline 2\r\n"
+    "--XyZ\r\n"
+    "\r\n"
+    "\r\n"
+    "--XyZ--\r\n"
+    "epilogue";
+
+/// Records the parser callbacks.
+class RecordingHandler : public MultipartHandler {
+ public:
+  struct Part {
+    MultipartHeader header;
+    std::string body;
+    bool ended = false;
+  };
+
+  void OnPartBegin(MultipartHeader const& header) override {
+    parts.push_back(Part{header, {}, false});
+  }
+  void OnPartData(std::string_view data) override {
+    parts.back().body.append(data);
+  }
+  void OnPartEnd() override { parts.back().ended = true; }
+
+  std::vector<Part> parts;
+};
+
+class StringReader : public HttpRequestBodyReader {
+ public:
+  StringReader(std::string data, std::size_t chunk)
+      : data_(std::move(data)), chunk_(chunk) {}
+
+  std::size_t Read(char* data, std::size_t size) override {
+    auto const n = std::min({size, chunk_, data_.size() - offset_});
+    std::copy_n(data_.data() + offset_, n, data);
+    offset_ += n;
+    return n;
+  }
+
+ private:
+  std::string data_;
+  std::size_t chunk_;
+  std::size_t offset_ = 0;
+};
+
+void CheckParts(std::vector<RecordingHandler::Part> const& parts) {
+  ASSERT_EQ(parts.size(), 3);
+  EXPECT_EQ(parts[0].header.name, "field1");
+  EXPECT_FALSE(parts[0].header.filename.has_value());
+  EXPECT_EQ(parts[0].body, "value1");
+  EXPECT_EQ(parts[1].header.name, "file");
+  EXPECT_EQ(parts[1].header.filename.value_or(""), "a \"b\".txt");
+  EXPECT_EQ(parts[1].header.headers.get("content-type").value_or(""),
+            "text/plain");
+  EXPECT_EQ(parts[1].body, "line 1\r\n--Xy not a boundary\r\nline 2");
+  EXPECT_TRUE(parts[2].header.headers.empty());
+  EXPECT_EQ(parts[2].body, "");
+  for (auto const& p : parts) EXPECT_TRUE(p.ended);
+}
+
+TEST(MultipartTest, Boundary) {
+  EXPECT_EQ(MultipartBoundary(kContentType), "XyZ");
+  EXPECT_EQ(MultipartBoundary("Multipart/Form-Data;charset=utf-8;BOUNDARY=a"),
+            "a");
+  EXPECT_EQ(MultipartBoundary("multipart/mixed; boundary=\"a b\""), "a b");
+  EXPECT_THROW(MultipartBoundary("text/plain; boundary=a"),
+               std::invalid_argument);
+  EXPECT_THROW(MultipartBoundary("multipart/form-data"), std::invalid_argument);
+  EXPECT_THROW(MultipartBoundary("multipart/form-data; boundary="),
+               std::invalid_argument);
+  auto const long_boundary = std::string(71, 'a');
+  EXPECT_THROW(MultipartBoundary("multipart/form-data; boundary=" +
+                                 long_boundary),
+               std::invalid_argument);
+}
+
+TEST(MultipartTest, ParseBuffered) {
+  std::string const body = kBody;
+  auto const parts = ParseMultipart(kContentType, body);
+  ASSERT_EQ(parts.size(), 3);
+  EXPECT_EQ(parts[0].header.name, "field1");
+  EXPECT_EQ(parts[0].body, "value1");
+  EXPECT_EQ(parts[1].body, "line 1\r\n--Xy not a boundary\r\nline 2");
+  EXPECT_EQ(parts[2].body, "");
+  // The bodies refer to the original buffer.
+  EXPECT_EQ(parts[0].body.data(), body.data() + body.find("value1"));
+}
+
+TEST(MultipartTest, ParseIncremental) {
+  // Splitting the body at every position exercises all the partial states.
+  for (std::size_t chunk = 1; chunk != 64; ++chunk) {
+    SCOPED_TRACE("Testing with chunk = " + std::to_string(chunk));
+    RecordingHandler handler;
+    StringReader reader(kBody, chunk);
+    ParseMultipart(kContentType, reader, handler);
+    CheckParts(handler.parts);
+  }
+}
+
+TEST(MultipartTest, NoPreamble) {
+  auto const parts = ParseMultipart(
+      "multipart/form-data; boundary=b",
+      "--b\r\nContent-Disposition: form-data; name=x\r\n\r\n1\r\n--b--");
+  ASSERT_EQ(parts.size(), 1);
+  EXPECT_EQ(parts[0].header.name, "x");
+  EXPECT_EQ(parts[0].body, "1");
+}
+
+TEST(MultipartTest, Errors) {
+  auto const* ct = "multipart/form-data; boundary=b";
+  // Truncated bodies.
+  EXPECT_THROW(ParseMultipart(ct, ""), std::runtime_error);
+  EXPECT_THROW(ParseMultipart(ct, "--b\r\n\r\nabc"), std::runtime_error);
+  EXPECT_THROW(ParseMultipart(ct, "--b\r\n\r\nabc\r\n--b"), std::runtime_error);
+  // Invalid boundary line and header.
+  EXPECT_THROW(ParseMultipart(ct, "--bx\r\n\r\n\r\n--b--"), std::runtime_error);
+  EXPECT_THROW(ParseMultipart(ct, "--b\r\nno-colon\r\n\r\n\r\n--b--"),
+               std::runtime_error);
+
+  RecordingHandler handler;
+  MultipartParser parser("b", handler, 16);
+  EXPECT_THROW(parser.Parse("--b\r\nx-long-header: " + std::string(32, 'a')),
+               std::runtime_error);
+}
+
+TEST(MultipartTest, ReadForm) {
+  StringReader reader(kBody, 7);
+  auto const parts = ReadMultipartForm(kContentType, reader);
+  ASSERT_EQ(parts.size(), 3);
+  EXPECT_EQ(parts[0].body, "value1");
+  EXPECT_EQ(parts[1].body, "line 1\r\n--Xy not a boundary\r\nline 2");
+  EXPECT_FALSE(parts[1].path.has_value());
+}
+
+TEST(MultipartTest, ReadFormSpill) {
+  auto const directory = std::filesystem::temp_directory_path();
+  StringReader reader(kBody, 5);
+  auto const parts =
+      ReadMultipartForm(kContentType, reader, MultipartFormOptions{directory});
+  ASSERT_EQ(parts.size(), 3);
+  EXPECT_EQ(parts[0].body, "value1");
+  EXPECT_FALSE(parts[0].path.has_value());
+  ASSERT_TRUE(parts[1].path.has_value());
+  EXPECT_EQ(parts[1].body, "");
+  EXPECT_EQ(parts[1].path->parent_path(), directory);
+  std::ostringstream contents;
+  contents << std::ifstream(*parts[1].path, std::ios::binary).rdbuf();
+  EXPECT_EQ(contents.str(), "line 1\r\n--Xy not a boundary\r\nline 2");
+  std::filesystem::remove(*parts[1].path);
+
+  // Files are removed if the body is invalid.
+  StringReader truncated(std::string(kBody).substr(0, 200), 5);
+  EXPECT_THROW(ReadMultipartForm(kContentType, truncated,
+                                 MultipartFormOptions{directory}),
+               std::runtime_error);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
@@ -0,0 +1,118 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/pubsub_message.h"
+#include "google/cloud/functions/internal/json_scanner.h"
+#include "google/cloud/functions/internal/parse_time.h"
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+auto constexpr kPubsubEventType = std::string_view{
+    "google.cloud.pubsub.topic.v1.messagePublished"};
+auto constexpr kMessagePublishedDataSchema = std::string_view{
+    "google.events.cloud.pubsub.v1.MessagePublishedData"};
+
+/// Returns the members of the raw JSON object @p raw, nothing if it is null.
+std::vector<functions_internal::JsonMember> ObjectMembers(
+    std::string_view raw, std::string_view name) {
+  if (raw == "null") return {};
+  if (raw.empty() || raw.front() != '{') {
+    throw std::invalid_argument("expected a JSON object for " +
+                                std::string(name));
+  }
+  return functions_internal::JsonObjectMembers(raw);
+}
+
+/// Returns the value of the raw JSON string @p raw, empty if it is null.
+std::string StringValue(std::string_view raw) {
+  if (raw == "null") return {};
+  return functions_internal::JsonUnescapeString(raw);
+}
+
+/// The member keys are not unescaped, they rarely need it.
+std::string KeyValue(std::string_view key) {
+  if (key.find('\\') == std::string_view::npos) return std::string(key);
+  return functions_internal::JsonUnescapeString("\"" + std::string(key) +
+                                                "\"");
+}
+
+bool IsPubsubEvent(CloudEvent const& event) {
+  return event.type_view() == kPubsubEventType ||
+         event.data_schema_view().value_or("") == kMessagePublishedDataSchema;
+}
+
+}  // namespace
+
+PubsubMessage CloudEventDataDecoder<PubsubMessage>::Decode(
+    CloudEvent const& event) {
+  if (!IsPubsubEvent(event)) {
+    throw std::invalid_argument("not a Pub/Sub event: " + event.type());
+  }
+  PubsubMessage message;
+  auto const data = event.data_view();
+  if (!data) return message;
+  // Locate the fields in one pass over each level, the views refer to the
+  // event data.
+  std::string_view raw_message = "null";
+  for (auto const& m : ObjectMembers(*data, "the event data")) {
+    if (m.key == "message") raw_message = m.value;
+    if (m.key == "subscription") message.subscription = StringValue(m.value);
+  }
+  for (auto const& m : ObjectMembers(raw_message, "message")) {
+    if (m.value == "null") continue;
+    if (m.key == "data") {
+      message.data = functions_internal::JsonBase64Decode(m.value);
+    } else if (m.key == "attributes") {
+      for (auto const& a : ObjectMembers(m.value, "message.attributes")) {
+        message.attributes.emplace(KeyValue(a.key), StringValue(a.value));
+      }
+    } else if (m.key == "messageId" || m.key == "message_id") {
+      message.message_id = StringValue(m.value);
+    } else if (m.key == "orderingKey") {
+      message.ordering_key = StringValue(m.value);
+    } else if (m.key == "publishTime" || m.key == "publish_time") {
+      message.publish_time =
+          functions_internal::ParseTimestamp(StringValue(m.value));
+    }
+  }
+  return message;
+}
+
+std::optional<std::string> PubsubOrderingKey(CloudEvent const& event) try {
+  if (!IsPubsubEvent(event)) return std::nullopt;
+  auto const data = event.data_view();
+  if (!data) return std::nullopt;
+  std::string_view raw_message = "null";
+  for (auto const& m : ObjectMembers(*data, "the event data")) {
+    if (m.key == "message") raw_message = m.value;
+  }
+  for (auto const& m : ObjectMembers(raw_message, "message")) {
+    if (m.key != "orderingKey") continue;
+    auto key = StringValue(m.value);
+    if (key.empty()) return std::nullopt;
+    return key;
+  }
+  return std::nullopt;
+} catch (std::exception const&) {
+  return std::nullopt;
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
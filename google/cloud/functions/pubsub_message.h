@@ -0,0 +1,81 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_PUBSUB_MESSAGE_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_PUBSUB_MESSAGE_H
+
+#include "google/cloud/functions/cloud_event.h"
+#include "google/cloud/functions/version.h"
+#include <map>
+#include <optional>
+#include <string>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * A Pub/Sub message, as delivered in a Cloud Event.
+ *
+ * This is the data of the `google.cloud.pubsub.topic.v1.messagePublished`
+ * events, the `google.events.cloud.pubsub.v1.MessagePublishedData` schema.
+ * Use it with `CloudEvent::data_as()`:
+ *
+ * @code
+ * void handler(gcf::CloudEvent const& event) {
+ *   auto const message = event.data_as<gcf::PubsubMessage>();
+ *   std::cout << "Hello " << message->data << "\n";
+ * }
+ * @endcode
+ *
+ * The message data is decoded from base64 directly from the event data, in a
+ * single pass that does not build a DOM. The event keeps the result, further
+ * calls to `data_as()` do not decode it again. Fields missing from the event
+ * data are empty or `std::nullopt`.
+ */
+struct PubsubMessage {
+  /// The message payload, decoded. It may contain any bytes.
+  std::string data;
+  std::map<std::string, std::string> attributes;
+  std::string message_id;
+  std::string ordering_key;
+  std::optional<CloudEvent::time_point> publish_time;
+  /// The subscription that delivered the message, if known.
+  std::string subscription;
+};
+
+template <>
+struct CloudEventDataDecoder<PubsubMessage> {
+  /**
+   * Decodes the JSON data of a Pub/Sub event.
+   *
+   * Throws `std::invalid_argument` if @p event is not a Pub/Sub event, or if
+   * its data is not valid.
+   */
+  static PubsubMessage Decode(CloudEvent const& event);
+};
+
+/**
+ * Returns the ordering key of a Pub/Sub event, if any.
+ *
+ * Use it as `CloudEventBatchOptions::ordering_key` to run the messages with
+ * the same ordering key in order. It only scans the event data for the key,
+ * the message payload is not decoded. Returns `std::nullopt` for other
+ * events, invalid data, and messages without an ordering key.
+ */
+std::optional<std::string> PubsubOrderingKey(CloudEvent const& event);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_PUBSUB_MESSAGE_H
@@ -0,0 +1,121 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/pubsub_message.h"
+#include <gmock/gmock.h>
+#include <chrono>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+// The data is "Hello\0World", with an embedded NUL, and the escaped `/` is
+// valid JSON.
+auto constexpr kData = R"js({
+  "message": {
+    "attributes": {"key": "value", "with\"quote": "aé"},
+    "data": "SGVsbG8AV29ybGQ\/",
+    "messageId": "2070443601311540",
+    "message_id": "2070443601311540",
+    "orderingKey": "order-1",
+    "publishTime": "2021-02-05T04:06:14.109Z",
+    "publish_time": "2021-02-05T04:06:14.109Z"
+  },
+  "subscription": "projects/test-project/subscriptions/test-subscription"
+})js";
+
+CloudEvent MakePubsubEvent() {
+  return CloudEvent("test-id",
+                    "//pubsub.googleapis.com/projects/p/topics/t",
+                    "google.cloud.pubsub.topic.v1.messagePublished");
+}
+
+TEST(PubsubMessage, Decode) {
+  auto event = MakePubsubEvent();
+  event.set_data(kData);
+  auto const message = event.data_as<PubsubMessage>();
+  EXPECT_EQ(message->data, std::string("Hello\0World?", 12));
+  EXPECT_THAT(message->attributes,
+              ElementsAre(Pair("key", "value"),
+                          Pair("with\"quote", "a\xc3\xa9")));
+  EXPECT_EQ(message->message_id, "2070443601311540");
+  EXPECT_EQ(message->ordering_key, "order-1");
+  auto const published = CloudEvent::time_point{} +
+                         std::chrono::seconds(1612497974) +
+                         std::chrono::milliseconds(109);
+  EXPECT_EQ(message->publish_time, published);
+  EXPECT_EQ(message->subscription,
+            "projects/test-project/subscriptions/test-subscription");
+
+  // The event keeps the decoded message.
+  EXPECT_EQ(event.data_as<PubsubMessage>(), message);
+}
+
+TEST(PubsubMessage, Missing) {
+  auto event = MakePubsubEvent();
+  EXPECT_EQ(event.data_as<PubsubMessage>()->data, "");
+
+  event.set_data(R"js({"message": {"data": null, "attributes": null}})js");
+  auto const message = event.data_as<PubsubMessage>();
+  EXPECT_EQ(message->data, "");
+  EXPECT_TRUE(message->attributes.empty());
+  EXPECT_EQ(message->message_id, "");
+  EXPECT_FALSE(message->publish_time.has_value());
+}
+
+TEST(PubsubMessage, OrderingKey) {
+  auto event = MakePubsubEvent();
+  EXPECT_FALSE(PubsubOrderingKey(event).has_value());
+  event.set_data(kData);
+  EXPECT_EQ(PubsubOrderingKey(event), "order-1");
+  event.set_data(R"js({"message": {"orderingKey": ""}})js");
+  EXPECT_FALSE(PubsubOrderingKey(event).has_value());
+  event.set_data("not json");
+  EXPECT_FALSE(PubsubOrderingKey(event).has_value());
+
+  auto other = CloudEvent("test-id", "//source", "other.type");
+  other.set_data(kData);
+  EXPECT_FALSE(PubsubOrderingKey(other).has_value());
+}
+
+TEST(PubsubMessage, Schema) {
+  auto event = CloudEvent("test-id", "test-source", "test-type");
+  event.set_data_schema("google.events.cloud.pubsub.v1.MessagePublishedData");
+  event.set_data(R"js({"message": {"data": "SGk="}})js");
+  EXPECT_EQ(event.data_as<PubsubMessage>()->data, "Hi");
+}
+
+TEST(PubsubMessage, Invalid) {
+  auto other = CloudEvent("test-id", "test-source", "test-type");
+  other.set_data(kData);
+  EXPECT_THROW((void)other.data_as<PubsubMessage>(), std::invalid_argument);
+
+  for (auto const* data : {R"js({"message": {"data": "not base64!"}})js",
+                           R"js({"message": "not an object"})js",
+                           R"js({"message": {"attributes": []}})js",
+                           R"js({"message": {"publishTime": "yesterday"}})js",
+                           R"js({"message": )js"}) {
+    auto event = MakePubsubEvent();
+    event.set_data(data);
+    EXPECT_THROW((void)event.data_as<PubsubMessage>(), std::invalid_argument)
+        << data;
+  }
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
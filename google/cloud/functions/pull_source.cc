@@ -0,0 +1,33 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/pull_source.h"
+#include "google/cloud/functions/internal/event_puller.h"
+#include <utility>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+Function WithPullSource(Function function,
+                        std::shared_ptr<CloudEventSource> source,
+                        PullOptions options) {
+  return functions_internal::FunctionImpl::MakeFunction(
+      std::make_shared<functions_internal::PullFunctionImpl>(
+          functions_internal::FunctionImpl::GetImpl(function),
+          std::make_shared<functions_internal::EventPuller>(std::move(source),
+                                                            options)));
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
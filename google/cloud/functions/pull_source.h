@@ -0,0 +1,121 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_PULL_SOURCE_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_PULL_SOURCE_H
+
+#include "google/cloud/functions/cloud_event.h"
+#include "google/cloud/functions/function.h"
+#include "google/cloud/functions/version.h"
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// An event received from a `CloudEventSource`.
+struct PulledCloudEvent {
+  CloudEvent event;
+  /// Identifies the event in `CloudEventSource::Ack()` and `Nack()`.
+  std::string ack_id;
+};
+
+/**
+ * Delivers the Cloud Events pulled from a messaging service.
+ *
+ * Implement this interface to adapt a client, such as the Pub/Sub streaming
+ * pull subscriber, see `WithPullSource()`. Implementations must be safe to
+ * call from multiple threads.
+ */
+class CloudEventSource {
+ public:
+  virtual ~CloudEventSource() = default;
+
+  /**
+   * Returns up to @p max_events events.
+   *
+   * Waits up to @p timeout for the first event, and returns an empty vector
+   * if there is none. Events are redelivered if they are not acknowledged,
+   * e.g., after a crash, so functions must tolerate duplicates.
+   */
+  virtual std::vector<PulledCloudEvent> Pull(
+      std::size_t max_events, std::chrono::milliseconds timeout) = 0;
+
+  /// Acknowledges the events that completed successfully.
+  virtual void Ack(std::vector<std::string> ack_ids) = 0;
+
+  /// Returns the events that failed, to be redelivered.
+  virtual void Nack(std::vector<std::string> ack_ids) = 0;
+};
+
+/// Configures how `WithPullSource()` runs the events.
+struct PullOptions {
+  /// The number of threads pulling and running events, use 0 for one per
+  /// core, as with `--threads`.
+  std::size_t concurrency = 0;
+
+  /**
+   * The maximum number of events each thread pulls and runs at once.
+   *
+   * A thread pulls again only once all its events complete, so at most
+   * `concurrency * max_batch_size` events are outstanding. Larger values
+   * pass the events to the function as a batch, see
+   * `UserCloudEventBatchFunction`.
+   */
+  std::size_t max_batch_size = 1;
+
+  /// Acknowledgements are sent once this many are pending, or after
+  /// `ack_delay`.
+  std::size_t ack_batch_size = 100;
+  std::chrono::milliseconds ack_delay = std::chrono::milliseconds(100);
+};
+
+/**
+ * Runs @p function with the events pulled from @p source.
+ *
+ * High volume subscriptions avoid the cost of a push delivery, an HTTP request
+ * with a JSON envelope and base64 encoded data for each message. The events
+ * run through @p function as pushed events do, including any decorators, but
+ * in the binary content mode, so the event data is neither copied nor
+ * encoded. Events that complete successfully are acknowledged, the others
+ * returned to the source. The events in a batch are acknowledged one by one,
+ * see `CloudEventBatchError`.
+ *
+ * Pulling starts once the warmup functions complete, and stops when the
+ * server shuts down, after the events in progress complete. The server still
+ * listens on its port, for health checks and pushed events.
+ *
+ * @par Example
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * int main(int argc, char* argv[]) {
+ *   gcf::PullOptions options;
+ *   options.max_batch_size = 10;
+ *   return gcf::Run(argc, argv,
+ *                   gcf::WithPullSource(gcf::MakeFunction(Handle),
+ *                                       MakeSubscriptionSource(), options));
+ * }
+ * @endcode
+ */
+Function WithPullSource(Function function,
+                        std::shared_ptr<CloudEventSource> source,
+                        PullOptions options = {});
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_PULL_SOURCE_H
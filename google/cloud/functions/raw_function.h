@@ -0,0 +1,88 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_RAW_FUNCTION_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_RAW_FUNCTION_H
+
+#include "google/cloud/functions/internal/http_message_types.h"
+#include "google/cloud/functions/function.h"
+#include "google/cloud/functions/version.h"
+#include <functional>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * The request received by raw `http` functions.
+ *
+ * @warning This is the framework's internal representation of requests, a
+ *     `boost::beast::http::request<>`. It may change in any release, without
+ *     notice, including changes to the Boost.Beast version, the body type, and
+ *     the allocator of its header fields.
+ */
+using RawHttpRequest = functions_internal::BeastRequest;
+
+/**
+ * The response returned by raw `http` functions.
+ *
+ * @warning This is the framework's internal representation of responses, a
+ *     `boost::beast::http::response<>`. It may change in any release, without
+ *     notice.
+ */
+using RawHttpResponse = functions_internal::BeastResponse;
+
+/// The signature of raw `http` functions, see `MakeFunction()`.
+using UserRawHttpFunction = std::function<RawHttpResponse(RawHttpRequest)>;
+
+/**
+ * Wraps an `http` handler that receives and returns Boost.Beast messages.
+ *
+ * The framework calls @p function with the request as it was parsed, and
+ * sends the response it returns, skipping the conversions to `HttpRequest`
+ * and from `HttpResponse`. The function still runs in the framework's server,
+ * with its middleware, lifecycle, logging, and metrics. Exceptions are
+ * reported as with any other function.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * namespace http = boost::beast::http;
+ * auto MyFunction() {
+ *   return gcf::MakeFunction([](gcf::RawHttpRequest request) {
+ *     gcf::RawHttpResponse response;
+ *     response.set(http::field::content_type, "text/plain");
+ *     response.body() = std::move(request.body());
+ *     return response;
+ *   });
+ * }
+ * @endcode
+ *
+ * @warning This is an advanced API, with no stability guarantees. Applications
+ *     using it must be rebuilt, and may need changes, for each release of the
+ *     framework. Prefer the other `MakeFunction()` overloads, unless the cost
+ *     of converting the messages is significant.
+ *
+ * Raw functions take on some of the work done by the framework:
+ * - The header fields of the request are allocated from a per-connection
+ *   memory pool, the request, and any copies of its fields, must not outlive
+ *   the call.
+ * - The `server`, `date`, `content-length`, and `connection` headers are
+ *   set by the server, as for other functions. The function is responsible
+ *   for any other headers, including `content-type`.
+ */
+Function MakeFunction(UserRawHttpFunction function);
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_RAW_FUNCTION_H
@@ -0,0 +1,74 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/raw_function.h"
+#include "google/cloud/functions/in_process_invoker.h"
+#include <gmock/gmock.h>
+#include <stdexcept>
+#include <string>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+namespace http = ::boost::beast::http;
+using ::testing::HasSubstr;
+
+TEST(RawFunctionTest, Basic) {
+  auto function = MakeFunction([](RawHttpRequest request) {
+    RawHttpResponse response;
+    response.result(http::status::accepted);
+    response.set(http::field::content_type, "text/plain");
+    response.body() = std::string(request.target()) + ":" + request.body();
+    return response;
+  });
+  InProcessInvoker invoker(function);
+  auto const response = invoker.Invoke(
+      HttpRequest{}.set_verb("POST").set_target("/raw").set_payload("body"));
+  EXPECT_EQ(response.result(), HttpResponse::kAccepted);
+  EXPECT_EQ(response.payload(), "/raw:body");
+  EXPECT_EQ(response.header("content-type").value_or(""), "text/plain");
+  // The server still sets its headers.
+  EXPECT_TRUE(response.has_header("server"));
+  EXPECT_TRUE(response.has_header("date"));
+  EXPECT_EQ(response.header("content-length").value_or(""), "9");
+}
+
+TEST(RawFunctionTest, Exception) {
+  InProcessInvoker invoker(
+      MakeFunction([](RawHttpRequest) -> RawHttpResponse {
+        throw std::runtime_error("raw failure");
+      }));
+  auto const response = invoker.Invoke(HttpRequest{}.set_target("/"));
+  EXPECT_EQ(response.result(), HttpResponse::kInternalServerError);
+  EXPECT_THAT(response.payload(), HasSubstr("raw failure"));
+}
+
+TEST(RawFunctionTest, Decorators) {
+  auto function = WithPrecheck(
+      MakeFunction([](RawHttpRequest) { return RawHttpResponse{}; }),
+      [](HttpRequest const& request) -> std::optional<HttpResponse> {
+        if (request.target() == "/ok") return std::nullopt;
+        return HttpResponse{}.set_result(HttpResponse::kForbidden);
+      });
+  InProcessInvoker invoker(function);
+  EXPECT_EQ(invoker.Invoke(HttpRequest{}.set_target("/ok")).result(),
+            HttpResponse::kOkay);
+  EXPECT_EQ(invoker.Invoke(HttpRequest{}.set_target("/no")).result(),
+            HttpResponse::kForbidden);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
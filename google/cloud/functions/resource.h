@@ -0,0 +1,148 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_RESOURCE_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_RESOURCE_H
+
+#include "google/cloud/functions/function.h"
+#include "google/cloud/functions/version.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// How many instances a `Resource<T>` creates.
+enum class ResourceScope {
+  /// A single instance, shared by all the threads.
+  kShared,
+  /// One instance for each thread that uses the resource.
+  kPerThread,
+};
+
+/**
+ * A client, or connection pool, that lives as long as the server.
+ *
+ * Functions often keep their clients in function-local statics, which are
+ * created by the first request and never destroyed. A `Resource` attached to
+ * the function with `WithResource()` is created during startup, before the
+ * server accepts requests, is shared by all the sessions, and is destroyed
+ * once the server stops.
+ *
+ * Use `ResourceScope::kPerThread` for objects that are not thread-safe, each
+ * thread creates its instance on first use. All the instances are destroyed
+ * by the thread running the shutdown.
+ *
+ * @code
+ * namespace gcf = google::cloud::functions;
+ * auto client = std::make_shared<gcf::Resource<Client>>(
+ *     [] { return std::make_unique<Client>(MakeConnection()); });
+ *
+ * gcf::Function MyFunction() {
+ *   return gcf::WithResource(
+ *       gcf::MakeFunction([client](gcf::HttpRequest const& request) {
+ *         return Handle(client->get(), request);
+ *       }),
+ *       client);
+ * }
+ * @endcode
+ */
+template <typename T>
+class Resource {
+ public:
+  using Factory = std::function<std::unique_ptr<T>()>;
+
+  explicit Resource(Factory factory,
+                    ResourceScope scope = ResourceScope::kShared)
+      : factory_(std::move(factory)), scope_(scope) {}
+
+  Resource(Resource const&) = delete;
+  Resource& operator=(Resource const&) = delete;
+
+  [[nodiscard]] ResourceScope scope() const { return scope_; }
+
+  /// Returns the instance for the calling thread, creating it if needed.
+  T& get() {
+    if (scope_ == ResourceScope::kPerThread) return GetPerThread();
+    if (auto* p = instance_.load(std::memory_order_acquire)) return *p;
+    std::lock_guard<std::mutex> lk(mu_);
+    if (!shared_) {
+      shared_ = factory_();
+      instance_.store(shared_.get(), std::memory_order_release);
+    }
+    return *shared_;
+  }
+
+  /// Creates the instance for the calling thread, unless it exists.
+  void Create() { (void)get(); }
+
+  /// Destroys all the instances, `get()` creates new ones if called again.
+  void Reset() {
+    std::unique_ptr<T> shared;
+    std::unordered_map<std::thread::id, std::unique_ptr<T>> per_thread;
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      instance_.store(nullptr, std::memory_order_release);
+      shared = std::move(shared_);
+      per_thread.swap(per_thread_);
+    }
+  }
+
+ private:
+  T& GetPerThread() {
+    auto const id = std::this_thread::get_id();
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      auto l = per_thread_.find(id);
+      if (l != per_thread_.end()) return *l->second;
+    }
+    // Create the instance outside the lock, other threads may be creating
+    // theirs.
+    auto instance = factory_();
+    std::lock_guard<std::mutex> lk(mu_);
+    return *per_thread_.try_emplace(id, std::move(instance)).first->second;
+  }
+
+  Factory factory_;
+  ResourceScope scope_;
+  std::mutex mu_;
+  std::atomic<T*> instance_{nullptr};
+  std::unique_ptr<T> shared_;
+  std::unordered_map<std::thread::id, std::unique_ptr<T>> per_thread_;
+};
+
+/**
+ * Ties the lifetime of @p resource to the server running @p function.
+ *
+ * The resource is created as a warmup, see `WithWarmup()`, and reset once
+ * the server stops, see `WithShutdown()`. Per-thread resources create the
+ * instance for the warmup thread only.
+ */
+template <typename T>
+Function WithResource(Function function,
+                      std::shared_ptr<Resource<T>> resource) {
+  return WithShutdown(
+      WithWarmup(std::move(function), [resource] { resource->Create(); }),
+      [resource] { resource->Reset(); });
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_RESOURCE_H
@@ -0,0 +1,95 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/resource.h"
+#include "google/cloud/functions/internal/function_impl.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::google::cloud::functions_internal::FunctionImpl;
+
+struct Counted {
+  explicit Counted(std::atomic<int>& live) : live(live) { ++live; }
+  ~Counted() { --live; }
+  std::atomic<int>& live;
+};
+
+TEST(ResourceTest, Shared) {
+  std::atomic<int> live{0};
+  std::atomic<int> created{0};
+  Resource<Counted> resource([&] {
+    ++created;
+    return std::make_unique<Counted>(live);
+  });
+  EXPECT_EQ(resource.scope(), ResourceScope::kShared);
+  std::vector<std::future<Counted*>> users(4);
+  for (auto& u : users) {
+    u = std::async(std::launch::async, [&] { return &resource.get(); });
+  }
+  auto* const instance = &resource.get();
+  for (auto& u : users) EXPECT_EQ(u.get(), instance);
+  EXPECT_EQ(created.load(), 1);
+  EXPECT_EQ(live.load(), 1);
+
+  resource.Reset();
+  EXPECT_EQ(live.load(), 0);
+  (void)resource.get();
+  EXPECT_EQ(created.load(), 2);
+}
+
+TEST(ResourceTest, PerThread) {
+  std::atomic<int> live{0};
+  Resource<Counted> resource([&] { return std::make_unique<Counted>(live); },
+                             ResourceScope::kPerThread);
+  auto* const mine = &resource.get();
+  EXPECT_EQ(&resource.get(), mine);
+  auto* const other =
+      std::async(std::launch::async, [&] { return &resource.get(); }).get();
+  EXPECT_NE(other, mine);
+  EXPECT_EQ(live.load(), 2);
+  resource.Reset();
+  EXPECT_EQ(live.load(), 0);
+}
+
+TEST(ResourceTest, WithResource) {
+  std::atomic<int> live{0};
+  auto resource = std::make_shared<Resource<Counted>>(
+      [&] { return std::make_unique<Counted>(live); });
+  auto function = WithResource(MakeFunction([](HttpRequest const& /*r*/) {
+                                 return HttpResponse{};
+                               }),
+                               resource);
+  auto const& impl = *FunctionImpl::GetImpl(function);
+
+  auto warmups = impl.GetWarmupHandlers("unused");
+  ASSERT_EQ(warmups.size(), 1);
+  warmups.front()();
+  EXPECT_EQ(live.load(), 1);
+
+  auto shutdown = impl.GetShutdownHandlers("unused");
+  ASSERT_EQ(shutdown.size(), 1);
+  shutdown.front()();
+  EXPECT_EQ(live.load(), 0);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
@@ -0,0 +1,95 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/server_sent_events.h"
+#include "google/cloud/functions/http_response.h"
+#include <stdexcept>
+#include <utility>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+/// An empty comment, clients ignore it.
+auto constexpr kHeartbeat = std::string_view{":\n"};
+
+void CheckField(std::string_view name, std::string_view value,
+                std::string_view invalid) {
+  if (value.find_first_of(invalid) == std::string_view::npos) return;
+  throw std::invalid_argument("invalid characters in the event " +
+                              std::string(name) + ": " + std::string(value));
+}
+
+/// Appends a field for each line in @p value, any line ending splits it.
+void AppendLines(std::string& out, std::string_view prefix,
+                 std::string_view value) {
+  while (true) {
+    auto const eol = value.find_first_of("\r\n");
+    out += prefix;
+    out += value.substr(0, eol);
+    out += '\n';
+    if (eol == std::string_view::npos) return;
+    auto const skip =
+        value[eol] == '\r' && eol + 1 < value.size() && value[eol + 1] == '\n'
+            ? 2
+            : 1;
+    value.remove_prefix(eol + skip);
+  }
+}
+
+}  // namespace
+
+ServerSentEventWriter::ServerSentEventWriter(HttpResponseWriter& writer,
+                                             ServerSentEventOptions options)
+    : writer_(writer), token_(CurrentCancellationToken()) {
+  // The events must reach the client as sent, without compression or
+  // buffering in proxies.
+  writer_.WriteHeader(HttpResponse{}
+                          .set_header("content-type", "text/event-stream")
+                          .set_header("cache-control", "no-cache, no-transform")
+                          .set_header("x-accel-buffering", "no"));
+  if (options.heartbeat_interval != std::chrono::milliseconds(0)) {
+    writer_.SetHeartbeat(kHeartbeat, options.heartbeat_interval);
+  }
+}
+
+void ServerSentEventWriter::Send(ServerSentEvent const& event) {
+  CheckField("type", event.event, "\r\n");
+  if (event.id) CheckField("id", *event.id, std::string_view("\r\n\0", 3));
+  buffer_.clear();
+  if (!event.event.empty()) AppendLines(buffer_, "event: ", event.event);
+  if (event.id) AppendLines(buffer_, "id: ", *event.id);
+  if (event.retry) {
+    buffer_ += "retry: " + std::to_string(event.retry->count()) + "\n";
+  }
+  AppendLines(buffer_, "data: ", event.data);
+  buffer_ += '\n';
+  writer_.Write(buffer_);
+}
+
+void ServerSentEventWriter::Send(std::string_view data) {
+  buffer_.clear();
+  AppendLines(buffer_, "data: ", data);
+  buffer_ += '\n';
+  writer_.Write(buffer_);
+}
+
+void ServerSentEventWriter::SendComment(std::string_view comment) {
+  buffer_.clear();
+  AppendLines(buffer_, ": ", comment);
+  writer_.Write(buffer_);
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
@@ -0,0 +1,114 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_SERVER_SENT_EVENTS_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_SERVER_SENT_EVENTS_H
+
+#include "google/cloud/functions/cancellation_token.h"
+#include "google/cloud/functions/http_response_writer.h"
+#include "google/cloud/functions/version.h"
+#include <chrono>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/// An event sent by `ServerSentEventWriter`.
+struct ServerSentEvent {
+  /// The event data, it may have multiple lines.
+  std::string data;
+  /// The event type, if empty, clients receive a `message` event.
+  std::string event;
+  /// If set, clients send it as `Last-Event-ID` when they reconnect.
+  std::optional<std::string> id = {};
+  /// If set, how long clients wait before reconnecting.
+  std::optional<std::chrono::milliseconds> retry = {};
+};
+
+/// Configures `ServerSentEventWriter`.
+struct ServerSentEventOptions {
+  /**
+   * Sends a comment once the stream is idle for this long, use 0 to disable.
+   *
+   * Proxies and load balancers close connections that are idle for too long.
+   */
+  std::chrono::milliseconds heartbeat_interval = std::chrono::seconds(15);
+};
+
+/**
+ * Sends a `text/event-stream` response, see the [Server-Sent Events][sse]
+ * specification.
+ *
+ * Use this in functions with the streaming response signature. The writer
+ * sends the response header once created, and each event as soon as it is
+ * sent. The framework sends the heartbeats while the function waits for its
+ * next event. Once the client disconnects, `cancelled()` returns `true`, and
+ * sending events throws `std::runtime_error`.
+ *
+ * @par Example
+ * @code
+ * namespace gcf = ::google::cloud::functions;
+ *
+ * void Progress(gcf::HttpRequest const&, gcf::HttpResponseWriter& w) {
+ *   gcf::ServerSentEventWriter events(w);
+ *   for (auto const& step : Steps()) {
+ *     if (events.cancelled()) return;
+ *     events.Send(gcf::ServerSentEvent{Run(step), "progress"});
+ *   }
+ * }
+ * @endcode
+ *
+ * [sse]: https://html.spec.whatwg.org/multipage/server-sent-events.html
+ */
+class ServerSentEventWriter {
+ public:
+  explicit ServerSentEventWriter(HttpResponseWriter& writer,
+                                 ServerSentEventOptions options = {});
+
+  /**
+   * Sends @p event.
+   *
+   * @throws std::invalid_argument if the event type or id contain a newline,
+   *     or the id contains a NUL character.
+   * @throws std::runtime_error if there is an error sending the event.
+   */
+  void Send(ServerSentEvent const& event);
+
+  /// Sends a `message` event with @p data.
+  void Send(std::string_view data);
+
+  /// Sends a comment, clients ignore it.
+  void SendComment(std::string_view comment);
+
+  /// Returns `true` once the client disconnects, or the request deadline
+  /// passes.
+  [[nodiscard]] bool cancelled() const { return token_.cancelled(); }
+
+  /// The cancellation token of the request.
+  [[nodiscard]] CancellationToken const& cancellation_token() const {
+    return token_;
+  }
+
+ private:
+  HttpResponseWriter& writer_;
+  CancellationToken token_;
+  std::string buffer_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_SERVER_SENT_EVENTS_H
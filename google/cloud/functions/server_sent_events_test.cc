@@ -0,0 +1,100 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/server_sent_events.h"
+#include <gmock/gmock.h>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+
+class TestWriter : public HttpResponseWriter {
+ public:
+  void WriteHeader(HttpResponse response) override {
+    header = std::move(response);
+  }
+  void Write(std::string_view data) override { writes.emplace_back(data); }
+  void SetHeartbeat(std::string_view data,
+                    std::chrono::milliseconds interval) override {
+    heartbeat = std::string(data);
+    heartbeat_interval = interval;
+  }
+
+  std::optional<HttpResponse> header;
+  std::vector<std::string> writes;
+  std::string heartbeat;
+  std::chrono::milliseconds heartbeat_interval{0};
+};
+
+TEST(ServerSentEventWriter, Header) {
+  TestWriter writer;
+  ServerSentEventWriter events(writer);
+  ASSERT_TRUE(writer.header.has_value());
+  EXPECT_EQ(writer.header->result(), HttpResponse::kOkay);
+  auto const& headers = writer.header->headers();
+  EXPECT_EQ(headers.get("content-type"), "text/event-stream");
+  EXPECT_EQ(headers.get("cache-control"), "no-cache, no-transform");
+  EXPECT_EQ(writer.heartbeat, ":\n");
+  EXPECT_EQ(writer.heartbeat_interval, std::chrono::seconds(15));
+  EXPECT_TRUE(writer.writes.empty());
+  EXPECT_FALSE(events.cancelled());
+}
+
+TEST(ServerSentEventWriter, NoHeartbeat) {
+  TestWriter writer;
+  ServerSentEventOptions options;
+  options.heartbeat_interval = std::chrono::milliseconds(0);
+  ServerSentEventWriter events(writer, options);
+  EXPECT_EQ(writer.heartbeat, "");
+}
+
+TEST(ServerSentEventWriter, Send) {
+  TestWriter writer;
+  ServerSentEventWriter events(writer);
+  events.Send("hello");
+  events.Send("two\nlines");
+  events.Send("");
+  events.Send(ServerSentEvent{"a\r\nb\rc", "progress", "42",
+                              std::chrono::milliseconds(1500)});
+  events.Send(ServerSentEvent{"x", "", "", std::nullopt});
+  events.SendComment("note");
+  EXPECT_THAT(writer.writes,
+              ElementsAre("data: hello\n\n", "data: two\ndata: lines\n\n",
+                          "data: \n\n",
+                          "event: progress\nid: 42\nretry: 1500\n"
+                          "data: a\ndata: b\ndata: c\n\n",
+                          "id: \ndata: x\n\n", ": note\n"));
+}
+
+TEST(ServerSentEventWriter, Invalid) {
+  TestWriter writer;
+  ServerSentEventWriter events(writer);
+  EXPECT_THROW(events.Send(ServerSentEvent{"data", "bad\ntype"}),
+               std::invalid_argument);
+  EXPECT_THROW(events.Send(ServerSentEvent{"data", "", "bad\rid"}),
+               std::invalid_argument);
+  EXPECT_THROW(
+      events.Send(ServerSentEvent{"data", "", std::string("bad\0id", 6)}),
+      std::invalid_argument);
+  EXPECT_TRUE(writer.writes.empty());
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
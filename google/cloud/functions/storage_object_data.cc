@@ -0,0 +1,80 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/storage_object_data.h"
+#include "google/cloud/functions/internal/parse_time.h"
+#include "google/cloud/functions/json_document.h"
+#include <charconv>
+#include <stdexcept>
+#include <string_view>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+auto constexpr kStorageEventPrefix = std::string_view{
+    "google.cloud.storage.object.v1."};
+auto constexpr kStorageObjectDataSchema = std::string_view{
+    "google.events.cloud.storage.v1.StorageObjectData"};
+
+/// The JSON mapping of `int64` fields uses strings, accept numbers too.
+std::int64_t GetInt64(JsonDocument const& doc, std::string_view pointer) {
+  auto const raw = doc.raw(pointer);
+  if (!raw || raw->front() != '"') return doc.get_int64(pointer).value_or(0);
+  auto const text = doc.get_string(pointer).value_or("");
+  std::int64_t value = 0;
+  auto const* end = text.data() + text.size();
+  auto const [ptr, ec] = std::from_chars(text.data(), end, value);
+  if (ec != std::errc{} || ptr != end) {
+    throw std::invalid_argument("invalid int64 value in " +
+                                std::string(pointer) + ": " + text);
+  }
+  return value;
+}
+
+std::optional<CloudEvent::time_point> GetTime(JsonDocument const& doc,
+                                              std::string_view pointer) {
+  auto const text = doc.get_string(pointer);
+  if (!text) return std::nullopt;
+  return functions_internal::ParseTimestamp(*text);
+}
+
+}  // namespace
+
+StorageObjectData CloudEventDataDecoder<StorageObjectData>::Decode(
+    CloudEvent const& event) {
+  if (event.type_view().rfind(kStorageEventPrefix, 0) != 0 &&
+      event.data_schema_view().value_or("") != kStorageObjectDataSchema) {
+    throw std::invalid_argument("not a Cloud Storage object event: " +
+                                event.type());
+  }
+  auto const doc = event.data_json().value_or(JsonDocument("{}"));
+  StorageObjectData data;
+  data.bucket = doc.get_string("/bucket").value_or("");
+  data.name = doc.get_string("/name").value_or("");
+  data.generation = GetInt64(doc, "/generation");
+  data.metageneration = GetInt64(doc, "/metageneration");
+  data.content_type = doc.get_string("/contentType").value_or("");
+  data.size = GetInt64(doc, "/size");
+  data.storage_class = doc.get_string("/storageClass").value_or("");
+  data.md5_hash = doc.get_string("/md5Hash").value_or("");
+  data.crc32c = doc.get_string("/crc32c").value_or("");
+  data.etag = doc.get_string("/etag").value_or("");
+  data.time_created = GetTime(doc, "/timeCreated");
+  data.updated = GetTime(doc, "/updated");
+  return data;
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
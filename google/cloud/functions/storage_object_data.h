@@ -0,0 +1,72 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_STORAGE_OBJECT_DATA_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_STORAGE_OBJECT_DATA_H
+
+#include "google/cloud/functions/cloud_event.h"
+#include "google/cloud/functions/version.h"
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * The commonly used fields of a Cloud Storage object event.
+ *
+ * This is the data of the `google.cloud.storage.object.v1.*` events, the
+ * `google.events.cloud.storage.v1.StorageObjectData` schema. Use it with
+ * `CloudEvent::data_as()`:
+ *
+ * @code
+ * void handler(gcf::CloudEvent const& event) {
+ *   auto const object = event.data_as<gcf::StorageObjectData>();
+ *   std::cout << "Object: " << object->name << "\n";
+ * }
+ * @endcode
+ *
+ * Fields missing from the event data are empty, zero, or `std::nullopt`.
+ */
+struct StorageObjectData {
+  std::string bucket;
+  std::string name;
+  std::int64_t generation = 0;
+  std::int64_t metageneration = 0;
+  std::string content_type;
+  std::int64_t size = 0;
+  std::string storage_class;
+  std::string md5_hash;
+  std::string crc32c;
+  std::string etag;
+  std::optional<CloudEvent::time_point> time_created;
+  std::optional<CloudEvent::time_point> updated;
+};
+
+template <>
+struct CloudEventDataDecoder<StorageObjectData> {
+  /**
+   * Decodes the JSON data of a Cloud Storage event.
+   *
+   * Throws `std::invalid_argument` if @p event is not a Cloud Storage object
+   * event, or if its data is not valid.
+   */
+  static StorageObjectData Decode(CloudEvent const& event);
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_STORAGE_OBJECT_DATA_H
@@ -0,0 +1,84 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/storage_object_data.h"
+#include <gmock/gmock.h>
+#include <chrono>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+auto constexpr kData = R"js({
+  "bucket": "some-bucket",
+  "contentType": "text/plain",
+  "crc32c": "rTVTeQ==",
+  "etag": "CNHZkbuF/ugCEAE=",
+  "generation": "1587627537231057",
+  "md5Hash": "kF8MuJ5+CTJxvyhHS1xzRg==",
+  "metageneration": 1,
+  "name": "folder/Test.cs",
+  "size": "352",
+  "storageClass": "MULTI_REGIONAL",
+  "timeCreated": "2020-04-23T07:38:57.230Z",
+  "updated": "2020-04-23T07:38:57Z"
+})js";
+
+TEST(StorageObjectData, Decode) {
+  auto event = CloudEvent("test-id",
+                          "//storage.googleapis.com/projects/_/buckets/b",
+                          "google.cloud.storage.object.v1.finalized");
+  event.set_data(kData);
+  auto const data = event.data_as<StorageObjectData>();
+  EXPECT_EQ(data->bucket, "some-bucket");
+  EXPECT_EQ(data->name, "folder/Test.cs");
+  EXPECT_EQ(data->generation, 1587627537231057);
+  EXPECT_EQ(data->metageneration, 1);
+  EXPECT_EQ(data->content_type, "text/plain");
+  EXPECT_EQ(data->size, 352);
+  EXPECT_EQ(data->storage_class, "MULTI_REGIONAL");
+  EXPECT_EQ(data->md5_hash, "kF8MuJ5+CTJxvyhHS1xzRg==");
+  EXPECT_EQ(data->crc32c, "rTVTeQ==");
+  EXPECT_EQ(data->etag, "CNHZkbuF/ugCEAE=");
+  auto const updated =
+      CloudEvent::time_point{} + std::chrono::seconds(1587627537);
+  EXPECT_EQ(data->time_created, updated + std::chrono::milliseconds(230));
+  EXPECT_EQ(data->updated, updated);
+}
+
+TEST(StorageObjectData, Missing) {
+  auto event = CloudEvent("test-id", "test-source", "test-type");
+  event.set_data_schema("google.events.cloud.storage.v1.StorageObjectData");
+  auto const data = event.data_as<StorageObjectData>();
+  EXPECT_EQ(data->bucket, "");
+  EXPECT_EQ(data->generation, 0);
+  EXPECT_FALSE(data->time_created.has_value());
+}
+
+TEST(StorageObjectData, Invalid) {
+  auto event = CloudEvent("test-id", "test-source", "test-type");
+  event.set_data(kData);
+  EXPECT_THROW((void)event.data_as<StorageObjectData>(),
+               std::invalid_argument);
+
+  auto storage = CloudEvent("test-id", "test-source",
+                            "google.cloud.storage.object.v1.deleted");
+  storage.set_data(R"js({"size": "not-a-number"})js");
+  EXPECT_THROW((void)storage.data_as<StorageObjectData>(),
+               std::invalid_argument);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
@@ -0,0 +1,61 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_TESTING_UTIL_CGROUP_DIRECTORY_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_TESTING_UTIL_CGROUP_DIRECTORY_H
+
+#include "google/cloud/functions/version.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+namespace google::cloud::functions_internal {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * A fake cgroup filesystem, in tests.
+ *
+ * The directory is created in the temporary directory, its name starts with
+ * @p prefix, use a different prefix in each test program.
+ */
+class CgroupDirectory {
+ public:
+  explicit CgroupDirectory(std::string const& prefix)
+      : root_(std::filesystem::temp_directory_path() /
+              (prefix + "_" + std::to_string(std::rand()))) {}
+  ~CgroupDirectory() {
+    std::error_code ec;
+    std::filesystem::remove_all(root_, ec);
+  }
+
+  CgroupDirectory(CgroupDirectory const&) = delete;
+  CgroupDirectory& operator=(CgroupDirectory const&) = delete;
+
+  void Write(std::filesystem::path const& name, std::string const& contents) {
+    auto const path = root_ / name;
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream(path) << contents;
+  }
+  [[nodiscard]] std::filesystem::path const& root() const { return root_; }
+
+ private:
+  std::filesystem::path root_;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions_internal
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_TESTING_UTIL_CGROUP_DIRECTORY_H
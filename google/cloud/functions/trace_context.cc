@@ -0,0 +1,123 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/trace_context.h"
+#include "google/cloud/functions/internal/checkpoint.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+namespace {
+
+auto constexpr kTraceIdSize = 32;
+auto constexpr kSpanIdSize = 16;
+
+bool IsHex(char c) {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+}
+
+/// Returns true if @p id is lowercase hex, of @p size digits, and not all 0.
+bool IsValidId(std::string_view id, std::size_t size) {
+  return id.size() == size && std::all_of(id.begin(), id.end(), IsHex) &&
+         id.find_first_not_of('0') != std::string_view::npos;
+}
+
+std::string ToHex(std::uint64_t value) {
+  std::string hex(kSpanIdSize, '0');
+  char buffer[kSpanIdSize];
+  auto const r = std::to_chars(buffer, buffer + kSpanIdSize, value, 16);
+  std::copy(buffer, r.ptr, hex.end() - (r.ptr - buffer));
+  return hex;
+}
+
+}  // namespace
+
+std::optional<TraceContext> ParseTraceParent(std::string_view value) {
+  // version "-" trace-id "-" parent-id "-" trace-flags
+  auto constexpr kSize = 2 + 1 + kTraceIdSize + 1 + kSpanIdSize + 1 + 2;
+  if (value.size() < kSize || value[2] != '-' || value[35] != '-' ||
+      value[52] != '-') {
+    return std::nullopt;
+  }
+  auto const version = value.substr(0, 2);
+  // Version 0 has a fixed size, future versions may add fields.
+  if (!IsHex(version[0]) || !IsHex(version[1]) || version == "ff" ||
+      (version == "00" && value.size() != kSize)) {
+    return std::nullopt;
+  }
+  if (value.size() > kSize && value[kSize] != '-') return std::nullopt;
+  auto const trace_id = value.substr(3, kTraceIdSize);
+  auto const span_id = value.substr(36, kSpanIdSize);
+  auto const flags = value.substr(53, 2);
+  if (!IsValidId(trace_id, kTraceIdSize) || !IsValidId(span_id, kSpanIdSize) ||
+      !IsHex(flags[0]) || !IsHex(flags[1])) {
+    return std::nullopt;
+  }
+  // Only the least significant bit, "sampled", is defined.
+  unsigned bits = 0;
+  std::from_chars(flags.data(), flags.data() + flags.size(), bits, 16);
+  auto const sampled = (bits & 0x01U) != 0;
+  return TraceContext{std::string(trace_id), std::string(span_id), sampled};
+}
+
+std::optional<TraceContext> ParseCloudTraceContext(std::string_view value) {
+  auto const slash = value.find('/');
+  if (slash == std::string_view::npos) return std::nullopt;
+  // Some clients send uppercase hex digits in the trace id.
+  std::string trace_id(value.substr(0, slash));
+  std::transform(trace_id.begin(), trace_id.end(), trace_id.begin(),
+                 [](char c) {
+                   if (c < 'A' || c > 'F') return c;
+                   return static_cast<char>(c - 'A' + 'a');
+                 });
+  if (!IsValidId(trace_id, kTraceIdSize)) return std::nullopt;
+  auto const rest = value.substr(slash + 1);
+  auto const semicolon = rest.find(';');
+  auto const span = rest.substr(0, semicolon);
+  std::uint64_t span_id = 0;
+  auto const* end = span.data() + span.size();
+  auto const r = std::from_chars(span.data(), end, span_id);
+  if (span.empty() || r.ec != std::errc{} || r.ptr != end || span_id == 0) {
+    return std::nullopt;
+  }
+  auto const sampled = semicolon != std::string_view::npos &&
+                       rest.substr(semicolon + 1) == "o=1";
+  return TraceContext{std::move(trace_id), ToHex(span_id), sampled};
+}
+
+std::string FormatTraceParent(TraceContext const& context) {
+  return "00-" + context.trace_id + "-" + context.span_id +
+         (context.sampled ? "-01" : "-00");
+}
+
+std::string FormatCloudTraceContext(TraceContext const& context) {
+  std::uint64_t span_id = 0;
+  auto const& s = context.span_id;
+  std::from_chars(s.data(), s.data() + s.size(), span_id, 16);
+  return context.trace_id + "/" + std::to_string(span_id) +
+         (context.sampled ? ";o=1" : ";o=0");
+}
+
+TraceContext MakeChildSpan(TraceContext const& parent) {
+  auto& generator = functions_internal::ThreadRandomGenerator();
+  std::uint64_t span_id = 0;
+  while (span_id == 0) span_id = generator();
+  return TraceContext{parent.trace_id, ToHex(span_id), parent.sampled};
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
@@ -0,0 +1,87 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_TRACE_CONTEXT_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_TRACE_CONTEXT_H
+
+#include "google/cloud/functions/version.h"
+#include <chrono>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Identifies a span in a distributed trace.
+ *
+ * Incoming requests carry the context of their caller in a `traceparent`
+ * header, see https://www.w3.org/TR/trace-context/, or in a Google Cloud
+ * `X-Cloud-Trace-Context` header. CloudEvents carry it in the `traceparent`
+ * extension attribute. Propagate the context in outbound calls to include
+ * them in the same trace.
+ */
+struct TraceContext {
+  /// The trace id, 32 lowercase hex digits.
+  std::string trace_id;
+  /// The span id, 16 lowercase hex digits.
+  std::string span_id;
+  /// If `true`, the caller records the trace.
+  bool sampled = false;
+};
+
+/// Parses a `traceparent` value, e.g. `00-<trace-id>-<span-id>-01`.
+std::optional<TraceContext> ParseTraceParent(std::string_view value);
+
+/// Parses an `X-Cloud-Trace-Context` value, i.e. `TRACE_ID/SPAN_ID;o=1`.
+std::optional<TraceContext> ParseCloudTraceContext(std::string_view value);
+
+/// Formats @p context as a `traceparent` value.
+std::string FormatTraceParent(TraceContext const& context);
+
+/// Formats @p context as an `X-Cloud-Trace-Context` value.
+std::string FormatCloudTraceContext(TraceContext const& context);
+
+/// Returns a new span in the same trace as @p parent, with a random span id.
+TraceContext MakeChildSpan(TraceContext const& parent);
+
+/// A span recorded by the framework, see `WithTracing()`.
+struct SpanData {
+  std::string name;
+  TraceContext context;
+  std::string parent_span_id;
+  std::chrono::system_clock::time_point start_time;
+  std::chrono::system_clock::time_point end_time;
+  /// The HTTP status code of the response.
+  int status_code = 0;
+};
+
+/**
+ * Receives the spans recorded by the framework.
+ *
+ * Implement this interface to send the spans to a tracing backend, such as
+ * Cloud Trace. The framework calls `Export()` from the threads running the
+ * function, implementations must be thread-safe, and should not block.
+ */
+class SpanExporter {
+ public:
+  virtual ~SpanExporter() = default;
+  virtual void Export(SpanData span) = 0;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_TRACE_CONTEXT_H
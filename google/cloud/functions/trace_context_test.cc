@@ -0,0 +1,113 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/trace_context.h"
+#include <gmock/gmock.h>
+#include <set>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+auto constexpr kTraceId = "4bf92f3577b34da6a3ce929d0e0e4736";
+
+TEST(TraceContextTest, ParseTraceParent) {
+  auto const context = ParseTraceParent(
+      "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01");
+  ASSERT_TRUE(context.has_value());
+  EXPECT_EQ(context->trace_id, kTraceId);
+  EXPECT_EQ(context->span_id, "00f067aa0ba902b7");
+  EXPECT_TRUE(context->sampled);
+
+  auto const unsampled = ParseTraceParent(
+      "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-00");
+  ASSERT_TRUE(unsampled.has_value());
+  EXPECT_FALSE(unsampled->sampled);
+
+  // Future versions may append fields.
+  auto const future = ParseTraceParent(
+      "01-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-03-extra");
+  ASSERT_TRUE(future.has_value());
+  EXPECT_TRUE(future->sampled);
+}
+
+TEST(TraceContextTest, ParseTraceParentInvalid) {
+  for (auto const* v : {
+           "",
+           "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7",
+           "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01-extra",
+           "ff-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01",
+           "00-00000000000000000000000000000000-00f067aa0ba902b7-01",
+           "00-4bf92f3577b34da6a3ce929d0e0e4736-0000000000000000-01",
+           "00-4BF92F3577B34DA6A3CE929D0E0E4736-00f067aa0ba902b7-01",
+           "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-0x",
+           "00_4bf92f3577b34da6a3ce929d0e0e4736_00f067aa0ba902b7_01",
+       }) {
+    EXPECT_FALSE(ParseTraceParent(v).has_value()) << v;
+  }
+}
+
+TEST(TraceContextTest, ParseCloudTraceContext) {
+  auto const context =
+      ParseCloudTraceContext("4BF92F3577B34DA6A3CE929D0E0E4736/255;o=1");
+  ASSERT_TRUE(context.has_value());
+  EXPECT_EQ(context->trace_id, kTraceId);
+  EXPECT_EQ(context->span_id, "00000000000000ff");
+  EXPECT_TRUE(context->sampled);
+
+  auto const unsampled =
+      ParseCloudTraceContext("4bf92f3577b34da6a3ce929d0e0e4736/255");
+  ASSERT_TRUE(unsampled.has_value());
+  EXPECT_FALSE(unsampled->sampled);
+
+  for (auto const* v : {
+           "",
+           "4bf92f3577b34da6a3ce929d0e0e4736",
+           "4bf92f3577b34da6a3ce929d0e0e4736/",
+           "4bf92f3577b34da6a3ce929d0e0e4736/0;o=1",
+           "4bf92f3577b34da6a3ce929d0e0e4736/12x;o=1",
+           "4bf92f3577b34da6a3ce929d0e0e473/255;o=1",
+       }) {
+    EXPECT_FALSE(ParseCloudTraceContext(v).has_value()) << v;
+  }
+}
+
+TEST(TraceContextTest, Format) {
+  TraceContext const context{kTraceId, "00000000000000ff", true};
+  EXPECT_EQ(FormatTraceParent(context),
+            "00-4bf92f3577b34da6a3ce929d0e0e4736-00000000000000ff-01");
+  EXPECT_EQ(FormatCloudTraceContext(context),
+            "4bf92f3577b34da6a3ce929d0e0e4736/255;o=1");
+
+  auto const parsed = ParseTraceParent(FormatTraceParent(context));
+  ASSERT_TRUE(parsed.has_value());
+  EXPECT_EQ(parsed->span_id, context.span_id);
+}
+
+TEST(TraceContextTest, MakeChildSpan) {
+  TraceContext const parent{kTraceId, "00f067aa0ba902b7", true};
+  std::set<std::string> ids;
+  for (int i = 0; i != 100; ++i) {
+    auto const child = MakeChildSpan(parent);
+    EXPECT_EQ(child.trace_id, parent.trace_id);
+    EXPECT_TRUE(child.sampled);
+    EXPECT_TRUE(ParseTraceParent(FormatTraceParent(child)).has_value());
+    ids.insert(child.span_id);
+  }
+  EXPECT_EQ(ids.size(), 100);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
@@ -0,0 +1,61 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/traffic_capture.h"
+#include "google/cloud/functions/internal/traffic_capture.h"
+#include "google/cloud/functions/internal/wrap_request.h"
+#include "google/cloud/functions/in_process_invoker.h"
+#include <chrono>
+#include <optional>
+#include <thread>
+#include <utility>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+void SetTrafficCaptureRedactor(TrafficCaptureRedactor redactor) {
+  functions_internal::SetCurrentTrafficCaptureRedactor(std::move(redactor));
+}
+
+TrafficReplayResult ReplayTraffic(InProcessInvoker& invoker,
+                                  std::string const& capture_file,
+                                  TrafficReplayOptions options) {
+  using Clock = std::chrono::steady_clock;
+  functions_internal::TrafficCaptureReader reader(capture_file);
+  TrafficReplayResult result;
+  auto const start = Clock::now();
+  std::optional<std::chrono::nanoseconds> first;
+  while (auto captured = reader.Next()) {
+    if (!first) first = captured->offset;
+    auto scheduled = Clock::now();
+    if (options.speed > 0) {
+      auto const offset = std::chrono::duration<double, std::nano>(
+          static_cast<double>((captured->offset - *first).count()) /
+          options.speed);
+      scheduled =
+          start + std::chrono::duration_cast<Clock::duration>(offset);
+      std::this_thread::sleep_until(scheduled);
+    }
+    auto response = invoker.Invoke(functions_internal::WrapRequest::wrap(
+        functions_internal::ToBeastRequest(*captured)));
+    result.latencies.push_back(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                             scheduled));
+    result.status_codes.push_back(response.result());
+  }
+  return result;
+}
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
@@ -0,0 +1,99 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_TRAFFIC_CAPTURE_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_TRAFFIC_CAPTURE_H
+
+#include "google/cloud/functions/http_request.h"
+#include "google/cloud/functions/version.h"
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+class InProcessInvoker;
+
+/**
+ * Changes, or drops, the requests captured with `--capture-file`.
+ *
+ * The redactor receives a copy of each sampled request, and returns `false`
+ * to leave it out of the capture. The `Authorization`,
+ * `Proxy-Authorization`, `Cookie`, `X-Goog-IAP-JWT-Assertion`, and
+ * `X-Serverless-Authorization` values are already replaced. The redactor
+ * runs in the threads serving the requests, and must be thread-safe.
+ */
+using TrafficCaptureRedactor = std::function<bool(HttpRequest&)>;
+
+/**
+ * Sets the redactor for the requests captured with `--capture-file`.
+ *
+ * Call this before `Run()`, the server uses the redactor set when it starts.
+ *
+ * @par Example
+ * @code
+ * gcf::SetTrafficCaptureRedactor([](gcf::HttpRequest& request) {
+ *   if (request.path() == "/login") return false;
+ *   request.remove_header("x-api-key");
+ *   return true;
+ * });
+ * @endcode
+ */
+void SetTrafficCaptureRedactor(TrafficCaptureRedactor redactor);
+
+/// Configures `ReplayTraffic()`.
+struct TrafficReplayOptions {
+  /**
+   * Sends the requests this many times faster than they were captured.
+   *
+   * Use 0 to send each request as soon as the previous response arrives.
+   */
+  double speed = 1.0;
+};
+
+/// The responses to the requests replayed by `ReplayTraffic()`.
+struct TrafficReplayResult {
+  /**
+   * The latency of each request, in the order captured.
+   *
+   * The latency starts when the request was scheduled, and includes any
+   * time waiting for the previous requests, as in an open-loop benchmark.
+   */
+  std::vector<std::chrono::nanoseconds> latencies;
+  /// The status code of each response.
+  std::vector<int> status_codes;
+};
+
+/**
+ * Replays the requests in @p capture_file through @p invoker.
+ *
+ * Capture the requests of a deployed function with `--capture-file`, then
+ * replay them against each build, and compare the latencies. The requests
+ * are sent one at a time, in the calling thread, at the times they arrived
+ * divided by `options.speed`. Use the `traffic_replay` benchmark to replay a
+ * capture over a socket, with concurrent requests.
+ *
+ * Throws `std::runtime_error` if the file cannot be read, or is not a
+ * capture file.
+ */
+TrafficReplayResult ReplayTraffic(InProcessInvoker& invoker,
+                                  std::string const& capture_file,
+                                  TrafficReplayOptions options = {});
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_TRAFFIC_CAPTURE_H
@@ -0,0 +1,86 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/functions/traffic_capture.h"
+#include "google/cloud/functions/in_process_invoker.h"
+#include <gmock/gmock.h>
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+namespace {
+
+using ::testing::ElementsAre;
+
+std::string CapturePath() {
+  return (std::filesystem::temp_directory_path() /
+          ("traffic_capture_test_" + std::to_string(std::random_device{}())))
+      .string();
+}
+
+HttpResponse Echo(HttpRequest const& request) {
+  if (request.path() == "/missing") {
+    return HttpResponse{}.set_result(HttpResponse::kNotFound);
+  }
+  auto const auth = request.header("authorization").value_or("");
+  return HttpResponse{}.set_payload(std::string(auth) + ":" +
+                                    request.payload());
+}
+
+TEST(TrafficCaptureTest, CaptureAndReplay) {
+  auto const path = CapturePath();
+  SetTrafficCaptureRedactor([](HttpRequest& request) {
+    return request.path() != "/secret";
+  });
+  {
+    InProcessInvoker invoker(
+        MakeFunction(Echo),
+        {"--capture-file=" + path, "--capture-sample-rate=1"});
+    for (auto const* target : {"/a", "/secret", "/missing", "/b"}) {
+      auto const response =
+          invoker.Invoke(HttpRequest{}
+                             .set_verb("POST")
+                             .set_target(target)
+                             .add_header("authorization", "Bearer token")
+                             .set_payload("body"));
+      EXPECT_EQ(response.payload().empty(),
+                std::string_view(target) == "/missing");
+    }
+  }
+  SetTrafficCaptureRedactor(nullptr);
+
+  InProcessInvoker invoker(MakeFunction(Echo));
+  auto const result =
+      ReplayTraffic(invoker, path, TrafficReplayOptions{/*speed=*/0});
+  EXPECT_THAT(result.status_codes,
+              ElementsAre(HttpResponse::kOkay, HttpResponse::kNotFound,
+                          HttpResponse::kOkay));
+  ASSERT_EQ(result.latencies.size(), 3);
+  for (auto latency : result.latencies) {
+    EXPECT_GE(latency, std::chrono::nanoseconds(0));
+  }
+  std::filesystem::remove(path);
+}
+
+TEST(TrafficCaptureTest, ReplayMissingFile) {
+  InProcessInvoker invoker(MakeFunction(Echo));
+  EXPECT_THROW(ReplayTraffic(invoker, CapturePath()), std::runtime_error);
+}
+
+}  // namespace
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
@@ -16,10 +16,21 @@
 #define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_USER_FUNCTIONS_H
 
 #include "google/cloud/functions/cloud_event.h"
+#include "google/cloud/functions/cloud_event_batch_error.h"
 #include "google/cloud/functions/http_request.h"
+#include "google/cloud/functions/http_request_body_reader.h"
 #include "google/cloud/functions/http_response.h"
+#include "google/cloud/functions/http_response_writer.h"
 #include "google/cloud/functions/version.h"
+#include "google/cloud/functions/websocket.h"
+#include <chrono>
+#include <cstddef>
+#include <exception>
 #include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
 namespace google::cloud::functions {
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
@@ -27,8 +38,337 @@ FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
 using UserHttpFunction =
     std::function<functions::HttpResponse(functions::HttpRequest)>;
 
+/**
+ * An HTTP function that reads the request body incrementally.
+ *
+ * The `HttpRequest` parameter has an empty payload, the function reads the
+ * body using the `HttpRequestBodyReader` parameter.
+ */
+using UserHttpStreamingFunction = std::function<functions::HttpResponse(
+    functions::HttpRequest, functions::HttpRequestBodyReader&)>;
+
+/**
+ * An HTTP function that sends its response incrementally.
+ *
+ * The function sends the response using the `HttpResponseWriter` parameter.
+ */
+using UserHttpStreamingResponseFunction = std::function<void(
+    functions::HttpRequest, functions::HttpResponseWriter&)>;
+
+/**
+ * A function that serves WebSocket connections.
+ *
+ * The function runs once for each connection, with the upgrade request. It
+ * returns the callbacks for the connection, and may keep the `WebSocket` to
+ * send messages at any time, until `on_close` runs.
+ */
+using UserWebSocketFunction = std::function<functions::WebSocketCallbacks(
+    functions::HttpRequest const&, std::shared_ptr<functions::WebSocket>)>;
+
 using UserCloudEventFunction = std::function<void(functions::CloudEvent)>;
 
+/**
+ * A CloudEvent function that receives all the events in a request at once.
+ *
+ * The framework calls the function once per request. For
+ * `application/cloudevents-batch+json` requests the vector has the events in
+ * the batch, in order, otherwise it has a single event. Use this to group the
+ * work for all the events, e.g., into a single bulk write. Throw a
+ * `CloudEventBatchError` to fail only some of the events.
+ */
+using UserCloudEventBatchFunction =
+    std::function<void(std::vector<functions::CloudEvent>)>;
+
+/**
+ * Returns the ordering key of an event, see `CloudEventBatchOptions`.
+ *
+ * For example, the event `subject()`, or `PubsubOrderingKey()`.
+ */
+using UserCloudEventOrderingKeyFunction =
+    std::function<std::optional<std::string>(functions::CloudEvent const&)>;
+
+/**
+ * Configures how a `UserCloudEventFunction` runs the events of a batch.
+ *
+ * By default the events in an `application/cloudevents-batch+json` request run
+ * one after another, and the first failure stops the batch. In either case the
+ * response to a batch lists the failed and skipped events, see
+ * `CloudEventBatchError`.
+ */
+struct CloudEventBatchOptions {
+  /**
+   * The maximum number of events of a batch running concurrently.
+   *
+   * The thread handling the request runs events too, the framework creates a
+   * pool with `parallelism - 1` threads shared by all the batches. Use 0 for
+   * one event per core.
+   */
+  std::size_t parallelism = 0;
+
+  /**
+   * If `true`, events that have not started when an event fails are skipped.
+   *
+   * Events still start in their batch order, but may complete in any order.
+   * Otherwise all the events run, regardless of any failures.
+   */
+  bool ordered = false;
+
+  /**
+   * If set, events with the same key run one after another, in batch order.
+   *
+   * Events with different keys, or without a key, run concurrently. Use this
+   * for events that must be processed in order, e.g., Pub/Sub messages with
+   * an ordering key, or changes to the same Firestore document. If the
+   * function throws the event runs without a key.
+   */
+  UserCloudEventOrderingKeyFunction ordering_key = {};
+};
+
+/**
+ * Returns the priority lane of a request, see `WithConcurrencyLimit()`.
+ *
+ * The `HttpRequest` parameter has the request headers, and an empty payload.
+ * For example, classify requests by path, by a header, or by the `ce-type`
+ * header of CloudEvents.
+ */
+using UserHttpClassifierFunction =
+    std::function<std::size_t(functions::HttpRequest const&)>;
+
+/// Configures `WithConcurrencyLimit()`.
+struct ConcurrencyLimitOptions {
+  /// The maximum number of requests running at once, at least 1.
+  std::size_t max_concurrency = 1;
+
+  /**
+   * Adjusts the limit from the latency of the requests.
+   *
+   * The limit starts at `min_concurrency`, and stays between
+   * `min_concurrency` and `max_concurrency`.
+   */
+  bool adaptive = false;
+
+  /// The lowest limit with `adaptive`, at least 1.
+  std::size_t min_concurrency = 1;
+
+  /// The maximum number of requests waiting to run, others are rejected.
+  std::size_t max_queue = 0;
+
+  /// The `Retry-After` value, in seconds, in responses to rejected requests.
+  std::chrono::seconds retry_after = std::chrono::seconds(1);
+
+  /**
+   * The weights of the priority lanes, all greater than 0.
+   *
+   * Each lane has its own queue of up to `max_queue` requests, and waiting
+   * requests start in proportion to the weights of their lanes. If empty, all
+   * requests share a single lane.
+   */
+  std::vector<double> lane_weights;
+
+  /**
+   * Returns the lane of each request, an index into `lane_weights`.
+   *
+   * Requests use the first lane if unset. Lanes out of range, and exceptions,
+   * use the last lane.
+   */
+  UserHttpClassifierFunction classifier;
+};
+
+/// Configures `WithOffload()`.
+struct OffloadOptions {
+  /**
+   * The size of a pool dedicated to the function.
+   *
+   * If 0 the function shares the default offload pool, which has one thread
+   * per available core.
+   */
+  std::size_t threads = 0;
+};
+
+/// Completes an asynchronous HTTP function, see `UserHttpAsyncFunction`.
+using HttpResponseCallback = std::function<void(functions::HttpResponse)>;
+
+/**
+ * An HTTP function that completes asynchronously.
+ *
+ * The function starts its work and returns, and then calls the callback, from
+ * any thread, with the response. The session does not block while the
+ * function waits for its I/O. The function must call the callback exactly
+ * once, additional calls are ignored. If the function throws before calling
+ * the callback the framework responds with an error.
+ */
+using UserHttpAsyncFunction = std::function<void(functions::HttpRequest,
+                                                 HttpResponseCallback)>;
+
+/**
+ * Completes an asynchronous CloudEvent function.
+ *
+ * Call it with an empty `std::exception_ptr` if the event was processed
+ * successfully.
+ */
+using CloudEventCallback = std::function<void(std::exception_ptr)>;
+
+/**
+ * A CloudEvent function that completes asynchronously.
+ *
+ * As with `UserHttpAsyncFunction` the function must call the callback exactly
+ * once for each event. For batches the response is sent once all the events
+ * complete, and reports the first error, if any.
+ */
+using UserCloudEventAsyncFunction =
+    std::function<void(functions::CloudEvent, CloudEventCallback)>;
+
+/**
+ * Checks an HTTP request before its body is received.
+ *
+ * The `HttpRequest` parameter has the request headers, and an empty payload.
+ * Return an `HttpResponse` to reject the request, or an empty optional to
+ * accept it.
+ */
+using UserHttpPrecheckFunction =
+    std::function<std::optional<functions::HttpResponse>(
+        functions::HttpRequest const&)>;
+
+/**
+ * Initializes a function during startup, see `WithWarmup()`.
+ *
+ * Throw an exception to abort the startup.
+ */
+using UserWarmupFunction = std::function<void()>;
+
+/**
+ * Releases the resources of a function during shutdown, see `WithShutdown()`.
+ *
+ * Exceptions are logged, and do not stop the other shutdown functions.
+ */
+using UserShutdownFunction = std::function<void()>;
+
+/**
+ * Prepares a function for a checkpoint of the server, see
+ * `WithCheckpointHooks()`.
+ *
+ * Throw an exception to abort the startup, no checkpoint is taken.
+ */
+using UserCheckpointFunction = std::function<void()>;
+
+/**
+ * Prepares a function to serve requests after the server is restored from a
+ * checkpoint, see `WithCheckpointHooks()`.
+ *
+ * Throw an exception to abort the startup.
+ */
+using UserRestoreFunction = std::function<void()>;
+
+/**
+ * Returns the current entity tag for the resource in an HTTP request.
+ *
+ * The `HttpRequest` parameter has the request headers, and an empty payload.
+ * Return an empty optional if the resource has no entity tag. The tag is
+ * quoted by the framework unless it is already quoted, e.g., `"v1"` or
+ * `W/"v1"`.
+ */
+using UserHttpValidatorFunction = std::function<std::optional<std::string>(
+    functions::HttpRequest const&)>;
+
+/**
+ * Returns the key that groups identical requests, see `WithCoalescing()`.
+ *
+ * The `HttpRequest` parameter has the request headers, and an empty payload.
+ * Return an empty optional to run the request on its own.
+ */
+using UserHttpCoalescingKeyFunction = std::function<std::optional<std::string>(
+    functions::HttpRequest const&)>;
+
+/// Configures `WithCoalescing()`.
+struct CoalescingOptions {
+  /**
+   * The headers that, with the request target, identify identical requests.
+   *
+   * For example, `Accept` or `Accept-Encoding` if the response depends on
+   * them. Header names are case-insensitive.
+   */
+  std::vector<std::string> headers;
+
+  /// If set, it replaces the target and `headers` as the key of the requests.
+  UserHttpCoalescingKeyFunction key;
+};
+
+/// Configures `WithResponseCache()`.
+struct ResponseCacheOptions {
+  /**
+   * The headers that, with the request target, select a cached response.
+   *
+   * Responses that `Vary` on other headers are not cached. Header names are
+   * case-insensitive.
+   */
+  std::vector<std::string> headers;
+
+  /// The memory used by the cached responses, including their headers.
+  std::size_t max_bytes = 64 * 1024 * 1024;
+
+  /// The cache is split in this many independently locked parts.
+  std::size_t shards = 16;
+};
+
+/**
+ * Returns the key that identifies the client of a request, see
+ * `WithRateLimit()`.
+ *
+ * The `HttpRequest` parameter has the request headers, and an empty payload.
+ * Return an empty optional to skip the limit for the request.
+ */
+using UserHttpRateLimitKeyFunction = std::function<std::optional<std::string>(
+    functions::HttpRequest const&)>;
+
+/// Configures `WithRateLimit()`.
+struct RateLimitOptions {
+  /// The sustained rate of requests per client, in requests per second.
+  double requests_per_second = 10;
+
+  /// The number of requests a client may send at once, at least 1.
+  double burst = 10;
+
+  /**
+   * The header that identifies the client.
+   *
+   * The key is the last comma-separated value of the header. In
+   * `X-Forwarded-For` this is the address of the client as seen by the
+   * closest proxy, the earlier values are set by the client and cannot be
+   * trusted. Requests without the header are keyed by the address of the
+   * peer, which is the proxy itself for proxied requests. Header names are
+   * case-insensitive.
+   */
+  std::string header = "X-Forwarded-For";
+
+  /**
+   * If set, it replaces `header` as the key of the requests.
+   *
+   * This converts the request header to an `HttpRequest`, use `header` if
+   * possible.
+   */
+  UserHttpRateLimitKeyFunction key;
+
+  /**
+   * The maximum number of clients tracked at once.
+   *
+   * The least recently seen clients are forgotten to make room for new ones,
+   * their next request starts with a full bucket.
+   */
+  std::size_t max_clients = 65536;
+};
+
+/// Configures `MakeStaticAssetFunction()`.
+struct StaticAssetOptions {
+  /// The file served for requests to a directory, e.g. `/` or `/docs/`.
+  std::string index = "index.html";
+
+  /// The `Cache-Control` header for all the files, if not empty.
+  std::string cache_control;
+
+  /// Files smaller than this, in bytes, are not precompressed.
+  std::size_t min_compress_size = 256;
+};
+
 FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
 }  // namespace google::cloud::functions
 
@@ -0,0 +1,65 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_WEBSOCKET_H
+#define FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_WEBSOCKET_H
+
+#include "google/cloud/functions/version.h"
+#include <functional>
+#include <string>
+
+namespace google::cloud::functions {
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_BEGIN
+
+/**
+ * A WebSocket connection, see `MakeWebSocketFunction()`.
+ *
+ * All the member functions are thread-safe, and return without waiting for
+ * the network. The messages are sent in the order they are queued. Once the
+ * connection is closed the messages are discarded.
+ */
+class WebSocket {
+ public:
+  virtual ~WebSocket() = default;
+
+  /// Queues @p message as a text message, it must be valid UTF-8.
+  virtual void Send(std::string message) = 0;
+
+  /// Queues @p message as a binary message.
+  virtual void SendBinary(std::string message) = 0;
+
+  /// Closes the connection, once the queued messages are sent.
+  virtual void Close() = 0;
+};
+
+/// The callbacks for the events of a WebSocket connection.
+struct WebSocketCallbacks {
+  /**
+   * Receives each message, in order.
+   *
+   * The callback runs in the thread serving the connection, and delays the
+   * next message until it returns. Long computations should run elsewhere,
+   * for example, with `RunInBackground()`. @p binary is `false` for text
+   * messages.
+   */
+  std::function<void(std::string message, bool binary)> on_message;
+
+  /// Runs once the connection closes, for any reason.
+  std::function<void()> on_close;
+};
+
+FUNCTIONS_FRAMEWORK_CPP_INLINE_NAMESPACE_END
+}  // namespace google::cloud::functions
+
+#endif  // FUNCTIONS_FRAMEWORK_CPP_GOOGLE_CLOUD_FUNCTIONS_WEBSOCKET_H